@@ -13,7 +13,18 @@
 #include <SDL_mixer.h>
 #endif
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <atomic>
 #include <iostream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "audio_driver.h"
 #include "core_driver.h"
@@ -21,17 +32,368 @@
 using std::cerr;
 using std::endl;
 
+// Each channel is a bit in the masks of _sk_effect_channels, so at most 64
 #define SG_MAX_CHANNELS 64
+
+// The buffer size used when none is given, in samples
+#define SG_DEFAULT_AUDIO_BUFFER 4096
+
 namespace splashkit_lib
 {
     static Mix_Chunk * _sk_sound_channels[SG_MAX_CHANNELS];
     static sk_sound_data * _current_music  = NULL;
 
+    // The priority each channel's effect was played with, and when it started,
+    // so a new effect can replace the least important one when none are free
+    static int _sk_channel_priority[SG_MAX_CHANNELS];
+    static unsigned long long _sk_channel_started[SG_MAX_CHANNELS];
+    static unsigned long long _sk_channel_plays = 0;
+
+    // Channels with a position effect, which is removed when the channel is reused
+    static bool _sk_channel_positioned[SG_MAX_CHANNELS];
+
+    // The channels each effect has been played on, one bit for each channel.
+    // Finding an effect's channel only checks these, rather than every channel.
+    static std::unordered_map<Mix_Chunk *, uint64_t> _sk_effect_channels;
+
     // access system data from core driver
     extern sk_system_data _sk_system_data;
 
     static bool _sk_audio_open = false;
 
+    //
+    // Post mix
+    //
+    // The mixed output is passed to the mix function as floats. When the
+    // device mixes floats this is the mixer's own buffer, otherwise the
+    // samples are converted through a buffer that is kept between calls.
+    //
+
+    static std::atomic<sk_audio_mix_fn> _sk_mix_fn(nullptr);
+    static std::vector<float> _sk_mix_buffer;
+
+    static void _sk_post_mix(void *udata, Uint8 *stream, int len)
+    {
+        sk_audio_mix_fn fn = _sk_mix_fn.load();
+        int channels = _sk_system_data.audio_specs.audio_channels;
+        int rate = _sk_system_data.audio_specs.audio_rate;
+
+        if ( ! fn || channels <= 0 ) return;
+
+        switch ( _sk_system_data.audio_specs.audio_format )
+        {
+            case AUDIO_F32SYS:
+            {
+                int frames = len / static_cast<int>(sizeof(float) * channels);
+                fn(reinterpret_cast<float *>(stream), frames, channels, rate);
+                break;
+            }
+            case AUDIO_S16SYS:
+            {
+                Sint16 *samples = reinterpret_cast<Sint16 *>(stream);
+                int count = len / static_cast<int>(sizeof(Sint16));
+
+                if ( _sk_mix_buffer.size() < static_cast<size_t>(count) ) _sk_mix_buffer.resize(count);
+
+                for (int i = 0; i < count; i++) _sk_mix_buffer[i] = samples[i] / 32768.0f;
+
+                fn(_sk_mix_buffer.data(), count / channels, channels, rate);
+
+                for (int i = 0; i < count; i++)
+                {
+                    float value = _sk_mix_buffer[i] * 32767.0f;
+                    samples[i] = static_cast<Sint16>(value < -32768.0f ? -32768.0f : (value > 32767.0f ? 32767.0f : value));
+                }
+                break;
+            }
+            default:
+                // Other formats are only used if the device could not give either of these
+                break;
+        }
+    }
+
+    void sk_set_audio_mix_fn(sk_audio_mix_fn fn)
+    {
+        _sk_mix_fn = fn;
+        if ( _sk_audio_open ) Mix_SetPostMix(fn ? _sk_post_mix : nullptr, nullptr);
+    }
+
+    //
+    // Shared samples
+    //
+    // Sound effects decoded from the same file, or from the same bytes, share
+    // one copy of their samples. Each effect gets its own chunk over the
+    // shared samples, so it keeps its own volume. Decoding on the worker
+    // threads checks the table too, so it is locked.
+    //
+
+    struct _sk_shared_samples
+    {
+        Mix_Chunk   *owner;     // The chunk that was decoded, and owns the samples
+        int         refs;       // The number of chunks using the samples
+    };
+
+    static std::mutex _sk_shared_samples_lock;
+    static std::unordered_map<string, _sk_shared_samples> _sk_shared_samples_by_key;
+    static std::unordered_map<Mix_Chunk *, string> _sk_shared_sample_keys;
+
+    /**
+     * Identify a file by its path, size and modification time, so a file that
+     * is changed and loaded again is decoded again.
+     */
+    static string _sk_file_samples_key(const string &filename)
+    {
+        std::error_code err;
+        std::filesystem::path path = std::filesystem::absolute(filename, err);
+        if ( err ) return "";
+
+        auto size = std::filesystem::file_size(path, err);
+        if ( err ) return "";
+
+        auto modified = std::filesystem::last_write_time(path, err);
+        if ( err ) return "";
+
+        return path.string() + "|" + std::to_string(size) + "|" + std::to_string(modified.time_since_epoch().count());
+    }
+
+    /**
+     * Identify bytes in memory by their size and an FNV-1a hash, which is much
+     * quicker than decoding them.
+     */
+    static string _sk_memory_samples_key(const void *data, size_t size)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        uint64_t hash = 14695981039346656037ULL;
+
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+
+        char key[64];
+        snprintf(key, sizeof(key), "memory|%zu|%016llx", size, static_cast<unsigned long long>(hash));
+        return key;
+    }
+
+    /**
+     * Add a chunk over the shared samples. Must be called with the lock held.
+     */
+    static Mix_Chunk *_sk_share_samples(const string &key, _sk_shared_samples &shared)
+    {
+        Mix_Chunk *result = Mix_QuickLoad_RAW(shared.owner->abuf, shared.owner->alen);
+        if ( ! result ) return nullptr;
+
+        shared.refs++;
+        _sk_shared_sample_keys[result] = key;
+        return result;
+    }
+
+    /**
+     * Get a chunk for the samples with the given key, decoding them only if no
+     * other effect has them already.
+     */
+    static Mix_Chunk *_sk_shared_chunk(const string &key, const std::function<Mix_Chunk *()> &decode)
+    {
+        if ( key.empty() ) return decode();
+
+        {
+            std::lock_guard<std::mutex> lock(_sk_shared_samples_lock);
+            auto it = _sk_shared_samples_by_key.find(key);
+            if ( it != _sk_shared_samples_by_key.end() ) return _sk_share_samples(key, it->second);
+        }
+
+        // Decode without the lock, so other files can be decoded at the same time
+        Mix_Chunk *decoded = decode();
+        if ( ! decoded ) return nullptr;
+
+        std::lock_guard<std::mutex> lock(_sk_shared_samples_lock);
+        auto it = _sk_shared_samples_by_key.find(key);
+
+        if ( it != _sk_shared_samples_by_key.end() )
+        {
+            // Another thread decoded the same samples first
+            Mix_FreeChunk(decoded);
+        }
+        else
+        {
+            it = _sk_shared_samples_by_key.emplace(key, _sk_shared_samples { decoded, 0 }).first;
+        }
+
+        return _sk_share_samples(key, it->second);
+    }
+
+    /**
+     * Free a chunk, and the shared samples once no chunk uses them.
+     */
+    static void _sk_free_shared_chunk(Mix_Chunk *chunk)
+    {
+        Mix_FreeChunk(chunk);
+
+        std::lock_guard<std::mutex> lock(_sk_shared_samples_lock);
+        auto key = _sk_shared_sample_keys.find(chunk);
+        if ( key == _sk_shared_sample_keys.end() ) return;
+
+        auto it = _sk_shared_samples_by_key.find(key->second);
+        if ( it != _sk_shared_samples_by_key.end() && --it->second.refs == 0 )
+        {
+            Mix_FreeChunk(it->second.owner);
+            _sk_shared_samples_by_key.erase(it);
+        }
+
+        _sk_shared_sample_keys.erase(key);
+    }
+
+    //
+    // Decoded sounds
+    //
+    // SDL_mixer is only used on the main thread, so decoding on a worker
+    // reads the file and converts wave samples with SDL alone. Other formats
+    // need SDL_mixer's decoders, so their bytes are kept and decoded when the
+    // chunk is made. Nothing is decoded for samples another effect already has.
+    //
+
+    struct sk_decoded_sound
+    {
+        string              key;                // Identifies the samples, to share them
+        string              filename;           // Loaded from when nothing was read
+        Uint8               *samples = nullptr; // In the mixer's format, from SDL_malloc
+        Uint32              length = 0;
+        std::vector<char>   encoded;            // Left for SDL_mixer to decode
+    };
+
+    static bool _sk_samples_shared(const string &key)
+    {
+        if ( key.empty() ) return false;
+
+        std::lock_guard<std::mutex> lock(_sk_shared_samples_lock);
+        return _sk_shared_samples_by_key.count(key) > 0;
+    }
+
+    /**
+     * Convert the encoded bytes to samples in the mixer's format, if they are
+     * a wave file. Other formats are left encoded.
+     */
+    static void _sk_decode_wave(sk_decoded_sound *decoded)
+    {
+        sk_audiospec mixer = _sk_system_data.audio_specs;
+        if ( mixer.audio_format == 0 || decoded->encoded.size() > INT32_MAX ) return;
+
+        SDL_RWops *source = SDL_RWFromConstMem(decoded->encoded.data(), static_cast<int>(decoded->encoded.size()));
+        if ( ! source ) return;
+
+        SDL_AudioSpec spec;
+        Uint8 *wave;
+        Uint32 length;
+        if ( ! SDL_LoadWAV_RW(source, 1, &spec, &wave, &length) ) return;
+
+        SDL_AudioCVT cvt;
+        if ( SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                               static_cast<SDL_AudioFormat>(mixer.audio_format), mixer.audio_channels, mixer.audio_rate) < 0 )
+        {
+            SDL_FreeWAV(wave);
+            return;
+        }
+
+        cvt.len = static_cast<int>(length);
+        cvt.buf = static_cast<Uint8 *>(SDL_malloc(static_cast<size_t>(length) * cvt.len_mult));
+        if ( cvt.buf ) memcpy(cvt.buf, wave, length);
+        SDL_FreeWAV(wave);
+
+        if ( ! cvt.buf ) return;
+
+        if ( SDL_ConvertAudio(&cvt) < 0 )
+        {
+            SDL_free(cvt.buf);
+            return;
+        }
+
+        decoded->samples = cvt.buf;
+        decoded->length = static_cast<Uint32>(cvt.len_cvt);
+        decoded->encoded = std::vector<char>();
+    }
+
+    sk_decoded_sound *sk_decode_sound(const string &filename)
+    {
+        sk_decoded_sound *result = new sk_decoded_sound();
+        result->key = _sk_file_samples_key(filename);
+        result->filename = filename;
+
+        if ( _sk_samples_shared(result->key) ) return result;
+
+        // A file that cannot be read is left for SDL_mixer, which reports it
+        std::ifstream file(filename, std::ios::binary);
+        if ( ! file ) return result;
+
+        result->encoded.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        _sk_decode_wave(result);
+        return result;
+    }
+
+    sk_decoded_sound *sk_decode_sound_from_memory(const void *data, size_t size)
+    {
+        sk_decoded_sound *result = new sk_decoded_sound();
+        result->key = _sk_memory_samples_key(data, size);
+
+        // The bytes are copied even when shared, as they may be gone by the
+        // time the chunk is made
+        const char *bytes = static_cast<const char *>(data);
+        result->encoded.assign(bytes, bytes + size);
+
+        if ( ! _sk_samples_shared(result->key) ) _sk_decode_wave(result);
+        return result;
+    }
+
+    void sk_free_decoded_sound(sk_decoded_sound *decoded)
+    {
+        if ( ! decoded ) return;
+
+        SDL_free(decoded->samples);
+        delete decoded;
+    }
+
+    sk_sound_data sk_sound_from_decoded(sk_decoded_sound *decoded)
+    {
+        internal_sk_init();
+        sk_sound_data result = { SGSD_SOUND_EFFECT, NULL };
+
+        if ( ! decoded ) return result;
+
+        result._data = _sk_shared_chunk(decoded->key, [decoded]() -> Mix_Chunk *
+        {
+            if ( decoded->samples )
+            {
+                // Made as SDL_mixer makes its own, so Mix_FreeChunk frees the samples
+                Mix_Chunk *chunk = static_cast<Mix_Chunk *>(SDL_malloc(sizeof(Mix_Chunk)));
+                if ( ! chunk ) return nullptr;
+
+                chunk->allocated = 1;
+                chunk->abuf = decoded->samples;
+                chunk->alen = decoded->length;
+                chunk->volume = MIX_MAX_VOLUME;
+                decoded->samples = nullptr;
+                return chunk;
+            }
+
+            if ( ! decoded->encoded.empty() )
+            {
+                SDL_RWops *source = SDL_RWFromConstMem(decoded->encoded.data(), static_cast<int>(decoded->encoded.size()));
+                return source ? Mix_LoadWAV_RW(source, 1) : nullptr;
+            }
+
+            return Mix_LoadWAV(decoded->filename.c_str());
+        });
+
+        sk_free_decoded_sound(decoded);
+
+        if(result._data == nullptr)
+        {
+            cerr << Mix_GetError() << endl;
+        }
+
+        return result;
+    }
+
     void sk_init_audio()
     {
         Mix_Init(~0);
@@ -44,9 +406,14 @@ namespace splashkit_lib
     }
 
     void sk_open_audio()
+    {
+        sk_open_audio(MIX_DEFAULT_FREQUENCY, 2, SG_DEFAULT_AUDIO_BUFFER);
+    }
+
+    void sk_open_audio(int frequency, int channels, int buffer_size)
     {
         internal_sk_init();
-        if ( Mix_OpenAudio(MIX_DEFAULT_FREQUENCY, MIX_DEFAULT_FORMAT, 2, 4096 ) < 0 )
+        if ( Mix_OpenAudio(frequency, MIX_DEFAULT_FORMAT, channels, buffer_size ) < 0 )
         {
             //        set_error_state("Unable to load audio. Mix_OpenAudio failed.");
             return;
@@ -59,6 +426,8 @@ namespace splashkit_lib
 
         Mix_AllocateChannels(SG_MAX_CHANNELS);
 
+        if ( _sk_mix_fn.load() ) Mix_SetPostMix(_sk_post_mix, nullptr);
+
         _sk_audio_open = true;
     }
 
@@ -74,18 +443,105 @@ namespace splashkit_lib
         }
     }
 
+    /**
+     * Record that the effect has started on the channel, so it can be found
+     * again without checking every channel.
+     */
+    static void _sk_record_channel(int channel, Mix_Chunk *effect, int priority)
+    {
+        uint64_t bit = uint64_t(1) << channel;
+        Mix_Chunk *previous = _sk_sound_channels[channel];
+
+        if ( previous && previous != effect )
+        {
+            auto it = _sk_effect_channels.find(previous);
+            if ( it != _sk_effect_channels.end() )
+            {
+                it->second &= ~bit;
+                if ( it->second == 0 ) _sk_effect_channels.erase(it);
+            }
+        }
+
+        if ( _sk_channel_positioned[channel] )
+        {
+            Mix_SetPosition(channel, 0, 0);
+            _sk_channel_positioned[channel] = false;
+        }
+
+        _sk_sound_channels[channel] = effect;
+        _sk_channel_priority[channel] = priority;
+        _sk_channel_started[channel] = ++_sk_channel_plays;
+        _sk_effect_channels[effect] |= bit;
+    }
+
+    /**
+     * Forget the effect, clearing the channels it was played on.
+     */
+    static void _sk_forget_effect(Mix_Chunk *effect)
+    {
+        auto it = _sk_effect_channels.find(effect);
+        if ( it == _sk_effect_channels.end() ) return;
+
+        for (int i = 0; i < SG_MAX_CHANNELS && (it->second >> i); i++)
+        {
+            if ( ((it->second >> i) & 1) && _sk_sound_channels[i] == effect ) _sk_sound_channels[i] = nullptr;
+        }
+
+        _sk_effect_channels.erase(it);
+    }
+
+    /**
+     * Halt the channel playing the least important effect, if it is less
+     * important than `priority`, and return it so it can be reused. Ties go
+     * to the effect that has been playing the longest.
+     */
+    static int _sk_steal_channel(int priority)
+    {
+        int result = -1;
+
+        for (int i = 0; i < SG_MAX_CHANNELS; i++)
+        {
+            if ( _sk_channel_priority[i] >= priority ) continue;
+
+            if ( result < 0 ||
+                 _sk_channel_priority[i] < _sk_channel_priority[result] ||
+                 (_sk_channel_priority[i] == _sk_channel_priority[result] && _sk_channel_started[i] < _sk_channel_started[result]) )
+            {
+                result = i;
+            }
+        }
+
+        if ( result >= 0 ) Mix_HaltChannel(result);
+        return result;
+    }
+
     int sk_get_channel(sk_sound_data *sound)
     {
         if ( (!sound) || (!sound->_data) ) return -1;
 
-        for (int i = 0; i < SG_MAX_CHANNELS; i++)
+        Mix_Chunk *effect = static_cast<Mix_Chunk *>(sound->_data);
+        auto it = _sk_effect_channels.find(effect);
+        if ( it == _sk_effect_channels.end() ) return -1;
+
+        int result = -1;
+        uint64_t mask = it->second;
+
+        for (int i = 0; i < SG_MAX_CHANNELS && (mask >> i); i++)
         {
-            if ( _sk_sound_channels[i] == sound->_data && Mix_Playing(i) )
+            if ( ! ((mask >> i) & 1) ) continue;
+
+            if ( _sk_sound_channels[i] == effect && Mix_Playing(i) )
             {
-                return i;
+                result = i;
+                break;
             }
+
+            // The channel has finished, or moved on to another effect
+            it->second &= ~(uint64_t(1) << i);
         }
-        return -1;
+
+        if ( it->second == 0 ) _sk_effect_channels.erase(it);
+        return result;
     }
 
 
@@ -100,16 +556,44 @@ namespace splashkit_lib
         switch (kind)
         {
             case SGSD_SOUND_EFFECT:
+                return sk_sound_from_decoded(sk_decode_sound(filename));
+            case SGSD_MUSIC:
             {
-                result._data = Mix_LoadWAV(filename.c_str());
+                result._data = Mix_LoadMUS(filename.c_str());
                 break;
             }
+
+            case SGSD_UNKNOWN:
+            default:
+                return result;
+        }
+
+        if(result._data == nullptr)
+        {
+            cerr << Mix_GetError() << endl;
+        }
+
+        return result;
+    }
+
+    sk_sound_data sk_load_sound_data_from_memory(const void *data, size_t size, sk_sound_kind kind)
+    {
+        internal_sk_init();
+        sk_sound_data result = { SGSD_UNKNOWN, NULL } ;
+
+        result.kind = kind;
+
+        switch (kind)
+        {
+            case SGSD_SOUND_EFFECT:
+                return sk_sound_from_decoded(sk_decode_sound_from_memory(data, size));
             case SGSD_MUSIC:
             {
-                result._data = Mix_LoadMUS(filename.c_str());
+                SDL_RWops *source = SDL_RWFromConstMem(data, static_cast<int>(size));
+                if ( ! source ) return result;
+                result._data = Mix_LoadMUS_RW(source, 1);
                 break;
             }
-
             case SGSD_UNKNOWN:
             default:
                 return result;
@@ -138,7 +622,8 @@ namespace splashkit_lib
                 {
                     _current_music = NULL;
                 }
-                Mix_FreeChunk(static_cast<Mix_Chunk *>(sound->_data));
+                _sk_forget_effect(static_cast<Mix_Chunk *>(sound->_data));
+                _sk_free_shared_chunk(static_cast<Mix_Chunk *>(sound->_data));
                 break;
 
             case SGSD_UNKNOWN:
@@ -149,9 +634,38 @@ namespace splashkit_lib
         sound->_data = NULL;
     }
 
+    size_t sk_sound_data_memory(sk_sound_data *sound)
+    {
+        if ( (!sound) || (!sound->_data) ) return 0;
+
+        // Music is streamed from its file, so only effects hold their samples.
+        // Shared samples are split between the effects that use them.
+        if ( sound->kind == SGSD_SOUND_EFFECT )
+        {
+            Mix_Chunk *chunk = static_cast<Mix_Chunk *>(sound->_data);
+
+            std::lock_guard<std::mutex> lock(_sk_shared_samples_lock);
+            auto key = _sk_shared_sample_keys.find(chunk);
+            if ( key != _sk_shared_sample_keys.end() )
+            {
+                auto it = _sk_shared_samples_by_key.find(key->second);
+                if ( it != _sk_shared_samples_by_key.end() ) return chunk->alen / it->second.refs;
+            }
+
+            return chunk->alen;
+        }
+
+        return 0;
+    }
+
     void sk_play_sound(sk_sound_data * sound, int loops, float volume)
     {
-        if ( (!sound) || (!sound->_data) ) return;
+        sk_play_sound(sound, loops, volume, 0);
+    }
+
+    int sk_play_sound(sk_sound_data * sound, int loops, float volume, int priority)
+    {
+        if ( (!sound) || (!sound->_data) ) return -1;
 
         switch (sound->kind)
         {
@@ -159,10 +673,19 @@ namespace splashkit_lib
             {
                 Mix_Chunk *effect = static_cast<Mix_Chunk *>(sound->_data);
                 int channel = Mix_PlayChannel( -1, effect, loops);
+
+                // No channel is free, so replace a less important effect
+                if ( channel < 0 )
+                {
+                    int stolen = _sk_steal_channel(priority);
+                    if ( stolen >= 0 ) channel = Mix_PlayChannel(stolen, effect, loops);
+                }
+
                 if (channel >= 0 && channel < SG_MAX_CHANNELS)
                 {
                     Mix_Volume(channel, static_cast<int>(volume * MIX_MAX_VOLUME));
-                    _sk_sound_channels[channel] = effect;   // record which channel is playing the effect
+                    _sk_record_channel(channel, effect, priority);   // record which channel is playing the effect
+                    return channel;
                 }
                 break;
             }
@@ -176,6 +699,43 @@ namespace splashkit_lib
             case SGSD_UNKNOWN:
                 break;
         }
+
+        return -1;
+    }
+
+    bool sk_channel_playing(int channel, sk_sound_data *sound)
+    {
+        if ( channel < 0 || channel >= SG_MAX_CHANNELS || ! sound || ! sound->_data ) return false;
+
+        return _sk_sound_channels[channel] == sound->_data && Mix_Playing(channel);
+    }
+
+    void sk_set_channel_volume(int channel, float volume)
+    {
+        if ( channel < 0 || channel >= SG_MAX_CHANNELS ) return;
+
+        Mix_Volume(channel, static_cast<int>(volume * MIX_MAX_VOLUME));
+    }
+
+    void sk_set_channel_position(int channel, int angle, int distance)
+    {
+        if ( channel < 0 || channel >= SG_MAX_CHANNELS ) return;
+
+        // An angle and distance of 0 removes the effect, so keep a distance of at least 1
+        if ( distance < 1 ) distance = 1;
+        if ( distance > 255 ) distance = 255;
+
+        if ( Mix_SetPosition(channel, static_cast<Sint16>(angle), static_cast<Uint8>(distance)) )
+        {
+            _sk_channel_positioned[channel] = true;
+        }
+    }
+
+    void sk_halt_channel(int channel)
+    {
+        if ( channel < 0 || channel >= SG_MAX_CHANNELS ) return;
+
+        Mix_HaltChannel(channel);
     }
 
     float sk_sound_playing(sk_sound_data * sound)
@@ -216,7 +776,7 @@ namespace splashkit_lib
                 channel = Mix_FadeInChannel(-1, static_cast<Mix_Chunk *>(sound->_data), loops, ms);
                 if ( channel >= 0 && channel < SG_MAX_CHANNELS )
                 {
-                    _sk_sound_channels[channel] = static_cast<Mix_Chunk *>(sound->_data);
+                    _sk_record_channel(channel, static_cast<Mix_Chunk *>(sound->_data), 0);
                 }
                 break;
             }
@@ -357,9 +917,14 @@ namespace splashkit_lib
                 
             case SGSD_SOUND_EFFECT:
             {
-                for (int i = 0; i < SG_MAX_CHANNELS; i++)
+                Mix_Chunk *effect = static_cast<Mix_Chunk *>(sound->_data);
+                auto it = _sk_effect_channels.find(effect);
+                if ( it == _sk_effect_channels.end() ) break;
+
+                uint64_t mask = it->second;
+                for (int i = 0; i < SG_MAX_CHANNELS && (mask >> i); i++)
                 {
-                    if ( _sk_sound_channels[i] == sound->_data )
+                    if ( ((mask >> i) & 1) && _sk_sound_channels[i] == effect )
                     {
                         Mix_HaltChannel(i);
                     }
@@ -35,6 +35,9 @@ namespace splashkit_lib
 
     void sk_init_audio();
     void sk_open_audio();
+
+    // Open audio with the given sample rate, output channels and buffer size in samples
+    void sk_open_audio(int frequency, int channels, int buffer_size);
     void sk_close_audio();
     bool sk_audio_is_open();
 
@@ -42,10 +45,37 @@ namespace splashkit_lib
 
     sk_sound_data sk_load_sound_data(string filename, sk_sound_kind kind);
 
+    // Sound effects can load in two steps: the decode reads the file and
+    // converts wave samples to the mixer's format without using SDL_mixer, so
+    // it can run on any thread. The result is then turned into sound data on
+    // the main thread, or freed if it is not needed. Music is only loaded on
+    // the main thread.
+    struct sk_decoded_sound;
+    sk_decoded_sound *sk_decode_sound(const string &filename);
+    sk_decoded_sound *sk_decode_sound_from_memory(const void *data, size_t size);
+    sk_sound_data sk_sound_from_decoded(sk_decoded_sound *decoded);
+    void sk_free_decoded_sound(sk_decoded_sound *decoded);
+
+    // Music streams from the data as it plays, so it must outlive the music
+    sk_sound_data sk_load_sound_data_from_memory(const void *data, size_t size, sk_sound_kind kind);
+
     void sk_close_sound_data(sk_sound_data * sound );
 
+    // Bytes of decoded samples held in memory
+    size_t sk_sound_data_memory(sk_sound_data *sound);
+
     void sk_play_sound(sk_sound_data * sound, int loops, float volume);
 
+    // When no channel is free, an effect replaces one playing at a lower priority.
+    // Returns the channel the effect is playing on, or -1.
+    int sk_play_sound(sk_sound_data * sound, int loops, float volume, int priority);
+
+    // Control a channel returned by sk_play_sound, while it is still playing the sound
+    bool sk_channel_playing(int channel, sk_sound_data *sound);
+    void sk_set_channel_volume(int channel, float volume);
+    void sk_set_channel_position(int channel, int angle, int distance);
+    void sk_halt_channel(int channel);
+
     float sk_sound_playing(sk_sound_data * sound);
 
     void sk_fade_in(sk_sound_data *sound, int loops, int ms);
@@ -75,6 +105,12 @@ namespace splashkit_lib
     bool sk_music_playing();
     
     sk_sound_data * sk_current_music();
+
+    // Called on the audio thread with the mixed output, as floats between -1 and 1
+    typedef void (*sk_audio_mix_fn)(float *samples, int frames, int channels, int rate);
+
+    // Register the function to call with the mixed output, or nullptr to stop
+    void sk_set_audio_mix_fn(sk_audio_mix_fn fn);
     
     
 }
@@ -21,10 +21,14 @@
 
 #include <string>
 #include <vector>
+#include <deque>
+#include <memory>
 #include <map>
+#include <atomic>
 
 using std::string;
 using std::vector;
+using std::deque;
 
 namespace splashkit_lib
 {
@@ -53,7 +57,9 @@ namespace splashkit_lib
         WINDOW_PTR =                0x57494e44, //'WIND';
         HTTP_REQUEST_PTR =          0x48524551, //'HREQ';
         HTTP_RESPONSE_PTR =         0x48524553, //'HRES';
+        HTTP_ASYNC_REQUEST_PTR =    0x48415359, //'HASY';
         WEB_SERVER_PTR =            0x57535652, //'WSVR';
+        WEBSOCKET_PTR =             0x57534b54, //'WSKT';
         CONNECTION_PTR =            0x434f4e50, //'CONP';
         MESSAGE_PTR =               0x4d534750, //'MSGP';
         SERVER_SOCKET_PTR =         0x53565253, //'SVRS';
@@ -61,6 +67,15 @@ namespace splashkit_lib
         DISPLAY_PTR =               0x44495350, //'DISP';
         QUERY_PTR =                 0x51555259, //'QURY';
         JSON_PTR =                  0x4a534f4e, //'JSON';
+        JSON_KEY_PTR =              0x4a4b4559, //'JKEY';
+        SPATIAL_INDEX_PTR =         0x5350494e, //'SPIN';
+        AUDIO_NODE_PTR =            0x414e4f44, //'ANOD';
+        SOUND_EMITTER_PTR =         0x53454d54, //'SEMT';
+        TILEMAP_PTR =               0x544d4150, //'TMAP';
+        PARTICLE_EMITTER_PTR =      0x5054454d, //'PTEM';
+        PHYSICS_WORLD_PTR =         0x50485957, //'PHYW';
+        UDP_ENDPOINT_PTR =          0x55445045, //'UDPE';
+        REPLICATED_STATE_PTR =      0x5245504c, //'REPL';
         NONE_PTR =                  0x4e4f4e45  //'NONE';
     };
 
@@ -154,7 +169,19 @@ namespace splashkit_lib
         int cell_rows;   // The rows of cells in the bitmap
         int cell_count;  // The total number of cells in the bitmap
 
-        bool *pixel_mask;   // Pixel mask used for pixel level collisions
+        // Pixel mask used for pixel level collisions, one bit per pixel with
+        // each row padded out to a whole number of 64 bit words
+        uint64_t *pixel_mask;
+        int mask_words;     // The number of words in each row of the mask
+        bool mask_pending;  // Loaded bitmaps build their mask on first use
+
+        // Tight bounds of the opaque pixels in each cell, relative to the cell
+        vector<rectangle> cell_opaque_bounds;
+
+        // Convex hull around the opaque pixels of each cell, relative to the
+        // cell, built on first use by polygon collisions
+        vector<vector<point_2d>> cell_hulls;
+        vector<bool> cell_hulls_built;
     };
 
     struct sk_font_data
@@ -165,8 +192,27 @@ namespace splashkit_lib
 
         bool                was_downloaded;
 
+        // Draw every size by scaling the glyphs of one large size
+        bool                scalable;
+
         // TTF_Font Private Data
         map<int, void *> _data;
+
+        // The font file, read once and shared by each size that is opened
+        vector<char> _file_data;
+
+        // When each open size was last used, so the oldest can be closed
+        map<int, unsigned long long> _size_used;
+
+        // The style for sizes opened after all sizes were closed, see
+        // sk_unload_font_data
+        int _unloaded_style = 0;
+
+        // Glyph atlas for each font size, created on first draw
+        map<int, void *> _atlas;
+
+        // Measured text sizes for each font size, created on first measure
+        map<int, void *> _measures;
     };
 
     enum sk_http_method
@@ -186,9 +232,40 @@ namespace splashkit_lib
         void * _socket;
     };
 
+    // An encoded message waiting to be sent. Broadcasts share one buffer
+    // between all of the connections they are queued on.
+    typedef std::shared_ptr<const vector<char>> sk_send_buffer;
+
+    // A datagram read by sk_read_udp_messages. The data points into the
+    // reading thread's packet ring, and is only valid until its next read.
+    struct sk_udp_datagram
+    {
+        unsigned int host;
+        unsigned short port;
+        const char *data;
+        unsigned long size;
+    };
+
+    // A resolved UDP destination. The address and port are kept in network
+    // byte order, ready to be sent to without parsing or resolving again.
+    struct sk_udp_endpoint_data
+    {
+        pointer_identifier id;
+        string host;
+        unsigned short port;
+        unsigned int address;
+        unsigned short address_port;
+    };
+
+    struct sk_server_data;
+
     struct sk_connection_data
     {
         pointer_identifier id;
+        unsigned int number;                // slot and generation, see connection_id
+        sk_server_data *server;             // the server that accepted this connection
+        unsigned int server_index;          // position in the server's connections
+        int shard;                          // the poll set the connection is watched by
         string name;
         sk_network_connection socket;
         unsigned int ip;
@@ -196,9 +273,30 @@ namespace splashkit_lib
         bool open;
         connection_type protocol;
         string string_ip;    // TODO should this be stored?
-        vector<sk_message*> messages;
-        long int expected_msg_len;      // We are part way through... a message this length
-        vector<int8_t> part_msg_data;
+        sk_udp_endpoint_data *endpoint; // UDP connections send here
+        deque<sk_message*> messages;
+        spsc_queue<sk_message*> incoming;   // Messages read by the network thread
+        vector<int8_t> read_buffer;         // TCP bytes read, parsed into whole messages in place
+        unsigned long read_start;           // first byte not yet parsed
+        unsigned long read_end;             // end of the bytes read
+        deque<sk_send_buffer> send_queue;   // TCP messages not yet fully sent
+        unsigned long send_offset;          // bytes of the front buffer already sent
+        std::atomic<unsigned long> send_queue_bytes;    // unsent bytes across the queue
+
+        // Memory held for the connection, kept as it changes so it can be
+        // measured from any thread without the connection's locks
+        std::atomic<size_t> read_buffer_bytes;          // capacity of the read buffer
+        std::atomic<size_t> message_bytes;              // messages received and not yet read
+        unsigned long send_queue_limit;     // 0 for no limit
+        send_queue_policy send_policy;
+        bool coalesce_sends;                // queue until activity is checked
+        connection_compression compression;
+        std::atomic<bool> compression_offered;      // this end has told the peer it reads compressed messages
+        std::atomic<bool> peer_reads_compression;   // the peer has told this end the same
+        std::atomic<bool> compression_answer_due;   // the peer's notice is waiting for one from this end
+        unsigned long long bytes_before_compression;
+        unsigned long long bytes_after_compression;
+        network_stats stats;                // queue_depth and send_queue_bytes are filled in when read
     };
 
     struct sk_server_data
@@ -210,7 +308,11 @@ namespace splashkit_lib
         unsigned int new_connections;
         connection_type protocol;
         vector<sk_connection_data*> connections;
-        vector<sk_message*> messages;
+        std::mutex accept_lock;
+        vector<sk_network_connection> pending_accepts;  // accepted by the network thread
+        deque<sk_message*> messages;
+        spsc_queue<sk_message*> incoming;   // Messages read by the network thread
+        network_stats stats;                // UDP traffic, and connections that have closed
     };
 
     struct sk_message
@@ -220,11 +322,14 @@ namespace splashkit_lib
         connection_type protocol;
 
         // TCP
-        sk_connection_data* connection;
+        unsigned int connection;            // the connection_id of the sender
 
         // UDP
         string host;
         int port;
+
+        unsigned long long arrived;         // steady clock nanoseconds, for queue latency
+        int channel;                        // the reliable UDP channel, or -1
     };
 
     struct sk_http_response
@@ -236,6 +341,7 @@ namespace splashkit_lib
         unsigned long       message_size;
         http_status_code    code;
         vector<string>      headers;
+        string              filename;       // When set, the file is streamed instead of message
 
         semaphore           response_sent;
     };
@@ -256,6 +362,72 @@ namespace splashkit_lib
         sk_http_response    *response;
 
         sk_web_server       *server;
+
+        // Set while a request handler runs on the civetweb worker thread,
+        // so responses can be written directly to the connection.
+        struct mg_connection *conn;
+        bool                direct;
+        bool                responded;
+        bool                keep_alive;     // Leave the connection open after responding
+
+        // The body is read from the connection as it is asked for
+        long long           content_length; // -1 when the client did not send one
+        bool                body_complete;
+
+        // Streamed responses write their headers and data as they go
+        bool                streamed;
+        bool                chunked;
+
+        // Query parameters and headers, parsed on first lookup and sorted
+        // by name. Header names are kept in lower case.
+        bool                                parsed_fields;
+        vector<std::pair<string, string>>   query_parameters;
+        vector<std::pair<string, string>>   header_fields;
+
+        // Values captured by the route that matched the request
+        vector<std::pair<string, string>>   path_parameters;
+    };
+
+    // Data read from, or written to, a curl transfer
+    struct request_stream
+    {
+        char *body;
+        unsigned long at;
+    };
+
+    // A client request running on curl's multi interface, see web_driver.cpp
+    struct sk_http_async_request
+    {
+        pointer_identifier  id;
+        void                *handle;    // CURL *
+        void                *headers;   // curl_slist *
+
+        // Curl reads from these while the request runs, so they belong to the request
+        string              body;
+        request_stream      upload;
+        request_stream      download;
+
+        bool                done;
+        sk_http_response    *response;
+    };
+
+    // A node in a server's route trie, see web_server_driver.cpp
+    struct sk_web_route_node;
+
+    #define SK_LATENCY_BUCKETS 128
+
+    struct sk_websocket_data
+    {
+        pointer_identifier      id;
+        sk_web_server           *server;
+        string                  path;
+
+        // Guards the connection, which civetweb's close handler clears,
+        // and the messages received on civetweb's threads
+        mutex                   lock;
+        struct mg_connection    *conn;
+        deque<string>           messages;
+        string                  partial;        // Fragments of a message still arriving
     };
 
     struct sk_web_server
@@ -269,6 +441,34 @@ namespace splashkit_lib
 
         unsigned short              port;
 
+        // Optional handler called on the worker thread for each request
+        web_request_handler         *handler;
+
+        // Routes matched on the worker thread before the general handler
+        sk_web_route_node           *routes;
+        mutex                       routes_lock;
+
+        // Persistent connection settings, a zero timeout disables keep-alive
+        unsigned int                keep_alive_timeout_ms;
+        unsigned int                max_keep_alive_requests;
+
+        // Responses at least this large are compressed, 0 turns this off
+        unsigned int                compression_min_size;
+
+        // Open websockets, and those not yet fetched with web_server_next_websocket
+        mutex                           websockets_lock;
+        vector<sk_websocket_data*>      websockets;
+        deque<sk_websocket_data*>       new_websockets;
+
+        // Runtime metrics, updated on the worker threads. Latencies are
+        // counted in log scale buckets, see web_server_driver.cpp
+        atomic<unsigned long long>      requests_accepted;
+        atomic<unsigned long long>      requests_completed;
+        atomic<unsigned long long>      bytes_in;
+        atomic<unsigned long long>      bytes_out;
+        atomic<unsigned int>            latency_buckets[SK_LATENCY_BUCKETS];
+        string                          metrics_path;   // guarded by routes_lock
+
         /**
          * @brief a vector of the requests that are awaiting a response - and in the users hands.
          * These must be responded to before the server can be closed.
@@ -310,6 +510,7 @@ namespace splashkit_lib
         vector<animation_frame> frames;  // The frames of the animations within this template.
 
         vector<animation>   anim_objs;         // The animations created from this script
+        bool anims_in_order;                   // Are anim_objs sorted by address, for update_animations?
     };
 }
 #endif /* BackendTypes_h */
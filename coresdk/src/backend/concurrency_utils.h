@@ -13,6 +13,12 @@
 #include <thread>
 #include <condition_variable>
 #include <queue>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
 
 using std::mutex;
 using std::thread;
@@ -20,6 +26,7 @@ using std::condition_variable;
 using std::unique_lock;
 using std::lock_guard;
 using std::queue;
+using std::atomic;
 
 namespace splashkit_lib
 {
@@ -66,55 +73,573 @@ namespace splashkit_lib
         {
             lock_guard<mutex> lock(_mutex);
             _tokens += num;
-            _cv.notify_all();
+
+            // each token can only wake one waiter
+            if (num == 1)
+                _cv.notify_one();
+            else
+                _cv.notify_all();
+        }
+    };
+
+    /**
+     * A lock free queue for handing data from one producer thread to one
+     * consumer thread. The consumer owns the head, the producer owns the
+     * tail, and they only meet on the atomic next links.
+     */
+    template <typename T>
+    class spsc_queue
+    {
+    private:
+        struct node
+        {
+            T data;
+            atomic<node *> next;
+
+            node() : data(), next(nullptr) { }
+        };
+
+        node *_head;    // consumer side, always a consumed (dummy) node
+        node *_tail;    // producer side
+
+    public:
+        spsc_queue()
+        {
+            _head = _tail = new node();
+        }
+
+        ~spsc_queue()
+        {
+            while (_head)
+            {
+                node *next = _head->next.load(std::memory_order_relaxed);
+                delete _head;
+                _head = next;
+            }
+        }
+
+        spsc_queue(const spsc_queue &) = delete;
+        spsc_queue &operator=(const spsc_queue &) = delete;
+
+        // Called only from the producer thread
+        void push(const T &data)
+        {
+            node *n = new node();
+            n->data = data;
+            _tail->next.store(n, std::memory_order_release);
+            _tail = n;
+        }
+
+        // Called only from the consumer thread
+        bool try_pop(T &data)
+        {
+            node *next = _head->next.load(std::memory_order_acquire);
+            if ( ! next ) return false;
+
+            data = next->data;
+            delete _head;
+            _head = next;
+            return true;
+        }
+
+        bool empty() const
+        {
+            return _head->next.load(std::memory_order_acquire) == nullptr;
+        }
+    };
+
+    /**
+     * A bounded lock free queue for many producers and a single consumer.
+     * Each slot carries a sequence number that tells producers whether it
+     * is free and the consumer whether it is ready to read. The capacity
+     * is rounded up to a power of two.
+     */
+    template <typename T>
+    class mpsc_ring
+    {
+    private:
+        struct cell
+        {
+            atomic<size_t> sequence;
+            T data;
+        };
+
+        cell *_buffer;
+        size_t _mask;
+        atomic<size_t> _enqueue_pos;
+        atomic<size_t> _dequeue_pos;    // only changed by the consumer
+
+    public:
+        explicit mpsc_ring(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity) size <<= 1;
+
+            _buffer = new cell[size];
+            _mask = size - 1;
+            for (size_t i = 0; i < size; i++)
+            {
+                _buffer[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            _enqueue_pos.store(0, std::memory_order_relaxed);
+            _dequeue_pos.store(0, std::memory_order_relaxed);
+        }
+
+        ~mpsc_ring()
+        {
+            delete[] _buffer;
+        }
+
+        mpsc_ring(const mpsc_ring &) = delete;
+        mpsc_ring &operator=(const mpsc_ring &) = delete;
+
+        size_t capacity() const
+        {
+            return _mask + 1;
+        }
+
+        // Called from any thread, returns false when the ring is full
+        bool try_push(T &&data)
+        {
+            size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+            cell *c;
+
+            for (;;)
+            {
+                c = &_buffer[pos & _mask];
+                size_t seq = c->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+                if (diff == 0)
+                {
+                    if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = _enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            c->data = std::move(data);
+            c->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Called only from the consumer thread
+        bool try_pop(T &data)
+        {
+            size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+            cell *c = &_buffer[pos & _mask];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+
+            if (seq != pos + 1) return false;
+
+            data = std::move(c->data);
+            c->sequence.store(pos + _mask + 1, std::memory_order_release);
+            _dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // An estimate, as producers may be adding at the same time
+        size_t size() const
+        {
+            return _enqueue_pos.load(std::memory_order_relaxed) - _dequeue_pos.load(std::memory_order_relaxed);
+        }
+    };
+
+    /**
+     * A bounded lock free queue for many producers and many consumers. It
+     * works like `mpsc_ring`, but consumers also claim their slot with a
+     * compare and swap, so any thread may pop. The capacity is rounded up
+     * to a power of two.
+     */
+    template <typename T>
+    class mpmc_ring
+    {
+    private:
+        struct cell
+        {
+            atomic<size_t> sequence;
+            T data;
+        };
+
+        cell *_buffer;
+        size_t _mask;
+        alignas(64) atomic<size_t> _enqueue_pos;
+        alignas(64) atomic<size_t> _dequeue_pos;
+
+    public:
+        explicit mpmc_ring(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity) size <<= 1;
+
+            _buffer = new cell[size];
+            _mask = size - 1;
+            for (size_t i = 0; i < size; i++)
+            {
+                _buffer[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            _enqueue_pos.store(0, std::memory_order_relaxed);
+            _dequeue_pos.store(0, std::memory_order_relaxed);
+        }
+
+        ~mpmc_ring()
+        {
+            delete[] _buffer;
+        }
+
+        mpmc_ring(const mpmc_ring &) = delete;
+        mpmc_ring &operator=(const mpmc_ring &) = delete;
+
+        size_t capacity() const
+        {
+            return _mask + 1;
+        }
+
+        // Called from any thread, returns false when the ring is full
+        bool try_push(T &&data)
+        {
+            size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+            cell *c;
+
+            for (;;)
+            {
+                c = &_buffer[pos & _mask];
+                size_t seq = c->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+                if (diff == 0)
+                {
+                    if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = _enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            c->data = std::move(data);
+            c->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Called from any thread, returns false when the ring is empty
+        bool try_pop(T &data)
+        {
+            size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+            cell *c;
+
+            for (;;)
+            {
+                c = &_buffer[pos & _mask];
+                size_t seq = c->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+                if (diff == 0)
+                {
+                    if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = _dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            data = std::move(c->data);
+            c->sequence.store(pos + _mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        // An estimate, as other threads may be adding and removing at the same time
+        size_t size() const
+        {
+            size_t in = _enqueue_pos.load(std::memory_order_relaxed);
+            size_t out = _dequeue_pos.load(std::memory_order_relaxed);
+            return in > out ? in - out : 0;
         }
     };
 
+    /**
+     * A queue that any number of threads can put to and take from, with
+     * take waiting for data to arrive. Data passes through a lock free
+     * ring, so put and take do not lock unless the ring is full or a taker
+     * has to sleep. Data put while the ring is full waits in a locked
+     * overflow queue. Data arrives in order from each thread. Once closed,
+     * the data already put can still be taken, and then take returns a
+     * default value rather than waiting.
+     */
     template <typename T>
     class channel
     {
     private:
-        queue<T> _queue;
-        semaphore _take_permission;
-        mutex _mutex;
+        mpmc_ring<T> _ring;
+        queue<T> _overflow;
+        mutex _overflow_lock;
+        atomic<size_t> _overflow_count;
 
-        T dequeue()
+        atomic<size_t> _available;      // data put and not yet claimed by a taker
+        atomic<int> _waiters;           // takers that are, or are about to be, asleep
+        atomic<bool> _closed;
+        mutex _wait_lock;
+        condition_variable _wake;
+
+        // Take the data this thread has claimed, which is in the ring or the
+        // overflow queue once its put has finished
+        T _take_claimed()
         {
-            T data = _queue.front();
-            _queue.pop();
-            return data;
+            T data;
+
+            while (true)
+            {
+                if (_ring.try_pop(data)) return data;
+
+                if (_overflow_count.load() > 0)
+                {
+                    lock_guard<mutex> lock(_overflow_lock);
+                    if ( ! _overflow.empty() )
+                    {
+                        data = std::move(_overflow.front());
+                        _overflow.pop();
+                        _overflow_count--;
+                        return data;
+                    }
+                }
+
+                std::this_thread::yield();
+            }
         }
 
     public:
-        void put(T data)
+        explicit channel(size_t capacity = 1024) : _ring(capacity), _overflow_count(0), _available(0), _waiters(0), _closed(false)
         {
-            unique_lock<mutex> lock(_mutex);
-            _queue.push(data);
-            lock.unlock();
+        }
+
+        channel(const channel &) = delete;
+        channel &operator=(const channel &) = delete;
+
+        // Returns false, and drops the data, if the channel is closed
+        bool put(T data)
+        {
+            if (_closed.load()) return false;
+
+            // once data overflows, keep adding behind it so it is taken in order
+            if (_overflow_count.load() > 0 || ! _ring.try_push(std::move(data)))
+            {
+                lock_guard<mutex> lock(_overflow_lock);
+                _overflow.push(std::move(data));
+                _overflow_count++;
+            }
+
+            _available++;
 
-            _take_permission.release();
+            if (_waiters.load() > 0)
+            {
+                lock_guard<mutex> lock(_wait_lock);
+                _wake.notify_one();
+            }
+
+            return true;
         }
 
+        // Waits for data, or returns a default value once closed and empty
         T take()
         {
-            _take_permission.acquire();
-            
-            lock_guard<mutex> lock(_mutex);
-            return dequeue();
+            T data;
+
+            while ( ! try_take(data) )
+            {
+                unique_lock<mutex> lock(_wait_lock);
+                _waiters++;
+                _wake.wait(lock, [this] { return _available.load() > 0 || _closed.load(); });
+                _waiters--;
+
+                if (_closed.load() && _available.load() == 0) return T();
+            }
+
+            return data;
         }
-        
+
+        // Stop accepting data, and wake every taker that is waiting
+        void close()
+        {
+            {
+                lock_guard<mutex> lock(_wait_lock);
+                _closed = true;
+            }
+            _wake.notify_all();
+        }
+
+        bool closed() const
+        {
+            return _closed.load();
+        }
+
+        size_t size() const
+        {
+            return _available.load();
+        }
+
         bool try_take(T& data)
         {
-            if (_take_permission.try_acquire())
+            size_t count = _available.load();
+
+            do
+            {
+                if (count == 0) return false;
+            } while ( ! _available.compare_exchange_weak(count, count - 1) );
+
+            data = _take_claimed();
+            return true;
+        }
+    };
+
+    /**
+     * A fixed set of threads that run queued jobs, in the order they are
+     * added. Jobs are passed through a channel, so adding does not lock
+     * unless its ring is full, when jobs wait in its overflow queue. A pool
+     * with one thread runs its jobs one at a time, in order.
+     */
+    class worker_pool
+    {
+    private:
+        std::vector<thread> _threads;
+        channel<std::function<void()>> _jobs;
+
+        void _run()
+        {
+            while (true)
+            {
+                std::function<void()> job = _jobs.take();
+
+                // an empty job is only added to stop the thread
+                if ( ! job ) return;
+
+                job();
+            }
+        }
+
+    public:
+        explicit worker_pool(unsigned int threads) : _jobs(4096)
+        {
+            if (threads == 0) threads = 1;
+            for (unsigned int i = 0; i < threads; i++)
             {
-                lock_guard<mutex> lock(_mutex);
-                data = dequeue();
-                return true;
+                _threads.emplace_back(&worker_pool::_run, this);
             }
-            
-            return false;
         }
-        
+
+        ~worker_pool()
+        {
+            // queued behind the waiting jobs, so those still run
+            for (size_t i = 0; i < _threads.size(); i++)
+            {
+                _jobs.put(std::function<void()>());
+            }
+
+            for (thread &t : _threads)
+            {
+                if (t.joinable()) t.join();
+            }
+        }
+
+        worker_pool(const worker_pool &) = delete;
+        worker_pool &operator=(const worker_pool &) = delete;
+
+        void add(std::function<void()> job)
+        {
+            if ( ! job ) return;
+            _jobs.put(std::move(job));
+        }
+
+        size_t thread_count() const
+        {
+            return _threads.size();
+        }
+
+        // An estimate of the jobs waiting to start
+        size_t queued() const
+        {
+            return _jobs.size();
+        }
     };
+
+    /**
+     * The pool shared by the library's parallel work and by user jobs, with
+     * a thread for each core but the calling one. Never destroyed, so the
+     * threads outlive any static cleanup at exit.
+     */
+    inline worker_pool &shared_worker_pool()
+    {
+        static worker_pool *pool = new worker_pool(std::max(2u, thread::hardware_concurrency()) - 1);
+        return *pool;
+    }
+
+    /**
+     * Call fn for each chunk of grain items in [0, count), on the pool's
+     * threads and the calling thread. Each thread takes the next chunk no
+     * one has claimed, so threads that finish early pick up the remaining
+     * work. fn is passed the chunk's first and end index and the chunk's
+     * number. Returns once every chunk has run.
+     */
+    inline void parallel_for(worker_pool &pool, size_t count, size_t grain, const std::function<void(size_t, size_t, size_t)> &fn)
+    {
+        if (grain == 0) grain = 1;
+        size_t chunks = (count + grain - 1) / grain;
+        if (chunks == 0) return;
+
+        struct progress
+        {
+            atomic<size_t> next{0};
+            atomic<size_t> done{0};
+            mutex lock;
+            condition_variable finished;
+        };
+        auto state = std::make_shared<progress>();
+
+        // Helpers that start after the work is done claim nothing, so they
+        // never call fn once this has returned
+        auto run = [state, chunks, count, grain, &fn]()
+        {
+            size_t chunk;
+            while ((chunk = state->next.fetch_add(1)) < chunks)
+            {
+                size_t begin = chunk * grain;
+                fn(begin, std::min(begin + grain, count), chunk);
+
+                if (state->done.fetch_add(1) + 1 == chunks)
+                {
+                    lock_guard<mutex> guard(state->lock);
+                    state->finished.notify_all();
+                }
+            }
+        };
+
+        size_t helpers = std::min(pool.thread_count(), chunks - 1);
+        for (size_t i = 0; i < helpers; i++)
+        {
+            pool.add(run);
+        }
+
+        run();
+
+        unique_lock<mutex> guard(state->lock);
+        state->finished.wait(guard, [&state, chunks] { return state->done.load() == chunks; });
+    }
 }
 #endif // sgsdl2_SGSDL2ConcurrencyUtils_h
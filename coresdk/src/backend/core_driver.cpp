@@ -21,6 +21,7 @@
 
 #include "audio_driver.h"
 #include "web_driver.h"
+#include "utility_functions.h"
 
 #include "easylogging++.h"
 
@@ -32,11 +33,38 @@ namespace splashkit_lib
     void sk_setup_displays();
     void _init_key_maps();
 
+    static bool _sk_done_init = false;
+    static bool _sk_headless_requested = false;
+
+    void sk_set_headless(bool value)
+    {
+        if ( _sk_done_init )
+        {
+            LOG(WARNING) << "Headless rendering must be selected before SplashKit is used";
+            return;
+        }
+
+        _sk_headless_requested = value;
+    }
+
+    bool sk_headless()
+    {
+        return _sk_headless_requested || get_env_var("SPLASHKIT_HEADLESS") == "1";
+    }
+
     void internal_sk_init()
     {
-        static bool done_init = false;
-        if ( done_init ) return;
-        done_init = true;
+        if ( _sk_done_init ) return;
+        _sk_done_init = true;
+
+        // Headless processes use SDL's dummy drivers, so they need no display
+        // or audio device and can run side by side on a render server
+        if ( sk_headless() )
+        {
+            SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+            SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+            SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+        }
 
         el::Loggers::reconfigureAllLoggers(el::ConfigurationType::Format, "%datetime %level: %msg");
 
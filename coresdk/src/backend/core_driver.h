@@ -52,5 +52,9 @@ namespace splashkit_lib
     sk_system_data *sk_read_system_data();
     
     void internal_sk_init();
+
+    // Render in software without a window system, must be called before SplashKit is initialised
+    void sk_set_headless(bool value);
+    bool sk_headless();
 }
 #endif /* defined(sk__CoreDriver) */
@@ -0,0 +1,183 @@
+//
+//  file_view.cpp
+//  splashkit
+//
+//  A read only view of a whole file, memory mapped where the platform
+//  supports it, so large files are read without copying.
+//
+
+#include "file_view.h"
+
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace splashkit_lib
+{
+    file_view::file_view(const string &path, bool map)
+    {
+        open(path, map);
+    }
+
+    file_view::~file_view()
+    {
+        _close();
+    }
+
+    file_view::file_view(file_view &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    file_view &file_view::operator=(file_view &&other) noexcept
+    {
+        if ( this == &other ) return *this;
+
+        _close();
+
+        _open = other._open;
+        _mapped = other._mapped;
+        _size = other._size;
+        _buffer = std::move(other._buffer);
+        _data = _mapped ? other._data : _buffer.data();
+#ifdef _WIN32
+        _file = other._file;
+        _mapping = other._mapping;
+        other._file = nullptr;
+        other._mapping = nullptr;
+#endif
+
+        other._data = nullptr;
+        other._size = 0;
+        other._open = false;
+        other._mapped = false;
+        return *this;
+    }
+
+    void file_view::_close()
+    {
+        if ( _mapped && _data )
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(_data);
+#else
+            munmap(const_cast<char *>(_data), _size);
+#endif
+        }
+
+#ifdef _WIN32
+        if ( _mapping ) CloseHandle(_mapping);
+        if ( _file ) CloseHandle(_file);
+        _mapping = nullptr;
+        _file = nullptr;
+#endif
+
+        _buffer.clear();
+        _data = nullptr;
+        _size = 0;
+        _open = false;
+        _mapped = false;
+    }
+
+    bool file_view::open(const string &path, bool map)
+    {
+        _close();
+        if ( ! map ) return _read(path);
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if ( file != INVALID_HANDLE_VALUE )
+        {
+            LARGE_INTEGER size;
+            if ( GetFileSizeEx(file, &size) )
+            {
+                _open = true;
+                _size = static_cast<size_t>(size.QuadPart);
+
+                // Empty files cannot be mapped, but are still open
+                if ( _size == 0 )
+                {
+                    CloseHandle(file);
+                    return true;
+                }
+
+                HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+                if ( data )
+                {
+                    _file = file;
+                    _mapping = mapping;
+                    _data = static_cast<const char *>(data);
+                    _mapped = true;
+                    return true;
+                }
+
+                if ( mapping ) CloseHandle(mapping);
+                _open = false;
+                _size = 0;
+            }
+            CloseHandle(file);
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if ( fd >= 0 )
+        {
+            struct stat info;
+            bool ok = fstat(fd, &info) == 0;
+
+            if ( ok && S_ISDIR(info.st_mode) )
+            {
+                ::close(fd);
+                return false;
+            }
+
+            // Pseudo files report a size of 0, so empty files are read below
+            if ( ok && S_ISREG(info.st_mode) && info.st_size > 0 )
+            {
+                size_t size = static_cast<size_t>(info.st_size);
+
+                // The mapping stays valid after the descriptor is closed
+                void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if ( data != MAP_FAILED )
+                {
+#ifdef MADV_SEQUENTIAL
+                    madvise(data, size, MADV_SEQUENTIAL);
+#endif
+                    ::close(fd);
+                    _data = static_cast<const char *>(data);
+                    _size = size;
+                    _mapped = true;
+                    _open = true;
+                    return true;
+                }
+            }
+
+            ::close(fd);
+        }
+#endif
+
+        // Fall back to reading the file, for files that cannot be mapped
+        return _read(path);
+    }
+
+    bool file_view::_read(const string &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if ( ! in ) return false;
+
+        _buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        _data = _buffer.data();
+        _size = _buffer.size();
+        _open = true;
+        return true;
+    }
+}
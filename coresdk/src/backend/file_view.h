@@ -0,0 +1,63 @@
+//
+//  file_view.h
+//  splashkit
+//
+//  A read only view of a whole file, memory mapped where the platform
+//  supports it, so large files are read without copying. Reading a mapped
+//  file after it has been truncated raises SIGBUS, so views that are kept
+//  while the file may change should read the file into memory instead.
+//
+
+#ifndef SPLASHKIT_FILE_VIEW_H
+#define SPLASHKIT_FILE_VIEW_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+
+namespace splashkit_lib
+{
+    class file_view
+    {
+    private:
+        const char *_data = nullptr;
+        size_t _size = 0;
+        bool _open = false;
+        bool _mapped = false;   // false when the contents were read into _buffer
+        string _buffer;
+#ifdef _WIN32
+        void *_file = nullptr;
+        void *_mapping = nullptr;
+#endif
+
+        void _close();
+        bool _read(const string &path);
+
+    public:
+        file_view() = default;
+        explicit file_view(const string &path, bool map = true);
+        ~file_view();
+
+        file_view(const file_view &) = delete;
+        file_view &operator=(const file_view &) = delete;
+        file_view(file_view &&other) noexcept;
+        file_view &operator=(file_view &&other) noexcept;
+
+        /**
+         * Map the file at `path`, replacing any file already viewed, or read
+         * it into memory when `map` is false. Returns false if the file
+         * could not be opened.
+         */
+        bool open(const string &path, bool map = true);
+
+        bool is_open() const { return _open; }
+        const char *data() const { return _data; }
+        size_t size() const { return _size; }
+        string_view view() const { return string_view(_data ? _data : "", _size); }
+    };
+}
+
+#endif //SPLASHKIT_FILE_VIEW_H
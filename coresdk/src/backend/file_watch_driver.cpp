@@ -0,0 +1,186 @@
+//
+//  file_watch_driver.cpp
+//  splashkit
+//
+//  Uses inotify on Linux. Other platforms check the modification times of
+//  the watched files every FILE_WATCH_POLL_MS instead.
+//
+
+#include "file_watch_driver.h"
+#include "utils_driver.h"
+#include "utility_functions.h"
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using std::map;
+using std::mutex;
+using std::lock_guard;
+
+// How often the watch thread checks whether it has been asked to stop
+#define FILE_WATCH_WAKE_MS 100
+// How often files are checked when there is no change notification API
+#define FILE_WATCH_POLL_MS 500
+
+namespace splashkit_lib
+{
+    static mutex _watch_lock;
+    static std::set<string> _changed_files;
+    static std::thread _watch_thread;
+    static std::atomic<bool> _watch_running(false);
+
+    static void _record_change(const string &path)
+    {
+        {
+            lock_guard<mutex> guard(_watch_lock);
+            _changed_files.insert(path);
+        }
+
+        sk_signal_activity();
+    }
+
+#ifdef __linux__
+    static void _watch_with_inotify(int fd, vector<string> directories)
+    {
+        map<int, string> watched;
+
+        auto add_directory = [&](const string &dir)
+        {
+            for (const string &sub : scan_dir_recursive(dir))
+            {
+                int wd = inotify_add_watch(fd, sub.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+                if ( wd >= 0 ) watched[wd] = sub;
+            }
+        };
+
+        for (const string &dir : directories)
+            add_directory(dir);
+
+        alignas(inotify_event) char buffer[16384];
+
+        while ( _watch_running )
+        {
+            pollfd pfd = { fd, POLLIN, 0 };
+            if ( poll(&pfd, 1, FILE_WATCH_WAKE_MS) <= 0 ) continue;
+
+            ssize_t len = read(fd, buffer, sizeof(buffer));
+            if ( len <= 0 ) continue;
+
+            for (char *p = buffer; p < buffer + len; )
+            {
+                const inotify_event *evt = reinterpret_cast<const inotify_event *>(p);
+                p += sizeof(inotify_event) + evt->len;
+
+                auto it = watched.find(evt->wd);
+                if ( it == watched.end() || evt->len == 0 ) continue;
+
+                string path = path_from({ it->second }, evt->name);
+
+                if ( evt->mask & IN_ISDIR )
+                {
+                    // New folders are watched too
+                    if ( evt->mask & (IN_CREATE | IN_MOVED_TO) ) add_directory(path);
+                }
+                else if ( evt->mask & (IN_CLOSE_WRITE | IN_MOVED_TO) )
+                {
+                    // Created files are reported once they are written and closed
+                    _record_change(path);
+                }
+            }
+        }
+
+        close(fd);
+    }
+#endif
+
+    static void _watch_by_polling(vector<string> directories)
+    {
+        map<string, std::filesystem::file_time_type> seen;
+        bool first = true;
+
+        while ( _watch_running )
+        {
+            for (const string &dir : directories)
+            {
+                std::error_code ec;
+                for (const auto &entry : std::filesystem::recursive_directory_iterator(dir, ec))
+                {
+                    if ( ! entry.is_regular_file(ec) ) continue;
+
+                    auto modified = entry.last_write_time(ec);
+                    if ( ec ) continue;
+
+                    string path = entry.path().string();
+                    auto it = seen.find(path);
+
+                    if ( it == seen.end() )
+                    {
+                        seen[path] = modified;
+                        if ( ! first ) _record_change(path);
+                    }
+                    else if ( it->second != modified )
+                    {
+                        it->second = modified;
+                        _record_change(path);
+                    }
+                }
+            }
+
+            first = false;
+
+            for (int waited = 0; waited < FILE_WATCH_POLL_MS && _watch_running; waited += FILE_WATCH_WAKE_MS)
+                std::this_thread::sleep_for(std::chrono::milliseconds(FILE_WATCH_WAKE_MS));
+        }
+    }
+
+    void sk_start_file_watch(const vector<string> &directories)
+    {
+        sk_stop_file_watch();
+
+        _watch_running = true;
+
+#ifdef __linux__
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if ( fd >= 0 )
+        {
+            _watch_thread = std::thread(_watch_with_inotify, fd, directories);
+            return;
+        }
+#endif
+
+        _watch_thread = std::thread(_watch_by_polling, directories);
+    }
+
+    void sk_stop_file_watch()
+    {
+        _watch_running = false;
+        if ( _watch_thread.joinable() ) _watch_thread.join();
+
+        lock_guard<mutex> guard(_watch_lock);
+        _changed_files.clear();
+    }
+
+    bool sk_file_watch_running()
+    {
+        return _watch_running;
+    }
+
+    vector<string> sk_take_changed_files()
+    {
+        lock_guard<mutex> guard(_watch_lock);
+
+        vector<string> result(_changed_files.begin(), _changed_files.end());
+        _changed_files.clear();
+        return result;
+    }
+}
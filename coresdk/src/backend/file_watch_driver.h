@@ -0,0 +1,29 @@
+//
+//  file_watch_driver.h
+//  splashkit
+//
+//  Watches directories for files that are written or replaced.
+//
+
+#ifndef SPLASHKIT_FILE_WATCH_DRIVER_H
+#define SPLASHKIT_FILE_WATCH_DRIVER_H
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace splashkit_lib
+{
+    // Start watching the directories, and the directories within them, on a
+    // background thread. Any existing watch is stopped first.
+    void sk_start_file_watch(const vector<string> &directories);
+    void sk_stop_file_watch();
+    bool sk_file_watch_running();
+
+    // The files changed since the last call, each listed once
+    vector<string> sk_take_changed_files();
+}
+
+#endif //SPLASHKIT_FILE_WATCH_DRIVER_H
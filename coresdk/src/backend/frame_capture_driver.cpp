@@ -0,0 +1,235 @@
+//
+//  frame_capture_driver.cpp
+//  splashkit
+//
+//  SDL_Renderer has no asynchronous readback, so each captured frame is read
+//  as the window refreshes. Everything after that, including any encoding
+//  the sink does, runs on the capture thread. When the sink falls behind and
+//  every buffer in the ring is full, frames are dropped instead of stalling
+//  the window.
+//
+
+#include "frame_capture_driver.h"
+#include "graphics_driver.h"
+#include "concurrency_utils.h"
+
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using std::map;
+using std::unique_ptr;
+using std::vector;
+
+// Buffers used when a capture asks for fewer than one
+#define SK_CAPTURE_DEFAULT_BUFFERS 3
+
+namespace splashkit_lib
+{
+    struct _sk_capture_slot
+    {
+        vector<uint8_t> pixels;
+        int width = 0, height = 0;
+        long long frame = 0;
+    };
+
+    struct _sk_frame_capture
+    {
+        vector<_sk_capture_slot> slots;
+        channel<int> free_slots;
+        channel<int> filled;        // -1 asks the capture thread to stop
+        sk_frame_sink sink;
+        std::function<void()> close;
+        std::thread worker;
+
+        long long next_frame = 0;
+        std::atomic<long long> captured{0};
+        std::atomic<long long> dropped{0};
+    };
+
+    // Captures are started, stopped and read from the main thread only
+    static map<void *, unique_ptr<_sk_frame_capture>> _sk_captures;
+
+    static _sk_frame_capture *_sk_capture_for(sk_drawing_surface *window)
+    {
+        if ( ! window || window->kind != SGDS_Window ) return nullptr;
+
+        auto it = _sk_captures.find(window->_data);
+        return it == _sk_captures.end() ? nullptr : it->second.get();
+    }
+
+    static void _sk_deliver_frames(_sk_frame_capture *capture)
+    {
+        int idx;
+        while ( (idx = capture->filled.take()) >= 0 )
+        {
+            _sk_capture_slot &slot = capture->slots[static_cast<size_t>(idx)];
+            capture->sink(slot.pixels.data(), slot.width, slot.height, slot.frame);
+            capture->free_slots.put(idx);
+        }
+    }
+
+    bool sk_start_frame_capture(sk_drawing_surface *window, int buffers, sk_frame_sink sink)
+    {
+        if ( ! window || window->kind != SGDS_Window || ! window->_data || ! sink ) return false;
+
+        sk_stop_frame_capture(window);
+
+        if ( buffers < 1 ) buffers = SK_CAPTURE_DEFAULT_BUFFERS;
+
+        unique_ptr<_sk_frame_capture> capture(new _sk_frame_capture());
+        capture->slots.resize(static_cast<size_t>(buffers));
+        for (int i = 0; i < buffers; i++) capture->free_slots.put(i);
+
+        capture->sink = sink;
+        capture->worker = std::thread(_sk_deliver_frames, capture.get());
+
+        _sk_captures[window->_data] = std::move(capture);
+        return true;
+    }
+
+    bool sk_start_frame_capture_to_file(sk_drawing_surface *window, int buffers, const char *destination)
+    {
+        if ( ! window || window->kind != SGDS_Window || ! window->_data || ! destination ) return false;
+
+        string dest = destination;
+        FILE *out;
+        bool piped = false;
+
+        if ( dest == "-" )
+            out = stdout;
+        else if ( ! dest.empty() && dest[0] == '|' )
+        {
+#ifdef _WIN32
+            out = _popen(dest.c_str() + 1, "wb");
+#else
+            out = popen(dest.c_str() + 1, "w");
+#endif
+            piped = true;
+        }
+        else
+            out = fopen(destination, "wb");
+
+        if ( ! out ) return false;
+
+        // After a failed write, such as the reader closing the pipe, later frames are skipped
+        auto failed = std::make_shared<std::atomic<bool>>(false);
+
+        sk_frame_sink sink = [out, failed](const void *pixels, int width, int height, long long)
+        {
+            if ( *failed ) return;
+
+            size_t sz = static_cast<size_t>(width) * height * 4;
+            if ( fwrite(pixels, 1, sz, out) != sz ) *failed = true;
+        };
+
+        if ( ! sk_start_frame_capture(window, buffers, sink) )
+        {
+            if ( piped )
+            {
+#ifdef _WIN32
+                _pclose(out);
+#else
+                pclose(out);
+#endif
+            }
+            else if ( out != stdout ) fclose(out);
+
+            return false;
+        }
+
+        _sk_captures[window->_data]->close = [out, piped]()
+        {
+            if ( piped )
+            {
+#ifdef _WIN32
+                _pclose(out);
+#else
+                pclose(out);
+#endif
+            }
+            else if ( out == stdout ) fflush(out);
+            else fclose(out);
+        };
+
+        return true;
+    }
+
+    void sk_stop_frame_capture(sk_drawing_surface *window)
+    {
+        _sk_frame_capture *capture = _sk_capture_for(window);
+        if ( ! capture ) return;
+
+        capture->filled.put(-1);
+        if ( capture->worker.joinable() ) capture->worker.join();
+        if ( capture->close ) capture->close();
+
+        _sk_captures.erase(window->_data);
+    }
+
+    void sk_stop_all_frame_captures()
+    {
+        while ( ! _sk_captures.empty() )
+        {
+            sk_drawing_surface window = { SGDS_Window, 0, 0, _sk_captures.begin()->first };
+            sk_stop_frame_capture(&window);
+        }
+    }
+
+    bool sk_frame_capture_active(sk_drawing_surface *window)
+    {
+        return _sk_capture_for(window) != nullptr;
+    }
+
+    long long sk_frames_captured(sk_drawing_surface *window)
+    {
+        _sk_frame_capture *capture = _sk_capture_for(window);
+        return capture ? capture->captured.load() : 0;
+    }
+
+    long long sk_frames_dropped(sk_drawing_surface *window)
+    {
+        _sk_frame_capture *capture = _sk_capture_for(window);
+        return capture ? capture->dropped.load() : 0;
+    }
+
+    void sk_capture_window_frame(sk_window_be *window_be)
+    {
+        if ( _sk_captures.empty() ) return;
+
+        auto it = _sk_captures.find(window_be);
+        if ( it == _sk_captures.end() || ! window_be->backing ) return;
+
+        _sk_frame_capture &capture = *it->second;
+
+        // Frame numbers count dropped frames, so the sink can see the gaps
+        long long frame = capture.next_frame++;
+
+        int idx;
+        if ( ! capture.free_slots.try_take(idx) )
+        {
+            capture.dropped++;
+            return;
+        }
+
+        _sk_capture_slot &slot = capture.slots[static_cast<size_t>(idx)];
+
+        // the backing texture may be larger than the window
+        int w = window_be->width, h = window_be->height;
+        SDL_Rect area = { 0, 0, w, h };
+
+        slot.width = w;
+        slot.height = h;
+        slot.frame = frame;
+        slot.pixels.resize(static_cast<size_t>(w) * h * 4);
+
+        _sk_restore_default_render_target(window_be);
+        SDL_RenderReadPixels(window_be->renderer, &area, SDL_PIXELFORMAT_RGBA32, slot.pixels.data(), w * 4);
+
+        capture.captured++;
+        capture.filled.put(idx);
+    }
+}
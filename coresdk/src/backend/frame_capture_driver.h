@@ -0,0 +1,44 @@
+//
+//  frame_capture_driver.h
+//  splashkit
+//
+//  Records each frame a window shows, handing the pixels to a callback or
+//  writing them to a file or pipe from a background thread.
+//
+
+#ifndef SPLASHKIT_FRAME_CAPTURE_DRIVER_H
+#define SPLASHKIT_FRAME_CAPTURE_DRIVER_H
+
+#include "backend_types.h"
+
+#include <functional>
+
+namespace splashkit_lib
+{
+    struct sk_window_be;
+
+    // Receives each frame on the capture thread. Pixels are 4 bytes each in
+    // R, G, B, A order, and are only valid during the call.
+    typedef std::function<void(const void *pixels, int width, int height, long long frame)> sk_frame_sink;
+
+    // Start capturing with a ring of buffers, so the window can run ahead of
+    // the sink by that many frames. Any existing capture is stopped first.
+    bool sk_start_frame_capture(sk_drawing_surface *window, int buffers, sk_frame_sink sink);
+
+    // Write raw frames to a file, to stdout for "-", or to the input of a
+    // command when the destination starts with "|"
+    bool sk_start_frame_capture_to_file(sk_drawing_surface *window, int buffers, const char *destination);
+
+    // Waits for the frames already read to reach the sink
+    void sk_stop_frame_capture(sk_drawing_surface *window);
+    void sk_stop_all_frame_captures();
+    bool sk_frame_capture_active(sk_drawing_surface *window);
+
+    long long sk_frames_captured(sk_drawing_surface *window);
+    long long sk_frames_dropped(sk_drawing_surface *window);
+
+    // Called as the window is refreshed, while its backing texture holds the frame
+    void sk_capture_window_frame(sk_window_be *window_be);
+}
+
+#endif //SPLASHKIT_FRAME_CAPTURE_DRIVER_H
@@ -10,6 +10,10 @@
 
 #ifdef RASPBERRY_PI
 #include "pigpiod_if2.h"
+#include "utils_driver.h"
+
+#include <mutex>
+#include <vector>
 
 
 using namespace std;
@@ -57,6 +61,26 @@ namespace splashkit_lib
                 gpio_write(pi, pin, value);
         }
 
+        // Read the levels of GPIO 0-31 in one request to the daemon
+        uint32_t sk_gpio_read_bank()
+        {
+
+                if (check_pi())
+                {
+                        return read_bank_1(pi);
+                }
+                return 0;
+        }
+
+        // Clear, then set, the GPIO 0-31 levels in the masks
+        void sk_gpio_write_bank(uint32_t set, uint32_t clear)
+        {
+
+                check_pi();
+                if (clear) clear_bank_1(pi, clear);
+                if (set) set_bank_1(pi, set);
+        }
+
         // Set the mode of a GPIO pin
         void sk_gpio_set_mode(int pin, int mode)
         {
@@ -96,6 +120,148 @@ namespace splashkit_lib
                 set_PWM_dutycycle(pi, pin, dutycycle);
         }
 
+        void sk_gpio_hardware_pwm(int pin, int frequency, int dutycycle)
+        {
+
+                check_pi();
+                hardware_PWM(pi, pin, frequency, dutycycle);
+        }
+
+        // The daemon keeps created waves until they are deleted
+        static int _wave_id = -1;
+
+        int sk_wave_send(const vector<sk_gpio_pulse> &pulses, bool repeat)
+        {
+
+                if (!check_pi() || pulses.empty()) return -1;
+
+                vector<gpioPulse_t> wave;
+                wave.reserve(pulses.size());
+                for (const sk_gpio_pulse &p : pulses)
+                {
+                        wave.push_back({p.set, p.clear, p.delay_us});
+                }
+
+                // a wave cannot be deleted while it is being sent
+                wave_tx_stop(pi);
+                if (_wave_id >= 0) wave_delete(pi, _wave_id);
+                _wave_id = -1;
+
+                wave_add_new(pi);
+                if (wave_add_generic(pi, wave.size(), wave.data()) < 0) return -1;
+
+                _wave_id = wave_create(pi);
+                if (_wave_id < 0) return _wave_id;
+
+                return repeat ? wave_send_repeat(pi, _wave_id) : wave_send_once(pi, _wave_id);
+        }
+
+        bool sk_wave_busy()
+        {
+
+                return check_pi() && wave_tx_busy(pi) == 1;
+        }
+
+        void sk_wave_stop()
+        {
+
+                check_pi();
+                wave_tx_stop(pi);
+        }
+
+        int sk_spi_open(int channel, int speed, int flags)
+        {
+
+                if (!check_pi()) return -1;
+                return spi_open(pi, channel, speed, flags);
+        }
+
+        void sk_spi_close(int handle)
+        {
+
+                check_pi();
+                spi_close(pi, handle);
+        }
+
+        // Full duplex, the received bytes replace the sent bytes in the buffer
+        int sk_spi_transfer(int handle, char *buffer, int count)
+        {
+
+                if (!check_pi()) return -1;
+                return spi_xfer(pi, handle, buffer, buffer, count);
+        }
+
+        int sk_i2c_open(int bus, int address, int flags)
+        {
+
+                if (!check_pi()) return -1;
+                return i2c_open(pi, bus, address, flags);
+        }
+
+        void sk_i2c_close(int handle)
+        {
+
+                check_pi();
+                i2c_close(pi, handle);
+        }
+
+        int sk_i2c_read_block(int handle, int reg, char *buffer, int count)
+        {
+
+                if (!check_pi()) return -1;
+                return i2c_read_i2c_block_data(pi, handle, reg, buffer, count);
+        }
+
+        int sk_i2c_write_block(int handle, int reg, char *buffer, int count)
+        {
+
+                if (!check_pi()) return -1;
+                return i2c_write_i2c_block_data(pi, handle, reg, buffer, count);
+        }
+
+        // Edges are reported on the daemon's callback thread, and queued
+        // until the program processes events
+        static std::mutex _edge_lock;
+        static vector<sk_gpio_edge_event> _edge_events;
+
+        static void _edge_callback(int pi, unsigned user_gpio, unsigned level, uint32_t tick, void *userdata)
+        {
+                // watchdog timeouts are not edges
+                if (level == PI_TIMEOUT) return;
+
+                {
+                        std::lock_guard<std::mutex> lock(_edge_lock);
+                        _edge_events.push_back({static_cast<int>(user_gpio), static_cast<int>(level), tick});
+                }
+
+                sk_signal_activity();
+        }
+
+        int sk_gpio_watch_edge(int pin, int edge)
+        {
+
+                if (!check_pi()) return -1;
+                return callback_ex(pi, pin, edge, _edge_callback, nullptr);
+        }
+
+        void sk_gpio_cancel_watch(int watch_id)
+        {
+
+                if (watch_id >= 0) callback_cancel(watch_id);
+        }
+
+        bool sk_gpio_take_edge_events(vector<sk_gpio_edge_event> &events)
+        {
+
+                events.clear();
+
+                std::lock_guard<std::mutex> lock(_edge_lock);
+                if (_edge_events.empty()) return false;
+
+                events.swap(_edge_events);
+                return true;
+        }
+
         // Cleanup the GPIO library
         void sk_gpio_cleanup()
         {
@@ -7,18 +7,60 @@
 
 #include <stdint.h> // Include the appropriate header file for stdint.h
 #ifdef RASPBERRY_PI
+#include <vector>
+
 namespace splashkit_lib
 {
+    // A change in a watched pin's level, with the daemon's microsecond tick
+    struct sk_gpio_edge_event
+    {
+        int pin;
+        int level;
+        uint32_t tick;
+    };
+
     int sk_gpio_init();
     int sk_gpio_read(int pin);
     void sk_gpio_set_mode(int pin, int mode);
     int sk_gpio_get_mode(int pin);
     void sk_gpio_set_pull_up_down(int pin, int pud);
     void sk_gpio_write(int pin, int value);
+    uint32_t sk_gpio_read_bank();
+    void sk_gpio_write_bank(uint32_t set, uint32_t clear);
     void sk_set_pwm_range(int pin, int range);
     void sk_set_pwm_frequency(int pin, int frequency);
     void sk_set_pwm_dutycycle(int pin, int dutycycle);
     void sk_gpio_cleanup();
+
+    // One step of a waveform, setting and clearing pins then waiting
+    struct sk_gpio_pulse
+    {
+        uint32_t set;
+        uint32_t clear;
+        uint32_t delay_us;
+    };
+
+    // Hardware PWM, with the duty cycle out of 1000000
+    void sk_gpio_hardware_pwm(int pin, int frequency, int dutycycle);
+    // Sends the pulses as a DMA timed waveform, replacing the last one sent
+    int sk_wave_send(const std::vector<sk_gpio_pulse> &pulses, bool repeat);
+    bool sk_wave_busy();
+    void sk_wave_stop();
+
+    // Hardware SPI and I2C, each returns a negative pigpio error on failure
+    int sk_spi_open(int channel, int speed, int flags);
+    void sk_spi_close(int handle);
+    int sk_spi_transfer(int handle, char *buffer, int count);
+    int sk_i2c_open(int bus, int address, int flags);
+    void sk_i2c_close(int handle);
+    int sk_i2c_read_block(int handle, int reg, char *buffer, int count);
+    int sk_i2c_write_block(int handle, int reg, char *buffer, int count);
+
+    // Watch for edges on a pin, returning the watch id or a negative error
+    int sk_gpio_watch_edge(int pin, int edge);
+    void sk_gpio_cancel_watch(int watch_id);
+    // Moves the edges seen since the last call into events, returns false if there were none
+    bool sk_gpio_take_edge_events(std::vector<sk_gpio_edge_event> &events);
 }
 #endif
 #endif /* defined(gpio_driver) */
\ No newline at end of file
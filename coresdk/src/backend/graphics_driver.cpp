@@ -20,12 +20,30 @@
 #endif
 
 #include "png.h"
+#include <zlib.h>
 #include <string.h>
+#include <cstdint>
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <cmath>
 
 #include "core_driver.h"
 #include "graphics_driver.h"
+#include "text_driver.h"
+#include "profiling_driver.h"
+#include "utility_functions.h"
+#include "file_view.h"
+#include "concurrency_utils.h"
+#include "frame_capture_driver.h"
+#include "post_effect_driver.h"
+#include "software_raster_driver.h"
 
 using std::cerr;
 using std::endl;
@@ -35,11 +53,24 @@ namespace splashkit_lib
     unsigned int _sk_renderer_count(sk_drawing_surface *surface);
     SDL_Renderer * _sk_prepared_renderer(sk_drawing_surface* surface, unsigned int idx);
     void _sk_complete_render(sk_drawing_surface* surface, unsigned int idx);
+    void sk_flush_draw_batch();
+    SDL_Color _sk_to_sdl_color(sk_color clr);
 
 
     static sk_window_be ** _sk_open_windows = nullptr;
     static unsigned int _sk_num_open_windows = 0;
 
+    static bool _sk_vsync = false;
+
+    bool _sk_apply_vsync(SDL_Renderer *renderer)
+    {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        return SDL_RenderSetVSync(renderer, _sk_vsync ? 1 : 0) == 0;
+#else
+        return false;
+#endif
+    }
+
     static sk_bitmap_be ** _sk_open_bitmaps = nullptr;
     static unsigned int _sk_num_open_bitmaps = 0;
 
@@ -57,6 +88,8 @@ namespace splashkit_lib
     {
         SDL_Window *window = (SDL_Window *)p;
 
+        if ( ! window ) return nullptr; // headless windows have no SDL window
+
         for (unsigned int i = 0; i < _sk_num_open_windows; i++)
         {
             if (window == _sk_open_windows[i]->window)
@@ -75,39 +108,264 @@ namespace splashkit_lib
     //
     //--------------------------------------------------------------------------------------
 
-    void _sk_restore_default_render_target(sk_window_be *window_be, sk_bitmap_be *from_bmp)
+    //
+    // Targets, clips and blend modes are set through these, which skip
+    // changes that would leave the renderer as it is. Drawing onto a bitmap
+    // leaves its texture as the target, so drawing many times onto one bitmap
+    // does not switch back to the window between each draw.
+    //
+
+    void _sk_forget_render_state(sk_window_be *window_be)
     {
-        SDL_SetRenderTarget(window_be->renderer, window_be->backing);
-        SDL_SetRenderDrawBlendMode(window_be->renderer, SDL_BLENDMODE_BLEND);
-        if ( window_be->clipped )
-        {
-            SDL_RenderSetClipRect(window_be->renderer, &window_be->clip);
-        }
-        else if ( from_bmp && from_bmp->clipped )
+        window_be->state.target_known = false;
+        window_be->state.clip_known = false;
+        window_be->state.blend_known = false;
+    }
+
+    static void _sk_render_state_target(sk_window_be *window_be, SDL_Texture *target)
+    {
+        sk_render_state &state = window_be->state;
+        if ( state.target_known && state.target == target ) return;
+
+        _sk_set_render_target(window_be->renderer, target);
+        state.target_known = true;
+        state.target = target;
+
+        // SDL clears the clip of texture targets, and restores the window's
+        // own clip when switching back to the window
+        state.clip_known = target != nullptr;
+        state.clipped = false;
+    }
+
+    static void _sk_render_state_clip(sk_window_be *window_be, const SDL_Rect *clip)
+    {
+        sk_render_state &state = window_be->state;
+        if ( state.clip_known )
         {
-            SDL_RenderSetClipRect(window_be->renderer, nullptr);
+            if ( ! clip && ! state.clipped ) return;
+            if ( clip && state.clipped && SDL_RectEquals(clip, &state.clip) ) return;
         }
+
+        SDL_RenderSetClipRect(window_be->renderer, clip);
+        state.clip_known = true;
+        state.clipped = clip != nullptr;
+        if ( clip ) state.clip = *clip;
+    }
+
+    static void _sk_render_state_blend(sk_window_be *window_be, SDL_BlendMode blend)
+    {
+        sk_render_state &state = window_be->state;
+        if ( state.blend_known && state.blend == blend ) return;
+
+        SDL_SetRenderDrawBlendMode(window_be->renderer, blend);
+        state.blend_known = true;
+        state.blend = blend;
+    }
+
+    void _sk_restore_default_render_target(sk_window_be *window_be)
+    {
+        _sk_render_state_target(window_be, window_be->backing);
+        _sk_render_state_blend(window_be, SDL_BLENDMODE_BLEND);
+        _sk_render_state_clip(window_be, window_be->clipped ? &window_be->clip : nullptr);
     }
 
-    void _sk_restore_default_render_target(unsigned int window_idx, sk_bitmap_be *from_bmp)
+    // Anything that may change a bitmap's pixels discards its snapshot
+    static void _sk_bitmap_changed(sk_bitmap_be *bitmap_be)
     {
-        _sk_restore_default_render_target(_sk_open_windows[window_idx], from_bmp);
+        bitmap_be->snapshot_valid = false;
+        bitmap_be->mips_valid = false;
+        bitmap_be->reads_since_change = 0;
     }
 
     void _sk_set_renderer_target(unsigned int window_idx, sk_bitmap_be *target)
     {
+        _sk_bitmap_changed(target);
+
         sk_window_be * window_be = _sk_open_windows[window_idx];
-        SDL_SetRenderTarget(window_be->renderer, target->texture[window_idx]);
-        SDL_SetRenderDrawBlendMode(window_be->renderer, SDL_BLENDMODE_BLEND);
 
-        if ( target->clipped )
+        _sk_render_state_target(window_be, target->texture[window_idx]);
+        _sk_render_state_blend(window_be, SDL_BLENDMODE_BLEND);
+        _sk_render_state_clip(window_be, target->clipped ? &target->clip : nullptr);
+    }
+
+    // Bitmap textures may be left as a renderer's target, so switch away from
+    // them before they are destroyed
+    static void _sk_destroy_bitmap_texture(SDL_Texture *texture)
+    {
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        {
+            sk_render_state &state = _sk_open_windows[i]->state;
+            if ( state.target_known && state.target == texture )
+                _sk_restore_default_render_target(_sk_open_windows[i]);
+        }
+
+        SDL_DestroyTexture(texture);
+    }
+
+    void _sk_upload_bitmap_area(SDL_Texture *tex, SDL_Surface *surface, const SDL_Rect &area);
+
+    //
+    // Software rendered bitmaps keep their pixels in their RGBA8888 surface.
+    // Only one of them has recorded drawing at a time, which is drawn when
+    // anything else touches the bitmaps or the batch is flushed, then the
+    // changed area is uploaded to its streaming textures.
+    //
+    static sk_bitmap_be *_sk_software_pending = nullptr;
+
+    static void _sk_flush_software_drawing()
+    {
+        sk_bitmap_be *bitmap_be = _sk_software_pending;
+        if ( ! bitmap_be ) return;
+
+        _sk_software_pending = nullptr;
+
+        SDL_Surface *surface = bitmap_be->surface;
+        SDL_Rect area = sk_raster_flush(bitmap_be->raster, static_cast<uint32_t *>(surface->pixels), surface->pitch / 4);
+        if ( area.w <= 0 || area.h <= 0 ) return;
+
+        _sk_bitmap_changed(bitmap_be);
+
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        {
+            if ( bitmap_be->texture[i] )
+                _sk_upload_bitmap_area(bitmap_be->texture[i], surface, area);
+        }
+    }
+
+    // Draws what the bitmap has recorded and returns it to the renderer
+    static void _sk_stop_software_rendering(sk_bitmap_be *bitmap_be)
+    {
+        if ( ! bitmap_be->raster ) return;
+
+        if ( _sk_software_pending == bitmap_be ) _sk_flush_software_drawing();
+
+        sk_free_raster_target(bitmap_be->raster);
+        bitmap_be->raster = nullptr;
+    }
+
+    void _sk_create_texture_for_bitmap_window(sk_bitmap_be *current_bmp, unsigned int src_window_idx, unsigned int dest_window_idx);
+    void _sk_leave_atlas(sk_bitmap_be *bitmap);
+
+    //
+    // Returns the index of a window that already has a texture for the
+    // bitmap, or -1 if no textures have been created yet.
+    //
+    int _sk_bitmap_texture_source(sk_bitmap_be *bitmap)
+    {
+        if ( ! bitmap->texture ) return -1;
+
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        {
+            if ( bitmap->texture[i] ) return static_cast<int>(i);
+        }
+
+        return -1;
+    }
+
+    //
+    // When on, bitmaps are drawn through a single window's renderer and the
+    // other windows copy the result the next time they use the bitmap.
+    //
+    static bool _sk_single_bitmap_renderer = false;
+
+    //
+    // The number of windows that currently hold a copy of the bitmap.
+    //
+    unsigned int _sk_bitmap_copy_count(sk_bitmap_be *bitmap)
+    {
+        unsigned int result = 0;
+
+        if ( ! bitmap->texture ) return 0;
+
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        {
+            if ( bitmap->texture[i] ) result++;
+        }
+
+        return result;
+    }
+
+    //
+    // Map a renderer index to the window used to draw onto the bitmap.
+    // Window affine bitmaps are only ever drawn through their own window.
+    // Otherwise only the windows that already hold a copy are drawn on, in
+    // window order - a window without a copy gets one from these when it
+    // next uses the bitmap.
+    //
+    unsigned int _sk_bitmap_window_idx(sk_bitmap_be *bitmap, unsigned int idx)
+    {
+        if ( bitmap->window_affinity ) return bitmap->window_affinity->idx;
+        if ( ! bitmap->texture ) return idx;
+
+        unsigned int seen = 0;
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        {
+            if ( ! bitmap->texture[i] ) continue;
+            if ( seen == idx ) return i;
+            seen++;
+        }
+
+        return idx;
+    }
+
+    //
+    // Remove every copy of the bitmap except the one in window_idx, so the
+    // other windows copy the new pixels the next time they use it.
+    //
+    void _sk_release_other_bitmap_copies(sk_bitmap_be *bitmap, unsigned int window_idx)
+    {
+        if ( ! bitmap->texture ) return;
+
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
         {
-            SDL_RenderSetClipRect(window_be->renderer, &target->clip);
+            if ( i == window_idx || ! bitmap->texture[i] ) continue;
+
+            _sk_destroy_bitmap_texture(bitmap->texture[i]);
+            bitmap->texture[i] = nullptr;
         }
-        else if ( window_be->clipped )
+    }
+
+    //
+    // Premultiplied colours are added to the destination rather than
+    // multiplied by their alpha a second time.
+    //
+    void _sk_apply_bitmap_blend_mode(sk_bitmap_be *bitmap, SDL_Texture *tex)
+    {
+        if ( bitmap->premultiplied )
         {
-            SDL_RenderSetClipRect(window_be->renderer, nullptr);
+            static SDL_BlendMode premultiplied_blend = SDL_ComposeCustomBlendMode(
+                SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+
+            SDL_SetTextureBlendMode(tex, premultiplied_blend);
         }
+        else
+            SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    }
+
+    //
+    // Get the bitmap's texture for a window, creating it the first time the
+    // bitmap is used with that window. Returns nullptr if the bitmap cannot
+    // be used with the window.
+    //
+    SDL_Texture * _sk_bitmap_texture(sk_bitmap_be *bitmap, unsigned int window_idx)
+    {
+        if ( window_idx >= _sk_num_open_windows ) return nullptr;
+        if ( bitmap->texture[window_idx] ) return bitmap->texture[window_idx];
+
+        if ( bitmap->window_affinity && bitmap->window_affinity->idx != window_idx ) return nullptr;
+
+        int src_idx = _sk_bitmap_texture_source(bitmap);
+        if ( src_idx < 0 && ! bitmap->surface ) return nullptr;
+
+        _sk_create_texture_for_bitmap_window(bitmap, src_idx < 0 ? window_idx : static_cast<unsigned int>(src_idx), window_idx);
+
+        SDL_Texture *tex = bitmap->texture[window_idx];
+        SDL_SetTextureColorMod(tex, bitmap->tint.r, bitmap->tint.g, bitmap->tint.b);
+        SDL_SetTextureAlphaMod(tex, bitmap->tint.a);
+        if ( bitmap->premultiplied ) _sk_apply_bitmap_blend_mode(bitmap, tex);
+
+        return tex;
     }
 
     void _sk_make_drawable(sk_bitmap_be *bitmap)
@@ -116,28 +374,39 @@ namespace splashkit_lib
 
         int access, w, h;
 
+        // drawing the renderer does needs target textures rather than the surface
+        _sk_stop_software_rendering(bitmap);
+        _sk_leave_atlas(bitmap);
+
+        // make sure one texture holds the pixels before the surface is removed
+        if ( _sk_bitmap_texture_source(bitmap) < 0 )
+            _sk_bitmap_texture(bitmap, _sk_bitmap_window_idx(bitmap, 0));
+
         for (unsigned int i = 0; i < _sk_num_open_windows; i++)
         {
             SDL_Renderer *renderer = _sk_open_windows[i]->renderer;
 
             SDL_Texture *orig_tex = bitmap->texture[i];
 
+            if ( ! orig_tex ) continue; // created from the others when needed
+
             SDL_QueryTexture(orig_tex, nullptr, &access, &w, &h);
 
             if ( access == SDL_TEXTUREACCESS_TARGET ) continue; // already target
 
             // Create new texture
-            SDL_Texture *tex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+            SDL_Texture *tex = _sk_create_texture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+            _sk_apply_bitmap_blend_mode(bitmap, tex);
             bitmap->texture[i] = tex;
 
             // Draw onto new texture
-            SDL_SetRenderTarget(renderer, tex);
-            SDL_RenderCopy(renderer, orig_tex, nullptr, nullptr);
+            _sk_render_state_target(_sk_open_windows[i], tex);
+            _sk_render_copy(renderer, orig_tex, nullptr, nullptr);
 
             // Destroy old
             SDL_DestroyTexture(orig_tex);
 
-            _sk_restore_default_render_target(_sk_open_windows[i], bitmap);
+            _sk_restore_default_render_target(_sk_open_windows[i]);
         }
 
         // Remove surface
@@ -146,6 +415,8 @@ namespace splashkit_lib
 
         // Set drawable
         bitmap->drawable = true;
+        bitmap->streaming = false;
+        bitmap->dirty = {0, 0, 0, 0};
     }
 
 
@@ -176,41 +447,70 @@ namespace splashkit_lib
 
         _sk_has_initial_window = true;
         _sk_initial_window = static_cast<sk_window_be *>(malloc(sizeof(sk_window_be)));
+        _sk_initial_window->window = nullptr;
+        _sk_initial_window->target = nullptr;
+        _sk_initial_window->changed = true;
 
-        _sk_initial_window->window = SDL_CreateWindow("SplashKit",
-                                                      SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 200, 200,
-                                                      SDL_WINDOW_ALLOW_HIGHDPI );
-
-        if ( ! _sk_initial_window->window )
+        if ( sk_headless() )
         {
-            cerr << "Splashkit failed to load a window." << endl << SDL_GetError() << endl;;
-            exit(-1);
-        }
+            // Render in software onto a surface, so no window system is needed
+            _sk_initial_window->target = SDL_CreateRGBSurfaceWithFormat(0, 200, 200, 32, SDL_PIXELFORMAT_RGBA8888);
 
-        _sk_initial_window->renderer = SDL_CreateRenderer(_sk_initial_window->window,
-                                                          -1,
-                                                          SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE );
+            if ( ! _sk_initial_window->target )
+            {
+                cerr << "Splashkit failed to create a headless surface." << endl << SDL_GetError() << endl;
+                exit(EXIT_FAILURE);
+            }
 
-        if ( ! _sk_initial_window->renderer )
-        {
-            _sk_initial_window->renderer = SDL_CreateRenderer(_sk_initial_window->window, -1, SDL_RENDERER_TARGETTEXTURE );
+            _sk_initial_window->renderer = SDL_CreateSoftwareRenderer(_sk_initial_window->target);
 
             if ( ! _sk_initial_window->renderer )
             {
-                cerr << "Splashkit failed to create a renderer for the window." << endl << (SDL_GetError()) << endl;
+                cerr << "Splashkit failed to create a headless renderer." << endl << (SDL_GetError()) << endl;
                 exit(EXIT_FAILURE);
             }
+
+            SDL_SetRenderDrawBlendMode(_sk_initial_window->renderer, SDL_BLENDMODE_BLEND);
         }
+        else
+        {
+            _sk_initial_window->window = SDL_CreateWindow("SplashKit",
+                                                          SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 200, 200,
+                                                          SDL_WINDOW_ALLOW_HIGHDPI );
 
-        SDL_SetRenderDrawBlendMode(_sk_initial_window->renderer, SDL_BLENDMODE_BLEND);
-        SDL_PumpEvents();
-        //HACK: Change size of Mojave
-        SDL_SetWindowSize(_sk_initial_window->window, 200, 200);
+            if ( ! _sk_initial_window->window )
+            {
+                cerr << "Splashkit failed to load a window." << endl << SDL_GetError() << endl;;
+                exit(-1);
+            }
+
+            _sk_initial_window->renderer = SDL_CreateRenderer(_sk_initial_window->window,
+                                                              -1,
+                                                              SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE );
+
+            if ( ! _sk_initial_window->renderer )
+            {
+                _sk_initial_window->renderer = SDL_CreateRenderer(_sk_initial_window->window, -1, SDL_RENDERER_TARGETTEXTURE );
+
+                if ( ! _sk_initial_window->renderer )
+                {
+                    cerr << "Splashkit failed to create a renderer for the window." << endl << (SDL_GetError()) << endl;
+                    exit(EXIT_FAILURE);
+                }
+            }
+
+            SDL_SetRenderDrawBlendMode(_sk_initial_window->renderer, SDL_BLENDMODE_BLEND);
+            SDL_PumpEvents();
+            //HACK: Change size of Mojave
+            SDL_SetWindowSize(_sk_initial_window->window, 200, 200);
+        }
 
         //    std::cout << "Initial Renderer is " << _sk_initial_window->renderer << std::endl;
 
         // The user cannot draw onto this window!
-        _sk_initial_window->backing = SDL_CreateTexture(_sk_initial_window->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, 200, 200);
+        _sk_initial_window->backing = _sk_create_texture(_sk_initial_window->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, 200, 200);
+        _sk_initial_window->width = 200;
+        _sk_initial_window->height = 200;
         _sk_initial_window->surface = nullptr;
 
         _sk_initial_window->event_data.close_requested = false;
@@ -220,6 +520,7 @@ namespace splashkit_lib
 
         _sk_initial_window->clipped = false;
         _sk_initial_window->clip = {0,0,0,0};
+        _sk_forget_render_state(_sk_initial_window);
 
         _sk_open_windows = static_cast<sk_window_be **>(malloc(sizeof(sk_window_be *)));
 
@@ -251,7 +552,7 @@ namespace splashkit_lib
                 if ( !textures ) exit (-1); // out of memory
 
                 current_bmp->texture = textures;
-                current_bmp->texture[0] = SDL_CreateTextureFromSurface(_sk_initial_window->renderer, current_bmp->surface );
+                current_bmp->texture[0] = nullptr; // created when first drawn
             }
             else
             {
@@ -276,19 +577,22 @@ namespace splashkit_lib
         SDL_QueryTexture(src_tex, nullptr, nullptr, &w, &h);
         pixels = malloc(static_cast<size_t>(4 * w * h));
 
-        SDL_SetRenderTarget(src_renderer, src_tex);
+        // Textures are copied lazily, so this may happen mid frame
+        SDL_Texture *old_target = SDL_GetRenderTarget(src_renderer);
+
+        _sk_set_render_target(src_renderer, src_tex);
         _sk_get_pixels_from_renderer(src_renderer, 0, 0, w, h, (int*)pixels);
         
         //SDL_RenderReadPixels(src_renderer, nullptr, SDL_PIXELFORMAT_RGBA8888, pixels, 4 * w);
 
-        SDL_Texture *tex = SDL_CreateTexture(dest_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        SDL_Texture *tex = _sk_create_texture(dest_renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
         SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
 
-        SDL_UpdateTexture(tex, nullptr, pixels, 4 * w);
+        _sk_update_texture(tex, nullptr, pixels, 4 * w);
         free(pixels);
 
-        // Restore default target
-        SDL_SetRenderTarget(src_renderer, nullptr);
+        // Restore the previous target
+        _sk_set_render_target(src_renderer, old_target);
 
         return tex;
     }
@@ -298,21 +602,32 @@ namespace splashkit_lib
         sk_window_be *window = _sk_open_windows[dest_window_idx];
 
         // if the surface exists, use that to create the new bitmap... otherwise extract from texture
-        if (current_bmp->surface && not current_bmp->drawable)
+        if (current_bmp->surface && current_bmp->streaming)
+        {
+            SDL_Texture *tex = _sk_create_texture(window->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, current_bmp->surface->w, current_bmp->surface->h);
+            SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+            _sk_update_texture(tex, nullptr, current_bmp->surface->pixels, current_bmp->surface->pitch);
+
+            current_bmp->texture[dest_window_idx] = tex;
+        }
+        else if (current_bmp->surface && not current_bmp->drawable)
         {
-            current_bmp->texture[dest_window_idx] = SDL_CreateTextureFromSurface(window->renderer, current_bmp->surface );
+            current_bmp->texture[dest_window_idx] = _sk_create_texture_from_surface(window->renderer, current_bmp->surface );
         }
         else
         {
             SDL_Texture *src_tex = current_bmp->texture[src_window_idx];
             current_bmp->texture[dest_window_idx] = _sk_copy_texture(src_tex,
                                                                      _sk_open_windows[src_window_idx]->renderer, window->renderer);
+
+            // switching back to the old target cleared its clip
+            _sk_forget_render_state(_sk_open_windows[src_window_idx]);
         }
     }
 
     //
-    // Add a window to the array of windows, and update all textures so
-    // they can be drawn to this window
+    // Add a window to the array of windows, and make room for each bitmap's
+    // texture on this window. The textures are created when first needed.
     //
     void _sk_add_window(sk_window_be * window)
     {
@@ -332,7 +647,7 @@ namespace splashkit_lib
         windows[idx] = window;
         window->idx = idx;
 
-        // create textures for new window
+        // make space for textures on the new window
 
         SDL_Texture ** textures = nullptr;
         sk_bitmap_be *current_bmp;
@@ -346,14 +661,7 @@ namespace splashkit_lib
             if ( !textures ) exit (-1); // out of memory
 
             current_bmp->texture = textures;
-
-            if ( idx > 0 ) // this is not the first window open
-                _sk_create_texture_for_bitmap_window(current_bmp, 0, idx);
-            else // first window... copy surface
-            {
-                current_bmp->texture[0] = SDL_CreateTextureFromSurface(window->renderer, current_bmp->surface );
-                //TODO: Could the surface be nullptr here?
-            }
+            current_bmp->texture[idx] = nullptr;
         }
     }
 
@@ -374,14 +682,16 @@ namespace splashkit_lib
         SDL_RenderReadPixels(renderer, &rect, SDL_PIXELFORMAT_RGBA8888, pixels, w * 4);
     }
 
-    void _sk_bitmap_be_texture_to_pixels(sk_bitmap_be *bitmap_be, int *pixels, int sz, int w, int h)
+    void _sk_bitmap_be_texture_to_pixels(sk_bitmap_be *bitmap_be, int *pixels, int sz, int x, int y, int w, int h)
     {
-        if (bitmap_be->drawable && _sk_num_open_windows > 0)
+        int src_idx = _sk_bitmap_texture_source(bitmap_be);
+
+        if (bitmap_be->drawable && src_idx >= 0)
         {
             // read pixels from the texture
-            _sk_set_renderer_target(0, bitmap_be);
-            _sk_get_pixels_from_renderer(_sk_open_windows[0]->renderer, 0, 0, w, h, pixels);
-            _sk_restore_default_render_target(_sk_open_windows[0], bitmap_be);
+            _sk_set_renderer_target(static_cast<unsigned int>(src_idx), bitmap_be);
+            _sk_get_pixels_from_renderer(_sk_open_windows[src_idx]->renderer, x, y, w, h, pixels);
+            _sk_restore_default_render_target(_sk_open_windows[src_idx]);
         }
         else
         {
@@ -424,7 +734,7 @@ namespace splashkit_lib
 
                 memset(pixels, 0, sizeof(pixels));
 
-                _sk_bitmap_be_texture_to_pixels(_sk_open_bitmaps[i], pixels, sz, w, h);
+                _sk_bitmap_be_texture_to_pixels(_sk_open_bitmaps[i], pixels, sz, 0, 0, w, h);
 
                 _sk_open_bitmaps[i]->surface = SDL_CreateRGBSurface(0, w, h, 32, rmask, gmask, bmask, amask);
 
@@ -471,8 +781,28 @@ namespace splashkit_lib
         // Remove all of the textures for this window
         for (unsigned int bmp_idx = 0; bmp_idx < _sk_num_open_bitmaps; bmp_idx++)
         {
+            sk_bitmap_be *bitmap_be = _sk_open_bitmaps[bmp_idx];
+
+            if ( bitmap_be->window_affinity == window_be ) bitmap_be->window_affinity = nullptr;
+
+            // Move drawn pixels to another window if this window holds the only copy
+            if ( bitmap_be->texture[idx] && ! bitmap_be->surface && _sk_num_open_windows > 1 )
+            {
+                bool only_copy = true;
+                for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+                {
+                    if ( i != idx && bitmap_be->texture[i] ) only_copy = false;
+                }
+
+                if ( only_copy )
+                {
+                    _sk_bitmap_texture(bitmap_be, idx == 0 ? 1 : 0);
+                }
+            }
+
             // Delete the relevant texture
-            SDL_DestroyTexture(_sk_open_bitmaps[bmp_idx]->texture[idx]);
+            if ( bitmap_be->texture[idx] )
+                _sk_destroy_bitmap_texture(bitmap_be->texture[idx]);
 
             // shuffle left from idx
             for (unsigned int i = idx; i < _sk_num_open_windows - 1; i++)
@@ -526,13 +856,16 @@ namespace splashkit_lib
             SDL_DestroyTexture(window_be->backing);
         }
 
+        _sk_release_text_renderer(window_be->renderer);
         SDL_DestroyRenderer(window_be->renderer);
-        SDL_DestroyWindow(window_be->window);
+        if ( window_be->window ) SDL_DestroyWindow(window_be->window);
+        if ( window_be->target ) SDL_FreeSurface(window_be->target);
 
         window_be->idx = UINT_MAX;
         window_be->renderer = nullptr;
         window_be->window = nullptr;
         window_be->backing = nullptr;
+        window_be->target = nullptr;
 
         if ( _sk_initial_window == window_be )
         {
@@ -618,13 +951,37 @@ namespace splashkit_lib
         }
     }
 
+    static void _sk_free_bitmap_mips(sk_bitmap_be *bitmap_be);
+
     void _sk_destroy_bitmap(sk_bitmap_be *bitmap_be)
     {
+        // recorded drawing is dropped with the bitmap, while that of other
+        // bitmaps is drawn as it may read this one
+        if ( _sk_software_pending == bitmap_be )
+            _sk_software_pending = nullptr;
+        else
+            _sk_flush_software_drawing();
+        sk_free_raster_target(bitmap_be->raster);
+        bitmap_be->raster = nullptr;
+
+        _sk_leave_atlas(bitmap_be);
+        _sk_free_bitmap_mips(bitmap_be);
+
+        // Bitmaps still packed into a closing atlas go back to their own textures
+        if ( bitmap_be->atlas_refs > 0 )
+        {
+            for (unsigned int i = 0; i < _sk_num_open_bitmaps; i++)
+            {
+                if ( _sk_open_bitmaps[i]->atlas == bitmap_be ) _sk_open_bitmaps[i]->atlas = nullptr;
+            }
+        }
+
         _sk_remove_bitmap(bitmap_be);
 
         for (unsigned int bmp_idx = 0; bmp_idx < _sk_num_open_windows; bmp_idx++)
         {
-            SDL_DestroyTexture(bitmap_be->texture[bmp_idx]);
+            if ( bitmap_be->texture[bmp_idx] )
+                _sk_destroy_bitmap_texture(bitmap_be->texture[bmp_idx]);
             bitmap_be->texture[bmp_idx] = nullptr;
         }
         free(bitmap_be->texture);
@@ -634,8 +991,11 @@ namespace splashkit_lib
             SDL_FreeSurface(bitmap_be->surface);
         }
 
+        free(bitmap_be->snapshot);
+
         bitmap_be->surface = nullptr;
         bitmap_be->texture = nullptr;
+        bitmap_be->snapshot = nullptr;
 
         free(bitmap_be);
     }
@@ -647,8 +1007,48 @@ namespace splashkit_lib
     //
     //--------------------------------------------------------------------------------------
 
+    //
+    // Backing textures are allocated in steps of this many pixels, so that
+    // resizing a window a little keeps using its current texture.
+    //
+    static const int _SK_BACKING_STEP = 256;
+
+    int _sk_backing_bucket(int size)
+    {
+        return ((size + _SK_BACKING_STEP - 1) / _SK_BACKING_STEP) * _SK_BACKING_STEP;
+    }
+
+    SDL_Texture * _sk_create_backing(SDL_Renderer *renderer, int width, int height)
+    {
+        SDL_Texture *result = _sk_create_texture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, _sk_backing_bucket(width), _sk_backing_bucket(height));
+
+        // the rounded up size may be beyond what the renderer supports
+        if ( ! result )
+            result = _sk_create_texture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+
+        return result;
+    }
+
+    //
+    // Can the window's backing texture show a window of this size? Textures
+    // that are too large by more than a bucket are replaced to save memory.
+    //
+    bool _sk_backing_fits(sk_window_be *window_be, int width, int height)
+    {
+        int w, h;
+
+        if ( ! window_be->backing ) return false;
+
+        SDL_QueryTexture(window_be->backing, nullptr, nullptr, &w, &h);
+
+        return width <= w && height <= h && w - width < 2 * _SK_BACKING_STEP && h - height < 2 * _SK_BACKING_STEP;
+    }
+
     bool _sk_open_window(const char *title, int width, int height, unsigned int options, sk_window_be *window_be)
     {
+        window_be->target = nullptr;
+        window_be->changed = true;
+
         window_be->window = SDL_CreateWindow(title,
                                              SDL_WINDOWPOS_CENTERED,
                                              SDL_WINDOWPOS_CENTERED,
@@ -686,15 +1086,20 @@ namespace splashkit_lib
 
         //std::cout << "Renderer is " << window_be->renderer << std::endl;
 
+        if ( _sk_vsync ) _sk_apply_vsync(window_be->renderer);
+
         SDL_SetRenderDrawColor(window_be->renderer, 120, 120, 120, 255);
         SDL_RenderClear(window_be->renderer);
         SDL_RenderPresent(window_be->renderer);
         SDL_SetRenderDrawBlendMode(window_be->renderer, SDL_BLENDMODE_BLEND);
 
-        window_be->backing = SDL_CreateTexture(window_be->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        window_be->backing = _sk_create_backing(window_be->renderer, width, height);
+        window_be->width = width;
+        window_be->height = height;
 
-        SDL_SetRenderTarget(window_be->renderer, window_be->backing);
-        SDL_SetRenderDrawBlendMode(window_be->renderer, SDL_BLENDMODE_BLEND);
+        window_be->clipped = false;
+        _sk_forget_render_state(window_be);
+        _sk_restore_default_render_target(window_be);
         SDL_RenderClear(window_be->renderer);
 
         _sk_add_window(window_be);
@@ -762,6 +1167,8 @@ namespace splashkit_lib
 
     void sk_close_drawing_surface(sk_drawing_surface *surface)
     {
+        sk_flush_draw_batch();
+
         if ( ! surface )
         {
             cerr << "No surface provided to close_drawing_surface" << endl;
@@ -771,6 +1178,8 @@ namespace splashkit_lib
         switch (surface->kind)
         {
             case SGDS_Window:
+                sk_stop_frame_capture(surface);
+                sk_clear_post_effects(surface);
                 _sk_destroy_window(static_cast<sk_window_be *>(surface->_data));
                 break;
 
@@ -814,6 +1223,8 @@ namespace splashkit_lib
 
         if ( window_be )
         {
+            window_be->changed = true;
+            _sk_restore_default_render_target(window_be);
             _sk_do_clear(window_be->renderer, clr);
 
             //ATI cards are lazy, won't draw the clear screen until you actually draw something else on top of it
@@ -832,20 +1243,36 @@ namespace splashkit_lib
 
             for (unsigned int i = 0; i < _sk_num_open_windows; i++)
             {
+                // windows without a texture will copy the cleared one when needed
+                if ( ! bitmap_be->texture[i] ) continue;
+
                 sk_window_be *window = _sk_open_windows[i];
                 SDL_Renderer *renderer = window->renderer;
 
                 _sk_set_renderer_target(i, bitmap_be);
 
                 _sk_do_clear(renderer, clr);
-
-                _sk_restore_default_render_target(window, bitmap_be);
             }
         }
     }
 
+    static sk_raster_target *_sk_software_target(sk_drawing_surface *surface);
+    static uint32_t _sk_to_raster_color(SDL_Color c);
+
     void sk_clear_drawing_surface(sk_drawing_surface *surface, sk_color clr)
     {
+        // a software clear replaces the drawing recorded before it
+        if ( surface )
+        {
+            if ( sk_raster_target *raster = _sk_software_target(surface) )
+            {
+                sk_raster_clear(raster, _sk_to_raster_color(_sk_to_sdl_color(clr)));
+                return;
+            }
+        }
+
+        sk_flush_draw_batch();
+
         if ( ! surface ) return;
 
         switch (surface->kind)
@@ -863,26 +1290,58 @@ namespace splashkit_lib
         }
     }
 
+    //
+    // Copy the backing texture to the window and present it. Windows that
+    // have not been drawn on since they were last presented still show that
+    // frame, so they are skipped unless vsync is pacing the program's loop.
+    // SDL_RenderPresent always presents the whole back buffer, so a changed
+    // window is presented in full.
+    //
     void _sk_present_window(sk_window_be *window_be)
     {
-        if ( window_be && window_be->backing )
+        if ( window_be && window_be->backing && (window_be->changed || _sk_vsync) )
         {
-            SDL_SetRenderTarget(window_be->renderer, nullptr);
+            window_be->changed = false;
 
-            SDL_RenderCopy(window_be->renderer, window_be->backing, nullptr, nullptr);
+            SDL_Texture *frame = sk_post_effect_output(window_be);
+            _sk_render_state_target(window_be, nullptr);
+
+            // the backing texture may be larger than the window
+            SDL_Rect src = { 0, 0, window_be->width, window_be->height };
+            _sk_render_copy(window_be->renderer, frame, &src, nullptr);
             SDL_RenderPresent(window_be->renderer);
-            _sk_restore_default_render_target(window_be, nullptr);
+            _sk_restore_default_render_target(window_be);
         }
     }
 
+    sk_render_counters _sk_render_counts = { 0, 0, 0, 0, 0, 0 };
+    SDL_Texture *_sk_last_drawn_texture = nullptr;
+    static sk_render_counters _sk_last_frame_counts = { 0, 0, 0, 0, 0, 0 };
+
+    sk_render_counters sk_last_frame_render_counters()
+    {
+        return _sk_last_frame_counts;
+    }
+
     void sk_refresh_window(sk_drawing_surface *window)
     {
+        SK_PROFILE_SCOPE("refresh window");
+
+        sk_flush_draw_batch();
+
         if ( (! window) || window->kind != SGDS_Window ) return;
 
         sk_window_be * window_be;
         window_be = static_cast<sk_window_be *>(window->_data);
 
+        sk_capture_window_frame(window_be);
         _sk_present_window(window_be);
+
+        _sk_text_end_frame();
+
+        _sk_last_frame_counts = _sk_render_counts;
+        _sk_render_counts = { 0, 0, 0, 0, 0, 0 };
+        _sk_last_drawn_texture = nullptr;
     }
 
     //
@@ -894,17 +1353,27 @@ namespace splashkit_lib
         switch (surface->kind)
         {
             case SGDS_Window:
-                return static_cast<sk_window_be *>(surface->_data)->renderer;
+            {
+                sk_window_be *window_be = static_cast<sk_window_be *>(surface->_data);
+                window_be->changed = true;
+                _sk_restore_default_render_target(window_be);
+                return window_be->renderer;
+            }
 
             case SGDS_Bitmap:
             {
                 sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+                unsigned int window_idx = _sk_bitmap_window_idx(bitmap_be, idx);
+
+                if ( window_idx >= _sk_num_open_windows ) return nullptr;
+
                 if ( ! bitmap_be->drawable ) _sk_make_drawable( bitmap_be );
-                _sk_set_renderer_target(idx, bitmap_be);
 
-                if (idx < _sk_num_open_windows)
-                    return _sk_open_windows[idx]->renderer;
-                else return nullptr;
+                // only windows with a copy are drawn on, missing copies are made on use
+                _sk_bitmap_texture(bitmap_be, window_idx);
+                _sk_set_renderer_target(window_idx, bitmap_be);
+
+                return _sk_open_windows[window_idx]->renderer;
             }
 
             case SGDS_Unknown:
@@ -920,9 +1389,15 @@ namespace splashkit_lib
             case SGDS_Window:
                 break;
             case SGDS_Bitmap:
-                if (idx < _sk_num_open_windows)
-                    _sk_restore_default_render_target(_sk_open_windows[idx], static_cast<sk_bitmap_be *>(surface->_data));
+            {
+                sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+                unsigned int window_idx = _sk_bitmap_window_idx(bitmap_be, idx);
+
+                // the bitmap stays the target, so further drawing onto it does not switch back
+                if ( window_idx < _sk_num_open_windows && _sk_single_bitmap_renderer )
+                    _sk_release_other_bitmap_copies(bitmap_be, window_idx);
                 break;
+            }
             case SGDS_Unknown:
             default:
                 break;
@@ -931,14 +1406,31 @@ namespace splashkit_lib
 
     unsigned int _sk_renderer_count(sk_drawing_surface *surface)
     {
+        // Any immediate drawing must come after what has already been batched
+        sk_flush_draw_batch();
+
         switch (surface->kind)
         {
             case SGDS_Window:
                 return 1;
             case SGDS_Bitmap:
+            {
                 // Drawing to a bitmap... so ensure that there is at least one window
                 if ( _sk_num_open_windows == 0 ) _sk_create_initial_window();
-                return _sk_num_open_windows;
+
+                sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+
+                // Window affine bitmaps are only drawn on through their window
+                if ( bitmap_be->window_affinity ) return 1;
+
+                // Ensures at least one window holds a copy to draw on
+                if ( ! bitmap_be->drawable ) _sk_make_drawable(bitmap_be);
+
+                if ( _sk_single_bitmap_renderer ) return 1;
+
+                unsigned int copies = _sk_bitmap_copy_count(bitmap_be);
+                return copies > 0 ? copies : 1;
+            }
             case SGDS_Unknown:
             default:
                 return 0;
@@ -946,20 +1438,230 @@ namespace splashkit_lib
     }
 
 
+    //--------------------------------------------------------------------------------------
     //
-    //  Rectangles
+    // Batched rendering
     //
+    //--------------------------------------------------------------------------------------
 
-    void sk_draw_aa_rect(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height)
+    //
+    // When batching is enabled filled shapes and bitmaps are recorded as
+    // triangles rather than drawn immediately. Consecutive draws onto the same
+    // surface, using the same bitmap, are combined into a single
+    // SDL_RenderGeometry call. Drawing order is preserved: any other operation
+    // on a surface flushes the pending batch first.
+    //
+    struct sk_draw_batch
     {
-        if ( (! surface) || (! surface->_data) ) return;
+        sk_drawing_surface  surface;    // The destination surface
+        sk_drawing_surface  source;     // The bitmap being drawn, SGDS_Unknown for untextured shapes
+        vector<SDL_Vertex>  vertices;
+        vector<int>         indices;
+    };
 
-        SDL_Rect rect = {
-            static_cast<int>(x),
-            static_cast<int>(y),
-            static_cast<int>(width),
-            static_cast<int>(height)
-        };
+    static bool _sk_batching = false;
+    static bool _sk_flushing_batch = false;
+    static sk_draw_batch _sk_batch;
+
+    void sk_set_batched_rendering(bool value)
+    {
+        if ( ! value ) sk_flush_draw_batch();
+        _sk_batching = value;
+    }
+
+    bool sk_batched_rendering()
+    {
+        return _sk_batching;
+    }
+
+    void sk_set_single_bitmap_renderer(bool value)
+    {
+        sk_flush_draw_batch();
+        _sk_single_bitmap_renderer = value;
+    }
+
+    bool sk_single_bitmap_renderer()
+    {
+        return _sk_single_bitmap_renderer;
+    }
+
+    bool sk_set_vsync(bool value)
+    {
+        _sk_vsync = value;
+
+        bool result = true;
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        {
+            if ( ! _sk_apply_vsync(_sk_open_windows[i]->renderer) ) result = false;
+        }
+
+        return result;
+    }
+
+    bool sk_vsync()
+    {
+        return _sk_vsync;
+    }
+
+    SDL_Texture * _sk_bitmap_texture_for(sk_drawing_surface *src, sk_drawing_surface *dst, unsigned int renderer_idx)
+    {
+        unsigned int idx;
+
+        // if its a window, dont use the renderer index to get the texture
+        if (dst->kind == SGDS_Window)
+            idx = static_cast<sk_window_be *>(dst->_data)->idx;
+        else
+            idx = _sk_bitmap_window_idx(static_cast<sk_bitmap_be *>(dst->_data), renderer_idx);
+
+        return _sk_bitmap_texture(static_cast<sk_bitmap_be *>(src->_data), idx);
+    }
+
+    // The recorder for a bitmap drawn on in software, with the bitmap's clip
+    // applied, or nullptr when the surface is drawn on by the renderer
+    static sk_raster_target *_sk_software_target(sk_drawing_surface *surface)
+    {
+        if ( surface->kind != SGDS_Bitmap || ! surface->_data ) return nullptr;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+        if ( ! bitmap_be->raster ) return nullptr;
+
+        // batched drawing may read this bitmap, and this drawing may read
+        // other software bitmaps, so both are drawn first
+        if ( ! _sk_batch.indices.empty() )
+            sk_flush_draw_batch();
+        else if ( _sk_software_pending != bitmap_be )
+            _sk_flush_software_drawing();
+
+        _sk_software_pending = bitmap_be;
+        sk_raster_set_clip(bitmap_be->raster, bitmap_be->clipped ? &bitmap_be->clip : nullptr);
+        return bitmap_be->raster;
+    }
+
+    static uint32_t _sk_to_raster_color(SDL_Color c)
+    {
+        return (static_cast<uint32_t>(c.r) << 24) | (c.g << 16) | (c.b << 8) | c.a;
+    }
+
+    void sk_flush_draw_batch()
+    {
+        _sk_flush_software_drawing();
+
+        if ( _sk_flushing_batch || _sk_batch.indices.empty() ) return;
+
+        _sk_flushing_batch = true;
+
+        sk_drawing_surface *dst = &_sk_batch.surface;
+        unsigned int count = _sk_renderer_count(dst);
+
+        for (unsigned int i = 0; i < count; i++)
+        {
+            SDL_Renderer *renderer = _sk_prepared_renderer(dst, i);
+            SDL_Texture *texture = nullptr;
+
+            if ( _sk_batch.source.kind == SGDS_Bitmap )
+            {
+                texture = _sk_bitmap_texture_for(&_sk_batch.source, dst, i);
+
+                // a window affine bitmap is not drawn to other windows
+                if ( ! texture )
+                {
+                    _sk_complete_render(dst, i);
+                    continue;
+                }
+            }
+
+            _sk_render_geometry(renderer,
+                               texture,
+                               _sk_batch.vertices.data(), static_cast<int>(_sk_batch.vertices.size()),
+                               _sk_batch.indices.data(), static_cast<int>(_sk_batch.indices.size()));
+
+            _sk_complete_render(dst, i);
+        }
+
+        _sk_batch.vertices.clear();
+        _sk_batch.indices.clear();
+        _sk_flushing_batch = false;
+    }
+
+    //
+    // Ensure the batch is recording draws from src onto dst, flushing
+    // what has been recorded if it uses a different surface or bitmap.
+    //
+    void _sk_batch_target(sk_drawing_surface *dst, sk_drawing_surface *src)
+    {
+        void *src_data = src ? src->_data : nullptr;
+
+        if ( _sk_batch.indices.empty() || _sk_batch.surface._data != dst->_data || _sk_batch.source._data != src_data )
+        {
+            sk_flush_draw_batch();
+
+            _sk_batch.surface = *dst;
+            if ( src )
+                _sk_batch.source = *src;
+            else
+                _sk_batch.source = { SGDS_Unknown, 0, 0, nullptr };
+        }
+    }
+
+    SDL_Color _sk_to_sdl_color(sk_color clr)
+    {
+        return {
+            static_cast<Uint8>(clr.r * 255),
+            static_cast<Uint8>(clr.g * 255),
+            static_cast<Uint8>(clr.b * 255),
+            static_cast<Uint8>(clr.a * 255)
+        };
+    }
+
+    // Add a quad with points in order around its edge
+    void _sk_batch_quad(const SDL_Vertex &v0, const SDL_Vertex &v1, const SDL_Vertex &v2, const SDL_Vertex &v3)
+    {
+        int base = static_cast<int>(_sk_batch.vertices.size());
+
+        _sk_batch.vertices.push_back(v0);
+        _sk_batch.vertices.push_back(v1);
+        _sk_batch.vertices.push_back(v2);
+        _sk_batch.vertices.push_back(v3);
+
+        _sk_batch.indices.insert(_sk_batch.indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+    }
+
+    void _sk_batch_triangle(const SDL_Vertex &v0, const SDL_Vertex &v1, const SDL_Vertex &v2)
+    {
+        int base = static_cast<int>(_sk_batch.vertices.size());
+
+        _sk_batch.vertices.push_back(v0);
+        _sk_batch.vertices.push_back(v1);
+        _sk_batch.vertices.push_back(v2);
+
+        _sk_batch.indices.insert(_sk_batch.indices.end(), { base, base + 1, base + 2 });
+    }
+
+    void _sk_batch_rect(sk_drawing_surface *surface, SDL_Color clr, float x, float y, float w, float h)
+    {
+        _sk_batch_target(surface, nullptr);
+        _sk_batch_quad(
+            { { x, y }, clr, { 0, 0 } },
+            { { x + w, y }, clr, { 0, 0 } },
+            { { x + w, y + h }, clr, { 0, 0 } },
+            { { x, y + h }, clr, { 0, 0 } });
+    }
+
+
+    //
+    //  Rectangles
+    //
+
+    void sk_draw_aa_rect(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height)
+    {
+        if ( (! surface) || (! surface->_data) ) return;
+
+        SDL_Rect rect = {
+            static_cast<int>(x),
+            static_cast<int>(y),
+            static_cast<int>(width),
+            static_cast<int>(height)
+        };
 
         unsigned int count = _sk_renderer_count(surface);
 
@@ -972,13 +1674,14 @@ namespace splashkit_lib
                                    static_cast<Uint8>(clr.b * 255),
                                    static_cast<Uint8>(clr.a * 255));
 
+            _sk_count_untextured_draw();
             SDL_RenderDrawRect(renderer, &rect);
 
             _sk_complete_render(surface, i);
         }
     }
 
-    void sk_fill_aa_rect(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height)
+    void sk_fill_aa_rect(sk_drawing_surface *surface, rgba8 clr, double x, double y, double width, double height)
     {
         if ( (! surface) || (! surface->_data)  ) return;
 
@@ -989,23 +1692,106 @@ namespace splashkit_lib
             static_cast<int>(height)
         };
 
+        if ( sk_raster_target *raster = _sk_software_target(surface) )
+        {
+            sk_raster_fill_rect(raster, _sk_to_raster_color({ clr.r, clr.g, clr.b, clr.a }), rect.x, rect.y, rect.w, rect.h);
+            return;
+        }
+
+        if ( _sk_batching )
+        {
+            _sk_batch_rect(surface, { clr.r, clr.g, clr.b, clr.a }, rect.x, rect.y, rect.w, rect.h);
+            return;
+        }
+
         unsigned int count = _sk_renderer_count(surface);
 
         for (unsigned int i = 0; i < count; i++)
         {
             SDL_Renderer *renderer = _sk_prepared_renderer(surface, i);
-            SDL_SetRenderDrawColor(renderer,
-                                   static_cast<Uint8>(clr.r * 255),
-                                   static_cast<Uint8>(clr.g * 255),
-                                   static_cast<Uint8>(clr.b * 255),
-                                   static_cast<Uint8>(clr.a * 255));
+            SDL_SetRenderDrawColor(renderer, clr.r, clr.g, clr.b, clr.a);
 
+            _sk_count_untextured_draw();
             SDL_RenderFillRect(renderer, &rect);
 
             _sk_complete_render(surface, i);
         }
     }
 
+    void sk_fill_aa_rect(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height)
+    {
+        SDL_Color sdl_clr = _sk_to_sdl_color(clr);
+        sk_fill_aa_rect(surface, rgba8 { sdl_clr.r, sdl_clr.g, sdl_clr.b, sdl_clr.a }, x, y, width, height);
+    }
+
+    static vector<SDL_Vertex> _sk_rect_vertices;
+    static vector<int> _sk_rect_indices;
+
+    void sk_fill_aa_rects(sk_drawing_surface *surface, const rgba8 *clrs, const double *data, int count)
+    {
+        if ( (! surface) || (! surface->_data) || ! clrs || ! data || count <= 0 ) return;
+
+        if ( sk_raster_target *raster = _sk_software_target(surface) )
+        {
+            for (int r = 0; r < count; r++)
+            {
+                const double *rect = data + r * 4;
+                sk_raster_fill_rect(raster, _sk_to_raster_color({ clrs[r].r, clrs[r].g, clrs[r].b, clrs[r].a }),
+                                    static_cast<int>(rect[0]), static_cast<int>(rect[1]),
+                                    static_cast<int>(rect[2]), static_cast<int>(rect[3]));
+            }
+            return;
+        }
+
+        vector<SDL_Vertex> &vertices = _sk_batching ? _sk_batch.vertices : _sk_rect_vertices;
+        vector<int> &indices = _sk_batching ? _sk_batch.indices : _sk_rect_indices;
+
+        if ( _sk_batching )
+            _sk_batch_target(surface, nullptr);
+        else
+        {
+            _sk_rect_vertices.clear();
+            _sk_rect_indices.clear();
+        }
+
+        vertices.reserve(vertices.size() + static_cast<size_t>(count) * 4);
+        indices.reserve(indices.size() + static_cast<size_t>(count) * 6);
+
+        // match SDL_RenderFillRect, which fills whole pixels
+        for (int r = 0; r < count; r++)
+        {
+            const double *rect = data + r * 4;
+            float x = static_cast<float>(static_cast<int>(rect[0]));
+            float y = static_cast<float>(static_cast<int>(rect[1]));
+            float w = static_cast<float>(static_cast<int>(rect[2]));
+            float h = static_cast<float>(static_cast<int>(rect[3]));
+            SDL_Color clr = { clrs[r].r, clrs[r].g, clrs[r].b, clrs[r].a };
+
+            int base = static_cast<int>(vertices.size());
+            vertices.push_back({ { x, y }, clr, { 0, 0 } });
+            vertices.push_back({ { x + w, y }, clr, { 0, 0 } });
+            vertices.push_back({ { x + w, y + h }, clr, { 0, 0 } });
+            vertices.push_back({ { x, y + h }, clr, { 0, 0 } });
+            indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+        }
+
+        if ( _sk_batching ) return;
+
+        unsigned int renderers = _sk_renderer_count(surface);
+
+        for (unsigned int i = 0; i < renderers; i++)
+        {
+            SDL_Renderer *renderer = _sk_prepared_renderer(surface, i);
+
+            _sk_render_geometry(renderer,
+                               nullptr,
+                               _sk_rect_vertices.data(), static_cast<int>(_sk_rect_vertices.size()),
+                               _sk_rect_indices.data(), static_cast<int>(_sk_rect_indices.size()));
+
+            _sk_complete_render(surface, i);
+        }
+    }
+
 
     // Rectangle points are...
     //
@@ -1026,6 +1812,24 @@ namespace splashkit_lib
         int x3 = static_cast<int>(data[4]), y3 = static_cast<int>(data[5]);
         int x4 = static_cast<int>(data[6]), y4 = static_cast<int>(data[7]);
 
+        // software bitmaps draw upright outlines as a rect for each side,
+        // covering the same pixels as the lines
+        sk_raster_target *raster = _sk_software_target(surface);
+        if ( raster && x1 == x3 && y1 == y2 && x2 == x4 && y3 == y4 && x2 >= x1 && y4 >= y1 )
+        {
+            uint32_t raster_clr = _sk_to_raster_color(_sk_to_sdl_color(clr));
+            int w = x2 - x1 + 1, h = y4 - y1 + 1;
+
+            sk_raster_fill_rect(raster, raster_clr, x1, y1, w, 1);
+            if ( h > 1 ) sk_raster_fill_rect(raster, raster_clr, x1, y4, w, 1);
+            if ( h > 2 )
+            {
+                sk_raster_fill_rect(raster, raster_clr, x1, y1 + 1, 1, h - 2);
+                if ( w > 1 ) sk_raster_fill_rect(raster, raster_clr, x2, y1 + 1, 1, h - 2);
+            }
+            return;
+        }
+
         unsigned int count = _sk_renderer_count(surface);
 
         for (unsigned int i = 0; i < count; i++)
@@ -1037,6 +1841,7 @@ namespace splashkit_lib
                                    static_cast<Uint8>(clr.b * 255),
                                    static_cast<Uint8>(clr.a * 255));
 
+            _sk_count_untextured_draw();
             SDL_RenderDrawLine(renderer, x1, y1, x2, y2);
             SDL_RenderDrawLine(renderer, x1, y1, x3, y3);
             SDL_RenderDrawLine(renderer, x4, y4, x2, y2);
@@ -1059,6 +1864,29 @@ namespace splashkit_lib
         if ( ! surface ) return;
         if ( data_sz != 8 ) return;
 
+        sk_raster_target *raster = surface->_data ? _sk_software_target(surface) : nullptr;
+        if ( raster )
+        {
+            // points in order around the edge
+            double xs[4] = { data[0], data[2], data[6], data[4] };
+            double ys[4] = { data[1], data[3], data[7], data[5] };
+            sk_raster_fill_polygon(raster, _sk_to_raster_color(_sk_to_sdl_color(clr)), xs, ys, 4);
+            return;
+        }
+
+        if ( _sk_batching && surface->_data )
+        {
+            SDL_Color sdl_clr = _sk_to_sdl_color(clr);
+
+            _sk_batch_target(surface, nullptr);
+            _sk_batch_quad(
+                { { static_cast<float>(data[0]), static_cast<float>(data[1]) }, sdl_clr, { 0, 0 } },
+                { { static_cast<float>(data[2]), static_cast<float>(data[3]) }, sdl_clr, { 0, 0 } },
+                { { static_cast<float>(data[6]), static_cast<float>(data[7]) }, sdl_clr, { 0, 0 } },
+                { { static_cast<float>(data[4]), static_cast<float>(data[5]) }, sdl_clr, { 0, 0 } });
+            return;
+        }
+
         // 8 values = 4 points
         Sint16 x[4], y[4];
 
@@ -1096,134 +1924,145 @@ namespace splashkit_lib
         }
     }
 
-    // utility function to draw a region of a source stretched over a region on the destination
-    void _sk_draw_bitmap_remapped( sk_drawing_surface * src, sk_drawing_surface * dst, rectangle src_rect, rectangle dst_rect, sk_renderer_flip flip) {
-        double dst_data[7];
-        dst_data[0] = dst_rect.x + (dst_rect.width - src_rect.width)/2;// x
-        dst_data[1] = dst_rect.y + (dst_rect.height - src_rect.height)/2;// y
-        dst_data[2] = 0;// angle
-        dst_data[3] = 0;// center_x
-        dst_data[4] = 0;// center_y
-        dst_data[5] = (double)dst_rect.width/src_rect.width;// scale_x
-        dst_data[6] = (double)dst_rect.height/src_rect.height;// scale_y
-        double src_data[4];
-        src_data[0] = src_rect.x;// x
-        src_data[1] = src_rect.y;// y
-        src_data[2] = src_rect.width;// w
-        src_data[3] = src_rect.height;// h
+    //
+    // Blurred rectangles
+    //
+    // this would be slow if we just drew individual pixels on the CPU
+    // ideally we'd just do this using a GPU shader, since there's an analytical solution.
+    // no easy way to use shaders currently, so we'll use an atlas based solution.
+    // we'll generate textures for each size of gaussian we use.
+    // we can then draw the larger blurred rectangle out of pieces of this image.
+    // this will lose accuracy once the size of a blur exceeeds the size of the rectangle,
+    // but looks good enough and has minimal performance cost.
+    //
+    struct sk_gaussian_cached_info
+    {
+        sk_drawing_surface texture;
+        int radius;
+    };
+
+    typedef std::list<sk_gaussian_cached_info> sk_gaussian_cache_list;
 
-        sk_draw_bitmap(src, dst, src_data, 4, dst_data, 7, flip);
-    }
+    // we'll cache up to 20 of the latest sizes to avoid recomputing them
+    // even if every one had a huge radius of 256x256  (so each image is 513x513),
+    // our maximum memory usage would be 20mb total. The list is kept with the
+    // most recently used kernel at the back, and the index finds it by radius.
+    #define MAX_GAUSSIAN_CACHE_SIZE 20
+    static sk_gaussian_cache_list _sk_gaussian_cache;
+    static std::unordered_map<int, sk_gaussian_cache_list::iterator> _sk_gaussian_cache_index;
 
-    void sk_draw_blurred_rect(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height, int blur_radius)
+    static sk_gaussian_cached_info * _sk_gaussian_kernel(int blur_radius)
     {
-        // this would be slow if we just drew individual pixels on the CPU
-        // ideally we'd just do this using a GPU shader, since there's an analytical solution.
-        // no easy way to use shaders currently, so we'll use an atlas based solution.
-        // we'll generate textures for each size of gaussian we use.
-        // we can then draw the larger blurred rectangle out of pieces of this image.
-        // this will lose accuracy once the size of a blur exceeeds the size of the rectangle,
-        // but looks good enough and has minimal performance cost.
-        struct gaussian_cached_info
-        {
-            sk_drawing_surface texture;
-            float* gaussian_kernel;
-            int gaussian_kernel_count;
-            float gaussian_kernelSum;
-            int radius;
-        };
+        // first try and find one in the cache, moving it to the back of the list
+        auto found = _sk_gaussian_cache_index.find(blur_radius);
+        if ( found != _sk_gaussian_cache_index.end() )
+        {
+            _sk_gaussian_cache.splice(_sk_gaussian_cache.end(), _sk_gaussian_cache, found->second);
+            return &*found->second;
+        }
+
+        // if there's too many, evict the least recently used one
+        if ( _sk_gaussian_cache.size() >= MAX_GAUSSIAN_CACHE_SIZE )
+        {
+            sk_gaussian_cached_info &oldest = _sk_gaussian_cache.front();
+            sk_close_drawing_surface(&oldest.texture);
+            _sk_gaussian_cache_index.erase(oldest.radius);
+            _sk_gaussian_cache.pop_front();
+        }
+
+        int kernel_size = blur_radius * 2 + 1; //symmetric half + middle
 
-        // we'll cache up to 20 of the latest sizes to avoid recomputing them
-        // even if every one had a huge radius of 256x256  (so each image is 513x513),
-        // our maximum memory usage would be 20mb total
-        #define MAX_GAUSSIAN_CACHE_SIZE 20
-        static std::vector<gaussian_cached_info> gaussian_cache;
+        sk_gaussian_cached_info new_gaussian;
+        new_gaussian.texture = sk_create_bitmap(kernel_size, kernel_size);
+        new_gaussian.radius = blur_radius;
 
-        gaussian_cached_info* gaussian = nullptr;
+        vector<float> kernel(kernel_size + 1, 0.0f);
 
-        // first try and find one in the cache
-        for (int i = 0; i < gaussian_cache.size(); i ++)
+        // calculate sigma to ensure gaussian is at min_val at radius
+        float min_val = 0.00001f; //(1/256)^2, or ~the minimum change between pixels from gamma space
+        float sigma = kernel_size/std::sqrt(-std::log(min_val));
+
+        // compute one half
+        for(int i = 0; i < blur_radius; i ++)
         {
-            if (gaussian_cache[i].radius == blur_radius)
-            {
-                // having found one, let's move it to the end of the vector
-                gaussian_cache.push_back(gaussian_cache[i]);
-                gaussian_cache.erase(gaussian_cache.begin() + i);
-                gaussian = &gaussian_cache[gaussian_cache.size()-1];
-                break;
-            }
+            int x = blur_radius-i;
+            // compute gaussian kernel
+            kernel[i] = std::exp(-(x/sigma)*(x/sigma));
+            kernel[kernel_size-i-1] = kernel[i];
         }
 
-        int kernel_size = blur_radius * 2 + 1; //symmetric half + middle
+        // fill middle
+        kernel[blur_radius] = 1;
 
-        // if we didn't find one, we'll create one
-        if (gaussian == nullptr)
+        // running sum (gives us a lookup table of pre-convolved results)
+        float sum = 0;
+        for(int i = 0; i <= kernel_size; i++)
         {
-            // if there's too many, evict the earliest one
-            if (gaussian_cache.size() >= MAX_GAUSSIAN_CACHE_SIZE)
-            {
-                delete [] gaussian_cache[0].gaussian_kernel;
+            sum += kernel[i];
+            kernel[i] = sum;
+        }
 
-                sk_close_drawing_surface(&gaussian_cache[0].texture);
+        // fill the 2D bitmap based on the pre-convolved results
+        float kernel_sum = kernel[kernel_size-1];
+        kernel_sum *= kernel_sum;
 
-                gaussian_cache.erase(gaussian_cache.begin());
+        vector<uint32_t> pixels(static_cast<size_t>(kernel_size) * kernel_size);
+        for(int y = 0; y < kernel_size; y++)
+        {
+            for(int x = 0; x < kernel_size; x++)
+            {
+                float local_sum = kernel[x] * kernel[y];
+                pixels[y * kernel_size + x] = 0xFFFFFF00 | static_cast<uint32_t>((local_sum/kernel_sum) * 255);
             }
+        }
 
-            gaussian_cached_info new_gaussian;
-            new_gaussian.texture = sk_create_bitmap(kernel_size, kernel_size);
-            new_gaussian.gaussian_kernel_count = kernel_size;
-            new_gaussian.gaussian_kernel = new float[kernel_size];
-            new_gaussian.radius = blur_radius;
+        sk_set_bitmap_pixels(&new_gaussian.texture, pixels.data(), 0, 0, kernel_size, kernel_size);
 
-            // calculate sigma to ensure gaussian is at min_val at radius
-            float min_val = 0.00001f; //(1/256)^2, or ~the minimum change between pixels from gamma space
-            float sigma = kernel_size/std::sqrt(-std::log(min_val));
+        // done!
+        _sk_gaussian_cache.push_back(new_gaussian);
+        auto it = std::prev(_sk_gaussian_cache.end());
+        _sk_gaussian_cache_index[blur_radius] = it;
+        return &*it;
+    }
 
-            // compute one half
-            new_gaussian.gaussian_kernelSum = 0;
-            for(int i = 0; i < blur_radius; i ++)
-            {
-                int x = blur_radius-i;
-                // compute gaussian kernel
-                new_gaussian.gaussian_kernel[i] = std::exp(-(x/sigma)*(x/sigma));
-                new_gaussian.gaussian_kernelSum += new_gaussian.gaussian_kernel[i];
+    static vector<SDL_Vertex> _sk_blur_vertices;
+    static vector<int> _sk_blur_indices;
 
-                new_gaussian.gaussian_kernel[kernel_size-i-1] = new_gaussian.gaussian_kernel[i];
-                new_gaussian.gaussian_kernelSum += new_gaussian.gaussian_kernel[i];
-            }
+    // add a region of the kernel, stretched over a region on the destination
+    static void _sk_add_blur_piece(float size, SDL_Color clr, const rectangle &src_rect, const rectangle &dst_rect, sk_renderer_flip flip)
+    {
+        if ( dst_rect.width <= 0 || dst_rect.height <= 0 || src_rect.width <= 0 || src_rect.height <= 0 ) return;
 
-            // fill middle
-            new_gaussian.gaussian_kernel[blur_radius] = 1;
-            new_gaussian.gaussian_kernelSum += 1;
+        float u0 = static_cast<float>(src_rect.x) / size;
+        float v0 = static_cast<float>(src_rect.y) / size;
+        float u1 = static_cast<float>(src_rect.x + src_rect.width) / size;
+        float v1 = static_cast<float>(src_rect.y + src_rect.height) / size;
 
-            // running sum (gives us a lookup table of pre-convolved results)
-            float sum = 0;
-            for(int i = 0; i <= kernel_size; i++)
-            {
-                sum += new_gaussian.gaussian_kernel[i];
-                new_gaussian.gaussian_kernel[i] = sum;
-            }
+        if ( flip == sk_FLIP_HORIZONTAL || flip == sk_FLIP_BOTH ) std::swap(u0, u1);
+        if ( flip == sk_FLIP_VERTICAL || flip == sk_FLIP_BOTH ) std::swap(v0, v1);
 
-            // fill the 2D bitmap based on the pre-convolved results
-            for(int y = 0; y < kernel_size; y++)
-            {
-                for(int x = 0; x < kernel_size; x++)
-                {
-                    float kernel_sum = new_gaussian.gaussian_kernel[kernel_size-1];
-                    kernel_sum *= kernel_sum;
+        float x0 = static_cast<float>(static_cast<int>(dst_rect.x));
+        float y0 = static_cast<float>(static_cast<int>(dst_rect.y));
+        float x1 = x0 + static_cast<int>(dst_rect.width);
+        float y1 = y0 + static_cast<int>(dst_rect.height);
 
-                    float local_sum = new_gaussian.gaussian_kernel[x] * new_gaussian.gaussian_kernel[y];
+        int base = static_cast<int>(_sk_blur_vertices.size());
 
-                    sk_set_bitmap_pixel(&new_gaussian.texture, {1.f, 1.f, 1.f, ((local_sum/kernel_sum))}, x, y);
-                }
-            }
+        _sk_blur_vertices.push_back({ { x0, y0 }, clr, { u0, v0 } });
+        _sk_blur_vertices.push_back({ { x1, y0 }, clr, { u1, v0 } });
+        _sk_blur_vertices.push_back({ { x1, y1 }, clr, { u1, v1 } });
+        _sk_blur_vertices.push_back({ { x0, y1 }, clr, { u0, v1 } });
 
-            sk_refresh_bitmap(&new_gaussian.texture);
+        _sk_blur_indices.insert(_sk_blur_indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+    }
 
-            // done!
-            gaussian_cache.push_back(new_gaussian);
-            gaussian = &gaussian_cache[gaussian_cache.size()-1];
-        }
+    void sk_draw_blurred_rect(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height, int blur_radius)
+    {
+        if ( ! surface || ! surface->_data ) return;
+
+        sk_gaussian_cached_info *gaussian = _sk_gaussian_kernel(blur_radius);
+
+        int kernel_size = blur_radius * 2 + 1;
 
         // do everything with doubles to avoid casting continuously later on
         double radius_d = (double)kernel_size;
@@ -1251,33 +2090,67 @@ namespace splashkit_lib
         x = (int)x;
         y = (int)y;
 
-        // finally we draw
+        // the color is applied through the vertices, and all nine pieces are
+        // drawn together from the kernel texture
+        SDL_Color sdl_clr = _sk_to_sdl_color(clr);
+        float size = static_cast<float>(kernel_size);
 
-        // set rectangle color
-        sk_set_bitmap_tint(&gaussian->texture, {clr.r, clr.g, clr.b, clr.a});
+        _sk_blur_vertices.clear();
+        _sk_blur_indices.clear();
 
         // top left corner
-        _sk_draw_bitmap_remapped(&gaussian->texture, surface, {0, 0, radius_d_w, radius_d_h}, {x-radius_d_w, y-radius_d_h, radius_d_w, radius_d_h}, sk_FLIP_NONE);
+        _sk_add_blur_piece(size, sdl_clr, {0, 0, radius_d_w, radius_d_h}, {x-radius_d_w, y-radius_d_h, radius_d_w, radius_d_h}, sk_FLIP_NONE);
         // top right corner
-        _sk_draw_bitmap_remapped(&gaussian->texture, surface, {0, 0, radius_d_w, radius_d_h}, {x+width, y-radius_d_h, radius_d_w, radius_d_h}, sk_FLIP_HORIZONTAL);
+        _sk_add_blur_piece(size, sdl_clr, {0, 0, radius_d_w, radius_d_h}, {x+width, y-radius_d_h, radius_d_w, radius_d_h}, sk_FLIP_HORIZONTAL);
 
         // bottom left corner
-        _sk_draw_bitmap_remapped(&gaussian->texture, surface, {0, 0, radius_d_w, radius_d_h}, {x-radius_d_w, y+height, radius_d_w, radius_d_h}, sk_FLIP_VERTICAL);
+        _sk_add_blur_piece(size, sdl_clr, {0, 0, radius_d_w, radius_d_h}, {x-radius_d_w, y+height, radius_d_w, radius_d_h}, sk_FLIP_VERTICAL);
         // bottom right corner
-        _sk_draw_bitmap_remapped(&gaussian->texture, surface, {0, 0, radius_d_w, radius_d_h}, {x+width, y+height, radius_d_w, radius_d_h}, sk_FLIP_BOTH);
+        _sk_add_blur_piece(size, sdl_clr, {0, 0, radius_d_w, radius_d_h}, {x+width, y+height, radius_d_w, radius_d_h}, sk_FLIP_BOTH);
 
         // top edge
-        _sk_draw_bitmap_remapped(&gaussian->texture, surface, {radius_d_w-1, 0, 1, radius_d_h}, {x, y-radius_d_h, width, radius_d_h}, sk_FLIP_NONE);
+        _sk_add_blur_piece(size, sdl_clr, {radius_d_w-1, 0, 1, radius_d_h}, {x, y-radius_d_h, width, radius_d_h}, sk_FLIP_NONE);
         // bottom edge
-        _sk_draw_bitmap_remapped(&gaussian->texture, surface, {radius_d_w-1, 0, 1, radius_d_h}, {x, y+height, width, radius_d_h}, sk_FLIP_VERTICAL);
+        _sk_add_blur_piece(size, sdl_clr, {radius_d_w-1, 0, 1, radius_d_h}, {x, y+height, width, radius_d_h}, sk_FLIP_VERTICAL);
 
         // left edge
-        _sk_draw_bitmap_remapped(&gaussian->texture, surface, {0, radius_d_h-1, radius_d_w, 1}, {x-radius_d_w, y, radius_d_w, height}, sk_FLIP_NONE);
+        _sk_add_blur_piece(size, sdl_clr, {0, radius_d_h-1, radius_d_w, 1}, {x-radius_d_w, y, radius_d_w, height}, sk_FLIP_NONE);
         // right edge
-        _sk_draw_bitmap_remapped(&gaussian->texture, surface, {0, radius_d_h-1, radius_d_w, 1}, {x+width, y, radius_d_w, height}, sk_FLIP_HORIZONTAL);
+        _sk_add_blur_piece(size, sdl_clr, {0, radius_d_h-1, radius_d_w, 1}, {x+width, y, radius_d_w, height}, sk_FLIP_HORIZONTAL);
 
         // center (could just as easily draw an actual rectangle here...)
-        _sk_draw_bitmap_remapped(&gaussian->texture, surface, {radius_d_w-1, radius_d_h-1, 1, 1}, {x, y, width, height}, sk_FLIP_NONE);
+        _sk_add_blur_piece(size, sdl_clr, {radius_d_w-1, radius_d_h-1, 1, 1}, {x, y, width, height}, sk_FLIP_NONE);
+
+        if ( _sk_blur_indices.empty() ) return;
+
+        if ( _sk_batching && _sk_num_open_windows > 0 )
+        {
+            _sk_batch_target(surface, &gaussian->texture);
+            _sk_batch.vertices.insert(_sk_batch.vertices.end(), _sk_blur_vertices.begin(), _sk_blur_vertices.end());
+
+            int base = static_cast<int>(_sk_batch.vertices.size() - _sk_blur_vertices.size());
+            for (int idx : _sk_blur_indices)
+                _sk_batch.indices.push_back(base + idx);
+            return;
+        }
+
+        unsigned int count = _sk_renderer_count(surface);
+
+        for (unsigned int i = 0; i < count; i++)
+        {
+            SDL_Renderer *renderer = _sk_prepared_renderer(surface, i);
+            SDL_Texture *texture = _sk_bitmap_texture_for(&gaussian->texture, surface, i);
+
+            if ( texture )
+            {
+                _sk_render_geometry(renderer,
+                                   texture,
+                                   _sk_blur_vertices.data(), static_cast<int>(_sk_blur_vertices.size()),
+                                   _sk_blur_indices.data(), static_cast<int>(_sk_blur_indices.size()));
+            }
+
+            _sk_complete_render(surface, i);
+        }
     }
 
 
@@ -1305,6 +2178,7 @@ namespace splashkit_lib
                                    static_cast<Uint8>(clr.b * 255),
                                    static_cast<Uint8>(clr.a * 255));
 
+            _sk_count_untextured_draw();
             SDL_RenderDrawLine(renderer, px1, py1, px2, py2);
             SDL_RenderDrawLine(renderer, px2, py2, px3, py3);
             SDL_RenderDrawLine(renderer, px3, py3, px1, py1);
@@ -1317,6 +2191,26 @@ namespace splashkit_lib
     {
         if ( ! surface || ! surface->_data ) return;
 
+        if ( sk_raster_target *raster = _sk_software_target(surface) )
+        {
+            double xs[3] = { x1, x2, x3 };
+            double ys[3] = { y1, y2, y3 };
+            sk_raster_fill_polygon(raster, _sk_to_raster_color(_sk_to_sdl_color(clr)), xs, ys, 3);
+            return;
+        }
+
+        if ( _sk_batching )
+        {
+            SDL_Color sdl_clr = _sk_to_sdl_color(clr);
+
+            _sk_batch_target(surface, nullptr);
+            _sk_batch_triangle(
+                { { static_cast<float>(x1), static_cast<float>(y1) }, sdl_clr, { 0, 0 } },
+                { { static_cast<float>(x2), static_cast<float>(y2) }, sdl_clr, { 0, 0 } },
+                { { static_cast<float>(x3), static_cast<float>(y3) }, sdl_clr, { 0, 0 } });
+            return;
+        }
+
         unsigned int count = _sk_renderer_count(surface);
 
         for (unsigned int i = 0; i < count; i++)
@@ -1346,70 +2240,160 @@ namespace splashkit_lib
     //  Ellipse
     //
 
-    void sk_draw_ellipse(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height)
-    {
-        if ( ! surface || ! surface->_data ) return;
+    //
+    // Circles and ellipses are drawn as triangles around a cached unit
+    // circle. Larger shapes need more segments to look round, so the unit
+    // circles are kept in buckets of 8, 16, ... 512 segments, and each shape
+    // uses the smallest bucket that keeps its edge within a quarter pixel of
+    // the true curve. The edge fades out over one pixel to smooth it.
+    //
+    #define _SK_CIRCLE_BUCKETS 7
 
-        // 4 values = 1 point w + h
-        int x1 = static_cast<int>(x), y1 = static_cast<int>(y);
-        int w = static_cast<int>(width), h = static_cast<int>(height);
+    static vector<SDL_FPoint> _sk_unit_circles[_SK_CIRCLE_BUCKETS];
+    static vector<SDL_Vertex> _sk_shape_vertices;
+    static vector<int> _sk_shape_indices;
 
-        unsigned int count = _sk_renderer_count(surface);
+    static const vector<SDL_FPoint> & _sk_unit_circle(double radius)
+    {
+        int bucket = 0;
+        int segments = 8;
 
-        for (unsigned int i = 0; i < count; i++)
+        if ( radius > 1 )
         {
-            SDL_Renderer *renderer = _sk_prepared_renderer(surface, i);
-            Uint8 a = static_cast<Uint8>(clr.a * 255);
-            ellipseRGBA( renderer,
-                        static_cast<Sint16>(x1 + w / 2),
-                        static_cast<Sint16>(y1 + h / 2),
-                        static_cast<Sint16>(w / 2),
-                        static_cast<Sint16>(h / 2),
-                        static_cast<Uint8>(clr.r * 255),
-                        static_cast<Uint8>(clr.g * 255),
-                        static_cast<Uint8>(clr.b * 255), a);
-
-            if ( a == 255 ) // SDL_Gfx changes renderer state ... undo change here
+            double needed = M_PI / acos(1 - 0.25 / radius);
+            while ( bucket < _SK_CIRCLE_BUCKETS - 1 && segments < needed )
             {
-                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+                segments *= 2;
+                bucket++;
             }
+        }
 
-            _sk_complete_render(surface, i);
+        vector<SDL_FPoint> &result = _sk_unit_circles[bucket];
+        if ( result.empty() )
+        {
+            result.reserve(segments);
+            for (int i = 0; i < segments; i++)
+            {
+                double angle = 2 * M_PI * i / segments;
+                result.push_back({ static_cast<float>(cos(angle)), static_cast<float>(sin(angle)) });
+            }
         }
-    }
 
-    void sk_fill_ellipse(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height)
+        return result;
+    }
+
+    // Add a ring of vertices around cx, cy that is d pixels outside the ellipse
+    static void _sk_add_ellipse_ring(vector<SDL_Vertex> &vertices, const vector<SDL_FPoint> &unit, float cx, float cy, float rx, float ry, float d, SDL_Color clr)
     {
-        if ( ! surface || ! surface->_data ) return;
+        float ex = std::max(rx + d, 0.0f);
+        float ey = std::max(ry + d, 0.0f);
 
-        // 4 values = 1 point w + h
-        int x1 = static_cast<int>(x), y1 = static_cast<int>(y);
-        int w = static_cast<int>(width), h = static_cast<int>(height);
+        for (const SDL_FPoint &pt : unit)
+            vertices.push_back({ { cx + pt.x * ex, cy + pt.y * ey }, clr, { 0, 0 } });
+    }
+
+    // Join two rings of n vertices, starting at a and b, with triangles
+    static void _sk_join_ellipse_rings(vector<int> &indices, int a, int b, int n)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            int j = (i + 1) % n;
+            indices.insert(indices.end(), { a + i, b + i, b + j, a + i, b + j, a + j });
+        }
+    }
+
+    //
+    // Add the triangles for an ellipse centred on cx, cy. A filled ellipse is
+    // a fan from the centre, and an outline is a band one pixel either side
+    // of the edge. Both fade to transparent over their outer pixel.
+    //
+    static void _sk_tessellate_ellipse(vector<SDL_Vertex> &vertices, vector<int> &indices, float cx, float cy, float rx, float ry, SDL_Color clr, bool filled)
+    {
+        const vector<SDL_FPoint> &unit = _sk_unit_circle(std::max(rx, ry));
+        int n = static_cast<int>(unit.size());
+        int base = static_cast<int>(vertices.size());
+        SDL_Color clear = { clr.r, clr.g, clr.b, 0 };
+
+        if ( filled )
+        {
+            vertices.push_back({ { cx, cy }, clr, { 0, 0 } });
+            _sk_add_ellipse_ring(vertices, unit, cx, cy, rx, ry, -0.5f, clr);
+            _sk_add_ellipse_ring(vertices, unit, cx, cy, rx, ry, 0.5f, clear);
+
+            for (int i = 0; i < n; i++)
+                indices.insert(indices.end(), { base, base + 1 + i, base + 1 + (i + 1) % n });
+
+            _sk_join_ellipse_rings(indices, base + 1, base + 1 + n, n);
+        }
+        else
+        {
+            _sk_add_ellipse_ring(vertices, unit, cx, cy, rx, ry, -1.0f, clear);
+            _sk_add_ellipse_ring(vertices, unit, cx, cy, rx, ry, 0.0f, clr);
+            _sk_add_ellipse_ring(vertices, unit, cx, cy, rx, ry, 1.0f, clear);
+
+            _sk_join_ellipse_rings(indices, base, base + n, n);
+            _sk_join_ellipse_rings(indices, base + n, base + 2 * n, n);
+        }
+    }
+
+    //
+    // Draw an ellipse, adding it to the batch when batching is on, or
+    // submitting it as a single geometry call to each renderer.
+    //
+    static void _sk_render_ellipse(sk_drawing_surface *surface, sk_color clr, double cx, double cy, double rx, double ry, bool filled)
+    {
+        SDL_Color sdl_clr = _sk_to_sdl_color(clr);
+        float fcx = static_cast<float>(cx), fcy = static_cast<float>(cy);
+        float frx = static_cast<float>(std::abs(rx)), fry = static_cast<float>(std::abs(ry));
+
+        sk_raster_target *raster = filled ? _sk_software_target(surface) : nullptr;
+        if ( raster )
+        {
+            sk_raster_fill_ellipse(raster, _sk_to_raster_color(sdl_clr), cx, cy, std::abs(rx), std::abs(ry));
+            return;
+        }
+
+        if ( _sk_batching )
+        {
+            _sk_batch_target(surface, nullptr);
+            _sk_tessellate_ellipse(_sk_batch.vertices, _sk_batch.indices, fcx, fcy, frx, fry, sdl_clr, filled);
+            return;
+        }
+
+        _sk_shape_vertices.clear();
+        _sk_shape_indices.clear();
+        _sk_tessellate_ellipse(_sk_shape_vertices, _sk_shape_indices, fcx, fcy, frx, fry, sdl_clr, filled);
 
         unsigned int count = _sk_renderer_count(surface);
 
         for (unsigned int i = 0; i < count; i++)
         {
             SDL_Renderer *renderer = _sk_prepared_renderer(surface, i);
-            Uint8 a = static_cast<Uint8>(clr.a * 255);
-            filledEllipseRGBA(renderer,
-                              static_cast<Sint16>(x1 + w / 2),
-                              static_cast<Sint16>(y1 + h / 2),
-                              static_cast<Sint16>(w / 2),
-                              static_cast<Sint16>(h / 2),
-                              static_cast<Uint8>(clr.r * 255),
-                              static_cast<Uint8>(clr.g * 255),
-                              static_cast<Uint8>(clr.b * 255), a);
 
-            if ( a == 255 ) // SDL_Gfx changes renderer state ... undo change here
-            {
-                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-            }
+            _sk_render_geometry(renderer,
+                               nullptr,
+                               _sk_shape_vertices.data(), static_cast<int>(_sk_shape_vertices.size()),
+                               _sk_shape_indices.data(), static_cast<int>(_sk_shape_indices.size()));
 
             _sk_complete_render(surface, i);
         }
     }
 
+    void sk_draw_ellipse(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height)
+    {
+        if ( ! surface || ! surface->_data ) return;
+
+        _sk_render_ellipse(surface, clr, x + width / 2, y + height / 2, width / 2, height / 2, false);
+    }
+
+    void sk_fill_ellipse(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height)
+    {
+        if ( ! surface || ! surface->_data ) return;
+
+
+        _sk_render_ellipse(surface, clr, x + width / 2, y + height / 2, width / 2, height / 2, true);
+    }
+
 
     //
     // Pixel
@@ -1419,6 +2403,18 @@ namespace splashkit_lib
     {
         if ( ! surface || ! surface->_data ) return;
 
+        if ( sk_raster_target *raster = _sk_software_target(surface) )
+        {
+            sk_raster_fill_rect(raster, _sk_to_raster_color(_sk_to_sdl_color(clr)), static_cast<int>(x), static_cast<int>(y), 1, 1);
+            return;
+        }
+
+        if ( _sk_batching )
+        {
+            _sk_batch_rect(surface, _sk_to_sdl_color(clr), static_cast<int>(x), static_cast<int>(y), 1, 1);
+            return;
+        }
+
         unsigned int count = _sk_renderer_count(surface);
 
         for (unsigned int i = 0; i < count; i++)
@@ -1440,6 +2436,7 @@ namespace splashkit_lib
             // when multisample is 1, but without multisample 1
             // double buffer causes flicker
             //
+            _sk_count_untextured_draw();
             SDL_RenderDrawPoint(renderer, x, y);
 
             _sk_complete_render(surface, i);
@@ -1447,46 +2444,152 @@ namespace splashkit_lib
 
     }
 
+    //
+    // Get an RGBA8888 surface that pixels can be written to directly, reading
+    // back what has been drawn when the bitmap only exists as a texture.
+    //
+    SDL_Surface * _sk_bitmap_pixel_surface(sk_drawing_surface *surface, sk_bitmap_be *bitmap_be)
+    {
+        if (bitmap_be->surface == nullptr)
+        {
+            bitmap_be->surface = SDL_CreateRGBSurfaceWithFormat(0, surface->width, surface->height, 32, SDL_PIXELFORMAT_RGBA8888);
+            if ( ! bitmap_be->surface ) return nullptr;
+
+            if ( bitmap_be->drawable && _sk_bitmap_texture_source(bitmap_be) >= 0 && bitmap_be->surface->pitch == surface->width * 4 )
+            {
+                int sz = surface->width * surface->height;
+                _sk_bitmap_be_texture_to_pixels(bitmap_be, static_cast<int *>(bitmap_be->surface->pixels), sz, 0, 0, surface->width, surface->height);
+            }
+        }
+        else if (bitmap_be->surface->format->format != SDL_PIXELFORMAT_RGBA8888)
+        {
+            SDL_Surface *converted = SDL_ConvertSurfaceFormat(bitmap_be->surface, SDL_PIXELFORMAT_RGBA8888, 0);
+            if ( ! converted ) return nullptr;
+
+            SDL_FreeSurface(bitmap_be->surface);
+            bitmap_be->surface = converted;
+        }
+
+        // ensure we can write to it
+
+        if (SDL_MUSTLOCK(bitmap_be->surface) && bitmap_be->surface->locked == 0)
+        {
+            if (SDL_LockSurface(bitmap_be->surface))
+                return nullptr;
+        }
+
+        return bitmap_be->surface;
+    }
+
+    //
+    // Grow the area of the bitmap that needs to be uploaded on the next refresh
+    //
+    void _sk_mark_bitmap_dirty(sk_bitmap_be *bitmap_be, const SDL_Rect &area)
+    {
+        _sk_bitmap_changed(bitmap_be);
+
+        if ( bitmap_be->dirty.w <= 0 || bitmap_be->dirty.h <= 0 )
+        {
+            bitmap_be->dirty = area;
+            return;
+        }
+
+        SDL_Rect result;
+        SDL_UnionRect(&bitmap_be->dirty, &area, &result);
+        bitmap_be->dirty = result;
+    }
+
     void sk_set_bitmap_pixel(sk_drawing_surface *surface, sk_color clr, int x, int y)
     {
+        sk_flush_draw_batch();
+
         // ensure we are operating on an SGDS_Bitmap
 
         if (surface->kind != SGDS_Bitmap)
             return;
 
+        if (x < 0 || x >= surface->width || y < 0 || y >= surface->height)
+            return;
+
         sk_bitmap_be * bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
 
-        // ensure surface exists
+        SDL_Surface *pixel_surface = _sk_bitmap_pixel_surface(surface, bitmap_be);
+        if ( ! pixel_surface ) return;
 
-        if (bitmap_be->surface == nullptr)
-        {
-            bitmap_be->surface = SDL_CreateRGBSurfaceWithFormat(0, surface->width, surface->height, 32, SDL_PIXELFORMAT_RGBA8888);
-        }
+        // write to it, the surface is always RGBA8888
 
-        // ensure we can write to it
+        Uint32* pixels = static_cast<Uint32 *>(pixel_surface->pixels);
+        int index = x + (pixel_surface->pitch * y / 4);
+        pixels[index] = static_cast<Uint32>(clr.r * 255) << 24 |
+                        static_cast<Uint32>(clr.g * 255) << 16 |
+                        static_cast<Uint32>(clr.b * 255) << 8 |
+                        static_cast<Uint32>(clr.a * 255);
+
+        _sk_mark_bitmap_dirty(bitmap_be, {x, y, 1, 1});
+    }
+
+    void sk_set_bitmap_pixels(sk_drawing_surface *surface, const uint32_t *pixels, int x, int y, int width, int height)
+    {
+        sk_flush_draw_batch();
+
+        if (surface->kind != SGDS_Bitmap || ! pixels)
+            return;
+
+        // clip the area to the bitmap, keeping track of where source rows start
+        SDL_Rect area = { x, y, width, height };
+        SDL_Rect bounds = { 0, 0, surface->width, surface->height };
+        SDL_Rect clipped;
+
+        if ( ! SDL_IntersectRect(&area, &bounds, &clipped) )
+            return;
 
-        if (SDL_MUSTLOCK(bitmap_be->surface))
+        sk_bitmap_be * bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+
+        SDL_Surface *pixel_surface = _sk_bitmap_pixel_surface(surface, bitmap_be);
+        if ( ! pixel_surface ) return;
+
+        const uint32_t *src = pixels + (clipped.y - y) * width + (clipped.x - x);
+        Uint8 *dst = static_cast<Uint8 *>(pixel_surface->pixels) + clipped.y * pixel_surface->pitch + clipped.x * 4;
+
+        for (int row = 0; row < clipped.h; row++)
         {
-            if (SDL_LockSurface(bitmap_be->surface))
-                return;
+            memcpy(dst, src, static_cast<size_t>(clipped.w) * 4);
+            src += width;
+            dst += pixel_surface->pitch;
         }
 
-        // write to it
+        _sk_mark_bitmap_dirty(bitmap_be, clipped);
+        sk_refresh_bitmap(surface);
+    }
+
+    //
+    // Copy the surface pixels within area into the streaming texture
+    //
+    void _sk_upload_bitmap_area(SDL_Texture *tex, SDL_Surface *surface, const SDL_Rect &area)
+    {
+        void *pixels;
+        int pitch;
 
-        int* pixels = (int*)bitmap_be->surface->pixels;
-        if (x >= 0 && x < surface->width && y >= 0 && y < surface->height)
+        if ( SDL_LockTexture(tex, &area, &pixels, &pitch) )
+            return;
+
+        const Uint8 *src = static_cast<const Uint8 *>(surface->pixels) + area.y * surface->pitch + area.x * 4;
+        Uint8 *dst = static_cast<Uint8 *>(pixels);
+
+        for (int row = 0; row < area.h; row++)
         {
-            int index = x + (bitmap_be->surface->pitch * y / 4);
-            pixels[index] = SDL_MapRGBA(bitmap_be->surface->format,
-                                        static_cast<Uint8>(clr.r * 255),
-                                        static_cast<Uint8>(clr.g * 255),
-                                        static_cast<Uint8>(clr.b * 255),
-                                        static_cast<Uint8>(clr.a * 255));
+            memcpy(dst, src, static_cast<size_t>(area.w) * 4);
+            src += surface->pitch;
+            dst += pitch;
         }
+
+        SDL_UnlockTexture(tex);
     }
 
     void sk_refresh_bitmap(sk_drawing_surface *surface)
     {
+        sk_flush_draw_batch();
+
         // ensure we are operating on an SGDS_Bitmap
 
         if (surface->kind != SGDS_Bitmap)
@@ -1495,32 +2598,55 @@ namespace splashkit_lib
         sk_bitmap_be * bitmap_be;
         bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
 
+        if ( ! bitmap_be->surface )
+            return;
+
+        // changed pixels are uploaded to the bitmap's own textures
+        _sk_leave_atlas(bitmap_be);
+
         // unlock surface
 
-        SDL_UnlockSurface(bitmap_be->surface);
+        if ( bitmap_be->surface->locked )
+            SDL_UnlockSurface(bitmap_be->surface);
+
+        if ( bitmap_be->streaming && ! bitmap_be->drawable )
+        {
+            // upload only the changed area to the existing textures
+            if ( bitmap_be->dirty.w > 0 && bitmap_be->dirty.h > 0 )
+            {
+                for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+                {
+                    if ( bitmap_be->texture[i] )
+                        _sk_upload_bitmap_area(bitmap_be->texture[i], bitmap_be->surface, bitmap_be->dirty);
+                }
+            }
+
+            bitmap_be->dirty = {0, 0, 0, 0};
+            return;
+        }
+
+        // Switch to streaming textures, which are created from the surface when next needed
 
-        // recreate all textures from the surface
+        bitmap_be->drawable = false;
+        bitmap_be->streaming = bitmap_be->surface->format->format == SDL_PIXELFORMAT_RGBA8888;
+        bitmap_be->dirty = {0, 0, 0, 0};
 
         for (unsigned int i = 0; i < _sk_num_open_windows; i++)
         {
-            SDL_Renderer *renderer = _sk_open_windows[i]->renderer;
-
             SDL_Texture *orig_tex = bitmap_be->texture[i];
 
-            // Create new texture
-            SDL_Texture *tex = SDL_CreateTextureFromSurface(_sk_open_windows[i]->renderer, bitmap_be->surface);
-            bitmap_be->texture[i] = tex;
+            if ( ! orig_tex ) continue;
 
-            // Destroy old
-            SDL_DestroyTexture(orig_tex);
+            bitmap_be->texture[i] = nullptr;
+            _sk_destroy_bitmap_texture(orig_tex);
+            _sk_bitmap_texture(bitmap_be, i);
         }
-
-        // Set drawable to false
-        bitmap_be->drawable = false;
     }
 
     void sk_set_bitmap_tint(sk_drawing_surface *surface, sk_color clr)
     {
+        sk_flush_draw_batch();
+
         // ensure we are operating on an SGDS_Bitmap
 
         if (surface->kind != SGDS_Bitmap)
@@ -1529,19 +2655,136 @@ namespace splashkit_lib
         sk_bitmap_be * bitmap_be;
         bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
 
+        // Remember the tint for textures created later
+        bitmap_be->tint = {
+            static_cast<Uint8>(clr.r * 255),
+            static_cast<Uint8>(clr.g * 255),
+            static_cast<Uint8>(clr.b * 255),
+            static_cast<Uint8>(clr.a * 255)
+        };
+
         for (unsigned int i = 0; i < _sk_num_open_windows; i++)
         {
+            if ( ! bitmap_be->texture[i] ) continue;
+
             SDL_SetTextureColorMod(bitmap_be->texture[i], static_cast<Uint8>(clr.r * 255),
                                                           static_cast<Uint8>(clr.g * 255),
                                                           static_cast<Uint8>(clr.b * 255)
             );
             SDL_SetTextureAlphaMod(bitmap_be->texture[i], static_cast<Uint8>(clr.a * 255));
         }
+
+        for (int i = 0; i < bitmap_be->mip_count; i++)
+        {
+            sk_set_bitmap_tint(&bitmap_be->mips[i], clr);
+        }
+    }
+
+    void sk_set_bitmap_premultiplied(sk_drawing_surface *surface, bool value)
+    {
+        sk_flush_draw_batch();
+
+        if ( ! surface || surface->kind != SGDS_Bitmap )
+            return;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+
+        bitmap_be->premultiplied = value;
+
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        {
+            if ( bitmap_be->texture[i] ) _sk_apply_bitmap_blend_mode(bitmap_be, bitmap_be->texture[i]);
+        }
+
+        for (int i = 0; i < bitmap_be->mip_count; i++)
+        {
+            sk_set_bitmap_premultiplied(&bitmap_be->mips[i], value);
+        }
+    }
+
+    void sk_bitmap_memory(sk_drawing_surface *surface, size_t *cpu_bytes, size_t *gpu_bytes)
+    {
+        *cpu_bytes = 0;
+        *gpu_bytes = 0;
+
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+
+        if ( bitmap_be->surface )
+            *cpu_bytes = static_cast<size_t>(bitmap_be->surface->pitch) * bitmap_be->surface->h;
+        if ( bitmap_be->snapshot )
+            *cpu_bytes += static_cast<size_t>(surface->width) * surface->height * 4;
+
+        for (int i = 0; i < bitmap_be->mip_count; i++)
+        {
+            size_t mip_cpu, mip_gpu;
+            sk_bitmap_memory(&bitmap_be->mips[i], &mip_cpu, &mip_gpu);
+            *cpu_bytes += mip_cpu;
+            *gpu_bytes += mip_gpu;
+        }
+
+        // Textures are 32 bits per pixel, one for each window the bitmap was drawn to
+        if ( bitmap_be->texture )
+        {
+            for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+            {
+                if ( bitmap_be->texture[i] )
+                    *gpu_bytes += static_cast<size_t>(surface->width) * surface->height * 4;
+            }
+        }
+    }
+
+    bool sk_bitmap_matches_source(sk_drawing_surface *surface)
+    {
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return false;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+        const SDL_Color &tint = bitmap_be->tint;
+
+        return ! bitmap_be->drawable && ! bitmap_be->streaming && ! bitmap_be->window_affinity &&
+            tint.r == 255 && tint.g == 255 && tint.b == 255 && tint.a == 255;
+    }
+
+    void sk_set_bitmap_window_affinity(sk_drawing_surface *bitmap, sk_drawing_surface *window)
+    {
+        sk_flush_draw_batch();
+
+        if ( ! bitmap || bitmap->kind != SGDS_Bitmap )
+            return;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(bitmap->_data);
+
+        // Clearing the affinity lets the bitmap be copied to other windows again
+        bitmap_be->window_affinity = nullptr;
+
+        if ( ! window || window->kind != SGDS_Window )
+            return;
+
+        sk_window_be *window_be = static_cast<sk_window_be *>(window->_data);
+        unsigned int idx = window_be->idx;
+
+        _sk_leave_atlas(bitmap_be);
+
+        // Make sure this window holds the pixels before the other copies are removed
+        _sk_bitmap_texture(bitmap_be, idx);
+        bitmap_be->window_affinity = window_be;
+
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        {
+            if ( i != idx && bitmap_be->texture[i] )
+            {
+                _sk_destroy_bitmap_texture(bitmap_be->texture[i]);
+                bitmap_be->texture[i] = nullptr;
+            }
+        }
     }
 
 
     sk_color sk_read_pixel(sk_drawing_surface *surface, int x, int y)
     {
+        sk_flush_draw_batch();
+
         sk_color result = {0,0,0,0};
         unsigned int clr = 0;
         
@@ -1549,10 +2792,36 @@ namespace splashkit_lib
 
         if ( ! surface || ! surface->_data ) return result;
 
+        sk_bitmap_be *bitmap_be = nullptr;
+        int reads = 0;
+
+        if ( surface->kind == SGDS_Bitmap )
+        {
+            if ( x < 0 || y < 0 || x >= surface->width || y >= surface->height ) return result;
+
+            // one read is likely a lone check, a second suggests many more to come
+            bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+            reads = bitmap_be->reads_since_change + 1;
+            if ( reads > 1 ) sk_snapshot_bitmap(surface);
+
+            if ( bitmap_be->snapshot_valid )
+            {
+                uint32_t px = bitmap_be->snapshot[y * surface->width + x];
+                result.r = ((px & 0xff000000) >> 24) / 255.0f;
+                result.g = ((px & 0x00ff0000) >> 16) / 255.0f;
+                result.b = ((px & 0x0000ff00) >> 8) / 255.0f;
+                result.a = (px & 0x000000ff) / 255.0f;
+                return result;
+            }
+        }
+
         if ( _sk_num_open_windows == 0 ) _sk_create_initial_window();
 
         SDL_Renderer *renderer = _sk_prepared_renderer(surface, 0);
 
+        // preparing the bitmap as a target counts as a change
+        if ( bitmap_be ) bitmap_be->reads_since_change = reads;
+
         SDL_RenderReadPixels(renderer,
                              &rect,
                              SDL_PIXELFORMAT_RGBA8888,
@@ -1569,78 +2838,231 @@ namespace splashkit_lib
     }
 
 
-    //
-    // Circles
-    //
-
-    void sk_draw_circle(sk_drawing_surface *surface, sk_color clr, double x, double y, double radius)
+    bool sk_snapshot_bitmap(sk_drawing_surface *surface)
     {
-        if ( ! surface || ! surface->_data ) return;
+        sk_flush_draw_batch();
 
-        // 3 values = 1 point + radius
-        int x1 = static_cast<int>(x), y1 = static_cast<int>(y);
-        int r = static_cast<int>(radius);
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return false;
 
-        unsigned int count = _sk_renderer_count(surface);
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+        if ( bitmap_be->snapshot_valid ) return true;
 
-        for (unsigned int i = 0; i < count; i++)
-        {
-            SDL_Renderer *renderer = _sk_prepared_renderer(surface, i);
-            Uint8 a = static_cast<Uint8>(clr.a * 255);
+        int count = surface->width * surface->height;
+        if ( count <= 0 ) return false;
 
-            circleRGBA(
-                       renderer,
-                       static_cast<Sint16>(x1),
-                       static_cast<Sint16>(y1),
-                       static_cast<Sint16>(r),
-                       static_cast<Uint8>(clr.r * 255),
-                       static_cast<Uint8>(clr.g * 255),
-                       static_cast<Uint8>(clr.b * 255),
-                       a
-                       );
+        // bitmaps do not change size, so the buffer is kept for later snapshots
+        if ( ! bitmap_be->snapshot )
+            bitmap_be->snapshot = static_cast<uint32_t *>(malloc(sizeof(uint32_t) * count));
+        if ( ! bitmap_be->snapshot ) return false;
 
-            if ( a == 255 ) // SDL_Gfx changes renderer state ... undo change here
-            {
-                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-            }
+        // bitmaps that released their surface are only read from a drawable texture
+        if ( ! bitmap_be->surface && ! bitmap_be->drawable ) _sk_make_drawable(bitmap_be);
 
-            _sk_complete_render(surface, i);
-        }
+        sk_to_pixels(surface, 0, 0, surface->width, surface->height, reinterpret_cast<int *>(bitmap_be->snapshot), count);
+
+        // reading the pixels may have prepared the bitmap as a target
+        bitmap_be->snapshot_valid = true;
+        return true;
     }
 
-    void sk_fill_circle(sk_drawing_surface *surface, sk_color clr, double x, double y, double radius)
+    bool sk_bitmap_has_snapshot(sk_drawing_surface *surface)
     {
-        if ( ! surface || ! surface->_data ) return;
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return false;
 
-        // 3 values = 1 point + radius
-        int x1 = static_cast<int>(x), y1 = static_cast<int>(y);
-        int r = static_cast<int>(radius);
+        return static_cast<sk_bitmap_be *>(surface->_data)->snapshot_valid;
+    }
 
-        unsigned int count = _sk_renderer_count(surface);
+    //
+    // Mip levels halve the bitmap each time, averaging each 2x2 block of
+    // pixels. Colours are weighted by their alpha, so transparent pixels do
+    // not darken the edges of shapes, unless the colours are premultiplied
+    // already. Levels stop once they are smaller than 8 pixels.
+    //
+    #define SK_MAX_MIP_LEVELS 6
+    #define SK_MIN_MIP_SIZE 8
 
-        for (unsigned int i = 0; i < count; i++)
+    static void _sk_free_bitmap_mips(sk_bitmap_be *bitmap_be)
+    {
+        for (int i = 0; i < bitmap_be->mip_count; i++)
         {
-            SDL_Renderer *renderer = _sk_prepared_renderer(surface, i);
-            Uint8 a = static_cast<Uint8>(clr.a * 255);
+            _sk_destroy_bitmap(static_cast<sk_bitmap_be *>(bitmap_be->mips[i]._data));
+        }
+        free(bitmap_be->mips);
 
-            filledCircleRGBA(
-                             renderer,
-                             static_cast<Sint16>(x1),
-                             static_cast<Sint16>(y1),
-                             static_cast<Sint16>(r),
-                             static_cast<Uint8>(clr.r * 255),
-                             static_cast<Uint8>(clr.g * 255),
-                             static_cast<Uint8>(clr.b * 255),
-                             a
-                             );
+        bitmap_be->mips = nullptr;
+        bitmap_be->mip_count = 0;
+        bitmap_be->mips_valid = false;
+    }
 
-            if ( a == 255 ) // SDL_Gfx changes renderer state ... undo change here
+    static void _sk_halve_pixels(const uint32_t *src, int w, int h, uint32_t *dst, int dw, int dh, bool premultiplied)
+    {
+        for (int y = 0; y < dh; y++)
+        {
+            int y0 = std::min(y * 2, h - 1), y1 = std::min(y * 2 + 1, h - 1);
+
+            for (int x = 0; x < dw; x++)
             {
-                SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+                int x0 = std::min(x * 2, w - 1), x1 = std::min(x * 2 + 1, w - 1);
+                uint32_t px[4] = { src[y0 * w + x0], src[y0 * w + x1], src[y1 * w + x0], src[y1 * w + x1] };
+
+                unsigned int r = 0, g = 0, b = 0, a = 0;
+                for (uint32_t p : px)
+                {
+                    unsigned int pa = p & 0xff, weight = premultiplied ? 1 : pa;
+                    r += (p >> 24) * weight;
+                    g += ((p >> 16) & 0xff) * weight;
+                    b += ((p >> 8) & 0xff) * weight;
+                    a += pa;
+                }
+
+                unsigned int total = premultiplied ? 4 : a;
+                if ( total == 0 )
+                    dst[y * dw + x] = 0;
+                else
+                    dst[y * dw + x] = ((r / total) << 24) | ((g / total) << 16) | ((b / total) << 8) | (a / 4);
             }
+        }
+    }
 
-            _sk_complete_render(surface, i);
+    static bool _sk_build_bitmap_mips(sk_drawing_surface *surface)
+    {
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+
+        int w = surface->width, h = surface->height;
+        if ( w < SK_MIN_MIP_SIZE * 2 && h < SK_MIN_MIP_SIZE * 2 ) return false;
+
+        // bitmaps that released their surface are only read from a drawable texture
+        if ( ! bitmap_be->surface && ! bitmap_be->drawable ) _sk_make_drawable(bitmap_be);
+
+        vector<uint32_t> pixels(static_cast<size_t>(w) * h), smaller;
+        sk_to_pixels(surface, 0, 0, w, h, reinterpret_cast<int *>(pixels.data()), w * h);
+
+        _sk_free_bitmap_mips(bitmap_be);
+        bitmap_be->mips = static_cast<sk_drawing_surface *>(malloc(sizeof(sk_drawing_surface) * SK_MAX_MIP_LEVELS));
+        if ( ! bitmap_be->mips ) return false;
+
+        sk_color tint = { bitmap_be->tint.r / 255.0f, bitmap_be->tint.g / 255.0f, bitmap_be->tint.b / 255.0f, bitmap_be->tint.a / 255.0f };
+
+        while ( bitmap_be->mip_count < SK_MAX_MIP_LEVELS && (w >= SK_MIN_MIP_SIZE * 2 || h >= SK_MIN_MIP_SIZE * 2) )
+        {
+            int dw = std::max(1, w / 2), dh = std::max(1, h / 2);
+            smaller.resize(static_cast<size_t>(dw) * dh);
+            _sk_halve_pixels(pixels.data(), w, h, smaller.data(), dw, dh, bitmap_be->premultiplied);
+
+            SDL_Surface *level = SDL_CreateRGBSurfaceWithFormat(0, dw, dh, 32, SDL_PIXELFORMAT_RGBA8888);
+            if ( ! level ) break;
+            for (int r = 0; r < dh; r++)
+                memcpy(static_cast<Uint8 *>(level->pixels) + r * level->pitch, smaller.data() + r * dw, static_cast<size_t>(dw) * 4);
+
+            sk_drawing_surface &mip = bitmap_be->mips[bitmap_be->mip_count];
+            mip = sk_bitmap_from_decoded(level);
+            if ( ! mip._data ) break;
+
+            sk_bitmap_be *mip_be = static_cast<sk_bitmap_be *>(mip._data);
+            mip_be->premultiplied = bitmap_be->premultiplied;
+            mip_be->window_affinity = bitmap_be->window_affinity;
+            sk_set_bitmap_tint(&mip, tint);
+
+            bitmap_be->mip_count++;
+            pixels.swap(smaller);
+            w = dw;
+            h = dh;
+        }
+
+        bitmap_be->mips_valid = bitmap_be->mip_count > 0;
+        return bitmap_be->mips_valid;
+    }
+
+    bool sk_generate_bitmap_mips(sk_drawing_surface *surface)
+    {
+        sk_flush_draw_batch();
+
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return false;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+        bitmap_be->mips_wanted = true;
+
+        return bitmap_be->mips_valid || _sk_build_bitmap_mips(surface);
+    }
+
+    void sk_free_bitmap_mips(sk_drawing_surface *surface)
+    {
+        sk_flush_draw_batch();
+
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+        bitmap_be->mips_wanted = false;
+        _sk_free_bitmap_mips(bitmap_be);
+    }
+
+    int sk_bitmap_mip_count(sk_drawing_surface *surface)
+    {
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return 0;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+        return bitmap_be->mips_valid ? bitmap_be->mip_count : 0;
+    }
+
+    void sk_set_bitmap_software_rendering(sk_drawing_surface *surface, bool value)
+    {
+        sk_flush_draw_batch();
+
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+
+        if ( ! value )
+        {
+            _sk_stop_software_rendering(bitmap_be);
+            return;
         }
+
+        if ( bitmap_be->raster ) return;
+
+        // the pixels are kept in an RGBA8888 surface, read back from the textures if needed
+        if ( ! bitmap_be->surface || bitmap_be->surface->format->format != SDL_PIXELFORMAT_RGBA8888 )
+        {
+            SDL_Surface *pixels = SDL_CreateRGBSurfaceWithFormat(0, surface->width, surface->height, 32, SDL_PIXELFORMAT_RGBA8888);
+            if ( ! pixels ) return;
+
+            sk_to_pixels(surface, static_cast<int *>(pixels->pixels), surface->width * surface->height);
+
+            if ( bitmap_be->surface ) SDL_FreeSurface(bitmap_be->surface);
+            bitmap_be->surface = pixels;
+            bitmap_be->drawable = false;
+            bitmap_be->streaming = false;
+        }
+
+        bitmap_be->raster = sk_create_raster_target(surface->width, surface->height);
+
+        // switches to streaming textures made from the surface
+        sk_refresh_bitmap(surface);
+    }
+
+    bool sk_bitmap_software_rendering(sk_drawing_surface *surface)
+    {
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return false;
+
+        return static_cast<sk_bitmap_be *>(surface->_data)->raster != nullptr;
+    }
+
+    //
+    // Circles
+    //
+
+    void sk_draw_circle(sk_drawing_surface *surface, sk_color clr, double x, double y, double radius)
+    {
+        if ( ! surface || ! surface->_data ) return;
+
+        _sk_render_ellipse(surface, clr, x, y, radius, radius, false);
+    }
+
+    void sk_fill_circle(sk_drawing_surface *surface, sk_color clr, double x, double y, double radius)
+    {
+        if ( ! surface || ! surface->_data ) return;
+
+        _sk_render_ellipse(surface, clr, x, y, radius, radius, true);
     }
 
 
@@ -1675,6 +3097,7 @@ namespace splashkit_lib
                                        static_cast<Uint8>(clr.b * 255),
                                        static_cast<Uint8>(clr.a * 255));
 
+                _sk_count_untextured_draw();
                 SDL_RenderDrawLine(renderer, x1i, y1i, x2i, y2i);
             }
             else
@@ -1701,6 +3124,8 @@ namespace splashkit_lib
 
     void sk_set_clip_rect(sk_drawing_surface *surface, double x, double y, double width, double height)
     {
+        sk_flush_draw_batch();
+
         if ( ! surface || ! surface->_data ) return;
 
         // 4 values = 1 point w + h
@@ -1716,7 +3141,7 @@ namespace splashkit_lib
                 window_be->clipped = true;
                 window_be->clip = { x1, y1, w, h };
 
-                SDL_RenderSetClipRect(window_be->renderer, &window_be->clip);
+                _sk_restore_default_render_target(window_be);
                 break;
             }
             case SGDS_Bitmap:
@@ -1737,6 +3162,8 @@ namespace splashkit_lib
 
     void sk_clear_clip_rect(sk_drawing_surface *surface)
     {
+        sk_flush_draw_batch();
+
         switch (surface->kind)
         {
             case SGDS_Window:
@@ -1746,7 +3173,7 @@ namespace splashkit_lib
 
                 window_be->clipped = false;
                 window_be->clip = { 0, 0, surface->width, surface->height };
-                SDL_RenderSetClipRect(window_be->renderer, nullptr);
+                _sk_restore_default_render_target(window_be);
                 //SDL_RenderPresent(window_be->renderer);
                 break;
             }
@@ -1845,9 +3272,83 @@ namespace splashkit_lib
     // To Pixels
     //
 
-    void sk_to_pixels(sk_drawing_surface *surface, int *pixels, int sz)
+    // Convert an area of a surface to RRGGBBAA pixels, a row at a time. The
+    // common formats are converted with plain loops over each row, which the
+    // compiler turns into vector instructions, and other formats fall back to
+    // reading each pixel.
+    static void _sk_surface_to_pixels(SDL_Surface *surface, int x, int y, int w, int h, int *pixels)
+    {
+        bool locked = SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) == 0;
+
+        if ( ! surface->pixels )
+        {
+            if ( locked ) SDL_UnlockSurface(surface);
+            return;
+        }
+
+        uint32_t *out = reinterpret_cast<uint32_t *>(pixels);
+        const Uint8 *base = static_cast<const Uint8 *>(surface->pixels);
+
+        switch (surface->format->format)
+        {
+            case SDL_PIXELFORMAT_RGBA8888:
+                // already RRGGBBAA, so rows are copied
+                for (int r = 0; r < h; r++)
+                    memcpy(out + r * w, base + (y + r) * surface->pitch + x * 4, static_cast<size_t>(w) * 4);
+                break;
+
+            case SDL_PIXELFORMAT_ARGB8888:
+                for (int r = 0; r < h; r++)
+                {
+                    const uint32_t *row = reinterpret_cast<const uint32_t *>(base + (y + r) * surface->pitch) + x;
+                    uint32_t *dst = out + r * w;
+                    for (int c = 0; c < w; c++)
+                        dst[c] = (row[c] << 8) | (row[c] >> 24);
+                }
+                break;
+
+            case SDL_PIXELFORMAT_ABGR8888:
+                for (int r = 0; r < h; r++)
+                {
+                    const uint32_t *row = reinterpret_cast<const uint32_t *>(base + (y + r) * surface->pitch) + x;
+                    uint32_t *dst = out + r * w;
+                    for (int c = 0; c < w; c++)
+                    {
+                        uint32_t p = row[c];
+                        dst[c] = (p << 24) | ((p & 0x0000ff00) << 8) | ((p & 0x00ff0000) >> 8) | (p >> 24);
+                    }
+                }
+                break;
+
+            case SDL_PIXELFORMAT_RGB24:
+                // bytes are red, green, blue in memory order
+                for (int r = 0; r < h; r++)
+                {
+                    const Uint8 *row = base + (y + r) * surface->pitch + x * 3;
+                    uint32_t *dst = out + r * w;
+                    for (int c = 0; c < w; c++)
+                        dst[c] = static_cast<uint32_t>(row[c * 3]) << 24 | static_cast<uint32_t>(row[c * 3 + 1]) << 16 | static_cast<uint32_t>(row[c * 3 + 2]) << 8 | 0xff;
+                }
+                break;
+
+            default:
+                for (int r = 0; r < h; r++)
+                {
+                    for (int c = 0; c < w; c++)
+                        out[r * w + c] = _get_pixel(surface, x + c, y + r);
+                }
+                break;
+        }
+
+        if ( locked ) SDL_UnlockSurface(surface);
+    }
+
+    void sk_to_pixels(sk_drawing_surface *surface, int x, int y, int w, int h, int *pixels, int sz)
     {
-        if ( ! surface || ! surface->_data || surface->width * surface->height != sz) return;
+        sk_flush_draw_batch();
+
+        if ( ! surface || ! surface->_data || w <= 0 || h <= 0 || w * h != sz ) return;
+        if ( x < 0 || y < 0 || x + w > surface->width || y + h > surface->height ) return;
 
         switch (surface->kind)
         {
@@ -1857,7 +3358,8 @@ namespace splashkit_lib
                 window_be = static_cast<sk_window_be *>(surface->_data);
 
                 // read pixels from the texture
-                _sk_get_pixels_from_renderer(window_be->renderer, 0, 0, surface->width, surface->height, pixels);
+                _sk_restore_default_render_target(window_be);
+                _sk_get_pixels_from_renderer(window_be->renderer, x, y, w, h, pixels);
 
                 break;
             }
@@ -1866,20 +3368,19 @@ namespace splashkit_lib
             {
                 sk_bitmap_be * bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
 
-                if ( ! bitmap_be->surface ) // read from texture
+                if ( bitmap_be->snapshot_valid ) // read from the snapshot
+                {
+                    for (int r = 0; r < h; r++)
+                        memcpy(pixels + r * w, bitmap_be->snapshot + (y + r) * surface->width + x, static_cast<size_t>(w) * 4);
+                }
+                else if ( ! bitmap_be->surface ) // read from texture
                 {
-                    _sk_bitmap_be_texture_to_pixels(bitmap_be, pixels, sz, surface->width, surface->height);
+                    _sk_bitmap_be_texture_to_pixels(bitmap_be, pixels, sz, x, y, w, h);
                 }
                 else
                 {
                     // read from surface
-                    for (int y = 0; y < surface->height; y++)
-                    {
-                        for(int x = 0; x < surface->width; x++)
-                        {
-                            pixels[y * surface->width + x] = static_cast<int>(_get_pixel(bitmap_be->surface, x, y));
-                        }
-                    }
+                    _sk_surface_to_pixels(bitmap_be->surface, x, y, w, h, pixels);
                 }
                 break;
             }
@@ -1889,6 +3390,13 @@ namespace splashkit_lib
         }
     }
 
+    void sk_to_pixels(sk_drawing_surface *surface, int *pixels, int sz)
+    {
+        if ( ! surface ) return;
+
+        sk_to_pixels(surface, 0, 0, surface->width, surface->height, pixels, sz);
+    }
+
 
     //
     // Window change functions...
@@ -1944,6 +3452,8 @@ namespace splashkit_lib
 
     void sk_resize(sk_drawing_surface *surface, int width, int height)
     {
+        sk_flush_draw_batch();
+
         if ( ! surface || ! surface->_data ) return;
 
         sk_window_be * window_be;
@@ -1953,41 +3463,61 @@ namespace splashkit_lib
         {
             case SGDS_Window:
             {
-                SDL_Rect dst = {0, 0, surface->width, surface->height};
-
-                // Get old backing texture
-                SDL_Texture * old = window_be->backing;
+                SDL_Rect old_area = {0, 0, window_be->width, window_be->height};
+                window_be->changed = true;
 
                 // Set renderer to draw onto window
-                SDL_SetRenderTarget(window_be->renderer, nullptr);
+                _sk_set_render_target(window_be->renderer, nullptr);
 
                 // Change window size
                 SDL_SetWindowSize(window_be->window, width, height);
                 surface->width = width;
                 surface->height = height;
+                window_be->width = width;
+                window_be->height = height;
 
                 // Clear new window surface
                 SDL_RenderSetClipRect(window_be->renderer, nullptr);
                 SDL_SetRenderDrawColor(window_be->renderer, 120, 120, 120, 255);
                 SDL_RenderClear(window_be->renderer);
 
-                // Create new backing
-                window_be->backing = SDL_CreateTexture(window_be->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
-                
-                // Copy across old display data
-                SDL_SetRenderTarget(window_be->renderer, window_be->backing);
-                SDL_RenderClear(window_be->renderer);
-                SDL_RenderCopy(window_be->renderer, old, nullptr, &dst);
-                SDL_RenderPresent(window_be->renderer);
-                
-                // Restore clipping
-                if ( window_be->clipped )
+                if ( _sk_backing_fits(window_be, width, height) )
                 {
-                    SDL_RenderSetClipRect(window_be->renderer, &window_be->clip);
+                    // Keep the backing, and clear the area that comes into view
+                    _sk_set_render_target(window_be->renderer, window_be->backing);
+
+                    if ( width > old_area.w )
+                    {
+                        SDL_Rect right = { old_area.w, 0, width - old_area.w, height };
+                        SDL_RenderFillRect(window_be->renderer, &right);
+                    }
+                    if ( height > old_area.h )
+                    {
+                        SDL_Rect below = { 0, old_area.h, MIN(width, old_area.w), height - old_area.h };
+                        SDL_RenderFillRect(window_be->renderer, &below);
+                    }
                 }
-                
-                // Delete old backing texture
-                SDL_DestroyTexture(old);
+                else
+                {
+                    // Get old backing texture
+                    SDL_Texture * old = window_be->backing;
+
+                    // Create new backing
+                    window_be->backing = _sk_create_backing(window_be->renderer, width, height);
+
+                    // Copy across old display data
+                    _sk_set_render_target(window_be->renderer, window_be->backing);
+                    SDL_RenderClear(window_be->renderer);
+                    _sk_render_copy(window_be->renderer, old, &old_area, &old_area);
+
+                    // Delete old backing texture
+                    SDL_DestroyTexture(old);
+                }
+                SDL_RenderPresent(window_be->renderer);
+
+                // Restore the target and clipping
+                _sk_forget_render_state(window_be);
+                _sk_restore_default_render_target(window_be);
                 
                 SDL_PumpEvents();
                 break;
@@ -2012,29 +3542,79 @@ namespace splashkit_lib
         //WriteLn(stderr, 'libpng: error: ', str);
     }
     
-    int sk_save_png(sk_drawing_surface * surface, const char *filename)
+    //
+    // Pixels are read back into pooled buffers, so repeated saves and
+    // screenshots do not allocate a new full size buffer each time.
+    //
+
+// Buffers kept for reuse once their save is written
+#define SK_PIXEL_POOL_SIZE 4
+// Finished background saves remembered for sk_image_save_status
+#define SK_SAVE_HISTORY 256
+
+    static mutex _sk_pixel_pool_lock;
+    static vector<vector<uint32_t>> _sk_pixel_pool;
+
+    static vector<uint32_t> _sk_take_pixel_buffer(size_t count)
+    {
+        vector<uint32_t> result;
+
+        {
+            lock_guard<mutex> guard(_sk_pixel_pool_lock);
+
+            for (size_t i = 0; i < _sk_pixel_pool.size(); i++)
+            {
+                if ( _sk_pixel_pool[i].capacity() >= count )
+                {
+                    result = std::move(_sk_pixel_pool[i]);
+                    _sk_pixel_pool.erase(_sk_pixel_pool.begin() + static_cast<long>(i));
+                    break;
+                }
+            }
+        }
+
+        result.resize(count);
+        return result;
+    }
+
+    static void _sk_return_pixel_buffer(vector<uint32_t> &&buffer)
+    {
+        lock_guard<mutex> guard(_sk_pixel_pool_lock);
+        if ( _sk_pixel_pool.size() < SK_PIXEL_POOL_SIZE ) _sk_pixel_pool.push_back(std::move(buffer));
+    }
+
+    static bool _sk_read_image_pixels(sk_drawing_surface *surface, vector<uint32_t> &pixels)
+    {
+        if ( ! surface || ! surface->_data || surface->width <= 0 || surface->height <= 0 ) return false;
+
+        int sz = surface->width * surface->height;
+        pixels = _sk_take_pixel_buffer(static_cast<size_t>(sz));
+        sk_to_pixels(surface, reinterpret_cast<int *>(pixels.data()), sz);
+        return true;
+    }
+
+    //
+    // Pixels are RGBA8888 values, with red in the high byte
+    //
+    static bool _sk_write_png(const uint32_t *pixels, int width, int height, const char *filename, int level)
     {
-        if ( ! surface || ! surface->_data || surface->width <= 0 || surface->height <= 0  ) return 0;
-        
         FILE *fp;
         png_structp png_ptr;
         png_infop info_ptr;
         int i, colortype;
-        unsigned long sz;
         png_bytepp row_pointers;
-        uint8_t *pixels;
         
         // Opening output file
         fp = fopen(filename, "wb");
         
-        if (fp == nullptr) return 0;
+        if (fp == nullptr) return false;
         
         // Initializing png structures and callbacks
         png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, &png_user_error, &png_user_warn);
         if (png_ptr == nullptr)
         {
             fclose(fp);
-            return 0;
+            return false;
         }
         
         info_ptr = png_create_info_struct(png_ptr);
@@ -2042,14 +3622,22 @@ namespace splashkit_lib
         {
             png_destroy_write_struct(&png_ptr, nullptr);
             fclose(fp);
-            return 0;
+            return false;
         }
         
         png_init_io(png_ptr, fp);
+
+        if ( level >= 0 )
+        {
+            png_set_compression_level(png_ptr, std::min(level, 9));
+
+            // without compression, filtering rows only costs time
+            if ( level == 0 ) png_set_filter(png_ptr, 0, PNG_FILTER_NONE);
+        }
         
         colortype = PNG_COLOR_TYPE_RGBA;
         png_set_IHDR( png_ptr, info_ptr,
-                     (png_uint_32)surface->width, (png_uint_32)surface->height, 8, colortype,
+                     (png_uint_32)width, (png_uint_32)height, 8, colortype,
                      PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
         
         // Writing the image
@@ -2059,17 +3647,11 @@ namespace splashkit_lib
         png_set_swap_alpha(png_ptr);
         png_set_bgr(png_ptr);
         
-        // actually get the pixel data...
-        sz = (unsigned long)(surface->width * surface->height) * sizeof(uint8_t);
-        pixels = (uint8_t *) malloc(sizeof(uint8_t) * sz * 4);
-        
-        sk_to_pixels(surface, (int *)pixels, (int)sz);
+        row_pointers = (png_bytepp)png_malloc(png_ptr, (unsigned long)height * sizeof(png_bytep));
         
-        row_pointers = (png_bytepp)png_malloc(png_ptr, (unsigned long)surface->height * sizeof(png_bytep));
-        
-        for (i = 0; i < surface->height; i++)
+        for (i = 0; i < height; i++)
         {
-            row_pointers[i] = png_bytep(pixels + i * surface->width * 4);
+            row_pointers[i] = png_bytep(pixels + i * width);
         }
         
         png_write_image(png_ptr, row_pointers);
@@ -2078,88 +3660,721 @@ namespace splashkit_lib
         // Cleaning out...
         png_free(png_ptr, row_pointers);
         png_destroy_write_struct(&png_ptr, &info_ptr);
-        free(pixels);
         
         fclose(fp);
-        return -1; // success
+        return true;
     }
-    
-    
-    //--------------------------------------------------------------------------------------
+
     //
-    // Images
+    // Write a "Quite OK Image" file (https://qoiformat.org), which encodes
+    // many times faster than PNG at a moderate cost in file size.
     //
-    //--------------------------------------------------------------------------------------
-    
-    
-    sk_drawing_surface sk_create_bitmap(int width, int height)
+    static bool _sk_write_qoi(const uint32_t *pixels, int width, int height, const char *filename)
     {
-        internal_sk_init();
-        if ( _sk_num_open_windows == 0 ) _sk_create_initial_window();
-        
-        sk_drawing_surface result = { SGDS_Unknown, 0, 0, nullptr };
-        
-        result.kind = SGDS_Bitmap;
-        sk_bitmap_be *data = static_cast<sk_bitmap_be *>(malloc(sizeof(sk_bitmap_be)));
-        
-        result._data = data;
-        result.width = width;
-        result.height = height;
-        
-        data->clipped = false;
-        data->clip = {0, 0, width, height};
-        data->drawable = true;
-        data->surface = nullptr;
-        data->texture = static_cast<SDL_Texture **>(malloc(sizeof(SDL_Texture*) * _sk_num_open_windows));
-        
-        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        vector<uint8_t> out;
+        out.reserve(14 + static_cast<size_t>(width) * height + 8);
+
+        auto put_u32 = [&](uint32_t v)
         {
-            data->texture[i] = SDL_CreateTexture(_sk_open_windows[i]->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
-            
-            SDL_SetTextureBlendMode(data->texture[i], SDL_BLENDMODE_BLEND);
-            
-            _sk_set_renderer_target(i, data);
-            SDL_SetRenderDrawColor(_sk_open_windows[i]->renderer, 255, 255, 255, 0);
-            SDL_RenderClear(_sk_open_windows[i]->renderer);
-           // SDL_RenderPresent(_sk_open_windows[i]->renderer);
-            _sk_restore_default_render_target(i, data);
-        }
-        
-        _sk_add_bitmap(data);
-        return result;
-    }
-    
-    sk_drawing_surface sk_load_bitmap(const char * filename)
-    {
-        internal_sk_init();
-        sk_drawing_surface result = { SGDS_Unknown, 0, 0, nullptr };
-        
-        SDL_Surface *surface;
-        
-        surface = IMG_Load(filename);
-        
-        if ( ! surface ) {
-            std::cout << "error loading image " << IMG_GetError() << std::endl;
-            return result;
-        }
-        sk_bitmap_be *data = static_cast<sk_bitmap_be *>(malloc(sizeof(sk_bitmap_be)));
-        
-        result._data = data;
-        
-        // Allocate space for one texture per window
-        if (_sk_num_open_windows > 0)
-            data->texture = static_cast<SDL_Texture **>(malloc(sizeof(SDL_Texture*) * _sk_num_open_windows));
-        else
-            data->texture = nullptr;
-        
-        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+            out.push_back(static_cast<uint8_t>(v >> 24));
+            out.push_back(static_cast<uint8_t>(v >> 16));
+            out.push_back(static_cast<uint8_t>(v >> 8));
+            out.push_back(static_cast<uint8_t>(v));
+        };
+
+        out.insert(out.end(), { 'q', 'o', 'i', 'f' });
+        put_u32(static_cast<uint32_t>(width));
+        put_u32(static_cast<uint32_t>(height));
+        out.push_back(4); // RGBA
+        out.push_back(0); // sRGB with linear alpha
+
+        uint32_t index[64] = { 0 };
+        uint32_t prev = 0x000000ff; // opaque black
+        int run = 0;
+        size_t count = static_cast<size_t>(width) * height;
+
+        for (size_t i = 0; i < count; i++)
         {
-            // Create a texture for each window
-            data->texture[i] = SDL_CreateTextureFromSurface(_sk_open_windows[i]->renderer, surface);
-        }
-        
-        data->surface = surface;
-        data->drawable = false;
+            uint32_t px = pixels[i];
+
+            if ( px == prev )
+            {
+                run++;
+                if ( run == 62 || i + 1 == count )
+                {
+                    out.push_back(static_cast<uint8_t>(0xc0 | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if ( run > 0 )
+            {
+                out.push_back(static_cast<uint8_t>(0xc0 | (run - 1)));
+                run = 0;
+            }
+
+            uint8_t r = static_cast<uint8_t>(px >> 24), g = static_cast<uint8_t>(px >> 16);
+            uint8_t b = static_cast<uint8_t>(px >> 8), a = static_cast<uint8_t>(px);
+            int hash = (r * 3 + g * 5 + b * 7 + a * 11) % 64;
+
+            if ( index[hash] == px )
+            {
+                out.push_back(static_cast<uint8_t>(hash));
+            }
+            else
+            {
+                index[hash] = px;
+
+                if ( a == static_cast<uint8_t>(prev) )
+                {
+                    // differences wrap, as the decoder adds them modulo 256
+                    int8_t dr = static_cast<int8_t>(r - static_cast<uint8_t>(prev >> 24));
+                    int8_t dg = static_cast<int8_t>(g - static_cast<uint8_t>(prev >> 16));
+                    int8_t db = static_cast<int8_t>(b - static_cast<uint8_t>(prev >> 8));
+                    int8_t dr_dg = static_cast<int8_t>(dr - dg);
+                    int8_t db_dg = static_cast<int8_t>(db - dg);
+
+                    if ( dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2 )
+                    {
+                        out.push_back(static_cast<uint8_t>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                    }
+                    else if ( dg > -33 && dg < 32 && dr_dg > -9 && dr_dg < 8 && db_dg > -9 && db_dg < 8 )
+                    {
+                        out.push_back(static_cast<uint8_t>(0x80 | (dg + 32)));
+                        out.push_back(static_cast<uint8_t>((dr_dg + 8) << 4 | (db_dg + 8)));
+                    }
+                    else
+                    {
+                        out.insert(out.end(), { 0xfe, r, g, b });
+                    }
+                }
+                else
+                {
+                    out.insert(out.end(), { 0xff, r, g, b, a });
+                }
+            }
+
+            prev = px;
+        }
+
+        out.insert(out.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+
+        FILE *fp = fopen(filename, "wb");
+        if ( ! fp ) return false;
+
+        bool ok = fwrite(out.data(), 1, out.size(), fp) == out.size();
+        return fclose(fp) == 0 && ok;
+    }
+
+    static bool _sk_encode_image(const uint32_t *pixels, int width, int height, const char *filename, sk_image_encoding encoding, int level)
+    {
+        if ( encoding == SK_ENCODE_QOI ) return _sk_write_qoi(pixels, width, height, filename);
+        return _sk_write_png(pixels, width, height, filename, level);
+    }
+
+    int sk_save_png(sk_drawing_surface * surface, const char *filename)
+    {
+        return sk_save_image(surface, filename, SK_ENCODE_PNG, -1) ? -1 : 0; // -1 is success
+    }
+
+    bool sk_save_image(sk_drawing_surface *surface, const char *filename, sk_image_encoding encoding, int level)
+    {
+        vector<uint32_t> pixels;
+        if ( ! _sk_read_image_pixels(surface, pixels) ) return false;
+
+        bool result = _sk_encode_image(pixels.data(), surface->width, surface->height, filename, encoding, level);
+        _sk_return_pixel_buffer(std::move(pixels));
+        return result;
+    }
+
+    //
+    // Background saves
+    //
+
+    struct _sk_image_save
+    {
+        int status;         // 0 running, 1 written, -1 failed
+        string filename;
+    };
+
+    static mutex _sk_save_lock;
+    static std::condition_variable _sk_save_done;
+    static std::map<int, _sk_image_save> _sk_saves;
+    static int _sk_next_save_id = 1;
+    static int _sk_saves_running = 0;
+
+    static worker_pool &_sk_save_workers()
+    {
+        // One thread keeps saves in order and leaves the other cores to the game
+        static worker_pool pool(1);
+        return pool;
+    }
+
+    static void _sk_finish_save(int id, bool ok)
+    {
+        lock_guard<mutex> guard(_sk_save_lock);
+
+        _sk_saves[id].status = ok ? 1 : -1;
+        _sk_saves_running--;
+
+        // forget the oldest finished saves
+        for (auto it = _sk_saves.begin(); _sk_saves.size() > SK_SAVE_HISTORY + static_cast<size_t>(_sk_saves_running) && it != _sk_saves.end(); )
+        {
+            if ( it->second.status != 0 ) it = _sk_saves.erase(it);
+            else ++it;
+        }
+
+        _sk_save_done.notify_all();
+    }
+
+    int sk_save_image_async(sk_drawing_surface *surface, const char *filename, sk_image_encoding encoding, int level)
+    {
+        // Reading back must happen here, as only this thread uses the renderer
+        vector<uint32_t> pixels;
+        if ( ! _sk_read_image_pixels(surface, pixels) ) return 0;
+
+        int width = surface->width, height = surface->height;
+        string path = filename;
+        int id;
+
+        {
+            lock_guard<mutex> guard(_sk_save_lock);
+            id = _sk_next_save_id++;
+            _sk_saves[id] = { 0, path };
+            _sk_saves_running++;
+        }
+
+        auto job = std::make_shared<vector<uint32_t>>(std::move(pixels));
+
+        _sk_save_workers().add([=]()
+        {
+            bool ok = _sk_encode_image(job->data(), width, height, path.c_str(), encoding, level);
+            _sk_return_pixel_buffer(std::move(*job));
+            _sk_finish_save(id, ok);
+        });
+
+        return id;
+    }
+
+    int sk_image_save_status(int id)
+    {
+        lock_guard<mutex> guard(_sk_save_lock);
+
+        auto it = _sk_saves.find(id);
+        return it == _sk_saves.end() ? -1 : it->second.status;
+    }
+
+    bool sk_image_save_pending(const char *filename)
+    {
+        lock_guard<mutex> guard(_sk_save_lock);
+
+        for (const auto &save : _sk_saves)
+        {
+            if ( save.second.status == 0 && save.second.filename == filename ) return true;
+        }
+
+        return false;
+    }
+
+    void sk_wait_for_image_saves()
+    {
+        std::unique_lock<mutex> guard(_sk_save_lock);
+        _sk_save_done.wait(guard, []() { return _sk_saves_running == 0; });
+    }
+    
+    
+    //--------------------------------------------------------------------------------------
+    //
+    // Images
+    //
+    //--------------------------------------------------------------------------------------
+    
+    
+    sk_drawing_surface sk_create_bitmap(int width, int height)
+    {
+        internal_sk_init();
+        if ( _sk_num_open_windows == 0 ) _sk_create_initial_window();
+        
+        sk_drawing_surface result = { SGDS_Unknown, 0, 0, nullptr };
+        
+        result.kind = SGDS_Bitmap;
+        sk_bitmap_be *data = static_cast<sk_bitmap_be *>(malloc(sizeof(sk_bitmap_be)));
+        
+        result._data = data;
+        result.width = width;
+        result.height = height;
+        
+        data->clipped = false;
+        data->clip = {0, 0, width, height};
+        data->drawable = true;
+        data->surface = nullptr;
+        data->tint = {255, 255, 255, 255};
+        data->window_affinity = nullptr;
+        data->atlas = nullptr;
+        data->atlas_area = {0, 0, 0, 0};
+        data->atlas_refs = 0;
+        data->premultiplied = false;
+        data->streaming = false;
+        data->dirty = {0, 0, 0, 0};
+        data->snapshot = nullptr;
+        data->snapshot_valid = false;
+        data->reads_since_change = 0;
+        data->mips = nullptr;
+        data->mip_count = 0;
+        data->mips_wanted = false;
+        data->mips_valid = false;
+        data->raster = nullptr;
+        data->texture = static_cast<SDL_Texture **>(malloc(sizeof(SDL_Texture*) * _sk_num_open_windows));
+        
+        // Only the first window holds the new bitmap, other windows copy it when needed
+        for (unsigned int i = 1; i < _sk_num_open_windows; i++)
+        {
+            data->texture[i] = nullptr;
+        }
+
+        data->texture[0] = _sk_create_texture(_sk_open_windows[0]->renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        
+        SDL_SetTextureBlendMode(data->texture[0], SDL_BLENDMODE_BLEND);
+        
+        _sk_set_renderer_target(0, data);
+        SDL_SetRenderDrawColor(_sk_open_windows[0]->renderer, 255, 255, 255, 0);
+        SDL_RenderClear(_sk_open_windows[0]->renderer);
+        _sk_restore_default_render_target(_sk_open_windows[0]);
+        
+        _sk_add_bitmap(data);
+        return result;
+    }
+    
+    //
+    // Baked textures hold pixels ready to upload, so loading them skips image
+    // decoding. Layout, little endian:
+    //
+    //   magic[8], u32 width, u32 height, u32 compression, u32 reserved,
+    //   u64 payload size, payload
+    //
+    // The payload is the rows of pixels, each byte R G B A, either raw or
+    // compressed with zlib.
+    //
+#define SK_BAKED_HEADER_SIZE 32
+#define SK_BAKED_EXT ".sktex"
+#define SK_BAKED_MAX_SIZE 16384
+
+    static const char SK_BAKED_MAGIC[8] = { 'S', 'K', 'T', 'E', 'X', 0, 0, 1 };
+
+    enum sk_baked_compression
+    {
+        SK_BAKED_RAW = 0,
+        SK_BAKED_ZLIB = 1
+    };
+
+    static bool _sk_is_baked_texture(const void *data, size_t size)
+    {
+        return size >= SK_BAKED_HEADER_SIZE && memcmp(data, SK_BAKED_MAGIC, sizeof(SK_BAKED_MAGIC)) == 0;
+    }
+
+    static SDL_Surface *_sk_decode_baked_texture(const void *data, size_t size)
+    {
+        if ( ! _sk_is_baked_texture(data, size) ) return nullptr;
+
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        uint32_t width, height, compression;
+        uint64_t payload_size;
+
+        memcpy(&width, bytes + 8, 4);
+        memcpy(&height, bytes + 12, 4);
+        memcpy(&compression, bytes + 16, 4);
+        memcpy(&payload_size, bytes + 24, 8);
+
+        if ( width == 0 || height == 0 || width > SK_BAKED_MAX_SIZE || height > SK_BAKED_MAX_SIZE ) return nullptr;
+        if ( payload_size > size - SK_BAKED_HEADER_SIZE ) return nullptr;
+
+        const unsigned char *payload = bytes + SK_BAKED_HEADER_SIZE;
+        size_t row = static_cast<size_t>(width) * 4;
+        size_t expected = row * height;
+
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, static_cast<int>(width), static_cast<int>(height), 32, SDL_PIXELFORMAT_RGBA32);
+        if ( ! surface ) return nullptr;
+
+        unsigned char *pixels = static_cast<unsigned char *>(surface->pixels);
+        bool tight = static_cast<size_t>(surface->pitch) == row;
+        bool ok = false;
+
+        if ( compression == SK_BAKED_RAW && payload_size == expected )
+        {
+            for (uint32_t y = 0; y < height; y++)
+                memcpy(pixels + y * surface->pitch, payload + y * row, row);
+            ok = true;
+        }
+        else if ( compression == SK_BAKED_ZLIB )
+        {
+            // Inflate straight into the surface when its rows are not padded
+            vector<unsigned char> unpacked(tight ? 0 : expected);
+            uLongf out_size = static_cast<uLongf>(expected);
+            Bytef *out = tight ? pixels : unpacked.data();
+
+            ok = uncompress(out, &out_size, payload, static_cast<uLong>(payload_size)) == Z_OK && out_size == expected;
+
+            if ( ok && ! tight )
+            {
+                for (uint32_t y = 0; y < height; y++)
+                    memcpy(pixels + y * surface->pitch, unpacked.data() + y * row, row);
+            }
+        }
+
+        if ( ! ok )
+        {
+            SDL_FreeSurface(surface);
+            return nullptr;
+        }
+
+        return surface;
+    }
+
+    bool sk_save_baked_texture(sk_drawing_surface *surface, const char *filename, bool compress)
+    {
+        if ( ! surface || ! surface->_data || surface->width <= 0 || surface->height <= 0 ) return false;
+
+        int count = surface->width * surface->height;
+        vector<int> pixels(count);
+        sk_to_pixels(surface, pixels.data(), count);
+
+        // Pixels are read as RRGGBBAA values, stored as R G B A bytes
+        vector<unsigned char> rgba(static_cast<size_t>(count) * 4);
+        for (int i = 0; i < count; i++)
+        {
+            uint32_t p = static_cast<uint32_t>(pixels[i]);
+            rgba[i * 4]     = static_cast<unsigned char>(p >> 24);
+            rgba[i * 4 + 1] = static_cast<unsigned char>(p >> 16);
+            rgba[i * 4 + 2] = static_cast<unsigned char>(p >> 8);
+            rgba[i * 4 + 3] = static_cast<unsigned char>(p);
+        }
+
+        vector<unsigned char> packed;
+        uint32_t compression = SK_BAKED_RAW;
+
+        if ( compress )
+        {
+            uLongf packed_size = compressBound(static_cast<uLong>(rgba.size()));
+            packed.resize(packed_size);
+
+            if ( compress2(packed.data(), &packed_size, rgba.data(), static_cast<uLong>(rgba.size()), Z_DEFAULT_COMPRESSION) != Z_OK )
+                return false;
+
+            packed.resize(packed_size);
+            compression = SK_BAKED_ZLIB;
+        }
+
+        const vector<unsigned char> &payload = compress ? packed : rgba;
+
+        unsigned char header[SK_BAKED_HEADER_SIZE] = { 0 };
+        uint32_t width = static_cast<uint32_t>(surface->width), height = static_cast<uint32_t>(surface->height);
+        uint64_t payload_size = payload.size();
+
+        memcpy(header, SK_BAKED_MAGIC, sizeof(SK_BAKED_MAGIC));
+        memcpy(header + 8, &width, 4);
+        memcpy(header + 12, &height, 4);
+        memcpy(header + 16, &compression, 4);
+        memcpy(header + 24, &payload_size, 8);
+
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(payload.data()), static_cast<std::streamsize>(payload.size()));
+
+        return static_cast<bool>(out);
+    }
+
+    static bool _sk_is_baked_filename(const char *filename)
+    {
+        size_t len = strlen(filename), ext_len = strlen(SK_BAKED_EXT);
+        return len > ext_len && strcmp(filename + len - ext_len, SK_BAKED_EXT) == 0;
+    }
+
+    SDL_Surface *sk_decode_bitmap(const char * filename)
+    {
+        if ( _sk_is_baked_filename(filename) )
+        {
+            file_view view(filename);
+            SDL_Surface *baked = view.is_open() ? _sk_decode_baked_texture(view.data(), view.size()) : nullptr;
+
+            if ( ! baked ) std::cout << "error loading baked texture " << filename << std::endl;
+            return baked;
+        }
+
+        SDL_Surface *surface = IMG_Load(filename);
+
+        if ( ! surface ) {
+            std::cout << "error loading image " << IMG_GetError() << std::endl;
+        }
+
+        return surface;
+    }
+
+    SDL_Surface *sk_decode_bitmap_from_memory(const void *data, size_t size)
+    {
+        if ( _sk_is_baked_texture(data, size) ) return _sk_decode_baked_texture(data, size);
+
+        SDL_RWops *source = SDL_RWFromConstMem(data, static_cast<int>(size));
+        SDL_Surface *surface = source ? IMG_Load_RW(source, 1) : nullptr;
+
+        if ( ! surface ) {
+            std::cout << "error loading image " << IMG_GetError() << std::endl;
+        }
+
+        return surface;
+    }
+
+    void sk_free_decoded_bitmap(SDL_Surface *surface)
+    {
+        if ( surface ) SDL_FreeSurface(surface);
+    }
+
+    void sk_release_bitmap_surface(sk_drawing_surface *surface)
+    {
+        sk_flush_draw_batch();
+
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+
+        // Streaming bitmaps upload from their surface, packed bitmaps need it
+        // to leave the atlas, and without a window there is nowhere else to
+        // keep the pixels
+        if ( ! bitmap_be->surface || bitmap_be->streaming || bitmap_be->atlas || _sk_num_open_windows == 0 ) return;
+
+        if ( _sk_bitmap_texture_source(bitmap_be) < 0 )
+            _sk_bitmap_texture(bitmap_be, _sk_bitmap_window_idx(bitmap_be, 0));
+
+        if ( _sk_bitmap_texture_source(bitmap_be) < 0 ) return;
+
+        SDL_FreeSurface(bitmap_be->surface);
+        bitmap_be->surface = nullptr;
+    }
+
+    //
+    // Texture atlases
+    //
+
+// Largest atlas texture, reduced to what the renderer supports
+#define SK_ATLAS_SIZE 2048
+// Bitmaps larger than this in either direction are left in their own texture
+#define SK_ATLAS_MAX_ITEM 256
+// Transparent gap between packed bitmaps, so filtering does not bleed
+#define SK_ATLAS_PADDING 1
+
+    void _sk_leave_atlas(sk_bitmap_be *bitmap)
+    {
+        sk_bitmap_be *atlas = bitmap->atlas;
+        if ( ! atlas ) return;
+
+        sk_flush_draw_batch();
+
+        // Textures for the bitmap are created from its surface when next needed
+        bitmap->atlas = nullptr;
+        bitmap->atlas_area = {0, 0, 0, 0};
+
+        if ( --atlas->atlas_refs == 0 ) _sk_destroy_bitmap(atlas);
+    }
+
+    static bool _sk_can_pack(sk_drawing_surface *surface)
+    {
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return false;
+
+        sk_bitmap_be *bitmap_be = static_cast<sk_bitmap_be *>(surface->_data);
+
+        return bitmap_be->surface && ! bitmap_be->drawable && ! bitmap_be->streaming &&
+            ! bitmap_be->window_affinity && ! bitmap_be->atlas && bitmap_be->atlas_refs == 0 &&
+            surface->width > 0 && surface->height > 0 &&
+            surface->width <= SK_ATLAS_MAX_ITEM && surface->height <= SK_ATLAS_MAX_ITEM;
+    }
+
+    static int _sk_atlas_size()
+    {
+        int result = SK_ATLAS_SIZE;
+
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        {
+            SDL_RendererInfo info;
+            if ( SDL_GetRendererInfo(_sk_open_windows[i]->renderer, &info) != 0 ) continue;
+
+            if ( info.max_texture_width > 0 ) result = std::min(result, info.max_texture_width);
+            if ( info.max_texture_height > 0 ) result = std::min(result, info.max_texture_height);
+        }
+
+        return result;
+    }
+
+    //
+    // Copy the packed bitmaps into a new atlas, and point them at it
+    //
+    static void _sk_build_atlas(const vector<sk_bitmap_be *> &items, const vector<SDL_Rect> &areas, int width, int height)
+    {
+        SDL_Surface *pixels = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGBA8888);
+        if ( ! pixels ) return;
+
+        SDL_FillRect(pixels, nullptr, 0);
+
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            SDL_Surface *src = items[i]->surface;
+            SDL_Rect dst = areas[i];
+
+            // copy alpha as it is, rather than blending onto the empty atlas
+            SDL_BlendMode mode;
+            SDL_GetSurfaceBlendMode(src, &mode);
+            SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(src, nullptr, pixels, &dst);
+            SDL_SetSurfaceBlendMode(src, mode);
+        }
+
+        sk_drawing_surface atlas = sk_bitmap_from_decoded(pixels);
+        sk_bitmap_be *atlas_be = static_cast<sk_bitmap_be *>(atlas._data);
+        atlas_be->atlas_refs = static_cast<int>(items.size());
+
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            sk_bitmap_be *bitmap_be = items[i];
+
+            for (unsigned int w = 0; w < _sk_num_open_windows; w++)
+            {
+                if ( bitmap_be->texture[w] ) _sk_destroy_bitmap_texture(bitmap_be->texture[w]);
+                bitmap_be->texture[w] = nullptr;
+            }
+
+            bitmap_be->atlas = atlas_be;
+            bitmap_be->atlas_area = areas[i];
+        }
+    }
+
+    int sk_pack_bitmaps_into_atlas(sk_drawing_surface **bitmaps, int count)
+    {
+        internal_sk_init();
+        sk_flush_draw_batch();
+
+        vector<sk_drawing_surface *> items;
+        for (int i = 0; i < count; i++)
+        {
+            if ( ! _sk_can_pack(bitmaps[i]) ) continue;
+
+            // each bitmap is packed once, even if listed twice
+            bool listed = false;
+            for (sk_drawing_surface *item : items)
+                if ( item->_data == bitmaps[i]->_data ) listed = true;
+
+            if ( ! listed ) items.push_back(bitmaps[i]);
+        }
+
+        if ( items.size() < 2 ) return 0;
+
+        // Shelf packing: tallest first, filling rows left to right
+        std::stable_sort(items.begin(), items.end(), [](sk_drawing_surface *a, sk_drawing_surface *b)
+        {
+            return a->height > b->height;
+        });
+
+        int size = _sk_atlas_size();
+        int packed = 0;
+
+        vector<sk_bitmap_be *> atlas_items;
+        vector<SDL_Rect> areas;
+        int x = 0, y = 0, shelf_h = 0, used_w = 0;
+
+        auto finish_atlas = [&]()
+        {
+            // a single bitmap gains nothing from an atlas
+            if ( atlas_items.size() > 1 )
+            {
+                _sk_build_atlas(atlas_items, areas, used_w, y + shelf_h);
+                packed += static_cast<int>(atlas_items.size());
+            }
+
+            atlas_items.clear();
+            areas.clear();
+            x = y = shelf_h = used_w = 0;
+        };
+
+        for (sk_drawing_surface *item : items)
+        {
+            int w = item->width + SK_ATLAS_PADDING;
+            int h = item->height + SK_ATLAS_PADDING;
+
+            if ( x + w > size )
+            {
+                // start a new shelf
+                x = 0;
+                y += shelf_h;
+                shelf_h = 0;
+            }
+
+            if ( y + h > size ) finish_atlas();
+
+            atlas_items.push_back(static_cast<sk_bitmap_be *>(item->_data));
+            areas.push_back({ x, y, item->width, item->height });
+
+            x += w;
+            used_w = std::max(used_w, x);
+            shelf_h = std::max(shelf_h, h);
+        }
+
+        finish_atlas();
+
+        return packed;
+    }
+
+    bool sk_bitmap_in_atlas(sk_drawing_surface *surface)
+    {
+        if ( ! surface || surface->kind != SGDS_Bitmap || ! surface->_data ) return false;
+
+        return static_cast<sk_bitmap_be *>(surface->_data)->atlas != nullptr;
+    }
+
+    sk_drawing_surface sk_load_bitmap(const char * filename)
+    {
+        internal_sk_init();
+        return sk_bitmap_from_decoded(sk_decode_bitmap(filename));
+    }
+
+    sk_drawing_surface sk_bitmap_from_decoded(SDL_Surface *surface)
+    {
+        internal_sk_init();
+        sk_drawing_surface result = { SGDS_Unknown, 0, 0, nullptr };
+
+        if ( ! surface ) return result;
+
+        sk_bitmap_be *data = static_cast<sk_bitmap_be *>(malloc(sizeof(sk_bitmap_be)));
+        
+        result._data = data;
+        
+        // Allocate space for one texture per window
+        if (_sk_num_open_windows > 0)
+            data->texture = static_cast<SDL_Texture **>(malloc(sizeof(SDL_Texture*) * _sk_num_open_windows));
+        else
+            data->texture = nullptr;
+        
+        for (unsigned int i = 0; i < _sk_num_open_windows; i++)
+        {
+            // Textures are created the first time the bitmap is drawn to each window
+            data->texture[i] = nullptr;
+        }
+        
+        data->surface = surface;
+        data->drawable = false;
+        data->tint = {255, 255, 255, 255};
+        data->window_affinity = nullptr;
+        data->atlas = nullptr;
+        data->atlas_area = {0, 0, 0, 0};
+        data->atlas_refs = 0;
+        data->premultiplied = false;
+        data->streaming = false;
+        data->dirty = {0, 0, 0, 0};
+        data->snapshot = nullptr;
+        data->snapshot_valid = false;
+        data->reads_since_change = 0;
+        data->mips = nullptr;
+        data->mip_count = 0;
+        data->mips_wanted = false;
+        data->mips_valid = false;
+        data->raster = nullptr;
         data->clipped = false;
         data->clip = {0,0,0,0};
         
@@ -2172,9 +4387,89 @@ namespace splashkit_lib
         return result;
     }
     
+    //
+    // Record the bitmap as a textured quad, matching the placement used by SDL_RenderCopyEx
+    //
+    // Work out the corners of a bitmap area drawn to dst_rect, rotated around centre_x, centre_y
+    void _sk_bitmap_quad_vertices(sk_drawing_surface *src, const SDL_FRect &src_rect, const SDL_FRect &dst_rect, double angle, double centre_x, double centre_y, sk_renderer_flip flip, SDL_Color clr, SDL_Vertex v[4])
+    {
+        // Tint is applied through the vertex colour
+
+        float u0 = src_rect.x / static_cast<float>(src->width);
+        float v0 = src_rect.y / static_cast<float>(src->height);
+        float u1 = (src_rect.x + src_rect.w) / static_cast<float>(src->width);
+        float v1 = (src_rect.y + src_rect.h) / static_cast<float>(src->height);
+
+        if ( flip == sk_FLIP_HORIZONTAL || flip == sk_FLIP_BOTH ) std::swap(u0, u1);
+        if ( flip == sk_FLIP_VERTICAL || flip == sk_FLIP_BOTH ) std::swap(v0, v1);
+
+        // Corners relative to the centre of rotation
+        double cx = centre_x, cy = centre_y;
+        double px[4] = { -cx, dst_rect.w - cx, dst_rect.w - cx, -cx };
+        double py[4] = { -cy, -cy, dst_rect.h - cy, dst_rect.h - cy };
+
+        float u[4] = { u0, u1, u1, u0 };
+        float tv[4] = { v0, v0, v1, v1 };
+
+        if ( angle == 0 )
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                v[i].position.x = static_cast<float>(dst_rect.x + cx + px[i]);
+                v[i].position.y = static_cast<float>(dst_rect.y + cy + py[i]);
+                v[i].color = clr;
+                v[i].tex_coord = { u[i], tv[i] };
+            }
+            return;
+        }
+
+        double rad = deg_to_rad(angle);
+        double cos_a = std::cos(rad), sin_a = std::sin(rad);
+
+        for (int i = 0; i < 4; i++)
+        {
+            v[i].position.x = static_cast<float>(dst_rect.x + cx + px[i] * cos_a - py[i] * sin_a);
+            v[i].position.y = static_cast<float>(dst_rect.y + cy + px[i] * sin_a + py[i] * cos_a);
+            v[i].color = clr;
+            v[i].tex_coord = { u[i], tv[i] };
+        }
+    }
+
+    void _sk_batch_bitmap(sk_drawing_surface *src, sk_drawing_surface *dst, const SDL_Rect &src_rect, const SDL_Rect &dst_rect, double angle, double centre_x, double centre_y, sk_renderer_flip flip, SDL_Color clr)
+    {
+        SDL_FRect src_f = { static_cast<float>(src_rect.x), static_cast<float>(src_rect.y), static_cast<float>(src_rect.w), static_cast<float>(src_rect.h) };
+        SDL_FRect dst_f = { static_cast<float>(dst_rect.x), static_cast<float>(dst_rect.y), static_cast<float>(dst_rect.w), static_cast<float>(dst_rect.h) };
+
+        SDL_Vertex v[4];
+        _sk_bitmap_quad_vertices(src, src_f, dst_f, angle, static_cast<int>(centre_x), static_cast<int>(centre_y), flip, clr, v);
+
+        _sk_batch_target(dst, src);
+        _sk_batch_quad(v[0], v[1], v[2], v[3]);
+    }
+
     //x, y is the position to draw the bitmap to. As bitmaps scale around their centre, (x, y) is the top-left of the bitmap IF and ONLY IF scale = 1.
     //Angle is in degrees, 0 being right way up
     //Centre is the point to rotate around, relative to the bitmap centre (therefore (0,0) would rotate around the centre point)
+    // The pixels software drawing reads from a bitmap: its RGBA8888 surface,
+    // or a snapshot of its textures. Either stays unchanged until the
+    // recorded drawing is next flushed.
+    static bool _sk_raster_image_for(sk_drawing_surface *src, sk_raster_image &out_image)
+    {
+        sk_bitmap_be *src_be = static_cast<sk_bitmap_be *>(src->_data);
+
+        if ( src_be->surface && src_be->surface->format->format == SDL_PIXELFORMAT_RGBA8888 )
+        {
+            SDL_Surface *surface = src_be->surface;
+            out_image = { static_cast<const uint32_t *>(surface->pixels), surface->w, surface->h, surface->pitch / 4 };
+            return true;
+        }
+
+        if ( ! sk_snapshot_bitmap(src) ) return false;
+
+        out_image = { src_be->snapshot, src->width, src->height, src->width };
+        return true;
+    }
+
     void sk_draw_bitmap( sk_drawing_surface * src, sk_drawing_surface * dst, double * src_data, int src_data_sz, double * dst_data, int dst_data_sz, sk_renderer_flip flip )
     {
         if ( ! src || ! dst || src->kind != SGDS_Bitmap )
@@ -2182,6 +4477,9 @@ namespace splashkit_lib
         
         if ( dst_data_sz != 7 )
             return;
+
+        // the source's textures and pixels must include its recorded drawing
+        if ( _sk_software_pending && _sk_software_pending == src->_data ) _sk_flush_software_drawing();
         
         // dst_data must be 7 values
         double x         = dst_data[0];
@@ -2225,6 +4523,91 @@ namespace splashkit_lib
         // Adjust centre to be relative to the bitmap centre rather than top-left
         centre_x = (centre_x * scale_x) + dst_rect.w / 2.0f;
         centre_y = (centre_y * scale_y) + dst_rect.h / 2.0f;
+
+        sk_bitmap_be *src_be = static_cast<sk_bitmap_be *>(src->_data);
+
+        // Bitmaps shrunk to half their size or less draw from the closest mip level
+        if ( src_be->mips_wanted && ! src_be->atlas )
+        {
+            double shrink = std::max(std::fabs(scale_x), std::fabs(scale_y));
+            if ( shrink <= 0.5 && shrink > 0 && (src_be->mips_valid || _sk_build_bitmap_mips(src)) )
+            {
+                int level = std::min(src_be->mip_count, static_cast<int>(std::floor(std::log2(1.0 / shrink))));
+                sk_drawing_surface *mip = &src_be->mips[level - 1];
+
+                double fx = mip->width / static_cast<double>(src->width);
+                double fy = mip->height / static_cast<double>(src->height);
+                src_rect = {
+                    static_cast<int>(src_x * fx),
+                    static_cast<int>(src_y * fy),
+                    std::max(1, static_cast<int>(src_w * fx)),
+                    std::max(1, static_cast<int>(src_h * fy))
+                };
+
+                src = mip;
+                src_be = static_cast<sk_bitmap_be *>(mip->_data);
+            }
+        }
+
+        // Software bitmaps copy from the source's pixels in system memory
+        sk_bitmap_be *dst_be = dst->kind == SGDS_Bitmap ? static_cast<sk_bitmap_be *>(dst->_data) : nullptr;
+        sk_raster_image image;
+        if ( dst_be && dst_be->raster && _sk_raster_image_for(src, image) )
+        {
+            sk_raster_draw_image(_sk_software_target(dst), image, src_rect, dst_rect, angle, centre_x, centre_y,
+                                 (flip & sk_FLIP_HORIZONTAL) != 0, (flip & sk_FLIP_VERTICAL) != 0,
+                                 src_be->tint, src_be->premultiplied, src_be == dst_be);
+            return;
+        }
+
+        SDL_Color tint = src_be->tint;
+
+        // Packed bitmaps draw from their area of the atlas
+        sk_drawing_surface atlas_surface;
+        if ( src_be->atlas )
+        {
+            // the area is clipped to the bitmap, as SDL clips to the texture
+            SDL_Rect bounds = { 0, 0, src->width, src->height };
+            SDL_Rect clipped;
+            if ( ! SDL_IntersectRect(&src_rect, &bounds, &clipped) ) return;
+
+            if ( clipped.w != src_rect.w || clipped.h != src_rect.h )
+            {
+                double sx = dst_rect.w / static_cast<double>(src_rect.w);
+                double sy = dst_rect.h / static_cast<double>(src_rect.h);
+                int dx = static_cast<int>((clipped.x - src_rect.x) * sx);
+                int dy = static_cast<int>((clipped.y - src_rect.y) * sy);
+
+                centre_x -= dx;
+                centre_y -= dy;
+                dst_rect = { dst_rect.x + dx, dst_rect.y + dy, static_cast<int>(clipped.w * sx), static_cast<int>(clipped.h * sy) };
+                if ( 0 == dst_rect.w || 0 == dst_rect.h ) return;
+            }
+
+            src_rect = { clipped.x + src_be->atlas_area.x, clipped.y + src_be->atlas_area.y, clipped.w, clipped.h };
+
+            SDL_Surface *atlas_pixels = src_be->atlas->surface;
+            int atlas_w = 0, atlas_h = 0;
+            if ( atlas_pixels )
+            {
+                atlas_w = atlas_pixels->w;
+                atlas_h = atlas_pixels->h;
+            }
+            else
+            {
+                int tex_idx = _sk_bitmap_texture_source(src_be->atlas);
+                if ( tex_idx >= 0 ) SDL_QueryTexture(src_be->atlas->texture[tex_idx], nullptr, nullptr, &atlas_w, &atlas_h);
+            }
+
+            atlas_surface = { SGDS_Bitmap, atlas_w, atlas_h, src_be->atlas };
+            src = &atlas_surface;
+        }
+
+        if ( _sk_batching && dst->_data && _sk_num_open_windows > 0 )
+        {
+            _sk_batch_bitmap(src, dst, src_rect, dst_rect, angle, centre_x, centre_y, flip, tint);
+            return;
+        }
         
         unsigned int count = _sk_renderer_count(dst);
         
@@ -2232,15 +4615,14 @@ namespace splashkit_lib
         {
             SDL_Renderer *renderer = _sk_prepared_renderer(dst, i);
             
-            // if its a window, dont use the renderer index to get the texture
-            if (dst->kind == SGDS_Window)
+            srcT = _sk_bitmap_texture_for(src, dst, i);
+
+            // a window affine bitmap is not drawn to other windows
+            if ( ! srcT )
             {
-                unsigned int idx = static_cast<sk_window_be *>(dst->_data)->idx;
-                
-                srcT = static_cast<sk_bitmap_be *>(src->_data)->texture[ idx ];
+                _sk_complete_render(dst, i);
+                continue;
             }
-            else
-                srcT = static_cast<sk_bitmap_be *>(src->_data)->texture[ i ];
             
             //Convert parameters to format SDL_RenderCopyEx expects
             SDL_Point centre = {
@@ -2249,15 +4631,139 @@ namespace splashkit_lib
             };
             SDL_RendererFlip sdl_flip = static_cast<SDL_RendererFlip>((flip == sk_FLIP_BOTH) ? (SDL_FLIP_HORIZONTAL | SDL_FLIP_VERTICAL) : flip); //SDL does not have a FLIP_BOTH
             
+            // The atlas texture is shared, so each packed bitmap applies its own tint
+            if ( src_be->atlas )
+            {
+                SDL_SetTextureColorMod(srcT, tint.r, tint.g, tint.b);
+                SDL_SetTextureAlphaMod(srcT, tint.a);
+            }
+
             //Render
-            SDL_RenderCopyEx(renderer, srcT, &src_rect, &dst_rect, angle, &centre, sdl_flip);
+            _sk_render_copy_ex(renderer, srcT, &src_rect, &dst_rect, angle, &centre, sdl_flip);
+
+            if ( src_be->atlas )
+            {
+                SDL_SetTextureColorMod(srcT, 255, 255, 255);
+                SDL_SetTextureAlphaMod(srcT, 255);
+            }
             
             _sk_complete_render(dst, i);
         }
     }
     
+    static vector<SDL_Vertex> _sk_quad_vertices;
+    static vector<int> _sk_quad_indices;
+
+    void sk_draw_bitmap_quads(sk_drawing_surface *src, sk_drawing_surface *dst, const sk_bitmap_quad *quads, int count)
+    {
+        if ( ! src || ! dst || src->kind != SGDS_Bitmap || ! dst->_data || ! quads || count <= 0 )
+            return;
+
+        // the source's textures must include its recorded drawing
+        if ( _sk_software_pending == src->_data ) _sk_flush_software_drawing();
+
+        sk_bitmap_be *src_be = static_cast<sk_bitmap_be *>(src->_data);
+
+        // Packed bitmaps draw from their area of the atlas
+        sk_drawing_surface atlas_surface;
+        sk_drawing_surface *tex_src = src;
+        float offset_x = 0, offset_y = 0;
+
+        if ( src_be->atlas )
+        {
+            int atlas_w = 0, atlas_h = 0;
+            if ( src_be->atlas->surface )
+            {
+                atlas_w = src_be->atlas->surface->w;
+                atlas_h = src_be->atlas->surface->h;
+            }
+            else
+            {
+                int tex_idx = _sk_bitmap_texture_source(src_be->atlas);
+                if ( tex_idx >= 0 ) SDL_QueryTexture(src_be->atlas->texture[tex_idx], nullptr, nullptr, &atlas_w, &atlas_h);
+            }
+
+            atlas_surface = { SGDS_Bitmap, atlas_w, atlas_h, src_be->atlas };
+            tex_src = &atlas_surface;
+            offset_x = static_cast<float>(src_be->atlas_area.x);
+            offset_y = static_cast<float>(src_be->atlas_area.y);
+        }
+
+        bool batching = _sk_batching && _sk_num_open_windows > 0;
+        vector<SDL_Vertex> &vertices = batching ? _sk_batch.vertices : _sk_quad_vertices;
+        vector<int> &indices = batching ? _sk_batch.indices : _sk_quad_indices;
+
+        if ( batching )
+            _sk_batch_target(dst, tex_src);
+        else
+        {
+            _sk_quad_vertices.clear();
+            _sk_quad_indices.clear();
+        }
+
+        vertices.reserve(vertices.size() + static_cast<size_t>(count) * 4);
+        indices.reserve(indices.size() + static_cast<size_t>(count) * 6);
+
+        for (int q = 0; q < count; q++)
+        {
+            const sk_bitmap_quad &quad = quads[q];
+
+            // the area is clipped to the bitmap, as SDL clips to the texture
+            double sx = std::max(0.0, quad.src_x), sy = std::max(0.0, quad.src_y);
+            double sw = std::min(quad.src_x + quad.src_w, static_cast<double>(src->width)) - sx;
+            double sh = std::min(quad.src_y + quad.src_h, static_cast<double>(src->height)) - sy;
+            if ( sw <= 0 || sh <= 0 ) continue;
+
+            // scale around the centre, so x, y is the top left at a scale of 1
+            double w = sw * quad.scale_x, h = sh * quad.scale_y;
+            if ( w == 0 || h == 0 ) continue;
+
+            SDL_FRect src_rect = { static_cast<float>(sx) + offset_x, static_cast<float>(sy) + offset_y, static_cast<float>(sw), static_cast<float>(sh) };
+            SDL_FRect dst_rect = {
+                static_cast<float>(quad.x - (w - sw) / 2.0),
+                static_cast<float>(quad.y - (h - sh) / 2.0),
+                static_cast<float>(w),
+                static_cast<float>(h)
+            };
+
+            SDL_Vertex v[4];
+            _sk_bitmap_quad_vertices(tex_src, src_rect, dst_rect, quad.angle, w / 2.0, h / 2.0, sk_FLIP_NONE, _sk_to_sdl_color(quad.tint), v);
+
+            int base = static_cast<int>(vertices.size());
+            vertices.insert(vertices.end(), v, v + 4);
+            indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+        }
+
+        if ( batching || _sk_quad_indices.empty() ) return;
+
+        unsigned int renderers = _sk_renderer_count(dst);
+
+        for (unsigned int i = 0; i < renderers; i++)
+        {
+            SDL_Renderer *renderer = _sk_prepared_renderer(dst, i);
+            SDL_Texture *texture = _sk_bitmap_texture_for(tex_src, dst, i);
+
+            // a window affine bitmap is not drawn to other windows
+            if ( texture )
+            {
+                _sk_render_geometry(renderer,
+                                   texture,
+                                   _sk_quad_vertices.data(), static_cast<int>(_sk_quad_vertices.size()),
+                                   _sk_quad_indices.data(), static_cast<int>(_sk_quad_indices.size()));
+            }
+
+            _sk_complete_render(dst, i);
+        }
+    }
+
     void sk_finalise_graphics()
     {
+        sk_flush_draw_batch();
+
+        // Let background saves and captures finish writing their files
+        sk_wait_for_image_saves();
+        sk_stop_all_frame_captures();
+
         // Close all bitmaps
         for (unsigned int i = _sk_num_open_bitmaps; i > 0; i--)
         {
@@ -20,29 +20,164 @@ namespace splashkit_lib
 {
     typedef unsigned int uint;
 
+    // The state last set on a window's renderer, so changes that would leave
+    // it as it is can be skipped. SDL flushes its queued drawing whenever the
+    // target changes, so avoiding needless switches lets it batch more.
+    struct sk_render_state
+    {
+        bool            target_known;   // false when the renderer may have been changed directly
+        SDL_Texture *   target;
+        bool            clip_known;
+        bool            clipped;
+        SDL_Rect        clip;
+        bool            blend_known;
+        SDL_BlendMode   blend;
+    };
+
+    // Counts of the rendering work done in a frame, reset as each window is
+    // presented. The renderer calls below go through the counting wrappers.
+    struct sk_render_counters
+    {
+        int             draw_calls;
+        int             texture_switches;       // draws using a different texture to the last draw
+        int             render_target_changes;
+        int             text_rasterizations;
+        int             textures_created;
+        long long       bytes_uploaded;
+    };
+
+    extern sk_render_counters _sk_render_counts;
+    extern SDL_Texture *_sk_last_drawn_texture;
+
+    // The counts for the frame most recently presented
+    sk_render_counters sk_last_frame_render_counters();
+
+    inline void _sk_count_draw(SDL_Texture *texture)
+    {
+        _sk_render_counts.draw_calls++;
+        if ( texture != _sk_last_drawn_texture )
+        {
+            _sk_render_counts.texture_switches++;
+            _sk_last_drawn_texture = texture;
+        }
+    }
+
+    inline int _sk_render_copy(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dst)
+    {
+        _sk_count_draw(texture);
+        return SDL_RenderCopy(renderer, texture, src, dst);
+    }
+
+    inline int _sk_render_copy_ex(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dst, double angle, const SDL_Point *center, SDL_RendererFlip flip)
+    {
+        _sk_count_draw(texture);
+        return SDL_RenderCopyEx(renderer, texture, src, dst, angle, center, flip);
+    }
+
+    inline int _sk_render_geometry(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Vertex *vertices, int num_vertices, const int *indices, int num_indices)
+    {
+        _sk_count_draw(texture);
+        return SDL_RenderGeometry(renderer, texture, vertices, num_vertices, indices, num_indices);
+    }
+
+    inline void _sk_count_untextured_draw()
+    {
+        _sk_count_draw(nullptr);
+    }
+
+    inline int _sk_set_render_target(SDL_Renderer *renderer, SDL_Texture *texture)
+    {
+        _sk_render_counts.render_target_changes++;
+        return SDL_SetRenderTarget(renderer, texture);
+    }
+
+    inline SDL_Texture *_sk_create_texture(SDL_Renderer *renderer, Uint32 format, int access, int w, int h)
+    {
+        _sk_render_counts.textures_created++;
+        return SDL_CreateTexture(renderer, format, access, w, h);
+    }
+
+    inline SDL_Texture *_sk_create_texture_from_surface(SDL_Renderer *renderer, SDL_Surface *surface)
+    {
+        _sk_render_counts.textures_created++;
+        if ( surface ) _sk_render_counts.bytes_uploaded += static_cast<long long>(surface->pitch) * surface->h;
+        return SDL_CreateTextureFromSurface(renderer, surface);
+    }
+
+    inline int _sk_update_texture(SDL_Texture *texture, const SDL_Rect *rect, const void *pixels, int pitch)
+    {
+        int h = 0;
+        if ( rect ) h = rect->h;
+        else SDL_QueryTexture(texture, nullptr, nullptr, nullptr, &h);
+
+        _sk_render_counts.bytes_uploaded += static_cast<long long>(pitch) * h;
+        return SDL_UpdateTexture(texture, rect, pixels, pitch);
+    }
+
     struct sk_window_be
     {
         SDL_Window *    window;
         SDL_Renderer *  renderer;
+        SDL_Surface *   target;     // headless windows render onto this surface, and have no window
+        bool            changed;    // drawn on since it was last presented
         SDL_Texture *   backing;
+        int             width, height;  // the area of the backing texture in use, it may be larger
         bool            clipped;
         SDL_Rect        clip;
         unsigned int    idx;
+        sk_render_state state;
 
         // Event data store
         sk_window_data  event_data;
         sk_drawing_surface *surface;
     };
 
+    struct sk_raster_target;
+
     struct sk_bitmap_be
     {
-        // 1 texture per open window
+        // 1 texture per open window, created the first time the bitmap is used with that window
         SDL_Texture **  texture;
         SDL_Surface *   surface;
         bool            clipped;
         SDL_Rect        clip;
 
         bool            drawable; // can be drawn on
+        SDL_Color       tint;     // applied to each texture as it is created
+
+        // streaming bitmaps keep an RGBA8888 surface and upload only the dirty area on refresh
+        bool            streaming;
+        SDL_Rect        dirty;
+
+        // when set, the bitmap only ever has a texture for this window
+        sk_window_be *  window_affinity;
+
+        // packed bitmaps draw from their area of the atlas texture, keeping
+        // their surface so they can leave the atlas when drawn on
+        sk_bitmap_be *  atlas;
+        SDL_Rect        atlas_area;
+        int             atlas_refs; // on an atlas, the number of bitmaps packed into it
+
+        // premultiplied bitmaps hold colours already multiplied by their alpha,
+        // as they are when drawn onto a cleared bitmap, and are blended to match
+        bool            premultiplied;
+
+        // a copy of the pixels in system memory for reading single pixels,
+        // kept until the bitmap is next changed
+        uint32_t *      snapshot;
+        bool            snapshot_valid;
+        int             reads_since_change;
+
+        // copies at half, quarter, ... size, drawn from when the bitmap is
+        // shrunk a lot, and rebuilt when next needed after it changes
+        sk_drawing_surface *mips;
+        int             mip_count;
+        bool            mips_wanted;
+        bool            mips_valid;
+
+        // when set, the bitmap is drawn on in software: its RGBA8888 surface
+        // holds the pixels and supported drawing is recorded here
+        sk_raster_target *raster;
     };
 
     sk_drawing_surface sk_open_window(const char *title, int width, int height);
@@ -51,9 +186,50 @@ namespace splashkit_lib
 
     sk_drawing_surface sk_load_bitmap(const char * filename);
 
+    // Loading in two steps: the decode does not touch the renderer or the
+    // bitmap list, so it can run on any thread. The result is then turned
+    // into a bitmap on the main thread, or freed if it is not needed.
+    SDL_Surface *sk_decode_bitmap(const char * filename);
+    SDL_Surface *sk_decode_bitmap_from_memory(const void *data, size_t size);
+    sk_drawing_surface sk_bitmap_from_decoded(SDL_Surface *surface);
+    void sk_free_decoded_bitmap(SDL_Surface *surface);
+
+    // Baked textures (.sktex files) are decoded by sk_decode_bitmap
+    bool sk_save_baked_texture(sk_drawing_surface *surface, const char *filename, bool compress);
+
+    // Free the copy of a bitmap's pixels in system memory, once a texture holds them
+    void sk_release_bitmap_surface(sk_drawing_surface *surface);
+
+    // Copy small loaded bitmaps into shared atlas textures, so drawing them
+    // does not switch textures. Returns the number of bitmaps packed.
+    int sk_pack_bitmaps_into_atlas(sk_drawing_surface **bitmaps, int count);
+    bool sk_bitmap_in_atlas(sk_drawing_surface *surface);
+
+
+    void sk_set_bitmap_window_affinity(sk_drawing_surface *bitmap, sk_drawing_surface *window);
+
+    // Memory held by a bitmap's pixels in system memory and in textures
+    void sk_bitmap_memory(sk_drawing_surface *surface, size_t *cpu_bytes, size_t *gpu_bytes);
+
+    // True while a loaded bitmap has not been drawn on, tinted or tied to a
+    // window, so it could be loaded again from its file
+    bool sk_bitmap_matches_source(sk_drawing_surface *surface);
 
     void sk_draw_bitmap( sk_drawing_surface * src, sk_drawing_surface * dst, double * src_data, int src_data_sz, double * dst_data, int dst_data_sz, sk_renderer_flip flip );
 
+    // One copy of an area of a bitmap for sk_draw_bitmap_quads. The copy is
+    // scaled and rotated around its centre, and x, y is its top left when
+    // the scale is 1, as in sk_draw_bitmap.
+    struct sk_bitmap_quad
+    {
+        double src_x, src_y, src_w, src_h;
+        double x, y, angle, scale_x, scale_y;
+        sk_color tint;
+    };
+
+    // Draw many copies of areas of a bitmap in one geometry submission
+    void sk_draw_bitmap_quads(sk_drawing_surface *src, sk_drawing_surface *dst, const sk_bitmap_quad *quads, int count);
+
     void sk_set_icon(sk_drawing_surface *surface, sk_drawing_surface *icon);
 
 
@@ -64,6 +240,9 @@ namespace splashkit_lib
 
     void sk_draw_aa_rect(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height);
     void sk_fill_aa_rect(sk_drawing_surface *surface, sk_color clr, double x, double y, double width, double height);
+    void sk_fill_aa_rect(sk_drawing_surface *surface, rgba8 clr, double x, double y, double width, double height);
+    // Fill count rectangles, each of four values x, y, width, height in data, with a color each from clrs
+    void sk_fill_aa_rects(sk_drawing_surface *surface, const rgba8 *clrs, const double *data, int count);
     void sk_draw_rect(sk_drawing_surface *surface, sk_color clr, double *data, int data_sz);
     void sk_fill_rect(sk_drawing_surface *surface, sk_color clr, double *data, int data_sz);
 
@@ -77,10 +256,30 @@ namespace splashkit_lib
     void sk_draw_pixel(sk_drawing_surface *surface, sk_color clr, double x, double y);
     sk_color sk_read_pixel(sk_drawing_surface *surface, int x, int y);
 
+    // Read all of a bitmap's pixels into system memory, so sk_read_pixel
+    // does not wait on the renderer until the bitmap next changes. Reading
+    // a bitmap a second time since it changed takes a snapshot as well.
+    bool sk_snapshot_bitmap(sk_drawing_surface *surface);
+    bool sk_bitmap_has_snapshot(sk_drawing_surface *surface);
+
+    // Keep smaller copies of a bitmap, so drawing it at half its size or
+    // less samples the closest copy rather than the whole bitmap
+    bool sk_generate_bitmap_mips(sk_drawing_surface *surface);
+    void sk_free_bitmap_mips(sk_drawing_surface *surface);
+    int sk_bitmap_mip_count(sk_drawing_surface *surface);
+
+    // Software rendered bitmaps record fills, clears and bitmap copies and
+    // draw them on the CPU when the pixels are next needed. Other drawing
+    // onto them returns them to the renderer.
+    void sk_set_bitmap_software_rendering(sk_drawing_surface *surface, bool value);
+    bool sk_bitmap_software_rendering(sk_drawing_surface *surface);
+
     void sk_set_bitmap_pixel(sk_drawing_surface *surface, sk_color clr, int x, int y);
+    void sk_set_bitmap_pixels(sk_drawing_surface *surface, const uint32_t *pixels, int x, int y, int width, int height);
     void sk_refresh_bitmap(sk_drawing_surface *surface);
 
     void sk_set_bitmap_tint(sk_drawing_surface *surface, sk_color clr);
+    void sk_set_bitmap_premultiplied(sk_drawing_surface *surface, bool value);
 
     void sk_draw_circle(sk_drawing_surface *surface, sk_color clr, double x, double y, double radius);
     void sk_fill_circle(sk_drawing_surface *surface, sk_color clr, double x, double y, double radius);
@@ -91,6 +290,20 @@ namespace splashkit_lib
     void sk_clear_clip_rect(sk_drawing_surface *surface);
 
     void sk_to_pixels(sk_drawing_surface *surface, int *pixels, int sz);
+    // Read the area x, y, w, h of the surface as RRGGBBAA pixels, sz must be w * h
+    void sk_to_pixels(sk_drawing_surface *surface, int x, int y, int w, int h, int *pixels, int sz);
+
+    void sk_set_batched_rendering(bool value);
+    bool sk_batched_rendering();
+
+    // Draws bitmaps through one window's renderer, other windows copy the result when they use it
+    void sk_set_single_bitmap_renderer(bool value);
+    bool sk_single_bitmap_renderer();
+
+    // Syncs presenting windows with the display's refresh, returns false when this is not supported
+    bool sk_set_vsync(bool value);
+    bool sk_vsync();
+    void sk_flush_draw_batch();
 
     void sk_show_border(sk_drawing_surface *surface, bool border);
 
@@ -100,8 +313,36 @@ namespace splashkit_lib
 
     int sk_save_png(sk_drawing_surface * surface, const char *filename);
 
+    enum sk_image_encoding
+    {
+        SK_ENCODE_PNG,
+        SK_ENCODE_QOI
+    };
+
+    // Read the surface's pixels and write them to a file. The level is the
+    // zlib compression level for PNG files (-1 for the default, 0 to 9).
+    bool sk_save_image(sk_drawing_surface *surface, const char *filename, sk_image_encoding encoding, int level);
+
+    // Read the pixels now and encode them on a background thread. Returns
+    // an id to check with sk_image_save_status, or 0 if nothing was read.
+    int sk_save_image_async(sk_drawing_surface *surface, const char *filename, sk_image_encoding encoding, int level);
+
+    // 0 while the save is running, 1 once written, -1 if it failed or is unknown
+    int sk_image_save_status(int id);
+
+    // True while a background save is still writing to the file
+    bool sk_image_save_pending(const char *filename);
+
+    void sk_wait_for_image_saves();
+
     struct sk_window_be;
 
+    // Drawing may leave a bitmap as the renderer's target, so switch back to
+    // the window's backing before using the renderer directly
+    void _sk_restore_default_render_target(sk_window_be *window_be);
+    // Call after changing the renderer's target, clip or blend mode directly
+    void _sk_forget_render_state(sk_window_be *window_be);
+
     sk_window_be *_sk_get_window_with_id(unsigned int window_id);
     sk_window_be *_sk_get_window_with_pointer(pointer p);
     
@@ -17,6 +17,11 @@
 #include "graphics_driver.h"
 #include "window_manager.h"
 #include "interface_driver.h"
+#include "profiling_driver.h"
+
+#include <fstream>
+#include <iterator>
+#include <cstring>
 
 namespace splashkit_lib
 {
@@ -28,6 +33,27 @@ namespace splashkit_lib
     map<SDL_Keycode, key_code> _sdl_key_map;
     map<key_code, SDL_Keycode> _sk_key_map;
 
+    // SDL keycodes are either a character below 128, or a scancode with
+    // SDLK_SCANCODE_MASK set, so both fit in one table indexed without a search
+    #define SK_SDL_KEY_TABLE_SIZE (128 + SDL_NUM_SCANCODES)
+    static key_code _sdl_key_table[SK_SDL_KEY_TABLE_SIZE];
+
+    static int _sdl_key_table_index(SDL_Keycode sym)
+    {
+        if ( sym >= 0 && sym < 128 ) return sym;
+
+        int scancode = sym & ~SDLK_SCANCODE_MASK;
+        if ( (sym & SDLK_SCANCODE_MASK) && scancode >= 0 && scancode < SDL_NUM_SCANCODES ) return 128 + scancode;
+
+        return -1;
+    }
+
+    static key_code _to_key_code(SDL_Keycode sym)
+    {
+        int idx = _sdl_key_table_index(sym);
+        return idx < 0 ? UNKNOWN_KEY : _sdl_key_table[idx];
+    }
+
     void _init_key_maps()
     {
         if ( _sdl_key_map.size() > 0 ) return;
@@ -293,6 +319,12 @@ namespace splashkit_lib
         _sdl_key_map[SDLK_SYSREQ] = SYS_REQ_KEY;
         _sdl_key_map[SDLK_MENU] = MENU_KEY;
         _sdl_key_map[SDLK_POWER] = POWER_KEY;
+
+        for (auto &entry : _sdl_key_map)
+        {
+            int idx = _sdl_key_table_index(entry.first);
+            if ( idx >= 0 ) _sdl_key_table[idx] = entry.second;
+        }
     }
 
     void _stop_reading_text(window current)
@@ -478,6 +510,8 @@ namespace splashkit_lib
                 break;
             case SDL_WINDOWEVENT_EXPOSED:
                 //            SDL_Log("Window %d exposed", event->window.windowID);
+                // the window system needs the contents redrawn
+                window->changed = true;
                 break;
             case SDL_WINDOWEVENT_MOVED:
                 //            SDL_Log("Window %d moved to %d,%d",
@@ -538,132 +572,510 @@ namespace splashkit_lib
         }
     }
 
-    void sk_process_events()
+    bool sk_has_pending_events()
     {
         internal_sk_init();
-        SDL_Event event;
+        SDL_PumpEvents();
+        return SDL_HasEvents(SDL_FIRSTEVENT, SDL_LASTEVENT) == SDL_TRUE;
+    }
 
-        while (SDL_WaitEventTimeout(&event, 0))
+    //
+    // Input recording and replay
+    //
+    // Recordings are a header followed by a stream of records, each starting
+    // with a one byte record type. The events of each frame are followed by
+    // a frame record holding the mouse state at the end of that frame. Values
+    // are stored in the machine's byte order, little endian on every platform
+    // SplashKit supports.
+    //
+    //   header:  magic[4] "SKIR", u32 version, u32 seed
+    //
+    static const char SK_INPUT_MAGIC[4] = { 'S', 'K', 'I', 'R' };
+    #define SK_INPUT_VERSION 1
+
+    enum sk_input_record
+    {
+        SK_RECORD_FRAME         = 0,  // i32 mouse x, i32 mouse y, u32 buttons
+        SK_RECORD_KEY_DOWN      = 1,  // i32 keycode
+        SK_RECORD_KEY_UP        = 2,  // i32 keycode
+        SK_RECORD_MOUSE_DOWN    = 3,  // u8 button, i32 x, i32 y
+        SK_RECORD_MOUSE_UP      = 4,  // u8 button, i32 x, i32 y
+        SK_RECORD_MOUSE_WHEEL   = 5,  // i32 x, i32 y
+        SK_RECORD_MOUSE_MOTION  = 6,  // i32 x, i32 y, i32 xrel, i32 yrel
+        SK_RECORD_TEXT_INPUT    = 7,  // u8 length, text
+        SK_RECORD_TEXT_EDITING  = 8,  // u8 length, text, i32 start, i32 length
+        SK_RECORD_WINDOW        = 9,  // u32 window id, u8 event, i32 data1, i32 data2
+        SK_RECORD_QUIT          = 10
+    };
+
+    static std::ofstream _sk_recording;
+    static bool _sk_is_recording = false;
+
+    static vector<unsigned char> _sk_replay;
+    static size_t _sk_replay_pos = 0;
+    static bool _sk_is_replaying = false;
+
+    // the mouse state as it was in the frame being replayed
+    static int _sk_replay_mouse_x = 0, _sk_replay_mouse_y = 0;
+    static uint32_t _sk_replay_buttons = 0;
+    static int _sk_replay_rel_x = 0, _sk_replay_rel_y = 0;
+
+    static void _sk_record_bytes(const void *data, size_t size)
+    {
+        _sk_recording.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    }
+
+    static void _sk_record_u8(uint8_t value)  { _sk_record_bytes(&value, 1); }
+    static void _sk_record_i32(int32_t value) { _sk_record_bytes(&value, 4); }
+
+    static void _sk_record_text(const char *text)
+    {
+        size_t len = strnlen(text, SDL_TEXTINPUTEVENT_TEXT_SIZE - 1);
+        _sk_record_u8(static_cast<uint8_t>(len));
+        _sk_record_bytes(text, len);
+    }
+
+    static void _sk_record_event(const SDL_Event &event)
+    {
+        switch ( event.type )
+        {
+            case SDL_WINDOWEVENT:
+                _sk_record_u8(SK_RECORD_WINDOW);
+                _sk_record_i32(static_cast<int32_t>(event.window.windowID));
+                _sk_record_u8(event.window.event);
+                _sk_record_i32(event.window.data1);
+                _sk_record_i32(event.window.data2);
+                break;
+            case SDL_QUIT:
+                _sk_record_u8(SK_RECORD_QUIT);
+                break;
+            case SDL_KEYDOWN:
+            case SDL_KEYUP:
+                _sk_record_u8(event.type == SDL_KEYDOWN ? SK_RECORD_KEY_DOWN : SK_RECORD_KEY_UP);
+                _sk_record_i32(event.key.keysym.sym);
+                break;
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+                _sk_record_u8(event.type == SDL_MOUSEBUTTONDOWN ? SK_RECORD_MOUSE_DOWN : SK_RECORD_MOUSE_UP);
+                _sk_record_u8(event.button.button);
+                _sk_record_i32(event.button.x);
+                _sk_record_i32(event.button.y);
+                break;
+            case SDL_MOUSEWHEEL:
+                _sk_record_u8(SK_RECORD_MOUSE_WHEEL);
+                _sk_record_i32(event.wheel.x);
+                _sk_record_i32(event.wheel.y);
+                break;
+            case SDL_MOUSEMOTION:
+                _sk_record_u8(SK_RECORD_MOUSE_MOTION);
+                _sk_record_i32(event.motion.x);
+                _sk_record_i32(event.motion.y);
+                _sk_record_i32(event.motion.xrel);
+                _sk_record_i32(event.motion.yrel);
+                break;
+            case SDL_TEXTINPUT:
+                _sk_record_u8(SK_RECORD_TEXT_INPUT);
+                _sk_record_text(event.text.text);
+                break;
+            case SDL_TEXTEDITING:
+                _sk_record_u8(SK_RECORD_TEXT_EDITING);
+                _sk_record_text(event.edit.text);
+                _sk_record_i32(event.edit.start);
+                _sk_record_i32(event.edit.length);
+                break;
+        }
+    }
+
+    static void _sk_record_frame()
+    {
+        int x = 0, y = 0;
+        uint32_t buttons = SDL_GetMouseState(&x, &y);
+
+        _sk_record_u8(SK_RECORD_FRAME);
+        _sk_record_i32(x);
+        _sk_record_i32(y);
+        _sk_record_i32(static_cast<int32_t>(buttons));
+    }
+
+    bool sk_start_input_recording(const char *filename, unsigned int seed)
+    {
+        sk_stop_input_recording();
+
+        _sk_recording.open(filename, std::ios::binary | std::ios::trunc);
+        if ( ! _sk_recording ) return false;
+
+        uint32_t version = SK_INPUT_VERSION;
+        uint32_t seed_value = seed;
+        _sk_record_bytes(SK_INPUT_MAGIC, sizeof(SK_INPUT_MAGIC));
+        _sk_record_bytes(&version, 4);
+        _sk_record_bytes(&seed_value, 4);
+
+        _sk_is_recording = true;
+        return true;
+    }
+
+    void sk_stop_input_recording()
+    {
+        if ( ! _sk_is_recording ) return;
+
+        _sk_recording.close();
+        _sk_is_recording = false;
+    }
+
+    bool sk_input_recording()
+    {
+        return _sk_is_recording;
+    }
+
+    // Read a value from the replay, returning false at the end of the data
+    static bool _sk_replay_bytes(void *data, size_t size)
+    {
+        if ( _sk_replay_pos + size > _sk_replay.size() ) return false;
+
+        memcpy(data, _sk_replay.data() + _sk_replay_pos, size);
+        _sk_replay_pos += size;
+        return true;
+    }
+
+    static bool _sk_replay_text(char *text, size_t capacity)
+    {
+        uint8_t len = 0;
+        if ( ! _sk_replay_bytes(&len, 1) || len >= capacity ) return false;
+        if ( ! _sk_replay_bytes(text, len) ) return false;
+
+        text[len] = '\0';
+        return true;
+    }
+
+    bool sk_start_input_replay(const char *filename, unsigned int *seed)
+    {
+        sk_stop_input_replay();
+
+        std::ifstream in(filename, std::ios::binary);
+        if ( ! in ) return false;
+
+        _sk_replay.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        _sk_replay_pos = 0;
+
+        char magic[4];
+        uint32_t version = 0, seed_value = 0;
+
+        if ( ! _sk_replay_bytes(magic, 4) || memcmp(magic, SK_INPUT_MAGIC, 4) != 0 ||
+             ! _sk_replay_bytes(&version, 4) || version != SK_INPUT_VERSION ||
+             ! _sk_replay_bytes(&seed_value, 4) )
+        {
+            _sk_replay.clear();
+            return false;
+        }
+
+        if ( seed ) *seed = seed_value;
+
+        _sk_replay_rel_x = 0;
+        _sk_replay_rel_y = 0;
+        _sk_is_replaying = true;
+        return true;
+    }
+
+    void sk_stop_input_replay()
+    {
+        _sk_is_replaying = false;
+        _sk_replay.clear();
+        _sk_replay.shrink_to_fit();
+        _sk_replay_pos = 0;
+    }
+
+    bool sk_input_replaying()
+    {
+        return _sk_is_replaying;
+    }
+
+    //
+    // Pointer samples keep each motion event of the frame, rather than only
+    // the state at its end
+    //
+    static bool _sk_sampling_pointer = false;
+    static vector<sk_pointer_sample> _sk_pointer_samples;
+
+    void sk_set_pointer_sampling(bool value)
+    {
+        _sk_sampling_pointer = value;
+        if ( ! value )
         {
-            switch ( event.type )
+            _sk_pointer_samples.clear();
+            _sk_pointer_samples.shrink_to_fit();
+        }
+    }
+
+    bool sk_pointer_sampling()
+    {
+        return _sk_sampling_pointer;
+    }
+
+    const vector<sk_pointer_sample> &sk_pointer_samples()
+    {
+        return _sk_pointer_samples;
+    }
+
+    bool sk_set_relative_mouse_mode(bool value)
+    {
+        internal_sk_init();
+        return SDL_SetRelativeMouseMode(value ? SDL_TRUE : SDL_FALSE) == 0;
+    }
+
+    bool sk_relative_mouse_mode()
+    {
+        return SDL_GetRelativeMouseMode() == SDL_TRUE;
+    }
+
+    static void _sk_handle_event(SDL_Event &event)
+    {
+        switch ( event.type )
+        {
+            case SDL_WINDOWEVENT:
             {
-                case SDL_WINDOWEVENT:
+                _sk_handle_window_event(&event);
+                break;
+            }
+
+            case SDL_QUIT:
+            {
+                // Use callback to inform front end of quit
+                if (_input_callbacks.do_quit)
                 {
-                    _sk_handle_window_event(&event);
-                    break;
+                    _input_callbacks.do_quit();
                 }
+                break;
+            }
 
-                case SDL_QUIT:
+            case SDL_KEYDOWN:
+            {
+                if (_input_callbacks.handle_key_down)
                 {
-                    // Use callback to inform front end of quit
-                    if (_input_callbacks.do_quit)
-                    {
-                        _input_callbacks.do_quit();
-                    }
-                    break;
+                    key_code key_code = _to_key_code(event.key.keysym.sym);
+                    _input_callbacks.handle_key_down(key_code);
                 }
 
-                case SDL_KEYDOWN:
-                {
-                    if (_input_callbacks.handle_key_down)
-                    {
-                        key_code key_code = _sdl_key_map[event.key.keysym.sym];
-                        _input_callbacks.handle_key_down(key_code);
-                    }
+                sk_interface_keydown(event.key.keysym.sym);
 
-                    sk_interface_keydown(event.key.keysym.sym);
+                break;
+            }
 
-                    break;
+            case SDL_KEYUP:
+            {
+                if (_input_callbacks.handle_key_up)
+                {
+                    key_code key_code = _to_key_code(event.key.keysym.sym);
+                    _handle_key_type(event.key.keysym.sym);
+                    _input_callbacks.handle_key_up(key_code);
                 }
 
-                case SDL_KEYUP:
-                {
-                    if (_input_callbacks.handle_key_up)
-                    {
-                        key_code key_code = _sdl_key_map[event.key.keysym.sym];
-                        _handle_key_type(event.key.keysym.sym);
-                        _input_callbacks.handle_key_up(key_code);
-                    }
+                sk_interface_keyup(event.key.keysym.sym);
 
-                    sk_interface_keyup(event.key.keysym.sym);
+                break;
+            }
 
-                    break;
+            case SDL_MOUSEBUTTONUP:
+            {
+                if (_input_callbacks.handle_mouse_up)
+                {
+                    int mouse_button = event.button.button;
+                    _input_callbacks.handle_mouse_up(mouse_button);
                 }
 
-                case SDL_MOUSEBUTTONUP:
-                {
-                    if (_input_callbacks.handle_mouse_up)
-                    {
-                        int mouse_button = event.button.button;
-                        _input_callbacks.handle_mouse_up(mouse_button);
-                    }
+                sk_interface_mouseup(event.button.x, event.button.y, event.button.button);
 
-                    sk_interface_mouseup(event.button.x, event.button.y, event.button.button);
+                break;
+            }
 
-                    break;
+            case SDL_MOUSEBUTTONDOWN:
+            {
+                if (_input_callbacks.handle_mouse_down)
+                {
+                    int mouse_button = event.button.button;
+                    _input_callbacks.handle_mouse_down(mouse_button);
                 }
 
-                case SDL_MOUSEBUTTONDOWN:
-                {
-                    if (_input_callbacks.handle_mouse_down)
-                    {
-                        int mouse_button = event.button.button;
-                        _input_callbacks.handle_mouse_down(mouse_button);
-                    }
+                sk_interface_mousedown(event.button.x, event.button.y, event.button.button);
 
-                    sk_interface_mousedown(event.button.x, event.button.y, event.button.button);
+                break;
+            }
 
-                    break;
+            case SDL_MOUSEWHEEL:
+            {
+                if (_input_callbacks.handle_mouse_wheel)
+                {
+                    _input_callbacks.handle_mouse_wheel(event.wheel.x, event.wheel.y);
                 }
 
-                case SDL_MOUSEWHEEL:
-                {
-                    if (_input_callbacks.handle_mouse_wheel)
-                    {
-                        _input_callbacks.handle_mouse_wheel(event.wheel.x, event.wheel.y);
-                    }
+                sk_interface_scroll(event.wheel.x, event.wheel.y);
 
-                    sk_interface_scroll(event.wheel.x, event.wheel.y);
+                break;
+            }
 
-                    break;
+            case SDL_TEXTEDITING:
+            {
+                if (&_handle_editing_text)
+                {
+                    char* text = event.edit.text;
+                    int cursor = event.edit.start;
+                    int selection_len = event.edit.length;
+
+                    _handle_editing_text(text, cursor, selection_len);
                 }
+                break;
+            }
 
-                case SDL_TEXTEDITING:
+            case SDL_TEXTINPUT:
+            {
+                if (&_handle_input_text)
                 {
-                    if (&_handle_editing_text)
-                    {
-                        char* text = event.edit.text;
-                        int cursor = event.edit.start;
-                        int selection_len = event.edit.length;
+                    char* text = event.text.text;
 
-                        _handle_editing_text(text, cursor, selection_len);
-                    }
-                    break;
+                    _handle_input_text(text);
                 }
 
-                case SDL_TEXTINPUT:
+                sk_interface_text(event.text.text);
+
+                break;
+            }
+
+            case SDL_MOUSEMOTION:
+            {
+                if (_sk_sampling_pointer)
                 {
-                    if (&_handle_input_text)
-                    {
-                        char* text = event.text.text;
+                    _sk_pointer_samples.push_back({event.motion.timestamp, event.motion.x, event.motion.y, event.motion.xrel, event.motion.yrel});
+                }
 
-                        _handle_input_text(text);
-                    }
+                sk_interface_mousemove(event.motion.x, event.motion.y);
+
+                break;
+            }
+        }
+    }
 
-                    sk_interface_text(event.text.text);
+    //
+    // Dispatch the recorded events of the next frame, in place of those from
+    // SDL. The replay stops at the end of the data, or if it is damaged.
+    //
+    static void _sk_replay_frame()
+    {
+        uint8_t type;
 
-                    break;
-                }
+        while ( _sk_replay_bytes(&type, 1) )
+        {
+            SDL_Event event;
+            memset(&event, 0, sizeof(event));
 
-                case SDL_MOUSEMOTION:
-                {
-                    sk_interface_mousemove(event.motion.x, event.motion.y);
+            int32_t a = 0, b = 0, c = 0, d = 0;
+            uint8_t u = 0;
+            bool ok = true;
 
+            switch ( type )
+            {
+                case SK_RECORD_FRAME:
+                    ok = _sk_replay_bytes(&a, 4) && _sk_replay_bytes(&b, 4) && _sk_replay_bytes(&c, 4);
+                    if ( ok )
+                    {
+                        _sk_replay_mouse_x = a;
+                        _sk_replay_mouse_y = b;
+                        _sk_replay_buttons = static_cast<uint32_t>(c);
+                        return;
+                    }
+                    break;
+                case SK_RECORD_KEY_DOWN:
+                case SK_RECORD_KEY_UP:
+                    ok = _sk_replay_bytes(&a, 4);
+                    event.type = type == SK_RECORD_KEY_DOWN ? SDL_KEYDOWN : SDL_KEYUP;
+                    event.key.keysym.sym = a;
+                    break;
+                case SK_RECORD_MOUSE_DOWN:
+                case SK_RECORD_MOUSE_UP:
+                    ok = _sk_replay_bytes(&u, 1) && _sk_replay_bytes(&a, 4) && _sk_replay_bytes(&b, 4);
+                    event.type = type == SK_RECORD_MOUSE_DOWN ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+                    event.button.button = u;
+                    event.button.x = a;
+                    event.button.y = b;
+                    break;
+                case SK_RECORD_MOUSE_WHEEL:
+                    ok = _sk_replay_bytes(&a, 4) && _sk_replay_bytes(&b, 4);
+                    event.type = SDL_MOUSEWHEEL;
+                    event.wheel.x = a;
+                    event.wheel.y = b;
+                    break;
+                case SK_RECORD_MOUSE_MOTION:
+                    ok = _sk_replay_bytes(&a, 4) && _sk_replay_bytes(&b, 4) && _sk_replay_bytes(&c, 4) && _sk_replay_bytes(&d, 4);
+                    event.type = SDL_MOUSEMOTION;
+                    event.motion.x = a;
+                    event.motion.y = b;
+                    event.motion.xrel = c;
+                    event.motion.yrel = d;
+                    _sk_replay_rel_x += c;
+                    _sk_replay_rel_y += d;
+                    break;
+                case SK_RECORD_TEXT_INPUT:
+                    ok = _sk_replay_text(event.text.text, sizeof(event.text.text));
+                    event.type = SDL_TEXTINPUT;
+                    break;
+                case SK_RECORD_TEXT_EDITING:
+                    ok = _sk_replay_text(event.edit.text, sizeof(event.edit.text)) && _sk_replay_bytes(&a, 4) && _sk_replay_bytes(&b, 4);
+                    event.type = SDL_TEXTEDITING;
+                    event.edit.start = a;
+                    event.edit.length = b;
+                    break;
+                case SK_RECORD_WINDOW:
+                    ok = _sk_replay_bytes(&a, 4) && _sk_replay_bytes(&u, 1) && _sk_replay_bytes(&b, 4) && _sk_replay_bytes(&c, 4);
+                    event.type = SDL_WINDOWEVENT;
+                    event.window.windowID = static_cast<Uint32>(a);
+                    event.window.event = u;
+                    event.window.data1 = b;
+                    event.window.data2 = c;
+                    break;
+                case SK_RECORD_QUIT:
+                    event.type = SDL_QUIT;
+                    break;
+                default:
+                    ok = false;
                     break;
-                }
             }
+
+            if ( ! ok ) break;
+
+            _sk_handle_event(event);
+        }
+
+        // out of data, so return to live input
+        sk_stop_input_replay();
+    }
+
+    void sk_process_events()
+    {
+        SK_PROFILE_SCOPE("process events");
+
+        internal_sk_init();
+        SDL_Event event;
+
+        _sk_pointer_samples.clear();
+
+        while (SDL_WaitEventTimeout(&event, 0))
+        {
+            if ( _sk_is_replaying )
+            {
+                // live input is ignored while replaying, other than requests to close
+                if ( event.type == SDL_QUIT || (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE) )
+                    _sk_handle_event(event);
+                continue;
+            }
+
+            if ( _sk_is_recording ) _sk_record_event(event);
+
+            _sk_handle_event(event);
         }
 
+        if ( _sk_is_replaying )
+            _sk_replay_frame();
+        else if ( _sk_is_recording )
+            _sk_record_frame();
+
         sk_interface_start();
     }
 
@@ -803,7 +1215,13 @@ namespace splashkit_lib
     {
         int lx = 0, ly = 0;
         
-        SDL_GetMouseState(&lx, &ly);
+        if ( _sk_is_replaying )
+        {
+            lx = _sk_replay_mouse_x;
+            ly = _sk_replay_mouse_y;
+        }
+        else
+            SDL_GetMouseState(&lx, &ly);
         x = lx;
         y = ly;
     }
@@ -812,14 +1230,22 @@ namespace splashkit_lib
     {
         int lx = 0, ly = 0;
         
-        SDL_GetRelativeMouseState(&lx, &ly);
+        if ( _sk_is_replaying )
+        {
+            lx = _sk_replay_rel_x;
+            ly = _sk_replay_rel_y;
+            _sk_replay_rel_x = 0;
+            _sk_replay_rel_y = 0;
+        }
+        else
+            SDL_GetRelativeMouseState(&lx, &ly);
         x = lx;
         y = ly;
     }
     
     bool sk_mouse_button_down(uint32_t button)
     {
-        int state = SDL_GetMouseState(nullptr, nullptr);
+        uint32_t state = _sk_is_replaying ? _sk_replay_buttons : SDL_GetMouseState(nullptr, nullptr);
         return state & SDL_BUTTON(button);
     }
     
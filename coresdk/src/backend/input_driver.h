@@ -48,7 +48,32 @@ namespace splashkit_lib
 
     extern sk_input_callbacks _input_callbacks;
 
+    // One mouse motion event, in the coordinates of the window it occurred in
+    struct sk_pointer_sample
+    {
+        uint32_t timestamp; // milliseconds
+        int x, y;
+        int xrel, yrel;
+    };
+
     void sk_process_events();
+    bool sk_has_pending_events();
+
+    // Record the events processed each frame to a file, or replay them in
+    // place of live input. The seed is stored with the recording.
+    bool sk_start_input_recording(const char *filename, unsigned int seed);
+    void sk_stop_input_recording();
+    bool sk_input_recording();
+    bool sk_start_input_replay(const char *filename, unsigned int *seed);
+    void sk_stop_input_replay();
+    bool sk_input_replaying();
+
+    void sk_set_pointer_sampling(bool value);
+    bool sk_pointer_sampling();
+    const vector<sk_pointer_sample> &sk_pointer_samples();
+
+    bool sk_set_relative_mouse_mode(bool value);
+    bool sk_relative_mouse_mode();
     int sk_window_close_requested(sk_drawing_surface* surf);
     int sk_key_pressed(int key_code);
     void sk_start_unicode_text_input(int x, int y, int w, int h);
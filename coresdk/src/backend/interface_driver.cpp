@@ -13,6 +13,10 @@
 #include <iostream>
 #include <cstdlib>
 #include <set>
+#include <map>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
 
 using namespace std;
 
@@ -99,7 +103,7 @@ namespace splashkit_lib
         if (!font_info || !font_info->first) return 8 * len;
 
         int w,h;
-        sk_text_size(font_info->first, font_info->second, std::string(text, len), &w, &h);
+        sk_text_size(font_info->first, font_info->second, text, static_cast<size_t>(len), &w, &h);
         return w;
     }
 
@@ -305,7 +309,246 @@ namespace splashkit_lib
             style_init_callback();
     }
 
-    void sk_interface_draw(drawing_options opts)
+    // Draw one command, moved by (-dx, -dy) so panels can be drawn into their cache
+    static void _draw_command(sk_drawing_surface *surface, mu_Command *cmd, int dx, int dy, const drawing_options &opts, sk_drawing_surface *ui_atlas)
+    {
+        switch (cmd->type)
+        {
+            case MU_COMMAND_TEXT:
+                const font_size_pair* font_info;
+                font_info = _get_font_size_pair(cmd->text.font);
+
+                if (cmd->text.font)
+                    sk_draw_text(surface, font_info->first, font_info->second, cmd->text.pos.x - dx, cmd->text.pos.y - dy, cmd->text.str, from_mu(cmd->text.color));
+
+                break;
+
+            case MU_COMMAND_RECT:
+                sk_fill_aa_rect(surface, from_mu(cmd->rect.color), cmd->rect.rect.x - dx, cmd->rect.rect.y - dy, cmd->rect.rect.w, cmd->rect.rect.h);
+
+                break;
+
+            case MU_COMMAND_BLUR_RECT:
+                mu_BlurredRectCommand* brect;
+                brect = (mu_BlurredRectCommand*)cmd;
+                sk_draw_blurred_rect(surface, from_mu(brect->color), brect->rect.x - dx, brect->rect.y - dy, brect->rect.w, brect->rect.h, brect->radius);
+
+                break;
+
+            case MU_COMMAND_ICON:
+                rectangle atlas_rect;
+                double src_data[4];
+                double dst_data[7];
+                sk_renderer_flip flip;
+
+                // if it's a custom icon, handle specially
+                if (cmd->icon.id >= MU_ICON_MAX)
+                {
+                    registered_icon* icon = _get_registered_icon(cmd->icon.id);
+                    if (icon)
+                    {
+                        icon->dst_data[0] = cmd->icon.rect.x - dx + (cmd->icon.rect.w - icon->src_data[2]) / 2; // X
+                        icon->dst_data[1] = cmd->icon.rect.y - dy + (cmd->icon.rect.h - icon->src_data[3]) / 2; // Y
+                        sk_draw_bitmap(icon->src, surface, icon->src_data, 4, icon->dst_data, 7, icon->flip);
+                    }
+                }
+                else // otherwise draw from atlas
+                {
+                    atlas_rect = atlas[cmd->icon.id];
+
+                    src_data[0] = atlas_rect.x;
+                    src_data[1] = atlas_rect.y;
+                    src_data[2] = atlas_rect.width;
+                    src_data[3] = atlas_rect.height;
+
+                    dst_data[0] = cmd->icon.rect.x - dx + (cmd->icon.rect.w - atlas_rect.width) / 2; // X
+                    dst_data[1] = cmd->icon.rect.y - dy + (cmd->icon.rect.h - atlas_rect.height) / 2; // Y
+                    dst_data[2] = opts.angle; // Angle
+                    dst_data[3] = opts.anchor_offset_x; // Centre X
+                    dst_data[4] = opts.anchor_offset_y; // Centre Y
+                    dst_data[5] = opts.scale_x; // Scale X
+                    dst_data[6] = opts.scale_y; // Scale Y
+
+                    flip = sk_FLIP_NONE;
+
+                    sk_set_bitmap_tint(ui_atlas, from_mu(cmd->icon.color));
+                    sk_draw_bitmap(ui_atlas, surface, src_data, 4, dst_data, 7, flip);
+                }
+
+                break;
+
+            case MU_COMMAND_CLIP:
+                sk_set_clip_rect(surface, cmd->clip.rect.x - dx, cmd->clip.rect.y - dy, cmd->clip.rect.w, cmd->clip.rect.h);
+
+                break;
+        }
+    }
+
+    // The commands of a root container run from just after its head jump up to
+    // its tail jump. Jumps in between skip over the windows nested inside it,
+    // which microui draws as separate root containers.
+    static mu_Command* _skip_panel_jumps(mu_Container *cnt, mu_Command *cmd)
+    {
+        while (cmd != cnt->tail && cmd->type == MU_COMMAND_JUMP)
+            cmd = (mu_Command*)cmd->jump.dst;
+
+        return cmd;
+    }
+
+    static mu_Command* _first_panel_command(mu_Container *cnt)
+    {
+        return _skip_panel_jumps(cnt, (mu_Command*)((char*)cnt->head + sizeof(mu_JumpCommand)));
+    }
+
+    static mu_Command* _next_panel_command(mu_Container *cnt, mu_Command *cmd)
+    {
+        return _skip_panel_jumps(cnt, (mu_Command*)((char*)cmd + cmd->base.size));
+    }
+
+    // Panel caching
+    // Each panel's commands are hashed as they are drawn. Once a panel has drawn
+    // the same commands two frames in a row it is drawn into a bitmap, and the
+    // bitmap is drawn in its place until its commands change again.
+    struct panel_cache
+    {
+        sk_drawing_surface bitmap;
+        bool valid;
+        uint64_t hash;
+        mu_Rect area;
+        void *surface;
+        unsigned int frame;
+    };
+
+    static std::map<mu_Container*, panel_cache> panel_caches;
+    static unsigned int panel_cache_frame = 0;
+
+    static void _hash_bytes(uint64_t &hash, const void *data, size_t size)
+    {
+        const unsigned char *bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    // Returns false if the panel draws something whose pixels may change without
+    // changing its commands, such as a bitmap registered as an icon
+    static bool _hash_panel_commands(mu_Container *cnt, const drawing_options &opts, uint64_t &hash)
+    {
+        hash = 14695981039346656037ULL;
+
+        _hash_bytes(hash, &opts.angle, sizeof(opts.angle));
+        _hash_bytes(hash, &opts.anchor_offset_x, sizeof(opts.anchor_offset_x));
+        _hash_bytes(hash, &opts.anchor_offset_y, sizeof(opts.anchor_offset_y));
+        _hash_bytes(hash, &opts.scale_x, sizeof(opts.scale_x));
+        _hash_bytes(hash, &opts.scale_y, sizeof(opts.scale_y));
+
+        for (mu_Command *cmd = _first_panel_command(cnt); cmd != cnt->tail; cmd = _next_panel_command(cnt, cmd))
+        {
+            if (cmd->type == MU_COMMAND_ICON && cmd->icon.id >= MU_ICON_MAX)
+                return false;
+
+            if (cmd->type == MU_COMMAND_TEXT)
+            {
+                // the font is a pointer into this frame's font set, so hash what it points to
+                const font_size_pair* font_info = _get_font_size_pair(cmd->text.font);
+                if (font_info)
+                    _hash_bytes(hash, font_info, sizeof(font_size_pair));
+
+                _hash_bytes(hash, &cmd->text.pos, sizeof(cmd->text.pos));
+                _hash_bytes(hash, &cmd->text.color, sizeof(cmd->text.color));
+                _hash_bytes(hash, cmd->text.str, strlen(cmd->text.str));
+            }
+            else
+                _hash_bytes(hash, cmd, cmd->base.size);
+        }
+
+        return true;
+    }
+
+    // The area a panel can draw to: its rectangle, with room for its border and shadows
+    static mu_Rect _panel_cache_area(mu_Container *cnt, sk_drawing_surface *surface)
+    {
+        int panel_margin = panel_shadow_style.radius + (int)std::max(std::abs(panel_shadow_style.offset.x), std::abs(panel_shadow_style.offset.y));
+        int element_margin = element_shadow_style.radius + (int)std::max(std::abs(element_shadow_style.offset.x), std::abs(element_shadow_style.offset.y));
+
+        mu_Rect area = expand_rect(cnt->rect, std::max(panel_margin, element_margin) + 2);
+
+        return intersect_rects(area, mu_rect(0, 0, surface->width, surface->height));
+    }
+
+    static void _draw_panel_commands(sk_drawing_surface *surface, mu_Container *cnt, int dx, int dy, const drawing_options &opts, sk_drawing_surface *ui_atlas)
+    {
+        for (mu_Command *cmd = _first_panel_command(cnt); cmd != cnt->tail; cmd = _next_panel_command(cnt, cmd))
+            _draw_command(surface, cmd, dx, dy, opts, ui_atlas);
+    }
+
+    static void _draw_panel(sk_drawing_surface *surface, mu_Container *cnt, const drawing_options &opts, sk_drawing_surface *ui_atlas)
+    {
+        uint64_t hash;
+        bool cacheable = _hash_panel_commands(cnt, opts, hash);
+        mu_Rect area = _panel_cache_area(cnt, surface);
+
+        panel_cache &cache = panel_caches[cnt];
+        bool unchanged = cache.frame == panel_cache_frame - 1 &&
+                         cache.hash == hash &&
+                         cache.surface == surface->_data &&
+                         memcmp(&cache.area, &area, sizeof(mu_Rect)) == 0;
+
+        cache.frame = panel_cache_frame;
+        cache.hash = hash;
+        cache.area = area;
+        cache.surface = surface->_data;
+
+        // changing panels are drawn directly, until they settle
+        if (!cacheable || !unchanged || area.w <= 0 || area.h <= 0)
+        {
+            cache.valid = false;
+            _draw_panel_commands(surface, cnt, 0, 0, opts, ui_atlas);
+            return;
+        }
+
+        if (!cache.valid)
+        {
+            if (cache.bitmap._data && (cache.bitmap.width != area.w || cache.bitmap.height != area.h))
+                sk_close_drawing_surface(&cache.bitmap);
+
+            if (!cache.bitmap._data)
+            {
+                cache.bitmap = sk_create_bitmap(area.w, area.h);
+                sk_set_bitmap_premultiplied(&cache.bitmap, true);
+            }
+
+            sk_clear_drawing_surface(&cache.bitmap, {0.f, 0.f, 0.f, 0.f});
+            _draw_panel_commands(&cache.bitmap, cnt, area.x, area.y, opts, ui_atlas);
+            sk_clear_clip_rect(&cache.bitmap);
+
+            cache.valid = true;
+        }
+
+        double src_data[4] = {0, 0, (double)area.w, (double)area.h};
+        double dst_data[7] = {(double)area.x, (double)area.y, 0, 0, 0, 1, 1};
+        sk_draw_bitmap(&cache.bitmap, surface, src_data, 4, dst_data, 7, sk_FLIP_NONE);
+    }
+
+    // Free the caches of panels that were not drawn this frame
+    static void _release_unused_panel_caches()
+    {
+        for (auto it = panel_caches.begin(); it != panel_caches.end();)
+        {
+            if (it->second.frame != panel_cache_frame)
+            {
+                if (it->second.bitmap._data)
+                    sk_close_drawing_surface(&it->second.bitmap);
+                it = panel_caches.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
+    void sk_interface_draw(const drawing_options &opts)
     {
         sk_interface_end();
 
@@ -317,80 +560,13 @@ namespace splashkit_lib
 
         if (surface)
         {
-            mu_Command *cmd = NULL;
-            while (mu_next_command(ctx, &cmd))
-            {
-                switch (cmd->type)
-                {
-                    case MU_COMMAND_TEXT:
-                        const font_size_pair* font_info;
-                        font_info = _get_font_size_pair(cmd->text.font);
-
-                        if (cmd->text.font)
-                            sk_draw_text(surface, font_info->first, font_info->second, cmd->text.pos.x, cmd->text.pos.y, cmd->text.str, from_mu(cmd->text.color));
-
-                        break;
-
-                    case MU_COMMAND_RECT:
-                        sk_fill_aa_rect(surface, from_mu(cmd->rect.color), cmd->rect.rect.x, cmd->rect.rect.y, cmd->rect.rect.w, cmd->rect.rect.h);
-
-                        break;
-
-                    case MU_COMMAND_BLUR_RECT:
-                        mu_BlurredRectCommand* brect;
-                        brect = (mu_BlurredRectCommand*)cmd;
-                        sk_draw_blurred_rect(surface, from_mu(brect->color), brect->rect.x, brect->rect.y, brect->rect.w, brect->rect.h, brect->radius);
-
-                        break;
-
-                    case MU_COMMAND_ICON:
-                        rectangle atlas_rect;
-                        double src_data[4];
-                        double dst_data[7];
-                        sk_renderer_flip flip;
-
-                        // if it's a custom icon, handle specially
-                        if (cmd->icon.id >= MU_ICON_MAX)
-                        {
-                            registered_icon* icon = _get_registered_icon(cmd->icon.id);
-                            if (icon)
-                            {
-                                icon->dst_data[0] = cmd->icon.rect.x + (cmd->icon.rect.w - icon->src_data[2]) / 2; // X
-                                icon->dst_data[1] = cmd->icon.rect.y + (cmd->icon.rect.h - icon->src_data[3]) / 2; // Y
-                                sk_draw_bitmap(icon->src, surface, icon->src_data, 4, icon->dst_data, 7, icon->flip);
-                            }
-                        }
-                        else // otherwise draw from atlas
-                        {
-                            atlas_rect = atlas[cmd->icon.id];
-
-                            src_data[0] = atlas_rect.x;
-                            src_data[1] = atlas_rect.y;
-                            src_data[2] = atlas_rect.width;
-                            src_data[3] = atlas_rect.height;
-
-                            dst_data[0] = cmd->icon.rect.x + (cmd->icon.rect.w - atlas_rect.width) / 2; // X
-                            dst_data[1] = cmd->icon.rect.y + (cmd->icon.rect.h - atlas_rect.height) / 2; // Y
-                            dst_data[2] = opts.angle; // Angle
-                            dst_data[3] = opts.anchor_offset_x; // Centre X
-                            dst_data[4] = opts.anchor_offset_y; // Centre Y
-                            dst_data[5] = opts.scale_x; // Scale X
-                            dst_data[6] = opts.scale_y; // Scale Y
-
-                            flip = sk_FLIP_NONE;
-
-                            sk_set_bitmap_tint(ui_atlas, from_mu(cmd->icon.color));
-                            sk_draw_bitmap(ui_atlas, surface, src_data, 4, dst_data, 7, flip);
-                        }
-
-                        break;
-
-                    case MU_COMMAND_CLIP:
-                        sk_set_clip_rect(surface, cmd->clip.rect.x, cmd->clip.rect.y, cmd->clip.rect.w, cmd->clip.rect.h);
-
-                        break;
-                }
-            }
+            panel_cache_frame++;
+
+            // mu_end has sorted the root containers into the order they are drawn
+            for (int i = 0; i < ctx->root_list.idx; i++)
+                _draw_panel(surface, ctx->root_list.items[i], opts, ui_atlas);
+
+            _release_unused_panel_caches();
         }
     }
 
@@ -410,9 +586,22 @@ namespace splashkit_lib
         ctx->style->size.y = current_font_size;
     }
 
+    // Virtual lists
+    // A list only creates the rows that can be seen. Space is reserved for the
+    // rows above and below these, so the list scrolls as if every row were there.
+    struct virtual_list_info
+    {
+        int row_count;
+        int end_row;
+        int row_step;
+    };
+
+    static std::vector<virtual_list_info> virtual_lists;
+
     void sk_interface_start()
     {
         fonts_this_frame.clear();
+        virtual_lists.clear();
         registered_icons_this_frame.clear();
         ctx->style->font = _add_font_size_pair(current_font, current_font_size);
 
@@ -497,6 +686,46 @@ namespace splashkit_lib
         mu_end_panel(ctx);
     }
 
+    // Reserve the space of `rows` rows with one empty layout row
+    static void _reserve_list_rows(int rows, int row_step)
+    {
+        if (rows <= 0) return;
+
+        int widths[] = {-1};
+        mu_layout_row(ctx, 1, widths, rows * row_step - ctx->style->spacing);
+        mu_layout_next(ctx);
+    }
+
+    void sk_interface_start_list(const string& name, int row_count, int row_height, int& first_row, int& visible_rows)
+    {
+        mu_begin_panel(ctx, name.c_str());
+
+        // the scroll is from the last frame, as microui uses for the panel's own layout
+        mu_Container *cnt = mu_get_current_container(ctx);
+        int row_step = row_height + ctx->style->spacing;
+
+        first_row = (cnt->scroll.y - ctx->style->padding) / row_step;
+        first_row = MAX(0, MIN(first_row, row_count));
+
+        visible_rows = MIN(cnt->body.h / row_step + 2, row_count - first_row);
+
+        _reserve_list_rows(first_row, row_step);
+
+        virtual_lists.push_back({row_count, first_row + visible_rows, row_step});
+    }
+
+    void sk_interface_end_list()
+    {
+        if (virtual_lists.size() > 0)
+        {
+            virtual_list_info& list = virtual_lists.back();
+            _reserve_list_rows(list.row_count - list.end_row, list.row_step);
+            virtual_lists.pop_back();
+        }
+
+        mu_end_panel(ctx);
+    }
+
     bool sk_interface_start_treenode(const string& name)
     {
         return mu_begin_treenode(ctx, name.c_str());
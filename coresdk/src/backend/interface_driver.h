@@ -12,7 +12,7 @@ namespace splashkit_lib
     void sk_interface_init();
     void sk_interface_set_init_style_callback(void(*callback)());
 
-    void sk_interface_draw(drawing_options opts);
+    void sk_interface_draw(const drawing_options &opts);
 
     int sk_interface_register_icon(sk_drawing_surface* src, const double (&src_data)[4], const double (&dst_data)[7], sk_renderer_flip flip);
 
@@ -33,6 +33,9 @@ namespace splashkit_lib
     void sk_interface_start_inset(const string& name);
     void sk_interface_end_inset();
 
+    void sk_interface_start_list(const string& name, int row_count, int row_height, int& first_row, int& visible_rows);
+    void sk_interface_end_list();
+
     bool sk_interface_start_treenode(const string& name);
     void sk_interface_end_treenode();
 
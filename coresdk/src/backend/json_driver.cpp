@@ -35,4 +35,35 @@ namespace splashkit_lib
             default: return "unknown";
         }
     }
-}
\ No newline at end of file
+
+    // Passes nlohmann's sax events on to a json_event_handler
+    struct _json_event_reader
+    {
+        json_event_handler *handler;
+
+        bool null() { return handler(JSON_NULL_VALUE, "", 0); }
+        bool boolean(bool val) { return handler(JSON_BOOL_VALUE, "", val ? 1 : 0); }
+        bool number_integer(backend_json::number_integer_t val) { return handler(JSON_NUMBER_VALUE, "", static_cast<double>(val)); }
+        bool number_unsigned(backend_json::number_unsigned_t val) { return handler(JSON_NUMBER_VALUE, "", static_cast<double>(val)); }
+        bool number_float(backend_json::number_float_t val, const backend_json::string_t &) { return handler(JSON_NUMBER_VALUE, "", val); }
+        bool string(backend_json::string_t &val) { return handler(JSON_STRING_VALUE, val, 0); }
+        bool binary(backend_json::binary_t &) { return true; }
+        bool start_object(size_t) { return handler(JSON_START_OBJECT, "", 0); }
+        bool key(backend_json::string_t &val) { return handler(JSON_KEY, val, 0); }
+        bool end_object() { return handler(JSON_END_OBJECT, "", 0); }
+        bool start_array(size_t) { return handler(JSON_START_ARRAY, "", 0); }
+        bool end_array() { return handler(JSON_END_ARRAY, "", 0); }
+
+        bool parse_error(size_t position, const std::string &, const nlohmann::detail::exception &ex)
+        {
+            LOG(WARNING) << "Invalid json at " << position << ": " << ex.what();
+            return false;
+        }
+    };
+
+    bool sk_json_parse_events(std::istream &in, json_event_handler *handler)
+    {
+        _json_event_reader reader = { handler };
+        return backend_json::sax_parse(in, &reader);
+    }
+}
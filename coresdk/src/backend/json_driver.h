@@ -17,6 +17,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <istream>
 
 using backend_json = nlohmann::json;
 using std::string;
@@ -29,14 +30,24 @@ namespace splashkit_lib
     {
         pointer_identifier id;
         backend_json data;
+        size_t index;       // Position in the list of json objects, see json.cpp
+    };
+
+    struct sk_json_key
+    {
+        pointer_identifier id;
+        string name;
     };
 
     void sk_delete_json(json j);
 
     string json_type_to_string(backend_json::value_t type);
 
+    // Parses the stream as it is read, passing each part of the json to handler
+    bool sk_json_parse_events(std::istream &in, json_event_handler *handler);
+
     template <typename T>
-    void sk_json_add_value(json j, string key, T value)
+    void sk_json_add_value(json j, const string &key, const T &value)
     {
         if (INVALID_PTR(j, JSON_PTR))
         {
@@ -54,8 +65,20 @@ namespace splashkit_lib
                 type == backend_json::value_t::number_unsigned);
     }
 
+    inline bool sk_json_check_type(const backend_json &value, backend_json::value_t type)
+    {
+        if ((value.type() != type) &&
+            !(is_type_number(value.type()) && is_type_number(type)))
+        {
+            LOG(ERROR) << "JSON key value is not expected in sk_json_read_value. Has type " << json_type_to_string(value.type());
+            return false;
+        }
+
+        return true;
+    }
+
     template<typename T>
-    T sk_json_read_value(json j, string key, backend_json::value_t type)
+    T sk_json_read_value(json j, const string &key, backend_json::value_t type)
     {
         if (INVALID_PTR(j, JSON_PTR))
         {
@@ -63,20 +86,59 @@ namespace splashkit_lib
             return T();
         }
 
-        backend_json temp = j->data[key];
+        // find the value in place, rather than copying it out to check its type
+        auto it = j->data.find(key);
+        if (it == j->data.end())
+        {
+            LOG(ERROR) << "JSON key " << key << " not found in sk_json_read_value";
+            return T();
+        }
+
+        if (!sk_json_check_type(*it, type)) return T();
 
-        if ((temp.type() != type) &&
-            !(is_type_number(temp.type()) && is_type_number(type)))
+        return it->template get<T>();
+    }
+
+    // The value at a json pointer path such as "/a/b/3/c", or nullptr if there is none
+    inline const backend_json *sk_json_find_path(json j, const string &path)
+    {
+        if (INVALID_PTR(j, JSON_PTR))
+        {
+            LOG(ERROR) << "Invalid json pointer passed to json_read_path_x";
+            return nullptr;
+        }
+
+        try
+        {
+            backend_json::json_pointer ptr(path);
+            const backend_json &data = j->data;
+            if (!data.contains(ptr)) return nullptr;
+            return &data.at(ptr);
+        }
+        catch (...)
         {
-            LOG(ERROR) << "JSON key value is not expected in sk_json_read_value. Has type " << json_type_to_string(j->data[key].type());
+            LOG(WARNING) << "Invalid json path " << path;
+            return nullptr;
+        }
+    }
+
+    template<typename T>
+    T sk_json_read_path(json j, const string &path, backend_json::value_t type)
+    {
+        const backend_json *value = sk_json_find_path(j, path);
+        if (!value)
+        {
+            LOG(ERROR) << "JSON path " << path << " not found in sk_json_read_path";
             return T();
         }
 
-        return j->data[key];
+        if (!sk_json_check_type(*value, type)) return T();
+
+        return value->template get<T>();
     }
 
     template <typename T>
-    void sk_json_read_array(json j, string key, vector<T>& out)
+    void sk_json_read_array(json j, const string &key, vector<T>& out)
     {
         if (INVALID_PTR(j, JSON_PTR))
         {
@@ -84,18 +146,20 @@ namespace splashkit_lib
             return;
         }
 
-        if (!j->data[key].is_array())
+        auto it = j->data.find(key);
+        if (it == j->data.end() || !it->is_array())
         {
-            LOG(ERROR) << "JSON key value is not an array. Has type " << json_type_to_string(j->data[key].type());
+            LOG(ERROR) << "JSON key value is not an array. Has type " << json_type_to_string(it == j->data.end() ? backend_json::value_t::null : it->type());
             return;
         }
         
         out.clear();
         
-        backend_json json_array = j->data[key];
+        const backend_json &json_array = *it;
+        out.reserve(json_array.size());
         
-        for (T e : json_array) {
-            out.push_back(e);
+        for (const backend_json &e : json_array) {
+            out.push_back(e.template get<T>());
         }
     }
 
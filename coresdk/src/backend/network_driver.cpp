@@ -20,13 +20,153 @@
 #include <SDL_net.h>
 #endif
 
+// SDL_net does not expose the OS socket, so the event backends below read it
+// from the start of SDL_net's private socket structs. That layout is the same
+// from 2.0.0 through 2.2.x. Other versions only use the public SDL_net calls.
+#define SK_SDLNET_VERSION (SDL_NET_MAJOR_VERSION * 10000 + SDL_NET_MINOR_VERSION * 100 + SDL_NET_PATCHLEVEL)
+#if SK_SDLNET_VERSION >= 20000 && SK_SDLNET_VERSION < 20300
+#define SK_SDLNET_SOCKET_LAYOUT
+#endif
+
+#if ! defined(SK_SDLNET_SOCKET_LAYOUT)
+// no OS socket, so no event backend
+#elif defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#define SK_EPOLL
+#define SK_MMSG
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#define SK_KQUEUE
+#elif defined(_WIN32) && defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0600
+#include <winsock2.h>
+#include <vector>
+#include <mutex>
+#define SK_WSAPOLL
+#endif
+
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <vector>
+
+#if defined(SK_EPOLL) || defined(SK_KQUEUE)
+#define SK_GATHER_SEND
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
 namespace splashkit_lib
 {
     // This set keeps track of all of the sockets to see if there is activity
     SDLNet_SocketSet _sockets; // allocate on setup of functions.
 
+    //
+    // Event driven polling of watched sockets, so that checking for activity
+    // only visits the sockets that are ready. This mirrors the start of
+    // SDL_net's private TCP and UDP socket structs (both begin with the
+    // ready flag and then the socket), see SK_SDLNET_SOCKET_LAYOUT.
+    //
+#ifdef SK_WSAPOLL
+    typedef SOCKET _sk_os_socket;
+#else
+    typedef int _sk_os_socket;
+#endif
+
+#ifdef SK_SDLNET_SOCKET_LAYOUT
+    struct _sk_sdlnet_socket
+    {
+        int ready;
+        _sk_os_socket channel;
+    };
+#endif
+
+#if defined(SK_EPOLL) || defined(SK_KQUEUE)
+    static int _sk_poll_fd = -1;
+    static std::vector<int> _sk_shard_fds;  // poll sets for shards 1 and up
+#elif defined(SK_WSAPOLL)
+    static std::vector<WSAPOLLFD> _sk_poll_fds;
+    static std::vector<void *> _sk_poll_owners;
+    // The network thread polls while the game thread may add connections
+    static std::mutex _sk_poll_lock;
+#endif
+
+#ifdef SK_SDLNET_SOCKET_LAYOUT
+    _sk_os_socket _sk_os_socket_for(sk_network_connection *con)
+    {
+        return static_cast<_sk_sdlnet_socket *>(con->_socket)->channel;
+    }
+#endif
+
+#ifdef SK_WSAPOLL
+    void _sk_remove_poll_fd(_sk_os_socket sock)
+    {
+        for (size_t i = 0; i < _sk_poll_fds.size(); i++)
+        {
+            if ( _sk_poll_fds[i].fd == sock )
+            {
+                _sk_poll_fds[i] = _sk_poll_fds.back();
+                _sk_poll_fds.pop_back();
+                _sk_poll_owners[i] = _sk_poll_owners.back();
+                _sk_poll_owners.pop_back();
+                break;
+            }
+        }
+    }
+#endif
+
+    // The poll set for a shard, shard 0 being the main one
+    static int _sk_poll_fd_for(int shard)
+    {
+#if defined(SK_EPOLL) || defined(SK_KQUEUE)
+        if ( shard <= 0 || shard > static_cast<int>(_sk_shard_fds.size()) ) return _sk_poll_fd;
+        return _sk_shard_fds[shard - 1];
+#else
+        (void)shard;
+        return -1;
+#endif
+    }
+
+    void sk_unwatch_connection(sk_network_connection *con)
+    {
+#if defined(SK_EPOLL) || defined(SK_KQUEUE)
+        if ( ! con->_socket ) return;
+
+        // the socket may be watched by any shard
+        for (int shard = 0; shard <= static_cast<int>(_sk_shard_fds.size()); shard++)
+        {
+            int poll_fd = _sk_poll_fd_for(shard);
+            if ( poll_fd < 0 ) continue;
+
+#if defined(SK_EPOLL)
+            epoll_event ev = {};
+            epoll_ctl(poll_fd, EPOLL_CTL_DEL, _sk_os_socket_for(con), &ev);
+#else
+            struct kevent kev;
+            EV_SET(&kev, _sk_os_socket_for(con), EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+            kevent(poll_fd, &kev, 1, nullptr, 0, nullptr);
+#endif
+        }
+#elif defined(SK_WSAPOLL)
+        if ( ! con->_socket ) return;
+
+        std::lock_guard<std::mutex> lock(_sk_poll_lock);
+        _sk_remove_poll_fd(_sk_os_socket_for(con));
+#endif
+    }
+
     void sk_network_init()
     {
         SDLNet_Init();
@@ -36,6 +176,165 @@ namespace splashkit_lib
             printf("Error allocating network resources\n");
             exit(1);
         }
+
+#if defined(SK_EPOLL)
+        _sk_poll_fd = epoll_create1(0);
+#elif defined(SK_KQUEUE)
+        _sk_poll_fd = kqueue();
+#endif
+    }
+
+    bool sk_network_events_supported()
+    {
+        internal_sk_init();
+#if defined(SK_EPOLL) || defined(SK_KQUEUE)
+        return _sk_poll_fd >= 0;
+#elif defined(SK_WSAPOLL)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    int sk_set_network_shards(int count)
+    {
+        internal_sk_init();
+
+#if defined(SK_EPOLL) || defined(SK_KQUEUE)
+        while ( static_cast<int>(_sk_shard_fds.size()) + 1 < count )
+        {
+#if defined(SK_EPOLL)
+            int poll_fd = epoll_create1(0);
+#else
+            int poll_fd = kqueue();
+#endif
+            if ( poll_fd < 0 ) break;
+            _sk_shard_fds.push_back(poll_fd);
+        }
+        return static_cast<int>(_sk_shard_fds.size()) + 1;
+#else
+        (void)count;
+        return 1;
+#endif
+    }
+
+    int sk_network_shard_count()
+    {
+#if defined(SK_EPOLL) || defined(SK_KQUEUE)
+        return static_cast<int>(_sk_shard_fds.size()) + 1;
+#else
+        return 1;
+#endif
+    }
+
+    void sk_watch_connection(sk_network_connection *con, void *owner)
+    {
+        sk_watch_connection_on(con, owner, 0);
+    }
+
+    void sk_watch_connection_on(sk_network_connection *con, void *owner, int shard)
+    {
+        if ( ! con || ! con->_socket ) return;
+
+#if defined(SK_EPOLL) || defined(SK_KQUEUE)
+        // a socket watched by two shards would be read by two threads
+        if ( ! _sk_shard_fds.empty() ) sk_unwatch_connection(con);
+#endif
+
+#if defined(SK_EPOLL)
+        int poll_fd = _sk_poll_fd_for(shard);
+        if ( poll_fd < 0 ) return;
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.ptr = owner;
+
+        if ( epoll_ctl(poll_fd, EPOLL_CTL_ADD, _sk_os_socket_for(con), &ev) < 0 )
+            epoll_ctl(poll_fd, EPOLL_CTL_MOD, _sk_os_socket_for(con), &ev);
+#elif defined(SK_KQUEUE)
+        int poll_fd = _sk_poll_fd_for(shard);
+        if ( poll_fd < 0 ) return;
+
+        struct kevent kev;
+        EV_SET(&kev, _sk_os_socket_for(con), EVFILT_READ, EV_ADD, 0, 0, owner);
+        kevent(poll_fd, &kev, 1, nullptr, 0, nullptr);
+#elif defined(SK_WSAPOLL)
+        (void)shard;
+        std::lock_guard<std::mutex> lock(_sk_poll_lock);
+        _sk_remove_poll_fd(_sk_os_socket_for(con));
+
+        WSAPOLLFD pfd = {};
+        pfd.fd = _sk_os_socket_for(con);
+        pfd.events = POLLRDNORM;
+        _sk_poll_fds.push_back(pfd);
+        _sk_poll_owners.push_back(owner);
+#else
+        (void)owner;
+        (void)shard;
+#endif
+    }
+
+    int sk_network_ready(void **ready, int max, int timeout_ms)
+    {
+        return sk_network_ready_on(0, ready, max, timeout_ms);
+    }
+
+    int sk_network_ready_on(int shard, void **ready, int max, int timeout_ms)
+    {
+        internal_sk_init();
+        int count = 0;
+
+#if defined(SK_EPOLL)
+        int poll_fd = _sk_poll_fd_for(shard);
+        if ( poll_fd < 0 || max <= 0 ) return 0;
+
+        epoll_event events[64];
+        int got = epoll_wait(poll_fd, events, max < 64 ? max : 64, timeout_ms);
+
+        for (int i = 0; i < got; i++)
+        {
+            ready[count++] = events[i].data.ptr;
+        }
+#elif defined(SK_KQUEUE)
+        int poll_fd = _sk_poll_fd_for(shard);
+        if ( poll_fd < 0 || max <= 0 ) return 0;
+
+        struct kevent events[64];
+        struct timespec timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+        int got = kevent(poll_fd, nullptr, 0, events, max < 64 ? max : 64, &timeout);
+
+        for (int i = 0; i < got; i++)
+        {
+            ready[count++] = events[i].udata;
+        }
+#elif defined(SK_WSAPOLL)
+        (void)shard;
+        // Poll a copy so that waiting does not block connections being watched
+        std::vector<WSAPOLLFD> fds;
+        std::vector<void *> owners;
+        {
+            std::lock_guard<std::mutex> lock(_sk_poll_lock);
+            fds = _sk_poll_fds;
+            owners = _sk_poll_owners;
+        }
+
+        if ( fds.empty() ) return 0;
+
+        if ( WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeout_ms) > 0 )
+        {
+            for (size_t i = 0; i < fds.size() && count < max; i++)
+            {
+                if ( fds[i].revents )
+                    ready[count++] = owners[i];
+            }
+        }
+#else
+        (void)ready;
+        (void)max;
+        (void)timeout_ms;
+#endif
+
+        return count;
     }
 
     sk_network_connection sk_open_udp_connection(unsigned short port)
@@ -115,13 +414,95 @@ namespace splashkit_lib
         return sent;
     }
 
+    long sk_send_buffers(sk_network_connection *con, const char **buffers, const unsigned long *sizes, int count)
+    {
+        // not entry point
+        if ( ! con->_socket ) return -1;
+        if ( count <= 0 ) return 0;
+
+#ifdef SK_GATHER_SEND
+        iovec parts[64];
+        if ( count > 64 ) count = 64;
+
+        for (int i = 0; i < count; i++)
+        {
+            parts[i].iov_base = const_cast<char *>(buffers[i]);
+            parts[i].iov_len = sizes[i];
+        }
+
+        msghdr msg = {};
+        msg.msg_iov = parts;
+        msg.msg_iovlen = count;
+
+        ssize_t sent = sendmsg(_sk_os_socket_for(con), &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if ( sent >= 0 ) return static_cast<long>(sent);
+        if ( errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ) return 0;
+        return -1;
+#else
+        // SDL_net sockets block, so each buffer is sent in full
+        long sent = 0;
+        for (int i = 0; i < count; i++)
+        {
+            int size = static_cast<int>(sizes[i]);
+            if ( SDLNet_TCP_Send((TCPsocket)con->_socket, buffers[i], size) < size ) return -1;
+            sent += size;
+        }
+        return sent;
+#endif
+    }
+
+    bool sk_set_tcp_no_delay(sk_network_connection *con, bool no_delay)
+    {
+        if ( ! con->_socket || con->kind != TCP ) return false;
+
+#if defined(SK_GATHER_SEND)
+        int flag = no_delay ? 1 : 0;
+        return setsockopt(_sk_os_socket_for(con), IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) == 0;
+#elif defined(SK_WSAPOLL)
+        BOOL flag = no_delay ? TRUE : FALSE;
+        return setsockopt(_sk_os_socket_for(con), IPPROTO_TCP, TCP_NODELAY, (const char *)&flag, sizeof(flag)) == 0;
+#else
+        return false;
+#endif
+    }
+
     int sk_send_udp_message(sk_network_connection *con, const char *host, unsigned short port, const char *buffer, unsigned long size)
     {
         // Not entry point.
-        UDPpacket packet;
-        SDLNet_ResolveHost(&packet.address, host, port);
+        unsigned int address;
+        unsigned short address_port;
+
+        if ( ! sk_resolve_address(host, port, &address, &address_port) ) return 0;
+
+        return sk_send_udp_to(con, address, address_port, buffer, size);
+    }
+
+    bool sk_resolve_address(const char *host, unsigned short port, unsigned int *address, unsigned short *address_port)
+    {
+        internal_sk_init();
 
+        IPaddress addr;
+        if ( SDLNet_ResolveHost(&addr, host, port) < 0 )
+        {
+            *address = 0;
+            *address_port = 0;
+            return false;
+        }
+
+        *address = addr.host;
+        *address_port = addr.port;
+        return true;
+    }
+
+    int sk_send_udp_to(sk_network_connection *con, unsigned int address, unsigned short address_port, const char *buffer, unsigned long size)
+    {
+        // Not entry point.
+        UDPpacket packet;
+        packet.channel = -1;
+        packet.address.host = address;
+        packet.address.port = address_port;
         packet.len = static_cast<int>(size);
+        packet.maxlen = packet.len;
         packet.data = (Uint8*)buffer;
         return SDLNet_UDP_Send((UDPsocket)con->_socket, -1, &packet);
     }
@@ -152,15 +533,200 @@ namespace splashkit_lib
         SDLNet_FreePacket(packet);
     }
 
+    //
+    // Batched UDP reads land in a ring of packets that is kept between
+    // reads, so nothing is allocated once the ring has grown to the batch
+    // size. Each thread that reads has its own ring.
+    //
+    struct _sk_udp_packet_ring
+    {
+        int count = 0;
+        unsigned long packet_size = 0;
+        std::vector<char> data;
+#ifdef SK_MMSG
+        std::vector<mmsghdr> headers;
+        std::vector<iovec> buffers;
+        std::vector<sockaddr_in> addresses;
+#else
+        std::vector<UDPpacket> packets;
+#endif
+    };
+
+    static thread_local _sk_udp_packet_ring _sk_udp_ring;
+
+    static void _sk_prepare_udp_ring(_sk_udp_packet_ring &ring, int count, unsigned long packet_size)
+    {
+        if ( ring.count >= count && ring.packet_size == packet_size ) return;
+
+        ring.count = count;
+        ring.packet_size = packet_size;
+        ring.data.resize(static_cast<size_t>(count) * packet_size);
+
+#ifdef SK_MMSG
+        ring.headers.assign(count, mmsghdr());
+        ring.buffers.resize(count);
+        ring.addresses.resize(count);
+
+        for (int i = 0; i < count; i++)
+        {
+            ring.buffers[i].iov_base = &ring.data[static_cast<size_t>(i) * packet_size];
+            ring.buffers[i].iov_len = packet_size;
+            ring.headers[i].msg_hdr.msg_iov = &ring.buffers[i];
+            ring.headers[i].msg_hdr.msg_iovlen = 1;
+        }
+#else
+        ring.packets.resize(count);
+
+        for (int i = 0; i < count; i++)
+        {
+            ring.packets[i].channel = -1;
+            ring.packets[i].data = (Uint8*)&ring.data[static_cast<size_t>(i) * packet_size];
+            ring.packets[i].maxlen = static_cast<int>(packet_size);
+        }
+#endif
+    }
+
+    int sk_read_udp_messages(sk_network_connection *con, sk_udp_datagram *out, int max_count, unsigned long packet_size)
+    {
+        // Not entry point.
+        if ( ! con->_socket || max_count <= 0 || packet_size == 0 ) return 0;
+
+        _sk_udp_packet_ring &ring = _sk_udp_ring;
+        _sk_prepare_udp_ring(ring, max_count, packet_size);
+
+#ifdef SK_MMSG
+        for (int i = 0; i < max_count; i++)
+        {
+            ring.headers[i].msg_hdr.msg_name = &ring.addresses[i];
+            ring.headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+
+        int received = recvmmsg(_sk_os_socket_for(con), ring.headers.data(), max_count, MSG_DONTWAIT, nullptr);
+        if ( received <= 0 ) return 0;
+
+        for (int i = 0; i < received; i++)
+        {
+            out[i].host = ntohl(ring.addresses[i].sin_addr.s_addr);
+            out[i].port = ntohs(ring.addresses[i].sin_port);
+            out[i].data = static_cast<const char *>(ring.buffers[i].iov_base);
+            out[i].size = ring.headers[i].msg_len;
+        }
+        return received;
+#else
+        // SDLNet_UDP_Recv does not block, so this stops at the first empty read
+        int received = 0;
+        while ( received < max_count )
+        {
+            UDPpacket &packet = ring.packets[received];
+            if ( SDLNet_UDP_Recv((UDPsocket)con->_socket, &packet) <= 0 ) break;
+
+            out[received].host = SDLNet_Read32(&packet.address.host);
+            out[received].port = SDLNet_Read16(&packet.address.port);
+            out[received].data = (const char *)packet.data;
+            out[received].size = packet.len > 0 ? static_cast<unsigned long>(packet.len) : 0;
+            received++;
+        }
+        return received;
+#endif
+    }
+
+    int sk_send_udp_messages(sk_network_connection *con, const unsigned int *addresses, const unsigned short *address_ports, int count, const char *buffer, unsigned long size)
+    {
+        // Not entry point.
+        if ( ! con->_socket || count <= 0 ) return 0;
+
+#ifdef SK_MMSG
+        // every destination shares the one buffer
+        iovec payload;
+        payload.iov_base = const_cast<char *>(buffer);
+        payload.iov_len = size;
+
+        static thread_local std::vector<mmsghdr> headers;
+        static thread_local std::vector<sockaddr_in> destinations;
+        headers.assign(count, mmsghdr());
+        destinations.assign(count, sockaddr_in());
+
+        for (int i = 0; i < count; i++)
+        {
+            destinations[i].sin_family = AF_INET;
+            destinations[i].sin_addr.s_addr = addresses[i];
+            destinations[i].sin_port = address_ports[i];
+
+            headers[i].msg_hdr.msg_name = &destinations[i];
+            headers[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            headers[i].msg_hdr.msg_iov = &payload;
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // sendmmsg can stop part way through, so keep going from where it stopped
+        int sent = 0;
+        while ( sent < count )
+        {
+            int done = sendmmsg(_sk_os_socket_for(con), headers.data() + sent, count - sent, 0);
+            if ( done <= 0 ) break;
+            sent += done;
+        }
+        return sent;
+#else
+        UDPpacket packet;
+        packet.channel = -1;
+        packet.len = static_cast<int>(size);
+        packet.maxlen = packet.len;
+        packet.data = (Uint8*)buffer;
+
+        int sent = 0;
+        for (int i = 0; i < count; i++)
+        {
+            packet.address.host = addresses[i];
+            packet.address.port = address_ports[i];
+            if ( SDLNet_UDP_Send((UDPsocket)con->_socket, -1, &packet) > 0 ) sent++;
+        }
+        return sent;
+#endif
+    }
+
     int sk_read_bytes(sk_network_connection *con, char *buffer, int size)
     {
         // not entry point
         return SDLNet_TCP_Recv((TCPsocket)con->_socket, buffer, size);
     }
 
+    int sk_read_available_bytes(sk_network_connection *con, char *buffer, int size)
+    {
+        // not entry point
+#ifdef SK_GATHER_SEND
+        if ( ! con->_socket ) return -1;
+
+        ssize_t got = recv(_sk_os_socket_for(con), buffer, size, MSG_DONTWAIT);
+        if ( got > 0 ) return static_cast<int>(got);
+        if ( got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ) return 0;
+        return -1;
+#else
+        return 0;
+#endif
+    }
+
+    int sk_receive_buffer_size(sk_network_connection *con)
+    {
+        if ( ! con->_socket ) return 0;
+
+#if defined(SK_GATHER_SEND)
+        int size = 0;
+        socklen_t len = sizeof(size);
+        if ( getsockopt(_sk_os_socket_for(con), SOL_SOCKET, SO_RCVBUF, &size, &len) == 0 ) return size;
+#elif defined(SK_WSAPOLL)
+        int size = 0;
+        int len = sizeof(size);
+        if ( getsockopt(_sk_os_socket_for(con), SOL_SOCKET, SO_RCVBUF, (char *)&size, &len) == 0 ) return size;
+#endif
+        return 0;
+    }
+
     void sk_close_connection(sk_network_connection *con)
     {
         // not entry point
+        sk_unwatch_connection(con);
+
         if ( con->kind == TCP )
         {
             SDLNet_TCP_DelSocket(_sockets, (TCPsocket)con->_socket);
@@ -204,8 +770,10 @@ namespace splashkit_lib
         TCPsocket client;
         if ((client = SDLNet_TCP_Accept((TCPsocket)con._socket)) != NULL)
         {
-            //        printf("Adding client %p\n", client);
-            SDLNet_TCP_AddSocket(_sockets, client);
+            // The socket set has a fixed size, and is only needed when there
+            // is no event driven polling to watch the connection instead
+            if ( ! sk_network_events_supported() )
+                SDLNet_TCP_AddSocket(_sockets, client);
             result._socket = client;
             result.kind = TCP;
         }
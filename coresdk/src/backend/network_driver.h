@@ -20,11 +20,34 @@ namespace splashkit_lib
 
     int sk_send_bytes(sk_network_connection *con, char *buffer, unsigned long size);
 
+    // Send as much of the buffers as the socket takes without blocking, in one
+    // gather write. Returns the bytes sent, or -1 if the connection failed.
+    long sk_send_buffers(sk_network_connection *con, const char **buffers, const unsigned long *sizes, int count);
+    bool sk_set_tcp_no_delay(sk_network_connection *con, bool no_delay);
+
     int sk_send_udp_message(sk_network_connection *con, const char *host, unsigned short port, const char *buffer, unsigned long size);
+
+    // Resolve a host once, giving the address and port in network byte order
+    // for sk_send_udp_to
+    bool sk_resolve_address(const char *host, unsigned short port, unsigned int *address, unsigned short *address_port);
+    int sk_send_udp_to(sk_network_connection *con, unsigned int address, unsigned short address_port, const char *buffer, unsigned long size);
     void sk_read_udp_message(sk_network_connection *con, unsigned int *host, unsigned short *port, char *buffer, unsigned long *size);
 
+    // Read up to max_count waiting datagrams without blocking, returning how
+    // many were read. Sends the one buffer to each of the addresses (network
+    // byte order), returning how many were sent.
+    int sk_read_udp_messages(sk_network_connection *con, sk_udp_datagram *out, int max_count, unsigned long packet_size);
+    int sk_send_udp_messages(sk_network_connection *con, const unsigned int *addresses, const unsigned short *address_ports, int count, const char *buffer, unsigned long size);
+
     int sk_read_bytes(sk_network_connection *con, char *buffer, int size);
 
+    // Read what has already arrived without blocking. Returns 0 when there is
+    // nothing waiting, or when reads cannot be made without blocking.
+    int sk_read_available_bytes(sk_network_connection *con, char *buffer, int size);
+
+    // The size of the operating system's receive buffer, or 0 if unknown
+    int sk_receive_buffer_size(sk_network_connection *con);
+
     void sk_close_connection(sk_network_connection *con);
 
     unsigned int sk_network_address(sk_network_connection *con);
@@ -35,5 +58,22 @@ namespace splashkit_lib
 
     unsigned int sk_network_has_data();
     unsigned int sk_connection_has_data(sk_network_connection *con);
+
+    // Event driven activity checks, reporting only the sockets with data.
+    // A timeout (in milliseconds) lets a network thread wait for activity.
+    bool sk_network_events_supported();
+    void sk_watch_connection(sk_network_connection *con, void *owner);
+    // Stop reporting activity on a socket, in whichever shard it is watched
+    void sk_unwatch_connection(sk_network_connection *con);
+    int sk_network_ready(void **ready, int max, int timeout_ms = 0);
+
+    // Connections can be split across several poll sets (shards), so that
+    // each network thread waits on its own share. Shard 0 is the one used by
+    // sk_watch_connection and sk_network_ready. Only epoll and kqueue
+    // support more than one shard.
+    int sk_set_network_shards(int count);
+    int sk_network_shard_count();
+    void sk_watch_connection_on(sk_network_connection *con, void *owner, int shard);
+    int sk_network_ready_on(int shard, void **ready, int max, int timeout_ms);
 }
 #endif /* defined(__sgsdl2__SGSDL2Network__) */
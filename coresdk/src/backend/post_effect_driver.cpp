@@ -0,0 +1,314 @@
+//
+//  post_effect_driver.cpp
+//  splashkit
+//
+//  SDL_Renderer has no custom shaders, so each effect is built from work
+//  the renderer already does on the graphics card: blend modes, colour and
+//  alpha modulation, and linear filtering as textures are scaled. Bloom
+//  blurs by scaling the frame down to a quarter and an eighth of its size
+//  and adding the result back. Renderers without subtractive blending, such
+//  as the software renderer, make the whole frame glow rather than only
+//  its bright areas.
+//
+
+#include "post_effect_driver.h"
+#include "graphics_driver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <vector>
+
+using std::map;
+using std::unique_ptr;
+using std::vector;
+
+// The width and height of the texture stretched over the window for a vignette
+#define SK_VIGNETTE_SIZE 64
+// Bloom only spreads the part of each color channel above this level
+#define SK_BLOOM_THRESHOLD 128
+
+namespace splashkit_lib
+{
+    struct _sk_post_effect
+    {
+        sk_post_effect_kind kind;
+        SDL_Color clr;
+        double strength;
+    };
+
+    struct _sk_window_effects
+    {
+        vector<_sk_post_effect> effects;
+
+        // owned by the window's renderer, and remade when the window resizes
+        int width = 0, height = 0;
+        SDL_Texture *output = nullptr;
+        SDL_Texture *quarter = nullptr;
+        SDL_Texture *eighth = nullptr;
+        SDL_Texture *vignette = nullptr;
+
+        vector<SDL_Rect> scanlines;
+    };
+
+    static map<void *, unique_ptr<_sk_window_effects>> _sk_effects;
+
+    static _sk_window_effects *_sk_effects_for(sk_drawing_surface *window)
+    {
+        if ( ! window || window->kind != SGDS_Window ) return nullptr;
+
+        auto it = _sk_effects.find(window->_data);
+        return it == _sk_effects.end() ? nullptr : it->second.get();
+    }
+
+    static void _sk_free_effect_textures(_sk_window_effects &fx)
+    {
+        SDL_Texture **textures[] = { &fx.output, &fx.quarter, &fx.eighth, &fx.vignette };
+        for (SDL_Texture **tex : textures)
+        {
+            if ( *tex ) SDL_DestroyTexture(*tex);
+            *tex = nullptr;
+        }
+        fx.width = fx.height = 0;
+    }
+
+    static SDL_Texture *_sk_effect_target(SDL_Renderer *renderer, Uint32 format, int w, int h)
+    {
+        SDL_Texture *result = _sk_create_texture(renderer, format, SDL_TEXTUREACCESS_TARGET, std::max(1, w), std::max(1, h));
+        if ( result ) SDL_SetTextureScaleMode(result, SDL_ScaleModeLinear);
+        return result;
+    }
+
+    // A white texture, transparent in the middle and opaque at the corners
+    static SDL_Texture *_sk_create_vignette(SDL_Renderer *renderer)
+    {
+        SDL_Texture *result = _sk_create_texture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, SK_VIGNETTE_SIZE, SK_VIGNETTE_SIZE);
+        if ( ! result ) return nullptr;
+
+        vector<uint8_t> pixels(SK_VIGNETTE_SIZE * SK_VIGNETTE_SIZE * 4);
+        double half = (SK_VIGNETTE_SIZE - 1) / 2.0;
+
+        for (int y = 0; y < SK_VIGNETTE_SIZE; y++)
+        {
+            for (int x = 0; x < SK_VIGNETTE_SIZE; x++)
+            {
+                double dx = (x - half) / half, dy = (y - half) / half;
+                double d = std::min(1.0, sqrt(dx * dx + dy * dy) / sqrt(2.0));
+
+                // clear to half way out, then a smooth fade to the corners
+                double t = std::max(0.0, (d - 0.5) / 0.5);
+                double alpha = t * t * (3 - 2 * t);
+
+                uint8_t *px = &pixels[(y * SK_VIGNETTE_SIZE + x) * 4];
+                px[0] = px[1] = px[2] = 255;
+                px[3] = static_cast<uint8_t>(alpha * 255);
+            }
+        }
+
+        _sk_update_texture(result, nullptr, pixels.data(), SK_VIGNETTE_SIZE * 4);
+        SDL_SetTextureBlendMode(result, SDL_BLENDMODE_BLEND);
+        SDL_SetTextureScaleMode(result, SDL_ScaleModeLinear);
+        return result;
+    }
+
+    static bool _sk_prepare_effect_textures(_sk_window_effects &fx, sk_window_be *window_be)
+    {
+        int w = window_be->width, h = window_be->height;
+        if ( fx.output && fx.width == w && fx.height == h ) return true;
+
+        _sk_free_effect_textures(fx);
+
+        Uint32 format;
+        if ( SDL_QueryTexture(window_be->backing, &format, nullptr, nullptr, nullptr) != 0 ) return false;
+
+        fx.output = _sk_effect_target(window_be->renderer, format, w, h);
+        if ( ! fx.output ) return false;
+
+        fx.width = w;
+        fx.height = h;
+
+        fx.scanlines.clear();
+        for (int y = 1; y < h; y += 2)
+            fx.scanlines.push_back({ 0, y, w, 1 });
+
+        return true;
+    }
+
+    static void _sk_apply_color_grade(SDL_Renderer *renderer, const _sk_post_effect &effect)
+    {
+        // blend towards white as the strength falls, so a weak grade changes less
+        auto channel = [&effect](Uint8 value) { return static_cast<Uint8>(255 - (255 - value) * effect.strength); };
+
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_MOD);
+        SDL_SetRenderDrawColor(renderer, channel(effect.clr.r), channel(effect.clr.g), channel(effect.clr.b), 255);
+        _sk_count_untextured_draw();
+        SDL_RenderFillRect(renderer, nullptr);
+    }
+
+    static void _sk_apply_vignette(_sk_window_effects &fx, SDL_Renderer *renderer, const _sk_post_effect &effect)
+    {
+        if ( ! fx.vignette ) fx.vignette = _sk_create_vignette(renderer);
+        if ( ! fx.vignette ) return;
+
+        SDL_SetTextureColorMod(fx.vignette, effect.clr.r, effect.clr.g, effect.clr.b);
+        SDL_SetTextureAlphaMod(fx.vignette, static_cast<Uint8>(effect.strength * 255));
+        _sk_render_copy(renderer, fx.vignette, nullptr, nullptr);
+    }
+
+    static void _sk_apply_scanlines(_sk_window_effects &fx, SDL_Renderer *renderer, const _sk_post_effect &effect)
+    {
+        if ( fx.scanlines.empty() ) return;
+
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(renderer, effect.clr.r, effect.clr.g, effect.clr.b, static_cast<Uint8>(effect.strength * 255));
+        _sk_count_untextured_draw();
+        SDL_RenderFillRects(renderer, fx.scanlines.data(), static_cast<int>(fx.scanlines.size()));
+    }
+
+    static void _sk_apply_bloom(_sk_window_effects &fx, SDL_Renderer *renderer, const _sk_post_effect &effect)
+    {
+        if ( ! fx.quarter )
+        {
+            Uint32 format;
+            SDL_QueryTexture(fx.output, &format, nullptr, nullptr, nullptr);
+            fx.quarter = _sk_effect_target(renderer, format, fx.width / 4, fx.height / 4);
+            fx.eighth = _sk_effect_target(renderer, format, fx.width / 8, fx.height / 8);
+            if ( ! fx.quarter || ! fx.eighth ) return;
+        }
+
+        // scale the frame down, keeping only what is above the threshold
+        _sk_set_render_target(renderer, fx.quarter);
+        SDL_SetTextureBlendMode(fx.output, SDL_BLENDMODE_NONE);
+        _sk_render_copy(renderer, fx.output, nullptr, nullptr);
+
+        // reverse subtract takes the threshold from the frame, not the frame from the threshold
+        static SDL_BlendMode subtract = SDL_ComposeCustomBlendMode(
+            SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_REV_SUBTRACT,
+            SDL_BLENDFACTOR_ZERO, SDL_BLENDFACTOR_ONE, SDL_BLENDOPERATION_ADD);
+
+        if ( SDL_SetRenderDrawBlendMode(renderer, subtract) == 0 )
+        {
+            SDL_SetRenderDrawColor(renderer, SK_BLOOM_THRESHOLD, SK_BLOOM_THRESHOLD, SK_BLOOM_THRESHOLD, 255);
+            _sk_count_untextured_draw();
+            SDL_RenderFillRect(renderer, nullptr);
+        }
+
+        // each halving blurs the glow a little more as it is filtered
+        _sk_set_render_target(renderer, fx.eighth);
+        SDL_SetTextureBlendMode(fx.quarter, SDL_BLENDMODE_NONE);
+        _sk_render_copy(renderer, fx.quarter, nullptr, nullptr);
+
+        // add both sizes back, the quarter for a tight glow and the eighth for a wide one
+        _sk_set_render_target(renderer, fx.output);
+        Uint8 alpha = static_cast<Uint8>(effect.strength * 255);
+
+        SDL_Texture *glows[] = { fx.quarter, fx.eighth };
+        for (SDL_Texture *glow : glows)
+        {
+            SDL_SetTextureBlendMode(glow, SDL_BLENDMODE_ADD);
+            SDL_SetTextureColorMod(glow, effect.clr.r, effect.clr.g, effect.clr.b);
+            SDL_SetTextureAlphaMod(glow, alpha);
+            _sk_render_copy(renderer, glow, nullptr, nullptr);
+        }
+    }
+
+    void sk_add_post_effect(sk_drawing_surface *window, sk_post_effect_kind kind, sk_color clr, double strength)
+    {
+        if ( ! window || window->kind != SGDS_Window || ! window->_data ) return;
+
+        unique_ptr<_sk_window_effects> &fx = _sk_effects[window->_data];
+        if ( ! fx ) fx.reset(new _sk_window_effects());
+
+        SDL_Color sdl_clr = {
+            static_cast<Uint8>(std::clamp(clr.r, 0.0f, 1.0f) * 255),
+            static_cast<Uint8>(std::clamp(clr.g, 0.0f, 1.0f) * 255),
+            static_cast<Uint8>(std::clamp(clr.b, 0.0f, 1.0f) * 255),
+            255
+        };
+
+        fx->effects.push_back({ kind, sdl_clr, std::clamp(strength, 0.0, 1.0) });
+    }
+
+    void sk_clear_post_effects(sk_drawing_surface *window)
+    {
+        if ( ! window || ! window->_data ) return;
+
+        auto it = _sk_effects.find(window->_data);
+        if ( it == _sk_effects.end() ) return;
+
+        _sk_free_effect_textures(*it->second);
+        _sk_effects.erase(it);
+    }
+
+    int sk_post_effect_count(sk_drawing_surface *window)
+    {
+        _sk_window_effects *fx = _sk_effects_for(window);
+        return fx ? static_cast<int>(fx->effects.size()) : 0;
+    }
+
+    SDL_Texture *sk_post_effect_output(sk_window_be *window_be)
+    {
+        if ( _sk_effects.empty() ) return window_be->backing;
+
+        auto it = _sk_effects.find(window_be);
+        if ( it == _sk_effects.end() || it->second->effects.empty() ) return window_be->backing;
+
+        _sk_window_effects &fx = *it->second;
+        if ( ! _sk_prepare_effect_textures(fx, window_be) ) return window_be->backing;
+
+        SDL_Renderer *renderer = window_be->renderer;
+
+        _sk_set_render_target(renderer, fx.output);
+        SDL_RenderSetClipRect(renderer, nullptr);
+
+        SDL_Rect src = { 0, 0, fx.width, fx.height };
+        SDL_BlendMode backing_blend = SDL_BLENDMODE_BLEND;
+        SDL_GetTextureBlendMode(window_be->backing, &backing_blend);
+        SDL_SetTextureBlendMode(window_be->backing, SDL_BLENDMODE_NONE);
+        _sk_render_copy(renderer, window_be->backing, &src, nullptr);
+        SDL_SetTextureBlendMode(window_be->backing, backing_blend);
+
+        for (const _sk_post_effect &effect : fx.effects)
+        {
+            switch (effect.kind)
+            {
+                case SK_COLOR_GRADE_EFFECT: _sk_apply_color_grade(renderer, effect); break;
+                case SK_VIGNETTE_EFFECT:    _sk_apply_vignette(fx, renderer, effect); break;
+                case SK_SCANLINES_EFFECT:   _sk_apply_scanlines(fx, renderer, effect); break;
+                case SK_BLOOM_EFFECT:       _sk_apply_bloom(fx, renderer, effect); break;
+            }
+        }
+
+        // the target, clip and blend mode were changed without the window's state
+        _sk_forget_render_state(window_be);
+        return fx.output;
+    }
+
+    sk_color sk_read_post_effect_pixel(sk_drawing_surface *window, int x, int y)
+    {
+        sk_color result = { 0, 0, 0, 0 };
+        if ( ! window || window->kind != SGDS_Window || ! window->_data ) return result;
+        if ( x < 0 || y < 0 || x >= window->width || y >= window->height ) return result;
+
+        sk_flush_draw_batch();
+
+        sk_window_be *window_be = static_cast<sk_window_be *>(window->_data);
+        SDL_Texture *frame = sk_post_effect_output(window_be);
+        sk_flush_draw_batch();
+
+        SDL_Rect rect = { x, y, 1, 1 };
+        unsigned int clr = 0;
+
+        _sk_set_render_target(window_be->renderer, frame);
+        SDL_RenderReadPixels(window_be->renderer, &rect, SDL_PIXELFORMAT_RGBA8888, &clr, 4);
+        _sk_forget_render_state(window_be);
+        _sk_restore_default_render_target(window_be);
+
+        result.r = ((clr & 0xff000000) >> 24) / 255.0f;
+        result.g = ((clr & 0x00ff0000) >> 16) / 255.0f;
+        result.b = ((clr & 0x0000ff00) >> 8) / 255.0f;
+        result.a = (clr & 0x000000ff) / 255.0f;
+        return result;
+    }
+}
@@ -0,0 +1,47 @@
+//
+//  post_effect_driver.h
+//  splashkit
+//
+//  Effects applied to a window's whole frame as it is presented, such as
+//  colour grading, a vignette, scanlines and bloom.
+//
+
+#ifndef SPLASHKIT_POST_EFFECT_DRIVER_H
+#define SPLASHKIT_POST_EFFECT_DRIVER_H
+
+#include "backend_types.h"
+
+#ifdef __linux__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+
+namespace splashkit_lib
+{
+    struct sk_window_be;
+
+    enum sk_post_effect_kind
+    {
+        SK_COLOR_GRADE_EFFECT,  // multiplies each pixel by the color
+        SK_VIGNETTE_EFFECT,     // fades the edges towards the color
+        SK_SCANLINES_EFFECT,    // darkens every second row with the color
+        SK_BLOOM_EFFECT         // adds a blurred glow of the bright areas
+    };
+
+    // Effects run in the order they are added. Strength is 0 to 1.
+    void sk_add_post_effect(sk_drawing_surface *window, sk_post_effect_kind kind, sk_color clr, double strength);
+    void sk_clear_post_effects(sk_drawing_surface *window);
+    int sk_post_effect_count(sk_drawing_surface *window);
+
+    // Called as the window is presented. Returns the texture to show: the
+    // backing texture when there are no effects, otherwise a copy of it with
+    // the effects applied, so drawing kept between frames is not changed.
+    SDL_Texture *sk_post_effect_output(sk_window_be *window_be);
+
+    // Read a pixel of the window's frame with its effects applied, as it
+    // would next be presented
+    sk_color sk_read_post_effect_pixel(sk_drawing_surface *window, int x, int y);
+}
+
+#endif //SPLASHKIT_POST_EFFECT_DRIVER_H
@@ -0,0 +1,143 @@
+//
+//  profiling_driver.cpp
+//  splashkit
+//
+//  Collects timed zones into a ring of recent frames.
+//
+
+#include "profiling_driver.h"
+#include "utils_driver.h"
+
+#include <mutex>
+#include <unordered_map>
+
+using std::mutex;
+using std::lock_guard;
+
+// Guard against a frame that never ends filling memory
+#define PROFILE_MAX_EVENTS_PER_FRAME 65536
+
+namespace splashkit_lib
+{
+    std::atomic<bool> _sk_profiling(false);
+
+    struct _sk_open_zone
+    {
+        int name;
+        long long start_ns;
+    };
+
+    static mutex _profile_lock;
+    static vector<string> _profile_names;
+    static std::unordered_map<string, int> _profile_name_ids;
+
+    static sk_profile_frame _current_frame = { 0, 0, {} };
+    static vector<sk_profile_frame> _profile_history(PROFILE_FRAME_HISTORY);
+    static size_t _profile_history_next = 0;
+    static size_t _profile_history_count = 0;
+
+    static std::atomic<unsigned int> _profile_thread_count(0);
+
+    // Each thread keeps its own stack of open zones, so nesting is tracked
+    // without locking until a zone closes
+    static thread_local vector<_sk_open_zone> _open_zones;
+    static thread_local unsigned int _profile_thread_id = _profile_thread_count++;
+
+    void sk_set_profiling(bool enabled)
+    {
+        lock_guard<mutex> guard(_profile_lock);
+
+        if ( enabled && ! _sk_profiling )
+        {
+            _current_frame.start_ns = sk_get_ticks_ns();
+            _current_frame.events.clear();
+        }
+
+        _sk_profiling = enabled;
+    }
+
+    int sk_profile_name_id(const string &name)
+    {
+        lock_guard<mutex> guard(_profile_lock);
+
+        auto it = _profile_name_ids.find(name);
+        if ( it != _profile_name_ids.end() ) return it->second;
+
+        int id = static_cast<int>(_profile_names.size());
+        _profile_names.push_back(name);
+        _profile_name_ids[name] = id;
+        return id;
+    }
+
+    string sk_profile_name(int id)
+    {
+        lock_guard<mutex> guard(_profile_lock);
+
+        if ( id < 0 || id >= static_cast<int>(_profile_names.size()) ) return "";
+        return _profile_names[id];
+    }
+
+    void sk_profile_begin(int name_id)
+    {
+        _open_zones.push_back({ name_id, name_id == PROFILE_UNTIMED_ZONE ? 0 : sk_get_ticks_ns() });
+    }
+
+    void sk_profile_end()
+    {
+        if ( _open_zones.empty() ) return;
+
+        long long end_ns = sk_get_ticks_ns();
+        _sk_open_zone zone = _open_zones.back();
+        _open_zones.pop_back();
+
+        if ( zone.name == PROFILE_UNTIMED_ZONE || ! sk_profiling_enabled() ) return;
+
+        sk_profile_event evt;
+        evt.name = zone.name;
+        evt.start_ns = zone.start_ns;
+        evt.duration_ns = end_ns - zone.start_ns;
+        evt.depth = static_cast<int>(_open_zones.size());
+        evt.thread = _profile_thread_id;
+
+        lock_guard<mutex> guard(_profile_lock);
+        if ( _current_frame.events.size() < PROFILE_MAX_EVENTS_PER_FRAME )
+            _current_frame.events.push_back(evt);
+    }
+
+    void sk_profile_next_frame()
+    {
+        if ( ! sk_profiling_enabled() ) return;
+
+        long long now = sk_get_ticks_ns();
+
+        lock_guard<mutex> guard(_profile_lock);
+
+        _current_frame.end_ns = now;
+
+        // Swap into the ring so the old frame's event storage is reused
+        sk_profile_frame &slot = _profile_history[_profile_history_next];
+        std::swap(slot, _current_frame);
+        _profile_history_next = (_profile_history_next + 1) % PROFILE_FRAME_HISTORY;
+        if ( _profile_history_count < PROFILE_FRAME_HISTORY ) _profile_history_count++;
+
+        _current_frame.start_ns = now;
+        _current_frame.end_ns = 0;
+        _current_frame.events.clear();
+    }
+
+    vector<sk_profile_frame> sk_profile_frames()
+    {
+        lock_guard<mutex> guard(_profile_lock);
+
+        vector<sk_profile_frame> result;
+        result.reserve(_profile_history_count);
+
+        size_t first = (_profile_history_next + PROFILE_FRAME_HISTORY - _profile_history_count) % PROFILE_FRAME_HISTORY;
+        for (size_t i = 0; i < _profile_history_count; i++)
+        {
+            result.push_back(_profile_history[(first + i) % PROFILE_FRAME_HISTORY]);
+        }
+
+        return result;
+    }
+}
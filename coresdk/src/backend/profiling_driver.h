@@ -0,0 +1,103 @@
+//
+//  profiling_driver.h
+//  splashkit
+//
+//  Collects timed zones into a ring of recent frames.
+//
+
+#ifndef SPLASHKIT_PROFILING_DRIVER_H
+#define SPLASHKIT_PROFILING_DRIVER_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// Number of completed frames kept for reports and trace export
+#define PROFILE_FRAME_HISTORY 120
+
+// Name id for a zone opened while profiling was off, which is never recorded
+#define PROFILE_UNTIMED_ZONE -1
+
+namespace splashkit_lib
+{
+    struct sk_profile_event
+    {
+        int name;               // index into sk_profile_names
+        long long start_ns;
+        long long duration_ns;
+        int depth;              // nesting depth on its thread
+        unsigned int thread;    // small id for the thread that ran the zone
+    };
+
+    struct sk_profile_frame
+    {
+        long long start_ns;
+        long long end_ns;
+        vector<sk_profile_event> events;
+    };
+
+    extern std::atomic<bool> _sk_profiling;
+
+    inline bool sk_profiling_enabled() { return _sk_profiling.load(std::memory_order_relaxed); }
+    void sk_set_profiling(bool enabled);
+
+    /**
+     * Map a zone name to an id. Ids are stable for the life of the program,
+     * so callers on hot paths can look them up once and keep them.
+     */
+    int sk_profile_name_id(const string &name);
+    string sk_profile_name(int id);
+
+    /**
+     * Open and close zones on the calling thread. Pass PROFILE_UNTIMED_ZONE
+     * to open a zone that only keeps begin and end calls paired.
+     */
+    void sk_profile_begin(int name_id);
+    void sk_profile_end();
+
+    /**
+     * Close off the current frame and start a new one. Called once per
+     * frame from process_events.
+     */
+    void sk_profile_next_frame();
+
+    /**
+     * Copy the completed frames, oldest first.
+     */
+    vector<sk_profile_frame> sk_profile_frames();
+
+    /**
+     * Times a zone for the life of the object. Does nothing while
+     * profiling is disabled.
+     */
+    struct sk_profile_scope
+    {
+        bool active;
+
+        explicit sk_profile_scope(int name_id) : active(sk_profiling_enabled())
+        {
+            if (active) sk_profile_begin(name_id);
+        }
+
+        ~sk_profile_scope()
+        {
+            if (active) sk_profile_end();
+        }
+
+        sk_profile_scope(const sk_profile_scope &) = delete;
+        sk_profile_scope &operator=(const sk_profile_scope &) = delete;
+    };
+}
+
+#define SK_PROFILE_CONCAT_(a, b) a##b
+#define SK_PROFILE_CONCAT(a, b) SK_PROFILE_CONCAT_(a, b)
+
+// Time the rest of the enclosing block as a zone called `name`
+#define SK_PROFILE_SCOPE(name) \
+    static const int SK_PROFILE_CONCAT(_sk_profile_id_, __LINE__) = splashkit_lib::sk_profile_name_id(name); \
+    splashkit_lib::sk_profile_scope SK_PROFILE_CONCAT(_sk_profile_scope_, __LINE__)(SK_PROFILE_CONCAT(_sk_profile_id_, __LINE__))
+
+#endif //SPLASHKIT_PROFILING_DRIVER_H
@@ -0,0 +1,135 @@
+//
+//  resource_registry.h
+//  splashkit
+//
+//  A name to resource hash table that can be read and updated from any thread.
+//
+
+#ifndef SPLASHKIT_RESOURCE_REGISTRY_H
+#define SPLASHKIT_RESOURCE_REGISTRY_H
+
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace splashkit_lib
+{
+    /**
+     * Holds the named resources of one kind, such as the loaded bitmaps.
+     * Lookups take a shared lock, so any number of threads can find
+     * resources at once, while inserts and removals take the lock
+     * exclusively. The lock only protects the registry itself: freeing a
+     * resource while another thread is using it is still an error.
+     *
+     * Resources are hashed by name, so a lookup hashes the name once rather
+     * than comparing it at each level of a tree. Entries are in no
+     * particular order.
+     */
+    template <typename T>
+    class resource_registry
+    {
+    private:
+        std::unordered_map<std::string, T> _resources;
+        mutable std::shared_mutex _lock;
+
+    public:
+        typedef T value_type;
+
+        bool contains(const std::string &name) const
+        {
+            std::shared_lock<std::shared_mutex> guard(_lock);
+            return _resources.count(name) > 0;
+        }
+
+        /**
+         * The resource called `name`, or `missing` if there is none.
+         */
+        T find(const std::string &name, T missing = T()) const
+        {
+            std::shared_lock<std::shared_mutex> guard(_lock);
+            auto it = _resources.find(name);
+            return it == _resources.end() ? missing : it->second;
+        }
+
+        /**
+         * Register `resource` as `name`, replacing any existing entry.
+         */
+        void set(const std::string &name, T resource)
+        {
+            std::unique_lock<std::shared_mutex> guard(_lock);
+            _resources[name] = resource;
+        }
+
+        /**
+         * Register `resource` as `name` unless the name is taken. Returns
+         * the resource now registered under the name, so threads racing
+         * to load the same resource all agree on the winner.
+         */
+        T insert(const std::string &name, T resource)
+        {
+            std::unique_lock<std::shared_mutex> guard(_lock);
+            return _resources.emplace(name, resource).first->second;
+        }
+
+        void erase(const std::string &name)
+        {
+            std::unique_lock<std::shared_mutex> guard(_lock);
+            _resources.erase(name);
+        }
+
+        size_t size() const
+        {
+            std::shared_lock<std::shared_mutex> guard(_lock);
+            return _resources.size();
+        }
+
+        /**
+         * Copy out the first entry, used to free resources one at a time.
+         */
+        bool first(std::string &name, T &resource) const
+        {
+            std::shared_lock<std::shared_mutex> guard(_lock);
+            if ( _resources.empty() ) return false;
+
+            name = _resources.begin()->first;
+            resource = _resources.begin()->second;
+            return true;
+        }
+
+        /**
+         * A snapshot of the registered resources, safe to walk while
+         * other threads add or remove entries.
+         */
+        std::vector<std::pair<std::string, T>> entries() const
+        {
+            std::shared_lock<std::shared_mutex> guard(_lock);
+            return std::vector<std::pair<std::string, T>>(_resources.begin(), _resources.end());
+        }
+    };
+}
+
+// Free every resource in a registry, dropping any invalid entries. Each
+// free removes its own entry, so the first entry is re-read every time.
+#define FREE_ALL_FROM_REGISTRY(registry, ptr_kind, fn)\
+{\
+std::string _name;\
+decltype(registry)::value_type _resource;\
+size_t sz = registry.size();\
+for(size_t i = 0; i < sz && registry.first(_name, _resource); i++)\
+{\
+if (HAS_PTR_KIND(_resource, ptr_kind))\
+{\
+fn(_resource);\
+}\
+else\
+{\
+LOG(WARNING) << "Splashkit contains invalid " #ptr_kind "!";\
+registry.erase(_name);\
+}\
+}\
+}
+
+#endif //SPLASHKIT_RESOURCE_REGISTRY_H
@@ -0,0 +1,75 @@
+//
+//  resource_tracking.h
+//  splashkit
+//
+//  Memory accounting and eviction for loaded resources. The loaders report
+//  each resource here, and resources.cpp evicts the least recently used
+//  ones when the memory budget is exceeded. Eviction frees the data a
+//  resource holds but keeps the resource itself, so handles to it stay
+//  valid, and the data is loaded again in place when it is next used.
+//
+
+#ifndef SPLASHKIT_RESOURCE_TRACKING_H
+#define SPLASHKIT_RESOURCE_TRACKING_H
+
+#include "resources.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+using std::string;
+
+namespace splashkit_lib
+{
+    // Reports the bytes a resource currently holds in system and video memory
+    typedef std::function<void(size_t &cpu_bytes, size_t &gpu_bytes)> resource_measure_fn;
+
+    // Loads the data of an evicted resource again, into the same resource
+    typedef std::function<void()> resource_reload_fn;
+
+    // Frees the data a resource holds to save memory, keeping the resource
+    // itself, and returns how to load the data again. Returns an empty
+    // function, without freeing, if the data cannot be loaded again as it is
+    // (for example a bitmap that has been drawn on).
+    typedef std::function<resource_reload_fn()> resource_evict_fn;
+
+    /**
+     * Start tracking a loaded resource. The resource is tracked until it is
+     * freed, which is detected through `notify_of_free`. Resources without
+     * an evict function are counted but never evicted. Tracking a resource
+     * may evict others to bring memory use back within the budget.
+     */
+    void _track_resource(void *resource, resource_kind kind, const string &name, resource_measure_fn measure, resource_evict_fn evict);
+
+    /**
+     * Count a resource in the memory report, without tracking it for the
+     * budget. Used for resources that are created often, such as json
+     * objects, where checking the budget each time would cost too much. The
+     * resource is counted until `notify_of_free` is called for it.
+     */
+    void _count_resource(void *resource, resource_kind kind, resource_measure_fn measure);
+
+    /**
+     * Mark a tracked resource as used, moving it to the back of the
+     * eviction order. An evicted resource is loaded again before this
+     * returns, so call it before touching the resource's data. Cheap when
+     * no budget is set and nothing is evicted.
+     */
+    void _resource_used(void *resource);
+
+    /**
+     * Evict the data of a tracked resource now, whatever the budget, unless
+     * it is pinned, retained, or cannot be loaded again as it is.
+     *
+     * @returns True if the resource's data is evicted
+     */
+    bool _evict_resource(void *resource);
+
+    /**
+     * Check if a tracked resource has had its data evicted.
+     */
+    bool _resource_evicted(void *resource);
+}
+
+#endif //SPLASHKIT_RESOURCE_TRACKING_H
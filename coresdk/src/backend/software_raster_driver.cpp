@@ -0,0 +1,534 @@
+//
+//  software_raster_driver.cpp
+//  splashkit
+//
+//  Each command records the pixels it may change. When flushed, the
+//  commands are sorted into tiles, and the tiles are drawn on the shared
+//  worker pool. Each tile draws its commands in the order they were
+//  recorded, and no two tiles share a pixel, so the result matches drawing
+//  the commands one at a time. Rows are filled a span at a time, blending
+//  four pixels at once with SSE2 where it is available.
+//
+
+#include "software_raster_driver.h"
+#include "concurrency_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using std::shared_ptr;
+using std::vector;
+
+// Commands are sorted into square tiles of this many pixels
+#define SK_RASTER_TILE_SIZE 64
+
+namespace splashkit_lib
+{
+    enum _sk_raster_kind
+    {
+        _SK_RASTER_CLEAR,
+        _SK_RASTER_RECT,
+        _SK_RASTER_POLYGON,
+        _SK_RASTER_ELLIPSE,
+        _SK_RASTER_IMAGE
+    };
+
+    struct _sk_raster_command
+    {
+        _sk_raster_kind kind;
+        uint32_t clr;
+        SDL_Rect bounds;    // the pixels it may change, within the clip area
+
+        // polygon points, or the ellipse centre in x[0], y[0] and radii in x[1], y[1]
+        double x[4], y[4];
+        int count;
+
+        // images map a pixel centre (px, py) onto the dst area at
+        // (ox + px * cos_a + py * sin_a, oy - px * sin_a + py * cos_a)
+        sk_raster_image image;
+        shared_ptr<vector<uint32_t>> copy;
+        double ox, oy, cos_a, sin_a;
+        double dst_w, dst_h, scale_x, scale_y;
+        int src_x, src_y;
+        int min_u, max_u, min_v, max_v;     // the texels that can be read
+        int base_u, base_v;                 // the texel at the start of the image pixels
+        bool flip_x, flip_y;
+        SDL_Color tint;
+        bool premultiplied;
+    };
+
+    struct sk_raster_target
+    {
+        int width, height;
+        SDL_Rect clip;
+        vector<_sk_raster_command> commands;
+
+        // the commands touching each tile, kept for reuse between flushes
+        vector<vector<unsigned int>> bins;
+    };
+
+    static bool _sk_raster_intersect(const SDL_Rect &a, const SDL_Rect &b, SDL_Rect &out_result)
+    {
+        int x1 = std::max(a.x, b.x), y1 = std::max(a.y, b.y);
+        int x2 = std::min(a.x + a.w, b.x + b.w), y2 = std::min(a.y + a.h, b.y + b.h);
+
+        out_result = { x1, y1, x2 - x1, y2 - y1 };
+        return x2 > x1 && y2 > y1;
+    }
+
+    // Keeps the command if any of its bounds lie within the clip area
+    static void _sk_raster_add(sk_raster_target *target, _sk_raster_command &cmd, int x1, int y1, int x2, int y2)
+    {
+        SDL_Rect area = { x1, y1, x2 - x1, y2 - y1 };
+        if ( ! _sk_raster_intersect(area, target->clip, cmd.bounds) ) return;
+
+        target->commands.push_back(std::move(cmd));
+    }
+
+    sk_raster_target *sk_create_raster_target(int width, int height)
+    {
+        if ( width <= 0 || height <= 0 ) return nullptr;
+
+        sk_raster_target *result = new sk_raster_target();
+        result->width = width;
+        result->height = height;
+        result->clip = { 0, 0, width, height };
+        return result;
+    }
+
+    void sk_free_raster_target(sk_raster_target *target)
+    {
+        delete target;
+    }
+
+    bool sk_raster_has_commands(sk_raster_target *target)
+    {
+        return target && ! target->commands.empty();
+    }
+
+    void sk_raster_set_clip(sk_raster_target *target, const SDL_Rect *clip)
+    {
+        if ( ! target ) return;
+
+        SDL_Rect all = { 0, 0, target->width, target->height };
+        if ( ! clip )
+            target->clip = all;
+        else if ( ! _sk_raster_intersect(*clip, all, target->clip) )
+            target->clip = { 0, 0, 0, 0 };
+    }
+
+    void sk_raster_clear(sk_raster_target *target, uint32_t clr)
+    {
+        if ( ! target ) return;
+
+        // everything drawn before is covered
+        target->commands.clear();
+
+        _sk_raster_command cmd = {};
+        cmd.kind = _SK_RASTER_CLEAR;
+        cmd.clr = clr;
+        cmd.bounds = { 0, 0, target->width, target->height };
+        target->commands.push_back(cmd);
+    }
+
+    void sk_raster_fill_rect(sk_raster_target *target, uint32_t clr, int x, int y, int w, int h)
+    {
+        if ( ! target || w <= 0 || h <= 0 || (clr & 0xff) == 0 ) return;
+
+        _sk_raster_command cmd = {};
+        cmd.kind = _SK_RASTER_RECT;
+        cmd.clr = clr;
+        _sk_raster_add(target, cmd, x, y, x + w, y + h);
+    }
+
+    void sk_raster_fill_polygon(sk_raster_target *target, uint32_t clr, const double *xs, const double *ys, int count)
+    {
+        if ( ! target || count < 3 || count > 4 || (clr & 0xff) == 0 ) return;
+
+        _sk_raster_command cmd = {};
+        cmd.kind = _SK_RASTER_POLYGON;
+        cmd.clr = clr;
+        cmd.count = count;
+
+        double left = xs[0], right = xs[0], top = ys[0], bottom = ys[0];
+        for (int i = 0; i < count; i++)
+        {
+            cmd.x[i] = xs[i];
+            cmd.y[i] = ys[i];
+            left = std::min(left, xs[i]);
+            right = std::max(right, xs[i]);
+            top = std::min(top, ys[i]);
+            bottom = std::max(bottom, ys[i]);
+        }
+
+        _sk_raster_add(target, cmd,
+                       static_cast<int>(std::floor(left)), static_cast<int>(std::floor(top)),
+                       static_cast<int>(std::ceil(right)), static_cast<int>(std::ceil(bottom)));
+    }
+
+    void sk_raster_fill_ellipse(sk_raster_target *target, uint32_t clr, double cx, double cy, double rx, double ry)
+    {
+        if ( ! target || rx <= 0 || ry <= 0 || (clr & 0xff) == 0 ) return;
+
+        _sk_raster_command cmd = {};
+        cmd.kind = _SK_RASTER_ELLIPSE;
+        cmd.clr = clr;
+        cmd.x[0] = cx;
+        cmd.y[0] = cy;
+        cmd.x[1] = rx;
+        cmd.y[1] = ry;
+
+        _sk_raster_add(target, cmd,
+                       static_cast<int>(std::floor(cx - rx)), static_cast<int>(std::floor(cy - ry)),
+                       static_cast<int>(std::ceil(cx + rx)), static_cast<int>(std::ceil(cy + ry)));
+    }
+
+    void sk_raster_draw_image(sk_raster_target *target, const sk_raster_image &image, const SDL_Rect &src, const SDL_Rect &dst, double angle, double centre_x, double centre_y, bool flip_x, bool flip_y, SDL_Color tint, bool premultiplied, bool copy)
+    {
+        if ( ! target || ! image.pixels || src.w <= 0 || src.h <= 0 || dst.w == 0 || dst.h == 0 || tint.a == 0 ) return;
+
+        // as SDL clips to the texture, only texels within the image are read
+        SDL_Rect texels;
+        SDL_Rect all = { 0, 0, image.width, image.height };
+        if ( ! _sk_raster_intersect(src, all, texels) ) return;
+
+        _sk_raster_command cmd = {};
+        cmd.kind = _SK_RASTER_IMAGE;
+        cmd.image = image;
+        cmd.tint = tint;
+        cmd.premultiplied = premultiplied;
+        cmd.src_x = src.x;
+        cmd.src_y = src.y;
+        cmd.min_u = texels.x;
+        cmd.max_u = texels.x + texels.w - 1;
+        cmd.min_v = texels.y;
+        cmd.max_v = texels.y + texels.h - 1;
+
+        // negative sizes draw mirrored
+        SDL_Rect area = dst;
+        cmd.flip_x = flip_x;
+        cmd.flip_y = flip_y;
+        if ( area.w < 0 )
+        {
+            area.x += area.w;
+            area.w = -area.w;
+            cmd.flip_x = ! cmd.flip_x;
+        }
+        if ( area.h < 0 )
+        {
+            area.y += area.h;
+            area.h = -area.h;
+            cmd.flip_y = ! cmd.flip_y;
+        }
+
+        cmd.dst_w = area.w;
+        cmd.dst_h = area.h;
+        cmd.scale_x = src.w / static_cast<double>(area.w);
+        cmd.scale_y = src.h / static_cast<double>(area.h);
+
+        // SDL turns clockwise on screen, so map pixels back by turning the other way
+        double radians = angle * M_PI / 180.0;
+        cmd.cos_a = std::cos(radians);
+        cmd.sin_a = std::sin(radians);
+
+        double dx = 0.5 - (area.x + centre_x);
+        double dy = 0.5 - (area.y + centre_y);
+        cmd.ox = dx * cmd.cos_a + dy * cmd.sin_a + centre_x;
+        cmd.oy = -dx * cmd.sin_a + dy * cmd.cos_a + centre_y;
+
+        if ( copy )
+        {
+            cmd.copy = std::make_shared<vector<uint32_t>>(static_cast<size_t>(texels.w) * texels.h);
+            for (int row = 0; row < texels.h; row++)
+            {
+                const uint32_t *from = image.pixels + (texels.y + row) * image.pitch + texels.x;
+                std::copy(from, from + texels.w, cmd.copy->data() + row * texels.w);
+            }
+            cmd.image = { cmd.copy->data(), texels.w, texels.h, texels.w };
+            cmd.base_u = texels.x;
+            cmd.base_v = texels.y;
+        }
+
+        // the bounds of the turned dst area
+        double left = 0, right = 0, top = 0, bottom = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            double lx = (i & 1 ? area.w : 0) - centre_x;
+            double ly = (i & 2 ? area.h : 0) - centre_y;
+            double px = area.x + centre_x + lx * cmd.cos_a - ly * cmd.sin_a;
+            double py = area.y + centre_y + lx * cmd.sin_a + ly * cmd.cos_a;
+
+            if ( i == 0 || px < left ) left = px;
+            if ( i == 0 || px > right ) right = px;
+            if ( i == 0 || py < top ) top = py;
+            if ( i == 0 || py > bottom ) bottom = py;
+        }
+
+        _sk_raster_add(target, cmd,
+                       static_cast<int>(std::floor(left)), static_cast<int>(std::floor(top)),
+                       static_cast<int>(std::ceil(right)), static_cast<int>(std::ceil(bottom)));
+    }
+
+    //
+    // Blending
+    //
+
+    // x / 255 rounded to the nearest integer, for x up to 255 * 255
+    static inline uint32_t _sk_div255(uint32_t x)
+    {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    // Blends a source whose channels are already scaled by 255 times their
+    // share of the result, with inv the share of the existing pixel
+    static inline uint32_t _sk_blend_pixel(uint32_t d, uint32_t sr, uint32_t sg, uint32_t sb, uint32_t sa, uint32_t inv)
+    {
+        uint32_t r = _sk_div255(sr + (d >> 24) * inv);
+        uint32_t g = _sk_div255(sg + ((d >> 16) & 0xff) * inv);
+        uint32_t b = _sk_div255(sb + ((d >> 8) & 0xff) * inv);
+        uint32_t a = _sk_div255(sa + (d & 0xff) * inv);
+        return (r << 24) | (g << 16) | (b << 8) | a;
+    }
+
+#ifdef __SSE2__
+    // The SSE2 form of _sk_blend_pixel, on two pixels unpacked to 16 bit lanes
+    static inline __m128i _sk_blend_lanes(__m128i d, __m128i src, __m128i inv)
+    {
+        __m128i x = _mm_add_epi16(_mm_add_epi16(src, _mm_mullo_epi16(d, inv)), _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+#endif
+
+    // Blends clr over count pixels, as SDL_BLENDMODE_BLEND does
+    static void _sk_blend_span(uint32_t *dst, int count, uint32_t clr)
+    {
+        uint32_t alpha = clr & 0xff;
+
+        if ( alpha == 255 )
+        {
+            std::fill_n(dst, count, clr);
+            return;
+        }
+
+        // alpha blends to alpha + dst alpha * (1 - alpha), so it is scaled by 255
+        uint32_t inv = 255 - alpha;
+        uint32_t sr = (clr >> 24) * alpha;
+        uint32_t sg = ((clr >> 16) & 0xff) * alpha;
+        uint32_t sb = ((clr >> 8) & 0xff) * alpha;
+        uint32_t sa = alpha * 255;
+
+        int i = 0;
+
+#ifdef __SSE2__
+        // pixels are stored a, b, g, r in memory, so that is the lane order
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i src = _mm_set_epi16(
+            static_cast<short>(sr), static_cast<short>(sg), static_cast<short>(sb), static_cast<short>(sa),
+            static_cast<short>(sr), static_cast<short>(sg), static_cast<short>(sb), static_cast<short>(sa));
+        const __m128i scale = _mm_set1_epi16(static_cast<short>(inv));
+
+        for ( ; i + 4 <= count; i += 4 )
+        {
+            __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+            __m128i lo = _sk_blend_lanes(_mm_unpacklo_epi8(px, zero), src, scale);
+            __m128i hi = _sk_blend_lanes(_mm_unpackhi_epi8(px, zero), src, scale);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packus_epi16(lo, hi));
+        }
+#endif
+
+        for ( ; i < count; i++ )
+        {
+            dst[i] = _sk_blend_pixel(dst[i], sr, sg, sb, sa, inv);
+        }
+    }
+
+    //
+    // Drawing a command within one tile
+    //
+
+    // Fills the pixels of the row whose centres lie in [left, right)
+    static void _sk_fill_row_span(uint32_t *row, const SDL_Rect &area, double left, double right, uint32_t clr)
+    {
+        int x1 = std::max(area.x, static_cast<int>(std::ceil(left - 0.5)));
+        int x2 = std::min(area.x + area.w, static_cast<int>(std::ceil(right - 0.5)));
+        if ( x2 > x1 ) _sk_blend_span(row + x1, x2 - x1, clr);
+    }
+
+    static void _sk_draw_polygon_rows(const _sk_raster_command &cmd, const SDL_Rect &area, uint32_t *pixels, int pitch)
+    {
+        for (int y = area.y; y < area.y + area.h; y++)
+        {
+            double yc = y + 0.5;
+            double left = INFINITY, right = -INFINITY;
+
+            for (int i = 0; i < cmd.count; i++)
+            {
+                int j = (i + 1) % cmd.count;
+
+                // each edge is walked from its top, so shared edges give the same x
+                int top = cmd.y[i] <= cmd.y[j] ? i : j;
+                int bottom = top == i ? j : i;
+                if ( yc < cmd.y[top] || yc >= cmd.y[bottom] ) continue;
+
+                double x = cmd.x[top] + (yc - cmd.y[top]) * (cmd.x[bottom] - cmd.x[top]) / (cmd.y[bottom] - cmd.y[top]);
+                left = std::min(left, x);
+                right = std::max(right, x);
+            }
+
+            if ( left < right ) _sk_fill_row_span(pixels + y * pitch, area, left, right, cmd.clr);
+        }
+    }
+
+    static void _sk_draw_ellipse_rows(const _sk_raster_command &cmd, const SDL_Rect &area, uint32_t *pixels, int pitch)
+    {
+        double cx = cmd.x[0], cy = cmd.y[0], rx = cmd.x[1], ry = cmd.y[1];
+
+        for (int y = area.y; y < area.y + area.h; y++)
+        {
+            double t = (y + 0.5 - cy) / ry;
+            if ( t * t >= 1 ) continue;
+
+            double half = rx * std::sqrt(1 - t * t);
+            _sk_fill_row_span(pixels + y * pitch, area, cx - half, cx + half, cmd.clr);
+        }
+    }
+
+    static void _sk_draw_image_rows(const _sk_raster_command &cmd, const SDL_Rect &area, uint32_t *pixels, int pitch)
+    {
+        const sk_raster_image &image = cmd.image;
+        SDL_Color tint = cmd.tint;
+
+        for (int y = area.y; y < area.y + area.h; y++)
+        {
+            uint32_t *row = pixels + y * pitch;
+            double lx = cmd.ox + area.x * cmd.cos_a + y * cmd.sin_a;
+            double ly = cmd.oy - area.x * cmd.sin_a + y * cmd.cos_a;
+
+            for (int x = area.x; x < area.x + area.w; x++, lx += cmd.cos_a, ly -= cmd.sin_a)
+            {
+                if ( lx < 0 || ly < 0 || lx >= cmd.dst_w || ly >= cmd.dst_h ) continue;
+
+                int u = cmd.src_x + static_cast<int>((cmd.flip_x ? cmd.dst_w - lx : lx) * cmd.scale_x);
+                int v = cmd.src_y + static_cast<int>((cmd.flip_y ? cmd.dst_h - ly : ly) * cmd.scale_y);
+                u = std::min(std::max(u, cmd.min_u), cmd.max_u);
+                v = std::min(std::max(v, cmd.min_v), cmd.max_v);
+
+                uint32_t s = image.pixels[(v - cmd.base_v) * image.pitch + (u - cmd.base_u)];
+                uint32_t a = _sk_div255((s & 0xff) * tint.a);
+                if ( a == 0 ) continue;
+
+                uint32_t r = _sk_div255((s >> 24) * tint.r);
+                uint32_t g = _sk_div255(((s >> 16) & 0xff) * tint.g);
+                uint32_t b = _sk_div255(((s >> 8) & 0xff) * tint.b);
+
+                // premultiplied colours are already scaled by their alpha,
+                // and are kept within it so the blend cannot overflow
+                uint32_t share = a;
+                if ( cmd.premultiplied )
+                {
+                    share = 255;
+                    r = std::min(r, a);
+                    g = std::min(g, a);
+                    b = std::min(b, a);
+                }
+
+                row[x] = _sk_blend_pixel(row[x], r * share, g * share, b * share, a * 255, 255 - a);
+            }
+        }
+    }
+
+    static void _sk_draw_command(const _sk_raster_command &cmd, const SDL_Rect &area, uint32_t *pixels, int pitch)
+    {
+        switch (cmd.kind)
+        {
+            case _SK_RASTER_CLEAR:
+                for (int y = area.y; y < area.y + area.h; y++)
+                    std::fill_n(pixels + y * pitch + area.x, area.w, cmd.clr);
+                break;
+
+            case _SK_RASTER_RECT:
+                for (int y = area.y; y < area.y + area.h; y++)
+                    _sk_blend_span(pixels + y * pitch + area.x, area.w, cmd.clr);
+                break;
+
+            case _SK_RASTER_POLYGON:
+                _sk_draw_polygon_rows(cmd, area, pixels, pitch);
+                break;
+
+            case _SK_RASTER_ELLIPSE:
+                _sk_draw_ellipse_rows(cmd, area, pixels, pitch);
+                break;
+
+            case _SK_RASTER_IMAGE:
+                _sk_draw_image_rows(cmd, area, pixels, pitch);
+                break;
+        }
+    }
+
+    SDL_Rect sk_raster_flush(sk_raster_target *target, uint32_t *pixels, int pitch)
+    {
+        SDL_Rect changed = { 0, 0, 0, 0 };
+        if ( ! target ) return changed;
+
+        if ( ! pixels || target->commands.empty() )
+        {
+            target->commands.clear();
+            return changed;
+        }
+
+        const int tile = SK_RASTER_TILE_SIZE;
+        int tiles_x = (target->width + tile - 1) / tile;
+        int tiles_y = (target->height + tile - 1) / tile;
+
+        vector<vector<unsigned int>> &bins = target->bins;
+        bins.resize(static_cast<size_t>(tiles_x) * tiles_y);
+        for (auto &bin : bins) bin.clear();
+
+        int x1 = target->width, y1 = target->height, x2 = 0, y2 = 0;
+
+        for (unsigned int i = 0; i < target->commands.size(); i++)
+        {
+            const SDL_Rect &b = target->commands[i].bounds;
+            x1 = std::min(x1, b.x);
+            y1 = std::min(y1, b.y);
+            x2 = std::max(x2, b.x + b.w);
+            y2 = std::max(y2, b.y + b.h);
+
+            for (int ty = b.y / tile; ty <= (b.y + b.h - 1) / tile; ty++)
+                for (int tx = b.x / tile; tx <= (b.x + b.w - 1) / tile; tx++)
+                    bins[ty * tiles_x + tx].push_back(i);
+        }
+
+        const vector<_sk_raster_command> &commands = target->commands;
+        int width = target->width, height = target->height;
+
+        parallel_for(shared_worker_pool(), bins.size(), 1, [&](size_t begin, size_t end, size_t)
+        {
+            for (size_t t = begin; t < end; t++)
+            {
+                int tx = static_cast<int>(t % tiles_x) * tile;
+                int ty = static_cast<int>(t / tiles_x) * tile;
+                SDL_Rect area = { tx, ty, std::min(tile, width - tx), std::min(tile, height - ty) };
+
+                for (unsigned int idx : bins[t])
+                {
+                    SDL_Rect part;
+                    if ( _sk_raster_intersect(commands[idx].bounds, area, part) )
+                        _sk_draw_command(commands[idx], part, pixels, pitch);
+                }
+            }
+        });
+
+        target->commands.clear();
+
+        changed = { x1, y1, x2 - x1, y2 - y1 };
+        return changed;
+    }
+}
@@ -0,0 +1,62 @@
+//
+//  software_raster_driver.h
+//  splashkit
+//
+//  Draws onto pixels in system memory without the renderer. Drawing is
+//  recorded, then sorted into tiles that are drawn in parallel when the
+//  pixels are next needed.
+//
+
+#ifndef SPLASHKIT_SOFTWARE_RASTER_DRIVER_H
+#define SPLASHKIT_SOFTWARE_RASTER_DRIVER_H
+
+#include <cstdint>
+
+#ifdef __linux__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+
+namespace splashkit_lib
+{
+    // Colors and pixels are 0xRRGGBBAA, as in RGBA8888 surfaces
+    struct sk_raster_image
+    {
+        const uint32_t *pixels;
+        int width, height;
+        int pitch;  // in pixels
+    };
+
+    struct sk_raster_target;
+
+    sk_raster_target *sk_create_raster_target(int width, int height);
+    void sk_free_raster_target(sk_raster_target *target);
+
+    bool sk_raster_has_commands(sk_raster_target *target);
+
+    // Limits the commands recorded after this to the clip area, or to the
+    // whole target when clip is nullptr
+    void sk_raster_set_clip(sk_raster_target *target, const SDL_Rect *clip);
+
+    // Drawing blends as SDL_BLENDMODE_BLEND does, apart from clear, which
+    // replaces every pixel and ignores the clip area like SDL_RenderClear
+    void sk_raster_clear(sk_raster_target *target, uint32_t clr);
+    void sk_raster_fill_rect(sk_raster_target *target, uint32_t clr, int x, int y, int w, int h);
+    // Fills a convex polygon of 3 or 4 points, covering the pixels whose
+    // centres it contains
+    void sk_raster_fill_polygon(sk_raster_target *target, uint32_t clr, const double *xs, const double *ys, int count);
+    void sk_raster_fill_ellipse(sk_raster_target *target, uint32_t clr, double cx, double cy, double rx, double ry);
+
+    // Copies the src area of the image onto the dst area, rotated by angle
+    // degrees around the centre (relative to the dst area), as
+    // SDL_RenderCopyEx does with nearest sampling. The image must not change
+    // until the commands are drawn, unless copy is set to record its pixels.
+    void sk_raster_draw_image(sk_raster_target *target, const sk_raster_image &image, const SDL_Rect &src, const SDL_Rect &dst, double angle, double centre_x, double centre_y, bool flip_x, bool flip_y, SDL_Color tint, bool premultiplied, bool copy);
+
+    // Draws the recorded commands onto the target's pixels and forgets them.
+    // Returns the area that changed, which is empty when nothing was drawn.
+    SDL_Rect sk_raster_flush(sk_raster_target *target, uint32_t *pixels, int pitch);
+}
+
+#endif //SPLASHKIT_SOFTWARE_RASTER_DRIVER_H
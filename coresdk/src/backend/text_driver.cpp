@@ -21,26 +21,41 @@
 #include "graphics_driver.h"
 #include "backend_types.h"
 #include "core_driver.h"
+#include "profiling_driver.h"
 #include "utility_functions.h"
 
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <sys/stat.h>
+
+// First line of the system font cache, change it when the format changes
+#define SYSTEM_FONT_CACHE_HEADER "SplashKit system fonts 1"
+
 using std::cerr;
 using std::endl;
 
 namespace splashkit_lib
 {
     /**
-     * @brief Paths to search for system fonts
-     * 
-     * Loaded in 
+     * @brief System font file names mapped to their paths. Each name is also
+     * listed in lower case, so lookups can ignore case.
+     *
+     * Built on first use, from the cache file when the font folders have not
+     * changed since it was written.
      */
-    vector<string> _system_font_paths;
+    static std::unordered_map<string, string> _system_font_index;
+    static std::once_flag _system_font_index_once;
 
     /**
-     * @brief Load the system font paths vector.
-     * 
+     * @brief Load the system font index.
+     *
      * Forward declaration.
      */
-    void load_system_font_paths();
+    void load_system_font_index();
 
     void sk_init_text()
     {
@@ -50,8 +65,6 @@ namespace splashkit_lib
             std::cerr << "Text loading is broken." << std::endl;
             exit(-1);
         }
-
-        load_system_font_paths();
     }
 
     void sk_finalize_text()
@@ -67,6 +80,7 @@ namespace splashkit_lib
         font->id = FONT_PTR;
         font->filename = filename;
         font->was_downloaded = false;
+        font->scalable = false;
 
         sk_add_font_size(font, font_size);
 
@@ -80,8 +94,49 @@ namespace splashkit_lib
         return font;
     }
 
+    // The number of sizes of one font that are kept open at once
+#define SK_FONT_MAX_SIZES 16
+
     /**
-     * Returns the font for the given size. Loads the font size if not loaded.
+     * @brief Close the least recently used sizes of the font.
+     *
+     * Forward declaration.
+     */
+    static void _close_old_font_sizes(sk_font_data *font);
+
+    /**
+     * @brief Counts calls to _get_font, to record when each size was last used.
+     */
+    static unsigned long long _font_use_count = 0;
+
+    /**
+     * Read the font file into memory the first time a size is opened, so
+     * other sizes can be opened without going back to the disk.
+     */
+    static bool _read_font_file(sk_font_data *font)
+    {
+        if ( ! font->_file_data.empty() ) return true;
+
+        std::ifstream file(font->filename, std::ios::binary | std::ios::ate);
+        if ( ! file ) return false;
+
+        std::streamsize size = file.tellg();
+        if ( size <= 0 ) return false;
+
+        font->_file_data.resize(static_cast<size_t>(size));
+        file.seekg(0);
+        if ( ! file.read(font->_file_data.data(), size) )
+        {
+            font->_file_data.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Returns the font for the given size. Loads the font size if not loaded,
+     * closing the least recently used size if too many are open.
      */
     TTF_Font* _get_font(sk_font_data* font, int font_size)
     {
@@ -93,11 +148,25 @@ namespace splashkit_lib
             if (font->_data.count(font_size) > 0)
             {
                 ttf_font = static_cast<TTF_Font *>(font->_data[font_size]);
+                font->_size_used[font_size] = ++_font_use_count;
             }
             else
             {
-                // Load the font for the given size.
-                ttf_font = TTF_OpenFont(font->filename.c_str(), font_size);
+                // The sizes have to match the style of the first one that is open
+                int font_style = font->_data.size() > 0 ? TTF_GetFontStyle(static_cast<TTF_Font*>(font->_data.begin()->second)) : font->_unloaded_style;
+
+                _close_old_font_sizes(font);
+
+                // Load the font for the given size, from memory when the file could be read
+                if ( _read_font_file(font) )
+                {
+                    SDL_RWops *rw = SDL_RWFromConstMem(font->_file_data.data(), static_cast<int>(font->_file_data.size()));
+                    ttf_font = rw ? TTF_OpenFontRW(rw, 1, font_size) : nullptr;
+                }
+                else
+                {
+                    ttf_font = TTF_OpenFont(font->filename.c_str(), font_size);
+                }
 
                 if (!ttf_font)
                 {
@@ -105,13 +174,10 @@ namespace splashkit_lib
                     return nullptr;
                 }
 
-                if (font->_data.size() > 0)
-                {
-                    int font_style = TTF_GetFontStyle(static_cast<TTF_Font*>(font->_data.begin()->second));
-                    TTF_SetFontStyle(ttf_font, font_style);
-                }
+                TTF_SetFontStyle(ttf_font, font_style);
 
                 font->_data[font_size] = ttf_font;
+                font->_size_used[font_size] = ++_font_use_count;
             }
         }
         else
@@ -122,6 +188,614 @@ namespace splashkit_lib
         return ttf_font;
     }
 
+    //
+    // Glyph atlas
+    //
+    // Each font size keeps a surface that glyphs are rendered into the first time
+    // they are drawn. The surface is uploaded to a texture for each renderer, and
+    // text is then drawn as a batch of quads from that texture, so repeated text
+    // does not need to be rasterised again.
+    //
+
+#define SK_GLYPH_ATLAS_SIZE 1024
+#define SK_GLYPH_ATLAS_PADDING 1
+
+// Scalable fonts render glyphs at this size, then scale them for other sizes
+#define SK_SCALABLE_FONT_SIZE 64
+
+    struct sk_glyph_info
+    {
+        SDL_Rect    src;        // Location of the glyph within the atlas
+        int         advance;    // Distance to move the pen after drawing the glyph
+    };
+
+    struct sk_glyph_atlas_texture
+    {
+        SDL_Renderer    *renderer;
+        SDL_Texture     *texture;
+        unsigned int    version;    // The atlas version last uploaded to the texture
+    };
+
+    struct sk_glyph_atlas
+    {
+        SDL_Surface *surface;
+        std::unordered_map<Uint32, sk_glyph_info> glyphs;
+        vector<sk_glyph_atlas_texture> textures;
+
+        // Shelf packing details - glyphs are added left to right along shelves
+        int shelf_x, shelf_y, shelf_h;
+
+        unsigned int version;   // Incremented each time glyphs are added
+        bool full;              // Set once a glyph no longer fits
+    };
+
+    /**
+     * @brief All of the glyph atlases, so textures can be released with their renderer.
+     */
+    static vector<sk_glyph_atlas *> _glyph_atlases;
+
+    sk_glyph_atlas *_create_glyph_atlas()
+    {
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, SK_GLYPH_ATLAS_SIZE, SK_GLYPH_ATLAS_SIZE, 32, SDL_PIXELFORMAT_ARGB8888);
+        if ( ! surface )
+        {
+            cerr << "Unable to create glyph atlas " << SDL_GetError() << endl;
+            return nullptr;
+        }
+
+        sk_glyph_atlas *atlas = new sk_glyph_atlas;
+        atlas->surface = surface;
+        atlas->shelf_x = 0;
+        atlas->shelf_y = 0;
+        atlas->shelf_h = 0;
+        atlas->version = 1;
+        atlas->full = false;
+
+        _glyph_atlases.push_back(atlas);
+        return atlas;
+    }
+
+    void _free_glyph_atlas(sk_glyph_atlas *atlas)
+    {
+        if ( ! atlas ) return;
+
+        for (auto &tex : atlas->textures)
+        {
+            SDL_DestroyTexture(tex.texture);
+        }
+
+        SDL_FreeSurface(atlas->surface);
+        erase_from_vector(_glyph_atlases, atlas);
+        delete atlas;
+    }
+
+    void _free_glyph_atlases(sk_font_data *font)
+    {
+        for (auto const it : font->_atlas)
+        {
+            _free_glyph_atlas(static_cast<sk_glyph_atlas *>(it.second));
+        }
+        font->_atlas.clear();
+    }
+
+    //
+    // Rendered text cache
+    //
+    // Labels drawn with the same font, size and style frame after frame are
+    // kept as a single texture, so drawing them again is one copy. The text is
+    // rendered in white and tinted as it is drawn, so one texture serves every
+    // colour. A string is only rendered the second time it is drawn, so text
+    // that changes every frame keeps using the glyph atlas. Entries that have
+    // not been drawn for a while are freed at the end of each frame.
+    //
+
+#define SK_TEXT_CACHE_MAX_BYTES (16 * 1024 * 1024)
+#define SK_TEXT_CACHE_MAX_ENTRIES 1024
+#define SK_TEXT_CACHE_MAX_AGE 120
+
+    struct sk_text_cache_key
+    {
+        sk_font_data    *font;
+        int             font_size;
+        int             style;
+        SDL_Renderer    *renderer;
+        string          text;
+
+        bool operator==(const sk_text_cache_key &other) const
+        {
+            return font == other.font && font_size == other.font_size && style == other.style
+                && renderer == other.renderer && text == other.text;
+        }
+    };
+
+    struct sk_text_cache_key_hash
+    {
+        size_t operator()(const sk_text_cache_key &key) const
+        {
+            size_t result = std::hash<string>()(key.text);
+            result ^= std::hash<const void *>()(key.font) + 0x9e3779b9 + (result << 6) + (result >> 2);
+            result ^= std::hash<const void *>()(key.renderer) + 0x9e3779b9 + (result << 6) + (result >> 2);
+            result ^= static_cast<size_t>(key.font_size) * 31 + static_cast<size_t>(key.style);
+            return result;
+        }
+    };
+
+    struct sk_text_cache_entry
+    {
+        sk_text_cache_key   key;
+        SDL_Texture         *texture;   // nullptr until the text is drawn a second time
+        int                 w, h;
+        unsigned long long  last_used;  // The frame the text was last drawn
+    };
+
+    typedef std::list<sk_text_cache_entry> sk_text_cache_list;
+
+    /**
+     * @brief The cached text, most recently drawn first, and an index to find it.
+     */
+    static sk_text_cache_list _text_cache;
+    static std::unordered_map<sk_text_cache_key, sk_text_cache_list::iterator, sk_text_cache_key_hash> _text_cache_index;
+    static size_t _text_cache_bytes = 0;
+    static unsigned long long _text_cache_frame = 0;
+
+    static void _erase_cached_text(sk_text_cache_list::iterator it)
+    {
+        if ( it->texture )
+        {
+            SDL_DestroyTexture(it->texture);
+            _text_cache_bytes -= static_cast<size_t>(it->w) * it->h * 4;
+        }
+
+        _text_cache_index.erase(it->key);
+        _text_cache.erase(it);
+    }
+
+    /**
+     * Evict the least recently drawn text until the cache is within its limits.
+     * The most recent entry is always kept, so the text just added can be drawn.
+     */
+    static void _trim_text_cache()
+    {
+        while ( _text_cache.size() > 1 &&
+                ( _text_cache_bytes > SK_TEXT_CACHE_MAX_BYTES || _text_cache.size() > SK_TEXT_CACHE_MAX_ENTRIES ) )
+        {
+            _erase_cached_text(std::prev(_text_cache.end()));
+        }
+    }
+
+    /**
+     * Free the cached text for a font or a renderer, when either is released.
+     */
+    static void _free_cached_text(sk_font_data *font, SDL_Renderer *renderer)
+    {
+        for (auto it = _text_cache.begin(); it != _text_cache.end(); )
+        {
+            auto next = std::next(it);
+            if ( (font && it->key.font == font) || (renderer && it->key.renderer == renderer) )
+            {
+                _erase_cached_text(it);
+            }
+            it = next;
+        }
+    }
+
+    void _sk_text_end_frame()
+    {
+        _text_cache_frame++;
+
+        while ( ! _text_cache.empty() && _text_cache.back().last_used + SK_TEXT_CACHE_MAX_AGE < _text_cache_frame )
+        {
+            _erase_cached_text(std::prev(_text_cache.end()));
+        }
+    }
+
+    /**
+     * Draw the text from the rendered text cache. Returns false if the text is
+     * not cached yet, in which case the caller should draw it another way.
+     */
+    bool _sk_draw_cached_text(sk_drawing_surface *surface, sk_font_data *font, int font_size, TTF_Font *ttf_font, double x, double y, const char *text, SDL_Color sdl_color)
+    {
+        // Bitmaps shared by several windows need a texture per renderer, so
+        // those are left to the glyph atlas
+        if ( ! *text || _sk_renderer_count(surface) != 1 ) return false;
+
+        SDL_Renderer *renderer = _sk_prepared_renderer(surface, 0);
+
+        // Reused between calls so that looking up a label does not allocate
+        static sk_text_cache_key lookup;
+        lookup.font = font;
+        lookup.font_size = font_size;
+        lookup.style = TTF_GetFontStyle(ttf_font);
+        lookup.renderer = renderer;
+        lookup.text.assign(text);
+
+        auto found = _text_cache_index.find(lookup);
+
+        if ( found == _text_cache_index.end() )
+        {
+            // First time this text is drawn - remember it, but leave it to the atlas
+            _text_cache.push_front({ lookup, nullptr, 0, 0, _text_cache_frame });
+            _text_cache_index[lookup] = _text_cache.begin();
+            _trim_text_cache();
+
+            _sk_complete_render(surface, 0);
+            return false;
+        }
+
+        sk_text_cache_list::iterator entry = found->second;
+        entry->last_used = _text_cache_frame;
+        _text_cache.splice(_text_cache.begin(), _text_cache, entry);
+
+        if ( ! entry->texture )
+        {
+            _sk_render_counts.text_rasterizations++;
+            SDL_Surface *text_surface = TTF_RenderUTF8_Blended(ttf_font, text, { 255, 255, 255, 255 });
+            if ( text_surface )
+            {
+                entry->texture = _sk_create_texture_from_surface(renderer, text_surface);
+                entry->w = text_surface->w;
+                entry->h = text_surface->h;
+                SDL_FreeSurface(text_surface);
+            }
+
+            if ( ! entry->texture )
+            {
+                _sk_complete_render(surface, 0);
+                return false;
+            }
+
+            SDL_SetTextureBlendMode(entry->texture, SDL_BLENDMODE_BLEND);
+            _text_cache_bytes += static_cast<size_t>(entry->w) * entry->h * 4;
+            _trim_text_cache();
+        }
+
+        SDL_SetTextureColorMod(entry->texture, sdl_color.r, sdl_color.g, sdl_color.b);
+        SDL_SetTextureAlphaMod(entry->texture, sdl_color.a);
+
+        SDL_Rect rect = { static_cast<int>(x), static_cast<int>(y), entry->w, entry->h };
+        _sk_render_copy(renderer, entry->texture, nullptr, &rect);
+
+        _sk_complete_render(surface, 0);
+        return true;
+    }
+
+    void sk_font_memory(sk_font_data *font, size_t *cpu_bytes, size_t *gpu_bytes)
+    {
+        *cpu_bytes = 0;
+        *gpu_bytes = 0;
+
+        if ( ! font ) return;
+
+        // The file is read once and shared by each open size
+        *cpu_bytes += font->_file_data.capacity();
+
+        // The glyph atlases dominate, each has a surface and a texture per renderer
+        for (auto const it : font->_atlas)
+        {
+            sk_glyph_atlas *atlas = static_cast<sk_glyph_atlas *>(it.second);
+            size_t bytes = static_cast<size_t>(atlas->surface->pitch) * atlas->surface->h;
+
+            *cpu_bytes += bytes;
+            *gpu_bytes += bytes * atlas->textures.size();
+        }
+
+        for (auto const &entry : _text_cache)
+        {
+            if ( entry.key.font == font && entry.texture )
+            {
+                *gpu_bytes += static_cast<size_t>(entry.w) * entry.h * 4;
+            }
+        }
+    }
+
+    //
+    // Text measurement cache
+    //
+    // Interface layout measures the same labels many times each frame, so the
+    // size of each string is remembered for each font size. The sizes are
+    // forgotten when the style changes, and the cache is emptied once it holds
+    // too many strings, so text that keeps changing cannot grow it forever.
+    //
+
+#define SK_TEXT_MEASURE_MAX_ENTRIES 4096
+
+    struct sk_text_measure_cache
+    {
+        int style;      // The font style the sizes were measured with
+        std::unordered_map<string, std::pair<int, int>> sizes;
+    };
+
+    void _free_text_measures(sk_font_data *font)
+    {
+        for (auto const it : font->_measures)
+        {
+            delete static_cast<sk_text_measure_cache *>(it.second);
+        }
+        font->_measures.clear();
+    }
+
+    sk_text_measure_cache *_get_text_measures(sk_font_data *font, int font_size, TTF_Font *ttf_font)
+    {
+        int style = TTF_GetFontStyle(ttf_font);
+        sk_text_measure_cache *cache;
+
+        auto it = font->_measures.find(font_size);
+        if ( it != font->_measures.end() )
+        {
+            cache = static_cast<sk_text_measure_cache *>(it->second);
+        }
+        else
+        {
+            cache = new sk_text_measure_cache;
+            cache->style = style;
+            font->_measures[font_size] = cache;
+        }
+
+        if ( cache->style != style || cache->sizes.size() >= SK_TEXT_MEASURE_MAX_ENTRIES )
+        {
+            cache->sizes.clear();
+            cache->style = style;
+        }
+
+        return cache;
+    }
+
+    /**
+     * Close the least recently used sizes of the font, along with their glyph
+     * atlases and measurements, until there is room to open another size.
+     */
+    static void _close_old_font_sizes(sk_font_data *font)
+    {
+        while ( font->_data.size() >= SK_FONT_MAX_SIZES )
+        {
+            auto oldest = font->_size_used.begin();
+            for (auto it = font->_size_used.begin(); it != font->_size_used.end(); ++it)
+            {
+                if ( it->second < oldest->second ) oldest = it;
+            }
+
+            int font_size = oldest->first;
+            font->_size_used.erase(oldest);
+
+            auto data = font->_data.find(font_size);
+            if ( data->second ) TTF_CloseFont(static_cast<TTF_Font *>(data->second));
+            font->_data.erase(data);
+
+            auto atlas = font->_atlas.find(font_size);
+            if ( atlas != font->_atlas.end() )
+            {
+                _free_glyph_atlas(static_cast<sk_glyph_atlas *>(atlas->second));
+                font->_atlas.erase(atlas);
+            }
+
+            auto measures = font->_measures.find(font_size);
+            if ( measures != font->_measures.end() )
+            {
+                delete static_cast<sk_text_measure_cache *>(measures->second);
+                font->_measures.erase(measures);
+            }
+        }
+    }
+
+    void _sk_release_text_renderer(SDL_Renderer *renderer)
+    {
+        _free_cached_text(nullptr, renderer);
+
+        for (sk_glyph_atlas *atlas : _glyph_atlases)
+        {
+            for (size_t i = 0; i < atlas->textures.size(); i++)
+            {
+                if ( atlas->textures[i].renderer == renderer )
+                {
+                    SDL_DestroyTexture(atlas->textures[i].texture);
+                    atlas->textures.erase(atlas->textures.begin() + static_cast<long>(i));
+                    break;
+                }
+            }
+        }
+    }
+
+    sk_glyph_atlas *_get_glyph_atlas(sk_font_data *font, int font_size)
+    {
+        auto it = font->_atlas.find(font_size);
+        if ( it != font->_atlas.end() ) return static_cast<sk_glyph_atlas *>(it->second);
+
+        sk_glyph_atlas *atlas = _create_glyph_atlas();
+        if ( atlas ) font->_atlas[font_size] = atlas;
+        return atlas;
+    }
+
+    /**
+     * Locate the glyph for code point `ch` in the atlas, rendering it into the
+     * atlas if this is the first time it has been used.
+     */
+    const sk_glyph_info *_atlas_glyph(sk_glyph_atlas *atlas, TTF_Font *ttf_font, Uint32 ch)
+    {
+        auto it = atlas->glyphs.find(ch);
+        if ( it != atlas->glyphs.end() ) return &it->second;
+
+        if ( atlas->full ) return nullptr;
+
+        int minx, maxx, miny, maxy, advance;
+        if ( TTF_GlyphMetrics32(ttf_font, ch, &minx, &maxx, &miny, &maxy, &advance) != 0 ) return nullptr;
+
+        sk_glyph_info info;
+        info.advance = advance;
+        info.src = { 0, 0, 0, 0 };
+
+        _sk_render_counts.text_rasterizations++;
+        SDL_Surface *glyph = TTF_RenderGlyph32_Blended(ttf_font, ch, { 255, 255, 255, 255 });
+
+        // Glyphs like space have nothing to render, but still advance the pen
+        if ( glyph )
+        {
+            // Move to the next shelf if this one is out of room
+            if ( atlas->shelf_x + glyph->w > SK_GLYPH_ATLAS_SIZE )
+            {
+                atlas->shelf_x = 0;
+                atlas->shelf_y += atlas->shelf_h + SK_GLYPH_ATLAS_PADDING;
+                atlas->shelf_h = 0;
+            }
+
+            if ( atlas->shelf_y + glyph->h > SK_GLYPH_ATLAS_SIZE || glyph->w > SK_GLYPH_ATLAS_SIZE )
+            {
+                SDL_FreeSurface(glyph);
+                atlas->full = true;
+                return nullptr;
+            }
+
+            info.src = { atlas->shelf_x, atlas->shelf_y, glyph->w, glyph->h };
+
+            SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);
+            SDL_Rect dst = info.src;
+            SDL_BlitSurface(glyph, nullptr, atlas->surface, &dst);
+            SDL_FreeSurface(glyph);
+
+            atlas->shelf_x += info.src.w + SK_GLYPH_ATLAS_PADDING;
+            atlas->shelf_h = MAX(atlas->shelf_h, info.src.h);
+            atlas->version++;
+        }
+
+        return &(atlas->glyphs[ch] = info);
+    }
+
+    /**
+     * Get the texture for the atlas on the indicated renderer, uploading any
+     * glyphs added since the texture was last used.
+     */
+    SDL_Texture *_atlas_texture(sk_glyph_atlas *atlas, SDL_Renderer *renderer)
+    {
+        sk_glyph_atlas_texture *entry = nullptr;
+
+        for (auto &tex : atlas->textures)
+        {
+            if ( tex.renderer == renderer )
+            {
+                entry = &tex;
+                break;
+            }
+        }
+
+        if ( ! entry )
+        {
+            SDL_Texture *texture = _sk_create_texture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, SK_GLYPH_ATLAS_SIZE, SK_GLYPH_ATLAS_SIZE);
+            if ( ! texture ) return nullptr;
+
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+            atlas->textures.push_back({ renderer, texture, 0 });
+            entry = &atlas->textures.back();
+        }
+
+        if ( entry->version != atlas->version )
+        {
+            _sk_update_texture(entry->texture, nullptr, atlas->surface->pixels, atlas->surface->pitch);
+            entry->version = atlas->version;
+        }
+
+        return entry->texture;
+    }
+
+    /**
+     * Decode the next UTF-8 code point from text, advancing the pointer past it.
+     */
+    Uint32 _next_utf8_code_point(const char *&text)
+    {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(text);
+        Uint32 ch;
+        int extra;
+
+        if ( p[0] < 0x80 )              { ch = p[0]; extra = 0; }
+        else if ( (p[0] & 0xE0) == 0xC0 ) { ch = p[0] & 0x1F; extra = 1; }
+        else if ( (p[0] & 0xF0) == 0xE0 ) { ch = p[0] & 0x0F; extra = 2; }
+        else if ( (p[0] & 0xF8) == 0xF0 ) { ch = p[0] & 0x07; extra = 3; }
+        else                            { text++; return 0xFFFD; }
+
+        text++;
+        for (int i = 0; i < extra; i++)
+        {
+            if ( (static_cast<unsigned char>(*text) & 0xC0) != 0x80 ) return 0xFFFD;
+            ch = (ch << 6) | (static_cast<unsigned char>(*text) & 0x3F);
+            text++;
+        }
+
+        return ch;
+    }
+
+    /**
+     * Draw the text using the glyph atlas for the font size, with the glyphs
+     * scaled by `scale`. Returns false if the text could not be drawn this
+     * way, in which case the caller should render the text directly.
+     */
+    bool _sk_draw_atlas_text(sk_drawing_surface *surface, sk_font_data *font, int font_size, TTF_Font *ttf_font, double x, double y, const char *text, SDL_Color sdl_color, float scale)
+    {
+        sk_glyph_atlas *atlas = _get_glyph_atlas(font, font_size);
+        if ( ! atlas ) return false;
+
+        // Build the quads once, then submit them to each renderer
+        static vector<SDL_Vertex> vertices;
+        static vector<int> indices;
+        vertices.clear();
+        indices.clear();
+
+        float pen_x = static_cast<float>(static_cast<int>(x));
+        float pen_y = static_cast<float>(static_cast<int>(y));
+        Uint32 prev = 0;
+
+        while ( *text )
+        {
+            Uint32 ch = _next_utf8_code_point(text);
+            const sk_glyph_info *glyph = _atlas_glyph(atlas, ttf_font, ch);
+            if ( ! glyph ) return false;
+
+            if ( prev ) pen_x += TTF_GetFontKerningSizeGlyphs32(ttf_font, prev, ch) * scale;
+            prev = ch;
+
+            if ( glyph->src.w > 0 && glyph->src.h > 0 )
+            {
+                float u0 = glyph->src.x / static_cast<float>(SK_GLYPH_ATLAS_SIZE);
+                float v0 = glyph->src.y / static_cast<float>(SK_GLYPH_ATLAS_SIZE);
+                float u1 = (glyph->src.x + glyph->src.w) / static_cast<float>(SK_GLYPH_ATLAS_SIZE);
+                float v1 = (glyph->src.y + glyph->src.h) / static_cast<float>(SK_GLYPH_ATLAS_SIZE);
+
+                float x0 = pen_x, y0 = pen_y;
+                float x1 = pen_x + glyph->src.w * scale, y1 = pen_y + glyph->src.h * scale;
+
+                int base = static_cast<int>(vertices.size());
+                vertices.push_back({ { x0, y0 }, sdl_color, { u0, v0 } });
+                vertices.push_back({ { x1, y0 }, sdl_color, { u1, v0 } });
+                vertices.push_back({ { x1, y1 }, sdl_color, { u1, v1 } });
+                vertices.push_back({ { x0, y1 }, sdl_color, { u0, v1 } });
+
+                indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+            }
+
+            pen_x += glyph->advance * scale;
+        }
+
+        if ( vertices.empty() ) return true;
+
+        unsigned int count = _sk_renderer_count(surface);
+
+        for (unsigned int i = 0; i < count; i++)
+        {
+            SDL_Renderer *renderer = _sk_prepared_renderer(surface, i);
+            SDL_Texture *texture = _atlas_texture(atlas, renderer);
+
+            if ( texture )
+            {
+#if SDL_VERSION_ATLEAST(2, 0, 12)
+                // Smooth the scaled glyphs - unscaled glyphs land on whole pixels either way
+                if ( scale != 1.0f ) SDL_SetTextureScaleMode(texture, SDL_ScaleModeLinear);
+#endif
+                _sk_render_geometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size()));
+            }
+
+            _sk_complete_render(surface, i);
+        }
+
+        return true;
+    }
+
     void sk_add_font_size(sk_font_data *font, int font_size)
     {
         _get_font(font, font_size);
@@ -142,17 +816,35 @@ namespace splashkit_lib
         return false;
     }
 
-    void sk_close_font(sk_font_data* font)
+    void sk_unload_font_data(sk_font_data *font)
     {
-        if (VALID_PTR(font, FONT_PTR))
+        if (INVALID_PTR(font, FONT_PTR)) return;
+
+        if (font->_data.size() > 0)
+            font->_unloaded_style = TTF_GetFontStyle(static_cast<TTF_Font *>(font->_data.begin()->second));
+
+        for (auto const it : font->_data)
         {
-            for (auto const it : font->_data)
+            if (it.second)
             {
-                if (it.second)
-                {
-                    TTF_CloseFont(static_cast<TTF_Font *>(it.second));
-                }
+                TTF_CloseFont(static_cast<TTF_Font *>(it.second));
             }
+        }
+
+        _free_glyph_atlases(font);
+        _free_cached_text(font, nullptr);
+        _free_text_measures(font);
+
+        font->_data.clear();
+        font->_size_used.clear();
+        vector<char>().swap(font->_file_data);
+    }
+
+    void sk_close_font(sk_font_data* font)
+    {
+        if (VALID_PTR(font, FONT_PTR))
+        {
+            sk_unload_font_data(font);
 
             font->name = "";
             font->id = NONE_PTR;
@@ -163,8 +855,44 @@ namespace splashkit_lib
         }
     }
 
+    /**
+     * Scalable fonts measure text at the size their glyphs are drawn from,
+     * and scale the result, so measurements match what is drawn.
+     */
+    static bool _scaled_font_size(sk_font_data *font, int font_size)
+    {
+        return VALID_PTR(font, FONT_PTR) && font->scalable && font_size != SK_SCALABLE_FONT_SIZE;
+    }
+
+    static int _scale_font_metric(int value, int font_size)
+    {
+        return static_cast<int>(value * font_size / static_cast<double>(SK_SCALABLE_FONT_SIZE) + 0.5);
+    }
+
+    void sk_set_font_scalable(sk_font_data* font, bool scalable)
+    {
+        if ( INVALID_PTR(font, FONT_PTR) ) return;
+        if ( font->scalable == scalable ) return;
+
+        font->scalable = scalable;
+
+        // Measurements and rendered text for the other sizes no longer match
+        _free_text_measures(font);
+        _free_cached_text(font, nullptr);
+    }
+
+    bool sk_font_scalable(sk_font_data* font)
+    {
+        return VALID_PTR(font, FONT_PTR) && font->scalable;
+    }
+
     int sk_text_line_skip(sk_font_data* font, int font_size)
     {
+        if ( _scaled_font_size(font, font_size) )
+        {
+            return _scale_font_metric(sk_text_line_skip(font, SK_SCALABLE_FONT_SIZE), font_size);
+        }
+
         TTF_Font* ttf_font = _get_font(font, font_size);
 
         if (ttf_font)
@@ -179,15 +907,44 @@ namespace splashkit_lib
 
     int sk_text_size(sk_font_data* font, int font_size, const string &text, int* w, int* h)
     {
+        return sk_text_size(font, font_size, text.c_str(), text.length(), w, h);
+    }
+
+    int sk_text_size(sk_font_data* font, int font_size, const char *text, size_t len, int* w, int* h)
+    {
+        if ( _scaled_font_size(font, font_size) )
+        {
+            int result = sk_text_size(font, SK_SCALABLE_FONT_SIZE, text, len, w, h);
+            *w = _scale_font_metric(*w, font_size);
+            *h = _scale_font_metric(*h, font_size);
+            return result;
+        }
+
         TTF_Font* ttf_font = _get_font(font, font_size);
 
         if (ttf_font)
         {
-            return TTF_SizeUTF8(ttf_font, text.c_str(), w, h);
+            // Reused between calls so that measuring a known string does not allocate
+            static string key;
+            key.assign(text, len);
+
+            sk_text_measure_cache *cache = _get_text_measures(font, font_size, ttf_font);
+
+            auto it = cache->sizes.find(key);
+            if ( it != cache->sizes.end() )
+            {
+                *w = it->second.first;
+                *h = it->second.second;
+                return 0;
+            }
+
+            int result = TTF_SizeUTF8(ttf_font, key.c_str(), w, h);
+            if ( result == 0 ) cache->sizes.emplace(key, std::make_pair(*w, *h));
+            return result;
         }
         else
         {
-            *w = 8 * (int)text.length();
+            *w = 8 * (int)len;
             *h = 8;
             return 0;
         }
@@ -195,6 +952,11 @@ namespace splashkit_lib
 
     int sk_text_height(sk_font_data* font, int font_size)
     {
+        if ( _scaled_font_size(font, font_size) )
+        {
+            return _scale_font_metric(sk_text_height(font, SK_SCALABLE_FONT_SIZE), font_size);
+        }
+
         TTF_Font* ttf_font = _get_font(font, font_size);
 
         if (ttf_font)
@@ -213,7 +975,18 @@ namespace splashkit_lib
 
         if (ttf_font)
         {
-            TTF_SetFontStyle(ttf_font, style);
+            if ( TTF_GetFontStyle(ttf_font) != style )
+            {
+                TTF_SetFontStyle(ttf_font, style);
+
+                // Glyphs in the atlas were rendered with the old style
+                auto it = font->_atlas.find(font_size);
+                if ( it != font->_atlas.end() )
+                {
+                    _free_glyph_atlas(static_cast<sk_glyph_atlas *>(it->second));
+                    font->_atlas.erase(it);
+                }
+            }
         }
         else
         {
@@ -267,16 +1040,14 @@ namespace splashkit_lib
                       const char * text,
                       sk_color clr)
     {
+        SK_PROFILE_SCOPE("draw text");
+
         if (!font) // draw bitmap based text -- no font
         {
             _sk_draw_bitmap_text(surface, x, y, text, clr);
             return;
         }
 
-        TTF_Font* ttf_font = _get_font(font, font_size);
-
-        if (!ttf_font) return; // error with font
-
         SDL_Surface * text_surface = NULL;
         SDL_Texture * text_texture = NULL;
 
@@ -285,7 +1056,27 @@ namespace splashkit_lib
         sdl_color.g = static_cast<Uint8>(clr.g * 255);
         sdl_color.b = static_cast<Uint8>(clr.b * 255);
         sdl_color.a = static_cast<Uint8>(clr.a * 255);
-        
+
+        // Scalable fonts draw other sizes by scaling the glyphs of one size,
+        // without opening or rendering the requested size
+        if ( _scaled_font_size(font, font_size) )
+        {
+            TTF_Font *scaled_font = _get_font(font, SK_SCALABLE_FONT_SIZE);
+            float scale = font_size / static_cast<float>(SK_SCALABLE_FONT_SIZE);
+
+            if ( scaled_font && _sk_draw_atlas_text(surface, font, SK_SCALABLE_FONT_SIZE, scaled_font, x, y, text, sdl_color, scale) ) return;
+        }
+
+        TTF_Font* ttf_font = _get_font(font, font_size);
+
+        if (!ttf_font) return; // error with font
+
+        // Draw unchanged labels from the text cache, then from the glyph atlas
+        // where possible, falling back to rendering the whole string
+        if ( _sk_draw_cached_text(surface, font, font_size, ttf_font, x, y, text, sdl_color) ) return;
+        if ( _sk_draw_atlas_text(surface, font, font_size, ttf_font, x, y, text, sdl_color, 1.0f) ) return;
+
+        _sk_render_counts.text_rasterizations++;
         text_surface = TTF_RenderUTF8_Blended(static_cast<TTF_Font *>(font->_data[font_size]), text, sdl_color);
         
         if (text_surface == NULL)
@@ -299,7 +1090,7 @@ namespace splashkit_lib
             for (unsigned int i = 0; i < count; i++)
             {
                 SDL_Renderer *renderer = _sk_prepared_renderer(surface, i);
-                text_texture = SDL_CreateTextureFromSurface(renderer, text_surface);
+                text_texture = _sk_create_texture_from_surface(renderer, text_surface);
                 if (text_texture == NULL)
                 {
                     // fail
@@ -312,7 +1103,7 @@ namespace splashkit_lib
                     rect.w = text_surface->w;
                     rect.h = text_surface->h;
                     
-                    SDL_RenderCopy(renderer, text_texture, NULL, &rect);
+                    _sk_render_copy(renderer, text_texture, NULL, &rect);
                     
                     _sk_complete_render(surface, i);
                     
@@ -339,42 +1130,119 @@ namespace splashkit_lib
         return base_fp;
     }
 
-    void load_system_font_paths()
+    static string _system_font_cache_file()
     {
-        _system_font_paths = scan_dir_recursive(system_font_path());
+        return path_from({ path_to_user_home(), ".splashkit" }, "system_fonts.cache");
     }
 
-    string sk_find_system_font_path(string name)
+    static long long _directory_mtime(const string &dir)
     {
-        internal_sk_init();
-        
-        string path, lcpath;
-        for(string dir : _system_font_paths)
-        {
-            path = path_from( { dir }, name);
-            lcpath = path_from( { dir }, to_lower(name));
+        struct stat info;
+        if ( stat(dir.c_str(), &info) != 0 ) return -1;
+        return static_cast<long long>(info.st_mtime);
+    }
 
-            // LOG(TRACE) << "Loading font at system path: " << path;
+    static void _index_system_font(const string &filename, const string &path)
+    {
+        // The first folder scanned wins, as it did when folders were searched in order
+        _system_font_index.emplace(filename, path);
+        _system_font_index.emplace(to_lower(filename), path);
+    }
+
+    // Read the cached index, if every folder it lists is unchanged. Adding or
+    // removing a font, or a folder, updates its folder's modification time.
+    static bool _read_system_font_cache()
+    {
+        std::ifstream in(_system_font_cache_file());
+        string line;
+
+        if ( ! getline(in, line) || line != SYSTEM_FONT_CACHE_HEADER ) return false;
+
+        vector<std::pair<string, string>> fonts;
 
-            if ( file_exists( path ))
+        while ( getline(in, line) )
+        {
+            if ( line.size() < 2 ) return false;
+
+            if ( line[0] == 'D' )
             {
-                return path;
+                size_t sep = line.find(' ', 2);
+                if ( sep == string::npos ) return false;
+
+                long long mtime = std::atoll(line.substr(2, sep - 2).c_str());
+                if ( _directory_mtime(line.substr(sep + 1)) != mtime ) return false;
             }
-            else if ( file_exists( lcpath ))
+            else if ( line[0] == 'F' )
             {
-                return lcpath;
+                size_t sep = line.find('\t', 2);
+                if ( sep == string::npos ) return false;
+                fonts.emplace_back(line.substr(2, sep - 2), line.substr(sep + 1));
             }
+            else
+                return false;
+        }
 
-            if ( file_exists( path + ".ttf" ))
-            {
-                return path + ".ttf";
-            }
-            else if ( file_exists( lcpath + ".ttf" ))
+        for (auto &font : fonts)
+            _index_system_font(font.first, font.second);
+
+        return true;
+    }
+
+    void load_system_font_index()
+    {
+        if ( _read_system_font_cache() ) return;
+
+        vector<string> dirs = scan_dir_recursive(system_font_path());
+        vector<std::pair<string, string>> fonts;
+
+        for (const string &dir : dirs)
+        {
+            std::error_code ec;
+            for (const auto &entry : std::filesystem::directory_iterator(dir, ec))
             {
-                return lcpath + ".ttf";
+                if ( ! entry.is_regular_file(ec) ) continue;
+
+                string filename = entry.path().filename().string();
+                string path = path_from({ dir }, filename);
+
+                fonts.emplace_back(filename, path);
+                _index_system_font(filename, path);
             }
         }
 
+        // Failing to save the cache only means scanning again next time
+        std::error_code ec;
+        std::filesystem::create_directories(path_from({ path_to_user_home(), ".splashkit" }), ec);
+
+        std::ofstream out(_system_font_cache_file(), std::ios::trunc);
+        if ( ! out ) return;
+
+        out << SYSTEM_FONT_CACHE_HEADER << "\n";
+        for (const string &dir : dirs)
+            out << "D " << _directory_mtime(dir) << " " << dir << "\n";
+        for (auto &font : fonts)
+            out << "F " << font.first << "\t" << font.second << "\n";
+    }
+
+    string sk_find_system_font_path(string name)
+    {
+        internal_sk_init();
+
+        std::call_once(_system_font_index_once, load_system_font_index);
+
+        for (const string &candidate : { name, name + ".ttf" })
+        {
+            auto it = _system_font_index.find(candidate);
+            if ( it == _system_font_index.end() ) it = _system_font_index.find(to_lower(candidate));
+
+            if ( it != _system_font_index.end() && file_exists(it->second) )
+                return it->second;
+
+            // Names can include folders within the system font folder
+            if ( candidate.find_first_of("/\\") != string::npos && file_exists(path_from({ system_font_path() }, candidate)) )
+                return path_from({ system_font_path() }, candidate);
+        }
+
         return "";
     }
 }
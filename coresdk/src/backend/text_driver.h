@@ -9,6 +9,9 @@
 #define sgsdl2_SGSDL2Text_h
 
 #include "backend_types.h"
+
+struct SDL_Renderer;
+
 namespace splashkit_lib
 {
     void sk_init_text();
@@ -20,11 +23,18 @@ namespace splashkit_lib
     void sk_add_font_size(sk_font_data *font, int font_size);
     bool sk_contains_valid_font(sk_font_data* font);
     void sk_close_font(sk_font_data* font);
+    // Close every open size and free the glyphs, keeping the font so sizes
+    // can be opened again, in the same style, as they are next used
+    void sk_unload_font_data(sk_font_data *font);
+    void sk_font_memory(sk_font_data *font, size_t *cpu_bytes, size_t *gpu_bytes);
     int sk_text_line_skip(sk_font_data* font, int font_size);
     int sk_text_size(sk_font_data* font, int font_size, const string &text, int* w, int* h);
+    int sk_text_size(sk_font_data* font, int font_size, const char *text, size_t len, int* w, int* h);
     int sk_text_height(sk_font_data* font, int font_size);
     void sk_set_font_style(sk_font_data* font, int font_size, int style);
     int sk_get_font_style(sk_font_data* font, int font_size);
+    void sk_set_font_scalable(sk_font_data* font, bool scalable);
+    bool sk_font_scalable(sk_font_data* font);
     void _sk_draw_bitmap_text( sk_drawing_surface * surface,
                               double x, double y,
                               const char * text,
@@ -38,5 +48,11 @@ namespace splashkit_lib
                       sk_color clr);
     
     string sk_find_system_font_path(string name);
+
+    // Release the glyph atlas textures owned by a renderer that is about to be destroyed
+    void _sk_release_text_renderer(SDL_Renderer *renderer);
+
+    // Age the rendered text cache, called once each time a window is refreshed
+    void _sk_text_end_frame();
 }
 #endif /* defined(__sgsdl2__SGSDL2Text__) */
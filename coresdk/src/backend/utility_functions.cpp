@@ -9,6 +9,9 @@
 #include "utility_functions.h"
 
 #include "camera.h"
+#include "animations.h"
+#include "images.h"
+#include "resource_tracking.h"
 
 #include <sys/stat.h>
 #include <iostream>
@@ -17,6 +20,8 @@
 #include <algorithm>
 
 #include <cstdlib>
+#include <cstring>
+#include <charconv>
 
 #include <unistd.h>
 #include <sys/types.h>
@@ -56,6 +61,14 @@ namespace splashkit_lib
         return (stat (path.c_str(), &buffer) == 0) and ( (buffer.st_mode & S_IFDIR) != 0);
     }
 
+    bool same_file(const string &path1, const string &path2)
+    {
+        if ( path1 == path2 ) return file_exists(path1);
+
+        std::error_code ec;
+        return std::filesystem::equivalent(path1, path2, ec);
+    }
+
     string directory_of(const string filename)
     {
         size_t found;
@@ -226,6 +239,9 @@ namespace splashkit_lib
         else if (id == BITMAP_PTR)
         {
             b = to_bitmap_ptr(p);
+
+            // Drawing onto an evicted bitmap needs its image back first
+            _resource_used(b);
             return &b->image.surface;
         }
         else
@@ -255,7 +271,50 @@ namespace splashkit_lib
         y = to_screen_y(y);
     }
 
-    string extract_delimited(int index, string value, char delimiter)
+    // Work out the area of the bitmap to draw, and how to flip it, from the options
+    void bitmap_source_and_flip(bitmap bmp, const drawing_options &opts, double src_data[4], sk_renderer_flip &flip)
+    {
+        if ( VALID_PTR(opts.anim, ANIMATION_PTR) || opts.draw_cell >= 0 )
+        {
+            int cell;
+            if ( opts.draw_cell >= 0 )
+                cell = opts.draw_cell;
+            else
+                cell = animation_current_cell(opts.anim);
+            
+            rectangle part = bitmap_rectangle_of_cell(bmp, cell);
+            src_data[0] = part.x;
+            src_data[1] = part.y;
+            src_data[2] = part.width;
+            src_data[3] = part.height;
+        }
+        else if (opts.is_part)
+        {
+            src_data[0] = opts.part.x;
+            src_data[1] = opts.part.y;
+            src_data[2] = opts.part.width;
+            src_data[3] = opts.part.height;
+        }
+        else
+        {
+            src_data[0] = 0;
+            src_data[1] = 0;
+            src_data[2] = bmp->image.surface.width;
+            src_data[3] = bmp->image.surface.height;
+        }
+
+        //
+        if ((opts.flip_x) and (opts.flip_y))
+            flip = sk_FLIP_BOTH;
+        else if (opts.flip_x)
+            flip = sk_FLIP_VERTICAL;
+        else if (opts.flip_y)
+            flip = sk_FLIP_HORIZONTAL;
+        else
+            flip = sk_FLIP_NONE;
+    }
+
+    string extract_delimited(int index, const string &value, char delimiter)
     {
         int at_index = 1; // 1 based
         int i;
@@ -282,7 +341,7 @@ namespace splashkit_lib
         return result;
     }
 
-    string extract_delimited_with_ranges(int index, string value)
+    string extract_delimited_with_ranges(int index, const string &value)
     {
         int i, count, start;
         bool in_range;
@@ -325,14 +384,14 @@ namespace splashkit_lib
         return result;
     }
 
-    int count_delimiter(string value, char delimiter)
+    int count_delimiter(const string &value, char delimiter)
     {
         int count = 0;
         for_each(value.begin(), value.end(), [&](char ch){if(ch == delimiter) count++;});
         return count;
     }
 
-    int count_delimiter_with_ranges(string value, char delimiter)
+    int count_delimiter_with_ranges(const string &value, char delimiter)
     {
         int i;
         bool in_range = false;
@@ -351,30 +410,130 @@ namespace splashkit_lib
         return result;
     }
 
-    bool try_str_to_int(string str, int &result)
+    void split_delimited(string_view value, char delimiter, vector<string_view> &out_fields)
     {
-        char temp;  //used to check nothing comes after the int
-
-        // scan the string, looking for a number ... followed by nothing
-        // sscanf = string scan format
-        //          This will "scan" the array of character in line.str (reads this)
-        //          " " = skip any spaces
-        //          "%d" = read an integer
-        //          " " = skip any spaces
-        //          "%c" = read a character
-        // sscanf returns the number of things it read (0 to 2 in this case)
-        //          Loop while this is not equal to 1
-        //          0 = did not read a number at the start
-        //          1 = read a number, but no character followed it
-        //          2 = read a number and a character... like "1 fred" (1 is the number, f is the character)
-        if ( sscanf(str.c_str(), " %d %c", &result, &temp) != 1 )
+        out_fields.clear();
+
+        size_t start = 0;
+        for (size_t i = 0; i < value.size(); i++)
         {
-            return false;
+            if (value[i] == delimiter)
+            {
+                out_fields.push_back(value.substr(start, i - start));
+                start = i + 1;
+            }
         }
+        out_fields.push_back(value.substr(start));
+    }
+
+    void split_delimited_with_ranges(string_view value, char delimiter, vector<string_view> &out_fields)
+    {
+        bool in_range = false;
+
+        out_fields.clear();
 
+        size_t start = 0;
+        for (size_t i = 0; i < value.size(); i++)
+        {
+            if ((not in_range) and (value[i] == delimiter))
+            {
+                out_fields.push_back(value.substr(start, i - start));
+                start = i + 1;
+            }
+            else if ((in_range) and (value[i] == ']'))
+                in_range = false;
+            else if ((not in_range) and (value[i] == '['))
+                in_range = true;
+        }
+        out_fields.push_back(value.substr(start));
+    }
+
+    string field_at(const vector<string_view> &fields, int index)
+    {
+        if (index < 1 || index > static_cast<int>(fields.size())) return string();
+        return string(fields[index - 1]);
+    }
+
+    string_view trim_view(string_view value)
+    {
+        const char *whitespace = " \t\n\v\f\r";
+
+        size_t start = value.find_first_not_of(whitespace);
+        if (start == string_view::npos) return string_view();
+
+        size_t end = value.find_last_not_of(whitespace);
+        return value.substr(start, end - start + 1);
+    }
+
+    // from_chars does not skip white space or accept a leading +, which the
+    // scanf based parsing did, so these are removed first
+    static string_view _number_text(string_view value)
+    {
+        value = trim_view(value);
+        if ( value.size() > 1 && value[0] == '+' && value[1] != '-' ) value.remove_prefix(1);
+        return value;
+    }
+
+    bool parse_int(string_view value, int &result)
+    {
+        value = _number_text(value);
+        if ( value.empty() ) return false;
+
+        int parsed;
+        auto res = std::from_chars(value.data(), value.data() + value.size(), parsed);
+        if ( res.ec != std::errc() || res.ptr != value.data() + value.size() ) return false;
+
+        result = parsed;
+        return true;
+    }
+
+    bool parse_double(string_view value, double &result)
+    {
+        value = _number_text(value);
+        if ( value.empty() ) return false;
+
+        double parsed;
+#if defined(__cpp_lib_to_chars)
+        // strtod and scanf also read hexadecimal, such as 0x1A, which
+        // from_chars only reads without the sign and 0x
+        bool negative = value[0] == '-';
+        string_view digits = negative ? value.substr(1) : value;
+
+        if ( digits.size() > 2 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X') )
+        {
+            digits.remove_prefix(2);
+            if ( digits[0] == '-' || digits[0] == '+' ) return false;
+
+            auto res = std::from_chars(digits.data(), digits.data() + digits.size(), parsed, std::chars_format::hex);
+            if ( res.ec != std::errc() || res.ptr != digits.data() + digits.size() ) return false;
+            if ( negative ) parsed = -parsed;
+        }
+        else
+        {
+            auto res = std::from_chars(value.data(), value.data() + value.size(), parsed);
+            if ( res.ec != std::errc() || res.ptr != value.data() + value.size() ) return false;
+        }
+#else
+        // without floating point from_chars, strtod needs a terminated copy
+        char buffer[64];
+        if ( value.size() >= sizeof(buffer) ) return false;
+        memcpy(buffer, value.data(), value.size());
+        buffer[value.size()] = '\0';
+
+        char *end;
+        parsed = strtod(buffer, &end);
+        if ( end != buffer + value.size() ) return false;
+#endif
+
+        result = parsed;
         return true;
     }
 
+    bool try_str_to_int(string str, int &result)
+    {
+        return parse_int(str, result);
+    }
+
     int str_to_int(string str, bool allow_empty, int empty_value)
     {
         int result;
@@ -401,25 +560,10 @@ namespace splashkit_lib
 
     bool try_str_to_float(string str, float &result)
     {
-        char temp;  //used to check nothing comes after the int
-
-        // scan the string, looking for a number ... followed by nothing
-        // sscanf = string scan format
-        //          This will "scan" the array of character in line.str (reads this)
-        //          " " = skip any spaces
-        //          "%d" = read an integer
-        //          " " = skip any spaces
-        //          "%c" = read a character
-        // sscanf returns the number of things it read (0 to 2 in this case)
-        //          Loop while this is not equal to 1
-        //          0 = did not read a number at the start
-        //          1 = read a number, but no character followed it
-        //          2 = read a number and a character... like "1 fred" (1 is the number, f is the character)
-        if ( sscanf(str.c_str(), " %f %c", &result, &temp) != 1 )
-        {
-            return false;
-        }
+        double value;
+        if ( ! parse_double(str, value) ) return false;
 
+        result = static_cast<float>(value);
         return true;
     }
 
@@ -449,26 +593,7 @@ namespace splashkit_lib
 
     bool try_str_to_double(string str, double &result)
     {
-        char temp;  //used to check nothing comes after the int
-
-        // scan the string, looking for a number ... followed by nothing
-        // sscanf = string scan format
-        //          This will "scan" the array of character in line.str (reads this)
-        //          " " = skip any spaces
-        //          "%d" = read an integer
-        //          " " = skip any spaces
-        //          "%c" = read a character
-        // sscanf returns the number of things it read (0 to 2 in this case)
-        //          Loop while this is not equal to 1
-        //          0 = did not read a number at the start
-        //          1 = read a number, but no character followed it
-        //          2 = read a number and a character... like "1 fred" (1 is the number, f is the character)
-        if ( sscanf(str.c_str(), " %lf %c", &result, &temp) != 1 )
-        {
-            return false;
-        }
-
-        return true;
+        return parse_double(str, result);
     }
 
     double str_to_double(string str, bool allow_empty, double empty_value)
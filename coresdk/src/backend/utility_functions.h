@@ -12,12 +12,15 @@
 #include "backend_types.h"
 
 #include <string>
+#include <string_view>
+#include <vector>
 #include <initializer_list>
 #include <algorithm>
 
 #include <easylogging++.h>
 
 using std::string;
+using std::string_view;
 
 namespace splashkit_lib
 {
@@ -30,8 +33,26 @@ namespace splashkit_lib
 
     bool directory_exists(string path);
 
-#define VALID_PTR(p,pkind) ( (p) and p->id == pkind )
-#define INVALID_PTR(p,pkind) ( not VALID_PTR(p,pkind) )
+    // True if both paths name the same existing file, however they are written
+    bool same_file(const string &path1, const string &path2);
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SK_UNLIKELY(x) ( __builtin_expect(!!(x), 0) )
+#else
+#define SK_UNLIKELY(x) ( x )
+#endif
+
+// Invalid handles are unusual, so their warnings are laid out away from the
+// accessors' hot path. SK_UNCHECKED_HANDLES builds only check for null
+// handles, skipping the read of the pointer kind. Code that tells kinds of
+// handle apart uses HAS_PTR_KIND, which always reads the kind.
+#define HAS_PTR_KIND(p,pkind) ( (p) and p->id == pkind )
+#ifdef SK_UNCHECKED_HANDLES
+#define VALID_PTR(p,pkind) ( (p) != nullptr )
+#else
+#define VALID_PTR(p,pkind) HAS_PTR_KIND(p,pkind)
+#endif
+#define INVALID_PTR(p,pkind) ( SK_UNLIKELY( not VALID_PTR(p,pkind) ) )
 
 #define ASSIGNED(ptr) ( ptr != nullptr )
 
@@ -98,7 +119,7 @@ size_t sz = collection.size();\
 for(size_t i = 0; i < sz; i++)\
 {\
 auto resource = collection.begin()->second;\
-if (VALID_PTR(resource, ptr_kind))\
+if (HAS_PTR_KIND(resource, ptr_kind))\
 {\
 fn(resource);\
 }\
@@ -114,7 +135,7 @@ size_t sz = collection.size();\
 for(size_t i = 0; i < sz; i++)\
 {\
 auto resource = *collection.begin();\
-if (VALID_PTR(resource, ptr_kind))\
+if (HAS_PTR_KIND(resource, ptr_kind))\
 {\
 fn(resource);\
 }\
@@ -169,13 +190,32 @@ collection.erase(collection.begin());\
     sk_drawing_surface *to_surface_ptr(void *p);
     void xy_from_opts(const drawing_options &opts, double &x, double &y);
 
+    // Work out the area of the bitmap to draw, and how to flip it, from the options
+    void bitmap_source_and_flip(bitmap bmp, const drawing_options &opts, double src_data[4], sk_renderer_flip &flip);
+
     void process_range(string value_in, vector<int> &result);
 
-    string extract_delimited(int index, string value, char delim);
-    string extract_delimited_with_ranges(int index, string value);
+    string extract_delimited(int index, const string &value, char delim);
+    string extract_delimited_with_ranges(int index, const string &value);
+
+    int count_delimiter(const string &value, char delimiter);
+    int count_delimiter_with_ranges(const string &value, char delimiter);
+
+    // Splits the value into all of its fields in one pass. The fields refer
+    // to the characters in value, which must outlive them.
+    void split_delimited(string_view value, char delimiter, std::vector<string_view> &out_fields);
+    // As split_delimited, but delimiters within [ ] ranges do not split
+    void split_delimited_with_ranges(string_view value, char delimiter, std::vector<string_view> &out_fields);
+    // The field at the 1 based index, or an empty field when there are fewer fields
+    string field_at(const std::vector<string_view> &fields, int index);
+
+    string_view trim_view(string_view value);
 
-    int count_delimiter(string value, char delimiter);
-    int count_delimiter_with_ranges(string value, char delimiter);
+    // Parse all of value as a number, without exceptions or the locale.
+    // Leading and trailing white space is ignored. As with strtod, doubles
+    // may be written in hexadecimal, such as 0x1A.
+    bool parse_int(string_view value, int &result);
+    bool parse_double(string_view value, double &result);
 
     int str_to_int(string str, bool allow_empty = true, int empty_value = 0);
     float str_to_float(string str, bool allow_empty = true, float empty_value = 0.0f);
@@ -9,6 +9,11 @@
 #include "core_driver.h"
 #include "utils_driver.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
 #ifdef __linux__
 #include <SDL2/SDL.h>
 #else
@@ -16,6 +21,10 @@
 #endif
 namespace splashkit_lib
 {
+    static std::mutex _activity_lock;
+    static std::condition_variable _activity_signal;
+    static std::atomic<unsigned long long> _activity_count(0);
+
     void sk_delay(unsigned int ms)
     {
         SDL_Delay(ms);
@@ -26,4 +35,42 @@ namespace splashkit_lib
         //ok without SDL init... and called on load
         return SDL_GetTicks();
     }
-}
\ No newline at end of file
+
+    static std::chrono::steady_clock::time_point _ticks_origin()
+    {
+        static const auto origin = std::chrono::steady_clock::now();
+        return origin;
+    }
+
+    // read the origin as the library loads, so ticks count from program start
+    // rather than from the first call
+    static const std::chrono::steady_clock::time_point _ticks_origin_at_load = _ticks_origin();
+
+    long long sk_get_ticks_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _ticks_origin()).count();
+    }
+
+    void sk_signal_activity()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_activity_lock);
+            _activity_count++;
+        }
+        _activity_signal.notify_all();
+    }
+
+    unsigned long long sk_activity_count()
+    {
+        return _activity_count.load();
+    }
+
+    bool sk_wait_for_activity(unsigned long long seen, int timeout_ms)
+    {
+        std::unique_lock<std::mutex> lock(_activity_lock);
+        return _activity_signal.wait_for(lock, std::chrono::milliseconds(timeout_ms < 0 ? 0 : timeout_ms), [seen]
+        {
+            return _activity_count.load() != seen;
+        });
+    }
+}
@@ -11,5 +11,15 @@ namespace splashkit_lib
 {
     void sk_delay(unsigned int ms);
     unsigned int sk_get_ticks();
+
+    // Nanoseconds since the library was loaded, from a monotonic clock, this
+    // does not wrap
+    long long sk_get_ticks_ns();
+
+    // Activity signalling, so an idle wait can wake as soon as work arrives
+    // from another thread. Waits return true if the count moved past `seen`.
+    void sk_signal_activity();
+    unsigned long long sk_activity_count();
+    bool sk_wait_for_activity(unsigned long long seen, int timeout_ms);
 }
 #endif /* defined(__sk__Utils__) */
@@ -8,6 +8,7 @@
 
 #include "web_driver.h"
 #include "core_driver.h"
+#include "utils_driver.h"
 #include "easylogging++.h"
 #include "utility_functions.h"
 
@@ -16,13 +17,77 @@
 #include <string.h>
 
 #include <curl/curl.h>
+
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
 namespace splashkit_lib
 {
-    struct request_stream
+    //
+    // Easy handles are kept in a pool once a request is done, so their
+    // connections stay open for the next request to the same host. All
+    // handles share one DNS, connection and TLS session cache.
+    //
+    #define CURL_POOL_SIZE 8
+
+    static CURLSH *_curl_share = nullptr;
+    static std::mutex _curl_share_locks[CURL_LOCK_DATA_LAST];
+    static std::vector<CURL *> _curl_pool;
+    static std::mutex _curl_pool_lock;
+
+    // Drives all of the asynchronous requests at once
+    static CURLM *_curl_multi = nullptr;
+    static int _curl_multi_active = 0;
+
+    static void _lock_curl_share(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr)
     {
-        char *body;
-        unsigned long at;
-    };
+        _curl_share_locks[data].lock();
+    }
+
+    static void _unlock_curl_share(CURL *handle, curl_lock_data data, void *userptr)
+    {
+        _curl_share_locks[data].unlock();
+    }
+
+    CURL *_acquire_curl()
+    {
+        CURL *result = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(_curl_pool_lock);
+            if ( ! _curl_pool.empty() )
+            {
+                result = _curl_pool.back();
+                _curl_pool.pop_back();
+            }
+        }
+
+        if ( result )
+            curl_easy_reset(result); // clears the options, but keeps the connections
+        else
+            result = curl_easy_init();
+
+        if ( result && _curl_share )
+            curl_easy_setopt(result, CURLOPT_SHARE, _curl_share);
+
+        return result;
+    }
+
+    void _release_curl(CURL *curl_handle)
+    {
+        if ( ! curl_handle ) return;
+
+        std::lock_guard<std::mutex> lock(_curl_pool_lock);
+        if ( _curl_pool.size() < CURL_POOL_SIZE )
+            _curl_pool.push_back(curl_handle);
+        else
+            curl_easy_cleanup(curl_handle);
+    }
 
     static size_t write_memory_callback(void *contents, size_t size, size_t nmemb, void *userp)
     {
@@ -80,10 +145,45 @@ namespace splashkit_lib
     void sk_init_web()
     {
         curl_global_init(CURL_GLOBAL_ALL);
+
+        _curl_share = curl_share_init();
+        if ( _curl_share )
+        {
+            curl_share_setopt(_curl_share, CURLSHOPT_LOCKFUNC, _lock_curl_share);
+            curl_share_setopt(_curl_share, CURLSHOPT_UNLOCKFUNC, _unlock_curl_share);
+            curl_share_setopt(_curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(_curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+            curl_share_setopt(_curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+        }
     }
 
     void sk_finalise_web()
     {
+        {
+            std::lock_guard<std::mutex> lock(_curl_pool_lock);
+            for (CURL *curl_handle : _curl_pool)
+            {
+                curl_easy_cleanup(curl_handle);
+            }
+            _curl_pool.clear();
+        }
+
+        if ( _curl_multi )
+        {
+            curl_multi_cleanup(_curl_multi);
+            _curl_multi = nullptr;
+        }
+
+        sk_http_disable_cache();
+
+        if ( _curl_share )
+        {
+            curl_share_cleanup(_curl_share);
+            _curl_share = nullptr;
+        }
+
         curl_global_cleanup();
     }
 
@@ -142,6 +242,8 @@ namespace splashkit_lib
         if(res != CURLE_OK)
         {
             LOG(ERROR) << curl_easy_strerror(res);
+            _release_curl(curl_handle);
+            free(data.body);
             return nullptr;
         }
 
@@ -160,8 +262,8 @@ namespace splashkit_lib
         else
             result->content_type = "";
 
-        /* cleanup curl stuff */
-        curl_easy_cleanup(curl_handle);
+        /* return the handle, and its open connection, to the pool */
+        _release_curl(curl_handle);
 
         result->message = data.body;
         result->message_size = data.at;
@@ -173,7 +275,7 @@ namespace splashkit_lib
         request_stream data_read = { nullptr, 0 };
 
         // init the curl session
-        CURL *curl_handle = curl_easy_init();;
+        CURL *curl_handle = _acquire_curl();
         CURLcode res;
 
         _init_curl(curl_handle, host, port);
@@ -189,29 +291,359 @@ namespace splashkit_lib
         return _create_response(curl_handle, res, data_read);
     }
 
-    sk_http_response *sk_http_get(const string &host, unsigned short port)
+    // Keeps the header lines of the final response, dropping those of any redirects
+    static size_t _collect_header(char *buffer, size_t size, size_t nitems, void *userdata)
+    {
+        size_t realsize = size * nitems;
+        vector<string> *headers = static_cast<vector<string> *>(userdata);
+
+        string line(buffer, realsize);
+        while ( ! line.empty() && (line.back() == '\r' || line.back() == '\n') ) line.pop_back();
+
+        if ( line.compare(0, 5, "HTTP/") == 0 )
+            headers->clear();
+        else if ( ! line.empty() )
+            headers->push_back(line);
+
+        return realsize;
+    }
+
+    static sk_http_response *_http_get(const string &host, unsigned short port, const vector<string> &request_headers, vector<string> *response_headers)
     {
         request_stream data_read = { nullptr, 0 };
 
         // init the curl session
-        CURL *curl_handle = curl_easy_init();;
+        CURL *curl_handle = _acquire_curl();
         CURLcode res;
 
         _init_curl(curl_handle, host, port);
         _setup_curl_download(curl_handle, &data_read);
 
+        struct curl_slist *list = NULL;
+        for (const string &header : request_headers)
+        {
+            list = curl_slist_append(list, header.c_str());
+        }
+        if ( list ) curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, list);
+
+        if ( response_headers )
+        {
+            curl_easy_setopt(curl_handle, CURLOPT_HEADERFUNCTION, _collect_header);
+            curl_easy_setopt(curl_handle, CURLOPT_HEADERDATA, (void *)response_headers);
+        }
+
         // get it!
         res = curl_easy_perform(curl_handle);
 
+        curl_slist_free_all(list);
+
         return _create_response(curl_handle, res, data_read);
     }
 
+    //
+    // The get response cache. Responses are kept with their validators,
+    // and fresh ones are returned without a request. Stale ones are checked
+    // with If-None-Match or If-Modified-Since, so an unchanged response
+    // costs a 304 with no body. With a directory, entries are also written
+    // to disk and found there in later runs.
+    //
+    #define HTTP_CACHE_MEMORY_LIMIT (16 * 1024 * 1024)
+
+    struct _http_cache_entry
+    {
+        string      url;
+        long        status;
+        string      content_type;
+        string      etag;
+        string      last_modified;
+        time_t      stored;
+        long long   lifetime;       // seconds it is fresh for once stored, 0 to check it each time
+        string      body;
+        time_t      last_used;
+    };
+
+    static bool _http_cache_enabled = false;
+    static string _http_cache_directory;
+    static std::map<string, _http_cache_entry> _http_cache;
+    static size_t _http_cache_bytes = 0;
+    static std::mutex _http_cache_lock;
+
+    static string _header_value(const vector<string> &headers, const string &name)
+    {
+        for (const string &header : headers)
+        {
+            size_t colon = header.find(':');
+            if ( colon == string::npos || to_lower(trim(header.substr(0, colon))) != name ) continue;
+            return trim(header.substr(colon + 1));
+        }
+        return "";
+    }
+
+    // Works out how long a response stays fresh, returning false if it must not be stored
+    static bool _cache_lifetime(const vector<string> &headers, long long &out_lifetime)
+    {
+        string cache_control = to_lower(_header_value(headers, "cache-control"));
+        out_lifetime = -1;
+
+        size_t start = 0;
+        while ( start < cache_control.size() )
+        {
+            size_t end = cache_control.find(',', start);
+            if ( end == string::npos ) end = cache_control.size();
+            string directive = trim(cache_control.substr(start, end - start));
+            start = end + 1;
+
+            if ( directive == "no-store" ) return false;
+            if ( directive == "no-cache" ) out_lifetime = 0;
+            else if ( directive.compare(0, 8, "max-age=") == 0 && out_lifetime != 0 )
+                out_lifetime = atoll(directive.c_str() + 8);
+        }
+
+        if ( out_lifetime < 0 )
+        {
+            string expires = _header_value(headers, "expires");
+            time_t when = expires.empty() ? -1 : curl_getdate(expires.c_str(), nullptr);
+            out_lifetime = when > 0 ? std::max(0LL, static_cast<long long>(when - time(nullptr))) : 0;
+        }
+
+        // time already spent in caches along the way
+        long long age = atoll(_header_value(headers, "age").c_str());
+        out_lifetime = std::max(0LL, out_lifetime - age);
+        return true;
+    }
+
+    static string _cache_path(const string &url)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.cache", static_cast<unsigned long long>(std::hash<string>()(url)));
+        return _http_cache_directory + "/" + name;
+    }
+
+    static void _save_cache_entry(const _http_cache_entry &entry)
+    {
+        if ( _http_cache_directory.empty() ) return;
+
+        std::ofstream out(_cache_path(entry.url), std::ios::binary | std::ios::trunc);
+        out << entry.url << '\n' << entry.status << '\n' << entry.content_type << '\n'
+            << entry.etag << '\n' << entry.last_modified << '\n'
+            << static_cast<long long>(entry.stored) << '\n' << entry.lifetime << '\n'
+            << entry.body.size() << '\n';
+        out.write(entry.body.data(), static_cast<std::streamsize>(entry.body.size()));
+    }
+
+    static bool _load_cache_entry(const string &url, _http_cache_entry &out_entry)
+    {
+        if ( _http_cache_directory.empty() ) return false;
+
+        std::ifstream in(_cache_path(url), std::ios::binary);
+        if ( ! in ) return false;
+
+        string line;
+        long long stored = 0;
+        size_t size = 0;
+
+        getline(in, out_entry.url);
+        if ( out_entry.url != url ) return false; // a different url with the same hash
+
+        getline(in, line); out_entry.status = atol(line.c_str());
+        getline(in, out_entry.content_type);
+        getline(in, out_entry.etag);
+        getline(in, out_entry.last_modified);
+        in >> stored >> out_entry.lifetime >> size;
+        in.get();
+
+        out_entry.body.resize(size);
+        in.read(&out_entry.body[0], static_cast<std::streamsize>(size));
+        if ( ! in ) return false;
+
+        out_entry.stored = static_cast<time_t>(stored);
+        return true;
+    }
+
+    static void _remember_cache_entry(const _http_cache_entry &entry)
+    {
+        auto it = _http_cache.find(entry.url);
+        if ( it != _http_cache.end() )
+        {
+            _http_cache_bytes -= it->second.body.size();
+            _http_cache.erase(it);
+        }
+
+        // larger responses than the limit are only kept on disk
+        if ( entry.body.size() > HTTP_CACHE_MEMORY_LIMIT ) return;
+
+        while ( _http_cache_bytes + entry.body.size() > HTTP_CACHE_MEMORY_LIMIT && ! _http_cache.empty() )
+        {
+            auto oldest = _http_cache.begin();
+            for (auto e = _http_cache.begin(); e != _http_cache.end(); ++e)
+            {
+                if ( e->second.last_used < oldest->second.last_used ) oldest = e;
+            }
+            _http_cache_bytes -= oldest->second.body.size();
+            _http_cache.erase(oldest);
+        }
+
+        _http_cache_bytes += entry.body.size();
+        _http_cache[entry.url] = entry;
+    }
+
+    static sk_http_response *_response_from_cache(const _http_cache_entry &entry)
+    {
+        sk_http_response *result = new sk_http_response;
+        result->id = HTTP_RESPONSE_PTR;
+        result->code = static_cast<http_status_code>(entry.status);
+        result->content_type = entry.content_type;
+
+        result->message = static_cast<char *>(malloc(entry.body.size() + 1));
+        memcpy(result->message, entry.body.data(), entry.body.size());
+        result->message[entry.body.size()] = 0;
+        result->message_size = entry.body.size();
+        return result;
+    }
+
+    static sk_http_response *_cached_http_get(const string &host, unsigned short port)
+    {
+        string url = host + ":" + std::to_string(port);
+        time_t now = time(nullptr);
+
+        _http_cache_entry entry;
+        bool found;
+        vector<string> request_headers;
+
+        {
+            std::lock_guard<std::mutex> lock(_http_cache_lock);
+
+            auto it = _http_cache.find(url);
+            found = it != _http_cache.end();
+            if ( found )
+                entry = it->second;
+            else if ( (found = _load_cache_entry(url, entry)) )
+                _remember_cache_entry(entry);
+
+            if ( found && entry.lifetime > 0 && now - entry.stored < entry.lifetime )
+            {
+                _http_cache[url].last_used = now;
+                return _response_from_cache(entry);
+            }
+        }
+
+        if ( found && ! entry.etag.empty() ) request_headers.push_back("If-None-Match: " + entry.etag);
+        if ( found && ! entry.last_modified.empty() ) request_headers.push_back("If-Modified-Since: " + entry.last_modified);
+
+        vector<string> response_headers;
+        sk_http_response *response = _http_get(host, port, request_headers, &response_headers);
+        long long lifetime;
+
+        if ( ! response )
+        {
+            // a stale copy is better than nothing when the network is down
+            if ( ! found ) return nullptr;
+            LOG(WARNING) << "Using the cached response to " << host << " as the request failed";
+            return _response_from_cache(entry);
+        }
+
+        if ( found && response->code == HTTP_STATUS_NOT_MODIFIED )
+        {
+            free(response->message);
+            response->message = nullptr;
+            delete response;
+
+            // the 304 can update how long the stored response stays fresh
+            if ( _cache_lifetime(response_headers, lifetime) ) entry.lifetime = lifetime;
+            entry.stored = now;
+            entry.last_used = now;
+
+            std::lock_guard<std::mutex> lock(_http_cache_lock);
+            _remember_cache_entry(entry);
+            _save_cache_entry(entry);
+            return _response_from_cache(entry);
+        }
+
+        if ( response->code != HTTP_STATUS_OK || ! _cache_lifetime(response_headers, lifetime) ) return response;
+
+        entry.etag = _header_value(response_headers, "etag");
+        entry.last_modified = _header_value(response_headers, "last-modified");
+
+        // without validators a response can only be used while it is fresh
+        if ( lifetime == 0 && entry.etag.empty() && entry.last_modified.empty() ) return response;
+
+        entry.url = url;
+        entry.status = response->code;
+        entry.content_type = response->content_type;
+        entry.stored = now;
+        entry.last_used = now;
+        entry.lifetime = lifetime;
+        entry.body.assign(response->message ? response->message : "", response->message_size);
+
+        std::lock_guard<std::mutex> lock(_http_cache_lock);
+        _remember_cache_entry(entry);
+        _save_cache_entry(entry);
+        return response;
+    }
+
+    void sk_http_enable_cache(const string &directory)
+    {
+        std::lock_guard<std::mutex> lock(_http_cache_lock);
+
+        _http_cache_enabled = true;
+        _http_cache_directory = directory;
+
+        if ( ! directory.empty() && ! directory_exists(directory) )
+        {
+            std::error_code err;
+            std::filesystem::create_directories(directory, err);
+            if ( err )
+            {
+                LOG(WARNING) << "Unable to create http cache directory " << directory << ", caching in memory only";
+                _http_cache_directory = "";
+            }
+        }
+    }
+
+    void sk_http_disable_cache()
+    {
+        std::lock_guard<std::mutex> lock(_http_cache_lock);
+
+        _http_cache_enabled = false;
+        _http_cache.clear();
+        _http_cache_bytes = 0;
+    }
+
+    void sk_http_clear_cache()
+    {
+        std::lock_guard<std::mutex> lock(_http_cache_lock);
+
+        for (auto &item : _http_cache)
+        {
+            if ( ! _http_cache_directory.empty() ) remove(_cache_path(item.first).c_str());
+        }
+        _http_cache.clear();
+        _http_cache_bytes = 0;
+
+        // entries saved in earlier runs are only found on disk
+        if ( ! _http_cache_directory.empty() )
+        {
+            std::error_code err;
+            for (const auto &file : std::filesystem::directory_iterator(_http_cache_directory, err))
+            {
+                if ( file.path().extension() == ".cache" ) std::filesystem::remove(file.path(), err);
+            }
+        }
+    }
+
+    sk_http_response *sk_http_get(const string &host, unsigned short port)
+    {
+        if ( _http_cache_enabled ) return _cached_http_get(host, port);
+
+        return _http_get(host, port, {}, nullptr);
+    }
+
     sk_http_response *sk_http_put(const string &host, unsigned short port, const string &body)
     {
         request_stream data_read = { nullptr, 0 };
 
         // init the curl session
-        CURL *curl_handle = curl_easy_init();;
+        CURL *curl_handle = _acquire_curl();
         CURLcode res;
 
         _init_curl(curl_handle, host, port);
@@ -253,7 +685,7 @@ namespace splashkit_lib
         request_stream data_read = { nullptr, 0 };
 
         // init the curl session
-        CURL *curl_handle = curl_easy_init();;
+        CURL *curl_handle = _acquire_curl();
         CURLcode res;
 
 
@@ -273,6 +705,172 @@ namespace splashkit_lib
         return _create_response(curl_handle, res, data_read);
     }
 
+    vector<sk_http_response *> sk_http_get_many(const vector<string> &urls, unsigned short port, int max_connections)
+    {
+        internal_sk_init();
+
+        vector<sk_http_response *> result(urls.size(), nullptr);
+        if ( urls.empty() ) return result;
+
+        CURLM *multi = curl_multi_init();
+        if ( ! multi )
+        {
+            LOG(ERROR) << "Unable to create curl multi handle to get " << urls.size() << " resources";
+            return result;
+        }
+
+        if ( max_connections < 1 ) max_connections = 1;
+
+        // requests to the same HTTP/2 server share one connection
+        curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(max_connections));
+
+        vector<CURL *> handles(urls.size(), nullptr);
+        vector<request_stream> data(urls.size(), { nullptr, 0 });
+
+        for (size_t i = 0; i < urls.size(); i++)
+        {
+            CURL *curl_handle = _acquire_curl();
+            if ( ! curl_handle ) continue;
+
+            _init_curl(curl_handle, urls[i], port);
+            _setup_curl_download(curl_handle, &data[i]);
+
+            curl_easy_setopt(curl_handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+            // wait for a connection that can be multiplexed, rather than opening another
+            curl_easy_setopt(curl_handle, CURLOPT_PIPEWAIT, 1L);
+            curl_easy_setopt(curl_handle, CURLOPT_PRIVATE, (void *)i);
+
+            handles[i] = curl_handle;
+            curl_multi_add_handle(multi, curl_handle);
+        }
+
+        // curl only opens max_connections at a time, and queues the rest
+        int running = 0;
+        do
+        {
+            CURLMcode mc = curl_multi_perform(multi, &running);
+            if ( mc == CURLM_OK && running )
+                mc = curl_multi_wait(multi, nullptr, 0, 1000, nullptr);
+
+            if ( mc != CURLM_OK )
+            {
+                LOG(ERROR) << "Error getting resources: " << curl_multi_strerror(mc);
+                break;
+            }
+
+            CURLMsg *msg;
+            int remaining;
+            while ( (msg = curl_multi_info_read(multi, &remaining)) )
+            {
+                if ( msg->msg != CURLMSG_DONE ) continue;
+
+                CURL *curl_handle = msg->easy_handle;
+                CURLcode res = msg->data.result;
+
+                void *index;
+                curl_easy_getinfo(curl_handle, CURLINFO_PRIVATE, &index);
+                size_t i = (size_t)index;
+
+                curl_multi_remove_handle(multi, curl_handle);
+                handles[i] = nullptr;
+
+                if ( res != CURLE_OK )
+                    LOG(WARNING) << "Unable to get " << urls[i];
+
+                result[i] = _create_response(curl_handle, res, data[i]);
+            }
+        } while ( running );
+
+        // only left when the transfers were stopped by an error
+        for (size_t i = 0; i < handles.size(); i++)
+        {
+            if ( ! handles[i] ) continue;
+
+            curl_multi_remove_handle(multi, handles[i]);
+            _release_curl(handles[i]);
+            free(data[i].body);
+        }
+
+        curl_multi_cleanup(multi);
+
+        return result;
+    }
+
+    struct _stream_target
+    {
+        sk_http_write_fn    *write;
+        sk_http_progress_fn *progress;
+        void                *context;
+    };
+
+    static size_t _write_stream_callback(void *contents, size_t size, size_t nmemb, void *userp)
+    {
+        size_t realsize = size * nmemb;
+        _stream_target *target = static_cast<_stream_target *>(userp);
+
+        // returning less than we were given aborts the transfer
+        if ( ! target->write(static_cast<const char *>(contents), realsize, target->context) )
+            return 0;
+
+        return realsize;
+    }
+
+    static int _stream_progress_callback(void *userp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
+    {
+        _stream_target *target = static_cast<_stream_target *>(userp);
+
+        long long total = dltotal > 0 ? static_cast<long long>(dltotal) : -1;
+        return target->progress(static_cast<long long>(dlnow), total, target->context) ? 0 : 1;
+    }
+
+    bool sk_http_get_stream(const string &host, unsigned short port, sk_http_write_fn *write, sk_http_progress_fn *progress, void *context, long &status)
+    {
+        internal_sk_init();
+
+        status = 0;
+
+        CURL *curl_handle = _acquire_curl();
+        if ( ! curl_handle )
+        {
+            LOG(ERROR) << "Unable to create curl handle for request to " << host;
+            return false;
+        }
+
+        _stream_target target = { write, progress, context };
+
+        _init_curl(curl_handle, host, port);
+
+        // error pages are not passed on as if they were the data
+        curl_easy_setopt(curl_handle, CURLOPT_FAILONERROR, 1L);
+
+        curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, _write_stream_callback);
+        curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void *)&target);
+
+        if ( progress )
+        {
+            curl_easy_setopt(curl_handle, CURLOPT_XFERINFOFUNCTION, _stream_progress_callback);
+            curl_easy_setopt(curl_handle, CURLOPT_XFERINFODATA, (void *)&target);
+            curl_easy_setopt(curl_handle, CURLOPT_NOPROGRESS, 0L);
+        }
+
+        CURLcode res = curl_easy_perform(curl_handle);
+
+        curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &status);
+        _release_curl(curl_handle);
+
+        if ( res != CURLE_OK )
+        {
+            if ( res == CURLE_WRITE_ERROR || res == CURLE_ABORTED_BY_CALLBACK )
+                LOG(WARNING) << "Download from " << host << " was stopped";
+            else
+                LOG(WARNING) << "Unable to download from " << host << ": " << curl_easy_strerror(res);
+            return false;
+        }
+
+        return true;
+    }
+
     sk_http_response *sk_http_make_request(const sk_http_request &request)
     {
         internal_sk_init();
@@ -291,4 +889,157 @@ namespace splashkit_lib
                 return nullptr;
         }
     }
+
+    sk_http_async_request *sk_http_start_request(const sk_http_request &request)
+    {
+        internal_sk_init();
+
+        if ( ! _curl_multi )
+        {
+            _curl_multi = curl_multi_init();
+            if ( ! _curl_multi )
+            {
+                LOG(ERROR) << "Unable to create curl multi handle for asynchronous requests";
+                return nullptr;
+            }
+        }
+
+        CURL *curl_handle = _acquire_curl();
+        if ( ! curl_handle )
+        {
+            LOG(ERROR) << "Unable to create curl handle for request to " << request.uri;
+            return nullptr;
+        }
+
+        sk_http_async_request *result = new sk_http_async_request;
+        result->id = HTTP_ASYNC_REQUEST_PTR;
+        result->handle = curl_handle;
+        result->headers = nullptr;
+        result->body = request.body;
+        result->upload = { nullptr, 0 };
+        result->download = { nullptr, 0 };
+        result->done = false;
+        result->response = nullptr;
+
+        _init_curl(curl_handle, request.uri, request.port);
+        _setup_curl_download(curl_handle, &result->download);
+
+        switch (request.method)
+        {
+            case HTTP_GET_METHOD:
+                break;
+            case HTTP_POST_METHOD:
+                result->headers = _setup_curl_upload(curl_handle, result->body, request.headers);
+                break;
+            case HTTP_PUT_METHOD:
+                // matches sk_http_put, which streams the body up with the read callback
+            {
+                struct curl_slist *list = NULL;
+                list = curl_slist_append(list, "Content-Type: application/json;charset=UTF8");
+                list = curl_slist_append(list, "Accept: application/json, text/plain, */*");
+                curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, list);
+                result->headers = list;
+
+                result->upload.body = strdup(result->body.c_str());
+                curl_easy_setopt(curl_handle, CURLOPT_READFUNCTION, read_request_body);
+                curl_easy_setopt(curl_handle, CURLOPT_UPLOAD, 1L);
+                curl_easy_setopt(curl_handle, CURLOPT_READDATA, &result->upload);
+                curl_easy_setopt(curl_handle, CURLOPT_INFILESIZE, (curl_off_t)result->body.length());
+                break;
+            }
+            case HTTP_DELETE_METHOD:
+                result->headers = _setup_curl_upload(curl_handle, result->body, request.headers);
+                curl_easy_setopt(curl_handle, CURLOPT_CUSTOMREQUEST, "DELETE");
+                break;
+            default:
+                LOG(WARNING) << "Unsupported method for asynchronous request to " << request.uri;
+                result->done = true;
+                return result;
+        }
+
+        curl_easy_setopt(curl_handle, CURLOPT_PRIVATE, result);
+        curl_multi_add_handle(_curl_multi, curl_handle);
+        _curl_multi_active++;
+
+        // get the connection going, this does not wait for any data
+        sk_http_update_requests();
+
+        return result;
+    }
+
+    void _finish_request(sk_http_async_request *request, CURLcode res)
+    {
+        curl_multi_remove_handle(_curl_multi, static_cast<CURL *>(request->handle));
+        _curl_multi_active--;
+
+        curl_slist_free_all(static_cast<curl_slist *>(request->headers));
+        request->headers = nullptr;
+        free(request->upload.body);
+        request->upload.body = nullptr;
+
+        // returns the handle to the pool, and takes the downloaded data
+        request->response = _create_response(static_cast<CURL *>(request->handle), res, request->download);
+        request->handle = nullptr;
+        request->download = { nullptr, 0 };
+        request->done = true;
+
+        sk_signal_activity(); // Wake anything waiting on the response
+    }
+
+    void sk_http_update_requests()
+    {
+        if ( ! _curl_multi || _curl_multi_active == 0 ) return;
+
+        int running;
+        curl_multi_perform(_curl_multi, &running);
+
+        CURLMsg *msg;
+        int remaining;
+        while ( (msg = curl_multi_info_read(_curl_multi, &remaining)) )
+        {
+            if ( msg->msg != CURLMSG_DONE ) continue;
+
+            sk_http_async_request *request = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &request);
+
+            // read the result before removing the handle, which invalidates msg
+            CURLcode res = msg->data.result;
+            if ( request ) _finish_request(request, res);
+        }
+    }
+
+    int sk_http_active_requests()
+    {
+        return _curl_multi_active;
+    }
+
+    bool sk_http_request_done(sk_http_async_request *request)
+    {
+        if ( ! request->done ) sk_http_update_requests();
+        return request->done;
+    }
+
+    sk_http_response *sk_http_request_response(sk_http_async_request *request)
+    {
+        return request->response;
+    }
+
+    void sk_http_free_request(sk_http_async_request *request)
+    {
+        if ( request->handle )
+        {
+            if ( ! request->done )
+            {
+                curl_multi_remove_handle(_curl_multi, static_cast<CURL *>(request->handle));
+                _curl_multi_active--;
+            }
+            curl_slist_free_all(static_cast<curl_slist *>(request->headers));
+            free(request->upload.body);
+            free(request->download.body);
+            _release_curl(static_cast<CURL *>(request->handle));
+        }
+
+        request->id = NONE_PTR;
+        delete request;
+    }
 }
@@ -20,5 +20,30 @@ namespace splashkit_lib
     sk_http_response *sk_http_put(const string &host, unsigned short port, const string &body);
     sk_http_response *sk_http_delete(const string &host, unsigned short port, const string &body);
     sk_http_response *sk_http_make_request(const sk_http_request &request);
+
+    // Caches get responses that allow it, in memory and also in the
+    // directory when one is given. Disabling the cache leaves the directory.
+    void sk_http_enable_cache(const string &directory);
+    void sk_http_disable_cache();
+    void sk_http_clear_cache();
+
+    // Streams the body of a get request to write as it arrives, rather than
+    // holding it in memory. Either callback can return false to stop the
+    // transfer, total is -1 when the server did not send a length.
+    typedef bool (sk_http_write_fn)(const char *data, size_t size, void *context);
+    typedef bool (sk_http_progress_fn)(long long received, long long total, void *context);
+
+    bool sk_http_get_stream(const string &host, unsigned short port, sk_http_write_fn *write, sk_http_progress_fn *progress, void *context, long &status);
+
+    // Gets all of the urls at once, over at most max_connections connections
+    vector<sk_http_response *> sk_http_get_many(const vector<string> &urls, unsigned short port, int max_connections);
+
+    // Requests that run in the background on curl's multi interface
+    sk_http_async_request *sk_http_start_request(const sk_http_request &request);
+    void sk_http_update_requests();
+    int sk_http_active_requests();
+    bool sk_http_request_done(sk_http_async_request *request);
+    sk_http_response *sk_http_request_response(sk_http_async_request *request);
+    void sk_http_free_request(sk_http_async_request *request);
 }
 #endif /* defined(__sgsdl2__SGSDL2Web__) */
@@ -10,23 +10,465 @@
 #include "concurrency_utils.h"
 #include "utility_functions.h"
 #include "core_driver.h"
+#include "utils_driver.h"
 
 #include <iostream>
 #include <cstring>
+#include <unordered_map>
+#include <chrono>
+#include <cmath>
+#include <sstream>
 
 using std::to_string;
+using std::unordered_map;
 
 namespace splashkit_lib
 {
     static map<unsigned short, sk_web_server*> servers;
 
+    // Requests answered on each open connection, to limit keep-alive reuse
+    static map<const struct mg_connection *, unsigned int> _connection_requests;
+    static mutex _connection_requests_lock;
+
     struct _web_server_ctx_data
     {
         unsigned short port;
     };
 
+    //
+    // Each request is a new object, so a handle kept after responding never
+    // refers to a later request. The storage of its strings and vectors is
+    // reused instead: a finished request gives its buffers back to the pool,
+    // and the next request takes them, so filling it for a similar request
+    // does not allocate.
+    //
+    #define SK_MAX_POOLED_REQUESTS 64
+
+    struct _request_storage
+    {
+        string          uri;
+        string          query_string;
+        string          body;
+        string          filename;
+        vector<string>  headers;
+        vector<std::pair<string, string>>   query_parameters;
+        vector<std::pair<string, string>>   header_fields;
+        vector<std::pair<string, string>>   path_parameters;
+    };
+
+    static vector<_request_storage> _request_pool;
+    static mutex _request_pool_lock;
+
+    static void _swap_storage(sk_http_request *r, _request_storage &storage)
+    {
+        r->uri.swap(storage.uri);
+        r->query_string.swap(storage.query_string);
+        r->body.swap(storage.body);
+        r->filename.swap(storage.filename);
+        r->headers.swap(storage.headers);
+        r->query_parameters.swap(storage.query_parameters);
+        r->header_fields.swap(storage.header_fields);
+        r->path_parameters.swap(storage.path_parameters);
+    }
+
+    static sk_http_request *_acquire_request()
+    {
+        sk_http_request *result = new sk_http_request;
+
+        lock_guard<mutex> lock(_request_pool_lock);
+        if ( ! _request_pool.empty() )
+        {
+            _swap_storage(result, _request_pool.back());
+            _request_pool.pop_back();
+        }
+
+        return result;
+    }
+
+    static void _release_request(sk_http_request *r)
+    {
+        // no longer a valid request for anything still holding the pointer
+        r->id = NONE_PTR;
+
+        {
+            lock_guard<mutex> lock(_request_pool_lock);
+            if ( _request_pool.size() < SK_MAX_POOLED_REQUESTS )
+            {
+                _request_pool.emplace_back();
+                _request_storage &storage = _request_pool.back();
+                _swap_storage(r, storage);
+
+                storage.body.clear();
+                storage.filename.clear();
+                storage.query_parameters.clear();
+                storage.header_fields.clear();
+                storage.path_parameters.clear();
+            }
+        }
+
+        delete r;
+    }
+
+    //
+    // Routes are kept in a trie with one level per path segment. Matching
+    // walks the request path once, preferring literal segments, then
+    // ":name" parameters, then a trailing "*" that matches the rest.
+    //
+    struct sk_web_route_node
+    {
+        unordered_map<string, sk_web_route_node *> children;
+        sk_web_route_node   *param_child = nullptr;
+        string              param_name;
+
+        web_request_handler *handlers[UNKNOWN_HTTP_METHOD + 1] = {};   // for exactly this path
+        web_request_handler *wildcard[UNKNOWN_HTTP_METHOD + 1] = {};   // for anything below this path
+    };
+
+    static vector<string> _path_segments(const string &path)
+    {
+        vector<string> result;
+        size_t end = path.find('?');
+        if ( end == string::npos ) end = path.size();
+
+        size_t start = 0;
+        while ( start < end )
+        {
+            size_t slash = path.find('/', start);
+            if ( slash == string::npos || slash > end ) slash = end;
+            if ( slash > start ) result.push_back(path.substr(start, slash - start));
+            start = slash + 1;
+        }
+
+        return result;
+    }
+
+    static void _free_routes(sk_web_route_node *node)
+    {
+        if ( ! node ) return;
+
+        for (auto &child : node->children) _free_routes(child.second);
+        _free_routes(node->param_child);
+        delete node;
+    }
+
+    void sk_add_web_route(sk_web_server *server, http_method method, const string &pattern, web_request_handler *handler)
+    {
+        lock_guard<mutex> lock(server->routes_lock);
+
+        if ( ! server->routes ) server->routes = new sk_web_route_node();
+        sk_web_route_node *node = server->routes;
+
+        vector<string> segments = _path_segments(pattern);
+        for (size_t i = 0; i < segments.size(); i++)
+        {
+            const string &segment = segments[i];
+
+            if ( segment == "*" )
+            {
+                if ( i + 1 != segments.size() )
+                    LOG(WARNING) << "Route " << pattern << " has segments after *, these are ignored";
+
+                node->wildcard[method] = handler;
+                return;
+            }
+            else if ( segment[0] == ':' )
+            {
+                if ( ! node->param_child )
+                {
+                    node->param_child = new sk_web_route_node();
+                    node->param_child->param_name = segment.substr(1);
+                }
+                else if ( node->param_child->param_name != segment.substr(1) )
+                {
+                    LOG(WARNING) << "Route " << pattern << " renames parameter " << node->param_child->param_name << ", the original name is kept";
+                }
+
+                node = node->param_child;
+            }
+            else
+            {
+                sk_web_route_node *&child = node->children[segment];
+                if ( ! child ) child = new sk_web_route_node();
+                node = child;
+            }
+        }
+
+        node->handlers[method] = handler;
+    }
+
+    static web_request_handler *_match_route(sk_web_route_node *node, const vector<string> &segments, size_t idx, http_method method, vector<std::pair<string, string>> &params)
+    {
+        if ( idx == segments.size() )
+        {
+            if ( node->handlers[method] ) return node->handlers[method];
+            if ( node->wildcard[method] )
+            {
+                params.push_back({"*", ""});
+                return node->wildcard[method];
+            }
+            return nullptr;
+        }
+
+        auto it = node->children.find(segments[idx]);
+        if ( it != node->children.end() )
+        {
+            web_request_handler *result = _match_route(it->second, segments, idx + 1, method, params);
+            if ( result ) return result;
+        }
+
+        if ( node->param_child )
+        {
+            params.push_back({node->param_child->param_name, segments[idx]});
+            web_request_handler *result = _match_route(node->param_child, segments, idx + 1, method, params);
+            if ( result ) return result;
+            params.pop_back();
+        }
+
+        if ( node->wildcard[method] )
+        {
+            string rest = segments[idx];
+            for (size_t i = idx + 1; i < segments.size(); i++) rest += "/" + segments[i];
+
+            params.push_back({"*", rest});
+            return node->wildcard[method];
+        }
+
+        return nullptr;
+    }
+
+    static web_request_handler *_route_for(sk_http_request *r)
+    {
+        lock_guard<mutex> lock(r->server->routes_lock);
+        if ( ! r->server->routes ) return nullptr;
+
+        return _match_route(r->server->routes, _path_segments(r->uri), 0, r->method, r->path_parameters);
+    }
+
+    static bool _keep_connection_alive(struct mg_connection *conn, sk_web_server *server)
+    {
+        if ( server->keep_alive_timeout_ms == 0 ) return false;
+
+        // HTTP/1.1 defaults to persistent connections, earlier versions must ask
+        const struct mg_request_info *request_info = mg_get_request_info(conn);
+        const char *header = mg_get_header(conn, "Connection");
+        bool requested;
+
+        if ( header )
+            requested = mg_strcasecmp(header, "keep-alive") == 0;
+        else
+            requested = request_info->http_version && strcmp(request_info->http_version, "1.1") == 0;
+
+        if ( ! requested ) return false;
+
+        lock_guard<mutex> lock(_connection_requests_lock);
+        unsigned int count = ++_connection_requests[conn];
+        return server->max_keep_alive_requests == 0 || count < server->max_keep_alive_requests;
+    }
+
+    static void connection_close_handler(const struct mg_connection *conn)
+    {
+        lock_guard<mutex> lock(_connection_requests_lock);
+        _connection_requests.erase(conn);
+    }
+
+    //
+    // Request latencies are counted in buckets with four steps for each
+    // power of two microseconds, so percentiles are within about 20%
+    // without keeping every sample.
+    //
+    static int _latency_bucket(unsigned long long us)
+    {
+        if ( us < 1 ) us = 1;
+
+        int msb = 0;
+        while ( (us >> (msb + 1)) != 0 ) msb++;
+
+        int step = msb >= 2 ? (us >> (msb - 2)) & 3 : (us << (2 - msb)) & 3;
+        int result = msb * 4 + step;
+        return result < SK_LATENCY_BUCKETS ? result : SK_LATENCY_BUCKETS - 1;
+    }
+
+    static double _latency_bucket_limit_us(int bucket)
+    {
+        return std::ldexp(1.0 + (bucket % 4 + 1) / 4.0, bucket / 4);
+    }
+
+    static void _record_request(sk_web_server *server, std::chrono::steady_clock::time_point start)
+    {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        server->latency_buckets[_latency_bucket(static_cast<unsigned long long>(us))]++;
+        server->requests_completed++;
+    }
+
+    double sk_web_server_latency_percentile(sk_web_server *server, double percentile)
+    {
+        unsigned long long counts[SK_LATENCY_BUCKETS];
+        unsigned long long total = 0;
+        for (int i = 0; i < SK_LATENCY_BUCKETS; i++)
+        {
+            counts[i] = server->latency_buckets[i];
+            total += counts[i];
+        }
+
+        if ( total == 0 ) return 0;
+
+        unsigned long long target = static_cast<unsigned long long>(std::ceil(percentile / 100.0 * total));
+        if ( target < 1 ) target = 1;
+
+        unsigned long long seen = 0;
+        for (int i = 0; i < SK_LATENCY_BUCKETS; i++)
+        {
+            seen += counts[i];
+            if ( seen >= target ) return _latency_bucket_limit_us(i) / 1000.0;
+        }
+
+        return _latency_bucket_limit_us(SK_LATENCY_BUCKETS - 1) / 1000.0;
+    }
+
+    string sk_web_server_metrics_text(sk_web_server *server)
+    {
+        unsigned long long accepted = server->requests_accepted;
+        unsigned long long completed = server->requests_completed;
+
+        // Prometheus text format, so standard scrapers can collect it
+        std::stringstream result;
+        result << "# TYPE splashkit_web_requests_accepted_total counter\n"
+               << "splashkit_web_requests_accepted_total " << accepted << "\n"
+               << "# TYPE splashkit_web_requests_completed_total counter\n"
+               << "splashkit_web_requests_completed_total " << completed << "\n"
+               << "# TYPE splashkit_web_requests_in_flight gauge\n"
+               << "splashkit_web_requests_in_flight " << (accepted > completed ? accepted - completed : 0) << "\n"
+               << "# TYPE splashkit_web_requests_queued gauge\n"
+               << "splashkit_web_requests_queued " << server->request_queue.size() << "\n"
+               << "# TYPE splashkit_web_bytes_in_total counter\n"
+               << "splashkit_web_bytes_in_total " << server->bytes_in << "\n"
+               << "# TYPE splashkit_web_bytes_out_total counter\n"
+               << "splashkit_web_bytes_out_total " << server->bytes_out << "\n"
+               << "# TYPE splashkit_web_request_latency_ms summary\n";
+
+        for (double q : { 50.0, 95.0, 99.0 })
+        {
+            result << "splashkit_web_request_latency_ms{quantile=\"" << q / 100.0 << "\"} "
+                   << sk_web_server_latency_percentile(server, q) << "\n";
+        }
+
+        return result.str();
+    }
+
+    static unsigned long _write_response(struct mg_connection *conn, sk_http_response *response, bool keep_alive)
+    {
+        // Concatenate headers vector
+        string headers;
+        for (string &header : response->headers) {
+          headers.append(header + "\r\n");
+        }
+
+        if ( ! response->filename.empty() )
+        {
+            // civetweb streams the file from disk, using sendfile where it can
+            mg_send_mime_file2(conn, response->filename.c_str(), response->content_type.c_str(), headers.c_str());
+            return response->message_size;
+        }
+
+        // Send HTTP reply to the client
+        int sent = mg_printf(conn,
+                  "HTTP/1.1 %d\r\n"
+                  "Content-Type: %s\r\n"
+                  "Connection: %s\r\n"
+                  "Content-Length: %lu\r\n" // Always set Content-Length
+                  "%s"
+                  "\r\n",
+                  response->code,
+                  response->content_type.c_str(),
+                  keep_alive ? "keep-alive" : "close",
+                  response->message_size,
+                  headers.c_str());
+
+        if ( sent > 0 ) sent += mg_write(conn, response->message, response->message_size);
+        return sent > 0 ? sent : 0;
+    }
+
+    void sk_send_direct_response(sk_http_request *request, sk_http_response *response)
+    {
+        if ( request->responded )
+        {
+            LOG(WARNING) << "Attempting to send a second response to a web request";
+            return;
+        }
+
+        if ( ! request->streamed )
+            request->server->bytes_out += _write_response(request->conn, response, request->keep_alive);
+        request->responded = true;
+    }
+
+    void sk_begin_streamed_response(sk_http_request *request, http_status_code code, const string &content_type, const vector<string> &headers)
+    {
+        // Only HTTP/1.1 clients understand chunks, others read until the connection closes
+        const struct mg_request_info *request_info = mg_get_request_info(request->conn);
+        request->chunked = request_info->http_version && strcmp(request_info->http_version, "1.1") == 0;
+        request->streamed = true;
+        if ( ! request->chunked ) request->keep_alive = false;
+
+        string extra_headers;
+        for (const string &header : headers) {
+          extra_headers.append(header + "\r\n");
+        }
+
+        int sent = mg_printf(request->conn,
+                  "HTTP/1.1 %d\r\n"
+                  "Content-Type: %s\r\n"
+                  "Connection: %s\r\n"
+                  "%s"
+                  "%s"
+                  "\r\n",
+                  code,
+                  content_type.c_str(),
+                  request->keep_alive ? "keep-alive" : "close",
+                  request->chunked ? "Transfer-Encoding: chunked\r\n" : "",
+                  extra_headers.c_str());
+
+        if ( sent > 0 ) request->server->bytes_out += sent;
+    }
+
+    bool sk_write_response_chunk(sk_http_request *request, const char *data, unsigned long size)
+    {
+        // An empty chunk would end the response early
+        if ( size == 0 ) return true;
+
+        if ( request->chunked && mg_printf(request->conn, "%lx\r\n", size) <= 0 ) return false;
+        if ( mg_write(request->conn, data, size) <= 0 ) return false;
+        if ( request->chunked && mg_write(request->conn, "\r\n", 2) <= 0 ) return false;
+
+        request->server->bytes_out += size;
+        return true;
+    }
+
+    void sk_end_streamed_response(sk_http_request *request)
+    {
+        if ( request->chunked )
+            mg_write(request->conn, "0\r\n\r\n", 5);
+    }
+
+    int sk_read_request_body(sk_http_request *request, char *buffer, int size)
+    {
+        if ( request->body_complete || ! request->conn || size <= 0 ) return 0;
+
+        // The worker thread waits on the request, so the connection is free to read
+        int got = mg_read(request->conn, buffer, size);
+        if ( got <= 0 )
+        {
+            request->body_complete = true;
+            return 0;
+        }
+
+        request->server->bytes_in += got;
+        return got;
+    }
+
     static int begin_request_handler(struct mg_connection *conn)
     {
+        auto start = std::chrono::steady_clock::now();
+
         _web_server_ctx_data *user_data;
         user_data = static_cast<_web_server_ctx_data *>(mg_get_user_data(mg_get_context(conn)));
         if ( not user_data )
@@ -44,18 +486,26 @@ namespace splashkit_lib
 
         const struct mg_request_info *request_info = mg_get_request_info(conn);
 
-        sk_http_request *r = new sk_http_request;
+        sk_http_request *r = _acquire_request();
         r->id = HTTP_REQUEST_PTR;
-        r->uri = request_info->request_uri ? request_info->request_uri : "" ;
-        r->query_string = request_info->query_string ? request_info->query_string : "";
-        r->filename = "";
+        r->uri.assign(request_info->request_uri ? request_info->request_uri : "");
+        r->query_string.assign(request_info->query_string ? request_info->query_string : "");
+        r->filename.clear();
 
-        // Populate headers
-        for (auto header : request_info->http_headers) {
-          if (header.name != nullptr) {
-            r->headers.push_back(string(header.name) + ": " + string(header.value));
-          }
+        // Populate headers, reusing the strings of a pooled request
+        size_t header_count = 0;
+        for (int i = 0; i < request_info->num_headers; i++)
+        {
+            const mg_header &header = request_info->http_headers[i];
+            if ( header.name == nullptr ) continue;
+
+            if ( header_count == r->headers.size() ) r->headers.emplace_back();
+            string &line = r->headers[header_count++];
+            line.assign(header.name);
+            line += ": ";
+            line += header.value ? header.value : "";
         }
+        r->headers.resize(header_count);
 
         if ( strncmp(request_info->request_method, "GET", 4) == 0 )
         {
@@ -87,53 +537,222 @@ namespace splashkit_lib
             r->method = UNKNOWN_HTTP_METHOD;
         }
 
-        if (r->method == HTTP_POST_METHOD or r->method == HTTP_PUT_METHOD)
-        {
-            char post_data[10240];
-            int post_data_len;
-            post_data_len = mg_read(conn, post_data, sizeof(post_data));
+        // The body is left on the connection until it is read, either in
+        // full with request_body or in chunks with read_request_body_chunk.
+        // civetweb decodes chunked bodies and stops at the Content-Length.
+        r->body.clear();
+        r->content_length = request_info->content_length;
+        r->body_complete = false;
 
-            r->body = string(post_data);
+        r->server = servers[port];
+        r->conn = conn;
+        r->response = nullptr;
+        r->direct = false;
+        r->responded = false;
+        r->keep_alive = _keep_connection_alive(conn, r->server);
+        r->streamed = false;
+        r->chunked = false;
+        r->parsed_fields = false;
+
+        sk_web_server *server = r->server;
+        server->requests_accepted++;
+
+        string metrics_path;
+        {
+            lock_guard<mutex> lock(server->routes_lock);
+            metrics_path = server->metrics_path;
         }
 
-        r->server = servers[port];
-        servers[port]->request_queue.put(r); // Add request to concurrent queue
-        r->control.acquire(); // Waits until user returns response.
+        if ( ! metrics_path.empty() && r->method == HTTP_GET_METHOD && _path_segments(r->uri) == _path_segments(metrics_path) )
+        {
+            string text = sk_web_server_metrics_text(server);
+
+            sk_http_response resp;
+            resp.message = &text[0];
+            resp.message_size = text.size();
+            resp.content_type = "text/plain; version=0.0.4";
+            resp.code = HTTP_STATUS_OK;
+            server->bytes_out += _write_response(conn, &resp, r->keep_alive);
+
+            _release_request(r);
+            _record_request(server, start);
+            return 1;
+        }
 
-        // Concatenate headers vector
-        string headers;
-        for (string &header : r->response->headers) {
-          headers.append(header.append("\r\n"));
+        // Let the route, or general, handler respond on this thread, freeing
+        // the worker as soon as it is done, and only queue requests they
+        // leave unanswered.
+        web_request_handler *handlers[] = { _route_for(r), r->server->handler };
+        for (web_request_handler *handler : handlers)
+        {
+            if ( ! handler ) continue;
+
+            r->direct = true;
+            handler(r);
+            r->direct = false;
+
+            if ( r->responded )
+            {
+                _release_request(r);
+                _record_request(server, start);
+                return 1;
+            }
         }
 
-        // Send HTTP reply to the client
-        mg_printf(conn,
-                  "HTTP/1.1 %d\r\n"
-                  "Content-Type: %s\r\n"
-                  "Connection: close\r\n"
-                  "Content-Length: %lu\r\n" // Always set Content-Length
-                  "%s"
-                  "\r\n"
-                  "%s",
-                  r->response->code,
-                  r->response->content_type.c_str(),
-                  r->response->message_size,
-                  headers.c_str(),
-                  r->response->message);
+        r->server->request_queue.put(r); // Add request to concurrent queue
+        sk_signal_activity(); // Wake the game thread if it is idle
+        r->control.acquire(); // Waits until user returns response.
 
-        // Indicate that the request has been dealt with - so it is no longer a request ptr
-        r->id = NONE_PTR;
+        // Streamed responses have already been written
+        if ( ! r->streamed )
+            server->bytes_out += _write_response(conn, r->response, r->keep_alive);
 
         // Signal to the front end that the response has been sent
-        r->response->response_sent.release();
+        sk_http_response *response = r->response;
 
-        // Now we can delete the request
-        delete r;
+        // Indicate that the request has been dealt with - so it is no longer a request ptr
+        _release_request(r);
+        response->response_sent.release();
+        _record_request(server, start);
 
         // Non-zero return means civetweb has replied to client
         return 1;
     }
 
+    //
+    // Websockets. civetweb calls these handlers on its own threads, with
+    // the server as the callback data. They look up the websocket for the
+    // connection under the server's websocket lock, so it cannot be freed by
+    // sk_close_websocket while they use it.
+    //
+    static int _websocket_connect_handler(const struct mg_connection *conn, void *cbdata)
+    {
+        return 0; // accept the connection
+    }
+
+    static void _websocket_ready_handler(struct mg_connection *conn, void *cbdata)
+    {
+        sk_web_server *server = static_cast<sk_web_server *>(cbdata);
+        const struct mg_request_info *request_info = mg_get_request_info(conn);
+
+        sk_websocket_data *ws = new sk_websocket_data;
+        ws->id = WEBSOCKET_PTR;
+        ws->server = server;
+        ws->path = request_info->request_uri ? request_info->request_uri : "";
+        ws->conn = conn;
+
+        lock_guard<mutex> lock(server->websockets_lock);
+        mg_set_user_connection_data(conn, ws);
+        server->websockets.push_back(ws);
+        server->new_websockets.push_back(ws);
+    }
+
+    static int _websocket_data_handler(struct mg_connection *conn, int bits, char *data, size_t len, void *cbdata)
+    {
+        sk_web_server *server = static_cast<sk_web_server *>(cbdata);
+        int opcode = bits & 0x0f;
+        bool final_fragment = (bits & 0x80) != 0;
+
+        if ( opcode == MG_WEBSOCKET_OPCODE_CONNECTION_CLOSE ) return 0;
+        if ( opcode == MG_WEBSOCKET_OPCODE_PING || opcode == MG_WEBSOCKET_OPCODE_PONG ) return 1;
+
+        lock_guard<mutex> lock(server->websockets_lock);
+        sk_websocket_data *ws = static_cast<sk_websocket_data *>(mg_get_user_connection_data(conn));
+        if ( ! ws ) return 0; // closed by the program
+
+        lock_guard<mutex> ws_lock(ws->lock);
+        ws->partial.append(data, len);
+        if ( final_fragment )
+        {
+            ws->messages.push_back(ws->partial);
+            ws->partial.clear();
+        }
+
+        return 1;
+    }
+
+    static void _websocket_close_handler(const struct mg_connection *conn, void *cbdata)
+    {
+        sk_web_server *server = static_cast<sk_web_server *>(cbdata);
+
+        lock_guard<mutex> lock(server->websockets_lock);
+        sk_websocket_data *ws = static_cast<sk_websocket_data *>(mg_get_user_connection_data(conn));
+        if ( ! ws ) return;
+
+        // Keep the websocket so its remaining messages can still be read
+        lock_guard<mutex> ws_lock(ws->lock);
+        ws->conn = nullptr;
+    }
+
+    void sk_add_websocket_route(sk_web_server *server, const string &path)
+    {
+        mg_set_websocket_handler(server->ctx, path.c_str(),
+                                 _websocket_connect_handler,
+                                 _websocket_ready_handler,
+                                 _websocket_data_handler,
+                                 _websocket_close_handler,
+                                 server);
+    }
+
+    sk_websocket_data *sk_next_websocket(sk_web_server *server)
+    {
+        lock_guard<mutex> lock(server->websockets_lock);
+        if ( server->new_websockets.empty() ) return nullptr;
+
+        sk_websocket_data *result = server->new_websockets.front();
+        server->new_websockets.pop_front();
+        return result;
+    }
+
+    static bool _websocket_write(sk_websocket_data *ws, int opcode, const string &message)
+    {
+        lock_guard<mutex> lock(ws->lock);
+        if ( ! ws->conn ) return false;
+
+        return mg_websocket_write(ws->conn, opcode, message.data(), message.size()) > 0;
+    }
+
+    bool sk_websocket_send(sk_websocket_data *ws, const string &message)
+    {
+        return _websocket_write(ws, MG_WEBSOCKET_OPCODE_TEXT, message);
+    }
+
+    void sk_websocket_broadcast(sk_web_server *server, const string &message)
+    {
+        lock_guard<mutex> lock(server->websockets_lock);
+        for (sk_websocket_data *ws : server->websockets)
+        {
+            _websocket_write(ws, MG_WEBSOCKET_OPCODE_TEXT, message);
+        }
+    }
+
+    static void _free_websocket(sk_websocket_data *ws)
+    {
+        ws->id = NONE_PTR;
+        delete ws;
+    }
+
+    void sk_close_websocket(sk_websocket_data *ws)
+    {
+        sk_web_server *server = ws->server;
+
+        {
+            lock_guard<mutex> lock(server->websockets_lock);
+            erase_from_vector(server->websockets, ws);
+            server->new_websockets.erase(std::remove(server->new_websockets.begin(), server->new_websockets.end(), ws), server->new_websockets.end());
+
+            lock_guard<mutex> ws_lock(ws->lock);
+            if ( ws->conn )
+            {
+                mg_websocket_write(ws->conn, MG_WEBSOCKET_OPCODE_CONNECTION_CLOSE, nullptr, 0);
+                mg_set_user_connection_data(ws->conn, nullptr);
+                ws->conn = nullptr;
+            }
+        }
+
+        _free_websocket(ws);
+    }
+
     void sk_flush_request(sk_http_request *request)
     {
         send_response(request, HTTP_STATUS_SERVICE_UNAVAILABLE, "Server closed");
@@ -181,7 +800,7 @@ namespace splashkit_lib
         return false;
     }
 
-    sk_web_server* sk_start_web_server(unsigned short port)
+    sk_web_server* sk_start_web_server(unsigned short port, unsigned int worker_threads, unsigned int keep_alive_timeout_ms, unsigned int max_keep_alive_requests)
     {
         internal_sk_init();
 
@@ -197,11 +816,36 @@ namespace splashkit_lib
         server->id = WEB_SERVER_PTR;
         server->port = port;
         server->last_request = nullptr;
+        server->handler = nullptr;
+        server->routes = nullptr;
+        server->compression_min_size = SK_DEFAULT_COMPRESSION_MIN_SIZE;
+        server->requests_accepted = 0;
+        server->requests_completed = 0;
+        server->bytes_in = 0;
+        server->bytes_out = 0;
+        for (auto &bucket : server->latency_buckets) bucket = 0;
+        server->keep_alive_timeout_ms = keep_alive_timeout_ms;
+        server->max_keep_alive_requests = max_keep_alive_requests;
 
         string port_str = to_string(port);
+        string threads_str = to_string(worker_threads);
+        string keep_alive_str = to_string(keep_alive_timeout_ms);
 
         // List of options. Last element must be NULL.
-        const char *options[] = {"listening_ports", port_str.c_str(), NULL};
+        vector<const char *> options = {"listening_ports", port_str.c_str()};
+        if ( worker_threads > 0 )
+        {
+            options.push_back("num_threads");
+            options.push_back(threads_str.c_str());
+        }
+        if ( keep_alive_timeout_ms > 0 )
+        {
+            options.push_back("enable_keep_alive");
+            options.push_back("yes");
+            options.push_back("keep_alive_timeout_ms");
+            options.push_back(keep_alive_str.c_str());
+        }
+        options.push_back(NULL);
 
         _web_server_ctx_data *user_data = new _web_server_ctx_data();
         user_data->port = port;
@@ -209,9 +853,10 @@ namespace splashkit_lib
         // Prepare callbacks structure. We have only one callback, the rest are NULL.
         memset(&server->callbacks, 0, sizeof(server->callbacks));
         server->callbacks.begin_request = &begin_request_handler;
+        server->callbacks.connection_close = &connection_close_handler;
 
         // Start the web server.
-        server->ctx = mg_start(&server->callbacks, user_data, options);
+        server->ctx = mg_start(&server->callbacks, user_data, options.data());
 
         servers[port] = server;
 
@@ -229,8 +874,9 @@ namespace splashkit_lib
         // Any loaded requests
         if (server->last_request)
         {
+            // the worker thread that received it returns it to the pool
             sk_flush_request(server->last_request);
-            delete server->last_request;
+            server->last_request = nullptr;
         }
 
         // Any yet to be processed requests
@@ -248,6 +894,17 @@ namespace splashkit_lib
 
         mg_stop(server->ctx);
 
+        _free_routes(server->routes);
+        server->routes = nullptr;
+
+        // civetweb has closed all the connections, so the websockets can go
+        for (sk_websocket_data *ws : server->websockets)
+        {
+            _free_websocket(ws);
+        }
+        server->websockets.clear();
+        server->new_websockets.clear();
+
         auto it = servers.find(server->port);
         if (it != servers.end())
         {
@@ -12,6 +12,10 @@
 
 #include "backend_types.h"
 
+#define SK_DEFAULT_KEEP_ALIVE_TIMEOUT_MS 2000
+#define SK_DEFAULT_MAX_KEEP_ALIVE_REQUESTS 100
+#define SK_DEFAULT_COMPRESSION_MIN_SIZE 1024
+
 namespace splashkit_lib
 {
     void sk_flush_request(sk_http_request *request);
@@ -20,7 +24,26 @@ namespace splashkit_lib
 
     bool sk_has_waiting_requests(sk_web_server *server);
 
-    sk_web_server* sk_start_web_server(unsigned short port);
+    sk_web_server* sk_start_web_server(unsigned short port, unsigned int worker_threads = 0, unsigned int keep_alive_timeout_ms = SK_DEFAULT_KEEP_ALIVE_TIMEOUT_MS, unsigned int max_keep_alive_requests = SK_DEFAULT_MAX_KEEP_ALIVE_REQUESTS);
+
+    void sk_send_direct_response(sk_http_request *request, sk_http_response *response);
+
+    int sk_read_request_body(sk_http_request *request, char *buffer, int size);
+
+    void sk_add_web_route(sk_web_server *server, http_method method, const string &pattern, web_request_handler *handler);
+
+    double sk_web_server_latency_percentile(sk_web_server *server, double percentile);
+    string sk_web_server_metrics_text(sk_web_server *server);
+
+    void sk_add_websocket_route(sk_web_server *server, const string &path);
+    sk_websocket_data *sk_next_websocket(sk_web_server *server);
+    bool sk_websocket_send(sk_websocket_data *ws, const string &message);
+    void sk_websocket_broadcast(sk_web_server *server, const string &message);
+    void sk_close_websocket(sk_websocket_data *ws);
+
+    void sk_begin_streamed_response(sk_http_request *request, http_status_code code, const string &content_type, const vector<string> &headers);
+    bool sk_write_response_chunk(sk_http_request *request, const char *data, unsigned long size);
+    void sk_end_streamed_response(sk_http_request *request);
 
     void sk_stop_web_server(sk_web_server *server);
 }
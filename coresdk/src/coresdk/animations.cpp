@@ -13,13 +13,21 @@
 #include "vector_2d.h"
 
 #include "utility_functions.h"
+#include "resource_registry.h"
+#include "file_view.h"
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <map>
+#include <memory>
 
 using std::string;
 using std::vector;
@@ -27,9 +35,19 @@ using std::map;
 using std::ifstream;
 using std::to_string;
 
+// Compiled scripts are cached beside their source with this extension
+#define COMPILED_ANIMATION_EXT ".skanim"
+#define COMPILED_ANIMATION_MAGIC "SKANIM\0\2"
+#define COMPILED_ANIMATION_MAGIC_LEN 8
+
+// Frame durations are counted in updates, normally run 60 times a second
+#define ANIMATION_UPDATES_PER_SECOND 60
+// Animations are allocated in blocks, so those created together sit together in memory
+#define ANIMATION_POOL_BLOCK 256
+
 namespace splashkit_lib
 {
-    static map<string, animation_script> _animation_scripts;
+    static resource_registry<animation_script> _animation_scripts;
 
     struct row_data
     {
@@ -46,13 +64,361 @@ namespace splashkit_lib
 
     int animation_index(animation_script temp, const string &name);
 
-    animation_script load_animation_script(const string &name, const string &filename)
+    //
+    // Animation pool
+    //
+    // Animations are handed out from blocks in order, so those created
+    // together sit together in memory. Freed slots are never handed out
+    // again, so a stale handle cannot come back to life as a new animation.
+    // A block is deleted once all of its slots have been used and freed.
+    //
+
+    struct _animation_block
+    {
+        std::unique_ptr<_animation_data[]> slots;
+        int used = 0;   // slots handed out so far
+        int live = 0;   // slots handed out and not yet freed
+    };
+
+    // Keyed by the address of each block's first slot
+    static map<_animation_data *, _animation_block> _animation_blocks;
+    static _animation_block *_current_animation_block = nullptr;
+
+    static animation _alloc_animation()
+    {
+        if ( ! _current_animation_block || _current_animation_block->used == ANIMATION_POOL_BLOCK )
+        {
+            _animation_block block;
+            block.slots.reset(new _animation_data[ANIMATION_POOL_BLOCK]);
+
+            _animation_data *start = block.slots.get();
+            _current_animation_block = &(_animation_blocks[start] = std::move(block));
+        }
+
+        _animation_block &block = *_current_animation_block;
+        block.live++;
+        return &block.slots[block.used++];
+    }
+
+    static void _release_animation(animation anim)
+    {
+        anim->id = NONE_PTR;
+        anim->script = nullptr;
+        anim->animation_name.clear();
+
+        // The block starting at or before the animation
+        auto it = _animation_blocks.upper_bound(anim);
+        if ( it == _animation_blocks.begin() ) return;
+        --it;
+
+        _animation_block &block = it->second;
+        block.live--;
+
+        if ( block.live == 0 && block.used == ANIMATION_POOL_BLOCK )
+        {
+            if ( _current_animation_block == &block ) _current_animation_block = nullptr;
+            _animation_blocks.erase(it);
+        }
+    }
+
+    // Note that anim has just been added to the end of this script's list
+    static void _animation_added(animation_script script)
+    {
+        size_t count = script->anim_objs.size();
+        if ( count > 1 && script->anim_objs[count - 1] < script->anim_objs[count - 2] )
+            script->anims_in_order = false;
+    }
+
+    //
+    // Compiled animation scripts
+    //
+    // The compiled form holds the resolved frames so a script loads with a
+    // single read and no text parsing. Scripts are cached in their own
+    // folder, each in a file named from a hash of its source path, so the
+    // resources folder is never written to. Layout (little endian):
+    //
+    //   magic[8], i64 source mtime, u64 source size, u32 length, source path,
+    //   u32 frame count, u32 animation count, u32 sound count
+    //   frames:     i32 cell, f32 duration, f64 move x, f64 move y, i32 next, i32 sound
+    //   animations: i32 start frame, u32 length, name
+    //   sounds:     u32 length, name, u32 length, filename
+    //
+    // A next or sound of -1 means none. The source mtime is in the file
+    // system's own ticks, so a change within the same second is still seen.
+    // The stamp is zero for files loaded without a source to check against.
+    //
+
+    struct _compiled_frame
+    {
+        int32_t cell;
+        float duration;
+        double move_x, move_y;
+        int32_t next;
+        int32_t sound;
+    };
+
+    static string _animation_cache_folder;
+    static bool _animation_cache_folder_set = false;
+
+    void set_animation_cache_path(const string &path)
+    {
+        _animation_cache_folder = path;
+        _animation_cache_folder_set = true;
+    }
+
+    string animation_cache_path()
+    {
+        if ( ! _animation_cache_folder_set )
+        {
+            std::error_code ec;
+            std::filesystem::path temp = std::filesystem::temp_directory_path(ec);
+            _animation_cache_folder = ec ? "" : (temp / "splashkit" / "animations").string();
+            _animation_cache_folder_set = true;
+        }
+
+        return _animation_cache_folder;
+    }
+
+    // The cache file for the script at path, or empty if scripts are not cached
+    static string _compiled_script_path(const string &path)
+    {
+        string folder = animation_cache_path();
+        if ( folder.empty() ) return "";
+
+        // FNV-1a of the source path
+        uint64_t hash = 14695981039346656037ULL;
+        for (char c : path)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx" COMPILED_ANIMATION_EXT, static_cast<unsigned long long>(hash));
+        return (std::filesystem::path(folder) / name).string();
+    }
+
+    static bool _is_compiled_script_path(const string &path)
+    {
+        size_t ext_len = strlen(COMPILED_ANIMATION_EXT);
+        return path.size() > ext_len && path.compare(path.size() - ext_len, ext_len, COMPILED_ANIMATION_EXT) == 0;
+    }
+
+    static bool _source_stamp(const string &path, int64_t &mtime, uint64_t &size)
+    {
+        std::error_code ec;
+        auto modified = std::filesystem::last_write_time(path, ec);
+        if ( ec ) return false;
+
+        auto length = std::filesystem::file_size(path, ec);
+        if ( ec ) return false;
+
+        mtime = static_cast<int64_t>(modified.time_since_epoch().count());
+        size = static_cast<uint64_t>(length);
+        return true;
+    }
+
+    // Bounds checked reads from a compiled script
+    struct _compiled_reader
+    {
+        const char *data;
+        size_t size;
+        size_t pos;
+
+        template <typename T>
+        bool read(T &value)
+        {
+            if ( size - pos < sizeof(T) ) return false;
+            memcpy(&value, data + pos, sizeof(T));
+            pos += sizeof(T);
+            return true;
+        }
+
+        bool read(string &value)
+        {
+            uint32_t len;
+            if ( ! read(len) || size - pos < len ) return false;
+            value.assign(data + pos, len);
+            pos += len;
+            return true;
+        }
+    };
+
+    // Load a compiled script. When check_stamp is set the script is only
+    // used if it was compiled from the source at src_path, with the given
+    // mtime and size.
+    static animation_script _load_compiled_animation_script(const string &name, const string &filename, const string &path, bool check_stamp, const string &src_path, int64_t src_mtime, uint64_t src_size)
+    {
+        file_view view(path);
+        if ( ! view.is_open() || view.size() < COMPILED_ANIMATION_MAGIC_LEN ) return nullptr;
+        if ( memcmp(view.data(), COMPILED_ANIMATION_MAGIC, COMPILED_ANIMATION_MAGIC_LEN) != 0 ) return nullptr;
+
+        _compiled_reader in = { view.data(), view.size(), COMPILED_ANIMATION_MAGIC_LEN };
+        int64_t mtime;
+        uint64_t size;
+        string source;
+        uint32_t frame_count, anim_count, sound_count;
+
+        if ( ! in.read(mtime) || ! in.read(size) || ! in.read(source) || ! in.read(frame_count) || ! in.read(anim_count) || ! in.read(sound_count) )
+            return nullptr;
+        if ( check_stamp && (mtime != src_mtime || size != src_size || source != src_path) )
+            return nullptr;
+
+        // Reject counts that could not fit in the file before allocating
+        if ( frame_count > (in.size - in.pos) / sizeof(_compiled_frame) ) return nullptr;
+
+        vector<_compiled_frame> frames(frame_count);
+        for (_compiled_frame &frame : frames)
+        {
+            if ( ! in.read(frame) ) return nullptr;
+            if ( frame.next < -1 || frame.next >= static_cast<int32_t>(frame_count) ) return nullptr;
+            if ( frame.sound < -1 || frame.sound >= static_cast<int32_t>(sound_count) ) return nullptr;
+        }
+
+        vector<id_data> ids(anim_count);
+        for (id_data &id : ids)
+        {
+            int32_t start;
+            if ( ! in.read(start) || ! in.read(id.name) ) return nullptr;
+            if ( start < 0 || start >= static_cast<int32_t>(frame_count) ) return nullptr;
+            id.start_id = start;
+        }
+
+        vector<sound_effect> sounds(sound_count);
+        for (sound_effect &snd : sounds)
+        {
+            string snd_id, snd_file;
+            if ( ! in.read(snd_id) || ! in.read(snd_file) ) return nullptr;
+
+            if ( has_sound_effect(snd_id) || load_sound_effect(snd_id, snd_file) )
+                snd = sound_effect_named(snd_id);
+            else
+            {
+                LOG(WARNING) << "In animation " << filename << ": Cannot find " << snd_id << " sound file " << snd_file;
+                snd = nullptr;
+            }
+        }
+
+        animation_script result = new(_animation_script_data);
+
+        result->id          = ANIMATION_SCRIPT_PTR;
+        result->name        = name;
+        result->filename    = filename;
+        result->anims_in_order = true;
+        result->frames.resize(frame_count);
+
+        for (size_t j = 0; j < frame_count; j++)
+        {
+            animation_frame &frame = result->frames[j];
+
+            frame.index        = static_cast<int>(j);
+            frame.cell_index   = frames[j].cell;
+            frame.duration     = frames[j].duration;
+            frame.movement     = vector_to(frames[j].move_x, frames[j].move_y);
+            frame.sound        = frames[j].sound == -1 ? nullptr : sounds[frames[j].sound];
+            frame.next         = frames[j].next == -1 ? nullptr : &result->frames[frames[j].next];
+        }
+
+        result->animations.resize(anim_count);
+        for (size_t j = 0; j < anim_count; j++)
+        {
+            result->animation_ids[ids[j].name] = static_cast<int>(j);
+            result->animation_names.push_back(ids[j].name);
+            result->animations[j] = ids[j].start_id;
+        }
+
+        return result;
+    }
+
+    template <typename T>
+    static void _write_compiled(std::ofstream &out, const T &value)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    static void _write_compiled(std::ofstream &out, const string &value)
+    {
+        _write_compiled(out, static_cast<uint32_t>(value.size()));
+        out.write(value.data(), value.size());
+    }
+
+    // Write the compiled form of a loaded script. The file is written under
+    // a temporary name and renamed so readers never see half a script.
+    static bool _save_compiled_animation_script(animation_script script, const string &path, const string &src_path, int64_t src_mtime, uint64_t src_size)
+    {
+        vector<sound_effect> sounds;
+        map<sound_effect, int32_t> sound_idx;
+
+        for (const animation_frame &frame : script->frames)
+        {
+            if ( frame.sound && sound_idx.count(frame.sound) == 0 )
+            {
+                sound_idx[frame.sound] = static_cast<int32_t>(sounds.size());
+                sounds.push_back(frame.sound);
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+        string tmp_path = path + ".tmp";
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        if ( ! out ) return false;
+
+        out.write(COMPILED_ANIMATION_MAGIC, COMPILED_ANIMATION_MAGIC_LEN);
+        _write_compiled(out, src_mtime);
+        _write_compiled(out, src_size);
+        _write_compiled(out, src_path);
+        _write_compiled(out, static_cast<uint32_t>(script->frames.size()));
+        _write_compiled(out, static_cast<uint32_t>(script->animations.size()));
+        _write_compiled(out, static_cast<uint32_t>(sounds.size()));
+
+        for (const animation_frame &frame : script->frames)
+        {
+            _compiled_frame data;
+            memset(&data, 0, sizeof(data));
+
+            data.cell       = frame.cell_index;
+            data.duration   = frame.duration;
+            data.move_x     = frame.movement.x;
+            data.move_y     = frame.movement.y;
+            data.next       = frame.next ? frame.next->index : -1;
+            data.sound      = frame.sound ? sound_idx[frame.sound] : -1;
+
+            _write_compiled(out, data);
+        }
+
+        for (size_t j = 0; j < script->animations.size(); j++)
+        {
+            _write_compiled(out, static_cast<int32_t>(script->animations[j]));
+            _write_compiled(out, script->animation_names[j]);
+        }
+
+        for (sound_effect snd : sounds)
+        {
+            _write_compiled(out, sound_effect_name(snd));
+            _write_compiled(out, sound_effect_filename(snd));
+        }
+
+        out.close();
+        if ( ! out || std::rename(tmp_path.c_str(), path.c_str()) != 0 )
+        {
+            std::remove(tmp_path.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    // Read a script from its file without registering it
+    static animation_script _read_animation_script(const string &name, const string &filename)
     {
         animation_script result;
         vector<row_data> rows;
         vector<id_data> ids;
 
         string line, line_id, data;
+        vector<string_view> fields; // the fields of data, split once per line
         int line_no, max_id;
 
         string path = path_to_resource(filename, ANIMATION_RESOURCE);
@@ -63,6 +429,35 @@ namespace splashkit_lib
             return nullptr;
         }
 
+        // Scripts can be shipped already compiled
+        if ( _is_compiled_script_path(path) )
+        {
+            result = _load_compiled_animation_script(name, filename, path, false, "", 0, 0);
+            if ( ! result )
+            {
+                LOG(WARNING) << "Error loading compiled animation script: " + path;
+                return nullptr;
+            }
+
+            return result;
+        }
+
+        // Use the compiled cache when it was built from this version of the source
+        int64_t src_mtime = 0;
+        uint64_t src_size = 0;
+        bool have_stamp = _source_stamp(path, src_mtime, src_size);
+        string compiled_path = _compiled_script_path(path);
+        have_stamp = have_stamp && ! compiled_path.empty();
+
+        if ( have_stamp && file_exists(compiled_path) )
+        {
+            result = _load_compiled_animation_script(name, filename, compiled_path, true, path, src_mtime, src_size);
+            if ( result )
+            {
+                return result;
+            }
+        }
+
         ifstream input(path);
 
         //
@@ -148,14 +543,15 @@ namespace splashkit_lib
             int dur, next, j;
             row_data my_row;
 
-            if ( count_delimiter_with_ranges(data, ',') != 3 )
+            split_delimited_with_ranges(data, ',', fields);
+            if ( fields.size() != 4 )
             {
                 LOG(WARNING) << "Error at line " + to_string(line_no) + " in animation " + filename + ". A multi-frame must have 4 values separated as id-range,cell-range,dur,next";
                 return false;
             }
 
-            process_range(extract_delimited_with_ranges(1, data), id_range);
-            process_range(extract_delimited_with_ranges(2, data), cell_range);
+            process_range(field_at(fields, 1), id_range);
+            process_range(field_at(fields, 2), cell_range);
 
             if (id_range.size() != cell_range.size())
             {
@@ -163,8 +559,8 @@ namespace splashkit_lib
                 return false;
             }
 
-            dur = str_to_int(extract_delimited_with_ranges(3,data), false);
-            next = str_to_int(extract_delimited_with_ranges(4,data), true, -1);
+            dur = str_to_int(field_at(fields, 3), false);
+            next = str_to_int(field_at(fields, 4), true, -1);
 
             for ( j = 0; j < id_range.size(); j++)
             {
@@ -189,14 +585,15 @@ namespace splashkit_lib
         {
             id_data my_id_data;
 
-            if (count_delimiter_with_ranges(data, ',') != 1)
+            split_delimited_with_ranges(data, ',', fields);
+            if (fields.size() != 2)
             {
                 LOG(WARNING) << "Error at line " + to_string(line_no) + " in animation " + filename + ". An id must have 2 values separated as name,start-id";
                 return false;
             }
 
-            my_id_data.name = to_lower(extract_delimited(1, data, ','));
-            my_id_data.start_id = str_to_int(extract_delimited(2,data,','), false);
+            my_id_data.name = to_lower(field_at(fields, 1));
+            my_id_data.start_id = str_to_int(field_at(fields, 2), false);
 
             return add_id(my_id_data);
         };
@@ -206,15 +603,16 @@ namespace splashkit_lib
             int id;
             string snd_id, snd_file;
 
-            if (count_delimiter(data, ',') != 2)
+            split_delimited(data, ',', fields);
+            if (fields.size() != 3)
             {
                 LOG(WARNING) << "Error at line " + to_string(line_no) + " in animation " + filename + ". A sound must have three parts frame #,sound name,sound file.";
                 return;
             }
 
-            id = str_to_int(extract_delimited(1, data, ','), true);
-            snd_id = extract_delimited(2,data,',');
-            snd_file = extract_delimited(3,data,',');
+            id = str_to_int(field_at(fields, 1), true);
+            snd_id = field_at(fields, 2);
+            snd_file = field_at(fields, 3);
 
             if (not has_sound_effect(snd_id))
             {
@@ -238,15 +636,16 @@ namespace splashkit_lib
             double x, y;
             vector_2d v;
 
-            if (count_delimiter(data, ',') != 2)
+            split_delimited_with_ranges(data, ',', fields);
+            if (fields.size() != 3)
             {
                 LOG(WARNING) << "Error at line " + to_string(line_no) + " in animation " + filename + ". A vector must have three parts frame #s, x value, y value.";
                 return;
             }
 
-            process_range(extract_delimited_with_ranges(1, data), id_range);
-            x_val = extract_delimited_with_ranges(2,data);
-            y_val = extract_delimited_with_ranges(3,data);
+            process_range(field_at(fields, 1), id_range);
+            x_val = field_at(fields, 2);
+            y_val = field_at(fields, 3);
 
             if (not try_str_to_double(x_val, x))
             {
@@ -276,8 +675,9 @@ namespace splashkit_lib
         auto process_line = [&]()
         {
             // Split line into id and data
-            line_id = extract_delimited(1, line, ':');
-            data = extract_delimited(2, line, ':');
+            split_delimited(line, ':', fields);
+            line_id = field_at(fields, 1);
+            data = field_at(fields, 2);
 
             // Verify that id is a single char
             if (line_id.length() != 1)
@@ -318,6 +718,7 @@ namespace splashkit_lib
             result->id          = ANIMATION_SCRIPT_PTR;
             result->name        = name;        // name taken from parameter of DoLoadAnimationScript
             result->filename    = filename;    // filename also taken from parameter
+            result->anims_in_order = true;
 
             int j, next_idx;
 
@@ -409,6 +810,7 @@ namespace splashkit_lib
                 if (sum_loop(current) == 0)
                 {
                     free_animation_script(result);
+                    result = nullptr;
                     LOG(WARNING) << "Error in animation " + filename + ". Animation contains a loop with duration 0 starting at cell " + to_string(current->index);
                     return;
                 }
@@ -462,17 +864,77 @@ namespace splashkit_lib
         build_frame_lists();
         check_animation_loops();
 
-        _animation_scripts[name] = result;
+        // Cache the compiled form for next time. Failing to write it only
+        // costs the speed up.
+        if ( result && have_stamp && ! _save_compiled_animation_script(result, compiled_path, path, src_mtime, src_size) )
+            LOG(DEBUG) << "Unable to cache compiled animation script " << compiled_path;
 
         return result;
     }
 
+    animation_script load_animation_script(const string &name, const string &filename)
+    {
+        animation_script result = _read_animation_script(name, filename);
+        if ( result ) _animation_scripts.set(name, result);
+        return result;
+    }
+
+    bool _animation_script_uses_file(const string &path)
+    {
+        for (auto &entry : _animation_scripts.entries())
+        {
+            animation_script script = entry.second;
+            if ( VALID_PTR(script, ANIMATION_SCRIPT_PTR) && same_file(path_to_resource(script->filename, ANIMATION_RESOURCE), path) )
+                return true;
+        }
+        return false;
+    }
+
+    // Read the scripts loaded from path again, keeping the script handles.
+    // Animations using a script restart the animation they were playing.
+    void _reload_animation_scripts_from_file(const string &path)
+    {
+        for (auto &entry : _animation_scripts.entries())
+        {
+            animation_script script = entry.second;
+            if ( INVALID_PTR(script, ANIMATION_SCRIPT_PTR) || ! same_file(path_to_resource(script->filename, ANIMATION_RESOURCE), path) )
+                continue;
+
+            animation_script fresh = _read_animation_script(script->name, script->filename);
+            if ( ! fresh )
+            {
+                LOG(WARNING) << "Keeping the previous version of animation script " << script->name;
+                continue;
+            }
+
+            // Swapping vectors keeps the frame storage, so next pointers stay valid
+            script->frames.swap(fresh->frames);
+            script->animations.swap(fresh->animations);
+            script->animation_names.swap(fresh->animation_names);
+            script->animation_ids.swap(fresh->animation_ids);
+
+            fresh->id = NONE_PTR;
+            delete(fresh);
+
+            for (animation anim : script->anim_objs)
+            {
+                int idx = script->animation_ids.count(anim->animation_name) > 0 ? script->animation_ids[anim->animation_name] : 0;
+
+                if ( script->animations.empty() )
+                {
+                    anim->first_frame = nullptr;
+                    anim->current_frame = nullptr;
+                    anim->last_frame = nullptr;
+                }
+                else
+                    assign_animation(anim, script, idx, false);
+            }
+        }
+    }
+
     animation_script animation_script_named(const string &name)
     {
-        if (has_animation_script(name))
-            return _animation_scripts[name];
-        else
-            return nullptr;
+        return _animation_scripts.find(name);
     }
 
 
@@ -506,12 +968,12 @@ namespace splashkit_lib
     void free_all_animation_scripts()
     {
         string name;
+        animation_script script;
 
         size_t sz = _animation_scripts.size();
 
-        for(size_t i = 0; i < sz; i++)
+        for(size_t i = 0; i < sz && _animation_scripts.first(name, script); i++)
         {
-            animation_script script = _animation_scripts.begin()->second;
             if (VALID_PTR(script, ANIMATION_SCRIPT_PTR))
             {
                 free_animation_script(script);
@@ -519,7 +981,7 @@ namespace splashkit_lib
             else
             {
                 LOG(WARNING) << "Animation Scripts contained an invalid pointer";
-                _animation_scripts.erase(_animation_scripts.begin());
+                _animation_scripts.erase(name);
             }
         }
     }
@@ -532,6 +994,7 @@ namespace splashkit_lib
         {
             using std::swap;
 
+            if (it + 1 != script->anim_objs.end()) script->anims_in_order = false;
             swap(*it, script->anim_objs.back());
             script->anim_objs.pop_back();
         }
@@ -546,15 +1009,13 @@ namespace splashkit_lib
             notify_of_free(ani);
 
             _remove_animation(ani->script, ani);
-            ani->id = NONE_PTR;
-
-            delete(ani); //ani may have been overridden by last call...
+            _release_animation(ani);
         }
     }
 
     bool has_animation_script(const string &name)
     {
-        return _animation_scripts.count(name) > 0;
+        return _animation_scripts.contains(name);
     }
 
 
@@ -708,7 +1169,9 @@ namespace splashkit_lib
         {
             if (anim->script)
                 _remove_animation(anim->script, anim);   // remove from old script
+            anim->script = script;
             script->anim_objs.push_back(anim);       // add to new script
+            _animation_added(script);
         }
 
         anim->first_frame        = &script->frames[script->animations[idx]];
@@ -794,7 +1257,7 @@ namespace splashkit_lib
             return result;
         }
 
-        result = new(_animation_data);
+        result = _alloc_animation();
 
         result->id = ANIMATION_PTR;
         result->current_frame = nullptr;
@@ -806,6 +1269,7 @@ namespace splashkit_lib
         result->frame_time = 0;
 
         script->anim_objs.push_back(result);
+        _animation_added(script);
 
         assign_animation(result, script, idx, with_sound);
 
@@ -896,4 +1360,258 @@ namespace splashkit_lib
             anim->entered_frame  = false;
         }
     }
+
+    void update_animation_by_time(animation anim, double seconds)
+    {
+        update_animation_by_time(anim, seconds, true, true);
+    }
+
+    void update_animation_by_time(animation anim, double seconds, bool with_sound)
+    {
+        update_animation_by_time(anim, seconds, with_sound, true);
+    }
+
+    // Move the animation on by ticks, collecting the sounds of frames entered
+    // or recording an event for each frame when events are wanted
+    static void _advance_animation(animation anim, float ticks, bool with_sound, bool coalesce_sounds, vector<sound_effect> &sounds, vector<animation_frame_event> *events)
+    {
+        anim->frame_time = anim->frame_time + ticks;
+        anim->entered_frame = false;
+
+        animation_frame *start = anim->current_frame;
+        float loop_time = 0;
+
+        while (ASSIGNED(anim->current_frame) and anim->frame_time >= anim->current_frame->duration)
+        {
+            loop_time += anim->current_frame->duration;
+            anim->frame_time = anim->frame_time - anim->current_frame->duration;
+            anim->last_frame = anim->current_frame;
+            anim->current_frame = anim->current_frame->next;
+            anim->entered_frame = true;
+
+            if (not ASSIGNED(anim->current_frame)) break;
+
+            if (events)
+            {
+                events->push_back({anim, anim->current_frame->cell_index, anim->current_frame->sound});
+            }
+            else if (ASSIGNED(anim->current_frame->sound) and with_sound)
+            {
+                if (not coalesce_sounds or std::find(sounds.begin(), sounds.end(), anim->current_frame->sound) == sounds.end())
+                    sounds.push_back(anim->current_frame->sound);
+            }
+
+            // Back at the start of a loop, so skip whole trips around it.
+            // Loops always contain a frame with a duration, so loop_time > 0.
+            if (anim->current_frame == start and loop_time > 0 and anim->frame_time >= loop_time)
+            {
+                anim->frame_time = std::fmod(anim->frame_time, loop_time);
+            }
+        }
+    }
+
+    void update_animation_by_time(animation anim, double seconds, bool with_sound, bool coalesce_sounds)
+    {
+        if (animation_ended(anim)) return;
+
+        vector<sound_effect> sounds;
+        _advance_animation(anim, static_cast<float>(seconds * ANIMATION_UPDATES_PER_SECOND), with_sound, coalesce_sounds, sounds, nullptr);
+
+        for (sound_effect effect : sounds)
+        {
+            play_sound_effect(effect);
+        }
+    }
+
+    static void _update_animations(animation_script script, double seconds, bool with_sound, vector<animation_frame_event> *events)
+    {
+        if (INVALID_PTR(script, ANIMATION_SCRIPT_PTR))
+        {
+            LOG(WARNING) << "Attempting to update the animations of an invalid animation script";
+            return;
+        }
+
+        // Walk the animations in memory order, so the pass runs through each pool block in turn
+        if (not script->anims_in_order)
+        {
+            std::sort(script->anim_objs.begin(), script->anim_objs.end());
+            script->anims_in_order = true;
+        }
+
+        float ticks = static_cast<float>(seconds * ANIMATION_UPDATES_PER_SECOND);
+        static vector<sound_effect> sounds;
+        sounds.clear();
+
+        for (animation anim : script->anim_objs)
+        {
+            if (animation_ended(anim)) continue;
+            _advance_animation(anim, ticks, with_sound, true, sounds, events);
+        }
+
+        for (sound_effect effect : sounds)
+        {
+            play_sound_effect(effect);
+        }
+    }
+
+    void update_animations(animation_script script, double seconds)
+    {
+        _update_animations(script, seconds, true, nullptr);
+    }
+
+    void update_animations(animation_script script, double seconds, bool with_sound)
+    {
+        _update_animations(script, seconds, with_sound, nullptr);
+    }
+
+    void update_animations(animation_script script, double seconds, vector<animation_frame_event> &out_events)
+    {
+        out_events.clear();
+        _update_animations(script, seconds, false, &out_events);
+    }
+
+    //
+    // Animation states
+    //
+    // A state is the index of its frame in the script's frames. Once ended
+    // the frame is -1 - the last frame, so the last cell can still be drawn.
+    //
+
+    static const animation_state _ended_animation_state = { -1, 0 };
+
+    animation_state start_animation_state(animation_script script, int idx)
+    {
+        if (INVALID_PTR(script, ANIMATION_SCRIPT_PTR))
+        {
+            LOG(WARNING) << "Attempting to start an animation state from an invalid animation script";
+            return _ended_animation_state;
+        }
+
+        if ((idx < 0) or (idx >= script->animations.size()))
+        {
+            LOG(WARNING) << "Unable to start animation state number " + to_string(idx) + " from script " + script->name;
+            return _ended_animation_state;
+        }
+
+        return { script->animations[idx], 0 };
+    }
+
+    animation_state start_animation_state(animation_script script, const string &name)
+    {
+        return start_animation_state(script, animation_index(script, name));
+    }
+
+    // Move the state on by ticks, collecting the sound of each frame entered
+    static bool _advance_animation_state(animation_script script, animation_state &state, float ticks, vector<sound_effect> *sounds)
+    {
+        if (state.frame < 0) return false;
+
+        if (state.frame >= script->frames.size())
+        {
+            // The script was reloaded with fewer frames
+            state = _ended_animation_state;
+            return false;
+        }
+
+        const animation_frame *start = &script->frames[state.frame];
+        const animation_frame *current = start;
+        float loop_time = 0;
+        bool entered = false;
+
+        state.frame_time += ticks;
+
+        while (state.frame_time >= current->duration)
+        {
+            loop_time += current->duration;
+            state.frame_time -= current->duration;
+            entered = true;
+
+            if (not ASSIGNED(current->next))
+            {
+                state.frame = -1 - current->index;
+                return true;
+            }
+
+            current = current->next;
+
+            if (sounds and ASSIGNED(current->sound) and std::find(sounds->begin(), sounds->end(), current->sound) == sounds->end())
+                sounds->push_back(current->sound);
+
+            if (current == start and loop_time > 0 and state.frame_time >= loop_time)
+                state.frame_time = std::fmod(state.frame_time, loop_time);
+        }
+
+        state.frame = current->index;
+        return entered;
+    }
+
+    bool advance_animation_state(animation_script script, animation_state &state, double seconds)
+    {
+        if (INVALID_PTR(script, ANIMATION_SCRIPT_PTR))
+        {
+            LOG(WARNING) << "Attempting to advance an animation state with an invalid animation script";
+            return false;
+        }
+
+        return _advance_animation_state(script, state, static_cast<float>(seconds * ANIMATION_UPDATES_PER_SECOND), nullptr);
+    }
+
+    void advance_animation_states(animation_script script, vector<animation_state> &states, double seconds, bool with_sound)
+    {
+        if (INVALID_PTR(script, ANIMATION_SCRIPT_PTR))
+        {
+            LOG(WARNING) << "Attempting to advance animation states with an invalid animation script";
+            return;
+        }
+
+        float ticks = static_cast<float>(seconds * ANIMATION_UPDATES_PER_SECOND);
+        static vector<sound_effect> sounds;
+        sounds.clear();
+
+        for (animation_state &state : states)
+        {
+            _advance_animation_state(script, state, ticks, with_sound ? &sounds : nullptr);
+        }
+
+        for (sound_effect effect : sounds)
+        {
+            play_sound_effect(effect);
+        }
+    }
+
+    // The frame the state is up to, or last showed if it has ended
+    static const animation_frame *_animation_state_frame(animation_script script, const animation_state &state)
+    {
+        if (INVALID_PTR(script, ANIMATION_SCRIPT_PTR)) return nullptr;
+
+        int idx = state.frame < 0 ? -1 - state.frame : state.frame;
+        if (idx >= script->frames.size()) return nullptr;
+
+        return &script->frames[idx];
+    }
+
+    int animation_state_cell(animation_script script, const animation_state &state)
+    {
+        const animation_frame *frame = _animation_state_frame(script, state);
+        return frame ? frame->cell_index : -1;
+    }
+
+    vector_2d animation_state_vector(animation_script script, const animation_state &state)
+    {
+        const animation_frame *frame = _animation_state_frame(script, state);
+        if (not frame or animation_state_ended(state)) return vector_to(0, 0);
+        return frame->movement;
+    }
+
+    bool animation_state_ended(const animation_state &state)
+    {
+        return state.frame < 0;
+    }
+
+    // Used by sprites updated on worker threads, which play the sound later
+    sound_effect _animation_entered_frame_sound(animation anim)
+    {
+        if ( animation_ended(anim) or not anim->entered_frame ) return nullptr;
+        return anim->current_frame->sound;
+    }
 }
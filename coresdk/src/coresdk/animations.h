@@ -14,12 +14,45 @@
 
 #include "types.h"
 #include "drawing_options.h"
+#include "sound.h"
 
 #include <string>
+#include <vector>
 using std::string;
+using std::vector;
 
 namespace splashkit_lib
 {
+    /**
+     * Records an animation entering a new frame during `update_animations`.
+     *
+     * @field anim      The `animation` that entered the frame
+     * @field cell      The cell drawn for the new frame
+     * @field sound     The sound effect of the new frame, or none
+     */
+    struct animation_frame_event
+    {
+        animation anim;
+        int cell;
+        sound_effect sound;
+    };
+
+    /**
+     * The position of a light weight animation within a script. Many
+     * animation states can play from the one `animation_script`, sharing its
+     * frames, with each state holding only its frame and time. Use these in
+     * place of `animation` objects when you have thousands of instances.
+     *
+     * @field frame         The frame the animation is up to, negative once
+     *                      the animation has ended
+     * @field frame_time    How long has been spent in the frame, in updates
+     */
+    struct animation_state
+    {
+        int frame;
+        float frame_time;
+    };
+
     /**
      * Load animation details from an animation frames file.
      *
@@ -68,6 +101,26 @@ namespace splashkit_lib
      */
     void free_all_animation_scripts();
 
+    /**
+     * Keep the compiled form of loaded animation scripts in files in this
+     * folder, so they load without parsing the next time the program runs. A
+     * compiled script is only used while its source file has the same size
+     * and modification time as when it was compiled. By default this is a
+     * folder within the system's temporary folder. Pass an empty path to
+     * stop caching scripts.
+     *
+     * @param path  The folder for the cache files, which is created if needed
+     */
+    void set_animation_cache_path(const string &path);
+
+    /**
+     * The folder where compiled animation scripts are cached.
+     *
+     * @returns The folder set with `set_animation_cache_path`, or an empty
+     *          string if scripts are not cached
+     */
+    string animation_cache_path();
+
     /**
      * Loads and returns a `animation_script`. The supplied filename is
      * used to locate the `animation_script` to load. The supplied name
@@ -539,6 +592,210 @@ namespace splashkit_lib
      * @attribute suffix    percent_with_sound
      */
     void update_animation(animation anim, float pct, bool with_sound);
+
+    /**
+     * Updates the animation by the time that has passed, moving on as many
+     * frames as that time covers. Frame durations are counted in updates, run
+     * 60 times each second, so the animation plays at the same speed whatever
+     * the frame rate. The sound of each frame entered is played once, even
+     * when several frames with that sound are passed in the one update.
+     *
+     * @param anim          The `animation` to update.
+     * @param seconds       The time since the animation was last updated
+     *
+     * @attribute class     animation
+     * @attribute method    update_by_time
+     * @attribute self      anim
+     */
+    void update_animation_by_time(animation anim, double seconds);
+
+    /**
+     * Updates the animation by the time that has passed, moving on as many
+     * frames as that time covers. The sound of each frame entered is played
+     * once, even when several frames with that sound are passed.
+     *
+     * @param anim          The `animation` to update.
+     * @param seconds       The time since the animation was last updated
+     * @param with_sound    Denotes whether the `animation` should play audio.
+     *
+     * @attribute class     animation
+     * @attribute method    update_by_time
+     * @attribute self      anim
+     *
+     * @attribute suffix    with_sound
+     */
+    void update_animation_by_time(animation anim, double seconds, bool with_sound);
+
+    /**
+     * Updates the animation by the time that has passed, moving on as many
+     * frames as that time covers.
+     *
+     * @param anim              The `animation` to update.
+     * @param seconds           The time since the animation was last updated
+     * @param with_sound        Denotes whether the `animation` should play audio.
+     * @param coalesce_sounds   True to play each sound once, false to play the
+     *                          sound of every frame entered
+     *
+     * @attribute class     animation
+     * @attribute method    update_by_time
+     * @attribute self      anim
+     *
+     * @attribute suffix    with_sound_coalesced
+     */
+    void update_animation_by_time(animation anim, double seconds, bool with_sound, bool coalesce_sounds);
+
+    /**
+     * Updates all of the animations created from the script by the time
+     * that has passed, in a single pass. Each animation moves on as many
+     * frames as the time covers. Each distinct frame sound is played once,
+     * even when many animations enter frames with that sound.
+     *
+     * @param script        The `animation_script` whose animations are updated
+     * @param seconds       The time since the animations were last updated
+     *
+     * @attribute class     animation_script
+     * @attribute method    update_animations
+     * @attribute self      script
+     */
+    void update_animations(animation_script script, double seconds);
+
+    /**
+     * Updates all of the animations created from the script by the time
+     * that has passed, in a single pass.
+     *
+     * @param script        The `animation_script` whose animations are updated
+     * @param seconds       The time since the animations were last updated
+     * @param with_sound    Denotes whether the animations should play audio.
+     *
+     * @attribute class     animation_script
+     * @attribute method    update_animations
+     * @attribute self      script
+     *
+     * @attribute suffix    with_sound
+     */
+    void update_animations(animation_script script, double seconds, bool with_sound);
+
+    /**
+     * Updates all of the animations created from the script by the time
+     * that has passed, in a single pass. No sounds are played. Instead an
+     * event is recorded for each frame entered, so the caller can play
+     * sounds or react to frames itself.
+     *
+     * @param script        The `animation_script` whose animations are updated
+     * @param seconds       The time since the animations were last updated
+     * @param out_events    Filled with an event for each frame entered
+     *
+     * @attribute class     animation_script
+     * @attribute method    update_animations
+     * @attribute self      script
+     *
+     * @attribute suffix    with_events
+     */
+    void update_animations(animation_script script, double seconds, vector<animation_frame_event> &out_events);
+
+    /**
+     * Start a light weight animation state at the first frame of one of the
+     * script's animations.
+     *
+     * @param script    The `animation_script` holding the frames
+     * @param idx       The index of the animation to start
+     * @returns         The state at the start of the animation, or an ended
+     *                  state if the script or index is invalid
+     *
+     * @attribute class     animation_script
+     * @attribute method    start_state
+     * @attribute self      script
+     */
+    animation_state start_animation_state(animation_script script, int idx);
+
+    /**
+     * Start a light weight animation state at the first frame of the named
+     * animation from the script.
+     *
+     * @param script    The `animation_script` holding the frames
+     * @param name      The name of the animation to start
+     * @returns         The state at the start of the animation, or an ended
+     *                  state if the script or name is invalid
+     *
+     * @attribute class     animation_script
+     * @attribute method    start_state
+     * @attribute self      script
+     *
+     * @attribute suffix    named
+     */
+    animation_state start_animation_state(animation_script script, const string &name);
+
+    /**
+     * Move an animation state on by the time that has passed, using the
+     * frames of the script it was started from. No sounds are played.
+     *
+     * @param script    The `animation_script` the state was started from
+     * @param state     The state to update
+     * @param seconds   The time since the state was last updated
+     * @returns         True if the state entered a new frame
+     *
+     * @attribute class     animation_script
+     * @attribute method    advance_state
+     * @attribute self      script
+     */
+    bool advance_animation_state(animation_script script, animation_state &state, double seconds);
+
+    /**
+     * Move a list of animation states on by the time that has passed, all
+     * using the frames of the one script. Each distinct frame sound is
+     * played once.
+     *
+     * @param script        The `animation_script` the states were started from
+     * @param states        The states to update
+     * @param seconds       The time since the states were last updated
+     * @param with_sound    Denotes whether frame sounds should be played.
+     *
+     * @attribute class     animation_script
+     * @attribute method    advance_states
+     * @attribute self      script
+     */
+    void advance_animation_states(animation_script script, vector<animation_state> &states, double seconds, bool with_sound);
+
+    /**
+     * The cell to draw for an animation state. Once the animation has ended
+     * this is the cell of its last frame.
+     *
+     * @param script    The `animation_script` the state was started from
+     * @param state     The animation state
+     * @returns         The cell of the current frame, or -1 if the state is
+     *                  not valid for the script
+     *
+     * @attribute class     animation_script
+     * @attribute method    state_cell
+     * @attribute self      script
+     */
+    int animation_state_cell(animation_script script, const animation_state &state);
+
+    /**
+     * The movement of the current frame of an animation state.
+     *
+     * @param script    The `animation_script` the state was started from
+     * @param state     The animation state
+     * @returns         The movement of the current frame, or a zero vector
+     *                  once the animation has ended
+     *
+     * @attribute class     animation_script
+     * @attribute method    state_vector
+     * @attribute self      script
+     */
+    vector_2d animation_state_vector(animation_script script, const animation_state &state);
+
+    /**
+     * Check if an animation state has reached the end of its animation.
+     *
+     * @param state     The animation state
+     * @returns         True if the animation has ended
+     *
+     * @attribute class     animation_state
+     * @attribute method    ended
+     * @attribute self      state
+     */
+    bool animation_state_ended(const animation_state &state);
 }
 
 #endif /* animations_h */
@@ -0,0 +1,621 @@
+//
+//  asset_streaming.cpp
+//  splashkit
+//
+//  Each frame the camera's view is compared against the regions. Assets of
+//  regions near the view, or near where the camera is heading, are decoded
+//  on the shared worker pool, nearest first, with only a few decodes in
+//  flight so that nearer assets do not queue behind farther ones. Decoded
+//  assets are registered on the main thread within a small time budget.
+//  Assets near the camera are retained so the resource budget does not
+//  evict them; those left behind are released, and when memory is over the
+//  budget their data is evicted farthest first. Eviction keeps the bitmaps
+//  and sound effects themselves, so handles given out stay valid and
+//  streaming later decodes their data back into them.
+//
+
+#include "asset_streaming.h"
+
+#include "audio.h"
+#include "camera.h"
+#include "rectangle_geometry.h"
+#include "sound.h"
+#include "vector_2d.h"
+#include "window_manager.h"
+
+#include "audio_driver.h"
+#include "concurrency_utils.h"
+#include "core_driver.h"
+#include "graphics_driver.h"
+#include "resource_tracking.h"
+#include "utility_functions.h"
+#include "utils_driver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+using std::ifstream;
+using std::make_shared;
+using std::map;
+using std::shared_ptr;
+using std::to_string;
+using std::vector;
+
+// The number of assets decoding at once
+#define STREAM_MAX_LOADS 4
+
+// Main thread time spent registering decoded assets each frame
+#define STREAM_FINISH_BUDGET_MS 2
+
+// How many frames ahead of the camera's movement assets are loaded
+#define STREAM_LOOKAHEAD_FRAMES 30
+
+#define STREAM_PLACEHOLDER_NAME "splashkit_streaming_placeholder"
+#define STREAM_PLACEHOLDER_SIZE 32
+
+namespace splashkit_lib
+{
+    // from images and sound
+    bitmap _register_loaded_bitmap(const string &name, const string &file_path, sk_drawing_surface surface, bool reloadable);
+    sound_effect _register_loaded_sound_effect(const string &name, const string &file_path, sk_sound_data data, bool reloadable);
+    void _restore_evicted_bitmap(bitmap bmp, SDL_Surface *decoded);
+    void _restore_evicted_sound_effect(sound_effect effect, sk_sound_data data);
+
+    // from bundles
+    resource_kind string_to_resource_kind(const string &txt);
+
+    struct _streamed_asset
+    {
+        resource_kind kind;
+        string name;
+        string path;
+
+        bool loading = false;   // a decode is in flight
+        void *resource = nullptr; // the bitmap or sound effect streaming registered
+        bool retained = false;
+        bool urgent = false;    // asked for this frame while not ready
+
+        // Worked out each frame
+        bool wanted = false;
+        bool keep = false;
+        double distance = 0;
+    };
+
+    struct _streaming_region
+    {
+        string name;
+        rectangle area;
+        vector<int> assets;
+    };
+
+    struct _stream_load
+    {
+        int asset;              // -1 once abandoned
+        resource_kind kind;
+        string path;
+
+        // Filled in on the worker thread
+        string file_path;
+        SDL_Surface *image = nullptr;
+        sk_decoded_sound *sound = nullptr;
+        atomic<bool> ready{false};
+    };
+
+    static vector<_streaming_region> _streaming_regions;
+    static map<string, int> _streaming_region_index;
+    static vector<_streamed_asset> _streamed_assets;
+    static map<string, int> _streamed_asset_index;
+    static vector<shared_ptr<_stream_load>> _stream_loads;
+
+    static double _stream_distance = 512;
+    static point_2d _stream_last_camera = { 0, 0 };
+    static vector_2d _stream_velocity = { 0, 0 };
+    static bool _stream_camera_known = false;
+    static string _stream_placeholder = STREAM_PLACEHOLDER_NAME;
+
+    static string _asset_key(resource_kind kind, const string &name)
+    {
+        return to_string(static_cast<int>(kind)) + ":" + name;
+    }
+
+    // Ready when registered with its data, which the budget may have evicted.
+    // Assets loaded other than by streaming are ready once they are loaded.
+    static bool _asset_resident(const _streamed_asset &asset)
+    {
+        if ( asset.resource ) return ! _resource_evicted(asset.resource);
+
+        if ( asset.kind == IMAGE_RESOURCE )
+            return has_bitmap(asset.name);
+        else
+            return has_sound_effect(asset.name);
+    }
+
+    // Assets streaming registered may still be freed by the program
+    static void _forget_streamed_asset(void *resource)
+    {
+        for (_streamed_asset &asset : _streamed_assets)
+        {
+            if ( asset.resource == resource ) asset.resource = nullptr;
+        }
+    }
+
+    static void _release_streamed_asset(_streamed_asset &asset)
+    {
+        if ( asset.retained )
+        {
+            release_resource(asset.kind, asset.name);
+            asset.retained = false;
+        }
+    }
+
+    static void _free_streamed_asset(_streamed_asset &asset)
+    {
+        _release_streamed_asset(asset);
+
+        void *resource = asset.resource;
+        asset.resource = nullptr;
+        if ( ! resource ) return;
+
+        if ( asset.kind == IMAGE_RESOURCE )
+            free_bitmap(static_cast<bitmap>(resource));
+        else
+            free_sound_effect(static_cast<sound_effect>(resource));
+    }
+
+    void add_streaming_region(const string &name, const rectangle &area)
+    {
+        if ( has_streaming_region(name) )
+        {
+            LOG(WARNING) << "Attempting to add streaming region " << name << " twice";
+            return;
+        }
+
+        _streaming_region_index[name] = static_cast<int>(_streaming_regions.size());
+        _streaming_regions.push_back({ name, area, {} });
+    }
+
+    void add_streaming_asset(const string &region, resource_kind kind, const string &name, const string &filename)
+    {
+        auto region_it = _streaming_region_index.find(region);
+        if ( region_it == _streaming_region_index.end() )
+        {
+            LOG(WARNING) << "Attempting to add asset " << name << " to unknown streaming region " << region;
+            return;
+        }
+
+        if ( kind != IMAGE_RESOURCE && kind != SOUND_RESOURCE )
+        {
+            LOG(WARNING) << "Unable to stream asset " << name << ", only bitmaps and sound effects can be streamed";
+            return;
+        }
+
+        string key = _asset_key(kind, name);
+        auto asset_it = _streamed_asset_index.find(key);
+        int idx;
+
+        if ( asset_it == _streamed_asset_index.end() )
+        {
+            idx = static_cast<int>(_streamed_assets.size());
+            _streamed_asset_index[key] = idx;
+
+            _streamed_asset asset;
+            asset.kind = kind;
+            asset.name = name;
+            asset.path = filename;
+            _streamed_assets.push_back(asset);
+        }
+        else
+        {
+            idx = asset_it->second;
+            if ( _streamed_assets[idx].path != filename )
+                LOG(WARNING) << "Streamed asset " << name << " is already loaded from " << _streamed_assets[idx].path << ", ignoring " << filename;
+        }
+
+        vector<int> &assets = _streaming_regions[region_it->second].assets;
+        if ( std::find(assets.begin(), assets.end(), idx) == assets.end() )
+            assets.push_back(idx);
+    }
+
+    void load_streaming_manifest(const string &filename)
+    {
+        string path = path_to_resource(filename, BUNDLE_RESOURCE);
+
+        ifstream input(path);
+        if ( ! input )
+        {
+            LOG(WARNING) << "Unable to locate streaming manifest " << filename << " (" << path << ")";
+            return;
+        }
+
+        string line, region;
+        int line_no = 0;
+        vector<string_view> fields; // reused for each line
+
+        while ( std::getline(input, line) )
+        {
+            line_no++;
+            line = trim(line);
+
+            if ( line.length() == 0 ) continue;
+            if ( line.substr(0, 2) == "//" ) continue;
+
+            split_delimited(line, ',', fields);
+            string kind = trim(field_at(fields, 1));
+            to_upper(kind);
+            string name = trim(field_at(fields, 2));
+
+            if ( name.length() == 0 )
+            {
+                LOG(WARNING) << "Name missing at line " << line_no << " of streaming manifest " << filename;
+                continue;
+            }
+
+            if ( kind == "REGION" )
+            {
+                if ( fields.size() != 6 )
+                {
+                    LOG(WARNING) << "Expected REGION,name,x,y,width,height at line " << line_no << " of streaming manifest " << filename;
+                    region = "";
+                    continue;
+                }
+
+                region = name;
+                add_streaming_region(name, rectangle_from(str_to_double(field_at(fields, 3)),
+                                                          str_to_double(field_at(fields, 4)),
+                                                          str_to_double(field_at(fields, 5)),
+                                                          str_to_double(field_at(fields, 6))));
+                continue;
+            }
+
+            if ( region.length() == 0 )
+            {
+                LOG(WARNING) << "Asset at line " << line_no << " of streaming manifest " << filename << " is not within a region";
+                continue;
+            }
+
+            string asset_path = trim(field_at(fields, 3));
+            if ( asset_path.length() == 0 )
+            {
+                LOG(WARNING) << "File missing for asset at line " << line_no << " of streaming manifest " << filename;
+                continue;
+            }
+
+            add_streaming_asset(region, string_to_resource_kind(kind), name, asset_path);
+        }
+    }
+
+    bool has_streaming_region(const string &name)
+    {
+        return _streaming_region_index.count(name) > 0;
+    }
+
+    void free_all_streaming_regions()
+    {
+        for (_streamed_asset &asset : _streamed_assets)
+            _free_streamed_asset(asset);
+
+        // Decodes still in flight are cleaned up as they finish
+        for (auto &load : _stream_loads)
+            load->asset = -1;
+
+        _streaming_regions.clear();
+        _streaming_region_index.clear();
+        _streamed_assets.clear();
+        _streamed_asset_index.clear();
+        _stream_camera_known = false;
+        _stream_velocity = vector_to(0, 0);
+    }
+
+    void set_asset_streaming_distance(double distance)
+    {
+        _stream_distance = distance < 0 ? 0 : distance;
+    }
+
+    double asset_streaming_distance()
+    {
+        return _stream_distance;
+    }
+
+    void set_streaming_placeholder(bitmap placeholder)
+    {
+        if ( ! bitmap_valid(placeholder) )
+        {
+            LOG(WARNING) << "Attempting to set the streaming placeholder to an invalid bitmap";
+            return;
+        }
+
+        _stream_placeholder = bitmap_name(placeholder);
+    }
+
+    static bitmap _streaming_placeholder()
+    {
+        if ( has_bitmap(_stream_placeholder) ) return bitmap_named(_stream_placeholder);
+
+        // The placeholder was freed, so fall back to the default
+        _stream_placeholder = STREAM_PLACEHOLDER_NAME;
+        if ( has_bitmap(_stream_placeholder) ) return bitmap_named(_stream_placeholder);
+
+        bitmap result = create_bitmap(_stream_placeholder, STREAM_PLACEHOLDER_SIZE, STREAM_PLACEHOLDER_SIZE);
+        clear_bitmap(result, rgba_color(128, 128, 128, 64));
+        return result;
+    }
+
+    bitmap streamed_bitmap(const string &name)
+    {
+        auto it = _streamed_asset_index.find(_asset_key(IMAGE_RESOURCE, name));
+        if ( it == _streamed_asset_index.end() ) return bitmap_named(name);
+
+        _streamed_asset &asset = _streamed_assets[it->second];
+        if ( _asset_resident(asset) ) return asset.resource ? static_cast<bitmap>(asset.resource) : bitmap_named(name);
+
+        asset.urgent = true;
+        return _streaming_placeholder();
+    }
+
+    bool streamed_asset_ready(resource_kind kind, const string &name)
+    {
+        auto it = _streamed_asset_index.find(_asset_key(kind, name));
+        if ( it == _streamed_asset_index.end() ) return false;
+
+        return _asset_resident(_streamed_assets[it->second]);
+    }
+
+    int asset_streaming_pending()
+    {
+        int result = 0;
+        for (const _streamed_asset &asset : _streamed_assets)
+        {
+            if ( (asset.wanted || asset.urgent) && ! _asset_resident(asset) ) result++;
+        }
+        return result;
+    }
+
+    // Runs on a worker thread, only touching the load itself
+    static void _decode_streamed_asset(_stream_load &load)
+    {
+        load.file_path = file_exists(load.path) ? load.path : path_to_resource(load.path, load.kind);
+
+        if ( file_exists(load.file_path) )
+        {
+            if ( load.kind == IMAGE_RESOURCE )
+                load.image = sk_decode_bitmap(load.file_path.c_str());
+            else
+                load.sound = sk_decode_sound(load.file_path);
+        }
+
+        load.ready.store(true, std::memory_order_release);
+    }
+
+    static void _start_streamed_load(int idx)
+    {
+        _streamed_asset &asset = _streamed_assets[idx];
+
+        auto load = make_shared<_stream_load>();
+        load->asset = idx;
+        load->kind = asset.kind;
+        load->path = asset.path;
+
+        asset.loading = true;
+        _stream_loads.push_back(load);
+
+        shared_worker_pool().add([load]()
+        {
+            _decode_streamed_asset(*load);
+        });
+    }
+
+    // Register the decoded asset, or throw it away if it is no longer needed
+    static void _finish_streamed_load(_stream_load &load)
+    {
+        _streamed_asset *asset = load.asset >= 0 ? &_streamed_assets[load.asset] : nullptr;
+        if ( asset ) asset->loading = false;
+
+        bool use = asset && (asset->keep || asset->urgent) && ! _asset_resident(*asset);
+
+        // Sound effects are made here, as SDL_mixer is only used on the main thread
+        sk_sound_data sound = { SGSD_UNKNOWN, nullptr };
+        if ( use && load.sound ) sound = sk_sound_from_decoded(load.sound);
+        else sk_free_decoded_sound(load.sound);
+        load.sound = nullptr;
+
+        if ( ! use || ! ( load.image || sound._data ) )
+        {
+            if ( asset && use )
+                LOG(WARNING) << "Unable to load streamed asset " << asset->name << " from " << load.path;
+
+            sk_free_decoded_bitmap(load.image);
+            return;
+        }
+
+        // Retain before registering, so registering cannot evict it
+        if ( ! asset->retained )
+        {
+            retain_resource(asset->kind, asset->name);
+            asset->retained = true;
+        }
+
+        static bool forgetting = false;
+        if ( ! forgetting )
+        {
+            register_free_notifier(&_forget_streamed_asset);
+            forgetting = true;
+        }
+
+        // Evicted assets are loaded back into the handles already given out
+        if ( asset->resource && load.kind == IMAGE_RESOURCE )
+            _restore_evicted_bitmap(static_cast<bitmap>(asset->resource), load.image);
+        else if ( asset->resource )
+            _restore_evicted_sound_effect(static_cast<sound_effect>(asset->resource), sound);
+        else if ( load.kind == IMAGE_RESOURCE )
+            asset->resource = _register_loaded_bitmap(asset->name, load.file_path, sk_bitmap_from_decoded(load.image), true);
+        else
+            asset->resource = _register_loaded_sound_effect(asset->name, load.file_path, sound, true);
+    }
+
+    // The gap between two rectangles, or 0 when they overlap
+    static double _rectangle_gap(const rectangle &a, const rectangle &b)
+    {
+        double dx = std::max({ 0.0, b.x - (a.x + a.width), a.x - (b.x + b.width) });
+        double dy = std::max({ 0.0, b.y - (a.y + a.height), a.y - (b.y + b.height) });
+        return sqrt(dx * dx + dy * dy);
+    }
+
+    static rectangle _grow_rectangle(const rectangle &rect, double amount)
+    {
+        return rectangle_from(rect.x - amount, rect.y - amount, rect.width + 2 * amount, rect.height + 2 * amount);
+    }
+
+    static rectangle _rectangle_union(const rectangle &a, const rectangle &b)
+    {
+        double left = std::min(a.x, b.x), top = std::min(a.y, b.y);
+        double right = std::max(a.x + a.width, b.x + b.width), bottom = std::max(a.y + a.height, b.y + b.height);
+        return rectangle_from(left, top, right - left, bottom - top);
+    }
+
+    void update_asset_streaming()
+    {
+        if ( _streaming_regions.empty() && _stream_loads.empty() ) return;
+
+        window wind = current_window();
+        point_2d cam = camera_position();
+        rectangle view = wind ? rectangle_from(cam.x, cam.y, window_width(wind), window_height(wind)) : rectangle_from(cam.x, cam.y, 0, 0);
+
+        // Follow the camera's velocity, treating a jump of more than a screen
+        // as the camera being placed rather than moving
+        if ( _stream_camera_known )
+        {
+            vector_2d step = vector_point_to_point(_stream_last_camera, cam);
+            double limit = std::max({ view.width, view.height, _stream_distance });
+
+            if ( fabs(step.x) > limit || fabs(step.y) > limit )
+                _stream_velocity = vector_to(0, 0);
+            else
+                _stream_velocity = vector_to(_stream_velocity.x * 0.8 + step.x * 0.2, _stream_velocity.y * 0.8 + step.y * 0.2);
+        }
+        _stream_last_camera = cam;
+        _stream_camera_known = true;
+
+        rectangle ahead = view;
+        ahead.x += _stream_velocity.x * STREAM_LOOKAHEAD_FRAMES;
+        ahead.y += _stream_velocity.y * STREAM_LOOKAHEAD_FRAMES;
+
+        rectangle prefetch = _grow_rectangle(_rectangle_union(view, ahead), _stream_distance);
+        rectangle keep = _rectangle_union(prefetch, _grow_rectangle(view, 2 * _stream_distance));
+
+        for (_streamed_asset &asset : _streamed_assets)
+        {
+            asset.wanted = false;
+            asset.keep = false;
+            asset.distance = std::numeric_limits<double>::max();
+        }
+
+        for (const _streaming_region &region : _streaming_regions)
+        {
+            bool wanted = rectangles_intersect(region.area, prefetch);
+            bool kept = rectangles_intersect(region.area, keep);
+            double distance = _rectangle_gap(region.area, view);
+
+            for (int idx : region.assets)
+            {
+                _streamed_asset &asset = _streamed_assets[idx];
+                asset.wanted = asset.wanted || wanted;
+                asset.keep = asset.keep || kept;
+                asset.distance = std::min(asset.distance, distance);
+            }
+        }
+
+        // Retain what is near, and let go of what is left behind
+        long long budget = resource_memory_budget();
+        vector<int> evictable;
+
+        for (int i = 0; i < static_cast<int>(_streamed_assets.size()); i++)
+        {
+            _streamed_asset &asset = _streamed_assets[i];
+            bool keep_asset = asset.keep || asset.urgent;
+
+            if ( keep_asset && asset.resource && ! asset.retained )
+            {
+                retain_resource(asset.kind, asset.name);
+                asset.retained = true;
+            }
+            else if ( ! keep_asset )
+                _release_streamed_asset(asset);
+
+            if ( budget > 0 && ! keep_asset && asset.resource && _asset_resident(asset) )
+                evictable.push_back(i);
+        }
+
+        // Evict the farthest assets until memory is back within the budget.
+        // Without a budget nothing needs to be evicted.
+        if ( ! evictable.empty() && resource_memory_used() > budget )
+        {
+            std::sort(evictable.begin(), evictable.end(), [](int a, int b)
+            {
+                return _streamed_assets[a].distance > _streamed_assets[b].distance;
+            });
+
+            for (int idx : evictable)
+            {
+                _evict_resource(_streamed_assets[idx].resource);
+                if ( resource_memory_used() <= budget ) break;
+            }
+        }
+
+        // Register decoded assets, within the time budget
+        long long start = sk_get_ticks_ns();
+        for (auto it = _stream_loads.begin(); it != _stream_loads.end(); )
+        {
+            if ( ! (*it)->ready.load(std::memory_order_acquire) )
+            {
+                ++it;
+                continue;
+            }
+
+            if ( sk_get_ticks_ns() - start > STREAM_FINISH_BUDGET_MS * 1000000LL ) break;
+
+            _finish_streamed_load(**it);
+            it = _stream_loads.erase(it);
+        }
+
+        // Start decoding the nearest assets that are needed, asked for first
+        int in_flight = static_cast<int>(_stream_loads.size());
+        if ( in_flight < STREAM_MAX_LOADS )
+        {
+            bool decode_audio = audio_ready();
+            vector<int> needed;
+
+            for (int i = 0; i < static_cast<int>(_streamed_assets.size()); i++)
+            {
+                const _streamed_asset &asset = _streamed_assets[i];
+                if ( ! (asset.wanted || asset.urgent) || asset.loading || _asset_resident(asset) ) continue;
+                if ( asset.kind == SOUND_RESOURCE && ! decode_audio ) continue;
+                needed.push_back(i);
+            }
+
+            std::sort(needed.begin(), needed.end(), [](int a, int b)
+            {
+                const _streamed_asset &asset_a = _streamed_assets[a], &asset_b = _streamed_assets[b];
+                if ( asset_a.urgent != asset_b.urgent ) return asset_a.urgent;
+                return asset_a.distance < asset_b.distance;
+            });
+
+            if ( ! needed.empty() ) internal_sk_init();
+
+            for (int idx : needed)
+            {
+                if ( in_flight >= STREAM_MAX_LOADS ) break;
+                _start_streamed_load(idx);
+                in_flight++;
+            }
+        }
+
+        // Assets must be asked for again each frame to stay urgent
+        for (_streamed_asset &asset : _streamed_assets)
+            asset.urgent = false;
+    }
+}
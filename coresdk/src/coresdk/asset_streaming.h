@@ -0,0 +1,150 @@
+/**
+ * @header  asset_streaming
+ * @brief   Asset streaming loads the bitmaps and sounds of a large world
+ *          region by region, as the camera comes near them.
+ *
+ * The world is split into regions, each an area with the assets used
+ * within it. As the camera moves, the assets of regions near the view, and
+ * those it is heading toward, are decoded on background threads and made
+ * ready a few at a time each frame, so moving around never waits on a file.
+ * Assets of regions left far behind are kept until the resource memory
+ * budget is exceeded, when their data is evicted farthest first. Evicting
+ * keeps the bitmap or sound effect itself, so handles to streamed assets
+ * stay valid, and the data is streamed back in when the camera returns, or
+ * loaded straight away if the asset is used before then. Use
+ * `streamed_bitmap` each frame to draw a streamed bitmap, which gives a
+ * placeholder until the bitmap is ready.
+ *
+ * @attribute group  resources
+ * @attribute static asset_streaming
+ */
+
+#ifndef SPLASHKIT_ASSET_STREAMING_H
+#define SPLASHKIT_ASSET_STREAMING_H
+
+#include <string>
+
+#include "images.h"
+#include "resources.h"
+#include "types.h"
+
+using std::string;
+
+namespace splashkit_lib
+{
+    /**
+     * Add a region of the world to stream assets for. Regions may overlap.
+     *
+     * @param name  The name of the region
+     * @param area  The area of the region, in world coordinates
+     */
+    void add_streaming_region(const string &name, const rectangle &area);
+
+    /**
+     * Add an asset used within a region. The asset is loaded when the
+     * camera comes near the region, under the given name. An asset can be
+     * added to several regions, and is kept while any of them is near.
+     * Bitmaps and sound effects can be streamed.
+     *
+     * @param region    The name of the region
+     * @param kind      The kind of asset, `IMAGE_RESOURCE` or `SOUND_RESOURCE`
+     * @param name      The name to load the asset as
+     * @param filename  The file of the asset, within the project's resources
+     */
+    void add_streaming_asset(const string &region, resource_kind kind, const string &name, const string &filename);
+
+    /**
+     * Load regions and their assets from a manifest file in the `bundles`
+     * folder of the project's resources. Each region starts with a line
+     * giving its name and area, followed by a line for each of its assets:
+     *
+     *    ```
+     *    REGION,forest,0,0,2048,2048
+     *    BITMAP,tree,tree.png
+     *    SOUND,birds,birds.wav
+     *    ```
+     *
+     * Lines starting with `//` are ignored.
+     *
+     * @param filename  The manifest file
+     */
+    void load_streaming_manifest(const string &filename);
+
+    /**
+     * Check if a region has been added for streaming.
+     *
+     * @param name  The name of the region
+     * @returns     True if there is a region with that name
+     */
+    bool has_streaming_region(const string &name);
+
+    /**
+     * Remove all streaming regions, freeing the assets that were loaded by
+     * streaming.
+     */
+    void free_all_streaming_regions();
+
+    /**
+     * Set how far beyond the edges of the window assets are loaded. Assets
+     * are kept until their regions are twice this distance away.
+     *
+     * @param distance  The distance, in pixels
+     *
+     * @attribute setter asset_streaming_distance
+     */
+    void set_asset_streaming_distance(double distance);
+
+    /**
+     * How far beyond the edges of the window assets are loaded.
+     *
+     * @returns The distance, in pixels
+     *
+     * @attribute getter asset_streaming_distance
+     */
+    double asset_streaming_distance();
+
+    /**
+     * Set the bitmap drawn in place of streamed bitmaps that are not yet
+     * ready. By default this is a small translucent grey square.
+     *
+     * @param placeholder   The bitmap to use as the placeholder
+     *
+     * @attribute setter streaming_placeholder
+     */
+    void set_streaming_placeholder(bitmap placeholder);
+
+    /**
+     * Get a streamed bitmap to draw. If the bitmap is not yet ready this
+     * returns the placeholder, and loads the bitmap ahead of the others
+     * waiting. Bitmaps that do not stream are returned as by `bitmap_named`.
+     *
+     * @param name  The name of the bitmap
+     * @returns     The bitmap, or the placeholder while it loads
+     */
+    bitmap streamed_bitmap(const string &name);
+
+    /**
+     * Check if a streamed asset is loaded and ready to use.
+     *
+     * @param kind  The kind of asset
+     * @param name  The name of the asset
+     * @returns     True if the asset is ready
+     */
+    bool streamed_asset_ready(resource_kind kind, const string &name);
+
+    /**
+     * The number of assets near the camera that are still loading.
+     *
+     * @returns The number of assets waiting to be ready
+     */
+    int asset_streaming_pending();
+
+    /**
+     * Load and evict streamed assets for the current camera position. This
+     * is called by `process_events`, so you only need to call it if your
+     * program does not process events.
+     */
+    void update_asset_streaming();
+}
+
+#endif /* SPLASHKIT_ASSET_STREAMING_H */
@@ -1,11 +1,15 @@
 #include "audio_driver.h"
+#include "core_driver.h"
 #include "audio.h"
 #include "resources.h"
 #include "backend_types.h"
 #include "utility_functions.h"
 
+#include <cmath>
 #include <iostream>
 #include <map>
+#include <mutex>
+#include <vector>
 
 using std::map;
 
@@ -20,11 +24,275 @@ namespace splashkit_lib
         string filename, name;
     };
 
+    enum _audio_node_kind
+    {
+        AUDIO_GENERATOR_NODE,
+        AUDIO_GAIN_NODE,
+        AUDIO_LOW_PASS_NODE,
+        AUDIO_MIX_NODE
+    };
+
+    struct _audio_node_data
+    {
+        pointer_identifier id;
+        _audio_node_kind kind;
+
+        audio_node inputs[2];
+        audio_mix_handler *generator;
+        double gain, cutoff;
+
+        vector<float> buffer;   // The node's output for the current pass
+        vector<float> history;  // The last low pass output for each channel
+        unsigned long pass;     // The pass the buffer was made in
+    };
+
+    // The graph is evaluated on the audio thread, so changes are locked
+    static std::mutex _audio_graph_lock;
+    static vector<audio_node> _audio_nodes;
+    static audio_node _audio_output = nullptr;
+    static audio_mix_handler *_audio_handler = nullptr;
+    static unsigned long _audio_pass = 0;
+
+    static const vector<float> &_evaluate_audio_node(audio_node node, int frames, int channels, int rate)
+    {
+        // Nodes used by more than one other node are only evaluated once. This
+        // also stops a loop in the graph from recursing forever.
+        if ( node->pass == _audio_pass ) return node->buffer;
+        node->pass = _audio_pass;
+
+        size_t count = static_cast<size_t>(frames) * channels;
+        node->buffer.assign(count, 0.0f);
+        float *out = node->buffer.data();
+
+        switch ( node->kind )
+        {
+            case AUDIO_GENERATOR_NODE:
+                if ( node->generator ) node->generator(out, frames, channels);
+                break;
+
+            case AUDIO_GAIN_NODE:
+                if ( node->inputs[0] )
+                {
+                    const float *in = _evaluate_audio_node(node->inputs[0], frames, channels, rate).data();
+                    float gain = static_cast<float>(node->gain);
+                    for (size_t i = 0; i < count; i++) out[i] = in[i] * gain;
+                }
+                break;
+
+            case AUDIO_LOW_PASS_NODE:
+                if ( node->inputs[0] )
+                {
+                    const float *in = _evaluate_audio_node(node->inputs[0], frames, channels, rate).data();
+
+                    // A one pole filter, each output moves part of the way to the input
+                    float alpha = rate > 0 ? static_cast<float>(1.0 - exp(-2.0 * M_PI * node->cutoff / rate)) : 1.0f;
+                    node->history.resize(channels, 0.0f);
+
+                    for (int f = 0; f < frames; f++)
+                    {
+                        for (int c = 0; c < channels; c++)
+                        {
+                            float &last = node->history[c];
+                            last += alpha * (in[f * channels + c] - last);
+                            out[f * channels + c] = last;
+                        }
+                    }
+                }
+                break;
+
+            case AUDIO_MIX_NODE:
+                for (audio_node input : node->inputs)
+                {
+                    if ( ! input ) continue;
+                    const float *in = _evaluate_audio_node(input, frames, channels, rate).data();
+                    for (size_t i = 0; i < count; i++) out[i] += in[i];
+                }
+                break;
+        }
+
+        return node->buffer;
+    }
+
+    // Called on the audio thread by the backend with the mixed output
+    static void _audio_mix(float *samples, int frames, int channels, int rate)
+    {
+        std::lock_guard<std::mutex> lock(_audio_graph_lock);
+
+        if ( _audio_output )
+        {
+            _audio_pass++;
+            const vector<float> &out = _evaluate_audio_node(_audio_output, frames, channels, rate);
+            size_t count = static_cast<size_t>(frames) * channels;
+            for (size_t i = 0; i < count; i++) samples[i] += out[i];
+        }
+
+        if ( _audio_handler ) _audio_handler(samples, frames, channels);
+    }
+
+    // Only ask the backend for the mixed output while something will use it.
+    // Called without the lock, as the backend locks the audio device, which is
+    // held while _audio_mix runs.
+    static void _update_audio_mix()
+    {
+        bool needed;
+        {
+            std::lock_guard<std::mutex> lock(_audio_graph_lock);
+            needed = _audio_output || _audio_handler;
+        }
+
+        sk_set_audio_mix_fn( needed ? _audio_mix : nullptr );
+    }
+
+    static audio_node _create_audio_node(_audio_node_kind kind, audio_node input1, audio_node input2)
+    {
+        if ( (input1 && INVALID_PTR(input1, AUDIO_NODE_PTR)) || (input2 && INVALID_PTR(input2, AUDIO_NODE_PTR)) )
+        {
+            LOG(WARNING) << "Attempting to create an audio node with an invalid input node";
+            return nullptr;
+        }
+
+        audio_node result = new _audio_node_data();
+        result->id = AUDIO_NODE_PTR;
+        result->kind = kind;
+        result->inputs[0] = input1;
+        result->inputs[1] = input2;
+        result->generator = nullptr;
+        result->gain = 1.0;
+        result->cutoff = 0.0;
+        result->pass = 0;
+
+        std::lock_guard<std::mutex> lock(_audio_graph_lock);
+        _audio_nodes.push_back(result);
+        return result;
+    }
+
+    int audio_sample_rate()
+    {
+        if ( ! sk_audio_is_open() ) return 0;
+        return sk_read_system_data()->audio_specs.audio_rate;
+    }
+
+    void set_audio_mix_handler(audio_mix_handler *handler)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_audio_graph_lock);
+            _audio_handler = handler;
+        }
+
+        _update_audio_mix();
+    }
+
+    audio_node create_audio_generator(audio_mix_handler *generator)
+    {
+        audio_node result = _create_audio_node(AUDIO_GENERATOR_NODE, nullptr, nullptr);
+        if ( result ) result->generator = generator;
+        return result;
+    }
+
+    audio_node create_audio_gain(audio_node input, double gain)
+    {
+        audio_node result = _create_audio_node(AUDIO_GAIN_NODE, input, nullptr);
+        if ( result ) result->gain = gain;
+        return result;
+    }
+
+    audio_node create_audio_low_pass(audio_node input, double cutoff)
+    {
+        audio_node result = _create_audio_node(AUDIO_LOW_PASS_NODE, input, nullptr);
+        if ( result ) result->cutoff = cutoff < 0 ? 0 : cutoff;
+        return result;
+    }
+
+    audio_node create_audio_mix(audio_node input1, audio_node input2)
+    {
+        return _create_audio_node(AUDIO_MIX_NODE, input1, input2);
+    }
+
+    void set_audio_node_gain(audio_node node, double gain)
+    {
+        if ( INVALID_PTR(node, AUDIO_NODE_PTR) || node->kind != AUDIO_GAIN_NODE )
+        {
+            LOG(WARNING) << "Attempting to set the gain of an audio node that is not a gain node";
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_audio_graph_lock);
+        node->gain = gain;
+    }
+
+    void set_audio_node_cutoff(audio_node node, double cutoff)
+    {
+        if ( INVALID_PTR(node, AUDIO_NODE_PTR) || node->kind != AUDIO_LOW_PASS_NODE )
+        {
+            LOG(WARNING) << "Attempting to set the cutoff of an audio node that is not a low pass node";
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_audio_graph_lock);
+        node->cutoff = cutoff < 0 ? 0 : cutoff;
+    }
+
+    void free_audio_node(audio_node node)
+    {
+        if ( INVALID_PTR(node, AUDIO_NODE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to free an invalid audio node";
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_audio_graph_lock);
+
+            for (audio_node other : _audio_nodes)
+            {
+                if ( other->inputs[0] == node ) other->inputs[0] = nullptr;
+                if ( other->inputs[1] == node ) other->inputs[1] = nullptr;
+            }
+
+            erase_from_vector(_audio_nodes, node);
+
+            if ( _audio_output == node ) _audio_output = nullptr;
+        }
+
+        _update_audio_mix();
+
+        node->id = NONE_PTR;
+        delete node;
+    }
+
+    void set_audio_output(audio_node node)
+    {
+        if ( node && INVALID_PTR(node, AUDIO_NODE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set an invalid audio node as the audio output";
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_audio_graph_lock);
+            _audio_output = node;
+        }
+
+        _update_audio_mix();
+    }
+
     void open_audio()
     {
         sk_open_audio();
     }
 
+    void open_audio(int frequency, int channels, int buffer_size)
+    {
+        if ( frequency <= 0 || channels <= 0 || buffer_size <= 0 || (buffer_size & (buffer_size - 1)) != 0 )
+        {
+            LOG(WARNING) << "Invalid audio settings passed to open_audio, using the default settings.";
+            sk_open_audio();
+            return;
+        }
+
+        sk_open_audio(frequency, channels, buffer_size);
+    }
+
     void close_audio()
     {
         sk_close_audio();
@@ -17,11 +17,53 @@
 #define sk_audio
 namespace splashkit_lib
 {
+    /**
+     * An audio mix handler works with audio samples as they are played. The
+     * samples are floats between `-1` and `1`, with the channels of each
+     * frame next to each other, so a stereo buffer is left, right, left,
+     * right. The handler is called on the audio thread, so it must be quick
+     * and must not call other SplashKit functions.
+     *
+     * @param samples       The samples to read or change
+     * @param frame_count   The number of frames, each with a sample for
+     *                      each channel
+     * @param channels      The number of channels in each frame
+     */
+    typedef void (audio_mix_handler)(float *samples, int frame_count, int channels);
+
+    /**
+     * An audio node makes or changes sound as it is played. Connect nodes
+     * together, and set the last one as the audio output, to play sound you
+     * create in your program as it runs.
+     *
+     * @attribute class audio_node
+     */
+    typedef struct _audio_node_data *audio_node;
+
     /**
      * Starts the SplashKit audio system working.
      */
     void open_audio();
 
+    /**
+     * Starts the SplashKit audio system working, with the settings you
+     * choose. A smaller buffer means sounds start sooner after you play them,
+     * which matters for music and rhythm games, but needs the computer to
+     * keep up with a faster stream of audio. 256 to 1024 samples suits most
+     * computers. The settings are used when audio is first opened, so close
+     * audio before opening it with new settings.
+     *
+     * @param frequency     The number of samples played each second, such as
+     *                      `44100` or `48000`.
+     * @param channels      The number of output channels, `1` for mono or `2`
+     *                      for stereo.
+     * @param buffer_size   The number of samples mixed at a time. This must be
+     *                      a power of two.
+     *
+     * @attribute suffix    with_settings
+     */
+    void open_audio(int frequency, int channels, int buffer_size);
+
     /**
      * Turns off audio, stopping all current sounds effects and music.
      */
@@ -38,6 +80,118 @@ namespace splashkit_lib
      * @attribute getter is_ready
      */
     bool audio_ready();
+
+    /**
+     * The number of samples played each second while audio is open.
+     *
+     * @returns The sample rate, or `0` if audio is not open.
+     */
+    int audio_sample_rate();
+
+    /**
+     * Register a handler that is called with the mixed audio, after the music
+     * and sound effects have been mixed and before it is played. The
+     * handler can change the samples in place, for example to add an echo.
+     *
+     * @param handler   The handler to call, or `nullptr` to remove it
+     */
+    void set_audio_mix_handler(audio_mix_handler *handler);
+
+    /**
+     * Create an audio node that makes sound by calling your handler. The
+     * samples are silent when the handler is called, and it fills them with
+     * the sound to play.
+     *
+     * @param generator The handler that makes the sound
+     * @returns         The new audio node
+     *
+     * @attribute class         audio_node
+     * @attribute constructor   true
+     * @attribute suffix        generator
+     */
+    audio_node create_audio_generator(audio_mix_handler *generator);
+
+    /**
+     * Create an audio node that changes the volume of another node.
+     *
+     * @param input The node to change the volume of
+     * @param gain  The amount to multiply the samples by, `1` leaves them
+     *              unchanged
+     * @returns     The new audio node
+     *
+     * @attribute class         audio_node
+     * @attribute constructor   true
+     * @attribute suffix        gain
+     */
+    audio_node create_audio_gain(audio_node input, double gain);
+
+    /**
+     * Create an audio node that removes high pitches from another node,
+     * making it sound muffled.
+     *
+     * @param input     The node to filter
+     * @param cutoff    The frequency, in hertz, above which sound is quietened
+     * @returns         The new audio node
+     *
+     * @attribute class         audio_node
+     * @attribute constructor   true
+     * @attribute suffix        low_pass
+     */
+    audio_node create_audio_low_pass(audio_node input, double cutoff);
+
+    /**
+     * Create an audio node that plays two nodes together.
+     *
+     * @param input1    The first node to mix
+     * @param input2    The second node to mix
+     * @returns         The new audio node
+     *
+     * @attribute class         audio_node
+     * @attribute constructor   true
+     * @attribute suffix        mix
+     */
+    audio_node create_audio_mix(audio_node input1, audio_node input2);
+
+    /**
+     * Change the gain of a gain node.
+     *
+     * @param node  The gain node
+     * @param gain  The amount to multiply the samples by
+     *
+     * @attribute class     audio_node
+     * @attribute setter    gain
+     */
+    void set_audio_node_gain(audio_node node, double gain);
+
+    /**
+     * Change the cutoff frequency of a low pass node.
+     *
+     * @param node      The low pass node
+     * @param cutoff    The frequency, in hertz, above which sound is quietened
+     *
+     * @attribute class     audio_node
+     * @attribute setter    cutoff
+     */
+    void set_audio_node_cutoff(audio_node node, double cutoff);
+
+    /**
+     * Free an audio node. Nodes that used it as an input are left without
+     * that input.
+     *
+     * @param node  The node to free
+     *
+     * @attribute class         audio_node
+     * @attribute destructor    true
+     */
+    void free_audio_node(audio_node node);
+
+    /**
+     * Play the sound from an audio node, along with the music and sound
+     * effects.
+     *
+     * @param node  The node to play, or `nullptr` to stop playing a node
+     */
+    void set_audio_output(audio_node node);
 }
 #include "sound.h"
 #include "music.h"
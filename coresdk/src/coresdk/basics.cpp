@@ -7,6 +7,7 @@
 //
 
 #include "basics.h"
+#include "utility_functions.h"
 
 #include <algorithm>
 #include <cstdlib>
@@ -18,28 +19,34 @@
 namespace splashkit_lib
 {
 
-    // trim see: https://stackoverflow.com/questions/216823/whats-the-best-way-to-trim-stdstring
+    // The characters isspace accepts in the C locale
+    static const char *WHITESPACE = " \t\n\v\f\r";
+
+    // each trim finds the ends first, then copies the text between them once
 
     // trim from start
     string ltrim(const string &text)
     {
-        string s = text;
-        s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](int c) { return !std::isspace(c);}));
-        return s;
+        size_t start = text.find_first_not_of(WHITESPACE);
+        if (start == string::npos) return string();
+        return text.substr(start);
     }
 
     // trim from end
     string rtrim(const string &text)
     {
-        string s = text;
-        s.erase(std::find_if(s.rbegin(), s.rend(), [](int c) { return !std::isspace(c);}).base(), s.end());
-        return s;
+        size_t end = text.find_last_not_of(WHITESPACE);
+        if (end == string::npos) return string();
+        return text.substr(0, end + 1);
     }
 
     // trim from both ends
     string trim(const string &text)
     {
-        return ltrim(rtrim(text));
+        size_t start = text.find_first_not_of(WHITESPACE);
+        if (start == string::npos) return string();
+        size_t end = text.find_last_not_of(WHITESPACE);
+        return text.substr(start, end - start + 1);
     }
 
     string to_lowercase(const string &text)
@@ -79,19 +86,31 @@ namespace splashkit_lib
         if (substr.empty())
             return text;
         
-        string result = text;
-        size_t pos = 0;
-        while ((pos = result.find(substr, pos)) != string::npos)
+        // copy the text between matches into the result in one pass, rather
+        // than replacing in place and moving the rest of the text each time
+        size_t pos = text.find(substr);
+        if (pos == string::npos)
+            return text;
+
+        string result;
+        result.reserve(text.length() + (replacement.length() > substr.length() ? 4 * (replacement.length() - substr.length()) : 0));
+
+        size_t start = 0;
+        while (pos != string::npos)
         {
-            result.replace(pos, substr.length(), replacement);
-            pos += replacement.length();
+            result.append(text, start, pos - start);
+            result += replacement;
+            start = pos + substr.length();
+            pos = text.find(substr, start);
         }
+        result.append(text, start, string::npos);
         return result;
     }
 
     vector<string> split(const string &text, char delimiter)
     {
         vector<string> result;
+        result.reserve(std::count(text.begin(), text.end(), delimiter) + 1);
         string::size_type start = 0;
         string::size_type end = text.find(delimiter);
         while (end != string::npos)
@@ -104,17 +123,10 @@ namespace splashkit_lib
         return result;
     }
 
-    // integer check see: https://stackoverflow.com/questions/2844817/how-do-i-check-if-a-c-string-is-an-int#2845275
-
     bool is_integer(const string &text)
     {
-        string s = trim(text);
-        if(s.empty() || ((!isdigit(s[0])) && (s[0] != '-') && (s[0] != '+'))) return false;
-        
-        char * p;
-        strtol(s.c_str(), &p, 10);
-        
-        return (*p == 0);
+        int value;
+        return parse_int(text, value);
     }
 
     bool is_double(const string &text)
@@ -124,22 +136,55 @@ namespace splashkit_lib
 
     bool is_number(const string &text)
     {
-        string s = trim(text);
+        // numbers start with a digit or sign, so "inf" and "nan" are not numbers
+        string_view s = trim_view(text);
         if(s.empty() || ((!isdigit(s[0])) && (s[0] != '-') && (s[0] != '+'))) return false;
-        
-        char * p;
-        strtod(s.c_str(), &p);
-        
-        return (*p == 0);
+
+        double value;
+        return parse_double(s, value);
     }
 
     int convert_to_integer(const string &text)
     {
+        int result;
+        if ( parse_int(text, result) ) return result;
+
+        // stoi reads a number at the start of the text, or reports the error
         return std::stoi( text );
     }
 
     double convert_to_double(const string &text)
     {
+        double result;
+        if ( parse_double(text, result) ) return result;
+
         return std::stod( text );
     }
+
+    bool parse_doubles(const string &text, char delimiter, vector<double> &out_values)
+    {
+        bool result = true;
+        string_view rest = text;
+
+        out_values.clear();
+        if ( trim_view(rest).empty() ) return true;
+
+        while ( true )
+        {
+            size_t end = rest.find(delimiter);
+            double value;
+
+            if ( ! parse_double(rest.substr(0, end), value) )
+            {
+                value = 0;
+                result = false;
+            }
+            out_values.push_back(value);
+
+            if ( end == string_view::npos ) break;
+            rest.remove_prefix(end + 1);
+        }
+
+        return result;
+    }
 }
@@ -91,6 +91,19 @@ namespace splashkit_lib
      */
     double convert_to_double(const string &text);
 
+    /**
+     * Read all of the numbers in a line of text, such as a line from a CSV
+     * file. This is much faster than splitting the text and converting each
+     * part.
+     *
+     * @param text          The text to read the numbers from.
+     * @param delimiter     The character between the numbers.
+     * @param out_values    Set to the numbers read from the text. A part that
+     *                      is not a number is read as 0.
+     * @return              True if every part of the text was a number.
+     */
+    bool parse_doubles(const string &text, char delimiter, vector<double> &out_values);
+
         /**
      * Returns the length of a string in characters.
      *
@@ -11,18 +11,29 @@
 #include "types.h"
 #include "resources.h"
 #include "utility_functions.h"
+#include "file_view.h"
 #include "images.h"
 #include "timers.h"
 #include "text.h"
 #include "audio.h"
-
+#include "animations.h"
+#include "concurrency_utils.h"
+#include "graphics_driver.h"
+#include "audio_driver.h"
+#include "utils_driver.h"
+#include "core_driver.h"
+
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <vector>
 #include <iostream>
 #include <fstream>
 
 using std::ifstream;
 using std::to_string;
+using std::shared_ptr;
+using std::make_shared;
 
 namespace splashkit_lib
 {
@@ -37,6 +48,7 @@ namespace splashkit_lib
         string                      name;
         string                      filename;
         vector<bundled_resource>    resources;
+        shared_ptr<file_view>       archive;    // kept mapped while packed music plays
     };
 
     static map<string, resource_bundle> _resource_bundles;
@@ -62,128 +74,482 @@ namespace splashkit_lib
         else return OTHER_RESOURCE;
     }
 
-    void load_resource_bundle(const string &name, const string &filename)
+    //
+    // Bundles load in three stages. The bundle file is parsed into entries
+    // on the calling thread. Images and sound effects are then decoded on a
+    // pool of worker threads. Finally each entry is finished in file order on
+    // the main thread, which is where the renderer, SDL_mixer, fonts, timers
+    // and the registries are touched. Music only opens its stream, so it is
+    // loaded when it is finished.
+    //
+
+    // A bundle can also be a packed archive, made with tools/skpack, holding
+    // the bundle lines and the files they name. All values are little endian:
+    //
+    //   header  "SKPACK" 0 1, u32 entry count, u32 reserved, u64 index offset
+    //   blobs   file contents, each aligned to PACK_ALIGNMENT bytes
+    //   index   per entry: u32 line length, the bundle line, u64 blob offset,
+    //           u64 blob size (0 when the line is loaded as usual)
+    //
+    // The archive is mapped, and packed files decode straight from memory.
+    //
+    #define PACK_HEADER_SIZE 24
+    #define PACK_ALIGNMENT 16
+
+    static const char PACK_MAGIC[8] = { 'S', 'K', 'P', 'A', 'C', 'K', 0, 1 };
+
+    // Main thread time spent finishing entries each frame for async loads
+    #define BUNDLE_FINISH_BUDGET_MS 4
+
+    struct _bundle_entry
+    {
+        resource_kind kind;
+        string name;
+        string path;
+        string line;        // kept for the bitmap cell details and warnings
+        int line_no;
+
+        // The packed file contents, within the archive mapping
+        const char *blob = nullptr;
+        size_t blob_size = 0;
+
+        // Filled in by the decode stage
+        string file_path;
+        SDL_Surface *image = nullptr;
+        sk_decoded_sound *sound = nullptr;
+        atomic<bool> ready{false};
+    };
+
+    struct _bundle_load
+    {
+        string name;
+        string filename;
+        vector<shared_ptr<_bundle_entry>> entries;
+        size_t finished = 0;
+        semaphore decoded;  // released as each entry is decoded
+        resource_bundle result;
+    };
+
+    static uint64_t _read_le(const char *data, int count)
     {
-        if ( has_resource_bundle(name) )
+        uint64_t value = 0;
+        for (int i = count - 1; i >= 0; i--)
+            value = (value << 8) | static_cast<unsigned char>(data[i]);
+        return value;
+    }
+
+    static map<string, shared_ptr<_bundle_load>> _bundle_loads;
+
+    // from images, sound and music
+    bitmap _register_loaded_bitmap(const string &name, const string &file_path, sk_drawing_surface surface, bool reloadable);
+    sound_effect _register_loaded_sound_effect(const string &name, const string &file_path, sk_sound_data data, bool reloadable);
+    music _register_loaded_music(const string &name, const string &file_path, sk_sound_data data);
+
+    static bool _needs_decode(resource_kind kind)
+    {
+        return kind == IMAGE_RESOURCE || kind == SOUND_RESOURCE || kind == MUSIC_RESOURCE;
+    }
+
+    // Runs on a worker thread, only touching the entry itself
+    static void _decode_bundle_entry(_bundle_entry &entry)
+    {
+        if ( entry.blob )
         {
-            LOG(WARNING) << "Attempting to load resource bundle twice.";
+            switch ( entry.kind )
+            {
+                case IMAGE_RESOURCE:
+                    entry.image = sk_decode_bitmap_from_memory(entry.blob, entry.blob_size);
+                    break;
+                case SOUND_RESOURCE:
+                    entry.sound = sk_decode_sound_from_memory(entry.blob, entry.blob_size);
+                    break;
+                default:
+                    break;
+            }
+
+            entry.ready.store(true, std::memory_order_release);
             return;
         }
 
-        string path = path_to_resource(filename, BUNDLE_RESOURCE);
+        entry.file_path = file_exists(entry.path) ? entry.path : path_to_resource(entry.path, entry.kind);
 
-        if ( ! file_exists(path) )
+        if ( file_exists(entry.file_path) )
         {
-            LOG(WARNING) << cat({ "Unable to locate bundle file for ", name, " (", path, ")"});
-            return;
+            switch ( entry.kind )
+            {
+                case IMAGE_RESOURCE:
+                    entry.image = sk_decode_bitmap(entry.file_path.c_str());
+                    break;
+                case SOUND_RESOURCE:
+                    entry.sound = sk_decode_sound(entry.file_path);
+                    break;
+                default:
+                    break;
+            }
         }
 
-        int line_no = 0;
-        string line;
-        ifstream input(path);
+        entry.ready.store(true, std::memory_order_release);
+    }
 
-        resource_bundle result;
+    static shared_ptr<_bundle_load> _start_bundle_load(const string &name, const string &path)
+    {
+        auto load = make_shared<_bundle_load>();
+        load->name = name;
+        load->filename = path;
+        load->result.name = name;
+        load->result.filename = path;
+
+        // Set up SDL before any worker uses it
+        internal_sk_init();
+        bool decode_audio = audio_ready();
+
+        // Each line with the packed file it names, if any
+        struct bundle_line { string text; int line_no; const char *blob; size_t blob_size; };
+        vector<bundle_line> lines;
 
-        // Called on load of each bitmap
-        auto rb_load_bitmap = [&](string line_name, string line_path)
+        load->result.archive = make_shared<file_view>(path);
+        string_view contents = load->result.archive->view();
+
+        if ( contents.size() >= PACK_HEADER_SIZE && contents.compare(0, sizeof(PACK_MAGIC), string_view(PACK_MAGIC, sizeof(PACK_MAGIC))) == 0 )
         {
-            bitmap bmp = load_bitmap(line_name, line_path);
-            int num_delim = count_delimiter(line, ',');
-            if ( num_delim > 2 and num_delim != 7 )
+            const char *data = contents.data();
+            uint64_t count = _read_le(data + 8, 4);
+            uint64_t pos = _read_le(data + 16, 8);
+
+            // Checked as sizes left after a position, so crafted values cannot overflow
+            uint64_t total = contents.size();
+
+            for (uint64_t i = 0; i < count; i++)
             {
-                LOG(WARNING) << "Incorrect cell options for bitmap " + line_name + " at " + to_string(line_no) + " of bundle " + name;
-                return;
+                if ( pos > total || total - pos < 4 ) break;
+                uint64_t length = _read_le(data + pos, 4);
+                if ( total - pos - 4 < length + 16 ) break;
+
+                bundle_line ln = { string(data + pos + 4, length), static_cast<int>(i + 1), nullptr, 0 };
+                pos += 4 + length;
+
+                uint64_t offset = _read_le(data + pos, 8);
+                uint64_t size = _read_le(data + pos + 8, 8);
+                pos += 16;
+
+                if ( size > 0 && size <= total && offset <= total - size )
+                {
+                    ln.blob = data + offset;
+                    ln.blob_size = static_cast<size_t>(size);
+                }
+
+                lines.push_back(ln);
             }
-            else if ( num_delim == 2 ) return;
 
-            bitmap_set_cell_details(bmp,
-                                    str_to_int(extract_delimited(4, line, ',')),
-                                    str_to_int(extract_delimited(5, line, ',')),
-                                    str_to_int(extract_delimited(6, line, ',')),
-                                    str_to_int(extract_delimited(7, line, ',')),
-                                    str_to_int(extract_delimited(8, line, ',')));
-        };
+            if ( lines.size() != count )
+                LOG(WARNING) << "Resource bundle archive " << path << " is truncated, loading " << lines.size() << " of " << count << " entries";
+        }
+        else
+        {
+            size_t pos = 0;
+            int line_no = 0;
 
-        // Called for each line in the bundle text file
-        auto process_line = [&]()
+            while (pos < contents.size())
+            {
+                size_t end = contents.find('\n', pos);
+                if (end == string_view::npos) end = contents.size();
+
+                line_no = line_no + 1;
+                lines.push_back({ string(contents.substr(pos, end - pos)), line_no, nullptr, 0 });
+                pos = end + 1;
+            }
+
+            // Text bundles are not needed once parsed
+            load->result.archive = nullptr;
+        }
+
+        vector<string_view> fields; // reused for each line
+        for (const bundle_line &ln : lines)
         {
-            resource_kind kind = string_to_resource_kind(extract_delimited(1, line, ','));
-            string line_name = trim(extract_delimited(2, line, ','));
-            string line_path = trim(extract_delimited(3, line, ','));
+            string line = trim(ln.text);
+            int line_no = ln.line_no;
+
+            if (line.length() == 0) continue;  //skip empty lines
+            if (line.substr(0,2) == "//") continue; //skip lines starting with //
 
+            split_delimited(line, ',', fields);
+            resource_kind kind = string_to_resource_kind(field_at(fields, 1));
+            string line_name = string(trim_view(fields.size() > 1 ? fields[1] : string_view()));
+            string line_path = string(trim_view(fields.size() > 2 ? fields[2] : string_view()));
 
             if ( kind == OTHER_RESOURCE )
             {
                 LOG(WARNING) << "Unknown resource type at line " + to_string(line_no) + " of bundle " + name;
-                return;
+                continue;
             }
 
             if ( line_name.length() == 0 )
             {
                 LOG(WARNING) << "Name missing for resource at line " + to_string(line_no) + " of bundle " + name;
-                return;
+                continue;
             }
 
             if ( line_path.length() == 0 && kind != TIMER_RESOURCE )
             {
                 LOG(WARNING) << "Name missing for resource at line " + to_string(line_no) + " of bundle " + name;
-                return;
+                continue;
             }
 
-            switch ( kind )
+            auto entry = make_shared<_bundle_entry>();
+            entry->kind = kind;
+            entry->name = line_name;
+            entry->path = line_path;
+            entry->line = line;
+            entry->line_no = line_no;
+
+            if ( ln.blob && _needs_decode(kind) )
             {
-                case BUNDLE_RESOURCE:
-                    load_resource_bundle(line_name, line_path);
-                    if ( ! has_resource_bundle(line_name) ) return;
-                    break;
-                case TIMER_RESOURCE:
-                    create_timer(line_name);
-                    break;
-                case IMAGE_RESOURCE:
-                    rb_load_bitmap(line_name, line_path);
-                    if ( ! has_resource_bundle(line_name) ) return;
-                    break;
-                case FONT_RESOURCE:
-                    load_font(line_name, line_path);
-                    if ( ! has_font(line_name) ) return;
-                    break;
-                case SOUND_RESOURCE:
-                    load_sound_effect(line_name, line_path);
-                    if ( ! has_sound_effect(line_name) ) return;
-                    break;
-                case MUSIC_RESOURCE:
-                    load_music(line_name, line_path);
-                    if ( ! has_music(line_name) ) return;
-                    break;
-                case ANIMATION_RESOURCE:
-                    load_animation_script(line_name, line_path);
-                    if ( ! has_animation_script(line_name) ) return;
-                    break;
-                default:
-                    return;
+                entry->blob = ln.blob;
+                entry->blob_size = ln.blob_size;
+                entry->file_path = path;
             }
 
-            bundled_resource br;
-            br.name = line_name;
-            br.kind = kind;
+            // Audio that cannot be decoded now is left for the normal loader,
+            // which reports the problem
+            bool decode = kind == IMAGE_RESOURCE || (kind == SOUND_RESOURCE && decode_audio);
+            if ( ! decode ) entry->ready = true;
 
-            result.resources.push_back(br);
+            load->entries.push_back(entry);
 
-            return;
+            if ( decode )
+            {
+                shared_worker_pool().add([load, entry]()
+                {
+                    _decode_bundle_entry(*entry);
+                    load->decoded.release();
+                });
+            }
+        }
+
+        return load;
+    }
+
+    // Called on the main thread, in file order, once the entry is decoded
+    static void _finish_bundle_entry(_bundle_load &load, _bundle_entry &entry)
+    {
+        const string &name = load.name;
+        const string &line = entry.line;
+        const string &line_name = entry.name;
+        const string &line_path = entry.path;
+        int line_no = entry.line_no;
+
+        // Loads a bitmap, using the decoded image where there is one
+        auto rb_load_bitmap = [&]()
+        {
+            bitmap bmp;
+
+            if ( has_bitmap(line_name) || ! entry.image )
+            {
+                sk_free_decoded_bitmap(entry.image);
+                bmp = load_bitmap(line_name, line_path);
+            }
+            else
+            {
+                bmp = _register_loaded_bitmap(line_name, entry.file_path, sk_bitmap_from_decoded(entry.image), ! entry.blob);
+            }
+            entry.image = nullptr;
+
+            if ( ! bmp ) return;
+
+            vector<string_view> fields;
+            split_delimited(line, ',', fields);
+
+            int num_delim = static_cast<int>(fields.size()) - 1;
+            if ( num_delim > 2 and num_delim != 7 )
+            {
+                LOG(WARNING) << "Incorrect cell options for bitmap " + line_name + " at " + to_string(line_no) + " of bundle " + name;
+                return;
+            }
+            else if ( num_delim == 2 ) return;
+
+            bitmap_set_cell_details(bmp,
+                                    str_to_int(field_at(fields, 4)),
+                                    str_to_int(field_at(fields, 5)),
+                                    str_to_int(field_at(fields, 6)),
+                                    str_to_int(field_at(fields, 7)),
+                                    str_to_int(field_at(fields, 8)));
         };
 
-        while (getline(input, line))
+        // Use the decoded sound effect, or packed music, or fall back to the
+        // normal loader
+        auto rb_load_audio = [&](bool (*has_fn)(const string &))
         {
-            line_no = line_no + 1;
+            bool use_decoded = ! has_fn(line_name);
+            sk_sound_data data = { SGSD_UNKNOWN, nullptr };
 
-            line = trim(line);
-            if (line.length() == 0) continue;  //skip empty lines
-            if (line.substr(0,2) == "//") continue; //skip lines starting with //
+            if ( entry.kind == SOUND_RESOURCE )
+            {
+                if ( use_decoded && entry.sound ) data = sk_sound_from_decoded(entry.sound);
+                else sk_free_decoded_sound(entry.sound);
+                entry.sound = nullptr;
+
+                if ( data._data ) _register_loaded_sound_effect(line_name, entry.file_path, data, ! entry.blob);
+                else load_sound_effect(line_name, line_path);
+            }
+            else
+            {
+                if ( use_decoded && entry.blob && audio_ready() )
+                    data = sk_load_sound_data_from_memory(entry.blob, entry.blob_size, SGSD_MUSIC);
+
+                if ( data._data ) _register_loaded_music(line_name, entry.file_path, data);
+                else load_music(line_name, line_path);
+            }
+        };
+
+        switch ( entry.kind )
+        {
+            case BUNDLE_RESOURCE:
+                load_resource_bundle(line_name, line_path);
+                if ( ! has_resource_bundle(line_name) ) return;
+                break;
+            case TIMER_RESOURCE:
+                create_timer(line_name);
+                break;
+            case IMAGE_RESOURCE:
+                rb_load_bitmap();
+                if ( ! has_bitmap(line_name) ) return;
+                break;
+            case FONT_RESOURCE:
+                load_font(line_name, line_path);
+                if ( ! has_font(line_name) ) return;
+                break;
+            case SOUND_RESOURCE:
+                rb_load_audio(&has_sound_effect);
+                if ( ! has_sound_effect(line_name) ) return;
+                break;
+            case MUSIC_RESOURCE:
+                rb_load_audio(&has_music);
+                if ( ! has_music(line_name) ) return;
+                break;
+            case ANIMATION_RESOURCE:
+                load_animation_script(line_name, line_path);
+                if ( ! has_animation_script(line_name) ) return;
+                break;
+            default:
+                return;
+        }
+
+        bundled_resource br;
+        br.name = line_name;
+        br.kind = entry.kind;
+
+        load.result.resources.push_back(br);
+    }
+
+    // Finish decoded entries in order, stopping at the first that is not
+    // ready or when the time budget is used. Returns true once all are done.
+    static bool _finish_bundle_entries(_bundle_load &load, long long budget_ns)
+    {
+        long long start = sk_get_ticks_ns();
+
+        while (load.finished < load.entries.size())
+        {
+            _bundle_entry &entry = *load.entries[load.finished];
+            if ( ! entry.ready.load(std::memory_order_acquire) ) return false;
+
+            _finish_bundle_entry(load, entry);
+            load.finished++;
+
+            if ( budget_ns > 0 && sk_get_ticks_ns() - start > budget_ns ) break;
+        }
 
-            process_line();
+        return load.finished == load.entries.size();
+    }
+
+    // Small bitmaps from the bundle share atlas textures, so they batch
+    static void _pack_bundle_bitmaps(const resource_bundle &bundle)
+    {
+        vector<bitmap> bitmaps;
+
+        for (const bundled_resource &br : bundle.resources)
+        {
+            if ( br.kind == IMAGE_RESOURCE && has_bitmap(br.name) )
+                bitmaps.push_back(bitmap_named(br.name));
+        }
+
+        bitmap_pack_into_atlas(bitmaps);
+    }
+
+    static string _bundle_path(const string &name, const string &filename)
+    {
+        if ( has_resource_bundle(name) || _bundle_loads.count(name) > 0 )
+        {
+            LOG(WARNING) << "Attempting to load resource bundle twice.";
+            return "";
+        }
+
+        string path = path_to_resource(filename, BUNDLE_RESOURCE);
+
+        if ( ! file_exists(path) )
+        {
+            LOG(WARNING) << cat({ "Unable to locate bundle file for ", name, " (", path, ")"});
+            return "";
+        }
+
+        return path;
+    }
+
+    void load_resource_bundle(const string &name, const string &filename)
+    {
+        string path = _bundle_path(name, filename);
+        if ( path.empty() ) return;
+
+        shared_ptr<_bundle_load> load = _start_bundle_load(name, path);
+
+        // Finish entries as soon as they decode, waiting when the next is not ready
+        while ( ! _finish_bundle_entries(*load, 0) )
+        {
+            load->decoded.acquire();
         }
 
-        _resource_bundles[name] = result;
+        _pack_bundle_bitmaps(load->result);
+        _resource_bundles[name] = load->result;
+    }
+
+    void load_resource_bundle_async(const string &name, const string &filename)
+    {
+        string path = _bundle_path(name, filename);
+        if ( path.empty() ) return;
+
+        _bundle_loads[name] = _start_bundle_load(name, path);
+    }
+
+    // Called each frame from process_events, and when progress is checked
+    void _update_resource_bundle_loads()
+    {
+        for (auto it = _bundle_loads.begin(); it != _bundle_loads.end(); )
+        {
+            // Hold the load, as finishing an entry may start other loads
+            shared_ptr<_bundle_load> load = it->second;
+
+            if ( _finish_bundle_entries(*load, BUNDLE_FINISH_BUDGET_MS * 1000000LL) )
+            {
+                _pack_bundle_bitmaps(load->result);
+                _resource_bundles[load->name] = load->result;
+                it = _bundle_loads.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
+    double resource_bundle_load_progress(const string &name)
+    {
+        _update_resource_bundle_loads();
+
+        if ( has_resource_bundle(name) ) return 1.0;
+
+        auto it = _bundle_loads.find(name);
+        if ( it == _bundle_loads.end() ) return 0.0;
+
+        const _bundle_load &load = *it->second;
+        if ( load.entries.empty() ) return 1.0;
+        return static_cast<double>(load.finished) / load.entries.size();
     }
 
     void free_resource_bundle(const string name)
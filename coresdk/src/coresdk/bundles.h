@@ -111,11 +111,38 @@ namespace splashkit_lib
      *    BUNDLE,another bundle,another.txt
      *    ```
      *
+     * The bundle can also be a packed archive made with the `skpack` tool,
+     * which stores the bundle and the bitmaps, sounds and music it lists in
+     * a single file. Packed files are read straight from the archive, and
+     * the archive stays open until the bundle is freed.
+     *
      * @param name      The name of the bundle when it is loaded.
      * @param filename  The filename to load.
      */
     void load_resource_bundle(const string &name, const string &filename);
 
+    /**
+     * Start loading a resource bundle in the background. Images and audio
+     * are read and decoded on worker threads, and the resources are made
+     * ready a few at a time each time you call `process_events`. Use
+     * `resource_bundle_load_progress` to show a loading screen, and
+     * `has_resource_bundle` to check when the bundle is ready to use.
+     *
+     * @param name      The name of the bundle when it is loaded.
+     * @param filename  The filename to load.
+     */
+    void load_resource_bundle_async(const string &name, const string &filename);
+
+    /**
+     * Reports how much of a resource bundle has loaded, and makes more of
+     * its resources ready if they have been decoded.
+     *
+     * @param name  The name of the resource bundle.
+     * @returns     A value from 0 to 1, which is 1 once the bundle is loaded and
+     *              0 if the bundle is not being loaded.
+     */
+    double resource_bundle_load_progress(const string &name);
+
     /**
      * Returns true when the named resource bundle has already been loaded.
      *
@@ -10,6 +10,9 @@
 
 #include "vector_2d.h"
 #include "graphics.h"
+
+#include <algorithm>
+
 namespace splashkit_lib
 {
     static double _camera_x = 0;
@@ -87,6 +90,19 @@ namespace splashkit_lib
         return rectangle_offset_by(rect, vector_world_to_screen());
     }
 
+    void to_screen(const vector<point_2d> &pts, vector<point_2d> &out_result)
+    {
+        const double cx = _camera_x, cy = _camera_y;
+        size_t count = pts.size();
+
+        out_result.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            out_result[i].x = pts[i].x - cx;
+            out_result[i].y = pts[i].y - cy;
+        }
+    }
+
     rectangle screen_rectangle()
     {
         return rectangle_from(0, 0, screen_width(), screen_height());
@@ -116,6 +132,19 @@ namespace splashkit_lib
         return point_at(pt.x + _camera_x, pt.y + _camera_y);
     }
 
+    void to_world(const vector<point_2d> &pts, vector<point_2d> &out_result)
+    {
+        const double cx = _camera_x, cy = _camera_y;
+        size_t count = pts.size();
+
+        out_result.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            out_result[i].x = pts[i].x + cx;
+            out_result[i].y = pts[i].y + cy;
+        }
+    }
+
 
     //---------------------------------------------------------------------------
     // Screen tests
@@ -126,6 +155,48 @@ namespace splashkit_lib
         return rectangles_intersect(to_screen(rect), screen_rectangle());
     }
 
+    int rects_on_screen(const vector<rectangle> &rects, vector<bool> &out_visible)
+    {
+        // The screen is the area 0, 0 to width, height in screen
+        // coordinates, which is camera x, y to camera x + width, y + height
+        // in the world, so the rectangles can be tested without moving them.
+        const float screen_l = 0, screen_t = 0;
+        const float screen_r = screen_width(), screen_b = screen_height();
+        const double cx = _camera_x, cy = _camera_y;
+        int result = 0;
+
+        out_visible.assign(rects.size(), false);
+
+        for (size_t i = 0; i < rects.size(); i++)
+        {
+            const rectangle &rect = rects[i];
+
+            // Match the rounding of rectangle_top etc. and intersection, so
+            // this agrees with rect_on_screen
+            double x = rect.x - cx, y = rect.y - cy;
+            float l = rect.width >= 0 ? x : x + rect.width;
+            float r = rect.width >= 0 ? x + rect.width : x;
+            float t = rect.height >= 0 ? y : y + rect.height;
+            float b = rect.height >= 0 ? y + rect.height : y;
+
+            l = std::max(l, screen_l);
+            t = std::max(t, screen_t);
+            r = std::min(r, screen_r);
+            b = std::min(b, screen_b);
+
+            if ( r < l or b < t ) continue;
+
+            // rectangles_intersect truncates the overlap to whole pixels
+            if ( (long long)(r - l) + (long long)(b - t) != 0 )
+            {
+                out_visible[i] = true;
+                result++;
+            }
+        }
+
+        return result;
+    }
+
     bool point_on_screen(const point_2d &pt)
     {
         return point_in_rectangle(pt, screen_rectangle());
@@ -16,6 +16,10 @@
 #define camera_hpp
 
 #include "geometry.h"
+
+#include <vector>
+using std::vector;
+
 namespace splashkit_lib
 {
     /**
@@ -138,6 +142,21 @@ namespace splashkit_lib
      */
     rectangle to_screen(const rectangle &rect);
 
+    /**
+     * Convert many points from world coordinates to screen coordinates in
+     * one call. This is much quicker than converting each point on its own
+     * when you have a lot of points to draw. The points and the result can
+     * be the same vector.
+     *
+     * @param pts           The points to convert - these should be in world
+     *                      coordinates.
+     * @param out_result    After the call this stores the points in screen
+     *                      coordinates, in the same order.
+     *
+     * @attribute suffix    points
+     */
+    void to_screen(const vector<point_2d> &pts, vector<point_2d> &out_result);
+
     /**
      * Returns a vector that can transform points from world to screen coordinates.
      *
@@ -205,6 +224,18 @@ namespace splashkit_lib
      */
     point_2d to_world(const point_2d &pt);
 
+    /**
+     * Convert many points from screen coordinates to world coordinates in
+     * one call. The points and the result can be the same vector.
+     *
+     * @param pts           The points in screen coordinates.
+     * @param out_result    After the call this stores the points in world
+     *                      coordinates, in the same order.
+     *
+     * @attribute suffix    points
+     */
+    void to_world(const vector<point_2d> &pts, vector<point_2d> &out_result);
+
 
     //---------------------------------------------------------------------------
     // Screen tests
@@ -220,6 +251,20 @@ namespace splashkit_lib
      */
     bool rect_on_screen(const rectangle &rect);
 
+    /**
+     * Tests which of the rectangles are on the screen. This gives the same
+     * results as calling `rect_on_screen` for each rectangle, but only
+     * works out the camera and screen area once, so it can quickly cull the
+     * tiles of a large map each frame.
+     *
+     * @param  rects        The rectangles to check, in world coordinates.
+     * @param  out_visible  After the call this stores a flag for each
+     *                      rectangle, which is true if any part of it is on
+     *                      the screen.
+     * @returns             The number of rectangles that are on the screen.
+     */
+    int rects_on_screen(const vector<rectangle> &rects, vector<bool> &out_visible);
+
     /**
      * Tests if the point is on the screen.
      *
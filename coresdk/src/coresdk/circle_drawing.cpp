@@ -25,7 +25,7 @@ using std::abs;
 namespace splashkit_lib
 {
 
-    void draw_circle(color clr, double x, double y, double radius, drawing_options opts)
+    void draw_circle(color clr, double x, double y, double radius, const drawing_options &opts)
     {
         sk_drawing_surface *surface;
 
@@ -44,7 +44,7 @@ namespace splashkit_lib
         draw_circle(clr, x, y, radius, option_defaults());
     }
 
-    void draw_circle(color clr, const circle &c, drawing_options opts)
+    void draw_circle(color clr, const circle &c, const drawing_options &opts)
     {
         draw_circle(clr, c.center.x, c.center.y, c.radius, opts);
     }
@@ -54,7 +54,7 @@ namespace splashkit_lib
         draw_circle(clr, c.center.x, c.center.y, c.radius, option_defaults());
     }
 
-    void fill_circle(color clr, double x, double y, double radius, drawing_options opts)
+    void fill_circle(color clr, double x, double y, double radius, const drawing_options &opts)
     {
         sk_drawing_surface *surface;
 
@@ -71,7 +71,7 @@ namespace splashkit_lib
         fill_circle(clr, x, y, radius, option_defaults());
     }
 
-    void fill_circle(color clr, const circle &c, drawing_options opts)
+    void fill_circle(color clr, const circle &c, const drawing_options &opts)
     {
         fill_circle(clr, c.center.x, c.center.y, c.radius, opts);
     }
@@ -81,7 +81,7 @@ namespace splashkit_lib
         fill_circle(clr, c.center.x, c.center.y, c.radius, option_defaults());
     }
     
-    void draw_circle_on_window(window destination, color clr, double x, double y, double radius, drawing_options opts)
+    void draw_circle_on_window(window destination, color clr, double x, double y, double radius, const drawing_options &opts)
     {
         draw_circle(clr, x, y, radius, option_draw_to(destination, opts));
     }
@@ -91,7 +91,7 @@ namespace splashkit_lib
         draw_circle(clr, x, y, radius, option_draw_to(destination));
     }
     
-    void draw_circle_on_bitmap(bitmap destination, color clr, double x, double y, double radius, drawing_options opts)
+    void draw_circle_on_bitmap(bitmap destination, color clr, double x, double y, double radius, const drawing_options &opts)
     {
         draw_circle(clr, x, y, radius, option_draw_to(destination, opts));
     }
@@ -101,7 +101,7 @@ namespace splashkit_lib
         draw_circle(clr, x, y, radius, option_draw_to(destination));
     }
     
-    void fill_circle_on_window(window destination, color clr, double x, double y, double radius, drawing_options opts)
+    void fill_circle_on_window(window destination, color clr, double x, double y, double radius, const drawing_options &opts)
     {
         fill_circle(clr, x, y, radius, option_draw_to(destination, opts));
     }
@@ -111,7 +111,7 @@ namespace splashkit_lib
         fill_circle(clr, x, y, radius, option_draw_to(destination));
     }
     
-    void fill_circle_on_bitmap(bitmap destination, color clr, double x, double y, double radius, drawing_options opts)
+    void fill_circle_on_bitmap(bitmap destination, color clr, double x, double y, double radius, const drawing_options &opts)
     {
         fill_circle(clr, x, y, radius, option_draw_to(destination, opts));
     }
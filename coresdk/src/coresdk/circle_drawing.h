@@ -25,7 +25,7 @@ namespace splashkit_lib
      *
      * @attribute suffix    with_options
      */
-    void draw_circle(color clr, double x, double y, double radius, drawing_options opts);
+    void draw_circle(color clr, double x, double y, double radius, const drawing_options &opts);
 
     /**
      *  Draw a circle onto the current window. The circle is centred on its x, y
@@ -51,7 +51,7 @@ namespace splashkit_lib
      * @attribute method    draw
      * @attribute self      c
      */
-    void draw_circle(color clr, const circle &c, drawing_options opts);
+    void draw_circle(color clr, const circle &c, const drawing_options &opts);
 
     /**
      *  Draw a circle on the current window. The circle is centred on its x, y
@@ -80,7 +80,7 @@ namespace splashkit_lib
      *
      * @attribute suffix    with_options
      */
-    void fill_circle(color clr, double x, double y, double radius, drawing_options opts);
+    void fill_circle(color clr, double x, double y, double radius, const drawing_options &opts);
 
     /**
      *  Fill a circle onto the current window. The circle is centred on its x, y
@@ -106,7 +106,7 @@ namespace splashkit_lib
      * @attribute method    fill
      * @attribute self      c
      */
-    void fill_circle(color clr, const circle &c, drawing_options opts);
+    void fill_circle(color clr, const circle &c, const drawing_options &opts);
 
     /**
      *  Draw a circle on the current window. The circle is centred on its x, y
@@ -137,7 +137,7 @@ namespace splashkit_lib
      * @attribute class     window
      * @attribute method    draw_circle
      */
-    void draw_circle_on_window(window destination, color clr, double x, double y, double radius, drawing_options opts);
+    void draw_circle_on_window(window destination, color clr, double x, double y, double radius, const drawing_options &opts);
     
     /**
      *  Draw a circle onto the destination window. The circle is centred on its x, y
@@ -169,7 +169,7 @@ namespace splashkit_lib
      * @attribute class     bitmap
      * @attribute method    draw_circle
      */
-    void draw_circle_on_bitmap(bitmap destination, color clr, double x, double y, double radius, drawing_options opts);
+    void draw_circle_on_bitmap(bitmap destination, color clr, double x, double y, double radius, const drawing_options &opts);
     
     /**
      *  Draw a circle onto the destination bitmap. The circle is centred on its x, y
@@ -201,7 +201,7 @@ namespace splashkit_lib
      * @attribute class     window
      * @attribute method    fill_circle
      */
-    void fill_circle_on_window(window destination, color clr, double x, double y, double radius, drawing_options opts);
+    void fill_circle_on_window(window destination, color clr, double x, double y, double radius, const drawing_options &opts);
     
     /**
      *  Fill a circle onto the destination window. The circle is centred on its x, y
@@ -233,7 +233,7 @@ namespace splashkit_lib
      * @attribute class     bitmap
      * @attribute method    fill_circle
      */
-    void fill_circle_on_bitmap(bitmap destination, color clr, double x, double y, double radius, drawing_options opts);
+    void fill_circle_on_bitmap(bitmap destination, color clr, double x, double y, double radius, const drawing_options &opts);
     
     /**
      *  Fill a circle onto the destination bitmap. The circle is centred on its x, y
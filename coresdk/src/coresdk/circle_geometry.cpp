@@ -12,12 +12,20 @@
 #include "vector_2d.h"
 #include "line_geometry.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 
 using std::abs;
 
 namespace splashkit_lib
 {
+    // from line_geometry
+    std::array<line, 3> _lines_from(const triangle &t);
+    std::array<line, 4> _lines_from(const rectangle &rect);
+    point_2d _closest_point_on_lines(const point_2d from_pt, const line *lines, size_t count, int &line_idx);
+
     circle circle_at(const point_2d &pt, double radius)
     {
         circle result;
@@ -108,6 +116,33 @@ namespace splashkit_lib
         return point_point_distance(point_at(c1_x, c1_y), point_at(c2_x, c2_y)) < c1_radius + c2_radius;
     }
 
+    void circles_intersect_many(const circle &c, const vector<circle> &circles, vector<bool> &out_result)
+    {
+        const double cx = c.center.x, cy = c.center.y, cr = c.radius;
+        const size_t n = circles.size();
+        const circle *other = circles.data();
+
+        out_result.resize(n);
+
+        // Compare squared distances, in branch free blocks the compiler can
+        // vectorise, then copy the results out
+        uint8_t hit[256];
+        for (size_t start = 0; start < n; start += 256)
+        {
+            size_t count = std::min<size_t>(256, n - start);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                double dx = other[start + i].center.x - cx, dy = other[start + i].center.y - cy;
+                double reach = other[start + i].radius + cr;
+                hit[i] = (reach > 0) & (dx * dx + dy * dy < reach * reach);
+            }
+
+            for (size_t i = 0; i < count; i++)
+                out_result[start + i] = hit[i];
+        }
+    }
+
     bool circle_triangle_intersect(const circle &c, const triangle &tri)
     {
         point_2d p;
@@ -125,7 +160,8 @@ namespace splashkit_lib
 
         int idx;
         // Find the closest point on the triangle to the sphere center
-        p = closest_point_on_lines(c.center, lines_from(tri), idx);
+        std::array<line, 3> edges = _lines_from(tri);
+        p = _closest_point_on_lines(c.center, edges.data(), edges.size(), idx);
 
         // Circle and triangle intersect if the squared distance from circle
         // center to point p is less than the squared circle radius
@@ -167,7 +203,8 @@ namespace splashkit_lib
     point_2d closest_point_on_rect_from_circle(const circle &c, const rectangle &rect)
     {
         int idx;
-        return closest_point_on_lines(c.center, lines_from(rect), idx);
+        std::array<line, 4> edges = _lines_from(rect);
+        return _closest_point_on_lines(c.center, edges.data(), edges.size(), idx);
     }
 
     bool tangent_points(const point_2d &from_pt, const circle &c, point_2d &p1, point_2d &p2)
@@ -7,7 +7,9 @@
 //
 
 #include "collisions.h"
+#include "line_geometry.h"
 #include "physics.h"
+#include "point_geometry.h"
 #include "sprites.h"
 #include "utility_functions.h"
 
@@ -16,6 +18,7 @@
 
 #include "graphics.h"
 #include "utils.h"
+#include "backend_types.h"
 
 using std::function;
 
@@ -119,8 +122,273 @@ namespace splashkit_lib
         return false;
     }
 
+    // Does the matrix only move the bitmap, without rotating or scaling it?
+    bool _is_translation_only(const matrix_2d &m)
+    {
+        return m.elements[0][0] == 1 and m.elements[1][1] == 1 and m.elements[0][1] == 0 and m.elements[1][0] == 0;
+    }
+
+    // Read 64 bits of a mask row starting at pixel x. Bits past the end of the row are 0.
+    inline uint64_t _mask_bits_at(const uint64_t *row, int words, int x)
+    {
+        int word = x / 64, shift = x % 64;
+
+        uint64_t result = word < words ? row[word] >> shift : 0;
+        if ( shift and word + 1 < words )
+            result |= row[word + 1] << (64 - shift);
+
+        return result;
+    }
+
+    // Check count pixels, starting at ax in row_a and bx in row_b, for a pixel drawn in both
+    bool _mask_rows_overlap(const uint64_t *row_a, int words_a, int ax, const uint64_t *row_b, int words_b, int bx, int count)
+    {
+        for (int i = 0; i < count; i += 64)
+        {
+            uint64_t bits = _mask_bits_at(row_a, words_a, ax + i) & _mask_bits_at(row_b, words_b, bx + i);
+
+            if ( count - i < 64 )
+                bits &= (uint64_t(1) << (count - i)) - 1;
+
+            if ( bits ) return true;
+        }
+
+        return false;
+    }
+
+    // from images
+    void _ensure_collision_mask(bitmap bmp);
+    const vector<point_2d> &_cell_hull(bitmap bmp, int cell);
+
+    // The bounds of the opaque pixels in a cell, relative to the cell
+    rectangle _cell_opaque_bounds(bitmap bmp, int cell)
+    {
+        _ensure_collision_mask(bmp);
+
+        if ( cell >= 0 and cell < static_cast<int>(bmp->cell_opaque_bounds.size()) )
+            return bmp->cell_opaque_bounds[cell];
+
+        return rectangle_from(0, 0, bmp->cell_w, bmp->cell_h);
+    }
+
+    // A quad around the opaque pixels of the cell, grown by a pixel as the
+    // pixel walk truncates positions to whole pixels
+    quad _cell_opaque_quad(const rectangle &bounds, const matrix_2d &matrix)
+    {
+        return quad_from(rectangle_from(bounds.x - 1, bounds.y - 1, bounds.width + 2, bounds.height + 2), matrix);
+    }
+
+    // The hull around a cell, moved by the matrix
+    static void _hull_in_world(bitmap bmp, int cell, const matrix_2d &matrix, vector<point_2d> &out_result)
+    {
+        const vector<point_2d> &hull = _cell_hull(bmp, cell);
+
+        out_result.resize(hull.size());
+        for (size_t i = 0; i < hull.size(); i++)
+            out_result[i] = matrix_multiply(matrix, hull[i]);
+    }
+
+    static vector<point_2d> _rectangle_points(const rectangle &rect)
+    {
+        return {
+            point_at(rect.x, rect.y),
+            point_at(rect.x + rect.width, rect.y),
+            point_at(rect.x + rect.width, rect.y + rect.height),
+            point_at(rect.x, rect.y + rect.height)
+        };
+    }
+
+    // Separating axis test: two convex polygons overlap unless the normal of
+    // one of their edges separates them. Works with either winding.
+    bool _convex_polygons_intersect(const vector<point_2d> &poly1, const vector<point_2d> &poly2)
+    {
+        if ( poly1.empty() or poly2.empty() ) return false;
+
+        for (int pass = 0; pass < 2; pass++)
+        {
+            const vector<point_2d> &edges = pass == 0 ? poly1 : poly2;
+
+            for (size_t i = 0; i < edges.size(); i++)
+            {
+                const point_2d &p1 = edges[i], &p2 = edges[(i + 1) % edges.size()];
+                double nx = p1.y - p2.y, ny = p2.x - p1.x;
+
+                double min1 = INFINITY, max1 = -INFINITY, min2 = INFINITY, max2 = -INFINITY;
+                for (const point_2d &pt : poly1)
+                {
+                    double d = pt.x * nx + pt.y * ny;
+                    min1 = std::min(min1, d);
+                    max1 = std::max(max1, d);
+                }
+                for (const point_2d &pt : poly2)
+                {
+                    double d = pt.x * nx + pt.y * ny;
+                    min2 = std::min(min2, d);
+                    max2 = std::max(max2, d);
+                }
+
+                if ( max1 < min2 or max2 < min1 ) return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool _point_in_convex_polygon(const point_2d &pt, const vector<point_2d> &poly)
+    {
+        if ( poly.size() < 3 ) return false;
+
+        bool has_left = false, has_right = false;
+        for (size_t i = 0; i < poly.size(); i++)
+        {
+            const point_2d &p1 = poly[i], &p2 = poly[(i + 1) % poly.size()];
+            double cross = (p2.x - p1.x) * (pt.y - p1.y) - (p2.y - p1.y) * (pt.x - p1.x);
+
+            if ( cross > 0 ) has_left = true;
+            else if ( cross < 0 ) has_right = true;
+
+            if ( has_left and has_right ) return false;
+        }
+
+        return true;
+    }
+
+    //
+    // Collision between the drawn pixels of one bitmap and the hull around
+    // a cell of another
+    //
+    static bool _bitmap_hull_collision(bitmap bmp, int cell, const matrix_2d &matrix, bitmap hull_bmp, int hull_cell, const matrix_2d &hull_matrix)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR) or INVALID_PTR(hull_bmp, BITMAP_PTR) ) return false;
+
+        const vector<point_2d> &hull = _cell_hull(hull_bmp, hull_cell);
+        if ( hull.empty() ) return false;
+
+        rectangle bounds = _cell_opaque_bounds(bmp, cell);
+        if ( bounds.width <= 0 ) return false;
+
+        // Quick check against the opaque part of the bitmap
+        quad q = _cell_opaque_quad(bounds, matrix);
+        vector<point_2d> world_hull;
+        _hull_in_world(hull_bmp, hull_cell, hull_matrix, world_hull);
+
+        // Quad points go across then down, so swap the last two to walk around the edge
+        vector<point_2d> outline = { q.points[0], q.points[1], q.points[3], q.points[2] };
+        if ( not _convex_polygons_intersect(outline, world_hull) ) return false;
+
+        return _step_through_pixels(bmp->cell_w, bmp->cell_h, matrix, hull_bmp->cell_w, hull_bmp->cell_h, hull_matrix, [&] (int ax, int ay, int bx, int by)
+                                    {
+                                        return pixel_drawn_at_point(bmp, cell, ax, ay) && _point_in_convex_polygon(point_at(bx + 0.5, by + 0.5), hull);
+                                    });
+    }
+
+    static bool _sprite_hull_collision(sprite s, const vector<point_2d> &poly)
+    {
+        vector<point_2d> hull;
+        _hull_in_world(sprite_collision_bitmap(s), sprite_current_cell(s), sprite_location_matrix(s), hull);
+        return _convex_polygons_intersect(hull, poly);
+    }
+
+    // Get the row of the mask for a row of the cell, or nullptr if it is outside the bitmap
+    const uint64_t *_mask_row(bitmap bmp, const vector_2d &cell_offset, int y)
+    {
+        int row = static_cast<int>(cell_offset.y) + y;
+        if ( row < 0 or row >= bmp->image.surface.height ) return nullptr;
+        return bmp->pixel_mask + row * bmp->mask_words;
+    }
+
+    //
+    // Collision between bitmaps that are only translated. This visits the same
+    // pixel pairs as _step_through_pixels, but tests 64 pixels of each row at
+    // a time using the packed collision masks.
+    //
+    bool _translated_bitmap_mask_collision(bitmap bmp1, int c1, const matrix_2d& matrix1, bitmap bmp2, int c2, const matrix_2d& matrix2)
+    {
+        if ( INVALID_PTR(bmp1, BITMAP_PTR) or INVALID_PTR(bmp2, BITMAP_PTR) ) return false;
+
+        _ensure_collision_mask(bmp1);
+        _ensure_collision_mask(bmp2);
+        if ( bmp1->pixel_mask == nullptr or bmp2->pixel_mask == nullptr ) return false;
+
+        // Step through the smaller of the two, as _step_through_pixels does
+        bool a_is_1 = bmp1->cell_w * bmp1->cell_h <= bmp2->cell_w * bmp2->cell_h;
+
+        bitmap bmp_a = a_is_1 ? bmp1 : bmp2;
+        bitmap bmp_b = a_is_1 ? bmp2 : bmp1;
+        const matrix_2d &matrix_a = a_is_1 ? matrix1 : matrix2;
+        const matrix_2d &matrix_b = a_is_1 ? matrix2 : matrix1;
+
+        vector_2d offset_a = bitmap_cell_offset(bmp_a, a_is_1 ? c1 : c2);
+        vector_2d offset_b = bitmap_cell_offset(bmp_b, a_is_1 ? c2 : c1);
+
+        int w_a = bmp_a->cell_w, h_a = bmp_a->cell_h;
+        int w_b = bmp_b->cell_w, h_b = bmp_b->cell_h;
+
+        // Only the opaque parts of the cells can collide
+        rectangle bounds_a = _cell_opaque_bounds(bmp_a, a_is_1 ? c1 : c2);
+        rectangle bounds_b = _cell_opaque_bounds(bmp_b, a_is_1 ? c2 : c1);
+
+        if ( bounds_a.width <= 0 or bounds_b.width <= 0 ) return false;
+
+        int a_left = static_cast<int>(bounds_a.x), a_right = static_cast<int>(bounds_a.x + bounds_a.width);
+        int a_top = static_cast<int>(bounds_a.y), a_bottom = static_cast<int>(bounds_a.y + bounds_a.height);
+        int b_left = static_cast<int>(bounds_b.x), b_right = static_cast<int>(bounds_b.x + bounds_b.width);
+        int b_top = static_cast<int>(bounds_b.y), b_bottom = static_cast<int>(bounds_b.y + bounds_b.height);
+
+        // Position of A's top left in B's local space
+        double dx = matrix_a.elements[0][2] - matrix_b.elements[0][2];
+        double dy = matrix_a.elements[1][2] - matrix_b.elements[1][2];
+
+        // Pixels in A map to B at x + k, except pixel -k - 1 which truncates to 0
+        int k = static_cast<int>(floor(dx));
+        bool extra_pixel = dx - k > 0;
+
+        int start = std::max({0, -k, a_left, b_left - k});
+        int end = std::min({w_a, w_b - k, a_right, b_right - k});
+
+        int x_a0 = static_cast<int>(offset_a.x);
+        int x_b0 = static_cast<int>(offset_b.x);
+
+        for (int y_a = std::max(0, a_top); y_a < std::min(h_a, a_bottom); y_a++)
+        {
+            int y_b = trunc(y_a + dy);
+            if ( y_b < 0 or y_b >= h_b or y_b < b_top or y_b >= b_bottom ) continue;
+
+            const uint64_t *row_a = _mask_row(bmp_a, offset_a, y_a);
+            const uint64_t *row_b = _mask_row(bmp_b, offset_b, y_b);
+            if ( row_a == nullptr or row_b == nullptr ) continue;
+
+            if ( start < end and _mask_rows_overlap(row_a, bmp_a->mask_words, x_a0 + start, row_b, bmp_b->mask_words, x_b0 + start + k, end - start) )
+                return true;
+
+            if ( extra_pixel and -k - 1 >= a_left and -k - 1 < std::min(w_a, a_right) and b_left == 0 and
+                 _mask_rows_overlap(row_a, bmp_a->mask_words, x_a0 - k - 1, row_b, bmp_b->mask_words, x_b0, 1) )
+                return true;
+        }
+
+        return false;
+    }
+
     bool _collision_within_bitmap_images_with_translation(bitmap bmp1, int c1, const matrix_2d& matrix1, bitmap bmp2, int c2, const matrix_2d& matrix2)
     {
+#ifndef DEBUG_STEP
+        if ( _is_translation_only(matrix1) and _is_translation_only(matrix2) )
+        {
+            return _translated_bitmap_mask_collision(bmp1, c1, matrix1, bmp2, c2, matrix2);
+        }
+#endif
+
+        if ( VALID_PTR(bmp1, BITMAP_PTR) and VALID_PTR(bmp2, BITMAP_PTR) )
+        {
+            rectangle bounds1 = _cell_opaque_bounds(bmp1, c1);
+            rectangle bounds2 = _cell_opaque_bounds(bmp2, c2);
+
+            if ( bounds1.width <= 0 or bounds2.width <= 0 ) return false;
+
+            if ( not quads_intersect(_cell_opaque_quad(bounds1, matrix1), _cell_opaque_quad(bounds2, matrix2)) )
+                return false;
+        }
+
         return _step_through_pixels(bitmap_cell_width(bmp1), bitmap_cell_height(bmp1), matrix1,
                                     bitmap_cell_width(bmp2), bitmap_cell_height(bmp2), matrix2,
                                     [&] (int ax, int ay, int bx, int by)
@@ -207,6 +475,9 @@ namespace splashkit_lib
 
         if ( not quads_intersect(q1, q2) ) return false;
 
+        rectangle bounds = _cell_opaque_bounds(bmp, cell);
+        if ( bounds.width <= 0 or not quads_intersect(_cell_opaque_quad(bounds, translation), q2) ) return false;
+
         return _step_through_pixels(rect.width, rect.height, translation_matrix(rect.x, rect.y), bmp->cell_w, bmp->cell_h, translation, [&] (int ax, int ay, int bx, int by)
                                     {
                                         return pixel_drawn_at_point(bmp, cell, bx, by);
@@ -286,6 +557,11 @@ namespace splashkit_lib
             return bitmap_rectangle_collision(bmp, cell, point_at(x, y), sprite_collision_rectangle(s));
         }
 
+        if (sprite_collision_kind(s) == POLYGON_COLLISIONS)
+        {
+            return _bitmap_hull_collision(bmp, cell, translation_matrix(x, y), sprite_collision_bitmap(s), sprite_current_cell(s), sprite_location_matrix(s));
+        }
+
         return _collision_within_bitmap_images_with_translation(
                     sprite_collision_bitmap(s), sprite_current_cell(s),
                     sprite_location_matrix(s),
@@ -310,6 +586,12 @@ namespace splashkit_lib
         {
             return false;
         }
+        else if (sprite_collision_kind(s) == POLYGON_COLLISIONS)
+        {
+            vector<point_2d> hull;
+            _hull_in_world(sprite_collision_bitmap(s), sprite_current_cell(s), sprite_location_matrix(s), hull);
+            return _point_in_convex_polygon(pt, hull);
+        }
         else if (bitmap_cell_count(sprite_collision_bitmap(s)) > 1)
         {
             return bitmap_point_collision(sprite_collision_bitmap(s), sprite_current_cell(s), sprite_location_matrix(s), pt);
@@ -326,6 +608,11 @@ namespace splashkit_lib
         {
             return false;
         }
+
+        if (sprite_collision_kind(s) == POLYGON_COLLISIONS)
+        {
+            return _sprite_hull_collision(s, _rectangle_points(rect));
+        }
         
         return bitmap_rectangle_collision(sprite_collision_bitmap(s), sprite_current_cell(s), sprite_location_matrix(s), rect);
     }
@@ -346,6 +633,27 @@ namespace splashkit_lib
         {
             return sprite_rectangle_collision(s1, sprite_collision_rectangle(s2));
         }
+
+        // Two polygons use the separating axis test, and a polygon against
+        // pixels checks the drawn pixels that fall inside the polygon
+        if (sprite_collision_kind(s1) == POLYGON_COLLISIONS and sprite_collision_kind(s2) == POLYGON_COLLISIONS)
+        {
+            vector<point_2d> hull2;
+            _hull_in_world(sprite_collision_bitmap(s2), sprite_current_cell(s2), sprite_location_matrix(s2), hull2);
+            return _sprite_hull_collision(s1, hull2);
+        }
+
+        if (sprite_collision_kind(s1) == POLYGON_COLLISIONS)
+        {
+            return _bitmap_hull_collision(sprite_collision_bitmap(s2), sprite_current_cell(s2), sprite_location_matrix(s2),
+                                          sprite_collision_bitmap(s1), sprite_current_cell(s1), sprite_location_matrix(s1));
+        }
+
+        if (sprite_collision_kind(s2) == POLYGON_COLLISIONS)
+        {
+            return _bitmap_hull_collision(sprite_collision_bitmap(s1), sprite_current_cell(s1), sprite_location_matrix(s1),
+                                          sprite_collision_bitmap(s2), sprite_current_cell(s2), sprite_location_matrix(s2));
+        }
         
         return _collision_within_bitmap_images_with_translation (
                                                                  sprite_collision_bitmap(s1), sprite_current_cell(s1), sprite_location_matrix(s1),
@@ -386,4 +694,155 @@ namespace splashkit_lib
         return bitmap_collision(bmp1, 0, translation_matrix(x1, y1), bmp2, 0, translation_matrix(x2, y2));
     }
 
+    //---------------------------------------------------------------------------
+    // Swept collisions
+    //---------------------------------------------------------------------------
+
+    // When a point moving from pt by movement comes within radius of centre,
+    // as a fraction of the movement, or -1 if it does not.
+    static float _point_time_to_circle(const point_2d &pt, const vector_2d &movement, const point_2d &centre, double radius)
+    {
+        double mx = pt.x - centre.x, my = pt.y - centre.y;
+        double c = mx * mx + my * my - radius * radius;
+        if ( c <= 0 ) return 0;
+
+        double a = movement.x * movement.x + movement.y * movement.y;
+        double b = 2 * (mx * movement.x + my * movement.y);
+        double disc = b * b - 4 * a * c;
+        if ( a == 0 or b >= 0 or disc < 0 ) return -1;
+
+        double t = (-b - sqrt(disc)) / (2 * a);
+        return t <= 1 ? static_cast<float>(t) : -1;
+    }
+
+    float circle_rectangle_time_of_impact(const circle &c, const vector_2d &movement, const rectangle &rect)
+    {
+        double r = c.radius;
+        double left = rect.x - r, right = rect.x + rect.width + r;
+        double top = rect.y - r, bottom = rect.y + rect.height + r;
+
+        // The circle touches the rectangle when its centre enters the
+        // rectangle grown by the radius, with rounded corners. First find
+        // where the centre enters the grown rectangle.
+        double t_enter = 0, t_exit = 1;
+        double start[2] = { c.center.x, c.center.y }, move[2] = { movement.x, movement.y };
+        double low[2] = { left, top }, high[2] = { right, bottom };
+
+        for (int i = 0; i < 2; i++)
+        {
+            if ( move[i] == 0 )
+            {
+                if ( start[i] < low[i] or start[i] > high[i] ) return -1;
+                continue;
+            }
+
+            double t1 = (low[i] - start[i]) / move[i], t2 = (high[i] - start[i]) / move[i];
+            if ( t1 > t2 ) std::swap(t1, t2);
+
+            if ( t1 > t_enter ) t_enter = t1;
+            if ( t2 < t_exit ) t_exit = t2;
+            if ( t_enter > t_exit ) return -1;
+        }
+
+        double hx = c.center.x + t_enter * movement.x, hy = c.center.y + t_enter * movement.y;
+        bool beside_x = hx >= rect.x and hx <= rect.x + rect.width;
+        bool beside_y = hy >= rect.y and hy <= rect.y + rect.height;
+
+        if ( beside_x or beside_y ) return static_cast<float>(t_enter);
+
+        // Entering at a corner, where the grown rectangle is rounded
+        point_2d corner = point_at(hx < rect.x ? rect.x : rect.x + rect.width, hy < rect.y ? rect.y : rect.y + rect.height);
+        return _point_time_to_circle(c.center, movement, corner, r);
+    }
+
+    float circle_line_time_of_impact(const circle &c, const vector_2d &movement, const line &l)
+    {
+        if ( point_line_distance(c.center, l) <= c.radius ) return 0;
+
+        float result = -1;
+        auto earliest = [&result](float t) { if ( t >= 0 and (result < 0 or t < result) ) result = t; };
+
+        // Hitting the side of the line
+        double lx = l.end_point.x - l.start_point.x, ly = l.end_point.y - l.start_point.y;
+        double len = sqrt(lx * lx + ly * ly);
+
+        if ( len > 0 )
+        {
+            double nx = -ly / len, ny = lx / len;
+            double dist = (c.center.x - l.start_point.x) * nx + (c.center.y - l.start_point.y) * ny;
+            if ( dist < 0 ) { nx = -nx; ny = -ny; dist = -dist; }
+
+            double approach = -(movement.x * nx + movement.y * ny);
+            if ( approach > 0 )
+            {
+                double t = (dist - c.radius) / approach;
+                if ( t <= 1 )
+                {
+                    double px = c.center.x + t * movement.x - l.start_point.x, py = c.center.y + t * movement.y - l.start_point.y;
+                    double along = (px * lx + py * ly) / (len * len);
+                    if ( along >= 0 and along <= 1 ) earliest(static_cast<float>(t));
+                }
+            }
+        }
+
+        // Hitting either end
+        earliest(_point_time_to_circle(c.center, movement, l.start_point, c.radius));
+        earliest(_point_time_to_circle(c.center, movement, l.end_point, c.radius));
+
+        return result;
+    }
+
+    float circle_circle_time_of_impact(const circle &c1, const vector_2d &movement1, const circle &c2, const vector_2d &movement2)
+    {
+        vector_2d relative = vector_to(movement1.x - movement2.x, movement1.y - movement2.y);
+        return _point_time_to_circle(c1.center, relative, c2.center, c1.radius + c2.radius);
+    }
+
+    // The distance the sprite moves in one update, as move_sprite moves it
+    static vector_2d _sprite_movement(sprite s)
+    {
+        vector_2d velocity = sprite_velocity(s);
+        float angle = sprite_rotation(s);
+
+        return angle == 0 ? velocity : matrix_multiply(rotation_matrix(angle), velocity);
+    }
+
+    float sprite_rectangle_time_of_impact(sprite s, const rectangle &rect)
+    {
+        return circle_rectangle_time_of_impact(sprite_collision_circle(s), _sprite_movement(s), rect);
+    }
+
+    float sprite_time_of_impact(sprite s1, sprite s2)
+    {
+        return circle_circle_time_of_impact(sprite_collision_circle(s1), _sprite_movement(s1), sprite_collision_circle(s2), _sprite_movement(s2));
+    }
+
+    // Move the sprite by its velocity, or the part of it before the impact
+    static bool _move_sprite_to_impact(sprite s, float t)
+    {
+        if ( t < 0 )
+        {
+            move_sprite(s);
+            return false;
+        }
+
+        move_sprite(s, t);
+        return true;
+    }
+
+    bool move_sprite_until_collision(sprite s, const rectangle &rect)
+    {
+        return _move_sprite_to_impact(s, sprite_rectangle_time_of_impact(s, rect));
+    }
+
+    bool move_sprite_until_collision(sprite s, const line &l)
+    {
+        return _move_sprite_to_impact(s, circle_line_time_of_impact(sprite_collision_circle(s), _sprite_movement(s), l));
+    }
+
+    bool move_sprite_until_collision(sprite s, sprite other)
+    {
+        return _move_sprite_to_impact(s, sprite_time_of_impact(s, other));
+    }
+
 }
@@ -476,5 +476,119 @@ namespace splashkit_lib
      */
     bool bitmap_collision(bitmap bmp1, double x1, double y1, bitmap bmp2, double x2, double y2);
 
+    /**
+     * Finds when a moving circle first touches a rectangle. Rather than
+     * testing where the circle ends up, this checks the whole path, so a
+     * fast circle can not pass through a thin rectangle.
+     *
+     * @param  c          The circle at the start of its movement
+     * @param  movement   The distance the circle moves
+     * @param  rect       The rectangle to check
+     * @return            The fraction of the movement, from 0 to 1, when the
+     *                    circle first touches the rectangle, or -1 if it does
+     *                    not touch the rectangle. This is 0 when they already
+     *                    overlap.
+     */
+    float circle_rectangle_time_of_impact(const circle &c, const vector_2d &movement, const rectangle &rect);
+
+    /**
+     * Finds when a moving circle first touches a line segment.
+     *
+     * @param  c          The circle at the start of its movement
+     * @param  movement   The distance the circle moves
+     * @param  l          The line to check
+     * @return            The fraction of the movement, from 0 to 1, when the
+     *                    circle first touches the line, or -1 if it does not
+     *                    touch the line. This is 0 when they already overlap.
+     */
+    float circle_line_time_of_impact(const circle &c, const vector_2d &movement, const line &l);
+
+    /**
+     * Finds when two moving circles first touch.
+     *
+     * @param  c1         The first circle at the start of its movement
+     * @param  movement1  The distance the first circle moves
+     * @param  c2         The second circle at the start of its movement
+     * @param  movement2  The distance the second circle moves
+     * @return            The fraction of the movement, from 0 to 1, when the
+     *                    circles first touch, or -1 if they do not touch. This
+     *                    is 0 when they already overlap.
+     */
+    float circle_circle_time_of_impact(const circle &c1, const vector_2d &movement1, const circle &c2, const vector_2d &movement2);
+
+    /**
+     * Finds when a sprite, moving by its velocity as update_sprite moves
+     * it, first touches a rectangle. The sprite's collision circle is used
+     * for the test.
+     *
+     * @param  s      The sprite to test
+     * @param  rect   The rectangle to check
+     * @return        The fraction of the sprite's next movement when it
+     *                first touches the rectangle, or -1 if it does not.
+     *
+     * @attribute class sprite
+     * @attribute method rectangle_time_of_impact
+     */
+    float sprite_rectangle_time_of_impact(sprite s, const rectangle &rect);
+
+    /**
+     * Finds when two sprites, each moving by its velocity, first touch.
+     * The sprites' collision circles are used for the test.
+     *
+     * @param  s1     The first sprite
+     * @param  s2     The second sprite
+     * @return        The fraction of the sprites' next movement when they
+     *                first touch, or -1 if they do not.
+     *
+     * @attribute class sprite
+     * @attribute method time_of_impact
+     * @attribute self  s1
+     */
+    float sprite_time_of_impact(sprite s1, sprite s2);
+
+    /**
+     * Moves the sprite by its velocity, stopping where it first touches the
+     * rectangle. This checks the whole movement, so fast sprites do not pass
+     * through thin walls.
+     *
+     * @param  s      The sprite to move
+     * @param  rect   The rectangle the sprite must stop at
+     * @return        True if the sprite was stopped by the rectangle
+     *
+     * @attribute class sprite
+     * @attribute method move_until_collision
+     * @attribute suffix with_rectangle
+     */
+    bool move_sprite_until_collision(sprite s, const rectangle &rect);
+
+    /**
+     * Moves the sprite by its velocity, stopping where it first touches the
+     * line.
+     *
+     * @param  s      The sprite to move
+     * @param  l      The line the sprite must stop at
+     * @return        True if the sprite was stopped by the line
+     *
+     * @attribute class sprite
+     * @attribute method move_until_collision
+     * @attribute suffix with_line
+     */
+    bool move_sprite_until_collision(sprite s, const line &l);
+
+    /**
+     * Moves the sprite by its velocity, stopping where it first touches the
+     * other sprite, which is assumed to move by its own velocity in the same
+     * update. Only `s` is moved.
+     *
+     * @param  s      The sprite to move
+     * @param  other  The sprite that `s` must stop at
+     * @return        True if the sprite was stopped by the other sprite
+     *
+     * @attribute class sprite
+     * @attribute method move_until_collision
+     * @attribute suffix with_sprite
+     */
+    bool move_sprite_until_collision(sprite s, sprite other);
+
 }
 #endif /* collisions_h */
@@ -8,6 +8,7 @@
 
 #include "color.h"
 #include "random.h"
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <iostream>
@@ -255,6 +256,109 @@ namespace splashkit_lib
         return b;
     }
 
+    rgba8 color_to_rgba8(color c)
+    {
+        // colors are clamped to 0..1 when they are made, so adding a half rounds
+        return {
+            static_cast<uint8_t>(c.r * 255 + 0.5f),
+            static_cast<uint8_t>(c.g * 255 + 0.5f),
+            static_cast<uint8_t>(c.b * 255 + 0.5f),
+            static_cast<uint8_t>(c.a * 255 + 0.5f)
+        };
+    }
+
+    color rgba8_to_color(rgba8 c)
+    {
+        const float scale = 1.0f / 255;
+        return { c.r * scale, c.g * scale, c.b * scale, c.a * scale };
+    }
+
+    void colors_to_rgba8(const vector<color> &colors, vector<rgba8> &out_packed)
+    {
+        size_t count = colors.size();
+        out_packed.resize(count);
+
+        const color *src = colors.data();
+        rgba8 *dst = out_packed.data();
+
+        // a plain loop over the components, so the compiler can convert several at once
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[i].r = static_cast<uint8_t>(src[i].r * 255 + 0.5f);
+            dst[i].g = static_cast<uint8_t>(src[i].g * 255 + 0.5f);
+            dst[i].b = static_cast<uint8_t>(src[i].b * 255 + 0.5f);
+            dst[i].a = static_cast<uint8_t>(src[i].a * 255 + 0.5f);
+        }
+    }
+
+    // One component of an hsb color, for n of 5 (red), 3 (green) or 1 (blue).
+    // This is the same as the domains in hsb_color, without the branches.
+    static inline double _hsb_component(double n, double h6, double s, double v)
+    {
+        double k = n + h6;
+        if ( k >= 6 ) k -= 6;
+
+        double ramp = std::min(std::min(k, 4 - k), 1.0);
+        return v - v * s * std::max(ramp, 0.0);
+    }
+
+    void hsb_to_rgb_many(const vector<double> &hues, const vector<double> &saturations, const vector<double> &brightnesses, vector<color> &out_colors)
+    {
+        size_t count = std::min(hues.size(), std::min(saturations.size(), brightnesses.size()));
+        out_colors.resize(count);
+
+        const double *h = hues.data(), *s = saturations.data(), *v = brightnesses.data();
+        color *dst = out_colors.data();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            double sat = std::min(std::fabs(s[i]), 1.0);
+            double bri = std::min(std::fabs(v[i]), 1.0);
+            double h6 = (h[i] - std::floor(h[i])) * 6;
+
+            dst[i].r = static_cast<float>(_hsb_component(5, h6, sat, bri));
+            dst[i].g = static_cast<float>(_hsb_component(3, h6, sat, bri));
+            dst[i].b = static_cast<float>(_hsb_component(1, h6, sat, bri));
+            dst[i].a = 1.0f;
+        }
+    }
+
+    void rgb_to_hsb_many(const vector<color> &colors, vector<double> &out_hues, vector<double> &out_saturations, vector<double> &out_brightnesses)
+    {
+        size_t count = colors.size();
+        out_hues.resize(count);
+        out_saturations.resize(count);
+        out_brightnesses.resize(count);
+
+        const color *src = colors.data();
+        double *h = out_hues.data(), *s = out_saturations.data(), *b = out_brightnesses.data();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            double rf = src[i].r, gf = src[i].g, bf = src[i].b;
+            double max_rgb = std::max(std::max(rf, gf), bf);
+            double min_rgb = std::min(std::min(rf, gf), bf);
+            double delta = max_rgb - min_rgb;
+
+            b[i] = max_rgb;
+            s[i] = max_rgb != 0.0 ? delta / max_rgb : 0.0;
+
+            double hue;
+            if ( delta == 0.0 )
+                hue = -1.0;     // grays match hsb_value_of, which gives them a hue of 300 degrees
+            else if ( rf == max_rgb )
+                hue = (gf - bf) / delta;
+            else if ( gf == max_rgb )
+                hue = 2.0 + (bf - rf) / delta;
+            else
+                hue = 4.0 + (rf - gf) / delta;
+
+            hue = hue * 60;
+            if ( hue < 0.0 ) hue += 360.0;
+            h[i] = hue / 360.0;
+        }
+    }
+
     color color_gray()
     {
         return rgba_color(0.5f, 0.5f, 0.5f, 1.0f);
@@ -912,6 +912,65 @@ namespace splashkit_lib
      */
     double brightness_of(color c);
 
+    /**
+     * Packs a color into four bytes, rounding each component to the nearest
+     * value between 0 and 255.
+     *
+     * @param  c The color
+     * @return   The packed color
+     *
+     * @attribute static color
+     * @attribute method to_rgba8
+     */
+    rgba8 color_to_rgba8(color c);
+
+    /**
+     * Unpacks a packed color.
+     *
+     * @param  c The packed color
+     * @return   The color, with each component between 0 and 1
+     *
+     * @attribute static color
+     * @attribute method from_rgba8
+     */
+    color rgba8_to_color(rgba8 c);
+
+    /**
+     * Packs many colors at once. This is much faster than packing the colors
+     * in turn, as the colors are converted together.
+     *
+     * @param colors     The colors to pack
+     * @param out_packed Set to the packed colors, in the same order
+     */
+    void colors_to_rgba8(const vector<color> &colors, vector<rgba8> &out_packed);
+
+    /**
+     * Converts many hue, saturation and brightness values to colors at once,
+     * giving the same colors as `hsb_color`. Each color is made from the
+     * values at the same index, and all of the colors are opaque. This is
+     * much faster than calling `hsb_color` for each color, as the colors are
+     * converted together without branching.
+     *
+     * @param hues        The hues, between 0 and 1
+     * @param saturations The saturations, between 0 and 1
+     * @param brightnesses The brightnesses, between 0 and 1
+     * @param out_colors  Set to the colors. Only as many colors are made as
+     *                    there are values in the shortest list.
+     */
+    void hsb_to_rgb_many(const vector<double> &hues, const vector<double> &saturations, const vector<double> &brightnesses, vector<color> &out_colors);
+
+    /**
+     * Works out the hue, saturation and brightness of many colors at once,
+     * giving the same values as `hue_of`, `saturation_of` and
+     * `brightness_of`.
+     *
+     * @param colors           The colors
+     * @param out_hues         Set to the hue of each color
+     * @param out_saturations  Set to the saturation of each color
+     * @param out_brightnesses Set to the brightness of each color
+     */
+    void rgb_to_hsb_many(const vector<color> &colors, vector<double> &out_hues, vector<double> &out_saturations, vector<double> &out_brightnesses);
+
     /**
      * Generates a new `color` associated to the color `alice_blue`.
      * @return A new `color` set to `alice_blue`.
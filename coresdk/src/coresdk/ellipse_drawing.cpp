@@ -19,7 +19,7 @@
 #include "graphics_driver.h"
 namespace splashkit_lib
 {
-    void draw_ellipse(color clr, double x, double y, double width, double height, drawing_options opts)
+    void draw_ellipse(color clr, double x, double y, double width, double height, const drawing_options &opts)
     {
         if ( width == 0 || height == 0 ) return;
 
@@ -51,7 +51,7 @@ namespace splashkit_lib
         draw_ellipse(clr, x, y, width, height, option_defaults());
     }
 
-    void draw_ellipse(color clr, const rectangle rect, drawing_options opts)
+    void draw_ellipse(color clr, const rectangle rect, const drawing_options &opts)
     {
         draw_ellipse(clr, rect.x, rect.y, rect.width, rect.height, opts);
     }
@@ -61,7 +61,7 @@ namespace splashkit_lib
         draw_ellipse(clr, rect.x, rect.y, rect.width, rect.height, option_defaults());
     }
 
-    void fill_ellipse(color clr, double x, double y, double width, double height, drawing_options opts)
+    void fill_ellipse(color clr, double x, double y, double width, double height, const drawing_options &opts)
     {
         if ( width == 0 || height == 0 ) return;
 
@@ -93,7 +93,7 @@ namespace splashkit_lib
         fill_ellipse(clr, x, y, width, height, option_defaults());
     }
     
-    void fill_ellipse(color clr, const rectangle rect, drawing_options opts)
+    void fill_ellipse(color clr, const rectangle rect, const drawing_options &opts)
     {
         fill_ellipse(clr, rect.x, rect.y, rect.width, rect.height, opts);
     }
@@ -103,7 +103,7 @@ namespace splashkit_lib
         fill_ellipse(clr, rect.x, rect.y, rect.width, rect.height, option_defaults());
     }
     
-    void draw_ellipse_on_window(window destination, color clr, double x, double y, double width, double height, drawing_options opts)
+    void draw_ellipse_on_window(window destination, color clr, double x, double y, double width, double height, const drawing_options &opts)
     {
         draw_ellipse(clr, x, y, width, height, option_draw_to(destination, opts));
     }
@@ -113,7 +113,7 @@ namespace splashkit_lib
         draw_ellipse(clr, x, y, width, height, option_draw_to(destination));
     }
     
-    void draw_ellipse_on_window(window destination, color clr, const rectangle rect, drawing_options opts)
+    void draw_ellipse_on_window(window destination, color clr, const rectangle rect, const drawing_options &opts)
     {
         draw_ellipse(clr, rect, option_draw_to(destination, opts));
     }
@@ -123,7 +123,7 @@ namespace splashkit_lib
         draw_ellipse(clr, rect, option_draw_to(destination));
     }
     
-    void fill_ellipse_on_window(window destination, color clr, double x, double y, double width, double height, drawing_options opts)
+    void fill_ellipse_on_window(window destination, color clr, double x, double y, double width, double height, const drawing_options &opts)
     {
         fill_ellipse(clr, x, y, width, height, option_draw_to(destination, opts));
     }
@@ -133,7 +133,7 @@ namespace splashkit_lib
         fill_ellipse(clr, x, y, width, height, option_draw_to(destination));
     }
     
-    void fill_ellipse_on_window(window destination, color clr, const rectangle rect, drawing_options opts)
+    void fill_ellipse_on_window(window destination, color clr, const rectangle rect, const drawing_options &opts)
     {
         fill_ellipse(clr, rect, option_draw_to(destination, opts));
     }
@@ -143,7 +143,7 @@ namespace splashkit_lib
         fill_ellipse(clr, rect, option_draw_to(destination));
     }
 
-    void draw_ellipse_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, drawing_options opts)
+    void draw_ellipse_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, const drawing_options &opts)
     {
         draw_ellipse(clr, x, y, width, height, option_draw_to(destination, opts));
     }
@@ -153,7 +153,7 @@ namespace splashkit_lib
         draw_ellipse(clr, x, y, width, height, option_draw_to(destination));
     }
     
-    void draw_ellipse_on_bitmap(bitmap destination, color clr, const rectangle rect, drawing_options opts)
+    void draw_ellipse_on_bitmap(bitmap destination, color clr, const rectangle rect, const drawing_options &opts)
     {
         draw_ellipse(clr, rect, option_draw_to(destination, opts));
     }
@@ -163,7 +163,7 @@ namespace splashkit_lib
         draw_ellipse(clr, rect, option_draw_to(destination));
     }
     
-    void fill_ellipse_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, drawing_options opts)
+    void fill_ellipse_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, const drawing_options &opts)
     {
         fill_ellipse(clr, x, y, width, height, option_draw_to(destination, opts));
     }
@@ -173,7 +173,7 @@ namespace splashkit_lib
         fill_ellipse(clr, x, y, width, height, option_draw_to(destination));
     }
     
-    void fill_ellipse_on_bitmap(bitmap destination, color clr, const rectangle rect, drawing_options opts)
+    void fill_ellipse_on_bitmap(bitmap destination, color clr, const rectangle rect, const drawing_options &opts)
     {
         fill_ellipse(clr, rect, option_draw_to(destination, opts));
     }
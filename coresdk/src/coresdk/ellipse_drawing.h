@@ -29,7 +29,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  with_options
      */
-    void draw_ellipse(color clr, double x, double y, double width, double height, drawing_options opts);
+    void draw_ellipse(color clr, double x, double y, double width, double height, const drawing_options &opts);
 
     /**
      * Draws an ellipse using the provided location, and size.
@@ -56,7 +56,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  within_rectangle_with_options
      */
-    void draw_ellipse(color clr, const rectangle rect, drawing_options opts);
+    void draw_ellipse(color clr, const rectangle rect, const drawing_options &opts);
 
     /**
      * Draws an ellipse using the provided location, and size.
@@ -82,7 +82,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  with_options
      */
-    void fill_ellipse(color clr, double x, double y, double width, double height, drawing_options opts);
+    void fill_ellipse(color clr, double x, double y, double width, double height, const drawing_options &opts);
 
     /**
      * Fills an ellipse using the provided location, and size.
@@ -109,7 +109,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  within_rectangle_with_options
      */
-    void fill_ellipse(color clr, const rectangle rect, drawing_options opts);
+    void fill_ellipse(color clr, const rectangle rect, const drawing_options &opts);
 
     /**
      * Fill an ellipse using the provided location, and size.
@@ -141,7 +141,7 @@ namespace splashkit_lib
      * @attribute suffix  with_options
      * @attribute method  draw_ellipse
      */
-    void draw_ellipse_on_window(window destination, color clr, double x, double y, double width, double height, drawing_options opts);
+    void draw_ellipse_on_window(window destination, color clr, double x, double y, double width, double height, const drawing_options &opts);
     
     /**
      * Draws an ellipse on the given window, using the provided location, and size.
@@ -175,7 +175,7 @@ namespace splashkit_lib
      * @attribute method  draw_ellipse
      * @attribute suffix  within_rectangle_with_options
      */
-    void draw_ellipse_on_window(window destination, color clr, const rectangle rect, drawing_options opts);
+    void draw_ellipse_on_window(window destination, color clr, const rectangle rect, const drawing_options &opts);
     
     /**
      * Draws an ellipse on the given window, using the provided location, and size.
@@ -207,7 +207,7 @@ namespace splashkit_lib
      * @attribute method  fill_ellipse
      * @attribute suffix  with_options
      */
-    void fill_ellipse_on_window(window destination, color clr, double x, double y, double width, double height, drawing_options opts);
+    void fill_ellipse_on_window(window destination, color clr, double x, double y, double width, double height, const drawing_options &opts);
     
     /**
      * Fills an ellipse on the given window, using the provided location, and size.
@@ -241,7 +241,7 @@ namespace splashkit_lib
      * @attribute method  fill_ellipse
      * @attribute suffix  within_rectangle_with_options
      */
-    void fill_ellipse_on_window(window destination, color clr, const rectangle rect, drawing_options opts);
+    void fill_ellipse_on_window(window destination, color clr, const rectangle rect, const drawing_options &opts);
     
     /**
      * Fill an ellipse on the given window, using the provided location, and size.
@@ -276,7 +276,7 @@ namespace splashkit_lib
      * @attribute method  draw_ellipse
      * @attribute suffix  with_options
      */
-    void draw_ellipse_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, drawing_options opts);
+    void draw_ellipse_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, const drawing_options &opts);
     
     /**
      * Draws an ellipse on the given bitmap, using the provided location, and size.
@@ -310,7 +310,7 @@ namespace splashkit_lib
      * @attribute method  draw_ellipse
      * @attribute suffix  within_rectangle_with_options
      */
-    void draw_ellipse_on_bitmap(bitmap destination, color clr, const rectangle rect, drawing_options opts);
+    void draw_ellipse_on_bitmap(bitmap destination, color clr, const rectangle rect, const drawing_options &opts);
     
     /**
      * Draws an ellipse on the given bitmap, using the provided location, and size.
@@ -342,7 +342,7 @@ namespace splashkit_lib
      * @attribute method  fill_ellipse
      * @attribute suffix  with_options
      */
-    void fill_ellipse_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, drawing_options opts);
+    void fill_ellipse_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, const drawing_options &opts);
     
     /**
      * Fills an ellipse on the given bitmap, using the provided location, and size.
@@ -376,7 +376,7 @@ namespace splashkit_lib
      * @attribute method  fill_ellipse
      * @attribute suffix  within_rectangle_with_options
      */
-    void fill_ellipse_on_bitmap(bitmap destination, color clr, const rectangle rect, drawing_options opts);
+    void fill_ellipse_on_bitmap(bitmap destination, color clr, const rectangle rect, const drawing_options &opts);
     
     /**
      * Fill an ellipse on the given bitmap, using the provided location, and size.
@@ -0,0 +1,572 @@
+//
+//  fixed_point.cpp
+//  splashkit
+//
+//  Fixed point values have 16 fractional bits. Everything here uses only
+//  integer arithmetic, and trigonometry uses CORDIC with a fixed table, so
+//  results do not depend on the processor, compiler or maths library.
+//
+
+#include "fixed_point.h"
+
+#include <climits>
+#include <cmath>
+#include <cstdint>
+
+#define FIXED_SHIFT 16
+#define FIXED_ONE (1LL << FIXED_SHIFT)
+#define FIXED_HALF (1LL << (FIXED_SHIFT - 1))
+
+// CORDIC works with angles in degrees with 32 fractional bits, and vectors
+// with 30 fractional bits
+#define CORDIC_ANGLE_SHIFT 32
+#define CORDIC_SHIFT 30
+#define CORDIC_STEPS 32
+
+namespace splashkit_lib
+{
+    // atan(2^-i) in degrees, with 32 fractional bits
+    static const long long CORDIC_ANGLES[CORDIC_STEPS] =
+    {
+        193273528320LL, 114096026022LL, 60285206653LL, 30601712202LL,
+        15360239180LL, 7687607525LL, 3844741810LL, 1922488225LL,
+        961258780LL, 480631223LL, 240315841LL, 120157949LL,
+        60078978LL, 30039490LL, 15019745LL, 7509872LL,
+        3754936LL, 1877468LL, 938734LL, 469367LL,
+        234684LL, 117342LL, 58671LL, 29335LL,
+        14668LL, 7334LL, 3667LL, 1833LL,
+        917LL, 458LL, 229LL, 115LL
+    };
+
+    // The product of cos(atan(2^-i)), which undoes the growth of the vector
+    // over the CORDIC steps, with 30 fractional bits
+    static const long long CORDIC_GAIN = 652032874LL;
+
+    //
+    // Wide arithmetic
+    //
+    // Products of two fixed point values need 128 bits before they are
+    // shifted back down. This is done by hand in two 64 bit halves, as not
+    // every compiler SplashKit targets has a 128 bit integer. Results that do
+    // not fit in a long long saturate at LLONG_MAX or LLONG_MIN.
+    //
+
+    // A two's complement 128 bit value
+    struct _fixed_wide
+    {
+        uint64_t hi, lo;
+    };
+
+    static _fixed_wide _wide_from(long long value)
+    {
+        return { value < 0 ? ~uint64_t(0) : 0, static_cast<uint64_t>(value) };
+    }
+
+    static _fixed_wide _wide_add(const _fixed_wide &a, const _fixed_wide &b)
+    {
+        uint64_t lo = a.lo + b.lo;
+        return { a.hi + b.hi + (lo < a.lo ? 1 : 0), lo };
+    }
+
+    static _fixed_wide _wide_negate(const _fixed_wide &a)
+    {
+        uint64_t lo = ~a.lo + 1;
+        return { ~a.hi + (lo == 0 ? 1 : 0), lo };
+    }
+
+    static bool _wide_negative(const _fixed_wide &a)
+    {
+        return (a.hi >> 63) != 0;
+    }
+
+    static _fixed_wide _wide_multiply(long long a, long long b)
+    {
+        // Multiply the magnitudes in 32 bit pieces, then restore the sign
+        uint64_t ua = a < 0 ? ~static_cast<uint64_t>(a) + 1 : static_cast<uint64_t>(a);
+        uint64_t ub = b < 0 ? ~static_cast<uint64_t>(b) + 1 : static_cast<uint64_t>(b);
+
+        uint64_t a_lo = ua & 0xffffffff, a_hi = ua >> 32;
+        uint64_t b_lo = ub & 0xffffffff, b_hi = ub >> 32;
+
+        uint64_t lo_lo = a_lo * b_lo;
+        uint64_t hi_lo = a_hi * b_lo;
+        uint64_t lo_hi = a_lo * b_hi;
+        uint64_t hi_hi = a_hi * b_hi;
+
+        uint64_t middle = (lo_lo >> 32) + (hi_lo & 0xffffffff) + (lo_hi & 0xffffffff);
+        _fixed_wide result = { hi_hi + (hi_lo >> 32) + (lo_hi >> 32) + (middle >> 32), (middle << 32) | (lo_lo & 0xffffffff) };
+
+        return (a < 0) != (b < 0) ? _wide_negate(result) : result;
+    }
+
+    // Shift the wide value down by shift bits, rounding toward negative
+    // infinity as >> does, and saturate it into a long long
+    static long long _wide_narrow(const _fixed_wide &a, int shift)
+    {
+        bool negative = _wide_negative(a);
+
+        uint64_t lo = shift == 0 ? a.lo : (a.lo >> shift) | (a.hi << (64 - shift));
+        uint64_t hi = shift == 0 ? a.hi : (a.hi >> shift) | (negative ? ~uint64_t(0) << (64 - shift) : 0);
+
+        // It fits if the high half only holds copies of the low half's sign bit
+        uint64_t expected_hi = (lo >> 63) != 0 ? ~uint64_t(0) : 0;
+        if ( hi != expected_hi ) return negative ? LLONG_MIN : LLONG_MAX;
+
+        return static_cast<long long>(lo);
+    }
+
+    static bool _wide_less_equal(const _fixed_wide &a, const _fixed_wide &b)
+    {
+        if ( a.hi != b.hi ) return static_cast<long long>(a.hi) < static_cast<long long>(b.hi);
+        return a.lo <= b.lo;
+    }
+
+    static long long _fixed_add(long long a, long long b)
+    {
+        return _wide_narrow(_wide_add(_wide_from(a), _wide_from(b)), 0);
+    }
+
+    static long long _fixed_subtract(long long a, long long b)
+    {
+        return _wide_narrow(_wide_add(_wide_from(a), _wide_negate(_wide_from(b))), 0);
+    }
+
+    // The sum of the products, plus a half to round, shifted back to 16
+    // fractional bits
+    static long long _fixed_sum_of_products(long long a1, long long b1, long long a2, long long b2, long long a3 = 0, long long b3 = 0)
+    {
+        _fixed_wide sum = _wide_add(_wide_multiply(a1, b1), _wide_multiply(a2, b2));
+        sum = _wide_add(sum, _wide_multiply(a3, b3));
+        return _wide_narrow(_wide_add(sum, _wide_from(FIXED_HALF)), FIXED_SHIFT);
+    }
+
+    long long fixed_from_double(double value)
+    {
+        double scaled = value * FIXED_ONE;
+
+        if ( std::isnan(scaled) ) return 0;
+        if ( scaled >= 9223372036854775807.0 ) return LLONG_MAX;
+        if ( scaled <= -9223372036854775808.0 ) return LLONG_MIN;
+
+        return std::llround(scaled);
+    }
+
+    long long fixed_from_int(int value)
+    {
+        return static_cast<long long>(value) * FIXED_ONE;
+    }
+
+    double fixed_to_double(long long value)
+    {
+        return static_cast<double>(value) / FIXED_ONE;
+    }
+
+    long long fixed_multiply(long long a, long long b)
+    {
+        return _fixed_sum_of_products(a, b, 0, 0);
+    }
+
+    long long fixed_divide(long long a, long long b)
+    {
+        if ( b == 0 ) return 0;
+
+        bool negative = (a < 0) != (b < 0);
+        uint64_t ua = a < 0 ? ~static_cast<uint64_t>(a) + 1 : static_cast<uint64_t>(a);
+        uint64_t ub = b < 0 ? ~static_cast<uint64_t>(b) + 1 : static_cast<uint64_t>(b);
+
+        // a * 2^16 / b, as the whole quotient followed by 16 bits of long
+        // division of the remainder, truncating toward zero as / does
+        uint64_t quotient = ua / ub, remainder = ua % ub;
+        if ( quotient >= (uint64_t(1) << (63 - FIXED_SHIFT)) ) return negative ? LLONG_MIN : LLONG_MAX;
+
+        for (int i = 0; i < FIXED_SHIFT; i++)
+        {
+            // remainder < ub <= 2^63, so doubling it can not overflow
+            remainder <<= 1;
+            quotient <<= 1;
+            if ( remainder >= ub )
+            {
+                remainder -= ub;
+                quotient |= 1;
+            }
+        }
+
+        return negative ? -static_cast<long long>(quotient) : static_cast<long long>(quotient);
+    }
+
+    // The largest whole number whose square is no more than value
+    static uint64_t _integer_sqrt(uint64_t value)
+    {
+        uint64_t result = 0;
+        uint64_t bit = uint64_t(1) << 62;
+
+        while ( bit > value ) bit >>= 2;
+
+        while ( bit != 0 )
+        {
+            if ( value >= result + bit )
+            {
+                value -= result + bit;
+                result = (result >> 1) + bit;
+            }
+            else
+                result >>= 1;
+            bit >>= 2;
+        }
+
+        return result;
+    }
+
+    long long fixed_square_root(long long value)
+    {
+        if ( value <= 0 ) return 0;
+
+        // sqrt(v * 2^16) is sqrt(v) with 16 fractional bits. Large values
+        // lose their last 8 bits rather than overflowing.
+        if ( value < (1LL << 47) )
+            return static_cast<long long>(_integer_sqrt(static_cast<uint64_t>(value) << FIXED_SHIFT));
+        else
+            return static_cast<long long>(_integer_sqrt(static_cast<uint64_t>(value))) << (FIXED_SHIFT / 2);
+    }
+
+    //
+    // Trigonometry
+    //
+
+    static void _fixed_sine_cosine(long long degrees, long long &out_sine, long long &out_cosine)
+    {
+        const long long full_turn = 360LL << FIXED_SHIFT;
+        const long long half_turn = 180LL << FIXED_SHIFT;
+        const long long quarter_turn = 90LL << FIXED_SHIFT;
+
+        // Bring the angle into -90 to 90, where CORDIC converges
+        long long z = degrees % full_turn;
+        if ( z >= half_turn ) z -= full_turn;
+        else if ( z < -half_turn ) z += full_turn;
+
+        bool flip = false;
+        if ( z > quarter_turn ) { z -= half_turn; flip = true; }
+        else if ( z < -quarter_turn ) { z += half_turn; flip = true; }
+
+        z *= 1LL << (CORDIC_ANGLE_SHIFT - FIXED_SHIFT);
+
+        long long x = CORDIC_GAIN, y = 0;
+        for (int i = 0; i < CORDIC_STEPS; i++)
+        {
+            long long dx = y >> i, dy = x >> i;
+            if ( z >= 0 )
+            {
+                x -= dx;
+                y += dy;
+                z -= CORDIC_ANGLES[i];
+            }
+            else
+            {
+                x += dx;
+                y -= dy;
+                z += CORDIC_ANGLES[i];
+            }
+        }
+
+        const long long round = 1LL << (CORDIC_SHIFT - FIXED_SHIFT - 1);
+        out_cosine = (x + round) >> (CORDIC_SHIFT - FIXED_SHIFT);
+        out_sine = (y + round) >> (CORDIC_SHIFT - FIXED_SHIFT);
+
+        if ( flip )
+        {
+            out_cosine = -out_cosine;
+            out_sine = -out_sine;
+        }
+    }
+
+    long long fixed_sine(long long degrees)
+    {
+        long long s, c;
+        _fixed_sine_cosine(degrees, s, c);
+        return s;
+    }
+
+    long long fixed_cosine(long long degrees)
+    {
+        long long s, c;
+        _fixed_sine_cosine(degrees, s, c);
+        return c;
+    }
+
+    long long fixed_arc_tangent(long long y, long long x)
+    {
+        if ( x == 0 and y == 0 ) return 0;
+
+        const long long half_turn = 180LL << CORDIC_ANGLE_SHIFT;
+        long long z = 0;
+
+        // Scale down large vectors so the steps can not overflow. The angle
+        // does not change, and the sign of each component is kept.
+        while ( x >= (1LL << 61) or x <= -(1LL << 61) or y >= (1LL << 61) or y <= -(1LL << 61) )
+        {
+            x /= 2;
+            y /= 2;
+        }
+
+        // Rotate into the right half, where CORDIC converges
+        if ( x < 0 )
+        {
+            z = y >= 0 ? half_turn : -half_turn;
+            x = -x;
+            y = -y;
+        }
+
+        // Scale up small vectors so each step keeps its precision
+        while ( x < (1LL << 29) and y < (1LL << 29) and y > -(1LL << 29) )
+        {
+            x *= 2;
+            y *= 2;
+        }
+
+        for (int i = 0; i < CORDIC_STEPS; i++)
+        {
+            long long dx = y >> i, dy = x >> i;
+            if ( y > 0 )
+            {
+                x += dx;
+                y -= dy;
+                z += CORDIC_ANGLES[i];
+            }
+            else
+            {
+                x -= dx;
+                y += dy;
+                z -= CORDIC_ANGLES[i];
+            }
+        }
+
+        const long long round = 1LL << (CORDIC_ANGLE_SHIFT - FIXED_SHIFT - 1);
+        return (z + round) >> (CORDIC_ANGLE_SHIFT - FIXED_SHIFT);
+    }
+
+    //
+    // Vectors
+    //
+
+    fixed_vector_2d fixed_vector_to(long long x, long long y)
+    {
+        return { x, y };
+    }
+
+    fixed_vector_2d fixed_vector_from(const vector_2d &v)
+    {
+        return { fixed_from_double(v.x), fixed_from_double(v.y) };
+    }
+
+    vector_2d vector_from_fixed(const fixed_vector_2d &v)
+    {
+        return { fixed_to_double(v.x), fixed_to_double(v.y) };
+    }
+
+    point_2d point_from_fixed(const fixed_vector_2d &v)
+    {
+        return { fixed_to_double(v.x), fixed_to_double(v.y) };
+    }
+
+    fixed_vector_2d fixed_vector_from_angle(long long degrees, long long magnitude)
+    {
+        long long s, c;
+        _fixed_sine_cosine(degrees, s, c);
+        return { fixed_multiply(c, magnitude), fixed_multiply(s, magnitude) };
+    }
+
+    fixed_vector_2d fixed_vector_add(const fixed_vector_2d &v1, const fixed_vector_2d &v2)
+    {
+        return { _fixed_add(v1.x, v2.x), _fixed_add(v1.y, v2.y) };
+    }
+
+    fixed_vector_2d fixed_vector_subtract(const fixed_vector_2d &v1, const fixed_vector_2d &v2)
+    {
+        return { _fixed_subtract(v1.x, v2.x), _fixed_subtract(v1.y, v2.y) };
+    }
+
+    fixed_vector_2d fixed_vector_multiply(const fixed_vector_2d &v, long long s)
+    {
+        return { fixed_multiply(v.x, s), fixed_multiply(v.y, s) };
+    }
+
+    long long fixed_dot_product(const fixed_vector_2d &v1, const fixed_vector_2d &v2)
+    {
+        return _fixed_sum_of_products(v1.x, v2.x, v1.y, v2.y);
+    }
+
+    long long fixed_vector_magnitude_squared(const fixed_vector_2d &v)
+    {
+        return fixed_dot_product(v, v);
+    }
+
+    long long fixed_vector_magnitude(const fixed_vector_2d &v)
+    {
+        // The square root of the full precision sum already has 16 fractional
+        // bits. Components are halved until the sum fits in 64 bits, which
+        // halves the root, so only very long vectors lose their last bits.
+        uint64_t x = v.x < 0 ? ~static_cast<uint64_t>(v.x) + 1 : static_cast<uint64_t>(v.x);
+        uint64_t y = v.y < 0 ? ~static_cast<uint64_t>(v.y) + 1 : static_cast<uint64_t>(v.y);
+        int halved = 0;
+
+        while ( x >= (uint64_t(1) << 31) or y >= (uint64_t(1) << 31) )
+        {
+            x >>= 1;
+            y >>= 1;
+            halved++;
+        }
+
+        uint64_t root = _integer_sqrt(x * x + y * y);
+        if ( halved > 0 and root > (static_cast<uint64_t>(LLONG_MAX) >> halved) ) return LLONG_MAX;
+
+        return static_cast<long long>(root << halved);
+    }
+
+    long long fixed_vector_angle(const fixed_vector_2d &v)
+    {
+        return fixed_arc_tangent(v.y, v.x);
+    }
+
+    fixed_vector_2d fixed_unit_vector(const fixed_vector_2d &v)
+    {
+        long long mag = fixed_vector_magnitude(v);
+        if ( mag == 0 ) return { 0, 0 };
+
+        return { fixed_divide(v.x, mag), fixed_divide(v.y, mag) };
+    }
+
+    bool fixed_vectors_equal(const fixed_vector_2d &v1, const fixed_vector_2d &v2)
+    {
+        return v1.x == v2.x and v1.y == v2.y;
+    }
+
+    //
+    // Matrices
+    //
+
+    static fixed_matrix_2d _fixed_matrix(long long a, long long b, long long c, long long d, long long e, long long f)
+    {
+        fixed_matrix_2d result;
+
+        result.elements[0][0] = a;
+        result.elements[0][1] = b;
+        result.elements[0][2] = c;
+
+        result.elements[1][0] = d;
+        result.elements[1][1] = e;
+        result.elements[1][2] = f;
+
+        result.elements[2][0] = 0;
+        result.elements[2][1] = 0;
+        result.elements[2][2] = FIXED_ONE;
+
+        return result;
+    }
+
+    fixed_matrix_2d fixed_identity_matrix()
+    {
+        return _fixed_matrix(FIXED_ONE, 0, 0, 0, FIXED_ONE, 0);
+    }
+
+    fixed_matrix_2d fixed_translation_matrix(long long dx, long long dy)
+    {
+        return _fixed_matrix(FIXED_ONE, 0, dx, 0, FIXED_ONE, dy);
+    }
+
+    fixed_matrix_2d fixed_rotation_matrix(long long degrees)
+    {
+        // The same layout as rotation_matrix
+        long long s, c;
+        _fixed_sine_cosine(-degrees, s, c);
+        return _fixed_matrix(c, s, 0, -s, c, 0);
+    }
+
+    fixed_matrix_2d fixed_scale_matrix(long long scale)
+    {
+        return _fixed_matrix(scale, 0, 0, 0, scale, 0);
+    }
+
+    fixed_matrix_2d fixed_matrix_multiply(const fixed_matrix_2d &m2, const fixed_matrix_2d &m1)
+    {
+        // Matches the order of matrix_multiply
+        fixed_matrix_2d result;
+
+        for (int r = 0; r < 3; r++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                result.elements[r][c] = _fixed_sum_of_products(m1.elements[r][0], m2.elements[0][c],
+                                                               m1.elements[r][1], m2.elements[1][c],
+                                                               m1.elements[r][2], m2.elements[2][c]);
+            }
+        }
+
+        return result;
+    }
+
+    fixed_vector_2d fixed_matrix_multiply(const fixed_matrix_2d &m, const fixed_vector_2d &v)
+    {
+        fixed_vector_2d result;
+
+        result.x = _fixed_add(_fixed_sum_of_products(v.x, m.elements[0][0], v.y, m.elements[0][1]), m.elements[0][2]);
+        result.y = _fixed_add(_fixed_sum_of_products(v.x, m.elements[1][0], v.y, m.elements[1][1]), m.elements[1][2]);
+
+        return result;
+    }
+
+    matrix_2d matrix_from_fixed(const fixed_matrix_2d &m)
+    {
+        matrix_2d result;
+
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 3; c++)
+                result.elements[r][c] = fixed_to_double(m.elements[r][c]);
+
+        return result;
+    }
+
+    //
+    // Collisions
+    //
+
+    // Compares squared distances at full precision
+    static bool _fixed_within(long long dx, long long dy, long long radius)
+    {
+        if ( radius < 0 ) return false;
+        if ( dx > radius or dx < -radius or dy > radius or dy < -radius ) return false;
+        return _wide_less_equal(_wide_add(_wide_multiply(dx, dx), _wide_multiply(dy, dy)), _wide_multiply(radius, radius));
+    }
+
+    bool fixed_point_in_circle(const fixed_vector_2d &pt, const fixed_circle &c)
+    {
+        return _fixed_within(_fixed_subtract(pt.x, c.center.x), _fixed_subtract(pt.y, c.center.y), c.radius);
+    }
+
+    bool fixed_point_in_rectangle(const fixed_vector_2d &pt, const fixed_rectangle &rect)
+    {
+        return pt.x >= rect.x and pt.x <= _fixed_add(rect.x, rect.width) and pt.y >= rect.y and pt.y <= _fixed_add(rect.y, rect.height);
+    }
+
+    bool fixed_circles_intersect(const fixed_circle &c1, const fixed_circle &c2)
+    {
+        return _fixed_within(_fixed_subtract(c1.center.x, c2.center.x), _fixed_subtract(c1.center.y, c2.center.y), _fixed_add(c1.radius, c2.radius));
+    }
+
+    bool fixed_rectangles_intersect(const fixed_rectangle &rect1, const fixed_rectangle &rect2)
+    {
+        return rect1.x < _fixed_add(rect2.x, rect2.width) and rect2.x < _fixed_add(rect1.x, rect1.width) and
+               rect1.y < _fixed_add(rect2.y, rect2.height) and rect2.y < _fixed_add(rect1.y, rect1.height);
+    }
+
+    bool fixed_circle_rectangle_intersect(const fixed_circle &c, const fixed_rectangle &rect)
+    {
+        long long right = _fixed_add(rect.x, rect.width);
+        long long bottom = _fixed_add(rect.y, rect.height);
+
+        // The closest point in the rectangle to the centre of the circle
+        long long x = c.center.x < rect.x ? rect.x : (c.center.x > right ? right : c.center.x);
+        long long y = c.center.y < rect.y ? rect.y : (c.center.y > bottom ? bottom : c.center.y);
+
+        return _fixed_within(_fixed_subtract(c.center.x, x), _fixed_subtract(c.center.y, y), c.radius);
+    }
+}
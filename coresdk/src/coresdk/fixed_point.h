@@ -0,0 +1,388 @@
+/**
+ * @header  fixed_point
+ * @brief   Fixed point vectors, matrices and collisions give the same results on every computer.
+ *
+ * Calculations with `double` values can give slightly different results on
+ * different processors and compilers, particularly for trigonometry. Games
+ * that run the same simulation on several computers, and only send the
+ * players' inputs over the network, need every computer to get exactly the
+ * same answer. The fixed point functions use whole number arithmetic to do
+ * this.
+ *
+ * Fixed point values are stored in a `long long`, with 16 bits after the
+ * binary point, so 1.0 is stored as 65536. Use `fixed_from_double` and
+ * `fixed_to_double` to convert values, for example to draw the results of a
+ * simulation. Products are worked out at full precision, and results too
+ * large to store saturate at the largest or smallest `long long` rather
+ * than wrapping. Angles are in degrees, as in the rest of SplashKit.
+ *
+ * @attribute group  physics
+ * @attribute static fixed_point
+ */
+
+#ifndef fixed_point_h
+#define fixed_point_h
+
+#include "matrix_2d.h"
+#include "types.h"
+
+namespace splashkit_lib
+{
+    /**
+     * A vector with fixed point components.
+     *
+     * @field x   The x component, as a fixed point value
+     * @field y   The y component, as a fixed point value
+     */
+    struct fixed_vector_2d
+    {
+        long long x, y;
+    };
+
+    /**
+     * A matrix with fixed point elements, used to transform fixed point
+     * vectors in the same way as `matrix_2d`.
+     *
+     * @field elements The elements of the matrix, as fixed point values
+     */
+    struct fixed_matrix_2d
+    {
+        long long elements[3][3];
+    };
+
+    /**
+     * A circle with a fixed point centre and radius.
+     *
+     * @field center  The centre of the circle
+     * @field radius  The radius of the circle, as a fixed point value
+     */
+    struct fixed_circle
+    {
+        fixed_vector_2d center;
+        long long radius;
+    };
+
+    /**
+     * A rectangle with a fixed point position and size.
+     *
+     * @field x       The left of the rectangle, as a fixed point value
+     * @field y       The top of the rectangle, as a fixed point value
+     * @field width   The width of the rectangle, as a fixed point value
+     * @field height  The height of the rectangle, as a fixed point value
+     */
+    struct fixed_rectangle
+    {
+        long long x, y;
+        long long width, height;
+    };
+
+    /**
+     * Convert a number to a fixed point value, rounding it to the nearest
+     * 1/65536.
+     *
+     * @param value The value to convert
+     * @returns     The fixed point value
+     */
+    long long fixed_from_double(double value);
+
+    /**
+     * Convert a whole number to a fixed point value.
+     *
+     * @param value The value to convert
+     * @returns     The fixed point value
+     */
+    long long fixed_from_int(int value);
+
+    /**
+     * Convert a fixed point value to a number.
+     *
+     * @param value The fixed point value
+     * @returns     The value as a double
+     */
+    double fixed_to_double(long long value);
+
+    /**
+     * Multiply two fixed point values.
+     *
+     * @param a The first value
+     * @param b The second value
+     * @returns The product, rounded to the nearest fixed point value, and
+     *          saturated if it is out of range
+     */
+    long long fixed_multiply(long long a, long long b);
+
+    /**
+     * Divide two fixed point values.
+     *
+     * @param a The value to divide
+     * @param b The value to divide by
+     * @returns The result, or 0 if `b` is 0, saturated if it is out of
+     *          range
+     */
+    long long fixed_divide(long long a, long long b);
+
+    /**
+     * The square root of a fixed point value.
+     *
+     * @param value The value
+     * @returns     The square root, or 0 if the value is negative
+     */
+    long long fixed_square_root(long long value);
+
+    /**
+     * The sine of a fixed point angle. This gives the same result on every
+     * computer.
+     *
+     * @param degrees   The angle in degrees, as a fixed point value
+     * @returns         The sine of the angle, as a fixed point value
+     */
+    long long fixed_sine(long long degrees);
+
+    /**
+     * The cosine of a fixed point angle. This gives the same result on every
+     * computer.
+     *
+     * @param degrees   The angle in degrees, as a fixed point value
+     * @returns         The cosine of the angle, as a fixed point value
+     */
+    long long fixed_cosine(long long degrees);
+
+    /**
+     * The angle from the x axis to the point x, y. This gives the same result
+     * on every computer.
+     *
+     * @param y     The y value, as a fixed point value
+     * @param x     The x value, as a fixed point value
+     * @returns     The angle in degrees, between -180 and 180, as a fixed
+     *              point value
+     */
+    long long fixed_arc_tangent(long long y, long long x);
+
+    /**
+     * Create a fixed point vector.
+     *
+     * @param x The x component, as a fixed point value
+     * @param y The y component, as a fixed point value
+     * @returns The new vector
+     */
+    fixed_vector_2d fixed_vector_to(long long x, long long y);
+
+    /**
+     * Convert a vector to a fixed point vector.
+     *
+     * @param v The vector to convert
+     * @returns The fixed point vector
+     */
+    fixed_vector_2d fixed_vector_from(const vector_2d &v);
+
+    /**
+     * Convert a fixed point vector to a vector, for example to draw it.
+     *
+     * @param v The fixed point vector
+     * @returns The vector
+     */
+    vector_2d vector_from_fixed(const fixed_vector_2d &v);
+
+    /**
+     * Convert a fixed point vector to a point, for example to draw it.
+     *
+     * @param v The fixed point vector
+     * @returns The point
+     */
+    point_2d point_from_fixed(const fixed_vector_2d &v);
+
+    /**
+     * Create a fixed point vector from an angle and a length.
+     *
+     * @param degrees   The angle in degrees, as a fixed point value
+     * @param magnitude The length of the vector, as a fixed point value
+     * @returns         The new vector
+     */
+    fixed_vector_2d fixed_vector_from_angle(long long degrees, long long magnitude);
+
+    /**
+     * Add two fixed point vectors.
+     *
+     * @param v1    The first vector
+     * @param v2    The second vector
+     * @returns     The sum of the vectors
+     */
+    fixed_vector_2d fixed_vector_add(const fixed_vector_2d &v1, const fixed_vector_2d &v2);
+
+    /**
+     * Subtract one fixed point vector from another.
+     *
+     * @param v1    The vector to subtract from
+     * @param v2    The vector to subtract
+     * @returns     The difference between the vectors
+     */
+    fixed_vector_2d fixed_vector_subtract(const fixed_vector_2d &v1, const fixed_vector_2d &v2);
+
+    /**
+     * Multiply a fixed point vector by a fixed point value.
+     *
+     * @param v     The vector
+     * @param s     The value to multiply by
+     * @returns     The scaled vector
+     */
+    fixed_vector_2d fixed_vector_multiply(const fixed_vector_2d &v, long long s);
+
+    /**
+     * The dot product of two fixed point vectors.
+     *
+     * @param v1    The first vector
+     * @param v2    The second vector
+     * @returns     The dot product, as a fixed point value
+     */
+    long long fixed_dot_product(const fixed_vector_2d &v1, const fixed_vector_2d &v2);
+
+    /**
+     * The length of a fixed point vector.
+     *
+     * @param v     The vector
+     * @returns     The length, as a fixed point value
+     */
+    long long fixed_vector_magnitude(const fixed_vector_2d &v);
+
+    /**
+     * The squared length of a fixed point vector. This avoids the square
+     * root when comparing lengths.
+     *
+     * @param v     The vector
+     * @returns     The squared length, as a fixed point value
+     */
+    long long fixed_vector_magnitude_squared(const fixed_vector_2d &v);
+
+    /**
+     * The angle of a fixed point vector.
+     *
+     * @param v     The vector
+     * @returns     The angle in degrees, between -180 and 180, as a fixed
+     *              point value
+     */
+    long long fixed_vector_angle(const fixed_vector_2d &v);
+
+    /**
+     * A fixed point vector with the same direction, and a length of 1.
+     *
+     * @param v     The vector
+     * @returns     The unit vector, or a zero vector if `v` has no length
+     */
+    fixed_vector_2d fixed_unit_vector(const fixed_vector_2d &v);
+
+    /**
+     * Check if two fixed point vectors are exactly the same.
+     *
+     * @param v1    The first vector
+     * @param v2    The second vector
+     * @returns     True if the vectors have the same components
+     */
+    bool fixed_vectors_equal(const fixed_vector_2d &v1, const fixed_vector_2d &v2);
+
+    /**
+     * The fixed point identity matrix, which leaves vectors unchanged.
+     *
+     * @returns     An identity matrix
+     */
+    fixed_matrix_2d fixed_identity_matrix();
+
+    /**
+     * A fixed point matrix that moves vectors.
+     *
+     * @param dx    The distance to move along the x axis, as a fixed point value
+     * @param dy    The distance to move along the y axis, as a fixed point value
+     * @returns     The translation matrix
+     */
+    fixed_matrix_2d fixed_translation_matrix(long long dx, long long dy);
+
+    /**
+     * A fixed point matrix that rotates vectors around the origin.
+     *
+     * @param degrees   The angle to rotate by, as a fixed point value
+     * @returns         The rotation matrix
+     */
+    fixed_matrix_2d fixed_rotation_matrix(long long degrees);
+
+    /**
+     * A fixed point matrix that scales vectors.
+     *
+     * @param scale The amount to scale by, as a fixed point value
+     * @returns     The scaling matrix
+     */
+    fixed_matrix_2d fixed_scale_matrix(long long scale);
+
+    /**
+     * Combine two fixed point matrices, as `matrix_multiply` does.
+     *
+     * @param m1    The first matrix
+     * @param m2    The second matrix
+     * @returns     The combined matrix
+     */
+    fixed_matrix_2d fixed_matrix_multiply(const fixed_matrix_2d &m1, const fixed_matrix_2d &m2);
+
+    /**
+     * Transform a fixed point vector by a fixed point matrix.
+     *
+     * @param m     The matrix
+     * @param v     The vector to transform
+     * @returns     The transformed vector
+     *
+     * @attribute suffix  vector
+     */
+    fixed_vector_2d fixed_matrix_multiply(const fixed_matrix_2d &m, const fixed_vector_2d &v);
+
+    /**
+     * Convert a fixed point matrix to a matrix, for example to draw with it.
+     *
+     * @param m     The fixed point matrix
+     * @returns     The matrix
+     */
+    matrix_2d matrix_from_fixed(const fixed_matrix_2d &m);
+
+    /**
+     * Check if a point is in a fixed point circle.
+     *
+     * @param pt    The point
+     * @param c     The circle
+     * @returns     True if the point is in or on the circle
+     */
+    bool fixed_point_in_circle(const fixed_vector_2d &pt, const fixed_circle &c);
+
+    /**
+     * Check if a point is in a fixed point rectangle.
+     *
+     * @param pt    The point
+     * @param rect  The rectangle
+     * @returns     True if the point is in or on the edge of the rectangle
+     */
+    bool fixed_point_in_rectangle(const fixed_vector_2d &pt, const fixed_rectangle &rect);
+
+    /**
+     * Check if two fixed point circles overlap.
+     *
+     * @param c1    The first circle
+     * @param c2    The second circle
+     * @returns     True if the circles touch or overlap
+     */
+    bool fixed_circles_intersect(const fixed_circle &c1, const fixed_circle &c2);
+
+    /**
+     * Check if two fixed point rectangles overlap.
+     *
+     * @param rect1 The first rectangle
+     * @param rect2 The second rectangle
+     * @returns     True if the rectangles overlap
+     */
+    bool fixed_rectangles_intersect(const fixed_rectangle &rect1, const fixed_rectangle &rect2);
+
+    /**
+     * Check if a fixed point circle and rectangle overlap.
+     *
+     * @param c     The circle
+     * @param rect  The rectangle
+     * @returns     True if the circle touches or overlaps the rectangle
+     */
+    bool fixed_circle_rectangle_intersect(const fixed_circle &c, const fixed_rectangle &rect);
+}
+
+#endif /* fixed_point_h */
@@ -0,0 +1,157 @@
+//
+//  frame_memory.cpp
+//  splashkit
+//
+//  Each thread bumps through its own block. The blocks are reset lazily: a
+//  refresh only moves on the frame number, and each thread starts its block
+//  again the next time it allocates in a new frame. When a frame outgrows
+//  the block, more blocks are added, and at the next reset they are joined
+//  into one block large enough for the whole frame. A scope records the
+//  position in the blocks, and moves back to it when it ends. Resets wait
+//  until the thread has no scopes open.
+//
+
+#include "frame_memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// The size of each thread's first block
+#define FRAME_MEMORY_START_SIZE (64 * 1024)
+// Everything handed out is aligned to this
+#define FRAME_MEMORY_ALIGN alignof(std::max_align_t)
+
+namespace splashkit_lib
+{
+    static std::atomic<unsigned long long> _frame_number{0};
+
+    struct _frame_block
+    {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    struct _frame_arena
+    {
+        std::vector<_frame_block> blocks;   // the last block is the one in use
+        size_t used = 0;                    // bytes used in the last block
+        size_t total = 0;                   // bytes used this frame, in all blocks
+        unsigned long long frame = 0;
+        int scopes = 0;                     // frame_memory_scopes open on the thread
+    };
+
+    static _frame_arena &_thread_arena()
+    {
+        thread_local _frame_arena arena;
+        return arena;
+    }
+
+    static void _add_frame_block(_frame_arena &arena, size_t size)
+    {
+        arena.blocks.push_back({ std::unique_ptr<char[]>(new char[size]), size });
+        arena.used = 0;
+    }
+
+    static void _reset_frame_arena(_frame_arena &arena)
+    {
+        // the frame overflowed, so replace the blocks with one that fits it all
+        if ( arena.blocks.size() > 1 )
+        {
+            size_t size = 0;
+            for (const _frame_block &block : arena.blocks) size += block.size;
+
+            arena.blocks.clear();
+            _add_frame_block(arena, size);
+        }
+
+        arena.used = 0;
+        arena.total = 0;
+    }
+
+    // The thread's arena, started again if a window has been refreshed and
+    // no scope is holding on to its memory
+    static _frame_arena &_current_arena()
+    {
+        _frame_arena &arena = _thread_arena();
+
+        unsigned long long frame = _frame_number.load(std::memory_order_relaxed);
+        if ( arena.frame != frame && arena.scopes == 0 )
+        {
+            _reset_frame_arena(arena);
+            arena.frame = frame;
+        }
+
+        return arena;
+    }
+
+    void *frame_memory(size_t bytes)
+    {
+        _frame_arena &arena = _current_arena();
+
+        if ( bytes == 0 ) bytes = 1;
+        size_t needed = (bytes + FRAME_MEMORY_ALIGN - 1) & ~(FRAME_MEMORY_ALIGN - 1);
+
+        if ( arena.blocks.empty() || arena.used + needed > arena.blocks.back().size )
+        {
+            size_t last = arena.blocks.empty() ? FRAME_MEMORY_START_SIZE / 2 : arena.blocks.back().size;
+            _add_frame_block(arena, std::max(last * 2, needed));
+        }
+
+        void *result = arena.blocks.back().data.get() + arena.used;
+        arena.used += needed;
+        arena.total += needed;
+        return result;
+    }
+
+    size_t frame_memory_used()
+    {
+        _frame_arena &arena = _thread_arena();
+        return arena.frame == _frame_number.load(std::memory_order_relaxed) || arena.scopes > 0 ? arena.total : 0;
+    }
+
+    size_t frame_memory_capacity()
+    {
+        size_t result = 0;
+        for (const _frame_block &block : _thread_arena().blocks) result += block.size;
+        return result;
+    }
+
+    frame_memory_scope::frame_memory_scope()
+    {
+        _frame_arena &arena = _current_arena();
+        _blocks = arena.blocks.size();
+        _used = arena.used;
+        _total = arena.total;
+        arena.scopes++;
+    }
+
+    frame_memory_scope::~frame_memory_scope()
+    {
+        _frame_arena &arena = _thread_arena();
+        arena.scopes--;
+
+        if ( arena.blocks.size() > _blocks )
+        {
+            // nothing came before the scope, so grow to fit what it needed,
+            // otherwise drop the blocks added after the mark
+            if ( _total == 0 )
+            {
+                _reset_frame_arena(arena);
+                return;
+            }
+
+            arena.blocks.resize(_blocks);
+        }
+
+        arena.used = _used;
+        arena.total = _total;
+    }
+
+    // Called each time a window is refreshed
+    void _next_frame_memory()
+    {
+        _frame_number.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,105 @@
+/**
+ * @header  frame_memory
+ * @brief   Frame memory holds short lived data that is only needed until the window is next refreshed.
+ *
+ * Work done each frame often needs temporary space, such as a list of the
+ * objects near the player. Frame memory hands out this space by moving a
+ * pointer through a large block, and the whole block is reused each time
+ * a window is refreshed, so there is no cost to free it. Each thread has
+ * its own block, so threads can use frame memory without locking.
+ *
+ * Memory from this block must not be used after the next refresh. Code
+ * that runs without refreshing a window, or that may refresh one while it
+ * still uses its frame memory, should take its memory inside a
+ * `frame_memory_scope`.
+ *
+ * @attribute group  utilities
+ * @attribute static frame_memory
+ */
+
+#ifndef frame_memory_h
+#define frame_memory_h
+
+#include <cstddef>
+#include <vector>
+
+namespace splashkit_lib
+{
+    /**
+     * Get space from the calling thread's frame memory. The space lasts
+     * until a window is next refreshed, and does not need to be freed.
+     *
+     * @param bytes     The number of bytes needed
+     * @return          The start of the space, aligned for any type
+     */
+    void *frame_memory(size_t bytes);
+
+    /**
+     * The number of bytes of frame memory the calling thread has used this
+     * frame.
+     *
+     * @return The bytes used
+     */
+    size_t frame_memory_used();
+
+    /**
+     * The number of bytes of frame memory the calling thread has reserved.
+     * Frame memory grows to fit the largest frame, and is then reused.
+     *
+     * @return The bytes reserved
+     */
+    size_t frame_memory_capacity();
+
+    // Marks the calling thread's frame memory, and gives back everything
+    // taken after the mark when the scope ends. A loop that never refreshes
+    // a window can use a scope for each pass, so its frame memory does not
+    // grow. While a scope is open a refresh does not reuse the thread's
+    // frame memory, which starts again once the outermost scope ends.
+    class frame_memory_scope
+    {
+    public:
+        frame_memory_scope();
+        ~frame_memory_scope();
+
+        frame_memory_scope(const frame_memory_scope &) = delete;
+        frame_memory_scope &operator=(const frame_memory_scope &) = delete;
+
+    private:
+        size_t _blocks;     // blocks in use at the mark
+        size_t _used;       // bytes used in the last of them
+        size_t _total;      // bytes used this frame
+    };
+
+    // An allocator for standard containers that takes its memory from the
+    // frame memory of the thread that grows the container. Deallocation does
+    // nothing, so containers using it must not outlive the frame.
+    template <typename T>
+    struct frame_allocator
+    {
+        typedef T value_type;
+
+        frame_allocator() noexcept = default;
+
+        template <typename U>
+        frame_allocator(const frame_allocator<U> &) noexcept { }
+
+        T *allocate(size_t n)
+        {
+            return static_cast<T *>(frame_memory(n * sizeof(T)));
+        }
+
+        void deallocate(T *, size_t) noexcept { }
+
+        template <typename U>
+        bool operator==(const frame_allocator<U> &) const noexcept { return true; }
+
+        template <typename U>
+        bool operator!=(const frame_allocator<U> &) const noexcept { return false; }
+    };
+
+    // A vector for per frame work, stored in frame memory
+    template <typename T>
+    using frame_vector = std::vector<T, frame_allocator<T>>;
+}
+
+#endif /* frame_memory_h */
@@ -12,13 +12,80 @@
 #include <cmath>
 namespace splashkit_lib
 {
+    static bool _fast_trig = false;
+
+    //
+    // Reduce the angle to within 45 degrees of a multiple of 90, then use
+    // the Taylor series to x^7 for sine and x^8 for cosine. Over +/- pi/4
+    // these are within 3.2e-7 and 2.5e-8 of the exact values, and the
+    // quadrant picks which result, and which sign, is returned.
+    //
+    static void _fast_sine_cosine(float degrees, float &s, float &c)
+    {
+        double quarter_turns = degrees / 90.0;
+        double n = std::floor(quarter_turns + 0.5);
+        double x = (quarter_turns - n) * (M_PI / 2);
+        double x2 = x * x;
+
+        double sx = x * (1 - x2 / 6 * (1 - x2 / 20 * (1 - x2 / 42)));
+        double cx = 1 - x2 / 2 * (1 - x2 / 12 * (1 - x2 / 30 * (1 - x2 / 56)));
+
+        switch ( static_cast<long long>(n) & 3 )
+        {
+            case 0: s = sx;  c = cx;  break;
+            case 1: s = cx;  c = -sx; break;
+            case 2: s = -sx; c = -cx; break;
+            default: s = -cx; c = sx; break;
+        }
+    }
+
+    float fast_sine(float degrees)
+    {
+        float s, c;
+        _fast_sine_cosine(degrees, s, c);
+        return s;
+    }
+
+    float fast_cosine(float degrees)
+    {
+        float s, c;
+        _fast_sine_cosine(degrees, s, c);
+        return c;
+    }
+
+    void sine_and_cosine(float degrees, float &out_sine, float &out_cosine)
+    {
+        if ( _fast_trig )
+        {
+            _fast_sine_cosine(degrees, out_sine, out_cosine);
+        }
+        else
+        {
+            double rads = deg_to_rad(degrees);
+            out_sine = sin(rads);
+            out_cosine = cos(rads);
+        }
+    }
+
+    void set_fast_trigonometry(bool value)
+    {
+        _fast_trig = value;
+    }
+
+    bool fast_trigonometry()
+    {
+        return _fast_trig;
+    }
+
     float cosine(float angle)
     {
+        if ( _fast_trig ) return fast_cosine(angle);
         return cos(deg_to_rad(angle));
     }
 
     float sine(float angle)
     {
+        if ( _fast_trig ) return fast_sine(angle);
         return sin(deg_to_rad(angle));
     }
 
@@ -44,5 +44,52 @@ namespace splashkit_lib
      */
     float tangent(float degrees);
 
+    /**
+     *  Returns the sine of the supplied angle (in degrees), using a fast
+     *  polynomial approximation rather than the standard library. The result
+     *  is within 4e-7 of the exact value, for any angle.
+     *
+     * @param  degrees The angle in degrees
+     * @return         the approximate sine of the supplied angle.
+     */
+    float fast_sine(float degrees);
+
+    /**
+     *  Returns the cosine of the supplied angle (in degrees), using a fast
+     *  polynomial approximation with the same error bound as `fast_sine`.
+     *
+     * @param  degrees The angle in degrees
+     * @return         the approximate cosine of the supplied angle.
+     */
+    float fast_cosine(float degrees);
+
+    /**
+     *  Calculates both the sine and cosine of the supplied angle (in degrees),
+     *  sharing the work between them. This uses the fast approximation when
+     *  fast trigonometry is on.
+     *
+     * @param  degrees      The angle in degrees
+     * @param  out_sine     After the call, the sine of the angle
+     * @param  out_cosine   After the call, the cosine of the angle
+     */
+    void sine_and_cosine(float degrees, float &out_sine, float &out_cosine);
+
+    /**
+     *  Turns the fast trigonometry approximations on or off for `sine`,
+     *  `cosine`, `sine_and_cosine` and the functions built on them, such as
+     *  `rotation_matrix`, `vector_from_angle` and sprite movement. It is
+     *  off by default.
+     *
+     * @param  value   True to use the fast approximations.
+     */
+    void set_fast_trigonometry(bool value);
+
+    /**
+     *  Indicates if the fast trigonometry approximations are in use.
+     *
+     * @return         True if `sine` and `cosine` use the fast approximations.
+     */
+    bool fast_trigonometry();
+
 }
 #endif /* geometry_hpp */
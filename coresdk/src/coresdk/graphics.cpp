@@ -15,8 +15,11 @@
 
 #include "graphics_driver.h"
 #include "core_driver.h"
+#include "resource_tracking.h"
+#include "utils_driver.h"
 
 #include <map>
+#include <thread>
 
 using std::map;
 using std::to_string;
@@ -26,7 +29,12 @@ namespace splashkit_lib
     extern map<string, window> _windows;
     extern window _current_window;
 
-    static unsigned int _last_update_time = 0;
+    // When the last frame was due, in nanoseconds from current_ticks_ns
+    static long long _last_frame_time = 0;
+
+    // Sleeping can overshoot by a millisecond or more, so the last part of
+    // each wait spins on the clock instead
+    #define FRAME_SPIN_MARGIN_NS 2000000
 
     void refresh_screen()
     {
@@ -39,22 +47,52 @@ namespace splashkit_lib
     void delay_for_target_fps(unsigned int target_fps)
     {
         if ( target_fps == 0 ) return;
-        unsigned int now = current_ticks();
-        unsigned int delta = now - _last_update_time;
-        unsigned int delay_time;
-        
-        //dont sleep if 5ms remaining...
-        while ((target_fps > 0) and ((delta + 8) * target_fps < 1000))
+
+        long long period = 1000000000LL / target_fps;
+        long long deadline = _last_frame_time + period;
+        long long now = current_ticks_ns();
+
+        // more than a frame behind, so start the schedule again from now
+        if ( now > deadline + period )
         {
-            delay_time = (1000 / target_fps) - delta;
-            delay(delay_time);
-            now = current_ticks();
-            delta = now - _last_update_time;
+            _last_frame_time = now;
+            return;
         }
-        
-        _last_update_time = now;
+
+        // presenting will wait for the display, so only wait here for
+        // larger gaps that mean the target is below the refresh rate
+        if ( sk_vsync() and deadline - now < period / 4 )
+        {
+            _last_frame_time = now > deadline ? now : deadline;
+            return;
+        }
+
+        for (long long remaining = deadline - now; remaining > 0; remaining = deadline - current_ticks_ns())
+        {
+            if ( remaining > FRAME_SPIN_MARGIN_NS )
+                sk_delay(static_cast<unsigned int>((remaining - FRAME_SPIN_MARGIN_NS) / 1000000));
+            else
+                std::this_thread::yield();
+        }
+
+        // each deadline follows the last, so frames keep a fixed step even
+        // when a single wait ends a little late
+        _last_frame_time = deadline;
     }
-    
+
+    void set_vsync(bool value)
+    {
+        if ( ! sk_set_vsync(value) )
+        {
+            LOG(WARNING) << "Unable to change vsync on all windows";
+        }
+    }
+
+    bool vsync_enabled()
+    {
+        return sk_vsync();
+    }
+
     void refresh_screen(unsigned int target_fps)
     {
         refresh_screen();
@@ -71,6 +109,36 @@ namespace splashkit_lib
         clear_window(_current_window, COLOR_WHITE);
     }
 
+    void set_batched_rendering(bool value)
+    {
+        sk_set_batched_rendering(value);
+    }
+
+    bool batched_rendering()
+    {
+        return sk_batched_rendering();
+    }
+
+    void set_headless_rendering(bool value)
+    {
+        sk_set_headless(value);
+    }
+
+    bool headless_rendering()
+    {
+        return sk_headless();
+    }
+
+    void set_single_bitmap_renderer(bool value)
+    {
+        sk_set_single_bitmap_renderer(value);
+    }
+
+    bool single_bitmap_renderer()
+    {
+        return sk_single_bitmap_renderer();
+    }
+
     int screen_width()
     {
         return window_width(current_window());
@@ -81,7 +149,32 @@ namespace splashkit_lib
         return window_height(current_window());
     }
 
-    void _save_surface(image_data &image, string basename)
+    static image_save_format _image_save_format = PNG_IMAGE_FORMAT;
+    static int _png_compression_level = -1;
+
+    void set_image_save_format(image_save_format format)
+    {
+        _image_save_format = format;
+    }
+
+    void set_png_compression_level(int level)
+    {
+        if ( level < -1 || level > 9 )
+        {
+            LOG(WARNING) << "PNG compression level must be between 0 and 9, or -1 for the default";
+            return;
+        }
+
+        _png_compression_level = level;
+    }
+
+    static sk_image_encoding _image_encoding()
+    {
+        return _image_save_format == QOI_IMAGE_FORMAT ? SK_ENCODE_QOI : SK_ENCODE_PNG;
+    }
+
+    // A new file on the user's desktop, not taken by a save still being written
+    static string _save_path(const string &basename)
     {
         string path = path_from( {path_to_user_home(), "Desktop"} );
 
@@ -90,19 +183,34 @@ namespace splashkit_lib
             path = path_to_user_home();
         }
 
-        string filename = basename + ".png";
+        string ext = _image_save_format == QOI_IMAGE_FORMAT ? ".qoi" : ".png";
+        string filename = basename + ext;
 
         int i = 1;
 
-        while (file_exists( path_from({path}, filename)))
+        while (file_exists( path_from({path}, filename)) || sk_image_save_pending(path_from({path}, filename).c_str()))
         {
-            filename = basename + to_string(i) + ".png";
+            filename = basename + to_string(i) + ext;
             i = i + 1;
         }
 
-        path = path_from( { path }, filename);
+        return path_from( { path }, filename);
+    }
+
+    void _save_surface(image_data &image, string basename)
+    {
+        string path = _save_path(basename);
+
+        if ( ! sk_save_image(&image.surface, path.c_str(), _image_encoding(), _png_compression_level) )
+        {
+            LOG(WARNING) << "Unable to save image to " << path;
+        }
+    }
 
-        sk_save_png(&image.surface, path.c_str());
+    int _save_surface_async(image_data &image, const string &basename)
+    {
+        string path = _save_path(basename);
+        return sk_save_image_async(&image.surface, path.c_str(), _image_encoding(), _png_compression_level);
     }
 
     void take_screenshot(const string &basename)
@@ -129,9 +237,53 @@ namespace splashkit_lib
             return;
         }
 
+        _resource_used(bmp);
         _save_surface(bmp->image, basename);
     }
 
+    int take_screenshot_async(const string &basename)
+    {
+        return take_screenshot_async(current_window(), basename);
+    }
+
+    int take_screenshot_async(window wind, const string &basename)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR))
+        {
+            LOG(WARNING) << "Attempting to save screenshot of invalid window";
+            return 0;
+        }
+
+        return _save_surface_async(wind->image, basename);
+    }
+
+    int save_bitmap_async(bitmap bmp, const string &basename)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
+        {
+            LOG(WARNING) << "Attempting to save image of invalid bitmap";
+            return 0;
+        }
+
+        _resource_used(bmp);
+        return _save_surface_async(bmp->image, basename);
+    }
+
+    bool image_save_complete(int save_id)
+    {
+        return sk_image_save_status(save_id) != 0;
+    }
+
+    bool image_save_succeeded(int save_id)
+    {
+        return sk_image_save_status(save_id) == 1;
+    }
+
+    void wait_for_image_saves()
+    {
+        sk_wait_for_image_saves();
+    }
+
     int number_of_displays()
     {
         sk_system_data *data = sk_read_system_data();
@@ -39,8 +39,10 @@ namespace splashkit_lib
 
     /**
      * Refreshes all open windows with a target FPS (frames per second). This will
-     * delay a period of time that will approximately meet the targeted frames per
-     * second.
+     * delay a period of time that will meet the targeted frames per second.
+     * Each frame is scheduled a fixed step after the last, sleeping for most
+     * of the wait and spinning for the final moments so frames stay evenly
+     * spaced at high refresh rates.
      *
      * @param target_fps The targeted frames per second to refresh the screen at.
      *
@@ -68,6 +70,82 @@ namespace splashkit_lib
      */
     void clear_screen();
 
+    /**
+     * Turn batched rendering on or off. When batching is on, filled rectangles,
+     * triangles, pixels and bitmaps are recorded rather than drawn straight
+     * away. Consecutive drawing onto the same window or bitmap is then sent
+     * to the graphics card together, when the screen is refreshed or another
+     * kind of drawing is performed. This greatly reduces the cost of drawing
+     * large numbers of small shapes each frame.
+     *
+     * @param value True to batch drawing, false to draw each shape as it is
+     *              requested.
+     */
+    void set_batched_rendering(bool value);
+
+    /**
+     * Turn vsync on or off. With vsync on, refreshing a window waits for the
+     * display to finish showing its current frame, which stops tearing. The
+     * target fps of `refresh_screen` then only adds waits when it is below
+     * the display's refresh rate.
+     *
+     * @param value True to sync with the display.
+     */
+    void set_vsync(bool value);
+
+    /**
+     * Indicates if vsync has been turned on.
+     *
+     * @return True if vsync has been turned on with `set_vsync`.
+     */
+    bool vsync_enabled();
+
+    /**
+     * Indicates if drawing is currently being batched.
+     *
+     * @return True if batched rendering has been turned on.
+     */
+    bool batched_rendering();
+
+    /**
+     * Turn headless rendering on or off. A headless program draws onto
+     * bitmaps using a software renderer, without needing a display or
+     * window system, so it can create images on a server. Each process
+     * renders on its own, so several can run at once. This must be called
+     * before any other SplashKit function. Headless rendering can also be
+     * turned on by setting the `SPLASHKIT_HEADLESS` environment variable
+     * to 1.
+     *
+     * @param value True to render without a window system.
+     */
+    void set_headless_rendering(bool value);
+
+    /**
+     * Indicates if SplashKit is rendering without a window system.
+     *
+     * @return True if headless rendering has been turned on.
+     */
+    bool headless_rendering();
+
+    /**
+     * Turn single renderer bitmaps on or off. Normally each open window keeps
+     * its own copy of a bitmap, and drawing onto the bitmap draws onto each
+     * copy. With this on, drawing onto a bitmap is done once, and the other
+     * windows copy the result when they next draw the bitmap. This makes
+     * drawing onto bitmaps faster when several windows are open, but drawing
+     * the changed bitmap onto another window is slower.
+     *
+     * @param value True to draw bitmaps using a single window's renderer.
+     */
+    void set_single_bitmap_renderer(bool value);
+
+    /**
+     * Indicates if bitmaps are drawn using a single window's renderer.
+     *
+     * @return True if single renderer bitmaps have been turned on.
+     */
+    bool single_bitmap_renderer();
+
     /**
      * Returns the width of the current window.
      *
@@ -82,6 +160,37 @@ namespace splashkit_lib
      */
     int screen_height();
 
+    /**
+     * The file formats used to save bitmaps and screenshots.
+     *
+     * @constant PNG_IMAGE_FORMAT  PNG files, which any image program can open.
+     * @constant QOI_IMAGE_FORMAT  "Quite OK Image" files, which save many times
+     *                             faster than PNG but are larger.
+     */
+    enum image_save_format
+    {
+        PNG_IMAGE_FORMAT,
+        QOI_IMAGE_FORMAT
+    };
+
+    /**
+     * Sets the file format used by `save_bitmap` and `take_screenshot`. The
+     * file extension follows the format. PNG is used by default.
+     *
+     * @param format The format for saved images
+     */
+    void set_image_save_format(image_save_format format);
+
+    /**
+     * Sets how hard PNG files are compressed when bitmaps and screenshots are
+     * saved. Lower levels save faster but make larger files, and 0 stores the
+     * pixels without compression.
+     *
+     * @param level The zlib compression level, from 0 to 9, or -1 for the
+     *              default level
+     */
+    void set_png_compression_level(int level);
+
     /**
      *  Saves a screenshot of the current window to a bitmap file. The file will
      *  be saved onto the user's desktop.
@@ -115,6 +224,72 @@ namespace splashkit_lib
      */
     void save_bitmap(bitmap bmp, const string &basename);
 
+    /**
+     * Starts saving a screenshot of the current window to the user's desktop.
+     * The pixels are read straight away, so you can keep drawing, and the file
+     * is written in the background. Use `image_save_complete` to check when
+     * it is done.
+     *
+     * @param basename The base of the filename. If there is a file of this name
+     *                 already, then the name will be changed to generate a
+     *                 unique filename.
+     * @returns        An id to check the progress of the save, or 0 if the
+     *                 save could not start
+     */
+    int take_screenshot_async(const string &basename);
+
+    /**
+     * Starts saving a screenshot of the window to the user's desktop. The
+     * pixels are read straight away, so you can keep drawing, and the file is
+     * written in the background.
+     *
+     * @param wind     The window to capture in the screenshot
+     * @param basename The base of the filename. If there is a file of this name
+     *                 already, then the name will be changed to generate a
+     *                 unique filename.
+     * @returns        An id to check the progress of the save, or 0 if the
+     *                 save could not start
+     *
+     * @attribute suffix  of_window
+     */
+    int take_screenshot_async(window wind, const string &basename);
+
+    /**
+     * Starts saving the bitmap to the user's desktop. The pixels are read
+     * straight away, so you can keep drawing onto the bitmap, and the file is
+     * written in the background.
+     *
+     * @param bmp      The bitmap to save
+     * @param basename The base of the filename. If there is a file of this name
+     *                 already, then the name will be changed to generate a
+     *                 unique filename.
+     * @returns        An id to check the progress of the save, or 0 if the
+     *                 save could not start
+     */
+    int save_bitmap_async(bitmap bmp, const string &basename);
+
+    /**
+     * Checks if a background save has finished.
+     *
+     * @param save_id  The id returned when the save started
+     * @returns        True once the save has finished, whether or not the
+     *                 file was written
+     */
+    bool image_save_complete(int save_id);
+
+    /**
+     * Checks if a background save wrote its file.
+     *
+     * @param save_id  The id returned when the save started
+     * @returns        True if the save has finished and the file was written
+     */
+    bool image_save_succeeded(int save_id);
+
+    /**
+     * Waits until all background saves have finished.
+     */
+    void wait_for_image_saves();
+
     /**
      * Returns the number of physical displays attached to the computer.
      *
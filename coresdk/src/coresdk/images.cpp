@@ -12,51 +12,520 @@
 #include "backend_types.h"
 #include "utility_functions.h"
 #include "resources.h"
+#include "resource_registry.h"
+#include "resource_tracking.h"
 
 #include <map>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <cmath>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 
 using std::map;
 using std::to_string;
 
+// The most corners kept in the convex hull around each cell
+#define BITMAP_HULL_MAX_POINTS 12
+
 namespace splashkit_lib
 {
-    static map<string, bitmap> _bitmaps;
+    static resource_registry<bitmap> _bitmaps;
 
-    void setup_collision_mask(bitmap bmp)
+    bitmap _register_loaded_bitmap(const string &name, const string &file_path, sk_drawing_surface surface, bool reloadable);
+    void _ensure_collision_mask(bitmap bmp);
+
+    // Images decoded ahead of time for evicted bitmaps, by asset streaming,
+    // used in place of decoding when the bitmaps are loaded again
+    static std::map<bitmap, SDL_Surface *> _prepared_images;
+
+    static SDL_Surface *_take_prepared_image(bitmap bmp)
+    {
+        auto it = _prepared_images.find(bmp);
+        if ( it == _prepared_images.end() ) return nullptr;
+
+        SDL_Surface *result = it->second;
+        _prepared_images.erase(it);
+        return result;
+    }
+
+    // Report a bitmap to the resource budget. Bitmaps loaded from a file can
+    // have their image evicted, and decoded again when next used, keeping
+    // the bitmap itself along with its cell details and collision mask.
+    static void _track_bitmap(bitmap bmp, bool reloadable)
+    {
+        resource_evict_fn evict;
+
+        if ( reloadable )
+        {
+            evict = [bmp]() -> resource_reload_fn
+            {
+                if ( ! sk_bitmap_matches_source(&bmp->image.surface) || sk_bitmap_in_atlas(&bmp->image.surface) ) return nullptr;
+
+                bool mips = sk_bitmap_mip_count(&bmp->image.surface) > 0;
+                int w = bmp->image.surface.width, h = bmp->image.surface.height;
+
+                sk_close_drawing_surface(&bmp->image.surface);
+                bmp->image.surface.width = w;
+                bmp->image.surface.height = h;
+
+                return [bmp, mips]()
+                {
+                    SDL_Surface *decoded = _take_prepared_image(bmp);
+                    if ( ! decoded ) decoded = sk_decode_bitmap(bmp->filename.c_str());
+                    if ( ! decoded )
+                    {
+                        LOG(WARNING) << "Unable to load evicted bitmap " << bmp->name << " again from " << bmp->filename;
+                        return;
+                    }
+
+                    // A hot reload may have already put an image back
+                    sk_close_drawing_surface(&bmp->image.surface);
+                    bmp->image.surface = sk_bitmap_from_decoded(decoded);
+                    if ( mips ) sk_generate_bitmap_mips(&bmp->image.surface);
+                };
+            };
+        }
+
+        _track_resource(bmp, IMAGE_RESOURCE, bmp->name, [bmp](size_t &cpu, size_t &gpu)
+        {
+            sk_bitmap_memory(&bmp->image.surface, &cpu, &gpu);
+            cpu += static_cast<size_t>(bmp->mask_words) * bmp->image.surface.height * sizeof(uint64_t);
+        }, evict);
+    }
+
+    //
+    // Find the bounds of the opaque pixels within each cell of the bitmap,
+    // allowing collisions to skip the transparent parts of the cells
+    //
+    void _setup_cell_opaque_bounds(bitmap bmp)
+    {
+        bmp->cell_opaque_bounds.clear();
+        bmp->cell_hulls.clear();
+
+        // Pending masks set up their bounds when they are built
+        if ( bmp->pixel_mask == nullptr or bmp->mask_pending ) return;
+
+        for (int cell = 0; cell < bmp->cell_count; cell++)
+        {
+            vector_2d offset = bitmap_cell_offset(bmp, cell);
+            int ox = static_cast<int>(offset.x), oy = static_cast<int>(offset.y);
+            int min_x = bmp->cell_w, min_y = bmp->cell_h, max_x = -1, max_y = -1;
+
+            for (int y = 0; y < bmp->cell_h and oy + y < bmp->image.surface.height; y++)
+            {
+                const uint64_t *row = bmp->pixel_mask + (oy + y) * bmp->mask_words;
+
+                for (int x = 0; x < bmp->cell_w and ox + x < bmp->image.surface.width; x++)
+                {
+                    int px = ox + x;
+                    if ( (row[px / 64] >> (px % 64)) & 1 )
+                    {
+                        min_x = std::min(min_x, x);
+                        max_x = std::max(max_x, x);
+                        min_y = std::min(min_y, y);
+                        max_y = std::max(max_y, y);
+                    }
+                }
+            }
+
+            if ( max_x < 0 )
+                bmp->cell_opaque_bounds.push_back(rectangle_from(0, 0, 0, 0));
+            else
+                bmp->cell_opaque_bounds.push_back(rectangle_from(min_x, min_y, max_x - min_x + 1, max_y - min_y + 1));
+        }
+    }
+
+    static double _cross(const point_2d &o, const point_2d &a, const point_2d &b)
+    {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    }
+
+    //
+    // Reduce a convex hull to BITMAP_HULL_MAX_POINTS by removing its shortest
+    // edges: each removed edge is replaced by extending the edges on either
+    // side until they meet. The hull only ever grows, so it still contains
+    // every opaque pixel.
+    //
+    void _simplify_hull(vector<point_2d> &hull)
+    {
+        while ( hull.size() > BITMAP_HULL_MAX_POINTS )
+        {
+            size_t n = hull.size();
+            size_t best = n;
+            double best_area = 0;
+            point_2d best_pt;
+
+            for (size_t i = 0; i < n; i++)
+            {
+                const point_2d &p0 = hull[(i + n - 1) % n], &p1 = hull[i], &p2 = hull[(i + 1) % n], &p3 = hull[(i + 2) % n];
+
+                // Where the edges before and after p1 -> p2 meet
+                double dx1 = p1.x - p0.x, dy1 = p1.y - p0.y;
+                double dx2 = p3.x - p2.x, dy2 = p3.y - p2.y;
+                double denom = dx1 * dy2 - dy1 * dx2;
+                if ( std::abs(denom) < 1e-9 ) continue;
+
+                double t = ((p2.x - p1.x) * dy2 - (p2.y - p1.y) * dx2) / denom;
+                if ( t <= 0 ) continue;  // the edges meet behind p1
+
+                point_2d pt = point_at(p1.x + dx1 * t, p1.y + dy1 * t);
+                double area = std::abs(_cross(p1, pt, p2)) / 2;
+
+                if ( best == n or area < best_area )
+                {
+                    best = i;
+                    best_area = area;
+                    best_pt = pt;
+                }
+            }
+
+            if ( best == n ) return;
+
+            hull[best] = best_pt;
+            hull.erase(hull.begin() + (best + 1) % n);
+        }
+    }
+
+    //
+    // The convex hull around the opaque pixels of a cell, using the corners
+    // of the first and last opaque pixel on each row
+    //
+    static vector<point_2d> _build_cell_hull(bitmap bmp, int cell, const rectangle &bounds)
+    {
+        vector<point_2d> pts;
+
+        vector_2d offset = bitmap_cell_offset(bmp, cell);
+        int ox = static_cast<int>(offset.x), oy = static_cast<int>(offset.y);
+        int left = static_cast<int>(bounds.x), right = static_cast<int>(bounds.x + bounds.width);
+        int top = static_cast<int>(bounds.y), bottom = static_cast<int>(bounds.y + bounds.height);
+
+        for (int y = top; y < bottom; y++)
+        {
+            const uint64_t *row = bmp->pixel_mask + (oy + y) * bmp->mask_words;
+            int first = -1, last = -1;
+
+            for (int x = left; x < right; x++)
+            {
+                int px = ox + x;
+                if ( (row[px / 64] >> (px % 64)) & 1 )
+                {
+                    if ( first < 0 ) first = x;
+                    last = x;
+                }
+            }
+
+            if ( first < 0 ) continue;
+
+            pts.push_back(point_at(first, y));
+            pts.push_back(point_at(first, y + 1));
+            pts.push_back(point_at(last + 1, y));
+            pts.push_back(point_at(last + 1, y + 1));
+        }
+
+        // Andrew's monotone chain, dropping points along straight edges
+        std::sort(pts.begin(), pts.end(), [](const point_2d &a, const point_2d &b) { return a.x < b.x or (a.x == b.x and a.y < b.y); });
+
+        vector<point_2d> hull(2 * pts.size());
+        size_t k = 0;
+
+        for (size_t i = 0; i < pts.size(); i++)
+        {
+            while ( k >= 2 and _cross(hull[k - 2], hull[k - 1], pts[i]) <= 0 ) k--;
+            hull[k++] = pts[i];
+        }
+
+        for (size_t i = pts.size() - 1, t = k + 1; i > 0; i--)
+        {
+            while ( k >= t and _cross(hull[k - 2], hull[k - 1], pts[i - 1]) <= 0 ) k--;
+            hull[k++] = pts[i - 1];
+        }
+
+        hull.resize(k > 0 ? k - 1 : 0);
+        _simplify_hull(hull);
+        return hull;
+    }
+
+    // The hull of a cell, built the first time it is needed
+    const vector<point_2d> &_cell_hull(bitmap bmp, int cell)
+    {
+        static const vector<point_2d> empty;
+
+        _ensure_collision_mask(bmp);
+
+        if ( bmp->pixel_mask == nullptr or cell < 0 or cell >= static_cast<int>(bmp->cell_opaque_bounds.size()) )
+            return empty;
+
+        if ( bmp->cell_hulls.size() != bmp->cell_opaque_bounds.size() )
+        {
+            bmp->cell_hulls.clear();
+            bmp->cell_hulls.resize(bmp->cell_opaque_bounds.size());
+            bmp->cell_hulls_built.assign(bmp->cell_opaque_bounds.size(), false);
+        }
+
+        if ( not bmp->cell_hulls_built[cell] )
+        {
+            const rectangle &bounds = bmp->cell_opaque_bounds[cell];
+            if ( bounds.width > 0 ) bmp->cell_hulls[cell] = _build_cell_hull(bmp, cell, bounds);
+            bmp->cell_hulls_built[cell] = true;
+        }
+
+        return bmp->cell_hulls[cell];
+    }
+
+    vector<point_2d> bitmap_cell_hull(bitmap bmp, int cell)
     {
         if ( INVALID_PTR(bmp, BITMAP_PTR) )
         {
-            LOG(WARNING) << "Attempt to setup collision map with invalid bitmp";
-            return;
+            LOG(WARNING) << "Trying to get the cell hull of an invalid bitmap";
+            return vector<point_2d>();
         }
-        
+
+        return _cell_hull(bmp, cell);
+    }
+
+    // Read the bitmap's pixels to build its mask and cell bounds
+    static void _build_collision_mask(bitmap bmp)
+    {
         int *pixels;
         int sz;
         int r, c;
+        int w = bmp->image.surface.width;
 
-        sz = bmp->image.surface.width * bmp->image.surface.height;
+        _resource_used(bmp);
+
+        sz = w * bmp->image.surface.height;
         pixels = (int *) malloc(sizeof(int) * sz);
 
         sk_to_pixels(&bmp->image.surface, pixels, sz);
 
-        if ( bmp->pixel_mask == nullptr )
-            bmp->pixel_mask = (bool *) malloc( sizeof(bool) * sz );
+        // Rows are packed into 64 bit words so collisions can test 64 pixels at once
+        if ( bmp->pixel_mask != nullptr )
+            free(bmp->pixel_mask);
+
+        bmp->mask_words = (w + 63) / 64;
+        bmp->pixel_mask = (uint64_t *) calloc( bmp->mask_words * bmp->image.surface.height, sizeof(uint64_t) );
 
-        // WriteLn(bmp^.name);
         for (r = 0; r < bmp->image.surface.height; r++)
         {
-            for(c = 0; c < bmp->image.surface.width; c++)
+            uint64_t *row = bmp->pixel_mask + r * bmp->mask_words;
+
+            for(c = 0; c < w; c++)
             {
-                bmp->pixel_mask[c + r * bmp->image.surface.width] = ((pixels[c + r * bmp->image.surface.width] & 0x000000FF) > 0x0000007F );
-                // if b^.nonTransparentPixels[c, r] then Write(1) else Write(0);
+                if ( (pixels[c + r * w] & 0x000000FF) > 0x0000007F )
+                    row[c / 64] |= uint64_t(1) << (c % 64);
             }
-            // WriteLn();
         }
-        // WriteLn();
 
         free(pixels);
+
+        _setup_cell_opaque_bounds(bmp);
+    }
+
+    //
+    // Collision mask cache
+    //
+    // Each cached mask is stored in its own file, named from a hash of the
+    // image's path, the bitmap's name and its cell layout, as images packed
+    // into one archive share a path. A mask is used only while the image
+    // file has the same modification time and contents as when the mask was
+    // saved. The cell bounds are kept alongside it.
+    //
+
+    static string _mask_cache_path;
+
+    // FNV-1a, to name cache files and to check the image has not changed
+    static uint64_t _fnv1a(const char *data, size_t len, uint64_t hash = 14695981039346656037ULL)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    struct _mask_cache_header
+    {
+        char magic[8];
+        uint64_t content_hash;
+        int64_t modified;
+        int32_t width, height, mask_words;
+        int32_t cell_w, cell_h, cell_cols, cell_rows, cell_count;
+        int32_t key_length;
+    };
+
+    static const char MASK_CACHE_MAGIC[8] = { 'S', 'K', 'M', 'A', 'S', 'K', '0', '2' };
+
+    // Identifies the bitmap's mask among all those cached
+    static string _mask_cache_key(bitmap bmp)
+    {
+        return bmp->filename + "\n" + bmp->name + "\n" +
+            std::to_string(bmp->cell_w) + "," + std::to_string(bmp->cell_h) + "," +
+            std::to_string(bmp->cell_cols) + "," + std::to_string(bmp->cell_rows) + "," +
+            std::to_string(bmp->cell_count);
+    }
+
+    static string _mask_cache_file(const string &key)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.skmask", static_cast<unsigned long long>(_fnv1a(key.data(), key.size())));
+        return (std::filesystem::path(_mask_cache_path) / name).string();
+    }
+
+    // The modification time and content hash of the image file
+    static bool _image_signature(const string &filename, uint64_t &hash, int64_t &modified)
+    {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(filename, ec);
+        if ( ec ) return false;
+        modified = static_cast<int64_t>(time.time_since_epoch().count());
+
+        std::ifstream in(filename, std::ios::binary);
+        if ( not in ) return false;
+
+        hash = 14695981039346656037ULL;
+        char buffer[65536];
+        while ( in.read(buffer, sizeof(buffer)) or in.gcount() > 0 )
+            hash = _fnv1a(buffer, static_cast<size_t>(in.gcount()), hash);
+
+        return true;
+    }
+
+    static bool _load_cached_mask(bitmap bmp, uint64_t hash, int64_t modified)
+    {
+        string key = _mask_cache_key(bmp);
+        std::ifstream in(_mask_cache_file(key), std::ios::binary);
+        if ( not in ) return false;
+
+        _mask_cache_header header;
+        if ( not in.read(reinterpret_cast<char *>(&header), sizeof(header)) ) return false;
+
+        if ( memcmp(header.magic, MASK_CACHE_MAGIC, sizeof(MASK_CACHE_MAGIC)) != 0 or
+             header.content_hash != hash or header.modified != modified or
+             header.width != bmp->image.surface.width or header.height != bmp->image.surface.height or
+             header.mask_words != (header.width + 63) / 64 or
+             header.key_length != static_cast<int32_t>(key.size()) )
+            return false;
+
+        string saved_key(header.key_length, '\0');
+        if ( not in.read(&saved_key[0], header.key_length) or saved_key != key ) return false;
+
+        size_t words = static_cast<size_t>(header.mask_words) * header.height;
+        uint64_t *mask = (uint64_t *) malloc(words * sizeof(uint64_t));
+        if ( not in.read(reinterpret_cast<char *>(mask), words * sizeof(uint64_t)) )
+        {
+            free(mask);
+            return false;
+        }
+
+        if ( bmp->pixel_mask != nullptr )
+            free(bmp->pixel_mask);
+
+        bmp->pixel_mask = mask;
+        bmp->mask_words = header.mask_words;
+
+        bool same_cells = header.cell_w == bmp->cell_w and header.cell_h == bmp->cell_h and
+                          header.cell_cols == bmp->cell_cols and header.cell_rows == bmp->cell_rows and
+                          header.cell_count == bmp->cell_count;
+
+        vector<int32_t> bounds(static_cast<size_t>(std::max(0, header.cell_count)) * 4);
+        if ( same_cells and in.read(reinterpret_cast<char *>(bounds.data()), bounds.size() * sizeof(int32_t)) )
+        {
+            bmp->cell_opaque_bounds.clear();
+            bmp->cell_hulls.clear();
+            for (size_t i = 0; i < bounds.size(); i += 4)
+                bmp->cell_opaque_bounds.push_back(rectangle_from(bounds[i], bounds[i + 1], bounds[i + 2], bounds[i + 3]));
+        }
+        else
+            _setup_cell_opaque_bounds(bmp);
+
+        return true;
+    }
+
+    static void _save_cached_mask(bitmap bmp, uint64_t hash, int64_t modified)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(_mask_cache_path, ec);
+
+        string key = _mask_cache_key(bmp);
+        string filename = _mask_cache_file(key);
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        if ( not out )
+        {
+            LOG(WARNING) << "Unable to write collision mask cache file " << filename;
+            return;
+        }
+
+        _mask_cache_header header;
+        memcpy(header.magic, MASK_CACHE_MAGIC, sizeof(MASK_CACHE_MAGIC));
+        header.content_hash = hash;
+        header.modified = modified;
+        header.width = bmp->image.surface.width;
+        header.height = bmp->image.surface.height;
+        header.mask_words = bmp->mask_words;
+        header.cell_w = bmp->cell_w;
+        header.cell_h = bmp->cell_h;
+        header.cell_cols = bmp->cell_cols;
+        header.cell_rows = bmp->cell_rows;
+        header.cell_count = static_cast<int32_t>(bmp->cell_opaque_bounds.size());
+        header.key_length = static_cast<int32_t>(key.size());
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(key.data(), key.size());
+        out.write(reinterpret_cast<const char *>(bmp->pixel_mask), static_cast<size_t>(bmp->mask_words) * header.height * sizeof(uint64_t));
+
+        for (const rectangle &r : bmp->cell_opaque_bounds)
+        {
+            int32_t bounds[4] = { static_cast<int32_t>(r.x), static_cast<int32_t>(r.y), static_cast<int32_t>(r.width), static_cast<int32_t>(r.height) };
+            out.write(reinterpret_cast<const char *>(bounds), sizeof(bounds));
+        }
+    }
+
+    void set_collision_mask_cache_path(const string &path)
+    {
+        _mask_cache_path = path;
+    }
+
+    string collision_mask_cache_path()
+    {
+        return _mask_cache_path;
+    }
+
+    //
+    // Loaded bitmaps build their masks the first time a collision needs
+    // them, using the cache when the image is unchanged since it was loaded
+    //
+    void _ensure_collision_mask(bitmap bmp)
+    {
+        if ( not bmp->mask_pending ) return;
+        bmp->mask_pending = false;
+
+        uint64_t hash = 0;
+        int64_t modified = 0;
+        bool cacheable = not _mask_cache_path.empty() and not bmp->filename.empty() and
+                         sk_bitmap_matches_source(&bmp->image.surface) and
+                         _image_signature(bmp->filename, hash, modified);
+
+        if ( cacheable and _load_cached_mask(bmp, hash, modified) ) return;
+
+        _build_collision_mask(bmp);
+
+        if ( cacheable ) _save_cached_mask(bmp, hash, modified);
+    }
+
+    void setup_collision_mask(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Attempt to setup collision map with invalid bitmp";
+            return;
+        }
+
+        bmp->mask_pending = false;
+        _build_collision_mask(bmp);
     }
     
     bool bitmap_valid(bitmap bmp)
@@ -66,13 +535,18 @@ namespace splashkit_lib
 
     bool has_bitmap(string name)
     {
-        return _bitmaps.count(name) > 0;
+        return _bitmaps.contains(name);
     }
 
     bitmap bitmap_named(string name)
     {
-        if (has_bitmap(name))
-            return _bitmaps[name];
+        bitmap result = _bitmaps.find(name);
+
+        if (result)
+        {
+            _resource_used(result);
+            return result;
+        }
         else
         {
             string filename = path_to_resource(name, IMAGE_RESOURCE);
@@ -89,7 +563,6 @@ namespace splashkit_lib
         if (has_bitmap(name)) return bitmap_named(name);
 
         sk_drawing_surface surface;
-        bitmap result = nullptr;
 
         string file_path = filename;
 
@@ -111,7 +584,15 @@ namespace splashkit_lib
             return nullptr;
         }
 
-        result = new _bitmap_data;
+        return _register_loaded_bitmap(name, file_path, surface, true);
+    }
+
+    // Wrap a loaded surface as a bitmap and register it. Used by load_bitmap
+    // and by bundles, which decode images on worker threads. Bitmaps that
+    // cannot be loaded again from file_path are not reloadable.
+    bitmap _register_loaded_bitmap(const string &name, const string &file_path, sk_drawing_surface surface, bool reloadable)
+    {
+        bitmap result = new _bitmap_data;
         result->image.surface = surface;
 
         result->id         = BITMAP_PTR;
@@ -121,15 +602,54 @@ namespace splashkit_lib
         result->cell_rows  = 1;
         result->cell_count = 1;
         result->pixel_mask = nullptr;
+        result->mask_words = 0;
+        result->mask_pending = true;
 
         result->name       = name;
         result->filename   = file_path;
 
-        setup_collision_mask(result);
+        // Another thread may have loaded the same name in the meantime
+        bitmap registered = _bitmaps.insert(name, result);
+        if ( registered != result )
+        {
+            sk_close_drawing_surface(&result->image.surface);
+            if ( result->pixel_mask != nullptr )
+                free(result->pixel_mask);
+            delete(result);
+        }
+        else
+            _track_bitmap(result, reloadable);
 
-        _bitmaps[name] = result;
+        return registered;
+    }
 
-        return result;
+    // Load an evicted bitmap again from an image decoded on another thread,
+    // keeping the bitmap's handle. Takes ownership of the decoded surface.
+    void _restore_evicted_bitmap(bitmap bmp, SDL_Surface *decoded)
+    {
+        _prepared_images[bmp] = decoded;
+        _resource_used(bmp);
+
+        // Left over if the bitmap was not evicted after all
+        sk_free_decoded_bitmap(_take_prepared_image(bmp));
+    }
+
+    // Give a new or reused bitmap the details of a freshly created bitmap
+    static void _reset_created_bitmap(bitmap bmp, int width, int height)
+    {
+        bmp->cell_w     = width;
+        bmp->cell_h     = height;
+        bmp->cell_cols  = 1;
+        bmp->cell_rows  = 1;
+        bmp->cell_count = 1;
+        bmp->pixel_mask = nullptr;
+        bmp->mask_words = 0;
+        bmp->mask_pending = false;
+        bmp->cell_opaque_bounds.clear();
+        bmp->cell_hulls.clear();
+        bmp->cell_hulls_built.clear();
+
+        bmp->filename   = "";
     }
 
     bitmap create_bitmap(string name, int width, int height)
@@ -139,33 +659,136 @@ namespace splashkit_lib
         result->id = BITMAP_PTR;
         result->image.surface = sk_create_bitmap(width, height);
 
-        result->cell_w     = width;
-        result->cell_h     = height;
-        result->cell_cols  = 1;
-        result->cell_rows  = 1;
-        result->cell_count = 1;
-        result->pixel_mask = nullptr;
-
-        result->filename   = "";
+        _reset_created_bitmap(result, width, height);
 
+        // Claim the first free name, checking and inserting together so
+        // bitmaps created on other threads cannot take the same name
         int idx = 0;
-        string key = name;
-        while (has_bitmap(key))
+        result->name = name;
+        while (_bitmaps.insert(result->name, result) != result)
         {
-            key = name + to_string(idx);
+            result->name = name + to_string(idx);
             idx++;
         }
 
-        result->name       = key;
+        _track_bitmap(result, false);
+
+        return result;
+    }
+
+    //
+    // Render targets are bitmaps kept for reuse by offscreen passes. They are
+    // not added to the bitmap registry, and stay open between uses so that
+    // acquiring one of a size that has been used before creates no texture.
+    //
+    struct _render_target
+    {
+        bitmap bmp;
+        bool in_use;
+    };
+
+    static vector<_render_target> _render_targets;
+
+    static bool _is_render_target(bitmap bmp)
+    {
+        for (const _render_target &target : _render_targets)
+        {
+            if ( target.bmp == bmp ) return true;
+        }
+        return false;
+    }
+
+    bitmap acquire_render_target(int width, int height)
+    {
+        if ( width <= 0 || height <= 0 )
+        {
+            LOG(WARNING) << "Attempting to acquire a render target with a size of " << width << "x" << height;
+            return nullptr;
+        }
+
+        for (_render_target &target : _render_targets)
+        {
+            sk_drawing_surface &surface = target.bmp->image.surface;
+            if ( target.in_use || surface.width != width || surface.height != height ) continue;
+
+            target.in_use = true;
+
+            bitmap bmp = target.bmp;
+            if ( bmp->pixel_mask != nullptr )
+                free(bmp->pixel_mask);
+            _reset_created_bitmap(bmp, width, height);
+
+            sk_clear_clip_rect(&surface);
+            sk_set_bitmap_tint(&surface, {1.0f, 1.0f, 1.0f, 1.0f});
+            sk_clear_drawing_surface(&surface, {1.0f, 1.0f, 1.0f, 0.0f});
+            return bmp;
+        }
+
+        bitmap result = new(_bitmap_data);
 
-        _bitmaps[key] = result;
+        result->id = BITMAP_PTR;
+        result->image.surface = sk_create_bitmap(width, height);
+        result->name = "render_target";
+        _reset_created_bitmap(result, width, height);
 
+        _render_targets.push_back({ result, true });
         return result;
     }
 
+    void release_render_target(bitmap target)
+    {
+        if ( INVALID_PTR(target, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Attempting to release an invalid render target";
+            return;
+        }
+
+        for (_render_target &entry : _render_targets)
+        {
+            if ( entry.bmp != target ) continue;
+
+            if ( ! entry.in_use )
+                LOG(WARNING) << "Attempting to release a render target that is not in use";
+
+            entry.in_use = false;
+            return;
+        }
+
+        LOG(WARNING) << "Attempting to release a bitmap that is not a render target";
+    }
+
+    static void _free_render_targets(bool including_in_use)
+    {
+        for (size_t i = _render_targets.size(); i > 0; i--)
+        {
+            _render_target &entry = _render_targets[i - 1];
+            if ( entry.in_use && ! including_in_use ) continue;
+
+            bitmap bmp = entry.bmp;
+            _render_targets.erase(_render_targets.begin() + (i - 1));
+
+            notify_of_free(bmp);
+            sk_close_drawing_surface(&bmp->image.surface);
+            bmp->id = NONE_PTR;
+            if ( bmp->pixel_mask != nullptr )
+                free(bmp->pixel_mask);
+            delete(bmp);
+        }
+    }
+
+    void free_render_targets()
+    {
+        _free_render_targets(false);
+    }
+
     void free_bitmap(bitmap bmp)
     {
-        if ( VALID_PTR(bmp, BITMAP_PTR) )
+        if ( VALID_PTR(bmp, BITMAP_PTR) && _is_render_target(bmp) )
+        {
+            LOG(WARNING) << "Attempting to free a render target, use release_render_target instead";
+            release_render_target(bmp);
+        }
+        else if ( VALID_PTR(bmp, BITMAP_PTR) )
         {
             notify_of_free(bmp);
 
@@ -184,7 +807,58 @@ namespace splashkit_lib
 
     void free_all_bitmaps()
     {
-        FREE_ALL_FROM_MAP(_bitmaps, BITMAP_PTR, free_bitmap);
+        FREE_ALL_FROM_REGISTRY(_bitmaps, BITMAP_PTR, free_bitmap);
+
+        // render targets are not in the registry, so the pool is freed as well
+        _free_render_targets(true);
+    }
+
+    bool _bitmap_uses_file(const string &file_path)
+    {
+        for (auto &entry : _bitmaps.entries())
+        {
+            if ( VALID_PTR(entry.second, BITMAP_PTR) && same_file(entry.second->filename, file_path) )
+                return true;
+        }
+        return false;
+    }
+
+    // Swap a newly decoded image into every bitmap loaded from file_path, so
+    // existing handles, and the sprites using them, show the new image.
+    // Takes ownership of the decoded surface.
+    void _replace_bitmap_image(const string &file_path, SDL_Surface *decoded)
+    {
+        bool used = false;
+
+        for (auto &entry : _bitmaps.entries())
+        {
+            bitmap bmp = entry.second;
+            if ( INVALID_PTR(bmp, BITMAP_PTR) || ! same_file(bmp->filename, file_path) ) continue;
+
+            // Bitmaps sharing a file each need their own copy
+            SDL_Surface *surface = used ? sk_decode_bitmap(file_path.c_str()) : decoded;
+            used = true;
+            if ( ! surface ) continue;
+
+            int old_w = bmp->image.surface.width, old_h = bmp->image.surface.height;
+
+            sk_drawing_surface replacement = sk_bitmap_from_decoded(surface);
+            sk_close_drawing_surface(&bmp->image.surface);
+            bmp->image.surface = replacement;
+
+            // A single cell follows the new size, cell layouts are kept
+            if ( bmp->cell_count == 1 && bmp->cell_w == old_w && bmp->cell_h == old_h )
+            {
+                bmp->cell_w = replacement.width;
+                bmp->cell_h = replacement.height;
+            }
+
+            // The mask is rebuilt from the new pixels when it is next needed
+            bmp->mask_pending = true;
+            _setup_cell_opaque_bounds(bmp);
+        }
+
+        if ( ! used ) sk_free_decoded_bitmap(decoded);
     }
 
     string bitmap_filename(bitmap bmp)
@@ -209,6 +883,7 @@ namespace splashkit_lib
             return;
         }
 
+        _resource_used(bmp);
         sk_clear_drawing_surface(&bmp->image.surface, clr);
     }
 
@@ -217,65 +892,168 @@ namespace splashkit_lib
         clear_bitmap(bitmap_named(name), clr);
     }
 
+    void set_bitmap_pixels(bitmap bmp, const vector<uint32_t> &pixels, const rectangle &area)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
+        {
+            LOG(WARNING) << "Attempting to set pixels of invalid bitmap";
+            return;
+        }
 
-    void draw_bitmap(bitmap bmp, double x, double y)
+        int w = static_cast<int>(area.width);
+        int h = static_cast<int>(area.height);
+
+        if ( w <= 0 || h <= 0 ) return;
+
+        if ( pixels.size() < static_cast<size_t>(w) * static_cast<size_t>(h) )
+        {
+            LOG(WARNING) << "Not enough pixels supplied to set_bitmap_pixels, expected " << w * h << " but got " << pixels.size();
+            return;
+        }
+
+        _resource_used(bmp);
+        sk_set_bitmap_pixels(&bmp->image.surface, pixels.data(), static_cast<int>(area.x), static_cast<int>(area.y), w, h);
+    }
+
+    void set_bitmap_pixels(bitmap bmp, const vector<uint32_t> &pixels)
     {
-        draw_bitmap(bmp, x, y, option_defaults());
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
+        {
+            LOG(WARNING) << "Attempting to set pixels of invalid bitmap";
+            return;
+        }
+
+        set_bitmap_pixels(bmp, pixels, rectangle_from(0, 0, bmp->image.surface.width, bmp->image.surface.height));
     }
 
-    void draw_bitmap(bitmap bmp, double x, double y, drawing_options opts)
+    vector<uint32_t> get_bitmap_pixels(bitmap bmp, const rectangle &area)
     {
+        vector<uint32_t> result;
+
         if ( INVALID_PTR(bmp, BITMAP_PTR))
         {
-            LOG(WARNING) << "Error trying to draw bitmap: passed in bmp is an invalid bitmap pointer.";
+            LOG(WARNING) << "Attempting to get pixels of invalid bitmap";
+            return result;
+        }
+
+        int x = static_cast<int>(area.x), y = static_cast<int>(area.y);
+        int w = static_cast<int>(area.width), h = static_cast<int>(area.height);
+
+        if ( w <= 0 || h <= 0 ) return result;
+
+        if ( x < 0 || y < 0 || x + w > bmp->image.surface.width || y + h > bmp->image.surface.height )
+        {
+            LOG(WARNING) << "Attempting to get pixels outside of bitmap " << bmp->name;
+            return result;
+        }
+
+        _resource_used(bmp);
+        result.resize(static_cast<size_t>(w) * static_cast<size_t>(h));
+        sk_to_pixels(&bmp->image.surface, x, y, w, h, reinterpret_cast<int *>(result.data()), w * h);
+        return result;
+    }
+
+    vector<uint32_t> get_bitmap_pixels(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
+        {
+            LOG(WARNING) << "Attempting to get pixels of invalid bitmap";
+            return vector<uint32_t>();
+        }
+
+        return get_bitmap_pixels(bmp, rectangle_from(0, 0, bmp->image.surface.width, bmp->image.surface.height));
+    }
+
+    void bitmap_snapshot(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
+        {
+            LOG(WARNING) << "Attempting to snapshot invalid bitmap";
             return;
         }
 
-        double src_data[4];
-        double dst_data[7];
-        sk_renderer_flip flip;
-        sk_drawing_surface * dest;
-        
-        
+        _resource_used(bmp);
+        sk_snapshot_bitmap(&bmp->image.surface);
+    }
+
+    bool bitmap_has_snapshot(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR)) return false;
+
+        return sk_bitmap_has_snapshot(&bmp->image.surface);
+    }
 
-        if ( VALID_PTR(opts.anim, ANIMATION_PTR) || opts.draw_cell >= 0 )
+    void bitmap_generate_mipmaps(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
         {
-            int cell;
-            if ( opts.draw_cell >= 0 )
-                cell = opts.draw_cell;
-            else
-                cell = animation_current_cell(opts.anim);
-            
-            rectangle part = bitmap_rectangle_of_cell(bmp, cell);
-            src_data[0] = part.x;
-            src_data[1] = part.y;
-            src_data[2] = part.width;
-            src_data[3] = part.height;
+            LOG(WARNING) << "Attempting to generate mipmaps for invalid bitmap";
+            return;
         }
-        else if (opts.is_part)
+
+        _resource_used(bmp);
+        if ( ! sk_generate_bitmap_mips(&bmp->image.surface) )
+            LOG(DEBUG) << "Bitmap " << bmp->name << " is too small for mipmaps";
+    }
+
+    void bitmap_free_mipmaps(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
         {
-            src_data[0] = opts.part.x;
-            src_data[1] = opts.part.y;
-            src_data[2] = opts.part.width;
-            src_data[3] = opts.part.height;
+            LOG(WARNING) << "Attempting to free mipmaps of invalid bitmap";
+            return;
         }
-        else
+
+        sk_free_bitmap_mips(&bmp->image.surface);
+    }
+
+    bool bitmap_has_mipmaps(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR)) return false;
+
+        return sk_bitmap_mip_count(&bmp->image.surface) > 0;
+    }
+
+    void bitmap_set_software_rendering(bitmap bmp, bool value)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
         {
-            src_data[0] = 0;
-            src_data[1] = 0;
-            src_data[2] = bmp->image.surface.width;
-            src_data[3] = bmp->image.surface.height;
+            LOG(WARNING) << "Attempting to set software rendering of invalid bitmap";
+            return;
         }
 
-        //
-        if ((opts.flip_x) and (opts.flip_y))
-            flip = sk_FLIP_BOTH;
-        else if (opts.flip_x)
-            flip = sk_FLIP_VERTICAL;
-        else if (opts.flip_y)
-            flip = sk_FLIP_HORIZONTAL;
-        else
-            flip = sk_FLIP_NONE;
+        _resource_used(bmp);
+        sk_set_bitmap_software_rendering(&bmp->image.surface, value);
+    }
+
+    bool bitmap_software_rendering(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR)) return false;
+
+        return sk_bitmap_software_rendering(&bmp->image.surface);
+    }
+
+    void draw_bitmap(bitmap bmp, double x, double y)
+    {
+        draw_bitmap(bmp, x, y, option_defaults());
+    }
+
+    void draw_bitmap(bitmap bmp, double x, double y, const drawing_options &opts)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
+        {
+            LOG(WARNING) << "Error trying to draw bitmap: passed in bmp is an invalid bitmap pointer.";
+            return;
+        }
+
+        _resource_used(bmp);
+
+        double src_data[4];
+        double dst_data[7];
+        sk_renderer_flip flip;
+        sk_drawing_surface * dest;
+
+        bitmap_source_and_flip(bmp, opts, src_data, flip);
 
         // make up dst data
         dst_data[0] = x; // X
@@ -292,12 +1070,106 @@ namespace splashkit_lib
         sk_draw_bitmap(&bmp->image.surface, dest, src_data, 4, dst_data, 7, flip);
     }
 
+    void draw_bitmaps(bitmap bmp, const vector<point_2d> &positions, const drawing_options &opts)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
+        {
+            LOG(WARNING) << "Error trying to draw bitmaps: passed in bmp is an invalid bitmap pointer.";
+            return;
+        }
+
+        if ( positions.empty() ) return;
+
+        _resource_used(bmp);
+
+        double src_data[4];
+        double dst_data[7];
+        sk_renderer_flip flip;
+        sk_drawing_surface * dest = to_surface_ptr(opts.dest);
+
+        bitmap_source_and_flip(bmp, opts, src_data, flip);
+
+        for (const point_2d &pt : positions)
+        {
+            dst_data[0] = pt.x;
+            dst_data[1] = pt.y;
+            dst_data[2] = opts.angle;
+            dst_data[3] = opts.anchor_offset_x;
+            dst_data[4] = opts.anchor_offset_y;
+            dst_data[5] = opts.scale_x;
+            dst_data[6] = opts.scale_y;
+
+            xy_from_opts(opts, dst_data[0], dst_data[1]);
+            sk_draw_bitmap(&bmp->image.surface, dest, src_data, 4, dst_data, 7, flip);
+        }
+    }
+
+    void draw_bitmaps(bitmap bmp, const vector<point_2d> &positions)
+    {
+        draw_bitmaps(bmp, positions, option_defaults());
+    }
+
+    void draw_bitmap_instances(bitmap bmp, const vector<bitmap_instance> &instances, const drawing_options &opts)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR))
+        {
+            LOG(WARNING) << "Error trying to draw bitmap instances: passed in bmp is an invalid bitmap pointer.";
+            return;
+        }
+
+        if ( instances.empty() ) return;
+
+        _resource_used(bmp);
+
+        // reused between calls, so drawing each frame does not allocate
+        static vector<sk_bitmap_quad> quads;
+        quads.resize(instances.size());
+
+        for (size_t i = 0; i < instances.size(); i++)
+        {
+            const bitmap_instance &inst = instances[i];
+            sk_bitmap_quad &quad = quads[i];
+
+            if ( inst.cell >= 0 )
+            {
+                rectangle part = bitmap_rectangle_of_cell(bmp, inst.cell);
+                quad.src_x = part.x;
+                quad.src_y = part.y;
+                quad.src_w = part.width;
+                quad.src_h = part.height;
+            }
+            else
+            {
+                quad.src_x = 0;
+                quad.src_y = 0;
+                quad.src_w = bmp->image.surface.width;
+                quad.src_h = bmp->image.surface.height;
+            }
+
+            quad.x = inst.position.x;
+            quad.y = inst.position.y;
+            xy_from_opts(opts, quad.x, quad.y);
+
+            quad.angle = inst.angle;
+            quad.scale_x = inst.scale_x;
+            quad.scale_y = inst.scale_y;
+            quad.tint = inst.tint;
+        }
+
+        sk_draw_bitmap_quads(&bmp->image.surface, to_surface_ptr(opts.dest), quads.data(), static_cast<int>(quads.size()));
+    }
+
+    void draw_bitmap_instances(bitmap bmp, const vector<bitmap_instance> &instances)
+    {
+        draw_bitmap_instances(bmp, instances, option_defaults());
+    }
+
     void draw_bitmap_on_window(window destination, bitmap bmp, double x, double y)
     {
         draw_bitmap(bmp, x, y, option_draw_to(destination));
     }
 
-    void draw_bitmap_on_window(window destination, bitmap bmp, double x, double y, drawing_options opts)
+    void draw_bitmap_on_window(window destination, bitmap bmp, double x, double y, const drawing_options &opts)
     {
         draw_bitmap(bmp, x, y, option_draw_to(destination, opts));
     }
@@ -307,7 +1179,7 @@ namespace splashkit_lib
         draw_bitmap(bmp, x, y, option_draw_to(destination));
     }
 
-    void draw_bitmap_on_bitmap(bitmap destination, bitmap bmp, double x, double y, drawing_options opts)
+    void draw_bitmap_on_bitmap(bitmap destination, bitmap bmp, double x, double y, const drawing_options &opts)
     {
         draw_bitmap(bmp, x, y, option_draw_to(destination, opts));
     }
@@ -317,7 +1189,7 @@ namespace splashkit_lib
         draw_bitmap(bitmap_named(name), x, y, option_defaults());
     }
 
-    void draw_bitmap(string name, double x, double y, drawing_options opts)
+    void draw_bitmap(string name, double x, double y, const drawing_options &opts)
     {
         draw_bitmap(bitmap_named(name), x, y, opts);
     }
@@ -444,6 +1316,98 @@ namespace splashkit_lib
         bmp->cell_cols  = columns;
         bmp->cell_rows  = rows;
         bmp->cell_count = count;
+
+        _setup_cell_opaque_bounds(bmp);
+    }
+
+    void bitmap_set_window_affinity(bitmap bmp, window wnd)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to set window affinity of invalid bitmap.";
+            return;
+        }
+
+        if ( INVALID_PTR(wnd, WINDOW_PTR) )
+        {
+            LOG(WARNING) << "Trying to set window affinity of bitmap to invalid window.";
+            return;
+        }
+
+        _resource_used(bmp);
+        sk_set_bitmap_window_affinity(&bmp->image.surface, &wnd->image.surface);
+    }
+
+    void bitmap_clear_window_affinity(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to clear window affinity of invalid bitmap.";
+            return;
+        }
+
+        sk_set_bitmap_window_affinity(&bmp->image.surface, nullptr);
+    }
+
+    void bitmap_release_pixel_data(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to release pixel data of invalid bitmap.";
+            return;
+        }
+
+        _resource_used(bmp);
+        // Build the collision mask while the pixels are still at hand
+        _ensure_collision_mask(bmp);
+        sk_release_bitmap_surface(&bmp->image.surface);
+    }
+
+    bool save_bitmap_baked(bitmap bmp, const string &filename, bool compress)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Attempting to save baked texture of invalid bitmap";
+            return false;
+        }
+
+        _resource_used(bmp);
+        if ( ! sk_save_baked_texture(&bmp->image.surface, filename.c_str(), compress) )
+        {
+            LOG(WARNING) << "Unable to save baked texture " << filename;
+            return false;
+        }
+
+        return true;
+    }
+
+    int bitmap_pack_into_atlas(const vector<bitmap> &bitmaps)
+    {
+        vector<sk_drawing_surface *> surfaces;
+
+        for (bitmap bmp : bitmaps)
+        {
+            if ( INVALID_PTR(bmp, BITMAP_PTR) )
+            {
+                LOG(WARNING) << "Skipping invalid bitmap when packing an atlas.";
+                continue;
+            }
+
+            _resource_used(bmp);
+            surfaces.push_back(&bmp->image.surface);
+        }
+
+        return sk_pack_bitmaps_into_atlas(surfaces.data(), static_cast<int>(surfaces.size()));
+    }
+
+    bool bitmap_in_atlas(bitmap bmp)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR) )
+        {
+            return false;
+        }
+
+        return sk_bitmap_in_atlas(&bmp->image.surface);
     }
 
     int bitmap_width(bitmap bmp)
@@ -526,9 +1490,12 @@ namespace splashkit_lib
         int px = ceil(x);
         int py = ceil(y);
 
-        if ( INVALID_PTR(bmp, BITMAP_PTR) or px < 0 or px >= bitmap_width(bmp) or py < 0 or py >= bitmap_height(bmp) or bmp->pixel_mask == nullptr ) return false;
+        if ( INVALID_PTR(bmp, BITMAP_PTR) or px < 0 or px >= bitmap_width(bmp) or py < 0 or py >= bitmap_height(bmp) ) return false;
+
+        _ensure_collision_mask(bmp);
+        if ( bmp->pixel_mask == nullptr ) return false;
 
-        return bmp->pixel_mask[px + py * bmp->image.surface.width];
+        return (bmp->pixel_mask[py * bmp->mask_words + px / 64] >> (px % 64)) & 1;
     }
 
     bool pixel_drawn_at_point(bitmap bmp, int cell, double x, double y)
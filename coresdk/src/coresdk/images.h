@@ -74,7 +74,8 @@ namespace splashkit_lib
     void free_bitmap(bitmap to_delete);
 
     /**
-     * Free all of the loaded bitmap resources.
+     * Free all of the loaded bitmap resources, and all render targets,
+     * including those that have not been released.
      */
     void free_all_bitmaps();
 
@@ -82,9 +83,9 @@ namespace splashkit_lib
      * Sets up the collision mask for a bitmap. This enables collision detection between
      * this bitmap and other bitmaps or shapes.
      *
-     * This is automatically called when a bitmap is loaded, and only needs to be 
-     * called on bitmaps created using `create_bitmap`, and when a bitmap is
-     * changed by drawing onto the bitmap.
+     * Loaded bitmaps set up their mask the first time a collision needs it, so this
+     * only needs to be called on bitmaps created using `create_bitmap`, and when a
+     * bitmap is changed by drawing onto the bitmap.
      *
      * @param bmp the bitmap to setup
      *
@@ -92,6 +93,42 @@ namespace splashkit_lib
      * @attribute method  setup_collision_mask
      */
     void setup_collision_mask(bitmap bmp);
+
+    /**
+     * Keep the collision masks of loaded bitmaps in files in this folder, so
+     * they do not need to be worked out from the pixels the next time the
+     * program runs. A saved mask is only used while its image file is
+     * unchanged. Pass an empty path to stop using the cache, which is the
+     * default.
+     *
+     * @param path  The folder for the cache files, which is created if needed
+     */
+    void set_collision_mask_cache_path(const string &path);
+
+    /**
+     * The folder where collision masks are cached.
+     *
+     * @returns The folder set with `set_collision_mask_cache_path`, or an
+     *          empty string if masks are not cached
+     */
+    string collision_mask_cache_path();
+
+    /**
+     * Get the convex polygon around the drawn pixels in a cell of the bitmap.
+     * Sprites using `POLYGON_COLLISIONS` collide using this shape. The
+     * polygon has at most 12 points, and is grown where needed to keep it
+     * convex, so it contains all of the drawn pixels.
+     *
+     * @param bmp   The bitmap
+     * @param cell  The cell of the bitmap
+     * @returns     The points of the polygon, relative to the top left of the
+     *              cell, or no points if the cell has no drawn pixels or the
+     *              bitmap has no collision mask
+     *
+     * @attribute class   bitmap
+     * @attribute method  cell_hull
+     */
+    vector<point_2d> bitmap_cell_hull(bitmap bmp, int cell);
     
     /**
      * Draws the bitmap supplied into `bmp` to the current window.
@@ -126,7 +163,88 @@ namespace splashkit_lib
      * @attribute self    bmp
      * @attribute suffix  with_options
      */
-    void draw_bitmap(bitmap bmp, double x, double y, drawing_options opts);
+    void draw_bitmap(bitmap bmp, double x, double y, const drawing_options &opts);
+
+    /**
+     * Draws the bitmap at each of the positions, using the same drawing
+     * options for every copy. This is faster than drawing the bitmap at each
+     * position in turn, particularly when called from other languages.
+     *
+     * @param bmp       The bitmap to draw
+     * @param positions The locations to draw the bitmap at
+     * @param opts      The `drawing_options` used for every copy
+     *
+     * @attribute class   bitmap
+     * @attribute method  draw_at_points
+     * @attribute self    bmp
+     * @attribute suffix  with_options
+     */
+    void draw_bitmaps(bitmap bmp, const vector<point_2d> &positions, const drawing_options &opts);
+
+    /**
+     * Draws the bitmap at each of the positions.
+     *
+     * @param bmp       The bitmap to draw
+     * @param positions The locations to draw the bitmap at
+     *
+     * @attribute class   bitmap
+     * @attribute method  draw_at_points
+     * @attribute self    bmp
+     */
+    void draw_bitmaps(bitmap bmp, const vector<point_2d> &positions);
+
+    /**
+     * One copy of a bitmap, or one of its cells, drawn with
+     * `draw_bitmap_instances`. Each copy is scaled and rotated around its
+     * centre, so the position is its top left when the scale is 1.
+     *
+     * @field cell      The cell to draw, or -1 to draw the whole bitmap
+     * @field position  The location of the top left of the copy
+     * @field angle     The angle to rotate the copy by, in degrees
+     * @field scale_x   The amount to scale the copy horizontally
+     * @field scale_y   The amount to scale the copy vertically
+     * @field tint      The color to tint the copy, use white to draw it unchanged
+     */
+    struct bitmap_instance
+    {
+        int cell;
+        point_2d position;
+        double angle;
+        double scale_x;
+        double scale_y;
+        color tint;
+    };
+
+    /**
+     * Draws many copies of a bitmap, or of its cells, in a single draw. Each
+     * instance has its own cell, position, rotation, scale and tint. This is
+     * much faster than calling `draw_bitmap` for each copy, so it suits
+     * tilemaps and particles.
+     *
+     * @param bmp       The bitmap to draw
+     * @param instances The copies of the bitmap to draw
+     * @param opts      The `drawing_options` giving the destination and
+     *                  camera to use; their other options are ignored
+     *
+     * @attribute class   bitmap
+     * @attribute method  draw_instances
+     * @attribute self    bmp
+     * @attribute suffix  with_options
+     */
+    void draw_bitmap_instances(bitmap bmp, const vector<bitmap_instance> &instances, const drawing_options &opts);
+
+    /**
+     * Draws many copies of a bitmap, or of its cells, onto the current window
+     * in a single draw.
+     *
+     * @param bmp       The bitmap to draw
+     * @param instances The copies of the bitmap to draw
+     *
+     * @attribute class   bitmap
+     * @attribute method  draw_instances
+     * @attribute self    bmp
+     */
+    void draw_bitmap_instances(bitmap bmp, const vector<bitmap_instance> &instances);
 
     /**
      * Draws the bitmap supplied into `bmp` to the given window.
@@ -163,7 +281,7 @@ namespace splashkit_lib
      * @attribute self    destination
      * @attribute suffix  with_options
      */
-    void draw_bitmap_on_window(window destination, bitmap bmp, double x, double y, drawing_options opts);
+    void draw_bitmap_on_window(window destination, bitmap bmp, double x, double y, const drawing_options &opts);
 
     /**
      * Draws the bitmap supplied into `bmp` to the given bitmap.
@@ -201,7 +319,7 @@ namespace splashkit_lib
      * @attribute self    bmp
      * @attribute suffix  on_bitmap_with_options
      */
-    void draw_bitmap_on_bitmap(bitmap destination, bitmap bmp, double x, double y, drawing_options opts);
+    void draw_bitmap_on_bitmap(bitmap destination, bitmap bmp, double x, double y, const drawing_options &opts);
 
     /**
      * Searches and draws a bitmap with name `name` to the current window.
@@ -231,7 +349,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  named_with_options
      */
-    void draw_bitmap(string name, double x, double y, drawing_options opts);
+    void draw_bitmap(string name, double x, double y, const drawing_options &opts);
 
     /**
      * Creates a new bitmap that you can draw to. Initially the bitmap will
@@ -249,6 +367,33 @@ namespace splashkit_lib
      */
     bitmap create_bitmap(string name, int width, int height);
 
+    /**
+     * Gets a transparent bitmap to draw an offscreen pass onto, such as a
+     * minimap or a post processing step. Render targets are kept for reuse
+     * rather than freed, so acquiring one each frame does not create a new
+     * texture once a target of that size has been released. Render targets
+     * are not named, and cannot be found with `bitmap_named`.
+     *
+     * @param width   The width of the render target
+     * @param height  The height of the render target
+     * @returns       A transparent bitmap of the requested size
+     */
+    bitmap acquire_render_target(int width, int height);
+
+    /**
+     * Returns a render target from `acquire_render_target` so that it can be
+     * reused. Do not draw with the bitmap after releasing it.
+     *
+     * @param target The render target to release
+     */
+    void release_render_target(bitmap target);
+
+    /**
+     * Frees the render targets that are not in use, releasing the memory
+     * they hold.
+     */
+    void free_render_targets();
+
     /**
      * Returns the filename from which the bitmap was loaded. This will be an empty
      * string for created bitmaps.
@@ -296,6 +441,162 @@ namespace splashkit_lib
      */
     void clear_bitmap(string name, color clr);
 
+    /**
+     * Replaces the pixels within an area of the bitmap. The pixels are
+     * supplied row by row for the area, with each pixel packed as a 32bit
+     * RGBA value (0xRRGGBBAA). Only the changed area is uploaded to the
+     * graphics card, making this suitable for bitmaps that are regenerated
+     * every frame.
+     *
+     * @param bmp     The bitmap to update
+     * @param pixels  The new pixels, must contain area width * area height values
+     * @param area    The area of the bitmap to replace
+     *
+     * @attribute class bitmap
+     * @attribute method set_pixels
+     */
+    void set_bitmap_pixels(bitmap bmp, const vector<uint32_t> &pixels, const rectangle &area);
+
+    /**
+     * Replaces all of the bitmap's pixels. The pixels are supplied row by
+     * row, with each pixel packed as a 32bit RGBA value (0xRRGGBBAA), as
+     * returned by `get_bitmap_pixels`.
+     *
+     * @param bmp     The bitmap to update
+     * @param pixels  The new pixels, must contain width * height values
+     *
+     * @attribute class bitmap
+     * @attribute method set_all_pixels
+     */
+    void set_bitmap_pixels(bitmap bmp, const vector<uint32_t> &pixels);
+
+    /**
+     * Reads the pixels within an area of the bitmap. The pixels are returned
+     * row by row for the area, with each pixel packed as a 32bit RGBA value
+     * (0xRRGGBBAA), matching `set_bitmap_pixels`. Only the area is read, so
+     * this is much faster than reading the whole bitmap to look at part of
+     * it.
+     *
+     * @param bmp     The bitmap to read
+     * @param area    The area of the bitmap to read, which must be within the
+     *                bitmap
+     * @returns       The area width * area height pixels, or no pixels if the
+     *                area is outside the bitmap
+     *
+     * @attribute class bitmap
+     * @attribute method get_pixels
+     */
+    vector<uint32_t> get_bitmap_pixels(bitmap bmp, const rectangle &area);
+
+    /**
+     * Reads all of the bitmap's pixels into a copy you can change and pass
+     * back to `set_bitmap_pixels`. The pixels are returned row by row, with
+     * each pixel packed as a 32bit RGBA value (0xRRGGBBAA).
+     *
+     * @param bmp     The bitmap to read
+     * @returns       The width * height pixels of the bitmap
+     *
+     * @attribute class bitmap
+     * @attribute method get_all_pixels
+     */
+    vector<uint32_t> get_bitmap_pixels(bitmap bmp);
+
+    /**
+     * Reads all of the bitmap's pixels once into memory, so that `get_pixel`
+     * and `get_bitmap_pixels` read from this copy rather than waiting on
+     * the graphics card each time. The copy is kept until the bitmap is next
+     * drawn on or changed. Reading two pixels from a bitmap that has not
+     * changed takes a snapshot automatically, so call this to avoid waiting
+     * on even the first reads, such as before a flood fill.
+     *
+     * @param bmp The bitmap to read
+     *
+     * @attribute class bitmap
+     * @attribute method snapshot
+     */
+    void bitmap_snapshot(bitmap bmp);
+
+    /**
+     * Checks if pixels read from the bitmap come from a snapshot in memory,
+     * taken by `bitmap_snapshot` or by reading pixels, and not yet discarded
+     * by drawing on the bitmap.
+     *
+     * @param bmp The bitmap to check
+     * @returns   True if the bitmap has an up to date snapshot
+     *
+     * @attribute class bitmap
+     * @attribute getter has_snapshot
+     */
+    bool bitmap_has_snapshot(bitmap bmp);
+
+    /**
+     * Creates smaller copies of the bitmap, each half the size of the last.
+     * When the bitmap is drawn at half its size or less, such as in a
+     * minimap or a zoomed out view, it is drawn from the closest copy. This
+     * reads far fewer pixels, and avoids the shimmer of sampling only some
+     * of the bitmap's pixels. Call this once after loading the bitmap. If the
+     * bitmap is drawn on later, the copies are made again the next time it is
+     * drawn shrunk, so avoid this for bitmaps that change every frame.
+     *
+     * @param bmp The bitmap to make smaller copies of
+     *
+     * @attribute class bitmap
+     * @attribute method generate_mipmaps
+     */
+    void bitmap_generate_mipmaps(bitmap bmp);
+
+    /**
+     * Frees the smaller copies made by `bitmap_generate_mipmaps`, so the
+     * bitmap is drawn at all sizes from its full size pixels again.
+     *
+     * @param bmp The bitmap
+     *
+     * @attribute class bitmap
+     * @attribute method free_mipmaps
+     */
+    void bitmap_free_mipmaps(bitmap bmp);
+
+    /**
+     * Checks if the bitmap has up to date smaller copies to draw from when
+     * it is shrunk, see `bitmap_generate_mipmaps`.
+     *
+     * @param bmp The bitmap to check
+     * @returns   True if the bitmap has its smaller copies
+     *
+     * @attribute class bitmap
+     * @attribute getter has_mipmaps
+     */
+    bool bitmap_has_mipmaps(bitmap bmp);
+
+    /**
+     * Draws onto the bitmap on the CPU rather than the graphics card. Clears,
+     * filled rectangles, triangles and ellipses, upright rectangle outlines,
+     * pixels, and other bitmaps drawn onto it are saved up, then drawn in
+     * parallel across the computer's cores when the bitmap is next used.
+     * This suits bitmaps drawn with many small shapes, and programs run
+     * without a graphics card. Other drawing, such as lines and text, turns
+     * this off for the bitmap.
+     *
+     * @param bmp   The bitmap
+     * @param value True to draw onto the bitmap in software
+     *
+     * @attribute class bitmap
+     * @attribute setter software_rendering
+     */
+    void bitmap_set_software_rendering(bitmap bmp, bool value);
+
+    /**
+     * Checks if the bitmap is drawn on in software, see
+     * `bitmap_set_software_rendering`.
+     *
+     * @param bmp The bitmap to check
+     * @returns   True if drawing onto the bitmap is done on the CPU
+     *
+     * @attribute class bitmap
+     * @attribute getter software_rendering
+     */
+    bool bitmap_software_rendering(bitmap bmp);
+
     /**
      * Returns the width of the bitmap.
      *
@@ -576,6 +877,86 @@ namespace splashkit_lib
      */
     int bitmap_cell_count(bitmap bmp);
 
+    /**
+     * Ties the bitmap to a single window. Bitmaps are normally copied to each
+     * window they are drawn on, a window affine bitmap keeps only a single
+     * copy for its window and is not drawn onto other windows. Use this for
+     * bitmaps that are only ever shown in one window to save video memory.
+     *
+     * @param bmp The bitmap
+     * @param wnd The only window the bitmap will be drawn to
+     *
+     * @attribute class bitmap
+     * @attribute method set_window_affinity
+     */
+    void bitmap_set_window_affinity(bitmap bmp, window wnd);
+
+    /**
+     * Allows the bitmap to be drawn to any window again, after it was tied
+     * to one window with `bitmap_set_window_affinity`.
+     *
+     * @param bmp The bitmap
+     *
+     * @attribute class bitmap
+     * @attribute method clear_window_affinity
+     */
+    void bitmap_clear_window_affinity(bitmap bmp);
+
+    /**
+     * Frees the copy of the bitmap's pixels kept in system memory, leaving
+     * only the copy on the graphics card. Use this for large bitmaps, such
+     * as backgrounds, that you draw but do not read pixels from. The bitmap
+     * still draws as before and its collision mask is kept, but reading its
+     * pixels becomes slower.
+     *
+     * @param bmp The bitmap
+     *
+     * @attribute class bitmap
+     * @attribute method release_pixel_data
+     */
+    void bitmap_release_pixel_data(bitmap bmp);
+
+    /**
+     * Saves the bitmap as a baked texture. Baked textures store pixels ready
+     * to upload to the graphics card, so they load much faster than PNG or
+     * JPEG images. Load them with `load_bitmap` like any other image.
+     *
+     * @param bmp       The bitmap to save
+     * @param filename  The file to write, which should end in ".sktex"
+     * @param compress  Compress the pixels with zlib, making the file
+     *                  smaller at a small cost when it loads
+     * @returns         True if the file was written
+     *
+     * @attribute class bitmap
+     * @attribute method save_baked
+     */
+    bool save_bitmap_baked(bitmap bmp, const string &filename, bool compress);
+
+    /**
+     * Copies small bitmaps into shared atlas textures. Bitmaps in the same
+     * atlas can be drawn one after another without switching textures, so
+     * with batched rendering they are drawn together. Packed bitmaps draw,
+     * use cells and check collisions as before. A bitmap leaves its atlas
+     * when you draw onto it or change its pixels. Bitmaps larger than 256
+     * pixels in either direction, and those that have been drawn onto, are
+     * not packed. Resource bundles pack their bitmaps when they load.
+     *
+     * @param bitmaps   The bitmaps to pack together
+     * @returns         The number of bitmaps that were packed
+     */
+    int bitmap_pack_into_atlas(const vector<bitmap> &bitmaps);
+
+    /**
+     * Checks if the bitmap is drawn from a shared atlas texture.
+     *
+     * @param bmp The bitmap
+     * @returns   True if the bitmap has been packed into an atlas
+     *
+     * @attribute class bitmap
+     * @attribute getter in_atlas
+     */
+    bool bitmap_in_atlas(bitmap bmp);
+
     /**
      * Check if the bitmap has a pixel drawn at the indicated point.
      *
@@ -8,11 +8,17 @@
 
 #include "input.h"
 
+#include "asset_streaming.h"
 #include "geometry.h"
 #include "input_driver.h"
+#include "web_driver.h"
+#include "profiling_driver.h"
 #include "keyboard_input.h"
 #include "text.h"
 #include "utility_functions.h"
+#include "random.h"
+#include "utils.h"
+#include "utils_driver.h"
 
 #include <vector>
 #include <map>
@@ -52,6 +58,18 @@ namespace splashkit_lib
     void _process_mouse_up_event(int code);
     void _process_mouse_wheel_callback(int x, int y);
 
+    // In bundles
+    void _update_resource_bundle_loads();
+
+    // In resources
+    void _update_resource_hot_reload();
+
+    // In raspi gpio
+    void _raspi_dispatch_edge_events();
+
+    // In timers
+    void _run_scheduled_calls();
+
     void process_events()
     {
         // Ensure callbacks are registered
@@ -70,13 +88,75 @@ namespace splashkit_lib
             _input_callbacks.handle_window_gain_focus = nullptr;
         }
 
+        // A new frame starts each time events are processed
+        sk_profile_next_frame();
+
         // Reset event tracking data
         _keyboard_start_process_events();
         _mouse_start_process_events();
         
         sk_process_events();
+
+        // Progress any background http requests
+        sk_http_update_requests();
+
+        // Make ready any resources decoded by background bundle loads
+        _update_resource_bundle_loads();
+
+        // Load and free streamed assets around the camera
+        update_asset_streaming();
+
+        // Swap in any resources whose files changed
+        _update_resource_hot_reload();
+
+        // Pass on any GPIO edges seen since the last frame
+        _raspi_dispatch_edge_events();
+
+        // Make any scheduled calls that are now due
+        _run_scheduled_calls();
     }
     
+    // Background web requests only progress when they are updated, so
+    // they are checked at this interval while waiting
+    #define HTTP_POLL_MS 5
+
+    bool process_events_wait(int max_ms)
+    {
+        bool woke = false;
+
+        // a replay supplies its own events each frame, so there is nothing to wait for
+        if ( ! sk_input_replaying() )
+        {
+            long long deadline = sk_get_ticks_ns() + max_ms * 1000000LL;
+
+            while ( ! woke )
+            {
+                long long remaining = (deadline - sk_get_ticks_ns() + 999999) / 1000000;
+                if ( remaining <= 0 ) break;
+
+                int wait_ms = static_cast<int>(remaining);
+
+                if ( sk_http_active_requests() == 0 )
+                {
+                    woke = wait_for_activity(wait_ms);
+                    break;
+                }
+
+                if ( wait_ms > HTTP_POLL_MS ) wait_ms = HTTP_POLL_MS;
+
+                unsigned long long seen = sk_activity_count();
+                woke = wait_for_activity(wait_ms);
+
+                // finishing a request signals activity
+                sk_http_update_requests();
+                woke = woke || sk_activity_count() != seen;
+            }
+        }
+
+        process_events();
+        return woke;
+    }
+
     bool quit_requested()
     {
         return _sk_quit;
@@ -86,4 +166,49 @@ namespace splashkit_lib
     {
         _sk_quit = false;
     }
+    bool start_input_recording(const string &filename, unsigned int seed)
+    {
+        if ( ! sk_start_input_recording(filename.c_str(), seed) )
+        {
+            LOG(WARNING) << "Unable to record input to " << filename;
+            return false;
+        }
+
+        rnd_seed(seed);
+        return true;
+    }
+
+    void stop_input_recording()
+    {
+        sk_stop_input_recording();
+    }
+
+    bool recording_input()
+    {
+        return sk_input_recording();
+    }
+
+    bool start_input_replay(const string &filename)
+    {
+        unsigned int seed;
+
+        if ( ! sk_start_input_replay(filename.c_str(), &seed) )
+        {
+            LOG(WARNING) << "Unable to replay input from " << filename << " - it is missing or is not an input recording";
+            return false;
+        }
+
+        rnd_seed(seed);
+        return true;
+    }
+
+    void stop_input_replay()
+    {
+        sk_stop_input_replay();
+    }
+
+    bool replaying_input()
+    {
+        return sk_input_replaying();
+    }
 }
@@ -30,6 +30,20 @@ namespace splashkit_lib
      */
     void process_events();
 
+    /**
+     * Waits for something to happen, then processes events as
+     * `process_events` does. The wait ends as soon as there is user input
+     * or a window event, a network connection receives data, a web server
+     * receives a request, or a background web request finishes. Use this in
+     * place of `process_events` in programs that only need to redraw when
+     * something changes, so they do not use the processor while idle. Pass
+     * the time until your next timed update as `max_ms`.
+     *
+     * @param max_ms    The longest time to wait, in milliseconds
+     * @return          True if activity ended the wait, false if the time ran out
+     */
+    bool process_events_wait(int max_ms);
+
     /**
      * Checks to see if the user has asked for the application to quit. This
      * value is updated by the `process_events` routine. Also see
@@ -44,5 +58,54 @@ namespace splashkit_lib
      */
     void reset_quit();
 
+    /**
+     * Start recording the input that `process_events` reads each frame, so
+     * the session can be played back exactly with `start_input_replay`. The
+     * random number generator is seeded with `seed`, and the seed is saved
+     * with the recording so the replay can do the same.
+     *
+     * @param filename  The path of the file to record to
+     * @param seed      The seed for `rnd`
+     * @return          True if the file could be opened for recording
+     */
+    bool start_input_recording(const string &filename, unsigned int seed);
+
+    /**
+     * Stop recording input, and close the recording file.
+     */
+    void stop_input_recording();
+
+    /**
+     * Checks if input is being recorded.
+     *
+     * @return  True if `process_events` is recording input
+     */
+    bool recording_input();
+
+    /**
+     * Play back a recording made with `start_input_recording`. Each call to
+     * `process_events` reads one frame of the recording in place of the
+     * keyboard, mouse and window events, and the mouse state reflects the
+     * recorded frame. The random number generator is seeded with the seed
+     * saved in the recording. Live input returns at the end of the recording.
+     *
+     * @param filename  The path of the recording
+     * @return          True if the recording could be read
+     */
+    bool start_input_replay(const string &filename);
+
+    /**
+     * Stop playing back a recording, and return to live input.
+     */
+    void stop_input_replay();
+
+    /**
+     * Checks if a recording is being played back.
+     *
+     * @return  True until the end of the recording is reached, or the replay
+     *          is stopped
+     */
+    bool replaying_input();
+
 }
 #endif /* input_hpp */
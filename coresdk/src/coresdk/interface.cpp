@@ -14,6 +14,7 @@
 #include "utility_functions.h"
 
 #include "interface_driver.h"
+#include "resource_tracking.h"
 
 #include <cmath>
 
@@ -229,7 +230,8 @@ namespace splashkit_lib
         inset,
         treenode,
         column,
-        popup
+        popup,
+        list
     };
 
     struct container_info
@@ -248,6 +250,9 @@ namespace splashkit_lib
     int label_width = 60;
 
     static std::vector<container_info> container_stack;
+
+    // first and visible row counts of the lists that are started
+    static std::vector<std::pair<int, int>> list_rows;
     static int filledContainerCount = 0;
     bool errors_occurred = false;
 
@@ -260,6 +265,7 @@ namespace splashkit_lib
             case panel_type::treenode: return "treenode";
             case panel_type::column:   return "column";
             case panel_type::popup:    return "popup";
+            case panel_type::list:     return "list";
         }
         return "";
     }
@@ -350,6 +356,10 @@ namespace splashkit_lib
             case panel_type::column:
                 sk_interface_end_column();
                 break;
+            case panel_type::list:
+                sk_interface_end_list();
+                list_rows.pop_back();
+                break;
         }
     }
 
@@ -579,6 +589,50 @@ namespace splashkit_lib
         _pop_container_stack(panel_type::inset, name);
     }
 
+    void start_list(const string& name, int height, int row_count, int row_height)
+    {
+        _interface_sanity_check();
+
+        if (row_height <= 0)
+        {
+            CLOG(WARNING, "interface") << "start_list(\"" << name << "\") called with a row height of " << row_height << " - rows must be at least 1 pixel high";
+            row_height = 1;
+        }
+
+        int first_row, visible_rows;
+
+        set_layout_height(height);
+        sk_interface_start_list(name, MAX(0, row_count), row_height, first_row, visible_rows);
+        list_rows.push_back({first_row, visible_rows});
+
+        _push_container_stack(true, panel_type::list, name);
+
+        container_stack.back().layout_height = row_height;
+        _update_layout();
+        _update_row_layout();
+    }
+
+    int list_first_row()
+    {
+        if (list_rows.size() == 0) return 0;
+
+        return list_rows.back().first;
+    }
+
+    int list_visible_rows()
+    {
+        if (list_rows.size() == 0) return 0;
+
+        return list_rows.back().second;
+    }
+
+    void end_list(const string& name)
+    {
+        _interface_sanity_check();
+
+        _pop_container_stack(panel_type::list, name);
+    }
+
     bool start_treenode(const string& name)
     {
         _interface_sanity_check();
@@ -804,49 +858,9 @@ namespace splashkit_lib
         return sk_interface_button(text, 0);
     }
 
-    // TODO the code inside here is copied straight from images.cpp
-    // perhaps this should be a method inside utility_functions.cpp instead
-    // (similar to xy_from_opts), and images.cpp should use it too?
-    void _compute_bitmap_data(bitmap bmp, drawing_options opts, int x, int y, double (&src_data)[4], double (&dst_data)[7], sk_renderer_flip* flip)
+    void _compute_bitmap_data(bitmap bmp, const drawing_options &opts, int x, int y, double (&src_data)[4], double (&dst_data)[7], sk_renderer_flip* flip)
     {
-        if ( VALID_PTR(opts.anim, ANIMATION_PTR) || opts.draw_cell >= 0 )
-        {
-            int cell;
-            if ( opts.draw_cell >= 0 )
-                cell = opts.draw_cell;
-            else
-                cell = animation_current_cell(opts.anim);
-
-            rectangle part = bitmap_rectangle_of_cell(bmp, cell);
-            src_data[0] = part.x;
-            src_data[1] = part.y;
-            src_data[2] = part.width;
-            src_data[3] = part.height;
-        }
-        else if (opts.is_part)
-        {
-            src_data[0] = opts.part.x;
-            src_data[1] = opts.part.y;
-            src_data[2] = opts.part.width;
-            src_data[3] = opts.part.height;
-        }
-        else
-        {
-            src_data[0] = 0;
-            src_data[1] = 0;
-            src_data[2] = bmp->image.surface.width;
-            src_data[3] = bmp->image.surface.height;
-        }
-
-        //
-        if ((opts.flip_x) and (opts.flip_y))
-            *flip = sk_FLIP_BOTH;
-        else if (opts.flip_x)
-            *flip = sk_FLIP_VERTICAL;
-        else if (opts.flip_y)
-            *flip = sk_FLIP_HORIZONTAL;
-        else
-            *flip = sk_FLIP_NONE;
+        bitmap_source_and_flip(bmp, opts, src_data, *flip);
 
         // make up dst data
         dst_data[0] = x; // X
@@ -858,7 +872,7 @@ namespace splashkit_lib
         dst_data[6] = opts.scale_y; // Scale Y
     }
 
-    bool _bitmap_button_internal(bitmap bmp, const rectangle* rect, drawing_options opts)
+    bool _bitmap_button_internal(bitmap bmp, const rectangle* rect, const drawing_options &opts)
     {
         _interface_sanity_check();
 
@@ -871,6 +885,7 @@ namespace splashkit_lib
         sk_renderer_flip flip;
 
         _compute_bitmap_data(bmp, opts, 0, 0, src_data, dst_data, &flip);
+        _resource_used(bmp);
         int icon = sk_interface_register_icon(&bmp->image.surface, src_data, dst_data, flip);
 
         if (rect)
@@ -879,7 +894,7 @@ namespace splashkit_lib
         return sk_interface_button("", icon);
     }
 
-    bool bitmap_button(bitmap bmp, drawing_options opts)
+    bool bitmap_button(bitmap bmp, const drawing_options &opts)
     {
         return _bitmap_button_internal(bmp, nullptr, opts);
     }
@@ -889,7 +904,7 @@ namespace splashkit_lib
         return bitmap_button(bmp, option_defaults());
     }
 
-    bool bitmap_button(const string& label_text, bitmap bmp, drawing_options opts)
+    bool bitmap_button(const string& label_text, bitmap bmp, const drawing_options &opts)
     {
         _interface_sanity_check();
 
@@ -910,7 +925,7 @@ namespace splashkit_lib
         return bitmap_button(label_text, bmp, option_defaults());
     }
 
-    bool bitmap_button(bitmap bmp, const rectangle& rect, drawing_options opts)
+    bool bitmap_button(bitmap bmp, const rectangle& rect, const drawing_options &opts)
     {
         return _bitmap_button_internal(bmp, &rect, opts);
     }
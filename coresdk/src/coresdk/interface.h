@@ -158,6 +158,54 @@ namespace splashkit_lib
      */
     void end_inset(const string& name);
 
+    /**
+     * Starts the creation of a scrolling list, inside an inset area. Only the
+     * rows that can be seen need to be created, so long lists and tables
+     * take the same time to show no matter how many rows they have.
+     *
+     * Use as follows:
+     * ```c++
+     * start_list("Items", 200, items.size(), 20);
+     * for (int i = list_first_row(); i < list_first_row() + list_visible_rows(); i++)
+     *     label_element(items[i]);
+     * end_list("Items");
+     *
+     * ```
+     * Each row must fill exactly one line of the layout, so for a table
+     * use `split_into_columns` before adding the rows.
+     * The function **must** be accompanied by a call to `end_list`
+     * with the same name.
+     *
+     * @param name              The name of the list
+     * @param height            Height of the list in pixels. -1 fills entire space. Use negative heights to fill _up to_ `height` away from the bottom
+     * @param row_count         The number of rows in the list
+     * @param row_height        The height of each row in pixels
+     */
+    void start_list(const string& name, int height, int row_count, int row_height);
+
+    /**
+     * The index of the first row to create in the current list.
+     *
+     * @return                  The index of the first row that can be seen, or 0 if no list has been started
+     */
+    int list_first_row();
+
+    /**
+     * The number of rows to create in the current list, starting at
+     * `list_first_row`.
+     *
+     * @return                  The number of rows that can be seen, or 0 if no list has been started
+     */
+    int list_visible_rows();
+
+    /**
+     * Finishes the creation of a list, reserving space for the rows after
+     * the ones that were created.
+     *
+     * @param name              The list's name - must match with `start_list`
+     */
+    void end_list(const string& name);
+
     /**
      * Starts the creation of a tree node (such as those in a file tree view).
      * Returns whether the tree node is expanded or not.
@@ -385,7 +433,7 @@ namespace splashkit_lib
      *
      * @attribute suffix        labeled_with_options
      */
-    bool bitmap_button(const string& label_text, bitmap bmp, drawing_options opts);
+    bool bitmap_button(const string& label_text, bitmap bmp, const drawing_options &opts);
 
     /**
      * Creates a button with a bitmap in it, and no label.
@@ -407,7 +455,7 @@ namespace splashkit_lib
      *
      * @attribute suffix        with_options
      */
-    bool bitmap_button(bitmap bmp, drawing_options opts);
+    bool bitmap_button(bitmap bmp, const drawing_options &opts);
 
     /**
      * Creates a button with a bitmap in it at a specific position on screen.
@@ -432,7 +480,7 @@ namespace splashkit_lib
      *
      * @attribute suffix        at_position_with_options
      */
-    bool bitmap_button(bitmap bmp, const rectangle& rect, drawing_options opts);
+    bool bitmap_button(bitmap bmp, const rectangle& rect, const drawing_options &opts);
 
     /**
      * Creates a checkbox with a label.
@@ -0,0 +1,135 @@
+//
+//  jobs.cpp
+//  splashkit
+//
+//  Jobs run on the worker pool shared with the rest of the library. Each
+//  running job has a record so it can be checked or waited on, which is
+//  removed once its completion has been seen.
+//
+
+#include "jobs.h"
+
+#include "concurrency_utils.h"
+#include "utility_functions.h"
+
+#include <map>
+
+namespace splashkit_lib
+{
+    struct _job_record
+    {
+        atomic<bool> done{false};
+        mutex lock;
+        condition_variable finished;
+    };
+
+    static mutex _jobs_lock;
+    static std::map<int, std::shared_ptr<_job_record>> _jobs;
+    static int _next_job_id = 0;
+
+    int start_job(job_callback *fn)
+    {
+        if ( ! fn )
+        {
+            LOG(WARNING) << "Attempting to start a job without a function to run";
+            return -1;
+        }
+
+        auto record = std::make_shared<_job_record>();
+        int id;
+        {
+            lock_guard<mutex> guard(_jobs_lock);
+            id = _next_job_id++;
+            if ( _next_job_id < 0 ) _next_job_id = 0;
+            _jobs[id] = record;
+        }
+
+        shared_worker_pool().add([fn, id, record]()
+        {
+            fn(id);
+
+            lock_guard<mutex> guard(record->lock);
+            record->done.store(true);
+            record->finished.notify_all();
+        });
+
+        return id;
+    }
+
+    static std::shared_ptr<_job_record> _job_record_for(int id)
+    {
+        lock_guard<mutex> guard(_jobs_lock);
+        auto it = _jobs.find(id);
+        return it == _jobs.end() ? nullptr : it->second;
+    }
+
+    static void _forget_job(int id)
+    {
+        lock_guard<mutex> guard(_jobs_lock);
+        _jobs.erase(id);
+    }
+
+    bool job_complete(int id)
+    {
+        std::shared_ptr<_job_record> record = _job_record_for(id);
+        if ( ! record ) return true;
+
+        if ( ! record->done.load() ) return false;
+
+        _forget_job(id);
+        return true;
+    }
+
+    void wait_for_job(int id)
+    {
+        std::shared_ptr<_job_record> record = _job_record_for(id);
+        if ( ! record ) return;
+
+        {
+            unique_lock<mutex> guard(record->lock);
+            record->finished.wait(guard, [&record] { return record->done.load(); });
+        }
+
+        _forget_job(id);
+    }
+
+    void parallel_for(int begin, int end, int grain, parallel_callback *fn)
+    {
+        if ( ! fn )
+        {
+            LOG(WARNING) << "Attempting to run a parallel for without a function to run";
+            return;
+        }
+
+        if ( end <= begin ) return;
+
+        size_t count = static_cast<size_t>(end) - begin;
+        if ( grain <= 0 ) grain = 1;
+
+        parallel_for(shared_worker_pool(), count, grain, [begin, fn](size_t first, size_t last, size_t)
+        {
+            fn(begin + static_cast<int>(first), begin + static_cast<int>(last));
+        });
+    }
+
+    void parallel_for(int begin, int end, parallel_callback *fn)
+    {
+        if ( end <= begin )
+        {
+            parallel_for(begin, end, 1, fn);
+            return;
+        }
+
+        // about four parts for each thread, so early finishers have more to take
+        size_t threads = shared_worker_pool().thread_count() + 1;
+        size_t count = static_cast<size_t>(end) - begin;
+        size_t grain = std::max<size_t>(1, count / (threads * 4));
+
+        parallel_for(begin, end, static_cast<int>(grain), fn);
+    }
+
+    int job_thread_count()
+    {
+        return static_cast<int>(shared_worker_pool().thread_count());
+    }
+}
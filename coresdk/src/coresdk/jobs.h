@@ -0,0 +1,101 @@
+/**
+ * @header  jobs
+ * @brief   Jobs run your code on other threads, using the same worker threads as SplashKit.
+ *
+ * SplashKit keeps a thread for each core of the computer to update
+ * particles, sprites and physics in parallel and to load resources in the
+ * background. You can use these threads for your own work as well. Start a
+ * job to run a function in the background, or use `parallel_for` to split
+ * a loop across all of the threads.
+ *
+ * Jobs run at the same time as your program, so they must not change
+ * anything that the rest of the program is using without care. Jobs must
+ * not wait for other jobs.
+ *
+ * @attribute group  utilities
+ * @attribute static jobs
+ */
+
+#ifndef jobs_h
+#define jobs_h
+
+namespace splashkit_lib
+{
+    /**
+     * The `job_callback` is a function pointer used to run your code as a
+     * background job. See `start_job`.
+     *
+     * @param id The id of the job that is running
+     */
+    typedef void (job_callback)(int id);
+
+    /**
+     * The `parallel_callback` is a function pointer used to run part of a
+     * loop. Each call is passed the part of the range it should do. See
+     * `parallel_for`.
+     *
+     * @param begin The first index to do
+     * @param end   The index after the last one to do
+     */
+    typedef void (parallel_callback)(int begin, int end);
+
+    /**
+     * Start a function running on one of the worker threads.
+     *
+     * @param fn    The function to run
+     * @return      The id of the job, used to check when it is complete, or
+     *              -1 if fn is not set
+     */
+    int start_job(job_callback *fn);
+
+    /**
+     * Check if a job has finished running. Once this returns true the job's
+     * id is forgotten, and checking it again also returns true.
+     *
+     * @param id    The id returned from `start_job`
+     * @return      True if the job has finished
+     */
+    bool job_complete(int id);
+
+    /**
+     * Wait for a job to finish running.
+     *
+     * @param id    The id returned from `start_job`
+     */
+    void wait_for_job(int id);
+
+    /**
+     * Run a loop over the range, split into parts that are done on all of
+     * the worker threads and the calling thread. Returns once the whole
+     * range is done. Threads that finish their part early take on parts no
+     * one has started, so uneven work is spread out.
+     *
+     * @param begin The first index of the range
+     * @param end   The index after the last one in the range
+     * @param fn    The function called for each part of the range
+     */
+    void parallel_for(int begin, int end, parallel_callback *fn);
+
+    /**
+     * Run a loop over the range, split into parts of the given size that are
+     * done on all of the worker threads and the calling thread.
+     *
+     * @param begin The first index of the range
+     * @param end   The index after the last one in the range
+     * @param grain The number of indexes in each part
+     * @param fn    The function called for each part of the range
+     *
+     * @attribute suffix with_grain
+     */
+    void parallel_for(int begin, int end, int grain, parallel_callback *fn);
+
+    /**
+     * The number of worker threads that run jobs. The thread calling
+     * `parallel_for` also does part of the work.
+     *
+     * @return The number of worker threads
+     */
+    int job_thread_count();
+}
+
+#endif /* jobs_h */
@@ -12,6 +12,12 @@
 #include "resources.h"
 #include "core_driver.h"
 #include "utils.h"
+#include "file_view.h"
+#include "resource_tracking.h"
+
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
 
 using std::ofstream;
 
@@ -19,14 +25,49 @@ namespace splashkit_lib
 {
     static vector<json> objects;
 
+    // An estimate of the memory held by a json value and its children. Each
+    // object entry also costs a tree node holding its key.
+    static size_t _json_bytes(const backend_json &value)
+    {
+        size_t result = sizeof(backend_json);
+
+        switch (value.type())
+        {
+            case backend_json::value_t::object:
+                for (auto it = value.begin(); it != value.end(); ++it)
+                    result += 4 * sizeof(void *) + sizeof(string) + it.key().capacity() + _json_bytes(it.value());
+                break;
+            case backend_json::value_t::array:
+                result += sizeof(vector<backend_json>);
+                for (const backend_json &item : value)
+                    result += _json_bytes(item);
+                break;
+            case backend_json::value_t::string:
+                result += sizeof(string) + value.get_ref<const string &>().capacity();
+                break;
+            default:
+                break;
+        }
+
+        return result;
+    }
+
     json create_json()
     {
         internal_sk_init();
 
+        // Freed objects are not reused, so a stale handle stays invalid
         sk_json* j = new sk_json;
+
         j->id = JSON_PTR;
+        j->index = objects.size();
         objects.push_back(j);
 
+        _count_resource(j, JSON_RESOURCE, [j](size_t &cpu, size_t &gpu)
+        {
+            cpu = sizeof(sk_json) + _json_bytes(j->data);
+        });
+
         return j;
     };
 
@@ -53,33 +94,115 @@ namespace splashkit_lib
             return;
         }
 
-        for (auto it = objects.begin(); it != objects.end();)
+        if (j->index >= objects.size() || objects[j->index] != j)
         {
-            if (*it == j)
-            {
-                notify_of_free(j);
-
-                sk_delete_json(*it);
-                it = objects.erase(it);
-                return;
-            }
-            else
-            {
-                ++it;
-            }
+            LOG(WARNING) << "Passed unknown json object to free_json";
+            return;
         }
+
+        notify_of_free(j);
+
+        // move the last object into this one's place, so nothing needs to shift
+        json last = objects.back();
+        objects[j->index] = last;
+        last->index = j->index;
+        objects.pop_back();
+
+        sk_delete_json(j);
     }
 
     void free_all_json()
     {
         for (json j : objects)
         {
+            notify_of_free(j);
             sk_delete_json(j);
         }
 
         objects.clear();
     }
 
+    // Keys are kept for the life of the program, so handles never dangle
+    static std::unordered_map<string, json_key> _json_keys;
+
+    json_key json_key_for(const string &name)
+    {
+        auto it = _json_keys.find(name);
+        if (it != _json_keys.end()) return it->second;
+
+        json_key result = new sk_json_key;
+        result->id = JSON_KEY_PTR;
+        result->name = name;
+        _json_keys[name] = result;
+
+        return result;
+    }
+
+    string json_key_name(json_key key)
+    {
+        if (INVALID_PTR(key, JSON_KEY_PTR))
+        {
+            LOG(WARNING) << "Passed invalid json key to json_key_name";
+            return "";
+        }
+
+        return key->name;
+    }
+
+    // The name of a key, or an empty string for an invalid key
+    static const string &_key_name(json_key key)
+    {
+        static const string empty;
+
+        if (INVALID_PTR(key, JSON_KEY_PTR))
+        {
+            LOG(WARNING) << "Passed invalid json key to json function";
+            return empty;
+        }
+
+        return key->name;
+    }
+
+    string json_read_string(json j, json_key key)
+    {
+        return json_read_string(j, _key_name(key));
+    }
+
+    double json_read_number_as_double(json j, json_key key)
+    {
+        return json_read_number_as_double(j, _key_name(key));
+    }
+
+    int json_read_number_as_int(json j, json_key key)
+    {
+        return json_read_number_as_int(j, _key_name(key));
+    }
+
+    bool json_read_bool(json j, json_key key)
+    {
+        return json_read_bool(j, _key_name(key));
+    }
+
+    bool json_has_key(json j, json_key key)
+    {
+        return json_has_key(j, _key_name(key));
+    }
+
+    void json_set_string(json j, json_key key, const string &value)
+    {
+        json_set_string(j, _key_name(key), value);
+    }
+
+    void json_set_number(json j, json_key key, double value)
+    {
+        json_set_number(j, _key_name(key), value);
+    }
+
+    void json_set_bool(json j, json_key key, bool value)
+    {
+        json_set_bool(j, _key_name(key), value);
+    }
+
     string json_to_string(json j)
     {
         if (INVALID_PTR(j, JSON_PTR))
@@ -98,17 +221,121 @@ namespace splashkit_lib
 
     json json_from_file(const string &filename)
     {
-        string result = file_as_string(filename, JSON_RESOURCE);
-        if (result.length() == 0)
+        // Parse straight from the mapped file, without copying it to a string
+        file_view file(path_to_resource(filename, JSON_RESOURCE));
+        if (file.size() == 0)
         {
             LOG(WARNING) << "No input received when trying to open json from file " \
                 << filename << ". Does the file exist?";
             return create_json();
         }
 
-        return json_from_string(result);
+        json j = create_json();
+        try
+        {
+            j->data = backend_json::parse(file.data(), file.data() + file.size());
+        }
+        catch(...)
+        {
+            LOG(ERROR) << "Invalid JSON in file " << filename;
+        }
+
+        return j;
     };
 
+    vector<int8_t> json_to_bytes(json j, json_format format)
+    {
+        if (INVALID_PTR(j, JSON_PTR))
+        {
+            LOG(WARNING) << "Passed invalid json object to json_to_bytes";
+            return {};
+        }
+
+        vector<uint8_t> result;
+        switch (format)
+        {
+            case JSON_FORMAT_CBOR:
+                result = backend_json::to_cbor(j->data);
+                break;
+            case JSON_FORMAT_MSGPACK:
+                result = backend_json::to_msgpack(j->data);
+                break;
+            case JSON_FORMAT_UBJSON:
+                result = backend_json::to_ubjson(j->data);
+                break;
+            default:
+            {
+                string text = j->data.dump();
+                return vector<int8_t>(text.begin(), text.end());
+            }
+        }
+
+        return vector<int8_t>(result.begin(), result.end());
+    }
+
+    json json_from_bytes(const vector<int8_t> &bytes, json_format format)
+    {
+        json j = create_json();
+        const uint8_t *start = reinterpret_cast<const uint8_t *>(bytes.data());
+        const uint8_t *end = start + bytes.size();
+
+        try
+        {
+            switch (format)
+            {
+                case JSON_FORMAT_CBOR:
+                    j->data = backend_json::from_cbor(start, end);
+                    break;
+                case JSON_FORMAT_MSGPACK:
+                    j->data = backend_json::from_msgpack(start, end);
+                    break;
+                case JSON_FORMAT_UBJSON:
+                    j->data = backend_json::from_ubjson(start, end);
+                    break;
+                default:
+                    j->data = backend_json::parse(start, end);
+                    break;
+            }
+        }
+        catch(...)
+        {
+            LOG(ERROR) << "Invalid bytes passed to json_from_bytes";
+        }
+
+        return j;
+    }
+
+    bool json_parse_file(const string &filename, json_event_handler *handler)
+    {
+        if (!handler)
+        {
+            LOG(WARNING) << "Passed no handler to json_parse_file";
+            return false;
+        }
+
+        string path = path_to_resource(filename, JSON_RESOURCE);
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open())
+        {
+            LOG(WARNING) << "Unable to open json file " << filename << ". Does the file exist?";
+            return false;
+        }
+
+        return sk_json_parse_events(in, handler);
+    }
+
+    bool json_parse_string(const string &j_string, json_event_handler *handler)
+    {
+        if (!handler)
+        {
+            LOG(WARNING) << "Passed no handler to json_parse_string";
+            return false;
+        }
+
+        std::istringstream in(j_string);
+        return sk_json_parse_events(in, handler);
+    }
+
     void json_to_file(json j, const string& filename)
     {
         if (INVALID_PTR(j, JSON_PTR))
@@ -132,60 +359,133 @@ namespace splashkit_lib
         }
     };
 
-    void json_set_string(json j, string key, string value)
+    void json_set_string(json j, const string &key, const string &value)
     {
         sk_json_add_value(j, key, value);
     };
 
-    void json_set_number(json j, string key, float value)
+    void json_set_number(json j, const string &key, float value)
     {
         sk_json_add_value(j, key, value);
     }
 
-    void json_set_number(json j, string key, double value)
+    void json_set_number(json j, const string &key, double value)
     {
         sk_json_add_value(j, key, value);
     }
 
-    void json_set_number(json j, string key, int value)
+    void json_set_number(json j, const string &key, int value)
     {
         sk_json_add_value(j, key, value);
     }
 
-    void json_set_bool(json j, string key, bool value)
+    void json_set_bool(json j, const string &key, bool value)
     {
         sk_json_add_value(j, key, value);
     }
 
-    void json_set_object(json j, string key, json obj)
+    void json_set_object(json j, const string &key, json obj)
     {
+        if (INVALID_PTR(obj, JSON_PTR))
+        {
+            LOG(WARNING) << "Passed an invalid json object to json_set_object";
+            return;
+        }
+
         sk_json_add_value(j, key, obj->data);
     }
 
-    void json_set_array(json j, string key, vector<string> value)
+    void json_move_object(json j, const string &key, json obj)
+    {
+        if (INVALID_PTR(j, JSON_PTR) || INVALID_PTR(obj, JSON_PTR) || j == obj)
+        {
+            LOG(WARNING) << "Passed an invalid json object to json_move_object";
+            return;
+        }
+
+        j->data[key] = std::move(obj->data);
+        free_json(obj);
+    }
+
+    // The array at key, which is created when it is missing
+    backend_json *_json_array_for(json j, const string &key)
+    {
+        backend_json &result = j->data[key];
+
+        if (result.is_null())
+        {
+            result = backend_json::array();
+        }
+        else if (!result.is_array())
+        {
+            LOG(WARNING) << "JSON key value is not an array. Has type " << json_type_to_string(result.type());
+            return nullptr;
+        }
+
+        return &result;
+    }
+
+    void json_append_to_array(json j, const string &key, json obj)
+    {
+        if (INVALID_PTR(j, JSON_PTR) || INVALID_PTR(obj, JSON_PTR) || j == obj)
+        {
+            LOG(WARNING) << "Passed an invalid json object to json_append_to_array";
+            return;
+        }
+
+        backend_json *arr = _json_array_for(j, key);
+        if (!arr) return;
+
+        arr->push_back(std::move(obj->data));
+        free_json(obj);
+    }
+
+    void json_reserve_array(json j, const string &key, int count)
+    {
+        if (INVALID_PTR(j, JSON_PTR))
+        {
+            LOG(WARNING) << "Passed an invalid json object to json_reserve_array";
+            return;
+        }
+
+        backend_json *arr = _json_array_for(j, key);
+        if (!arr || count <= 0) return;
+
+        arr->get_ref<backend_json::array_t &>().reserve(static_cast<size_t>(count));
+    }
+
+    void json_set_array(json j, const string &key, const vector<string> &value)
     {
         sk_json_add_value(j, key, value);
     }
 
-    void json_set_array(json j, string key, vector<double> value)
+    void json_set_array(json j, const string &key, const vector<double> &value)
     {
         sk_json_add_value(j, key, value);
     }
 
-    void json_set_array(json j, string key, vector<bool> value)
+    void json_set_array(json j, const string &key, const vector<bool> &value)
     {
         sk_json_add_value(j, key, value);
     }
 
-    void json_set_array(json j, string key, vector<json> value)
+    void json_set_array(json j, const string &key, const vector<json> &value)
     {
-        vector<backend_json> real;
+        if (INVALID_PTR(j, JSON_PTR))
+        {
+            LOG(WARNING) << "Passed an invalid json object to json_set_array";
+            return;
+        }
+
+        // build the array in place, rather than copying a temporary one in
+        backend_json::array_t real;
+        real.reserve(value.size());
 
         for (json frontend : value)
         {
             if (INVALID_PTR(frontend, JSON_PTR))
             {
-                LOG(WARNING) << "Passed an invalid json object to json_add_x";
+                LOG(WARNING) << "Skipping an invalid json value in the array passed to json_set_array";
             }
             else
             {
@@ -193,35 +493,35 @@ namespace splashkit_lib
             }
         }
 
-        sk_json_add_value(j, key, real);
+        j->data[key] = std::move(real);
     }
 
-    string json_read_string(json j, string key)
+    string json_read_string(json j, const string &key)
     {
         return sk_json_read_value<string>(j, key, backend_json::value_t::string);
     }
 
-    float json_read_number(json j, string key)
+    float json_read_number(json j, const string &key)
     {
         return sk_json_read_value<float>(j, key, backend_json::value_t::number_float);
     }
 
-    int json_read_number_as_int(json j, string key)
+    int json_read_number_as_int(json j, const string &key)
     {
         return sk_json_read_value<int>(j, key, backend_json::value_t::number_integer);
     }
 
-    double json_read_number_as_double(json j, string key)
+    double json_read_number_as_double(json j, const string &key)
     {
         return sk_json_read_value<double>(j, key, backend_json::value_t::number_float);
     }
 
-    bool json_read_bool(json j, string key)
+    bool json_read_bool(json j, const string &key)
     {
         return sk_json_read_value<bool>(j, key, backend_json::value_t::boolean);
     }
 
-    json json_read_object(json j, string key)
+    json json_read_object(json j, const string &key)
     {
         auto backend_j = sk_json_read_value<backend_json>(j, key, backend_json::value_t::object);
 
@@ -230,22 +530,22 @@ namespace splashkit_lib
         return result;
     }
 
-    void json_read_array(json j, string key, vector<double>& out)
+    void json_read_array(json j, const string &key, vector<double>& out)
     {
         sk_json_read_array(j, key, out);
     }
 
-    void json_read_array(json j, string key, vector<bool>& out)
+    void json_read_array(json j, const string &key, vector<bool>& out)
     {
         sk_json_read_array(j, key, out);
     }
 
-    void json_read_array(json j, string key, vector<string>& out)
+    void json_read_array(json j, const string &key, vector<string>& out)
     {
         sk_json_read_array(j, key, out);
     }
 
-    void json_read_array(json j, string key, vector<json>& out)
+    void json_read_array(json j, const string &key, vector<json>& out)
     {
         vector<backend_json> real;
         sk_json_read_array(j, key, real);
@@ -260,7 +560,37 @@ namespace splashkit_lib
         }
     }
 
-    bool json_has_key(json j, string key)
+    bool json_has_path(json j, const string &path)
+    {
+        return sk_json_find_path(j, path) != nullptr;
+    }
+
+    string json_read_path_string(json j, const string &path)
+    {
+        return sk_json_read_path<string>(j, path, backend_json::value_t::string);
+    }
+
+    double json_read_path_number(json j, const string &path)
+    {
+        return sk_json_read_path<double>(j, path, backend_json::value_t::number_float);
+    }
+
+    bool json_read_path_bool(json j, const string &path)
+    {
+        return sk_json_read_path<bool>(j, path, backend_json::value_t::boolean);
+    }
+
+    json json_read_path_object(json j, const string &path)
+    {
+        const backend_json *value = sk_json_find_path(j, path);
+
+        json result = create_json();
+        if (value && sk_json_check_type(*value, backend_json::value_t::object))
+            result->data = *value;
+        return result;
+    }
+
+    bool json_has_key(json j, const string &key)
     {
         if (INVALID_PTR(j, JSON_PTR))
         {
@@ -8,8 +8,8 @@
  * manipulate them to/from a JSON string or from a file containing a JSON
  * string. Create a new JSON object with a call to `create_json()` and
  * read or write data to it by calling methods like
- * `json_add_string(json j, string key, string value)` and
- * `json_read_string(json j, string key)`.
+ * `json_add_string(json j, const string &key, const string &value)` and
+ * `json_read_string(json j, const string &key)`.
  *
  * @attribute group  json
  * @attribute static json
@@ -49,6 +49,73 @@ namespace splashkit_lib
      */
     typedef struct sk_json *json;
 
+    /**
+     * A `json_key` is a key that has been prepared once with `json_key_for`,
+     * so that it can be used to read and set values many times without
+     * creating a new `string` for each call. Keys last until the program
+     * ends, and do not need to be freed.
+     *
+     * @attribute class json_key
+     */
+    typedef struct sk_json_key *json_key;
+
+    /**
+     * The ways a `json` object can be encoded as bytes. The binary formats are
+     * smaller than text, and are faster to read, which makes them useful for
+     * sending data between programs.
+     *
+     * @constant JSON_FORMAT_TEXT     The usual json text.
+     * @constant JSON_FORMAT_CBOR     Concise Binary Object Representation (RFC 8949).
+     * @constant JSON_FORMAT_MSGPACK  MessagePack.
+     * @constant JSON_FORMAT_UBJSON   Universal Binary JSON.
+     */
+    enum json_format
+    {
+        JSON_FORMAT_TEXT,
+        JSON_FORMAT_CBOR,
+        JSON_FORMAT_MSGPACK,
+        JSON_FORMAT_UBJSON
+    };
+
+    /**
+     * The events reported while json is parsed with `json_parse_file` or
+     * `json_parse_string`.
+     *
+     * @constant JSON_START_OBJECT  An object has started, its keys and values follow.
+     * @constant JSON_END_OBJECT    The current object has ended.
+     * @constant JSON_START_ARRAY   An array has started, its values follow.
+     * @constant JSON_END_ARRAY     The current array has ended.
+     * @constant JSON_KEY           The text is the key of the next value in the object.
+     * @constant JSON_STRING_VALUE  The text is a string value.
+     * @constant JSON_NUMBER_VALUE  The number is a number value.
+     * @constant JSON_BOOL_VALUE    The number is 1 for true and 0 for false.
+     * @constant JSON_NULL_VALUE    The value is null.
+     */
+    enum json_event
+    {
+        JSON_START_OBJECT,
+        JSON_END_OBJECT,
+        JSON_START_ARRAY,
+        JSON_END_ARRAY,
+        JSON_KEY,
+        JSON_STRING_VALUE,
+        JSON_NUMBER_VALUE,
+        JSON_BOOL_VALUE,
+        JSON_NULL_VALUE
+    };
+
+    /**
+     * A json event handler is called for each part of the json as it is
+     * parsed, so that you can read large files without loading all of the
+     * data into a `json` object. Return false to stop parsing.
+     *
+     * @param event   The kind of data that was read
+     * @param text    The key or string value, empty for other events
+     * @param number  The number or bool value, 0 for other events
+     * @return        True to continue parsing, false to stop
+     */
+    typedef bool (json_event_handler)(json_event event, const string &text, double number);
+
     /**
      * @brief Creates an empty `json` object.
      *
@@ -147,6 +214,32 @@ namespace splashkit_lib
      */
     json json_from_string(const string &j_string);
 
+    /**
+     * Returns the key for the given name. Asking for the same name again
+     * returns the same key.
+     *
+     * @param name The name of the key.
+     *
+     * @returns The key, which can be passed to the `json_key` versions of
+     *          the read and set functions.
+     *
+     * @attribute class json_key
+     * @attribute constructor true
+     */
+    json_key json_key_for(const string &name);
+
+    /**
+     * Returns the name of a key.
+     *
+     * @param key The key.
+     *
+     * @returns The name the key was created with.
+     *
+     * @attribute class json_key
+     * @attribute getter name
+     */
+    string json_key_name(json_key key);
+
     /**
      * Adds a `string` value to the `json` object for the given `string` key.
      *
@@ -158,7 +251,7 @@ namespace splashkit_lib
      * @attribute method add_string
      * @attribute self j
      */
-    void json_set_string(json j, string key, string value);
+    void json_set_string(json j, const string &key, const string &value);
 
     /**
      * Adds a `float` value to the `json` object for the given `string` key.
@@ -173,7 +266,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  float
      */
-    void json_set_number(json j, string key, float value);
+    void json_set_number(json j, const string &key, float value);
 
     /**
      * Adds a `double` value to the `json` object for the given `string` key.
@@ -188,7 +281,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  double
      */
-    void json_set_number(json j, string key, double value);
+    void json_set_number(json j, const string &key, double value);
 
     /**
      * Adds an `int` value to the `json` object for the given `string` key.
@@ -203,7 +296,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  integer
      */
-    void json_set_number(json j, string key, int value);
+    void json_set_number(json j, const string &key, int value);
 
     /**
      * Adds a `bool` value to the `json` object for the given `string` key.
@@ -216,7 +309,7 @@ namespace splashkit_lib
      * @attribute method add_bool
      * @attribute self j
      */
-    void json_set_bool(json j, string key, bool value);
+    void json_set_bool(json j, const string &key, bool value);
 
     /**
      * Adds a `json` object to the `json` object for the given `string` key.
@@ -229,7 +322,7 @@ namespace splashkit_lib
      * @attribute method add_object
      * @attribute self j
      */
-    void json_set_object(json j, string key, json obj);
+    void json_set_object(json j, const string &key, json obj);
 
     /**
      * Adds an array of `string` values to the `json` object for
@@ -244,7 +337,7 @@ namespace splashkit_lib
      * @attribute suffix of_string
      * @attribute self j
      */
-    void json_set_array(json j, string key, vector<string> value);
+    void json_set_array(json j, const string &key, const vector<string> &value);
 
     /**
      * Adds an array of `double` values to the `json` object for
@@ -259,7 +352,7 @@ namespace splashkit_lib
      * @attribute suffix of_double
      * @attribute self j
      */
-    void json_set_array(json j, string key, vector<double> value);
+    void json_set_array(json j, const string &key, const vector<double> &value);
 
     /**
      * Adds an array of `bool` values to the `json` object for
@@ -274,7 +367,7 @@ namespace splashkit_lib
      * @attribute suffix of_bool
      * @attribute self j
      */
-    void json_set_array(json j, string key, vector<bool> value);
+    void json_set_array(json j, const string &key, const vector<bool> &value);
 
     /**
      * Adds an array of `json` object values to the `json` object for
@@ -289,7 +382,100 @@ namespace splashkit_lib
      * @attribute suffix of_json
      * @attribute self j
      */
-    void json_set_array(json j, string key, vector<json> value);
+    void json_set_array(json j, const string &key, const vector<json> &value);
+
+    /**
+     * Moves a `json` object into the `json` object for the given `string`
+     * key. Unlike `json_set_object` the data is not copied, instead `obj` is
+     * freed and its data now belongs to `j`.
+     *
+     * @param j The `json` object where data will be inserted for the given key.
+     * @param key The `string` key where data will be stored in the `json` object.
+     * @param obj The value to be moved into the `json` object. This is freed.
+     *
+     * @attribute class json
+     * @attribute method move_object
+     * @attribute self j
+     */
+    void json_move_object(json j, const string &key, json obj);
+
+    /**
+     * Moves a `json` object onto the end of the array at the given `string`
+     * key, creating the array if needed. The data is not copied, instead
+     * `obj` is freed and its data now belongs to `j`.
+     *
+     * @param j The `json` object containing the array.
+     * @param key The `string` key of the array in the `json` object.
+     * @param obj The value to be moved onto the array. This is freed.
+     *
+     * @attribute class json
+     * @attribute method append_to_array
+     * @attribute self j
+     */
+    void json_append_to_array(json j, const string &key, json obj);
+
+    /**
+     * Makes room for the indicated number of values in the array at the
+     * given `string` key, creating the array if needed. Appending up to this
+     * many values will then not need to grow the array.
+     *
+     * @param j The `json` object containing the array.
+     * @param key The `string` key of the array in the `json` object.
+     * @param count The number of values to make room for.
+     *
+     * @attribute class json
+     * @attribute method reserve_array
+     * @attribute self j
+     */
+    void json_reserve_array(json j, const string &key, int count);
+
+    /**
+     * Encodes the `json` object as bytes in the indicated format.
+     *
+     * @param j The `json` object to encode.
+     * @param format The format to encode the `json` object in.
+     *
+     * @returns The encoded bytes.
+     *
+     * @attribute class json
+     * @attribute method to_bytes
+     * @attribute self j
+     */
+    vector<int8_t> json_to_bytes(json j, json_format format);
+
+    /**
+     * Creates a `json` object from bytes in the indicated format, such as
+     * those from `json_to_bytes`.
+     *
+     * @param bytes The encoded json.
+     * @param format The format the bytes are in.
+     *
+     * @returns A new `json` object, which is empty if the bytes are not valid.
+     */
+    json json_from_bytes(const vector<int8_t> &bytes, json_format format);
+
+    /**
+     * Reads a file of json, calling the handler for each part of it as it is
+     * read. This does not create a `json` object, so the file is never
+     * all in memory at once.
+     *
+     * @param filename The name of the file to read.
+     * @param handler  The function to call for each part of the json.
+     *
+     * @returns True if the whole file was valid json, and the handler did not stop parsing.
+     */
+    bool json_parse_file(const string &filename, json_event_handler *handler);
+
+    /**
+     * Reads a string of json, calling the handler for each part of it, rather
+     * than creating a `json` object.
+     *
+     * @param j_string The json text to read.
+     * @param handler  The function to call for each part of the json.
+     *
+     * @returns True if the string was valid json, and the handler did not stop parsing.
+     */
+    bool json_parse_string(const string &j_string, json_event_handler *handler);
 
     /**
      * Reads a `float` value from the `json` object for the given `string` key.
@@ -303,7 +489,7 @@ namespace splashkit_lib
      * @attribute method read_number
      * @attribute self j
      */
-    float json_read_number(json j, string key);
+    float json_read_number(json j, const string &key);
 
     /**
      * Reads a `integer` value from the `json` object for the given `string` key.
@@ -317,7 +503,7 @@ namespace splashkit_lib
      * @attribute method read_integer
      * @attribute self j
      */
-    int json_read_number_as_int(json j, string key);
+    int json_read_number_as_int(json j, const string &key);
 
     /**
      * Reads a `double` value from the `json` object for the given `string` key.
@@ -331,7 +517,7 @@ namespace splashkit_lib
      * @attribute method read_double
      * @attribute self j
      */
-    double json_read_number_as_double(json j, string key);
+    double json_read_number_as_double(json j, const string &key);
 
     /**
      * Reads a `string` value from the `json` object for the given `string` key.
@@ -345,7 +531,7 @@ namespace splashkit_lib
      * @attribute method read_string
      * @attribute self j
      */
-    string json_read_string(json j, string key);
+    string json_read_string(json j, const string &key);
 
     /**
      * Reads a `bool` value from the `json` object for the given `string` key.
@@ -359,7 +545,7 @@ namespace splashkit_lib
      * @attribute method read_bool
      * @attribute self j
      */
-    bool json_read_bool(json j, string key);
+    bool json_read_bool(json j, const string &key);
 
     /**
      * Reads a `json` object value from the `json` object for the given `string` key.
@@ -373,11 +559,13 @@ namespace splashkit_lib
      * @attribute method read_object
      * @attribute self j
      */
-    json json_read_object(json j, string key);
+    json json_read_object(json j, const string &key);
 
     /**
      * Reads an array of `double` values from the `json` object for
-     * the given `string` key.
+     * the given `string` key. The values replace those in `out_result`,
+     * reusing its storage, so reading into the same vector each frame does
+     * not allocate.
      *
      * @param j The `json` object from which data will be returned for the given key.
      * @param key The `string` key used to find data in the `json` object.
@@ -388,7 +576,7 @@ namespace splashkit_lib
      * @attribute suffix of_double
      * @attribute self j
      */
-    void json_read_array(json j, string key, vector<double> &out_result);
+    void json_read_array(json j, const string &key, vector<double> &out_result);
 
     /**
      * Reads an array of `json` object values from the `json` object for
@@ -403,7 +591,7 @@ namespace splashkit_lib
      * @attribute suffix of_json
      * @attribute self j
      */
-    void json_read_array(json j, string key, vector<json> &out_result);
+    void json_read_array(json j, const string &key, vector<json> &out_result);
 
     /**
      * Reads an array of `string` values from the `json` object for
@@ -418,7 +606,7 @@ namespace splashkit_lib
      * @attribute suffix of_string
      * @attribute self j
      */
-    void json_read_array(json j, string key, vector<string> &out_result);
+    void json_read_array(json j, const string &key, vector<string> &out_result);
 
     /**
      * Reads an array of `bool` values from the `json` object for
@@ -433,7 +621,208 @@ namespace splashkit_lib
      * @attribute suffix of_bool
      * @attribute self j
      */
-    void json_read_array(json j, string key, vector<bool> &out_result);
+    void json_read_array(json j, const string &key, vector<bool> &out_result);
+
+    /**
+     * Checks if the `json` object contains a value at the given path. Paths
+     * are json pointers, such as "/player/items/3/name", where numbers index
+     * into arrays.
+     *
+     * @param j The `json` object to check.
+     * @param path The path to the value.
+     *
+     * @returns Returns `true` if there is a value at the path.
+     *
+     * @attribute class json
+     * @attribute method has_path
+     * @attribute self j
+     */
+    bool json_has_path(json j, const string &path);
+
+    /**
+     * Reads a `string` value at the given path in the `json` object, without
+     * reading each of the objects along the way. See `json_has_path`.
+     *
+     * @param j The `json` object from which data will be read.
+     * @param path The path to the value, such as "/player/name".
+     *
+     * @returns Returns the `string` value stored at the path.
+     *
+     * @attribute class json
+     * @attribute method read_path_string
+     * @attribute self j
+     */
+    string json_read_path_string(json j, const string &path);
+
+    /**
+     * Reads a number at the given path in the `json` object, without reading
+     * each of the objects along the way. See `json_has_path`.
+     *
+     * @param j The `json` object from which data will be read.
+     * @param path The path to the value, such as "/player/items/3/weight".
+     *
+     * @returns Returns the number stored at the path.
+     *
+     * @attribute class json
+     * @attribute method read_path_number
+     * @attribute self j
+     */
+    double json_read_path_number(json j, const string &path);
+
+    /**
+     * Reads a `bool` value at the given path in the `json` object, without
+     * reading each of the objects along the way. See `json_has_path`.
+     *
+     * @param j The `json` object from which data will be read.
+     * @param path The path to the value, such as "/player/alive".
+     *
+     * @returns Returns the `bool` value stored at the path.
+     *
+     * @attribute class json
+     * @attribute method read_path_bool
+     * @attribute self j
+     */
+    bool json_read_path_bool(json j, const string &path);
+
+    /**
+     * Reads a `json` object at the given path in the `json` object. The
+     * result is a copy, which you need to free.
+     *
+     * @param j The `json` object from which data will be read.
+     * @param path The path to the value, such as "/player/items/3".
+     *
+     * @returns Returns a copy of the `json` object stored at the path.
+     *
+     * @attribute class json
+     * @attribute method read_path_object
+     * @attribute self j
+     */
+    json json_read_path_object(json j, const string &path);
+
+    /**
+     * Reads a `string` value from the `json` object for the given key.
+     *
+     * @param j The `json` object to use.
+     * @param key The key, from `json_key_for`.
+     *
+     * @returns Returns the `string` value stored at the key.
+     *
+     * @attribute class json
+     * @attribute method read_string
+     * @attribute self j
+     *
+     * @attribute suffix with_key
+     */
+    string json_read_string(json j, json_key key);
+
+    /**
+     * Reads a `double` value from the `json` object for the given key.
+     *
+     * @param j The `json` object to use.
+     * @param key The key, from `json_key_for`.
+     *
+     * @returns Returns the `double` value stored at the key.
+     *
+     * @attribute class json
+     * @attribute method read_double
+     * @attribute self j
+     *
+     * @attribute suffix with_key
+     */
+    double json_read_number_as_double(json j, json_key key);
+
+    /**
+     * Reads an `int` value from the `json` object for the given key.
+     *
+     * @param j The `json` object to use.
+     * @param key The key, from `json_key_for`.
+     *
+     * @returns Returns the `int` value stored at the key.
+     *
+     * @attribute class json
+     * @attribute method read_integer
+     * @attribute self j
+     *
+     * @attribute suffix with_key
+     */
+    int json_read_number_as_int(json j, json_key key);
+
+    /**
+     * Reads a `bool` value from the `json` object for the given key.
+     *
+     * @param j The `json` object to use.
+     * @param key The key, from `json_key_for`.
+     *
+     * @returns Returns the `bool` value stored at the key.
+     *
+     * @attribute class json
+     * @attribute method read_bool
+     * @attribute self j
+     *
+     * @attribute suffix with_key
+     */
+    bool json_read_bool(json j, json_key key);
+
+    /**
+     * Checks if the `json` object contains the given key.
+     *
+     * @param j The `json` object to use.
+     * @param key The key, from `json_key_for`.
+     *
+     * @returns Returns `true` if the `json` object contains the key.
+     *
+     * @attribute class json
+     * @attribute method has_key
+     * @attribute self j
+     *
+     * @attribute suffix with_key
+     */
+    bool json_has_key(json j, json_key key);
+
+    /**
+     * Adds a `string` value to the `json` object for the given key.
+     *
+     * @param j The `json` object to use.
+     * @param key The key, from `json_key_for`.
+     * @param value The value to be inserted into the `json` object.
+     *
+     * @attribute class json
+     * @attribute method add_string
+     * @attribute self j
+     *
+     * @attribute suffix with_key
+     */
+    void json_set_string(json j, json_key key, const string &value);
+
+    /**
+     * Adds a `double` value to the `json` object for the given key.
+     *
+     * @param j The `json` object to use.
+     * @param key The key, from `json_key_for`.
+     * @param value The value to be inserted into the `json` object.
+     *
+     * @attribute class json
+     * @attribute method add_number
+     * @attribute self j
+     *
+     * @attribute suffix double_with_key
+     */
+    void json_set_number(json j, json_key key, double value);
+
+    /**
+     * Adds a `bool` value to the `json` object for the given key.
+     *
+     * @param j The `json` object to use.
+     * @param key The key, from `json_key_for`.
+     * @param value The value to be inserted into the `json` object.
+     *
+     * @attribute class json
+     * @attribute method add_bool
+     * @attribute self j
+     *
+     * @attribute suffix with_key
+     */
+    void json_set_bool(json j, json_key key, bool value);
 
     /**
      * Checks if the `json` object contains the given `string` key.
@@ -447,7 +836,7 @@ namespace splashkit_lib
      * @attribute method has_key
      * @attribute self j
      */
-    bool json_has_key(json j, string key);
+    bool json_has_key(json j, const string &key);
 
     /**
      * Returns the count of keys in the top-level `json` object.
@@ -12,18 +12,27 @@
 #include "utility_functions.h"
 
 #include <vector>
-#include <map>
+#include <bitset>
+#include <algorithm>
 
 using std::vector;
-using std::map;
+using std::bitset;
 
 namespace splashkit_lib
 {
-    static map<key_code, bool> _keys_down;
-    static map<key_code, bool> _keys_just_typed; // i.e. those that have just gone down
-    static map<key_code, bool> _keys_released; // i.e. those that have just gone up
+    // key codes are all below this, so each key state is a single bit
+    #define SK_KEY_CODE_COUNT 512
+
+    static bitset<SK_KEY_CODE_COUNT> _keys_down;
+    static bitset<SK_KEY_CODE_COUNT> _keys_just_typed; // i.e. those that have just gone down
+    static bitset<SK_KEY_CODE_COUNT> _keys_released; // i.e. those that have just gone up
     static bool _key_pressed = false;
 
+    static inline bool _valid_key_code(key_code key)
+    {
+        return key >= 0 && key < SK_KEY_CODE_COUNT;
+    }
+
     static vector<key_callback *> _on_key_down;
     static vector<key_callback *> _on_key_up;
     static vector<key_callback *> _on_key_typed;
@@ -71,22 +80,25 @@ namespace splashkit_lib
     void _keyboard_start_process_events()
     {
         _key_pressed = false;
-        _keys_just_typed.clear();
-        _keys_released.clear();
+        _keys_just_typed.reset();
+        _keys_released.reset();
     }
 
     void _handle_key_up_callback(key_code code)
     {
         key_code keycode = static_cast<key_code>(code);
-        _keys_released[keycode] = true;
-        _keys_down[keycode] = false;
+        if ( _valid_key_code(keycode) )
+        {
+            _keys_released[keycode] = true;
+            _keys_down[keycode] = false;
+        }
         _raise_key_event(_on_key_up, keycode);
     }
 
     void _handle_key_down_callback(key_code code)
     {
         key_code keycode = static_cast<key_code>(code);
-        if(not key_down(keycode))
+        if(_valid_key_code(keycode) and not key_down(keycode))
         {
             _keys_down[keycode] = true;
             _keys_just_typed[keycode] = true;
@@ -97,17 +109,17 @@ namespace splashkit_lib
 
     bool key_down(key_code key)
     {
-        return _keys_down.count(key) > 0 and _keys_down[key];
+        return _valid_key_code(key) and _keys_down[key];
     }
 
     bool key_typed(key_code key)
     {
-        return _keys_just_typed.count(key) > 0 and _keys_just_typed[key] ;
+        return _valid_key_code(key) and _keys_just_typed[key];
     }
     
     bool key_released(key_code key)
     {
-        return _keys_released.count(key) > 0 and _keys_released[key] ;
+        return _valid_key_code(key) and _keys_released[key];
     }
     
     bool any_key_pressed()
@@ -48,7 +48,7 @@ namespace splashkit_lib
         draw_line(clr, l.start_point.x, l.start_point.y, l.end_point.x, l.end_point.y, option_defaults());
     }
 
-    void draw_line(color clr, const line &l, drawing_options opts)
+    void draw_line(color clr, const line &l, const drawing_options &opts)
     {
         draw_line(clr, l.start_point.x, l.start_point.y, l.end_point.x, l.end_point.y, opts);
     }
@@ -78,7 +78,7 @@ namespace splashkit_lib
         draw_line(clr, l, option_draw_to(destination));
     }
     
-    void draw_line_on_window(window destination, color clr, const line &l, drawing_options opts)
+    void draw_line_on_window(window destination, color clr, const line &l, const drawing_options &opts)
     {
         draw_line(clr, l, option_draw_to(destination, opts));
     }
@@ -108,7 +108,7 @@ namespace splashkit_lib
         draw_line(clr, l, option_draw_to(destination));
     }
     
-    void draw_line_on_bitmap(bitmap destination, color clr, const line &l, drawing_options opts)
+    void draw_line_on_bitmap(bitmap destination, color clr, const line &l, const drawing_options &opts)
     {
         draw_line(clr, l, option_draw_to(destination, opts));
     }
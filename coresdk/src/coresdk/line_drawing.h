@@ -87,7 +87,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  record_with_options
      */
-    void draw_line(color clr, const line &l, drawing_options opts);
+    void draw_line(color clr, const line &l, const drawing_options &opts);
     
     /**
      * Draw a line from one point to another on the given window.
@@ -183,7 +183,7 @@ namespace splashkit_lib
      * @attribute suffix  record_with_options
      * @attribute method  draw_line
      */
-    void draw_line_on_window(window destination, color clr, const line &l, drawing_options opts);
+    void draw_line_on_window(window destination, color clr, const line &l, const drawing_options &opts);
     
     /**
      * Draw a line from one point to another on the given bitmap.
@@ -279,7 +279,7 @@ namespace splashkit_lib
      * @attribute suffix  record_with_options
      * @attribute method  draw_line
      */
-    void draw_line_on_bitmap(bitmap destination, color clr, const line &l, drawing_options opts);
+    void draw_line_on_bitmap(bitmap destination, color clr, const line &l, const drawing_options &opts);
 
 }
 #endif /* line_drawing_h */
@@ -10,6 +10,8 @@
 #include "point_geometry.h"
 #include "utility_functions.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 
 namespace splashkit_lib
@@ -106,17 +108,50 @@ namespace splashkit_lib
         } //  else NOT (u < EPS) or (u > 1)
     }
 
-    point_2d closest_point_on_lines(const point_2d from_pt, const vector<line> &lines, int &line_idx)
+    void closest_points_on_line(const vector<point_2d> &from_pts, const line &l, vector<point_2d> &out_result)
+    {
+        const size_t n = from_pts.size();
+        out_result.resize(n);
+
+        const double sx = l.start_point.x, sy = l.start_point.y;
+        const double dx = l.end_point.x - sx, dy = l.end_point.y - sy;
+        const double sq_line_mag = dx * dx + dy * dy;
+
+        if ( sq_line_mag < EPSEPS )
+        {
+            LOG(WARNING) << "Cannot determine intersection point on line, line is too short";
+            std::fill(out_result.begin(), out_result.end(), point_at(0,0));
+            return;
+        }
+
+        const point_2d *from = from_pts.data();
+        point_2d *result = out_result.data();
+
+        // Clamping u to the segment picks the nearer end point, as
+        // closest_point_on_line does, without a branch in the loop
+        for (size_t i = 0; i < n; i++)
+        {
+            double u = ((from[i].x - sx) * dx + (from[i].y - sy) * dy) / sq_line_mag;
+            u = u < EPS ? 0 : (u > 1 ? 1 : u);
+
+            result[i].x = sx + u * dx;
+            result[i].y = sy + u * dy;
+        }
+    }
+
+    // Used by the collision tests with the fixed size edge arrays below, so
+    // they do not need to allocate
+    point_2d _closest_point_on_lines(const point_2d from_pt, const line *lines, size_t count, int &line_idx)
     {
         line_idx = -1;
         point_2d result = point_at_origin();
 
-        if (lines.size() < 1) return result;
+        if (count < 1) return result;
 
         float min_dist = std::numeric_limits<float>::max(), dst;
         point_2d pt;
 
-        for (int i = 0; i < lines.size(); i++)
+        for (int i = 0; i < static_cast<int>(count); i++)
         {
             pt = closest_point_on_line(from_pt, lines[i]);
             dst = point_point_distance(pt, from_pt);
@@ -131,27 +166,56 @@ namespace splashkit_lib
         return result;
     }
 
-    vector<line> lines_from(const triangle &t)
+    point_2d closest_point_on_lines(const point_2d from_pt, const vector<line> &lines, int &line_idx)
     {
-        vector<line> result;
+        return _closest_point_on_lines(from_pt, lines.data(), lines.size(), line_idx);
+    }
 
-        result.push_back(line_from(t.points[0], t.points[1]));
-        result.push_back(line_from(t.points[1], t.points[2]));
-        result.push_back(line_from(t.points[2], t.points[0]));
+    std::array<line, 3> _lines_from(const triangle &t)
+    {
+        return {{
+            line_from(t.points[0], t.points[1]),
+            line_from(t.points[1], t.points[2]),
+            line_from(t.points[2], t.points[0])
+        }};
+    }
+
+    std::array<line, 4> _lines_from(const rectangle &rect)
+    {
+        return {{
+            line_from(rect.x, rect.y, rect.x + rect.width, rect.y),
+            line_from(rect.x, rect.y, rect.x, rect.y + rect.height),
+            line_from(rect.x + rect.width, rect.y, rect.x + rect.width, rect.y + rect.height),
+            line_from(rect.x, rect.y + rect.height, rect.x + rect.width, rect.y + rect.height)
+        }};
+    }
 
+    vector<line> lines_from(const triangle &t)
+    {
+        vector<line> result;
+        lines_from(t, result);
         return result;
     }
 
+    void lines_from(const triangle &t, vector<line> &out_result)
+    {
+        std::array<line, 3> lines = _lines_from(t);
+        out_result.assign(lines.begin(), lines.end());
+    }
+
     vector<line> lines_from(const rectangle &rect)
     {
         vector<line> result;
-        result.push_back(line_from(rect.x, rect.y, rect.x + rect.width, rect.y));
-        result.push_back(line_from(rect.x, rect.y, rect.x, rect.y + rect.height));
-        result.push_back(line_from(rect.x + rect.width, rect.y, rect.x + rect.width, rect.y + rect.height));
-        result.push_back(line_from(rect.x, rect.y + rect.height, rect.x + rect.width, rect.y + rect.height));
+        lines_from(rect, result);
         return result;
     }
 
+    void lines_from(const rectangle &rect, vector<line> &out_result)
+    {
+        std::array<line, 4> lines = _lines_from(rect);
+        out_result.assign(lines.begin(), lines.end());
+    }
+
     float line_length(const line &l)
     {
         return sqrt(line_length_squared(l));
@@ -171,9 +235,23 @@ namespace splashkit_lib
         return point_in_circle(pt, c);
     }
 
+    bool _line_intersects_lines(const line &l, const line *lines, size_t count);
+
     bool line_intersects_rect(const line &l, const rectangle &rect)
     {
-        return line_intersects_lines(l, lines_from(rect));
+        std::array<line, 4> edges = _lines_from(rect);
+        return _line_intersects_lines(l, edges.data(), edges.size());
+    }
+
+    void lines_intersect_rect(const vector<line> &lines, const rectangle &rect, vector<bool> &out_result)
+    {
+        std::array<line, 4> edges = _lines_from(rect);
+
+        out_result.resize(lines.size());
+        for (size_t i = 0; i < lines.size(); i++)
+        {
+            out_result[i] = _line_intersects_lines(lines[i], edges.data(), edges.size());
+        }
     }
 
     point_2d line_mid_point(const line &l)
@@ -194,12 +272,11 @@ namespace splashkit_lib
         return "Line from " + point_to_string(ln.start_point) + " to " + point_to_string(ln.end_point);
     }
 
-    bool line_intersects_lines(const line &l, const vector<line> &lines)
+    bool _line_intersects_lines(const line &l, const line *lines, size_t count)
     {
-        int i;
         point_2d pt;
 
-        for (i = 0; i < lines.size(); i++)
+        for (size_t i = 0; i < count; i++)
         {
             if ( line_intersection_point(l, lines[i], pt) and point_on_line(pt, lines[i]) and point_on_line(pt, l))
             {
@@ -208,4 +285,9 @@ namespace splashkit_lib
         }
         return false;
     }
+
+    bool line_intersects_lines(const line &l, const vector<line> &lines)
+    {
+        return _line_intersects_lines(l, lines.data(), lines.size());
+    }
 }
@@ -85,6 +85,17 @@ namespace splashkit_lib
      */
     vector<line> lines_from(const triangle &t);
 
+    /**
+     * Gets the lines from the details in the triangle, reusing the supplied
+     * vector so that no memory needs to be allocated once it has grown.
+     *
+     * @param t             The triangle
+     * @param out_result    After the call this holds the 3 lines of the triangle
+     *
+     * @attribute suffix  triangle_into
+     */
+    void lines_from(const triangle &t, vector<line> &out_result);
+
     /**
      * Returns an array of lines from a supplied rectangle.
      *
@@ -95,6 +106,17 @@ namespace splashkit_lib
      */
     vector<line> lines_from(const rectangle &rect);
 
+    /**
+     * Gets the lines from a supplied rectangle, reusing the supplied vector
+     * so that no memory needs to be allocated once it has grown.
+     *
+     * @param rect          The rectangle to get the lines from
+     * @param out_result    After the call this holds the 4 lines of the rectangle
+     *
+     * @attribute suffix  rectangle_into
+     */
+    void lines_from(const rectangle &rect, vector<line> &out_result);
+
     /**
      * Returns the point at which two lines would intersect. This point may lie
      * past the end of one or both lines.
@@ -127,6 +149,19 @@ namespace splashkit_lib
      */
     point_2d closest_point_on_lines(const point_2d from_pt, const vector<line> &lines, int &line_idx);
 
+    /**
+     * Gets the closest point on the line to each of the given points, as
+     * closest_point_on_line does. This is much faster than finding each
+     * point with its own call.
+     *
+     * @param  from_pts     The points to test
+     * @param  l            The line
+     * @param  out_result   After the call, this holds the point on the line
+     *                      closest to each of `from_pts`. Its storage is reused
+     *                      between calls.
+     */
+    void closest_points_on_line(const vector<point_2d> &from_pts, const line &l, vector<point_2d> &out_result);
+
     /**
      * Returns true if the two lines intersect.
      *
@@ -154,6 +189,18 @@ namespace splashkit_lib
      */
     bool line_intersects_rect(const line &l, const rectangle &rect);
 
+    /**
+     * Tests many lines against one rectangle, as line_intersects_rect does.
+     * The rectangle's edges are only worked out once.
+     *
+     * @param  lines        The lines to test
+     * @param  rect         The rectangle
+     * @param  out_result   After the call, this holds a result for each line:
+     *                      true if it intersects `rect`. Its storage is reused
+     *                      between calls.
+     */
+    void lines_intersect_rect(const vector<line> &lines, const rectangle &rect, vector<bool> &out_result);
+
     /**
      * Returns the center point of the line.
      *
@@ -1,15 +1,114 @@
 #include "logging.h"
+#include "concurrency_utils.h"
+
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+#include <vector>
 
 using namespace std;
 
 namespace splashkit_lib
 {
-    log_level _log_level;
-    log_mode _log_mode; // Necessary for telling the logger where to send messages to
+    // Read without a lock by every thread that logs
+    atomic<log_level> _log_level;
+    atomic<log_mode> _log_mode; // Necessary for telling the logger where to send messages to
     ofstream custom_log_file;
 
+    // Asynchronous logging queues the formatted lines for a writer thread
+    #define LOG_RING_SIZE 8192
+    static mpsc_ring<string> *_log_ring = nullptr;
+    static thread _log_writer;
+    static atomic<bool> _log_async_running(false);  // new text is queued for the writer
+    static atomic<bool> _log_writer_stop(false);    // the writer drains the ring and stops
+    static atomic<int> _log_submitting(0);          // threads part way through queueing text
+    static atomic<unsigned long> _log_written(0);   // passes completed by the writer
+    static int _log_flush_interval_ms = 100;
+    static mutex _log_write_lock;                   // guards the file and the mode
+    static mutex _log_wake_lock;
+    static condition_variable _log_wake;
+
+    //
+    // LOG_BINARY_FILE writes compact records rather than text. The file starts
+    // with the magic "SKLOG\x01" and the session's start time, then holds
+    // records that each start with a record type. Values are little endian.
+    //
+    //   format:  u8 1, u32 id, u16 length, text
+    //   event:   u8 2, u32 format id, u64 ns since start, u8 count, args
+    //   message: u8 3, u64 ns since start, u8 level, u16 length, text
+    //
+    // Each arg is a u8 type then its value: 1 for an i64, 2 for an f64, and
+    // 3 for a string as a u16 length and text. Appending to a file starts a
+    // new session with its own header. tools/sklog-decode expands the file.
+    //
+    #define LOG_BINARY_FORMAT 1
+    #define LOG_BINARY_EVENT 2
+    #define LOG_BINARY_MESSAGE 3
+    #define LOG_BINARY_INT 1
+    #define LOG_BINARY_DOUBLE 2
+    #define LOG_BINARY_STRING 3
+
+    static vector<string> _log_formats;
+    static mutex _log_formats_lock;
+    static std::chrono::steady_clock::time_point _log_session_start;
+
+    static void _put_bytes(string &out, uint64_t value, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            out += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    static void _put_text(string &out, const string &text)
+    {
+        size_t len = text.length() > 0xFFFF ? 0xFFFF : text.length();
+        _put_bytes(out, len, 2);
+        out.append(text, 0, len);
+    }
+
+    static void _put_timestamp(string &out)
+    {
+        auto elapsed = std::chrono::steady_clock::now() - _log_session_start;
+        _put_bytes(out, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(), 8);
+    }
+
+    static string _format_record(unsigned int id, const string &format)
+    {
+        string result;
+        _put_bytes(result, LOG_BINARY_FORMAT, 1);
+        _put_bytes(result, id, 4);
+        _put_text(result, format);
+        return result;
+    }
+
+    // Starts a session in the binary log, the caller must hold _log_write_lock.
+    static void _start_binary_session()
+    {
+        _log_session_start = std::chrono::steady_clock::now();
+        auto wall = std::chrono::system_clock::now().time_since_epoch();
+
+        string header = "SKLOG\x01";
+        _put_bytes(header, std::chrono::duration_cast<std::chrono::nanoseconds>(wall).count(), 8);
+
+        // formats registered before the file was opened
+        lock_guard<mutex> lock(_log_formats_lock);
+        for (size_t i = 0; i < _log_formats.size(); i++)
+        {
+            header += _format_record(static_cast<unsigned int>(i), _log_formats[i]);
+        }
+
+        custom_log_file.write(header.data(), header.size());
+    }
+
+    static void _submit_log_text(string &&text);
+
     void init_custom_logger(string app_name, bool override_prev_log, log_mode mode)
     {
+        // messages already queued go where they were meant to
+        flush_log();
+
+        lock_guard<mutex> lock(_log_write_lock);
         switch (mode)
         {
         case LOG_CONSOLE:
@@ -41,6 +140,25 @@ namespace splashkit_lib
             }
             _log_mode = mode;
             break;
+        case LOG_BINARY_FILE:
+            if (custom_log_file.is_open())
+            {
+                custom_log_file.close();
+            }
+            if (override_prev_log == false) // Default
+            {
+                custom_log_file.open(app_name + ".sklog", ofstream::out | ofstream::app | ofstream::binary);
+            }
+            else
+            {
+                custom_log_file.open(app_name + ".sklog", ofstream::out | ofstream::binary);
+            }
+            _log_mode = mode;
+            if (custom_log_file.is_open()) _start_binary_session();
+            break;
+        default:
+            _log_mode = mode;
+            break;
         }
     }
 
@@ -50,100 +168,331 @@ namespace splashkit_lib
         init_custom_logger("console", true, mode);
     }
 
-    void log(log_level level, string message)
+    // Returns the text that starts a message at this level, or nullptr when
+    // messages at this level are not being logged
+    static const char *_level_prefix(log_level level)
     {
         switch (level)
         {
         case NONE:
-            break;
+            return "";
         case INFO:
-            if (level < _log_level)
-            {
-                return;
-            }
-            if (_log_mode == LOG_CONSOLE || _log_mode == LOG_CONSOLE_AND_FILE)
-            {
-                write("INFO: ");
-            }
-            else if (_log_mode == LOG_FILE_ONLY || _log_mode == LOG_CONSOLE_AND_FILE)
-            {
-                custom_log_file << "INFO: ";
-            }
-            break;
+            return level < _log_level ? nullptr : "INFO: ";
         case DEBUG:
-            if (level < _log_level)
-            {
-                return;
-            }
-            if (_log_mode == LOG_CONSOLE || _log_mode == LOG_CONSOLE_AND_FILE)
-            {
-                write("DEBUG: ");
-            }
-            else if (_log_mode == LOG_FILE_ONLY || _log_mode == LOG_CONSOLE_AND_FILE)
-            {
-                custom_log_file << "DEBUG: ";
-            }
-            break;
+            return level < _log_level ? nullptr : "DEBUG: ";
         case WARNING:
-            if (level < _log_level)
-            {
-                return;
-            }
-            if (_log_mode == LOG_CONSOLE || _log_mode == LOG_CONSOLE_AND_FILE)
-            {
-                write("WARNING: ");
-            }
-            else if (_log_mode == LOG_FILE_ONLY || _log_mode == LOG_CONSOLE_AND_FILE)
-            {
-                custom_log_file << "WARNING: ";
-            }
-            break;
+            return level < _log_level ? nullptr : "WARNING: ";
         case ERROR:
-            if (level < _log_level)
+            return level < _log_level ? nullptr : "ERROR: ";
+        case FATAL:
+            return "FATAL: ";
+        }
+        return nullptr;
+    }
+
+    // Formats the time like ctime, without its new line. The text is reused
+    // until the second changes, so most messages do not format the time.
+    static const string &_log_timestamp()
+    {
+        static const char *days[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+        static const char *months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+        thread_local std::time_t last_time = 0;
+        thread_local string result;
+
+        std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        if (now != last_time || result.empty())
+        {
+            std::tm local;
+#ifdef WINDOWS
+            localtime_s(&local, &now);
+#else
+            localtime_r(&now, &local);
+#endif
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%s %s %2d %02d:%02d:%02d %d",
+                     days[local.tm_wday], months[local.tm_mon], local.tm_mday,
+                     local.tm_hour, local.tm_min, local.tm_sec, 1900 + local.tm_year);
+            result = buffer;
+            last_time = now;
+        }
+
+        return result;
+    }
+
+    // Writes lines, which each end in a new line, to the log's destinations.
+    // The caller must hold _log_write_lock.
+    static void _write_log_text(const string &text)
+    {
+        if (_log_mode == LOG_CONSOLE || _log_mode == LOG_CONSOLE_AND_FILE)
+        {
+            write(text);
+        }
+        if ((_log_mode == LOG_FILE_ONLY || _log_mode == LOG_CONSOLE_AND_FILE || _log_mode == LOG_BINARY_FILE) && custom_log_file.is_open())
+        {
+            custom_log_file << text;
+        }
+    }
+
+    static void _log_writer_loop()
+    {
+        string batch;
+        string line;
+        auto last_flush = std::chrono::steady_clock::now();
+
+        while (true)
+        {
+            bool stopping = _log_writer_stop.load(std::memory_order_acquire);
+
+            // take everything that is waiting, and write it in one go
+            batch.clear();
+            while (_log_ring->try_pop(line))
             {
-                return;
+                batch += line;
             }
-            if (_log_mode == LOG_CONSOLE || _log_mode == LOG_CONSOLE_AND_FILE)
+
+            if (!batch.empty())
             {
-                write("ERROR: ");
+                lock_guard<mutex> lock(_log_write_lock);
+                _write_log_text(batch);
             }
-            else if (_log_mode == LOG_FILE_ONLY || _log_mode == LOG_CONSOLE_AND_FILE)
+
+            auto now = std::chrono::steady_clock::now();
+            if (stopping || now - last_flush >= std::chrono::milliseconds(_log_flush_interval_ms))
             {
-                custom_log_file << "ERROR: ";
+                lock_guard<mutex> lock(_log_write_lock);
+                if (custom_log_file.is_open()) custom_log_file.flush();
+                last_flush = now;
             }
-            break;
-        case FATAL:
-            if (_log_mode == LOG_CONSOLE || _log_mode == LOG_CONSOLE_AND_FILE)
+
+            _log_written.fetch_add(1, std::memory_order_release);
+
+            if (stopping) break;
+
+            unique_lock<mutex> lock(_log_wake_lock);
+            _log_wake.wait_for(lock, std::chrono::milliseconds(_log_flush_interval_ms));
+        }
+    }
+
+    void enable_async_logging(int flush_interval_ms)
+    {
+        if (_log_async_running) return;
+
+        _log_flush_interval_ms = flush_interval_ms > 0 ? flush_interval_ms : 1;
+        if (!_log_ring) _log_ring = new mpsc_ring<string>(LOG_RING_SIZE);
+
+        _log_writer_stop = false;
+        _log_async_running = true;
+        _log_writer = thread(_log_writer_loop);
+    }
+
+    void disable_async_logging()
+    {
+        if (!_log_async_running) return;
+
+        // New text is written directly from here on. Text already being
+        // queued must reach the ring before the writer drains it a final
+        // time and stops, or it would be left behind.
+        _log_async_running = false;
+        while (_log_submitting.load() > 0)
+        {
+            _log_wake.notify_one();
+            std::this_thread::yield();
+        }
+
+        _log_writer_stop = true;
+        _log_wake.notify_one();
+        _log_writer.join();
+    }
+
+    bool async_logging_enabled()
+    {
+        return _log_async_running;
+    }
+
+    void flush_log()
+    {
+        if (_log_async_running)
+        {
+            // wait for the writer to finish a pass that started after this call
+            unsigned long start = _log_written.load(std::memory_order_acquire);
+            while (_log_async_running && _log_written.load(std::memory_order_acquire) < start + 2)
             {
-                write("FATAL: ");
+                _log_wake.notify_one();
+                std::this_thread::yield();
             }
-            else if (_log_mode == LOG_FILE_ONLY || _log_mode == LOG_CONSOLE_AND_FILE)
+        }
+
+        lock_guard<mutex> lock(_log_write_lock);
+        if (custom_log_file.is_open()) custom_log_file.flush();
+    }
+
+    void set_log_level(log_level level)
+    {
+        _log_level = level;
+    }
+
+    bool log_enabled(log_level level)
+    {
+        return _log_mode != LOG_NONE && _level_prefix(level) != nullptr;
+    }
+
+    void log(log_level level, const string &message)
+    {
+        const char *prefix = _level_prefix(level);
+        if (!prefix || _log_mode == LOG_NONE) return;
+
+        if (_log_mode == LOG_BINARY_FILE)
+        {
+            string record;
+            _put_bytes(record, LOG_BINARY_MESSAGE, 1);
+            _put_timestamp(record);
+            _put_bytes(record, static_cast<uint64_t>(level), 1);
+            _put_text(record, message);
+            _submit_log_text(std::move(record));
+            return;
+        }
+
+        string line;
+        line.reserve(strlen(prefix) + 26 + message.length());
+        line += prefix;
+        line += _log_timestamp();
+        line += " ";
+        line += message;
+        line += "\n";
+
+        _submit_log_text(std::move(line));
+    }
+
+    // Writes the text, or queues it for the writer when logging is asynchronous
+    static void _submit_log_text(string &&text)
+    {
+        // Counted before checking the flag, so disable_async_logging waits
+        // for this text to be queued before stopping the writer
+        _log_submitting.fetch_add(1);
+        if (_log_async_running.load())
+        {
+            // wait for the writer to make room, rather than drop the message
+            while (!_log_ring->try_push(std::move(text)))
             {
-                custom_log_file << "FATAL: ";
+                _log_wake.notify_one();
+                std::this_thread::yield();
             }
-            break;
+
+            if (_log_ring->size() > _log_ring->capacity() / 2)
+                _log_wake.notify_one();
+
+            _log_submitting.fetch_sub(1);
+            return;
         }
+        _log_submitting.fetch_sub(1);
 
-        auto time = std::chrono::system_clock::now();
-        std::time_t c_time = std::chrono::system_clock::to_time_t(time);
-        string str_time = std::ctime(&c_time);
-        // Required to remove the new line character ctime decides to add, then we add the log message
-        if (_log_mode == LOG_CONSOLE || _log_mode == LOG_CONSOLE_AND_FILE)
+        lock_guard<mutex> lock(_log_write_lock);
+        _write_log_text(text);
+    }
+
+    unsigned int register_log_format(const string &format)
+    {
+        unsigned int id;
         {
-            write(str_time.substr(0, str_time.length() - 1));
-            write(" ");
-            write_line(message);
+            lock_guard<mutex> lock(_log_formats_lock);
+            id = static_cast<unsigned int>(_log_formats.size());
+            _log_formats.push_back(format);
         }
-        else if (_log_mode == LOG_FILE_ONLY || _log_mode == LOG_CONSOLE_AND_FILE)
+
+        if (_log_mode == LOG_BINARY_FILE)
         {
-            custom_log_file << str_time.substr(0, str_time.length() - 1);
-            custom_log_file << " ";
-            custom_log_file << message + "\n";
+            _submit_log_text(_format_record(id, format));
         }
+
+        return id;
+    }
+
+    // Starts an event record, the args are added by the caller
+    static string _event_record(unsigned int format_id, int arg_count)
+    {
+        string result;
+        result.reserve(32);
+        _put_bytes(result, LOG_BINARY_EVENT, 1);
+        _put_bytes(result, format_id, 4);
+        _put_timestamp(result);
+        _put_bytes(result, arg_count, 1);
+        return result;
+    }
+
+    static void _put_arg(string &out, long long value)
+    {
+        _put_bytes(out, LOG_BINARY_INT, 1);
+        _put_bytes(out, static_cast<uint64_t>(value), 8);
+    }
+
+    static void _put_arg(string &out, double value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        _put_bytes(out, LOG_BINARY_DOUBLE, 1);
+        _put_bytes(out, bits, 8);
+    }
+
+    static void _put_arg(string &out, const string &value)
+    {
+        _put_bytes(out, LOG_BINARY_STRING, 1);
+        _put_text(out, value);
+    }
+
+    void log_event(unsigned int format_id)
+    {
+        if (_log_mode != LOG_BINARY_FILE) return;
+        _submit_log_text(_event_record(format_id, 0));
+    }
+
+    void log_event(unsigned int format_id, int value)
+    {
+        if (_log_mode != LOG_BINARY_FILE) return;
+        string record = _event_record(format_id, 1);
+        _put_arg(record, static_cast<long long>(value));
+        _submit_log_text(std::move(record));
+    }
+
+    void log_event(unsigned int format_id, double value)
+    {
+        if (_log_mode != LOG_BINARY_FILE) return;
+        string record = _event_record(format_id, 1);
+        _put_arg(record, value);
+        _submit_log_text(std::move(record));
+    }
+
+    void log_event(unsigned int format_id, const string &value)
+    {
+        if (_log_mode != LOG_BINARY_FILE) return;
+        string record = _event_record(format_id, 1);
+        _put_arg(record, value);
+        _submit_log_text(std::move(record));
+    }
+
+    void log_event(unsigned int format_id, int value1, int value2)
+    {
+        if (_log_mode != LOG_BINARY_FILE) return;
+        string record = _event_record(format_id, 2);
+        _put_arg(record, static_cast<long long>(value1));
+        _put_arg(record, static_cast<long long>(value2));
+        _submit_log_text(std::move(record));
+    }
+
+    void log_event(unsigned int format_id, double value1, double value2)
+    {
+        if (_log_mode != LOG_BINARY_FILE) return;
+        string record = _event_record(format_id, 2);
+        _put_arg(record, value1);
+        _put_arg(record, value2);
+        _submit_log_text(std::move(record));
     }
 
     void close_log_process()
     {
+        disable_async_logging();
+
+        lock_guard<mutex> lock(_log_write_lock);
         if (custom_log_file.is_open())
         {
             custom_log_file.close();
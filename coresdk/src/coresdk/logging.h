@@ -50,13 +50,15 @@ namespace splashkit_lib
      * @constant LOG_CONSOLE Ensure that output only directs to the on-screen, text-based console..
      * @constant LOG_FILE_ONLY Ensure that output only directs to a text file..
      * @constant LOG_CONSOLE_AND_FILE Direct ouput to both the console and a file.
+     * @constant LOG_BINARY_FILE Write compact binary records to a .sklog file, for use with `log_event`. Use the sklog_decode tool to read the file.
     */
     enum log_mode
     {
         LOG_NONE,
         LOG_CONSOLE,
         LOG_FILE_ONLY,
-        LOG_CONSOLE_AND_FILE
+        LOG_CONSOLE_AND_FILE,
+        LOG_BINARY_FILE
     };
     
     /**
@@ -83,8 +85,123 @@ namespace splashkit_lib
      * @param level         The level of the message to log
      * @param message     The message to be shown
      */
-    void log(log_level level, string message);
+    void log(log_level level, const string &message);
+
+    /**
+     * Sets the lowest level of message that `log` will write. Messages at
+     * lower levels are ignored, apart from those with no level.
+     *
+     * @param level The lowest level to write
+     */
+    void set_log_level(log_level level);
+
+    /**
+     * Checks if messages at the given level will be written. Use this to skip
+     * building messages that would not be logged, as in
+     * `if (log_enabled(DEBUG)) log(DEBUG, describe_state());`
+     *
+     * @param level The level of the message
+     * @returns     True if a message at this level would be written
+     */
+    bool log_enabled(log_level level);
     
+    /**
+     * Registers the text for an event that can be logged with `log_event`.
+     * Each `{}` in the format is replaced by one of the event's values when
+     * the binary log is decoded, so the text is only stored once.
+     *
+     * @param format The text of the event, such as "packet {} from {}"
+     * @returns      The id to pass to `log_event`
+     */
+    unsigned int register_log_format(const string &format);
+
+    /**
+     * Records an event in the binary log. Events are only written when the
+     * logger was started with `LOG_BINARY_FILE`.
+     *
+     * @param format_id The id from `register_log_format`
+     */
+    void log_event(unsigned int format_id);
+
+    /**
+     * Records an event with an integer value in the binary log.
+     *
+     * @param format_id The id from `register_log_format`
+     * @param value     The value for the format's placeholder
+     *
+     * @attribute suffix with_int
+     */
+    void log_event(unsigned int format_id, int value);
+
+    /**
+     * Records an event with a number in the binary log.
+     *
+     * @param format_id The id from `register_log_format`
+     * @param value     The value for the format's placeholder
+     *
+     * @attribute suffix with_double
+     */
+    void log_event(unsigned int format_id, double value);
+
+    /**
+     * Records an event with some text in the binary log.
+     *
+     * @param format_id The id from `register_log_format`
+     * @param value     The value for the format's placeholder
+     *
+     * @attribute suffix with_string
+     */
+    void log_event(unsigned int format_id, const string &value);
+
+    /**
+     * Records an event with two integer values in the binary log.
+     *
+     * @param format_id The id from `register_log_format`
+     * @param value1    The value for the format's first placeholder
+     * @param value2    The value for the format's second placeholder
+     *
+     * @attribute suffix with_ints
+     */
+    void log_event(unsigned int format_id, int value1, int value2);
+
+    /**
+     * Records an event with two numbers in the binary log.
+     *
+     * @param format_id The id from `register_log_format`
+     * @param value1    The value for the format's first placeholder
+     * @param value2    The value for the format's second placeholder
+     *
+     * @attribute suffix with_doubles
+     */
+    void log_event(unsigned int format_id, double value1, double value2);
+
+    /**
+     * Starts writing log messages on a background thread. Calls to `log` then
+     * only format and queue the message, and the thread writes the queued
+     * messages together, flushing the log file at the indicated interval.
+     *
+     * @param flush_interval_ms The most time, in milliseconds, before queued messages are written to the log file.
+     */
+    void enable_async_logging(int flush_interval_ms);
+
+    /**
+     * Writes any queued messages, and returns to writing each message as it
+     * is logged.
+     */
+    void disable_async_logging();
+
+    /**
+     * Checks if log messages are being written on a background thread.
+     *
+     * @returns True after `enable_async_logging` has been called.
+     */
+    bool async_logging_enabled();
+
+    /**
+     * Waits for queued log messages to be written, and flushes the log file.
+     */
+    void flush_log();
+
     /**
      * Ensures propper memory clean-up prior to exit, if needed.  Used in sk_init_looging ().
      */
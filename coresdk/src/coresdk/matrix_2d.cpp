@@ -8,6 +8,7 @@
 
 #include "matrix_2d.h"
 
+#include "geometry.h"
 #include "point_geometry.h"
 #include "utility_functions.h"
 
@@ -89,15 +90,29 @@ namespace splashkit_lib
 
     matrix_2d rotation_matrix(double deg)
     {
-        double rads = deg_to_rad(-deg);
+        double c, s;
+
+        if ( fast_trigonometry() )
+        {
+            float fs, fc;
+            sine_and_cosine(-deg, fs, fc);
+            s = fs;
+            c = fc;
+        }
+        else
+        {
+            double rads = deg_to_rad(-deg);
+            c = cos(rads);
+            s = sin(rads);
+        }
 
         matrix_2d result;
-        result.elements[0][0] = cos(rads);
-        result.elements[0][1] = sin(rads);
+        result.elements[0][0] = c;
+        result.elements[0][1] = s;
         result.elements[0][2] = 0;
 
-        result.elements[1][0] = -sin(rads);
-        result.elements[1][1] = cos(rads);
+        result.elements[1][0] = -s;
+        result.elements[1][1] = c;
         result.elements[1][2] = 0;
 
         result.elements[2][0] = 0;
@@ -243,4 +258,62 @@ namespace splashkit_lib
             q.points[i] = matrix_multiply(m, q.points[i]);
         }
     }
+
+    //
+    // Transform n points, as matrix_multiply does. Only the top two rows of
+    // the matrix are used, so the coefficients are read once and the loop
+    // has no calls or branches for the compiler to vectorise around.
+    //
+    static void _apply_affine(const matrix_2d &m, const point_2d *src, point_2d *dst, size_t n)
+    {
+        const double a = m.elements[0][0], b = m.elements[0][1], tx = m.elements[0][2];
+        const double c = m.elements[1][0], d = m.elements[1][1], ty = m.elements[1][2];
+
+        for (size_t i = 0; i < n; i++)
+        {
+            double x = src[i].x, y = src[i].y;
+            dst[i].x = x * a + y * b + tx;
+            dst[i].y = x * c + y * d + ty;
+        }
+    }
+
+    void apply_matrix(const matrix_2d &m, vector<point_2d> &pts)
+    {
+        _apply_affine(m, pts.data(), pts.data(), pts.size());
+    }
+
+    void apply_matrix(const matrix_2d &m, const vector<point_2d> &pts, vector<point_2d> &out_result)
+    {
+        out_result.resize(pts.size());
+        _apply_affine(m, pts.data(), out_result.data(), pts.size());
+    }
+
+    void apply_matrix(const matrix_2d &m, vector<double> &xs, vector<double> &ys)
+    {
+        if ( xs.size() != ys.size() )
+        {
+            LOG(WARNING) << "apply_matrix needs the same number of x and y values";
+            return;
+        }
+
+        const double a = m.elements[0][0], b = m.elements[0][1], tx = m.elements[0][2];
+        const double c = m.elements[1][0], d = m.elements[1][1], ty = m.elements[1][2];
+        double *x = xs.data(), *y = ys.data();
+        const size_t n = xs.size();
+
+        for (size_t i = 0; i < n; i++)
+        {
+            double px = x[i], py = y[i];
+            x[i] = px * a + py * b + tx;
+            y[i] = px * c + py * d + ty;
+        }
+    }
+
+    void apply_matrix(const matrix_2d &m, vector<quad> &quads)
+    {
+        for (quad &q : quads)
+        {
+            _apply_affine(m, q.points, q.points, 4);
+        }
+    }
 }
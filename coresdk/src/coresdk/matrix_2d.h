@@ -189,6 +189,53 @@ namespace splashkit_lib
      */
     void apply_matrix(const matrix_2d &matrix, quad &q);
 
+    /**
+     * Use a matrix to transform all of the points, in place. This is much
+     * faster than transforming each point with its own call.
+     *
+     * @param matrix    The matrix with the transformations needed.
+     * @param pts       The points to transform.
+     *
+     * @attribute suffix  to_points
+     */
+    void apply_matrix(const matrix_2d &matrix, vector<point_2d> &pts);
+
+    /**
+     * Use a matrix to transform all of the points, leaving the original
+     * points unchanged.
+     *
+     * @param matrix        The matrix with the transformations needed.
+     * @param pts           The points to transform.
+     * @param out_result    After the call, this holds the transformed points.
+     *                      Its storage is reused between calls.
+     *
+     * @attribute suffix  to_points_into
+     */
+    void apply_matrix(const matrix_2d &matrix, const vector<point_2d> &pts, vector<point_2d> &out_result);
+
+    /**
+     * Use a matrix to transform points whose x and y values are kept in
+     * separate lists, in place. Keeping the values apart like this lets the
+     * transform process several points at once.
+     *
+     * @param matrix    The matrix with the transformations needed.
+     * @param xs        The x value of each point.
+     * @param ys        The y value of each point, must be the same length as `xs`.
+     *
+     * @attribute suffix  to_coordinates
+     */
+    void apply_matrix(const matrix_2d &matrix, vector<double> &xs, vector<double> &ys);
+
+    /**
+     * Use a matrix to transform all of the points in each of the quads.
+     *
+     * @param matrix    The matrix with the transformations needed.
+     * @param quads     The quads to transform.
+     *
+     * @attribute suffix  to_quads
+     */
+    void apply_matrix(const matrix_2d &matrix, vector<quad> &quads);
+
     /**
      * This function returns a string representation of a Matrix.
      *
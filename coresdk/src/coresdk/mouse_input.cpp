@@ -144,4 +144,39 @@ namespace splashkit_lib
         return sk_show_mouse(-1);
     }
     
+
+    void set_mouse_sampling(bool sample)
+    {
+        sk_set_pointer_sampling(sample);
+    }
+
+    bool mouse_sampling()
+    {
+        return sk_pointer_sampling();
+    }
+
+    vector<mouse_sample> mouse_samples()
+    {
+        const vector<sk_pointer_sample> &samples = sk_pointer_samples();
+
+        vector<mouse_sample> result;
+        result.reserve(samples.size());
+
+        for (const sk_pointer_sample &sample : samples)
+        {
+            result.push_back({sample.timestamp, point_at(sample.x, sample.y), vector_to(sample.xrel, sample.yrel)});
+        }
+
+        return result;
+    }
+
+    bool set_relative_mouse_mode(bool relative)
+    {
+        return sk_set_relative_mouse_mode(relative);
+    }
+
+    bool relative_mouse_mode()
+    {
+        return sk_relative_mouse_mode();
+    }
 }
@@ -8,6 +8,10 @@
 #define mouse_input_h
 
 #include "geometry.h"
+
+#include <vector>
+using std::vector;
+
 namespace splashkit_lib
 {
     /**
@@ -32,6 +36,21 @@ namespace splashkit_lib
         MOUSE_X2_BUTTON
     };
 
+    /**
+     * The position of the mouse when it moved, taken from one of the motion
+     * events read by `process_events`.
+     *
+     * @field time      When the mouse moved, in milliseconds since SplashKit started
+     * @field position  The position of the mouse in the window it moved in
+     * @field movement  How far the mouse moved since the previous sample
+     */
+    struct mouse_sample
+    {
+        unsigned int time;
+        point_2d position;
+        vector_2d movement;
+    };
+
     /**
      * Returns The current window position of the mouse as a `Vector`
      *
@@ -70,6 +89,51 @@ namespace splashkit_lib
      */
     vector_2d mouse_movement();
 
+    /**
+     * Starts or stops keeping every mouse movement read by `process_events`.
+     * Normally only the mouse position at the end of each frame can be read.
+     * With sampling on, `mouse_samples` returns each position the mouse moved
+     * through, so a fast mouse can draw smooth strokes.
+     *
+     * @param sample  True to keep the mouse movements of each frame
+     */
+    void set_mouse_sampling(bool sample);
+
+    /**
+     * Checks if the mouse movements of each frame are being kept.
+     *
+     * @returns True if mouse sampling has been turned on
+     */
+    bool mouse_sampling();
+
+    /**
+     * Returns the mouse movements read by the last call to `process_events`,
+     * oldest first. This is empty unless `set_mouse_sampling` has been
+     * turned on.
+     *
+     * @returns The mouse movements of the last frame
+     */
+    vector<mouse_sample> mouse_samples();
+
+    /**
+     * Turns relative mouse mode on or off. In relative mode the cursor is
+     * hidden and held in the window, and `mouse_movement` and the sample
+     * movements keep reporting motion even when the cursor would have
+     * reached the edge of the screen. This suits games that use the mouse
+     * to turn a camera.
+     *
+     * @param relative  True to turn relative mode on
+     * @returns         True if the mode could be changed
+     */
+    bool set_relative_mouse_mode(bool relative);
+
+    /**
+     * Checks if relative mouse mode is on.
+     *
+     * @returns True if the mouse is in relative mode
+     */
+    bool relative_mouse_mode();
+
     /**
      * Returns the amount the mouse wheel was scrolled since the last call
      * to `process_events`. The result is a vector containing the x and y
@@ -12,11 +12,12 @@
 #include "backend_types.h"
 #include "utility_functions.h"
 #include "music.h"
+#include "resource_registry.h"
 
 #include <map>
 namespace splashkit_lib
 {
-    static map<string, music> _music;
+    static resource_registry<music> _music;
 
     // While this is the same as sound data..
     // we want the compiler to make them different!
@@ -27,6 +28,8 @@ namespace splashkit_lib
         string filename, name;
     };
 
+    music _register_loaded_music(const string &name, const string &file_path, sk_sound_data data);
+
     music load_music(const string &name, const string &filename)
     {
         if ( ! audio_ready() )
@@ -49,24 +52,38 @@ namespace splashkit_lib
             }
         }
 
+        sk_sound_data data = sk_load_sound_data(file_path, SGSD_MUSIC);
+
+        // Unable to load sound effect
+        if ( ! data._data )
+        {
+            LOG(WARNING) << cat({ "Error loading sound data for ", name, " (", file_path, ")"});
+            return nullptr;
+        }
+
+        return _register_loaded_music(name, file_path, data);
+    }
+
+    // Wrap loaded music data and register it. Used by load_music and by
+    // bundles, which open music on worker threads.
+    music _register_loaded_music(const string &name, const string &file_path, sk_sound_data data)
+    {
         music result = new _music_data();
 
         result->id = MUSIC_PTR;
         result->filename = file_path;
         result->name = name;
-        result->audio = sk_load_sound_data(file_path, SGSD_MUSIC);
+        result->audio = data;
 
-        // Unable to load sound effect
-        if ( ! result->audio._data )
+        // Another thread may have loaded the same name in the meantime
+        music registered = _music.insert(name, result);
+        if ( registered != result )
         {
+            sk_close_sound_data(&result->audio);
             result->id = NONE_PTR;
             delete result;
-            LOG(WARNING) << cat({ "Error loading sound data for ", name, " (", file_path, ")"});
-            return nullptr;
         }
-
-        _music[name] = result;
-        return result;
+        return registered;
     }
 
     void free_music(music effect)
@@ -89,12 +106,12 @@ namespace splashkit_lib
     void free_all_music()
     {
         string name;
+        music effect;
 
         size_t sz = _music.size();
 
-        for(size_t i = 0; i < sz; i++)
+        for(size_t i = 0; i < sz && _music.first(name, effect); i++)
         {
-            music effect = _music.begin()->second;
             if (VALID_PTR(effect, MUSIC_PTR))
             {
                 free_music(effect);
@@ -102,7 +119,7 @@ namespace splashkit_lib
             else
             {
                 LOG(WARNING) << "Music contained an invalid pointer";
-                _music.erase(_music.begin());
+                _music.erase(name);
             }
         }
     }
@@ -114,13 +131,14 @@ namespace splashkit_lib
 
     bool has_music(const string &name)
     {
-        return _music.count(name) > 0;
+        return _music.contains(name);
     }
 
     music music_named(const string &name)
     {
-        if (has_music(name))
-            return _music[name];
+        music result = _music.find(name);
+        if (result)
+            return result;
         else
         {
             string filename = path_to_resource(name, MUSIC_RESOURCE);
@@ -1,12 +1,23 @@
 #include <sstream>
 #include <cmath>
 #include <iomanip>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <zlib.h>
 
 #include "easylogging++.h"
 
 #include "networking.h"
 #include "network_driver.h"
+#include "profiling_driver.h"
+#include "utils_driver.h"
 #include "utility_functions.h"
+#include "resource_tracking.h"
 
 using std::endl;
 using std::stringstream;
@@ -15,20 +26,115 @@ using std::uppercase;
 using std::hex;
 using std::setw;
 using std::setfill;
+using std::deque;
 
 namespace splashkit_lib
 {
-    #define PACKET_SIZE 512
     static unsigned int UDP_PACKET_SIZE = 1024;
+    // Datagrams read from a UDP socket at once, and the most batches read
+    // each time the socket is checked
+    #define UDP_READ_BATCH 64
+    #define UDP_READ_BATCHES 16
+    // Limits on the size of each TCP connection's read buffer, before it
+    // grows to fit a larger message
+    #define TCP_READ_BUFFER_MIN 4096
+    #define TCP_READ_BUFFER_MAX (1024 * 1024)
+    // The largest TCP message accepted, so a bad length header from a peer
+    // cannot make the read buffer grow without limit
+    #define TCP_MESSAGE_MAX (16UL * 1024 * 1024)
 
-
-    typedef char packet_data[PACKET_SIZE];
     typedef unsigned char byte;
 
-    static map<string, connection> _connections;
+    static std::unordered_map<string, connection> _connections;
     static map<string, server_socket> _server_sockets;
+    static map<string, udp_endpoint> _udp_endpoints;     // keyed by name_for_connection
+    static sk_network_connection _endpoint_socket = { NONE_PTR, UNKNOWN, nullptr };
+    static unsigned long _default_send_queue_limit = 0;
+    static send_queue_policy _default_send_policy = DROP_NEW_MESSAGES;
+    static connection_compression _default_compression = NO_COMPRESSION;
     static vector<message> _messages;
 
+    // Background network thread, reading messages into the incoming queues.
+    // The lock is held while it reads, and while sockets close or reconnect.
+    static thread _network_thread;
+    static atomic<bool> _network_thread_active(false);
+    static std::recursive_mutex _network_io_lock;
+    static thread_local bool _on_network_thread = false;
+
+    typedef std::lock_guard<std::recursive_mutex> _network_io_guard;
+
+    //
+    // Accepted connections can be shared out between more network threads,
+    // each waiting on its own poll set (shard). A shard's thread reads its
+    // connections holding only that shard's lock, so shards read in
+    // parallel. Closing or reconnecting a connection takes the network lock
+    // and then its shard's lock. Shard 0 is read by the main network thread,
+    // which also accepts connections.
+    //
+    #define MAX_NETWORK_SHARDS 64
+    static vector<thread> _shard_threads;
+    static std::recursive_mutex _shard_locks[MAX_NETWORK_SHARDS];
+    static int _shard_count = 1;
+    static unsigned int _next_shard = 0;
+    static thread_local int _network_shard = 0;     // the shard read by this thread
+
+    // A shard thread may still hold a closed connection from its last wait,
+    // so connections closed while shards run are freed by their shard's
+    // thread before it waits again. Each list is guarded by its shard's lock.
+    static vector<connection> _retired_connections[MAX_NETWORK_SHARDS];
+
+    // Connections whose peer closed them, found by a shard thread, which
+    // are shut by the network thread as that needs the network lock
+    static vector<connection> _peer_closed_connections[MAX_NETWORK_SHARDS];
+
+    static std::recursive_mutex &_shard_lock_for(connection con)
+    {
+        return _shard_locks[con->shard];
+    }
+
+    // Accepted connections go to the extra shards in turn
+    static int _pick_shard()
+    {
+        if ( _shard_count <= 1 ) return 0;
+        return 1 + static_cast<int>(_next_shard++ % (_shard_count - 1));
+    }
+
+    static unsigned long long _now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Messages read on the network thread are queued for the game thread
+    // The memory a message holds, counted for its connection until it is read
+    static size_t _message_bytes(message m)
+    {
+        return sizeof(sk_message) + m->data.size();
+    }
+
+    static void _deliver_message(deque<message> &messages, spsc_queue<message> &incoming, message m, network_stats &stats, std::atomic<size_t> *held_bytes = nullptr)
+    {
+        m->arrived = _now_ns();
+        stats.messages_in++;
+        if (held_bytes) *held_bytes += _message_bytes(m);
+
+        if (_on_network_thread)
+        {
+            incoming.push(m);
+            sk_signal_activity();
+        }
+        else
+            messages.push_back(m);
+    }
+
+    static void _take_incoming(deque<message> &messages, spsc_queue<message> &incoming)
+    {
+        message m;
+        while (incoming.try_pop(m))
+        {
+            messages.push_back(m);
+        }
+    }
+
     server_socket create_server(const string &name, unsigned short int port, connection_type protocol)
     {
         sk_network_connection con;
@@ -54,6 +160,11 @@ namespace splashkit_lib
             socket->port = port;
             socket->new_connections = 0;
             socket->protocol = protocol;
+            socket->stats = network_stats();
+
+            // UDP servers receive messages directly, TCP servers are ready
+            // when there are connections to accept
+            sk_watch_connection(&socket->socket, socket);
 
             _server_sockets.insert({name, socket});
 
@@ -80,6 +191,8 @@ namespace splashkit_lib
         return nullptr;
     }
 
+    static void _forget_reliable_peers(connection con, server_socket svr);
+
     bool close_server(server_socket svr)
     {
         if (INVALID_PTR(svr, SERVER_SOCKET_PTR))
@@ -88,14 +201,17 @@ namespace splashkit_lib
             return false;
         }
 
+        _network_io_guard lock(_network_io_lock);
         clear_messages(svr);
 
-        for(auto connection : svr->connections)
+        // closing a connection takes it out of the list
+        while ( ! svr->connections.empty() )
         {
-            close_connection(connection);
+            close_connection(svr->connections.back());
         }
 
         // close the socket
+        _forget_reliable_peers(nullptr, svr);
         sk_close_connection(&svr->socket);
         _server_sockets.erase(svr->name);
 
@@ -149,21 +265,184 @@ namespace splashkit_lib
         return false;
     }
 
+    static void _add_stats(network_stats &total, const network_stats &stats)
+    {
+        total.bytes_in += stats.bytes_in;
+        total.bytes_out += stats.bytes_out;
+        total.messages_in += stats.messages_in;
+        total.messages_out += stats.messages_out;
+        total.queue_depth += stats.queue_depth;
+        total.max_queue_latency = std::max(total.max_queue_latency, stats.max_queue_latency);
+        total.partial_frames += stats.partial_frames;
+        total.send_queue_bytes += stats.send_queue_bytes;
+        total.messages_resent += stats.messages_resent;
+    }
+
+    //
+    // Every connection has a slot, giving it a number that finds it without
+    // a search. The number includes the slot's generation, so the number of
+    // a closed connection is not mistaken for the one that reuses its slot.
+    //
+    #define CONNECTION_SLOT_BITS 20
+    #define CONNECTION_SLOT_MASK ((1u << CONNECTION_SLOT_BITS) - 1)
+    #define CONNECTION_GENERATION_MASK ((1u << (32 - CONNECTION_SLOT_BITS)) - 1)
+
+    static vector<connection> _connection_slots;
+    static vector<unsigned int> _connection_generations;
+    static vector<unsigned int> _free_connection_slots;
+
+    static void _assign_connection_slot(connection con)
+    {
+        unsigned int slot;
+        if ( ! _free_connection_slots.empty() )
+        {
+            slot = _free_connection_slots.back();
+            _free_connection_slots.pop_back();
+        }
+        else
+        {
+            slot = static_cast<unsigned int>(_connection_slots.size());
+            _connection_slots.push_back(nullptr);
+            _connection_generations.push_back(1);
+        }
+
+        _connection_slots[slot] = con;
+        con->number = (_connection_generations[slot] << CONNECTION_SLOT_BITS) | slot;
+    }
+
+    static void _release_connection_slot(connection con)
+    {
+        unsigned int slot = con->number & CONNECTION_SLOT_MASK;
+
+        // skip generation 0, so no connection is ever numbered 0
+        unsigned int generation = (_connection_generations[slot] + 1) & CONNECTION_GENERATION_MASK;
+        _connection_generations[slot] = generation == 0 ? 1 : generation;
+
+        _connection_slots[slot] = nullptr;
+        _free_connection_slots.push_back(slot);
+    }
+
+    // Free a connection that has been taken out of the network's lists
+    static void _delete_connection(connection con)
+    {
+        notify_of_free(con);
+        _forget_reliable_peers(con, nullptr);
+        _release_connection_slot(con);
+        con->id = NONE_PTR;
+
+        if ( con->shard > 0 && _network_thread_active )
+        {
+            _network_io_guard shard_lock(_shard_lock_for(con));
+            erase_from_vector(_peer_closed_connections[con->shard], con);
+            _retired_connections[con->shard].push_back(con);
+            return;
+        }
+
+        delete con;
+    }
+
+    // Called with the shard's lock held, when the shard's thread holds no
+    // connections from a wait
+    static void _free_retired_connections(int shard)
+    {
+        for (connection con : _retired_connections[shard]) delete con;
+        _retired_connections[shard].clear();
+    }
+
+    // Take a connection out of its server's list by moving another into its
+    // place. New connections are kept at the end of the list, so a connection
+    // taken from the older part is replaced by the last of the older ones.
+    static void _remove_from_server(server_socket svr, connection con)
+    {
+        vector<connection> &list = svr->connections;
+        unsigned int idx = con->server_index;
+        unsigned int count = static_cast<unsigned int>(list.size());
+        unsigned int first_new = count - std::min<unsigned int>(svr->new_connections, count);
+
+        auto move_to = [&list] (unsigned int from, unsigned int to)
+        {
+            list[to] = list[from];
+            list[to]->server_index = to;
+        };
+
+        if ( idx >= first_new )
+        {
+            svr->new_connections--;
+        }
+        else if ( first_new < count )
+        {
+            // keep the older connections together before the new ones
+            move_to(first_new - 1, idx);
+            idx = first_new - 1;
+        }
+
+        move_to(count - 1, idx);
+        list.pop_back();
+        con->server = nullptr;
+    }
+
+    unsigned int connection_id(connection a_connection)
+    {
+        if ( INVALID_PTR(a_connection, CONNECTION_PTR) )
+        {
+            LOG(WARNING) << "Invalid connection passed to connection_id";
+            return 0;
+        }
+
+        return a_connection->number;
+    }
+
+    connection connection_with_id(unsigned int id)
+    {
+        unsigned int slot = id & CONNECTION_SLOT_MASK;
+
+        _network_io_guard lock(_network_io_lock);
+        if ( slot >= _connection_slots.size() ) return nullptr;
+
+        connection result = _connection_slots[slot];
+        if ( result && result->number == id ) return result;
+        return nullptr;
+    }
+
     connection _create_connection(const string& name, connection_type protocol)
     {
         connection result = new sk_connection_data;
 
         result->id = CONNECTION_PTR;
+        result->server = nullptr;
+        result->server_index = 0;
+        result->shard = 0;
+        _assign_connection_slot(result);
         result->name = name;
         result->ip = 0;
         result->string_ip = "";
         result->port = 0;
         result->protocol = protocol;
-        //result->part_msg_data is empty
-        result->expected_msg_len = -1;
+        result->read_start = 0;
+        result->read_end = 0;
         result->open = true;
         result->socket._socket = nullptr;
         result->socket.kind = UNKNOWN;
+        result->endpoint = nullptr;
+        result->send_offset = 0;
+        result->send_queue_bytes = 0;
+        result->read_buffer_bytes = 0;
+        result->message_bytes = 0;
+        result->send_queue_limit = _default_send_queue_limit;
+        result->send_policy = _default_send_policy;
+        result->coalesce_sends = false;
+        result->compression = _default_compression;
+        result->compression_offered = false;
+        result->peer_reads_compression = false;
+        result->compression_answer_due = false;
+        result->bytes_before_compression = 0;
+        result->bytes_after_compression = 0;
+        result->stats = network_stats();
+
+        _count_resource(result, NETWORK_RESOURCE, [result](size_t &cpu, size_t &gpu)
+        {
+            cpu = sizeof(sk_connection_data) + result->read_buffer_bytes + result->send_queue_bytes + result->message_bytes;
+        });
 
         return result;
     }
@@ -174,6 +453,11 @@ namespace splashkit_lib
         con->port = port;
         con->protocol = protocol;
 
+        // The peer may not be the one compression was agreed with
+        con->compression_offered = false;
+        con->peer_reads_compression = false;
+        con->compression_answer_due = false;
+
         if (protocol == TCP)
         {
             con->socket = sk_open_tcp_connection(host.c_str(), port);
@@ -181,6 +465,8 @@ namespace splashkit_lib
         else if (protocol == UDP)
         {
             con->socket = sk_open_udp_connection(0);
+            // resolve now, so each send goes straight to the address
+            con->endpoint = resolve_endpoint(host, port);
         }
         else
         {
@@ -194,6 +480,7 @@ namespace splashkit_lib
         }
 
         con->ip = sk_network_address(&con->socket);
+        sk_watch_connection(&con->socket, con);
 
         return true;
     }
@@ -220,24 +507,63 @@ namespace splashkit_lib
         else
         {
             LOG(ERROR) << "Could not establish connection at open_connection after calling _establish_connection";
-            delete con;
+            _delete_connection(con);
             return nullptr;
         }
     }
 
-    void shut_connection(connection con)
+    // How long closing a connection waits for its queued messages to send
+    #define SEND_QUEUE_CLOSE_WAIT_MS 500
+
+    bool _flush_send_queue(connection con);
+
+    // Send what is queued for the connection, including coalesced messages,
+    // before it is closed. Waits up to SEND_QUEUE_CLOSE_WAIT_MS for the
+    // socket to take it, and reports what could not be sent.
+    static void _drain_send_queue(connection con)
     {
-        if ( INVALID_PTR(con, CONNECTION_PTR))
+        auto give_up = std::chrono::steady_clock::now() + std::chrono::milliseconds(SEND_QUEUE_CLOSE_WAIT_MS);
+
+        while ( con->open && ! con->send_queue.empty() )
         {
-            LOG(WARNING) << "Attempting to shut invalid connection";
-            return;
+            if ( ! _flush_send_queue(con) ) break;
+            if ( con->send_queue.empty() || std::chrono::steady_clock::now() >= give_up ) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
 
+        if ( con->send_queue_bytes > 0 )
+            LOG(WARNING) << "Closing connection " << con->name << " with " << con->send_queue_bytes.load() << " bytes still to send -- messages dropped";
+    }
+
+    // Close the connection's socket, first sending what is queued unless
+    // the connection failed or is being dropped for sending too slowly
+    static void _shut_connection(connection con, bool send_queued)
+    {
+        _network_io_guard lock(_network_io_lock);
+        _network_io_guard shard_lock(_shard_lock_for(con));
         if (con->open)
         {
+            if ( send_queued ) _drain_send_queue(con);
+
             con->open = false;
             sk_close_connection(&con->socket);
         }
+
+        con->send_queue.clear();
+        con->send_offset = 0;
+        con->send_queue_bytes = 0;
+        con->read_start = con->read_end = 0;
+    }
+
+    void shut_connection(connection con)
+    {
+        if ( INVALID_PTR(con, CONNECTION_PTR))
+        {
+            LOG(WARNING) << "Attempting to shut invalid connection";
+            return;
+        }
+
+        _shut_connection(con, true);
     }
 
     bool has_connection(const string &name)
@@ -275,36 +601,25 @@ namespace splashkit_lib
         }
 
         bool result = false;
+        _network_io_guard lock(_network_io_lock);
+        std::unique_lock<std::recursive_mutex> shard_lock(_shard_lock_for(con));
         clear_messages(con);
         shut_connection(con);
 
-        if (_connections.find(con->name) != _connections.end())
+        if (con->server)
         {
-            _connections.erase(con->name);
-            con->id = NONE_PTR;
-            delete con;
+            // keep the closed connection's traffic in the server's totals
+            _add_stats(con->server->stats, con->stats);
+            _remove_from_server(con->server, con);
+            shard_lock.unlock();
+            _delete_connection(con);
             result = true;
         }
-        else
+        else if (_connections.erase(con->name) > 0)
         {
-            for (auto sock : _server_sockets)
-            {
-                server_socket s = sock.second;
-                int idx = index_of(s->connections, con);
-
-                if (idx > -1)
-                {
-                    if ( idx >= s->connections.size() - s->new_connections )
-                    {
-                        s->new_connections--;
-                    }
-                    
-                    result = true;
-                    con->id = NONE_PTR;
-                    delete con;
-                    s->connections.erase(s->connections.begin() + idx);
-                }
-            }
+            shard_lock.unlock();
+            _delete_connection(con);
+            result = true;
         }
 
         return result;
@@ -423,7 +738,21 @@ namespace splashkit_lib
             return false;
         }
 
-        sk_network_connection con = sk_accept_connection(server->socket);
+        sk_network_connection con;
+        con._socket = nullptr;
+        con.kind = UNKNOWN;
+
+        // take a connection the network thread has already accepted
+        {
+            lock_guard<mutex> lock(server->accept_lock);
+            if ( ! server->pending_accepts.empty() )
+            {
+                con = server->pending_accepts.front();
+                server->pending_accepts.erase(server->pending_accepts.begin());
+            }
+        }
+
+        if ( ! con._socket ) con = sk_accept_connection(server->socket);
 
         if (con._socket && (con.kind == TCP))
         {
@@ -435,7 +764,11 @@ namespace splashkit_lib
             client->string_ip = ipv4_to_str(ip);
             client->port = port;
             client->socket = con;
+            client->shard = _pick_shard();
+            sk_watch_connection_on(&client->socket, client, client->shard);
 
+            client->server = server;
+            client->server_index = static_cast<unsigned int>(server->connections.size());
             server->connections.push_back(client);
             server->new_connections++;
 
@@ -450,9 +783,11 @@ namespace splashkit_lib
     {
         bool result = false;
 
+        // accept everything waiting, up to a limit for each server so that a
+        // flood of connections cannot stall the game
         for (auto it : _server_sockets)
         {
-            if (accept_new_connection(it.second))
+            for (int i = 0; i < 256 && accept_new_connection(it.second); i++)
             {
                 result = true;
             }
@@ -512,14 +847,106 @@ namespace splashkit_lib
         string host = con->string_ip;
         unsigned short port = con->port;
 
-        sk_close_connection(&con->socket);
+        _network_io_guard lock(_network_io_lock);
+        _network_io_guard shard_lock(_shard_lock_for(con));
+        _shut_connection(con, true);
         con->open = _establish_connection(con, host, port, con->protocol);
     }
 
     void release_all_connections()
     {
+        stop_network_thread();
         close_all_connections();
         close_all_servers();
+        release_all_endpoints();
+    }
+
+    udp_endpoint resolve_endpoint(const string &host, unsigned short int port)
+    {
+        string key = name_for_connection(host, port);
+
+        _network_io_guard lock(_network_io_lock);
+        auto it = _udp_endpoints.find(key);
+        if ( it != _udp_endpoints.end() ) return it->second;
+
+        unsigned int address;
+        unsigned short address_port;
+        if ( ! sk_resolve_address(host.c_str(), port, &address, &address_port) )
+        {
+            LOG(WARNING) << "Unable to resolve address of " << key;
+            return nullptr;
+        }
+
+        udp_endpoint result = new sk_udp_endpoint_data;
+        result->id = UDP_ENDPOINT_PTR;
+        result->host = host;
+        result->port = port;
+        result->address = address;
+        result->address_port = address_port;
+
+        _udp_endpoints[key] = result;
+        return result;
+    }
+
+    string endpoint_host(udp_endpoint ep)
+    {
+        if ( INVALID_PTR(ep, UDP_ENDPOINT_PTR) )
+        {
+            LOG(WARNING) << "Invalid udp_endpoint passed to endpoint_host";
+            return "";
+        }
+
+        return ep->host;
+    }
+
+    unsigned short int endpoint_port(udp_endpoint ep)
+    {
+        if ( INVALID_PTR(ep, UDP_ENDPOINT_PTR) )
+        {
+            LOG(WARNING) << "Invalid udp_endpoint passed to endpoint_port";
+            return 0;
+        }
+
+        return ep->port;
+    }
+
+    // Endpoints are sent to from one shared socket, opened when first needed
+    static bool _open_endpoint_socket()
+    {
+        if ( _endpoint_socket._socket ) return true;
+
+        _endpoint_socket = sk_open_udp_connection(0);
+        if ( ! _endpoint_socket._socket )
+        {
+            LOG(ERROR) << "Unable to open a UDP socket to send to endpoints";
+            return false;
+        }
+        return true;
+    }
+
+    void release_all_endpoints()
+    {
+        _network_io_guard lock(_network_io_lock);
+
+        // UDP connections hold on to their endpoint, so forget them too
+        for (auto const &con: _connections)
+        {
+            con.second->endpoint = nullptr;
+        }
+
+        for (auto const &ep: _udp_endpoints)
+        {
+            ep.second->id = NONE_PTR;
+            delete ep.second;
+        }
+        _udp_endpoints.clear();
+
+        if ( _endpoint_socket._socket )
+        {
+            sk_close_connection(&_endpoint_socket);
+            _endpoint_socket._socket = nullptr;
+            _endpoint_socket.kind = UNKNOWN;
+        }
     }
 
     connection message_connection(message msg)
@@ -530,6 +957,18 @@ namespace splashkit_lib
             return nullptr;
         }
 
+        // the sender may have closed since the message arrived
+        return msg->connection ? connection_with_id(msg->connection) : nullptr;
+    }
+
+    unsigned int message_connection_id(message msg)
+    {
+        if ( INVALID_PTR(msg, MESSAGE_PTR))
+        {
+            LOG(WARNING) << "Attempting to get connection id of invalid message";
+            return 0;
+        }
+
         return msg->connection;
     }
 
@@ -543,145 +982,800 @@ namespace splashkit_lib
         UDP_PACKET_SIZE = udp_packet_size;
     }
 
-    void _enqueue_tcp_message(const vector<int8_t> &message, connection con)
+    //
+    // The data buffers of closed messages are kept for reuse, so a busy
+    // connection does not allocate a buffer for every message it receives.
+    // Each message is itself new, so a handle to a closed message never
+    // becomes valid again. Messages are created on the network thread and
+    // closed on the game thread, so the pool is locked.
+    //
+    #define MESSAGE_POOL_SIZE 1024
+    static vector<vector<int8_t>> _message_buffer_pool;
+    static mutex _message_pool_lock;
+
+    message _alloc_message()
+    {
+        message m = new sk_message;
+
+        lock_guard<mutex> lock(_message_pool_lock);
+        if ( ! _message_buffer_pool.empty() )
+        {
+            m->data.swap(_message_buffer_pool.back());
+            _message_buffer_pool.pop_back();
+        }
+
+        return m;
+    }
+
+    void _recycle_message(message m)
+    {
+        m->id = NONE_PTR;
+        m->data.clear();
+
+        {
+            lock_guard<mutex> lock(_message_pool_lock);
+            if (_message_buffer_pool.size() < MESSAGE_POOL_SIZE)
+                _message_buffer_pool.push_back(std::move(m->data));
+        }
+
+        delete m;
+    }
+
+    void _enqueue_tcp_message(const int8_t *data, unsigned long size, connection con)
     {
-        sk_message* m = new sk_message;
+        sk_message* m = _alloc_message();
 
         m->id = MESSAGE_PTR;
-        m->data = message;
+        m->data.assign(data, data + size);
         m->protocol = TCP;
-        m->connection = con;
+        m->channel = -1;
+        m->connection = con->number;
         m->host = con->string_ip;
         m->port = con->port;
 
-        con->messages.push_back(m);
-        con->expected_msg_len = -1;
-        con->part_msg_data.clear();
+        _deliver_message(con->messages, con->incoming, m, con->stats, &con->message_bytes);
     }
 
-    void _enqueue_udp_message(vector<sk_message*> &messages, const char* msg, unsigned long size, unsigned int host, int port)
+    void _enqueue_udp_message(deque<sk_message*> &messages, spsc_queue<sk_message*> &incoming, network_stats &stats, const char* msg, unsigned long size, unsigned int host, int port, int channel = -1, std::atomic<size_t> *held_bytes = nullptr)
     {
-        message m = new sk_message;
+        message m = _alloc_message();
         m->id = MESSAGE_PTR;
-        for (int i = 0; i < size; ++i)
-        {
-            m->data.push_back(msg[i]);
-        }
+        m->data.assign(msg, msg + size);
         m->protocol = UDP;
-        m->connection = nullptr;
+        m->channel = channel;
+        m->connection = 0;
         m->host = ipv4_to_str(host);
         m->port = port;
-        messages.push_back(m);
+        stats.bytes_in += size;
+        _deliver_message(messages, incoming, m, stats, held_bytes);
     }
 
-    bool _read_udp_message_from(sk_network_connection con, vector<message>& messages)
+    static void _send_udp_bytes(connection con, const char *data, unsigned long size)
+    {
+        if ( VALID_PTR(con->endpoint, UDP_ENDPOINT_PTR) )
+            sk_send_udp_to(&con->socket, con->endpoint->address, con->endpoint->address_port, data, size);
+        else
+            sk_send_udp_message(&con->socket, con->string_ip.c_str(), con->port, data, size);
+    }
+
+    //
+    // Reliable UDP channels. Messages sent on a channel start with a header
+    // giving the channel and a sequence number, and are sent again until the
+    // peer acknowledges them. Each channel is delivered in order on its own,
+    // so a lost packet only holds up the later messages on its channel. An
+    // ack carries the next sequence number expected, and a bit for each of
+    // the 32 after it that has arrived, so only the lost packets are resent.
+    //
+    // Data also carries the oldest number the sender is still waiting on,
+    // so a peer that was forgotten picks up from there rather than waiting
+    // for packets that will never be sent again. Plain UDP messages that
+    // start with the reliable mark are sent with an escape header, so they
+    // are never read as reliable packets.
+    //
+    // Peers are the other end of a UDP connection, or a client of a UDP
+    // server, found by the connection or by the server and address. Clients
+    // of a server only become peers by sending data on a channel, there are
+    // at most RELIABLE_MAX_PEERS of them, and they are forgotten once they
+    // have been silent for RELIABLE_PEER_TIMEOUT_NS. The state has its own
+    // lock, as the network and shard threads read packets while the game
+    // thread sends.
+    //
+    #define RELIABLE_MARK_0 '\xff'
+    #define RELIABLE_MARK_1 'S'
+    #define RELIABLE_DATA 1
+    #define RELIABLE_ACK 2
+    #define RELIABLE_ESCAPED 3
+    #define RELIABLE_HEADER_SIZE 8
+    #define RELIABLE_DATA_HEADER_SIZE 12
+    #define RELIABLE_ACK_SIZE 12
+    #define RELIABLE_ESCAPE_SIZE 3
+    #define RELIABLE_CHANNELS 16
+    #define RELIABLE_WINDOW 1024
+    #define RELIABLE_EARLY_LIMIT 32
+    #define RELIABLE_MAX_PEERS 256
+    #define RELIABLE_PEER_TIMEOUT_NS 60000000000ULL
+    #define RELIABLE_INITIAL_RTT_NS 100000000ULL
+    #define RELIABLE_MIN_RESEND_NS 20000000ULL
+    #define RELIABLE_MAX_RESEND_NS 1000000000ULL
+
+    struct _reliable_packet
+    {
+        vector<char> data;
+        unsigned long long sent;
+        int sends;
+    };
+
+    struct _reliable_channel
+    {
+        uint32_t next_send = 0;
+        map<uint32_t, _reliable_packet> unacked;
+        uint32_t next_receive = 0;
+        map<uint32_t, vector<char>> early;      // arrived ahead of a missing packet
+    };
+
+    struct _reliable_peer
+    {
+        connection con = nullptr;               // sends through the connection,
+        server_socket svr = nullptr;            // or through the server's socket to the address
+        unsigned int address = 0;               // network byte order
+        unsigned short address_port = 0;
+        unsigned long long rtt = 0;             // smoothed round trip time
+        unsigned long long last_heard = 0;      // when a packet last arrived from the peer
+        _reliable_channel channels[RELIABLE_CHANNELS];
+    };
+
+    static mutex _reliable_lock;
+    static map<string, _reliable_peer> _reliable_peers;
+
+    static string _reliable_key(connection con, server_socket svr, unsigned int address, unsigned short address_port)
+    {
+        if ( con ) return "#" + to_string(con->number);
+        return svr->name + "/" + to_string(address) + ":" + to_string(address_port);
+    }
+
+    // The host and port of a datagram, in the network byte order used to send
+    static void _to_network_order(unsigned int host, unsigned short port, unsigned int &out_address, unsigned short &out_port)
+    {
+        unsigned char a[4] = { (unsigned char)(host >> 24), (unsigned char)(host >> 16), (unsigned char)(host >> 8), (unsigned char)host };
+        unsigned char p[2] = { (unsigned char)(port >> 8), (unsigned char)port };
+        memcpy(&out_address, a, 4);
+        memcpy(&out_port, p, 2);
+    }
+
+    static _reliable_peer &_reliable_peer_for(connection con, server_socket svr, unsigned int address, unsigned short address_port)
+    {
+        auto it = _reliable_peers.find(_reliable_key(con, svr, address, address_port));
+        if ( it != _reliable_peers.end() ) return it->second;
+
+        _reliable_peer &peer = _reliable_peers[_reliable_key(con, svr, address, address_port)];
+        peer.con = con;
+        peer.svr = svr;
+        peer.address = address;
+        peer.address_port = address_port;
+        peer.last_heard = _now_ns();
+        return peer;
+    }
+
+    // The peer a packet came from, made for data, but not for acks, and not
+    // past the limit on the clients of servers
+    static _reliable_peer *_receiving_reliable_peer(connection con, server_socket svr, unsigned int address, unsigned short address_port, bool data)
+    {
+        auto it = _reliable_peers.find(_reliable_key(con, svr, address, address_port));
+        if ( it != _reliable_peers.end() ) return &it->second;
+
+        if ( ! data ) return nullptr;
+        if ( ! con && _reliable_peers.size() >= RELIABLE_MAX_PEERS ) return nullptr;
+
+        return &_reliable_peer_for(con, svr, address, address_port);
+    }
+
+    static void _reliable_send(_reliable_peer &peer, const char *data, unsigned long size)
     {
-        if (sk_connection_has_data(&con) > 0)
+        if ( peer.con )
         {
-            char data[UDP_PACKET_SIZE];
-            unsigned long size;
-            unsigned int times, host;
-            unsigned short port;
-            times = size = host = port = 0;
+            _send_udp_bytes(peer.con, data, size);
+            peer.con->stats.bytes_out += size;
+        }
+        else
+        {
+            sk_send_udp_to(&peer.svr->socket, peer.address, peer.address_port, data, size);
+            peer.svr->stats.bytes_out += size;
+        }
+    }
 
-            do
-            {
-                size = UDP_PACKET_SIZE;
-                host = 0;
-                port = 0;
+    static void _write_reliable_header(char *dest, char kind, int channel, uint32_t number)
+    {
+        dest[0] = RELIABLE_MARK_0;
+        dest[1] = RELIABLE_MARK_1;
+        dest[2] = kind;
+        dest[3] = static_cast<char>(channel);
+        for (int i = 0; i < 4; i++) dest[4 + i] = static_cast<char>((number >> (8 * i)) & 0xff);
+    }
 
-                sk_read_udp_message(&con, &host, &port, data, &size);
+    static uint32_t _read_reliable_number(const char *src)
+    {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(src);
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
 
-                if ((size > 0) || (host > 0))
-                {
-                    _enqueue_udp_message(messages, data, size, host, port);
-                }
+    static bool _is_reliable_packet(const char *data, unsigned long size)
+    {
+        return size >= RELIABLE_HEADER_SIZE && data[0] == RELIABLE_MARK_0 && data[1] == RELIABLE_MARK_1 &&
+            (data[2] == RELIABLE_DATA || data[2] == RELIABLE_ACK) &&
+            static_cast<unsigned char>(data[3]) < RELIABLE_CHANNELS;
+    }
 
-                times += 1;
-            }
-            while (((size != 0) && (host != 0)) || (times < 10));
+    static bool _is_escaped_packet(const char *data, unsigned long size)
+    {
+        return size >= RELIABLE_ESCAPE_SIZE && data[0] == RELIABLE_MARK_0 && data[1] == RELIABLE_MARK_1 && data[2] == RELIABLE_ESCAPED;
+    }
 
-            return true;
-        }
+    // Plain UDP data that starts with the reliable mark is copied after an
+    // escape header, and the data and size are changed to point at the copy
+    static void _escape_udp_payload(const char *&data, unsigned long &size, string &escaped)
+    {
+        if ( size < 2 || data[0] != RELIABLE_MARK_0 || data[1] != RELIABLE_MARK_1 ) return;
 
-        return false;
+        escaped.reserve(size + RELIABLE_ESCAPE_SIZE);
+        escaped += RELIABLE_MARK_0;
+        escaped += RELIABLE_MARK_1;
+        escaped += static_cast<char>(RELIABLE_ESCAPED);
+        escaped.append(data, size);
+
+        data = escaped.data();
+        size = escaped.size();
     }
 
-    bool _extract_data(packet_data buffer, int received_count, connection con)
+    static bool _send_reliable_message(_reliable_peer &peer, int channel, const char *data, unsigned long size)
     {
-        int buf_idx = 0;
-        unsigned long msg_len = 0;
-        vector<int8_t> msg;
-        int missing, got;
-        byte size[4];
-
-        while (buf_idx < received_count) // there is data to read...
+        if ( channel < 0 || channel >= RELIABLE_CHANNELS )
         {
-            // Work out the message length...
-            if (con->expected_msg_len > 0)   // we are part way though a message...
-            {
-                msg = con->part_msg_data;                              // get the part
-                msg_len = con->expected_msg_len - msg.size();      // How much left to read...
-                con->expected_msg_len = -1;                          // Reset length of message to "no message"
-                con->part_msg_data.clear();                            // Reset part of message
-            }
-            else // This is a new message... get its size.
-            {
-                msg.clear();
+            LOG(WARNING) << "Reliable channels must be from 0 to " << RELIABLE_CHANNELS - 1 << " -- message ignored";
+            return false;
+        }
 
-                if ((received_count - buf_idx) < 4) // if there are less than 4 bytes for the start of this message...
-                {
-                    // How much do we have?
-                    missing = 4 - (received_count - buf_idx);
+        if ( size + RELIABLE_DATA_HEADER_SIZE >= 1024 )
+        {
+            LOG(ERROR) << "Cannot send messages longer than " << 1023 - RELIABLE_DATA_HEADER_SIZE << " bytes on a reliable UDP channel -- message ignored";
+            return false;
+        }
 
-                    // Move back to give space for 4 values... we must know size!
-                    for (int i = 0; i < 4 - missing; ++i) // move back the ones we have...
-                    {
-                        buffer[received_count - 4 + i] = buffer[buf_idx + i]; // copy back over
-                    }
+        _reliable_channel &ch = peer.channels[channel];
+        if ( ch.unacked.size() >= RELIABLE_WINDOW )
+        {
+            LOG(WARNING) << "Too many messages waiting to be acknowledged on reliable channel " << channel << " -- message ignored";
+            return false;
+        }
 
-                    // read the missing bytes
-                    got = sk_read_bytes(&con->socket, &buffer[received_count - missing], missing);
+        uint32_t waiting_on = ch.unacked.empty() ? ch.next_send : ch.unacked.begin()->first;
 
-                    if (got != missing)
-                    {
-                        LOG(WARNING) << "Issue reading message size from network. Notify SplashKit team.";
-                        return false;
-                    }
+        _reliable_packet &packet = ch.unacked[ch.next_send];
+        packet.data.resize(size + RELIABLE_DATA_HEADER_SIZE);
+        _write_reliable_header(packet.data.data(), RELIABLE_DATA, channel, ch.next_send);
+        for (int i = 0; i < 4; i++) packet.data[RELIABLE_HEADER_SIZE + i] = static_cast<char>((waiting_on >> (8 * i)) & 0xff);
+        memcpy(packet.data.data() + RELIABLE_DATA_HEADER_SIZE, data, size);
+        packet.sent = _now_ns();
+        packet.sends = 1;
+        ch.next_send++;
 
-                    buf_idx = received_count - 4;
-                }
+        _reliable_send(peer, packet.data.data(), packet.data.size());
+        return true;
+    }
 
-                size[0] = byte(buffer[buf_idx]);
-                size[1] = byte(buffer[buf_idx + 1]);
-                size[2] = byte(buffer[buf_idx + 2]);
-                size[3] = byte(buffer[buf_idx + 3]);
+    static void _send_reliable_ack(_reliable_peer &peer, int channel)
+    {
+        _reliable_channel &ch = peer.channels[channel];
 
-                msg_len = (size[0] << 24) + (size[1] << 16) + (size[2] << 8) + (size[3]);
+        uint32_t mask = 0;
+        for (auto &item : ch.early)
+        {
+            uint32_t ahead = item.first - ch.next_receive - 1;
+            if ( ahead < 32 ) mask |= 1u << ahead;
+        }
 
-                buf_idx += 4;
-            }
+        char ack[RELIABLE_ACK_SIZE];
+        _write_reliable_header(ack, RELIABLE_ACK, channel, ch.next_receive);
+        for (int i = 0; i < 4; i++) ack[RELIABLE_HEADER_SIZE + i] = static_cast<char>((mask >> (8 * i)) & 0xff);
 
-            unsigned long end_msg = buf_idx + msg_len;
-            for (; buf_idx < end_msg; ++buf_idx)
-            {
-                if ((buf_idx >= received_count) || (buf_idx > PACKET_SIZE))
-                {
-                    con->part_msg_data = msg;
-                    con->expected_msg_len = msg_len;
-                    return true;
-                }
+        _reliable_send(peer, ack, RELIABLE_ACK_SIZE);
+    }
 
-                msg.push_back(buffer[buf_idx]);
-            }
+    static void _acknowledge(_reliable_peer &peer, _reliable_channel &ch, uint32_t number)
+    {
+        auto it = ch.unacked.find(number);
+        if ( it == ch.unacked.end() ) return;
 
-            _enqueue_tcp_message(msg, con);
+        // only packets sent once give a clear measure of the round trip
+        if ( it->second.sends == 1 )
+        {
+            unsigned long long sample = _now_ns() - it->second.sent;
+            peer.rtt = peer.rtt ? (peer.rtt * 7 + sample) / 8 : sample;
+        }
+        ch.unacked.erase(it);
+    }
+
+    // An ack ahead of anything sent means the peer kept its state after
+    // this end forgot it. The waiting packets are numbered again from the
+    // number the peer expects, so they are not taken as acknowledged.
+    static void _renumber_reliable_channel(_reliable_channel &ch, int channel, uint32_t number)
+    {
+        map<uint32_t, _reliable_packet> unacked;
+        unacked.swap(ch.unacked);
+        ch.next_send = number;
+
+        for (auto &item : unacked)
+        {
+            _reliable_packet &packet = ch.unacked[ch.next_send];
+            packet = std::move(item.second);
+            _write_reliable_header(packet.data.data(), RELIABLE_DATA, channel, ch.next_send);
+            for (int i = 0; i < 4; i++) packet.data[RELIABLE_HEADER_SIZE + i] = static_cast<char>((number >> (8 * i)) & 0xff);
+            packet.sent = 0;                    // send again straight away
+            ch.next_send++;
+        }
+    }
+
+    //
+    // Handle a reliable packet read by a connection or server. Data is
+    // acknowledged each time it arrives, so a lost ack is made up for when
+    // the packet is sent again.
+    //
+    static void _receive_reliable_packet(connection con, server_socket svr, deque<message> &messages, spsc_queue<message> &incoming, network_stats &stats, const sk_udp_datagram &packet)
+    {
+        unsigned int address;
+        unsigned short address_port;
+        _to_network_order(packet.host, packet.port, address, address_port);
+
+        bool data = packet.data[2] == RELIABLE_DATA;
+        if ( packet.size < (data ? RELIABLE_DATA_HEADER_SIZE : RELIABLE_ACK_SIZE) ) return;
+
+        lock_guard<mutex> lock(_reliable_lock);
+        _reliable_peer *found = _receiving_reliable_peer(con, svr, address, address_port, data);
+        if ( ! found ) return;
+
+        _reliable_peer &peer = *found;
+        peer.last_heard = _now_ns();
+
+        int channel = static_cast<unsigned char>(packet.data[3]);
+        uint32_t number = _read_reliable_number(packet.data + 4);
+        _reliable_channel &ch = peer.channels[channel];
+
+        if ( ! data )
+        {
+            stats.bytes_in += packet.size;
+
+            if ( static_cast<int32_t>(number - ch.next_send) > 0 )
+            {
+                _renumber_reliable_channel(ch, channel, number);
+                return;
+            }
+
+            // everything before the number has arrived, and those after it with their bit set
+            while ( ! ch.unacked.empty() && ch.unacked.begin()->first < number )
+                _acknowledge(peer, ch, ch.unacked.begin()->first);
+
+            uint32_t mask = _read_reliable_number(packet.data + RELIABLE_HEADER_SIZE);
+            for (int i = 0; i < 32; i++)
+            {
+                if ( mask & (1u << i) ) _acknowledge(peer, ch, number + 1 + i);
+            }
+            return;
+        }
+
+        const char *body = packet.data + RELIABLE_DATA_HEADER_SIZE;
+        unsigned long size = packet.size - RELIABLE_DATA_HEADER_SIZE;
+
+        // the sender has had everything before this acknowledged, by this
+        // peer before it was forgotten, so skip ahead to it
+        uint32_t waiting_on = _read_reliable_number(packet.data + RELIABLE_HEADER_SIZE);
+        if ( static_cast<int32_t>(waiting_on - ch.next_receive) > 0 )
+        {
+            ch.next_receive = waiting_on;
+            ch.early.erase(ch.early.begin(), ch.early.lower_bound(waiting_on));
+        }
+
+        if ( number == ch.next_receive )
+        {
+            _enqueue_udp_message(messages, incoming, stats, body, size, packet.host, packet.port, channel, con ? &con->message_bytes : nullptr);
+            ch.next_receive++;
+        }
+        else if ( number - ch.next_receive - 1 < RELIABLE_EARLY_LIMIT && ch.early.count(number) == 0 )
+        {
+            // only those within the ack's mask are kept, later ones are sent again
+            ch.early[number].assign(body, body + size);
+        }
+
+        // deliver those that were waiting on this one
+        for (auto it = ch.early.begin(); it != ch.early.end() && it->first == ch.next_receive; it = ch.early.erase(it))
+        {
+            _enqueue_udp_message(messages, incoming, stats, it->second.data(), it->second.size(), packet.host, packet.port, channel, con ? &con->message_bytes : nullptr);
+            ch.next_receive++;
+        }
+
+        _send_reliable_ack(peer, channel);
+    }
+
+    //
+    // Send again the packets that have not been acknowledged within twice
+    // the round trip time, backing off for packets that keep being lost.
+    // Clients of servers that have gone silent are forgotten.
+    //
+    static void _resend_reliable_messages()
+    {
+        lock_guard<mutex> lock(_reliable_lock);
+        if ( _reliable_peers.empty() ) return;
+
+        unsigned long long now = _now_ns();
+
+        for (auto item = _reliable_peers.begin(); item != _reliable_peers.end(); )
+        {
+            _reliable_peer &peer = item->second;
+            if ( ! peer.con && now - peer.last_heard > RELIABLE_PEER_TIMEOUT_NS )
+            {
+                item = _reliable_peers.erase(item);
+                continue;
+            }
+            ++item;
+
+            unsigned long long wait = peer.rtt ? peer.rtt * 2 : RELIABLE_INITIAL_RTT_NS;
+            wait = std::max(RELIABLE_MIN_RESEND_NS, std::min(RELIABLE_MAX_RESEND_NS, wait));
+
+            for (_reliable_channel &ch : peer.channels)
+            {
+                for (auto &pending : ch.unacked)
+                {
+                    _reliable_packet &packet = pending.second;
+                    unsigned long long backoff = std::min(RELIABLE_MAX_RESEND_NS, wait << std::min(packet.sends - 1, 4));
+                    if ( now - packet.sent < backoff ) continue;
+
+                    _reliable_send(peer, packet.data.data(), packet.data.size());
+                    packet.sent = now;
+                    packet.sends++;
+
+                    if ( peer.con ) peer.con->stats.messages_resent++;
+                    else peer.svr->stats.messages_resent++;
+                }
+            }
+        }
+    }
+
+    static void _forget_reliable_peers(connection con, server_socket svr)
+    {
+        lock_guard<mutex> lock(_reliable_lock);
+
+        for (auto it = _reliable_peers.begin(); it != _reliable_peers.end(); )
+        {
+            if ( (con && it->second.con == con) || (svr && it->second.svr == svr) )
+                it = _reliable_peers.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    // The owner is the connection or server reading, so reliable packets can be acknowledged
+    bool _read_udp_message_from(sk_network_connection con, deque<message>& messages, spsc_queue<message> &incoming, network_stats &stats, bool known_ready = false, void *owner = nullptr)
+    {
+        if (known_ready || sk_connection_has_data(&con) > 0)
+        {
+            sk_udp_datagram batch[UDP_READ_BATCH];
+            int count, times = 0;
+
+            connection from_con = HAS_PTR_KIND(static_cast<connection>(owner), CONNECTION_PTR) ? static_cast<connection>(owner) : nullptr;
+            server_socket from_svr = from_con ? nullptr : static_cast<server_socket>(owner);
+            std::atomic<size_t> *held_bytes = from_con ? &from_con->message_bytes : nullptr;
+
+            // read until a batch comes back short, so one busy socket cannot
+            // hold up the others for too long
+            do
+            {
+                count = sk_read_udp_messages(&con, batch, UDP_READ_BATCH, UDP_PACKET_SIZE);
+
+                for (int i = 0; i < count; i++)
+                {
+                    if ( _is_escaped_packet(batch[i].data, batch[i].size) )
+                        _enqueue_udp_message(messages, incoming, stats, batch[i].data + RELIABLE_ESCAPE_SIZE, batch[i].size - RELIABLE_ESCAPE_SIZE, batch[i].host, batch[i].port, -1, held_bytes);
+                    else if ( owner && _is_reliable_packet(batch[i].data, batch[i].size) )
+                        _receive_reliable_packet(from_con, from_svr, messages, incoming, stats, batch[i]);
+                    else
+                        _enqueue_udp_message(messages, incoming, stats, batch[i].data, batch[i].size, batch[i].host, batch[i].port, -1, held_bytes);
+                }
+
+                times += 1;
+            }
+            while (count == UDP_READ_BATCH && times < UDP_READ_BATCHES);
+
+            return true;
         }
 
         return false;
     }
 
-    bool _check_connection_for_data(connection con)
+    //
+    // Compressed TCP messages set the top bit of their length header, and
+    // start with their uncompressed length. The rest is raw deflate, with
+    // the shared dictionary preset. Streams are kept for each thread and
+    // reset for each message, so compressing does not allocate.
+    //
+    // Compression is agreed for each connection. An end that wants to
+    // compress first sends a notice, a compressed frame with no payload,
+    // saying it reads compressed messages. A SplashKit peer answers with the
+    // same notice, and messages are only compressed once it has. The answer
+    // is sent with the network lock held, as shard threads read the notice.
+    //
+    // Shard threads compress and decompress in parallel, so the dictionary
+    // can only be set once. It is not changed after it is published.
+    //
+    #define TCP_COMPRESSED_FLAG 0x80000000UL
+    #define COMPRESSION_MIN_SIZE 64
+
+    static string _compression_dictionary;
+    static atomic<bool> _compression_dictionary_set(false);
+    static std::mutex _compression_dictionary_lock;
+
+    static const string *_shared_dictionary()
+    {
+        if ( ! _compression_dictionary_set.load(std::memory_order_acquire) || _compression_dictionary.empty() ) return nullptr;
+        return &_compression_dictionary;
+    }
+
+    struct _compression_streams
+    {
+        z_stream deflaters[3];  // indexed by connection_compression
+        z_stream inflater;
+        bool ready[3] = { false, false, false };
+        bool inflater_ready = false;
+
+        ~_compression_streams()
+        {
+            for (int i = 0; i < 3; i++)
+                if ( ready[i] ) deflateEnd(&deflaters[i]);
+            if ( inflater_ready ) inflateEnd(&inflater);
+        }
+    };
+
+    static thread_local _compression_streams _zlib;
+
+    static z_stream *_deflater_for(connection_compression compression)
+    {
+        int idx = static_cast<int>(compression);
+        z_stream &stream = _zlib.deflaters[idx];
+
+        if ( ! _zlib.ready[idx] )
+        {
+            stream = z_stream();
+            int level = compression == FAST_COMPRESSION ? 1 : 9;
+            if ( deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK ) return nullptr;
+            _zlib.ready[idx] = true;
+        }
+        else if ( deflateReset(&stream) != Z_OK ) return nullptr;
+
+        const string *dictionary = _shared_dictionary();
+        if ( dictionary )
+            deflateSetDictionary(&stream, reinterpret_cast<const Bytef *>(dictionary->data()), static_cast<uInt>(dictionary->size()));
+
+        return &stream;
+    }
+
+    static z_stream *_inflater()
+    {
+        z_stream &stream = _zlib.inflater;
+
+        if ( ! _zlib.inflater_ready )
+        {
+            stream = z_stream();
+            if ( inflateInit2(&stream, -15) != Z_OK ) return nullptr;
+            _zlib.inflater_ready = true;
+        }
+        else if ( inflateReset(&stream) != Z_OK ) return nullptr;
+
+        const string *dictionary = _shared_dictionary();
+        if ( dictionary )
+            inflateSetDictionary(&stream, reinterpret_cast<const Bytef *>(dictionary->data()), static_cast<uInt>(dictionary->size()));
+
+        return &stream;
+    }
+
+    static void _write_be32(char *dest, unsigned long value)
+    {
+        dest[0] = static_cast<char>((value >> 24) & 0xFF);
+        dest[1] = static_cast<char>((value >> 16) & 0xFF);
+        dest[2] = static_cast<char>((value >> 8) & 0xFF);
+        dest[3] = static_cast<char>(value & 0xFF);
+    }
+
+    // The compressed frame, or nullptr if compressing does not make it smaller
+    static sk_send_buffer _compress_tcp_frame(const char *data, unsigned long n, connection_compression compression)
+    {
+        z_stream *stream = _deflater_for(compression);
+        if ( ! stream ) return nullptr;
+
+        vector<char> *frame = new vector<char>(8 + deflateBound(stream, n));
+
+        stream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        stream->avail_in = static_cast<uInt>(n);
+        stream->next_out = reinterpret_cast<Bytef *>(frame->data() + 8);
+        stream->avail_out = static_cast<uInt>(frame->size() - 8);
+
+        int status = deflate(stream, Z_FINISH);
+        unsigned long payload = 4 + stream->total_out;
+
+        if ( status != Z_STREAM_END || payload >= n )
+        {
+            delete frame;
+            return nullptr;
+        }
+
+        _write_be32(frame->data(), payload | TCP_COMPRESSED_FLAG);
+        _write_be32(frame->data() + 4, n);
+        frame->resize(4 + payload);
+
+        return sk_send_buffer(frame);
+    }
+
+    static bool _enqueue_compressed_tcp_message(const int8_t *data, unsigned long size, connection con)
+    {
+        if ( size < 4 ) return false;
+
+        const byte *len = reinterpret_cast<const byte *>(data);
+        unsigned long original = (static_cast<unsigned long>(len[0]) << 24) + (len[1] << 16) + (len[2] << 8) + len[3];
+        if ( original > TCP_MESSAGE_MAX ) return false;
+
+        z_stream *stream = _inflater();
+        if ( ! stream ) return false;
+
+        sk_message* m = _alloc_message();
+        m->data.resize(original);
+
+        stream->next_in = reinterpret_cast<Bytef *>(const_cast<int8_t *>(data + 4));
+        stream->avail_in = static_cast<uInt>(size - 4);
+        stream->next_out = reinterpret_cast<Bytef *>(m->data.data());
+        stream->avail_out = static_cast<uInt>(original);
+
+        int status = inflate(stream, Z_FINISH);
+        if ( (status != Z_STREAM_END) || (stream->total_out != original) )
+        {
+            _recycle_message(m);
+            return false;
+        }
+
+        m->id = MESSAGE_PTR;
+        m->protocol = TCP;
+        m->channel = -1;
+        m->connection = con->number;
+        m->host = con->string_ip;
+        m->port = con->port;
+
+        _deliver_message(con->messages, con->incoming, m, con->stats, &con->message_bytes);
+        return true;
+    }
+
+    // Queue each whole message in the connection's read buffer, leaving any
+    // partial message at the start of the buffer for the next read. Returns
+    // the size the buffer needs to hold the partial message.
+    unsigned long _extract_messages(connection con)
+    {
+        vector<int8_t> &buffer = con->read_buffer;
+        unsigned long needed = 0;
+
+        while (con->read_end - con->read_start >= 4)
+        {
+            const byte *size = reinterpret_cast<const byte *>(&buffer[con->read_start]);
+            unsigned long msg_len = (static_cast<unsigned long>(size[0]) << 24) + (size[1] << 16) + (size[2] << 8) + size[3];
+            bool compressed = (msg_len & TCP_COMPRESSED_FLAG) != 0;
+            msg_len &= ~TCP_COMPRESSED_FLAG;
+
+            if (con->read_end - con->read_start - 4 < msg_len)
+            {
+                needed = msg_len + 4;
+                break;
+            }
+
+            if ( compressed && msg_len == 0 )
+            {
+                // A compression notice, answered when the network lock is held
+                con->peer_reads_compression = true;
+                if ( ! con->compression_offered ) con->compression_answer_due = true;
+            }
+            else if ( ! compressed )
+                _enqueue_tcp_message(&buffer[con->read_start + 4], msg_len, con);
+            else if ( ! _enqueue_compressed_tcp_message(&buffer[con->read_start + 4], msg_len, con) )
+                LOG(WARNING) << "Unable to decompress message from " << con->name << " -- message ignored";
+
+            con->read_start += msg_len + 4;
+        }
+
+        if (con->read_start != con->read_end) con->stats.partial_frames++;
+
+        // move the partial message to the front, so the rest can follow it
+        if (con->read_start == con->read_end)
+        {
+            con->read_start = con->read_end = 0;
+        }
+        else if (con->read_start > 0)
+        {
+            memmove(&buffer[0], &buffer[con->read_start], con->read_end - con->read_start);
+            con->read_end -= con->read_start;
+            con->read_start = 0;
+        }
+
+        return needed;
+    }
+
+    // Read what has arrived on a TCP connection into its read buffer, and
+    // queue the messages it completes. Returns false if the connection closed,
+    // or the peer sent a message larger than TCP_MESSAGE_MAX.
+    bool _read_tcp_messages(connection con)
+    {
+        vector<int8_t> &buffer = con->read_buffer;
+
+        if (buffer.empty())
+        {
+            unsigned long os_size = static_cast<unsigned long>(sk_receive_buffer_size(&con->socket));
+            buffer.resize(std::max<unsigned long>(TCP_READ_BUFFER_MIN, std::min<unsigned long>(os_size, TCP_READ_BUFFER_MAX)));
+            con->read_buffer_bytes = buffer.capacity();
+        }
+
+        // the socket is ready, so the first read will not wait
+        int received = sk_read_bytes(&con->socket, reinterpret_cast<char *>(&buffer[con->read_end]), static_cast<int>(buffer.size() - con->read_end));
+        if (received <= 0) return false;
+
+        for (int times = 0; received > 0; times++)
+        {
+            con->read_end += received;
+            con->stats.bytes_in += received;
+
+            unsigned long needed = _extract_messages(con);
+            if (needed > TCP_MESSAGE_MAX + 4)
+            {
+                LOG(WARNING) << "Closing connection " << con->name << " as it sent a message of " << needed - 4 << " bytes, larger than the limit of " << TCP_MESSAGE_MAX;
+                return false;
+            }
+            if (needed > buffer.size())
+            {
+                buffer.resize(needed);
+                con->read_buffer_bytes = buffer.capacity();
+            }
+
+            // keep reading what has already arrived, so a large message is
+            // not spread over many checks for activity
+            if (times >= 10 || con->read_end == buffer.size()) break;
+            received = sk_read_available_bytes(&con->socket, reinterpret_cast<char *>(&buffer[con->read_end]), static_cast<int>(buffer.size() - con->read_end));
+        }
+
+        return true;
+    }
+
+    // The peer closed the connection, which leaves its socket readable, so
+    // it is shut rather than being reported ready on every wait
+    static void _connection_closed_by_peer(connection con)
+    {
+        if ( _network_shard > 0 )
+        {
+            // Shard threads hold their shard's lock, but not the network lock
+            sk_unwatch_connection(&con->socket);
+            _peer_closed_connections[_network_shard].push_back(con);
+            return;
+        }
+
+        _shut_connection(con, false);
+    }
+
+    // Shut the connections shard threads found closed by their peers.
+    // Called on the network or game thread with the network lock held.
+    static void _shut_peer_closed_connections()
+    {
+        for (int shard = 1; shard < MAX_NETWORK_SHARDS; shard++)
+        {
+            vector<connection> closed;
+            {
+                _network_io_guard shard_lock(_shard_locks[shard]);
+                closed.swap(_peer_closed_connections[shard]);
+            }
+
+            for (connection con : closed) _shut_connection(con, false);
+        }
+    }
+
+    bool _check_connection_for_data(connection con, bool known_ready = false)
     {
         if (INVALID_PTR(con, CONNECTION_PTR) || !con->socket._socket)
         {
@@ -689,91 +1783,735 @@ namespace splashkit_lib
             return false;
         }
 
-        if (sk_connection_has_data(&con->socket) > 0)
+        if (known_ready || sk_connection_has_data(&con->socket) > 0)
         {
-            bool got_data = true; // are we expecting more data?
-            int times = 0;
-            do
+            if (con->protocol == TCP)
             {
-                if (con->protocol == TCP)
+                if ( ! _read_tcp_messages(con) )
                 {
-                    packet_data buffer;
-                    int received = sk_read_bytes(&con->socket, buffer, 512);
+                    LOG(DEBUG) << "Connection " << con->name << " closed by its peer";
+                    _connection_closed_by_peer(con);
+                    return false;
+                }
+            }
+            else
+            {
+                _read_udp_message_from(con->socket, con->messages, con->incoming, con->stats, known_ready, con);
+            }
 
-                    if (received <= 0) {
-                        // shut_connection
-                        LOG(DEBUG) << "No data received in _c_c_for_data";
-                        return false;
-                    }
+            return true;
+        }
+
+        return false;
+    }
+
+    bool _check_udp_socket_for_data(server_socket socket)
+    {
+        if (VALID_PTR(socket, SERVER_SOCKET_PTR))
+        {
+            return _read_udp_message_from(socket->socket, socket->messages, socket->incoming, socket->stats, false, socket);
+        }
+
+        return false;
+    }
+
+    // A TCP server is ready to accept. The network thread only takes the
+    // sockets, leaving the game thread to add them to the server's list.
+    void _accept_ready_connections(server_socket svr)
+    {
+        if ( ! _on_network_thread )
+        {
+            accept_new_connection(svr);
+            return;
+        }
+
+        sk_network_connection con = sk_accept_connection(svr->socket);
+        while ( con._socket )
+        {
+            {
+                lock_guard<mutex> lock(svr->accept_lock);
+                svr->pending_accepts.push_back(con);
+            }
+            sk_signal_activity();
+            con = sk_accept_connection(svr->socket);
+        }
+    }
+
+    //
+    // Read from only the sockets the backend reports as ready. The owners
+    // registered with sk_watch_connection are connections or servers.
+    //
+    void _check_ready_sockets()
+    {
+        void *ready[64];
+        bool got_data = true;
+
+        while (got_data)
+        {
+            got_data = false;
+            int count = sk_network_ready(ready, 64);
 
-                    got_data = _extract_data(buffer, received, con);
+            for (int i = 0; i < count; i++)
+            {
+                if (HAS_PTR_KIND(static_cast<connection>(ready[i]), CONNECTION_PTR))
+                {
+                    got_data = _check_connection_for_data(static_cast<connection>(ready[i]), true) || got_data;
                 }
-                else
+                else if (HAS_PTR_KIND(static_cast<server_socket>(ready[i]), SERVER_SOCKET_PTR))
                 {
-                    got_data = _read_udp_message_from(con->socket, con->messages);
+                    server_socket svr = static_cast<server_socket>(ready[i]);
+                    if (svr->protocol == UDP)
+                        got_data = _read_udp_message_from(svr->socket, svr->messages, svr->incoming, svr->stats, true, svr) || got_data;
+                    else
+                        _accept_ready_connections(svr);
                 }
+            }
+        }
+    }
+
+    //
+    // TCP messages are encoded once into a shared buffer with their length
+    // header, and queued on each connection they go to. Queues are written
+    // with gather sends that do not block, and whatever the socket does not
+    // take is sent as later network activity is checked.
+    //
+    #define SEND_GATHER_MAX 64
+
+    sk_send_buffer _encode_tcp_frame(const char *data, unsigned long n, connection_compression compression)
+    {
+        if ( compression != NO_COMPRESSION && n >= COMPRESSION_MIN_SIZE )
+        {
+            sk_send_buffer compressed = _compress_tcp_frame(data, n, compression);
+            if ( compressed ) return compressed;
+        }
+
+        vector<char> *frame = new vector<char>(n + 4);
+        _write_be32(frame->data(), n);
+        std::copy(data, data + n, frame->begin() + 4);
+
+        return sk_send_buffer(frame);
+    }
+
+    // A message encoded for each kind of compression as it is first needed,
+    // so a broadcast is only encoded once for each kind
+    struct _tcp_frames
+    {
+        const char *data;
+        unsigned long size;
+        sk_send_buffer encoded[3];
+    };
+
+    // Send what the socket will take from the connection's queue, returning
+    // false if the connection failed and was shut
+    bool _flush_send_queue(connection con)
+    {
+        const char *buffers[SEND_GATHER_MAX];
+        unsigned long sizes[SEND_GATHER_MAX];
+
+        while ( con->open && ! con->send_queue.empty() )
+        {
+            int count = 0;
+            for (auto it = con->send_queue.begin(); it != con->send_queue.end() && count < SEND_GATHER_MAX; ++it, ++count)
+            {
+                unsigned long skip = count == 0 ? con->send_offset : 0;
+                buffers[count] = (*it)->data() + skip;
+                sizes[count] = (*it)->size() - skip;
+            }
+
+            long sent = sk_send_buffers(&con->socket, buffers, sizes, count);
+            if ( sent < 0 )
+            {
+                LOG(DEBUG) << "Shutting the connection as no bytes sent";
+                _shut_connection(con, false);
+                return false;
+            }
+
+            // drop the buffers that were sent in full
+            unsigned long remaining = static_cast<unsigned long>(sent);
+            con->send_queue_bytes -= remaining;
+            while ( remaining > 0 )
+            {
+                unsigned long left = con->send_queue.front()->size() - con->send_offset;
+                if ( remaining < left )
+                {
+                    con->send_offset += remaining;
+                    break;
+                }
+
+                remaining -= left;
+                con->send_queue.pop_front();
+                con->send_offset = 0;
+            }
+
+            // the socket is full, try again later
+            if ( sent == 0 || con->send_offset > 0 ) break;
+        }
+
+        return true;
+    }
+
+    bool _queue_tcp_frame(connection con, const sk_send_buffer &frame)
+    {
+        if ( ! con->open ) return false;
+
+        if ( con->send_queue_limit > 0 && con->send_queue_bytes + frame->size() > con->send_queue_limit )
+        {
+            if ( con->send_policy == CLOSE_SLOW_CONNECTION )
+            {
+                LOG(WARNING) << "Closing connection " << con->name << " as its send queue is full";
+                _shut_connection(con, false);
+            }
+            return false;
+        }
+
+        con->send_queue.push_back(frame);
+        con->send_queue_bytes += frame->size();
+
+        // coalesced messages wait to go out together when activity is checked
+        if ( con->coalesce_sends ) return true;
+        return _flush_send_queue(con);
+    }
+
+    // Tell the peer this end reads compressed messages, if it wants to
+    // compress or the peer is waiting to hear. Called with the network lock.
+    void _send_compression_notice(connection con)
+    {
+        if ( con->protocol != TCP || ! con->open || con->compression_offered ) return;
+
+        bool answer = con->compression_answer_due.exchange(false);
+        if ( con->compression == NO_COMPRESSION && ! answer ) return;
+
+        vector<char> *notice = new vector<char>(4);
+        _write_be32(notice->data(), TCP_COMPRESSED_FLAG);
+
+        con->compression_offered = true;
+        _queue_tcp_frame(con, sk_send_buffer(notice));
+    }
+
+    bool _queue_tcp_message(connection con, _tcp_frames &frames)
+    {
+        if ( frames.size > TCP_MESSAGE_MAX )
+        {
+            LOG(WARNING) << "Unable to send a message of " << frames.size << " bytes to " << con->name << ", larger than the limit of " << TCP_MESSAGE_MAX;
+            return false;
+        }
+
+        _send_compression_notice(con);
+
+        // Messages are sent uncompressed until the peer says it reads them
+        connection_compression compression = con->peer_reads_compression ? con->compression : NO_COMPRESSION;
+
+        sk_send_buffer &frame = frames.encoded[compression];
+        if ( ! frame ) frame = _encode_tcp_frame(frames.data, frames.size, compression);
+
+        if ( ! _queue_tcp_frame(con, frame) ) return false;
+
+        con->bytes_before_compression += frames.size + 4;
+        con->bytes_after_compression += frame->size();
+        con->stats.bytes_out += frame->size();
+        con->stats.messages_out++;
+        return true;
+    }
+
+    void set_connection_compression(connection a_connection, connection_compression compression)
+    {
+        if ( INVALID_PTR(a_connection, CONNECTION_PTR) )
+        {
+            LOG(WARNING) << "Invalid connection passed to set_connection_compression";
+            return;
+        }
+
+        _network_io_guard lock(_network_io_lock);
+        a_connection->compression = compression;
+    }
+
+    void set_default_connection_compression(connection_compression compression)
+    {
+        _default_compression = compression;
+    }
+
+    void set_network_compression_dictionary(const string &dictionary)
+    {
+        std::lock_guard<std::mutex> lock(_compression_dictionary_lock);
+
+        if ( _compression_dictionary_set.load(std::memory_order_acquire) )
+        {
+            if ( dictionary != _compression_dictionary )
+                LOG(WARNING) << "The network compression dictionary can only be set once -- dictionary not changed";
+            return;
+        }
+
+        _compression_dictionary = dictionary;
+        _compression_dictionary_set.store(true, std::memory_order_release);
+    }
+
+    double connection_compression_ratio(connection a_connection)
+    {
+        if ( INVALID_PTR(a_connection, CONNECTION_PTR) )
+        {
+            LOG(WARNING) << "Invalid connection passed to connection_compression_ratio";
+            return 1;
+        }
+
+        if ( a_connection->bytes_before_compression == 0 ) return 1;
+        return static_cast<double>(a_connection->bytes_after_compression) / a_connection->bytes_before_compression;
+    }
+
+    network_stats connection_statistics(connection a_connection)
+    {
+        if ( INVALID_PTR(a_connection, CONNECTION_PTR) )
+        {
+            LOG(WARNING) << "Invalid connection passed to connection_statistics";
+            return network_stats();
+        }
+
+        _network_io_guard lock(_network_io_lock);
+        _network_io_guard shard_lock(_shard_lock_for(a_connection));
+        _take_incoming(a_connection->messages, a_connection->incoming);
+
+        network_stats result = a_connection->stats;
+        result.queue_depth = static_cast<unsigned int>(a_connection->messages.size());
+        result.send_queue_bytes = a_connection->send_queue_bytes;
+        return result;
+    }
+
+    network_stats server_statistics(server_socket svr)
+    {
+        if ( INVALID_PTR(svr, SERVER_SOCKET_PTR) )
+        {
+            LOG(WARNING) << "Invalid server_socket passed to server_statistics";
+            return network_stats();
+        }
+
+        _network_io_guard lock(_network_io_lock);
+        _take_incoming(svr->messages, svr->incoming);
+
+        network_stats result = svr->stats;
+        result.queue_depth = static_cast<unsigned int>(svr->messages.size());
+        result.send_queue_bytes = 0;
+
+        for (connection con: svr->connections)
+        {
+            _add_stats(result, connection_statistics(con));
+        }
+
+        return result;
+    }
+
+    void reset_connection_statistics(connection a_connection)
+    {
+        if ( INVALID_PTR(a_connection, CONNECTION_PTR) )
+        {
+            LOG(WARNING) << "Invalid connection passed to reset_connection_statistics";
+            return;
+        }
+
+        _network_io_guard lock(_network_io_lock);
+        a_connection->stats = network_stats();
+    }
+
+    void reset_server_statistics(server_socket svr)
+    {
+        if ( INVALID_PTR(svr, SERVER_SOCKET_PTR) )
+        {
+            LOG(WARNING) << "Invalid server_socket passed to reset_server_statistics";
+            return;
+        }
+
+        _network_io_guard lock(_network_io_lock);
+        svr->stats = network_stats();
+        for (connection con: svr->connections)
+        {
+            con->stats = network_stats();
+        }
+    }
+
+    unsigned long connection_send_queue_bytes(connection a_connection)
+    {
+        if ( INVALID_PTR(a_connection, CONNECTION_PTR) )
+        {
+            LOG(WARNING) << "Invalid connection passed to connection_send_queue_bytes";
+            return 0;
+        }
+
+        return a_connection->send_queue_bytes;
+    }
+
+    void set_connection_send_queue_limit(connection a_connection, unsigned long max_bytes, send_queue_policy policy)
+    {
+        if ( INVALID_PTR(a_connection, CONNECTION_PTR) )
+        {
+            LOG(WARNING) << "Invalid connection passed to set_connection_send_queue_limit";
+            return;
+        }
+
+        _network_io_guard lock(_network_io_lock);
+        a_connection->send_queue_limit = max_bytes;
+        a_connection->send_policy = policy;
+    }
+
+    void set_default_send_queue_limit(unsigned long max_bytes, send_queue_policy policy)
+    {
+        _default_send_queue_limit = max_bytes;
+        _default_send_policy = policy;
+    }
+
+    void set_connection_coalesce_sends(connection a_connection, bool coalesce)
+    {
+        if ( INVALID_PTR(a_connection, CONNECTION_PTR) )
+        {
+            LOG(WARNING) << "Invalid connection passed to set_connection_coalesce_sends";
+            return;
+        }
+
+        _network_io_guard lock(_network_io_lock);
+        a_connection->coalesce_sends = coalesce;
+        if ( ! coalesce ) _flush_send_queue(a_connection);
+    }
+
+    bool set_connection_no_delay(connection a_connection, bool no_delay)
+    {
+        if ( INVALID_PTR(a_connection, CONNECTION_PTR) || a_connection->protocol != TCP || ! a_connection->open )
+        {
+            LOG(WARNING) << "Invalid or closed TCP connection passed to set_connection_no_delay";
+            return false;
+        }
+
+        _network_io_guard lock(_network_io_lock);
+        return sk_set_tcp_no_delay(&a_connection->socket, no_delay);
+    }
+
+    void _flush_all_send_queues()
+    {
+        for (auto const &svr: _server_sockets)
+        {
+            for (connection con: svr.second->connections)
+            {
+                _send_compression_notice(con);
+                if ( ! con->send_queue.empty() ) _flush_send_queue(con);
+            }
+        }
+
+        for (auto const &con: _connections)
+        {
+            _send_compression_notice(con.second);
+            if ( ! con.second->send_queue.empty() ) _flush_send_queue(con.second);
+        }
+    }
+
+    void check_network_activity()
+    {
+        SK_PROFILE_SCOPE("network activity");
+
+        accept_all_new_connections();
+
+        {
+            _network_io_guard lock(_network_io_lock);
+            _flush_all_send_queues();
+        }
+
+        _resend_reliable_messages();
+
+        // The network thread is already reading messages
+        if (_network_thread_active) return;
+
+        if (sk_network_events_supported())
+        {
+            _check_ready_sockets();
+            return;
+        }
+
+        bool got_data = true;
+
+        while ((sk_network_has_data() > 0) && got_data)
+        {
+            got_data = false;
+
+            for (auto it = _server_sockets.begin(); it != _server_sockets.end(); ++it)
+            {
+                server_socket s = it->second;
+                if (s->protocol == TCP)
+                {
+                    for (int i = 0; i < s->connections.size(); ++i)
+                    {
+                        got_data = _check_connection_for_data(s->connections[i]) || got_data;
+                    }
+                }
+                else
+                {
+                    got_data = _check_udp_socket_for_data(s) || got_data;
+                }
+            }
+
+            for (auto it = _connections.begin(); it != _connections.end(); ++it)
+            {
+                got_data = _check_connection_for_data(it->second) || got_data;
+            }
+        }
+    }
+
+    // Used by wait_for_activity, which must service sockets while it waits
+    bool _network_needs_polling()
+    {
+        return ! (_connections.empty() && _server_sockets.empty());
+    }
+
+    // Wait up to timeout_ms for new connections, socket data, or activity
+    // signalled since `seen`, reading any messages that arrive
+    bool _wait_for_network_data(unsigned long long seen, int timeout_ms)
+    {
+        if (accept_all_new_connections()) return true;
+
+        // The network thread signals when it delivers messages
+        if (_network_thread_active) return sk_wait_for_activity(seen, timeout_ms);
+
+        if (sk_network_events_supported())
+        {
+            void *ready[1];
+            if (sk_network_ready(ready, 1, timeout_ms) > 0)
+            {
+                check_network_activity();
+                return true;
+            }
+            return sk_activity_count() != seen;
+        }
+
+        if (sk_network_has_data() > 0)
+        {
+            check_network_activity();
+            return true;
+        }
+
+        return sk_wait_for_activity(seen, timeout_ms);
+    }
+
+    void _network_thread_loop()
+    {
+        _on_network_thread = true;
+        void *ready[1];
+
+        while (_network_thread_active)
+        {
+            // Wait without the lock, then read whatever is ready now
+            if (sk_network_ready(ready, 1, 10) > 0)
+            {
+                _network_io_guard lock(_network_io_lock);
+                _check_ready_sockets();
+            }
+
+            _network_io_guard lock(_network_io_lock);
+            _shut_peer_closed_connections();
+            _flush_all_send_queues();
+            _resend_reliable_messages();
+        }
+    }
+
+    // Read the connections watched by one of the extra shards
+    void _shard_thread_loop(int shard)
+    {
+        _on_network_thread = true;
+        _network_shard = shard;
+        void *ready[64];
+
+        while (_network_thread_active)
+        {
+            {
+                _network_io_guard lock(_shard_locks[shard]);
+                _free_retired_connections(shard);
+            }
+
+            int count = sk_network_ready_on(shard, ready, 64, 10);
+            if (count <= 0) continue;
+
+            // Connections closed since the wait are retired, not freed, so
+            // they can still be checked here
+            _network_io_guard lock(_shard_locks[shard]);
+            for (int i = 0; i < count; i++)
+            {
+                connection con = static_cast<connection>(ready[i]);
+                if (VALID_PTR(con, CONNECTION_PTR) && con->shard == shard && con->open)
+                {
+                    _check_connection_for_data(con, true);
+                }
+            }
+        }
+    }
+
+    // A joinable std::thread left at exit terminates the program
+    static void _stop_network_thread_at_exit()
+    {
+        stop_network_thread();
+    }
+
+    static void _start_network_thread()
+    {
+        static bool stop_at_exit = false;
+        if ( ! stop_at_exit )
+        {
+            atexit(_stop_network_thread_at_exit);
+            stop_at_exit = true;
+        }
+
+        _network_thread_active = true;
+        _network_thread = thread(_network_thread_loop);
+    }
+
+    bool start_network_threads(int count)
+    {
+        if (_network_thread_active) return true;
+
+        if ( ! sk_network_events_supported() )
+        {
+            LOG(WARNING) << "Unable to start network threads, event driven network checks are not supported";
+            return false;
+        }
+
+        count = std::max(1, std::min(count, MAX_NETWORK_SHARDS));
+        _shard_count = sk_set_network_shards(count);
+        if (_shard_count < count)
+        {
+            LOG(WARNING) << "Only able to start " << _shard_count << " of " << count << " network threads";
+        }
+
+        _start_network_thread();
+        for (int shard = 1; shard < _shard_count; shard++)
+        {
+            _shard_threads.push_back(thread(_shard_thread_loop, shard));
+        }
+        return true;
+    }
+
+    bool start_network_thread()
+    {
+        if (_network_thread_active) return true;
+
+        if ( ! sk_network_events_supported() )
+        {
+            LOG(WARNING) << "Unable to start network thread, event driven network checks are not supported";
+            return false;
+        }
+
+        _start_network_thread();
+        return true;
+    }
+
+    void stop_network_thread()
+    {
+        if ( ! _network_thread_active ) return;
 
-                times += 1;
-            } while (got_data and times < 10);
+        _network_thread_active = false;
+        if (_network_thread.joinable())
+            _network_thread.join();
 
-            return true;
+        for (thread &t: _shard_threads)
+        {
+            if (t.joinable()) t.join();
         }
+        _shard_threads.clear();
 
-        return false;
-    }
+        // the game thread reads everything through shard 0 again
+        _network_io_guard lock(_network_io_lock);
+        _shut_peer_closed_connections();
+        for (int shard = 1; shard < MAX_NETWORK_SHARDS; shard++)
+        {
+            _network_io_guard shard_lock(_shard_locks[shard]);
+            _free_retired_connections(shard);
+        }
+        _shard_count = 1;
 
-    bool _check_udp_socket_for_data(server_socket socket)
-    {
-        if (VALID_PTR(socket, SERVER_SOCKET_PTR))
+        for (auto const &svr: _server_sockets)
         {
-            return _read_udp_message_from(socket->socket, socket->messages);
+            for (connection con: svr.second->connections)
+            {
+                if (con->shard == 0 || ! con->open) continue;
+                con->shard = 0;
+                sk_watch_connection(&con->socket, con);
+            }
         }
+    }
 
-        return false;
+    bool network_thread_running()
+    {
+        return _network_thread_active;
     }
 
-    void check_network_activity()
+    void broadcast_message(const string &a_msg)
     {
-        accept_all_new_connections();
-        bool got_data = true;
+        // the encoded frames are shared by every TCP connection
+        _tcp_frames frames = { a_msg.data(), a_msg.length() };
 
-        while ((sk_network_has_data() > 0) && got_data)
+        _network_io_guard lock(_network_io_lock);
+        for(auto const& tcp_server: _server_sockets)
         {
-            got_data = false;
-
-            for (auto it = _server_sockets.begin(); it != _server_sockets.end(); ++it)
+            for (connection con: tcp_server.second->connections)
             {
-                server_socket s = it->second;
-                if (s->protocol == TCP)
-                {
-                    for (int i = 0; i < s->connections.size(); ++i)
-                    {
-                        got_data = _check_connection_for_data(s->connections[i]) || got_data;
-                    }
-                }
-                else
-                {
-                    got_data = _check_udp_socket_for_data(s) || got_data;
-                }
+                _queue_tcp_message(con, frames);
             }
+        }
+        for (auto const& a_connection: _connections)
+        {
+            if (a_connection.second->protocol == TCP)
+                _queue_tcp_message(a_connection.second, frames);
+            else
+                send_message_to(a_msg, a_connection.second);
+        }
+    }
 
-            for (auto it = _connections.begin(); it != _connections.end(); ++it)
+    bool _broadcast_udp_message(sk_network_connection *socket, const string &a_msg, const vector<udp_endpoint> &endpoints)
+    {
+        const char *data = a_msg.data();
+        unsigned long size = a_msg.size();
+        string escaped;
+        _escape_udp_payload(data, size, escaped);
+
+        if (size >= 1024)
+        {
+            LOG(ERROR) << "Cannot send messages longer than 1024 bytes using UDP -- message ignored";
+            return false;
+        }
+
+        vector<unsigned int> addresses;
+        vector<unsigned short> ports;
+        addresses.reserve(endpoints.size());
+        ports.reserve(endpoints.size());
+
+        for (udp_endpoint ep: endpoints)
+        {
+            if (INVALID_PTR(ep, UDP_ENDPOINT_PTR))
             {
-                got_data = _check_connection_for_data(it->second) || got_data;
+                LOG(WARNING) << "Skipping invalid udp_endpoint passed to broadcast_message";
+                continue;
             }
+            addresses.push_back(ep->address);
+            ports.push_back(ep->address_port);
         }
+
+        int count = static_cast<int>(addresses.size());
+        return sk_send_udp_messages(socket, addresses.data(), ports.data(), count, data, size) == count;
     }
 
-    void broadcast_message(const string &a_msg)
+    bool broadcast_message(const string &a_msg, const vector<udp_endpoint> &endpoints)
     {
-        for(auto const& tcp_server: _server_sockets)
-        {
-            broadcast_message(a_msg, tcp_server.second);
-        }
-        for (auto const& udp_connection: _connections)
+        _network_io_guard lock(_network_io_lock);
+        if ( ! _open_endpoint_socket() ) return false;
+
+        return _broadcast_udp_message(&_endpoint_socket, a_msg, endpoints);
+    }
+
+    bool broadcast_message(const string &a_msg, server_socket svr, const vector<udp_endpoint> &endpoints)
+    {
+        if (INVALID_PTR(svr, SERVER_SOCKET_PTR) || svr->protocol != UDP)
         {
-            send_message_to(a_msg, udp_connection.second);
+            LOG(WARNING) << "Invalid or non UDP server_socket passed to broadcast message.";
+            return false;
         }
+
+        _network_io_guard lock(_network_io_lock);
+        if ( ! _broadcast_udp_message(&svr->socket, a_msg, endpoints) ) return false;
+
+        svr->stats.bytes_out += a_msg.size() * endpoints.size();
+        svr->stats.messages_out += endpoints.size();
+        return true;
     }
 
     void broadcast_message(const string &a_msg, const string &name)
@@ -789,9 +2527,12 @@ namespace splashkit_lib
             return;
         }
 
+        _tcp_frames frames = { a_msg.data(), a_msg.length() };
+
+        _network_io_guard lock(_network_io_lock);
         for (auto const& tcp_connection: svr->connections)
         {
-            send_message_to(a_msg, tcp_connection);
+            _queue_tcp_message(tcp_connection, frames);
         }
     }
 
@@ -802,6 +2543,8 @@ namespace splashkit_lib
             return;
         }
 
+        _take_incoming(svr->messages, svr->incoming);
+        for (message m : svr->messages) close_message(m);
         svr->messages.clear();
     }
 
@@ -812,6 +2555,12 @@ namespace splashkit_lib
             return;
         }
 
+        _take_incoming(a_connection->messages, a_connection->incoming);
+        for (message m : a_connection->messages)
+        {
+            a_connection->message_bytes -= _message_bytes(m);
+            close_message(m);
+        }
         a_connection->messages.clear();
     }
 
@@ -836,7 +2585,7 @@ namespace splashkit_lib
         }
 
         msg->id = NONE_PTR;
-        delete msg;
+        _recycle_message(msg);
     }
 
     bool has_messages()
@@ -867,6 +2616,7 @@ namespace splashkit_lib
             return false;
         }
 
+        _take_incoming(con->messages, con->incoming);
         return !con->messages.empty();
     }
 
@@ -878,6 +2628,7 @@ namespace splashkit_lib
             return false;
         }
 
+        _take_incoming(svr->messages, svr->incoming);
         if ( !svr->messages.empty() )
         {
             return true;
@@ -928,6 +2679,7 @@ namespace splashkit_lib
             return -1;
         }
 
+        _take_incoming(con->messages, con->incoming);
         return static_cast<unsigned int>(con->messages.size());
     }
 
@@ -939,6 +2691,7 @@ namespace splashkit_lib
             return -1;
         }
 
+        _take_incoming(svr->messages, svr->incoming);
         return static_cast<unsigned int>(svr->messages.size());
     }
 
@@ -957,6 +2710,119 @@ namespace splashkit_lib
         return result;
     }
 
+    //
+    // Binary values in messages are little endian, and are put together a
+    // byte at a time so that they read the same on any machine.
+    //
+    static bool _message_has_bytes(message msg, unsigned int offset, unsigned int count, const char *caller)
+    {
+        if (INVALID_PTR(msg, MESSAGE_PTR))
+        {
+            LOG(ERROR) << "Invalid message passed to " << caller;
+            return false;
+        }
+
+        if (static_cast<unsigned long>(offset) + count > msg->data.size())
+        {
+            LOG(WARNING) << "Reading past the end of a message in " << caller << ", offset " << offset << " of a " << msg->data.size() << " byte message";
+            return false;
+        }
+
+        return true;
+    }
+
+    static uint64_t _read_le(const int8_t *data, unsigned int count)
+    {
+        uint64_t result = 0;
+        for (unsigned int i = 0; i < count; i++)
+            result |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+        return result;
+    }
+
+    static void _append_le(vector<int8_t> &bytes, uint64_t value, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++)
+            bytes.push_back(static_cast<int8_t>((value >> (8 * i)) & 0xFF));
+    }
+
+    int16_t message_read_int16(message msg, unsigned int offset)
+    {
+        if ( ! _message_has_bytes(msg, offset, 2, "message_read_int16") ) return 0;
+        return static_cast<int16_t>(_read_le(&msg->data[offset], 2));
+    }
+
+    int32_t message_read_int32(message msg, unsigned int offset)
+    {
+        if ( ! _message_has_bytes(msg, offset, 4, "message_read_int32") ) return 0;
+        return static_cast<int32_t>(_read_le(&msg->data[offset], 4));
+    }
+
+    uint32_t message_read_uint32(message msg, unsigned int offset)
+    {
+        if ( ! _message_has_bytes(msg, offset, 4, "message_read_uint32") ) return 0;
+        return static_cast<uint32_t>(_read_le(&msg->data[offset], 4));
+    }
+
+    int64_t message_read_int64(message msg, unsigned int offset)
+    {
+        if ( ! _message_has_bytes(msg, offset, 8, "message_read_int64") ) return 0;
+        return static_cast<int64_t>(_read_le(&msg->data[offset], 8));
+    }
+
+    float message_read_float(message msg, unsigned int offset)
+    {
+        if ( ! _message_has_bytes(msg, offset, 4, "message_read_float") ) return 0;
+
+        uint32_t bits = static_cast<uint32_t>(_read_le(&msg->data[offset], 4));
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    double message_read_double(message msg, unsigned int offset)
+    {
+        if ( ! _message_has_bytes(msg, offset, 8, "message_read_double") ) return 0;
+
+        uint64_t bits = _read_le(&msg->data[offset], 8);
+        double result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    void append_message_int16(vector<int8_t> &out_bytes, int16_t value)
+    {
+        _append_le(out_bytes, static_cast<uint16_t>(value), 2);
+    }
+
+    void append_message_int32(vector<int8_t> &out_bytes, int32_t value)
+    {
+        _append_le(out_bytes, static_cast<uint32_t>(value), 4);
+    }
+
+    void append_message_uint32(vector<int8_t> &out_bytes, uint32_t value)
+    {
+        _append_le(out_bytes, value, 4);
+    }
+
+    void append_message_int64(vector<int8_t> &out_bytes, int64_t value)
+    {
+        _append_le(out_bytes, static_cast<uint64_t>(value), 8);
+    }
+
+    void append_message_float(vector<int8_t> &out_bytes, float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        _append_le(out_bytes, bits, 4);
+    }
+
+    void append_message_double(vector<int8_t> &out_bytes, double value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        _append_le(out_bytes, bits, 8);
+    }
+
     vector<int8_t> message_data_bytes(message msg)
     {
         if (INVALID_PTR(msg, MESSAGE_PTR))
@@ -1002,10 +2868,26 @@ namespace splashkit_lib
         return msg->protocol;
     }
 
-    message _pop_message(vector<message> &messages)
+    int message_channel(message msg)
+    {
+        if (INVALID_PTR(msg, MESSAGE_PTR))
+        {
+            LOG(ERROR) << "Invalid message passed to get message channel";
+            return -1;
+        }
+
+        return msg->channel;
+    }
+
+    message _pop_message(deque<message> &messages, network_stats &stats, std::atomic<size_t> *held_bytes = nullptr)
     {
         message first = messages.front();
-        messages.erase(messages.begin());
+        messages.pop_front();
+        if (held_bytes) *held_bytes -= _message_bytes(first);
+
+        double waited = (_now_ns() - first->arrived) / 1e9;
+        if (waited > stats.max_queue_latency) stats.max_queue_latency = waited;
+
         return first;
     }
 
@@ -1017,7 +2899,54 @@ namespace splashkit_lib
             return nullptr;
         }
 
-        return _pop_message(con->messages);
+        _take_incoming(con->messages, con->incoming);
+        if (con->messages.empty()) return nullptr;
+
+        return _pop_message(con->messages, con->stats, &con->message_bytes);
+    }
+
+    // Take the first message of the channel, leaving those of other channels in order
+    static message _pop_channel_message(deque<message> &messages, network_stats &stats, int channel, std::atomic<size_t> *held_bytes = nullptr)
+    {
+        for (auto it = messages.begin(); it != messages.end(); ++it)
+        {
+            if ( (*it)->channel != channel ) continue;
+
+            message result = *it;
+            messages.erase(it);
+            if (held_bytes) *held_bytes -= _message_bytes(result);
+
+            double waited = (_now_ns() - result->arrived) / 1e9;
+            if (waited > stats.max_queue_latency) stats.max_queue_latency = waited;
+            return result;
+        }
+        return nullptr;
+    }
+
+    message read_message(connection con, int channel)
+    {
+        if (INVALID_PTR(con, CONNECTION_PTR))
+        {
+            LOG(ERROR) << "Invalid connection passed to read message";
+            return nullptr;
+        }
+
+        if (con->protocol == TCP) return read_message(con);
+
+        _take_incoming(con->messages, con->incoming);
+        return _pop_channel_message(con->messages, con->stats, channel, &con->message_bytes);
+    }
+
+    message read_message(server_socket svr, int channel)
+    {
+        if (INVALID_PTR(svr, SERVER_SOCKET_PTR))
+        {
+            LOG(ERROR) << "Invalid server passed to read_message";
+            return nullptr;
+        }
+
+        _take_incoming(svr->messages, svr->incoming);
+        return _pop_channel_message(svr->messages, svr->stats, channel);
     }
 
     message read_message(const string &name)
@@ -1042,9 +2971,10 @@ namespace splashkit_lib
             }
         }
 
+        _take_incoming(svr->messages, svr->incoming);
         if (svr->messages.size() > 0)
         {
-            return _pop_message(svr->messages);
+            return _pop_message(svr->messages, svr->stats);
         }
 
         return nullptr;
@@ -1059,7 +2989,7 @@ namespace splashkit_lib
         }
         for (auto const& con: _connections)
         {
-            if ( con.second->messages.size() > 0 )
+            if ( has_messages(con.second) )
                 return read_message(con.second);
         }
         
@@ -1130,53 +3060,25 @@ namespace splashkit_lib
         return result;
     }
 
-    bool send_message_to(const string &msg, connection con)
+    bool _send_message_bytes(connection con, const char *data, unsigned long size)
     {
-        if (INVALID_PTR(con, CONNECTION_PTR) || !con->open)
-        {
-            LOG(WARNING) << "Invalid connection or closed connection passed to send_message_to";
-            return false;
-        }
-
         if (con->protocol == TCP)
         {
-            unsigned long n = msg.length();
-            byte size[4];
-            size[0] = (n >> 24) & 0xFF;
-            size[1] = (n >> 16) & 0xFF;
-            size[2] = (n >> 8) & 0xFF;
-            size[3] = n & 0xFF;
-
-            unsigned long len = msg.size() + 4;
-            char buffer[len];
-
-            for (int i = 0; i < len; ++i)
-            {
-                if (i < 4)
-                {
-                    buffer[i] = size[i];
-                }
-                else
-                {
-                    buffer[i] = byte(msg[i - 4]);
-                }
-            }
-
-            if (sk_send_bytes(&con->socket, buffer, len) == len)
-            {
-                return true;
-            }
-            else
-            {
-                LOG(DEBUG) << "Shutting the connection as no bytes sent";
-                shut_connection(con);
-            }
+            _network_io_guard lock(_network_io_lock);
+            _tcp_frames frames = { data, size };
+            return _queue_tcp_message(con, frames);
         }
         else // UDP
         {
-            if (msg.size() < 1024)
+            string escaped;
+            _escape_udp_payload(data, size, escaped);
+
+            if (size < 1024)
             {
-                sk_send_udp_message(&con->socket, con->string_ip.c_str(), con->port, msg.c_str(), msg.length());
+                _send_udp_bytes(con, data, size);
+
+                con->stats.bytes_out += size;
+                con->stats.messages_out++;
                 return true;
             }
             else
@@ -1188,11 +3090,115 @@ namespace splashkit_lib
         return false;
     }
 
+    bool send_message_to(const string &msg, connection con)
+    {
+        if (INVALID_PTR(con, CONNECTION_PTR) || !con->open)
+        {
+            LOG(WARNING) << "Invalid connection or closed connection passed to send_message_to";
+            return false;
+        }
+
+        return _send_message_bytes(con, msg.data(), msg.length());
+    }
+
+    bool send_message_to(const string &msg, connection con, int channel)
+    {
+        if (INVALID_PTR(con, CONNECTION_PTR) || !con->open)
+        {
+            LOG(WARNING) << "Invalid connection or closed connection passed to send_message_to";
+            return false;
+        }
+
+        if (con->protocol == TCP) return _send_message_bytes(con, msg.data(), msg.length());
+
+        lock_guard<mutex> lock(_reliable_lock);
+        _reliable_peer &peer = _reliable_peer_for(con, nullptr, 0, 0);
+        if ( ! _send_reliable_message(peer, channel, msg.data(), msg.length()) ) return false;
+
+        con->stats.messages_out++;
+        return true;
+    }
+
+    bool send_message_to(const string &msg, server_socket svr, udp_endpoint ep, int channel)
+    {
+        if (INVALID_PTR(svr, SERVER_SOCKET_PTR) || svr->protocol != UDP)
+        {
+            LOG(WARNING) << "Invalid or TCP server passed to send_message_to on a reliable channel";
+            return false;
+        }
+
+        if (INVALID_PTR(ep, UDP_ENDPOINT_PTR))
+        {
+            LOG(WARNING) << "Invalid udp_endpoint passed to send_message_to";
+            return false;
+        }
+
+        lock_guard<mutex> lock(_reliable_lock);
+        _reliable_peer &peer = _reliable_peer_for(nullptr, svr, ep->address, ep->address_port);
+        if ( ! _send_reliable_message(peer, channel, msg.data(), msg.length()) ) return false;
+
+        svr->stats.messages_out++;
+        return true;
+    }
+
+    bool send_message_bytes(connection con, const vector<int8_t> &bytes)
+    {
+        if (INVALID_PTR(con, CONNECTION_PTR) || !con->open)
+        {
+            LOG(WARNING) << "Invalid connection or closed connection passed to send_message_bytes";
+            return false;
+        }
+
+        return _send_message_bytes(con, reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    }
+
+    bool send_message_to(const string &msg, udp_endpoint ep)
+    {
+        if (INVALID_PTR(ep, UDP_ENDPOINT_PTR))
+        {
+            LOG(WARNING) << "Invalid udp_endpoint passed to send_message_to";
+            return false;
+        }
+
+        const char *data = msg.data();
+        unsigned long size = msg.size();
+        string escaped;
+        _escape_udp_payload(data, size, escaped);
+
+        if (size >= 1024)
+        {
+            LOG(ERROR) << "Cannot send messages longer than 1024 bytes using UDP -- message ignored";
+            return false;
+        }
+
+        _network_io_guard lock(_network_io_lock);
+        if ( ! _open_endpoint_socket() ) return false;
+
+        return sk_send_udp_to(&_endpoint_socket, ep->address, ep->address_port, data, size) > 0;
+    }
+
     bool send_message_to(const string &a_msg, const string &name)
     {
         return send_message_to(a_msg, connection_named(name));
     }
 
+    bool send_json_message_to(json j, json_format format, connection a_connection)
+    {
+        vector<int8_t> bytes = json_to_bytes(j, format);
+        return send_message_to(string(bytes.begin(), bytes.end()), a_connection);
+    }
+
+    json message_json(message msg, json_format format)
+    {
+        if (INVALID_PTR(msg, MESSAGE_PTR))
+        {
+            LOG(ERROR) << "Invalid message passed to message_json";
+            return create_json();
+        }
+
+        return json_from_bytes(msg->data, format);
+    }
+
     string name_for_connection(const string host, const unsigned int port)
     {
         stringstream str;
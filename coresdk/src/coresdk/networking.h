@@ -16,6 +16,7 @@
 #include <map>
 
 #include "types.h"
+#include "json.h"
 
 using std::string;
 using std::vector;
@@ -42,6 +43,38 @@ namespace splashkit_lib
         UNKNOWN
     };
 
+    /**
+     * What happens when a TCP message is sent to a connection whose queue of
+     * unsent messages is already at its limit.
+     *
+     * @constant DROP_NEW_MESSAGES  The new message is not sent, and the
+     *                              connection stays open.
+     * @constant CLOSE_SLOW_CONNECTION  The connection is closed, so a slow
+     *                                  client cannot hold on to memory.
+     */
+    enum send_queue_policy
+    {
+        DROP_NEW_MESSAGES,
+        CLOSE_SLOW_CONNECTION
+    };
+
+    /**
+     * How TCP messages sent to a connection are compressed. Small messages,
+     * and those that do not get smaller, are always sent as they are.
+     *
+     * @constant NO_COMPRESSION     Messages are sent as they are.
+     * @constant FAST_COMPRESSION   Messages are compressed quickly, for the
+     *                              least delay.
+     * @constant SMALL_COMPRESSION  Messages are compressed as much as
+     *                              possible, for the least bandwidth.
+     */
+    enum connection_compression
+    {
+        NO_COMPRESSION,
+        FAST_COMPRESSION,
+        SMALL_COMPRESSION
+    };
+
     /**
      * A message contains data that has been transferred between a client
      * connection and a server (or visa versa).
@@ -50,6 +83,36 @@ namespace splashkit_lib
      */
     typedef struct sk_message *message;
 
+    /**
+     * Counts of the traffic through a connection or server, to find slow
+     * clients and to size buffers.
+     *
+     * @field bytes_in          The bytes read from the network
+     * @field bytes_out         The bytes queued to send, after compression
+     * @field messages_in       The messages received
+     * @field messages_out      The messages sent
+     * @field queue_depth       The messages waiting to be read
+     * @field max_queue_latency The longest a message has waited before it
+     *                          was read, in seconds
+     * @field partial_frames    The times a read ended part way through a
+     *                          TCP message
+     * @field send_queue_bytes  The bytes waiting to be sent
+     * @field messages_resent   The reliable UDP messages sent again as they
+     *                          were not acknowledged in time
+     */
+    struct network_stats
+    {
+        unsigned long long bytes_in;
+        unsigned long long bytes_out;
+        unsigned long long messages_in;
+        unsigned long long messages_out;
+        unsigned int queue_depth;
+        double max_queue_latency;
+        unsigned long long partial_frames;
+        unsigned long long send_queue_bytes;
+        unsigned long long messages_resent;
+    };
+
     /**
      * A connection represents the communication channel from a client going to
      * a server. This can be used for the client and the server to send and
@@ -59,6 +122,15 @@ namespace splashkit_lib
      */
     typedef struct sk_connection_data *connection;
 
+    /**
+     * A UDP endpoint is a host and port whose address has already been
+     * looked up, so messages can be sent to it without resolving the host
+     * each time.
+     *
+     * @attribute class udp_endpoint
+     */
+    typedef struct sk_udp_endpoint_data *udp_endpoint;
+
     /**
      * A server represents a network resource that clients can connect to. The
      * server will receive messages from all of the client connections, and can
@@ -311,7 +383,8 @@ namespace splashkit_lib
     connection retrieve_connection(const string &name, int idx);
 
     /**
-     * Get a connection from the server.
+     * Get a connection from the server. Closing a connection moves another
+     * into its place, so indexes can change as connections close.
      *
      * @param  server The server
      * @param  idx  The index of the connection
@@ -329,7 +402,8 @@ namespace splashkit_lib
     void close_all_connections();
 
     /**
-     * Close the connection
+     * Close the connection. Messages still queued to send over TCP are sent
+     * first, waiting up to half a second for them to go.
      *
      * @param  a_connection The connection to close
      * @return              True if this succeeds.
@@ -358,6 +432,27 @@ namespace splashkit_lib
      */
     connection connection_named(const string &name);
 
+    /**
+     * A number that identifies the connection while it is open. Numbers are
+     * not reused straight away, so the number of a closed connection does
+     * not find a newer connection.
+     *
+     * @param  a_connection The connection
+     * @return              The connection's number, or 0 if it is invalid
+     *
+     * @attribute class connection
+     * @attribute getter id
+     */
+    unsigned int connection_id(connection a_connection);
+
+    /**
+     * Find a connection from its number, without searching.
+     *
+     * @param  id The number from `connection_id`
+     * @return    The connection, or nullptr if it has been closed
+     */
+    connection connection_with_id(unsigned int id);
+
     /**
      * Does the connection with the supplied name exist?
      *
@@ -439,7 +534,8 @@ namespace splashkit_lib
     void reconnect(const string &name);
 
     /**
-     * Attempt to reconnect the connection.
+     * Attempt to reconnect the connection. Messages still queued to send
+     * are sent on the old connection first, as when it is closed.
      *
      * @param a_connection The connection to reconnect
      *
@@ -491,7 +587,8 @@ namespace splashkit_lib
     void broadcast_message(const string &a_msg, const string &name);
 
     /**
-     * Broadcast a message to all connections of a server.
+     * Broadcast a message to all connections of a server. The message is
+     * encoded once and shared by all of the connections.
      *
      * @param a_msg The message to send
      * @param svr   The server to send the message to.
@@ -502,11 +599,78 @@ namespace splashkit_lib
      */
     void broadcast_message(const string &a_msg, server_socket svr);
 
+    /**
+     * Send a UDP message to each of the endpoints. The message is sent to
+     * all of them together, which is much faster than sending to each in
+     * turn.
+     *
+     * @param a_msg     The message to send, shorter than 1024 bytes
+     * @param endpoints The endpoints to send the message to
+     * @return          True if the message was sent to every endpoint
+     *
+     * @attribute suffix to_endpoints
+     */
+    bool broadcast_message(const string &a_msg, const vector<udp_endpoint> &endpoints);
+
+    /**
+     * Send a UDP message from a UDP server to each of the endpoints, so
+     * that their replies come back to the server.
+     *
+     * @param a_msg     The message to send, shorter than 1024 bytes
+     * @param svr       The UDP server to send the message from
+     * @param endpoints The endpoints to send the message to
+     * @return          True if the message was sent to every endpoint
+     *
+     * @attribute class server_socket
+     * @attribute method broadcast_message
+     * @attribute self svr
+     *
+     * @attribute suffix from_server_to_endpoints
+     */
+    bool broadcast_message(const string &a_msg, server_socket svr, const vector<udp_endpoint> &endpoints);
+
     /**
      * Check network activity, looking for new connections and messages.
      */
     void check_network_activity();
 
+    /**
+     * Start a background thread that reads from the network and prepares
+     * messages as they arrive. Messages are then handed over whenever you
+     * check for or read messages, and `check_network_activity` only needs to
+     * accept new connections. This needs event driven network checks, so it
+     * fails on platforms that do not support them.
+     *
+     * @returns True if the network thread is running
+     */
+    bool start_network_thread();
+
+    /**
+     * Start several background network threads, sharing accepted
+     * connections between them so that servers with many clients read in
+     * parallel. The first thread also accepts new connections, which are
+     * handed to the game thread as network activity is checked. More than
+     * one thread needs epoll or kqueue, so other platforms run a single
+     * network thread.
+     *
+     * @param  count The number of network threads to run
+     * @returns      True if the network threads are running
+     */
+    bool start_network_threads(int count);
+
+    /**
+     * Stop the background network thread, returning to reading messages
+     * when you call `check_network_activity`.
+     */
+    void stop_network_thread();
+
+    /**
+     * Checks if the background network thread is reading messages.
+     *
+     * @returns True if the network thread is running
+     */
+    bool network_thread_running();
+
     /**
      * Clear all of the messages from a server.
      *
@@ -645,6 +809,24 @@ namespace splashkit_lib
      */
     message read_message(connection a_connection);
 
+    /**
+     * Reads the first message received on a reliable channel of the
+     * connection, see `send_message_to` with a channel. Messages on each
+     * channel are read in the order they were sent. TCP connections are
+     * already reliable and ordered, so this reads their first message.
+     * Reading without a channel reads messages from all of the channels.
+     *
+     * @param  a_connection A connection
+     * @param  channel      The channel to read, from 0 to 15
+     * @return              The first message read from the channel
+     *
+     * @attribute class connection
+     * @attribute method read_message
+     *
+     * @attribute suffix from_channel
+     */
+    message read_message(connection a_connection, int channel);
+
     /**
      * Reads the first message from a connection or server.
      *
@@ -675,6 +857,21 @@ namespace splashkit_lib
      */
     message read_message(server_socket svr);
 
+    /**
+     * Reads the first message received by a UDP server on one of its
+     * reliable channels, from any of its clients.
+     *
+     * @param  svr     A UDP server
+     * @param  channel The channel to read, from 0 to 15
+     * @return         The first message read from the channel
+     *
+     * @attribute class server_socket
+     * @attribute method read_message
+     *
+     * @attribute suffix from_server_channel
+     */
+    message read_message(server_socket svr, int channel);
+
     /**
      * Gets the body of a message as a string.
      *
@@ -697,6 +894,132 @@ namespace splashkit_lib
      */
     vector<int8_t> message_data_bytes(message msg);
 
+    /**
+     * Read a little endian 16 bit integer from a message.
+     *
+     * @param  msg    The message to read from
+     * @param  offset The index of the first byte to read
+     * @return        The value read, or 0 if it is past the end of the message
+     *
+     * @attribute class message
+     * @attribute method read_int16
+     */
+    int16_t message_read_int16(message msg, unsigned int offset);
+
+    /**
+     * Read a little endian 32 bit integer from a message.
+     *
+     * @param  msg    The message to read from
+     * @param  offset The index of the first byte to read
+     * @return        The value read, or 0 if it is past the end of the message
+     *
+     * @attribute class message
+     * @attribute method read_int32
+     */
+    int32_t message_read_int32(message msg, unsigned int offset);
+
+    /**
+     * Read a little endian unsigned 32 bit integer from a message.
+     *
+     * @param  msg    The message to read from
+     * @param  offset The index of the first byte to read
+     * @return        The value read, or 0 if it is past the end of the message
+     *
+     * @attribute class message
+     * @attribute method read_uint32
+     */
+    uint32_t message_read_uint32(message msg, unsigned int offset);
+
+    /**
+     * Read a little endian 64 bit integer from a message.
+     *
+     * @param  msg    The message to read from
+     * @param  offset The index of the first byte to read
+     * @return        The value read, or 0 if it is past the end of the message
+     *
+     * @attribute class message
+     * @attribute method read_int64
+     */
+    int64_t message_read_int64(message msg, unsigned int offset);
+
+    /**
+     * Read a little endian 32 bit floating point number from a message.
+     *
+     * @param  msg    The message to read from
+     * @param  offset The index of the first byte to read
+     * @return        The value read, or 0 if it is past the end of the message
+     *
+     * @attribute class message
+     * @attribute method read_float
+     */
+    float message_read_float(message msg, unsigned int offset);
+
+    /**
+     * Read a little endian 64 bit floating point number from a message.
+     *
+     * @param  msg    The message to read from
+     * @param  offset The index of the first byte to read
+     * @return        The value read, or 0 if it is past the end of the message
+     *
+     * @attribute class message
+     * @attribute method read_double
+     */
+    double message_read_double(message msg, unsigned int offset);
+
+    /**
+     * Add a 16 bit integer to the end of message bytes, in little endian
+     * order for `message_read_int16`.
+     *
+     * @param out_bytes The bytes to add to
+     * @param value     The value to add
+     */
+    void append_message_int16(vector<int8_t> &out_bytes, int16_t value);
+
+    /**
+     * Add a 32 bit integer to the end of message bytes, in little endian
+     * order for `message_read_int32`.
+     *
+     * @param out_bytes The bytes to add to
+     * @param value     The value to add
+     */
+    void append_message_int32(vector<int8_t> &out_bytes, int32_t value);
+
+    /**
+     * Add an unsigned 32 bit integer to the end of message bytes, in little
+     * endian order for `message_read_uint32`.
+     *
+     * @param out_bytes The bytes to add to
+     * @param value     The value to add
+     */
+    void append_message_uint32(vector<int8_t> &out_bytes, uint32_t value);
+
+    /**
+     * Add a 64 bit integer to the end of message bytes, in little endian
+     * order for `message_read_int64`.
+     *
+     * @param out_bytes The bytes to add to
+     * @param value     The value to add
+     */
+    void append_message_int64(vector<int8_t> &out_bytes, int64_t value);
+
+    /**
+     * Add a 32 bit floating point number to the end of message bytes, in
+     * little endian order for `message_read_float`.
+     *
+     * @param out_bytes The bytes to add to
+     * @param value     The value to add
+     */
+    void append_message_float(vector<int8_t> &out_bytes, float value);
+
+    /**
+     * Add a 64 bit floating point number to the end of message bytes, in
+     * little endian order for `message_read_double`.
+     *
+     * @param out_bytes The bytes to add to
+     * @param value     The value to add
+     */
+    void append_message_double(vector<int8_t> &out_bytes, double value);
+
     /**
      * Returns the host who made the message.
      *
@@ -730,6 +1053,17 @@ namespace splashkit_lib
      */
     connection_type message_protocol(message msg);
 
+    /**
+     * Returns the reliable channel a message was sent on.
+     *
+     * @param  msg The message to check
+     * @return     The channel of the message, or -1 if it was not sent on a channel
+     *
+     * @attribute class message
+     * @attribute getter channel
+     */
+    int message_channel(message msg);
+
     /**
      * Read message data from a connection.
      *
@@ -767,11 +1101,12 @@ namespace splashkit_lib
     string read_message_data(const string &name);
 
     /**
-     * Send a message to the connection.
+     * Send a message to the connection. TCP messages the connection is not
+     * ready to take are queued, and sent as network activity is checked.
      *
      * @param  a_msg        The message to send
      * @param  a_connection The connection to send the message to
-     * @return              True if the message sends.
+     * @return              True if the message sends, or is queued to send.
      *
      * @attribute class connection
      * @attribute method send_message
@@ -781,6 +1116,31 @@ namespace splashkit_lib
      */
     bool send_message_to(const string &a_msg, connection a_connection);
 
+    /**
+     * Send a message to the connection on a reliable channel. On a UDP
+     * connection the message is sent again until the other end acknowledges
+     * it, and the messages on each channel are read in the order they were
+     * sent. Each channel is ordered on its own, so a lost message only holds
+     * up the later messages on its channel. TCP connections are already
+     * reliable and ordered, so the channel is not used.
+     *
+     * Both ends must send and read with channels for messages to be
+     * acknowledged. Up to 1024 messages can wait to be acknowledged on each
+     * channel.
+     *
+     * @param  a_msg        The message to send, shorter than 1012 bytes over UDP
+     * @param  a_connection The connection to send the message to
+     * @param  channel      The channel to send on, from 0 to 15
+     * @return              True if the message sends, or is queued to send.
+     *
+     * @attribute class connection
+     * @attribute method send_message
+     * @attribute self a_connection
+     *
+     * @attribute suffix connection_channel
+     */
+    bool send_message_to(const string &a_msg, connection a_connection, int channel);
+
     /**
      * Send a message to the connection with the given name.
      *
@@ -792,14 +1152,309 @@ namespace splashkit_lib
      */
     bool send_message_to(const string &a_msg, const string &name);
 
+    /**
+     * Send bytes as a message to the connection, without building a string
+     * first. Use the `append_message` functions to build up binary
+     * messages, and the `message_read` functions to read them back.
+     *
+     * @param  a_connection The connection to send the message to
+     * @param  bytes        The bytes to send
+     * @return              True if the message sends, or is queued to send
+     *
+     * @attribute class connection
+     * @attribute method send_bytes
+     * @attribute self a_connection
+     */
+    bool send_message_bytes(connection a_connection, const vector<int8_t> &bytes);
+
+    /**
+     * The number of bytes of TCP messages waiting to be sent on the
+     * connection. This grows when the other end is not reading as fast as
+     * messages are being sent.
+     *
+     * @param  a_connection The connection
+     * @return              The bytes waiting to be sent
+     *
+     * @attribute class connection
+     * @attribute getter send_queue_bytes
+     */
+    unsigned long connection_send_queue_bytes(connection a_connection);
+
+    /**
+     * Limit the bytes waiting to be sent on a connection. Messages sent when
+     * the queue is at the limit are dealt with by the policy.
+     *
+     * @param a_connection The connection
+     * @param max_bytes    The most bytes to queue, or 0 for no limit
+     * @param policy       What to do with messages sent once the queue is full
+     *
+     * @attribute class connection
+     * @attribute method set_send_queue_limit
+     */
+    void set_connection_send_queue_limit(connection a_connection, unsigned long max_bytes, send_queue_policy policy);
+
+    /**
+     * Set the send queue limit given to connections opened or accepted from
+     * now on. There is no limit by default.
+     *
+     * @param max_bytes The most bytes to queue, or 0 for no limit
+     * @param policy    What to do with messages sent once the queue is full
+     */
+    void set_default_send_queue_limit(unsigned long max_bytes, send_queue_policy policy);
+
+    /**
+     * Compress the TCP messages sent to a connection. Connections always
+     * read compressed messages, so only the sending end needs to turn this
+     * on, and each end can choose its own compression. Turning compression
+     * on sends the peer a short notice, and messages are only compressed
+     * once the peer answers it, so a peer that does not use SplashKit is
+     * sent messages uncompressed. The notice is a frame such a peer may not
+     * expect, so only turn this on for peers that use SplashKit.
+     *
+     * @param a_connection The connection
+     * @param compression  How to compress the messages sent
+     *
+     * @attribute class connection
+     * @attribute setter compression
+     */
+    void set_connection_compression(connection a_connection, connection_compression compression);
+
+    /**
+     * Set the compression given to connections opened or accepted from now
+     * on. Messages are not compressed by default.
+     *
+     * @param compression How to compress the messages sent
+     */
+    void set_default_connection_compression(connection_compression compression);
+
+    /**
+     * Set text that messages are expected to share, such as common json
+     * keys, so that even short messages compress well. Both ends of each
+     * connection must use the same dictionary. The dictionary can only be
+     * set once, before any messages are compressed.
+     *
+     * @param dictionary The shared text, or an empty string for none
+     */
+    void set_network_compression_dictionary(const string &dictionary);
+
+    /**
+     * The bytes sent on the connection after compression, divided by the
+     * bytes that would have been sent without it.
+     *
+     * @param  a_connection The connection
+     * @return              The compression ratio, 1 if nothing was compressed
+     *
+     * @attribute class connection
+     * @attribute getter compression_ratio
+     */
+    double connection_compression_ratio(connection a_connection);
+
+    /**
+     * The traffic through a connection since it opened, or since its
+     * statistics were reset.
+     *
+     * @param  a_connection The connection
+     * @return              The connection's statistics
+     *
+     * @attribute class connection
+     * @attribute getter statistics
+     */
+    network_stats connection_statistics(connection a_connection);
+
+    /**
+     * The traffic through a server and all of its connections. The latency
+     * is the longest of any of them.
+     *
+     * @param  svr The server
+     * @return     The totals for the server
+     *
+     * @attribute class server_socket
+     * @attribute getter statistics
+     */
+    network_stats server_statistics(server_socket svr);
+
+    /**
+     * Start counting a connection's traffic again from zero.
+     *
+     * @param a_connection The connection
+     *
+     * @attribute class connection
+     * @attribute method reset_statistics
+     */
+    void reset_connection_statistics(connection a_connection);
+
+    /**
+     * Start counting the traffic of a server, and of its connections, again
+     * from zero.
+     *
+     * @param svr The server
+     *
+     * @attribute class server_socket
+     * @attribute method reset_statistics
+     */
+    void reset_server_statistics(server_socket svr);
+
+    /**
+     * Choose whether messages sent to a connection are sent straight away,
+     * or held until network activity is next checked. Holding messages lets
+     * many small messages go out together in one write. Messages still held
+     * are sent when the connection is closed or reconnected.
+     *
+     * @param a_connection The connection
+     * @param coalesce     True to hold messages until network activity is
+     *                     checked
+     *
+     * @attribute class connection
+     * @attribute setter coalesce_sends
+     */
+    void set_connection_coalesce_sends(connection a_connection, bool coalesce);
+
+    /**
+     * Choose whether the operating system sends small TCP packets straight
+     * away, or waits briefly to combine them (Nagle's algorithm).
+     *
+     * @param a_connection The connection
+     * @param no_delay     True to send small packets without waiting
+     * @return             True if the setting was changed
+     *
+     * @attribute class connection
+     * @attribute method set_no_delay
+     */
+    bool set_connection_no_delay(connection a_connection, bool no_delay);
+
+    /**
+     * Look up the address of a host, so that UDP messages can be sent to it
+     * quickly. Endpoints are cached, so resolving the same host and port
+     * again returns the same endpoint without another lookup.
+     *
+     * @param  host The name or ip address of the host
+     * @param  port The port to send messages to
+     * @return      The endpoint, or nullptr if the host cannot be resolved
+     *
+     * @attribute class udp_endpoint
+     * @attribute constructor true
+     */
+    udp_endpoint resolve_endpoint(const string &host, unsigned short int port);
+
+    /**
+     * The host an endpoint was resolved from.
+     *
+     * @param  ep The endpoint
+     * @return    The host name or ip address
+     *
+     * @attribute class udp_endpoint
+     * @attribute getter host
+     */
+    string endpoint_host(udp_endpoint ep);
+
+    /**
+     * The port messages are sent to at an endpoint.
+     *
+     * @param  ep The endpoint
+     * @return    The port number
+     *
+     * @attribute class udp_endpoint
+     * @attribute getter port
+     */
+    unsigned short int endpoint_port(udp_endpoint ep);
+
+    /**
+     * Send a UDP message to an endpoint. All endpoints share a single UDP
+     * socket, and replies to that socket are not read. Use a UDP connection
+     * when you need to read replies.
+     *
+     * @param  a_msg The message to send, shorter than 1024 bytes
+     * @param  ep    The endpoint to send the message to
+     * @return       True if the message sends
+     *
+     * @attribute class udp_endpoint
+     * @attribute method send_message
+     * @attribute self ep
+     *
+     * @attribute suffix endpoint
+     */
+    bool send_message_to(const string &a_msg, udp_endpoint ep);
+
+    /**
+     * Send a message from a UDP server to one of its clients on a reliable
+     * channel, see `send_message_to` with a connection and channel. Use
+     * `resolve_endpoint` with the host and port of a message to reply to its
+     * sender.
+     *
+     * A server keeps the channels of up to 256 clients, each added when it
+     * first sends on a channel, and forgets a client once it has sent
+     * nothing for a minute.
+     *
+     * @param  a_msg   The message to send, shorter than 1012 bytes
+     * @param  svr     The UDP server to send from
+     * @param  ep      The endpoint of the client
+     * @param  channel The channel to send on, from 0 to 15
+     * @return         True if the message sends
+     *
+     * @attribute class server_socket
+     * @attribute method send_message
+     * @attribute self svr
+     *
+     * @attribute suffix server_channel
+     */
+    bool send_message_to(const string &a_msg, server_socket svr, udp_endpoint ep, int channel);
+
+    /**
+     * Free all of the resolved endpoints, and the socket used to send to
+     * them. Endpoints must be resolved again after this.
+     */
+    void release_all_endpoints();
+
+    /**
+     * Send a `json` object to the connection, encoded in the indicated
+     * format. Use `message_json` with the same format to read it.
+     *
+     * @param  j            The json to send
+     * @param  format       The format to encode the json in
+     * @param  a_connection The connection to send the message to
+     * @return              True if the message sends.
+     *
+     * @attribute class connection
+     * @attribute method send_json
+     * @attribute self a_connection
+     */
+    bool send_json_message_to(json j, json_format format, connection a_connection);
+
+    /**
+     * Reads the body of a message as a `json` object, such as one sent with
+     * `send_json_message_to`. You need to free the result.
+     *
+     * @param  msg    The message to read
+     * @param  format The format the json was sent in
+     * @return        A new `json` object, which is empty if the message is not valid json
+     *
+     * @attribute class message
+     * @attribute method to_json
+     * @attribute self msg
+     */
+    json message_json(message msg, json_format format);
+
     /**
      * Returns the connection that sent a message.
      *
      * @param  msg The message
-     * @return     The connection that sent the message
+     * @return     The connection that sent the message, or nullptr if it
+     *             has since closed
      */
     connection message_connection(message msg);
 
+    /**
+     * Returns the number of the connection that sent a message, for use as
+     * a key in your own records.
+     *
+     * @param  msg The message
+     * @return     The connection_id of the sender, or 0 for UDP messages
+     *
+     * @attribute class message
+     * @attribute getter connection_id
+     */
+    unsigned int message_connection_id(message msg);
+
     /**
      * Returns the name SplashKit would use for a connection made to a server
      * from a host to a port.
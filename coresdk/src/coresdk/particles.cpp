@@ -0,0 +1,418 @@
+//
+//  particles.cpp
+//  splashkit
+//
+//  Particles are stored as a structure of arrays, with the live particles
+//  packed at the front, so the update loops run straight through memory
+//  and can be vectorised by the compiler. Particles that die are replaced
+//  by the last live particle.
+//
+
+#include "particles.h"
+
+#include "drawing_options.h"
+#include "images.h"
+#include "random.h"
+
+#include "backend_types.h"
+#include "concurrency_utils.h"
+#include "graphics_driver.h"
+#include "resource_tracking.h"
+#include "utility_functions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// Emitters with fewer live particles than this are updated on the calling thread
+#define PARTICLE_PARALLEL_MIN_COUNT 16384
+// The number of particles each thread takes at a time
+#define PARTICLE_CHUNK 4096
+
+namespace splashkit_lib
+{
+    struct _particle_emitter_data
+    {
+        pointer_identifier id;
+        bitmap bmp;
+        int capacity;
+        int count;              // live particles, packed at the front of each array
+
+        // particle details, each array holds capacity values
+        vector<float> x, y;
+        vector<float> vx, vy;
+        vector<float> age, life;
+
+        point_2d position;
+        double rate;            // particles released per second
+        double carry;           // part of a particle left from the last update
+        double min_life, max_life;
+        double angle, spread;
+        double min_speed, max_speed;
+        vector_2d gravity;
+        color start_color, end_color;
+        double start_scale, end_scale;
+    };
+
+    particle_emitter create_particle_emitter(bitmap particle_bitmap, int capacity)
+    {
+        if ( INVALID_PTR(particle_bitmap, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to create particle emitter with invalid bitmap";
+            return nullptr;
+        }
+
+        if ( capacity <= 0 )
+        {
+            LOG(WARNING) << "Trying to create particle emitter with a capacity of " << capacity;
+            return nullptr;
+        }
+
+        particle_emitter result = new _particle_emitter_data;
+        result->id = PARTICLE_EMITTER_PTR;
+        result->bmp = particle_bitmap;
+        result->capacity = capacity;
+        result->count = 0;
+
+        size_t size = static_cast<size_t>(capacity);
+        result->x.resize(size);
+        result->y.resize(size);
+        result->vx.resize(size);
+        result->vy.resize(size);
+        result->age.resize(size);
+        result->life.resize(size);
+
+        result->position = { 0, 0 };
+        result->rate = 0;
+        result->carry = 0;
+        result->min_life = 1;
+        result->max_life = 1;
+        result->angle = -90;
+        result->spread = 180;
+        result->min_speed = 50;
+        result->max_speed = 100;
+        result->gravity = { 0, 0 };
+        result->start_color = { 1.0f, 1.0f, 1.0f, 1.0f };
+        result->end_color = { 1.0f, 1.0f, 1.0f, 0.0f };
+        result->start_scale = 1;
+        result->end_scale = 1;
+
+        return result;
+    }
+
+    void free_particle_emitter(particle_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to free particle emitter with invalid pointer";
+            return;
+        }
+
+        notify_of_free(emitter);
+
+        emitter->id = NONE_PTR;
+        delete emitter;
+    }
+
+    void particle_emitter_set_position(particle_emitter emitter, const point_2d &pos)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to move an invalid particle emitter";
+            return;
+        }
+
+        emitter->position = pos;
+    }
+
+    point_2d particle_emitter_position(particle_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to get the position of an invalid particle emitter";
+            return { 0, 0 };
+        }
+
+        return emitter->position;
+    }
+
+    void particle_emitter_set_rate(particle_emitter emitter, double per_second)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the rate of an invalid particle emitter";
+            return;
+        }
+
+        emitter->rate = std::max(0.0, per_second);
+    }
+
+    void particle_emitter_set_lifetime(particle_emitter emitter, double min_seconds, double max_seconds)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the lifetime of an invalid particle emitter";
+            return;
+        }
+
+        if ( max_seconds < min_seconds ) std::swap(min_seconds, max_seconds);
+
+        emitter->min_life = std::max(0.0, min_seconds);
+        emitter->max_life = std::max(0.0, max_seconds);
+    }
+
+    void particle_emitter_set_velocity(particle_emitter emitter, double angle, double spread, double min_speed, double max_speed)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the velocity of an invalid particle emitter";
+            return;
+        }
+
+        if ( max_speed < min_speed ) std::swap(min_speed, max_speed);
+
+        emitter->angle = angle;
+        emitter->spread = std::abs(spread);
+        emitter->min_speed = min_speed;
+        emitter->max_speed = max_speed;
+    }
+
+    void particle_emitter_set_gravity(particle_emitter emitter, const vector_2d &gravity)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the gravity of an invalid particle emitter";
+            return;
+        }
+
+        emitter->gravity = gravity;
+    }
+
+    void particle_emitter_set_colors(particle_emitter emitter, color start_color, color end_color)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the colors of an invalid particle emitter";
+            return;
+        }
+
+        emitter->start_color = start_color;
+        emitter->end_color = end_color;
+    }
+
+    void particle_emitter_set_sizes(particle_emitter emitter, double start_scale, double end_scale)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the sizes of an invalid particle emitter";
+            return;
+        }
+
+        emitter->start_scale = start_scale;
+        emitter->end_scale = end_scale;
+    }
+
+    // Add up to count new particles at the emitter's position
+    static void _spawn_particles(particle_emitter emitter, int count)
+    {
+        count = std::min(count, emitter->capacity - emitter->count);
+        if ( count <= 0 ) return;
+
+        // three random numbers for each particle: lifetime, direction and speed
+        static vector<float> random;
+        random.resize(static_cast<size_t>(count) * 3);
+        rnd_fill(random);
+
+        float px = static_cast<float>(emitter->position.x);
+        float py = static_cast<float>(emitter->position.y);
+
+        for (int i = 0; i < count; i++)
+        {
+            int p = emitter->count + i;
+            const float *r = &random[static_cast<size_t>(i) * 3];
+
+            double life = emitter->min_life + r[0] * (emitter->max_life - emitter->min_life);
+            double angle = deg_to_rad(emitter->angle + (r[1] * 2 - 1) * emitter->spread);
+            double speed = emitter->min_speed + r[2] * (emitter->max_speed - emitter->min_speed);
+
+            emitter->x[p] = px;
+            emitter->y[p] = py;
+            emitter->vx[p] = static_cast<float>(std::cos(angle) * speed);
+            emitter->vy[p] = static_cast<float>(std::sin(angle) * speed);
+            emitter->age[p] = 0;
+            emitter->life[p] = static_cast<float>(life);
+        }
+
+        emitter->count += count;
+    }
+
+    void emit_particles(particle_emitter emitter, int count)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to emit particles from an invalid particle emitter";
+            return;
+        }
+
+        _spawn_particles(emitter, count);
+    }
+
+    // Move particles [begin, end) on by dt seconds
+    static void _integrate_particles(particle_emitter emitter, size_t begin, size_t end, float dt)
+    {
+        float *x = emitter->x.data(), *y = emitter->y.data();
+        float *vx = emitter->vx.data(), *vy = emitter->vy.data();
+        float *age = emitter->age.data();
+
+        float gx = static_cast<float>(emitter->gravity.x) * dt;
+        float gy = static_cast<float>(emitter->gravity.y) * dt;
+
+        for (size_t i = begin; i < end; i++)
+        {
+            vx[i] += gx;
+            vy[i] += gy;
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+            age[i] += dt;
+        }
+    }
+
+    void update_particle_emitter(particle_emitter emitter, double seconds)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to update an invalid particle emitter";
+            return;
+        }
+
+        if ( seconds <= 0 ) return;
+
+        float dt = static_cast<float>(seconds);
+        size_t count = static_cast<size_t>(emitter->count);
+
+        if ( count < PARTICLE_PARALLEL_MIN_COUNT )
+            _integrate_particles(emitter, 0, count, dt);
+        else
+        {
+            parallel_for(shared_worker_pool(), count, PARTICLE_CHUNK, [emitter, dt](size_t begin, size_t end, size_t)
+            {
+                _integrate_particles(emitter, begin, end, dt);
+            });
+        }
+
+        // replace particles whose lifetime has ended with the last live particle
+        int i = 0;
+        while ( i < emitter->count )
+        {
+            if ( emitter->age[i] < emitter->life[i] )
+            {
+                i++;
+                continue;
+            }
+
+            int last = --emitter->count;
+            emitter->x[i] = emitter->x[last];
+            emitter->y[i] = emitter->y[last];
+            emitter->vx[i] = emitter->vx[last];
+            emitter->vy[i] = emitter->vy[last];
+            emitter->age[i] = emitter->age[last];
+            emitter->life[i] = emitter->life[last];
+        }
+
+        // release new particles at the emitter's rate
+        emitter->carry += emitter->rate * seconds;
+        int released = static_cast<int>(emitter->carry);
+        emitter->carry -= released;
+
+        _spawn_particles(emitter, released);
+    }
+
+    void draw_particle_emitter(particle_emitter emitter, const drawing_options &opts)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to draw an invalid particle emitter";
+            return;
+        }
+
+        if ( INVALID_PTR(emitter->bmp, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to draw a particle emitter whose bitmap has been freed";
+            return;
+        }
+
+        if ( emitter->count == 0 ) return;
+
+        sk_drawing_surface *surface = to_surface_ptr(opts.dest);
+        if ( ! surface ) return;
+
+        // the camera moves every particle by the same amount
+        double offset_x = 0, offset_y = 0;
+        xy_from_opts(opts, offset_x, offset_y);
+
+        _resource_used(emitter->bmp);
+
+        double w = emitter->bmp->image.surface.width;
+        double h = emitter->bmp->image.surface.height;
+
+        const color &c0 = emitter->start_color, &c1 = emitter->end_color;
+
+        // reused between calls, so drawing each frame does not allocate
+        static vector<sk_bitmap_quad> quads;
+        quads.resize(static_cast<size_t>(emitter->count));
+
+        for (int i = 0; i < emitter->count; i++)
+        {
+            float life = emitter->life[i];
+            float t = life > 0 ? std::min(1.0f, emitter->age[i] / life) : 1.0f;
+            double scale = emitter->start_scale + t * (emitter->end_scale - emitter->start_scale);
+
+            sk_bitmap_quad &quad = quads[i];
+            quad.src_x = 0;
+            quad.src_y = 0;
+            quad.src_w = w;
+            quad.src_h = h;
+            quad.x = emitter->x[i] + offset_x - w / 2;
+            quad.y = emitter->y[i] + offset_y - h / 2;
+            quad.angle = 0;
+            quad.scale_x = scale;
+            quad.scale_y = scale;
+            quad.tint = {
+                c0.r + t * (c1.r - c0.r),
+                c0.g + t * (c1.g - c0.g),
+                c0.b + t * (c1.b - c0.b),
+                c0.a + t * (c1.a - c0.a)
+            };
+        }
+
+        sk_draw_bitmap_quads(&emitter->bmp->image.surface, surface, quads.data(), static_cast<int>(quads.size()));
+    }
+
+    void draw_particle_emitter(particle_emitter emitter)
+    {
+        draw_particle_emitter(emitter, option_defaults());
+    }
+
+    int particle_count(particle_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to count the particles of an invalid particle emitter";
+            return 0;
+        }
+
+        return emitter->count;
+    }
+
+    void clear_particles(particle_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to clear the particles of an invalid particle emitter";
+            return;
+        }
+
+        emitter->count = 0;
+        emitter->carry = 0;
+    }
+}
@@ -0,0 +1,228 @@
+/**
+ * @header  particles
+ * @brief   Particle emitters draw many short lived copies of a bitmap, for effects like smoke, sparks and rain.
+ *
+ * A particle emitter releases particles from its position, each with its
+ * own speed and direction. Particles fall under the emitter's gravity,
+ * change color and size over their lifetime, and disappear when their
+ * lifetime ends. The emitter holds a fixed number of particles, so it never
+ * needs to allocate memory once it is created, and all of its particles are
+ * drawn together in a single draw.
+ *
+ * @attribute group  graphics
+ * @attribute static particles
+ */
+
+#ifndef particles_h
+#define particles_h
+
+#include "types.h"
+
+namespace splashkit_lib
+{
+    /**
+     * A particle emitter releases, moves and draws particles.
+     *
+     * @attribute class particle_emitter
+     */
+    typedef struct _particle_emitter_data *particle_emitter;
+
+    /**
+     * Create a particle emitter that draws its particles with the bitmap.
+     * The emitter starts at 0,0 and releases no particles until you set its
+     * rate or call `emit_particles`.
+     *
+     * @param particle_bitmap The bitmap to draw each particle with
+     * @param capacity        The most particles that can be alive at once
+     * @return                The new particle emitter, or nullptr if the
+     *                        bitmap is invalid
+     *
+     * @attribute class particle_emitter
+     * @attribute constructor true
+     */
+    particle_emitter create_particle_emitter(bitmap particle_bitmap, int capacity);
+
+    /**
+     * Free the particle emitter and its particles.
+     *
+     * @param emitter The particle emitter to free
+     *
+     * @attribute class particle_emitter
+     * @attribute destructor true
+     */
+    void free_particle_emitter(particle_emitter emitter);
+
+    /**
+     * Move the point new particles are released from.
+     *
+     * @param emitter The particle emitter
+     * @param pos     The new position of the emitter
+     *
+     * @attribute class particle_emitter
+     * @attribute setter position
+     */
+    void particle_emitter_set_position(particle_emitter emitter, const point_2d &pos);
+
+    /**
+     * The point new particles are released from.
+     *
+     * @param emitter The particle emitter
+     * @return        The position of the emitter
+     *
+     * @attribute class particle_emitter
+     * @attribute getter position
+     */
+    point_2d particle_emitter_position(particle_emitter emitter);
+
+    /**
+     * Set how many particles the emitter releases each second as it is
+     * updated.
+     *
+     * @param emitter     The particle emitter
+     * @param per_second  The number of particles to release each second, 0
+     *                    to stop releasing particles
+     *
+     * @attribute class particle_emitter
+     * @attribute setter rate
+     */
+    void particle_emitter_set_rate(particle_emitter emitter, double per_second);
+
+    /**
+     * Set how long new particles live for. Each particle is given a random
+     * lifetime in the range.
+     *
+     * @param emitter     The particle emitter
+     * @param min_seconds The shortest lifetime
+     * @param max_seconds The longest lifetime
+     *
+     * @attribute class particle_emitter
+     * @attribute method set_lifetime
+     */
+    void particle_emitter_set_lifetime(particle_emitter emitter, double min_seconds, double max_seconds);
+
+    /**
+     * Set the direction and speed of new particles. Each particle moves at a
+     * random angle within the spread either side of the angle, at a random
+     * speed in the range.
+     *
+     * @param emitter   The particle emitter
+     * @param angle     The direction to release particles in, in degrees
+     * @param spread    The most a particle's direction can differ from the
+     *                  angle, in degrees
+     * @param min_speed The slowest speed, in pixels per second
+     * @param max_speed The fastest speed, in pixels per second
+     *
+     * @attribute class particle_emitter
+     * @attribute method set_velocity
+     */
+    void particle_emitter_set_velocity(particle_emitter emitter, double angle, double spread, double min_speed, double max_speed);
+
+    /**
+     * Set the acceleration applied to every particle, such as gravity pulling
+     * them down.
+     *
+     * @param emitter The particle emitter
+     * @param gravity The acceleration, in pixels per second per second
+     *
+     * @attribute class particle_emitter
+     * @attribute setter gravity
+     */
+    void particle_emitter_set_gravity(particle_emitter emitter, const vector_2d &gravity);
+
+    /**
+     * Set the color of particles as they are released and as their lifetime
+     * ends. Particles fade smoothly from one color to the other.
+     *
+     * @param emitter     The particle emitter
+     * @param start_color The color of new particles
+     * @param end_color   The color of particles at the end of their lifetime
+     *
+     * @attribute class particle_emitter
+     * @attribute method set_colors
+     */
+    void particle_emitter_set_colors(particle_emitter emitter, color start_color, color end_color);
+
+    /**
+     * Set the scale of particles as they are released and as their lifetime
+     * ends. Particles change smoothly from one size to the other.
+     *
+     * @param emitter     The particle emitter
+     * @param start_scale The scale of new particles
+     * @param end_scale   The scale of particles at the end of their lifetime
+     *
+     * @attribute class particle_emitter
+     * @attribute method set_sizes
+     */
+    void particle_emitter_set_sizes(particle_emitter emitter, double start_scale, double end_scale);
+
+    /**
+     * Release a number of particles straight away, such as for an explosion.
+     * Particles beyond the emitter's capacity are not released.
+     *
+     * @param emitter The particle emitter
+     * @param count   The number of particles to release
+     *
+     * @attribute class particle_emitter
+     * @attribute method emit
+     */
+    void emit_particles(particle_emitter emitter, int count);
+
+    /**
+     * Move the emitter's particles on by the time passed, removing those
+     * whose lifetime has ended and releasing new particles at the emitter's
+     * rate. Large numbers of particles are updated on several threads.
+     *
+     * @param emitter The particle emitter
+     * @param seconds The time since the emitter was last updated
+     *
+     * @attribute class particle_emitter
+     * @attribute method update
+     */
+    void update_particle_emitter(particle_emitter emitter, double seconds);
+
+    /**
+     * Draw the emitter's particles onto the current window.
+     *
+     * @param emitter The particle emitter
+     *
+     * @attribute class particle_emitter
+     * @attribute method draw
+     */
+    void draw_particle_emitter(particle_emitter emitter);
+
+    /**
+     * Draw the emitter's particles. The destination and camera of the
+     * drawing options are used, and the other options are ignored.
+     *
+     * @param emitter The particle emitter
+     * @param opts    The drawing options
+     *
+     * @attribute class particle_emitter
+     * @attribute method draw
+     * @attribute suffix with_options
+     */
+    void draw_particle_emitter(particle_emitter emitter, const drawing_options &opts);
+
+    /**
+     * The number of particles that are alive.
+     *
+     * @param emitter The particle emitter
+     * @return        The number of particles
+     *
+     * @attribute class particle_emitter
+     * @attribute getter particle_count
+     */
+    int particle_count(particle_emitter emitter);
+
+    /**
+     * Remove all of the emitter's particles.
+     *
+     * @param emitter The particle emitter
+     *
+     * @attribute class particle_emitter
+     * @attribute method clear
+     */
+    void clear_particles(particle_emitter emitter);
+}
+
+#endif /* particles_h */
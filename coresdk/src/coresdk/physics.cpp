@@ -5,5 +5,805 @@
 //  Created by Clancy Light Townsend on 18/08/2016.
 //  Copyright © 2016 Andrew Cain. All rights reserved.
 //
+//  Bodies are kept in one array, indexed by body id. Each step finds the
+//  pairs of bodies whose bounds overlap by sorting them along the x axis
+//  (sweep and prune), works out the contacts between those pairs, then
+//  solves the contacts with sequential impulses. Bodies that touch are
+//  grouped into islands, and an island falls asleep once all of its bodies
+//  have been still for long enough.
+//
 
 #include "physics.h"
+
+#include "resources.h"
+#include "sprites.h"
+
+#include "backend_types.h"
+#include "concurrency_utils.h"
+#include "utility_functions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// The most steps run in one update
+#define PHYSICS_MAX_STEPS 8
+// Pairs are checked for contacts on several threads when there are at least this many
+#define PHYSICS_PARALLEL_MIN_PAIRS 2048
+// The number of pairs each thread takes at a time
+#define PHYSICS_PAIR_CHUNK 512
+// Bodies slower than this, in pixels per second, are still
+#define PHYSICS_SLEEP_SPEED 4.0
+// Islands fall asleep once all their bodies have been still for this many seconds
+#define PHYSICS_SLEEP_TIME 0.5
+// Overlap allowed before positions are corrected, reducing jitter in stacks
+#define PHYSICS_SLOP 0.5
+// The part of the overlap corrected each step
+#define PHYSICS_CORRECTION 0.2
+// Bodies must approach faster than this, in pixels per second, to bounce
+#define PHYSICS_BOUNCE_SPEED 10.0
+
+namespace splashkit_lib
+{
+    enum _physics_shape
+    {
+        PHYSICS_CIRCLE,
+        PHYSICS_BOX
+    };
+
+    struct _physics_body
+    {
+        bool active;
+        _physics_shape shape;
+        double x, y;            // centre
+        double hw, hh;          // half width and height of the box, or radius twice for circles
+        double vx, vy;
+        double inv_mass;        // 0 for static bodies
+        double restitution, friction;
+        double still_time;      // seconds the body has been still for
+        bool sleeping;
+
+        sprite spr;             // moved to the body after each update, or nullptr
+        double sprite_dx, sprite_dy;    // sprite position relative to the centre
+    };
+
+    struct _physics_contact
+    {
+        int a, b;
+        double nx, ny;          // normal from a to b
+        double depth;
+        double bounce;          // speed the bodies should separate at
+        double normal_impulse, tangent_impulse;
+    };
+
+    struct _physics_world_data
+    {
+        pointer_identifier id;
+        vector<_physics_body> bodies;
+        vector<int> free_ids;
+        int count;
+
+        double gravity_x, gravity_y;
+        double time_step;
+        double carry;           // time left over from the last update
+        int iterations;
+
+        // reused each step
+        vector<int> order;
+        vector<std::pair<int, int>> pairs;
+        vector<_physics_contact> contacts;
+        vector<vector<_physics_contact>> chunk_contacts;
+        vector<int> island_parent;
+        vector<double> island_still;
+    };
+
+    // The worlds, so the bodies of a sprite can be removed when it is freed
+    static vector<physics_world> _physics_worlds;
+
+    physics_world create_physics_world(const vector_2d &gravity)
+    {
+        physics_world result = new _physics_world_data;
+        _physics_worlds.push_back(result);
+        result->id = PHYSICS_WORLD_PTR;
+        result->count = 0;
+        result->gravity_x = gravity.x;
+        result->gravity_y = gravity.y;
+        result->time_step = 1.0 / 60.0;
+        result->carry = 0;
+        result->iterations = 8;
+        return result;
+    }
+
+    void free_physics_world(physics_world world)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to free physics world with invalid pointer";
+            return;
+        }
+
+        notify_of_free(world);
+        erase_from_vector(_physics_worlds, world);
+
+        world->id = NONE_PTR;
+        delete world;
+    }
+
+    static void _wake_all(physics_world world)
+    {
+        for (_physics_body &body : world->bodies)
+        {
+            body.sleeping = false;
+            body.still_time = 0;
+        }
+    }
+
+    void physics_world_set_gravity(physics_world world, const vector_2d &gravity)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the gravity of an invalid physics world";
+            return;
+        }
+
+        world->gravity_x = gravity.x;
+        world->gravity_y = gravity.y;
+        _wake_all(world);
+    }
+
+    void physics_world_set_time_step(physics_world world, double seconds)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the time step of an invalid physics world";
+            return;
+        }
+
+        if ( seconds <= 0 )
+        {
+            LOG(WARNING) << "Trying to set the time step of a physics world to " << seconds;
+            return;
+        }
+
+        world->time_step = seconds;
+    }
+
+    void physics_world_set_iterations(physics_world world, int iterations)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the iterations of an invalid physics world";
+            return;
+        }
+
+        world->iterations = std::max(1, iterations);
+    }
+
+    //
+    // Bodies
+    //
+
+    static int _add_body(physics_world world, _physics_shape shape, double x, double y, double hw, double hh, double mass)
+    {
+        _physics_body body;
+        body.active = true;
+        body.shape = shape;
+        body.x = x;
+        body.y = y;
+        body.hw = hw;
+        body.hh = hh;
+        body.vx = 0;
+        body.vy = 0;
+        body.inv_mass = mass > 0 ? 1.0 / mass : 0;
+        body.restitution = 0.2;
+        body.friction = 0.4;
+        body.still_time = 0;
+        body.sleeping = false;
+        body.spr = nullptr;
+        body.sprite_dx = 0;
+        body.sprite_dy = 0;
+
+        int result;
+        if ( world->free_ids.empty() )
+        {
+            result = static_cast<int>(world->bodies.size());
+            world->bodies.push_back(body);
+        }
+        else
+        {
+            result = world->free_ids.back();
+            world->free_ids.pop_back();
+            world->bodies[result] = body;
+        }
+
+        world->count++;
+        return result;
+    }
+
+    int physics_add_circle(physics_world world, const circle &c, double mass)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to add a circle to an invalid physics world";
+            return -1;
+        }
+
+        double r = std::abs(c.radius);
+        return _add_body(world, PHYSICS_CIRCLE, c.center.x, c.center.y, r, r, mass);
+    }
+
+    int physics_add_rectangle(physics_world world, const rectangle &rect, double mass)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to add a rectangle to an invalid physics world";
+            return -1;
+        }
+
+        double hw = std::abs(rect.width) / 2, hh = std::abs(rect.height) / 2;
+        double left = std::min(rect.x, rect.x + rect.width), top = std::min(rect.y, rect.y + rect.height);
+        return _add_body(world, PHYSICS_BOX, left + hw, top + hh, hw, hh, mass);
+    }
+
+    // Remove the bodies of a sprite as it is freed
+    static void _remove_sprite_bodies(void *resource)
+    {
+        for (physics_world world : _physics_worlds)
+        {
+            for (size_t i = 0; i < world->bodies.size(); i++)
+            {
+                if ( world->bodies[i].active && world->bodies[i].spr == resource )
+                    physics_remove_body(world, static_cast<int>(i));
+            }
+        }
+    }
+
+    int physics_add_sprite(physics_world world, sprite s, bool is_static)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to add a sprite to an invalid physics world";
+            return -1;
+        }
+
+        // sprite_name checks the sprite, as its data is private to sprites
+        if ( sprite_name(s).empty() )
+        {
+            LOG(WARNING) << "Trying to add an invalid sprite to a physics world";
+            return -1;
+        }
+
+        static bool removing = false;
+        if ( ! removing )
+        {
+            register_free_notifier(&_remove_sprite_bodies);
+            removing = true;
+        }
+
+        rectangle area = sprite_collision_rectangle(s);
+        double mass = is_static ? 0 : std::max(0.001f, sprite_mass(s));
+
+        int result = physics_add_rectangle(world, area, mass);
+
+        _physics_body &body = world->bodies[result];
+        point_2d pos = sprite_position(s);
+        vector_2d vel = sprite_velocity(s);
+
+        body.spr = s;
+        body.sprite_dx = pos.x - body.x;
+        body.sprite_dy = pos.y - body.y;
+        if ( ! is_static )
+        {
+            // sprite velocities are in pixels per update, at 60 updates each second
+            body.vx = vel.x * 60;
+            body.vy = vel.y * 60;
+        }
+
+        return result;
+    }
+
+    // Get the body with the id, logging a warning if there is none
+    static _physics_body * _body(physics_world world, int body, const char *action)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to " << action << " in an invalid physics world";
+            return nullptr;
+        }
+
+        if ( body < 0 || body >= static_cast<int>(world->bodies.size()) || ! world->bodies[body].active )
+        {
+            LOG(WARNING) << "Trying to " << action << " with invalid physics body " << body;
+            return nullptr;
+        }
+
+        return &world->bodies[body];
+    }
+
+    void physics_remove_body(physics_world world, int body)
+    {
+        _physics_body *b = _body(world, body, "remove a body");
+        if ( ! b ) return;
+
+        b->active = false;
+        b->spr = nullptr;
+        world->free_ids.push_back(body);
+        world->count--;
+
+        // bodies resting on this one need to fall
+        _wake_all(world);
+    }
+
+    int physics_body_count(physics_world world)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to count the bodies of an invalid physics world";
+            return 0;
+        }
+
+        return world->count;
+    }
+
+    point_2d physics_body_position(physics_world world, int body)
+    {
+        _physics_body *b = _body(world, body, "get the position of a body");
+        if ( ! b ) return point_at(0, 0);
+
+        return point_at(b->x, b->y);
+    }
+
+    void physics_set_body_position(physics_world world, int body, const point_2d &pos)
+    {
+        _physics_body *b = _body(world, body, "move a body");
+        if ( ! b ) return;
+
+        b->x = pos.x;
+        b->y = pos.y;
+        b->sleeping = false;
+        b->still_time = 0;
+    }
+
+    vector_2d physics_body_velocity(physics_world world, int body)
+    {
+        _physics_body *b = _body(world, body, "get the velocity of a body");
+        if ( ! b ) return vector_to(0, 0);
+
+        return vector_to(b->vx, b->vy);
+    }
+
+    void physics_set_body_velocity(physics_world world, int body, const vector_2d &velocity)
+    {
+        _physics_body *b = _body(world, body, "set the velocity of a body");
+        if ( ! b || b->inv_mass == 0 ) return;
+
+        b->vx = velocity.x;
+        b->vy = velocity.y;
+        b->sleeping = false;
+        b->still_time = 0;
+    }
+
+    void physics_apply_impulse(physics_world world, int body, const vector_2d &impulse)
+    {
+        _physics_body *b = _body(world, body, "apply an impulse to a body");
+        if ( ! b || b->inv_mass == 0 ) return;
+
+        b->vx += impulse.x * b->inv_mass;
+        b->vy += impulse.y * b->inv_mass;
+        b->sleeping = false;
+        b->still_time = 0;
+    }
+
+    void physics_set_body_material(physics_world world, int body, double restitution, double friction)
+    {
+        _physics_body *b = _body(world, body, "set the material of a body");
+        if ( ! b ) return;
+
+        b->restitution = std::max(0.0, std::min(1.0, restitution));
+        b->friction = std::max(0.0, friction);
+    }
+
+    bool physics_body_sleeping(physics_world world, int body)
+    {
+        _physics_body *b = _body(world, body, "check if a body is sleeping");
+        if ( ! b ) return false;
+
+        return b->sleeping;
+    }
+
+    //
+    // Collision detection
+    //
+
+    // Bodies that do not move, either static or asleep
+    static inline bool _resting(const _physics_body &b)
+    {
+        return b.inv_mass == 0 || b.sleeping;
+    }
+
+    // Find the pairs of bodies whose bounds overlap, sorted along x
+    static void _find_pairs(physics_world world)
+    {
+        vector<int> &order = world->order;
+        vector<_physics_body> &bodies = world->bodies;
+
+        order.clear();
+        for (int i = 0; i < static_cast<int>(bodies.size()); i++)
+        {
+            if ( bodies[i].active ) order.push_back(i);
+        }
+
+        std::sort(order.begin(), order.end(), [&bodies](int a, int b)
+        {
+            return bodies[a].x - bodies[a].hw < bodies[b].x - bodies[b].hw;
+        });
+
+        world->pairs.clear();
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const _physics_body &a = bodies[order[i]];
+            double right = a.x + a.hw;
+
+            for (size_t j = i + 1; j < order.size(); j++)
+            {
+                const _physics_body &b = bodies[order[j]];
+                if ( b.x - b.hw > right ) break;
+
+                // two bodies that are not moving cannot start touching
+                if ( _resting(a) && _resting(b) ) continue;
+                if ( std::abs(a.y - b.y) > a.hh + b.hh ) continue;
+
+                world->pairs.push_back({ order[i], order[j] });
+            }
+        }
+    }
+
+    // The contact where a circle at a overlaps a circle at b
+    static bool _circle_circle(const _physics_body &a, const _physics_body &b, _physics_contact &c)
+    {
+        double dx = b.x - a.x, dy = b.y - a.y;
+        double r = a.hw + b.hw;
+        double dist_sq = dx * dx + dy * dy;
+        if ( dist_sq >= r * r ) return false;
+
+        double dist = std::sqrt(dist_sq);
+        if ( dist > 0 )
+        {
+            c.nx = dx / dist;
+            c.ny = dy / dist;
+        }
+        else
+        {
+            c.nx = 0;
+            c.ny = 1;
+        }
+        c.depth = r - dist;
+        return true;
+    }
+
+    // The contact where a box at a overlaps a box at b, along the axis of least overlap
+    static bool _box_box(const _physics_body &a, const _physics_body &b, _physics_contact &c)
+    {
+        double dx = b.x - a.x, dy = b.y - a.y;
+        double ox = a.hw + b.hw - std::abs(dx);
+        double oy = a.hh + b.hh - std::abs(dy);
+        if ( ox <= 0 || oy <= 0 ) return false;
+
+        if ( ox < oy )
+        {
+            c.nx = dx < 0 ? -1 : 1;
+            c.ny = 0;
+            c.depth = ox;
+        }
+        else
+        {
+            c.nx = 0;
+            c.ny = dy < 0 ? -1 : 1;
+            c.depth = oy;
+        }
+        return true;
+    }
+
+    // The contact where a box at a overlaps a circle at b
+    static bool _box_circle(const _physics_body &a, const _physics_body &b, _physics_contact &c)
+    {
+        double dx = b.x - a.x, dy = b.y - a.y;
+        double px = std::max(-a.hw, std::min(a.hw, dx));
+        double py = std::max(-a.hh, std::min(a.hh, dy));
+        double r = b.hw;
+
+        if ( px != dx || py != dy )
+        {
+            // the centre is outside the box, so push away from the closest point
+            double ex = dx - px, ey = dy - py;
+            double dist_sq = ex * ex + ey * ey;
+            if ( dist_sq >= r * r ) return false;
+
+            double dist = std::sqrt(dist_sq);
+            c.nx = ex / dist;
+            c.ny = ey / dist;
+            c.depth = r - dist;
+            return true;
+        }
+
+        // the centre is inside the box, so push out through the closest side
+        double ox = a.hw - std::abs(dx), oy = a.hh - std::abs(dy);
+        if ( ox < oy )
+        {
+            c.nx = dx < 0 ? -1 : 1;
+            c.ny = 0;
+            c.depth = ox + r;
+        }
+        else
+        {
+            c.nx = 0;
+            c.ny = dy < 0 ? -1 : 1;
+            c.depth = oy + r;
+        }
+        return true;
+    }
+
+    static bool _collide(const vector<_physics_body> &bodies, int ia, int ib, _physics_contact &c)
+    {
+        const _physics_body &a = bodies[ia], &b = bodies[ib];
+        bool hit;
+
+        c.a = ia;
+        c.b = ib;
+
+        if ( a.shape == PHYSICS_CIRCLE && b.shape == PHYSICS_CIRCLE )
+            hit = _circle_circle(a, b, c);
+        else if ( a.shape == PHYSICS_BOX && b.shape == PHYSICS_BOX )
+            hit = _box_box(a, b, c);
+        else if ( a.shape == PHYSICS_BOX )
+            hit = _box_circle(a, b, c);
+        else
+        {
+            // work out the contact from the box's side, then turn it around
+            hit = _box_circle(b, a, c);
+            c.nx = -c.nx;
+            c.ny = -c.ny;
+        }
+
+        if ( ! hit ) return false;
+
+        // bounce if the bodies are approaching quickly enough
+        double vn = (b.vx - a.vx) * c.nx + (b.vy - a.vy) * c.ny;
+        double e = std::max(a.restitution, b.restitution);
+        c.bounce = vn < -PHYSICS_BOUNCE_SPEED ? -e * vn : 0;
+        c.normal_impulse = 0;
+        c.tangent_impulse = 0;
+        return true;
+    }
+
+    // Work out the contacts for the pairs, in pair order
+    static void _find_contacts(physics_world world)
+    {
+        const vector<std::pair<int, int>> &pairs = world->pairs;
+        const vector<_physics_body> &bodies = world->bodies;
+
+        world->contacts.clear();
+
+        worker_pool &pool = shared_worker_pool();
+
+        if ( pairs.size() < PHYSICS_PARALLEL_MIN_PAIRS || pool.thread_count() < 1 )
+        {
+            _physics_contact c;
+            for (const std::pair<int, int> &pair : pairs)
+            {
+                if ( _collide(bodies, pair.first, pair.second, c) ) world->contacts.push_back(c);
+            }
+            return;
+        }
+
+        // each chunk writes its own contacts, which are joined in chunk order
+        // so the result does not depend on which thread ran first
+        size_t chunks = (pairs.size() + PHYSICS_PAIR_CHUNK - 1) / PHYSICS_PAIR_CHUNK;
+        world->chunk_contacts.resize(chunks);
+
+        parallel_for(pool, pairs.size(), PHYSICS_PAIR_CHUNK, [&](size_t begin, size_t end, size_t chunk)
+        {
+            vector<_physics_contact> &out = world->chunk_contacts[chunk];
+            out.clear();
+
+            _physics_contact c;
+            for (size_t i = begin; i < end; i++)
+            {
+                if ( _collide(bodies, pairs[i].first, pairs[i].second, c) ) out.push_back(c);
+            }
+        });
+
+        for (size_t i = 0; i < chunks; i++)
+        {
+            const vector<_physics_contact> &part = world->chunk_contacts[i];
+            world->contacts.insert(world->contacts.end(), part.begin(), part.end());
+        }
+    }
+
+    //
+    // Solving
+    //
+
+    static void _solve_contact(vector<_physics_body> &bodies, _physics_contact &c, double dt)
+    {
+        _physics_body &a = bodies[c.a], &b = bodies[c.b];
+
+        double inv_a = a.sleeping ? 0 : a.inv_mass;
+        double inv_b = b.sleeping ? 0 : b.inv_mass;
+        double inv_sum = inv_a + inv_b;
+        if ( inv_sum == 0 ) return;
+
+        // push the bodies apart along the normal, never pulling them together
+        double rvx = b.vx - a.vx, rvy = b.vy - a.vy;
+        double vn = rvx * c.nx + rvy * c.ny;
+
+        double correction = PHYSICS_CORRECTION / dt * std::max(0.0, c.depth - PHYSICS_SLOP);
+        double target = std::max(c.bounce, correction);
+
+        double lambda = (target - vn) / inv_sum;
+        double total = std::max(0.0, c.normal_impulse + lambda);
+        lambda = total - c.normal_impulse;
+        c.normal_impulse = total;
+
+        a.vx -= lambda * c.nx * inv_a;
+        a.vy -= lambda * c.ny * inv_a;
+        b.vx += lambda * c.nx * inv_b;
+        b.vy += lambda * c.ny * inv_b;
+
+        // friction resists sliding, up to the normal impulse times the friction
+        rvx = b.vx - a.vx;
+        rvy = b.vy - a.vy;
+        double tx = -c.ny, ty = c.nx;
+        double vt = rvx * tx + rvy * ty;
+
+        double mu = std::sqrt(a.friction * b.friction);
+        double limit = mu * c.normal_impulse;
+
+        double lambda_t = -vt / inv_sum;
+        double total_t = std::max(-limit, std::min(limit, c.tangent_impulse + lambda_t));
+        lambda_t = total_t - c.tangent_impulse;
+        c.tangent_impulse = total_t;
+
+        a.vx -= lambda_t * tx * inv_a;
+        a.vy -= lambda_t * ty * inv_a;
+        b.vx += lambda_t * tx * inv_b;
+        b.vy += lambda_t * ty * inv_b;
+    }
+
+    static int _island_root(vector<int> &parent, int i)
+    {
+        while ( parent[i] != i )
+        {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // Group touching moving bodies into islands, and put islands that have
+    // been still for long enough to sleep. Touching a body wakes its island.
+    static void _update_sleep(physics_world world, double dt)
+    {
+        vector<_physics_body> &bodies = world->bodies;
+        vector<int> &parent = world->island_parent;
+        vector<double> &still = world->island_still;
+
+        size_t n = bodies.size();
+        parent.resize(n);
+        for (size_t i = 0; i < n; i++) parent[i] = static_cast<int>(i);
+
+        for (const _physics_contact &c : world->contacts)
+        {
+            // static bodies do not join islands, or everything on the ground would be one island
+            if ( bodies[c.a].inv_mass == 0 || bodies[c.b].inv_mass == 0 ) continue;
+
+            int ra = _island_root(parent, c.a), rb = _island_root(parent, c.b);
+            if ( ra != rb ) parent[ra] = rb;
+        }
+
+        // the shortest time any body in each island has been still
+        still.assign(n, PHYSICS_SLEEP_TIME * 2);
+        for (size_t i = 0; i < n; i++)
+        {
+            _physics_body &b = bodies[i];
+            if ( ! b.active || b.inv_mass == 0 ) continue;
+
+            if ( ! b.sleeping )
+            {
+                double speed_sq = b.vx * b.vx + b.vy * b.vy;
+                b.still_time = speed_sq < PHYSICS_SLEEP_SPEED * PHYSICS_SLEEP_SPEED ? b.still_time + dt : 0;
+            }
+
+            int root = _island_root(parent, static_cast<int>(i));
+            still[root] = std::min(still[root], b.still_time);
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            _physics_body &b = bodies[i];
+            if ( ! b.active || b.inv_mass == 0 ) continue;
+
+            bool sleep = still[_island_root(parent, static_cast<int>(i))] >= PHYSICS_SLEEP_TIME;
+            if ( sleep && ! b.sleeping )
+            {
+                b.vx = 0;
+                b.vy = 0;
+            }
+            else if ( ! sleep && b.sleeping )
+                b.still_time = 0;
+
+            b.sleeping = sleep;
+        }
+    }
+
+    static void _step(physics_world world, double dt)
+    {
+        vector<_physics_body> &bodies = world->bodies;
+
+        // apply gravity to moving bodies
+        for (_physics_body &b : bodies)
+        {
+            if ( ! b.active || _resting(b) ) continue;
+            b.vx += world->gravity_x * dt;
+            b.vy += world->gravity_y * dt;
+        }
+
+        _find_pairs(world);
+        _find_contacts(world);
+
+        // a moving body touching a sleeping one wakes it
+        for (const _physics_contact &c : world->contacts)
+        {
+            _physics_body &a = bodies[c.a], &b = bodies[c.b];
+            if ( a.sleeping && ! _resting(b) ) { a.sleeping = false; a.still_time = 0; }
+            if ( b.sleeping && ! _resting(a) ) { b.sleeping = false; b.still_time = 0; }
+        }
+
+        for (int i = 0; i < world->iterations; i++)
+        {
+            for (_physics_contact &c : world->contacts)
+                _solve_contact(bodies, c, dt);
+        }
+
+        for (_physics_body &b : bodies)
+        {
+            if ( ! b.active || _resting(b) ) continue;
+            b.x += b.vx * dt;
+            b.y += b.vy * dt;
+        }
+
+        _update_sleep(world, dt);
+    }
+
+    int update_physics_world(physics_world world, double seconds)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to update an invalid physics world";
+            return 0;
+        }
+
+        if ( seconds > 0 ) world->carry += seconds;
+
+        int steps = 0;
+        while ( world->carry >= world->time_step && steps < PHYSICS_MAX_STEPS )
+        {
+            _step(world, world->time_step);
+            world->carry -= world->time_step;
+            steps++;
+        }
+
+        // drop time that could not be simulated, rather than falling further behind
+        if ( steps == PHYSICS_MAX_STEPS ) world->carry = std::min(world->carry, world->time_step);
+
+        // move sprites to their bodies
+        for (_physics_body &b : world->bodies)
+        {
+            if ( ! b.active || ! b.spr ) continue;
+
+            sprite_set_position(b.spr, point_at(b.x + b.sprite_dx, b.y + b.sprite_dy));
+        }
+
+        return steps;
+    }
+}
@@ -1,7 +1,19 @@
 /**
  * @header  physics
  * @author  Andrew Cain
+ * @brief   A physics world moves bodies under gravity and makes them bounce off each other.
+ *
+ * Add circles and rectangles to a physics world, or add sprites to have
+ * them moved by the world. Each update steps the world forward by a fixed
+ * time step, so the simulation behaves the same at any frame rate. Bodies
+ * with a mass of 0 are static, and never move. Bodies that come to rest
+ * fall asleep, and are not simulated again until something touches them.
+ *
+ * Bodies do not rotate, so rectangles always stay lined up with the
+ * x and y axes.
+ *
  * @attribute group  physics
+ * @attribute static physics
  */
 
 #ifndef physics_hpp
@@ -9,6 +21,245 @@
 
 #include "matrix_2d.h"
 #include "vector_2d.h"
+#include "sprites.h"
 #include "collisions.h"
 
+namespace splashkit_lib
+{
+    /**
+     * A physics world holds the bodies that are simulated together.
+     *
+     * @attribute class physics_world
+     */
+    typedef struct _physics_world_data *physics_world;
+
+    /**
+     * Create a new physics world with no bodies. The world steps 60 times
+     * each second of simulated time.
+     *
+     * @param gravity The acceleration applied to all bodies, in pixels per
+     *                second per second
+     * @return        The new physics world
+     *
+     * @attribute class physics_world
+     * @attribute constructor true
+     */
+    physics_world create_physics_world(const vector_2d &gravity);
+
+    /**
+     * Free the physics world and its bodies. Sprites added to the world are
+     * not freed.
+     *
+     * @param world The physics world to free
+     *
+     * @attribute class physics_world
+     * @attribute destructor true
+     */
+    void free_physics_world(physics_world world);
+
+    /**
+     * Change the acceleration applied to all bodies, waking any that are
+     * asleep.
+     *
+     * @param world   The physics world
+     * @param gravity The acceleration, in pixels per second per second
+     *
+     * @attribute class physics_world
+     * @attribute setter gravity
+     */
+    void physics_world_set_gravity(physics_world world, const vector_2d &gravity);
+
+    /**
+     * Change the length of each step of the simulation. Shorter steps are
+     * more accurate, but need more work for each second of simulated time.
+     *
+     * @param world   The physics world
+     * @param seconds The time each step simulates
+     *
+     * @attribute class physics_world
+     * @attribute setter time_step
+     */
+    void physics_world_set_time_step(physics_world world, double seconds);
+
+    /**
+     * Change how many times the contacts between bodies are solved in each
+     * step. More iterations make stacks of bodies more stable.
+     *
+     * @param world       The physics world
+     * @param iterations  The number of iterations, 8 by default
+     *
+     * @attribute class physics_world
+     * @attribute setter iterations
+     */
+    void physics_world_set_iterations(physics_world world, int iterations);
+
+    /**
+     * Move the world forward by the time passed. The time is used up in
+     * fixed steps, and time left over is kept for the next update. At most 8
+     * steps are run in one update, so a long pause does not stall the game.
+     * Sprites added to the world are moved to their bodies' positions.
+     *
+     * @param world   The physics world
+     * @param seconds The time since the world was last updated
+     * @return        The number of steps that were run
+     *
+     * @attribute class physics_world
+     * @attribute method update
+     */
+    int update_physics_world(physics_world world, double seconds);
+
+    /**
+     * Add a circle to the world.
+     *
+     * @param world The physics world
+     * @param c     The circle's starting position and size
+     * @param mass  The mass of the body, or 0 for a body that never moves
+     * @return      The id of the new body, or -1 if the world is invalid
+     *
+     * @attribute class physics_world
+     * @attribute method add_circle
+     */
+    int physics_add_circle(physics_world world, const circle &c, double mass);
+
+    /**
+     * Add a rectangle to the world.
+     *
+     * @param world The physics world
+     * @param rect  The rectangle's starting position and size
+     * @param mass  The mass of the body, or 0 for a body that never moves
+     * @return      The id of the new body, or -1 if the world is invalid
+     *
+     * @attribute class physics_world
+     * @attribute method add_rectangle
+     */
+    int physics_add_rectangle(physics_world world, const rectangle &rect, double mass);
+
+    /**
+     * Add a sprite to the world, as a rectangle the size of its collision
+     * rectangle and with the sprite's mass. The world moves the sprite each
+     * update. The sprite's velocity is given to the body. The body is
+     * removed when the sprite is freed.
+     *
+     * @param world     The physics world
+     * @param s         The sprite to add
+     * @param is_static True if the sprite should never move
+     * @return          The id of the new body, or -1 if the world or sprite
+     *                  is invalid
+     *
+     * @attribute class physics_world
+     * @attribute method add_sprite
+     */
+    int physics_add_sprite(physics_world world, sprite s, bool is_static);
+
+    /**
+     * Remove a body from the world. Its id may be reused by bodies added
+     * later.
+     *
+     * @param world The physics world
+     * @param body  The id of the body to remove
+     *
+     * @attribute class physics_world
+     * @attribute method remove_body
+     */
+    void physics_remove_body(physics_world world, int body);
+
+    /**
+     * The number of bodies in the world.
+     *
+     * @param world The physics world
+     * @return      The number of bodies
+     *
+     * @attribute class physics_world
+     * @attribute getter body_count
+     */
+    int physics_body_count(physics_world world);
+
+    /**
+     * The centre of a body.
+     *
+     * @param world The physics world
+     * @param body  The id of the body
+     * @return      The position of the centre of the body
+     *
+     * @attribute class physics_world
+     * @attribute method body_position
+     */
+    point_2d physics_body_position(physics_world world, int body);
+
+    /**
+     * Move the centre of a body, waking it if it is asleep.
+     *
+     * @param world The physics world
+     * @param body  The id of the body
+     * @param pos   The new position of the centre of the body
+     *
+     * @attribute class physics_world
+     * @attribute method set_body_position
+     */
+    void physics_set_body_position(physics_world world, int body, const point_2d &pos);
+
+    /**
+     * The velocity of a body.
+     *
+     * @param world The physics world
+     * @param body  The id of the body
+     * @return      The velocity, in pixels per second
+     *
+     * @attribute class physics_world
+     * @attribute method body_velocity
+     */
+    vector_2d physics_body_velocity(physics_world world, int body);
+
+    /**
+     * Change the velocity of a body, waking it if it is asleep.
+     *
+     * @param world     The physics world
+     * @param body      The id of the body
+     * @param velocity  The new velocity, in pixels per second
+     *
+     * @attribute class physics_world
+     * @attribute method set_body_velocity
+     */
+    void physics_set_body_velocity(physics_world world, int body, const vector_2d &velocity);
+
+    /**
+     * Push a body, changing its velocity by the impulse divided by its mass.
+     * Static bodies are not affected.
+     *
+     * @param world   The physics world
+     * @param body    The id of the body
+     * @param impulse The impulse to apply
+     *
+     * @attribute class physics_world
+     * @attribute method apply_impulse
+     */
+    void physics_apply_impulse(physics_world world, int body, const vector_2d &impulse);
+
+    /**
+     * Change how bouncy and how slippery a body is.
+     *
+     * @param world       The physics world
+     * @param body        The id of the body
+     * @param restitution How much of its speed the body keeps when it
+     *                    bounces, from 0 to 1
+     * @param friction    How much the body resists sliding, 0 for no friction
+     *
+     * @attribute class physics_world
+     * @attribute method set_body_material
+     */
+    void physics_set_body_material(physics_world world, int body, double restitution, double friction);
+
+    /**
+     * Check if a body has come to rest and is no longer being simulated.
+     *
+     * @param world The physics world
+     * @param body  The id of the body
+     * @return      True if the body is asleep
+     *
+     * @attribute class physics_world
+     * @attribute method body_sleeping
+     */
+    bool physics_body_sleeping(physics_world world, int body);
+}
+
 #endif /* physics_hpp */
@@ -9,6 +9,7 @@
 #include "point_drawing.h"
 
 #include "graphics_driver.h"
+#include "resource_tracking.h"
 #include "utility_functions.h"
 
 namespace splashkit_lib
@@ -18,7 +19,7 @@ namespace splashkit_lib
         draw_pixel(clr, x, y, option_defaults());
     }
 
-    void draw_pixel(color clr, double x, double y, drawing_options opts)
+    void draw_pixel(color clr, double x, double y, const drawing_options &opts)
     {
         sk_drawing_surface *surface;
 
@@ -37,7 +38,7 @@ namespace splashkit_lib
         draw_pixel(clr, pt.x, pt.y, option_defaults());
     }
 
-    void draw_pixel(color clr, const point_2d &pt, drawing_options opts)
+    void draw_pixel(color clr, const point_2d &pt, const drawing_options &opts)
     {
         draw_pixel(clr, pt.x, pt.y, opts);
     }
@@ -50,6 +51,7 @@ namespace splashkit_lib
             return COLOR_WHITE;
         }
 
+        _resource_used(bmp);
         return sk_read_pixel(&bmp->image.surface, static_cast<int>(x), static_cast<int>(y));
     }
 
@@ -89,7 +91,7 @@ namespace splashkit_lib
         draw_pixel(clr, x, y, option_draw_to(destination));
     }
     
-    void draw_pixel_on_window(window destination, color clr, double x, double y, drawing_options opts)
+    void draw_pixel_on_window(window destination, color clr, double x, double y, const drawing_options &opts)
     {
         draw_pixel(clr, x, y, option_draw_to(destination, opts));
     }
@@ -99,7 +101,7 @@ namespace splashkit_lib
         draw_pixel(clr, pt, option_draw_to(destination));
     }
     
-    void draw_pixel_on_window(window destination, color clr, const point_2d &pt, drawing_options opts)
+    void draw_pixel_on_window(window destination, color clr, const point_2d &pt, const drawing_options &opts)
     {
         draw_pixel(clr, pt, option_draw_to(destination, opts));
     }
@@ -109,7 +111,7 @@ namespace splashkit_lib
         draw_pixel(clr, x, y, option_draw_to(destination));
     }
     
-    void draw_pixel_on_bitmap(bitmap destination, color clr, double x, double y, drawing_options opts)
+    void draw_pixel_on_bitmap(bitmap destination, color clr, double x, double y, const drawing_options &opts)
     {
         draw_pixel(clr, x, y, option_draw_to(destination, opts));
     }
@@ -119,7 +121,7 @@ namespace splashkit_lib
         draw_pixel(clr, pt, option_draw_to(destination));
     }
     
-    void draw_pixel_on_bitmap(bitmap destination, color clr, const point_2d &pt, drawing_options opts)
+    void draw_pixel_on_bitmap(bitmap destination, color clr, const point_2d &pt, const drawing_options &opts)
     {
         draw_pixel(clr, pt, option_draw_to(destination, opts));
     }
@@ -34,7 +34,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  with_options
      */
-    void draw_pixel(color clr, double x, double y, drawing_options opts);
+    void draw_pixel(color clr, double x, double y, const drawing_options &opts);
 
     /**
      * Draws an individual pixel to the current window.
@@ -55,7 +55,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  at_point_with_options
      */
-    void draw_pixel(color clr, const point_2d &pt, drawing_options opts);
+    void draw_pixel(color clr, const point_2d &pt, const drawing_options &opts);
 
     /**
      * Returns the color of the pixel at the x,y location on the supplied
@@ -159,7 +159,7 @@ namespace splashkit_lib
      * @attribute class  window
      * @attribute suffix  with_options
      */
-    void draw_pixel_on_window(window destination, color clr, double x, double y, drawing_options opts);
+    void draw_pixel_on_window(window destination, color clr, double x, double y, const drawing_options &opts);
     
     /**
      * Draws an individual pixel to the given window.
@@ -184,7 +184,7 @@ namespace splashkit_lib
      * @attribute class  window
      * @attribute suffix  at_point_with_options
      */
-    void draw_pixel_on_window(window destination, color clr, const point_2d &pt, drawing_options opts);
+    void draw_pixel_on_window(window destination, color clr, const point_2d &pt, const drawing_options &opts);
     
     /**
      * Returns the color of the pixel at the x,y location on the given
@@ -243,7 +243,7 @@ namespace splashkit_lib
      * @attribute suffix  with_options
      * @attribute method  draw_pixel
      */
-    void draw_pixel_on_bitmap(bitmap destination, color clr, double x, double y, drawing_options opts);
+    void draw_pixel_on_bitmap(bitmap destination, color clr, double x, double y, const drawing_options &opts);
     
     /**
      * Draws an individual pixel to the given bitmap.
@@ -270,6 +270,6 @@ namespace splashkit_lib
      * @attribute suffix  at_point_with_options
      * @attribute method  draw_pixel
      */
-    void draw_pixel_on_bitmap(bitmap destination, color clr, const point_2d &pt, drawing_options opts);
+    void draw_pixel_on_bitmap(bitmap destination, color clr, const point_2d &pt, const drawing_options &opts);
 }
 #endif /* point_drawing_h */
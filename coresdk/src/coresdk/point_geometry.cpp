@@ -16,7 +16,9 @@
 
 #include "utility_functions.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 using std::to_string;
 
@@ -124,6 +126,33 @@ namespace splashkit_lib
         return point_in_rectangle(point_at(ptx, pty), rectangle_from(rect_x, rect_y, rect_width, rect_height));
     }
 
+    void points_in_rectangle(const vector<point_2d> &pts, const rectangle &rect, vector<bool> &out_result)
+    {
+        const double left = rectangle_left(rect), right = rectangle_right(rect);
+        const double top = rectangle_top(rect), bottom = rectangle_bottom(rect);
+        const size_t n = pts.size();
+        const point_2d *p = pts.data();
+
+        out_result.resize(n);
+
+        // Work out blocks of results without branches, so the compiler can
+        // vectorise the tests, then copy them out
+        uint8_t inside[256];
+        for (size_t start = 0; start < n; start += 256)
+        {
+            size_t count = std::min<size_t>(256, n - start);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                double x = p[start + i].x, y = p[start + i].y;
+                inside[i] = (x >= left) & (x <= right) & (y >= top) & (y <= bottom);
+            }
+
+            for (size_t i = 0; i < count; i++)
+                out_result[start + i] = inside[i];
+        }
+    }
+
     bool point_in_quad(const point_2d &pt, const quad &q)
     {
         return
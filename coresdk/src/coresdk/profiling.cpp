@@ -0,0 +1,275 @@
+//
+//  profiling.cpp
+//  splashkit
+//
+//  Public access to the profile zones collected by the profiling driver.
+//
+
+#include "profiling.h"
+#include "drawing_options.h"
+#include "rectangle_drawing.h"
+#include "text.h"
+#include "color.h"
+
+#include "graphics_driver.h"
+#include "profiling_driver.h"
+#include "utility_functions.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <vector>
+
+using std::map;
+using std::vector;
+
+// Layout of the overlay, in pixels. The default bitmap font is 8 pixels high.
+#define PROFILE_OVERLAY_LINE_HEIGHT 10
+#define PROFILE_OVERLAY_WIDTH 300
+#define PROFILE_OVERLAY_BAR_WIDTH 60
+
+namespace splashkit_lib
+{
+    struct _profile_zone_summary
+    {
+        string name;
+        double total_ms = 0;
+        double max_ms = 0;      // longest total for this zone in a single frame
+    };
+
+    void enable_profiling()
+    {
+        sk_set_profiling(true);
+    }
+
+    void disable_profiling()
+    {
+        sk_set_profiling(false);
+    }
+
+    bool profiling_enabled()
+    {
+        return sk_profiling_enabled();
+    }
+
+    void profile_begin(const string &name)
+    {
+        // skip the name lookup and clock read while off, but still open a
+        // zone so this begin stays paired with its profile_end
+        if ( ! sk_profiling_enabled() )
+        {
+            sk_profile_begin(PROFILE_UNTIMED_ZONE);
+            return;
+        }
+
+        sk_profile_begin(sk_profile_name_id(name));
+    }
+
+    void profile_end()
+    {
+        sk_profile_end();
+    }
+
+    // Zone totals across the frames, sorted with the most expensive first
+    static vector<_profile_zone_summary> _summarise_zones(const vector<sk_profile_frame> &frames)
+    {
+        map<int, _profile_zone_summary> zones;
+
+        for (const sk_profile_frame &frame : frames)
+        {
+            map<int, double> frame_totals;
+            for (const sk_profile_event &evt : frame.events)
+            {
+                frame_totals[evt.name] += evt.duration_ns / 1000000.0;
+            }
+
+            for (auto &total : frame_totals)
+            {
+                _profile_zone_summary &zone = zones[total.first];
+                zone.total_ms += total.second;
+                zone.max_ms = std::max(zone.max_ms, total.second);
+            }
+        }
+
+        vector<_profile_zone_summary> result;
+        for (auto &zone : zones)
+        {
+            zone.second.name = sk_profile_name(zone.first);
+            result.push_back(zone.second);
+        }
+
+        std::sort(result.begin(), result.end(), [](const _profile_zone_summary &a, const _profile_zone_summary &b)
+        {
+            return a.total_ms > b.total_ms;
+        });
+
+        return result;
+    }
+
+    double profile_zone_time(const string &name)
+    {
+        vector<sk_profile_frame> frames = sk_profile_frames();
+        if ( frames.empty() ) return 0;
+
+        int id = sk_profile_name_id(name);
+        double total = 0;
+
+        for (const sk_profile_frame &frame : frames)
+            for (const sk_profile_event &evt : frame.events)
+                if ( evt.name == id ) total += evt.duration_ns / 1000000.0;
+
+        return total / frames.size();
+    }
+
+    static double _average_frame_ms(const vector<sk_profile_frame> &frames)
+    {
+        if ( frames.empty() ) return 0;
+
+        double total = 0;
+        for (const sk_profile_frame &frame : frames)
+            total += (frame.end_ns - frame.start_ns) / 1000000.0;
+
+        return total / frames.size();
+    }
+
+    double profile_frame_time()
+    {
+        return _average_frame_ms(sk_profile_frames());
+    }
+
+    void draw_profile_overlay(window wind)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR) )
+        {
+            LOG(WARNING) << "Attempting to draw profile overlay to invalid window";
+            return;
+        }
+
+        vector<sk_profile_frame> frames = sk_profile_frames();
+        vector<_profile_zone_summary> zones = _summarise_zones(frames);
+        double frame_ms = _average_frame_ms(frames);
+
+        // read before the overlay's own drawing adds to the counts
+        render_statistics stats = render_stats();
+
+        drawing_options opts = option_to_screen(option_draw_to(wind));
+        int lines = static_cast<int>(zones.size()) + 3;
+        char line[128];
+
+        fill_rectangle(rgba_color(0, 0, 0, 180), 0, 0, PROFILE_OVERLAY_WIDTH, lines * PROFILE_OVERLAY_LINE_HEIGHT + 4, opts);
+
+        snprintf(line, sizeof(line), "draws %5d  textures %4d  targets %3d", stats.draw_calls, stats.texture_switches, stats.render_target_changes);
+        draw_text(line, COLOR_WHITE, 2, 2, opts);
+
+        snprintf(line, sizeof(line), "text %4d  created %3d  upload %7.1f KB", stats.text_rasterizations, stats.textures_created, stats.bytes_uploaded / 1024.0);
+        draw_text(line, COLOR_WHITE, 2, 2 + PROFILE_OVERLAY_LINE_HEIGHT, opts);
+
+        double y = 2 + 2 * PROFILE_OVERLAY_LINE_HEIGHT;
+
+        if ( frames.empty() )
+        {
+            draw_text(profiling_enabled() ? "profile: waiting for frames" : "profile: disabled", COLOR_WHITE, 2, y, opts);
+            return;
+        }
+
+        snprintf(line, sizeof(line), "frame %6.2f ms  %5.1f fps  (%d frames)", frame_ms, frame_ms > 0 ? 1000.0 / frame_ms : 0.0, static_cast<int>(frames.size()));
+        draw_text(line, COLOR_WHITE, 2, y, opts);
+
+        y += PROFILE_OVERLAY_LINE_HEIGHT;
+        for (const _profile_zone_summary &zone : zones)
+        {
+            double avg_ms = zone.total_ms / frames.size();
+
+            // Bar shows the share of the average frame spent in this zone
+            double share = frame_ms > 0 ? std::min(1.0, avg_ms / frame_ms) : 0;
+            fill_rectangle(COLOR_GREEN, PROFILE_OVERLAY_WIDTH - PROFILE_OVERLAY_BAR_WIDTH - 2, y, PROFILE_OVERLAY_BAR_WIDTH * share, PROFILE_OVERLAY_LINE_HEIGHT - 2, opts);
+
+            snprintf(line, sizeof(line), "%-14.14s %6.2f %6.2f", zone.name.c_str(), avg_ms, zone.max_ms);
+            draw_text(line, COLOR_WHITE, 2, y, opts);
+            y += PROFILE_OVERLAY_LINE_HEIGHT;
+        }
+    }
+
+    render_statistics render_stats()
+    {
+        sk_render_counters counts = sk_last_frame_render_counters();
+
+        render_statistics result;
+        result.draw_calls = counts.draw_calls;
+        result.texture_switches = counts.texture_switches;
+        result.render_target_changes = counts.render_target_changes;
+        result.text_rasterizations = counts.text_rasterizations;
+        result.textures_created = counts.textures_created;
+        result.bytes_uploaded = counts.bytes_uploaded;
+        return result;
+    }
+
+    static void _write_trace_string(std::ofstream &out, const string &text)
+    {
+        out << '"';
+        for (char c : text)
+        {
+            switch (c)
+            {
+                case '"':  out << "\\\""; break;
+                case '\\': out << "\\\\"; break;
+                case '\n': out << "\\n"; break;
+                case '\t': out << "\\t"; break;
+                default:
+                    if ( static_cast<unsigned char>(c) < 0x20 )
+                    {
+                        char esc[8];
+                        snprintf(esc, sizeof(esc), "\\u%04x", c);
+                        out << esc;
+                    }
+                    else
+                        out << c;
+            }
+        }
+        out << '"';
+    }
+
+    bool save_profile_trace(const string &filename)
+    {
+        std::ofstream out(filename, std::ofstream::out | std::ofstream::trunc);
+        if ( ! out )
+        {
+            LOG(WARNING) << "Unable to open " << filename << " to save profile trace";
+            return false;
+        }
+
+        vector<sk_profile_frame> frames = sk_profile_frames();
+        map<int, string> names;
+        bool first = true;
+
+        // Complete ("X") events with microsecond timestamps. Each frame is
+        // also written as a zone on its own track so frame boundaries show.
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (const sk_profile_frame &frame : frames)
+        {
+            if ( ! first ) out << ',';
+            first = false;
+            out << "\n{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":0"
+                << ",\"ts\":" << frame.start_ns / 1000.0
+                << ",\"dur\":" << (frame.end_ns - frame.start_ns) / 1000.0 << '}';
+
+            for (const sk_profile_event &evt : frame.events)
+            {
+                auto it = names.find(evt.name);
+                if ( it == names.end() ) it = names.emplace(evt.name, sk_profile_name(evt.name)).first;
+
+                out << ",\n{\"name\":";
+                _write_trace_string(out, it->second);
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << evt.thread + 1
+                    << ",\"ts\":" << evt.start_ns / 1000.0
+                    << ",\"dur\":" << evt.duration_ns / 1000.0 << '}';
+            }
+        }
+        out << "\n]}\n";
+
+        return static_cast<bool>(out);
+    }
+}
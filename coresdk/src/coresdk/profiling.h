@@ -0,0 +1,123 @@
+/**
+ * @header  profiling
+ * @brief   SplashKit profiling lets you time sections of your program each frame.
+ *
+ * Mark sections of your code with `profile_begin` and `profile_end`. While
+ * profiling is enabled, SplashKit records how long each section takes, and
+ * keeps the timings for recent frames. A frame ends each time you call
+ * `process_events`. SplashKit times its own event processing, network
+ * checks, text drawing and window refreshes in the same way.
+ *
+ * @attribute group  utilities
+ * @attribute static profiling
+ */
+
+#ifndef profiling_hpp
+#define profiling_hpp
+
+#include "window_manager.h"
+
+#include <string>
+using std::string;
+
+namespace splashkit_lib
+{
+    /**
+     * Counts of the rendering work done in one frame. These are counted
+     * whether or not profiling is enabled.
+     *
+     * @field draw_calls            The number of draws sent to the renderer
+     * @field texture_switches      The number of draws that used a different
+     *                              texture to the draw before
+     * @field render_target_changes The number of times drawing moved between
+     *                              windows and bitmaps
+     * @field text_rasterizations   The number of strings and glyphs drawn
+     *                              from the font, rather than from a cache
+     * @field textures_created      The number of textures created
+     * @field bytes_uploaded        The bytes of pixels sent to video memory
+     */
+    struct render_statistics
+    {
+        int draw_calls;
+        int texture_switches;
+        int render_target_changes;
+        int text_rasterizations;
+        int textures_created;
+        long long bytes_uploaded;
+    };
+
+    /**
+     * Start recording profile zones. Timings are kept for the most recent
+     * frames only.
+     */
+    void enable_profiling();
+
+    /**
+     * Stop recording profile zones. Timings already collected are kept.
+     */
+    void disable_profiling();
+
+    /**
+     * Check if profile zones are being recorded.
+     *
+     * @returns True if profiling is enabled.
+     */
+    bool profiling_enabled();
+
+    /**
+     * Start timing a zone of your code. Each call must be matched by a call
+     * to `profile_end`. Zones can be nested.
+     *
+     * @param name  The name of the zone, for example "physics"
+     */
+    void profile_begin(const string &name);
+
+    /**
+     * Stop timing the zone most recently started by `profile_begin` on this
+     * thread.
+     */
+    void profile_end();
+
+    /**
+     * The average time spent in a zone each frame, over the recent frames.
+     *
+     * @param name  The name of the zone
+     * @returns     The average time in milliseconds, or 0 if the zone did not run
+     */
+    double profile_zone_time(const string &name);
+
+    /**
+     * The average length of the recent frames.
+     *
+     * @returns The average frame time in milliseconds
+     */
+    double profile_frame_time();
+
+    /**
+     * Draw a summary of the recent frames in the top left of the window. Each
+     * zone is listed with its average and longest time per frame, below the
+     * rendering counts of the last frame.
+     *
+     * @param wind  The window to draw the overlay to
+     */
+    void draw_profile_overlay(window wind);
+
+    /**
+     * The rendering work done in the frame most recently shown. The counts
+     * restart each time a window is refreshed.
+     *
+     * @returns The counts for the last frame
+     */
+    render_statistics render_stats();
+
+    /**
+     * Save the recent frames in the Chrome trace event format. The file can be
+     * opened in chrome://tracing or https://ui.perfetto.dev.
+     *
+     * @param filename  The path of the file to write
+     * @returns         True if the trace was written
+     */
+    bool save_profile_trace(const string &filename);
+}
+
+#endif /* profiling_hpp */
@@ -10,6 +10,8 @@
 #include "matrix_2d.h"
 #include "vector_2d.h"
 
+#include <array>
+
 namespace splashkit_lib
 {
     quad quad_from(double x_top_left, double y_top_left,
@@ -67,24 +69,35 @@ namespace splashkit_lib
         }
     }
 
+    static std::array<triangle, 2> _triangles_from(const quad &q)
+    {
+        return {{
+            triangle_from(q.points[0], q.points[1], q.points[2]),
+            triangle_from(q.points[2], q.points[3], q.points[1])
+        }};
+    }
+
     vector<triangle> triangles_from(const quad &q)
     {
         vector<triangle> result;
-
-        result.push_back(triangle_from(q.points[0], q.points[1], q.points[2]));
-        result.push_back(triangle_from(q.points[2], q.points[3], q.points[1]));
-
+        triangles_from(q, result);
         return result;
     }
 
+    void triangles_from(const quad &q, vector<triangle> &out_result)
+    {
+        std::array<triangle, 2> triangles = _triangles_from(q);
+        out_result.assign(triangles.begin(), triangles.end());
+    }
+
     bool quads_intersect(const quad &q1, const quad &q2)
     {
-        vector<triangle> q1_triangles = triangles_from(q1);
-        vector<triangle> q2_triangles = triangles_from(q2);
+        std::array<triangle, 2> q1_triangles = _triangles_from(q1);
+        std::array<triangle, 2> q2_triangles = _triangles_from(q2);
 
-        for (triangle t1 : q1_triangles)
+        for (const triangle &t1 : q1_triangles)
         {
-            for (triangle t2 : q2_triangles)
+            for (const triangle &t2 : q2_triangles)
             {
                 if ( triangles_intersect(t1, t2) )
                 {
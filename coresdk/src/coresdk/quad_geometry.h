@@ -100,5 +100,16 @@ namespace splashkit_lib
      */
     vector<triangle> triangles_from(const quad &q);
 
+    /**
+     * Gets the two triangles that make up a quad, reusing the supplied vector
+     * so that no memory needs to be allocated once it has grown.
+     *
+     * @param q             The quad
+     * @param out_result    After the call this holds the two triangles from the quad
+     *
+     * @attribute suffix  into
+     */
+    void triangles_from(const quad &q, vector<triangle> &out_result);
+
 }
 #endif /* quad_geometry_h */
@@ -8,33 +8,163 @@
 //
 
 #include "random.h"
-#include <cstdlib>
-#include <ctime>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <easylogging++.h>
 
+// Number of independent generators stepped together by rnd_fill. Keeping
+// them in separate arrays lets the compiler step them with vector
+// instructions.
+#define RND_FILL_LANES 8
+
 namespace splashkit_lib
 {
-    static bool _do_seed = true;
+    // Each thread gets its own xoshiro256** generator, so rnd never takes a
+    // lock and threads do not disturb each other's sequences.
+    struct _rnd_state
+    {
+        uint64_t s[4];
+        bool seeded = false;
+    };
+
+    // xoshiro128+ lanes used for bulk generation, seeded from _rnd_state
+    struct _rnd_lanes
+    {
+        uint32_t s0[RND_FILL_LANES], s1[RND_FILL_LANES], s2[RND_FILL_LANES], s3[RND_FILL_LANES];
+        bool seeded = false;
+    };
+
+    static thread_local _rnd_state _rnd;
+    static thread_local _rnd_lanes _rnd_bulk;
+
+    // Seed used by threads that have not yet drawn a number
+    static std::atomic<uint64_t> _rnd_base_seed(static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count()));
+    static std::atomic<uint64_t> _rnd_thread_count(0);
+
+    static inline uint64_t _rotl64(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    static inline uint32_t _rotl32(uint32_t x, int k)
+    {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    // splitmix64, used to expand a single seed into a full generator state
+    static inline uint64_t _splitmix64(uint64_t &x)
+    {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    static void _seed_state(_rnd_state &state, uint64_t seed)
+    {
+        for (int i = 0; i < 4; i++)
+            state.s[i] = _splitmix64(seed);
+        state.seeded = true;
+    }
+
+    static inline uint64_t _next(_rnd_state &state)
+    {
+        if ( ! state.seeded )
+        {
+            // Offset each thread from the base seed so they do not share a sequence
+            uint64_t seed = _rnd_base_seed.load() + 0x632be59bd9b4e019ULL * _rnd_thread_count++;
+            _seed_state(state, seed);
+        }
+
+        uint64_t *s = state.s;
+        const uint64_t result = _rotl64(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = _rotl64(s[3], 45);
+
+        return result;
+    }
+
+    // A value in [0, range) without modulo bias (Lemire's multiply and reject)
+    static uint32_t _bounded(uint32_t range)
+    {
+        uint64_t m = static_cast<uint64_t>(static_cast<uint32_t>(_next(_rnd) >> 32)) * range;
+        uint32_t low = static_cast<uint32_t>(m);
+
+        if ( low < range )
+        {
+            uint32_t threshold = static_cast<uint32_t>(-range) % range;
+            while ( low < threshold )
+            {
+                m = static_cast<uint64_t>(static_cast<uint32_t>(_next(_rnd) >> 32)) * range;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    static void _seed_lanes(_rnd_lanes &lanes)
+    {
+        for (int i = 0; i < RND_FILL_LANES; i++)
+        {
+            uint64_t a = _next(_rnd), b = _next(_rnd);
+            lanes.s0[i] = static_cast<uint32_t>(a);
+            lanes.s1[i] = static_cast<uint32_t>(a >> 32);
+            lanes.s2[i] = static_cast<uint32_t>(b);
+            lanes.s3[i] = static_cast<uint32_t>(b >> 32) | 1; // never all zero
+        }
+        lanes.seeded = true;
+    }
+
+    // Step every lane once, writing one 32 bit value per lane
+    static inline void _next_lanes(_rnd_lanes &lanes, uint32_t out[RND_FILL_LANES])
+    {
+        for (int i = 0; i < RND_FILL_LANES; i++)
+        {
+            out[i] = lanes.s0[i] + lanes.s3[i];
+
+            const uint32_t t = lanes.s1[i] << 9;
+            lanes.s2[i] ^= lanes.s0[i];
+            lanes.s3[i] ^= lanes.s1[i];
+            lanes.s1[i] ^= lanes.s2[i];
+            lanes.s0[i] ^= lanes.s3[i];
+            lanes.s2[i] ^= t;
+            lanes.s3[i] = _rotl32(lanes.s3[i], 11);
+        }
+    }
+
+    void rnd_seed(unsigned int seed)
+    {
+        _rnd_base_seed = seed;
+        _rnd_thread_count = 1;
+        _seed_state(_rnd, seed);
+        _rnd_bulk.seeded = false;
+    }
 
     float rnd()
     {
-        return rnd(RAND_MAX) / static_cast<float>(RAND_MAX);
+        // The top 24 bits fill a float's mantissa exactly, giving [0, 1)
+        return static_cast<float>(_next(_rnd) >> 40) * (1.0f / 16777216.0f);
     }
 
     int rnd(int ubound)
     {
         if (ubound == 0) return 0;
-        
-        if (_do_seed)
-        {
-            _do_seed = false;
-            srand((unsigned)time(0));
-        }
-        
-        return rand() % ubound;
+
+        // A negative bound behaves as its magnitude, as rand() % ubound did
+        uint32_t range = ubound < 0 ? 0u - static_cast<uint32_t>(ubound) : static_cast<uint32_t>(ubound);
+        return static_cast<int>(_bounded(range));
     }
-    
+
     int rnd(int min, int max)
     {
         if (min > max)
@@ -44,13 +174,70 @@ namespace splashkit_lib
         }
 
         if (min == max) return min;
-        
-        if (_do_seed)
+
+        uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(max) - min);
+        return static_cast<int>(static_cast<int64_t>(min) + _bounded(range));
+    }
+
+    void rnd_fill(vector<float> &values)
+    {
+        const size_t count = values.size();
+        if ( count == 0 ) return;
+        if ( ! _rnd_bulk.seeded ) _seed_lanes(_rnd_bulk);
+
+        uint32_t bits[RND_FILL_LANES];
+        size_t i = 0;
+
+        for ( ; i + RND_FILL_LANES <= count; i += RND_FILL_LANES)
+        {
+            _next_lanes(_rnd_bulk, bits);
+            for (int j = 0; j < RND_FILL_LANES; j++)
+                values[i + j] = static_cast<float>(bits[j] >> 8) * (1.0f / 16777216.0f);
+        }
+
+        if ( i < count )
+        {
+            _next_lanes(_rnd_bulk, bits);
+            for (int j = 0; i < count; i++, j++)
+                values[i] = static_cast<float>(bits[j] >> 8) * (1.0f / 16777216.0f);
+        }
+    }
+
+    void rnd_fill(vector<int> &values, int min, int max)
+    {
+        const size_t count = values.size();
+        if ( count == 0 ) return;
+
+        if (min > max)
         {
-            _do_seed = false;
-            srand((unsigned)time(0));
+            LOG(WARNING) << "Min value is greater than max value when calling rnd_fill.";
+            std::swap(min, max);
+        }
+
+        if (min == max)
+        {
+            std::fill(values.begin(), values.end(), min);
+            return;
+        }
+
+        if ( ! _rnd_bulk.seeded ) _seed_lanes(_rnd_bulk);
+
+        const uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(max) - min);
+        const uint32_t threshold = static_cast<uint32_t>(-range) % range;
+        uint32_t bits[RND_FILL_LANES];
+
+        for (size_t i = 0; i < count; i += RND_FILL_LANES)
+        {
+            _next_lanes(_rnd_bulk, bits);
+
+            for (int j = 0; j < RND_FILL_LANES && i + j < count; j++)
+            {
+                uint64_t m = static_cast<uint64_t>(bits[j]) * range;
+
+                // Rare values that would bias the result are redrawn
+                uint32_t offset = static_cast<uint32_t>(m) < threshold ? _bounded(range) : static_cast<uint32_t>(m >> 32);
+                values[i + j] = static_cast<int>(static_cast<int64_t>(min) + offset);
+            }
         }
-        
-        return min + rand() % (max - min);
     }
 }
@@ -13,6 +13,10 @@
 
 #ifndef random_hpp
 #define random_hpp
+
+#include <vector>
+using std::vector;
+
 namespace splashkit_lib
 {
     /**
@@ -43,5 +47,38 @@ namespace splashkit_lib
      */
     int rnd(int min, int max);
 
+    /**
+     * Seeds the random number generator for the current thread. After seeding
+     * with the same value, `rnd` and `rnd_fill` produce the same sequence of
+     * numbers, which is useful for replaying a game exactly. Threads that have
+     * not yet generated a number will also be seeded from this value.
+     *
+     * @param seed  the value to start the sequence from
+     */
+    void rnd_seed(unsigned int seed);
+
+    /**
+     * Fills each of the `values` with a random number between 0 and 1. This
+     * is much faster than calling `rnd` in a loop when many numbers are
+     * needed.
+     *
+     * @param values    the values to fill, resize it to the number needed
+     *
+     * @attribute suffix  float
+     */
+    void rnd_fill(vector<float> &values);
+
+    /**
+     * Fills each of the `values` with a random number between 'min' and
+     * `max`, matching the range used by `rnd(min, max)`.
+     *
+     * @param values    the values to fill, resize it to the number needed
+     * @param min       the `int` representing of minimum bound.
+     * @param max       the `int` representing of maximum bound.
+     *
+     * @attribute suffix  int_range
+     */
+    void rnd_fill(vector<int> &values, int min, int max);
+
 #endif /* random_hpp */
 }
@@ -5,6 +5,8 @@
 #include "raspi_gpio.h"
 #include "gpio_driver.h"
 #include <iostream>
+#include <map>
+#include <vector>
 using namespace std;
 
 namespace splashkit_lib
@@ -129,6 +131,37 @@ namespace splashkit_lib
         return GPIO_DEFAULT_VALUE;
 #endif
     }
+    unsigned int raspi_pin_mask(pins pin)
+    {
+        int bcmPin = boardToBCM(pin);
+        if (bcmPin < 0)
+        {
+            return 0;
+        }
+        return 1u << bcmPin;
+    }
+
+    // Read all pins in one request
+    unsigned int raspi_read_all()
+    {
+#ifdef RASPBERRY_PI
+        return sk_gpio_read_bank();
+#else
+        cout << "Unable to read pins - GPIO not supported on this platform" << endl;
+        return 0;
+#endif
+    }
+
+    // Write many pins in one request
+    void raspi_write_mask(unsigned int set, unsigned int clear)
+    {
+#ifdef RASPBERRY_PI
+        sk_gpio_write_bank(set, clear);
+#else
+        cout << "Unable to write pins - GPIO not supported on this platform" << endl;
+#endif
+    }
+
     void raspi_set_pull_up_down(pins pin, pull_up_down pud)
     {
 #ifdef RASPBERRY_PI
@@ -210,10 +243,234 @@ namespace splashkit_lib
 #endif
     }
 
+    void raspi_set_hardware_pwm(pins pin, int frequency, int dutycycle)
+    {
+#ifdef RASPBERRY_PI
+        int bcmPin = boardToBCM(pin);
+        if (bcmPin != 12 && bcmPin != 13 && bcmPin != 18 && bcmPin != 19)
+        {
+            cout << "Hardware PWM is not available on PIN: " << pin << endl;
+        }
+        else
+        {
+            sk_gpio_hardware_pwm(bcmPin, frequency, dutycycle);
+        }
+#else
+        cout << "Unable to set hardware pwm - GPIO not supported on this platform" << endl;
+#endif
+    }
+
+#ifdef RASPBERRY_PI
+    // The waveform being built, sent to the daemon in one request
+    static vector<sk_gpio_pulse> _wave_pulses;
+#endif
+
+    void raspi_wave_clear()
+    {
+#ifdef RASPBERRY_PI
+        _wave_pulses.clear();
+#endif
+    }
+
+    void raspi_wave_add_pulse(unsigned int set, unsigned int clear, int delay_us)
+    {
+#ifdef RASPBERRY_PI
+        _wave_pulses.push_back({set, clear, static_cast<uint32_t>(delay_us < 0 ? 0 : delay_us)});
+#else
+        cout << "Unable to add pulse - GPIO not supported on this platform" << endl;
+#endif
+    }
+
+    bool raspi_wave_send(bool repeat)
+    {
+#ifdef RASPBERRY_PI
+        if (_wave_pulses.empty())
+        {
+            cout << "Add pulses with raspi_wave_add_pulse before sending a wave" << endl;
+            return false;
+        }
+        return sk_wave_send(_wave_pulses, repeat) >= 0;
+#else
+        cout << "Unable to send wave - GPIO not supported on this platform" << endl;
+        return false;
+#endif
+    }
+
+    bool raspi_wave_busy()
+    {
+#ifdef RASPBERRY_PI
+        return sk_wave_busy();
+#else
+        return false;
+#endif
+    }
+
+    void raspi_wave_stop()
+    {
+#ifdef RASPBERRY_PI
+        sk_wave_stop();
+#endif
+    }
+
+    int raspi_spi_open(int channel, int speed, int spi_flags)
+    {
+#ifdef RASPBERRY_PI
+        int handle = sk_spi_open(channel, speed, spi_flags);
+        if (handle < 0)
+        {
+            cout << "Unable to open SPI channel " << channel << endl;
+        }
+        return handle;
+#else
+        cout << "Unable to open SPI - GPIO not supported on this platform" << endl;
+        return -1;
+#endif
+    }
+
+    void raspi_spi_close(int handle)
+    {
+#ifdef RASPBERRY_PI
+        sk_spi_close(handle);
+#endif
+    }
+
+    int raspi_spi_transfer(int handle, vector<char> &buffer)
+    {
+#ifdef RASPBERRY_PI
+        if (buffer.empty()) return 0;
+        return sk_spi_transfer(handle, buffer.data(), static_cast<int>(buffer.size()));
+#else
+        cout << "Unable to transfer over SPI - GPIO not supported on this platform" << endl;
+        return -1;
+#endif
+    }
+
+    int raspi_i2c_open(int bus, int address)
+    {
+#ifdef RASPBERRY_PI
+        int handle = sk_i2c_open(bus, address, 0);
+        if (handle < 0)
+        {
+            cout << "Unable to open I2C device " << address << " on bus " << bus << endl;
+        }
+        return handle;
+#else
+        cout << "Unable to open I2C - GPIO not supported on this platform" << endl;
+        return -1;
+#endif
+    }
+
+    void raspi_i2c_close(int handle)
+    {
+#ifdef RASPBERRY_PI
+        sk_i2c_close(handle);
+#endif
+    }
+
+    vector<char> raspi_i2c_read_block(int handle, int reg, int count)
+    {
+#ifdef RASPBERRY_PI
+        if (count <= 0) return vector<char>();
+
+        vector<char> result(count);
+        int read = sk_i2c_read_block(handle, reg, result.data(), count);
+        result.resize(read > 0 ? read : 0);
+        return result;
+#else
+        cout << "Unable to read I2C - GPIO not supported on this platform" << endl;
+        return vector<char>();
+#endif
+    }
+
+    int raspi_i2c_write_block(int handle, int reg, const vector<char> &bytes)
+    {
+#ifdef RASPBERRY_PI
+        if (bytes.empty()) return 0;
+        // the daemon only reads the bytes, so they are sent without a copy
+        return sk_i2c_write_block(handle, reg, const_cast<char *>(bytes.data()), static_cast<int>(bytes.size()));
+#else
+        cout << "Unable to write I2C - GPIO not supported on this platform" << endl;
+        return -1;
+#endif
+    }
+
+#ifdef RASPBERRY_PI
+    // The handler watching each BCM pin
+    struct _edge_watch
+    {
+        pins pin;
+        gpio_edge_handler *handler;
+        int watch_id;
+    };
+
+    static map<int, _edge_watch> _edge_watches;
+#endif
+
+    void raspi_on_edge(pins pin, gpio_edge edge, gpio_edge_handler *handler)
+    {
+#ifdef RASPBERRY_PI
+        int bcmPin = boardToBCM(pin);
+        if (bcmPin < 0)
+        {
+            cout << "Cant watch a power or ground pin" << endl;
+            return;
+        }
+
+        raspi_stop_edge(pin);
+        if (!handler) return;
+
+        int watch_id = sk_gpio_watch_edge(bcmPin, static_cast<int>(edge));
+        if (watch_id < 0)
+        {
+            cout << "Unable to watch pin " << pin << " for edges" << endl;
+            return;
+        }
+
+        _edge_watches[bcmPin] = {pin, handler, watch_id};
+#else
+        cout << "Unable to watch pin - GPIO not supported on this platform" << endl;
+#endif
+    }
+
+    void raspi_stop_edge(pins pin)
+    {
+#ifdef RASPBERRY_PI
+        auto it = _edge_watches.find(boardToBCM(pin));
+        if (it == _edge_watches.end()) return;
+
+        sk_gpio_cancel_watch(it->second.watch_id);
+        _edge_watches.erase(it);
+#endif
+    }
+
+    // Called by process events, to pass the queued edges to their handlers
+    void _raspi_dispatch_edge_events()
+    {
+#ifdef RASPBERRY_PI
+        static vector<sk_gpio_edge_event> events;
+
+        if (_edge_watches.empty() || !sk_gpio_take_edge_events(events)) return;
+
+        for (const sk_gpio_edge_event &evt : events)
+        {
+            auto it = _edge_watches.find(evt.pin);
+            if (it == _edge_watches.end()) continue; // stopped since the edge was seen
+
+            it->second.handler(it->second.pin, static_cast<pin_values>(evt.level), evt.tick);
+        }
+#endif
+    }
+
     // Cleanup GPIO resources
     void raspi_cleanup()
     {
 #ifdef RASPBERRY_PI
+        for (auto &watch : _edge_watches)
+        {
+            sk_gpio_cancel_watch(watch.second.watch_id);
+        }
+        _edge_watches.clear();
+
         cout << "Cleaning GPIO pins" << endl;
         for (int i = 1; i <= 40; i++)
         {
@@ -10,9 +10,12 @@
 #define raspi_gpio_hpp
 
 #include <stdint.h>
+#include <vector>
 #include "gpio_driver.h"
 #include "types.h"
 
+using std::vector;
+
 namespace splashkit_lib
 {
     /**
@@ -109,11 +112,199 @@ namespace splashkit_lib
      */
     pin_values raspi_read(pins pin);
 
+    /**
+     * @brief Gets the bit used for a pin by `raspi_read_all` and `raspi_write_mask`.
+     *
+     * Power and ground pins have no bit, so they return 0.
+     *
+     * @param pin  The pin to get the bit for.
+     * @returns    The pin's bit, or 0 if the pin is not a GPIO pin.
+     */
+    unsigned int raspi_pin_mask(pins pin);
+
+    /**
+     * @brief Reads the values of all of the GPIO pins at once.
+     *
+     * This function reads every pin in a single request, which is much faster
+     * than reading the pins one at a time. Use `raspi_pin_mask` to check the
+     * value of a pin in the result.
+     *
+     * @returns    The pin values, with the bit for each high pin set.
+     */
+    unsigned int raspi_read_all();
+
+    /**
+     * @brief Writes the values of many GPIO pins at once.
+     *
+     * Pins in the clear mask are set low, then pins in the set mask are set
+     * high, in a single request. Combine the results of `raspi_pin_mask` to
+     * make the masks.
+     *
+     * @param set    The bits of the pins to set high.
+     * @param clear  The bits of the pins to set low.
+     */
+    void raspi_write_mask(unsigned int set, unsigned int clear);
+
     /**
      * @brief Cleans up and releases any resources used by the GPIO library.
      *
      * This function should be called when you are finished using the GPIO library. It sets all pin modes to INPUT and values to LOW.
      */
     void raspi_cleanup();
+
+    /**
+     * @brief Starts hardware PWM on the specified pin.
+     *
+     * Hardware PWM is timed by the Raspberry Pi's PWM peripheral, so it is
+     * far more precise than `raspi_set_pwm_dutycycle`. It is only available
+     * on pins 12, 32 and 33 (GPIO 18, 12 and 13) and pin 35 (GPIO 19).
+     *
+     * @param pin        The pin to output PWM on.
+     * @param frequency  The PWM frequency, in Hz.
+     * @param dutycycle  The time the pin is high, out of 1000000. Use 0 to stop.
+     */
+    void raspi_set_hardware_pwm(pins pin, int frequency, int dutycycle);
+
+    /**
+     * @brief Removes the pulses added with `raspi_wave_add_pulse`.
+     */
+    void raspi_wave_clear();
+
+    /**
+     * @brief Adds a pulse to the end of the waveform being built.
+     *
+     * Each pulse sets some pins high, sets others low, then waits before the
+     * next pulse. Combine the results of `raspi_pin_mask` to make the masks.
+     * The pins must be set to output with `raspi_set_mode`.
+     *
+     * @param set       The bits of the pins to set high.
+     * @param clear     The bits of the pins to set low.
+     * @param delay_us  The time to wait before the next pulse, in microseconds.
+     */
+    void raspi_wave_add_pulse(unsigned int set, unsigned int clear, int delay_us);
+
+    /**
+     * @brief Sends the waveform that has been built.
+     *
+     * The waveform is timed by DMA, so it is accurate to the microsecond and
+     * uses no processor time while it plays. Sending a waveform stops the
+     * last one. The pulses are kept, so the waveform can be sent again.
+     *
+     * @param repeat  True to repeat the waveform until `raspi_wave_stop` is called.
+     * @returns       True if the waveform was sent.
+     */
+    bool raspi_wave_send(bool repeat);
+
+    /**
+     * @brief Checks if a waveform is being sent.
+     *
+     * @returns  True if a waveform is still playing.
+     */
+    bool raspi_wave_busy();
+
+    /**
+     * @brief Stops the waveform that is being sent.
+     */
+    void raspi_wave_stop();
+
+    /**
+     * @brief Opens a hardware SPI channel.
+     *
+     * Hardware SPI sends many bytes in a single request, which is much faster
+     * than writing each bit with `raspi_write`.
+     *
+     * @param channel    The SPI channel to open, 0 or 1 on the main SPI bus.
+     * @param speed      The speed of the bus, in bits per second.
+     * @param spi_flags  The pigpio SPI flags, 0 for mode 0 on the main bus.
+     * @returns          A handle for the channel, or a negative value if it could not be opened.
+     */
+    int raspi_spi_open(int channel, int speed, int spi_flags);
+
+    /**
+     * @brief Closes a hardware SPI channel.
+     *
+     * @param handle  The handle returned by `raspi_spi_open`.
+     */
+    void raspi_spi_close(int handle);
+
+    /**
+     * @brief Sends and receives bytes over a hardware SPI channel.
+     *
+     * SPI sends and receives at the same time, so the bytes received replace
+     * the bytes sent in the buffer. No other copy of the data is made.
+     *
+     * @param handle  The handle returned by `raspi_spi_open`.
+     * @param buffer  The bytes to send, which are replaced by the bytes received.
+     * @returns       The number of bytes transferred, or a negative value on failure.
+     */
+    int raspi_spi_transfer(int handle, vector<char> &buffer);
+
+    /**
+     * @brief Opens a device on a hardware I2C bus.
+     *
+     * @param bus      The I2C bus, usually 1.
+     * @param address  The address of the device on the bus.
+     * @returns        A handle for the device, or a negative value if it could not be opened.
+     */
+    int raspi_i2c_open(int bus, int address);
+
+    /**
+     * @brief Closes a device opened with `raspi_i2c_open`.
+     *
+     * @param handle  The handle returned by `raspi_i2c_open`.
+     */
+    void raspi_i2c_close(int handle);
+
+    /**
+     * @brief Reads a block of bytes from an I2C device's register.
+     *
+     * @param handle  The handle returned by `raspi_i2c_open`.
+     * @param reg     The register to read from.
+     * @param count   The number of bytes to read, up to 32.
+     * @returns       The bytes read, which is empty if the read failed.
+     */
+    vector<char> raspi_i2c_read_block(int handle, int reg, int count);
+
+    /**
+     * @brief Writes a block of bytes to an I2C device's register.
+     *
+     * @param handle  The handle returned by `raspi_i2c_open`.
+     * @param reg     The register to write to.
+     * @param bytes   The bytes to write, up to 32.
+     * @returns       0 if the bytes were written, or a negative value on failure.
+     */
+    int raspi_i2c_write_block(int handle, int reg, const vector<char> &bytes);
+
+    /**
+     * A gpio edge handler is called when a watched pin changes value.
+     *
+     * @param pin    The pin that changed.
+     * @param value  The new value of the pin.
+     * @param tick   When the change happened, in microseconds. This is
+     *               measured by the GPIO hardware, and wraps around about
+     *               every 72 minutes.
+     */
+    typedef void (gpio_edge_handler)(pins pin, pin_values value, unsigned int tick);
+
+    /**
+     * @brief Calls a handler each time the specified pin changes value.
+     *
+     * Changes are detected by the GPIO hardware, so short pulses are not
+     * missed between frames. The handler is called for each change, in
+     * order, when events are processed. Watching a pin again replaces its
+     * handler.
+     *
+     * @param pin      The pin to watch.
+     * @param edge     The changes to watch for.
+     * @param handler  The function to call when the pin changes.
+     */
+    void raspi_on_edge(pins pin, gpio_edge edge, gpio_edge_handler *handler);
+
+    /**
+     * @brief Stops watching the specified pin for changes.
+     *
+     * @param pin  The pin to stop watching.
+     */
+    void raspi_stop_edge(pins pin);
 }
 #endif /* raspi_gpio_hpp */
@@ -104,6 +104,129 @@ namespace splashkit_lib
         fill_rectangle(clr, rect.x, rect.y, rect.width, rect.height, option_defaults());
     }
 
+    void fill_rectangles(color clr, const vector<rectangle> &rects, const drawing_options &opts)
+    {
+        sk_drawing_surface *surface;
+
+        surface = to_surface_ptr(opts.dest);
+
+        if ( ! surface ) return;
+
+        for (const rectangle &rect : rects)
+        {
+            double x = rect.x, y = rect.y;
+            double width = rect.width, height = rect.height;
+
+            if ( width == 0 || height == 0 ) continue;
+
+            if (width < 0)
+            {
+                x = x + width;
+                width = -width;
+            }
+
+            if (height < 0)
+            {
+                y = y + height;
+                height = -height;
+            }
+
+            xy_from_opts(opts, x, y);
+            sk_fill_aa_rect(surface, clr, x, y, width, height);
+        }
+    }
+
+    void fill_rectangles(color clr, const vector<rectangle> &rects)
+    {
+        fill_rectangles(clr, rects, option_defaults());
+    }
+
+    void fill_rectangle(rgba8 clr, double x, double y, double width, double height, const drawing_options &opts)
+    {
+        if ( width == 0 || height == 0 ) return;
+
+        sk_drawing_surface *surface;
+
+        surface = to_surface_ptr(opts.dest);
+
+        if (surface)
+        {
+            if (width < 0)
+            {
+                x = x + width;
+                width = -width;
+            }
+
+            if (height < 0)
+            {
+                y = y + height;
+                height = -height;
+            }
+
+            xy_from_opts(opts, x, y);
+            sk_fill_aa_rect(surface, clr, x, y, width, height);
+        }
+    }
+
+    void fill_rectangle(rgba8 clr, double x, double y, double width, double height)
+    {
+        fill_rectangle(clr, x, y, width, height, option_defaults());
+    }
+
+    void fill_rectangles(const vector<rgba8> &clrs, const vector<rectangle> &rects, const drawing_options &opts)
+    {
+        sk_drawing_surface *surface;
+
+        surface = to_surface_ptr(opts.dest);
+
+        if ( ! surface ) return;
+
+        if ( clrs.size() != rects.size() )
+        {
+            LOG(WARNING) << "Trying to fill " << rects.size() << " rectangles with " << clrs.size() << " colors";
+            return;
+        }
+
+        static vector<rgba8> fill_clrs;
+        static vector<double> data;
+        fill_clrs.clear();
+        data.clear();
+        data.reserve(rects.size() * 4);
+
+        for (size_t i = 0; i < rects.size(); i++)
+        {
+            const rectangle &rect = rects[i];
+            double x = rect.x, y = rect.y;
+            double width = rect.width, height = rect.height;
+
+            if ( width == 0 || height == 0 ) continue;
+
+            if (width < 0)
+            {
+                x = x + width;
+                width = -width;
+            }
+
+            if (height < 0)
+            {
+                y = y + height;
+                height = -height;
+            }
+
+            xy_from_opts(opts, x, y);
+
+            fill_clrs.push_back(clrs[i]);
+            data.insert(data.end(), { x, y, width, height });
+        }
+
+        sk_fill_aa_rects(surface, fill_clrs.data(), data.data(), static_cast<int>(fill_clrs.size()));
+    }
+
+    void fill_rectangles(const vector<rgba8> &clrs, const vector<rectangle> &rects)
+    {
+        fill_rectangles(clrs, rects, option_defaults());
+    }
+
     void draw_quad(color clr, const quad &q)
     {
         draw_quad(clr, q, option_defaults());
@@ -152,7 +275,7 @@ namespace splashkit_lib
         }
     }
 
-    void draw_rectangle_on_window(window destination, color clr, double x, double y, double width, double height, drawing_options opts)
+    void draw_rectangle_on_window(window destination, color clr, double x, double y, double width, double height, const drawing_options &opts)
     {
         draw_rectangle(clr, x, y, width, height, option_draw_to(destination, opts));
     }
@@ -212,7 +335,7 @@ namespace splashkit_lib
         fill_quad(clr, q, option_draw_to(destination, opts));
     }
 
-    void draw_rectangle_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, drawing_options opts)
+    void draw_rectangle_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, const drawing_options &opts)
     {
         draw_rectangle(clr, x, y, width, height, option_draw_to(destination, opts));
     }
@@ -113,6 +113,83 @@ namespace splashkit_lib
      */
     void fill_rectangle(color clr, const rectangle &rect);
 
+    /**
+     * Fills many rectangles of the same color using the supplied drawing
+     * options. This is faster than filling each rectangle in turn,
+     * particularly when called from other languages.
+     *
+     * @param clr     The color of the rectangles
+     * @param rects   The rectangles to fill
+     * @param opts    The drawing options
+     *
+     * @attribute suffix  with_options
+     */
+    void fill_rectangles(color clr, const vector<rectangle> &rects, const drawing_options &opts);
+
+    /**
+     * Fills many rectangles of the same color onto the current window.
+     *
+     * @param clr     The color of the rectangles
+     * @param rects   The rectangles to fill
+     */
+    void fill_rectangles(color clr, const vector<rectangle> &rects);
+
+    /**
+     * Fills a rectangle with a packed color using the supplied drawing
+     * options. The color is drawn without being converted.
+     *
+     * @param clr     The packed color of the rectangle
+     * @param x       The distance from the left of the window/bitmap to the
+     *                rectangle
+     * @param y       The distance from the top of the window/bitmap to the
+     *                rectangle
+     * @param width   The width of the rectangle
+     * @param height  The height of the rectangle
+     * @param opts    The drawing options
+     *
+     * @attribute suffix  packed_with_options
+     */
+    void fill_rectangle(rgba8 clr, double x, double y, double width, double height, const drawing_options &opts);
+
+    /**
+     * Fills a rectangle with a packed color to the current window.
+     *
+     * @param clr     The packed color of the rectangle
+     * @param x       The distance from the left of the window/bitmap to the
+     *                rectangle
+     * @param y       The distance from the top of the window/bitmap to the
+     *                rectangle
+     * @param width   The width of the rectangle
+     * @param height  The height of the rectangle
+     *
+     * @attribute suffix  packed
+     */
+    void fill_rectangle(rgba8 clr, double x, double y, double width, double height);
+
+    /**
+     * Fills many rectangles, each with its own packed color, using the
+     * supplied drawing options. The rectangles are drawn together in a single
+     * draw, which suits gradients and heatmaps made of many cells.
+     *
+     * @param clrs    The packed color of each rectangle
+     * @param rects   The rectangles to fill, one for each color
+     * @param opts    The drawing options
+     *
+     * @attribute suffix  packed_with_options
+     */
+    void fill_rectangles(const vector<rgba8> &clrs, const vector<rectangle> &rects, const drawing_options &opts);
+
+    /**
+     * Fills many rectangles, each with its own packed color, onto the current
+     * window.
+     *
+     * @param clrs    The packed color of each rectangle
+     * @param rects   The rectangles to fill, one for each color
+     *
+     * @attribute suffix  packed
+     */
+    void fill_rectangles(const vector<rgba8> &clrs, const vector<rectangle> &rects);
+
     /**
      * Draw a quad to the current window.
      *
@@ -281,7 +358,7 @@ namespace splashkit_lib
      * @attribute class     window
      * @attribute method    draw_rectangle
      */
-    void draw_rectangle_on_window(window destination, color clr, double x, double y, double width, double height, drawing_options opts);
+    void draw_rectangle_on_window(window destination, color clr, double x, double y, double width, double height, const drawing_options &opts);
 
     /**
      *  Draw a rectangle to the window using. The rectangle is centred on its x, y
@@ -459,7 +536,7 @@ namespace splashkit_lib
      * @attribute class     bitmap
      * @attribute method    draw_rectangle
      */
-    void draw_rectangle_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, drawing_options opts);
+    void draw_rectangle_on_bitmap(bitmap destination, color clr, double x, double y, double width, double height, const drawing_options &opts);
     
     /**
      *  Draw a rectangle to the bitmap using. The rectangle is centred on its x, y
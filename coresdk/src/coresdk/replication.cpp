@@ -0,0 +1,613 @@
+//
+//  replication.cpp
+//  splashkit
+//
+//  Snapshot messages start with "RS" and their kind, then the snapshot and
+//  baseline numbers and the field count. With no baseline every value
+//  follows. Otherwise each field has a bit that is set when its value
+//  changed since the baseline, followed by the new value. Values are packed
+//  in the fewest bits that hold their range, least significant first.
+//  Acknowledgements hold the latest snapshot a client has, or 0 to ask for
+//  every field when the client is missing the baseline it was sent.
+//
+
+#include "replication.h"
+
+#include "backend_types.h"
+#include "utility_functions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+using std::map;
+using std::to_string;
+using std::vector;
+
+// The snapshots kept on each side to encode and decode changes against
+#define REPLICATION_HISTORY 64
+// The bytes before the packed values: "RS", the kind, two numbers and a count
+#define REPLICATION_HEADER_SIZE 15
+
+namespace splashkit_lib
+{
+    enum _replication_message_kind
+    {
+        REPLICATION_SNAPSHOT = 1,
+        REPLICATION_ACK = 2
+    };
+
+    struct _replicated_field
+    {
+        string name;
+        double min, max, precision;
+        uint32_t max_step;
+        int bits;
+
+        // fields added with a sprite follow its x or y, finding it by name so
+        // a freed sprite is skipped
+        string target;
+        bool target_y;
+    };
+
+    struct _replication_snapshot
+    {
+        unsigned int number;    // 0 while the slot is unused
+        vector<uint32_t> steps;
+    };
+
+    struct _replicated_state_data
+    {
+        pointer_identifier id;
+        vector<_replicated_field> fields;
+        map<string, int> field_ids;
+        vector<double> values;
+
+        // indexed by the snapshot number modulo the history size
+        _replication_snapshot history[REPLICATION_HISTORY];
+        unsigned int latest;
+
+        // the latest snapshot each client acknowledged, by client key
+        map<string, unsigned int> acked;
+
+        // the latest snapshot encoded against each baseline, 0 for none
+        map<unsigned int, string> encoded;
+    };
+
+    //----------------------------------------------------------------------
+    // Bit packing
+    //----------------------------------------------------------------------
+
+    struct _bit_writer
+    {
+        string &out;
+        uint64_t pending;
+        int count;
+
+        void write(uint32_t value, int bits)
+        {
+            pending |= static_cast<uint64_t>(value) << count;
+            count += bits;
+
+            while ( count >= 8 )
+            {
+                out.push_back(static_cast<char>(pending & 0xff));
+                pending >>= 8;
+                count -= 8;
+            }
+        }
+
+        void finish()
+        {
+            if ( count > 0 ) out.push_back(static_cast<char>(pending & 0xff));
+            pending = 0;
+            count = 0;
+        }
+    };
+
+    struct _bit_reader
+    {
+        const string &in;
+        size_t pos;
+        uint64_t pending;
+        int count;
+
+        bool read(int bits, uint32_t &out_value)
+        {
+            while ( count < bits )
+            {
+                if ( pos >= in.size() ) return false;
+                pending |= static_cast<uint64_t>(static_cast<uint8_t>(in[pos++])) << count;
+                count += 8;
+            }
+
+            out_value = bits == 32 ? static_cast<uint32_t>(pending) : static_cast<uint32_t>(pending & ((1ull << bits) - 1));
+            pending >>= bits;
+            count -= bits;
+            return true;
+        }
+    };
+
+    static void _write_uint(string &out, uint32_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; i++)
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+
+    static uint32_t _read_uint(const string &in, size_t pos, int bytes)
+    {
+        uint32_t result = 0;
+        for (int i = 0; i < bytes; i++)
+            result |= static_cast<uint32_t>(static_cast<uint8_t>(in[pos + i])) << (8 * i);
+        return result;
+    }
+
+    //----------------------------------------------------------------------
+    // Fields
+    //----------------------------------------------------------------------
+
+    replicated_state create_replicated_state()
+    {
+        replicated_state result = new _replicated_state_data;
+        result->id = REPLICATED_STATE_PTR;
+        result->latest = 0;
+        for (auto &snapshot : result->history) snapshot.number = 0;
+        return result;
+    }
+
+    void free_replicated_state(replicated_state state)
+    {
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) )
+        {
+            LOG(WARNING) << "Trying to free replicated state with invalid pointer";
+            return;
+        }
+
+        notify_of_free(state);
+
+        state->id = NONE_PTR;
+        delete state;
+    }
+
+    static int _add_field(replicated_state state, const string &name, double min, double max, double precision, const string &target, bool target_y)
+    {
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) )
+        {
+            LOG(WARNING) << "Trying to add a field to an invalid replicated state";
+            return -1;
+        }
+
+        if ( state->field_ids.count(name) )
+        {
+            LOG(WARNING) << "Replicated state already has a field named " << name;
+            return -1;
+        }
+
+        if ( ! (max >= min) || ! (precision > 0) )
+        {
+            LOG(WARNING) << "Replicated field " << name << " needs a max at least its min and a precision above 0";
+            return -1;
+        }
+
+        // snapshots taken before the field was added cannot be changed from
+        if ( state->latest > 0 )
+        {
+            LOG(WARNING) << "Fields must be added to a replicated state before its first snapshot";
+            return -1;
+        }
+
+        double steps = std::round((max - min) / precision);
+        if ( steps > 4294967295.0 )
+        {
+            LOG(WARNING) << "Replicated field " << name << " needs more than 32 bits for its range and precision";
+            return -1;
+        }
+
+        _replicated_field field;
+        field.name = name;
+        field.min = min;
+        field.max = max;
+        field.precision = precision;
+        field.max_step = static_cast<uint32_t>(steps);
+        field.bits = 0;
+        while ( field.bits < 32 && (static_cast<uint64_t>(field.max_step) >> field.bits) != 0 ) field.bits++;
+        field.target = target;
+        field.target_y = target_y;
+
+        int result = static_cast<int>(state->fields.size());
+        state->fields.push_back(field);
+        state->field_ids[name] = result;
+        state->values.push_back(min);
+        return result;
+    }
+
+    int replicated_state_add_number(replicated_state state, const string &name, double min, double max, double precision)
+    {
+        return _add_field(state, name, min, max, precision, "", false);
+    }
+
+    int replicated_state_add_integer(replicated_state state, const string &name, int min, int max)
+    {
+        return _add_field(state, name, min, max, 1, "", false);
+    }
+
+    int replicated_state_add_bool(replicated_state state, const string &name)
+    {
+        return _add_field(state, name, 0, 1, 1, "", false);
+    }
+
+    int replicated_state_add_sprite(replicated_state state, const string &name, sprite s, const rectangle &area, double precision)
+    {
+        string target = sprite_name(s);
+        if ( target.empty() )
+        {
+            LOG(WARNING) << "Trying to replicate the position of an invalid sprite";
+            return -1;
+        }
+
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) )
+        {
+            LOG(WARNING) << "Trying to add a field to an invalid replicated state";
+            return -1;
+        }
+
+        if ( state->field_ids.count(name + ".x") || state->field_ids.count(name + ".y") )
+        {
+            LOG(WARNING) << "Replicated state already has a field named " << name << ".x or " << name << ".y";
+            return -1;
+        }
+
+        int result = _add_field(state, name + ".x", area.x, area.x + area.width, precision, target, false);
+        if ( result < 0 ) return -1;
+
+        _add_field(state, name + ".y", area.y, area.y + area.height, precision, target, true);
+        return result;
+    }
+
+    int replicated_state_field(replicated_state state, const string &name)
+    {
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) ) return -1;
+
+        auto it = state->field_ids.find(name);
+        return it == state->field_ids.end() ? -1 : it->second;
+    }
+
+    int replicated_state_field_count(replicated_state state)
+    {
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) ) return 0;
+
+        return static_cast<int>(state->fields.size());
+    }
+
+    static bool _valid_field(replicated_state state, int field)
+    {
+        return VALID_PTR(state, REPLICATED_STATE_PTR) && field >= 0 && field < static_cast<int>(state->fields.size());
+    }
+
+    void replicated_state_set_value(replicated_state state, int field, double value)
+    {
+        if ( ! _valid_field(state, field) )
+        {
+            LOG(WARNING) << "Trying to set an invalid field of a replicated state";
+            return;
+        }
+
+        const _replicated_field &f = state->fields[field];
+        state->values[field] = std::min(std::max(value, f.min), f.max);
+    }
+
+    double replicated_state_value(replicated_state state, int field)
+    {
+        if ( ! _valid_field(state, field) ) return 0;
+
+        return state->values[field];
+    }
+
+    //----------------------------------------------------------------------
+    // Snapshots
+    //----------------------------------------------------------------------
+
+    static uint32_t _to_step(const _replicated_field &field, double value)
+    {
+        double step = std::round((std::min(std::max(value, field.min), field.max) - field.min) / field.precision);
+        return std::min(field.max_step, static_cast<uint32_t>(std::max(step, 0.0)));
+    }
+
+    static double _from_step(const _replicated_field &field, uint32_t step)
+    {
+        return std::min(field.max, field.min + std::min(step, field.max_step) * field.precision);
+    }
+
+    static _replication_snapshot *_snapshot_numbered(replicated_state state, unsigned int number)
+    {
+        if ( number == 0 ) return nullptr;
+
+        _replication_snapshot &result = state->history[number % REPLICATION_HISTORY];
+        return result.number == number ? &result : nullptr;
+    }
+
+    unsigned int replicated_state_take_snapshot(replicated_state state)
+    {
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) )
+        {
+            LOG(WARNING) << "Trying to take a snapshot of an invalid replicated state";
+            return 0;
+        }
+
+        unsigned int number = state->latest + 1;
+        _replication_snapshot &snapshot = state->history[number % REPLICATION_HISTORY];
+        snapshot.number = number;
+        snapshot.steps.resize(state->fields.size());
+
+        for (size_t i = 0; i < state->fields.size(); i++)
+        {
+            const _replicated_field &field = state->fields[i];
+
+            if ( ! field.target.empty() && has_sprite(field.target) )
+            {
+                sprite s = sprite_named(field.target);
+                state->values[i] = field.target_y ? sprite_y(s) : sprite_x(s);
+            }
+
+            snapshot.steps[i] = _to_step(field, state->values[i]);
+        }
+
+        state->latest = number;
+        state->encoded.clear();
+        return number;
+    }
+
+    unsigned int replicated_state_snapshot_number(replicated_state state)
+    {
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) ) return 0;
+
+        return state->latest;
+    }
+
+    static void _encode_snapshot(replicated_state state, const _replication_snapshot *baseline, string &out)
+    {
+        const _replication_snapshot &latest = *_snapshot_numbered(state, state->latest);
+
+        out.clear();
+        out += "RS";
+        out.push_back(static_cast<char>(REPLICATION_SNAPSHOT));
+        _write_uint(out, latest.number, 4);
+        _write_uint(out, baseline ? baseline->number : 0, 4);
+        _write_uint(out, static_cast<uint32_t>(state->fields.size()), 4);
+
+        _bit_writer bits = { out, 0, 0 };
+        for (size_t i = 0; i < state->fields.size(); i++)
+        {
+            if ( baseline )
+            {
+                bool changed = baseline->steps[i] != latest.steps[i];
+                bits.write(changed ? 1 : 0, 1);
+                if ( ! changed ) continue;
+            }
+
+            bits.write(latest.steps[i], state->fields[i].bits);
+        }
+        bits.finish();
+    }
+
+    //----------------------------------------------------------------------
+    // Clients
+    //----------------------------------------------------------------------
+
+    static string _client_key(connection con)
+    {
+        return "#" + to_string(connection_id(con));
+    }
+
+    static string _client_key(udp_endpoint ep)
+    {
+        return to_string(ep->address) + ":" + to_string(ep->address_port);
+    }
+
+    // Replies from UDP servers have no connection, so are matched to the
+    // endpoint they came from
+    static string _client_key(message msg)
+    {
+        connection con = message_connection(msg);
+        if ( con ) return _client_key(con);
+
+        udp_endpoint ep = resolve_endpoint(message_host(msg), message_port(msg));
+        return ep ? _client_key(ep) : "";
+    }
+
+    // The latest snapshot encoded against the last snapshot the client has
+    static const string *_snapshot_message_for(replicated_state state, const string &key)
+    {
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) )
+        {
+            LOG(WARNING) << "Trying to send an invalid replicated state";
+            return nullptr;
+        }
+
+        if ( state->latest == 0 ) replicated_state_take_snapshot(state);
+
+        auto acked = state->acked.find(key);
+        const _replication_snapshot *baseline = acked == state->acked.end() ? nullptr : _snapshot_numbered(state, acked->second);
+        unsigned int baseline_number = baseline ? baseline->number : 0;
+
+        auto it = state->encoded.find(baseline_number);
+        if ( it != state->encoded.end() ) return &it->second;
+
+        string &result = state->encoded[baseline_number];
+        _encode_snapshot(state, baseline, result);
+        return &result;
+    }
+
+    bool replicated_state_send(replicated_state state, connection con)
+    {
+        if ( INVALID_PTR(con, CONNECTION_PTR) )
+        {
+            LOG(WARNING) << "Trying to send a replicated state to an invalid connection";
+            return false;
+        }
+
+        const string *msg = _snapshot_message_for(state, _client_key(con));
+        return msg && send_message_to(*msg, con);
+    }
+
+    bool replicated_state_send(replicated_state state, connection con, int channel)
+    {
+        if ( INVALID_PTR(con, CONNECTION_PTR) )
+        {
+            LOG(WARNING) << "Trying to send a replicated state to an invalid connection";
+            return false;
+        }
+
+        const string *msg = _snapshot_message_for(state, _client_key(con));
+        return msg && send_message_to(*msg, con, channel);
+    }
+
+    bool replicated_state_send(replicated_state state, server_socket svr, udp_endpoint ep)
+    {
+        if ( INVALID_PTR(ep, UDP_ENDPOINT_PTR) )
+        {
+            LOG(WARNING) << "Trying to send a replicated state to an invalid udp_endpoint";
+            return false;
+        }
+
+        const string *msg = _snapshot_message_for(state, _client_key(ep));
+        return msg && broadcast_message(*msg, svr, vector<udp_endpoint> { ep });
+    }
+
+    void replicated_state_forget_client(replicated_state state, connection con)
+    {
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) || INVALID_PTR(con, CONNECTION_PTR) ) return;
+
+        state->acked.erase(_client_key(con));
+    }
+
+    void replicated_state_forget_client(replicated_state state, udp_endpoint ep)
+    {
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) || INVALID_PTR(ep, UDP_ENDPOINT_PTR) ) return;
+
+        state->acked.erase(_client_key(ep));
+    }
+
+    //----------------------------------------------------------------------
+    // Receiving
+    //----------------------------------------------------------------------
+
+    // Acknowledgements go back the way the snapshot came
+    static void _send_ack(message msg, unsigned int number)
+    {
+        string ack = "RS";
+        ack.push_back(static_cast<char>(REPLICATION_ACK));
+        _write_uint(ack, number, 4);
+
+        connection con = message_connection(msg);
+        int channel = message_channel(msg);
+
+        if ( con && channel >= 0 )
+            send_message_to(ack, con, channel);
+        else if ( con )
+            send_message_to(ack, con);
+        else if ( udp_endpoint ep = resolve_endpoint(message_host(msg), message_port(msg)) )
+            send_message_to(ack, ep);
+    }
+
+    static void _receive_snapshot(replicated_state state, message msg, const string &data)
+    {
+        unsigned int number = _read_uint(data, 3, 4);
+        unsigned int baseline_number = _read_uint(data, 7, 4);
+        uint32_t field_count = _read_uint(data, 11, 4);
+
+        if ( field_count != state->fields.size() )
+        {
+            LOG(WARNING) << "Received a snapshot with " << field_count << " fields for a replicated state with " << state->fields.size();
+            return;
+        }
+
+        // snapshots that arrive late are already covered by a newer one
+        if ( number <= state->latest )
+        {
+            _send_ack(msg, state->latest);
+            return;
+        }
+
+        const _replication_snapshot *baseline = _snapshot_numbered(state, baseline_number);
+        if ( baseline_number != 0 && ! baseline )
+        {
+            _send_ack(msg, 0);
+            return;
+        }
+
+        vector<uint32_t> steps = baseline ? baseline->steps : vector<uint32_t>(state->fields.size(), 0);
+
+        _bit_reader bits = { data, REPLICATION_HEADER_SIZE, 0, 0 };
+        for (size_t i = 0; i < state->fields.size(); i++)
+        {
+            uint32_t changed = 1;
+            if ( (baseline && ! bits.read(1, changed)) || (changed && ! bits.read(state->fields[i].bits, steps[i])) )
+            {
+                LOG(WARNING) << "Received a replicated state snapshot that ends early";
+                return;
+            }
+        }
+
+        _replication_snapshot &snapshot = state->history[number % REPLICATION_HISTORY];
+        snapshot.number = number;
+        snapshot.steps = std::move(steps);
+        state->latest = number;
+        state->encoded.clear();
+
+        for (size_t i = 0; i < state->fields.size(); i++)
+        {
+            const _replicated_field &field = state->fields[i];
+            state->values[i] = _from_step(field, snapshot.steps[i]);
+
+            if ( ! field.target.empty() && has_sprite(field.target) )
+            {
+                sprite s = sprite_named(field.target);
+                if ( field.target_y )
+                    sprite_set_y(s, static_cast<float>(state->values[i]));
+                else
+                    sprite_set_x(s, static_cast<float>(state->values[i]));
+            }
+        }
+
+        _send_ack(msg, number);
+    }
+
+    static void _receive_ack(replicated_state state, message msg, unsigned int number)
+    {
+        string key = _client_key(msg);
+        if ( key.empty() ) return;
+
+        unsigned int &acked = state->acked[key];
+
+        // acknowledgements may arrive out of order, so only newer ones count
+        if ( number == 0 )
+            acked = 0;
+        else if ( number > acked && number <= state->latest )
+            acked = number;
+    }
+
+    bool replicated_state_receive(replicated_state state, message msg)
+    {
+        if ( INVALID_PTR(state, REPLICATED_STATE_PTR) || INVALID_PTR(msg, MESSAGE_PTR) ) return false;
+
+        string data = message_data(msg);
+        if ( data.size() < 7 || data[0] != 'R' || data[1] != 'S' ) return false;
+
+        switch (data[2])
+        {
+            case REPLICATION_SNAPSHOT:
+                if ( data.size() < REPLICATION_HEADER_SIZE ) return false;
+                _receive_snapshot(state, msg, data);
+                return true;
+
+            case REPLICATION_ACK:
+                _receive_ack(state, msg, _read_uint(data, 3, 4));
+                return true;
+
+            default:
+                return false;
+        }
+    }
+}
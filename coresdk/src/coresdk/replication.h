@@ -0,0 +1,290 @@
+/**
+ * @header  replication
+ * @brief   Replicated state keeps a set of values in step between a server
+ *          and its clients, sending only what has changed.
+ *
+ * The server and each client create a replicated state and add the same
+ * fields to it in the same order. Each tick the server sets the values,
+ * takes a snapshot, and sends it to each client. A client passes each
+ * message it reads to `replicated_state_receive`, which updates its values
+ * and tells the server which snapshot it has. The server then sends each
+ * client only the fields that changed since the last snapshot that client
+ * has, with each value packed into just the bits its range and precision
+ * need. Lost messages are covered by the next one, as changes are always
+ * sent relative to a snapshot the client is known to have.
+ *
+ * @attribute group  networking
+ * @attribute static replication
+ */
+
+#ifndef SPLASHKIT_REPLICATION_H
+#define SPLASHKIT_REPLICATION_H
+
+#include <string>
+
+#include "networking.h"
+#include "sprites.h"
+
+using std::string;
+
+namespace splashkit_lib
+{
+    /**
+     * A replicated state holds fields whose values are copied from a server
+     * to its clients.
+     *
+     * @attribute class replicated_state
+     */
+    typedef struct _replicated_state_data *replicated_state;
+
+    /**
+     * Create a new replicated state, with no fields.
+     *
+     * @return  The new replicated state
+     *
+     * @attribute class replicated_state
+     * @attribute constructor true
+     */
+    replicated_state create_replicated_state();
+
+    /**
+     * Free the replicated state, along with its snapshots and the details of
+     * the clients it has sent to.
+     *
+     * @param state The replicated state to free
+     *
+     * @attribute class replicated_state
+     * @attribute destructor true
+     */
+    void free_replicated_state(replicated_state state);
+
+    /**
+     * Add a number to the replicated state. Values are kept between min and
+     * max, and are sent rounded to the nearest multiple of precision from
+     * min, so a smaller range or a coarser precision sends fewer bits.
+     *
+     * @param state     The replicated state
+     * @param name      The name of the field
+     * @param min       The smallest value the field can hold
+     * @param max       The largest value the field can hold
+     * @param precision The step between the values sent
+     * @return          The id of the new field, or -1 if the field could not
+     *                  be added
+     *
+     * @attribute class replicated_state
+     * @attribute method add_number
+     */
+    int replicated_state_add_number(replicated_state state, const string &name, double min, double max, double precision);
+
+    /**
+     * Add a whole number to the replicated state, which is kept between min
+     * and max.
+     *
+     * @param state The replicated state
+     * @param name  The name of the field
+     * @param min   The smallest value the field can hold
+     * @param max   The largest value the field can hold
+     * @return      The id of the new field, or -1 if the field could not be
+     *              added
+     *
+     * @attribute class replicated_state
+     * @attribute method add_integer
+     */
+    int replicated_state_add_integer(replicated_state state, const string &name, int min, int max);
+
+    /**
+     * Add a true or false value to the replicated state, which is sent in a
+     * single bit.
+     *
+     * @param state The replicated state
+     * @param name  The name of the field
+     * @return      The id of the new field, or -1 if the field could not be
+     *              added
+     *
+     * @attribute class replicated_state
+     * @attribute method add_bool
+     */
+    int replicated_state_add_bool(replicated_state state, const string &name);
+
+    /**
+     * Add the position of a sprite to the replicated state, as the fields
+     * name.x and name.y. The server reads the sprite's position as each
+     * snapshot is taken, and clients move their sprite as snapshots arrive.
+     *
+     * @param state     The replicated state
+     * @param name      The name of the fields, before the .x and .y
+     * @param s         The sprite whose position is replicated
+     * @param area      The area the sprite moves within
+     * @param precision The step between the positions sent
+     * @return          The id of the x field, with the y field the id after
+     *                  it, or -1 if the fields could not be added
+     *
+     * @attribute class replicated_state
+     * @attribute method add_sprite
+     */
+    int replicated_state_add_sprite(replicated_state state, const string &name, sprite s, const rectangle &area, double precision);
+
+    /**
+     * Find the id of a field from its name.
+     *
+     * @param state The replicated state
+     * @param name  The name of the field
+     * @return      The id of the field, or -1 if there is no field with
+     *              that name
+     *
+     * @attribute class replicated_state
+     * @attribute method field
+     */
+    int replicated_state_field(replicated_state state, const string &name);
+
+    /**
+     * The number of fields in the replicated state.
+     *
+     * @param state The replicated state
+     * @return      The number of fields added to it
+     *
+     * @attribute class replicated_state
+     * @attribute getter field_count
+     */
+    int replicated_state_field_count(replicated_state state);
+
+    /**
+     * Set the value of a field. On the server it is sent with the next
+     * snapshot taken.
+     *
+     * @param state The replicated state
+     * @param field The id of the field
+     * @param value The new value, which is kept within the field's range
+     *
+     * @attribute class replicated_state
+     * @attribute method set_value
+     */
+    void replicated_state_set_value(replicated_state state, int field, double value);
+
+    /**
+     * The value of a field. On a client this is the value from the latest
+     * snapshot received, as rounded to the field's precision.
+     *
+     * @param state The replicated state
+     * @param field The id of the field
+     * @return      The value of the field, or 0 if there is no such field
+     *
+     * @attribute class replicated_state
+     * @attribute method value
+     */
+    double replicated_state_value(replicated_state state, int field);
+
+    /**
+     * Take a snapshot of the current values, ready to send to clients. Call
+     * this once each tick, after the values are set and before sending.
+     *
+     * @param state The replicated state
+     * @return      The number of the snapshot, which counts up from 1
+     *
+     * @attribute class replicated_state
+     * @attribute method take_snapshot
+     */
+    unsigned int replicated_state_take_snapshot(replicated_state state);
+
+    /**
+     * The number of the latest snapshot: the last taken on the server, or
+     * the last received on a client.
+     *
+     * @param state The replicated state
+     * @return      The snapshot number, or 0 if there has not been one
+     *
+     * @attribute class replicated_state
+     * @attribute getter snapshot_number
+     */
+    unsigned int replicated_state_snapshot_number(replicated_state state);
+
+    /**
+     * Send the latest snapshot to a client, with only the fields that
+     * changed since the last snapshot the client has. Clients that share
+     * the same last snapshot are sent the same bytes, which are only encoded
+     * once.
+     *
+     * @param state The replicated state
+     * @param con   The connection to the client
+     * @return      True if the snapshot was sent
+     *
+     * @attribute class replicated_state
+     * @attribute method send
+     */
+    bool replicated_state_send(replicated_state state, connection con);
+
+    /**
+     * Send the latest snapshot to a client on a reliable channel of a UDP
+     * connection, see `send_message_to`. Snapshots on a channel must fit in
+     * 1016 bytes.
+     *
+     * @param state   The replicated state
+     * @param con     The connection to the client
+     * @param channel The reliable channel to send on
+     * @return        True if the snapshot was sent
+     *
+     * @attribute class replicated_state
+     * @attribute method send
+     *
+     * @attribute suffix on_channel
+     */
+    bool replicated_state_send(replicated_state state, connection con, int channel);
+
+    /**
+     * Send the latest snapshot to a client of a UDP server.
+     *
+     * @param state The replicated state
+     * @param svr   The UDP server to send from
+     * @param ep    The client's endpoint
+     * @return      True if the snapshot was sent
+     *
+     * @attribute class replicated_state
+     * @attribute method send
+     *
+     * @attribute suffix to_endpoint
+     */
+    bool replicated_state_send(replicated_state state, server_socket svr, udp_endpoint ep);
+
+    /**
+     * Handle a message sent by another replicated state. Clients pass it the
+     * snapshots they read, which update their values and are acknowledged
+     * to the server. Servers pass it the acknowledgements they read.
+     *
+     * @param state The replicated state
+     * @param msg   The message that was read
+     * @return      True if the message was for a replicated state, false
+     *              if it is some other message
+     *
+     * @attribute class replicated_state
+     * @attribute method receive
+     */
+    bool replicated_state_receive(replicated_state state, message msg);
+
+    /**
+     * Forget what a client has received, so it is next sent every field.
+     * Call this when the client disconnects.
+     *
+     * @param state The replicated state
+     * @param con   The connection to the client
+     *
+     * @attribute class replicated_state
+     * @attribute method forget_client
+     */
+    void replicated_state_forget_client(replicated_state state, connection con);
+
+    /**
+     * Forget what a client of a UDP server has received, so it is next sent
+     * every field.
+     *
+     * @param state The replicated state
+     * @param ep    The client's endpoint
+     *
+     * @attribute class replicated_state
+     * @attribute method forget_client
+     *
+     * @attribute suffix endpoint
+     */
+    void replicated_state_forget_client(replicated_state state, udp_endpoint ep);
+}
+
+#endif /* SPLASHKIT_REPLICATION_H */
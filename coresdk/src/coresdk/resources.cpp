@@ -7,11 +7,27 @@
 //
 
 #include "resources.h"
+#include "audio.h"
 #include "utility_functions.h"
+#include "resource_tracking.h"
+#include "concurrency_utils.h"
+#include "file_watch_driver.h"
+#include "graphics_driver.h"
+#include "audio_driver.h"
+#include "utils_driver.h"
 
 #include <stdio.h>
 #include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <unordered_map>
 
 #ifdef __APPLE__
 #include <CoreFoundation/CoreFoundation.h>
@@ -30,19 +46,81 @@
 #include <linux/limits.h>
 #include <libgen.h>
 #endif
+
+// Changed files are reloaded once they have not changed for this long, as
+// editors often save a file in several writes
+#define HOT_RELOAD_SETTLE_MS 150
+
+// Programs that build many different filenames start the path cache over
+// rather than growing it forever
+#define RESOURCE_PATH_CACHE_LIMIT 4096
 namespace splashkit_lib
 {
     // Free notifiers are called when resources are deleted.
     static vector<free_notifier *> _free_notifiers;
 
+    //
+    // Resource tracking, used to keep loaded resources within the memory budget
+    //
+    struct _tracked_resource
+    {
+        resource_kind kind;
+        string name;
+        resource_measure_fn measure;
+        resource_evict_fn evict;
+        resource_reload_fn reload;      // set while the data is evicted
+        long long bytes;                // as last measured
+        std::list<void *>::iterator lru;
+    };
+
+    typedef std::pair<int, string> _resource_key;
+
+    static std::mutex _tracking_lock;
+    static std::unordered_map<void *, _tracked_resource> _tracked_resources;
+    static std::map<_resource_key, int> _resource_refs;
+    static std::set<_resource_key> _pinned_resources;
+
+    // Resources holding data, least recently used first. Evicted resources
+    // are taken out until they are loaded again.
+    static std::list<void *> _resource_lru;
+    static long long _resource_bytes = 0;
+    static std::atomic<int> _evicted_count(0);
+
+    // Resources that are only reported, see _count_resource
+    static std::unordered_map<void *, std::pair<resource_kind, resource_measure_fn>> _counted_resources;
+    static std::atomic<long long> _resource_budget(0);
+
+    //
+    // Hot reload of changed resource files
+    //
+    static std::atomic<bool> _hot_reload(false);
+    static std::map<string, long long> _hot_reload_pending;  // path to time of last change
+    static std::mutex _hot_reload_lock;
+    static vector<std::function<void()>> _hot_reload_ready;  // decoded, waiting to be swapped in
+
+    // in images, sound and animations
+    bool _bitmap_uses_file(const string &file_path);
+    void _replace_bitmap_image(const string &file_path, SDL_Surface *decoded);
+    bool _sound_effect_uses_file(const string &file_path);
+    void _replace_sound_effect_data(const string &file_path, sk_sound_data data);
+    bool _animation_script_uses_file(const string &path);
+    void _reload_animation_scripts_from_file(const string &path);
+
     static bool     _has_resources_path = false;
     static string   _resources_path = "";
 
+    // Resolved resource paths, keyed by kind and filename. Cleared whenever
+    // the resources folder changes.
+    static std::shared_mutex _resource_path_lock;
+    static std::unordered_map<string, string> _resource_paths;
+
     void set_resources_path(const string &path)
     {
         //    cout << "Setting path to: " << path << endl;
+        std::unique_lock<std::shared_mutex> guard(_resource_path_lock);
         _has_resources_path = true;
         _resources_path = path;
+        _resource_paths.clear();
     }
 
     /// Try to set the resource path by exploring sub directories and parent
@@ -147,7 +225,14 @@ namespace splashkit_lib
 
     string path_to_resources()
     {
-        if ( ! _has_resources_path ) _guess_resources_path();
+        {
+            std::shared_lock<std::shared_mutex> guard(_resource_path_lock);
+            if ( _has_resources_path ) return _resources_path;
+        }
+
+        _guess_resources_path();
+
+        std::shared_lock<std::shared_mutex> guard(_resource_path_lock);
         return _resources_path;
     }
 
@@ -166,6 +251,7 @@ namespace splashkit_lib
             case JSON_RESOURCE:         return path_from({ path, "json" });
             case SERVER_RESOURCE:       return path_from({ path, "server" });
             case OTHER_RESOURCE:        return path;
+            case NETWORK_RESOURCE:      return path;
             default:
                 LOG(WARNING) << "Attempting to get path to unknown resource kind.";
                 return path;
@@ -174,7 +260,21 @@ namespace splashkit_lib
     
     string path_to_resource(const string &filename, resource_kind kind)
     {
-        return path_from( { path_to_resources(kind) }, filename );
+        // The kind is stored in the key's first character
+        string key = static_cast<char>('A' + kind) + filename;
+
+        {
+            std::shared_lock<std::shared_mutex> guard(_resource_path_lock);
+            auto it = _resource_paths.find(key);
+            if ( it != _resource_paths.end() ) return it->second;
+        }
+
+        string path = path_from( { path_to_resources(kind) }, filename );
+
+        std::unique_lock<std::shared_mutex> guard(_resource_path_lock);
+        if ( _resource_paths.size() >= RESOURCE_PATH_CACHE_LIMIT ) _resource_paths.clear();
+        _resource_paths.emplace(key, path);
+        return path;
     }
 
     void register_free_notifier(free_notifier *fn)
@@ -196,5 +296,404 @@ namespace splashkit_lib
         {
             fn ( resource );
         }
+
+        std::lock_guard<std::mutex> guard(_tracking_lock);
+        _counted_resources.erase(resource);
+
+        auto it = _tracked_resources.find(resource);
+        if ( it == _tracked_resources.end() ) return;
+
+        _resource_bytes -= it->second.bytes;
+        if ( it->second.reload ) _evicted_count--;
+        else _resource_lru.erase(it->second.lru);
+        _tracked_resources.erase(it);
+    }
+
+    // Measure the resource again, keeping the total up to date. Called with
+    // the tracking lock held.
+    static long long _measure_tracked(_tracked_resource &res)
+    {
+        size_t cpu = 0, gpu = 0;
+        res.measure(cpu, gpu);
+
+        long long bytes = static_cast<long long>(cpu + gpu);
+        _resource_bytes += bytes - res.bytes;
+        res.bytes = bytes;
+        return bytes;
+    }
+
+    // Record that a resource's data was evicted, returning false if it could
+    // not be, in which case it goes to the back of the eviction order to be
+    // tried again later.
+    static bool _store_evicted(void *resource, resource_reload_fn reload)
+    {
+        std::lock_guard<std::mutex> guard(_tracking_lock);
+        auto it = _tracked_resources.find(resource);
+        if ( it == _tracked_resources.end() ) return false;
+
+        _tracked_resource &res = it->second;
+        _resource_lru.erase(res.lru);
+
+        if ( reload )
+        {
+            res.reload = reload;
+            _evicted_count++;
+            _measure_tracked(res);
+            return true;
+        }
+
+        res.lru = _resource_lru.insert(_resource_lru.end(), resource);
+        return false;
+    }
+
+    // Evict least recently used resources until memory use is within the
+    // budget. `keep` is the resource just loaded or used, which the caller
+    // is about to touch. Sizes are measured again as resources are looked
+    // at, so only the front of the eviction order is visited.
+    static void _enforce_resource_budget(void *keep)
+    {
+        long long budget = _resource_budget;
+        if ( budget <= 0 ) return;
+
+        struct candidate
+        {
+            void *resource;
+            resource_evict_fn evict;
+        };
+
+        vector<candidate> candidates;
+
+        {
+            std::lock_guard<std::mutex> guard(_tracking_lock);
+            if ( _resource_bytes <= budget ) return;
+
+            long long expected = _resource_bytes;
+            for (auto it = _resource_lru.begin(); it != _resource_lru.end() && expected > budget; ++it)
+            {
+                if ( *it == keep ) continue;
+
+                _tracked_resource &res = _tracked_resources[*it];
+                if ( ! res.evict ) continue;
+
+                _resource_key key(res.kind, res.name);
+                if ( _pinned_resources.count(key) > 0 || _resource_refs.count(key) > 0 ) continue;
+
+                expected -= _measure_tracked(res);
+                candidates.push_back({ *it, res.evict });
+            }
+        }
+
+        // The lock is not held while the evict functions run, as they call
+        // into the loaders
+        for (candidate &c : candidates)
+        {
+            {
+                std::lock_guard<std::mutex> guard(_tracking_lock);
+                if ( _resource_bytes <= budget ) break;
+
+                // Skip resources freed or used since the candidates were chosen
+                auto it = _tracked_resources.find(c.resource);
+                if ( it == _tracked_resources.end() || it->second.reload ) continue;
+            }
+
+            _store_evicted(c.resource, c.evict());
+        }
+
+        std::lock_guard<std::mutex> guard(_tracking_lock);
+        if ( _resource_bytes > budget )
+            LOG(WARNING) << "Loaded resources use " << _resource_bytes << " bytes, over the budget of " << budget << " bytes, but nothing more can be evicted";
+    }
+
+    void _track_resource(void *resource, resource_kind kind, const string &name, resource_measure_fn measure, resource_evict_fn evict)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_tracking_lock);
+
+            auto it = _tracked_resources.find(resource);
+            if ( it != _tracked_resources.end() )
+            {
+                _resource_bytes -= it->second.bytes;
+                if ( it->second.reload ) _evicted_count--;
+                else _resource_lru.erase(it->second.lru);
+            }
+
+            _tracked_resource &res = _tracked_resources[resource];
+            res = { kind, name, measure, evict, nullptr, 0, _resource_lru.insert(_resource_lru.end(), resource) };
+            _measure_tracked(res);
+        }
+
+        _enforce_resource_budget(resource);
+    }
+
+    void _count_resource(void *resource, resource_kind kind, resource_measure_fn measure)
+    {
+        std::lock_guard<std::mutex> guard(_tracking_lock);
+        _counted_resources[resource] = { kind, measure };
+    }
+
+    void _resource_used(void *resource)
+    {
+        if ( _resource_budget.load(std::memory_order_relaxed) <= 0 && _evicted_count.load(std::memory_order_relaxed) == 0 ) return;
+
+        resource_reload_fn reload;
+
+        {
+            std::lock_guard<std::mutex> guard(_tracking_lock);
+            auto it = _tracked_resources.find(resource);
+            if ( it == _tracked_resources.end() ) return;
+
+            _tracked_resource &res = it->second;
+            if ( res.reload )
+            {
+                reload = res.reload;
+                res.reload = nullptr;
+                _evicted_count--;
+                res.lru = _resource_lru.insert(_resource_lru.end(), resource);
+            }
+            else
+                _resource_lru.splice(_resource_lru.end(), _resource_lru, res.lru);
+        }
+
+        if ( ! reload ) return;
+
+        // Load the data back into the resource, then make room for it
+        reload();
+
+        {
+            std::lock_guard<std::mutex> guard(_tracking_lock);
+            auto it = _tracked_resources.find(resource);
+            if ( it != _tracked_resources.end() ) _measure_tracked(it->second);
+        }
+
+        _enforce_resource_budget(resource);
+    }
+
+    bool _evict_resource(void *resource)
+    {
+        resource_evict_fn evict;
+
+        {
+            std::lock_guard<std::mutex> guard(_tracking_lock);
+            auto it = _tracked_resources.find(resource);
+            if ( it == _tracked_resources.end() ) return false;
+
+            _tracked_resource &res = it->second;
+            if ( res.reload ) return true;
+            if ( ! res.evict ) return false;
+
+            _resource_key key(res.kind, res.name);
+            if ( _pinned_resources.count(key) > 0 || _resource_refs.count(key) > 0 ) return false;
+
+            evict = res.evict;
+        }
+
+        return _store_evicted(resource, evict());
+    }
+
+    bool _resource_evicted(void *resource)
+    {
+        std::lock_guard<std::mutex> guard(_tracking_lock);
+        auto it = _tracked_resources.find(resource);
+        return it != _tracked_resources.end() && it->second.reload;
+    }
+
+    void set_resource_memory_budget(long long bytes)
+    {
+        if ( bytes < 0 )
+        {
+            LOG(WARNING) << "Resource memory budget cannot be negative, removing the budget";
+            bytes = 0;
+        }
+
+        _resource_budget = bytes;
+        _enforce_resource_budget(nullptr);
+    }
+
+    long long resource_memory_budget()
+    {
+        return _resource_budget;
+    }
+
+    long long resource_memory_used()
+    {
+        std::lock_guard<std::mutex> guard(_tracking_lock);
+
+        // Measure everything again, to pick up growth since each was last seen
+        for (auto &it : _tracked_resources) _measure_tracked(it.second);
+
+        return _resource_bytes;
+    }
+
+    vector<resource_memory_usage> resource_memory_report()
+    {
+        std::map<resource_kind, resource_memory_usage> kinds;
+
+        auto add = [&kinds](resource_kind kind, const resource_measure_fn &measure)
+        {
+            size_t cpu = 0, gpu = 0;
+            if ( measure ) measure(cpu, gpu);
+
+            auto it = kinds.emplace(kind, resource_memory_usage{ kind, 0, 0, 0 }).first;
+            it->second.count++;
+            it->second.cpu_bytes += static_cast<long long>(cpu);
+            it->second.gpu_bytes += static_cast<long long>(gpu);
+        };
+
+        {
+            std::lock_guard<std::mutex> guard(_tracking_lock);
+
+            for (auto &it : _tracked_resources) add(it.second.kind, it.second.measure);
+            for (auto &it : _counted_resources) add(it.second.first, it.second.second);
+        }
+
+        vector<resource_memory_usage> result;
+        for (auto &it : kinds) result.push_back(it.second);
+        return result;
+    }
+
+    void retain_resource(resource_kind kind, const string &name)
+    {
+        std::lock_guard<std::mutex> guard(_tracking_lock);
+        _resource_refs[_resource_key(kind, name)]++;
+    }
+
+    void release_resource(resource_kind kind, const string &name)
+    {
+        std::lock_guard<std::mutex> guard(_tracking_lock);
+
+        auto it = _resource_refs.find(_resource_key(kind, name));
+        if ( it == _resource_refs.end() )
+        {
+            LOG(WARNING) << "Releasing resource " << name << " that was not retained";
+            return;
+        }
+
+        if ( --it->second == 0 ) _resource_refs.erase(it);
+    }
+
+    void pin_resource(resource_kind kind, const string &name)
+    {
+        std::lock_guard<std::mutex> guard(_tracking_lock);
+        _pinned_resources.insert(_resource_key(kind, name));
+    }
+
+    void unpin_resource(resource_kind kind, const string &name)
+    {
+        std::lock_guard<std::mutex> guard(_tracking_lock);
+        _pinned_resources.erase(_resource_key(kind, name));
+    }
+
+    static worker_pool &_hot_reload_worker()
+    {
+        static worker_pool pool(1);
+        return pool;
+    }
+
+    // Queue work to run on the main thread during process_events
+    static void _hot_reload_done(std::function<void()> apply)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_hot_reload_lock);
+            _hot_reload_ready.push_back(apply);
+        }
+
+        sk_signal_activity();
+    }
+
+    static void _start_hot_reload(const string &path)
+    {
+        if ( _bitmap_uses_file(path) )
+        {
+            _hot_reload_worker().add([path]()
+            {
+                SDL_Surface *decoded = sk_decode_bitmap(path.c_str());
+                if ( ! decoded )
+                {
+                    LOG(WARNING) << "Unable to reload image " << path;
+                    return;
+                }
+
+                _hot_reload_done([path, decoded]() { _replace_bitmap_image(path, decoded); });
+            });
+        }
+
+        if ( audio_ready() && _sound_effect_uses_file(path) )
+        {
+            _hot_reload_worker().add([path]()
+            {
+                sk_decoded_sound *decoded = sk_decode_sound(path);
+
+                // The effect is made on the main thread, as SDL_mixer is only used there
+                _hot_reload_done([path, decoded]()
+                {
+                    sk_sound_data data = sk_sound_from_decoded(decoded);
+                    if ( ! data._data )
+                    {
+                        LOG(WARNING) << "Unable to reload sound effect " << path;
+                        return;
+                    }
+
+                    _replace_sound_effect_data(path, data);
+                });
+            });
+        }
+
+        // Scripts are small, and may load sounds, so they are read here
+        if ( _animation_script_uses_file(path) )
+            _reload_animation_scripts_from_file(path);
+    }
+
+    void enable_resource_hot_reload()
+    {
+        if ( _hot_reload ) return;
+
+        _hot_reload = true;
+        sk_start_file_watch({ path_to_resources() });
+    }
+
+    void disable_resource_hot_reload()
+    {
+        if ( ! _hot_reload ) return;
+
+        _hot_reload = false;
+        sk_stop_file_watch();
+        _hot_reload_pending.clear();
+    }
+
+    bool resource_hot_reload_enabled()
+    {
+        return _hot_reload;
+    }
+
+    // Called from process_events
+    void _update_resource_hot_reload()
+    {
+        vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> guard(_hot_reload_lock);
+            ready.swap(_hot_reload_ready);
+        }
+
+        for (auto &apply : ready) apply();
+
+        if ( ! _hot_reload ) return;
+
+        long long now = sk_get_ticks_ns();
+
+        for (const string &path : sk_take_changed_files())
+            _hot_reload_pending[path] = now;
+
+        for (auto it = _hot_reload_pending.begin(); it != _hot_reload_pending.end(); )
+        {
+            if ( now - it->second < HOT_RELOAD_SETTLE_MS * 1000000LL )
+            {
+                ++it;
+                continue;
+            }
+
+            string path = it->first;
+            it = _hot_reload_pending.erase(it);
+            _start_hot_reload(path);
+        }
     }
 }
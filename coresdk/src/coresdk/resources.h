@@ -12,7 +12,9 @@
 #define resources_hpp
 
 #include <string>
+#include <vector>
 using std::string;
+using std::vector;
 
 namespace splashkit_lib
 {
@@ -46,6 +48,9 @@ namespace splashkit_lib
      * @constant OTHER_RESOURCE     Other resources can be loaded, these will be
      *                              located directly in these project's
      *                              `Resources` folder.
+     * @constant NETWORK_RESOURCE   Network connections are not loaded from
+     *                              file, but their buffers are included in
+     *                              the resource memory report.
      */
     enum resource_kind
     {
@@ -58,7 +63,8 @@ namespace splashkit_lib
         SERVER_RESOURCE,
         SOUND_RESOURCE,
         TIMER_RESOURCE,
-        OTHER_RESOURCE
+        OTHER_RESOURCE,
+        NETWORK_RESOURCE
     };
 
     /**
@@ -121,5 +127,121 @@ namespace splashkit_lib
      */
     void deregister_free_notifier(free_notifier *handler);
 
+    /**
+     * Limit the memory used by loaded bitmaps, fonts and sound effects. When
+     * loading a resource takes the total over the budget, SplashKit frees
+     * the image, sound or glyph data of the least recently used resources
+     * that are not retained or pinned. The resources themselves are kept,
+     * so existing bitmaps, fonts and sound effects, and the sprites using
+     * them, stay valid, and their data is loaded again from the file when
+     * they are next drawn or played. Retain resources that must never wait
+     * on a file. Bitmaps that have been drawn on, and resources that did not
+     * come from a file, are never evicted.
+     *
+     * @param bytes The budget in bytes, or 0 to keep every resource loaded
+     */
+    void set_resource_memory_budget(long long bytes);
+
+    /**
+     * The memory budget for loaded resources.
+     *
+     * @returns The budget in bytes, or 0 if there is no budget
+     */
+    long long resource_memory_budget();
+
+    /**
+     * The memory currently used by loaded bitmaps, fonts and sound effects,
+     * in both system and video memory. Music is streamed from its file and
+     * is not counted.
+     *
+     * @returns The estimated number of bytes in use
+     */
+    long long resource_memory_used();
+
+    /**
+     * The memory used by one kind of resource.
+     *
+     * @field kind      The kind of resource
+     * @field count     The number of resources of this kind that are loaded
+     * @field cpu_bytes The estimated bytes used in system memory
+     * @field gpu_bytes The estimated bytes used in video memory
+     */
+    struct resource_memory_usage
+    {
+        resource_kind kind;
+        int count;
+        long long cpu_bytes;
+        long long gpu_bytes;
+    };
+
+    /**
+     * Report the memory used by each kind of resource. As well as the
+     * bitmaps, fonts and sound effects counted in `resource_memory_used`,
+     * this includes json objects and the buffers of network connections.
+     * Bitmap memory includes their collision masks and a texture for each
+     * window they have been drawn to. Kinds with nothing loaded are left out.
+     *
+     * @returns The memory used by each kind of resource
+     */
+    vector<resource_memory_usage> resource_memory_report();
+
+    /**
+     * Record that your code is using a resource, so it will not be evicted
+     * to meet the memory budget. Each call must be matched by a call to
+     * `release_resource`.
+     *
+     * @param kind  The kind of resource
+     * @param name  The name of the resource
+     */
+    void retain_resource(resource_kind kind, const string &name);
+
+    /**
+     * Record that your code has finished with a resource it retained. Once
+     * it is no longer retained the resource can be evicted.
+     *
+     * @param kind  The kind of resource
+     * @param name  The name of the resource
+     */
+    void release_resource(resource_kind kind, const string &name);
+
+    /**
+     * Keep a resource loaded regardless of the memory budget, until it is
+     * unpinned.
+     *
+     * @param kind  The kind of resource
+     * @param name  The name of the resource
+     */
+    void pin_resource(resource_kind kind, const string &name);
+
+    /**
+     * Allow a pinned resource to be evicted again.
+     *
+     * @param kind  The kind of resource
+     * @param name  The name of the resource
+     */
+    void unpin_resource(resource_kind kind, const string &name);
+
+    /**
+     * Watch the files in the resources folder, and reload bitmaps, sound
+     * effects and animation scripts when their files change. Images and
+     * sounds are decoded in the background, then swapped into the existing
+     * resources during `process_events`, so sprites and other code holding
+     * the resources show the changes without reloading anything themselves.
+     * Use this while working on your program's content.
+     */
+    void enable_resource_hot_reload();
+
+    /**
+     * Stop watching the resources folder for changes.
+     */
+    void disable_resource_hot_reload();
+
+    /**
+     * Check if resources are reloaded when their files change.
+     *
+     * @returns True if hot reload is enabled
+     */
+    bool resource_hot_reload_enabled();
+
 }
 #endif /* resources_hpp */
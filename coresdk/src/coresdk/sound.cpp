@@ -10,15 +10,22 @@
 #include "resources.h"
 #include "backend_types.h"
 #include "utility_functions.h"
+#include "resource_registry.h"
+#include "resource_tracking.h"
+#include "camera.h"
+#include "geometry.h"
+#include "sprites.h"
 
+#include <cmath>
 #include <iostream>
 #include <map>
+#include <vector>
 
 using std::map;
 
 namespace splashkit_lib
 {
-    static map<string, sound_effect> _sound_effects;
+    static resource_registry<sound_effect> _sound_effects;
 
     struct _sound_data
     {
@@ -28,15 +35,78 @@ namespace splashkit_lib
     };
 #include "sound.h"
 
+    sound_effect _register_loaded_sound_effect(const string &name, const string &file_path, sk_sound_data data, bool reloadable);
+
+    // Sound data loaded ahead of time for evicted effects, by asset
+    // streaming, used in place of loading when the effects are loaded again
+    static std::map<sound_effect, sk_sound_data> _prepared_sounds;
+
+    static sk_sound_data _take_prepared_sound(sound_effect effect)
+    {
+        sk_sound_data result = { SGSD_UNKNOWN, nullptr };
+
+        auto it = _prepared_sounds.find(effect);
+        if ( it == _prepared_sounds.end() ) return result;
+
+        result = it->second;
+        _prepared_sounds.erase(it);
+        return result;
+    }
+
+    // Report a sound effect to the resource budget. Effects that are not
+    // playing can have their sound data evicted, and loaded again with the
+    // same volume when next played.
+    static void _track_sound_effect(sound_effect effect, bool reloadable)
+    {
+        resource_evict_fn evict;
+
+        if ( reloadable )
+        {
+            evict = [effect]() -> resource_reload_fn
+            {
+                if ( sk_sound_playing(&effect->effect) > 0 ) return nullptr;
+
+                double volume = sk_sound_volume(&effect->effect);
+                sk_close_sound_data(&effect->effect);
+
+                return [effect, volume]()
+                {
+                    // A hot reload may have already put the data back
+                    if ( effect->effect._data ) sk_close_sound_data(&effect->effect);
+                    effect->effect = _take_prepared_sound(effect);
+                    if ( ! effect->effect._data ) effect->effect = sk_load_sound_data(effect->filename, SGSD_SOUND_EFFECT);
+                    if ( ! effect->effect._data )
+                    {
+                        LOG(WARNING) << "Unable to load evicted sound effect " << effect->name << " again from " << effect->filename;
+                        return;
+                    }
+
+                    sk_set_sound_volume(&effect->effect, volume);
+                };
+            };
+        }
+
+        _track_resource(effect, SOUND_RESOURCE, effect->name, [effect](size_t &cpu, size_t &gpu)
+        {
+            cpu = sk_sound_data_memory(&effect->effect);
+            gpu = 0;
+        }, evict);
+    }
+
     bool has_sound_effect(const string &name)
     {
-        return _sound_effects.count(name) > 0;
+        return _sound_effects.contains(name);
     }
 
     sound_effect sound_effect_named(const string &name)
     {
-        if (has_sound_effect(name))
-            return _sound_effects[name];
+        sound_effect result = _sound_effects.find(name);
+
+        if (result)
+        {
+            _resource_used(result);
+            return result;
+        }
         else
         {
             string filename = path_to_resource(name, SOUND_RESOURCE);
@@ -81,24 +151,53 @@ namespace splashkit_lib
             }
         }
 
+        sk_sound_data data = sk_load_sound_data(file_path, SGSD_SOUND_EFFECT);
+
+        // Unable to load sound effect
+        if ( ! data._data )
+        {
+            LOG(WARNING) <<  cat({ "Error loading sound data for ", name, " (", file_path, ")"}) ;
+            return nullptr;
+        }
+
+        return _register_loaded_sound_effect(name, file_path, data, true);
+    }
+
+    // Wrap loaded sound data and register it. Used by load_sound_effect and
+    // by bundles, which decode sounds on worker threads.
+    sound_effect _register_loaded_sound_effect(const string &name, const string &file_path, sk_sound_data data, bool reloadable)
+    {
         sound_effect result = new _sound_data();
 
         result->id = AUDIO_PTR;
         result->filename = file_path;
         result->name = name;
-        result->effect = sk_load_sound_data(file_path, SGSD_SOUND_EFFECT);
+        result->effect = data;
 
-        // Unable to load sound effect
-        if ( ! result->effect._data )
+        // Another thread may have loaded the same name in the meantime
+        sound_effect registered = _sound_effects.insert(name, result);
+        if ( registered != result )
         {
+            sk_close_sound_data(&result->effect);
             result->id = NONE_PTR;
             delete result;
-            LOG(WARNING) <<  cat({ "Error loading sound data for ", name, " (", file_path, ")"}) ;
-            return nullptr;
         }
+        else
+            _track_sound_effect(result, reloadable);
 
-        _sound_effects[name] = result;
-        return result;
+        return registered;
+    }
+
+    // Load an evicted sound effect again from data loaded on another thread,
+    // keeping the effect's handle. Takes ownership of the data.
+    void _restore_evicted_sound_effect(sound_effect effect, sk_sound_data data)
+    {
+        _prepared_sounds[effect] = data;
+        _resource_used(effect);
+
+        // Left over if the effect was not evicted after all
+        sk_sound_data unused = _take_prepared_sound(effect);
+        sk_close_sound_data(&unused);
     }
 
     void free_sound_effect(sound_effect effect)
@@ -120,7 +219,43 @@ namespace splashkit_lib
 
     void free_all_sound_effects()
     {
-        FREE_ALL_FROM_MAP(_sound_effects, AUDIO_PTR, free_sound_effect);
+        FREE_ALL_FROM_REGISTRY(_sound_effects, AUDIO_PTR, free_sound_effect);
+    }
+
+    bool _sound_effect_uses_file(const string &file_path)
+    {
+        for (auto &entry : _sound_effects.entries())
+        {
+            if ( VALID_PTR(entry.second, AUDIO_PTR) && same_file(entry.second->filename, file_path) )
+                return true;
+        }
+        return false;
+    }
+
+    // Swap newly loaded sound data into every effect loaded from file_path,
+    // keeping each effect's volume. Takes ownership of the data.
+    void _replace_sound_effect_data(const string &file_path, sk_sound_data data)
+    {
+        bool used = false;
+
+        for (auto &entry : _sound_effects.entries())
+        {
+            sound_effect effect = entry.second;
+            if ( INVALID_PTR(effect, AUDIO_PTR) || ! same_file(effect->filename, file_path) ) continue;
+
+            sk_sound_data replacement = used ? sk_load_sound_data(file_path, SGSD_SOUND_EFFECT) : data;
+            used = true;
+            if ( ! replacement._data ) continue;
+
+            double volume = sk_sound_volume(&effect->effect);
+
+            sk_stop_sound(&effect->effect);
+            sk_close_sound_data(&effect->effect);
+            effect->effect = replacement;
+            sk_set_sound_volume(&effect->effect, volume);
+        }
+
+        if ( ! used ) sk_close_sound_data(&data);
     }
 
     bool sound_effect_valid(sound_effect effect)
@@ -129,6 +264,11 @@ namespace splashkit_lib
     }
 
     void play_sound_effect(sound_effect effect, int times, double volume)
+    {
+        play_sound_effect(effect, times, volume, 0);
+    }
+
+    void play_sound_effect(sound_effect effect, int times, double volume, int priority)
     {
         if (not audio_ready()) return;
 
@@ -138,6 +278,8 @@ namespace splashkit_lib
             return;
         }
 
+        _resource_used(effect);
+
         // convert to SDL-compatible loops count
         // (-1 = inf, 0 = once, 1 = twice)
         int loops;
@@ -150,7 +292,7 @@ namespace splashkit_lib
         else if (volume > 1) volume = 1;
 
         // play the effect, seaching for a channel
-        sk_play_sound(&effect->effect, loops, volume);
+        sk_play_sound(&effect->effect, loops, volume, priority);
     }
 
     void play_sound_effect(sound_effect effect)
@@ -221,4 +363,270 @@ namespace splashkit_lib
     {
         sk_fade_all_sound_effects_out(ms);
     }
+
+    //----------------------------------------------------------------------------
+    // Sound emitters
+    //----------------------------------------------------------------------------
+
+    struct _sound_emitter_data
+    {
+        pointer_identifier id;
+        sound_effect effect;
+        sprite attached;        // When set, the emitter follows the sprite's centre
+        point_2d position;
+        double range, volume;
+        int times;              // The times to play, -1 repeats until stopped
+        bool active;            // Started, and not yet finished or stopped
+        int channel;            // The channel playing the sound, or -1
+    };
+
+    static std::vector<sound_emitter> _sound_emitters;
+    static point_2d _sound_listener = { 0, 0 };
+    static bool _sound_listener_set = false;
+
+    // Emitters attached to a sprite stay where the sprite was when it is freed
+    static void _detach_sound_emitters(void *resource)
+    {
+        for (sound_emitter emitter : _sound_emitters)
+        {
+            if ( emitter->attached == resource ) emitter->attached = nullptr;
+        }
+    }
+
+    static point_2d _current_sound_listener()
+    {
+        return _sound_listener_set ? _sound_listener : screen_center();
+    }
+
+    // Play, pan and attenuate the emitter for the listener, or release its
+    // channel when it cannot be heard
+    static void _update_sound_emitter(sound_emitter emitter, const point_2d &listener)
+    {
+        if ( ! emitter->active ) return;
+
+        if ( INVALID_PTR(emitter->effect, AUDIO_PTR) )
+        {
+            emitter->active = false;
+            emitter->channel = -1;
+            return;
+        }
+
+        if ( emitter->attached )
+        {
+            emitter->position = center_point(emitter->attached);
+        }
+
+        // A sound that has finished, or was stopped with its effect, is done
+        if ( emitter->channel >= 0 && ! sk_channel_playing(emitter->channel, &emitter->effect->effect) )
+        {
+            emitter->channel = -1;
+            emitter->active = false;
+            return;
+        }
+
+        double dx = emitter->position.x - listener.x;
+        double dy = emitter->position.y - listener.y;
+        double dist = sqrt(dx * dx + dy * dy);
+
+        if ( dist >= emitter->range )
+        {
+            if ( emitter->channel >= 0 )
+            {
+                sk_halt_channel(emitter->channel);
+                emitter->channel = -1;
+            }
+
+            // Only repeating sounds wait to come back into range
+            if ( emitter->times != -1 ) emitter->active = false;
+            return;
+        }
+
+        if ( emitter->channel < 0 )
+        {
+            int loops = emitter->times == -1 ? -1 : emitter->times - 1;
+            _resource_used(emitter->effect);
+            emitter->channel = sk_play_sound(&emitter->effect->effect, loops, static_cast<float>(emitter->volume), 0);
+
+            // No channel was free, try again next update
+            if ( emitter->channel < 0 ) return;
+        }
+
+        // The listener faces up the screen, angles go clockwise from there
+        int angle = static_cast<int>(atan2(dx, -dy) * 180.0 / M_PI);
+        if ( angle < 0 ) angle += 360;
+
+        sk_set_channel_position(emitter->channel, angle, static_cast<int>(255.0 * dist / emitter->range));
+    }
+
+    static sound_emitter _create_sound_emitter(sound_effect effect, sprite s, const point_2d &position, double range)
+    {
+        if ( INVALID_PTR(effect, AUDIO_PTR) )
+        {
+            LOG(WARNING) << "Attempting to create a sound emitter with an invalid sound effect";
+            return nullptr;
+        }
+
+        static bool detaching = false;
+        if ( s && ! detaching )
+        {
+            register_free_notifier(&_detach_sound_emitters);
+            detaching = true;
+        }
+
+        sound_emitter result = new _sound_emitter_data();
+        result->id = SOUND_EMITTER_PTR;
+        result->effect = effect;
+        result->attached = s;
+        result->position = s ? center_point(s) : position;
+        result->range = range > 0 ? range : 1;
+        result->volume = 1.0;
+        result->times = 1;
+        result->active = false;
+        result->channel = -1;
+
+        _sound_emitters.push_back(result);
+        return result;
+    }
+
+    sound_emitter create_sound_emitter(sound_effect effect, const point_2d &position, double range)
+    {
+        return _create_sound_emitter(effect, nullptr, position, range);
+    }
+
+    sound_emitter create_sound_emitter(sound_effect effect, sprite s, double range)
+    {
+        // sprite_name checks the sprite, as its data is private to sprites
+        if ( sprite_name(s).empty() )
+        {
+            LOG(WARNING) << "Attempting to create a sound emitter for an invalid sprite";
+            return nullptr;
+        }
+
+        return _create_sound_emitter(effect, s, point_at(0, 0), range);
+    }
+
+    void free_sound_emitter(sound_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, SOUND_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to free an invalid sound emitter";
+            return;
+        }
+
+        stop_sound_emitter(emitter);
+        erase_from_vector(_sound_emitters, emitter);
+
+        emitter->id = NONE_PTR;
+        delete emitter;
+    }
+
+    void start_sound_emitter(sound_emitter emitter, int times)
+    {
+        if ( INVALID_PTR(emitter, SOUND_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to start an invalid sound emitter";
+            return;
+        }
+
+        if ( ! audio_ready() || times == 0 || times < -1 ) return;
+
+        stop_sound_emitter(emitter);
+
+        emitter->times = times;
+        emitter->active = true;
+        _update_sound_emitter(emitter, _current_sound_listener());
+    }
+
+    void stop_sound_emitter(sound_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, SOUND_EMITTER_PTR) ) return;
+
+        if ( emitter->channel >= 0 && VALID_PTR(emitter->effect, AUDIO_PTR) && sk_channel_playing(emitter->channel, &emitter->effect->effect) )
+        {
+            sk_halt_channel(emitter->channel);
+        }
+
+        emitter->channel = -1;
+        emitter->active = false;
+    }
+
+    bool sound_emitter_playing(sound_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, SOUND_EMITTER_PTR) || ! emitter->active || emitter->channel < 0 ) return false;
+        if ( INVALID_PTR(emitter->effect, AUDIO_PTR) ) return false;
+
+        return sk_channel_playing(emitter->channel, &emitter->effect->effect);
+    }
+
+    void set_sound_emitter_position(sound_emitter emitter, const point_2d &position)
+    {
+        if ( INVALID_PTR(emitter, SOUND_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to move an invalid sound emitter";
+            return;
+        }
+
+        emitter->position = position;
+    }
+
+    point_2d sound_emitter_position(sound_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, SOUND_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get the position of an invalid sound emitter";
+            return point_at(0, 0);
+        }
+
+        return emitter->position;
+    }
+
+    void set_sound_emitter_volume(sound_emitter emitter, double volume)
+    {
+        if ( INVALID_PTR(emitter, SOUND_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set the volume of an invalid sound emitter";
+            return;
+        }
+
+        if (volume < 0) volume = 0;
+        else if (volume > 1) volume = 1;
+
+        emitter->volume = volume;
+
+        if ( emitter->channel >= 0 ) sk_set_channel_volume(emitter->channel, static_cast<float>(volume));
+    }
+
+    double sound_emitter_volume(sound_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, SOUND_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get the volume of an invalid sound emitter";
+            return 0;
+        }
+
+        return emitter->volume;
+    }
+
+    void set_sound_listener_position(const point_2d &position)
+    {
+        _sound_listener = position;
+        _sound_listener_set = true;
+    }
+
+    point_2d sound_listener_position()
+    {
+        return _current_sound_listener();
+    }
+
+    void update_sound_emitters()
+    {
+        if ( _sound_emitters.empty() ) return;
+
+        point_2d listener = _current_sound_listener();
+
+        for (sound_emitter emitter : _sound_emitters)
+        {
+            _update_sound_emitter(emitter, listener);
+        }
+    }
 }
@@ -8,6 +8,9 @@
 #ifndef sound_h
 #define sound_h
 
+#include "types.h"
+#include "sprites.h"
+
 #include <string>
 using std::string;
 
@@ -179,6 +182,28 @@ namespace splashkit_lib
      */
     void play_sound_effect(sound_effect effect, int times, double volume);
 
+    /**
+     * This version of `play_sound_effect` also gives the `sound_effect` a
+     * priority. When every channel is already playing, the new effect
+     * replaces the effect with the lowest priority, as long as that is lower
+     * than the new effect's priority. Effects played without a priority have
+     * a priority of `0`.
+     *
+     * @param effect   The effect indicates which sound effect to start playing.
+     * @param times    Controls the number of times the sound effect is played.
+     * @param volume   Indicates the percentage of the original volume to play the
+     *                 `sound_effect` at. This must be between `0` and `1`.
+     * @param priority How important the effect is. Higher priority effects
+     *                 replace lower priority ones when there are no free
+     *                 channels.
+     *
+     * @attribute class   sound_effect
+     * @attribute method  play
+     * @attribute suffix  with_times_volume_and_priority
+     * @attribute self    effect
+     */
+    void play_sound_effect(sound_effect effect, int times, double volume, int priority);
+
     /**
      * Plays a sound effect once at full volume.
      *
@@ -298,6 +323,164 @@ namespace splashkit_lib
      * @param ms The number of milliseconds to fade out all sound effects.
      */
     void fade_all_sound_effects_out(int ms);
+
+    /**
+     * A sound emitter plays a `sound_effect` from a place in your game. The
+     * sound gets quieter as the emitter moves away from the listener, and
+     * pans to the side the emitter is on. Emitters that are too far away to
+     * be heard do not use one of the channels sound effects play on.
+     *
+     * Call `update_sound_emitters` each frame to move the sounds to match
+     * the emitters and the listener.
+     *
+     * @attribute class sound_emitter
+     */
+    typedef struct _sound_emitter_data *sound_emitter;
+
+    /**
+     * Create a sound emitter that plays a sound effect from a point in your
+     * game world.
+     *
+     * @param effect    The sound effect the emitter plays
+     * @param position  Where the emitter is, in world coordinates
+     * @param range     How far away the emitter can be heard from
+     * @returns         The new sound emitter
+     *
+     * @attribute class         sound_emitter
+     * @attribute constructor   true
+     */
+    sound_emitter create_sound_emitter(sound_effect effect, const point_2d &position, double range);
+
+    /**
+     * Create a sound emitter that plays a sound effect from a sprite. The
+     * emitter follows the centre of the sprite as it moves, and stays where
+     * the sprite was if the sprite is freed.
+     *
+     * @param effect    The sound effect the emitter plays
+     * @param s         The sprite the sound comes from
+     * @param range     How far away the emitter can be heard from
+     * @returns         The new sound emitter
+     *
+     * @attribute class         sound_emitter
+     * @attribute constructor   true
+     * @attribute suffix        for_sprite
+     */
+    sound_emitter create_sound_emitter(sound_effect effect, sprite s, double range);
+
+    /**
+     * Stop the emitter's sound and free the emitter.
+     *
+     * @param emitter   The sound emitter to free
+     *
+     * @attribute class         sound_emitter
+     * @attribute destructor    true
+     */
+    void free_sound_emitter(sound_emitter emitter);
+
+    /**
+     * Start the emitter playing its sound effect. The sound only takes a
+     * channel while the listener is in range. A sound that plays a set
+     * number of times is skipped if it starts out of range.
+     *
+     * @param emitter   The sound emitter
+     * @param times     The number of times to play the sound effect, or `-1`
+     *                  to repeat it until it is stopped
+     *
+     * @attribute class   sound_emitter
+     * @attribute method  start
+     */
+    void start_sound_emitter(sound_emitter emitter, int times);
+
+    /**
+     * Stop the emitter playing its sound effect.
+     *
+     * @param emitter   The sound emitter
+     *
+     * @attribute class   sound_emitter
+     * @attribute method  stop
+     */
+    void stop_sound_emitter(sound_emitter emitter);
+
+    /**
+     * Check if the emitter's sound effect is playing.
+     *
+     * @param emitter   The sound emitter
+     * @returns         True if the emitter is playing, and in range of the
+     *                  listener
+     *
+     * @attribute class   sound_emitter
+     * @attribute getter  is_playing
+     */
+    bool sound_emitter_playing(sound_emitter emitter);
+
+    /**
+     * Move a sound emitter. Emitters created for a sprite move with it, so
+     * this is only needed for emitters at a point.
+     *
+     * @param emitter   The sound emitter
+     * @param position  The new position, in world coordinates
+     *
+     * @attribute class   sound_emitter
+     * @attribute setter  position
+     */
+    void set_sound_emitter_position(sound_emitter emitter, const point_2d &position);
+
+    /**
+     * The position of a sound emitter.
+     *
+     * @param emitter   The sound emitter
+     * @returns         The position, in world coordinates
+     *
+     * @attribute class   sound_emitter
+     * @attribute getter  position
+     */
+    point_2d sound_emitter_position(sound_emitter emitter);
+
+    /**
+     * Change the volume of a sound emitter, before the distance to the
+     * listener is taken into account.
+     *
+     * @param emitter   The sound emitter
+     * @param volume    The volume, between `0` and `1`
+     *
+     * @attribute class   sound_emitter
+     * @attribute setter  volume
+     */
+    void set_sound_emitter_volume(sound_emitter emitter, double volume);
+
+    /**
+     * The volume of a sound emitter.
+     *
+     * @param emitter   The sound emitter
+     * @returns         The volume, between `0` and `1`
+     *
+     * @attribute class   sound_emitter
+     * @attribute getter  volume
+     */
+    double sound_emitter_volume(sound_emitter emitter);
+
+    /**
+     * Set where the sound emitters are heard from. Until this is called, the
+     * listener is at the centre of the screen, following the camera.
+     *
+     * @param position  The position of the listener, in world coordinates
+     */
+    void set_sound_listener_position(const point_2d &position);
+
+    /**
+     * Where the sound emitters are heard from.
+     *
+     * @returns The position of the listener, in world coordinates
+     */
+    point_2d sound_listener_position();
+
+    /**
+     * Update the volume and panning of all of the sound emitters, in one
+     * pass. Emitters that have moved out of range release their channel, and
+     * repeating emitters that come back into range start again. Call this
+     * once each frame.
+     */
+    void update_sound_emitters();
 }
 
 #endif /* sound_h */
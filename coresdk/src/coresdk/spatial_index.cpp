@@ -0,0 +1,952 @@
+//
+//  spatial_index.cpp
+//  splashkit
+//
+//  Shapes are kept in a bounding volume hierarchy, bulk built with
+//  sort-tile-recursive (STR) packing. Shapes added after a build are kept
+//  in a pending list until enough of them build up to make a rebuild worth
+//  while.
+//
+
+#include "spatial_index.h"
+
+#include "circle_geometry.h"
+#include "line_geometry.h"
+#include "point_geometry.h"
+#include "rectangle_geometry.h"
+#include "triangle_geometry.h"
+#include "vector_2d.h"
+
+#include "backend_types.h"
+#include "concurrency_utils.h"
+#include "utility_functions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <thread>
+
+// The number of entries in each node of the tree
+#define SPATIAL_NODE_SIZE 8
+// Shapes added since the last build are checked one at a time, until there
+// are more than this many, and more than 1/8 of the shapes in the tree
+#define SPATIAL_PENDING_LIMIT 32
+// Batches of rays smaller than this are cast on the calling thread
+#define RAYCAST_PARALLEL_MIN_COUNT 256
+// The number of rays each thread takes at a time
+#define RAYCAST_CHUNK 64
+
+namespace splashkit_lib
+{
+    enum _spatial_shape_kind
+    {
+        SPATIAL_RECTANGLE,
+        SPATIAL_CIRCLE,
+        SPATIAL_TRIANGLE,
+        SPATIAL_LINE
+    };
+
+    struct _spatial_shape
+    {
+        _spatial_shape_kind kind;
+        bool active;
+        bool in_tree;
+        double min_x, min_y, max_x, max_y;
+        union
+        {
+            rectangle rect;
+            circle circ;
+            triangle tri;
+            line ln;
+        };
+    };
+
+    struct _spatial_node
+    {
+        double min_x, min_y, max_x, max_y;
+        int first, count;   // nodes in the level below, or entries in items for leaves
+    };
+
+    struct _spatial_index_data
+    {
+        pointer_identifier id;
+        vector<_spatial_shape> shapes;  // indexed by shape id
+        int count;                      // active shapes
+
+        // levels[0] holds the leaves, and the last level holds the root
+        vector<vector<_spatial_node>> levels;
+        vector<int> items;              // shape ids, in leaf order
+        vector<int> pending;            // shape ids added since the last build
+        int removed_in_tree;            // shapes removed since the last build
+    };
+
+    spatial_index create_spatial_index()
+    {
+        spatial_index result = new _spatial_index_data;
+        result->id = SPATIAL_INDEX_PTR;
+        result->count = 0;
+        result->removed_in_tree = 0;
+        return result;
+    }
+
+    void free_spatial_index(spatial_index index)
+    {
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to free spatial index with invalid pointer";
+            return;
+        }
+
+        notify_of_free(index);
+
+        index->id = NONE_PTR;
+        delete index;
+    }
+
+    //----------------------------------------------------------------------
+    // Adding and removing shapes
+    //----------------------------------------------------------------------
+
+    static int _add_shape(spatial_index index, _spatial_shape &shape)
+    {
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to add a shape to an invalid spatial index";
+            return -1;
+        }
+
+        shape.active = true;
+        shape.in_tree = false;
+
+        int result = static_cast<int>(index->shapes.size());
+        index->shapes.push_back(shape);
+        index->pending.push_back(result);
+        index->count++;
+        return result;
+    }
+
+    int spatial_index_add(spatial_index index, const rectangle &rect)
+    {
+        _spatial_shape shape;
+        shape.kind = SPATIAL_RECTANGLE;
+        shape.rect = rect;
+        shape.min_x = rectangle_left(rect);
+        shape.min_y = rectangle_top(rect);
+        shape.max_x = rectangle_right(rect);
+        shape.max_y = rectangle_bottom(rect);
+        return _add_shape(index, shape);
+    }
+
+    int spatial_index_add(spatial_index index, const circle &c)
+    {
+        _spatial_shape shape;
+        shape.kind = SPATIAL_CIRCLE;
+        shape.circ = c;
+        shape.min_x = c.center.x - std::abs(c.radius);
+        shape.min_y = c.center.y - std::abs(c.radius);
+        shape.max_x = c.center.x + std::abs(c.radius);
+        shape.max_y = c.center.y + std::abs(c.radius);
+        return _add_shape(index, shape);
+    }
+
+    int spatial_index_add(spatial_index index, const triangle &tri)
+    {
+        _spatial_shape shape;
+        shape.kind = SPATIAL_TRIANGLE;
+        shape.tri = tri;
+        shape.min_x = std::min({tri.points[0].x, tri.points[1].x, tri.points[2].x});
+        shape.min_y = std::min({tri.points[0].y, tri.points[1].y, tri.points[2].y});
+        shape.max_x = std::max({tri.points[0].x, tri.points[1].x, tri.points[2].x});
+        shape.max_y = std::max({tri.points[0].y, tri.points[1].y, tri.points[2].y});
+        return _add_shape(index, shape);
+    }
+
+    int spatial_index_add(spatial_index index, const line &l)
+    {
+        _spatial_shape shape;
+        shape.kind = SPATIAL_LINE;
+        shape.ln = l;
+        shape.min_x = std::min(l.start_point.x, l.end_point.x);
+        shape.min_y = std::min(l.start_point.y, l.end_point.y);
+        shape.max_x = std::max(l.start_point.x, l.end_point.x);
+        shape.max_y = std::max(l.start_point.y, l.end_point.y);
+        return _add_shape(index, shape);
+    }
+
+    int spatial_index_add(spatial_index index, const vector<line> &lines)
+    {
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to add lines to an invalid spatial index";
+            return -1;
+        }
+
+        if ( lines.empty() ) return -1;
+
+        int result = static_cast<int>(index->shapes.size());
+        index->shapes.reserve(index->shapes.size() + lines.size());
+
+        for (const line &l : lines)
+            spatial_index_add(index, l);
+
+        build_spatial_index(index);
+        return result;
+    }
+
+    static bool _has_shape(spatial_index index, int id)
+    {
+        return id >= 0 && id < static_cast<int>(index->shapes.size()) && index->shapes[id].active;
+    }
+
+    bool spatial_index_remove(spatial_index index, int id)
+    {
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to remove a shape from an invalid spatial index";
+            return false;
+        }
+
+        if ( ! _has_shape(index, id) ) return false;
+
+        // The tree and pending list skip inactive shapes until the next build
+        _spatial_shape &shape = index->shapes[id];
+        shape.active = false;
+        if ( shape.in_tree ) index->removed_in_tree++;
+        index->count--;
+        return true;
+    }
+
+    void spatial_index_clear(spatial_index index)
+    {
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to clear an invalid spatial index";
+            return;
+        }
+
+        index->shapes.clear();
+        index->levels.clear();
+        index->items.clear();
+        index->pending.clear();
+        index->count = 0;
+        index->removed_in_tree = 0;
+    }
+
+    int spatial_index_count(spatial_index index)
+    {
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to count the shapes in an invalid spatial index";
+            return 0;
+        }
+
+        return index->count;
+    }
+
+    bool spatial_index_has_shape(spatial_index index, int id)
+    {
+        return VALID_PTR(index, SPATIAL_INDEX_PTR) && _has_shape(index, id);
+    }
+
+    rectangle spatial_index_shape_bounds(spatial_index index, int id)
+    {
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) || ! _has_shape(index, id) )
+        {
+            LOG(WARNING) << "Trying to get the bounds of an unknown shape in a spatial index";
+            return rectangle_from(0, 0, 0, 0);
+        }
+
+        const _spatial_shape &shape = index->shapes[id];
+        return rectangle_from(shape.min_x, shape.min_y, shape.max_x - shape.min_x, shape.max_y - shape.min_y);
+    }
+
+    //----------------------------------------------------------------------
+    // Building the tree
+    //----------------------------------------------------------------------
+
+    // Order the entries so that each run of SPATIAL_NODE_SIZE entries forms
+    // a compact tile: sort by x into vertical slices, then each slice by y
+    template <typename CENTER_X, typename CENTER_Y>
+    static void _str_sort(vector<int> &order, CENTER_X center_x, CENTER_Y center_y)
+    {
+        size_t n = order.size();
+        size_t nodes = (n + SPATIAL_NODE_SIZE - 1) / SPATIAL_NODE_SIZE;
+        size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(nodes))));
+        size_t per_slice = std::max<size_t>(1, slices) * SPATIAL_NODE_SIZE;
+
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return center_x(a) < center_x(b); });
+
+        for (size_t start = 0; start < n; start += per_slice)
+        {
+            auto end = order.begin() + std::min(n, start + per_slice);
+            std::sort(order.begin() + start, end, [&](int a, int b) { return center_y(a) < center_y(b); });
+        }
+    }
+
+    static void _grow_node(_spatial_node &node, double min_x, double min_y, double max_x, double max_y)
+    {
+        node.min_x = std::min(node.min_x, min_x);
+        node.min_y = std::min(node.min_y, min_y);
+        node.max_x = std::max(node.max_x, max_x);
+        node.max_y = std::max(node.max_y, max_y);
+    }
+
+    static _spatial_node _empty_node(int first, int count)
+    {
+        double inf = std::numeric_limits<double>::infinity();
+        return { inf, inf, -inf, -inf, first, count };
+    }
+
+    void build_spatial_index(spatial_index index)
+    {
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to build an invalid spatial index";
+            return;
+        }
+
+        vector<_spatial_shape> &shapes = index->shapes;
+
+        index->levels.clear();
+        index->items.clear();
+        index->pending.clear();
+        index->removed_in_tree = 0;
+
+        vector<int> &items = index->items;
+        items.reserve(index->count);
+        for (int i = 0; i < static_cast<int>(shapes.size()); i++)
+        {
+            shapes[i].in_tree = shapes[i].active;
+            if ( shapes[i].active ) items.push_back(i);
+        }
+
+        if ( items.empty() ) return;
+
+        _str_sort(items,
+            [&](int id) { return shapes[id].min_x + shapes[id].max_x; },
+            [&](int id) { return shapes[id].min_y + shapes[id].max_y; });
+
+        // Pack the sorted shapes into leaves
+        vector<_spatial_node> level;
+        for (size_t i = 0; i < items.size(); i += SPATIAL_NODE_SIZE)
+        {
+            int count = static_cast<int>(std::min<size_t>(SPATIAL_NODE_SIZE, items.size() - i));
+            _spatial_node node = _empty_node(static_cast<int>(i), count);
+            for (int j = 0; j < count; j++)
+            {
+                const _spatial_shape &shape = shapes[items[i + j]];
+                _grow_node(node, shape.min_x, shape.min_y, shape.max_x, shape.max_y);
+            }
+            level.push_back(node);
+        }
+
+        // Then pack each level into the one above, until there is one root
+        while ( level.size() > 1 )
+        {
+            vector<int> order(level.size());
+            for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<int>(i);
+
+            _str_sort(order,
+                [&](int i) { return level[i].min_x + level[i].max_x; },
+                [&](int i) { return level[i].min_y + level[i].max_y; });
+
+            // Children of a node must be next to each other in their level
+            vector<_spatial_node> sorted;
+            sorted.reserve(level.size());
+            for (int i : order) sorted.push_back(level[i]);
+            index->levels.push_back(sorted);
+
+            level.clear();
+            for (size_t i = 0; i < sorted.size(); i += SPATIAL_NODE_SIZE)
+            {
+                int count = static_cast<int>(std::min<size_t>(SPATIAL_NODE_SIZE, sorted.size() - i));
+                _spatial_node node = _empty_node(static_cast<int>(i), count);
+                for (int j = 0; j < count; j++)
+                {
+                    const _spatial_node &child = sorted[i + j];
+                    _grow_node(node, child.min_x, child.min_y, child.max_x, child.max_y);
+                }
+                level.push_back(node);
+            }
+        }
+
+        index->levels.push_back(level);
+    }
+
+    // Rebuild once the pending shapes or removed shapes make up enough of
+    // the index to slow queries down
+    static void _refresh_spatial_index(spatial_index index)
+    {
+        size_t in_tree = index->items.size();
+
+        if ( index->pending.size() > SPATIAL_PENDING_LIMIT && index->pending.size() * 8 > in_tree )
+            build_spatial_index(index);
+        else if ( index->removed_in_tree > SPATIAL_PENDING_LIMIT && static_cast<size_t>(index->removed_in_tree) * 2 > in_tree )
+            build_spatial_index(index);
+    }
+
+    //----------------------------------------------------------------------
+    // Walking the tree
+    //----------------------------------------------------------------------
+
+    // Calls visit with the id of each shape whose bounds overlaps accepts,
+    // skipping the nodes it rejects. Stops early when visit returns false.
+    template <typename OVERLAPS, typename VISIT>
+    static void _visit_shapes(spatial_index index, OVERLAPS overlaps, VISIT visit)
+    {
+        for (int id : index->pending)
+        {
+            const _spatial_shape &shape = index->shapes[id];
+            if ( ! shape.active ) continue;
+
+            _spatial_node bounds = { shape.min_x, shape.min_y, shape.max_x, shape.max_y, id, 1 };
+            if ( overlaps(bounds) && ! visit(id) ) return;
+        }
+
+        if ( index->levels.empty() ) return;
+
+        // Each entry is the level and the index of a node in that level
+        vector<std::pair<int, int>> stack;
+        stack.push_back({ static_cast<int>(index->levels.size()) - 1, 0 });
+
+        while ( ! stack.empty() )
+        {
+            auto top = stack.back();
+            stack.pop_back();
+
+            const _spatial_node &node = index->levels[top.first][top.second];
+            if ( ! overlaps(node) ) continue;
+
+            if ( top.first == 0 )
+            {
+                for (int i = node.first; i < node.first + node.count; i++)
+                {
+                    int id = index->items[i];
+                    const _spatial_shape &shape = index->shapes[id];
+                    if ( ! shape.active ) continue;
+
+                    _spatial_node bounds = { shape.min_x, shape.min_y, shape.max_x, shape.max_y, id, 1 };
+                    if ( overlaps(bounds) && ! visit(id) ) return;
+                }
+            }
+            else
+            {
+                for (int i = node.first; i < node.first + node.count; i++)
+                    stack.push_back({ top.first - 1, i });
+            }
+        }
+    }
+
+    static bool _node_overlaps_rect(const _spatial_node &node, double min_x, double min_y, double max_x, double max_y)
+    {
+        return node.min_x <= max_x && node.max_x >= min_x && node.min_y <= max_y && node.max_y >= min_y;
+    }
+
+    static double _node_distance_squared(const _spatial_node &node, const point_2d &pt)
+    {
+        double dx = std::max({ node.min_x - pt.x, 0.0, pt.x - node.max_x });
+        double dy = std::max({ node.min_y - pt.y, 0.0, pt.y - node.max_y });
+        return dx * dx + dy * dy;
+    }
+
+    static bool _circle_touches_rect(const circle &c, const rectangle &rect)
+    {
+        double dx = c.center.x - std::max((double)rectangle_left(rect), std::min(c.center.x, (double)rectangle_right(rect)));
+        double dy = c.center.y - std::max((double)rectangle_top(rect), std::min(c.center.y, (double)rectangle_bottom(rect)));
+        return dx * dx + dy * dy <= c.radius * c.radius;
+    }
+
+    static bool _shape_touches_rect(const _spatial_shape &shape, const rectangle &rect)
+    {
+        switch ( shape.kind )
+        {
+            case SPATIAL_RECTANGLE:
+                // The bounds of the shape already overlap the area
+                return true;
+            case SPATIAL_CIRCLE:
+                return _circle_touches_rect(shape.circ, rect);
+            case SPATIAL_TRIANGLE:
+                return triangle_rectangle_intersect(shape.tri, rect);
+            case SPATIAL_LINE:
+                return point_in_rectangle(shape.ln.start_point, rect) || line_intersects_rect(shape.ln, rect);
+        }
+        return false;
+    }
+
+    static bool _shape_touches_circle(const _spatial_shape &shape, const circle &c)
+    {
+        switch ( shape.kind )
+        {
+            case SPATIAL_RECTANGLE:
+                return _circle_touches_rect(c, shape.rect);
+            case SPATIAL_CIRCLE:
+                return circles_intersect(shape.circ, c);
+            case SPATIAL_TRIANGLE:
+                return circle_triangle_intersect(c, shape.tri);
+            case SPATIAL_LINE:
+                return line_intersects_circle(shape.ln, c);
+        }
+        return false;
+    }
+
+    //----------------------------------------------------------------------
+    // Rays
+    //----------------------------------------------------------------------
+
+    // Distance along a ray, with a unit heading, to where it enters the node,
+    // or -1 if it misses the node within max_distance
+    static double _ray_node_distance(const _spatial_node &node, const point_2d &origin, const vector_2d &dir, double max_distance)
+    {
+        double t_min = 0, t_max = max_distance;
+
+        const double origins[2] = { origin.x, origin.y };
+        const double dirs[2] = { dir.x, dir.y };
+        const double mins[2] = { node.min_x, node.min_y };
+        const double maxs[2] = { node.max_x, node.max_y };
+
+        for (int axis = 0; axis < 2; axis++)
+        {
+            if ( std::abs(dirs[axis]) < 1e-12 )
+            {
+                if ( origins[axis] < mins[axis] || origins[axis] > maxs[axis] ) return -1;
+                continue;
+            }
+
+            double t1 = (mins[axis] - origins[axis]) / dirs[axis];
+            double t2 = (maxs[axis] - origins[axis]) / dirs[axis];
+            if ( t1 > t2 ) std::swap(t1, t2);
+
+            t_min = std::max(t_min, t1);
+            t_max = std::min(t_max, t2);
+            if ( t_min > t_max ) return -1;
+        }
+
+        return t_min;
+    }
+
+    static bool _ray_segment_distance(const point_2d &origin, const vector_2d &dir, const point_2d &a, const point_2d &b, double max_distance, double &dist, vector_2d &normal)
+    {
+        double ex = b.x - a.x, ey = b.y - a.y;
+        double denom = dir.x * ey - dir.y * ex;
+        if ( std::abs(denom) < 1e-12 ) return false;
+
+        double ax = a.x - origin.x, ay = a.y - origin.y;
+        double t = (ax * ey - ay * ex) / denom;
+        double s = (ax * dir.y - ay * dir.x) / denom;
+
+        if ( t < 0 || t > max_distance || s < 0 || s > 1 ) return false;
+
+        double len = std::sqrt(ex * ex + ey * ey);
+        normal = vector_to(-ey / len, ex / len);
+        if ( dot_product(normal, dir) > 0 ) normal = vector_invert(normal);
+
+        dist = t;
+        return true;
+    }
+
+    // Distance along a ray, with a unit heading, to where it first touches
+    // the shape, and the shape's surface normal there. Rays starting inside
+    // a shape hit it at distance 0, facing back along the ray.
+    static bool _ray_shape_distance(const _spatial_shape &shape, const point_2d &origin, const vector_2d &dir, double max_distance, double &dist, vector_2d &normal)
+    {
+        switch ( shape.kind )
+        {
+            case SPATIAL_RECTANGLE:
+            {
+                _spatial_node bounds = { shape.min_x, shape.min_y, shape.max_x, shape.max_y, 0, 0 };
+                double t = _ray_node_distance(bounds, origin, dir, max_distance);
+                if ( t < 0 ) return false;
+
+                dist = t;
+                if ( t == 0 )
+                {
+                    normal = vector_invert(dir);
+                    return true;
+                }
+
+                // The side the ray entered through is the one it reaches last
+                double tx = dir.x == 0 ? -1 : ((dir.x > 0 ? shape.min_x : shape.max_x) - origin.x) / dir.x;
+                double ty = dir.y == 0 ? -1 : ((dir.y > 0 ? shape.min_y : shape.max_y) - origin.y) / dir.y;
+                if ( tx >= ty )
+                    normal = vector_to(dir.x > 0 ? -1 : 1, 0);
+                else
+                    normal = vector_to(0, dir.y > 0 ? -1 : 1);
+                return true;
+            }
+            case SPATIAL_CIRCLE:
+            {
+                const circle &c = shape.circ;
+                if ( c.radius <= 0 ) return false;
+
+                double ox = c.center.x - origin.x, oy = c.center.y - origin.y;
+                double dist_sq = ox * ox + oy * oy;
+
+                if ( dist_sq <= c.radius * c.radius )
+                {
+                    dist = 0;
+                    normal = vector_invert(dir);
+                    return true;
+                }
+
+                double v = ox * dir.x + oy * dir.y;
+                double d = c.radius * c.radius - (dist_sq - v * v);
+                if ( d < 0 ) return false;
+
+                double t = v - std::sqrt(d);
+                if ( t < 0 || t > max_distance ) return false;
+
+                dist = t;
+                normal = vector_to((origin.x + dir.x * t - c.center.x) / c.radius, (origin.y + dir.y * t - c.center.y) / c.radius);
+                return true;
+            }
+            case SPATIAL_TRIANGLE:
+            {
+                if ( point_in_triangle(origin, shape.tri) )
+                {
+                    dist = 0;
+                    normal = vector_invert(dir);
+                    return true;
+                }
+
+                bool hit = false;
+                double edge_dist;
+                vector_2d edge_normal;
+                for (int i = 0; i < 3; i++)
+                {
+                    if ( _ray_segment_distance(origin, dir, shape.tri.points[i], shape.tri.points[(i + 1) % 3], hit ? dist : max_distance, edge_dist, edge_normal) )
+                    {
+                        hit = true;
+                        dist = edge_dist;
+                        normal = edge_normal;
+                    }
+                }
+                return hit;
+            }
+            case SPATIAL_LINE:
+                return _ray_segment_distance(origin, dir, shape.ln.start_point, shape.ln.end_point, max_distance, dist, normal);
+        }
+        return false;
+    }
+
+    //----------------------------------------------------------------------
+    // Queries
+    //----------------------------------------------------------------------
+
+    vector<int> spatial_index_query(spatial_index index, const rectangle &area)
+    {
+        vector<int> result;
+
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to query an invalid spatial index";
+            return result;
+        }
+
+        _refresh_spatial_index(index);
+
+        double min_x = rectangle_left(area), min_y = rectangle_top(area);
+        double max_x = rectangle_right(area), max_y = rectangle_bottom(area);
+
+        _visit_shapes(index,
+            [&](const _spatial_node &node) { return _node_overlaps_rect(node, min_x, min_y, max_x, max_y); },
+            [&](int id)
+            {
+                if ( _shape_touches_rect(index->shapes[id], area) ) result.push_back(id);
+                return true;
+            });
+
+        return result;
+    }
+
+    vector<int> spatial_index_query(spatial_index index, const circle &area)
+    {
+        vector<int> result;
+
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to query an invalid spatial index";
+            return result;
+        }
+
+        _refresh_spatial_index(index);
+
+        double radius_sq = area.radius * area.radius;
+
+        _visit_shapes(index,
+            [&](const _spatial_node &node) { return _node_distance_squared(node, area.center) <= radius_sq; },
+            [&](int id)
+            {
+                if ( _shape_touches_circle(index->shapes[id], area) ) result.push_back(id);
+                return true;
+            });
+
+        return result;
+    }
+
+    vector<int> spatial_index_ray_query(spatial_index index, const point_2d &origin, const vector_2d &heading, double max_distance)
+    {
+        vector<int> result;
+
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to query an invalid spatial index";
+            return result;
+        }
+
+        if ( is_zero_vector(heading) || max_distance < 0 ) return result;
+
+        _refresh_spatial_index(index);
+
+        vector_2d dir = unit_vector(heading);
+        vector<std::pair<double, int>> hits;
+
+        _visit_shapes(index,
+            [&](const _spatial_node &node) { return _ray_node_distance(node, origin, dir, max_distance) >= 0; },
+            [&](int id)
+            {
+                double dist;
+                vector_2d normal;
+                if ( _ray_shape_distance(index->shapes[id], origin, dir, max_distance, dist, normal) )
+                    hits.push_back({ dist, id });
+                return true;
+            });
+
+        std::sort(hits.begin(), hits.end());
+
+        result.reserve(hits.size());
+        for (const auto &hit : hits) result.push_back(hit.second);
+        return result;
+    }
+
+    struct _ray_entry
+    {
+        int level, node;
+        double distance;    // where the ray enters the node
+    };
+
+    static raycast_hit _no_hit()
+    {
+        return { false, 0, point_at_origin(), vector_to(0, 0), -1 };
+    }
+
+    // Find the nearest hit along a ray with a unit heading, without
+    // rebuilding the index, so many rays can be cast at once. The stack is
+    // passed in to be reused from ray to ray.
+    static raycast_hit _nearest_ray_hit(spatial_index index, const point_2d &origin, const vector_2d &dir, double max_distance, vector<_ray_entry> &stack)
+    {
+        raycast_hit result = _no_hit();
+        double best = max_distance;
+
+        auto check_shape = [&](int id)
+        {
+            const _spatial_shape &shape = index->shapes[id];
+            if ( ! shape.active ) return;
+
+            double dist;
+            vector_2d normal;
+            if ( _ray_shape_distance(shape, origin, dir, best, dist, normal) && ( ! result.hit || dist < result.distance ) )
+            {
+                best = dist;
+                result = { true, dist, point_at(origin.x + dir.x * dist, origin.y + dir.y * dist), normal, id };
+            }
+        };
+
+        for (int id : index->pending)
+            check_shape(id);
+
+        if ( index->levels.empty() ) return result;
+
+        int root_level = static_cast<int>(index->levels.size()) - 1;
+        double root_dist = _ray_node_distance(index->levels[root_level][0], origin, dir, best);
+        if ( root_dist < 0 ) return result;
+
+        stack.clear();
+        stack.push_back({ root_level, 0, root_dist });
+
+        while ( ! stack.empty() )
+        {
+            _ray_entry top = stack.back();
+            stack.pop_back();
+
+            // A nearer hit may have been found since this node was pushed
+            if ( top.distance > best ) continue;
+
+            const _spatial_node &node = index->levels[top.level][top.node];
+
+            if ( top.level == 0 )
+            {
+                for (int i = node.first; i < node.first + node.count; i++)
+                    check_shape(index->items[i]);
+                continue;
+            }
+
+            // Push the children furthest first, so the nearest is visited next
+            size_t start = stack.size();
+            for (int i = node.first; i < node.first + node.count; i++)
+            {
+                double dist = _ray_node_distance(index->levels[top.level - 1][i], origin, dir, best);
+                if ( dist >= 0 ) stack.push_back({ top.level - 1, i, dist });
+            }
+            std::sort(stack.begin() + start, stack.end(), [](const _ray_entry &a, const _ray_entry &b) { return a.distance > b.distance; });
+        }
+
+        return result;
+    }
+
+    bool spatial_index_raycast(spatial_index index, const point_2d &origin, const vector_2d &heading, double max_distance, raycast_hit &out_hit)
+    {
+        out_hit = _no_hit();
+
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to cast a ray into an invalid spatial index";
+            return false;
+        }
+
+        if ( is_zero_vector(heading) || max_distance < 0 ) return false;
+
+        _refresh_spatial_index(index);
+
+        vector<_ray_entry> stack;
+        out_hit = _nearest_ray_hit(index, origin, unit_vector(heading), max_distance, stack);
+        return out_hit.hit;
+    }
+
+    void raycast_many(const vector<point_2d> &origins, const vector<vector_2d> &headings, double max_distance, spatial_index index, vector<raycast_hit> &out_hits)
+    {
+        out_hits.assign(origins.size(), _no_hit());
+
+        if ( INVALID_PTR(index, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to cast rays into an invalid spatial index";
+            return;
+        }
+
+        if ( headings.size() != origins.size() )
+        {
+            LOG(WARNING) << "Casting rays with " << origins.size() << " origins and " << headings.size() << " headings, the extra origins will not hit anything";
+        }
+
+        if ( max_distance < 0 ) return;
+
+        // Build now, as the threads below only read the index
+        _refresh_spatial_index(index);
+
+        size_t count = std::min(origins.size(), headings.size());
+
+        auto cast_range = [&](size_t begin, size_t end)
+        {
+            vector<_ray_entry> stack;
+            for (size_t i = begin; i < end; i++)
+            {
+                if ( is_zero_vector(headings[i]) ) continue;
+                out_hits[i] = _nearest_ray_hit(index, origins[i], unit_vector(headings[i]), max_distance, stack);
+            }
+        };
+
+        worker_pool &pool = shared_worker_pool();
+
+        if ( count < RAYCAST_PARALLEL_MIN_COUNT || pool.thread_count() < 1 )
+        {
+            cast_range(0, count);
+            return;
+        }
+
+        parallel_for(pool, count, RAYCAST_CHUNK, [&](size_t begin, size_t end, size_t)
+        {
+            cast_range(begin, end);
+        });
+    }
+
+    point_2d closest_point_on_lines(const point_2d from_pt, spatial_index lines, int &line_id)
+    {
+        line_id = -1;
+        point_2d result = point_at_origin();
+
+        if ( INVALID_PTR(lines, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to find the closest point on lines in an invalid spatial index";
+            return result;
+        }
+
+        _refresh_spatial_index(lines);
+
+        double min_dist = std::numeric_limits<double>::max();
+
+        auto check_line = [&](int id)
+        {
+            const _spatial_shape &shape = lines->shapes[id];
+            if ( ! shape.active || shape.kind != SPATIAL_LINE ) return;
+
+            point_2d pt = closest_point_on_line(from_pt, shape.ln);
+            double dx = pt.x - from_pt.x, dy = pt.y - from_pt.y;
+            double dist = dx * dx + dy * dy;
+
+            if ( dist < min_dist )
+            {
+                min_dist = dist;
+                line_id = id;
+                result = pt;
+            }
+        };
+
+        for (int id : lines->pending)
+            check_line(id);
+
+        if ( lines->levels.empty() ) return result;
+
+        // Visit the nearest nodes first, and stop once the nearest remaining
+        // node is further away than the closest point found
+        struct queued_node { double dist; int level, node; };
+        auto further = [](const queued_node &a, const queued_node &b) { return a.dist > b.dist; };
+        std::priority_queue<queued_node, vector<queued_node>, decltype(further)> queue(further);
+
+        int root_level = static_cast<int>(lines->levels.size()) - 1;
+        queue.push({ _node_distance_squared(lines->levels[root_level][0], from_pt), root_level, 0 });
+
+        while ( ! queue.empty() && queue.top().dist < min_dist )
+        {
+            queued_node top = queue.top();
+            queue.pop();
+
+            const _spatial_node &node = lines->levels[top.level][top.node];
+
+            for (int i = node.first; i < node.first + node.count; i++)
+            {
+                if ( top.level == 0 )
+                    check_line(lines->items[i]);
+                else
+                    queue.push({ _node_distance_squared(lines->levels[top.level - 1][i], from_pt), top.level - 1, i });
+            }
+        }
+
+        return result;
+    }
+
+    bool line_intersects_lines(const line &l, spatial_index lines)
+    {
+        if ( INVALID_PTR(lines, SPATIAL_INDEX_PTR) )
+        {
+            LOG(WARNING) << "Trying to check lines in an invalid spatial index";
+            return false;
+        }
+
+        _refresh_spatial_index(lines);
+
+        double min_x = std::min(l.start_point.x, l.end_point.x), min_y = std::min(l.start_point.y, l.end_point.y);
+        double max_x = std::max(l.start_point.x, l.end_point.x), max_y = std::max(l.start_point.y, l.end_point.y);
+        bool result = false;
+
+        _visit_shapes(lines,
+            [&](const _spatial_node &node) { return _node_overlaps_rect(node, min_x, min_y, max_x, max_y); },
+            [&](int id)
+            {
+                const _spatial_shape &shape = lines->shapes[id];
+                result = shape.kind == SPATIAL_LINE && lines_intersect(l, shape.ln);
+                return ! result;
+            });
+
+        return result;
+    }
+}
@@ -0,0 +1,320 @@
+/**
+ * @header  spatial_index
+ * @brief   A spatial index stores shapes so you can quickly find the ones in an area.
+ *
+ * Add the rectangles, circles, triangles and lines that make up your level
+ * to a spatial index, then ask it for the shapes in an area or along a
+ * ray. Each shape you add is given an id, which the queries return. The
+ * index keeps the shapes in a tree of bounding boxes, so a query only
+ * checks the shapes near the area, rather than every shape.
+ *
+ * @attribute group  geometry
+ * @attribute static spatial_index
+ */
+
+#ifndef spatial_index_h
+#define spatial_index_h
+
+#include "types.h"
+
+#include <vector>
+using std::vector;
+
+namespace splashkit_lib
+{
+    /**
+     * A spatial index holds shapes, and finds the ones in an area without
+     * checking every shape.
+     *
+     * @attribute class spatial_index
+     */
+    typedef struct _spatial_index_data *spatial_index;
+
+    /**
+     * The details of where a ray cast into a spatial index first hits a
+     * shape.
+     *
+     * @field hit       True if the ray hit a shape
+     * @field distance  How far along the ray the hit is
+     * @field point     The point where the ray hit the shape
+     * @field normal    The unit vector out of the shape's surface at the hit.
+     *                  Rays that start inside a shape hit it at distance 0,
+     *                  and the normal points back along the ray.
+     * @field shape_id  The id of the shape that was hit, or -1 if there was
+     *                  no hit
+     */
+    struct raycast_hit
+    {
+        bool hit;
+        double distance;
+        point_2d point;
+        vector_2d normal;
+        int shape_id;
+    };
+
+    /**
+     * Create a new, empty, spatial index.
+     *
+     * @return  The new spatial index
+     *
+     * @attribute class spatial_index
+     * @attribute constructor true
+     */
+    spatial_index create_spatial_index();
+
+    /**
+     * Free the spatial index and the shapes it holds.
+     *
+     * @param index The spatial index to free
+     *
+     * @attribute class spatial_index
+     * @attribute destructor true
+     */
+    void free_spatial_index(spatial_index index);
+
+    /**
+     * Add a rectangle to the spatial index.
+     *
+     * @param index The spatial index
+     * @param rect  The rectangle to add
+     * @return      The id of the shape in the index, or -1 if the index is
+     *              not valid
+     *
+     * @attribute class spatial_index
+     * @attribute method add
+     * @attribute suffix rectangle
+     */
+    int spatial_index_add(spatial_index index, const rectangle &rect);
+
+    /**
+     * Add a circle to the spatial index.
+     *
+     * @param index The spatial index
+     * @param c     The circle to add
+     * @return      The id of the shape in the index, or -1 if the index is
+     *              not valid
+     *
+     * @attribute class spatial_index
+     * @attribute method add
+     * @attribute suffix circle
+     */
+    int spatial_index_add(spatial_index index, const circle &c);
+
+    /**
+     * Add a triangle to the spatial index.
+     *
+     * @param index The spatial index
+     * @param tri   The triangle to add
+     * @return      The id of the shape in the index, or -1 if the index is
+     *              not valid
+     *
+     * @attribute class spatial_index
+     * @attribute method add
+     * @attribute suffix triangle
+     */
+    int spatial_index_add(spatial_index index, const triangle &tri);
+
+    /**
+     * Add a line to the spatial index.
+     *
+     * @param index The spatial index
+     * @param l     The line to add
+     * @return      The id of the shape in the index, or -1 if the index is
+     *              not valid
+     *
+     * @attribute class spatial_index
+     * @attribute method add
+     * @attribute suffix line
+     */
+    int spatial_index_add(spatial_index index, const line &l);
+
+    /**
+     * Add many lines to the spatial index, and rebuild its tree once they are
+     * all in place. This is the quickest way to fill an index.
+     *
+     * @param index The spatial index
+     * @param lines The lines to add
+     * @return      The id of the first line added. The other lines have the
+     *              ids that follow it, in order. Returns -1 if there are no
+     *              lines, or the index is not valid.
+     *
+     * @attribute class spatial_index
+     * @attribute method add_all
+     * @attribute suffix lines
+     */
+    int spatial_index_add(spatial_index index, const vector<line> &lines);
+
+    /**
+     * Remove a shape from the spatial index. Its id is not given to any
+     * other shape.
+     *
+     * @param index The spatial index
+     * @param id    The id of the shape to remove
+     * @return      True if the shape was in the index
+     *
+     * @attribute class spatial_index
+     * @attribute method remove
+     */
+    bool spatial_index_remove(spatial_index index, int id);
+
+    /**
+     * Remove all of the shapes from the spatial index.
+     *
+     * @param index The spatial index
+     *
+     * @attribute class spatial_index
+     * @attribute method clear
+     */
+    void spatial_index_clear(spatial_index index);
+
+    /**
+     * The number of shapes in the spatial index.
+     *
+     * @param index The spatial index
+     * @return      The number of shapes that have been added and not removed
+     *
+     * @attribute class spatial_index
+     * @attribute getter count
+     */
+    int spatial_index_count(spatial_index index);
+
+    /**
+     * Check if a shape is in the spatial index.
+     *
+     * @param index The spatial index
+     * @param id    The id of the shape
+     * @return      True if the shape has been added and not removed
+     *
+     * @attribute class spatial_index
+     * @attribute method has_shape
+     */
+    bool spatial_index_has_shape(spatial_index index, int id);
+
+    /**
+     * The rectangle around a shape in the spatial index.
+     *
+     * @param index The spatial index
+     * @param id    The id of the shape
+     * @return      The bounding rectangle of the shape, or an empty rectangle
+     *              if the shape is not in the index
+     *
+     * @attribute class spatial_index
+     * @attribute method shape_bounds
+     */
+    rectangle spatial_index_shape_bounds(spatial_index index, int id);
+
+    /**
+     * Rebuild the tree that the spatial index uses to find shapes. Shapes
+     * added since the last build are checked one by one until the tree is
+     * rebuilt. The index rebuilds itself once enough shapes have been added
+     * or removed, so you only need to call this to choose when that work is
+     * done, such as after loading a level.
+     *
+     * @param index The spatial index
+     *
+     * @attribute class spatial_index
+     * @attribute method build
+     */
+    void build_spatial_index(spatial_index index);
+
+    /**
+     * Find the shapes in the spatial index that touch a rectangle.
+     *
+     * @param index The spatial index
+     * @param area  The area to search
+     * @return      The ids of the shapes that touch the rectangle
+     *
+     * @attribute class spatial_index
+     * @attribute method query
+     * @attribute suffix rectangle
+     */
+    vector<int> spatial_index_query(spatial_index index, const rectangle &area);
+
+    /**
+     * Find the shapes in the spatial index that touch a circle.
+     *
+     * @param index The spatial index
+     * @param area  The area to search
+     * @return      The ids of the shapes that touch the circle
+     *
+     * @attribute class spatial_index
+     * @attribute method query
+     * @attribute suffix circle
+     */
+    vector<int> spatial_index_query(spatial_index index, const circle &area);
+
+    /**
+     * Find the shapes in the spatial index that a ray passes through.
+     *
+     * @param index         The spatial index
+     * @param origin        The point the ray starts from
+     * @param heading       The direction of the ray
+     * @param max_distance  How far the ray reaches
+     * @return              The ids of the shapes the ray hits, nearest first
+     *
+     * @attribute class spatial_index
+     * @attribute method ray_query
+     */
+    vector<int> spatial_index_ray_query(spatial_index index, const point_2d &origin, const vector_2d &heading, double max_distance);
+
+    /**
+     * Cast a ray into the spatial index, and find the first shape it hits.
+     *
+     * @param index         The spatial index
+     * @param origin        The point the ray starts from
+     * @param heading       The direction of the ray
+     * @param max_distance  How far the ray reaches
+     * @param out_hit       After the call this stores where the ray first hit
+     *                      a shape
+     * @return              True if the ray hit a shape
+     *
+     * @attribute class spatial_index
+     * @attribute method raycast
+     */
+    bool spatial_index_raycast(spatial_index index, const point_2d &origin, const vector_2d &heading, double max_distance, raycast_hit &out_hit);
+
+    /**
+     * Cast many rays into the spatial index, and find the first shape each
+     * one hits. Large batches are split across several threads, so this is
+     * much faster than casting each ray with its own call. The index must
+     * not be changed while this runs.
+     *
+     * @param origins       The points the rays start from
+     * @param headings      The direction of each ray, matching the origins
+     * @param max_distance  How far the rays reach
+     * @param index         The spatial index
+     * @param out_hits      After the call this stores the hit for each ray,
+     *                      in the same order as the origins
+     */
+    void raycast_many(const vector<point_2d> &origins, const vector<vector_2d> &headings, double max_distance, spatial_index index, vector<raycast_hit> &out_hits);
+
+    /**
+     * Get the point closest to `from pt` that is on one of the lines in the
+     * spatial index. Other shapes in the index are ignored. Only the lines
+     * near the point are checked.
+     *
+     * @param  from_pt The point to test
+     * @param  lines   The spatial index holding the lines
+     * @param  line_id After the call this will store the id of the line that
+     *                  had the matching point, or -1 if the index has no lines.
+     * @return         The point on one of the lines that is the closest point
+     *                 on these lines to the `from pt`.
+     *
+     * @attribute suffix in_index
+     */
+    point_2d closest_point_on_lines(const point_2d from_pt, spatial_index lines, int &line_id);
+
+    /**
+     * Returns true if the line intersects any of the lines in the spatial
+     * index. Other shapes in the index are ignored.
+     *
+     * @param  l     The line to check
+     * @param  lines The spatial index holding the lines to check against
+     * @return       True if `l` intersects any of the lines in `lines`
+     *
+     * @attribute suffix in_index
+     */
+    bool line_intersects_lines(const line &l, spatial_index lines);
+}
+
+#endif /* spatial_index_h */
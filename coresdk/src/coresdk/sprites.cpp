@@ -7,6 +7,7 @@
 //
 
 #include "animations.h"
+#include "audio.h"
 #include "backend_types.h"
 #include "camera.h"
 #include "collisions.h"
@@ -16,13 +17,20 @@
 #include "sprites.h"
 #include "timers.h"
 #include "utility_functions.h"
+#include "resource_registry.h"
 #include "vector_2d.h"
 
+#include "concurrency_utils.h"
+
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 using std::map;
+using std::unordered_map;
 using std::vector;
 using std::to_string;
 using std::swap;
@@ -32,7 +40,35 @@ namespace splashkit_lib
     timer _sprite_timer = nullptr;
     vector<sprite_event_handler *> _global_sprite_event_handlers;
 
-    map<string, sprite> _sprites;
+    resource_registry<sprite> _sprites;
+
+    // from animations
+    sound_effect _animation_entered_frame_sound(animation anim);
+
+    // Packs smaller than this are not worth splitting across threads
+#define SPRITE_PARALLEL_MIN_COUNT   512
+    // The number of sprites each thread takes at a time
+#define SPRITE_PARALLEL_CHUNK       128
+
+    //
+    // While a sprite is updated on a worker thread its events, and the
+    // sounds of its animation, are kept here to be raised on the main
+    // thread once the pack has been updated.
+    //
+    struct _deferred_sprite_event
+    {
+        sprite              s;
+        size_t              idx;    // the sprite's position in the pack
+        sprite_event_kind   evt;
+        sound_effect        sound;  // when assigned, play this instead of raising evt
+    };
+
+    static thread_local vector<_deferred_sprite_event> *_deferred_sprite_events = nullptr;
+    static thread_local size_t _deferred_sprite_idx = 0;
+
+    // Lists of events from earlier updates, kept so their space is reused.
+    // Each update takes its own, as an event handler may update sprites again.
+    static vector<vector<vector<_deferred_sprite_event>>> _spare_deferred_events;
 
     // Sprite pack data
 #define INITIAL_PACK_NAME "default"
@@ -44,10 +80,105 @@ namespace splashkit_lib
         return _sprite_packs[_current_pack];
     }
 
+    //
+    // Packs that are being looped over, with the number of loops in progress.
+    // Sprites removed from these packs leave a nullptr in their place, and
+    // the pack is compacted when the last loop ends, so the loops do not
+    // need their own copy of the pack.
+    //
+    unordered_map<const vector<void *> *, int> _iterating_packs;
+
+    static void _begin_pack_iteration(vector<void *> &pack)
+    {
+        _iterating_packs[&pack]++;
+    }
+
+    static void _end_pack_iteration(vector<void *> &pack)
+    {
+        auto it = _iterating_packs.find(&pack);
+        if ( it == _iterating_packs.end() or --it->second > 0 ) return;
+
+        _iterating_packs.erase(it);
+        pack.erase(std::remove(pack.begin(), pack.end(), nullptr), pack.end());
+    }
+
+    static bool _remove_from_pack(vector<void *> &pack, void *s)
+    {
+        if ( _iterating_packs.count(&pack) == 0 )
+            return erase_from_vector(pack, s);
+
+        auto it = std::find(pack.begin(), pack.end(), s);
+        if ( it == pack.end() ) return false;
+
+        *it = nullptr;
+        return true;
+    }
+
 #define SCALE_KEY       "scale"
 #define ROTATION_KEY    "rotation"
 #define MASS_KEY        "mass"
 
+    //
+    // Value names are interned, giving each name a small id that indexes
+    // the value arrays in every sprite. The first ids are the built in values.
+    //
+#define MASS_VALUE_ID       0
+#define ROTATION_VALUE_ID   1
+#define SCALE_VALUE_ID      2
+
+    static unordered_map<string, int> _sprite_value_ids = { { MASS_KEY, MASS_VALUE_ID }, { ROTATION_KEY, ROTATION_VALUE_ID }, { SCALE_KEY, SCALE_VALUE_ID } };
+    static int _sprite_value_id_count = 3;
+
+    // -1 when no sprite has been given a value with that name
+    static int _find_sprite_value_id(const string &name)
+    {
+        auto it = _sprite_value_ids.find(name);
+        return it == _sprite_value_ids.end() ? -1 : it->second;
+    }
+
+    //-----------------------------------------------------------------------------
+    // Dense sprite storage
+    //-----------------------------------------------------------------------------
+
+    //
+    // The state that changes every frame is kept in arrays for each pack,
+    // rather than in each sprite, so update_all_sprites can move a whole
+    // pack in one pass over contiguous memory. Sprites keep their slot in
+    // the arrays, and removing a sprite moves the last one into its slot.
+    //
+    struct _sprite_world
+    {
+        vector<double>  x, y;           // The game location of each sprite
+        vector<double>  dx, dy;         // The velocity of each sprite
+        vector<float>   rotation;       // In degrees
+        vector<float>   scale;
+        vector<sprite>  owners;         // owners[i]->slot == i
+    };
+
+    // Each sprite pack has its own world, keyed by the pack
+    unordered_map<const vector<void *> *, _sprite_world> _sprite_worlds;
+
+    //
+    // The location matrix and rotated collision rectangle are costly to
+    // work out, so they are kept until something they depend on changes.
+    // Position, rotation and scale are compared with the values the cache
+    // was made from, as they change in the pack's arrays; other changes
+    // mark the cache as dirty.
+    //
+    struct _sprite_shape_cache
+    {
+        bool        dirty;              // set when the anchor point or collision bitmap change
+        double      x, y;
+        float       rotation, scale;
+        int         w, h;               // the size of the base layer's cells
+
+        bool        has_location;
+        matrix_2d   location;
+
+        bool        has_collision_rect;
+        rectangle   collision_rect;
+    };
+
     struct _sprite_data
     {
         pointer_identifier  id;
@@ -58,14 +189,20 @@ namespace splashkit_lib
         vector<int>         visible_layers;   // The indexes of the visible layers
         vector<vector_2d>   layer_offsets;    // Offsets from drawing the layers
 
-        map<string, float>  values;           // Values associated with this sprite
+        bool                cache_layers;     // Draw the visible layers from one composited image per cell
+        map<int, bitmap>    layer_cache;      // The composited layers, by animation cell (-1 when not animated)
+        rectangle           layer_cache_area; // The area the composited layers cover, relative to the sprite
+
+        vector<float>       values;           // Values associated with this sprite, indexed by value id
+        vector<bool>        has_values;       // Whether the sprite has the value with each id
+        int                 value_count;      // The values this sprite has, other than rotation and scale
 
 
         animation           animation_info;   // The data used to animate this sprite
         animation_script    script;           // The template for this sprite"s animations
 
-        point_2d            position;         // The game location of the sprite
-        vector_2d           velocity;         // The velocity of the sprite
+        _sprite_world       *world;           // Holds the position, velocity, rotation and scale
+        size_t              slot;             // The sprite's index in the world's arrays
 
         collision_test_kind collision_kind;   //The kind of collisions used by this sprite
         bitmap              collision_bitmap; // The bitmap used for collision testing (default to first image)
@@ -82,6 +219,12 @@ namespace splashkit_lib
 
         bool                announced_animation_end; // Used to avoid multiple announcements of an end of an animation
 
+        int                 z_index;            // The order sprites are drawn in when draw_all_sprites sorts the pack
+
+        _sprite_shape_cache shape;
+
+        unsigned int        queued_events;      // A bit for each kind of event waiting in the batch, when coalescing
+
         vector<sprite_event_handler *> evts;    // The call backs listening for sprite events
 
         vector<void *>      &pack;              // Points the the SpritePack that contains this sprite
@@ -91,10 +234,288 @@ namespace splashkit_lib
         }
     };
 
+    static inline double &_sprite_x(sprite s) { return s->world->x[s->slot]; }
+    static inline double &_sprite_y(sprite s) { return s->world->y[s->slot]; }
+    static inline double &_sprite_dx(sprite s) { return s->world->dx[s->slot]; }
+    static inline double &_sprite_dy(sprite s) { return s->world->dy[s->slot]; }
+    static inline float &_sprite_rotation(sprite s) { return s->world->rotation[s->slot]; }
+    static inline float &_sprite_scale(sprite s) { return s->world->scale[s->slot]; }
+
+    static inline vector_2d _sprite_velocity(sprite s)
+    {
+        return vector_to(_sprite_dx(s), _sprite_dy(s));
+    }
+
+    static inline void _sprite_set_velocity(sprite s, const vector_2d &value)
+    {
+        _sprite_dx(s) = value.x;
+        _sprite_dy(s) = value.y;
+    }
+
+    static void _sprite_world_add(sprite s)
+    {
+        _sprite_world &world = _sprite_worlds[&s->pack];
+
+        s->world = &world;
+        s->slot = world.owners.size();
+
+        world.x.push_back(0);
+        world.y.push_back(0);
+        world.dx.push_back(0);
+        world.dy.push_back(0);
+        world.rotation.push_back(0);
+        world.scale.push_back(1);
+        world.owners.push_back(s);
+    }
+
+    static void _sprite_world_remove(sprite s)
+    {
+        _sprite_world &world = *s->world;
+        size_t idx = s->slot, last = world.owners.size() - 1;
+
+        if ( idx != last )
+        {
+            world.x[idx] = world.x[last];
+            world.y[idx] = world.y[last];
+            world.dx[idx] = world.dx[last];
+            world.dy[idx] = world.dy[last];
+            world.rotation[idx] = world.rotation[last];
+            world.scale[idx] = world.scale[last];
+            world.owners[idx] = world.owners[last];
+            world.owners[idx]->slot = idx;
+        }
+
+        world.x.pop_back();
+        world.y.pop_back();
+        world.dx.pop_back();
+        world.dy.pop_back();
+        world.rotation.pop_back();
+        world.scale.pop_back();
+        world.owners.pop_back();
+
+        s->world = nullptr;
+    }
+
+    //
+    // Move every sprite in the world by its velocity, as move_sprite does,
+    // rotating the velocity by the sprite's rotation.
+    //
+    static void _move_sprite_range(_sprite_world &world, size_t begin, size_t end, float pct)
+    {
+        double *x = world.x.data(), *y = world.y.data();
+        const double *dx = world.dx.data(), *dy = world.dy.data();
+        const float *rotation = world.rotation.data();
+        const bool fast = fast_trigonometry();
+
+        for (size_t i = begin; i < end; i++)
+        {
+            double mx = dx[i], my = dy[i];
+
+            if ( rotation[i] != 0 )
+            {
+                // matches matrix_multiply(rotation_matrix(angle), velocity)
+                double c, sn;
+                if ( fast )
+                {
+                    float fs, fc;
+                    sine_and_cosine(-rotation[i], fs, fc);
+                    sn = fs;
+                    c = fc;
+                }
+                else
+                {
+                    double rads = deg_to_rad(-rotation[i]);
+                    c = cos(rads);
+                    sn = sin(rads);
+                }
+                mx = dx[i] * c + dy[i] * sn;
+                my = dy[i] * c - dx[i] * sn;
+            }
+
+            x[i] += pct * mx;
+            y[i] += pct * my;
+        }
+    }
+
+    static void _move_sprite_world(_sprite_world &world, float pct)
+    {
+        _move_sprite_range(world, 0, world.owners.size(), pct);
+    }
+
+    static inline void _move_sprite_slot(_sprite_world &world, size_t slot, float pct)
+    {
+        _move_sprite_range(world, slot, slot + 1, pct);
+    }
+
+    //-----------------------------------------------------------------------------
+    // Broad phase collision grid
+    //-----------------------------------------------------------------------------
+
+    // The size of each cell in the spatial hash used to find sprites that may collide
+#define SPRITE_GRID_CELL_SIZE 128
+
+    struct _sprite_grid_entry
+    {
+        rectangle rect;             // The collision rectangle when last checked
+        int x0, y0, x1, y1;         // The grid cells covered by the rectangle
+    };
+
+    struct _sprite_grid
+    {
+        unordered_map<int64_t, vector<sprite>>      cells;
+        unordered_map<sprite, _sprite_grid_entry>   entries;
+    };
+
+    // Each sprite pack has its own grid, keyed by the pack
+    unordered_map<const vector<void *> *, _sprite_grid> _sprite_grids;
+
+    int64_t _sprite_grid_key(int x, int y)
+    {
+        return (static_cast<int64_t>(x) << 32) | static_cast<uint32_t>(y);
+    }
+
+    void _sprite_grid_cells(const rectangle &rect, _sprite_grid_entry &entry)
+    {
+        entry.x0 = static_cast<int>(floor(rect.x / SPRITE_GRID_CELL_SIZE));
+        entry.y0 = static_cast<int>(floor(rect.y / SPRITE_GRID_CELL_SIZE));
+        entry.x1 = static_cast<int>(floor((rect.x + rect.width) / SPRITE_GRID_CELL_SIZE));
+        entry.y1 = static_cast<int>(floor((rect.y + rect.height) / SPRITE_GRID_CELL_SIZE));
+    }
+
+    void _sprite_grid_remove(_sprite_grid &grid, sprite s, const _sprite_grid_entry &entry)
+    {
+        for (int y = entry.y0; y <= entry.y1; y++)
+        {
+            for (int x = entry.x0; x <= entry.x1; x++)
+            {
+                auto cell = grid.cells.find(_sprite_grid_key(x, y));
+                if ( cell == grid.cells.end() ) continue;
+
+                vector<sprite> &sprites = cell->second;
+                for (size_t i = 0; i < sprites.size(); i++)
+                {
+                    if ( sprites[i] == s )
+                    {
+                        sprites[i] = sprites.back();
+                        sprites.pop_back();
+                        break;
+                    }
+                }
+
+                if ( sprites.empty() ) grid.cells.erase(cell);
+            }
+        }
+    }
+
+    void _remove_sprite_from_grid(sprite s)
+    {
+        auto grid = _sprite_grids.find(&s->pack);
+        if ( grid == _sprite_grids.end() ) return;
+
+        auto entry = grid->second.entries.find(s);
+        if ( entry == grid->second.entries.end() ) return;
+
+        _sprite_grid_remove(grid->second, s, entry->second);
+        grid->second.entries.erase(entry);
+    }
+
     //-----------------------------------------------------------------------------
     // Event Utility Code
     //-----------------------------------------------------------------------------
 
+    //
+    // When batching, events are queued as they are raised and handed to the
+    // handlers together by dispatch_sprite_events, each global handler
+    // being called for all of the events in turn.
+    //
+    struct _queued_sprite_event
+    {
+        sprite              s;      // nullptr once the sprite is freed
+        sprite_event_kind   evt;
+    };
+
+    static bool _batch_sprite_events = false;
+    static bool _coalesce_sprite_events = false;
+    static vector<_queued_sprite_event> _queued_sprite_events;
+    static vector<_queued_sprite_event> *_dispatching_sprite_events = nullptr;
+
+    static void _forget_queued_sprite_events(sprite s)
+    {
+        for (_queued_sprite_event &e : _queued_sprite_events)
+            if ( e.s == s ) e.s = nullptr;
+
+        if ( _dispatching_sprite_events )
+            for (_queued_sprite_event &e : *_dispatching_sprite_events)
+                if ( e.s == s ) e.s = nullptr;
+    }
+
+    void set_sprite_event_batching(bool value)
+    {
+        _batch_sprite_events = value;
+        if ( not value ) dispatch_sprite_events();
+    }
+
+    bool sprite_event_batching()
+    {
+        return _batch_sprite_events;
+    }
+
+    void set_sprite_event_coalescing(bool value)
+    {
+        _coalesce_sprite_events = value;
+    }
+
+    bool sprite_event_coalescing()
+    {
+        return _coalesce_sprite_events;
+    }
+
+    void dispatch_sprite_events()
+    {
+        // Loop until no more events are queued by handlers. The batch is
+        // reused between frames, so dispatching does not allocate.
+        static vector<_queued_sprite_event> batch;
+
+        // dispatching from a handler is left to the dispatch already running
+        if ( _dispatching_sprite_events ) return;
+
+        while ( not _queued_sprite_events.empty() )
+        {
+            batch.swap(_queued_sprite_events);
+            _queued_sprite_events.clear();
+            _dispatching_sprite_events = &batch;
+
+            for (const _queued_sprite_event &e : batch)
+                if ( e.s ) e.s->queued_events = 0;
+
+            // this sprite"s event handlers
+            for (size_t i = 0; i < batch.size(); i++)
+            {
+                sprite s = batch[i].s;
+                if ( not s ) continue;
+
+                for (size_t j = 0; batch[i].s and j < s->evts.size(); j++)
+                {
+                    s->evts[j](s, batch[i].evt);
+                }
+            }
+
+            // global sprite event handlers, a handler at a time
+            for (size_t h = 0; h < _global_sprite_event_handlers.size(); h++)
+            {
+                sprite_event_handler *handler = _global_sprite_event_handlers[h];
+
+                for (size_t i = 0; i < batch.size(); i++)
+                {
+                    if ( batch[i].s ) handler(batch[i].s, batch[i].evt);
+                }
+            }
+
+            _dispatching_sprite_events = nullptr;
+            batch.clear();
+        }
+    }
+
     //
     // loop through all event listeners and notif(y them of the event )
     //
@@ -105,6 +526,23 @@ namespace splashkit_lib
             LOG(WARNING) << "Attempting to use invalid sprite";
             return;
         }
+
+        if ( _deferred_sprite_events )
+        {
+            _deferred_sprite_events->push_back({ s, _deferred_sprite_idx, evt, nullptr });
+            return;
+        }
+
+        if ( _batch_sprite_events )
+        {
+            unsigned int bit = 1u << evt;
+            if ( _coalesce_sprite_events and (s->queued_events & bit) ) return;
+
+            s->queued_events |= bit;
+            _queued_sprite_events.push_back({ s, evt });
+            return;
+        }
+
         int i;
 
         // this sprite"s event handlers
@@ -188,24 +626,27 @@ namespace splashkit_lib
         result->layer_names["base_layer"] = 0;
         result->layers.push_back(layer);
         result->layer_offsets.push_back(vector_to(0,0));
+        result->cache_layers = false;
 
         result->anchor_point = point_at(bitmap_width(layer) / 2, bitmap_height(layer) / 2);
         result->position_at_anchor_point = false;
         result->draw_at_anchor_point = false;
+        result->z_index = 0;
+        result->shape.dirty = true;
+        result->queued_events = 0;
 
         // Set the first layer as visible.
         result->visible_layers.push_back(0);                //The first layer (at idx 0) is drawn
 
-        // Setup the values
-        result->values[MASS_KEY] = 1;
-        result->values[ROTATION_KEY] = 0;
-        result->values[SCALE_KEY] = 1;
+        // Setup the values, the world holds the rotation and scale
+        result->values.assign(SCALE_VALUE_ID + 1, 0);
+        result->has_values.assign(SCALE_VALUE_ID + 1, false);
+        result->values[MASS_VALUE_ID] = 1;
+        result->has_values[MASS_VALUE_ID] = true;
+        result->value_count = 1;
 
-        // Position the sprite
-        result->position = point_at(0,0);
-
-        // Initialise sprite movement
-        result->velocity = vector_to(0,0);
+        // Position the sprite at the origin, with no movement, rotation or scaling
+        _sprite_world_add(result);
 
         // Setup animation detials
         result->script         = ani;
@@ -231,7 +672,7 @@ namespace splashkit_lib
         result->last_update = timer_ticks(_sprite_timer);
 
         // Write_ln("adding for ", name, " ", Hex_str(obj));
-        _sprites[name] = result;
+        _sprites.set(name, result);
 
         current_pack().push_back(result);
 
@@ -252,6 +693,9 @@ namespace splashkit_lib
     // Free sprites
     //-----------------------------------------------------------------------------
 
+    static void _remove_sprite_tweens(sprite s);
+    static void _forget_layer_cache(sprite s);
+
     void free_sprite(sprite s)
     {
         if( (INVALID_PTR(s, SPRITE_PTR)) )
@@ -272,8 +716,14 @@ namespace splashkit_lib
 
         //Free buffered rotation image
         s->collision_bitmap = nullptr;
+        _forget_layer_cache(s);
 
-        if( ( not erase_from_vector(s->pack, static_cast<void *>(s)) ) )
+        _remove_sprite_from_grid(s);
+        _remove_sprite_tweens(s);
+        _forget_queued_sprite_events(s);
+        _sprite_world_remove(s);
+
+        if( ( not _remove_from_pack(s->pack, static_cast<void *>(s)) ) )
         {
             LOG(WARNING) << "Error removing sprite from sprite pack!";
         }
@@ -288,7 +738,7 @@ namespace splashkit_lib
 
     void free_all_sprites()
     {
-        FREE_ALL_FROM_MAP(_sprites, SPRITE_PTR, free_sprite);
+        FREE_ALL_FROM_REGISTRY(_sprites, SPRITE_PTR, free_sprite);
     }
 
     //-----------------------------------------------------------------------------
@@ -297,15 +747,12 @@ namespace splashkit_lib
 
     bool has_sprite(const string &name)
     {
-        return _sprites.count(name) > 0;
+        return _sprites.contains(name);
     }
 
     sprite sprite_named(const string &name)
     {
-        if( (has_sprite(name)) )
-            return _sprites[name];
-        else
-            return nullptr;
+        return _sprites.find(name);
     }
 
     //-----------------------------------------------------------------------------
@@ -426,6 +873,7 @@ namespace splashkit_lib
 
         //Extend layers and add index
         s->visible_layers.push_back(id);
+        _forget_layer_cache(s);
 
         return static_cast<int>(s->visible_layers.size() - 1);
     }
@@ -443,7 +891,10 @@ namespace splashkit_lib
         if ( not sprite_has_layer(s, id) )
             return;
 
+        if ( sprite_visible_index_of_layer(s, id) < 0 ) return;
+
         erase_from_vector(s->visible_layers, id);
+        _forget_layer_cache(s);
     }
 
     void sprite_toggle_layer_visible(sprite s, const string &name)
@@ -525,6 +976,7 @@ namespace splashkit_lib
         if ( not sprite_has_layer(s, idx) )
             return;
         s->layer_offsets[idx] = value;
+        if ( sprite_visible_index_of_layer(s, idx) >= 0 ) _forget_layer_cache(s);
     }
 
     int sprite_visible_index_of_layer(sprite s, const string &name)
@@ -553,6 +1005,7 @@ namespace splashkit_lib
 
         if ( visible_layer < s->visible_layers.size() - 1 )
             move_range(s->visible_layers, sprite_visible_index_of_layer(s, visible_layer), 1, s->visible_layers.size() - 1 );
+        _forget_layer_cache(s);
     }
 
     void sprite_send_layer_backward(sprite s, int visible_layer)
@@ -561,6 +1014,7 @@ namespace splashkit_lib
 
         if ( visible_layer < s->visible_layers.size() - 1 )
             swap(s->visible_layers[visible_layer], s->visible_layers[visible_layer + 1]);
+        _forget_layer_cache(s);
     }
 
     void sprite_bring_layer_forward(sprite s, int visible_layer)
@@ -569,6 +1023,7 @@ namespace splashkit_lib
 
         if ( visible_layer > 0 )
             swap(s->visible_layers[visible_layer], s->visible_layers[visible_layer - 1]);
+        _forget_layer_cache(s);
     }
 
     void sprite_bring_layer_to_front(sprite s, int visible_layer)
@@ -577,6 +1032,7 @@ namespace splashkit_lib
 
         if ( visible_layer > 0 )
             move_range(s->visible_layers, sprite_visible_index_of_layer(s, visible_layer), 1, 0 );
+        _forget_layer_cache(s);
     }
 
     rectangle sprite_layer_rectangle(sprite s, const string &name)
@@ -592,7 +1048,7 @@ namespace splashkit_lib
         if ( not sprite_has_layer(s, idx) )
             return rectangle_from(0,0,0,0);
         else
-            return bitmap_cell_rectangle(s->layers[idx], point_offset_by(s->position, s->layer_offsets[idx]));
+            return bitmap_cell_rectangle(s->layers[idx], point_offset_by(point_at(_sprite_x(s), _sprite_y(s)), s->layer_offsets[idx]));
     }
 
     circle sprite_circle(sprite s)
@@ -664,8 +1120,8 @@ namespace splashkit_lib
         }
 
         return point_at(
-                        s->position.x + sprite_width(s) / 2.0f,
-                        s->position.y + sprite_height(s) / 2.0f);
+                        _sprite_x(s) + sprite_width(s) / 2.0f,
+                        _sprite_y(s) + sprite_height(s) / 2.0f);
     }
 
     //-----------------------------------------------------------------------------
@@ -816,6 +1272,38 @@ namespace splashkit_lib
     // Update Sprites
     //-----------------------------------------------------------------------------
 
+    //
+    // The rest of update_sprite, once the sprite has moved by its velocity
+    //
+    static void _finish_sprite_update(sprite s, float pct, bool with_sound, bool clicked, const point_2d &mouse)
+    {
+        if ( with_sound and _deferred_sprite_events )
+        {
+            update_sprite_animation(s, pct, false);
+
+            sound_effect snd = _animation_entered_frame_sound(s->animation_info);
+            if ( snd ) _deferred_sprite_events->push_back({ s, _deferred_sprite_idx, SPRITE_ARRIVED_EVENT, snd });
+        }
+        else
+            update_sprite_animation(s, pct, with_sound);
+
+        //   if mouse_clicked(LEFT_BUTTON) and circle_circle_collision(sprite_collision_circle(s), circle_at(mouse_x(), mouse_y(), 17))
+        //   {
+        //     sprite_raise_event(s, sprite_touched_event);
+        //   }
+
+        if ( clicked and circles_intersect(sprite_collision_circle(s), circle_at(mouse, 1)))
+        {
+            sprite_raise_event(s, SPRITE_CLICKED_EVENT);
+        }
+
+        if ( sprite_animation_has_ended(s) and (not s->announced_animation_end) )
+        {
+            s->announced_animation_end = true;
+            sprite_raise_event(s, SPRITE_ANIMATION_ENDED_EVENT);
+        }
+    }
+
     void update_sprite(sprite s)
     {
         update_sprite(s, 1.0, true);
@@ -836,29 +1324,87 @@ namespace splashkit_lib
         if ( VALID_PTR(s, SPRITE_PTR) )
         {
             move_sprite(s, pct);
-            update_sprite_animation(s, pct, with_sound);
+            _finish_sprite_update(s, pct, with_sound, mouse_clicked(LEFT_BUTTON), mouse_position());
+        }
+    }
 
-            //   if mouse_clicked(LEFT_BUTTON) and circle_circle_collision(sprite_collision_circle(s), circle_at(mouse_x(), mouse_y(), 17))
-            //   {
-            //     sprite_raise_event(s, sprite_touched_event);
-            //   }
+    //-----------------------------------------------------------------------------
+    // Sprite drawing
+    //-----------------------------------------------------------------------------
 
-            if ( mouse_clicked(LEFT_BUTTON) and circles_intersect(sprite_collision_circle(s), circle_at(mouse_x(), mouse_y(), 1)))
-            {
-                sprite_raise_event(s, SPRITE_CLICKED_EVENT);
-            }
+    //
+    // The composited layers are render targets, so releasing them when the
+    // visible layers change lets the next composite reuse their textures.
+    //
+    static void _forget_layer_cache(sprite s)
+    {
+        for (auto &item : s->layer_cache)
+        {
+            release_render_target(item.second);
+        }
+        s->layer_cache.clear();
+    }
+
+    // The visible layers of the sprite's current cell, drawn into one bitmap
+    static bitmap _sprite_layer_cache(sprite s)
+    {
+        int cell = VALID_PTR(s->animation_info, ANIMATION_PTR) ? animation_current_cell(s->animation_info) : -1;
+
+        auto it = s->layer_cache.find(cell);
+        if ( it != s->layer_cache.end() ) return it->second;
 
-            if ( sprite_animation_has_ended(s) and (not s->announced_animation_end) )
+        if ( s->layer_cache.empty() )
+        {
+            // the cells of each layer are the same size, so all cells cover the same area
+            bool first = true;
+            for (int idx : s->visible_layers)
             {
-                s->announced_animation_end = true;
-                sprite_raise_event(s, SPRITE_ANIMATION_ENDED_EVENT);
+                rectangle r = rectangle_from(s->layer_offsets[idx].x, s->layer_offsets[idx].y, sprite_layer_width(s, idx), sprite_layer_height(s, idx));
+                if ( first )
+                    s->layer_cache_area = r;
+                else
+                {
+                    double right = std::max(s->layer_cache_area.x + s->layer_cache_area.width, r.x + r.width);
+                    double bottom = std::max(s->layer_cache_area.y + s->layer_cache_area.height, r.y + r.height);
+                    s->layer_cache_area.x = std::min(s->layer_cache_area.x, r.x);
+                    s->layer_cache_area.y = std::min(s->layer_cache_area.y, r.y);
+                    s->layer_cache_area.width = right - s->layer_cache_area.x;
+                    s->layer_cache_area.height = bottom - s->layer_cache_area.y;
+                }
+                first = false;
             }
         }
+
+        const rectangle &area = s->layer_cache_area;
+        bitmap result = acquire_render_target(static_cast<int>(ceil(area.width)), static_cast<int>(ceil(area.height)));
+        if ( result == nullptr ) return nullptr;
+
+        drawing_options opts = option_draw_to(result);
+        opts.draw_cell = cell;
+
+        for (int idx : s->visible_layers)
+        {
+            draw_bitmap(s->layers[idx], s->layer_offsets[idx].x - area.x, s->layer_offsets[idx].y - area.y, opts);
+        }
+
+        s->layer_cache[cell] = result;
+        return result;
     }
 
-    //-----------------------------------------------------------------------------
-    // Sprite drawing
-    //-----------------------------------------------------------------------------
+    bool sprite_caches_layers(sprite s)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) ) return false;
+        return s->cache_layers;
+    }
+
+    void sprite_set_caches_layers(sprite s, bool value)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) ) return;
+
+        // setting it again redraws the cache, for when the layer bitmaps have been drawn on
+        _forget_layer_cache(s);
+        s->cache_layers = value;
+    }
 
     void draw_sprite(sprite s)
     {
@@ -878,38 +1424,61 @@ namespace splashkit_lib
             return;
         }
 
+        // set in place, rather than copied through each of the option functions
+        drawing_options opts = option_defaults();
+
+        float scale = sprite_scale(s);
+        opts.scale_x = scale;
+        opts.scale_y = scale;
+
+        double x = _sprite_x(s) + x_offset;
+        double y = _sprite_y(s) + y_offset;
+        if ( s->draw_at_anchor_point )
+        {
+            x -= s->anchor_point.x;
+            y -= s->anchor_point.y;
+        }
+
         float angle = sprite_rotation(s);
-        drawing_options opts;
 
-        if (angle != 0)
-            opts = option_rotate_bmp( angle,
-                                     s->anchor_point.x - sprite_layer_width(s, 0) / 2.0f,
-                                     s->anchor_point.y  - sprite_layer_height(s, 0) / 2.0f );
-        else
-            opts = option_defaults();
+        if ( s->cache_layers and s->visible_layers.size() > 1 )
+        {
+            bitmap composite = _sprite_layer_cache(s);
+            if ( composite )
+            {
+                const rectangle &area = s->layer_cache_area;
+
+                // rotate around the anchor point, as the layers do when drawn one by one
+                if (angle != 0)
+                {
+                    opts.angle = angle;
+                    opts.anchor_offset_x = s->layer_offsets[0].x + s->anchor_point.x - area.x - area.width / 2.0f;
+                    opts.anchor_offset_y = s->layer_offsets[0].y + s->anchor_point.y - area.y - area.height / 2.0f;
+                }
+
+                draw_bitmap(composite, x + area.x, y + area.y, opts);
+                return;
+            }
+        }
 
-        float scale = sprite_scale(s);
-        if (scale != 1)
-            opts = option_scale_bmp( scale, scale, opts );
+        if (angle != 0)
+        {
+            opts.angle = angle;
+            opts.anchor_offset_x = s->anchor_point.x - sprite_layer_width(s, 0) / 2.0f;
+            opts.anchor_offset_y = s->anchor_point.y - sprite_layer_height(s, 0) / 2.0f;
+        }
 
-        opts = option_with_animation( s->animation_info, opts );
+        opts.anim = s->animation_info;
 
         int idx;
         for (int i = 0; i < s->visible_layers.size(); i++)
         {
             idx = s->visible_layers[i];
-            if ( s->draw_at_anchor_point )
-                draw_bitmap(
-                            sprite_layer(s, idx),
-                            s->position.x - s->anchor_point.x + x_offset + s->layer_offsets[idx].x,
-                            s->position.y -s->anchor_point.y + y_offset + s->layer_offsets[idx].y,
-                            opts);
-            else
-                draw_bitmap(
-                            sprite_layer(s, idx),
-                            s->position.x + x_offset + s->layer_offsets[idx].x,
-                            s->position.y + y_offset + s->layer_offsets[idx].y,
-                            opts);
+            draw_bitmap(
+                        sprite_layer(s, idx),
+                        x + s->layer_offsets[idx].x,
+                        y + s->layer_offsets[idx].y,
+                        opts);
         }
     }
 
@@ -939,6 +1508,7 @@ namespace splashkit_lib
         if ( VALID_PTR(s, SPRITE_PTR) )
         {
             s->anchor_point = pt;
+            s->shape.dirty = true;
         }
         else
         {
@@ -959,17 +1529,44 @@ namespace splashkit_lib
     // Sprite Movement
     //-----------------------------------------------------------------------------
 
-    void move_sprite(sprite s, const vector_2d &distance )
-    {
-        move_sprite(s, distance, 1.0);
-    }
-
-    void move_sprite(sprite s, const vector_2d &distance, float pct)
+    //
+    // Advance a sprite heading to the destination given to sprite_move_to
+    //
+    static void _step_sprite_move_to(sprite s)
     {
-        if ( INVALID_PTR(s, SPRITE_PTR) )
+        if ( s->is_moving )
         {
-            LOG(WARNING) << "No sprite supplied to move_sprite";
-            return;
+            float pct = (timer_ticks(_sprite_timer) - s->last_update) / 1000;
+
+            if ( pct <= 0 ) return;
+
+            s->last_update = timer_ticks(_sprite_timer);
+
+            _sprite_x(s) += pct * s->moving_vec.x;
+            _sprite_y(s) += pct * s->moving_vec.y;
+
+            s->arrive_in_sec -= pct;
+            if ( s->arrive_in_sec <= 0 )
+            {
+                s->is_moving = false;
+                s->arrive_in_sec = 0;
+
+                sprite_raise_event(s, SPRITE_ARRIVED_EVENT);
+            }
+        }
+    }
+
+    void move_sprite(sprite s, const vector_2d &distance )
+    {
+        move_sprite(s, distance, 1.0);
+    }
+
+    void move_sprite(sprite s, const vector_2d &distance, float pct)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) )
+        {
+            LOG(WARNING) << "No sprite supplied to move_sprite";
+            return;
         }
 
         vector_2d mvmt;
@@ -985,29 +1582,10 @@ namespace splashkit_lib
             mvmt = distance;
         }
 
-        s->position.x += pct * mvmt.x;
-        s->position.y += pct * mvmt.y;
-
-        if ( s->is_moving )
-        {
-            pct = (timer_ticks(_sprite_timer) - s->last_update) / 1000;
-
-            if ( pct <= 0 ) return;
-
-            s->last_update = timer_ticks(_sprite_timer);
-
-            s->position.x += pct * s->moving_vec.x;
-            s->position.y += pct * s->moving_vec.y;
+        _sprite_x(s) += pct * mvmt.x;
+        _sprite_y(s) += pct * mvmt.y;
 
-            s->arrive_in_sec -= pct;
-            if ( s->arrive_in_sec <= 0 )
-            {
-                s->is_moving = false;
-                s->arrive_in_sec = 0;
-
-                sprite_raise_event(s, SPRITE_ARRIVED_EVENT);
-            }
-        }
+        _step_sprite_move_to(s);
     }
 
     void move_sprite_to(sprite s, double x, double y)
@@ -1018,13 +1596,13 @@ namespace splashkit_lib
             return;
         }
 
-        s->position.x = x;
-        s->position.y = y;
+        _sprite_x(s) = x;
+        _sprite_y(s) = y;
 
         if (s->position_at_anchor_point)
         {
-            s->position.x -= s->anchor_point.x;
-            s->position.y -= s->anchor_point.y;
+            _sprite_x(s) -= s->anchor_point.x;
+            _sprite_y(s) -= s->anchor_point.y;
         }
     }
 
@@ -1036,7 +1614,7 @@ namespace splashkit_lib
     void move_sprite(sprite s, float pct)
     {
         if ( VALID_PTR(s, SPRITE_PTR) )
-            move_sprite(s, s->velocity, pct);
+            move_sprite(s, _sprite_velocity(s), pct);
     }
 
     vector_2d sprite_velocity(sprite s)
@@ -1047,7 +1625,7 @@ namespace splashkit_lib
             return vector_to(0,0);
         }
 
-        return s->velocity;
+        return _sprite_velocity(s);
     }
 
     void sprite_set_velocity(sprite s, const vector_2d &value)
@@ -1058,7 +1636,7 @@ namespace splashkit_lib
             return;
         }
 
-        s->velocity = value;
+        _sprite_set_velocity(s, value);
     }
 
     void sprite_add_to_velocity(sprite s, const vector_2d &value)
@@ -1069,7 +1647,7 @@ namespace splashkit_lib
             return;
         }
 
-        s->velocity = vector_add(s->velocity, value);
+        _sprite_set_velocity(s, vector_add(_sprite_velocity(s), value));
     }
 
     void sprite_set_x(sprite s, float value)
@@ -1080,7 +1658,7 @@ namespace splashkit_lib
             return;
         }
 
-        s->position.x = value;
+        _sprite_x(s) = value;
     }
 
     float sprite_x(sprite s)
@@ -1091,7 +1669,7 @@ namespace splashkit_lib
             return 0;
         }
 
-        return s->position.x;
+        return _sprite_x(s);
     }
 
     void sprite_set_y(sprite s, float value)
@@ -1102,7 +1680,7 @@ namespace splashkit_lib
             return;
         }
 
-        s->position.y = value;
+        _sprite_y(s) = value;
     }
 
     float sprite_y(sprite s)
@@ -1113,7 +1691,7 @@ namespace splashkit_lib
             return 0;
         }
 
-        return s->position.y;
+        return _sprite_y(s);
     }
 
     point_2d sprite_position(sprite s)
@@ -1125,15 +1703,44 @@ namespace splashkit_lib
         }
         else
         {
-            return s->position;
+            return point_at(_sprite_x(s), _sprite_y(s));
         }
     }
 
+    void sprite_positions(const vector<sprite> &sprites, vector<point_2d> &out_positions)
+    {
+        bool invalid = false;
+        out_positions.resize(sprites.size());
+
+        for (size_t i = 0; i < sprites.size(); i++)
+        {
+            sprite s = sprites[i];
+            if ( INVALID_PTR(s, SPRITE_PTR) )
+            {
+                invalid = true;
+                out_positions[i] = point_at(0, 0);
+            }
+            else
+                out_positions[i] = point_at(_sprite_x(s), _sprite_y(s));
+        }
+
+        if ( invalid )
+            LOG(WARNING) << "Attempting to get the positions of invalid sprites";
+    }
+
+    vector<point_2d> sprite_positions(const vector<sprite> &sprites)
+    {
+        vector<point_2d> result;
+        sprite_positions(sprites, result);
+        return result;
+    }
+
     void sprite_set_position(sprite s, const point_2d &value)
     {
         if ( VALID_PTR(s, SPRITE_PTR) )
         {
-            s->position = value;
+            _sprite_x(s) = value.x;
+            _sprite_y(s) = value.y;
         }
         else
         {
@@ -1145,7 +1752,7 @@ namespace splashkit_lib
     {
         if ( VALID_PTR(s, SPRITE_PTR) )
         {
-            s->velocity.x = value;
+            _sprite_dx(s) = value;
         }
         else
         {
@@ -1162,7 +1769,7 @@ namespace splashkit_lib
         }
         else
         {
-            return s->velocity.x;
+            return _sprite_dx(s);
         }
 
     }
@@ -1171,7 +1778,7 @@ namespace splashkit_lib
     {
         if ( VALID_PTR(s, SPRITE_PTR) )
         {
-            s->velocity.y = value;
+            _sprite_dy(s) = value;
         }
         else
         {
@@ -1188,7 +1795,7 @@ namespace splashkit_lib
         }
         else
         {
-            return s->velocity.y;
+            return _sprite_dy(s);
         }
     }
 
@@ -1197,13 +1804,13 @@ namespace splashkit_lib
         if ( INVALID_PTR(s, SPRITE_PTR) )
             return 0;
         else
-            return vector_magnitude(s->velocity);
+            return vector_magnitude(_sprite_velocity(s));
     }
 
     void sprite_set_speed(sprite s, float value)
     {
         if ( VALID_PTR(s, SPRITE_PTR) )
-            s->velocity = vector_multiply(unit_vector(s->velocity), value);
+            _sprite_set_velocity(s, vector_multiply(unit_vector(_sprite_velocity(s)), value));
     }
 
     float sprite_heading(sprite s)
@@ -1211,13 +1818,13 @@ namespace splashkit_lib
         if ( INVALID_PTR(s, SPRITE_PTR) )
             return 0;
         else
-            return vector_angle(s->velocity);
+            return vector_angle(_sprite_velocity(s));
     }
 
     void sprite_set_heading(sprite s, float value)
     {
         if ( VALID_PTR(s, SPRITE_PTR) )
-            s->velocity = vector_from_angle(value, vector_magnitude(s->velocity));
+            _sprite_set_velocity(s, vector_from_angle(value, vector_magnitude(_sprite_velocity(s))));
     }
 
     bool sprite_move_from_anchor_point(sprite s)
@@ -1263,6 +1870,33 @@ namespace splashkit_lib
         s->last_update = timer_ticks(_sprite_timer);
     }
 
+    //
+    // Clear the sprite's cached shapes if the sprite has changed since they
+    // were worked out.
+    //
+    static _sprite_shape_cache &_sprite_shape(sprite s)
+    {
+        _sprite_shape_cache &c = s->shape;
+        int w = sprite_layer_width(s, 0), h = sprite_layer_height(s, 0);
+
+        if ( c.dirty or c.x != _sprite_x(s) or c.y != _sprite_y(s) or
+             c.rotation != _sprite_rotation(s) or c.scale != _sprite_scale(s) or
+             c.w != w or c.h != h )
+        {
+            c.dirty = false;
+            c.x = _sprite_x(s);
+            c.y = _sprite_y(s);
+            c.rotation = _sprite_rotation(s);
+            c.scale = _sprite_scale(s);
+            c.w = w;
+            c.h = h;
+            c.has_location = false;
+            c.has_collision_rect = false;
+        }
+
+        return c;
+    }
+
     matrix_2d sprite_location_matrix(sprite s)
     {
         matrix_2d result = identity_matrix();
@@ -1273,6 +1907,9 @@ namespace splashkit_lib
             return result;
         }
 
+        _sprite_shape_cache &cache = _sprite_shape(s);
+        if ( cache.has_location ) return cache.location;
+
         float scale = sprite_scale(s);
         float w = sprite_layer_width(s, 0);
         float h = sprite_layer_height(s, 0);
@@ -1287,7 +1924,9 @@ namespace splashkit_lib
         float new_y = sprite_y(s) - (h * scale / 2.0) + (h / 2.0);
         result = matrix_multiply(result, translation_matrix(new_x / scale, new_y / scale));
 
-        return matrix_multiply(result, scale_matrix(scale));
+        cache.location = matrix_multiply(result, scale_matrix(scale));
+        cache.has_location = true;
+        return cache.location;
     }
 
     //---------------------------------------------------------------------------
@@ -1303,7 +1942,7 @@ namespace splashkit_lib
         }
         else
         {
-            return s->values[MASS_KEY];
+            return s->values[MASS_VALUE_ID];
         }
 
     }
@@ -1311,7 +1950,7 @@ namespace splashkit_lib
     void sprite_set_mass(sprite s, float value)
     {
         if ( VALID_PTR(s, SPRITE_PTR) )
-            s->values[MASS_KEY] = value;
+            s->values[MASS_VALUE_ID] = value;
     }
 
     float sprite_rotation(sprite s)
@@ -1323,7 +1962,7 @@ namespace splashkit_lib
         }
         else
         {
-            return s->values[ROTATION_KEY];
+            return _sprite_rotation(s);
         }
 
     }
@@ -1342,7 +1981,7 @@ namespace splashkit_lib
                 value = value - trunc(value / 360) * 360;
             }
 
-            s->values[ROTATION_KEY] = value;
+            _sprite_rotation(s) = value;
         }
         else
         {
@@ -1355,17 +1994,60 @@ namespace splashkit_lib
         if ( INVALID_PTR(s, SPRITE_PTR) )
             return 0;
         else
-            return s->values[SCALE_KEY];
+            return _sprite_scale(s);
     }
 
     void sprite_set_scale(sprite s, float value)
     {
         if ( VALID_PTR(s, SPRITE_PTR) )
         {
-            s->values[SCALE_KEY] = value;
+            _sprite_scale(s) = value;
+        }
+    }
+
+    int sprite_z_index(sprite s)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to use invalid sprite";
+            return 0;
+        }
+
+        return s->z_index;
+    }
+
+    void sprite_set_z_index(sprite s, int value)
+    {
+        if ( VALID_PTR(s, SPRITE_PTR) )
+        {
+            s->z_index = value;
         }
     }
 
+    // Rotation and scale are kept with the sprite's position
+    static inline bool _sprite_has_value(sprite s, int id)
+    {
+        return id == ROTATION_VALUE_ID or id == SCALE_VALUE_ID or
+               (id >= 0 and id < static_cast<int>(s->has_values.size()) and s->has_values[id]);
+    }
+
+    static inline float &_sprite_value(sprite s, int id)
+    {
+        if ( id == ROTATION_VALUE_ID ) return _sprite_rotation(s);
+        if ( id == SCALE_VALUE_ID ) return _sprite_scale(s);
+        return s->values[id];
+    }
+
+    int sprite_value_id(const string &name)
+    {
+        int id = _find_sprite_value_id(name);
+        if ( id >= 0 ) return id;
+
+        id = _sprite_value_id_count++;
+        _sprite_value_ids[name] = id;
+        return id;
+    }
+
     int sprite_value_count(sprite s)
     {
         if ( INVALID_PTR(s, SPRITE_PTR) )
@@ -1374,10 +2056,15 @@ namespace splashkit_lib
             return -1;
         }
 
-        return static_cast<int>(s->values.size());
+        return s->value_count + 2;
     }
 
-    bool sprite_has_value(sprite s, string name)
+    bool sprite_has_value(sprite s, const string &name)
+    {
+        return sprite_has_value(s, _find_sprite_value_id(name));
+    }
+
+    bool sprite_has_value(sprite s, int id)
     {
         if ( INVALID_PTR(s, SPRITE_PTR) )
         {
@@ -1385,16 +2072,22 @@ namespace splashkit_lib
             return false;
         }
 
-        return s->values.count(name) > 0;
+        return _sprite_has_value(s, id);
     }
 
     float sprite_value(sprite s, const string &name)
     {
-        if ( not sprite_has_value(s, name) )
+        return sprite_value(s, _find_sprite_value_id(name));
+    }
+
+    float sprite_value(sprite s, int id)
+    {
+        if ( not sprite_has_value(s, id) )
         {
             return 0;
         }
-        return s->values[name];
+
+        return _sprite_value(s, id);
     }
 
     void sprite_add_value(sprite s, const string &name)
@@ -1410,20 +2103,251 @@ namespace splashkit_lib
             return;
         }
 
-        if ( sprite_has_value(s, name) ) return;
+        int id = sprite_value_id(name);
+        if ( _sprite_has_value(s, id) ) return;
+
+        if ( id >= static_cast<int>(s->values.size()) )
+        {
+            s->values.resize(id + 1, 0);
+            s->has_values.resize(id + 1, false);
+        }
 
-        s->values[name] = init_val;
+        s->values[id] = init_val;
+        s->has_values[id] = true;
+        s->value_count++;
     }
 
     void sprite_set_value(sprite s, const string &name, float val)
     {
-        if ( not sprite_has_value(s, name) )
+        sprite_set_value(s, _find_sprite_value_id(name), val);
+    }
+
+    void sprite_set_value(sprite s, int id, float val)
+    {
+        if ( not sprite_has_value(s, id) )
         {
             LOG(WARNING) << "Attempting to use invalid sprite";
             return;
         }
 
-        s->values[name] = val;
+        _sprite_value(s, id) = val;
+    }
+
+    //---------------------------------------------------------------------------
+    // Sprite Tweens
+    //---------------------------------------------------------------------------
+
+    // Tweens of the sprite's position, as the value ids are never negative
+#define TWEEN_X_ID  -1
+#define TWEEN_Y_ID  -2
+
+    //
+    // All running tweens, for every sprite, kept in parallel arrays so they
+    // are advanced in one pass. Ended tweens are replaced by the last tween.
+    //
+    struct _sprite_tween_list
+    {
+        vector<sprite>      owner;
+        vector<int>         property;   // a value id, or TWEEN_X_ID / TWEEN_Y_ID
+        vector<double>      from, to;           // doubles, so positions keep their precision
+        vector<double>      elapsed, duration;  // in seconds
+        vector<easing_kind> easing;
+        vector<bool>        arrive;     // raise the arrived event, rather than tween ended, when it ends
+
+        size_t size() const { return owner.size(); }
+
+        void remove(size_t idx)
+        {
+            size_t last = owner.size() - 1;
+            owner[idx] = owner[last];           owner.pop_back();
+            property[idx] = property[last];     property.pop_back();
+            from[idx] = from[last];             from.pop_back();
+            to[idx] = to[last];                 to.pop_back();
+            elapsed[idx] = elapsed[last];       elapsed.pop_back();
+            duration[idx] = duration[last];     duration.pop_back();
+            easing[idx] = easing[last];         easing.pop_back();
+            arrive[idx] = arrive[last];         arrive.pop_back();
+        }
+    };
+
+    static _sprite_tween_list _sprite_tweens;
+    static unsigned int _sprite_tweens_last_ticks = 0;
+
+    static double _ease(easing_kind easing, double t)
+    {
+        switch (easing)
+        {
+            case EASE_IN_QUAD_EASING:       return t * t;
+            case EASE_OUT_QUAD_EASING:      return t * (2 - t);
+            case EASE_IN_OUT_QUAD_EASING:   return t < 0.5 ? 2 * t * t : -1 + (4 - 2 * t) * t;
+            case EASE_IN_CUBIC_EASING:      return t * t * t;
+            case EASE_OUT_CUBIC_EASING:     { double u = t - 1; return u * u * u + 1; }
+            case EASE_IN_OUT_CUBIC_EASING:  return t < 0.5 ? 4 * t * t * t : (t - 1) * (2 * t - 2) * (2 * t - 2) + 1;
+            case EASE_OUT_BACK_EASING:
+            {
+                const double c1 = 1.70158, c3 = c1 + 1;
+                double u = t - 1;
+                return 1 + c3 * u * u * u + c1 * u * u;
+            }
+            case EASE_OUT_BOUNCE_EASING:
+            {
+                const double n1 = 7.5625, d1 = 2.75;
+                if ( t < 1 / d1 ) return n1 * t * t;
+                if ( t < 2 / d1 ) { t -= 1.5 / d1; return n1 * t * t + 0.75; }
+                if ( t < 2.5 / d1 ) { t -= 2.25 / d1; return n1 * t * t + 0.9375; }
+                t -= 2.625 / d1;
+                return n1 * t * t + 0.984375;
+            }
+            default:                        return t;
+        }
+    }
+
+    static double _tweened_property(sprite s, int property)
+    {
+        if ( property == TWEEN_X_ID ) return _sprite_x(s);
+        if ( property == TWEEN_Y_ID ) return _sprite_y(s);
+        return _sprite_value(s, property);
+    }
+
+    // Positions are set as doubles, as sprite_set_position does. Other
+    // properties go through their setters, so rotation is kept within 0 to 360.
+    static void _set_tweened_property(sprite s, int property, double value)
+    {
+        if ( property == TWEEN_X_ID ) _sprite_x(s) = value;
+        else if ( property == TWEEN_Y_ID ) _sprite_y(s) = value;
+        else if ( property == ROTATION_VALUE_ID ) sprite_set_rotation(s, static_cast<float>(value));
+        else if ( property == SCALE_VALUE_ID ) sprite_set_scale(s, static_cast<float>(value));
+        else sprite_set_value(s, property, static_cast<float>(value));
+    }
+
+    static void _remove_sprite_tweens(sprite s)
+    {
+        for (size_t i = _sprite_tweens.size(); i > 0; i--)
+        {
+            if ( _sprite_tweens.owner[i - 1] == s )
+                _sprite_tweens.remove(i - 1);
+        }
+    }
+
+    static void _start_sprite_tween(sprite s, int property, double target, double seconds, easing_kind easing, bool arrive)
+    {
+        // a new tween of the property takes over from the old one
+        for (size_t i = _sprite_tweens.size(); i > 0; i--)
+        {
+            if ( _sprite_tweens.owner[i - 1] == s and _sprite_tweens.property[i - 1] == property )
+                _sprite_tweens.remove(i - 1);
+        }
+
+        if ( _sprite_tweens.size() == 0 )
+            _sprite_tweens_last_ticks = timer_ticks(_sprite_timer);
+
+        _sprite_tweens.owner.push_back(s);
+        _sprite_tweens.property.push_back(property);
+        _sprite_tweens.from.push_back(_tweened_property(s, property));
+        _sprite_tweens.to.push_back(target);
+        _sprite_tweens.elapsed.push_back(0);
+        _sprite_tweens.duration.push_back(seconds > 0 ? seconds : 0);
+        _sprite_tweens.easing.push_back(easing);
+        _sprite_tweens.arrive.push_back(arrive);
+    }
+
+    void sprite_tween_position(sprite s, const point_2d &pt, float seconds, easing_kind easing)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to tween invalid sprite";
+            return;
+        }
+
+        _start_sprite_tween(s, TWEEN_X_ID, pt.x, seconds, easing, false);
+        _start_sprite_tween(s, TWEEN_Y_ID, pt.y, seconds, easing, true);
+    }
+
+    void sprite_tween_rotation(sprite s, float angle, float seconds, easing_kind easing)
+    {
+        sprite_tween_value(s, ROTATION_VALUE_ID, angle, seconds, easing);
+    }
+
+    void sprite_tween_scale(sprite s, float scale, float seconds, easing_kind easing)
+    {
+        sprite_tween_value(s, SCALE_VALUE_ID, scale, seconds, easing);
+    }
+
+    void sprite_tween_value(sprite s, int value_id, float target, float seconds, easing_kind easing)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to tween invalid sprite";
+            return;
+        }
+
+        if ( not _sprite_has_value(s, value_id) )
+        {
+            LOG(WARNING) << "Attempting to tween a value the sprite " << s->name << " does not have";
+            return;
+        }
+
+        _start_sprite_tween(s, value_id, target, seconds, easing, false);
+    }
+
+    bool sprite_tweening(sprite s)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) ) return false;
+
+        for (sprite owner : _sprite_tweens.owner)
+        {
+            if ( owner == s ) return true;
+        }
+        return false;
+    }
+
+    void sprite_stop_tweens(sprite s)
+    {
+        if ( VALID_PTR(s, SPRITE_PTR) )
+            _remove_sprite_tweens(s);
+    }
+
+    void update_sprite_tweens()
+    {
+        if ( _sprite_tweens.size() == 0 ) return;
+
+        unsigned int now = timer_ticks(_sprite_timer);
+        double seconds = (now - _sprite_tweens_last_ticks) / 1000.0;
+        _sprite_tweens_last_ticks = now;
+
+        if ( seconds <= 0 ) return;
+
+        // The events are raised after the pass, as handlers may start or
+        // stop tweens
+        vector<std::pair<sprite, sprite_event_kind>> ended;
+
+        for (size_t i = 0; i < _sprite_tweens.size(); )
+        {
+            double elapsed = _sprite_tweens.elapsed[i] + seconds;
+            double duration = _sprite_tweens.duration[i];
+            double t = elapsed >= duration ? 1 : elapsed / duration;
+
+            double from = _sprite_tweens.from[i], to = _sprite_tweens.to[i];
+            _set_tweened_property(_sprite_tweens.owner[i], _sprite_tweens.property[i], from + (to - from) * _ease(_sprite_tweens.easing[i], t));
+
+            if ( t < 1 )
+            {
+                _sprite_tweens.elapsed[i] = elapsed;
+                i++;
+                continue;
+            }
+
+            // the x tween of a position ends with its y tween, which raises the event
+            if ( _sprite_tweens.property[i] != TWEEN_X_ID )
+                ended.push_back({ _sprite_tweens.owner[i], _sprite_tweens.arrive[i] ? SPRITE_ARRIVED_EVENT : SPRITE_TWEEN_ENDED_EVENT });
+
+            _sprite_tweens.remove(i);
+        }
+
+        for (auto &e : ended)
+        {
+            sprite_raise_event(e.first, e.second);
+        }
     }
 
     //---------------------------------------------------------------------------
@@ -1477,32 +2401,255 @@ namespace splashkit_lib
         free_sprite(static_cast<sprite>(s));
     }
 
+    // Sprites added to the pack by fn are not visited, and sprites freed by
+    // fn are skipped
     void _call_for_all_sprites(vector<void *> &sprites, sprite_function *fn)
     {
-        for(void *s : sprites)
+        _begin_pack_iteration(sprites);
+
+        size_t count = sprites.size();
+        for(size_t i = 0; i < count; i++)
         {
-            fn(s);
+            if ( sprites[i] ) fn(sprites[i]);
         }
+
+        _end_pack_iteration(sprites);
     }
 
     void _call_for_all_sprites(vector<void *> &sprites, sprite_float_function *fn, float val)
     {
-        // use a local copy so changes to the sprite pack do not effect loop
-        vector<void *> local_copy = sprites;
-        for(void *s : local_copy)
+        _begin_pack_iteration(sprites);
+
+        size_t count = sprites.size();
+        for(size_t i = 0; i < count; i++)
         {
-            fn(s, val);
+            if ( sprites[i] ) fn(sprites[i], val);
         }
+
+        _end_pack_iteration(sprites);
+    }
+
+    static bool _cull_sprites = true;
+    static bool _sort_sprites = false;
+
+    void set_sprite_culling(bool value)
+    {
+        _cull_sprites = value;
+    }
+
+    bool sprite_culling()
+    {
+        return _cull_sprites;
+    }
+
+    void set_sprite_draw_sorting(bool value)
+    {
+        _sort_sprites = value;
+    }
+
+    bool sprite_draw_sorting()
+    {
+        return _sort_sprites;
+    }
+
+    //
+    // A rectangle in game coordinates that contains everything draw_sprite
+    // draws for the sprite. The visible layers may be rotated and scaled
+    // about points within them, so this is the square around the circle
+    // that contains the layers however they are rotated or scaled.
+    //
+    static rectangle _sprite_draw_bounds(sprite s)
+    {
+        double left = 0, top = 0, right = 0, bottom = 0;
+        bool first = true;
+
+        double x = _sprite_x(s), y = _sprite_y(s);
+        if ( s->draw_at_anchor_point )
+        {
+            x -= s->anchor_point.x;
+            y -= s->anchor_point.y;
+        }
+
+        for (int idx : s->visible_layers)
+        {
+            double lx = x + s->layer_offsets[idx].x, ly = y + s->layer_offsets[idx].y;
+            double lr = lx + sprite_layer_width(s, idx), lb = ly + sprite_layer_height(s, idx);
+
+            if ( first or lx < left ) left = lx;
+            if ( first or ly < top ) top = ly;
+            if ( first or lr > right ) right = lr;
+            if ( first or lb > bottom ) bottom = lb;
+            first = false;
+        }
+
+        double rotation = _sprite_rotation(s), scale = _sprite_scale(s);
+        if ( rotation == 0 and scale == 1 )
+            return rectangle_from(left, top, right - left, bottom - top);
+
+        // Rotating about the anchor point, which can be outside the layers
+        double cx = (left + right) / 2, cy = (top + bottom) / 2;
+        double ax = x + s->anchor_point.x - cx, ay = y + s->anchor_point.y - cy;
+        double radius = (sqrt((right - left) * (right - left) + (bottom - top) * (bottom - top)) + sqrt(ax * ax + ay * ay)) * fmax(fabs(scale), 1.0);
+
+        return rectangle_from(cx - radius, cy - radius, 2 * radius, 2 * radius);
+    }
+
+    // The bitmap the sprite draws first, used to group sprites when sorting
+    static bitmap _sprite_draw_texture(sprite s)
+    {
+        return s->visible_layers.empty() ? nullptr : s->layers[s->visible_layers[0]];
     }
 
     void draw_all_sprites()
     {
-        call_for_all_sprites(&_draw_sprite);
+        if ( not _cull_sprites and not _sort_sprites )
+        {
+            call_for_all_sprites(&_draw_sprite);
+            return;
+        }
+
+        vector<void *> &pack = current_pack();
+
+        // Reused each frame, so this does not allocate once it has grown
+        static vector<sprite> visible;
+        visible.clear();
+
+        rectangle view = screen_rectangle();
+
+        for (void *p : pack)
+        {
+            sprite s = static_cast<sprite>(p);
+            if ( not s or s->visible_layers.empty() ) continue;
+
+            if ( _cull_sprites and not rectangles_intersect(_sprite_draw_bounds(s), view) ) continue;
+
+            visible.push_back(s);
+        }
+
+        if ( _sort_sprites )
+        {
+            std::stable_sort(visible.begin(), visible.end(), [](sprite a, sprite b)
+            {
+                if ( a->z_index != b->z_index ) return a->z_index < b->z_index;
+                return std::less<bitmap>()(_sprite_draw_texture(a), _sprite_draw_texture(b));
+            });
+        }
+
+        for (sprite s : visible)
+        {
+            draw_sprite(s);
+        }
     }
 
     void update_all_sprites(float pct)
     {
-        call_for_all_sprites(&_update_sprite_pct, pct);
+        update_sprite_tweens();
+
+        vector<void *> &pack = current_pack();
+        auto world = _sprite_worlds.find(&pack);
+
+        // Move the whole pack in one pass over its positions and velocities,
+        // then finish each sprite's update. Events are raised once the pack
+        // has moved.
+        if ( world != _sprite_worlds.end() )
+            _move_sprite_world(world->second, pct);
+
+        bool clicked = mouse_clicked(LEFT_BUTTON);
+        point_2d mouse = mouse_position();
+
+        _begin_pack_iteration(pack);
+
+        size_t count = pack.size();
+        for(size_t i = 0; i < count; i++)
+        {
+            sprite s = static_cast<sprite>(pack[i]);
+            if ( not s ) continue;
+
+            _step_sprite_move_to(s);
+            _finish_sprite_update(s, pct, true, clicked, mouse);
+        }
+
+        _end_pack_iteration(pack);
+
+        if ( _batch_sprite_events ) dispatch_sprite_events();
+    }
+
+    void update_all_sprites_in_parallel(float pct)
+    {
+        vector<void *> &pack = current_pack();
+        worker_pool &pool = shared_worker_pool();
+
+        if ( pack.size() < SPRITE_PARALLEL_MIN_COUNT or pool.thread_count() < 2 )
+        {
+            update_all_sprites(pct);
+            return;
+        }
+
+        update_sprite_tweens();
+
+        size_t count = pack.size();
+        vector<vector<_deferred_sprite_event>> deferred;
+        if ( ! _spare_deferred_events.empty() )
+        {
+            deferred.swap(_spare_deferred_events.back());
+            _spare_deferred_events.pop_back();
+        }
+        deferred.resize((count + SPRITE_PARALLEL_CHUNK - 1) / SPRITE_PARALLEL_CHUNK);
+
+        auto world = _sprite_worlds.find(&pack);
+        bool clicked = mouse_clicked(LEFT_BUTTON);
+        point_2d mouse = mouse_position();
+
+        // Each chunk moves its part of the pack's arrays, then updates its
+        // sprites, keeping their events to raise later
+        parallel_for(pool, count, SPRITE_PARALLEL_CHUNK, [&](size_t begin, size_t end, size_t chunk)
+        {
+            _deferred_sprite_events = &deferred[chunk];
+
+            for (size_t i = begin; i < end; i++)
+            {
+                sprite s = static_cast<sprite>(pack[i]);
+                if ( not s ) continue;
+
+                _deferred_sprite_idx = i;
+
+                if ( world != _sprite_worlds.end() )
+                    _move_sprite_slot(world->second, s->slot, pct);
+
+                _step_sprite_move_to(s);
+                _finish_sprite_update(s, pct, true, clicked, mouse);
+            }
+
+            _deferred_sprite_events = nullptr;
+        });
+
+        // Chunks hold consecutive sprites, so this raises events in pack order.
+        // Freed sprites leave a nullptr in the pack, so events for sprites
+        // freed by an earlier handler are skipped.
+        _begin_pack_iteration(pack);
+
+        for (const vector<_deferred_sprite_event> &events : deferred)
+        {
+            for (const _deferred_sprite_event &e : events)
+            {
+                if ( e.sound )
+                    play_sound_effect(e.sound);
+                else if ( pack[e.idx] == e.s )
+                    sprite_raise_event(e.s, e.evt);
+            }
+        }
+
+        _end_pack_iteration(pack);
+
+        for (vector<_deferred_sprite_event> &events : deferred) events.clear();
+        _spare_deferred_events.push_back(std::move(deferred));
+
+        if ( _batch_sprite_events ) dispatch_sprite_events();
+    }
+
+    void update_all_sprites_in_parallel()
+    {
+        update_all_sprites_in_parallel(1.0);
     }
 
     void call_for_all_sprites(sprite_function *fn)
@@ -1543,6 +2690,121 @@ namespace splashkit_lib
         return _current_pack;
     }
 
+    //
+    // Bring the pack's grid up to date. Only sprites whose collision rectangle
+    // now covers different grid cells are moved within the grid.
+    //
+    _sprite_grid &_update_sprite_grid(vector<void *> &pack)
+    {
+        _sprite_grid &grid = _sprite_grids[&pack];
+
+        for (void *p : pack)
+        {
+            sprite s = static_cast<sprite>(p);
+            if ( not s ) continue;
+
+            _sprite_grid_entry entry;
+            entry.rect = sprite_collision_rectangle(s);
+            _sprite_grid_cells(entry.rect, entry);
+
+            auto existing = grid.entries.find(s);
+            if ( existing != grid.entries.end() )
+            {
+                _sprite_grid_entry &old = existing->second;
+                if ( old.x0 == entry.x0 and old.y0 == entry.y0 and old.x1 == entry.x1 and old.y1 == entry.y1 )
+                {
+                    old.rect = entry.rect;
+                    continue;
+                }
+
+                _sprite_grid_remove(grid, s, old);
+            }
+
+            for (int y = entry.y0; y <= entry.y1; y++)
+            {
+                for (int x = entry.x0; x <= entry.x1; x++)
+                {
+                    grid.cells[_sprite_grid_key(x, y)].push_back(s);
+                }
+            }
+
+            grid.entries[s] = entry;
+        }
+
+        return grid;
+    }
+
+    vector<sprite> sprites_in_rectangle(const rectangle &rect)
+    {
+        vector<sprite> result;
+        _sprite_grid &grid = _update_sprite_grid(current_pack());
+
+        _sprite_grid_entry area;
+        _sprite_grid_cells(rect, area);
+
+        for (int y = area.y0; y <= area.y1; y++)
+        {
+            for (int x = area.x0; x <= area.x1; x++)
+            {
+                auto cell = grid.cells.find(_sprite_grid_key(x, y));
+                if ( cell == grid.cells.end() ) continue;
+
+                for (sprite s : cell->second)
+                {
+                    const _sprite_grid_entry &entry = grid.entries[s];
+
+                    // Only report the sprite from the first cell it shares with the area
+                    if ( x != std::max(entry.x0, area.x0) or y != std::max(entry.y0, area.y0) ) continue;
+
+                    if ( rectangles_intersect(entry.rect, rect) )
+                        result.push_back(s);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    void sprite_pack_colliding_pairs(sprite_collision_function *fn)
+    {
+        _sprite_grid &grid = _update_sprite_grid(current_pack());
+
+        // Find the pairs first, so the function can move or free the sprites
+        vector<sprite> pairs;
+
+        for (auto &cell : grid.cells)
+        {
+            int x = static_cast<int>(cell.first >> 32);
+            int y = static_cast<int>(static_cast<int32_t>(cell.first & 0xFFFFFFFF));
+            vector<sprite> &sprites = cell.second;
+
+            for (size_t i = 0; i < sprites.size(); i++)
+            {
+                const _sprite_grid_entry &a = grid.entries[sprites[i]];
+
+                for (size_t j = i + 1; j < sprites.size(); j++)
+                {
+                    const _sprite_grid_entry &b = grid.entries[sprites[j]];
+
+                    // Only test the pair in the first cell they share
+                    if ( x != std::max(a.x0, b.x0) or y != std::max(a.y0, b.y0) ) continue;
+
+                    if ( sprite_collision(sprites[i], sprites[j]) )
+                    {
+                        pairs.push_back(sprites[i]);
+                        pairs.push_back(sprites[j]);
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i + 1 < pairs.size(); i += 2)
+        {
+            if ( VALID_PTR(pairs[i], SPRITE_PTR) and VALID_PTR(pairs[i + 1], SPRITE_PTR) )
+                fn(pairs[i], pairs[i + 1]);
+        }
+    }
+
     void select_sprite_pack(const string &name)
     {
         if ( has_sprite_pack(name) )
@@ -1555,10 +2817,18 @@ namespace splashkit_lib
     {
         if  (not has_sprite_pack(name)) return;
 
+        if ( _iterating_packs.count(&_sprite_packs[name]) > 0 )
+        {
+            LOG(WARNING) << "Cannot free the sprite_pack " + name + " while looping over its sprites";
+            return;
+        }
+
         // TODO: Temporarily do not call due to 70c30d4
         vector<void *> &pack = _sprite_packs[name];
         _call_for_all_sprites(pack, &_free_sprite);
 
+        _sprite_grids.erase(&pack);
+        _sprite_worlds.erase(&pack);
         _sprite_packs.erase(name);
     }
 
@@ -1608,9 +2878,12 @@ namespace splashkit_lib
         if ( INVALID_PTR(s, SPRITE_PTR) )
             return rectangle_from(0,0,0,0);
         else if (sprite_rotation(s) == 0 and sprite_scale(s) == 1)
-            return bitmap_cell_rectangle(s->collision_bitmap, s->position);
+            return bitmap_cell_rectangle(s->collision_bitmap, point_at(_sprite_x(s), _sprite_y(s)));
         else
         {
+            _sprite_shape_cache &cache = _sprite_shape(s);
+            if ( cache.has_collision_rect ) return cache.collision_rect;
+
             int cw = bitmap_cell_width(s->collision_bitmap);
             int ch = bitmap_cell_height(s->collision_bitmap);
 
@@ -1641,7 +2914,9 @@ namespace splashkit_lib
                 else if ( pts[i].y > max_y ) max_y = pts[i].y;
             }
 
-            return rectangle_from(min_x, min_y, max_x - min_x, max_y - min_y);
+            cache.collision_rect = rectangle_from(min_x, min_y, max_x - min_x, max_y - min_y);
+            cache.has_collision_rect = true;
+            return cache.collision_rect;
         }
     }
 
@@ -1676,6 +2951,10 @@ namespace splashkit_lib
 
     void sprite_set_collision_bitmap(sprite s, bitmap bmp)
     {
-        if ( VALID_PTR(s, SPRITE_PTR) ) s->collision_bitmap = bmp;
+        if ( VALID_PTR(s, SPRITE_PTR) )
+        {
+            s->collision_bitmap = bmp;
+            s->shape.dirty = true;
+        }
     }
 }
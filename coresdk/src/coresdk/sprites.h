@@ -30,13 +30,15 @@ namespace splashkit_lib
      *  @constant SPRITE_ANIMATION_ENDED_EVENT The Sprite's animation has ended.
      *  @constant SPRITE_TOUCHED_EVENT         The Sprite was touched
      *  @constant SPRITE_CLICKED_EVENT         The Sprite was touched
+     *  @constant SPRITE_TWEEN_ENDED_EVENT     A rotation, scale or value tween of the Sprite has ended
      */
     enum sprite_event_kind
     {
         SPRITE_ARRIVED_EVENT,
         SPRITE_ANIMATION_ENDED_EVENT,
         SPRITE_TOUCHED_EVENT,
-        SPRITE_CLICKED_EVENT
+        SPRITE_CLICKED_EVENT,
+        SPRITE_TWEEN_ENDED_EVENT
     };
 
     /**
@@ -44,11 +46,41 @@ namespace splashkit_lib
      *
      * @constant PIXEL_COLLISIONS   The sprite will check for collisions with its collision bitmap.
      * @constant AABB_COLLISIONS    The sprite will check for collisions with a bounding box around the sprite.
+     * @constant POLYGON_COLLISIONS The sprite will check for collisions with a convex polygon around the
+     *                              drawn pixels of its collision bitmap (see `bitmap_cell_hull`).
      */
     enum collision_test_kind
     {
         PIXEL_COLLISIONS,
-        AABB_COLLISIONS
+        AABB_COLLISIONS,
+        POLYGON_COLLISIONS
+    };
+
+    /**
+     * The easing curves used by sprite tweens, which shape how the value
+     * moves from its start to its target over the tween.
+     *
+     * @constant LINEAR_EASING              Changes at a constant rate.
+     * @constant EASE_IN_QUAD_EASING        Starts slowly and speeds up.
+     * @constant EASE_OUT_QUAD_EASING       Starts quickly and slows down.
+     * @constant EASE_IN_OUT_QUAD_EASING    Speeds up, then slows down at the end.
+     * @constant EASE_IN_CUBIC_EASING       Starts more slowly than quad easing and speeds up.
+     * @constant EASE_OUT_CUBIC_EASING      Slows down more sharply than quad easing.
+     * @constant EASE_IN_OUT_CUBIC_EASING   Speeds up, then slows down, more sharply than quad easing.
+     * @constant EASE_OUT_BACK_EASING       Goes a little past the target, then settles back on it.
+     * @constant EASE_OUT_BOUNCE_EASING     Bounces on the target before coming to rest.
+     */
+    enum easing_kind
+    {
+        LINEAR_EASING,
+        EASE_IN_QUAD_EASING,
+        EASE_OUT_QUAD_EASING,
+        EASE_IN_OUT_QUAD_EASING,
+        EASE_IN_CUBIC_EASING,
+        EASE_OUT_CUBIC_EASING,
+        EASE_IN_OUT_CUBIC_EASING,
+        EASE_OUT_BACK_EASING,
+        EASE_OUT_BOUNCE_EASING
     };
 
     /**
@@ -88,6 +120,15 @@ namespace splashkit_lib
      */
     typedef void (sprite_float_function)(void *s, float f);
 
+    /**
+     *  The sprite collision function is used with sprite packs to provide a
+     *  procedure to be called for each pair of sprites that are colliding.
+     *
+     * @param s1 The first `sprite` in the collision.
+     * @param s2 The `sprite` it is colliding with.
+     */
+    typedef void (sprite_collision_function)(void *s1, void *s2);
+
     //---------------------------------------------------------------------------
     // sprite creation routines
     //---------------------------------------------------------------------------
@@ -281,6 +322,47 @@ namespace splashkit_lib
      */
     void sprite_stop_calling_on_event(sprite s, sprite_event_handler *handler);
 
+    /**
+     * Turns on or off batching sprite events. While batching, events are
+     * queued as sprites raise them and handed to the handlers by
+     * dispatch_sprite_events, which update_all_sprites calls once it has
+     * updated the pack. Each sprite's own handlers are called first, in the
+     * order the events were raised, then each global handler is called for
+     * all of the events. Turning batching off dispatches any queued events.
+     *
+     * @param value True to queue sprite events until they are dispatched.
+     */
+    void set_sprite_event_batching(bool value);
+
+    /**
+     * Indicates if sprite events are queued until they are dispatched.
+     *
+     * @returns True if sprite events are being batched.
+     */
+    bool sprite_event_batching();
+
+    /**
+     * Turns on or off dropping repeated events while batching, so each
+     * sprite raises each kind of event at most once between dispatches.
+     *
+     * @param value True to raise each event once per sprite in a batch.
+     */
+    void set_sprite_event_coalescing(bool value);
+
+    /**
+     * Indicates if repeated sprite events are dropped while batching.
+     *
+     * @returns True if repeated events are coalesced.
+     */
+    bool sprite_event_coalescing();
+
+    /**
+     * Hands the queued sprite events to their handlers. Events raised by
+     * the handlers are dispatched before this returns. Call this after
+     * updating sprites individually when batching sprite events.
+     */
+    void dispatch_sprite_events();
+
     //---------------------------------------------------------------------------
     // layer code
     //---------------------------------------------------------------------------
@@ -537,6 +619,36 @@ namespace splashkit_lib
      */
     void sprite_set_layer_offset(sprite s, int idx, const vector_2d &value);
 
+    /**
+     * Indicates if the sprite draws its visible layers from a cached image,
+     * see `sprite_set_caches_layers`.
+     *
+     * @param s The sprite to get the details of.
+     * @returns  True if the sprite caches its layers.
+     *
+     * @attribute class sprite
+     * @attribute getter caches_layers
+     */
+    bool sprite_caches_layers(sprite s);
+
+    /**
+     * Allows you to have a sprite with many layers drawn as a single image.
+     * The visible layers of each cell are drawn together into a cached image
+     * the first time that cell is drawn, and showing, hiding, moving or
+     * reordering layers clears the cache. Set this again after drawing onto
+     * one of the layer bitmaps to update the cached images.
+     *
+     * When cached, the layers scale and rotate together as one image, rather
+     * than each around its own centre.
+     *
+     * @param s     The sprite to change.
+     * @param value True to draw the layers from a cached image.
+     *
+     * @attribute class sprite
+     * @attribute setter caches_layers
+     */
+    void sprite_set_caches_layers(sprite s, bool value);
+
     /**
      * Returns the index of the n'th (idx parameter) visible layer.
      *
@@ -1098,6 +1210,106 @@ namespace splashkit_lib
      */
     void sprite_move_to(sprite s, const point_2d &pt, float taking_seconds);
 
+    //---------------------------------------------------------------------------
+    // sprite Tweens
+    //---------------------------------------------------------------------------
+
+    /**
+     * Moves the sprite's position to the indicated point over a number of
+     * seconds, following the easing curve. The sprite raises the
+     * sprite_arrived event when it gets there. Tweens are advanced by
+     * update_sprite_tweens, which update_all_sprites calls for you. Starting
+     * a tween replaces any tween of the same property.
+     *
+     * @param s         The sprite to move.
+     * @param pt        The position the sprite moves to.
+     * @param seconds   The time the tween takes.
+     * @param easing    The curve the sprite follows over the tween.
+     *
+     * @attribute class sprite
+     * @attribute method tween_position
+     */
+    void sprite_tween_position(sprite s, const point_2d &pt, float seconds, easing_kind easing);
+
+    /**
+     * Rotates the sprite to the indicated angle over a number of seconds,
+     * following the easing curve. The sprite raises the sprite_tween_ended
+     * event when the tween ends.
+     *
+     * @param s         The sprite to rotate.
+     * @param angle     The rotation, in degrees, to end the tween at.
+     * @param seconds   The time the tween takes.
+     * @param easing    The curve the rotation follows over the tween.
+     *
+     * @attribute class sprite
+     * @attribute method tween_rotation
+     */
+    void sprite_tween_rotation(sprite s, float angle, float seconds, easing_kind easing);
+
+    /**
+     * Scales the sprite to the indicated scale over a number of seconds,
+     * following the easing curve. The sprite raises the sprite_tween_ended
+     * event when the tween ends.
+     *
+     * @param s         The sprite to scale.
+     * @param scale     The scale to end the tween at.
+     * @param seconds   The time the tween takes.
+     * @param easing    The curve the scale follows over the tween.
+     *
+     * @attribute class sprite
+     * @attribute method tween_scale
+     */
+    void sprite_tween_scale(sprite s, float scale, float seconds, easing_kind easing);
+
+    /**
+     * Changes one of the sprite's values to the target over a number of
+     * seconds, following the easing curve. This can animate game specific
+     * values, such as an opacity used when drawing the sprite. The sprite
+     * raises the sprite_tween_ended event when the tween ends.
+     *
+     * @param s         The sprite to change.
+     * @param value_id  The id of the value, from sprite_value_id. The sprite
+     *                  must already have the value.
+     * @param target    The value to end the tween at.
+     * @param seconds   The time the tween takes.
+     * @param easing    The curve the value follows over the tween.
+     *
+     * @attribute class sprite
+     * @attribute method tween_value
+     */
+    void sprite_tween_value(sprite s, int value_id, float target, float seconds, easing_kind easing);
+
+    /**
+     * Indicates if any of the sprite's properties are being tweened.
+     *
+     * @param s   The sprite to check.
+     * @returns   True if the sprite has a tween that has not ended.
+     *
+     * @attribute class sprite
+     * @attribute getter tweening
+     */
+    bool sprite_tweening(sprite s);
+
+    /**
+     * Stops all of the sprite's tweens, leaving its properties where they
+     * are. No events are raised for the stopped tweens.
+     *
+     * @param s   The sprite whose tweens are stopped.
+     *
+     * @attribute class sprite
+     * @attribute method stop_tweens
+     */
+    void sprite_stop_tweens(sprite s);
+
+    /**
+     * Advances the tweens of every sprite, in every pack, by the time since
+     * they were last advanced. Events for the tweens that end are raised
+     * once all of the tweens have been advanced. This is called by
+     * update_all_sprites, so you only need to call it if you update your
+     * sprites individually.
+     */
+    void update_sprite_tweens();
+
     //---------------------------------------------------------------------------
     // sprite Screen Position Tests
     //---------------------------------------------------------------------------
@@ -1426,6 +1638,27 @@ namespace splashkit_lib
      */
     point_2d sprite_position(sprite s);
 
+    /**
+     * Returns the positions of many sprites in one call. Invalid sprites
+     * are given a position of 0,0.
+     *
+     * @param sprites The sprites to get the positions of.
+     * @returns       The location of each sprite, in the same order.
+     */
+    vector<point_2d> sprite_positions(const vector<sprite> &sprites);
+
+    /**
+     * Gets the positions of many sprites, reusing the supplied vector so that
+     * no memory needs to be allocated once it has grown.
+     *
+     * @param sprites       The sprites to get the positions of.
+     * @param out_positions After the call this holds the location of each
+     *                      sprite, in the same order.
+     *
+     * @attribute suffix  into
+     */
+    void sprite_positions(const vector<sprite> &sprites, vector<point_2d> &out_positions);
+
     /**
      * Sets the sprite's position.
      *
@@ -1697,6 +1930,31 @@ namespace splashkit_lib
      */
     void sprite_set_scale(sprite s, float value);
 
+    /**
+     * Returns the z index of the sprite. When draw_all_sprites sorts the
+     * sprites in the pack, sprites with a higher z index are drawn over
+     * those with a lower z index.
+     *
+     * @param s     The sprite to get the z index of.
+     * @returns     The sprite's z index, 0 by default.
+     *
+     * @attribute class sprite
+     * @attribute getter z_index
+     */
+    int sprite_z_index(sprite s);
+
+    /**
+     * Allows you to change the z index of a sprite, which orders the
+     * sprites drawn by draw_all_sprites when sorting is turned on.
+     *
+     * @param s     The sprite to change.
+     * @param value The new z index for the sprite.
+     *
+     * @attribute class sprite
+     * @attribute setter z_index
+     */
+    void sprite_set_z_index(sprite s, int value);
+
     //---------------------------------------------------------------------------
     // sprite value code
     //---------------------------------------------------------------------------
@@ -1769,7 +2027,56 @@ namespace splashkit_lib
      * @param name  The name of the value to check.
      * @returns     True if the sprite has a value with that name.
      */
-    bool sprite_has_value(sprite s, string name);
+    bool sprite_has_value(sprite s, const string &name);
+
+    /**
+     * Returns the id for a sprite value name. The id can be used in place of
+     * the name to read and change the value in any sprite, without looking
+     * up the name each time. The same name always has the same id.
+     *
+     * @param name  The name of the value.
+     * @returns     The id for values with that name.
+     */
+    int sprite_value_id(const string &name);
+
+    /**
+     * Indicates if the sprite has the value with the given id.
+     *
+     * @param s     The sprite to get the details from.
+     * @param id    The id of the value, from sprite_value_id.
+     * @returns     True if the sprite has a value with that id.
+     *
+     * @attribute suffix with_id
+     */
+    bool sprite_has_value(sprite s, int id);
+
+    /**
+     * Returns the value with the given id from the sprite.
+     *
+     * @param s     The sprite to get the details from.
+     * @param id    The id of the value, from sprite_value_id.
+     * @returns     The value from the sprite's data store, or 0 if it
+     *              does not have the value.
+     *
+     * @attribute class sprite
+     * @attribute method value
+     * @attribute suffix with_id
+     */
+    float sprite_value(sprite s, int id);
+
+    /**
+     * Assigns the value with the given id in the sprite. The sprite must
+     * already have the value, see sprite_add_value.
+     *
+     * @param s     The sprite to change.
+     * @param id    The id of the value, from sprite_value_id.
+     * @param val   The new value.
+     *
+     * @attribute class sprite
+     * @attribute method set_value
+     * @attribute suffix with_id
+     */
+    void sprite_set_value(sprite s, int id, float val);
 
     //---------------------------------------------------------------------------
     // sprite name
@@ -1793,10 +2100,45 @@ namespace splashkit_lib
 
     /**
      * draws all of the sprites in the current sprite pack. Packs can be
-     * switched to select between different sets of sprites.
+     * switched to select between different sets of sprites. Sprites outside
+     * of the camera's view are skipped, unless culling has been turned off
+     * with set_sprite_culling.
      */
     void draw_all_sprites();
 
+    /**
+     * Turns on or off skipping the sprites that are outside of the camera's
+     * view in draw_all_sprites. Culling is on by default.
+     *
+     * @param value True to skip sprites that can not be seen.
+     */
+    void set_sprite_culling(bool value);
+
+    /**
+     * Indicates if draw_all_sprites skips sprites outside of the camera's view.
+     *
+     * @returns True if sprites that can not be seen are skipped.
+     */
+    bool sprite_culling();
+
+    /**
+     * Turns on or off sorting the sprites drawn by draw_all_sprites. When on,
+     * sprites are drawn in order of their z index, and sprites with the same
+     * z index are grouped by the bitmap they draw so batched rendering can
+     * draw them together. When off, the default, sprites are drawn in the
+     * order they were added to the pack.
+     *
+     * @param value True to sort the sprites when drawing.
+     */
+    void set_sprite_draw_sorting(bool value);
+
+    /**
+     * Indicates if draw_all_sprites sorts the sprites it draws.
+     *
+     * @returns True if sprites are sorted by z index and bitmap when drawn.
+     */
+    bool sprite_draw_sorting();
+
     /**
      * Update all of the sprites in the current sprite pack.
      */
@@ -1812,6 +2154,26 @@ namespace splashkit_lib
      */
     void update_all_sprites(float pct);
 
+    /**
+     * Update all of the sprites in the current sprite pack, sharing large
+     * packs between threads. Sprite events and animation sounds are held
+     * until all sprites have been updated, and are then raised in pack order
+     * on the calling thread, so event handlers never run at the same time.
+     */
+    void update_all_sprites_in_parallel();
+
+    /**
+     * Update all of the sprites in the current sprite pack, sharing large
+     * packs between threads, passing in a percentage value to indicate the
+     * percentage to update. Sprite events and animation sounds are raised in
+     * pack order on the calling thread once all sprites have been updated.
+     *
+     * @param pct The percentage of the update to apply.
+     *
+     * @attribute suffix  percent
+     */
+    void update_all_sprites_in_parallel(float pct);
+
     /**
      * Call the supplied function for all sprites in the current pack.
      *
@@ -1829,6 +2191,25 @@ namespace splashkit_lib
      */
     void call_for_all_sprites(sprite_float_function *fn, float val);
 
+    /**
+     * Call the supplied function for each pair of colliding sprites in the
+     * current pack. Sprites are kept in a spatial grid, so only sprites that
+     * are near each other are tested with `sprite_collision`. This is much
+     * faster than testing each pair of sprites when there are many sprites.
+     *
+     * @param fn The function called with each pair of colliding sprites.
+     */
+    void sprite_pack_colliding_pairs(sprite_collision_function *fn);
+
+    /**
+     * Returns the sprites in the current pack whose collision rectangle
+     * intersects the indicated rectangle.
+     *
+     * @param rect The area to search for sprites.
+     * @returns The sprites within the rectangle.
+     */
+    vector<sprite> sprites_in_rectangle(const rectangle &rect);
+
     /**
      * Create a new sprite_pack with a given name. This pack can then be
      * selected and used to control which sprites are drawn/updated in
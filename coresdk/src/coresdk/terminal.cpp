@@ -7,9 +7,13 @@
 //
 
 #include <easylogging++.h>
+#include "terminal.h"
 #include "types.h"
+#include "concurrency_utils.h"
+#include "utils_driver.h"
 #include <iostream>
 #include <map>
+#include <mutex>
 
 using std::map;
 using std::pair;
@@ -17,13 +21,80 @@ using std::cout;
 using std::to_string;
 using std::endl;
 using std::cin;
+using std::mutex;
+using std::lock_guard;
 
 namespace splashkit_lib
 {
-    void write(string text)
+    // Buffered output is sent once this much text is waiting
+    static const size_t TERMINAL_BUFFER_SIZE = 64 * 1024;
+
+    // Output waiting to be sent, guarded by _terminal_lock as logging may
+    // write from its own thread
+    static string _terminal_buffer;
+    static bool _terminal_buffered = false;
+    static mutex _terminal_lock;
+
+    // The caller must hold _terminal_lock
+    static void _send_terminal_buffer()
     {
-        cout << text;
+        if ( _terminal_buffer.empty() ) return;
+
+        cout.write(_terminal_buffer.data(), static_cast<std::streamsize>(_terminal_buffer.size()));
         cout.flush();
+        _terminal_buffer.clear();
+    }
+
+    // Sends what is left in the buffer as the program ends
+    static struct _terminal_buffer_flusher
+    {
+        ~_terminal_buffer_flusher()
+        {
+            terminal_flush();
+        }
+    } _flush_at_exit;
+
+    static void _write_terminal(const char *text, size_t length)
+    {
+        lock_guard<mutex> lock(_terminal_lock);
+
+        if ( _terminal_buffered )
+        {
+            _terminal_buffer.append(text, length);
+            if ( _terminal_buffer.size() >= TERMINAL_BUFFER_SIZE ) _send_terminal_buffer();
+        }
+        else
+        {
+            cout.write(text, static_cast<std::streamsize>(length));
+            cout.flush();
+        }
+    }
+
+    void set_terminal_buffered(bool value)
+    {
+        lock_guard<mutex> lock(_terminal_lock);
+
+        if ( ! value ) _send_terminal_buffer();
+        else _terminal_buffer.reserve(TERMINAL_BUFFER_SIZE);
+
+        _terminal_buffered = value;
+    }
+
+    bool terminal_buffered()
+    {
+        return _terminal_buffered;
+    }
+
+    void terminal_flush()
+    {
+        lock_guard<mutex> lock(_terminal_lock);
+        _send_terminal_buffer();
+        cout.flush();
+    }
+
+    void write(string text)
+    {
+        _write_terminal(text.data(), text.size());
     }
     
     void write(int data)
@@ -43,14 +114,13 @@ namespace splashkit_lib
 
     void write_line()
     {
-        cout << endl;
-        cout.flush();
+        _write_terminal("\n", 1);
     }
 
     void write_line(string line)
     {
-        cout << line << endl;
-        cout.flush();
+        line += '\n';
+        _write_terminal(line.data(), line.size());
     }
     
     void write_line(int data)
@@ -68,22 +138,146 @@ namespace splashkit_lib
         write_line(std::to_string(data));
     }
 
+    // A line read by the input reader, or the end of the input
+    struct _terminal_line
+    {
+        string text;
+        bool closed;
+    };
+
+    // Once started, the input reader owns cin and queues each line it reads
+    static channel<_terminal_line> _terminal_lines;
+    static atomic<bool> _terminal_reader_started(false);
+    static atomic<bool> _terminal_input_closed(false);
+
+    // The rest of a line that read_char took a character from
+    static string _terminal_partial_line;
+    static bool _terminal_has_partial_line = false;
+
+    static void _terminal_reader_loop()
+    {
+        string line;
+
+        while ( getline(cin, line) )
+        {
+            _terminal_lines.put({line, false});
+            sk_signal_activity();
+        }
+
+        _terminal_input_closed = true;
+        _terminal_lines.put({string(""), true});
+        sk_signal_activity();
+    }
+
+    static void _start_terminal_reader()
+    {
+        bool expected = false;
+        if ( ! _terminal_reader_started.compare_exchange_strong(expected, true) ) return;
+
+        // getline cannot be interrupted, so the reader is left to end with the program
+        thread(_terminal_reader_loop).detach();
+    }
+
+    // Takes the next line from the reader, waiting for one when wait is true
+    static bool _take_terminal_line(string &out_line, bool wait)
+    {
+        if ( _terminal_has_partial_line )
+        {
+            out_line = _terminal_partial_line;
+            _terminal_has_partial_line = false;
+            return true;
+        }
+
+        _terminal_line entry;
+
+        if ( wait )
+            entry = _terminal_lines.take();
+        else if ( ! _terminal_lines.try_take(entry) )
+        {
+            out_line = "";
+            return false;
+        }
+
+        if ( entry.closed )
+        {
+            // leave the end in the queue, so later reads also see it
+            _terminal_lines.put(entry);
+            out_line = "";
+            return false;
+        }
+
+        out_line = entry.text;
+        return true;
+    }
+
+    // The number of lines waiting, not counting the end of the input
+    static size_t _terminal_lines_waiting()
+    {
+        size_t result = _terminal_lines.size();
+        if ( _terminal_input_closed && result > 0 ) result--;
+        return result;
+    }
+
     string read_line()
     {
         string result;
-        getline(std::cin, result);
+        terminal_flush(); // show any prompt before waiting
+
+        if ( _terminal_reader_started )
+            _take_terminal_line(result, true);
+        else
+            getline(std::cin, result);
+
         return result;
     }
 
     char read_char()
     {
         char result = 0;
-        cin >> result;
+        terminal_flush();
+
+        if ( ! _terminal_reader_started )
+        {
+            cin >> result;
+            return result;
+        }
+
+        // skip white space as cin >> does, keeping the rest of the line
+        string line;
+        while ( _take_terminal_line(line, true) )
+        {
+            size_t start = line.find_first_not_of(" \t\r\n");
+            if ( start == string::npos ) continue;
+
+            result = line[start];
+            _terminal_partial_line = line.substr(start + 1);
+            _terminal_has_partial_line = true;
+            break;
+        }
+
         return result;
     }
 
     bool terminal_has_input()
     {
+        terminal_flush();
+
+        if ( _terminal_reader_started )
+            return _terminal_has_partial_line || _terminal_lines_waiting() > 0;
+
         return cin.peek() != EOF;
     }
+
+    bool terminal_has_line()
+    {
+        _start_terminal_reader();
+        return _terminal_has_partial_line || _terminal_lines_waiting() > 0;
+    }
+
+    bool try_read_line(string &out_line)
+    {
+        _start_terminal_reader();
+        terminal_flush();
+        return _take_terminal_line(out_line, false);
+    }
 }
@@ -115,6 +115,49 @@ namespace splashkit_lib
      * @returns true if there is data waiting to be read.
      */
     bool terminal_has_input();
+
+    /**
+     * Checks if a whole line has been entered, without waiting. The first
+     * call starts reading the terminal in the background, after which
+     * `read_line` and `read_char` take their input from the lines that have
+     * been read.
+     *
+     * @returns True if `try_read_line` will return a line.
+     */
+    bool terminal_has_line();
+
+    /**
+     * Read a line of text from the terminal if one has been entered,
+     * without waiting for the user. The first call starts reading the
+     * terminal in the background.
+     *
+     * @param out_line  Set to the line that was entered, or an empty string
+     * @returns         True if a line was read.
+     */
+    bool try_read_line(string &out_line);
+
+    /**
+     * Turn buffered terminal output on or off. Normally each write is sent
+     * to the terminal straight away. When buffered, written text is kept
+     * and sent in large chunks, which is much faster when writing a lot of
+     * output. The buffer is sent when it fills, when `terminal_flush` is
+     * called, before reading from the terminal, and when the program ends.
+     *
+     * @param value True to buffer terminal output.
+     */
+    void set_terminal_buffered(bool value);
+
+    /**
+     * Indicates if terminal output is being buffered.
+     *
+     * @returns True if buffered output has been turned on.
+     */
+    bool terminal_buffered();
+
+    /**
+     * Send any buffered output to the terminal.
+     */
+    void terminal_flush();
 }
 
 #endif /* terminal_h */
@@ -10,6 +10,8 @@
 #include "backend_types.h"
 #include "resources.h"
 #include "utility_functions.h"
+#include "resource_registry.h"
+#include "resource_tracking.h"
 
 #include "text_driver.h"
 #include "graphics_driver.h"
@@ -19,23 +21,49 @@
 #include <map>
 namespace splashkit_lib
 {
-    static map<string, font> _fonts;
+    static resource_registry<font> _fonts;
+
+    // Report a font to the resource budget. Fonts can have their open sizes
+    // and glyphs evicted, and the sizes are opened again, in the same style,
+    // when the font is next used.
+    static void _track_font(font fnt)
+    {
+        resource_evict_fn evict = [fnt]() -> resource_reload_fn
+        {
+            vector<int> sizes;
+            for (auto const &it : fnt->_data) sizes.push_back(it.first);
+
+            sk_unload_font_data(fnt);
+
+            // Open the sizes again, which keep the font's style
+            return [fnt, sizes]()
+            {
+                for (int size : sizes) sk_add_font_size(fnt, size);
+            };
+        };
+
+        _track_resource(fnt, FONT_RESOURCE, fnt->name, [fnt](size_t &cpu, size_t &gpu)
+        {
+            sk_font_memory(fnt, &cpu, &gpu);
+        }, evict);
+    }
 
     bool has_font(font fnt)
     {
-        return VALID_PTR(fnt, FONT_PTR) and _fonts.count(fnt->name) > 0;
+        return VALID_PTR(fnt, FONT_PTR) and _fonts.contains(fnt->name);
     }
 
     bool has_font(string name)
     {
-        if ( _fonts.count(name) <= 0 ) return false;
-        return has_font(_fonts.find(name)->second);
+        font fnt = _fonts.find(name);
+        return fnt and has_font(fnt);
     }
 
     bool font_has_size(font fnt, int font_size)
     {
         if (has_font(fnt))
         {
+            _resource_used(fnt);
             return fnt->_data.count(font_size) > 0;
         }
         else
@@ -70,9 +98,12 @@ namespace splashkit_lib
 
     font font_named(string name)
     {
-        if (has_font(name))
+        font result = _fonts.find(name);
+
+        if (has_font(result))
         {
-            return _fonts[name];
+            _resource_used(result);
+            return result;
         }
         else
         {
@@ -108,12 +139,12 @@ namespace splashkit_lib
     void free_all_fonts()
     {
         string name;
+        font fnt;
 
         size_t sz = _fonts.size();
 
-        for(size_t i = 0; i < sz; i++)
+        for(size_t i = 0; i < sz && _fonts.first(name, fnt); i++)
         {
-            font fnt = _fonts.begin()->second;
             if (VALID_PTR(fnt, FONT_PTR))
             {
                 free_font(fnt);
@@ -121,7 +152,7 @@ namespace splashkit_lib
             else
             {
                 LOG(WARNING) << "Fonts contained an invalid pointer";
-                _fonts.erase(_fonts.begin());
+                _fonts.erase(name);
             }
         }
     }
@@ -134,6 +165,8 @@ namespace splashkit_lib
             return;
         }
 
+        _resource_used(fnt);
+
         for (auto const it : fnt->_data)
         {
             sk_set_font_style(fnt, it.first, style);
@@ -153,6 +186,9 @@ namespace splashkit_lib
             return NORMAL_FONT; // Add NONE to font_style enum?
         }
 
+        _resource_used(fnt);
+        if ( fnt->_data.empty() ) return NORMAL_FONT;
+
         int font_size = fnt->_data.begin()->first;
 
         // Should the backend not just return a font_style instead of an int?
@@ -164,6 +200,28 @@ namespace splashkit_lib
         return get_font_style(font_named(name));
     }
 
+    void set_font_scalable(font fnt, bool value)
+    {
+        if (!VALID_PTR(fnt, FONT_PTR))
+        {
+            LOG(WARNING) << "Attempting to set scalable on invalid font.";
+            return;
+        }
+
+        sk_set_font_scalable(fnt, value);
+    }
+
+    bool font_scalable(font fnt)
+    {
+        if (!VALID_PTR(fnt, FONT_PTR))
+        {
+            LOG(WARNING) << "Attempting to check if an invalid font is scalable.";
+            return false;
+        }
+
+        return sk_font_scalable(fnt);
+    }
+
     font load_font(const string &name, const string &filename)
     {
         if (has_font(name)) return font_named(name);
@@ -200,8 +258,19 @@ namespace splashkit_lib
             LOG(WARNING) << "LoadFont failed: " + name + " (" + file_path + ")";
         } else
         {
-            _fonts[name] = result;
             result->name = name; // Need to clean this up, name is set to filename in sk_load_font
+
+            // Another thread may have loaded the same name in the meantime
+            font registered = _fonts.insert(name, result);
+            if ( registered != result )
+            {
+                sk_close_font(result);
+                result->id = NONE_PTR;
+                delete result;
+                result = registered;
+            }
+            else
+                _track_font(result);
         }
 
         return result;
@@ -252,6 +321,8 @@ namespace splashkit_lib
 
         if (text.length() < 1) return;
 
+        if ( fnt ) _resource_used(fnt);
+
         xy_from_opts(opts, x, y);
 
         sk_draw_text(to_surface_ptr(opts.dest), fnt, font_size, x, y, text.c_str(), clr);
@@ -350,8 +421,10 @@ namespace splashkit_lib
             return 0;
         }
 
+        if ( fnt ) _resource_used(fnt);
+
         int w = 0, h = 0;
-        sk_text_size(fnt, font_size, text.c_str(), &w, &h);
+        sk_text_size(fnt, font_size, text, &w, &h);
         return w;
     }
 
@@ -368,8 +441,10 @@ namespace splashkit_lib
             return 0;
         }
 
+        _resource_used(fnt);
+
         int w = 0, h = 0;
-        sk_text_size(fnt, font_size, text.c_str(), &w, &h);
+        sk_text_size(fnt, font_size, text, &w, &h);
         return h;
     }
 
@@ -77,6 +77,37 @@ namespace splashkit_lib
      */
     font_style get_font_style(const string &name);
 
+    /**
+     * @brief Sets whether a `font` draws every size from one set of glyphs.
+     *
+     * A scalable font renders its glyphs once, at a large size, and scales
+     * them to draw text at any other size. Text that is drawn at many sizes,
+     * such as text that zooms, then does not need its glyphs rendered again
+     * for each size. Small text may look a little softer than text drawn by a
+     * font that is not scalable.
+     *
+     * @param fnt           The `font` to change.
+     * @param value         True to draw all sizes from the same glyphs.
+     *
+     * @attribute class     font
+     * @attribute setter    scalable
+     * @attribute self      fnt
+     */
+    void set_font_scalable(font fnt, bool value);
+
+    /**
+     * @brief Checks if a `font` draws every size from one set of glyphs.
+     *
+     * @param fnt           The `font` to check.
+     *
+     * @attribute class     font
+     * @attribute getter    scalable
+     * @attribute self      fnt
+     *
+     * @returns Returns true if the `font` is scalable.
+     */
+    bool font_scalable(font fnt);
+
     /**
      * @brief Loads a new font from a file.
      *
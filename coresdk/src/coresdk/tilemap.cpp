@@ -0,0 +1,370 @@
+//
+//  tilemap.cpp
+//  splashkit
+//
+//  The map is split into square chunks of tiles. Each chunk is drawn once
+//  into a render target, and the chunk bitmaps are drawn each frame. A chunk
+//  is only drawn again when one of its tiles changes.
+//
+
+#include "tilemap.h"
+
+#include "camera.h"
+#include "color.h"
+#include "drawing_options.h"
+#include "images.h"
+
+#include "backend_types.h"
+#include "graphics_driver.h"
+#include "utility_functions.h"
+
+#include <algorithm>
+
+// The most tiles across and down each chunk
+#define TILEMAP_CHUNK_TILES 32
+// The largest chunk bitmap, in pixels across or down
+#define TILEMAP_CHUNK_MAX_PIXELS 2048
+
+namespace splashkit_lib
+{
+    struct _tilemap_chunk
+    {
+        bitmap bmp;     // the drawn tiles, or nullptr until the chunk is first seen
+        bool dirty;     // a tile has changed since the chunk was drawn
+    };
+
+    struct _tilemap_data
+    {
+        pointer_identifier id;
+        bitmap tileset;
+        int columns, rows;
+        int tile_width, tile_height;
+
+        int chunk_tiles;            // tiles across and down each chunk
+        int chunk_cols, chunk_rows;
+
+        vector<int> cells;          // indexed by row * columns + column
+        vector<_tilemap_chunk> chunks;
+    };
+
+    static bool _valid_tile_size(int width, int height)
+    {
+        return width > 0 && height > 0 && width <= TILEMAP_CHUNK_MAX_PIXELS && height <= TILEMAP_CHUNK_MAX_PIXELS;
+    }
+
+    // Split the map into chunks for its tile size, to be drawn afresh
+    static void _layout_tilemap_chunks(tilemap map)
+    {
+        for (_tilemap_chunk &chunk : map->chunks)
+        {
+            if ( chunk.bmp ) release_render_target(chunk.bmp);
+        }
+
+        // keep chunk bitmaps within the texture sizes every graphics card supports
+        int largest_tile = std::max(map->tile_width, map->tile_height);
+        map->chunk_tiles = std::max(1, std::min(TILEMAP_CHUNK_TILES, TILEMAP_CHUNK_MAX_PIXELS / largest_tile));
+
+        map->chunk_cols = (map->columns + map->chunk_tiles - 1) / map->chunk_tiles;
+        map->chunk_rows = (map->rows + map->chunk_tiles - 1) / map->chunk_tiles;
+
+        map->chunks.assign(static_cast<size_t>(map->chunk_cols) * map->chunk_rows, { nullptr, true });
+    }
+
+    tilemap create_tilemap(bitmap tileset, int columns, int rows)
+    {
+        if ( INVALID_PTR(tileset, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to create tilemap with invalid tileset bitmap";
+            return nullptr;
+        }
+
+        if ( columns <= 0 || rows <= 0 )
+        {
+            LOG(WARNING) << "Trying to create tilemap with " << columns << " columns and " << rows << " rows";
+            return nullptr;
+        }
+
+        int tile_width = bitmap_cell_width(tileset);
+        int tile_height = bitmap_cell_height(tileset);
+        if ( ! _valid_tile_size(tile_width, tile_height) )
+        {
+            LOG(WARNING) << "Trying to create tilemap with tiles of " << tile_width << "x" << tile_height << ", tiles must be 1 to " << TILEMAP_CHUNK_MAX_PIXELS << " pixels across and down";
+            return nullptr;
+        }
+
+        tilemap result = new _tilemap_data;
+        result->id = TILEMAP_PTR;
+        result->tileset = tileset;
+        result->columns = columns;
+        result->rows = rows;
+        result->tile_width = tile_width;
+        result->tile_height = tile_height;
+
+        result->cells.assign(static_cast<size_t>(columns) * rows, -1);
+        _layout_tilemap_chunks(result);
+
+        return result;
+    }
+
+    void free_tilemap(tilemap map)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to free tilemap with invalid pointer";
+            return;
+        }
+
+        notify_of_free(map);
+
+        for (_tilemap_chunk &chunk : map->chunks)
+        {
+            if ( chunk.bmp ) release_render_target(chunk.bmp);
+        }
+
+        map->id = NONE_PTR;
+        delete map;
+    }
+
+    int tilemap_columns(tilemap map)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to get the columns of an invalid tilemap";
+            return 0;
+        }
+
+        return map->columns;
+    }
+
+    int tilemap_rows(tilemap map)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to get the rows of an invalid tilemap";
+            return 0;
+        }
+
+        return map->rows;
+    }
+
+    int tilemap_tile_width(tilemap map)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to get the tile width of an invalid tilemap";
+            return 0;
+        }
+
+        return map->tile_width;
+    }
+
+    int tilemap_tile_height(tilemap map)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to get the tile height of an invalid tilemap";
+            return 0;
+        }
+
+        return map->tile_height;
+    }
+
+    void tilemap_set_tile_size(tilemap map, int width, int height)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the tile size of an invalid tilemap";
+            return;
+        }
+
+        if ( ! _valid_tile_size(width, height) )
+        {
+            LOG(WARNING) << "Trying to set tilemap tiles to " << width << "x" << height << ", tiles must be 1 to " << TILEMAP_CHUNK_MAX_PIXELS << " pixels across and down";
+            return;
+        }
+
+        if ( map->tile_width == width && map->tile_height == height ) return;
+
+        map->tile_width = width;
+        map->tile_height = height;
+        _layout_tilemap_chunks(map);
+    }
+
+    int tilemap_tile(tilemap map, int column, int row)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to read a tile of an invalid tilemap";
+            return -1;
+        }
+
+        if ( column < 0 || row < 0 || column >= map->columns || row >= map->rows ) return -1;
+
+        return map->cells[static_cast<size_t>(row) * map->columns + column];
+    }
+
+    static void _mark_chunk_dirty(tilemap map, int column, int row)
+    {
+        int idx = (row / map->chunk_tiles) * map->chunk_cols + column / map->chunk_tiles;
+        map->chunks[idx].dirty = true;
+    }
+
+    void tilemap_set_tile(tilemap map, int column, int row, int cell)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to set a tile of an invalid tilemap";
+            return;
+        }
+
+        if ( column < 0 || row < 0 || column >= map->columns || row >= map->rows )
+        {
+            LOG(WARNING) << "Trying to set tile " << column << ", " << row << " outside of a tilemap";
+            return;
+        }
+
+        int &current = map->cells[static_cast<size_t>(row) * map->columns + column];
+        if ( cell < 0 ) cell = -1;
+        if ( current == cell ) return;
+
+        current = cell;
+        _mark_chunk_dirty(map, column, row);
+    }
+
+    void tilemap_set_tiles(tilemap map, const vector<int> &cells)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to set the tiles of an invalid tilemap";
+            return;
+        }
+
+        if ( cells.size() != map->cells.size() )
+        {
+            LOG(WARNING) << "Trying to set tiles of a tilemap, expected " << map->cells.size() << " cells but got " << cells.size();
+            return;
+        }
+
+        for (int row = 0; row < map->rows; row++)
+        {
+            for (int column = 0; column < map->columns; column++)
+            {
+                size_t idx = static_cast<size_t>(row) * map->columns + column;
+                int cell = cells[idx] < 0 ? -1 : cells[idx];
+
+                if ( map->cells[idx] == cell ) continue;
+
+                map->cells[idx] = cell;
+                _mark_chunk_dirty(map, column, row);
+            }
+        }
+    }
+
+    void tilemap_refresh(tilemap map)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to refresh an invalid tilemap";
+            return;
+        }
+
+        for (_tilemap_chunk &chunk : map->chunks)
+            chunk.dirty = true;
+    }
+
+    // Draw the tiles of a chunk into its bitmap
+    static void _bake_chunk(tilemap map, int chunk_col, int chunk_row)
+    {
+        _tilemap_chunk &chunk = map->chunks[chunk_row * map->chunk_cols + chunk_col];
+
+        int first_col = chunk_col * map->chunk_tiles;
+        int first_row = chunk_row * map->chunk_tiles;
+        int cols = std::min(map->chunk_tiles, map->columns - first_col);
+        int rows = std::min(map->chunk_tiles, map->rows - first_row);
+
+        // a released target of the same size comes back cleared, and reuses its texture
+        if ( chunk.bmp ) release_render_target(chunk.bmp);
+        chunk.bmp = acquire_render_target(cols * map->tile_width, rows * map->tile_height);
+        chunk.dirty = false;
+
+        if ( ! chunk.bmp ) return;
+
+        static vector<bitmap_instance> instances;
+        instances.clear();
+
+        for (int r = 0; r < rows; r++)
+        {
+            for (int c = 0; c < cols; c++)
+            {
+                int cell = map->cells[static_cast<size_t>(first_row + r) * map->columns + first_col + c];
+                if ( cell < 0 ) continue;
+
+                instances.push_back({
+                    cell,
+                    point_at(c * map->tile_width, r * map->tile_height),
+                    0, 1, 1,
+                    COLOR_WHITE
+                });
+            }
+        }
+
+        draw_bitmap_instances(map->tileset, instances, option_draw_to(chunk.bmp));
+    }
+
+    void draw_tilemap(tilemap map, double x, double y, const drawing_options &opts)
+    {
+        if ( INVALID_PTR(map, TILEMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to draw an invalid tilemap";
+            return;
+        }
+
+        if ( INVALID_PTR(map->tileset, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to draw a tilemap whose tileset has been freed";
+            return;
+        }
+
+        sk_drawing_surface *surface = to_surface_ptr(opts.dest);
+        if ( ! surface ) return;
+
+        // work out the area of the destination that can be seen, in the same
+        // coordinates as x and y
+        double view_x = 0, view_y = 0;
+        xy_from_opts(opts, view_x, view_y);
+        view_x = -view_x;
+        view_y = -view_y;
+
+        // nothing to draw when the map is to the right of, or below, the view
+        if ( view_x + surface->width < x || view_y + surface->height < y ) return;
+
+        double chunk_w = map->chunk_tiles * map->tile_width;
+        double chunk_h = map->chunk_tiles * map->tile_height;
+
+        int first_col = std::max(0, static_cast<int>((view_x - x) / chunk_w));
+        int first_row = std::max(0, static_cast<int>((view_y - y) / chunk_h));
+        int last_col = std::min(map->chunk_cols - 1, static_cast<int>((view_x + surface->width - x) / chunk_w));
+        int last_row = std::min(map->chunk_rows - 1, static_cast<int>((view_y + surface->height - y) / chunk_h));
+
+        drawing_options chunk_opts = option_defaults();
+        chunk_opts.dest = opts.dest;
+        chunk_opts.camera = opts.camera;
+
+        for (int row = first_row; row <= last_row; row++)
+        {
+            for (int col = first_col; col <= last_col; col++)
+            {
+                _tilemap_chunk &chunk = map->chunks[row * map->chunk_cols + col];
+                if ( chunk.dirty || ! chunk.bmp ) _bake_chunk(map, col, row);
+                if ( ! chunk.bmp ) continue;
+
+                draw_bitmap(chunk.bmp, x + col * chunk_w, y + row * chunk_h, chunk_opts);
+            }
+        }
+    }
+
+    void draw_tilemap(tilemap map, double x, double y)
+    {
+        draw_tilemap(map, x, y, option_defaults());
+    }
+}
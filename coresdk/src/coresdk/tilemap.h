@@ -0,0 +1,200 @@
+/**
+ * @header  tilemap
+ * @brief   Tilemaps draw large grids of tiles from the cells of a bitmap.
+ *
+ * A tilemap uses a bitmap with cell details as its tileset, and holds the
+ * index of the cell to draw at each column and row of the map. The map is
+ * drawn in chunks of tiles that are kept in bitmaps on the graphics card,
+ * so drawing a large map takes only a few draws each frame. Chunks are
+ * redrawn when one of their tiles changes, and only the chunks that can be
+ * seen are drawn.
+ *
+ * @attribute group  graphics
+ * @attribute static tilemap
+ */
+
+#ifndef tilemap_h
+#define tilemap_h
+
+#include "types.h"
+
+#include <vector>
+using std::vector;
+
+namespace splashkit_lib
+{
+    /**
+     * A tilemap holds a grid of tiles, each drawn from a cell of its tileset
+     * bitmap.
+     *
+     * @attribute class tilemap
+     */
+    typedef struct _tilemap_data *tilemap;
+
+    /**
+     * Create a new tilemap. The size of each tile is the cell size of the
+     * tileset, set with `bitmap_set_cell_details`, and can be changed with
+     * `tilemap_set_tile_size`. All of the tiles start empty.
+     *
+     * @param tileset The bitmap to draw the tiles from
+     * @param columns The number of tiles across the map
+     * @param rows    The number of tiles down the map
+     * @return        The new tilemap, or nullptr if the tileset is invalid or
+     *                its cells are larger than 2048 pixels across or down
+     *
+     * @attribute class tilemap
+     * @attribute constructor true
+     */
+    tilemap create_tilemap(bitmap tileset, int columns, int rows);
+
+    /**
+     * Free the tilemap and the bitmaps used to draw it.
+     *
+     * @param map The tilemap to free
+     *
+     * @attribute class tilemap
+     * @attribute destructor true
+     */
+    void free_tilemap(tilemap map);
+
+    /**
+     * The number of tiles across the tilemap.
+     *
+     * @param map The tilemap
+     * @return    The number of columns in the map
+     *
+     * @attribute class tilemap
+     * @attribute getter columns
+     */
+    int tilemap_columns(tilemap map);
+
+    /**
+     * The number of tiles down the tilemap.
+     *
+     * @param map The tilemap
+     * @return    The number of rows in the map
+     *
+     * @attribute class tilemap
+     * @attribute getter rows
+     */
+    int tilemap_rows(tilemap map);
+
+    /**
+     * The width of each tile of the tilemap.
+     *
+     * @param map The tilemap
+     * @return    The width of the tiles, in pixels
+     *
+     * @attribute class tilemap
+     * @attribute getter tile_width
+     */
+    int tilemap_tile_width(tilemap map);
+
+    /**
+     * The height of each tile of the tilemap.
+     *
+     * @param map The tilemap
+     * @return    The height of the tiles, in pixels
+     *
+     * @attribute class tilemap
+     * @attribute getter tile_height
+     */
+    int tilemap_tile_height(tilemap map);
+
+    /**
+     * Set the size of each tile of the tilemap, which is the distance
+     * between the tiles as they are drawn. Each tile still draws its whole
+     * cell of the tileset. All of the chunks are redrawn the next time the
+     * map is drawn.
+     *
+     * @param map     The tilemap
+     * @param width   The width of the tiles, from 1 to 2048 pixels
+     * @param height  The height of the tiles, from 1 to 2048 pixels
+     *
+     * @attribute class tilemap
+     * @attribute method set_tile_size
+     */
+    void tilemap_set_tile_size(tilemap map, int width, int height);
+
+    /**
+     * Get the cell of the tileset drawn at a tile of the map.
+     *
+     * @param map     The tilemap
+     * @param column  The column of the tile
+     * @param row     The row of the tile
+     * @return        The cell index, or -1 if the tile is empty or outside
+     *                the map
+     *
+     * @attribute class tilemap
+     * @attribute method tile
+     */
+    int tilemap_tile(tilemap map, int column, int row);
+
+    /**
+     * Set the cell of the tileset drawn at a tile of the map. Only the chunk
+     * holding the tile is redrawn the next time the map is drawn.
+     *
+     * @param map     The tilemap
+     * @param column  The column of the tile
+     * @param row     The row of the tile
+     * @param cell    The cell index to draw, or -1 to leave the tile empty
+     *
+     * @attribute class tilemap
+     * @attribute method set_tile
+     */
+    void tilemap_set_tile(tilemap map, int column, int row, int cell);
+
+    /**
+     * Set all of the tiles of the map at once.
+     *
+     * @param map   The tilemap
+     * @param cells The cell index of each tile, row by row from the top left.
+     *              Must contain columns * rows values, with -1 for empty
+     *              tiles.
+     *
+     * @attribute class tilemap
+     * @attribute method set_tiles
+     */
+    void tilemap_set_tiles(tilemap map, const vector<int> &cells);
+
+    /**
+     * Redraw all of the chunks of the map the next time it is drawn. Call
+     * this after drawing onto the tileset bitmap.
+     *
+     * @param map The tilemap
+     *
+     * @attribute class tilemap
+     * @attribute method refresh
+     */
+    void tilemap_refresh(tilemap map);
+
+    /**
+     * Draw the tilemap, with its top left at x, y.
+     *
+     * @param map The tilemap to draw
+     * @param x   The x location of the left of the map
+     * @param y   The y location of the top of the map
+     *
+     * @attribute class tilemap
+     * @attribute method draw
+     */
+    void draw_tilemap(tilemap map, double x, double y);
+
+    /**
+     * Draw the tilemap, with its top left at x, y. The destination and
+     * camera of the drawing options are used, and the other options are
+     * ignored.
+     *
+     * @param map   The tilemap to draw
+     * @param x     The x location of the left of the map
+     * @param y     The y location of the top of the map
+     * @param opts  The drawing options
+     *
+     * @attribute class tilemap
+     * @attribute method draw
+     * @attribute suffix with_options
+     */
+    void draw_tilemap(tilemap map, double x, double y, const drawing_options &opts);
+}
+
+#endif /* tilemap_h */
@@ -11,26 +11,60 @@
 #include "utils_driver.h"
 #include "backend_types.h"
 #include "utility_functions.h"
+#include "resource_registry.h"
 
 #include <map>
+#include <vector>
 
 using std::map;
+using std::vector;
+
+// Scheduled calls are kept in a wheel of 4 levels of 64 slots. Level 0 has
+// a slot for each millisecond, and each higher level covers 64 times as much.
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+// The low bits of a scheduled call id pick its slot in _calls
+#define SCHEDULED_CALL_SLOT_BITS 16
+#define SCHEDULED_CALL_SLOT_MASK ((1 << SCHEDULED_CALL_SLOT_BITS) - 1)
 
 namespace splashkit_lib
 {
-    static map<string, timer> _timers;
+    static resource_registry<timer> _timers;
 
     struct _timer_data
     {
         pointer_identifier id;
-        unsigned int start_ticks;
-        unsigned int paused_ticks;
+        long long start_ticks;      // in nanoseconds, see sk_get_ticks_ns
+        long long paused_ticks;
         bool paused;
         bool started;
         string name;
+        string key;                 // the name folded to lower case, as registered
     };
 
-    timer create_timer(string name)
+    // The registry key for a timer name. Names without capitals are used as
+    // they are, and others are folded into a buffer that is reused, so
+    // lookups by name do not allocate.
+    static const string &_timer_key(const string &name)
+    {
+        bool has_upper = false;
+        for (char c : name)
+        {
+            if ( c >= 'A' && c <= 'Z' ) { has_upper = true; break; }
+        }
+        if ( ! has_upper ) return name;
+
+        thread_local string key;
+        key.assign(name);
+        for (char &c : key)
+        {
+            if ( c >= 'A' && c <= 'Z' ) c = static_cast<char>(c - 'A' + 'a');
+        }
+        return key;
+    }
+
+    timer create_timer(const string &name)
     {
         if (has_timer(name)) return timer_named(name);
 
@@ -38,14 +72,21 @@ namespace splashkit_lib
         result = new(_timer_data);
         result->id = TIMER_PTR;
         result->name = name;
+        result->key = _timer_key(name);
 
         result->start_ticks = 0;
         result->paused_ticks = 0;
         result->paused = false;
         result->started = false;
 
-        _timers[to_lower(name)] = result;
-        return result;
+        // Another thread may have created the same name in the meantime
+        timer registered = _timers.insert(result->key, result);
+        if ( registered != result )
+        {
+            result->id = NONE_PTR;
+            delete(result);
+        }
+        return registered;
     }
 
     /**
@@ -64,7 +105,7 @@ namespace splashkit_lib
 
         notify_of_free(to_free);
 
-        _timers.erase(to_lower(to_free->name));
+        _timers.erase(to_free->key);
 
         to_free->id = NONE_PTR;
 
@@ -73,19 +114,17 @@ namespace splashkit_lib
 
     void free_all_timers()
     {
-        FREE_ALL_FROM_MAP(_timers, TIMER_PTR, free_timer);
+        FREE_ALL_FROM_REGISTRY(_timers, TIMER_PTR, free_timer);
     }
 
-    timer timer_named(string name)
+    timer timer_named(const string &name)
     {
-        if (not has_timer(name)) return nullptr;
-
-        return _timers[to_lower(name)];
+        return _timers.find(_timer_key(name));
     }
 
-    bool has_timer(string name)
+    bool has_timer(const string &name)
     {
-        return _timers.count(to_lower(name)) > 0;
+        return _timers.contains(_timer_key(name));
     }
 
     void start_timer(timer to_start)
@@ -98,10 +137,10 @@ namespace splashkit_lib
 
         to_start->started = true;
         to_start->paused = false;
-        to_start->start_ticks = sk_get_ticks();
+        to_start->start_ticks = sk_get_ticks_ns();
     }
 
-    void start_timer(string name)
+    void start_timer(const string &name)
     {
         start_timer(timer_named(name));
     }
@@ -118,7 +157,7 @@ namespace splashkit_lib
         to_stop->paused = false;
     }
 
-    void stop_timer(string name)
+    void stop_timer(const string &name)
     {
         stop_timer(timer_named(name));
     }
@@ -134,11 +173,11 @@ namespace splashkit_lib
         if (to_pause->started and (not to_pause->paused))
         {
             to_pause->paused = true;
-            to_pause->paused_ticks = sk_get_ticks() - to_pause->start_ticks;
+            to_pause->paused_ticks = sk_get_ticks_ns() - to_pause->start_ticks;
         }
     }
 
-    void pause_timer(string name)
+    void pause_timer(const string &name)
     {
         pause_timer(timer_named(name));
     }
@@ -154,12 +193,12 @@ namespace splashkit_lib
         if (to_resume->paused)
         {
             to_resume->paused = false;
-            to_resume->start_ticks = sk_get_ticks() - to_resume->paused_ticks;
+            to_resume->start_ticks = sk_get_ticks_ns() - to_resume->paused_ticks;
             to_resume->paused_ticks = 0;
         }
     }
 
-    void resume_timer(string name)
+    void resume_timer(const string &name)
     {
         resume_timer(timer_named(name));
     }
@@ -172,16 +211,16 @@ namespace splashkit_lib
             return;
         }
 
-        tmr->start_ticks = sk_get_ticks();
+        tmr->start_ticks = sk_get_ticks_ns();
         tmr->paused_ticks = 0;
     }
 
-    void reset_timer(string name)
+    void reset_timer(const string &name)
     {
         reset_timer(timer_named(name));
     }
 
-    unsigned int timer_ticks(timer to_get)
+    long long timer_ticks_ns(timer to_get)
     {
         if (INVALID_PTR(to_get, TIMER_PTR))
         {
@@ -194,13 +233,33 @@ namespace splashkit_lib
             if (to_get->paused)
                 return to_get->paused_ticks;
             else
-                return sk_get_ticks() - to_get->start_ticks;
+                return sk_get_ticks_ns() - to_get->start_ticks;
         }
 
         return 0;
     }
 
-    unsigned int timer_ticks(string name)
+    long long timer_ticks_ns(const string &name)
+    {
+        return timer_ticks_ns(timer_named(name));
+    }
+
+    long long timer_ticks_us(timer to_get)
+    {
+        return timer_ticks_ns(to_get) / 1000;
+    }
+
+    long long timer_ticks_us(const string &name)
+    {
+        return timer_ticks_us(timer_named(name));
+    }
+
+    unsigned int timer_ticks(timer to_get)
+    {
+        return static_cast<unsigned int>(timer_ticks_ns(to_get) / 1000000);
+    }
+
+    unsigned int timer_ticks(const string &name)
     {
         return timer_ticks(timer_named(name));
     }
@@ -216,7 +275,7 @@ namespace splashkit_lib
         return to_get->paused;
     }
 
-    bool timer_paused(string name)
+    bool timer_paused(const string &name)
     {
         return timer_paused(timer_named(name));
     }
@@ -232,8 +291,261 @@ namespace splashkit_lib
         return to_get->started;
     }
 
-    bool timer_started(string name)
+    bool timer_started(const string &name)
     {
         return timer_started(timer_named(name));
     }
+
+    //
+    // Scheduled calls
+    //
+    // Each call sits in one slot of the wheel, in a list linked through
+    // prev and next. Adding and cancelling a call is a fixed amount of work,
+    // and each update only looks at the slots for the milliseconds that have
+    // passed, moving calls down a level as their time gets close.
+    //
+
+    struct _scheduled_call
+    {
+        timer_callback *callback;
+        long long due;              // in milliseconds, on the wheel's clock
+        unsigned int interval;      // 0 for calls that happen once
+        unsigned int generation;    // changes each time the slot is reused
+        int prev, next;             // in the wheel slot's list, -1 at the ends
+        int *head;                  // the wheel slot holding this call, or nullptr
+        bool active;
+    };
+
+    static vector<_scheduled_call> _calls;
+    static vector<int> _free_calls;
+    static int _wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    static long long _wheel_time = -1;      // the last millisecond run
+    static int _pending_calls = 0;
+
+    static void _init_wheel()
+    {
+        if ( _wheel_time >= 0 ) return;
+
+        for (int level = 0; level < TIMER_WHEEL_LEVELS; level++)
+            for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++)
+                _wheel[level][slot] = -1;
+
+        _wheel_time = sk_get_ticks_ns() / 1000000;
+    }
+
+    static void _unlink_call(int idx)
+    {
+        _scheduled_call &call = _calls[idx];
+        if ( ! call.head ) return;
+
+        if ( call.prev >= 0 ) _calls[call.prev].next = call.next;
+        else *call.head = call.next;
+
+        if ( call.next >= 0 ) _calls[call.next].prev = call.prev;
+
+        call.head = nullptr;
+        call.prev = call.next = -1;
+    }
+
+    // Put the call in the slot of the lowest level that reaches its due
+    // time, which is moved on to earliest if it has already passed
+    static void _link_call(int idx, long long earliest)
+    {
+        _scheduled_call &call = _calls[idx];
+        if ( call.due < earliest ) call.due = earliest;
+
+        long long delta = call.due - _wheel_time;
+        long long at = call.due;
+        int level = 0;
+
+        while ( level < TIMER_WHEEL_LEVELS - 1 && delta >= (1LL << (TIMER_WHEEL_BITS * (level + 1))) )
+            level++;
+
+        // beyond the top level, wait in its furthest slot and be placed again later
+        long long top_range = 1LL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS);
+        if ( delta >= top_range ) at = _wheel_time + top_range - 1;
+
+        int slot = static_cast<int>((at >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+        int *head = &_wheel[level][slot];
+
+        call.head = head;
+        call.prev = -1;
+        call.next = *head;
+        if ( *head >= 0 ) _calls[*head].prev = idx;
+        *head = idx;
+    }
+
+    static int _schedule_call(unsigned int ms, unsigned int interval, timer_callback *callback)
+    {
+        if ( ! callback )
+        {
+            LOG(WARNING) << "Attempting to schedule a call without a callback";
+            return -1;
+        }
+
+        _init_wheel();
+
+        int idx;
+        if ( _free_calls.empty() )
+        {
+            if ( _calls.size() > SCHEDULED_CALL_SLOT_MASK )
+            {
+                LOG(WARNING) << "Unable to schedule more than " << SCHEDULED_CALL_SLOT_MASK + 1 << " calls";
+                return -1;
+            }
+
+            idx = static_cast<int>(_calls.size());
+            _calls.push_back({ nullptr, 0, 0, 0, -1, -1, nullptr, false });
+        }
+        else
+        {
+            idx = _free_calls.back();
+            _free_calls.pop_back();
+        }
+
+        _scheduled_call &call = _calls[idx];
+        call.callback = callback;
+        call.due = sk_get_ticks_ns() / 1000000 + ms;
+        call.interval = interval;
+        call.active = true;
+        _link_call(idx, _wheel_time + 1);
+        _pending_calls++;
+
+        return static_cast<int>(((call.generation & 0x7fff) << SCHEDULED_CALL_SLOT_BITS) | idx);
+    }
+
+    int call_after(unsigned int ms, timer_callback *callback)
+    {
+        return _schedule_call(ms, 0, callback);
+    }
+
+    int call_every(unsigned int ms, timer_callback *callback)
+    {
+        return _schedule_call(ms, ms > 0 ? ms : 1, callback);
+    }
+
+    // The index of the active call with this id, or -1
+    static int _scheduled_call_index(int id)
+    {
+        if ( id < 0 ) return -1;
+
+        int idx = id & SCHEDULED_CALL_SLOT_MASK;
+        if ( idx >= _calls.size() ) return -1;
+
+        const _scheduled_call &call = _calls[idx];
+        if ( ! call.active || (call.generation & 0x7fff) != static_cast<unsigned int>(id >> SCHEDULED_CALL_SLOT_BITS) ) return -1;
+
+        return idx;
+    }
+
+    static void _release_call(int idx)
+    {
+        _scheduled_call &call = _calls[idx];
+        _unlink_call(idx);
+        call.active = false;
+        call.callback = nullptr;
+        call.generation++;
+        _free_calls.push_back(idx);
+        _pending_calls--;
+    }
+
+    void cancel_scheduled_call(int id)
+    {
+        int idx = _scheduled_call_index(id);
+        if ( idx < 0 ) return;
+
+        _release_call(idx);
+    }
+
+    bool has_scheduled_call(int id)
+    {
+        return _scheduled_call_index(id) >= 0;
+    }
+
+    void cancel_all_scheduled_calls()
+    {
+        for (int i = 0; i < _calls.size(); i++)
+        {
+            if ( _calls[i].active ) _release_call(i);
+        }
+
+        // with the wheel empty it restarts from the clock on the next call
+        _wheel_time = -1;
+    }
+
+    // Move the calls in a higher level slot down to where they now belong
+    static void _cascade(int level)
+    {
+        int slot = static_cast<int>((_wheel_time >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+        int idx = _wheel[level][slot];
+        _wheel[level][slot] = -1;
+
+        while ( idx >= 0 )
+        {
+            int next = _calls[idx].next;
+            _calls[idx].head = nullptr;
+            // calls due now go in the level 0 slot that is about to run
+            _link_call(idx, _wheel_time);
+            idx = next;
+        }
+
+        if ( slot == 0 && level + 1 < TIMER_WHEEL_LEVELS ) _cascade(level + 1);
+    }
+
+    // Make the calls that are due by now, in milliseconds on the same clock
+    // as sk_get_ticks_ns
+    void _run_scheduled_calls_until(long long now)
+    {
+        if ( _wheel_time < 0 ) return;
+
+        while ( _wheel_time < now )
+        {
+            // nothing waiting, so there is no need to step through each millisecond
+            if ( _pending_calls == 0 )
+            {
+                _wheel_time = now;
+                return;
+            }
+
+            _wheel_time++;
+
+            int slot = static_cast<int>(_wheel_time & (TIMER_WHEEL_SLOTS - 1));
+            if ( slot == 0 ) _cascade(1);
+
+            int *head = &_wheel[0][slot];
+            while ( *head >= 0 )
+            {
+                int idx = *head;
+                _unlink_call(idx);
+
+                _scheduled_call &call = _calls[idx];
+                timer_callback *callback = call.callback;
+                unsigned int generation = call.generation;
+                int id = static_cast<int>(((generation & 0x7fff) << SCHEDULED_CALL_SLOT_BITS) | idx);
+
+                callback(id);
+
+                // the callback may have cancelled every call, restarting the wheel
+                if ( _wheel_time < 0 ) return;
+
+                // the callback may have cancelled the call, or scheduled others
+                _scheduled_call &after = _calls[idx];
+                if ( ! after.active || after.generation != generation ) continue;
+
+                if ( after.interval > 0 )
+                {
+                    after.due += after.interval;
+                    _link_call(idx, _wheel_time + 1);
+                }
+                else
+                    _release_call(idx);
+            }
+        }
+    }
+
+    // Called each frame from process_events
+    void _run_scheduled_calls()
+    {
+        _run_scheduled_calls_until(sk_get_ticks_ns() / 1000000);
+    }
 }
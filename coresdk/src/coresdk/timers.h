@@ -24,6 +24,15 @@ namespace splashkit_lib
      */
     typedef struct _timer_data *timer;
 
+    /**
+     * The `timer_callback` is a function pointer used to register your code
+     * to be called once a set time has passed. See `call_after` and
+     * `call_every`.
+     *
+     * @param id The id of the scheduled call that is running
+     */
+    typedef void (timer_callback)(int id);
+
     /**
      * Create and return a new Timer. The timer will not be started, and will have
      * an initial 'ticks' of 0.
@@ -34,7 +43,7 @@ namespace splashkit_lib
      * @param  name The name of the timer for resource tracking
      * @return      A new timer.
      */
-    timer create_timer(string name);
+    timer create_timer(const string &name);
 
     /**
      * Free the memory used to store this timer.
@@ -57,7 +66,7 @@ namespace splashkit_lib
      * @param  name The name of the timer to fetch
      * @return      Returns the timer fetched from SplashKit
      */
-    timer timer_named(string name);
+    timer timer_named(const string &name);
 
     /**
      * Checks if SplashKit has a timer with the indicated name.
@@ -67,7 +76,7 @@ namespace splashkit_lib
      *
      * @attribute suffix _named
      */
-    bool has_timer(string name);
+    bool has_timer(const string &name);
 
     /**
      * Start a timer. The timer will then start recording the time that has passed.
@@ -90,7 +99,7 @@ namespace splashkit_lib
      *
      * @attribute suffix _named
      */
-    void start_timer(string name);
+    void start_timer(const string &name);
 
     /**
      * Stop the timer. The time is reset to 0 and you must
@@ -111,7 +120,7 @@ namespace splashkit_lib
      *
      * @attribute suffix _named
      */
-    void stop_timer(string name);
+    void stop_timer(const string &name);
 
     /**
      * Pause the timer, getting ticks from a paused timer
@@ -132,7 +141,7 @@ namespace splashkit_lib
      *
      * @attribute suffix _named
      */
-    void pause_timer(string name);
+    void pause_timer(const string &name);
 
     /**
      * Resumes a paused timer.
@@ -151,7 +160,7 @@ namespace splashkit_lib
      *
      * @attribute suffix _named
      */
-    void resume_timer(string name);
+    void resume_timer(const string &name);
 
     /**
      * Resets the time of a given timer
@@ -170,7 +179,7 @@ namespace splashkit_lib
      *
      * @attribute suffix _named
      */
-    void reset_timer(string name);
+    void reset_timer(const string &name);
 
     /**
      * Gets the number of ticks (milliseconds) that have passed since the timer
@@ -199,7 +208,63 @@ namespace splashkit_lib
      *
      * @attribute suffix _named
      */
-    unsigned int timer_ticks(string name);
+    unsigned int timer_ticks(const string &name);
+
+    /**
+     * Gets the number of microseconds that have passed since the timer was
+     * started/reset. This uses a high resolution clock, so it can time work
+     * that takes less than a millisecond.
+     *
+     * @attribute class timer
+     * @attribute getter ticks_us
+     *
+     * @param  to_get The timer
+     * @return        The number of microseconds that have passed since the
+     *                timer was started (excluding the time the timer was
+     *                paused)
+     */
+    long long timer_ticks_us(timer to_get);
+
+    /**
+     * Gets the number of microseconds that have passed since the timer was
+     * started/reset.
+     *
+     * @param  name The name of the Timer
+     * @return      The number of microseconds that have passed since the
+     *              timer was started (excluding the time the timer was
+     *              paused)
+     *
+     * @attribute suffix _named
+     */
+    long long timer_ticks_us(const string &name);
+
+    /**
+     * Gets the number of nanoseconds that have passed since the timer was
+     * started/reset. This uses a high resolution clock, so it can time work
+     * that takes less than a millisecond.
+     *
+     * @attribute class timer
+     * @attribute getter ticks_ns
+     *
+     * @param  to_get The timer
+     * @return        The number of nanoseconds that have passed since the
+     *                timer was started (excluding the time the timer was
+     *                paused)
+     */
+    long long timer_ticks_ns(timer to_get);
+
+    /**
+     * Gets the number of nanoseconds that have passed since the timer was
+     * started/reset.
+     *
+     * @param  name The name of the Timer
+     * @return      The number of nanoseconds that have passed since the
+     *              timer was started (excluding the time the timer was
+     *              paused)
+     *
+     * @attribute suffix _named
+     */
+    long long timer_ticks_ns(const string &name);
 
     /**
      * Indicates if the timer is paused.
@@ -220,7 +285,7 @@ namespace splashkit_lib
      *
      * @attribute suffix _named
      */
-    bool timer_paused(string name);
+    bool timer_paused(const string &name);
 
     /**
      * Indicates if the timer is started.
@@ -241,7 +306,55 @@ namespace splashkit_lib
      *
      * @attribute suffix _named
      */
-    bool timer_started(string name);
+    bool timer_started(const string &name);
+
+    /**
+     * Register a function to be called once, after the time has passed. The
+     * call is made from `process_events`, so it happens on the first frame
+     * after the time is up. Scheduled calls cost nothing each frame until
+     * they are due, so you can have thousands waiting.
+     *
+     * @param ms        The number of milliseconds to wait
+     * @param callback  The function to call
+     * @return          The id of the scheduled call, or -1 if it could not
+     *                  be scheduled
+     */
+    int call_after(unsigned int ms, timer_callback *callback);
+
+    /**
+     * Register a function to be called repeatedly, each time the interval
+     * passes, until it is cancelled. Calls are made from `process_events`.
+     * After a long frame the missed calls are made one after another, so the
+     * function is called the right number of times.
+     *
+     * @param ms        The number of milliseconds between calls
+     * @param callback  The function to call
+     * @return          The id of the scheduled call, or -1 if it could not
+     *                  be scheduled
+     */
+    int call_every(unsigned int ms, timer_callback *callback);
+
+    /**
+     * Stop a scheduled call from happening. A callback can cancel its own
+     * id to stop repeating. Ids that have already finished are ignored.
+     *
+     * @param id The id returned from `call_after` or `call_every`
+     */
+    void cancel_scheduled_call(int id);
+
+    /**
+     * Check if a scheduled call is still waiting to be made.
+     *
+     * @param id The id returned from `call_after` or `call_every`
+     * @return   True if the call has not yet been made, or repeats and has
+     *           not been cancelled
+     */
+    bool has_scheduled_call(int id);
+
+    /**
+     * Cancel all scheduled calls.
+     */
+    void cancel_all_scheduled_calls();
 }
 
 #endif /* timers_hpp */
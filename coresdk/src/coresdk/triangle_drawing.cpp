@@ -19,7 +19,7 @@
 #include "graphics_driver.h"
 namespace splashkit_lib
 {
-    void draw_triangle(color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts)
+    void draw_triangle(color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts)
     {
         sk_drawing_surface *surface;
 
@@ -40,7 +40,7 @@ namespace splashkit_lib
         draw_triangle(clr, x1, y1, x2, y2, x3, y3, option_defaults());
     }
 
-    void draw_triangle(color clr, const triangle &tri, drawing_options opts)
+    void draw_triangle(color clr, const triangle &tri, const drawing_options &opts)
     {
         draw_triangle(clr,
                       tri.points[0].x, tri.points[0].y,
@@ -58,7 +58,7 @@ namespace splashkit_lib
                       option_defaults());
     }
 
-    void fill_triangle(color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts)
+    void fill_triangle(color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts)
     {
         sk_drawing_surface *surface;
 
@@ -79,7 +79,7 @@ namespace splashkit_lib
         fill_triangle(clr, x1, y1, x2, y2, x3, y3, option_defaults());
     }
 
-    void fill_triangle(color clr, const triangle &tri, drawing_options opts)
+    void fill_triangle(color clr, const triangle &tri, const drawing_options &opts)
     {
         fill_triangle(clr,
                       tri.points[0].x, tri.points[0].y,
@@ -97,7 +97,7 @@ namespace splashkit_lib
                       option_defaults());
     }
 
-    void draw_triangle_on_bitmap(bitmap destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts)
+    void draw_triangle_on_bitmap(bitmap destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts)
     {
         draw_triangle(clr, x1, y1, x2, y2, x3, y3, option_draw_to(destination, opts));
     }
@@ -107,7 +107,7 @@ namespace splashkit_lib
         draw_triangle(clr, x1, y1, x2, y2, x3, y3, option_draw_to(destination));
     }
 
-    void draw_triangle_on_bitmap(bitmap destination, color clr, const triangle &tri, drawing_options opts)
+    void draw_triangle_on_bitmap(bitmap destination, color clr, const triangle &tri, const drawing_options &opts)
     {
         draw_triangle(clr, tri, option_draw_to(destination, opts));
     }
@@ -117,7 +117,7 @@ namespace splashkit_lib
         draw_triangle(clr, tri, option_draw_to(destination));
     }
 
-    void fill_triangle_on_bitmap(bitmap destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts)
+    void fill_triangle_on_bitmap(bitmap destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts)
     {
         fill_triangle(clr, x1, y1, x2, y2, x3, y3, option_draw_to(destination, opts));
     }
@@ -127,7 +127,7 @@ namespace splashkit_lib
         fill_triangle(clr, x1, y1, x2, y2, x3, y3, option_draw_to(destination));
     }
 
-    void fill_triangle_on_bitmap(bitmap destination, color clr, const triangle &tri, drawing_options opts)
+    void fill_triangle_on_bitmap(bitmap destination, color clr, const triangle &tri, const drawing_options &opts)
     {
         fill_triangle(clr, tri, option_draw_to(destination, opts));
     }
@@ -137,7 +137,7 @@ namespace splashkit_lib
         fill_triangle(clr, tri, option_draw_to(destination));
     }
     
-    void draw_triangle_on_window(window destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts)
+    void draw_triangle_on_window(window destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts)
     {
         draw_triangle(clr, x1, y1, x2, y2, x3, y3, option_draw_to(destination, opts));
     }
@@ -147,7 +147,7 @@ namespace splashkit_lib
         draw_triangle(clr, x1, y1, x2, y2, x3, y3, option_draw_to(destination));
     }
     
-    void draw_triangle_on_window(window destination, color clr, const triangle &tri, drawing_options opts)
+    void draw_triangle_on_window(window destination, color clr, const triangle &tri, const drawing_options &opts)
     {
         draw_triangle(clr, tri, option_draw_to(destination, opts));
     }
@@ -157,7 +157,7 @@ namespace splashkit_lib
         draw_triangle(clr, tri, option_draw_to(destination));
     }
     
-    void fill_triangle_on_window(window destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts)
+    void fill_triangle_on_window(window destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts)
     {
         fill_triangle(clr, x1, y1, x2, y2, x3, y3, option_draw_to(destination, opts));
     }
@@ -167,7 +167,7 @@ namespace splashkit_lib
         fill_triangle(clr, x1, y1, x2, y2, x3, y3, option_draw_to(destination));
     }
     
-    void fill_triangle_on_window(window destination, color clr, const triangle &tri, drawing_options opts)
+    void fill_triangle_on_window(window destination, color clr, const triangle &tri, const drawing_options &opts)
     {
         fill_triangle(clr, tri, option_draw_to(destination, opts));
     }
@@ -33,7 +33,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  with_options
      */
-    void draw_triangle(color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts);
+    void draw_triangle(color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts);
 
     /**
      * Draw a triangle to the current window.
@@ -63,7 +63,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  record_with_options
      */
-    void draw_triangle(color clr, const triangle &tri, drawing_options opts);
+    void draw_triangle(color clr, const triangle &tri, const drawing_options &opts);
 
     /**
      * Draw a triangle onto the current window.
@@ -95,7 +95,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  with_options
      */
-    void fill_triangle(color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts);
+    void fill_triangle(color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts);
 
     /**
      * Fills a triangle on the current window.
@@ -125,7 +125,7 @@ namespace splashkit_lib
      *
      * @attribute suffix  record_with_options
      */
-    void fill_triangle(color clr, const triangle &tri, drawing_options opts);
+    void fill_triangle(color clr, const triangle &tri, const drawing_options &opts);
 
     /**
      * Draw a triangle onto the current window.
@@ -161,7 +161,7 @@ namespace splashkit_lib
      * @attribute suffix  with_options
      * @attribute method  draw_triangle
      */
-    void draw_triangle_on_window(window destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts);
+    void draw_triangle_on_window(window destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts);
 
     /**
      * Draw a triangle to the given window.
@@ -198,7 +198,7 @@ namespace splashkit_lib
      * @attribute suffix  record_with_options
      * @attribute method  draw_triangle
      */
-    void draw_triangle_on_window(window destination, color clr, const triangle &tri, drawing_options opts);
+    void draw_triangle_on_window(window destination, color clr, const triangle &tri, const drawing_options &opts);
 
     /**
      * Draw a triangle on a given window, using the supplied drawing options.
@@ -236,7 +236,7 @@ namespace splashkit_lib
      * @attribute suffix  with_options
      * @attribute method  fill_triangle
      */
-    void fill_triangle_on_window(window destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts);
+    void fill_triangle_on_window(window destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts);
 
     /**
      * Fill a triangle on a given window
@@ -273,7 +273,7 @@ namespace splashkit_lib
      * @attribute suffix  record_with_options
      * @attribute method  fill_triangle
      */
-    void fill_triangle_on_window(window destination, color clr, const triangle &tri, drawing_options opts);
+    void fill_triangle_on_window(window destination, color clr, const triangle &tri, const drawing_options &opts);
 
     /**
      * Fill a triangle on a given window
@@ -311,7 +311,7 @@ namespace splashkit_lib
      * @attribute suffix  with_options
      * @attribute method  draw_triangle
      */
-    void draw_triangle_on_bitmap(bitmap destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts);
+    void draw_triangle_on_bitmap(bitmap destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts);
 
     /**
      * Draw a triangle to the given bitmap.
@@ -348,7 +348,7 @@ namespace splashkit_lib
      * @attribute suffix  record_with_options
      * @attribute method  draw_triangle
      */
-    void draw_triangle_on_bitmap(bitmap destination, color clr, const triangle &tri, drawing_options opts);
+    void draw_triangle_on_bitmap(bitmap destination, color clr, const triangle &tri, const drawing_options &opts);
 
     /**
      * Draw a triangle on a given bitmap, using the supplied drawing options.
@@ -386,7 +386,7 @@ namespace splashkit_lib
      * @attribute suffix  with_options
      * @attribute method  fill_triangle
      */
-    void fill_triangle_on_bitmap(bitmap destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, drawing_options opts);
+    void fill_triangle_on_bitmap(bitmap destination, color clr, double x1, double y1, double x2, double y2, double x3, double y3, const drawing_options &opts);
 
     /**
      * Fill a triangle on a given bitmap
@@ -423,7 +423,7 @@ namespace splashkit_lib
      * @attribute suffix  record_with_options
      * @attribute method  fill_triangle
      */
-    void fill_triangle_on_bitmap(bitmap destination, color clr, const triangle &tri, drawing_options opts);
+    void fill_triangle_on_bitmap(bitmap destination, color clr, const triangle &tri, const drawing_options &opts);
 
     /**
      * Fill a triangle on a given bitmap
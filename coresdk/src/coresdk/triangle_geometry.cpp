@@ -8,11 +8,15 @@
 
 #include "geometry.h"
 
+#include <array>
 #include <vector>
 using std::vector;
 
 namespace splashkit_lib
 {
+    // from line_geometry
+    std::array<line, 3> _lines_from(const triangle &t);
+
     triangle triangle_from(double x1, double y1, double x2, double y2, double x3, double y3)
     {
         triangle result;
@@ -110,8 +114,8 @@ namespace splashkit_lib
             if ( point_in_triangle(t1.points[i], t2) || point_in_triangle(t2.points[i], t1) ) return true;
         }
 
-        vector<line> t1_lines = lines_from(t1);
-        vector<line> t2_lines = lines_from(t2);
+        std::array<line, 3> t1_lines = _lines_from(t1);
+        std::array<line, 3> t2_lines = _lines_from(t2);
 
         // Check if any lines intersect (check first two of both, as if they do not intersect then
         // it cant intersect the third either)
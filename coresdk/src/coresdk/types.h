@@ -37,6 +37,23 @@ namespace splashkit_lib
         float r, g, b, a;
     };
 
+    /**
+     * A color packed into four bytes, as it is stored in bitmaps and sent to
+     * the graphics card. Packed colors take a quarter of the memory of a
+     * `color` and are drawn without being converted, so they suit drawing
+     * large numbers of differently colored shapes such as gradients and
+     * heatmaps.
+     *
+     * @field r   The red component of the color (between 0 and 255)
+     * @field g   The green component of the color (between 0 and 255)
+     * @field b   The blue component of the color (between 0 and 255)
+     * @field a   The alpha component of the color (between 0 and 255)
+     */
+    struct rgba8
+    {
+        uint8_t r, g, b, a;
+    };
+
     /**
      * Bitmaps represent image resources in SplashKit. You can load these from
      * file, download them from the internet, or create and draw them yourself.
@@ -285,6 +302,7 @@ namespace splashkit_lib
      * @constant HTTP_STATUS_MOVED_PERMANENTLY          The URL of the requested resource has been changed permanently.
      * @constant HTTP_STATUS_FOUND                      The URI of requested resource has been changed temporarily.
      * @constant HTTP_STATUS_SEE_OTHER                  The server sent this response to direct the client to get the requested resource at another URI with a GET request.
+     * @constant HTTP_STATUS_NOT_MODIFIED               The resource has not changed since the version the client already has.
      * @constant HTTP_STATUS_BAD_REQUEST                The server cannot or will not process the request due to an apparent client error.
      * @constant HTTP_STATUS_UNAUTHORIZED               The server requires authentication or has failed to process provided authentication.
      * @constant HTTP_STATUS_FORBIDDEN                  The request was a valid request, but the server is refusing to respond to it.
@@ -304,6 +322,7 @@ namespace splashkit_lib
         HTTP_STATUS_MOVED_PERMANENTLY = 301,
         HTTP_STATUS_FOUND = 302,
         HTTP_STATUS_SEE_OTHER = 303,
+        HTTP_STATUS_NOT_MODIFIED = 304,
         HTTP_STATUS_BAD_REQUEST = 400,
         HTTP_STATUS_UNAUTHORIZED = 401,
         HTTP_STATUS_FORBIDDEN = 403,
@@ -459,6 +478,20 @@ namespace splashkit_lib
         PUD_UP = 2
     };
 
+    /**
+     * GPIO Edges, the changes in a pin's value that can be watched for:
+     *
+     * @constant GPIO_RISING_EDGE   The pin changes from low to high.
+     * @constant GPIO_FALLING_EDGE  The pin changes from high to low.
+     * @constant GPIO_EITHER_EDGE   The pin changes in either direction.
+     */
+    enum gpio_edge
+    {
+        GPIO_RISING_EDGE = 0,
+        GPIO_FALLING_EDGE = 1,
+        GPIO_EITHER_EDGE = 2
+    };
+
     /**
      * Use these interface styles as a way to quickly
      * customize your interface.
@@ -479,5 +512,25 @@ namespace splashkit_lib
         BUBBLE = 4,
         BUBBLE_MULTICOLORED = 5
     };
+
+    /**
+     * Effects applied to everything shown in a window, as it is refreshed.
+     *
+     * @constant COLOR_GRADE_EFFECT  Multiplies each pixel by the color, to
+     *                               tint or darken the whole window.
+     * @constant VIGNETTE_EFFECT     Fades the edges of the window towards the
+     *                               color.
+     * @constant SCANLINES_EFFECT    Darkens every second row with the color,
+     *                               like an old CRT screen.
+     * @constant BLOOM_EFFECT        Adds a soft glow around the bright areas,
+     *                               tinted by the color.
+     */
+    enum post_effect_kind
+    {
+        COLOR_GRADE_EFFECT = 0,
+        VIGNETTE_EFFECT = 1,
+        SCANLINES_EFFECT = 2,
+        BLOOM_EFFECT = 3
+    };
 }
 #endif /* types_hpp */
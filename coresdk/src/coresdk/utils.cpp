@@ -9,6 +9,7 @@
 #include "utils.h"
 #include "input.h"
 #include "utils_driver.h"
+#include "input_driver.h"
 #include "resources.h"
 #include "input.h"
 #include "text.h"
@@ -18,6 +19,7 @@
 #include <iostream>
 #include <string>
 #include <fstream>
+#include <iterator>
 
 using std::string;
 using std::ifstream;
@@ -27,28 +29,64 @@ namespace splashkit_lib
     // from window manager
     unsigned int number_open_windows();
 
+    // from networking
+    bool _network_needs_polling();
+    bool _wait_for_network_data(unsigned long long seen, int timeout_ms);
+
+    // Window events and sockets without an event backend have nothing to
+    // wait on, so they are checked at this interval while idle
+    #define ACTIVITY_POLL_MS 5
+
+    // Longest gap between process_events calls during a delay
+    #define DELAY_EVENT_INTERVAL_MS 50
+
+    bool wait_for_activity(int milliseconds)
+    {
+        unsigned long long seen = sk_activity_count();
+        long long deadline = sk_get_ticks_ns() + milliseconds * 1000000LL;
+
+        while (true)
+        {
+            bool windows_open = number_open_windows() > 0;
+            if ( windows_open && sk_has_pending_events() ) return true;
+
+            long long remaining = (deadline - sk_get_ticks_ns() + 999999) / 1000000;
+            if ( remaining <= 0 ) return false;
+
+            bool sockets = _network_needs_polling();
+            int wait_ms = static_cast<int>(remaining);
+            if ( (windows_open || sockets) && wait_ms > ACTIVITY_POLL_MS ) wait_ms = ACTIVITY_POLL_MS;
+
+            if ( sockets ? _wait_for_network_data(seen, wait_ms) : sk_wait_for_activity(seen, wait_ms) )
+                return true;
+        }
+    }
+
     void delay(int milliseconds)
     {
-        if (milliseconds > 0)
+        if (milliseconds <= 0) return;
+
+        if (milliseconds < DELAY_EVENT_INTERVAL_MS)
         {
-            if (milliseconds < 50)
-                sk_delay(milliseconds);
-            else
+            sk_delay(milliseconds);
+            return;
+        }
+
+        // Wait on events, sockets and web requests rather than sleeping, so
+        // activity is serviced as it arrives and a quit ends the delay early
+        long long deadline = sk_get_ticks_ns() + milliseconds * 1000000LL;
+
+        while (true)
+        {
+            long long remaining = (deadline - sk_get_ticks_ns() + 999999) / 1000000;
+            if ( remaining <= 0 ) return;
+
+            wait_for_activity(remaining < DELAY_EVENT_INTERVAL_MS ? static_cast<int>(remaining) : DELAY_EVENT_INTERVAL_MS);
+
+            if ( number_open_windows() > 0 )
             {
-                unsigned int t;
-                for (t = 1; t < milliseconds / 50; t++)
-                {
-                    if ( number_open_windows() > 0 )
-                    {
-                        process_events();
-                        if ( quit_requested() ) return;
-                    }
-
-                    sk_delay(50);
-                }
-                t = milliseconds % 50;
-
-                if (t > 0) sk_delay(t);
+                process_events();
+                if ( quit_requested() ) return;
             }
         }
     }
@@ -58,17 +96,25 @@ namespace splashkit_lib
         return sk_get_ticks();
     }
 
+    long long current_ticks_us()
+    {
+        return sk_get_ticks_ns() / 1000;
+    }
+
+    long long current_ticks_ns()
+    {
+        return sk_get_ticks_ns();
+    }
+
     string file_as_string(string filename, resource_kind kind)
     {
         string path = path_to_resource(filename, kind);
 
+        // Read in one pass, in text mode so line endings are translated as
+        // the line by line read did, keeping the final newline it added
         ifstream ifs(path);
-        std::string line;
-        std::string result = "";
-        while(getline(ifs, line))
-        {
-            result += line + "\n";
-        }
+        string result((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        if ( ! result.empty() && result.back() != '\n' ) result += '\n';
 
         return result;
     }
@@ -29,6 +29,19 @@ namespace splashkit_lib
      */
     void delay(int milliseconds);
 
+    /**
+     * Waits until there is something for the program to respond to, or until
+     * the time runs out. SplashKit wakes as soon as a window event arrives,
+     * a network connection receives data, or a web server receives a
+     * request. Any network messages that arrive are read, ready for you to
+     * fetch. Use this in place of `delay` when you want to idle without
+     * adding latency.
+     *
+     * @param milliseconds  The longest time to wait, in milliseconds
+     * @returns             True if activity woke the wait, false if the time ran out
+     */
+    bool wait_for_activity(int milliseconds);
+
     /**
      * Gets the number of milliseconds that have passed since the program was
      * started.
@@ -37,6 +50,22 @@ namespace splashkit_lib
      */
     unsigned int current_ticks();
 
+    /**
+     * Gets the number of microseconds that have passed since the program was
+     * started. This uses a high resolution clock, and does not wrap.
+     *
+     * @return The number of microseconds passed
+     */
+    long long current_ticks_us();
+
+    /**
+     * Gets the number of nanoseconds that have passed since the program was
+     * started. This uses a high resolution clock, and does not wrap.
+     *
+     * @return The number of nanoseconds passed
+     */
+    long long current_ticks_ns();
+
     /**
      * Return a SplashKit resource of `resource_kind` with name `filename`
      * as a string.
@@ -56,6 +56,74 @@ namespace splashkit_lib
         return http_post(url, port, body, {});
     }
 
+    http_async_request make_async_request(http_method request_type, const string &uri, unsigned short port, const string &body, const vector<string> &headers)
+    {
+        sk_http_request request;
+
+        request.id = HTTP_REQUEST_PTR;
+        request.method = request_type;
+        request.uri = uri;
+        request.port = port;
+        request.body = body;
+        request.filename = "";
+        request.headers = headers;
+        request.server = nullptr;
+
+        return sk_http_start_request(request);
+    }
+
+    http_async_request http_get_async(const string &url, unsigned short port)
+    {
+        return make_async_request(HTTP_GET_METHOD, url, port, "", {});
+    }
+
+    http_async_request http_post_async(const string &url, unsigned short port, const string &body, const vector<string> &headers)
+    {
+        return make_async_request(HTTP_POST_METHOD, url, port, body, headers);
+    }
+
+    http_async_request http_post_async(const string &url, unsigned short port, const string &body)
+    {
+        return http_post_async(url, port, body, {});
+    }
+
+    bool http_request_done(http_async_request request)
+    {
+        if ( INVALID_PTR(request, HTTP_ASYNC_REQUEST_PTR) )
+        {
+            LOG(WARNING) << "Attempting to check an invalid http request";
+            return true;
+        }
+
+        return sk_http_request_done(request);
+    }
+
+    http_response http_response_of(http_async_request request)
+    {
+        if ( INVALID_PTR(request, HTTP_ASYNC_REQUEST_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get the response of an invalid http request";
+            return nullptr;
+        }
+
+        return sk_http_request_response(request);
+    }
+
+    void free_http_request(http_async_request request)
+    {
+        if ( INVALID_PTR(request, HTTP_ASYNC_REQUEST_PTR) )
+        {
+            LOG(WARNING) << "Attempting to free an invalid http request";
+            return;
+        }
+
+        http_response response = sk_http_request_response(request);
+        if ( response ) free_response(response);
+
+        notify_of_free(request);
+        sk_http_free_request(request);
+    }
+
     void save_response_to_file(http_response response, string filename)
     {
         ofstream file(filename, ios::binary);
@@ -74,23 +142,95 @@ namespace splashkit_lib
         return string(response->message);
     }
 
-    bool download_file(const string &name, const string &url, unsigned short port, string &path)
+    // Around the number of connections a browser opens to a server
+    #define HTTP_GET_MANY_CONNECTIONS 6
+
+    vector<http_response> http_get_many(const vector<string> &urls, unsigned short port, int max_connections)
     {
-        http_response response = http_get(url, port);
+        return sk_http_get_many(urls, port, max_connections);
+    }
 
-        if ( !response )
+    vector<http_response> http_get_many(const vector<string> &urls, unsigned short port)
+    {
+        return http_get_many(urls, port, HTTP_GET_MANY_CONNECTIONS);
+    }
+
+    struct _download_target
+    {
+        FILE                    *file;
+        http_data_handler       *on_data;
+        http_progress_handler   *progress;
+    };
+
+    static bool _write_download(const char *data, size_t size, void *context)
+    {
+        _download_target *target = static_cast<_download_target *>(context);
+
+        if ( target->file )
+            return fwrite(data, 1, size, target->file) == size;
+
+        return target->on_data(const_cast<char *>(data), static_cast<int>(size));
+    }
+
+    static bool _report_download(long long received, long long total, void *context)
+    {
+        _download_target *target = static_cast<_download_target *>(context);
+        target->progress(received, total);
+        return true;
+    }
+
+    bool _stream_download(const string &url, unsigned short port, _download_target &target)
+    {
+        long status;
+        bool result = sk_http_get_stream(url, port, &_write_download, target.progress ? &_report_download : nullptr, &target, status);
+
+        if ( ! result && status >= 300 )
         {
+            LOG(WARNING) << "Unable to download file from " << url << " got status " << status;
+        }
+
+        return result;
+    }
+
+    bool download_to_file(const string &url, unsigned short port, const string &path, http_progress_handler *progress)
+    {
+        FILE *file = fopen(path.c_str(), "wb");
+        if ( ! file )
+        {
+            LOG(WARNING) << "Unable to open " << path << " to download " << url;
             return false;
         }
 
-        auto cleanup_response = finally( [&] { free_response(response); });
+        _download_target target = { file, nullptr, progress };
+        bool result = _stream_download(url, port, target);
+
+        fclose(file);
 
-        if ( static_cast<int>(response->code) < 200 || static_cast<int>(response->code) >= 300 )
+        // do not leave part of a file behind
+        if ( ! result ) remove(path.c_str());
+
+        return result;
+    }
+
+    bool download_to_file(const string &url, unsigned short port, const string &path)
+    {
+        return download_to_file(url, port, path, nullptr);
+    }
+
+    bool http_get_streamed(const string &url, unsigned short port, http_data_handler *on_data, http_progress_handler *progress)
+    {
+        if ( ! on_data )
         {
-            LOG(WARNING) << "Unable to download file from " << url << " got status " << response->code;
+            LOG(WARNING) << "Attempting to stream a http request without a data handler";
             return false;
         }
 
+        _download_target target = { nullptr, on_data, progress };
+        return _stream_download(url, port, target);
+    }
+
+    bool download_file(const string &name, const string &url, unsigned short port, string &path)
+    {
         char *tmpname;
 
 #ifndef WINDOWS
@@ -107,12 +247,10 @@ namespace splashkit_lib
         tmpname = strdup(fpath.c_str());
         LOG(WARNING) << tmpname;
 #endif
-        save_response_to_file(response, tmpname);
-
         path = string(tmpname);
         free(tmpname);
 
-        return true;
+        return download_to_file(url, port, path);
     }
 
     bitmap download_bitmap(const string &name, const string &url, unsigned short port)
@@ -185,4 +323,19 @@ namespace splashkit_lib
             LOG(WARNING) << "Attempting to delete a http response with an invalid pointer.";
         }
     }
+
+    void enable_http_cache(const string &directory)
+    {
+        sk_http_enable_cache(directory);
+    }
+
+    void disable_http_cache()
+    {
+        sk_http_disable_cache();
+    }
+
+    void clear_http_cache()
+    {
+        sk_http_clear_cache();
+    }
 }
@@ -27,6 +27,35 @@ namespace splashkit_lib
      */
     typedef struct sk_http_response *http_response;
 
+    /**
+     * A HTTP request that runs in the background while your program
+     * continues. Requests are progressed each time you call `process_events`
+     * or check `http_request_done`. Once you are finished with the request you
+     * need to call `free_http_request`.
+     *
+     * @attribute class http_async_request
+     */
+    typedef struct sk_http_async_request *http_async_request;
+
+    /**
+     * A http progress handler is called as data is downloaded, so that you
+     * can report how much of the resource has arrived.
+     *
+     * @param received  The number of bytes received so far
+     * @param total     The size of the resource, or -1 if the server did not say
+     */
+    typedef void (http_progress_handler)(long long received, long long total);
+
+    /**
+     * A http data handler is called with each piece of a resource as it is
+     * downloaded. Return false to stop the download.
+     *
+     * @param data  The bytes that were received
+     * @param size  The number of bytes in data
+     * @return      True to keep downloading, false to stop
+     */
+    typedef bool (http_data_handler)(void *data, int size);
+
     /**
      * Make a get request to access a resource on the internet.
      *
@@ -59,6 +88,144 @@ namespace splashkit_lib
      */
     http_response http_post(const string &url, unsigned short port, const string &body, const vector<string> &headers);
 
+    /**
+     * Get many resources at once. The requests run at the same time over a
+     * limited number of connections, and share a connection when the server
+     * supports HTTP/2, so this takes about as long as the slowest request.
+     * You need to free each of the responses.
+     *
+     * @param  urls The paths to the resources
+     * @param  port The port on the servers (80 for http, 443 for https)
+     * @return      The responses, in the same order as the urls. A request that
+     *              failed has a nullptr response.
+     */
+    vector<http_response> http_get_many(const vector<string> &urls, unsigned short port);
+
+    /**
+     * Get many resources at once, using no more than the indicated number of
+     * connections.
+     *
+     * @param  urls             The paths to the resources
+     * @param  port             The port on the servers (80 for http, 443 for https)
+     * @param  max_connections  The most connections to have open at once
+     * @return                  The responses, in the same order as the urls
+     *
+     * @attribute suffix  with_limit
+     */
+    vector<http_response> http_get_many(const vector<string> &urls, unsigned short port, int max_connections);
+
+    /**
+     * Download a resource straight into a file. The data is written as it
+     * arrives, so large files can be downloaded without holding them in
+     * memory.
+     *
+     * @param  url  The path to the resource, for example http://splashkit.io
+     * @param  port The port on the server (80 for http, 443 for https)
+     * @param  path The path to the file to save the resource to
+     * @return      True if the whole resource was downloaded
+     */
+    bool download_to_file(const string &url, unsigned short port, const string &path);
+
+    /**
+     * Download a resource straight into a file, calling the progress handler
+     * as the data arrives.
+     *
+     * @param  url      The path to the resource, for example http://splashkit.io
+     * @param  port     The port on the server (80 for http, 443 for https)
+     * @param  path     The path to the file to save the resource to
+     * @param  progress The function to call as data is received
+     * @return          True if the whole resource was downloaded
+     *
+     * @attribute suffix  with_progress
+     */
+    bool download_to_file(const string &url, unsigned short port, const string &path, http_progress_handler *progress);
+
+    /**
+     * Make a get request, passing the data to the handler in pieces as it
+     * arrives rather than building up a response in memory.
+     *
+     * @param  url      The path to the resource, for example http://splashkit.io
+     * @param  port     The port on the server (80 for http, 443 for https)
+     * @param  on_data  The function to call with each piece of the resource
+     * @param  progress The function to call as data is received, this may be nullptr
+     * @return          True if the whole resource was received
+     */
+    bool http_get_streamed(const string &url, unsigned short port, http_data_handler *on_data, http_progress_handler *progress);
+
+    /**
+     * Start a get request that runs in the background. Use
+     * `http_request_done` to check when it has finished, and
+     * `http_response_of` to access the response.
+     *
+     * @param  url  The path to the resource, for example http://splashkit.io
+     * @param  port The port on the server (80 for http, 443 for https)
+     * @return      The request, which continues while your program runs
+     */
+    http_async_request http_get_async(const string &url, unsigned short port);
+
+    /**
+     * Start posting the supplied information to the indicated url in the
+     * background.
+     *
+     * @param  url  The url of the server to post the data to
+     * @param  port The port to connect to on the server
+     * @param  body The body of the message to post
+     * @return      The request, which continues while your program runs
+     */
+    http_async_request http_post_async(const string &url, unsigned short port, const string &body);
+
+    /**
+     * Start posting the supplied information to the indicated url with the
+     * given headers in the background.
+     *
+     * @param  url      The url of the server to post the data to
+     * @param  port     The port to connect to on the server
+     * @param  body     The body of the message to post
+     * @param  headers  The headers of the request
+     * @return          The request, which continues while your program runs
+     *
+     * @attribute suffix  with_headers
+     */
+    http_async_request http_post_async(const string &url, unsigned short port, const string &body, const vector<string> &headers);
+
+    /**
+     * Check if a background request has finished. This also progresses any
+     * requests that are still running, so you can call it in a loop when you
+     * are not calling `process_events`.
+     *
+     * @param  request  The request to check
+     * @return          True when the request has finished, or failed
+     *
+     * @attribute class   http_async_request
+     * @attribute getter  done
+     */
+    bool http_request_done(http_async_request request);
+
+    /**
+     * Get the response to a background request. This is `nullptr` until the
+     * request is done, or when the request failed. The response belongs to
+     * the request, and is freed with it in `free_http_request`.
+     *
+     * @param  request  The request to get the response of
+     * @return          The response from the server
+     *
+     * @attribute class   http_async_request
+     * @attribute getter  response
+     */
+    http_response http_response_of(http_async_request request);
+
+    /**
+     * Free a background request, and its response. Requests that are still
+     * running are cancelled.
+     *
+     * @param request The request to free
+     *
+     * @attribute class http_async_request
+     * @attribute destructor true
+     * @attribute method free
+     */
+    void free_http_request(http_async_request request);
+
     /**
      * Download an image from a web server and load it into SplashKit so that
      * you can use it.
@@ -129,5 +296,29 @@ namespace splashkit_lib
      * @attribute method free
      */
     void free_response (http_response response);
+
+    /**
+     * Keep the responses to get requests, so that asking for the same
+     * resource again is answered without downloading it while the server
+     * says it is still fresh. Older responses are checked with the server,
+     * which only sends the resource again if it has changed. Responses are
+     * also saved in the directory, so later runs of your program can use
+     * them too.
+     *
+     * @param directory The directory to save responses in, or an empty string to keep them in memory only
+     */
+    void enable_http_cache(const string &directory);
+
+    /**
+     * Stop keeping the responses to get requests. Responses already saved
+     * to disk are left there, to be used when the cache is enabled again.
+     */
+    void disable_http_cache();
+
+    /**
+     * Remove all of the responses kept by the http cache, including those
+     * saved to disk.
+     */
+    void clear_http_cache();
 }
 #endif /* web_hpp */
@@ -10,11 +10,29 @@
 #include "web_server.h"
 #include "web_client.h"
 #include "web_server_driver.h"
+#include "json_driver.h"
 #include "utils.h"
+#include "file_view.h"
 
 #include <sstream>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <chrono>
+#include <ctime>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <streambuf>
+#include <zlib.h>
 
 using std::stringstream;
+using std::ifstream;
+using std::list;
+using std::shared_ptr;
+using std::make_shared;
 
 namespace splashkit_lib
 {
@@ -28,6 +46,234 @@ namespace splashkit_lib
         return start_web_server(8080);
     }
 
+    web_server start_web_server(unsigned short port, unsigned int worker_threads)
+    {
+        return sk_start_web_server(port, worker_threads);
+    }
+
+    web_server start_web_server(unsigned short port, unsigned int worker_threads, unsigned int keep_alive_timeout_ms, unsigned int max_requests_per_connection)
+    {
+        return sk_start_web_server(port, worker_threads, keep_alive_timeout_ms, max_requests_per_connection);
+    }
+
+    void web_server_websocket_route(web_server server, const string &path)
+    {
+        if (INVALID_PTR(server, WEB_SERVER_PTR))
+        {
+            LOG(WARNING) << "web_server_websocket_route called on an invalid server";
+            return;
+        }
+
+        sk_add_websocket_route(server, path);
+    }
+
+    bool web_server_has_new_websocket(web_server server)
+    {
+        if (INVALID_PTR(server, WEB_SERVER_PTR))
+        {
+            LOG(WARNING) << "web_server_has_new_websocket called on an invalid server";
+            return false;
+        }
+
+        lock_guard<mutex> lock(server->websockets_lock);
+        return ! server->new_websockets.empty();
+    }
+
+    websocket web_server_next_websocket(web_server server)
+    {
+        if (INVALID_PTR(server, WEB_SERVER_PTR))
+        {
+            LOG(WARNING) << "web_server_next_websocket called on an invalid server";
+            return nullptr;
+        }
+
+        return sk_next_websocket(server);
+    }
+
+    void websocket_broadcast(web_server server, const string &message)
+    {
+        if (INVALID_PTR(server, WEB_SERVER_PTR))
+        {
+            LOG(WARNING) << "websocket_broadcast called on an invalid server";
+            return;
+        }
+
+        sk_websocket_broadcast(server, message);
+    }
+
+    bool websocket_send(websocket ws, const string &message)
+    {
+        if (INVALID_PTR(ws, WEBSOCKET_PTR))
+        {
+            LOG(WARNING) << "websocket_send called on an invalid websocket";
+            return false;
+        }
+
+        return sk_websocket_send(ws, message);
+    }
+
+    bool websocket_has_message(websocket ws)
+    {
+        return websocket_message_count(ws) > 0;
+    }
+
+    unsigned int websocket_message_count(websocket ws)
+    {
+        if (INVALID_PTR(ws, WEBSOCKET_PTR))
+        {
+            LOG(WARNING) << "Checking messages on an invalid websocket";
+            return 0;
+        }
+
+        lock_guard<mutex> lock(ws->lock);
+        return static_cast<unsigned int>(ws->messages.size());
+    }
+
+    string websocket_read_message(websocket ws)
+    {
+        if (INVALID_PTR(ws, WEBSOCKET_PTR))
+        {
+            LOG(WARNING) << "websocket_read_message called on an invalid websocket";
+            return "";
+        }
+
+        lock_guard<mutex> lock(ws->lock);
+        if (ws->messages.empty()) return "";
+
+        string result = std::move(ws->messages.front());
+        ws->messages.pop_front();
+        return result;
+    }
+
+    bool websocket_is_open(websocket ws)
+    {
+        if (INVALID_PTR(ws, WEBSOCKET_PTR)) return false;
+
+        lock_guard<mutex> lock(ws->lock);
+        return ws->conn != nullptr;
+    }
+
+    string websocket_path(websocket ws)
+    {
+        if (INVALID_PTR(ws, WEBSOCKET_PTR))
+        {
+            LOG(WARNING) << "websocket_path called on an invalid websocket";
+            return "";
+        }
+
+        return ws->path;
+    }
+
+    void close_websocket(websocket ws)
+    {
+        if (INVALID_PTR(ws, WEBSOCKET_PTR))
+        {
+            LOG(WARNING) << "close_websocket called on an invalid websocket";
+            return;
+        }
+
+        sk_close_websocket(ws);
+    }
+
+    json web_server_metrics(web_server server)
+    {
+        json result = create_json();
+
+        if (INVALID_PTR(server, WEB_SERVER_PTR))
+        {
+            LOG(WARNING) << "web_server_metrics called on an invalid server";
+            return result;
+        }
+
+        double accepted = server->requests_accepted;
+        double completed = server->requests_completed;
+
+        json_set_number(result, "requests_accepted", accepted);
+        json_set_number(result, "requests_completed", completed);
+        json_set_number(result, "requests_in_flight", accepted > completed ? accepted - completed : 0.0);
+        json_set_number(result, "requests_queued", static_cast<double>(server->request_queue.size()));
+        json_set_number(result, "requests_outstanding", static_cast<double>(server->outstanding_requests.size()));
+        json_set_number(result, "bytes_in", static_cast<double>(server->bytes_in));
+        json_set_number(result, "bytes_out", static_cast<double>(server->bytes_out));
+        json_set_number(result, "latency_p50_ms", sk_web_server_latency_percentile(server, 50));
+        json_set_number(result, "latency_p95_ms", sk_web_server_latency_percentile(server, 95));
+        json_set_number(result, "latency_p99_ms", sk_web_server_latency_percentile(server, 99));
+
+        return result;
+    }
+
+    double web_server_latency_percentile(web_server server, double percentile)
+    {
+        if (INVALID_PTR(server, WEB_SERVER_PTR))
+        {
+            LOG(WARNING) << "web_server_latency_percentile called on an invalid server";
+            return 0;
+        }
+
+        return sk_web_server_latency_percentile(server, percentile);
+    }
+
+    void web_server_set_metrics_path(web_server server, const string &path)
+    {
+        if (INVALID_PTR(server, WEB_SERVER_PTR))
+        {
+            LOG(WARNING) << "web_server_set_metrics_path called on an invalid server";
+            return;
+        }
+
+        lock_guard<mutex> lock(server->routes_lock);
+        server->metrics_path = path;
+    }
+
+    void web_server_set_compression(web_server server, unsigned int min_size)
+    {
+        if (INVALID_PTR(server, WEB_SERVER_PTR))
+        {
+            LOG(WARNING) << "web_server_set_compression called on an invalid server";
+            return;
+        }
+
+        server->compression_min_size = min_size;
+    }
+
+    void web_server_add_route(web_server server, http_method method, const string &pattern, web_request_handler *handler)
+    {
+        if (INVALID_PTR(server, WEB_SERVER_PTR))
+        {
+            LOG(WARNING) << "web_server_add_route called on an invalid server";
+            return;
+        }
+
+        sk_add_web_route(server, method, pattern, handler);
+    }
+
+    string request_path_parameter(http_request r, const string &name, const string &default_value)
+    {
+        if (INVALID_PTR(r, HTTP_REQUEST_PTR))
+        {
+            LOG(WARNING) << "Getting path parameter with invalid request";
+            return "";
+        }
+
+        for (const auto &param : r->path_parameters)
+        {
+            if (param.first == name) return param.second;
+        }
+
+        return default_value;
+    }
+
+    void set_web_server_request_handler(web_server server, web_request_handler *handler)
+    {
+        if (INVALID_PTR(server, WEB_SERVER_PTR))
+        {
+            LOG(WARNING) << "set_web_server_request_handler called on an invalid server";
+            return;
+        }
+
+        server->handler = handler;
+    }
+
     bool has_incoming_requests(web_server server)
     {
         if (INVALID_PTR(server, WEB_SERVER_PTR))
@@ -87,36 +333,298 @@ namespace splashkit_lib
         r->control.release();
     }
 
-    void send_response(http_request r, http_status_code code, const string &message, const string &content_type, const vector<string> &headers)
+    /**
+     * Hand the response to the request's worker thread to send, and wait
+     * for it to go. When called on the worker thread from a request handler
+     * the response is written straight away.
+     */
+    void _deliver_response(http_request r, sk_http_response &resp)
+    {
+        if (r->direct)
+        {
+            // Called from a request handler, so reply on this worker thread
+            sk_send_direct_response(r, &resp);
+            return;
+        }
+
+        _send_response(r, &resp);
+
+        // Wait for sending thread to actually send the data...
+        // After this the request will have been deleted
+        resp.response_sent.acquire();
+    }
+
+    bool _can_respond(http_request r)
     {
         if (INVALID_PTR(r, HTTP_REQUEST_PTR))
         {
             LOG(WARNING) << "send_response called on an invalid request";
-            return;
+            return false;
         }
         else if (INVALID_PTR(r->server, WEB_SERVER_PTR))
         {
             LOG(WARNING) << "send_response called on a request that was not received by a server. You cannot sent responses to requests you make.";
-            return;
+            return false;
         }
 
+        return true;
+    }
+
+    //
+    // Response compression, negotiated from the request's Accept-Encoding.
+    // Only gzip and deflate are produced here, brotli is only sent from
+    // pre-compressed ".br" files.
+    //
+    static bool _accepts_encoding(http_request r, const string &encoding)
+    {
+        string accepted = to_lower(request_header(r, "Accept-Encoding", ""));
+        size_t start = 0;
+
+        while (start < accepted.size())
+        {
+            size_t end = accepted.find(',', start);
+            if (end == string::npos) end = accepted.size();
+
+            string item = accepted.substr(start, end - start);
+            size_t params = item.find(';');
+            string name = trim(item.substr(0, params));
+
+            if (name == encoding || name == "*")
+            {
+                // An explicit zero quality refuses the encoding
+                string quality = params == string::npos ? "" : trim(item.substr(params + 1));
+                return ! (quality.compare(0, 2, "q=") == 0 && str_to_float(quality.substr(2), true, 1.0f) <= 0);
+            }
+
+            start = end + 1;
+        }
+
+        return false;
+    }
+
+    static bool _is_compressible(const string &content_type)
+    {
+        string type = to_lower(content_type);
+        return type.compare(0, 5, "text/") == 0 ||
+            type.find("json") != string::npos ||
+            type.find("javascript") != string::npos ||
+            type.find("xml") != string::npos ||
+            type.find("svg") != string::npos;
+    }
+
+    /**
+     * The encoding to compress a response with, or an empty string if it
+     * should be sent as is.
+     */
+    static string _response_encoding(http_request r, const string &content_type, size_t size)
+    {
+        unsigned int min_size = r->server->compression_min_size;
+        if (min_size == 0 || size < min_size || ! _is_compressible(content_type)) return "";
+
+        if (_accepts_encoding(r, "gzip")) return "gzip";
+        if (_accepts_encoding(r, "deflate")) return "deflate";
+        return "";
+    }
+
+    static bool _compress(const char *data, size_t size, const string &encoding, string &result)
+    {
+        z_stream stream = {};
+
+        // 16 more window bits asks zlib for a gzip wrapper
+        int window_bits = encoding == "gzip" ? 15 + 16 : 15;
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return false;
+
+        result.resize(deflateBound(&stream, size));
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        stream.avail_in = static_cast<uInt>(size);
+        stream.next_out = reinterpret_cast<Bytef *>(&result[0]);
+        stream.avail_out = static_cast<uInt>(result.size());
+
+        int status = deflate(&stream, Z_FINISH);
+        deflateEnd(&stream);
+
+        if (status != Z_STREAM_END) return false;
+
+        result.resize(stream.total_out);
+        return true;
+    }
+
+    static void _send_body(http_request r, http_status_code code, const char *data, size_t size, const string &content_type, const vector<string> &headers)
+    {
         sk_http_response resp;
+        resp.headers = headers;
+
+        string compressed;
+        string encoding = _response_encoding(r, content_type, size);
+
+        if ( ! encoding.empty() && _compress(data, size, encoding, compressed) && compressed.size() < size )
+        {
+            data = compressed.data();
+            size = compressed.size();
+            resp.headers.push_back("Content-Encoding: " + encoding);
+            resp.headers.push_back("Vary: Accept-Encoding");
+        }
 
         resp.id = HTTP_RESPONSE_PTR;
-        resp.message = strdup(message.c_str()); // copy to pass to non-const ref -- as this is used for sending and receiving data
-        resp.message_size = message.size();
+        // the body outlives the response, as delivering waits for it to be
+        // written, and is only read, so it is sent without a copy
+        resp.message = const_cast<char *>(data);
+        resp.message_size = size;
         resp.content_type = content_type;
         resp.code = code;
-        resp.headers = headers;
 
-        _send_response(r, &resp);
+        _deliver_response(r, resp);
+    }
 
-        // Wait for sending thread to actually send the data...
-        // After this the request will have been deleted
-        resp.response_sent.acquire();
+    void send_response(http_request r, http_status_code code, const string &message, const string &content_type, const vector<string> &headers)
+    {
+        if ( ! _can_respond(r) ) return;
 
-        // Safe to delete the response message copy
-        delete resp.message;
+        _send_body(r, code, message.data(), message.size(), content_type, headers);
+    }
+
+    //
+    // Json responses are written straight from the document into a buffer.
+    // A document that fits is sent from the buffer as a normal response.
+    // Once a larger one fills the buffer, the response is streamed in
+    // chunks, so the whole document is never held as a string.
+    //
+    #define SK_JSON_RESPONSE_BUFFER (64 * 1024)
+
+    class _json_response_buffer : public std::streambuf
+    {
+    public:
+        _json_response_buffer(http_request r, vector<char> &buffer) : _request(r), _buffer(buffer)
+        {
+            _buffer.resize(SK_JSON_RESPONSE_BUFFER);
+            setp(_buffer.data(), _buffer.data() + _buffer.size());
+        }
+
+        void finish()
+        {
+            if ( ! _streaming )
+            {
+                _send_body(_request, HTTP_STATUS_OK, pbase(), static_cast<size_t>(pptr() - pbase()), "application/json", {});
+                return;
+            }
+
+            _send_chunk();
+            end_streamed_response(_request);
+        }
+
+    protected:
+        int_type overflow(int_type ch) override
+        {
+            if ( ! _send_chunk() ) return traits_type::eof();
+
+            if ( ! traits_type::eq_int_type(ch, traits_type::eof()) )
+            {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+    private:
+        // Send the buffer as the next chunk, starting the stream on the first one
+        bool _send_chunk()
+        {
+            if ( ! _streaming )
+            {
+                sk_begin_streamed_response(_request, HTTP_STATUS_OK, "application/json", {});
+                _streaming = true;
+            }
+
+            size_t size = static_cast<size_t>(pptr() - pbase());
+            setp(_buffer.data(), _buffer.data() + _buffer.size());
+
+            // once the client has gone, the rest of the document is dropped
+            if ( _failed || size == 0 ) return ! _failed;
+            _failed = ! sk_write_response_chunk(_request, _buffer.data(), size);
+            return ! _failed;
+        }
+
+        http_request _request;
+        vector<char> &_buffer;
+        bool _streaming = false;
+        bool _failed = false;
+    };
+
+    void begin_streamed_response(http_request r, http_status_code code, const string &content_type, const vector<string> &headers)
+    {
+        if ( ! _can_respond(r) ) return;
+
+        if ( r->streamed )
+        {
+            LOG(WARNING) << "begin_streamed_response called on a request that is already streaming";
+            return;
+        }
+
+        sk_begin_streamed_response(r, code, content_type, headers);
+    }
+
+    void begin_streamed_response(http_request r, http_status_code code, const string &content_type)
+    {
+        begin_streamed_response(r, code, content_type, {});
+    }
+
+    bool send_response_chunk(http_request r, const string &data)
+    {
+        if ( ! _can_respond(r) ) return false;
+
+        if ( ! r->streamed )
+        {
+            LOG(WARNING) << "send_response_chunk called before begin_streamed_response";
+            return false;
+        }
+
+        return sk_write_response_chunk(r, data.data(), data.size());
+    }
+
+    void end_streamed_response(http_request r)
+    {
+        if ( ! _can_respond(r) ) return;
+
+        if ( ! r->streamed )
+        {
+            LOG(WARNING) << "end_streamed_response called before begin_streamed_response";
+            return;
+        }
+
+        sk_end_streamed_response(r);
+
+        // Complete the request now that all of the data has been written
+        sk_http_response resp;
+        resp.id = HTTP_RESPONSE_PTR;
+        resp.message = nullptr;
+        resp.message_size = 0;
+        _deliver_response(r, resp);
+    }
+
+    void begin_event_stream(http_request r)
+    {
+        begin_streamed_response(r, HTTP_STATUS_OK, "text/event-stream", { "Cache-Control: no-cache" });
+    }
+
+    bool send_server_event(http_request r, const string &event, const string &data)
+    {
+        string message;
+
+        if ( ! event.empty() )
+            message += "event: " + event + "\n";
+
+        // Each line of the data needs its own field
+        stringstream lines(data);
+        string line;
+        while (getline(lines, line))
+        {
+            message += "data: " + line + "\n";
+        }
+        if (data.empty()) message += "data: \n";
+        message += "\n";
+
+        return send_response_chunk(r, message);
     }
 
     void send_response(http_request r, http_status_code code, const string &message, const string &content_type)
@@ -136,7 +644,25 @@ namespace splashkit_lib
 
     void send_response(http_request r, json j)
     {
-        send_response(r, HTTP_STATUS_OK, json_to_string(j), "application/json");
+        if ( ! _can_respond(r) ) return;
+
+        // compressed responses need the whole document to compress
+        if ( INVALID_PTR(j, JSON_PTR) || ! _response_encoding(r, "application/json", SIZE_MAX).empty() )
+        {
+            send_response(r, HTTP_STATUS_OK, json_to_string(j), "application/json");
+            return;
+        }
+
+        // each thread reuses its buffer, as requests can be answered on worker threads
+        static thread_local vector<char> buffer;
+
+        _json_response_buffer out_buffer(r, buffer);
+        std::ostream out(&out_buffer);
+
+        // matches the indenting of json_to_string
+        out << std::setw(4) << j->data;
+        out.flush();
+        out_buffer.finish();
     }
 
     void send_response(http_request r, http_status_code code)
@@ -149,10 +675,282 @@ namespace splashkit_lib
         send_response(r, HTTP_STATUS_NO_CONTENT, "", "text/plain");
     }
 
+    //
+    // Small files sent with send_file_response are kept in memory, least
+    // recently used first out, and are checked against the file on disk at
+    // most once a second. Larger files are streamed from disk by civetweb.
+    //
+    #define FILE_CACHE_MAX_FILE_SIZE (256 * 1024)
+    #define FILE_CACHE_MAX_SIZE (16 * 1024 * 1024)
+    #define FILE_CACHE_MAX_ENTRIES 4096
+    #define FILE_CACHE_RECHECK_MS 1000
+
+    struct _cached_file
+    {
+        string path;
+        bool exists;    // missing files are remembered too, for pre-compressed siblings
+        time_t modified;
+        long long size;
+        bool in_memory;
+        shared_ptr<const file_view> view;   // mapped contents of in memory files
+        string etag;
+        string last_modified;
+
+        // guarded by the cache lock
+        std::chrono::steady_clock::time_point checked;
+        shared_ptr<const string> gzip_data;  // compressed on first request
+    };
+
+    typedef shared_ptr<_cached_file> _cached_file_ptr;
+
+    static list<_cached_file_ptr> _file_cache;
+    static map<string, list<_cached_file_ptr>::iterator> _file_cache_index;
+    static size_t _file_cache_size = 0;
+    static mutex _file_cache_lock;
+
+    static string _http_date(time_t time)
+    {
+        struct tm gmt;
+#ifdef WINDOWS
+        gmtime_s(&gmt, &time);
+#else
+        gmtime_r(&time, &gmt);
+#endif
+        char result[64];
+        strftime(result, sizeof(result), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+        return result;
+    }
+
+    static size_t _cached_size(const _cached_file_ptr &file)
+    {
+        return file->view ? file->view->size() : 0;
+    }
+
+    static void _forget_cached_file(const string &path)
+    {
+        auto it = _file_cache_index.find(path);
+        if (it == _file_cache_index.end()) return;
+
+        _cached_file_ptr file = *it->second;
+        _file_cache_size -= _cached_size(file) + (file->gzip_data ? file->gzip_data->size() : 0);
+        _file_cache.erase(it->second);
+        _file_cache_index.erase(it);
+    }
+
+    static _cached_file_ptr _find_cached_file(const string &path, time_t modified, long long size, bool any_version)
+    {
+        auto it = _file_cache_index.find(path);
+        if (it == _file_cache_index.end()) return nullptr;
+
+        _cached_file_ptr file = *it->second;
+        if ( ! any_version && ( ! file->exists || file->modified != modified || file->size != size) ) return nullptr;
+
+        _file_cache.splice(_file_cache.begin(), _file_cache, it->second);
+        return file;
+    }
+
+    // The cache lock must be held
+    static void _cache_file(const _cached_file_ptr &file)
+    {
+        _forget_cached_file(file->path);
+        _file_cache.push_front(file);
+        _file_cache_index[file->path] = _file_cache.begin();
+        _file_cache_size += _cached_size(file);
+
+        while ((_file_cache_size > FILE_CACHE_MAX_SIZE || _file_cache.size() > FILE_CACHE_MAX_ENTRIES) && _file_cache.size() > 1)
+        {
+            string oldest = _file_cache.back()->path;
+            _forget_cached_file(oldest);
+        }
+    }
+
+    static _cached_file_ptr _load_file(const string &path)
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        {
+            lock_guard<mutex> lock(_file_cache_lock);
+            _cached_file_ptr file = _find_cached_file(path, 0, 0, true);
+            if (file && now - file->checked < std::chrono::milliseconds(FILE_CACHE_RECHECK_MS))
+                return file->exists ? file : nullptr;
+        }
+
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0 || S_ISDIR(info.st_mode))
+        {
+            _cached_file_ptr missing = make_shared<_cached_file>();
+            missing->path = path;
+            missing->exists = false;
+            missing->in_memory = false;
+            missing->checked = now;
+
+            lock_guard<mutex> lock(_file_cache_lock);
+            _cache_file(missing);
+            return nullptr;
+        }
+
+        {
+            lock_guard<mutex> lock(_file_cache_lock);
+            _cached_file_ptr file = _find_cached_file(path, info.st_mtime, info.st_size, false);
+            if (file)
+            {
+                file->checked = now;
+                return file;
+            }
+        }
+
+        _cached_file_ptr file = make_shared<_cached_file>();
+        file->path = path;
+        file->exists = true;
+        file->modified = info.st_mtime;
+        file->size = info.st_size;
+        file->in_memory = info.st_size <= FILE_CACHE_MAX_FILE_SIZE;
+        file->last_modified = _http_date(info.st_mtime);
+        file->checked = now;
+
+        stringstream etag;
+        etag << "\"" << std::hex << static_cast<long long>(info.st_mtime) << "-" << file->size << "\"";
+        file->etag = etag.str();
+
+        // Large files are left for civetweb to stream. Small files are read
+        // into memory rather than mapped, as they are kept across requests
+        // and a mapping would fault if the file were truncated while cached.
+        if (file->in_memory)
+        {
+            auto view = make_shared<file_view>(path, false);
+            if (view->is_open())
+                file->view = view;
+            else
+                file->in_memory = false;
+        }
+
+        lock_guard<mutex> lock(_file_cache_lock);
+        _cache_file(file);
+        return file;
+    }
+
+    /**
+     * The gzipped copy of a cached file, compressed once and then kept with
+     * the file in the cache.
+     */
+    static shared_ptr<const string> _gzipped_file(const _cached_file_ptr &file)
+    {
+        {
+            lock_guard<mutex> lock(_file_cache_lock);
+            if (file->gzip_data) return file->gzip_data;
+        }
+
+        auto compressed = make_shared<string>();
+        if ( ! file->view || ! _compress(file->view->data(), file->view->size(), "gzip", *compressed) || compressed->size() >= file->view->size() )
+            return nullptr;
+
+        lock_guard<mutex> lock(_file_cache_lock);
+        if ( ! file->gzip_data )
+        {
+            file->gzip_data = compressed;
+
+            auto it = _file_cache_index.find(file->path);
+            if (it != _file_cache_index.end() && *it->second == file)
+                _file_cache_size += compressed->size();
+        }
+        return file->gzip_data;
+    }
+
+    static bool _client_has_file(http_request r, const string &etag, const string &last_modified)
+    {
+        string etags = request_header(r, "If-None-Match", "");
+        if ( ! etags.empty() )
+            return etags == "*" || etags.find(etag) != string::npos;
+
+        return request_header(r, "If-Modified-Since", "") == last_modified;
+    }
+
     void send_file_response(http_request r, const string &filename, const string &content_type)
     {
-        string file = file_as_string(filename, SERVER_RESOURCE);
-        send_response(r, HTTP_STATUS_OK, file, content_type);
+        if ( ! _can_respond(r) ) return;
+
+        string path = path_to_resource(filename, SERVER_RESOURCE);
+        _cached_file_ptr file = _load_file(path);
+
+        if ( ! file )
+        {
+            LOG(WARNING) << "Unable to find file to send in response: " << path;
+            send_response(r, HTTP_STATUS_NOT_FOUND, "Not found", "text/plain");
+            return;
+        }
+
+        sk_http_response resp;
+
+        resp.id = HTTP_RESPONSE_PTR;
+        resp.message = nullptr;
+        resp.message_size = 0;
+        resp.content_type = content_type;
+        resp.code = HTTP_STATUS_OK;
+
+        // Prefer pre-compressed siblings, so nothing is compressed per request.
+        // They are only sent while compression is turned on.
+        string encoding = "";
+        const char *sibling_encodings[][2] = { { "br", ".br" }, { "gzip", ".gz" } };
+        for (auto &sibling_encoding : sibling_encodings)
+        {
+            if ( r->server->compression_min_size == 0 ) break;
+            if ( ! _accepts_encoding(r, sibling_encoding[0]) ) continue;
+
+            _cached_file_ptr sibling = _load_file(path + sibling_encoding[1]);
+            if (sibling)
+            {
+                file = sibling;
+                encoding = sibling_encoding[0];
+                break;
+            }
+        }
+
+        const char *body = file->view ? file->view->view().data() : "";
+        size_t body_size = _cached_size(file);
+        string etag = file->etag;
+        shared_ptr<const string> gzipped;
+
+        if ( file->in_memory && encoding.empty() && _response_encoding(r, content_type, body_size) == "gzip" )
+        {
+            gzipped = _gzipped_file(file);
+            if (gzipped)
+            {
+                body = gzipped->data();
+                body_size = gzipped->size();
+                encoding = "gzip";
+                etag = etag.substr(0, etag.size() - 1) + "-gz\"";
+            }
+        }
+
+        if ( ! encoding.empty() )
+            resp.headers.push_back("Content-Encoding: " + encoding);
+        if ( r->server->compression_min_size > 0 || ! encoding.empty() )
+            resp.headers.push_back("Vary: Accept-Encoding");
+
+        if ( ! file->in_memory )
+        {
+            // civetweb handles the caching headers when streaming files
+            resp.filename = file->path;
+            resp.message_size = file->size; // for the server's byte count
+        }
+        else
+        {
+            resp.headers.push_back("ETag: " + etag);
+            resp.headers.push_back("Last-Modified: " + file->last_modified);
+
+            if (_client_has_file(r, etag, file->last_modified))
+            {
+                resp.code = HTTP_STATUS_NOT_MODIFIED;
+            }
+            else
+            {
+                // Send straight from the cache, the data is held until the response is sent
+                resp.message = const_cast<char *>(body);
+                resp.message_size = body_size;
+            }
+        }
+
+        _deliver_response(r, resp);
     }
 
     void send_javascript_file_response(http_request r, const string &filename)
@@ -192,50 +990,103 @@ namespace splashkit_lib
         return r->query_string;
     }
 
-// From: https://cboard.cprogramming.com/c-programming/13752-how-parse-query_string.html
-#define TO_HEX(Y) (Y>='0'&&Y<='9'?Y-'0':Y-'A'+10)
+    typedef vector<std::pair<string, string>> _request_fields;
 
-    string request_query_parameter(http_request r, const string &name, const string &default_value)
+    static int _hex_value(char ch)
     {
-        if (INVALID_PTR(r, HTTP_REQUEST_PTR))
+        if (ch >= '0' && ch <= '9') return ch - '0';
+        if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+        if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+        return -1;
+    }
+
+    static string _url_decode(const string &value)
+    {
+        string result;
+        result.reserve(value.size());
+
+        for (size_t i = 0; i < value.size(); i++)
         {
-            LOG(WARNING) << "Getting query parameter with invalid request";
-            return "";
+            if (value[i] == '%' && i + 2 < value.size() && _hex_value(value[i + 1]) >= 0 && _hex_value(value[i + 2]) >= 0)
+            {
+                result += static_cast<char>((_hex_value(value[i + 1]) << 4) + _hex_value(value[i + 2]));
+                i += 2;
+            }
+            else if (value[i] == '+')
+                result += ' ';
+            else
+                result += value[i];
         }
 
-        string query_string = r->query_string;
-
-        size_t idx = query_string.find(name + "=");
+        return result;
+    }
 
-        if ( idx == string::npos) return default_value;
+    static void _sort_fields(_request_fields &fields)
+    {
+        // Stable, so the first of any repeated names is found
+        std::stable_sort(fields.begin(), fields.end(),
+            [](const std::pair<string, string> &a, const std::pair<string, string> &b) { return a.first < b.first; });
+    }
 
-        auto iter = query_string.begin() + idx + name.length() + 1;
-        stringstream result;
+    /**
+     * Parse the query string and headers once, so each lookup is a binary
+     * search rather than a scan of the raw strings.
+     */
+    static void _parse_request_fields(http_request r)
+    {
+        if (r->parsed_fields) return;
+        r->parsed_fields = true;
 
-        while ( iter < query_string.end() )
+        const string &query = r->query_string;
+        size_t start = 0;
+        while (start < query.size())
         {
-            if ( *iter == '%' )
-            {
-                result << (char)((TO_HEX(*(iter + 1)) << 4) + TO_HEX(*(iter + 2)));
-                iter += 2;
-            }
-            else if ( *iter == '+' )
-            {
-                result << ' ';
-            }
-            else if ( *iter == '&' )
-            {
-                break; // end of parameter
-            }
-            else
+            size_t end = query.find('&', start);
+            if (end == string::npos) end = query.size();
+
+            if (end > start)
             {
-                result << *iter;
+                size_t eq = query.find('=', start);
+                if (eq == string::npos || eq > end) eq = end;
+
+                string value = eq < end ? query.substr(eq + 1, end - eq - 1) : "";
+                r->query_parameters.push_back({ _url_decode(query.substr(start, eq - start)), _url_decode(value) });
             }
 
-            iter++;
+            start = end + 1;
         }
+        _sort_fields(r->query_parameters);
 
-        return result.str();
+        for (const string &header : r->headers)
+        {
+            size_t colon = header.find(':');
+            if (colon == string::npos) continue;
+
+            r->header_fields.push_back({ to_lower(header.substr(0, colon)), trim(header.substr(colon + 1)) });
+        }
+        _sort_fields(r->header_fields);
+    }
+
+    static const string *_find_field(const _request_fields &fields, const string &name)
+    {
+        auto it = std::lower_bound(fields.begin(), fields.end(), name,
+            [](const std::pair<string, string> &field, const string &key) { return field.first < key; });
+
+        if (it == fields.end() || it->first != name) return nullptr;
+        return &it->second;
+    }
+
+    string request_query_parameter(http_request r, const string &name, const string &default_value)
+    {
+        if (INVALID_PTR(r, HTTP_REQUEST_PTR))
+        {
+            LOG(WARNING) << "Getting query parameter with invalid request";
+            return "";
+        }
+
+        _parse_request_fields(r);
+        const string *value = _find_field(r->query_parameters, name);
+        return value ? *value : default_value;
     }
 
     bool request_has_query_parameter(http_request r, const string &name)
@@ -243,13 +1094,37 @@ namespace splashkit_lib
         if (INVALID_PTR(r, HTTP_REQUEST_PTR))
         {
             LOG(WARNING) << "Getting query parameter with invalid request";
+            return false;
+        }
+
+        _parse_request_fields(r);
+        return _find_field(r->query_parameters, name) != nullptr;
+    }
+
+    string request_header(http_request r, const string &name, const string &default_value)
+    {
+        if (INVALID_PTR(r, HTTP_REQUEST_PTR))
+        {
+            LOG(WARNING) << "Getting request header with invalid request";
             return "";
         }
 
-        return r->query_string.find(name + "=") != string::npos;
+        _parse_request_fields(r);
+        const string *value = _find_field(r->header_fields, to_lower(name));
+        return value ? *value : default_value;
     }
 
-#undef TO_HEX
+    bool request_has_header(http_request r, const string &name)
+    {
+        if (INVALID_PTR(r, HTTP_REQUEST_PTR))
+        {
+            LOG(WARNING) << "Getting request header with invalid request";
+            return false;
+        }
+
+        _parse_request_fields(r);
+        return _find_field(r->header_fields, to_lower(name)) != nullptr;
+    }
 
     http_method request_method(http_request r)
     {
@@ -270,9 +1145,92 @@ namespace splashkit_lib
             return "";
         }
 
+        char buffer[8192];
+        int got;
+        while ((got = sk_read_request_body(r, buffer, sizeof(buffer))) > 0)
+        {
+            r->body.append(buffer, got);
+        }
+
         return r->body;
     }
 
+    string read_request_body_chunk(http_request r, unsigned int max_size)
+    {
+        if (INVALID_PTR(r, HTTP_REQUEST_PTR))
+        {
+            LOG(WARNING) << "Reading request body with invalid request";
+            return "";
+        }
+
+        string result(max_size, '\0');
+        int got = sk_read_request_body(r, &result[0], static_cast<int>(max_size));
+        result.resize(got);
+        return result;
+    }
+
+    // Reads the request body from the connection as the parser asks for it
+    class _request_body_buffer : public std::streambuf
+    {
+    public:
+        _request_body_buffer(http_request r) : _request(r) {}
+
+    protected:
+        int_type underflow() override
+        {
+            int got = sk_read_request_body(_request, _buffer, sizeof(_buffer));
+            if ( got <= 0 ) return traits_type::eof();
+
+            setg(_buffer, _buffer, _buffer + got);
+            return traits_type::to_int_type(_buffer[0]);
+        }
+
+    private:
+        http_request _request;
+        char _buffer[16 * 1024];
+    };
+
+    bool parse_request_body_json(http_request r, json_event_handler *handler)
+    {
+        if (INVALID_PTR(r, HTTP_REQUEST_PTR))
+        {
+            LOG(WARNING) << "Parsing request body with invalid request";
+            return false;
+        }
+
+        if (!handler)
+        {
+            LOG(WARNING) << "Parsing request body without a handler";
+            return false;
+        }
+
+        _request_body_buffer buffer(r);
+        std::istream in(&buffer);
+        return sk_json_parse_events(in, handler);
+    }
+
+    bool request_body_complete(http_request r)
+    {
+        if (INVALID_PTR(r, HTTP_REQUEST_PTR))
+        {
+            LOG(WARNING) << "Checking request body with invalid request";
+            return true;
+        }
+
+        return r->body_complete;
+    }
+
+    long long request_content_length(http_request r)
+    {
+        if (INVALID_PTR(r, HTTP_REQUEST_PTR))
+        {
+            LOG(WARNING) << "Getting content length with invalid request";
+            return -1;
+        }
+
+        return r->content_length;
+    }
+
     vector<string> request_headers(http_request r)
     {
         if (INVALID_PTR(r, HTTP_REQUEST_PTR))
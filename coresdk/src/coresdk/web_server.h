@@ -34,6 +34,25 @@ namespace splashkit_lib
      */
     typedef struct sk_http_request *http_request;
 
+    /**
+     * A websocket is a connection a client has opened to a websocket route
+     * of a `web_server`. Both sides can send messages at any time, so the
+     * server can push updates to clients without them polling.
+     *
+     * @attribute class websocket
+     */
+    typedef struct sk_websocket_data *websocket;
+
+    /**
+     * A web request handler is called by the web server as each request
+     * arrives, on one of the server's worker threads. The handler can call
+     * `send_response` to reply straight away, otherwise the request is
+     * queued to be read with `next_web_request`.
+     *
+     * @param request The `http_request` that was received.
+     */
+    typedef void (web_request_handler)(void *request);
+
     /**
      * The method token is used to indicate the kind of action to be performed
      * on the server. See [W3 specifications](https://www.w3.org/Protocols/rfc2616/rfc2616-sec5.html).
@@ -81,6 +100,300 @@ namespace splashkit_lib
      */
     web_server start_web_server();
 
+    /**
+     * Starts the web server on a given port number, with a set number of
+     * worker threads to handle connections. Each request in progress uses
+     * one of these threads until it gets its response.
+     *
+     * @param port            The port number to connect through.
+     * @param worker_threads  The number of worker threads for the server.
+     *
+     * @returns     Returns a new `web_server` instance.
+     *
+     * @attribute class       web_server
+     * @attribute constructor true
+     * @attribute suffix      with_worker_threads
+     */
+    web_server start_web_server(unsigned short port, unsigned int worker_threads);
+
+    /**
+     * Starts the web server on a given port number, with control over how
+     * long idle connections are kept open for more requests. Connections
+     * are kept open for HTTP/1.1 clients, and for clients that ask with a
+     * `Connection: keep-alive` header.
+     *
+     * @param port                        The port number to connect through.
+     * @param worker_threads              The number of worker threads for the server.
+     * @param keep_alive_timeout_ms       How long an idle connection is kept open, 0 to always close connections.
+     * @param max_requests_per_connection The number of requests before a connection is closed, 0 for no limit.
+     *
+     * @returns     Returns a new `web_server` instance.
+     *
+     * @attribute class       web_server
+     * @attribute constructor true
+     * @attribute suffix      with_keep_alive
+     */
+    web_server start_web_server(unsigned short port, unsigned int worker_threads, unsigned int keep_alive_timeout_ms, unsigned int max_requests_per_connection);
+
+    /**
+     * Lets clients open websockets to the server at the given path. Use
+     * `web_server_next_websocket` to get each new websocket.
+     *
+     * @param server  The `web_server` to accept websockets on.
+     * @param path    The path clients connect to, such as "/live".
+     *
+     * @attribute class  web_server
+     * @attribute self   server
+     * @attribute method add_websocket_route
+     */
+    void web_server_websocket_route(web_server server, const string &path);
+
+    /**
+     * Checks if a client has opened a websocket that you have not yet
+     * fetched with `web_server_next_websocket`.
+     *
+     * @param server  The `web_server` to check.
+     *
+     * @returns True if there is a new websocket.
+     *
+     * @attribute class  web_server
+     * @attribute self   server
+     * @attribute getter has_new_websocket
+     */
+    bool web_server_has_new_websocket(web_server server);
+
+    /**
+     * Returns the next websocket a client has opened on the server.
+     *
+     * @param server  The `web_server` to get the websocket from.
+     *
+     * @returns The new websocket, or `nullptr` if there is none.
+     *
+     * @attribute class  web_server
+     * @attribute self   server
+     * @attribute method next_websocket
+     */
+    websocket web_server_next_websocket(web_server server);
+
+    /**
+     * Sends a message to every open websocket on the server.
+     *
+     * @param server  The `web_server` whose websockets will get the message.
+     * @param message The message to send.
+     *
+     * @attribute class  web_server
+     * @attribute self   server
+     * @attribute method broadcast_websocket_message
+     */
+    void websocket_broadcast(web_server server, const string &message);
+
+    /**
+     * Sends a text message to the client on a websocket.
+     *
+     * @param ws      The websocket to send the message on.
+     * @param message The message to send.
+     *
+     * @returns False if the message could not be sent, such as when the websocket has closed.
+     *
+     * @attribute class  websocket
+     * @attribute self   ws
+     * @attribute method send
+     */
+    bool websocket_send(websocket ws, const string &message);
+
+    /**
+     * Checks if the client has sent messages that are waiting to be read.
+     *
+     * @param ws  The websocket to check.
+     *
+     * @returns True if there is a message to read.
+     *
+     * @attribute class  websocket
+     * @attribute self   ws
+     * @attribute getter has_message
+     */
+    bool websocket_has_message(websocket ws);
+
+    /**
+     * Returns the number of messages waiting to be read from a websocket.
+     *
+     * @param ws  The websocket to check.
+     *
+     * @returns The number of waiting messages.
+     *
+     * @attribute class  websocket
+     * @attribute self   ws
+     * @attribute getter message_count
+     */
+    unsigned int websocket_message_count(websocket ws);
+
+    /**
+     * Reads the next message the client sent on a websocket.
+     *
+     * @param ws  The websocket to read from.
+     *
+     * @returns The message, or an empty string if there are no messages.
+     *
+     * @attribute class  websocket
+     * @attribute self   ws
+     * @attribute method read_message
+     */
+    string websocket_read_message(websocket ws);
+
+    /**
+     * Checks if the websocket is still open. Messages that arrived before
+     * it closed can still be read.
+     *
+     * @param ws  The websocket to check.
+     *
+     * @returns True while the client is connected.
+     *
+     * @attribute class  websocket
+     * @attribute self   ws
+     * @attribute getter is_open
+     */
+    bool websocket_is_open(websocket ws);
+
+    /**
+     * Returns the path the client used to open the websocket.
+     *
+     * @param ws  The websocket.
+     *
+     * @returns The path of the websocket route.
+     *
+     * @attribute class  websocket
+     * @attribute self   ws
+     * @attribute getter path
+     */
+    string websocket_path(websocket ws);
+
+    /**
+     * Closes the websocket, if it is still open, and releases it.
+     *
+     * @param ws  The websocket to close.
+     *
+     * @attribute class       websocket
+     * @attribute destructor  true
+     * @attribute self        ws
+     */
+    void close_websocket(websocket ws);
+
+    /**
+     * Returns the server's request metrics as a json object. It counts the
+     * requests accepted and completed, those in flight, waiting in the
+     * queue, or handed out by `next_web_request`, the body bytes read and
+     * bytes sent, and the 50th, 95th and 99th percentile time in
+     * milliseconds from a request arriving to its response being sent.
+     *
+     * @param server  The `web_server` to get the metrics for.
+     *
+     * @returns A json object with the server's metrics.
+     *
+     * @attribute class  web_server
+     * @attribute self   server
+     * @attribute getter metrics
+     */
+    json web_server_metrics(web_server server);
+
+    /**
+     * Returns the time within which the given percentage of requests have
+     * been responded to, measured from the request arriving to its
+     * response being sent.
+     *
+     * @param server      The `web_server` to get the latency for.
+     * @param percentile  The percentage of requests, such as 99.
+     *
+     * @returns The latency in milliseconds, or 0 if no requests have completed.
+     *
+     * @attribute class  web_server
+     * @attribute self   server
+     * @attribute method latency_percentile
+     */
+    double web_server_latency_percentile(web_server server, double percentile);
+
+    /**
+     * Has the server answer GET requests for the path with its metrics, in
+     * the Prometheus text format, without passing them to your program.
+     *
+     * @param server  The `web_server` to publish metrics for.
+     * @param path    The path to serve the metrics on, such as "/metrics", or an empty string to stop.
+     *
+     * @attribute class  web_server
+     * @attribute self   server
+     * @attribute method set_metrics_path
+     */
+    void web_server_set_metrics_path(web_server server, const string &path);
+
+    /**
+     * Sets how large a response needs to be before the server compresses
+     * it, for clients that accept gzip or deflate encoded responses. Text,
+     * JSON, JavaScript and XML responses are compressed. Files sent with
+     * `send_file_response` are compressed once and kept, and a ".br" or
+     * ".gz" copy of the file next to it is sent instead when there is one.
+     * Turning compression off also stops these copies being sent.
+     *
+     * @param server    The `web_server` to configure.
+     * @param min_size  The smallest response, in bytes, to compress. Use 0 to turn compression off.
+     *
+     * @attribute class  web_server
+     * @attribute self   server
+     * @attribute method set_compression
+     */
+    void web_server_set_compression(web_server server, unsigned int min_size);
+
+    /**
+     * Adds a route to the server, so that requests matching the method and
+     * path pattern are passed to the handler as they arrive. Patterns are
+     * split into segments at each "/". A segment starting with ":" matches
+     * any value, which you can read with `request_path_parameter`, and a
+     * final "*" matches the rest of the path. Literal segments are matched
+     * first when several routes could apply.
+     *
+     * Route handlers run on the server's worker threads, like the handler
+     * passed to `set_web_server_request_handler`. Requests they do not
+     * respond to are passed on to that handler, and then to the queue.
+     *
+     * @param server  The `web_server` to add the route to.
+     * @param method  The method of the requests to handle.
+     * @param pattern The path pattern, such as "/players/:id/score".
+     * @param handler The function to call for matching requests.
+     *
+     * @attribute class  web_server
+     * @attribute self   server
+     * @attribute method add_route
+     */
+    void web_server_add_route(web_server server, http_method method, const string &pattern, web_request_handler *handler);
+
+    /**
+     * Returns the part of the request path matched by a ":name" segment of
+     * the route pattern. The rest of the path matched by "*" is named "*".
+     *
+     * @param r             A request object.
+     * @param name          The name of the parameter, without the ":".
+     * @param default_value The value to return if the route has no such parameter.
+     *
+     * @returns The matching part of the path, or the default value.
+     *
+     * @attribute class http_request
+     * @attribute method path_parameter
+     */
+    string request_path_parameter(http_request r, const string &name, const string &default_value);
+
+    /**
+     * Registers a handler to respond to requests as they arrive, without
+     * waiting for your program to call `next_web_request`. The handler
+     * runs on the server's worker threads, so several requests may be
+     * handled at once. Pass `nullptr` to send all requests to the queue.
+     *
+     * @param server  The `web_server` to handle requests for.
+     * @param handler The function to call for each request.
+     *
+     * @attribute class  web_server
+     * @attribute self   server
+     * @attribute method set_request_handler
+     */
+    void set_web_server_request_handler(web_server server, web_request_handler *handler);
+
     /**
      * Returns true if the given `web_sever` has pending requests.
      *
@@ -218,6 +531,85 @@ namespace splashkit_lib
      */
     void send_response(http_request r);
 
+    /**
+     * Starts sending a response whose content is not known up front. Send
+     * the content with `send_response_chunk`, and finish the response with
+     * `end_streamed_response`. HTTP/1.1 clients receive the content with
+     * chunked transfer encoding.
+     *
+     * @param r             The request to respond to.
+     * @param code          The status code of the response.
+     * @param content_type  The type of content being sent.
+     * @param headers       Extra headers to send with the response.
+     *
+     * @attribute class   http_request
+     * @attribute method  begin_streamed_response
+     * @attribute suffix  with_headers
+     */
+    void begin_streamed_response(http_request r, http_status_code code, const string &content_type, const vector<string> &headers);
+
+    /**
+     * Starts sending a response whose content is not known up front. Send
+     * the content with `send_response_chunk`, and finish the response with
+     * `end_streamed_response`.
+     *
+     * @param r             The request to respond to.
+     * @param code          The status code of the response.
+     * @param content_type  The type of content being sent.
+     *
+     * @attribute class   http_request
+     * @attribute method  begin_streamed_response
+     */
+    void begin_streamed_response(http_request r, http_status_code code, const string &content_type);
+
+    /**
+     * Sends the next part of a streamed response to the client.
+     *
+     * @param r     The request being responded to.
+     * @param data  The data to send.
+     *
+     * @returns False if the data could not be sent, such as when the client has disconnected.
+     *
+     * @attribute class   http_request
+     * @attribute method  send_response_chunk
+     */
+    bool send_response_chunk(http_request r, const string &data);
+
+    /**
+     * Finishes a streamed response, or event stream, to a request.
+     *
+     * @param r The request being responded to.
+     *
+     * @attribute class   http_request
+     * @attribute method  end_streamed_response
+     */
+    void end_streamed_response(http_request r);
+
+    /**
+     * Starts a stream of server-sent events in response to a request. Send
+     * events with `send_server_event` and finish with `end_streamed_response`.
+     *
+     * @param r The request to respond to, usually from a browser `EventSource`.
+     *
+     * @attribute class   http_request
+     * @attribute method  begin_event_stream
+     */
+    void begin_event_stream(http_request r);
+
+    /**
+     * Sends a server-sent event on a stream started with `begin_event_stream`.
+     *
+     * @param r     The request being responded to.
+     * @param event The name of the event, or an empty string for a plain message.
+     * @param data  The data for the event, which may span several lines.
+     *
+     * @returns False if the event could not be sent, such as when the client has disconnected.
+     *
+     * @attribute class   http_request
+     * @attribute method  send_server_event
+     */
+    bool send_server_event(http_request r, const string &event, const string &data);
+
     /**
      * Serves a file to the given `http_request`.
      *
@@ -329,7 +721,9 @@ namespace splashkit_lib
 
 
     /**
-     * Returns the body of the request.
+     * Returns the body of the request. The body is read from the client the
+     * first time you ask for it. If you have read part of the body with
+     * `read_request_body_chunk`, this returns only the rest of it.
      *
      * @param r A request object.
      *
@@ -340,6 +734,61 @@ namespace splashkit_lib
      */
     string request_body(http_request r);
 
+    /**
+     * Reads the next part of the request body, so that large uploads can be
+     * processed as they arrive. An empty result means the whole body has
+     * been read.
+     *
+     * @param r         A request object.
+     * @param max_size  The largest number of bytes to read.
+     *
+     * @returns The next part of the body, up to `max_size` bytes.
+     *
+     * @attribute class http_request
+     * @attribute method read_body_chunk
+     */
+    string read_request_body_chunk(http_request r, unsigned int max_size);
+
+    /**
+     * Checks if the whole body of the request has been read.
+     *
+     * @param r A request object.
+     *
+     * @returns True once there is no more of the body to read.
+     *
+     * @attribute class http_request
+     * @attribute getter body_complete
+     */
+    bool request_body_complete(http_request r);
+
+    /**
+     * Parses the rest of the request body as json while it is read from the
+     * client, calling the handler for each part of it. This lets you accept
+     * large uploads without reading them into memory.
+     *
+     * @param r       A request object.
+     * @param handler The function to call for each part of the json.
+     *
+     * @returns True if the body was valid json, and the handler did not stop parsing.
+     *
+     * @attribute class http_request
+     * @attribute method parse_body_json
+     */
+    bool parse_request_body_json(http_request r, json_event_handler *handler);
+
+    /**
+     * Returns the length of the request body the client said it would
+     * send, or -1 when it did not say (such as for a chunked upload).
+     *
+     * @param r A request object.
+     *
+     * @returns The value of the request's Content-Length header, or -1.
+     *
+     * @attribute class http_request
+     * @attribute getter content_length
+     */
+    long long request_content_length(http_request r);
+
 
     /**
      * Returns the headers of the request.
@@ -353,6 +802,35 @@ namespace splashkit_lib
      */
     vector<string> request_headers(http_request r);
 
+    /**
+     * Returns the value of a header sent with the request. Header names
+     * are not case sensitive.
+     *
+     * @param r             A request object.
+     * @param name          The name of the header, such as "Content-Type".
+     * @param default_value The value to return if the header was not sent.
+     *
+     * @returns The value of the header, or the default value.
+     *
+     * @attribute class http_request
+     * @attribute method header
+     */
+    string request_header(http_request r, const string &name, const string &default_value);
+
+    /**
+     * Checks if a header was sent with the request. Header names are not
+     * case sensitive.
+     *
+     * @param r     A request object.
+     * @param name  The name of the header to check for.
+     *
+     * @returns True if the request has the header.
+     *
+     * @attribute class http_request
+     * @attribute method has_header
+     */
+    bool request_has_header(http_request r, const string &name);
+
 
     /**
      * Returns an array of strings representing each stub of the URI.
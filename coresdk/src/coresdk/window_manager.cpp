@@ -9,6 +9,8 @@
 
 #include "window_manager.h"
 #include "graphics_driver.h"
+#include "frame_capture_driver.h"
+#include "post_effect_driver.h"
 #include "resources.h"
 #include "backend_types.h"
 #include "utility_functions.h"
@@ -25,6 +27,9 @@ namespace splashkit_lib
     window _current_window = nullptr;
     map<string, window> _windows;
 
+    // In frame memory
+    void _next_frame_memory();
+
     unsigned int number_open_windows()
     {
         return static_cast<unsigned int>(_windows.size());
@@ -123,12 +128,15 @@ namespace splashkit_lib
         }
 
         sk_refresh_window(&wind->image.surface);
+
+        // Temporaries from the frame that has been shown are no longer needed
+        _next_frame_memory();
     }
     
     void refresh_window(window wind, unsigned int target_fps)
     {
         refresh_window(wind);
-        delay_for_target_fps(60);
+        delay_for_target_fps(target_fps);
     }
 
     void clear_window(window wind, color clr)
@@ -521,5 +529,100 @@ namespace splashkit_lib
         
         return wind->caption;
     }
+
+    bool window_start_capture(window wind, frame_capture_handler *on_frame, int buffers)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR))
+        {
+            LOG(WARNING) << "Attempting to capture invalid window";
+            return false;
+        }
+
+        if ( ! on_frame )
+        {
+            LOG(WARNING) << "Attempting to capture window " << wind->caption << " without a frame handler";
+            return false;
+        }
+
+        return sk_start_frame_capture(&wind->image.surface, buffers, on_frame);
+    }
+
+    bool window_start_capture_to_file(window wind, const string &destination, int buffers)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR))
+        {
+            LOG(WARNING) << "Attempting to capture invalid window";
+            return false;
+        }
+
+        if ( ! sk_start_frame_capture_to_file(&wind->image.surface, buffers, destination.c_str()) )
+        {
+            LOG(WARNING) << "Unable to open " << destination << " to capture window " << wind->caption;
+            return false;
+        }
+
+        return true;
+    }
+
+    void window_stop_capture(window wind)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR))
+        {
+            LOG(WARNING) << "Attempting to stop capture of invalid window";
+            return;
+        }
+
+        sk_stop_frame_capture(&wind->image.surface);
+    }
+
+    bool window_capturing(window wind)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR)) return false;
+
+        return sk_frame_capture_active(&wind->image.surface);
+    }
+
+    long long window_frames_captured(window wind)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR)) return 0;
+
+        return sk_frames_captured(&wind->image.surface);
+    }
+
+    long long window_frames_dropped(window wind)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR)) return 0;
+
+        return sk_frames_dropped(&wind->image.surface);
+    }
+
+    void add_window_post_effect(window wind, post_effect_kind kind, color clr, double strength)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR))
+        {
+            LOG(WARNING) << "Attempting to add post effect to invalid window";
+            return;
+        }
+
+        sk_add_post_effect(&wind->image.surface, static_cast<sk_post_effect_kind>(kind), clr, strength);
+    }
+
+    void clear_window_post_effects(window wind)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR))
+        {
+            LOG(WARNING) << "Attempting to clear post effects of invalid window";
+            return;
+        }
+
+        sk_clear_post_effects(&wind->image.surface);
+    }
+
+    int window_post_effect_count(window wind)
+    {
+        if ( INVALID_PTR(wind, WINDOW_PTR)) return 0;
+
+        return sk_post_effect_count(&wind->image.surface);
+    }
     
 }
@@ -543,5 +543,136 @@ namespace splashkit_lib
      */
     string window_caption(window wind);
 
+    /**
+     * A frame capture handler is called with each frame recorded from a
+     * window. It runs on a background thread, so it can encode or send the
+     * frame without slowing the window down.
+     *
+     * @param pixels  The frame, row by row from the top, with 4 bytes per
+     *                pixel in red, green, blue, alpha order. The pixels are
+     *                only valid until the handler returns.
+     * @param width   The width of the frame in pixels
+     * @param height  The height of the frame in pixels
+     * @param frame   The number of the frame since the capture started,
+     *                which skips any frames that were dropped
+     */
+    typedef void (frame_capture_handler)(const void *pixels, int width, int height, long long frame);
+
+    /**
+     * Start recording each frame the window shows as it is refreshed. The
+     * frames are passed to the handler from a background thread. The window
+     * can get ahead of the handler by up to `buffers` frames; after that,
+     * frames are dropped rather than slowing the window down.
+     *
+     * @param wind      The window to record
+     * @param on_frame  The function to call with each frame
+     * @param buffers   The number of frames that can wait for the handler
+     * @returns         True if the capture started
+     *
+     * @attribute class   window
+     * @attribute method  start_capture
+     */
+    bool window_start_capture(window wind, frame_capture_handler *on_frame, int buffers);
+
+    /**
+     * Start recording each frame the window shows as raw RGBA pixels. The
+     * destination can be a file, "-" for standard output, or a command to
+     * send the frames to when it starts with "|". For example
+     * "|ffmpeg -f rawvideo -pix_fmt rgba -s 800x600 -r 60 -i - out.mp4"
+     * records the window to a video.
+     *
+     * @param wind         The window to record
+     * @param destination  Where to write the frames
+     * @param buffers      The number of frames that can wait to be written
+     * @returns            True if the capture started
+     *
+     * @attribute class   window
+     * @attribute method  start_capture_to_file
+     */
+    bool window_start_capture_to_file(window wind, const string &destination, int buffers);
+
+    /**
+     * Stop recording the window. This waits for the frames already recorded
+     * to be handled or written.
+     *
+     * @param wind The window
+     *
+     * @attribute class   window
+     * @attribute method  stop_capture
+     */
+    void window_stop_capture(window wind);
+
+    /**
+     * Checks if the window's frames are being recorded.
+     *
+     * @param wind The window
+     * @returns    True while the window is being captured
+     *
+     * @attribute class   window
+     * @attribute getter  capturing
+     */
+    bool window_capturing(window wind);
+
+    /**
+     * The number of frames recorded since the capture started.
+     *
+     * @param wind The window
+     * @returns    The number of frames read from the window
+     *
+     * @attribute class   window
+     * @attribute getter  frames_captured
+     */
+    long long window_frames_captured(window wind);
+
+    /**
+     * The number of frames skipped since the capture started, because the
+     * handler had not finished with the earlier frames.
+     *
+     * @param wind The window
+     * @returns    The number of frames dropped
+     *
+     * @attribute class   window
+     * @attribute getter  frames_dropped
+     */
+    long long window_frames_dropped(window wind);
+
+    /**
+     * Add an effect applied to everything shown in the window. Effects run
+     * on the graphics card each time the window is refreshed, in the order
+     * they were added. They change only what is shown, and not the drawing
+     * kept in the window between frames, so reading pixels from the window
+     * or capturing its frames sees the drawing without the effects.
+     *
+     * @param wind      The window to add the effect to
+     * @param kind      The effect to add
+     * @param clr       The color used by the effect
+     * @param strength  How strong the effect is, from 0 to 1
+     *
+     * @attribute class   window
+     * @attribute method  add_post_effect
+     */
+    void add_window_post_effect(window wind, post_effect_kind kind, color clr, double strength);
+
+    /**
+     * Remove all of the effects from the window.
+     *
+     * @param wind The window
+     *
+     * @attribute class   window
+     * @attribute method  clear_post_effects
+     */
+    void clear_window_post_effects(window wind);
+
+    /**
+     * The number of effects applied to the window.
+     *
+     * @param wind The window
+     * @returns    The number of effects added since they were last cleared
+     *
+     * @attribute class   window
+     * @attribute getter  post_effect_count
+     */
+    int window_post_effect_count(window wind);
+
 }
 #endif /* window_manager_hpp */
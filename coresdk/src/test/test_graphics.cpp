@@ -105,6 +105,27 @@ void test_clipping(window w1)
     delay(3000);
 }
 
+void test_post_effects(window w1)
+{
+    post_effect_kind kinds[] = { COLOR_GRADE_EFFECT, VIGNETTE_EFFECT, SCANLINES_EFFECT, BLOOM_EFFECT };
+    color colors[] = { COLOR_GOLD, COLOR_BLACK, COLOR_BLACK, COLOR_WHITE };
+    string names[] = { "Gold color grade", "Black vignette", "Scanlines", "Bloom" };
+
+    for (int i = 0; i < 4; i++)
+    {
+        clear_window_post_effects(w1);
+        add_window_post_effect(w1, kinds[i], colors[i], 0.6);
+
+        clear_window(w1, COLOR_SILVER);
+        fill_circle(COLOR_WHITE, 150, 150, 60, option_draw_to(w1));
+        draw_text(names[i], COLOR_BLACK, 10, 10, option_draw_to(w1));
+        refresh_window(w1);
+        delay(2000);
+    }
+
+    clear_window_post_effects(w1);
+}
+
 void run_graphics_test()
 {
     cout << "Checking the number of displays and their details" << endl;
@@ -126,6 +147,7 @@ void run_graphics_test()
     window w1 = open_window("Testing Graphics", 300, 300);
     
     test_clipping(w1);
+    test_post_effects(w1);
     
     color in_clr = string_to_color("#ffeebbaa");
     
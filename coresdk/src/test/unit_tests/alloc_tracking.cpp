@@ -0,0 +1,126 @@
+/**
+ * Counts heap allocations, see alloc_tracking.h. Nothing is counted,
+ * and the counts stay at 0, unless SK_COUNT_ALLOCATIONS is defined.
+ *
+ * When the build wraps malloc (SK_WRAP_MALLOC, with the linker's --wrap
+ * option), the wrappers count each allocation and operator new simply
+ * calls malloc. Otherwise operator new counts its own allocations, and
+ * direct calls to malloc are not seen.
+ */
+
+#include "alloc_tracking.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef SK_COUNT_ALLOCATIONS
+static std::atomic<long long> _allocations(0);
+static thread_local long long _thread_allocations = 0;
+
+static inline void _count_allocation()
+{
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    _thread_allocations++;
+}
+
+long long allocation_count()
+{
+    return _allocations.load(std::memory_order_relaxed);
+}
+
+long long thread_allocation_count()
+{
+    return _thread_allocations;
+}
+
+#ifdef SK_WRAP_MALLOC
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t count, size_t size);
+    void *__real_realloc(void *ptr, size_t size);
+
+    void *__wrap_malloc(size_t size)
+    {
+        _count_allocation();
+        return __real_malloc(size);
+    }
+
+    void *__wrap_calloc(size_t count, size_t size)
+    {
+        _count_allocation();
+        return __real_calloc(count, size);
+    }
+
+    void *__wrap_realloc(void *ptr, size_t size)
+    {
+        _count_allocation();
+        return __real_realloc(ptr, size);
+    }
+}
+#endif
+
+void *operator new(size_t size)
+{
+#ifndef SK_WRAP_MALLOC
+    _count_allocation();
+#endif
+
+    void *result = std::malloc(size ? size : 1);
+    if ( ! result ) throw std::bad_alloc();
+    return result;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+#ifndef SK_WRAP_MALLOC
+    _count_allocation();
+#endif
+
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+#else
+
+long long allocation_count()
+{
+    return 0;
+}
+
+long long thread_allocation_count()
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * Allocation tracking for tests and benchmarks.
+ *
+ * alloc_tracking.cpp replaces the global operator new, and on Linux the
+ * build also wraps malloc, calloc and realloc, so that every heap
+ * allocation is counted. Counting is built in with the SK_COUNT_ALLOCATIONS
+ * CMake option, and without it the counts stay at 0 so the checks below
+ * always pass. Counts are kept for each thread, so work on other threads
+ * does not affect the code being checked.
+ */
+
+#ifndef alloc_tracking_h
+#define alloc_tracking_h
+
+/**
+ * The number of heap allocations made by all threads since the program
+ * started.
+ */
+long long allocation_count();
+
+/**
+ * The number of heap allocations made by the calling thread since it
+ * started.
+ */
+long long thread_allocation_count();
+
+/**
+ * Require that the statements make no heap allocations on this thread.
+ * Call the code once beforehand, so that caches it fills on first use are
+ * not counted.
+ *
+ *     REQUIRE_NO_ALLOCATIONS({ draw_bitmap(bmp, 0, 0); });
+ */
+#define REQUIRE_NO_ALLOCATIONS(...) REQUIRE_ALLOCATIONS_AT_MOST(0, __VA_ARGS__)
+
+/**
+ * Require that the statements make no more than `max` heap allocations on
+ * this thread.
+ */
+#define REQUIRE_ALLOCATIONS_AT_MOST(max, ...)                                       \
+    do                                                                              \
+    {                                                                               \
+        long long _allocations_before = thread_allocation_count();                  \
+        __VA_ARGS__                                                                 \
+        long long allocations = thread_allocation_count() - _allocations_before;    \
+        REQUIRE(allocations <= (max));                                              \
+    } while (0)
+
+#endif /* alloc_tracking_h */
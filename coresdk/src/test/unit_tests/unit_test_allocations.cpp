@@ -0,0 +1,72 @@
+/**
+ * Allocation Unit Tests
+ *
+ * Checks that functions called every frame do not allocate memory. Each
+ * function is called once first, so that caches filled on first use are
+ * not counted.
+ */
+
+#include "catch.hpp"
+
+#include "alloc_tracking.h"
+
+#include "drawing_options.h"
+#include "images.h"
+#include "keyboard_input.h"
+#include "sprites.h"
+#include "types.h"
+
+using namespace splashkit_lib;
+
+TEST_CASE("allocations are counted", "[allocations]")
+{
+#ifdef SK_COUNT_ALLOCATIONS
+    long long before = thread_allocation_count();
+    delete new int(1);
+    REQUIRE(thread_allocation_count() == before + 1);
+#endif
+}
+
+TEST_CASE("frame functions do not allocate", "[allocations]")
+{
+    SECTION("drawing a bitmap")
+    {
+        bitmap bmp = create_bitmap("alloc_test_source", 20, 20);
+        bitmap dest = create_bitmap("alloc_test_dest", 100, 100);
+        drawing_options opts = option_draw_to(dest);
+
+        draw_bitmap(bmp, 10, 10, opts);
+        REQUIRE_NO_ALLOCATIONS({
+            for (int i = 0; i < 100; i++)
+                draw_bitmap(bmp, i % 80, i / 2, opts);
+        });
+
+        free_bitmap(dest);
+        free_bitmap(bmp);
+    }
+    SECTION("checking keys")
+    {
+        bool down = key_down(A_KEY);
+        REQUIRE_NO_ALLOCATIONS({
+            for (int key = A_KEY; key <= Z_KEY; key++)
+                down = key_down(static_cast<key_code>(key)) || down;
+        });
+        REQUIRE(down == false);
+    }
+    SECTION("reading sprite positions")
+    {
+        bitmap bmp = create_bitmap("alloc_test_sprite", 20, 20);
+        sprite s = create_sprite(bmp);
+        sprite_set_x(s, 15);
+
+        float x = sprite_x(s);
+        REQUIRE_NO_ALLOCATIONS({
+            for (int i = 0; i < 100; i++)
+                x += sprite_x(s);
+        });
+        REQUIRE(x == 15 * 101);
+
+        free_sprite(s);
+        free_bitmap(bmp);
+    }
+}
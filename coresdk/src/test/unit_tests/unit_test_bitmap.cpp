@@ -7,9 +7,21 @@
 #include "types.h"
 #include "graphics.h"
 #include "resources.h"
+#include "asset_streaming.h"
+#include "camera.h"
+#include "utils.h"
+
+#include "graphics_driver.h"
+
+#include <filesystem>
 
 using namespace splashkit_lib;
 
+namespace splashkit_lib
+{
+    bitmap _register_loaded_bitmap(const string &name, const string &file_path, sk_drawing_surface surface, bool reloadable);
+}
+
 TEST_CASE("bitmaps can be created and freed", "[bitmap]")
 {
     SECTION("can detect non-existent bitmap")
@@ -80,3 +92,364 @@ TEST_CASE("bitmaps can be created and freed", "[bitmap]")
         }
     }
 }
+
+TEST_CASE("bitmap pixels can be set in bulk", "[bitmap]")
+{
+    bitmap bmp = create_bitmap("pixels", 4, 4);
+    REQUIRE(bmp != nullptr);
+
+    vector<uint32_t> pixels(2 * 2, 0xff0000ff);
+    set_bitmap_pixels(bmp, pixels, rectangle_from(1, 1, 2, 2));
+
+    SECTION("updates the pixels in the area")
+    {
+        color clr = get_pixel(bmp, 1, 1);
+        REQUIRE(clr.r == 1.0f);
+        REQUIRE(clr.g == 0.0f);
+        REQUIRE(clr.a == 1.0f);
+        clr = get_pixel(bmp, 2, 2);
+        REQUIRE(clr.r == 1.0f);
+    }
+    SECTION("leaves the rest of the bitmap unchanged")
+    {
+        color clr = get_pixel(bmp, 0, 0);
+        REQUIRE(clr.a == 0.0f);
+        clr = get_pixel(bmp, 3, 3);
+        REQUIRE(clr.a == 0.0f);
+    }
+    SECTION("all pixels can be read, changed and set back")
+    {
+        vector<uint32_t> all = get_bitmap_pixels(bmp);
+        REQUIRE(all.size() == 16);
+        REQUIRE(all[1 * 4 + 1] == 0xff0000ff);
+        REQUIRE((all[0] & 0xff) == 0);
+
+        all[0] = 0x0000ffff;
+        set_bitmap_pixels(bmp, all);
+        REQUIRE(get_bitmap_pixels(bmp) == all);
+        REQUIRE(get_pixel(bmp, 0, 0).b == 1.0f);
+    }
+
+    free_bitmap(bmp);
+}
+
+TEST_CASE("bitmap pixels are read from a snapshot until the bitmap changes", "[bitmap]")
+{
+    bitmap bmp = create_bitmap("snapshot", 8, 8);
+    REQUIRE(bmp != nullptr);
+    clear_bitmap(bmp, COLOR_RED);
+
+    SECTION("a snapshot is taken on the second read")
+    {
+        REQUIRE_FALSE(bitmap_has_snapshot(bmp));
+        get_pixel(bmp, 0, 0);
+        REQUIRE_FALSE(bitmap_has_snapshot(bmp));
+        REQUIRE(get_pixel(bmp, 1, 1).r == 1.0f);
+        REQUIRE(bitmap_has_snapshot(bmp));
+    }
+    SECTION("drawing discards the snapshot")
+    {
+        bitmap_snapshot(bmp);
+        REQUIRE(bitmap_has_snapshot(bmp));
+        REQUIRE(get_pixel(bmp, 4, 4).r == 1.0f);
+
+        fill_rectangle_on_bitmap(bmp, COLOR_BLUE, 0, 0, 8, 8);
+        REQUIRE_FALSE(bitmap_has_snapshot(bmp));
+        color clr = get_pixel(bmp, 4, 4);
+        REQUIRE(clr.r == 0.0f);
+        REQUIRE(clr.b == 1.0f);
+    }
+    SECTION("setting pixels discards the snapshot")
+    {
+        bitmap_snapshot(bmp);
+        set_bitmap_pixels(bmp, vector<uint32_t>(1, 0x00ff00ff), rectangle_from(2, 2, 1, 1));
+        REQUIRE_FALSE(bitmap_has_snapshot(bmp));
+        REQUIRE(get_pixel(bmp, 2, 2).g == 1.0f);
+        REQUIRE(get_bitmap_pixels(bmp, rectangle_from(2, 2, 1, 1))[0] == 0x00ff00ff);
+    }
+
+    free_bitmap(bmp);
+}
+
+TEST_CASE("bitmaps can keep smaller copies for drawing shrunk", "[bitmap]")
+{
+    bitmap bmp = create_bitmap("mipmaps", 64, 64);
+    bitmap dest = create_bitmap("mipmaps_dest", 16, 16);
+    clear_bitmap(bmp, COLOR_RED);
+    clear_bitmap(dest, COLOR_BLACK);
+
+    REQUIRE_FALSE(bitmap_has_mipmaps(bmp));
+    bitmap_generate_mipmaps(bmp);
+    REQUIRE(bitmap_has_mipmaps(bmp));
+
+    // a quarter size draw covers the same area as the full size bitmap would
+    draw_bitmap(bmp, -24, -24, option_scale_bmp(0.25, 0.25, option_draw_to(dest)));
+    REQUIRE(get_pixel(dest, 0, 0).r == 1.0f);
+    REQUIRE(get_pixel(dest, 15, 15).r == 1.0f);
+
+    SECTION("drawing on the bitmap updates the copies when next needed")
+    {
+        fill_rectangle_on_bitmap(bmp, COLOR_BLUE, 0, 0, 64, 64);
+        REQUIRE_FALSE(bitmap_has_mipmaps(bmp));
+
+        draw_bitmap(bmp, -24, -24, option_scale_bmp(0.25, 0.25, option_draw_to(dest)));
+        REQUIRE(bitmap_has_mipmaps(bmp));
+        REQUIRE(get_pixel(dest, 8, 8).b == 1.0f);
+    }
+    SECTION("the copies can be freed")
+    {
+        bitmap_free_mipmaps(bmp);
+        REQUIRE_FALSE(bitmap_has_mipmaps(bmp));
+    }
+
+    free_bitmap(dest);
+    free_bitmap(bmp);
+}
+
+TEST_CASE("bitmaps can be drawn on in software", "[bitmap]")
+{
+    bitmap bmp = create_bitmap("software", 200, 100);
+    bitmap_set_software_rendering(bmp, true);
+    REQUIRE(bitmap_software_rendering(bmp));
+
+    clear_bitmap(bmp, COLOR_WHITE);
+    fill_rectangle_on_bitmap(bmp, COLOR_RED, 10, 10, 100, 50);
+    fill_circle_on_bitmap(bmp, COLOR_BLUE, 150, 50, 20);
+
+    REQUIRE(get_pixel(bmp, 0, 0).g == 1.0f);
+    REQUIRE(get_pixel(bmp, 60, 30).r == 1.0f);
+    REQUIRE(get_pixel(bmp, 60, 30).g == 0.0f);
+    REQUIRE(get_pixel(bmp, 150, 50).b == 1.0f);
+    REQUIRE(get_pixel(bmp, 150, 50).r == 0.0f);
+
+    SECTION("drawing it elsewhere includes the recorded drawing")
+    {
+        bitmap dest = create_bitmap("software_dest", 200, 100);
+        fill_rectangle_on_bitmap(bmp, COLOR_GREEN, 0, 0, 5, 5);
+        draw_bitmap(bmp, 0, 0, option_draw_to(dest));
+        REQUIRE(get_pixel(dest, 2, 2).g == 1.0f);
+        REQUIRE(get_pixel(dest, 2, 2).r == 0.0f);
+        free_bitmap(dest);
+    }
+    SECTION("other drawing returns it to the renderer")
+    {
+        draw_line_on_bitmap(bmp, COLOR_BLACK, 0, 99, 199, 99);
+        REQUIRE_FALSE(bitmap_software_rendering(bmp));
+        REQUIRE(get_pixel(bmp, 60, 30).r == 1.0f);
+    }
+
+    free_bitmap(bmp);
+}
+
+TEST_CASE("bitmaps are evicted to meet the resource memory budget", "[bitmap]")
+{
+    free_all_bitmaps();
+
+    long long before = resource_memory_used();
+    bitmap ufo = load_bitmap("ufo", "ufo.png");
+    REQUIRE(ufo != nullptr);
+    long long ufo_bytes = resource_memory_used() - before;
+    REQUIRE(ufo_bytes > 0);
+
+    set_resource_memory_budget(before + ufo_bytes);
+    bitmap player = load_bitmap("player", "player.png");
+    REQUIRE(bitmap_valid(player));
+
+    SECTION("evicted bitmaps keep their handle and are reloaded on use")
+    {
+        REQUIRE(has_bitmap("ufo"));
+        REQUIRE(bitmap_valid(ufo));
+        REQUIRE(bitmap_width(ufo) == 35);
+        REQUIRE(bitmap_named("ufo") == ufo);
+        REQUIRE(bitmap_height(ufo) == 33);
+        REQUIRE(get_pixel(ufo, 17, 16).a > 0.0f);
+        REQUIRE(has_bitmap("player"));
+        REQUIRE(bitmap_valid(player));
+    }
+    SECTION("retained bitmaps are not evicted")
+    {
+        retain_resource(IMAGE_RESOURCE, "player");
+        REQUIRE(bitmap_valid(bitmap_named("ufo")));
+        REQUIRE(bitmap_valid(player));
+        release_resource(IMAGE_RESOURCE, "player");
+    }
+
+    set_resource_memory_budget(0);
+    free_all_bitmaps();
+    REQUIRE(has_bitmap("ufo") == false);
+}
+
+TEST_CASE("small bitmaps can be packed into an atlas", "[bitmap]")
+{
+    bitmap ufo = load_bitmap("atlas_ufo", "ufo.png");
+    bitmap ufo_copy = load_bitmap("atlas_ufo_copy", "ufo.png");
+    bitmap player = load_bitmap("atlas_player", "player.png");
+    REQUIRE(bitmap_valid(ufo));
+    REQUIRE(bitmap_valid(ufo_copy));
+    REQUIRE(bitmap_valid(player));
+
+    color before = get_pixel(ufo, 17, 16);
+
+    REQUIRE(bitmap_pack_into_atlas({ ufo, ufo_copy, player }) == 2);
+
+    SECTION("only small bitmaps are packed")
+    {
+        REQUIRE(bitmap_in_atlas(ufo));
+        REQUIRE(bitmap_in_atlas(ufo_copy));
+        REQUIRE_FALSE(bitmap_in_atlas(player));
+    }
+    SECTION("packed bitmaps keep their size and pixels")
+    {
+        REQUIRE(bitmap_width(ufo) == 35);
+        REQUIRE(bitmap_height(ufo) == 33);
+        color after = get_pixel(ufo, 17, 16);
+        REQUIRE(after.r == before.r);
+        REQUIRE(after.a == before.a);
+    }
+    SECTION("drawing onto a bitmap takes it out of the atlas")
+    {
+        clear_bitmap(ufo, COLOR_RED);
+        REQUIRE_FALSE(bitmap_in_atlas(ufo));
+        REQUIRE(bitmap_in_atlas(ufo_copy));
+    }
+
+    free_bitmap(ufo);
+    free_bitmap(ufo_copy);
+    free_bitmap(player);
+}
+
+TEST_CASE("bitmaps can be streamed in around the camera", "[bitmap]")
+{
+    free_all_bitmaps();
+    double distance = asset_streaming_distance();
+    set_asset_streaming_distance(200);
+    add_streaming_region("far_region", rectangle_from(10000, 0, 100, 100));
+    add_streaming_asset("far_region", IMAGE_RESOURCE, "streamed_ufo", "ufo.png");
+    REQUIRE(has_streaming_region("far_region"));
+
+    move_camera_to(0, 0);
+    update_asset_streaming();
+    REQUIRE_FALSE(streamed_asset_ready(IMAGE_RESOURCE, "streamed_ufo"));
+    REQUIRE(asset_streaming_pending() == 0);
+
+    move_camera_to(9900, 0);
+    bitmap placeholder = streamed_bitmap("streamed_ufo");
+    REQUIRE(bitmap_valid(placeholder));
+    REQUIRE(bitmap_name(placeholder) != "streamed_ufo");
+
+    for (int i = 0; i < 200 && ! streamed_asset_ready(IMAGE_RESOURCE, "streamed_ufo"); i++)
+    {
+        update_asset_streaming();
+        delay(10);
+    }
+    REQUIRE(streamed_asset_ready(IMAGE_RESOURCE, "streamed_ufo"));
+    bitmap ufo = streamed_bitmap("streamed_ufo");
+    REQUIRE(bitmap_width(ufo) == 35);
+
+    SECTION("assets far from the camera are kept when there is no budget")
+    {
+        move_camera_to(-10000, 0);
+        update_asset_streaming();
+        REQUIRE(streamed_asset_ready(IMAGE_RESOURCE, "streamed_ufo"));
+        REQUIRE(streamed_bitmap("streamed_ufo") == ufo);
+    }
+    SECTION("assets far from the camera are evicted over the budget, keeping their handles")
+    {
+        set_resource_memory_budget(1);
+        move_camera_to(-10000, 0);
+        update_asset_streaming();
+        REQUIRE_FALSE(streamed_asset_ready(IMAGE_RESOURCE, "streamed_ufo"));
+        REQUIRE(bitmap_valid(ufo));
+        REQUIRE(streamed_bitmap("streamed_ufo") != ufo);
+
+        move_camera_to(9900, 0);
+        for (int i = 0; i < 200 && ! streamed_asset_ready(IMAGE_RESOURCE, "streamed_ufo"); i++)
+        {
+            update_asset_streaming();
+            delay(10);
+        }
+        REQUIRE(streamed_bitmap("streamed_ufo") == ufo);
+        REQUIRE(bitmap_width(ufo) == 35);
+        set_resource_memory_budget(0);
+    }
+
+    free_all_streaming_regions();
+    REQUIRE_FALSE(has_streaming_region("far_region"));
+    REQUIRE_FALSE(has_bitmap("streamed_ufo"));
+    set_asset_streaming_distance(distance);
+    move_camera_to(0, 0);
+    free_all_bitmaps();
+}
+
+TEST_CASE("cached collision masks are kept apart for bitmaps sharing a file", "[bitmap]")
+{
+    free_all_bitmaps();
+    string cache = (std::filesystem::temp_directory_path() / "splashkit_mask_cache_test").string();
+    std::filesystem::remove_all(cache);
+    set_collision_mask_cache_path(cache);
+
+    // Like images packed into one archive, both bitmaps come from the same file
+    string file = path_to_resource("ufo.png", IMAGE_RESOURCE);
+    SDL_Surface *blank = sk_decode_bitmap(file.c_str());
+    REQUIRE(blank != nullptr);
+    SDL_FillRect(blank, nullptr, 0);
+
+    bitmap ufo = _register_loaded_bitmap("packed_ufo", file, sk_bitmap_from_decoded(sk_decode_bitmap(file.c_str())), false);
+    REQUIRE(bitmap_point_collision(ufo, 0, 0, 17, 16));
+
+    bitmap empty = _register_loaded_bitmap("packed_blank", file, sk_bitmap_from_decoded(blank), false);
+    REQUIRE_FALSE(bitmap_point_collision(empty, 0, 0, 17, 16));
+
+    SECTION("a bitmap loaded again uses its own cached mask")
+    {
+        free_bitmap(ufo);
+        ufo = _register_loaded_bitmap("packed_ufo", file, sk_bitmap_from_decoded(sk_decode_bitmap(file.c_str())), false);
+        REQUIRE(bitmap_point_collision(ufo, 0, 0, 17, 16));
+    }
+    SECTION("each cell layout has its own cached mask")
+    {
+        free_bitmap(empty);
+        blank = sk_decode_bitmap(file.c_str());
+        SDL_FillRect(blank, nullptr, 0);
+        empty = _register_loaded_bitmap("packed_blank", file, sk_bitmap_from_decoded(blank), false);
+        bitmap_set_cell_details(empty, 5, 5, 7, 6, 42);
+        REQUIRE_FALSE(bitmap_point_collision(empty, 0, 0, 17, 16));
+    }
+
+    set_collision_mask_cache_path("");
+    free_all_bitmaps();
+    std::filesystem::remove_all(cache);
+}
+
+static int _render_targets_freed = 0;
+
+static void _count_freed_render_target(void *pointer)
+{
+    _render_targets_freed++;
+}
+
+TEST_CASE("render targets are reused, and freed with the bitmaps", "[bitmap]")
+{
+    free_all_bitmaps();
+
+    bitmap first = acquire_render_target(32, 16);
+    REQUIRE(bitmap_valid(first));
+    REQUIRE(bitmap_width(first) == 32);
+    REQUIRE(bitmap_height(first) == 16);
+
+    release_render_target(first);
+    REQUIRE(acquire_render_target(32, 16) == first);
+
+    bitmap second = acquire_render_target(8, 8);
+    REQUIRE(second != first);
+    release_render_target(second);
+
+    _render_targets_freed = 0;
+    register_free_notifier(_count_freed_render_target);
+
+    // first is still in use, and is freed along with the released second
+    free_all_bitmaps();
+    REQUIRE(_render_targets_freed == 2);
+
+    deregister_free_notifier(_count_freed_render_target);
+}
@@ -0,0 +1,98 @@
+/**
+ * Resource Bundle Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "bundles.h"
+#include "images.h"
+#include "resources.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace splashkit_lib;
+
+static void _put_le(std::string &out, uint64_t value, int count)
+{
+    for (int i = 0; i < count; i++)
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+// An archive holding one bundle line, with the index and blob positions given
+static std::string _write_archive(const std::string &filename, const std::string &line, uint64_t index_offset, uint64_t blob_offset, uint64_t blob_size)
+{
+    std::string data("SKPACK\0\1", 8);
+    _put_le(data, 1, 4);
+    _put_le(data, 0, 4);
+    _put_le(data, index_offset, 8);
+
+    _put_le(data, line.size(), 4);
+    data += line;
+    _put_le(data, blob_offset, 8);
+    _put_le(data, blob_size, 8);
+
+    std::string path = path_to_resource(filename, BUNDLE_RESOURCE);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), data.size());
+    return path;
+}
+
+TEST_CASE("malformed bundle archives are rejected without reading outside them", "[bundles]")
+{
+    SECTION("a blob whose offset and size overflow is loaded from its file instead")
+    {
+        std::string path = _write_archive("overflow_blob.skpack", "BITMAP,overflow_ufo,ufo.png", 24, 0xFFFFFFFFFFFFFFF0ULL, 0x20);
+        load_resource_bundle("overflow_blob", "overflow_blob.skpack");
+
+        REQUIRE(has_resource_bundle("overflow_blob"));
+        REQUIRE(has_bitmap("overflow_ufo"));
+        REQUIRE(bitmap_width(bitmap_named("overflow_ufo")) == 35);
+
+        free_resource_bundle("overflow_blob");
+        std::remove(path.c_str());
+    }
+    SECTION("a blob past the end of the archive is loaded from its file instead")
+    {
+        std::string path = _write_archive("outside_blob.skpack", "BITMAP,outside_ufo,ufo.png", 24, 8, 1 << 20);
+        load_resource_bundle("outside_blob", "outside_blob.skpack");
+
+        REQUIRE(has_bitmap("outside_ufo"));
+        REQUIRE(bitmap_width(bitmap_named("outside_ufo")) == 35);
+
+        free_resource_bundle("outside_blob");
+        std::remove(path.c_str());
+    }
+    SECTION("an index offset that overflows loads no entries")
+    {
+        std::string path = _write_archive("overflow_index.skpack", "BITMAP,lost_ufo,ufo.png", 0xFFFFFFFFFFFFFFFEULL, 0, 0);
+        load_resource_bundle("overflow_index", "overflow_index.skpack");
+
+        REQUIRE(has_resource_bundle("overflow_index"));
+        REQUIRE_FALSE(has_bitmap("lost_ufo"));
+
+        free_resource_bundle("overflow_index");
+        std::remove(path.c_str());
+    }
+    SECTION("a line longer than the archive loads no entries")
+    {
+        std::string path = _write_archive("long_line.skpack", "BITMAP,long_ufo,ufo.png", 24, 0, 0);
+
+        // Claim the line runs far past the end of the file
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(24);
+        file.write("\xFF\xFF\xFF\xFF", 4);
+        file.close();
+
+        load_resource_bundle("long_line", "long_line.skpack");
+
+        REQUIRE(has_resource_bundle("long_line"));
+        REQUIRE_FALSE(has_bitmap("long_ufo"));
+
+        free_resource_bundle("long_line");
+        std::remove(path.c_str());
+    }
+}
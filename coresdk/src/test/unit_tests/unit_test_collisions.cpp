@@ -0,0 +1,306 @@
+/**
+ * Collision Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "circle_drawing.h"
+#include "collisions.h"
+#include "geometry.h"
+#include "images.h"
+#include "sprites.h"
+#include "vector_2d.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace splashkit_lib;
+
+namespace splashkit_lib
+{
+    bool _convex_polygons_intersect(const vector<point_2d> &poly1, const vector<point_2d> &poly2);
+    bool _point_in_convex_polygon(const point_2d &pt, const vector<point_2d> &poly);
+    void _simplify_hull(vector<point_2d> &hull);
+}
+
+static vector<point_2d> _square(double x, double y, double size)
+{
+    return { point_at(x, y), point_at(x + size, y), point_at(x + size, y + size), point_at(x, y + size) };
+}
+
+// A regular polygon, wound the same way as the hulls of bitmaps
+static vector<point_2d> _regular_polygon(int points, double radius)
+{
+    vector<point_2d> result;
+    for (int i = 0; i < points; i++)
+    {
+        double angle = -2 * M_PI * i / points;
+        result.push_back(point_at(radius * cos(angle), radius * sin(angle)));
+    }
+    return result;
+}
+
+TEST_CASE("moving circles find when they hit a rectangle", "[collisions]")
+{
+    rectangle rect = rectangle_from(0, 0, 10, 10);
+
+    SECTION("a circle moving onto a side hits when it reaches the side")
+    {
+        float t = circle_rectangle_time_of_impact(circle_at(-10, 5, 2), vector_to(20, 0), rect);
+        REQUIRE(t > 0.3999);
+        REQUIRE(t < 0.4001);
+    }
+    SECTION("a fast circle can not pass through the rectangle")
+    {
+        float t = circle_rectangle_time_of_impact(circle_at(-10, 5, 2), vector_to(1000, 0), rect);
+        REQUIRE(t > 0.00799);
+        REQUIRE(t < 0.00801);
+    }
+    SECTION("a circle moving away or past misses")
+    {
+        REQUIRE(circle_rectangle_time_of_impact(circle_at(-10, 5, 2), vector_to(-20, 0), rect) == -1);
+        REQUIRE(circle_rectangle_time_of_impact(circle_at(-10, 20, 2), vector_to(40, 0), rect) == -1);
+        REQUIRE(circle_rectangle_time_of_impact(circle_at(-10, 5, 2), vector_to(5, 0), rect) == -1);
+    }
+    SECTION("a circle already overlapping hits straight away")
+    {
+        REQUIRE(circle_rectangle_time_of_impact(circle_at(5, 5, 2), vector_to(20, 0), rect) == 0);
+        REQUIRE(circle_rectangle_time_of_impact(circle_at(-1, 5, 2), vector_to(-20, 0), rect) == 0);
+    }
+    SECTION("a circle moving onto a corner hits its rounded edge")
+    {
+        // the centre comes within 5 of the corner at 0,0 after (sqrt(200) - 5) of sqrt(800)
+        float t = circle_rectangle_time_of_impact(circle_at(-10, -10, 5), vector_to(20, 20), rect);
+        REQUIRE(t > 0.3231);
+        REQUIRE(t < 0.3233);
+    }
+    SECTION("a circle passing close to a corner, but outside its rounded edge, misses")
+    {
+        // the path passes the corner at 0,0 about 5.66 away
+        REQUIRE(circle_rectangle_time_of_impact(circle_at(-12, 4, 5), vector_to(16, -16), rect) == -1);
+    }
+    SECTION("a circle that does not move only hits when it overlaps")
+    {
+        REQUIRE(circle_rectangle_time_of_impact(circle_at(-10, 5, 2), vector_to(0, 0), rect) == -1);
+        REQUIRE(circle_rectangle_time_of_impact(circle_at(11, 5, 2), vector_to(0, 0), rect) == 0);
+    }
+}
+
+TEST_CASE("moving circles find when they hit a line", "[collisions]")
+{
+    line l = line_from(0, 0, 0, 10);
+
+    SECTION("a circle moving onto the side of the line hits it")
+    {
+        float t = circle_line_time_of_impact(circle_at(-10, 5, 2), vector_to(20, 0), l);
+        REQUIRE(t > 0.3999);
+        REQUIRE(t < 0.4001);
+    }
+    SECTION("a circle moving just past the end of the line hits the end")
+    {
+        // at y 11.5 the circle reaches the end at 0,10 when its centre is sqrt(1.75) short of it
+        float t = circle_line_time_of_impact(circle_at(-10, 11.5, 2), vector_to(20, 0), l);
+        REQUIRE(t > 0.4338);
+        REQUIRE(t < 0.4340);
+    }
+    SECTION("a circle moving away or past misses")
+    {
+        REQUIRE(circle_line_time_of_impact(circle_at(-10, 5, 2), vector_to(-20, 0), l) == -1);
+        REQUIRE(circle_line_time_of_impact(circle_at(-10, 13, 2), vector_to(20, 0), l) == -1);
+    }
+    SECTION("a circle already overlapping hits straight away")
+    {
+        REQUIRE(circle_line_time_of_impact(circle_at(1, 5, 2), vector_to(20, 0), l) == 0);
+    }
+    SECTION("a circle that does not move misses")
+    {
+        REQUIRE(circle_line_time_of_impact(circle_at(-10, 5, 2), vector_to(0, 0), l) == -1);
+    }
+}
+
+TEST_CASE("moving circles find when they hit each other", "[collisions]")
+{
+    SECTION("circles moving together hit when they touch")
+    {
+        float t = circle_circle_time_of_impact(circle_at(0, 0, 1), vector_to(10, 0), circle_at(20, 0, 1), vector_to(-10, 0));
+        REQUIRE(t > 0.8999);
+        REQUIRE(t < 0.9001);
+    }
+    SECTION("a circle hits one that is standing still")
+    {
+        float t = circle_circle_time_of_impact(circle_at(0, 0, 1), vector_to(20, 0), circle_at(20, 0, 1), vector_to(0, 0));
+        REQUIRE(t > 0.8999);
+        REQUIRE(t < 0.9001);
+    }
+    SECTION("circles moving apart or past each other miss")
+    {
+        REQUIRE(circle_circle_time_of_impact(circle_at(0, 0, 1), vector_to(-10, 0), circle_at(20, 0, 1), vector_to(10, 0)) == -1);
+        REQUIRE(circle_circle_time_of_impact(circle_at(0, 0, 1), vector_to(10, 0), circle_at(20, 5, 1), vector_to(-10, 0)) == -1);
+    }
+    SECTION("circles already overlapping hit straight away")
+    {
+        REQUIRE(circle_circle_time_of_impact(circle_at(0, 0, 2), vector_to(-10, 0), circle_at(3, 0, 2), vector_to(10, 0)) == 0);
+    }
+    SECTION("circles moving together at the same speed do not hit")
+    {
+        REQUIRE(circle_circle_time_of_impact(circle_at(0, 0, 1), vector_to(10, 0), circle_at(20, 0, 1), vector_to(10, 0)) == -1);
+        REQUIRE(circle_circle_time_of_impact(circle_at(0, 0, 1), vector_to(0, 0), circle_at(20, 0, 1), vector_to(0, 0)) == -1);
+    }
+}
+
+TEST_CASE("sprites can move until they collide", "[collisions]")
+{
+    bitmap bmp = create_bitmap("impact_sprite_bitmap", 10, 10);
+    sprite s = create_sprite("impact_sprite", bmp);
+    sprite_set_position(s, point_at(0, 0));
+    sprite_set_velocity(s, vector_to(100, 0));
+
+    double radius = sprite_collision_circle(s).radius;
+    REQUIRE(radius > 0);
+
+    SECTION("a sprite stops where it touches a thin wall")
+    {
+        REQUIRE(move_sprite_until_collision(s, rectangle_from(50, -20, 1, 40)));
+
+        double x = sprite_collision_circle(s).center.x;
+        REQUIRE(x > 50 - radius - 0.01);
+        REQUIRE(x < 50 - radius + 0.01);
+    }
+    SECTION("a sprite stops where it touches a line")
+    {
+        REQUIRE(move_sprite_until_collision(s, line_from(60, -20, 60, 20)));
+
+        double x = sprite_collision_circle(s).center.x;
+        REQUIRE(x > 60 - radius - 0.01);
+        REQUIRE(x < 60 - radius + 0.01);
+    }
+    SECTION("a sprite that hits nothing moves by its whole velocity")
+    {
+        REQUIRE_FALSE(move_sprite_until_collision(s, rectangle_from(500, -20, 1, 40)));
+        REQUIRE(sprite_x(s) > 99.99);
+        REQUIRE(sprite_x(s) < 100.01);
+    }
+    SECTION("a sprite that does not move is only stopped by what it overlaps")
+    {
+        sprite_set_velocity(s, vector_to(0, 0));
+        REQUIRE_FALSE(move_sprite_until_collision(s, rectangle_from(50, -20, 1, 40)));
+        REQUIRE(move_sprite_until_collision(s, rectangle_from(5, -20, 1, 40)));
+        REQUIRE(sprite_x(s) == 0);
+    }
+
+    free_sprite(s);
+    free_bitmap(bmp);
+}
+
+TEST_CASE("convex polygons collide when they overlap or touch", "[collisions]")
+{
+    vector<point_2d> a = _square(0, 0, 10);
+
+    SECTION("polygons that are apart do not collide")
+    {
+        REQUIRE_FALSE(_convex_polygons_intersect(a, _square(11, 0, 10)));
+        REQUIRE_FALSE(_convex_polygons_intersect(a, _square(0, -20, 10)));
+    }
+    SECTION("polygons apart only along a diagonal do not collide")
+    {
+        // the diamond is within the square's bounds, but past its corner
+        vector<point_2d> diamond = { point_at(14, 8), point_at(18, 14), point_at(14, 20), point_at(8, 14) };
+        REQUIRE_FALSE(_convex_polygons_intersect(a, diamond));
+    }
+    SECTION("polygons that touch collide")
+    {
+        REQUIRE(_convex_polygons_intersect(a, _square(10, 0, 10)));
+        REQUIRE(_convex_polygons_intersect(a, _square(10, 10, 10)));
+    }
+    SECTION("polygons that overlap collide, with either winding")
+    {
+        vector<point_2d> b = _square(5, 5, 10);
+        REQUIRE(_convex_polygons_intersect(a, b));
+
+        vector<point_2d> reversed(b.rbegin(), b.rend());
+        REQUIRE(_convex_polygons_intersect(a, reversed));
+        REQUIRE(_convex_polygons_intersect(a, _square(2, 2, 2)));
+    }
+    SECTION("an empty polygon collides with nothing")
+    {
+        REQUIRE_FALSE(_convex_polygons_intersect(a, vector<point_2d>()));
+    }
+    SECTION("points are inside when within or on the edge of the polygon")
+    {
+        REQUIRE(_point_in_convex_polygon(point_at(5, 5), a));
+        REQUIRE(_point_in_convex_polygon(point_at(10, 5), a));
+        REQUIRE_FALSE(_point_in_convex_polygon(point_at(10.5, 5), a));
+        REQUIRE_FALSE(_point_in_convex_polygon(point_at(5, 5), { point_at(0, 0), point_at(10, 10) }));
+    }
+}
+
+TEST_CASE("hulls are simplified to a few points that still contain the shape", "[collisions]")
+{
+    SECTION("a hull with many points is cut down, and grows to hold its points")
+    {
+        vector<point_2d> original = _regular_polygon(40, 50);
+        vector<point_2d> hull = original;
+
+        _simplify_hull(hull);
+        REQUIRE(hull.size() <= 12);
+        REQUIRE(hull.size() >= 3);
+
+        // points kept from the original lie on the hull, so test them a
+        // little toward the centre to stay clear of rounding
+        for (const point_2d &pt : original)
+            REQUIRE(_point_in_convex_polygon(point_at(pt.x * 0.9999, pt.y * 0.9999), hull));
+    }
+    SECTION("a hull with few points is left as it is")
+    {
+        vector<point_2d> hull = _regular_polygon(8, 50);
+        _simplify_hull(hull);
+        REQUIRE(hull.size() == 8);
+    }
+    SECTION("a hull with no edge that can be removed is left as it is")
+    {
+        // no two edges of points along a line ever meet
+        vector<point_2d> hull;
+        for (int i = 0; i < 20; i++) hull.push_back(point_at(i, 2 * i));
+
+        _simplify_hull(hull);
+        REQUIRE(hull.size() == 20);
+    }
+}
+
+TEST_CASE("the hull of a bitmap cell holds every drawn pixel", "[collisions]")
+{
+    bitmap bmp = create_bitmap("hull_bitmap", 64, 64);
+    fill_circle_on_bitmap(bmp, COLOR_WHITE, 32, 30, 25);
+    setup_collision_mask(bmp);
+
+    vector<point_2d> hull = bitmap_cell_hull(bmp, 0);
+    REQUIRE(hull.size() >= 3);
+    REQUIRE(hull.size() <= 12);
+
+    int drawn = 0;
+    bool all_inside = true;
+    for (int y = 0; y < 64; y++)
+    {
+        for (int x = 0; x < 64; x++)
+        {
+            if ( not pixel_drawn_at_point(bmp, x, y) ) continue;
+
+            drawn++;
+            all_inside = all_inside and _point_in_convex_polygon(point_at(x + 0.5, y + 0.5), hull);
+        }
+    }
+
+    REQUIRE(drawn > 0);
+    REQUIRE(all_inside);
+
+    SECTION("a clear cell has no hull")
+    {
+        bitmap clear = create_bitmap("hull_clear_bitmap", 16, 16);
+        setup_collision_mask(clear);
+        REQUIRE(bitmap_cell_hull(clear, 0).empty());
+        free_bitmap(clear);
+    }
+
+    free_bitmap(bmp);
+}
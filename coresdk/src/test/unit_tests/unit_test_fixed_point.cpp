@@ -0,0 +1,98 @@
+/**
+ * Fixed Point Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "fixed_point.h"
+
+#include <climits>
+
+using namespace splashkit_lib;
+
+TEST_CASE("fixed point values convert to and from numbers", "[fixed_point]")
+{
+    SECTION("whole numbers have 16 fractional bits")
+    {
+        REQUIRE(fixed_from_int(1) == 65536);
+        REQUIRE(fixed_from_int(-3) == -3 * 65536);
+        REQUIRE(fixed_to_double(fixed_from_double(2.5)) == 2.5);
+    }
+    SECTION("numbers too large to store saturate")
+    {
+        REQUIRE(fixed_from_double(1e300) == LLONG_MAX);
+        REQUIRE(fixed_from_double(-1e300) == LLONG_MIN);
+    }
+}
+
+TEST_CASE("fixed point arithmetic uses full precision", "[fixed_point]")
+{
+    SECTION("products are rounded to the nearest value")
+    {
+        REQUIRE(fixed_multiply(fixed_from_int(3), fixed_from_double(0.5)) == fixed_from_double(1.5));
+        REQUIRE(fixed_multiply(fixed_from_int(-4), fixed_from_int(5)) == fixed_from_int(-20));
+        REQUIRE(fixed_multiply(1, 32768) == 1);
+    }
+    SECTION("products of large values do not overflow the intermediate")
+    {
+        REQUIRE(fixed_multiply(fixed_from_int(1000000), fixed_from_int(1000000)) == fixed_from_int(1000000) * 1000000);
+        REQUIRE(fixed_multiply(fixed_from_int(-2000000), fixed_from_int(1000000)) == fixed_from_int(-2000000) * 1000000);
+    }
+    SECTION("products out of range saturate")
+    {
+        REQUIRE(fixed_multiply(LLONG_MAX, fixed_from_int(2)) == LLONG_MAX);
+        REQUIRE(fixed_multiply(LLONG_MAX, fixed_from_int(-2)) == LLONG_MIN);
+        REQUIRE(fixed_multiply(LLONG_MIN, LLONG_MIN) == LLONG_MAX);
+    }
+    SECTION("division keeps the fraction of large values")
+    {
+        REQUIRE(fixed_divide(fixed_from_int(1), fixed_from_int(4)) == fixed_from_double(0.25));
+        REQUIRE(fixed_divide(fixed_from_int(-9), fixed_from_int(2)) == fixed_from_double(-4.5));
+        REQUIRE(fixed_divide(fixed_from_int(1000000000), fixed_from_int(2)) == fixed_from_int(500000000));
+    }
+    SECTION("division by zero gives zero, and out of range results saturate")
+    {
+        REQUIRE(fixed_divide(fixed_from_int(5), 0) == 0);
+        REQUIRE(fixed_divide(LLONG_MAX, 1) == LLONG_MAX);
+        REQUIRE(fixed_divide(LLONG_MAX, -1) == LLONG_MIN);
+    }
+}
+
+TEST_CASE("fixed point vectors saturate rather than wrap", "[fixed_point]")
+{
+    SECTION("adding and subtracting")
+    {
+        fixed_vector_2d v = fixed_vector_add(fixed_vector_to(LLONG_MAX, 1), fixed_vector_to(1, 1));
+        REQUIRE(v.x == LLONG_MAX);
+        REQUIRE(v.y == 2);
+
+        v = fixed_vector_subtract(fixed_vector_to(LLONG_MIN, 0), fixed_vector_to(1, 0));
+        REQUIRE(v.x == LLONG_MIN);
+    }
+    SECTION("dot products of large vectors")
+    {
+        fixed_vector_2d v = fixed_vector_to(fixed_from_int(100000), fixed_from_int(100000));
+        REQUIRE(fixed_dot_product(v, v) == fixed_from_int(100000) * 200000);
+    }
+    SECTION("lengths of large vectors")
+    {
+        REQUIRE(fixed_vector_magnitude(fixed_vector_to(fixed_from_int(3), fixed_from_int(4))) == fixed_from_int(5));
+        REQUIRE(fixed_vector_magnitude(fixed_vector_to(fixed_from_int(3000000), fixed_from_int(4000000))) == fixed_from_int(5000000));
+    }
+    SECTION("angles of large vectors")
+    {
+        REQUIRE(fixed_vector_angle(fixed_vector_to(LLONG_MAX, LLONG_MAX)) == fixed_from_int(45));
+        REQUIRE(fixed_vector_angle(fixed_vector_to(LLONG_MIN, 0)) == fixed_from_int(180));
+    }
+}
+
+TEST_CASE("fixed point collisions work with large shapes", "[fixed_point]")
+{
+    fixed_circle c = { fixed_vector_to(0, 0), fixed_from_int(1000000) };
+
+    REQUIRE(fixed_point_in_circle(fixed_vector_to(fixed_from_int(600000), fixed_from_int(800000)), c));
+    REQUIRE_FALSE(fixed_point_in_circle(fixed_vector_to(fixed_from_int(600001), fixed_from_int(800000)), c));
+
+    fixed_rectangle rect = { LLONG_MAX - 10, 0, 100, 100 };
+    REQUIRE(fixed_point_in_rectangle(fixed_vector_to(LLONG_MAX, 50), rect));
+}
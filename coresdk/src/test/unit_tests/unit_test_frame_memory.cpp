@@ -0,0 +1,94 @@
+/**
+ * Frame Memory Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "frame_memory.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace splashkit_lib
+{
+    // Moves frame memory on to the next frame, as refresh_window does
+    void _next_frame_memory();
+}
+
+using namespace splashkit_lib;
+
+TEST_CASE("frame memory hands out aligned space until the next frame", "[frame_memory]")
+{
+    _next_frame_memory();
+    REQUIRE(frame_memory_used() == 0);
+
+    char *a = static_cast<char *>(frame_memory(3));
+    char *b = static_cast<char *>(frame_memory(100));
+    REQUIRE(a != nullptr);
+    REQUIRE(b != nullptr);
+    REQUIRE(reinterpret_cast<uintptr_t>(b) % alignof(std::max_align_t) == 0);
+    REQUIRE(b >= a + 3);
+    REQUIRE(frame_memory_used() >= 103);
+
+    frame_vector<int> values;
+    for (int i = 0; i < 1000; i++) values.push_back(i);
+    REQUIRE(values[999] == 999);
+
+    _next_frame_memory();
+    REQUIRE(frame_memory_used() == 0);
+
+    // the next frame reuses the same space
+    REQUIRE(static_cast<char *>(frame_memory(3)) == a);
+}
+
+TEST_CASE("frame memory scopes give back what they use", "[frame_memory]")
+{
+    _next_frame_memory();
+    frame_memory(16);
+    size_t before = frame_memory_used();
+
+    SECTION("a scope returns to its mark")
+    {
+        char *first;
+        {
+            frame_memory_scope scope;
+            first = static_cast<char *>(frame_memory(256));
+            REQUIRE(frame_memory_used() > before);
+        }
+        REQUIRE(frame_memory_used() == before);
+
+        frame_memory_scope scope;
+        REQUIRE(static_cast<char *>(frame_memory(256)) == first);
+    }
+    SECTION("loops that never refresh do not grow")
+    {
+        for (int i = 0; i < 10; i++)
+        {
+            frame_memory_scope scope;
+            frame_memory(1024 * 1024);
+        }
+        size_t capacity = frame_memory_capacity();
+
+        for (int i = 0; i < 100; i++)
+        {
+            frame_memory_scope scope;
+            frame_memory(1024 * 1024);
+        }
+        REQUIRE(frame_memory_capacity() == capacity);
+        REQUIRE(frame_memory_used() == before);
+    }
+    SECTION("a refresh inside a scope does not reuse its memory")
+    {
+        frame_memory_scope scope;
+        char *outer = static_cast<char *>(frame_memory(64));
+        memset(outer, 7, 64);
+
+        _next_frame_memory();
+        char *inner = static_cast<char *>(frame_memory(64));
+        memset(inner, 9, 64);
+
+        REQUIRE(inner != outer);
+        REQUIRE(outer[0] == 7);
+        REQUIRE(outer[63] == 7);
+    }
+}
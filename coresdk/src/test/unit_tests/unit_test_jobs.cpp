@@ -0,0 +1,339 @@
+/**
+ * Jobs and Concurrency Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "jobs.h"
+#include "concurrency_utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace splashkit_lib;
+
+TEST_CASE("mpmc ring passes data between threads", "[concurrency]")
+{
+    SECTION("capacity is rounded up to a power of two")
+    {
+        mpmc_ring<int> ring(5);
+        REQUIRE(ring.capacity() == 8);
+    }
+    SECTION("pops in the order pushed, until empty")
+    {
+        mpmc_ring<int> ring(4);
+        int value;
+
+        REQUIRE_FALSE(ring.try_pop(value));
+        for (int i = 0; i < 4; i++) REQUIRE(ring.try_push(int(i)));
+        REQUIRE(ring.size() == 4);
+
+        for (int i = 0; i < 4; i++)
+        {
+            REQUIRE(ring.try_pop(value));
+            REQUIRE(value == i);
+        }
+        REQUIRE_FALSE(ring.try_pop(value));
+        REQUIRE(ring.size() == 0);
+    }
+    SECTION("refuses pushes when full, and takes them again once popped")
+    {
+        mpmc_ring<int> ring(2);
+        int value;
+
+        REQUIRE(ring.try_push(1));
+        REQUIRE(ring.try_push(2));
+        REQUIRE_FALSE(ring.try_push(3));
+
+        REQUIRE(ring.try_pop(value));
+        REQUIRE(value == 1);
+        REQUIRE(ring.try_push(3));
+
+        REQUIRE(ring.try_pop(value));
+        REQUIRE(value == 2);
+        REQUIRE(ring.try_pop(value));
+        REQUIRE(value == 3);
+    }
+    SECTION("many producers and consumers see each value once")
+    {
+        constexpr int PRODUCERS = 4, CONSUMERS = 4, PER_PRODUCER = 10000;
+        mpmc_ring<int> ring(64);
+        std::atomic<int> taken(0);
+        std::vector<std::vector<int>> seen(CONSUMERS);
+        std::vector<std::thread> threads;
+
+        for (int p = 0; p < PRODUCERS; p++)
+        {
+            threads.emplace_back([&ring, p]()
+            {
+                for (int i = 0; i < PER_PRODUCER; i++)
+                {
+                    while ( ! ring.try_push(p * PER_PRODUCER + i) ) std::this_thread::yield();
+                }
+            });
+        }
+
+        for (int c = 0; c < CONSUMERS; c++)
+        {
+            threads.emplace_back([&ring, &taken, &seen, c]()
+            {
+                int value;
+                while ( taken.load() < PRODUCERS * PER_PRODUCER )
+                {
+                    if ( ring.try_pop(value) )
+                    {
+                        seen[c].push_back(value);
+                        taken++;
+                    }
+                    else std::this_thread::yield();
+                }
+            });
+        }
+
+        for (std::thread &t : threads) t.join();
+
+        std::set<int> all;
+        for (const std::vector<int> &values : seen) all.insert(values.begin(), values.end());
+        REQUIRE(all.size() == PRODUCERS * PER_PRODUCER);
+        REQUIRE(*all.begin() == 0);
+        REQUIRE(*all.rbegin() == PRODUCERS * PER_PRODUCER - 1);
+    }
+}
+
+TEST_CASE("channels pass data between threads", "[concurrency]")
+{
+    SECTION("data is taken in the order it is put, beyond the ring")
+    {
+        channel<int> ch(4);
+        int value;
+
+        REQUIRE_FALSE(ch.try_take(value));
+        for (int i = 0; i < 10; i++) REQUIRE(ch.put(int(i)));
+        REQUIRE(ch.size() == 10);
+
+        for (int i = 0; i < 10; i++)
+        {
+            REQUIRE(ch.try_take(value));
+            REQUIRE(value == i);
+        }
+        REQUIRE_FALSE(ch.try_take(value));
+        REQUIRE(ch.size() == 0);
+    }
+    SECTION("take waits for data to be put")
+    {
+        channel<int> ch(4);
+        std::atomic<bool> putting(false);
+
+        std::thread producer([&ch, &putting]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            putting = true;
+            ch.put(42);
+        });
+
+        int value = ch.take();
+        REQUIRE(putting.load());
+        REQUIRE(value == 42);
+
+        producer.join();
+    }
+    SECTION("closing wakes waiting takers with a default value")
+    {
+        channel<int> ch(4);
+        std::atomic<int> woken(0);
+        std::vector<std::thread> takers;
+
+        for (int i = 0; i < 3; i++)
+        {
+            takers.emplace_back([&ch, &woken]()
+            {
+                if ( ch.take() == 0 ) woken++;
+            });
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE(woken.load() == 0);
+
+        ch.close();
+        for (std::thread &t : takers) t.join();
+        REQUIRE(woken.load() == 3);
+    }
+    SECTION("data put before closing can still be taken, but no more is accepted")
+    {
+        channel<int> ch(2);
+        ch.put(1);
+        ch.put(2);
+        ch.put(3);
+        ch.close();
+
+        REQUIRE(ch.closed());
+        REQUIRE_FALSE(ch.put(4));
+
+        REQUIRE(ch.take() == 1);
+        REQUIRE(ch.take() == 2);
+        REQUIRE(ch.take() == 3);
+        REQUIRE(ch.take() == 0);
+
+        int value;
+        REQUIRE_FALSE(ch.try_take(value));
+    }
+    SECTION("many producers and blocking consumers see each value once")
+    {
+        constexpr int PRODUCERS = 4, CONSUMERS = 4, PER_PRODUCER = 10000;
+        channel<int> ch(64);
+        std::vector<std::vector<int>> seen(CONSUMERS);
+        std::vector<std::thread> producers, consumers;
+
+        for (int c = 0; c < CONSUMERS; c++)
+        {
+            consumers.emplace_back([&ch, &seen, c]()
+            {
+                // values start at 1, so the 0 from a closed channel ends the loop
+                int value;
+                while ( (value = ch.take()) != 0 ) seen[c].push_back(value);
+            });
+        }
+
+        for (int p = 0; p < PRODUCERS; p++)
+        {
+            producers.emplace_back([&ch, p]()
+            {
+                for (int i = 1; i <= PER_PRODUCER; i++) ch.put(p * PER_PRODUCER + i);
+            });
+        }
+
+        for (std::thread &t : producers) t.join();
+        ch.close();
+        for (std::thread &t : consumers) t.join();
+
+        std::set<int> all;
+        size_t total = 0;
+        for (const std::vector<int> &values : seen)
+        {
+            all.insert(values.begin(), values.end());
+            total += values.size();
+        }
+        REQUIRE(total == PRODUCERS * PER_PRODUCER);
+        REQUIRE(all.size() == PRODUCERS * PER_PRODUCER);
+        REQUIRE(*all.begin() == 1);
+        REQUIRE(*all.rbegin() == PRODUCERS * PER_PRODUCER);
+    }
+}
+
+TEST_CASE("worker pools run every job", "[concurrency]")
+{
+    SECTION("a single thread pool runs jobs in order, beyond its ring")
+    {
+        constexpr int JOBS = 10000;
+        std::vector<int> order;
+        {
+            worker_pool pool(1);
+            for (int i = 0; i < JOBS; i++)
+                pool.add([&order, i]() { order.push_back(i); });
+        }
+
+        REQUIRE(order.size() == JOBS);
+        bool in_order = true;
+        for (int i = 0; i < JOBS; i++) in_order = in_order && order[i] == i;
+        REQUIRE(in_order);
+    }
+    SECTION("jobs never run on the thread adding them")
+    {
+        std::thread::id adder = std::this_thread::get_id();
+        std::atomic<int> inline_runs(0);
+        {
+            worker_pool pool(2);
+            for (int i = 0; i < 10000; i++)
+                pool.add([&inline_runs, adder]() { if ( std::this_thread::get_id() == adder ) inline_runs++; });
+        }
+
+        REQUIRE(inline_runs.load() == 0);
+    }
+}
+
+static std::atomic<int> _job_runs(0);
+static std::atomic<long long> _parallel_sum(0);
+static std::atomic<int> _parallel_calls(0);
+
+static void _count_job(int id)
+{
+    _job_runs++;
+}
+
+static void _slow_job(int id)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    _job_runs++;
+}
+
+static void _sum_range(int begin, int end)
+{
+    long long sum = 0;
+    for (int i = begin; i < end; i++) sum += i;
+    _parallel_sum += sum;
+    _parallel_calls++;
+}
+
+TEST_CASE("jobs can be started and waited on", "[jobs]")
+{
+    _job_runs = 0;
+
+    SECTION("waiting returns once the job has run")
+    {
+        int id = start_job(_slow_job);
+        REQUIRE(id >= 0);
+
+        wait_for_job(id);
+        REQUIRE(_job_runs.load() == 1);
+        REQUIRE(job_complete(id));
+    }
+    SECTION("each job gets its own id")
+    {
+        std::vector<int> ids;
+        for (int i = 0; i < 100; i++) ids.push_back(start_job(_count_job));
+        for (int id : ids) wait_for_job(id);
+
+        REQUIRE(std::set<int>(ids.begin(), ids.end()).size() == ids.size());
+        REQUIRE(_job_runs.load() == 100);
+    }
+    SECTION("a job without a function is not started")
+    {
+        REQUIRE(start_job(nullptr) == -1);
+    }
+    SECTION("unknown jobs are complete")
+    {
+        REQUIRE(job_complete(-5));
+        wait_for_job(-5);
+    }
+    SECTION("there is at least one job thread")
+    {
+        REQUIRE(job_thread_count() >= 1);
+    }
+}
+
+TEST_CASE("parallel for covers the range once", "[jobs]")
+{
+    _parallel_sum = 0;
+    _parallel_calls = 0;
+
+    SECTION("with the default grain")
+    {
+        parallel_for(10, 10010, _sum_range);
+        REQUIRE(_parallel_sum.load() == (10LL + 10009LL) * 10000 / 2);
+    }
+    SECTION("with a given grain")
+    {
+        parallel_for(0, 1000, 100, _sum_range);
+        REQUIRE(_parallel_sum.load() == 999LL * 1000 / 2);
+        REQUIRE(_parallel_calls.load() == 10);
+    }
+    SECTION("an empty range calls nothing")
+    {
+        parallel_for(5, 5, _sum_range);
+        parallel_for(5, 1, _sum_range);
+        REQUIRE(_parallel_calls.load() == 0);
+    }
+}
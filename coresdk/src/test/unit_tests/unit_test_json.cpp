@@ -120,4 +120,165 @@ TEST_CASE("json can be created and read", "[json]")
 
     free_json(person);
     free_all_json();
-}
\ No newline at end of file
+}
+
+TEST_CASE("json objects can be freed in any order", "[json]")
+{
+    vector<json> objects;
+    for (int i = 0; i < 10; i++)
+    {
+        json j = create_json();
+        json_set_number(j, "index", i);
+        objects.push_back(j);
+    }
+
+    // free from the middle and the ends, which moves the objects that remain
+    free_json(objects[4]);
+    free_json(objects[0]);
+    free_json(objects[9]);
+
+    for (int i : {1, 2, 3, 5, 6, 7, 8})
+    {
+        REQUIRE(json_read_number_as_int(objects[i], "index") == i);
+    }
+
+    SECTION("objects created after others are freed start empty")
+    {
+        json j = create_json();
+        REQUIRE(json_count_keys(j) == 0);
+    }
+
+    free_all_json();
+}
+
+TEST_CASE("json objects can be moved into other json objects", "[json]")
+{
+    json parent = create_json();
+
+    SECTION("can move an object to a key")
+    {
+        json child = create_json();
+        json_set_string(child, "name", "child");
+        json_move_object(parent, "child", child);
+
+        json result = json_read_object(parent, "child");
+        REQUIRE(json_read_string(result, "name") == "child");
+    }
+
+    SECTION("can append objects to an array")
+    {
+        json_reserve_array(parent, "items", 3);
+        for (int i = 0; i < 3; i++)
+        {
+            json item = create_json();
+            json_set_number(item, "index", i);
+            json_append_to_array(parent, "items", item);
+        }
+
+        vector<json> items;
+        json_read_array(parent, "items", items);
+
+        REQUIRE(items.size() == 3);
+        REQUIRE(json_read_number_as_int(items[2], "index") == 2);
+    }
+
+    free_all_json();
+}
+
+static vector<json_event> parsed_events;
+static vector<string> parsed_text;
+
+bool record_json_event(json_event event, const string &text, double number)
+{
+    parsed_events.push_back(event);
+    parsed_text.push_back(text);
+    return true;
+}
+
+TEST_CASE("json can be parsed without creating json objects", "[json]")
+{
+    parsed_events.clear();
+    parsed_text.clear();
+
+    REQUIRE(json_parse_string("{\"name\": \"John\", \"scores\": [1, 2]}", record_json_event));
+
+    vector<json_event> expected = {
+        JSON_START_OBJECT,
+        JSON_KEY, JSON_STRING_VALUE,
+        JSON_KEY, JSON_START_ARRAY, JSON_NUMBER_VALUE, JSON_NUMBER_VALUE, JSON_END_ARRAY,
+        JSON_END_OBJECT
+    };
+
+    REQUIRE(parsed_events == expected);
+    REQUIRE(parsed_text[1] == "name");
+    REQUIRE(parsed_text[2] == "John");
+
+    SECTION("invalid json is reported")
+    {
+        REQUIRE_FALSE(json_parse_string("{\"name\": ", record_json_event));
+    }
+}
+
+TEST_CASE("json values can be read by path", "[json]")
+{
+    json j = json_from_string("{\"player\": {\"name\": \"Ann\", \"alive\": true, \"scores\": [10, 20, 30]}}");
+
+    REQUIRE(json_has_path(j, "/player/scores/2"));
+    REQUIRE_FALSE(json_has_path(j, "/player/scores/3"));
+    REQUIRE(json_read_path_string(j, "/player/name") == "Ann");
+    REQUIRE(json_read_path_bool(j, "/player/alive"));
+    REQUIRE(json_read_path_number(j, "/player/scores/1") == 20);
+
+    SECTION("numbers are read into the storage of the vector passed")
+    {
+        json player = json_read_path_object(j, "/player");
+        vector<double> scores;
+        scores.reserve(8);
+        const double *storage = scores.data();
+
+        json_read_array(player, "scores", scores);
+        REQUIRE(scores == vector<double> { 10, 20, 30 });
+        REQUIRE(scores.data() == storage);
+
+        json_read_array(player, "scores", scores);
+        REQUIRE(scores.size() == 3);
+        REQUIRE(scores.data() == storage);
+    }
+
+    free_all_json();
+}
+
+TEST_CASE("json can be encoded as bytes", "[json]")
+{
+    json person = create_person();
+
+    for (json_format format : {JSON_FORMAT_TEXT, JSON_FORMAT_CBOR, JSON_FORMAT_MSGPACK, JSON_FORMAT_UBJSON})
+    {
+        vector<int8_t> bytes = json_to_bytes(person, format);
+        json j = json_from_bytes(bytes, format);
+
+        REQUIRE(json_read_string(j, "firstName") == "John");
+        REQUIRE(json_read_bool(j, "pensioner"));
+    }
+
+    REQUIRE(json_to_bytes(person, JSON_FORMAT_CBOR).size() < json_to_bytes(person, JSON_FORMAT_TEXT).size());
+
+    free_all_json();
+}
+
+TEST_CASE("json values can be read and set with keys", "[json]")
+{
+    json_key speed = json_key_for("speed");
+
+    REQUIRE(json_key_for("speed") == speed);
+    REQUIRE(json_key_name(speed) == "speed");
+
+    json j = create_json();
+    json_set_number(j, speed, 2.5);
+
+    REQUIRE(json_has_key(j, speed));
+    REQUIRE(json_read_number_as_double(j, speed) == 2.5);
+    REQUIRE(json_read_number_as_double(j, "speed") == 2.5);
+
+    free_all_json();
+}
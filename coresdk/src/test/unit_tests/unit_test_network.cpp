@@ -1,6 +1,10 @@
 #include "catch.hpp"
 
 #include "networking.h"
+#include "replication.h"
+#include "images.h"
+#include "sprites.h"
+#include "utils.h"
 
 using namespace splashkit_lib;
 
@@ -120,6 +124,306 @@ TEST_CASE("can communicate with server", "[networking]")
         REQUIRE_FALSE(is_connection_open(conn2));
     }
 }
+TEST_CASE("queued TCP messages are sent before the connection closes", "[networking]")
+{
+    constexpr unsigned short int PORT = 3004;
+
+    server_socket server = create_server("test_server_7", PORT, TCP);
+    connection conn = open_connection("test_connection_7", "localhost", PORT, TCP);
+    REQUIRE(server != nullptr);
+    REQUIRE(is_connection_open(conn));
+
+    for (int i = 0; i < 100 && ! accept_new_connection(server); i++)
+        delay(10);
+    REQUIRE(connection_count(server) == 1);
+    connection accepted = retrieve_connection(server, 0);
+
+    // coalesced messages wait in the queue until activity is checked
+    set_connection_coalesce_sends(conn, true);
+    REQUIRE(send_message_to("one", conn));
+    REQUIRE(send_message_to("two", conn));
+    REQUIRE(send_message_to("three", conn));
+    REQUIRE(close_connection(conn));
+
+    for (int i = 0; i < 100 && message_count(accepted) < 3; i++)
+    {
+        check_network_activity();
+        delay(10);
+    }
+
+    REQUIRE(message_count(accepted) == 3);
+    REQUIRE(read_message_data(accepted) == "one");
+    REQUIRE(read_message_data(accepted) == "two");
+    REQUIRE(read_message_data(accepted) == "three");
+
+    REQUIRE(close_server(server));
+}
+TEST_CASE("TCP messages are compressed once the peer agrees", "[networking]")
+{
+    constexpr unsigned short int PORT = 3005;
+
+    server_socket server = create_server("test_server_8", PORT, TCP);
+    connection conn = open_connection("test_connection_8", "localhost", PORT, TCP);
+    REQUIRE(server != nullptr);
+    REQUIRE(is_connection_open(conn));
+
+    for (int i = 0; i < 100 && ! accept_new_connection(server); i++)
+        delay(10);
+    REQUIRE(connection_count(server) == 1);
+    connection accepted = retrieve_connection(server, 0);
+
+    set_connection_compression(conn, SMALL_COMPRESSION);
+    const string text(2000, 'a');
+
+    // The first message goes out uncompressed, with the notice ahead of it
+    REQUIRE(send_message_to(text, conn));
+    for (int i = 0; i < 100 && message_count(accepted) < 1; i++)
+    {
+        check_network_activity();
+        delay(10);
+    }
+    REQUIRE(message_count(accepted) == 1);
+    REQUIRE(read_message_data(accepted) == text);
+    REQUIRE(connection_compression_ratio(conn) == 1);
+
+    // Later messages are compressed once the accepted end has answered
+    for (int i = 0; i < 100 && connection_compression_ratio(conn) >= 1; i++)
+    {
+        check_network_activity();
+        delay(10);
+        REQUIRE(send_message_to(text, conn));
+    }
+    REQUIRE(connection_compression_ratio(conn) < 1);
+
+    for (int i = 0; i < 100 && message_count(accepted) == 0; i++)
+    {
+        check_network_activity();
+        delay(10);
+    }
+    while ( message_count(accepted) > 0 )
+        REQUIRE(read_message_data(accepted) == text);
+
+    REQUIRE(close_connection(conn));
+    REQUIRE(close_server(server));
+}
+TEST_CASE("binary messages read back the values appended", "[networking]")
+{
+    constexpr unsigned short int PORT = 3006;
+
+    server_socket server = create_server("test_server_9", PORT, TCP);
+    connection conn = open_connection("test_connection_9", "localhost", PORT, TCP);
+    REQUIRE(server != nullptr);
+    REQUIRE(is_connection_open(conn));
+
+    for (int i = 0; i < 100 && ! accept_new_connection(server); i++)
+        delay(10);
+    REQUIRE(connection_count(server) == 1);
+    connection accepted = retrieve_connection(server, 0);
+
+    vector<int8_t> bytes;
+    append_message_int16(bytes, -12345);
+    append_message_int32(bytes, -123456789);
+    append_message_uint32(bytes, 4000000000u);
+    append_message_int64(bytes, -1234567890123456789LL);
+    append_message_float(bytes, 1.5f);
+    append_message_double(bytes, -2.25);
+    REQUIRE(bytes.size() == 2 + 4 + 4 + 8 + 4 + 8);
+
+    SECTION("values are appended little endian")
+    {
+        vector<int8_t> out;
+        append_message_uint32(out, 0x01020304u);
+        REQUIRE(out == vector<int8_t> { 4, 3, 2, 1 });
+    }
+
+    REQUIRE(send_message_bytes(conn, bytes));
+    for (int i = 0; i < 100 && message_count(accepted) < 1; i++)
+    {
+        check_network_activity();
+        delay(10);
+    }
+    REQUIRE(message_count(accepted) == 1);
+
+    message msg = read_message(accepted);
+    REQUIRE(message_data_bytes(msg) == bytes);
+    REQUIRE(message_read_int16(msg, 0) == -12345);
+    REQUIRE(message_read_int32(msg, 2) == -123456789);
+    REQUIRE(message_read_uint32(msg, 6) == 4000000000u);
+    REQUIRE(message_read_int64(msg, 10) == -1234567890123456789LL);
+    REQUIRE(message_read_float(msg, 18) == 1.5f);
+    REQUIRE(message_read_double(msg, 22) == -2.25);
+
+    // Reads past the end give 0
+    REQUIRE(message_read_int32(msg, 28) == 0);
+    REQUIRE(message_read_double(msg, 30) == 0);
+    REQUIRE(message_read_int16(msg, 1000) == 0);
+    close_message(msg);
+
+    REQUIRE(close_connection(conn));
+    REQUIRE(close_server(server));
+}
+TEST_CASE("can send on reliable UDP channels", "[networking]")
+{
+    constexpr unsigned short int PORT = 3002;
+
+    server_socket server = create_server("test_server_5", PORT, UDP);
+    connection conn = open_connection("test_connection_5", "localhost", PORT, UDP);
+    REQUIRE(server != nullptr);
+    REQUIRE(is_connection_open(conn));
+
+    REQUIRE(send_message_to("first", conn, 1));
+    REQUIRE(send_message_to("second", conn, 1));
+    REQUIRE(send_message_to("other", conn, 2));
+    REQUIRE_FALSE(send_message_to("no channel", conn, 16));
+
+    for (int i = 0; i < 100 && message_count(server) < 3; i++)
+    {
+        check_network_activity();
+        delay(10);
+    }
+
+    message msg = read_message(server, 1);
+    REQUIRE(msg != nullptr);
+    REQUIRE(message_channel(msg) == 1);
+    REQUIRE(message_data(msg) == "first");
+
+    // reply to the sender on another channel
+    udp_endpoint client = resolve_endpoint(message_host(msg), message_port(msg));
+    REQUIRE(send_message_to("reply", server, client, 0));
+    close_message(msg);
+
+    msg = read_message(server, 1);
+    REQUIRE(msg != nullptr);
+    REQUIRE(message_data(msg) == "second");
+    close_message(msg);
+
+    msg = read_message(server, 2);
+    REQUIRE(msg != nullptr);
+    REQUIRE(message_data(msg) == "other");
+    close_message(msg);
+
+    for (int i = 0; i < 100 && ! has_messages(conn); i++)
+    {
+        check_network_activity();
+        delay(10);
+    }
+
+    msg = read_message(conn, 0);
+    REQUIRE(msg != nullptr);
+    REQUIRE(message_data(msg) == "reply");
+    close_message(msg);
+
+    // plain messages that look like reliable packets arrive as they were sent
+    const string looks_reliable("\xffS\x01\x01" "abcdefgh", 12);
+    REQUIRE(send_message_to(looks_reliable, conn));
+
+    for (int i = 0; i < 100 && ! has_messages(server); i++)
+    {
+        check_network_activity();
+        delay(10);
+    }
+
+    msg = read_message(server);
+    REQUIRE(msg != nullptr);
+    REQUIRE(message_data(msg) == looks_reliable);
+    close_message(msg);
+
+    close_connection(conn);
+    REQUIRE(close_server(server));
+}
+TEST_CASE("can replicate state changes over UDP", "[networking]")
+{
+    constexpr unsigned short int PORT = 3003;
+
+    server_socket server = create_server("test_server_6", PORT, UDP);
+    connection conn = open_connection("test_connection_6", "localhost", PORT, UDP);
+    REQUIRE(server != nullptr);
+    REQUIRE(is_connection_open(conn));
+
+    replicated_state sent = create_replicated_state();
+    replicated_state received = create_replicated_state();
+    for (replicated_state state : { sent, received })
+    {
+        for (int i = 0; i < 50; i++)
+            replicated_state_add_number(state, "x" + std::to_string(i), 0, 1000, 0.5);
+        replicated_state_add_bool(state, "alive");
+    }
+    REQUIRE(replicated_state_field_count(received) == 51);
+    REQUIRE(replicated_state_field(received, "alive") == 50);
+
+    // the server learns the client's endpoint from its first message
+    REQUIRE(send_message_to("hello", conn));
+    for (int i = 0; i < 100 && ! has_messages(server); i++)
+    {
+        check_network_activity();
+        delay(10);
+    }
+    message hello = read_message(server);
+    REQUIRE(hello != nullptr);
+    REQUIRE_FALSE(replicated_state_receive(sent, hello));
+    udp_endpoint client = resolve_endpoint(message_host(hello), message_port(hello));
+    close_message(hello);
+
+    auto deliver = [&](replicated_state from, replicated_state to, bool to_client) -> size_t
+    {
+        for (int i = 0; i < 100 && ! (to_client ? has_messages(conn) : has_messages(server)); i++)
+        {
+            check_network_activity();
+            delay(10);
+        }
+        message msg = to_client ? read_message(conn) : read_message(server);
+        REQUIRE(msg != nullptr);
+        size_t size = message_data(msg).size();
+        REQUIRE(replicated_state_receive(to, msg));
+        close_message(msg);
+        return size;
+    };
+
+    for (int i = 0; i < 50; i++)
+        replicated_state_set_value(sent, i, i * 10.5);
+    replicated_state_set_value(sent, 50, 1);
+    REQUIRE(replicated_state_take_snapshot(sent) == 1);
+    REQUIRE(replicated_state_send(sent, server, client));
+
+    size_t full_size = deliver(sent, received, true);
+    REQUIRE(replicated_state_snapshot_number(received) == 1);
+    REQUIRE(replicated_state_value(received, 3) == 31.5);
+    REQUIRE(replicated_state_value(received, 50) == 1);
+
+    // the acknowledgement lets the next snapshot send only what changed
+    deliver(received, sent, false);
+    replicated_state_set_value(sent, 7, 999);
+    replicated_state_take_snapshot(sent);
+    REQUIRE(replicated_state_send(sent, server, client));
+
+    size_t delta_size = deliver(sent, received, true);
+    REQUIRE(delta_size < full_size / 2);
+    REQUIRE(replicated_state_snapshot_number(received) == 2);
+    REQUIRE(replicated_state_value(received, 7) == 999);
+    REQUIRE(replicated_state_value(received, 3) == 31.5);
+
+    free_replicated_state(sent);
+    free_replicated_state(received);
+    close_connection(conn);
+    REQUIRE(close_server(server));
+}
+TEST_CASE("replicated sprite fields reject duplicate names", "[networking]")
+{
+    bitmap bmp = create_bitmap("replicated_sprite_bitmap", 10, 10);
+    sprite s = create_sprite("replicated_sprite", bmp);
+    replicated_state state = create_replicated_state();
+    rectangle area = rectangle_from(0, 0, 800, 600);
+
+    REQUIRE(replicated_state_add_sprite(state, "player", s, area, 0.5) == 0);
+    REQUIRE(replicated_state_field_count(state) == 2);
+    REQUIRE(replicated_state_add_sprite(state, "player", s, area, 0.5) == -1);
+    REQUIRE(replicated_state_add_sprite(nullptr, "other", s, area, 0.5) == -1);
+    REQUIRE(replicated_state_field_count(state) == 2);
+
+    free_replicated_state(state);
+    free_sprite(s);
+    free_bitmap(bmp);
+}
 TEST_CASE("can convert network data")
 {
     SECTION("can convert hexidecimal to ipv4")
@@ -0,0 +1,114 @@
+/**
+ * Particle Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "images.h"
+#include "particles.h"
+
+using namespace splashkit_lib;
+
+TEST_CASE("particle emitters release and remove particles", "[particles]")
+{
+    bitmap bmp = create_bitmap("particle_bitmap", 4, 4);
+    particle_emitter emitter = create_particle_emitter(bmp, 100);
+    REQUIRE(emitter != nullptr);
+    REQUIRE(particle_count(emitter) == 0);
+
+    SECTION("emitted particles are limited by the capacity")
+    {
+        emit_particles(emitter, 60);
+        REQUIRE(particle_count(emitter) == 60);
+
+        emit_particles(emitter, 60);
+        REQUIRE(particle_count(emitter) == 100);
+
+        emit_particles(emitter, -5);
+        REQUIRE(particle_count(emitter) == 100);
+    }
+    SECTION("particles are removed when their lifetime ends")
+    {
+        particle_emitter_set_lifetime(emitter, 1, 1);
+        emit_particles(emitter, 10);
+
+        update_particle_emitter(emitter, 0.5);
+        REQUIRE(particle_count(emitter) == 10);
+
+        emit_particles(emitter, 5);
+        update_particle_emitter(emitter, 0.75);
+        REQUIRE(particle_count(emitter) == 5);
+
+        update_particle_emitter(emitter, 0.5);
+        REQUIRE(particle_count(emitter) == 0);
+    }
+    SECTION("particles are released at the emitter's rate, across updates")
+    {
+        particle_emitter_set_lifetime(emitter, 10, 10);
+        particle_emitter_set_rate(emitter, 10);
+
+        for (int i = 0; i < 4; i++) update_particle_emitter(emitter, 0.25);
+        REQUIRE(particle_count(emitter) == 10);
+    }
+    SECTION("updates without time passing change nothing")
+    {
+        particle_emitter_set_rate(emitter, 10);
+        emit_particles(emitter, 3);
+
+        update_particle_emitter(emitter, 0);
+        update_particle_emitter(emitter, -1);
+        REQUIRE(particle_count(emitter) == 3);
+    }
+    SECTION("clearing removes all particles")
+    {
+        emit_particles(emitter, 20);
+        clear_particles(emitter);
+        REQUIRE(particle_count(emitter) == 0);
+    }
+    SECTION("the emitter can be moved")
+    {
+        particle_emitter_set_position(emitter, point_at(12.5, -4));
+        REQUIRE(particle_emitter_position(emitter).x == 12.5);
+        REQUIRE(particle_emitter_position(emitter).y == -4);
+    }
+
+    free_particle_emitter(emitter);
+    free_bitmap(bmp);
+}
+
+TEST_CASE("large particle emitters are updated across threads", "[particles]")
+{
+    bitmap bmp = create_bitmap("particle_bitmap", 4, 4);
+    particle_emitter emitter = create_particle_emitter(bmp, 50000);
+
+    // half live for one second, and half for three
+    particle_emitter_set_lifetime(emitter, 1, 1);
+    emit_particles(emitter, 25000);
+    particle_emitter_set_lifetime(emitter, 3, 3);
+    emit_particles(emitter, 25000);
+    REQUIRE(particle_count(emitter) == 50000);
+
+    update_particle_emitter(emitter, 0.5);
+    REQUIRE(particle_count(emitter) == 50000);
+
+    update_particle_emitter(emitter, 1);
+    REQUIRE(particle_count(emitter) == 25000);
+
+    update_particle_emitter(emitter, 2);
+    REQUIRE(particle_count(emitter) == 0);
+
+    free_particle_emitter(emitter);
+    free_bitmap(bmp);
+}
+
+TEST_CASE("particle emitters need a bitmap and a capacity", "[particles]")
+{
+    bitmap bmp = create_bitmap("particle_bitmap", 4, 4);
+
+    REQUIRE(create_particle_emitter(nullptr, 10) == nullptr);
+    REQUIRE(create_particle_emitter(bmp, 0) == nullptr);
+    REQUIRE(particle_count(nullptr) == 0);
+
+    free_bitmap(bmp);
+}
@@ -0,0 +1,71 @@
+/**
+ * Physics Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "images.h"
+#include "physics.h"
+#include "sprites.h"
+
+using namespace splashkit_lib;
+
+TEST_CASE("physics bodies move under gravity", "[physics]")
+{
+    physics_world world = create_physics_world(vector_to(0, 100));
+    int body = physics_add_circle(world, circle_at(100, 100, 10), 1);
+    int ground = physics_add_rectangle(world, rectangle_from(0, 500, 800, 20), 0);
+    REQUIRE(body >= 0);
+    REQUIRE(ground >= 0);
+    REQUIRE(physics_body_count(world) == 2);
+
+    update_physics_world(world, 0.5);
+
+    REQUIRE(physics_body_position(world, body).y > 100);
+    REQUIRE(physics_body_velocity(world, body).y > 0);
+    REQUIRE(physics_body_position(world, ground).y == 510);
+
+    physics_remove_body(world, body);
+    REQUIRE(physics_body_count(world) == 1);
+
+    free_physics_world(world);
+}
+
+TEST_CASE("physics worlds move the sprites added to them", "[physics]")
+{
+    physics_world world = create_physics_world(vector_to(0, 100));
+    bitmap bmp = create_bitmap("physics_sprite_bitmap", 10, 10);
+    sprite s = create_sprite("physics_sprite", bmp);
+    sprite_set_position(s, point_at(100, 100));
+
+    REQUIRE(physics_add_sprite(world, nullptr, false) == -1);
+
+    int body = physics_add_sprite(world, s, false);
+    REQUIRE(body >= 0);
+    REQUIRE(physics_body_count(world) == 1);
+
+    update_physics_world(world, 0.5);
+    REQUIRE(sprite_y(s) > 100);
+
+    SECTION("freeing the sprite removes its body")
+    {
+        free_sprite(s);
+        REQUIRE(physics_body_count(world) == 0);
+
+        // the world no longer moves the freed sprite
+        update_physics_world(world, 0.5);
+        REQUIRE(physics_body_count(world) == 0);
+    }
+    SECTION("removing the body leaves the sprite where it is")
+    {
+        physics_remove_body(world, body);
+        float y = sprite_y(s);
+        update_physics_world(world, 0.5);
+        REQUIRE(sprite_y(s) == y);
+        free_sprite(s);
+    }
+
+    free_bitmap(bmp);
+    free_physics_world(world);
+}
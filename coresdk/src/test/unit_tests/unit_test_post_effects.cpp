@@ -0,0 +1,46 @@
+/**
+ * Post Effect Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "graphics.h"
+#include "window_manager.h"
+
+#include "backend_types.h"
+#include "post_effect_driver.h"
+
+using namespace splashkit_lib;
+
+TEST_CASE("bloom only spreads the bright parts of the frame", "[post_effects]")
+{
+    window wind = open_window("post effects", 64, 64);
+    clear_window(wind, COLOR_BLACK);
+    fill_rectangle_on_window(wind, COLOR_WHITE, 0, 0, 16, 16);
+    add_window_post_effect(wind, BLOOM_EFFECT, COLOR_WHITE, 1);
+    REQUIRE(window_post_effect_count(wind) == 1);
+
+    SECTION("bright areas stay bright")
+    {
+        sk_color bright = sk_read_post_effect_pixel(&wind->image.surface, 4, 4);
+        REQUIRE(bright.r > 0.99f);
+        REQUIRE(bright.g > 0.99f);
+    }
+    SECTION("dark areas away from the bright ones gain no glow")
+    {
+        sk_color dark = sk_read_post_effect_pixel(&wind->image.surface, 60, 60);
+        REQUIRE(dark.r < 0.02f);
+        REQUIRE(dark.g < 0.02f);
+        REQUIRE(dark.b < 0.02f);
+    }
+    SECTION("the effects do not change the window's own pixels")
+    {
+        sk_read_post_effect_pixel(&wind->image.surface, 60, 60);
+        REQUIRE(get_pixel(wind, 60, 60).r < 0.02f);
+    }
+
+    clear_window_post_effects(wind);
+    REQUIRE(window_post_effect_count(wind) == 0);
+    close_window(wind);
+}
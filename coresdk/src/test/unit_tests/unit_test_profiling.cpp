@@ -0,0 +1,88 @@
+/**
+ * Profiling Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "profiling.h"
+#include "profiling_driver.h"
+
+using namespace splashkit_lib;
+
+// The events of the frame just closed, or none if no frame was recorded
+static vector<sk_profile_event> _last_frame_events()
+{
+    vector<sk_profile_frame> frames = sk_profile_frames();
+    if ( frames.empty() ) return vector<sk_profile_event>();
+    return frames.back().events;
+}
+
+TEST_CASE("profile zones are recorded while profiling is enabled", "[profiling]")
+{
+    enable_profiling();
+    sk_profile_next_frame();
+
+    SECTION("nested zones are recorded with their depth")
+    {
+        profile_begin("outer");
+        profile_begin("inner");
+        profile_end();
+        profile_end();
+        sk_profile_next_frame();
+
+        vector<sk_profile_event> events = _last_frame_events();
+        REQUIRE(events.size() == 2);
+        REQUIRE(sk_profile_name(events[0].name) == "inner");
+        REQUIRE(events[0].depth == 1);
+        REQUIRE(sk_profile_name(events[1].name) == "outer");
+        REQUIRE(events[1].depth == 0);
+        REQUIRE(events[1].duration_ns >= events[0].duration_ns);
+    }
+    SECTION("the same name always maps to the same id")
+    {
+        REQUIRE(sk_profile_name_id("physics") == sk_profile_name_id("physics"));
+        REQUIRE(sk_profile_name_id("physics") != sk_profile_name_id("drawing"));
+    }
+    SECTION("an unmatched profile_end is ignored")
+    {
+        profile_end();
+        sk_profile_next_frame();
+        REQUIRE(_last_frame_events().empty());
+    }
+
+    disable_profiling();
+}
+
+TEST_CASE("profile zones are skipped while profiling is disabled", "[profiling]")
+{
+    SECTION("zones started while disabled are not recorded")
+    {
+        disable_profiling();
+        REQUIRE_FALSE(profiling_enabled());
+
+        profile_begin("while disabled");
+        profile_end();
+
+        enable_profiling();
+        sk_profile_next_frame();
+        REQUIRE(_last_frame_events().empty());
+    }
+    SECTION("a zone started while disabled still pairs with its end")
+    {
+        disable_profiling();
+        profile_begin("while disabled");
+
+        enable_profiling();
+        sk_profile_next_frame();
+        profile_begin("while enabled");
+        profile_end();
+        profile_end();
+        sk_profile_next_frame();
+
+        vector<sk_profile_event> events = _last_frame_events();
+        REQUIRE(events.size() == 1);
+        REQUIRE(sk_profile_name(events[0].name) == "while enabled");
+    }
+
+    disable_profiling();
+}
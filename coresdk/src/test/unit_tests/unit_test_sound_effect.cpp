@@ -7,6 +7,8 @@
 #include "types.h"
 #include "audio.h"
 #include "resources.h"
+#include "images.h"
+#include "sprites.h"
 
 using namespace splashkit_lib;
 
@@ -88,3 +90,42 @@ TEST_CASE("sound effects can be loaded, played and freed", "[sound_effect]")
         }
     }
 }
+TEST_CASE("sound emitters follow sprites until they are freed", "[sound_effect]")
+{
+    open_audio();
+    sound_effect snd = load_sound_effect("emitter_sound", "SwinGameStart.wav");
+    REQUIRE(snd != nullptr);
+
+    bitmap bmp = create_bitmap("emitter_sprite_bitmap", 10, 10);
+    sprite s = create_sprite("emitter_sprite", bmp);
+    sprite_set_x(s, 100);
+    sprite_set_y(s, 50);
+
+    REQUIRE(create_sound_emitter(snd, nullptr, 100) == nullptr);
+
+    sound_emitter emitter = create_sound_emitter(snd, s, 1000);
+    REQUIRE(emitter != nullptr);
+    set_sound_listener_position(point_at(0, 0));
+    start_sound_emitter(emitter, -1);
+    REQUIRE(sound_emitter_position(emitter).x == 105);
+    REQUIRE(sound_emitter_position(emitter).y == 55);
+
+    SECTION("the emitter moves with the sprite")
+    {
+        sprite_set_x(s, 200);
+        update_sound_emitters();
+        REQUIRE(sound_emitter_position(emitter).x == 205);
+        free_sprite(s);
+    }
+    SECTION("the emitter stays where a freed sprite was")
+    {
+        free_sprite(s);
+        update_sound_emitters();
+        REQUIRE(sound_emitter_position(emitter).x == 105);
+        REQUIRE(sound_emitter_position(emitter).y == 55);
+    }
+
+    free_sound_emitter(emitter);
+    free_bitmap(bmp);
+    free_sound_effect(snd);
+}
@@ -0,0 +1,102 @@
+/**
+ * Spatial Index Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "spatial_index.h"
+#include "circle_geometry.h"
+#include "line_geometry.h"
+#include "point_geometry.h"
+#include "rectangle_geometry.h"
+#include "vector_2d.h"
+
+#include <algorithm>
+
+using namespace splashkit_lib;
+
+TEST_CASE("shapes can be added to a spatial index", "[spatial_index]")
+{
+    spatial_index index = create_spatial_index();
+    REQUIRE(index != nullptr);
+
+    SECTION("each shape is given the next id")
+    {
+        REQUIRE(spatial_index_add(index, rectangle_from(0, 0, 10, 10)) == 0);
+        REQUIRE(spatial_index_add(index, circle_at(50, 50, 5)) == 1);
+        REQUIRE(spatial_index_add(index, line_from(0, 0, 100, 0)) == 2);
+        REQUIRE(spatial_index_count(index) == 3);
+        REQUIRE(spatial_index_has_shape(index, 1));
+        REQUIRE_FALSE(spatial_index_has_shape(index, 3));
+    }
+    SECTION("lines added together get ids that follow the first")
+    {
+        spatial_index_add(index, rectangle_from(0, 0, 10, 10));
+
+        vector<line> lines = { line_from(0, 0, 10, 0), line_from(0, 10, 10, 10), line_from(0, 20, 10, 20) };
+        REQUIRE(spatial_index_add(index, lines) == 1);
+        REQUIRE(spatial_index_count(index) == 4);
+        REQUIRE(spatial_index_has_shape(index, 3));
+    }
+    SECTION("adding no lines returns -1 and leaves the index unchanged")
+    {
+        spatial_index_add(index, rectangle_from(0, 0, 10, 10));
+
+        REQUIRE(spatial_index_add(index, vector<line>()) == -1);
+        REQUIRE(spatial_index_count(index) == 1);
+        REQUIRE(spatial_index_add(index, circle_at(0, 0, 1)) == 1);
+    }
+    SECTION("removed shapes keep their id to themselves")
+    {
+        int first = spatial_index_add(index, rectangle_from(0, 0, 10, 10));
+        REQUIRE(spatial_index_remove(index, first));
+        REQUIRE_FALSE(spatial_index_remove(index, first));
+        REQUIRE(spatial_index_count(index) == 0);
+        REQUIRE(spatial_index_add(index, rectangle_from(0, 0, 10, 10)) == first + 1);
+    }
+
+    free_spatial_index(index);
+}
+
+TEST_CASE("spatial indexes find the shapes in an area", "[spatial_index]")
+{
+    spatial_index index = create_spatial_index();
+
+    int near_id = spatial_index_add(index, rectangle_from(0, 0, 10, 10));
+    int far_id = spatial_index_add(index, circle_at(500, 500, 10));
+    int wall_id = spatial_index_add(index, line_from(100, -50, 100, 50));
+
+    SECTION("before and after the tree is built")
+    {
+        for (int pass = 0; pass < 2; pass++)
+        {
+            vector<int> found = spatial_index_query(index, rectangle_from(-5, -5, 20, 20));
+            REQUIRE(found.size() == 1);
+            REQUIRE(found[0] == near_id);
+
+            found = spatial_index_query(index, circle_at(505, 505, 2));
+            REQUIRE(found.size() == 1);
+            REQUIRE(found[0] == far_id);
+
+            build_spatial_index(index);
+        }
+    }
+    SECTION("removed shapes are not found")
+    {
+        spatial_index_remove(index, near_id);
+        REQUIRE(spatial_index_query(index, rectangle_from(-5, -5, 20, 20)).empty());
+    }
+    SECTION("rays hit the nearest shape")
+    {
+        raycast_hit hit;
+        REQUIRE(spatial_index_raycast(index, point_at(50, 0), vector_to(1, 0), 1000, hit));
+        REQUIRE(hit.shape_id == wall_id);
+        REQUIRE(hit.distance > 49.99);
+        REQUIRE(hit.distance < 50.01);
+
+        REQUIRE_FALSE(spatial_index_raycast(index, point_at(50, 0), vector_to(0, -1), 1000, hit));
+        REQUIRE(hit.shape_id == -1);
+    }
+
+    free_spatial_index(index);
+}
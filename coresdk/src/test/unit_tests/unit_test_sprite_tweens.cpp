@@ -0,0 +1,92 @@
+/**
+ * Sprite Tween Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "images.h"
+#include "sprites.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace splashkit_lib;
+
+// Lets a tween of the given length run to its end
+static void _finish_tweens(int ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms + 20));
+    update_sprite_tweens();
+}
+
+TEST_CASE("sprite tweens move properties to their targets", "[sprites]")
+{
+    bitmap bmp = create_bitmap("tween_sprite_bitmap", 10, 10);
+    sprite s = create_sprite("tween_sprite", bmp);
+    sprite_set_position(s, point_at(0, 0));
+
+    SECTION("positions keep their double precision")
+    {
+        // 16777217.5 can not be held by a float
+        sprite_tween_position(s, point_at(16777217.5, -3.25), 0.01f, LINEAR_EASING);
+        REQUIRE(sprite_tweening(s));
+
+        _finish_tweens(10);
+        REQUIRE(sprite_position(s).x == 16777217.5);
+        REQUIRE(sprite_position(s).y == -3.25);
+        REQUIRE_FALSE(sprite_tweening(s));
+    }
+    SECTION("rotation is kept within 0 to 360, as by sprite_set_rotation")
+    {
+        sprite_set_rotation(s, 0);
+        sprite_tween_rotation(s, 370, 0.01f, EASE_OUT_QUAD_EASING);
+
+        _finish_tweens(10);
+        REQUIRE(sprite_rotation(s) > 9.99);
+        REQUIRE(sprite_rotation(s) < 10.01);
+    }
+    SECTION("scale and values reach their targets")
+    {
+        sprite_add_value(s, "tween_health", 10);
+        int id = sprite_value_id("tween_health");
+
+        sprite_tween_scale(s, 2, 0.01f, EASE_IN_CUBIC_EASING);
+        sprite_tween_value(s, id, 25, 0.01f, EASE_OUT_BOUNCE_EASING);
+
+        _finish_tweens(10);
+        REQUIRE(sprite_scale(s) == 2);
+        REQUIRE(sprite_value(s, "tween_health") == 25);
+        REQUIRE_FALSE(sprite_tweening(s));
+    }
+    SECTION("a new tween of a property replaces the old one")
+    {
+        sprite_tween_scale(s, 5, 10, LINEAR_EASING);
+        sprite_tween_scale(s, 3, 0.01f, LINEAR_EASING);
+
+        _finish_tweens(10);
+        REQUIRE(sprite_scale(s) == 3);
+        REQUIRE_FALSE(sprite_tweening(s));
+    }
+    SECTION("stopped tweens leave properties where they are")
+    {
+        sprite_tween_position(s, point_at(1000, 1000), 10, LINEAR_EASING);
+        REQUIRE(sprite_tweening(s));
+
+        sprite_stop_tweens(s);
+        REQUIRE_FALSE(sprite_tweening(s));
+
+        point_2d at = sprite_position(s);
+        _finish_tweens(10);
+        REQUIRE(sprite_position(s).x == at.x);
+        REQUIRE(sprite_position(s).y == at.y);
+    }
+    SECTION("values the sprite does not have are not tweened")
+    {
+        sprite_tween_value(s, sprite_value_id("tween_missing_value"), 5, 0.01f, LINEAR_EASING);
+        REQUIRE_FALSE(sprite_tweening(s));
+    }
+
+    free_sprite(s);
+    free_bitmap(bmp);
+}
@@ -0,0 +1,104 @@
+/**
+ * Tilemap Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "images.h"
+#include "tilemap.h"
+
+#include <vector>
+
+using namespace splashkit_lib;
+
+TEST_CASE("tilemaps hold a grid of tiles", "[tilemap]")
+{
+    bitmap tileset = create_bitmap("tilemap_tileset", 64, 32);
+    bitmap_set_cell_details(tileset, 16, 8, 4, 4, 16);
+
+    tilemap map = create_tilemap(tileset, 5, 3);
+    REQUIRE(map != nullptr);
+
+    SECTION("the map has the size it was created with, and starts empty")
+    {
+        REQUIRE(tilemap_columns(map) == 5);
+        REQUIRE(tilemap_rows(map) == 3);
+
+        for (int row = 0; row < 3; row++)
+            for (int col = 0; col < 5; col++)
+                REQUIRE(tilemap_tile(map, col, row) == -1);
+    }
+    SECTION("tiles can be set and read back")
+    {
+        tilemap_set_tile(map, 4, 2, 7);
+        REQUIRE(tilemap_tile(map, 4, 2) == 7);
+
+        tilemap_set_tile(map, 4, 2, -5);
+        REQUIRE(tilemap_tile(map, 4, 2) == -1);
+    }
+    SECTION("tiles outside the map are empty and can not be set")
+    {
+        tilemap_set_tile(map, 5, 0, 1);
+        tilemap_set_tile(map, -1, 0, 1);
+        REQUIRE(tilemap_tile(map, 5, 0) == -1);
+        REQUIRE(tilemap_tile(map, 0, 3) == -1);
+        REQUIRE(tilemap_tile(map, -1, -1) == -1);
+    }
+    SECTION("all tiles are set at once, row by row")
+    {
+        std::vector<int> cells;
+        for (int i = 0; i < 15; i++) cells.push_back(i);
+
+        tilemap_set_tiles(map, cells);
+        REQUIRE(tilemap_tile(map, 0, 0) == 0);
+        REQUIRE(tilemap_tile(map, 4, 0) == 4);
+        REQUIRE(tilemap_tile(map, 0, 1) == 5);
+        REQUIRE(tilemap_tile(map, 4, 2) == 14);
+    }
+    SECTION("tiles are not changed by a list of the wrong size")
+    {
+        tilemap_set_tiles(map, std::vector<int>(14, 3));
+        REQUIRE(tilemap_tile(map, 0, 0) == -1);
+    }
+    SECTION("tiles start at the cell size of the tileset")
+    {
+        REQUIRE(tilemap_tile_width(map) == 16);
+        REQUIRE(tilemap_tile_height(map) == 8);
+    }
+    SECTION("the tile size can be changed, keeping the tiles")
+    {
+        tilemap_set_tile(map, 1, 1, 3);
+        tilemap_set_tile_size(map, 32, 24);
+
+        REQUIRE(tilemap_tile_width(map) == 32);
+        REQUIRE(tilemap_tile_height(map) == 24);
+        REQUIRE(tilemap_tile(map, 1, 1) == 3);
+    }
+    SECTION("invalid tile sizes are ignored")
+    {
+        tilemap_set_tile_size(map, 0, 8);
+        tilemap_set_tile_size(map, 16, -1);
+        tilemap_set_tile_size(map, 4096, 8);
+
+        REQUIRE(tilemap_tile_width(map) == 16);
+        REQUIRE(tilemap_tile_height(map) == 8);
+    }
+
+    free_tilemap(map);
+    free_bitmap(tileset);
+}
+
+TEST_CASE("tilemaps are only created with a valid tileset and size", "[tilemap]")
+{
+    bitmap tileset = create_bitmap("tilemap_tileset", 16, 16);
+
+    REQUIRE(create_tilemap(nullptr, 4, 4) == nullptr);
+    REQUIRE(create_tilemap(tileset, 0, 4) == nullptr);
+    REQUIRE(create_tilemap(tileset, 4, -1) == nullptr);
+
+    free_bitmap(tileset);
+
+    REQUIRE(tilemap_tile_width(nullptr) == 0);
+    REQUIRE(tilemap_tile_height(nullptr) == 0);
+}
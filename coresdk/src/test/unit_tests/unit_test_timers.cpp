@@ -0,0 +1,199 @@
+/**
+ * Timer Unit Tests
+ */
+
+#include "catch.hpp"
+
+#include "timers.h"
+#include "utils.h"
+
+#include <vector>
+
+using namespace splashkit_lib;
+
+namespace splashkit_lib
+{
+    // In timers, runs the wheel up to a time rather than the clock
+    void _run_scheduled_calls_until(long long now);
+}
+
+static std::vector<int> _calls_made;
+static int _cancel_after = 0;
+
+static void _record_call(int id)
+{
+    _calls_made.push_back(id);
+}
+
+static void _record_and_stop(int id)
+{
+    _calls_made.push_back(id);
+    if ( static_cast<int>(_calls_made.size()) >= _cancel_after ) cancel_scheduled_call(id);
+}
+
+// Milliseconds on the clock the scheduled calls use
+static long long _now_ms()
+{
+    return current_ticks_ns() / 1000000;
+}
+
+TEST_CASE("scheduled calls are made once their time has passed", "[timers]")
+{
+    cancel_all_scheduled_calls();
+    _calls_made.clear();
+
+    SECTION("a call is made once, with its own id")
+    {
+        long long start = _now_ms();
+        int id = call_after(20, _record_call);
+        REQUIRE(id >= 0);
+        REQUIRE(has_scheduled_call(id));
+
+        _run_scheduled_calls_until(start + 19);
+        REQUIRE(_calls_made.empty());
+
+        _run_scheduled_calls_until(start + 25);
+        REQUIRE(_calls_made.size() == 1);
+        REQUIRE(_calls_made[0] == id);
+        REQUIRE_FALSE(has_scheduled_call(id));
+
+        _run_scheduled_calls_until(start + 100);
+        REQUIRE(_calls_made.size() == 1);
+    }
+    SECTION("calls are made in the order they are due")
+    {
+        long long start = _now_ms();
+        int later = call_after(30, _record_call);
+        int sooner = call_after(10, _record_call);
+
+        _run_scheduled_calls_until(start + 40);
+        REQUIRE(_calls_made.size() == 2);
+        REQUIRE(_calls_made[0] == sooner);
+        REQUIRE(_calls_made[1] == later);
+    }
+    SECTION("calls without a callback are not scheduled")
+    {
+        REQUIRE(call_after(10, nullptr) == -1);
+        REQUIRE(call_every(10, nullptr) == -1);
+    }
+    SECTION("repeating calls are made each interval, including missed ones")
+    {
+        long long start = _now_ms();
+        int id = call_every(10, _record_call);
+
+        _run_scheduled_calls_until(start + 105);
+        REQUIRE(_calls_made.size() == 10);
+        REQUIRE(has_scheduled_call(id));
+
+        cancel_scheduled_call(id);
+    }
+
+    cancel_all_scheduled_calls();
+}
+
+TEST_CASE("scheduled calls move down the wheel as it turns", "[timers]")
+{
+    cancel_all_scheduled_calls();
+    _calls_made.clear();
+
+    SECTION("past the end of the first level")
+    {
+        long long start = _now_ms();
+        call_after(100, _record_call);
+
+        _run_scheduled_calls_until(start + 99);
+        REQUIRE(_calls_made.empty());
+        _run_scheduled_calls_until(start + 105);
+        REQUIRE(_calls_made.size() == 1);
+    }
+    SECTION("past the end of the second level")
+    {
+        long long start = _now_ms();
+        call_after(5000, _record_call);
+
+        _run_scheduled_calls_until(start + 4999);
+        REQUIRE(_calls_made.empty());
+        _run_scheduled_calls_until(start + 5005);
+        REQUIRE(_calls_made.size() == 1);
+    }
+    SECTION("beyond the range of the whole wheel")
+    {
+        long long start = _now_ms();
+        call_after(20000000, _record_call);
+
+        _run_scheduled_calls_until(start + 19999999);
+        REQUIRE(_calls_made.empty());
+        _run_scheduled_calls_until(start + 20000005);
+        REQUIRE(_calls_made.size() == 1);
+    }
+    SECTION("repeating calls keep their interval across levels")
+    {
+        long long start = _now_ms();
+        call_every(1000, _record_call);
+
+        _run_scheduled_calls_until(start + 10005);
+        REQUIRE(_calls_made.size() == 10);
+    }
+
+    cancel_all_scheduled_calls();
+}
+
+TEST_CASE("scheduled calls can be cancelled", "[timers]")
+{
+    cancel_all_scheduled_calls();
+    _calls_made.clear();
+
+    SECTION("before they are due")
+    {
+        long long start = _now_ms();
+        int id = call_after(10, _record_call);
+        cancel_scheduled_call(id);
+        REQUIRE_FALSE(has_scheduled_call(id));
+
+        _run_scheduled_calls_until(start + 20);
+        REQUIRE(_calls_made.empty());
+    }
+    SECTION("by a repeating call, from within its callback")
+    {
+        long long start = _now_ms();
+        _cancel_after = 3;
+        int id = call_every(5, _record_and_stop);
+
+        _run_scheduled_calls_until(start + 100);
+        REQUIRE(_calls_made.size() == 3);
+        REQUIRE_FALSE(has_scheduled_call(id));
+    }
+    SECTION("ids of finished calls do not match calls that reuse their slot")
+    {
+        int old_id = call_after(10, _record_call);
+        cancel_scheduled_call(old_id);
+
+        int new_id = call_after(10, _record_call);
+        REQUIRE(new_id != old_id);
+        REQUIRE_FALSE(has_scheduled_call(old_id));
+
+        cancel_scheduled_call(old_id);
+        REQUIRE(has_scheduled_call(new_id));
+    }
+    SECTION("all at once")
+    {
+        long long start = _now_ms();
+        int first = call_after(10, _record_call);
+        int second = call_every(10, _record_call);
+
+        cancel_all_scheduled_calls();
+        REQUIRE_FALSE(has_scheduled_call(first));
+        REQUIRE_FALSE(has_scheduled_call(second));
+
+        _run_scheduled_calls_until(start + 50);
+        REQUIRE(_calls_made.empty());
+    }
+    SECTION("unknown ids are ignored")
+    {
+        cancel_scheduled_call(-1);
+        cancel_scheduled_call(12345);
+        REQUIRE_FALSE(has_scheduled_call(-1));
+    }
+
+    cancel_all_scheduled_calls();
+}
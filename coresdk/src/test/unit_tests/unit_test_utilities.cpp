@@ -136,6 +136,12 @@ TEST_CASE("string is converted to double", "[covert_to_double]")
     {
         REQUIRE(convert_to_double("-1.23e2") == -123.0);
     }
+    SECTION("string is hexadecimal")
+    {
+        REQUIRE(convert_to_double("0x1A") == 26.0);
+        REQUIRE(convert_to_double("-0x1a") == -26.0);
+        REQUIRE(convert_to_double(" 0x1.8p1 ") == 3.0);
+    }
     SECTION("string is a decimal number with no integer or decimal part")
     {
         REQUIRE_THROWS(convert_to_double("."));
@@ -227,6 +233,10 @@ TEST_CASE("string is converted to integer", "[covert_to_integer]")
     {
         REQUIRE_THROWS(convert_to_integer("."));
     }
+    SECTION("string is hexadecimal, which is read up to the x")
+    {
+        REQUIRE(convert_to_integer("0x1A") == 0);
+    }
     SECTION("string is not a number")
     {
         REQUIRE_THROWS(convert_to_integer("SplashKit"));
@@ -388,6 +398,10 @@ TEST_CASE("verify that string is integer", "[is_integer]")
     {
         REQUIRE_FALSE(is_integer(""));
     }
+    SECTION("string is hexadecimal")
+    {
+        REQUIRE_FALSE(is_integer("0x1A"));
+    }
 }
 TEST_CASE("verify that string is number", "[is_number]")
 {
@@ -451,6 +465,21 @@ TEST_CASE("verify that string is number", "[is_number]")
     {
         REQUIRE_FALSE(is_number(""));
     }
+    SECTION("string is hexadecimal")
+    {
+        REQUIRE(is_number("0x1A"));
+        REQUIRE(is_number("-0x1a"));
+        REQUIRE(is_number("+0X1A"));
+        REQUIRE(is_number("0x1.8p1"));
+        REQUIRE(is_double("0x1A"));
+    }
+    SECTION("string is not complete hexadecimal")
+    {
+        REQUIRE_FALSE(is_number("0x"));
+        REQUIRE_FALSE(is_number("0xG"));
+        REQUIRE_FALSE(is_number("0x-1A"));
+        REQUIRE_FALSE(is_number("0x1A fred"));
+    }
 }
 TEST_CASE("length of string is calculated", "[length_of]")
 {
@@ -705,6 +734,53 @@ TEST_CASE("random number int between min and max is generated", "[rnd(int min, i
         REQUIRE(result == 1);
     }
 }
+TEST_CASE("random sequence can be replayed by seeding", "[rnd_seed]")
+{
+    rnd_seed(1234);
+    int first = rnd(0, 1000000);
+    float second = rnd();
+    rnd_seed(1234);
+    REQUIRE(rnd(0, 1000000) == first);
+    REQUIRE(rnd() == second);
+}
+TEST_CASE("random values are generated in bulk", "[rnd_fill]")
+{
+    SECTION("floats are between 0 and 1")
+    {
+        vector<float> values(37);
+        rnd_fill(values);
+        for (float v : values)
+        {
+            REQUIRE(v >= 0);
+            REQUIRE(v < 1);
+        }
+    }
+    SECTION("ints are between min and max")
+    {
+        vector<int> values(37);
+        rnd_fill(values, -5, 5);
+        for (int v : values)
+        {
+            REQUIRE(v >= -5);
+            REQUIRE(v < 5);
+        }
+    }
+    SECTION("min and max are equal")
+    {
+        vector<int> values(5);
+        rnd_fill(values, 3, 3);
+        for (int v : values)
+        {
+            REQUIRE(v == 3);
+        }
+    }
+    SECTION("empty values are left empty")
+    {
+        vector<float> values;
+        rnd_fill(values);
+        REQUIRE(values.empty());
+    }
+}
 TEST_CASE("gets the number of milliseconds that have passed since the program was started", "[current_ticks]")
 {
     unsigned int result = current_ticks();
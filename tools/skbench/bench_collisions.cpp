@@ -0,0 +1,223 @@
+//
+//  bench_collisions.cpp
+//  splashkit
+//
+//  Benchmarks for collision tests and geometry. Shapes and positions are
+//  made from a fixed seed, so each run tests the same cases and roughly
+//  the same share of them collide.
+//
+
+#include "skbench.h"
+
+#include "circle_drawing.h"
+#include "circle_geometry.h"
+#include "collisions.h"
+#include "color.h"
+#include "drawing_options.h"
+#include "images.h"
+#include "line_geometry.h"
+#include "matrix_2d.h"
+#include "point_geometry.h"
+#include "quad_geometry.h"
+#include "random.h"
+#include "rectangle_geometry.h"
+#include "sprites.h"
+#include "triangle_geometry.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace splashkit_lib;
+
+// Shapes are reused in turn, so keep the count a power of two
+#define SHAPE_COUNT 1024
+#define SHAPE_MASK (SHAPE_COUNT - 1)
+#define TESTS_PER_SAMPLE 10000
+#define COLLISION_SEED 42
+// Sprites are placed in an area this size, so that many of them overlap
+#define SPRITE_AREA 400
+
+static vector<circle> _circles;
+static vector<triangle> _triangles;
+static vector<quad> _quads;
+static vector<line> _lines;
+static vector<point_2d> _points, _transformed;
+static vector<sprite> _sprites;
+
+static int _collisions;
+
+static double _rnd_range(double min, double max)
+{
+    return min + rnd() * (max - min);
+}
+
+static point_2d _rnd_point(double size)
+{
+    return point_at(_rnd_range(0, size), _rnd_range(0, size));
+}
+
+static void _setup_shapes()
+{
+    if ( ! _circles.empty() ) return;
+
+    rnd_seed(COLLISION_SEED);
+
+    for (int i = 0; i < SHAPE_COUNT; i++)
+    {
+        _circles.push_back(circle_at(_rnd_point(200), _rnd_range(5, 40)));
+
+        point_2d a = _rnd_point(200);
+        _triangles.push_back(triangle_from(a, point_at(a.x + _rnd_range(-60, 60), a.y + _rnd_range(-60, 60)), point_at(a.x + _rnd_range(-60, 60), a.y + _rnd_range(-60, 60))));
+
+        rectangle r = rectangle_from(_rnd_range(0, 200), _rnd_range(0, 200), _rnd_range(5, 60), _rnd_range(5, 60));
+        _quads.push_back(quad_from(r, rotation_matrix(_rnd_range(0, 360))));
+
+        point_2d p = _rnd_point(200);
+        _lines.push_back(line_from(p.x, p.y, p.x + _rnd_range(-100, 100), p.y + _rnd_range(-100, 100)));
+
+        _points.push_back(_rnd_point(800));
+    }
+
+    _transformed.resize(SHAPE_COUNT);
+}
+
+static void _report_hits(int ops)
+{
+    bench_metric("hit_rate", static_cast<double>(_collisions) / ops);
+    _collisions = 0;
+}
+
+static void _setup_sprites(collision_test_kind kind, bool rotated)
+{
+    _setup_shapes();
+
+    bitmap bmp = bitmap_named("skbench_frog");
+    if ( ! bmp ) bmp = load_bitmap("skbench_frog", "frog.png");
+    setup_collision_mask(bmp);
+
+    rnd_seed(COLLISION_SEED);
+    for (int i = 0; i < SHAPE_COUNT; i++)
+    {
+        sprite s = create_sprite(bmp);
+        sprite_set_position(s, _rnd_point(SPRITE_AREA));
+        sprite_set_collision_kind(s, kind);
+        if ( rotated ) sprite_set_rotation(s, _rnd_range(0, 360));
+        _sprites.push_back(s);
+    }
+}
+
+static void _free_sprites()
+{
+    for (sprite s : _sprites)
+        free_sprite(s);
+    _sprites.clear();
+}
+
+static void _add_sprite_benchmark(const string &name, collision_test_kind kind, bool rotated)
+{
+    add_benchmark("collisions", name, TESTS_PER_SAMPLE, [](int ops)
+    {
+        for (int i = 0; i < ops; i++)
+        {
+            if ( sprite_collision(_sprites[i & SHAPE_MASK], _sprites[(i * 7 + 1) & SHAPE_MASK]) ) _collisions++;
+        }
+        _report_hits(ops);
+    },
+    [kind, rotated]() { _setup_sprites(kind, rotated); },
+    _free_sprites);
+}
+
+// A bitmap of a filled circle, so collisions depend on its pixels and not only its bounds
+static bitmap _circle_bitmap(int size)
+{
+    string name = "skbench_circle_" + to_string(size);
+    bitmap bmp = bitmap_named(name);
+    if ( bmp ) return bmp;
+
+    bmp = create_bitmap(name, size, size);
+    clear_bitmap(bmp, COLOR_TRANSPARENT);
+    fill_circle(COLOR_BLACK, size / 2.0, size / 2.0, size / 2.0, option_draw_to(bmp));
+    setup_collision_mask(bmp);
+    return bmp;
+}
+
+static void _add_bitmap_benchmark(int size)
+{
+    add_benchmark("collisions", "bitmap_collision_" + to_string(size) + "px", TESTS_PER_SAMPLE, [size](int ops)
+    {
+        bitmap bmp = _circle_bitmap(size);
+        for (int i = 0; i < ops; i++)
+        {
+            // offsets within one size in each direction, so the bounds always overlap
+            const point_2d &offset = _points[i & SHAPE_MASK];
+            if ( bitmap_collision(bmp, 0, 0, bmp, (offset.x / 400.0 - 1) * size, (offset.y / 400.0 - 1) * size) ) _collisions++;
+        }
+        _report_hits(ops);
+    },
+    [size]() { _setup_shapes(); _circle_bitmap(size); });
+}
+
+void register_collision_benchmarks()
+{
+    _add_sprite_benchmark("sprite_aabb", AABB_COLLISIONS, false);
+    _add_sprite_benchmark("sprite_aabb_rotated", AABB_COLLISIONS, true);
+    _add_sprite_benchmark("sprite_polygon", POLYGON_COLLISIONS, false);
+    _add_sprite_benchmark("sprite_polygon_rotated", POLYGON_COLLISIONS, true);
+    _add_sprite_benchmark("sprite_pixel", PIXEL_COLLISIONS, false);
+    _add_sprite_benchmark("sprite_pixel_rotated", PIXEL_COLLISIONS, true);
+
+    // sprites have no circle collision kind, so test their collision circles directly
+    add_benchmark("collisions", "sprite_circles", TESTS_PER_SAMPLE, [](int ops)
+    {
+        for (int i = 0; i < ops; i++)
+        {
+            if ( circles_intersect(sprite_collision_circle(_sprites[i & SHAPE_MASK]), sprite_collision_circle(_sprites[(i * 7 + 1) & SHAPE_MASK])) ) _collisions++;
+        }
+        _report_hits(ops);
+    },
+    []() { _setup_sprites(AABB_COLLISIONS, false); },
+    _free_sprites);
+
+    _add_bitmap_benchmark(16);
+    _add_bitmap_benchmark(64);
+    _add_bitmap_benchmark(256);
+
+    add_benchmark("geometry", "circle_triangle_intersect", TESTS_PER_SAMPLE, [](int ops)
+    {
+        for (int i = 0; i < ops; i++)
+        {
+            if ( circle_triangle_intersect(_circles[i & SHAPE_MASK], _triangles[(i * 7 + 1) & SHAPE_MASK]) ) _collisions++;
+        }
+        _report_hits(ops);
+    }, _setup_shapes);
+
+    add_benchmark("geometry", "quads_intersect", TESTS_PER_SAMPLE, [](int ops)
+    {
+        for (int i = 0; i < ops; i++)
+        {
+            if ( quads_intersect(_quads[i & SHAPE_MASK], _quads[(i * 7 + 1) & SHAPE_MASK]) ) _collisions++;
+        }
+        _report_hits(ops);
+    }, _setup_shapes);
+
+    add_benchmark("geometry", "line_intersection_point", TESTS_PER_SAMPLE, [](int ops)
+    {
+        point_2d pt;
+        for (int i = 0; i < ops; i++)
+        {
+            if ( line_intersection_point(_lines[i & SHAPE_MASK], _lines[(i * 7 + 1) & SHAPE_MASK], pt) ) _collisions++;
+        }
+        bench_keep(pt);
+        _report_hits(ops);
+    }, _setup_shapes);
+
+    // each operation transforms one point of the array
+    add_benchmark("geometry", "matrix_multiply_points", SHAPE_COUNT, [](int ops)
+    {
+        matrix_2d m = scale_rotate_translate_matrix(point_at(1.5, 0.5), 30, point_at(100, 50));
+        for (int i = 0; i < ops; i++)
+            _transformed[i & SHAPE_MASK] = matrix_multiply(m, _points[i & SHAPE_MASK]);
+        bench_keep(_transformed[0]);
+    }, _setup_shapes);
+}
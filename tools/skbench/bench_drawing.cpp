@@ -0,0 +1,147 @@
+//
+//  bench_drawing.cpp
+//  splashkit
+//
+//  Each sample draws one frame of many shapes, bitmaps or text onto the
+//  benchmark window and shows it, so the time of each frame and the cost of
+//  each draw within it can be compared between builds.
+//
+
+#include "skbench.h"
+
+#include "circle_drawing.h"
+#include "color.h"
+#include "drawing_options.h"
+#include "images.h"
+#include "line_drawing.h"
+#include "random.h"
+#include "rectangle_drawing.h"
+#include "text.h"
+#include "window_manager.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace splashkit_lib;
+
+// The number of draws in each frame
+#define DRAWS_PER_FRAME 1000
+#define TEXT_PER_FRAME 100
+
+static vector<float> _xs, _ys;
+static bitmap _bmp = nullptr;
+static font _fnt = nullptr;
+
+// The same positions are used in every run
+static void _setup_positions()
+{
+    rnd_seed(1);
+    _xs.resize(DRAWS_PER_FRAME);
+    _ys.resize(DRAWS_PER_FRAME);
+    rnd_fill(_xs);
+    rnd_fill(_ys);
+
+    window wnd = bench_window();
+    for (int i = 0; i < DRAWS_PER_FRAME; i++)
+    {
+        _xs[i] *= window_width(wnd);
+        _ys[i] *= window_height(wnd);
+    }
+}
+
+static void _setup_bitmap()
+{
+    _setup_positions();
+    if ( ! _bmp ) _bmp = load_bitmap("skbench_frog", "frog.png");
+}
+
+static void _setup_font()
+{
+    _setup_positions();
+    if ( ! _fnt ) _fnt = load_font("skbench_hara", "hara.ttf");
+}
+
+static void _draw_bitmaps(int ops, const drawing_options &opts)
+{
+    clear_window(bench_window(), COLOR_WHITE);
+    for (int i = 0; i < ops; i++)
+        draw_bitmap(_bmp, _xs[i % DRAWS_PER_FRAME], _ys[i % DRAWS_PER_FRAME], opts);
+    bench_present();
+}
+
+void register_drawing_benchmarks()
+{
+    add_benchmark("drawing", "fill_rectangle", DRAWS_PER_FRAME, [](int ops)
+    {
+        clear_window(bench_window(), COLOR_WHITE);
+        for (int i = 0; i < ops; i++)
+            fill_rectangle(COLOR_RED, _xs[i % DRAWS_PER_FRAME], _ys[i % DRAWS_PER_FRAME], 20, 10);
+        bench_present();
+    }, _setup_positions);
+
+    add_benchmark("drawing", "draw_line", DRAWS_PER_FRAME, [](int ops)
+    {
+        clear_window(bench_window(), COLOR_WHITE);
+        for (int i = 0; i < ops; i++)
+        {
+            int j = (i + 1) % DRAWS_PER_FRAME;
+            draw_line(COLOR_BLUE, _xs[i % DRAWS_PER_FRAME], _ys[i % DRAWS_PER_FRAME], _xs[j], _ys[j]);
+        }
+        bench_present();
+    }, _setup_positions);
+
+    add_benchmark("drawing", "fill_circle", DRAWS_PER_FRAME, [](int ops)
+    {
+        clear_window(bench_window(), COLOR_WHITE);
+        for (int i = 0; i < ops; i++)
+            fill_circle(COLOR_GREEN, _xs[i % DRAWS_PER_FRAME], _ys[i % DRAWS_PER_FRAME], 15);
+        bench_present();
+    }, _setup_positions);
+
+    add_benchmark("drawing", "draw_bitmap", DRAWS_PER_FRAME, [](int ops)
+    {
+        _draw_bitmaps(ops, option_defaults());
+    }, _setup_bitmap);
+
+    add_benchmark("drawing", "draw_bitmap_rotated", DRAWS_PER_FRAME, [](int ops)
+    {
+        _draw_bitmaps(ops, option_rotate_bmp(30));
+    }, _setup_bitmap);
+
+    add_benchmark("drawing", "draw_bitmap_scaled", DRAWS_PER_FRAME, [](int ops)
+    {
+        _draw_bitmaps(ops, option_scale_bmp(1.5, 0.75));
+    }, _setup_bitmap);
+
+    // The same text each frame, which can reuse text drawn before
+    add_benchmark("drawing", "draw_text", TEXT_PER_FRAME, [](int ops)
+    {
+        clear_window(bench_window(), COLOR_WHITE);
+        for (int i = 0; i < ops; i++)
+            draw_text("The quick brown fox", COLOR_BLACK, _fnt, 18, _xs[i], _ys[i]);
+        bench_present();
+    }, _setup_font);
+
+    // Different text each frame, so every draw must render the text again
+    add_benchmark("drawing", "draw_text_changing", TEXT_PER_FRAME, [](int ops)
+    {
+        static int frame = 0;
+        frame++;
+
+        clear_window(bench_window(), COLOR_WHITE);
+        for (int i = 0; i < ops; i++)
+            draw_text("Score " + to_string(frame * TEXT_PER_FRAME + i), COLOR_BLACK, _fnt, 18, _xs[i], _ys[i]);
+        bench_present();
+    }, _setup_font);
+
+    // An empty frame, the cost every other drawing benchmark includes once per sample
+    add_benchmark("drawing", "refresh_window", 1, [](int ops)
+    {
+        for (int i = 0; i < ops; i++)
+        {
+            clear_window(bench_window(), COLOR_WHITE);
+            bench_present();
+        }
+    });
+}
@@ -0,0 +1,154 @@
+//
+//  bench_networking.cpp
+//  splashkit
+//
+//  Loopback benchmarks for sending and reading messages, based on the
+//  servers and connections set up in test_tcp_networking.cpp and
+//  test_udp_networking.cpp. Each sample has the clients send their share
+//  of the messages to one server, then checks for network activity until
+//  the server has read them all. Every message carries the time it was
+//  sent, so its latency is known when it is read.
+//
+
+#include "skbench.h"
+
+#include "networking.h"
+
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace splashkit_lib;
+
+// Each benchmark uses its own port, so sockets left closing by one do not affect the next
+#define BENCH_NETWORK_FIRST_PORT 47100
+// How long a sample waits for messages before counting them as lost
+#define BENCH_NETWORK_TIMEOUT 2.0
+#define MESSAGES_PER_SAMPLE 1000
+
+struct _network_bench
+{
+    connection_type protocol;
+    int message_size;
+    int clients;
+    unsigned short int port;
+
+    server_socket server;
+    vector<connection> connections;
+    vector<int8_t> payload;
+    vector<double> latencies;
+    long long received, lost;
+    clock_t cpu_start;
+};
+
+static _network_bench _bench;
+
+static void _setup_network_bench(const _network_bench &config)
+{
+    _bench = config;
+    _bench.latencies.clear();
+    _bench.received = 0;
+    _bench.lost = 0;
+    _bench.payload.assign(config.message_size, 7);
+
+    string name = "skbench_" + to_string(config.port);
+    _bench.server = create_server(name, config.port, config.protocol);
+
+    for (int i = 0; i < config.clients; i++)
+    {
+        connection con = open_connection(name + "_client_" + to_string(i), "127.0.0.1", config.port, config.protocol);
+        if ( config.protocol == TCP ) set_connection_no_delay(con, true);
+        _bench.connections.push_back(con);
+    }
+
+    // wait for the server to accept each tcp client
+    double deadline = bench_now() + BENCH_NETWORK_TIMEOUT;
+    while ( config.protocol == TCP && connection_count(_bench.server) < static_cast<unsigned int>(config.clients) && bench_now() < deadline )
+        check_network_activity();
+
+    _bench.cpu_start = clock();
+}
+
+static void _run_network_bench(int ops)
+{
+    // send, with the time written into the start of each message
+    for (int i = 0; i < ops; i++)
+    {
+        double now = bench_now();
+        memcpy(_bench.payload.data(), &now, sizeof(now));
+        send_message_bytes(_bench.connections[i % _bench.clients], _bench.payload);
+    }
+
+    int remaining = ops;
+    double deadline = bench_now() + BENCH_NETWORK_TIMEOUT;
+
+    while ( remaining > 0 && bench_now() < deadline )
+    {
+        check_network_activity();
+
+        message msg;
+        while ( remaining > 0 && (msg = read_message(_bench.server)) )
+        {
+            _bench.latencies.push_back((bench_now() - message_read_double(msg, 0)) * 1e6);
+            close_message(msg);
+            remaining--;
+        }
+    }
+
+    _bench.received += ops - remaining;
+    _bench.lost += remaining;
+}
+
+static void _teardown_network_bench()
+{
+    double cpu_seconds = static_cast<double>(clock() - _bench.cpu_start) / CLOCKS_PER_SEC;
+
+    bench_metric("latency_p50_us", bench_percentile(_bench.latencies, 50));
+    bench_metric("latency_p99_us", bench_percentile(_bench.latencies, 99));
+    bench_metric("cpu_us_per_message", _bench.received ? cpu_seconds * 1e6 / _bench.received : 0);
+    bench_metric("lost", _bench.lost);
+
+    for (connection con : _bench.connections)
+        close_connection(con);
+    _bench.connections.clear();
+
+    close_server(_bench.server);
+    _bench.server = nullptr;
+}
+
+static void _add_network_benchmark(connection_type protocol, int message_size, int clients)
+{
+    static unsigned short int next_port = BENCH_NETWORK_FIRST_PORT;
+
+    _network_bench config = {};
+    config.protocol = protocol;
+    config.message_size = message_size;
+    config.clients = clients;
+    config.port = next_port++;
+
+    string name = string(protocol == TCP ? "tcp_" : "udp_") + to_string(message_size) + "b_" + to_string(clients) + "_clients";
+
+    add_benchmark("networking", name, MESSAGES_PER_SAMPLE, _run_network_bench,
+        [config]() { _setup_network_bench(config); },
+        _teardown_network_bench);
+}
+
+void register_networking_benchmarks()
+{
+    int sizes[] = { 16, 256, 1024 };
+    int client_counts[] = { 1, 8 };
+
+    for (connection_type protocol : { TCP, UDP })
+    {
+        for (int size : sizes)
+        {
+            for (int clients : client_counts)
+                _add_network_benchmark(protocol, size, clients);
+        }
+    }
+
+    // larger messages are split across packets, so only tcp can send them
+    _add_network_benchmark(TCP, 16384, 1);
+}
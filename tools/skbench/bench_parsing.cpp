@@ -0,0 +1,271 @@
+//
+//  bench_parsing.cpp
+//  splashkit
+//
+//  Benchmarks for reading and writing json, and for the text parsing used
+//  by bundles and animation scripts. The corpus is in tools/skbench/corpus,
+//  and is copied into Resources/json next to skbench, along with the test
+//  bundles and animation scripts.
+//
+//  Large json files are made when the benchmarks start, by repeating the
+//  objects of save_game.json, and are kept in memory rather than checked
+//  in. SKBENCH_JSON_SIZES_MB sets their sizes, such as "10,50,200", and
+//  defaults to "10,50".
+//
+
+#include "skbench.h"
+
+#include "json.h"
+#include "resources.h"
+
+#include "utility_functions.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+using namespace splashkit_lib;
+
+#define DEFAULT_JSON_SIZES_MB "10,50"
+
+static double _rss_at_setup;
+
+static string _read_file(const string &path)
+{
+    ifstream in(path, ios::binary);
+    stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+static vector<string> _lines(const string &text)
+{
+    vector<string> result;
+    stringstream in(text);
+    string line;
+    while ( getline(in, line) )
+    {
+        if ( ! line.empty() && line.back() == '\r' ) line.pop_back();
+        if ( ! line.empty() && line.compare(0, 2, "//") != 0 ) result.push_back(line);
+    }
+    return result;
+}
+
+// A json document of at least the given size, built from the objects of the corpus save game
+static string _large_json(size_t megabytes)
+{
+    json save = json_from_file("save_game.json");
+    vector<json> objects;
+    json_read_array(save, "objects", objects);
+
+    vector<string> records;
+    for (json obj : objects)
+    {
+        records.push_back(json_to_string(obj));
+        free_json(obj);
+    }
+    free_json(save);
+
+    if ( records.empty() ) return "{}";
+
+    size_t target = megabytes * 1024 * 1024;
+    string result = "{\"version\":3,\"objects\":[";
+    result.reserve(target + 1024);
+
+    for (size_t i = 0; result.size() < target; i++)
+    {
+        if ( i ) result += ',';
+        result += records[i % records.size()];
+    }
+
+    return result + "]}";
+}
+
+static void _start_memory_use()
+{
+    _rss_at_setup = bench_peak_rss_mb();
+}
+
+static void _report_memory_use()
+{
+    double peak = bench_peak_rss_mb();
+    bench_metric("peak_rss_mb", peak);
+    bench_metric("peak_rss_growth_mb", peak - _rss_at_setup);
+}
+
+static void _add_json_benchmarks(const string &name, const function<string()> &load)
+{
+    // each benchmark owns its document, so large ones are freed between benchmarks
+    auto text = make_shared<string>();
+    auto doc = make_shared<json>(nullptr);
+
+    add_benchmark("json", "from_string_" + name, 1, [text](int ops)
+    {
+        for (int i = 0; i < ops; i++)
+            free_json(json_from_string(*text));
+    },
+    [text, load]() { _start_memory_use(); *text = load(); bench_bytes_per_op(text->size()); },
+    [text]() { _report_memory_use(); string().swap(*text); });
+
+    add_benchmark("json", "to_string_" + name, 1, [doc](int ops)
+    {
+        for (int i = 0; i < ops; i++)
+            bench_keep(json_to_string(*doc));
+    },
+    [text, doc, load]()
+    {
+        _start_memory_use();
+        *text = load();
+        *doc = json_from_string(*text);
+        bench_bytes_per_op(text->size());
+        string().swap(*text);
+    },
+    [doc]() { _report_memory_use(); free_json(*doc); *doc = nullptr; });
+}
+
+// Reading the fields of each object in the save game, as a game loading it would
+static void _add_json_read_benchmarks()
+{
+    static json save = nullptr;
+    static vector<json> objects;
+
+    bench_step setup = []()
+    {
+        save = json_from_file("save_game.json");
+        json_read_array(save, "objects", objects);
+    };
+
+    bench_step teardown = []()
+    {
+        for (json obj : objects) free_json(obj);
+        objects.clear();
+        free_json(save);
+        save = nullptr;
+    };
+
+    add_benchmark("json", "read_fields_by_string", 1000, [](int ops)
+    {
+        double total = 0;
+        for (int i = 0; i < ops; i++)
+        {
+            json obj = objects[i % objects.size()];
+            total += json_read_number_as_double(obj, "x") + json_read_number_as_double(obj, "y");
+            total += json_read_bool(obj, "active") ? 1 : 0;
+            total += json_read_string(obj, "kind").size();
+        }
+        bench_keep(total);
+    }, setup, teardown);
+
+    add_benchmark("json", "read_fields_by_key", 1000, [](int ops)
+    {
+        static json_key x = json_key_for("x"), y = json_key_for("y");
+        double total = 0;
+        for (int i = 0; i < ops; i++)
+        {
+            json obj = objects[i % objects.size()];
+            total += json_read_number_as_double(obj, x) + json_read_number_as_double(obj, y);
+        }
+        bench_keep(total);
+    }, setup, teardown);
+
+    add_benchmark("json", "read_path", 1000, [](int ops)
+    {
+        double total = 0;
+        for (int i = 0; i < ops; i++)
+            total += json_read_path_number(save, "player.position.x");
+        bench_keep(total);
+    }, setup, teardown);
+
+    add_benchmark("json", "read_array", 100, [](int ops)
+    {
+        vector<string> tags;
+        for (int i = 0; i < ops; i++)
+            json_read_array(objects[i % objects.size()], "tags", tags);
+        bench_keep(tags);
+    }, setup, teardown);
+}
+
+// The line by line parsing done when loading bundles and animation scripts
+static void _add_text_benchmarks(const string &name, resource_kind kind, const string &filename, bool has_ranges)
+{
+    auto lines = make_shared<vector<string>>();
+
+    bench_step setup = [lines, kind, filename]()
+    {
+        *lines = _lines(_read_file(path_to_resource(filename, kind)));
+
+        double bytes = 0;
+        for (const string &line : *lines) bytes += line.size();
+        bench_bytes_per_op(lines->empty() ? 0 : bytes / lines->size());
+    };
+
+    add_benchmark("text", name + "_extract_delimited", 1000, [lines](int ops)
+    {
+        size_t total = 0;
+        for (int i = 0; i < ops; i++)
+        {
+            const string &line = (*lines)[i % lines->size()];
+            int fields = count_delimiter_with_ranges(line, ',') + 1;
+            for (int f = 1; f <= fields; f++)
+                total += extract_delimited_with_ranges(f, line).size();
+        }
+        bench_keep(total);
+    }, setup);
+
+    add_benchmark("text", name + "_split_delimited", 1000, [lines](int ops)
+    {
+        static vector<string_view> fields;
+        size_t total = 0;
+        for (int i = 0; i < ops; i++)
+        {
+            split_delimited_with_ranges((*lines)[i % lines->size()], ',', fields);
+            total += fields.size();
+        }
+        bench_keep(total);
+    }, setup);
+
+    if ( ! has_ranges ) return;
+
+    // the ranges of each line, after its "m:" or "f:" prefix
+    add_benchmark("text", name + "_process_range", 1000, [lines](int ops)
+    {
+        vector<int> cells;
+        for (int i = 0; i < ops; i++)
+        {
+            const string &line = (*lines)[i % lines->size()];
+            string data = line.size() > 2 && line[1] == ':' ? line.substr(2) : line;
+            for (int f = 1; f <= 2; f++)
+            {
+                string field = extract_delimited_with_ranges(f, data);
+                if ( field.find('[') != string::npos ) process_range(field, cells);
+            }
+        }
+        bench_keep(cells);
+    }, setup);
+}
+
+void register_parsing_benchmarks()
+{
+    _add_json_benchmarks("save_game", []() { return _read_file(path_to_resource("save_game.json", JSON_RESOURCE)); });
+    _add_json_benchmarks("person", []() { return _read_file(path_to_resource("person.json", JSON_RESOURCE)); });
+
+    const char *env_sizes = getenv("SKBENCH_JSON_SIZES_MB");
+    string list = env_sizes ? env_sizes : DEFAULT_JSON_SIZES_MB;
+
+    for (int i = 1; i <= count_delimiter(list, ',') + 1; i++)
+    {
+        int mb = atoi(extract_delimited(i, list, ',').c_str());
+        if ( mb > 0 ) _add_json_benchmarks("large_" + to_string(mb) + "mb", [mb]() { return _large_json(mb); });
+    }
+
+    _add_json_read_benchmarks();
+
+    _add_text_benchmarks("animation", ANIMATION_RESOURCE, "kermit.txt", true);
+    _add_text_benchmarks("bundle", BUNDLE_RESOURCE, "cave_escape.txt", false);
+}
@@ -0,0 +1,171 @@
+//
+//  bench_sprites.cpp
+//  splashkit
+//
+//  Measures how the cost of updating, drawing and colliding sprites grows
+//  with the number of sprites. Each sample is one frame over every sprite,
+//  and counts as one operation per sprite, so the time of each operation
+//  is the cost per sprite. Compare it across the sprite counts to see how
+//  the cost scales. Each benchmark also records the heap allocations made
+//  in each frame.
+//
+
+#include "skbench.h"
+#include "unit_tests/alloc_tracking.h"
+
+#include "animations.h"
+#include "collisions.h"
+#include "color.h"
+#include "images.h"
+#include "random.h"
+#include "sprites.h"
+#include "vector_2d.h"
+#include "window_manager.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace splashkit_lib;
+
+#define SPRITE_SEED 7
+// All pairs are tested in each collision frame, so larger counts take too long
+#define MAX_PAIRWISE_SPRITES 2000
+
+enum _sprite_setup
+{
+    SPRITES_PLAIN,
+    SPRITES_LAYERS,     // three layers each, two of them shown
+    SPRITES_VALUES,     // four named values each
+    SPRITES_ANIMATED    // playing a walking animation
+};
+
+static const char *_setup_names[] = { "plain", "layers", "values", "animated" };
+
+static vector<sprite> _sprites;
+static long long _frames, _frame_allocations;
+
+static void _setup_sprites(_sprite_setup kind, int count)
+{
+    bitmap bmp = bitmap_named("skbench_frog_cells");
+    if ( ! bmp )
+    {
+        bmp = load_bitmap("skbench_frog_cells", "frog.png");
+        bitmap_set_cell_details(bmp, 73, 105, 4, 4, 16);
+    }
+
+    animation_script script = nullptr;
+    if ( kind == SPRITES_ANIMATED )
+    {
+        script = animation_script_named("skbench_walk");
+        if ( ! script ) script = load_animation_script("skbench_walk", "kermit.txt");
+    }
+
+    window wnd = bench_window();
+    rnd_seed(SPRITE_SEED);
+    _sprites.reserve(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        sprite s = script ? create_sprite(bmp, script) : create_sprite(bmp);
+        sprite_set_x(s, rnd() * window_width(wnd));
+        sprite_set_y(s, rnd() * window_height(wnd));
+        sprite_set_velocity(s, vector_to(rnd() * 2 - 1, rnd() * 2 - 1));
+
+        switch (kind)
+        {
+            case SPRITES_LAYERS:
+                sprite_show_layer(s, sprite_add_layer(s, bmp, "shadow"));
+                sprite_add_layer(s, bmp, "hidden");
+                break;
+            case SPRITES_VALUES:
+                sprite_add_value(s, "health", 100);
+                sprite_add_value(s, "speed", 2);
+                sprite_add_value(s, "score", 0);
+                sprite_add_value(s, "team", i % 2);
+                break;
+            case SPRITES_ANIMATED:
+                sprite_start_animation(s, "WalkFront");
+                break;
+            default:
+                break;
+        }
+
+        _sprites.push_back(s);
+    }
+
+    _frames = 0;
+    _frame_allocations = 0;
+}
+
+static void _free_sprites()
+{
+    bench_metric("allocations_per_frame", _frames ? static_cast<double>(_frame_allocations) / _frames : 0);
+
+    for (sprite s : _sprites)
+        free_sprite(s);
+    _sprites.clear();
+}
+
+// Run one frame of work, counting the allocations it makes
+template <typename T>
+static void _counted_frame(T frame)
+{
+    long long before = allocation_count();
+    frame();
+
+    if ( bench_warming_up() ) return;
+    _frame_allocations += allocation_count() - before;
+    _frames++;
+}
+
+static void _add_sprite_benchmarks(_sprite_setup kind, int count)
+{
+    string suffix = string(_setup_names[kind]) + "_" + to_string(count);
+    bench_step setup = [kind, count]() { _setup_sprites(kind, count); };
+
+    add_benchmark("sprites", "update_" + suffix, count, [](int ops)
+    {
+        _counted_frame([]() { update_all_sprites(); });
+    }, setup, _free_sprites);
+
+    add_benchmark("sprites", "draw_" + suffix, count, [](int ops)
+    {
+        _counted_frame([]()
+        {
+            clear_window(bench_window(), COLOR_WHITE);
+            draw_all_sprites();
+            bench_present();
+        });
+    }, setup, _free_sprites);
+
+    if ( count > MAX_PAIRWISE_SPRITES ) return;
+
+    // each operation is one sprite tested against all the others
+    add_benchmark("sprites", "collide_pairs_" + suffix, count, [](int ops)
+    {
+        int hits = 0;
+        _counted_frame([&hits]()
+        {
+            for (size_t i = 0; i < _sprites.size(); i++)
+            {
+                for (size_t j = i + 1; j < _sprites.size(); j++)
+                {
+                    if ( sprite_collision(_sprites[i], _sprites[j]) ) hits++;
+                }
+            }
+        });
+        bench_metric("collisions_per_frame", hits);
+    }, setup, _free_sprites);
+}
+
+void register_sprite_benchmarks()
+{
+    int counts[] = { 100, 1000, 10000, 100000 };
+
+    for (int kind = SPRITES_PLAIN; kind <= SPRITES_ANIMATED; kind++)
+    {
+        for (int count : counts)
+            _add_sprite_benchmarks(static_cast<_sprite_setup>(kind), count);
+    }
+}
@@ -0,0 +1,136 @@
+//
+//  bench_startup.cpp
+//  splashkit
+//
+//  Times the steps of starting a game: loading a bundle, an animation
+//  script, a font and its first text, a bitmap with its collision mask,
+//  and opening a window. Each sample loads everything, then frees it all
+//  so the next sample loads it again. The time of each step is reported
+//  as a metric of the benchmark.
+//
+//  The cold benchmark asks the operating system to drop the resource
+//  files from its cache before each sample, so they are read from disk.
+//  This is only possible on Linux, elsewhere both benchmarks use the cache.
+//
+
+#include "skbench.h"
+
+#include "animations.h"
+#include "bundles.h"
+#include "color.h"
+#include "drawing_options.h"
+#include "images.h"
+#include "resources.h"
+#include "text.h"
+#include "window_manager.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace splashkit_lib;
+
+enum _startup_phase
+{
+    PHASE_BUNDLE,
+    PHASE_ANIMATION,
+    PHASE_FONT,
+    PHASE_BITMAP,
+    PHASE_WINDOW,
+    PHASE_COUNT
+};
+
+static const char *_phase_names[PHASE_COUNT] = { "bundle", "animation_script", "font_and_first_text", "bitmap_and_mask", "open_window" };
+
+static vector<double> _phase_ms[PHASE_COUNT];
+static bool _evicted_files = false;
+
+// Ask the operating system to forget the cached contents of all resource files
+static void _evict_resource_files()
+{
+#ifdef __linux__
+    std::error_code err;
+    for (const auto &entry : filesystem::recursive_directory_iterator(path_to_resources(), err))
+    {
+        if ( ! entry.is_regular_file(err) ) continue;
+
+        int fd = open(entry.path().c_str(), O_RDONLY);
+        if ( fd < 0 ) continue;
+
+        fdatasync(fd);
+        _evicted_files = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0 || _evicted_files;
+        close(fd);
+    }
+#endif
+}
+
+static void _run_startup(bool cold)
+{
+    if ( cold ) _evict_resource_files();
+
+    double times[PHASE_COUNT + 1];
+    times[0] = bench_now();
+
+    load_resource_bundle("skbench_startup", "test.txt");
+    times[PHASE_ANIMATION] = bench_now();
+
+    animation_script script = load_animation_script("skbench_startup_walk", "kermit.txt");
+    times[PHASE_FONT] = bench_now();
+
+    font fnt = load_font("skbench_startup_font", "hara.ttf");
+    draw_text("Loading...", COLOR_BLACK, fnt, 24, 10, 10, option_draw_to(bench_window()));
+    times[PHASE_BITMAP] = bench_now();
+
+    bitmap bmp = load_bitmap("skbench_startup_bitmap", "background.png");
+    setup_collision_mask(bmp);
+    times[PHASE_WINDOW] = bench_now();
+
+    window wnd = open_window("skbench startup", 800, 600);
+    times[PHASE_COUNT] = bench_now();
+
+    for (int phase = 0; phase < PHASE_COUNT && ! bench_warming_up(); phase++)
+        _phase_ms[phase].push_back((times[phase + 1] - times[phase]) * 1000);
+
+    close_window(wnd);
+    free_bitmap(bmp);
+    free_font(fnt);
+    free_animation_script(script);
+    free_resource_bundle("skbench_startup");
+}
+
+static void _clear_phases()
+{
+    for (vector<double> &times : _phase_ms)
+        times.clear();
+    _evicted_files = false;
+}
+
+static void _report_phases()
+{
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        bench_metric(string(_phase_names[phase]) + "_ms_p50", bench_percentile(_phase_ms[phase], 50));
+        bench_metric(string(_phase_names[phase]) + "_ms_max", bench_percentile(_phase_ms[phase], 100));
+    }
+
+    bench_metric("cache_evicted", _evicted_files ? 1 : 0);
+}
+
+void register_startup_benchmarks()
+{
+    add_benchmark("startup", "cold", 1, [](int ops)
+    {
+        for (int i = 0; i < ops; i++) _run_startup(true);
+    }, _clear_phases, _report_phases);
+
+    add_benchmark("startup", "warm", 1, [](int ops)
+    {
+        for (int i = 0; i < ops; i++) _run_startup(false);
+    }, _clear_phases, _report_phases);
+}
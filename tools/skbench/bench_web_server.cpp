@@ -0,0 +1,267 @@
+//
+//  bench_web_server.cpp
+//  splashkit
+//
+//  Load tests for the web server. A curl multi handle keeps a number of
+//  clients sending requests to a server on loopback, while the benchmark
+//  loop answers any requests that reach the queue. Route handlers answer
+//  the others on the server's worker threads. Latency is measured by the
+//  clients from sending a request to receiving all of its response.
+//
+
+#include "skbench.h"
+
+#include "json.h"
+#include "web_server.h"
+
+#include <curl/curl.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace splashkit_lib;
+
+#define BENCH_WEB_FIRST_PORT 47200
+#define BENCH_WEB_WORKERS 16
+#define REQUESTS_PER_SAMPLE 500
+// How often the server's requests in flight are checked to estimate worker use
+#define BENCH_WEB_UTILIZATION_INTERVAL 0.001
+#define BENCH_WEB_POST_BODY_SIZE 4096
+
+enum _web_request_kind
+{
+    WEB_ROUTED_GET,     // answered by a route handler on a worker thread
+    WEB_QUEUED_GET,     // answered by the benchmark loop, through next_web_request
+    WEB_POST_BODY,      // a route handler echoes the body back
+    WEB_STATIC_FILE     // a route handler sends a file from Resources/server
+};
+
+// Upper bounds of the latency histogram buckets, in microseconds
+static const double _latency_buckets[] = { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000 };
+#define LATENCY_BUCKET_COUNT (sizeof(_latency_buckets) / sizeof(_latency_buckets[0]))
+
+struct _web_client
+{
+    CURL *handle;
+    double started;
+};
+
+struct _web_bench
+{
+    _web_request_kind kind;
+    int clients;
+    unsigned short int port;
+
+    web_server server;
+    CURLM *multi;
+    vector<_web_client> pool;
+    string url, post_body;
+
+    vector<double> latencies;
+    long long histogram[LATENCY_BUCKET_COUNT + 1];
+    long long failed;
+    double in_flight_total;
+    long long in_flight_checks;
+};
+
+static _web_bench _web;
+
+static size_t _discard_response(char *data, size_t size, size_t count, void *user)
+{
+    return size * count;
+}
+
+static void _hello_route(void *request)
+{
+    send_response(static_cast<http_request>(request), "Hello World");
+}
+
+static void _echo_route(void *request)
+{
+    http_request r = static_cast<http_request>(request);
+    send_response(r, HTTP_STATUS_OK, request_body(r), "application/octet-stream");
+}
+
+static void _file_route(void *request)
+{
+    send_html_file_response(static_cast<http_request>(request), "get.html");
+}
+
+static void _setup_web_bench(const _web_bench &config)
+{
+    _web.kind = config.kind;
+    _web.clients = config.clients;
+    _web.port = config.port;
+    _web.latencies.clear();
+    _web.failed = 0;
+    _web.in_flight_total = 0;
+    _web.in_flight_checks = 0;
+    for (long long &bucket : _web.histogram) bucket = 0;
+
+    _web.server = start_web_server(config.port, BENCH_WEB_WORKERS);
+    web_server_add_route(_web.server, HTTP_GET_METHOD, "/hello", _hello_route);
+    web_server_add_route(_web.server, HTTP_POST_METHOD, "/echo", _echo_route);
+    web_server_add_route(_web.server, HTTP_GET_METHOD, "/file", _file_route);
+
+    string base = "http://127.0.0.1:" + to_string(config.port);
+    switch (config.kind)
+    {
+        case WEB_ROUTED_GET:    _web.url = base + "/hello"; break;
+        case WEB_QUEUED_GET:    _web.url = base + "/queued"; break;
+        case WEB_POST_BODY:     _web.url = base + "/echo"; break;
+        case WEB_STATIC_FILE:   _web.url = base + "/file"; break;
+    }
+    _web.post_body.assign(BENCH_WEB_POST_BODY_SIZE, 'x');
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    _web.multi = curl_multi_init();
+
+    // each client keeps its connection open between requests
+    _web.pool.resize(config.clients);
+    for (_web_client &client : _web.pool)
+    {
+        client.handle = curl_easy_init();
+        curl_easy_setopt(client.handle, CURLOPT_URL, _web.url.c_str());
+        curl_easy_setopt(client.handle, CURLOPT_WRITEFUNCTION, _discard_response);
+        curl_easy_setopt(client.handle, CURLOPT_PRIVATE, &client);
+        curl_easy_setopt(client.handle, CURLOPT_TCP_NODELAY, 1L);
+
+        if ( config.kind == WEB_POST_BODY )
+        {
+            curl_easy_setopt(client.handle, CURLOPT_POSTFIELDS, _web.post_body.c_str());
+            curl_easy_setopt(client.handle, CURLOPT_POSTFIELDSIZE, static_cast<long>(_web.post_body.size()));
+        }
+    }
+}
+
+static void _record_latency(double seconds)
+{
+    double us = seconds * 1e6;
+    _web.latencies.push_back(us);
+
+    size_t bucket = 0;
+    while ( bucket < LATENCY_BUCKET_COUNT && us > _latency_buckets[bucket] ) bucket++;
+    _web.histogram[bucket]++;
+}
+
+static void _check_worker_use()
+{
+    static double next_check = 0;
+    double now = bench_now();
+    if ( now < next_check ) return;
+    next_check = now + BENCH_WEB_UTILIZATION_INTERVAL;
+
+    json metrics = web_server_metrics(_web.server);
+    _web.in_flight_total += json_read_number_as_double(metrics, "requests_in_flight");
+    _web.in_flight_checks++;
+    free_json(metrics);
+}
+
+static void _run_web_bench(int ops)
+{
+    int started = 0, finished = 0;
+
+    static vector<_web_client *> idle;
+    idle.clear();
+    for (_web_client &client : _web.pool) idle.push_back(&client);
+
+    while ( finished < ops )
+    {
+        while ( started < ops && ! idle.empty() )
+        {
+            _web_client *client = idle.back();
+            idle.pop_back();
+
+            client->started = bench_now();
+            curl_multi_add_handle(_web.multi, client->handle);
+            started++;
+        }
+
+        int running = 0;
+        curl_multi_perform(_web.multi, &running);
+
+        CURLMsg *msg;
+        int left = 0;
+        while ( (msg = curl_multi_info_read(_web.multi, &left)) )
+        {
+            if ( msg->msg != CURLMSG_DONE ) continue;
+
+            _web_client *client = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &client);
+
+            long code = 0;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &code);
+            if ( msg->data.result != CURLE_OK || code != 200 ) _web.failed++;
+            else _record_latency(bench_now() - client->started);
+
+            curl_multi_remove_handle(_web.multi, msg->easy_handle);
+            idle.push_back(client);
+            finished++;
+        }
+
+        while ( has_incoming_requests(_web.server) )
+            send_response(next_web_request(_web.server), "Hello World");
+
+        _check_worker_use();
+
+        // when the loop answers requests it cannot wait on the clients alone
+        curl_multi_wait(_web.multi, nullptr, 0, _web.kind == WEB_QUEUED_GET ? 0 : 1, nullptr);
+    }
+}
+
+static void _teardown_web_bench()
+{
+    bench_metric("latency_p50_us", bench_percentile(_web.latencies, 50));
+    bench_metric("latency_p90_us", bench_percentile(_web.latencies, 90));
+    bench_metric("latency_p99_us", bench_percentile(_web.latencies, 99));
+    bench_metric("server_latency_p99_ms", web_server_latency_percentile(_web.server, 99));
+    bench_metric("failed", _web.failed);
+    bench_metric("worker_utilization", _web.in_flight_checks ? _web.in_flight_total / _web.in_flight_checks / BENCH_WEB_WORKERS : 0);
+
+    for (size_t i = 0; i < LATENCY_BUCKET_COUNT; i++)
+        bench_metric("latency_le_" + to_string(static_cast<int>(_latency_buckets[i])) + "us", _web.histogram[i]);
+    bench_metric("latency_over_" + to_string(static_cast<int>(_latency_buckets[LATENCY_BUCKET_COUNT - 1])) + "us", _web.histogram[LATENCY_BUCKET_COUNT]);
+
+    for (_web_client &client : _web.pool)
+        curl_easy_cleanup(client.handle);
+    _web.pool.clear();
+
+    curl_multi_cleanup(_web.multi);
+    _web.multi = nullptr;
+
+    stop_web_server(_web.server);
+    _web.server = nullptr;
+}
+
+static void _add_web_benchmark(const string &name, _web_request_kind kind, int clients)
+{
+    static unsigned short int next_port = BENCH_WEB_FIRST_PORT;
+
+    _web_bench config = {};
+    config.kind = kind;
+    config.clients = clients;
+    config.port = next_port++;
+
+    add_benchmark("web_server", name + "_" + to_string(clients) + "_clients", REQUESTS_PER_SAMPLE, _run_web_bench,
+        [config]() { _setup_web_bench(config); },
+        _teardown_web_bench);
+}
+
+void register_web_server_benchmarks()
+{
+    vector<int> client_counts = { 1, 16, 64 };
+
+    // SKBENCH_WEB_CLIENTS adds another number of clients to test with
+    const char *extra = getenv("SKBENCH_WEB_CLIENTS");
+    if ( extra && atoi(extra) > 0 ) client_counts.push_back(atoi(extra));
+
+    for (int clients : client_counts)
+    {
+        _add_web_benchmark("routed_get", WEB_ROUTED_GET, clients);
+        _add_web_benchmark("queued_get", WEB_QUEUED_GET, clients);
+        _add_web_benchmark("post_body", WEB_POST_BODY, clients);
+        _add_web_benchmark("static_file", WEB_STATIC_FILE, clients);
+    }
+}
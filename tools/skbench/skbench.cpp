@@ -0,0 +1,296 @@
+//
+//  skbench.cpp
+//  splashkit
+//
+//  Runs the registered benchmarks and reports their results.
+//
+//  Usage: skbench [--filter text] [--samples n] [--min-time seconds]
+//                 [--json file] [--window] [--list]
+//
+//  Benchmarks run headless by default, so results do not depend on the
+//  display or its refresh rate. Use --window to draw to a real window.
+//  Only benchmarks whose "group/name" contains the filter text are run.
+//
+
+#include "skbench.h"
+
+#include "color.h"
+#include "graphics.h"
+#include "profiling.h"
+#include "window_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+using namespace splashkit_lib;
+
+// Samples are taken until both the sample count and the time are reached
+#define BENCH_DEFAULT_SAMPLES 20
+#define BENCH_MAX_SAMPLES 10000
+#define BENCH_DEFAULT_MIN_TIME 0.5
+#define BENCH_WARMUP_SAMPLES 2
+
+static vector<bench_case> _benchmarks;
+static vector<bench_metric_value> _current_metrics;
+
+static bool _headless = true;
+static bool _warming_up = false;
+static double _bytes_per_op = 0;
+
+void add_benchmark(const string &group, const string &name, int ops_per_sample, const bench_body &body, const bench_step &setup, const bench_step &teardown)
+{
+    _benchmarks.push_back({ group, name, max(1, ops_per_sample), body, setup, teardown });
+}
+
+void bench_metric(const string &name, double value)
+{
+    for (bench_metric_value &metric : _current_metrics)
+    {
+        if ( metric.name == name )
+        {
+            metric.value = value;
+            return;
+        }
+    }
+
+    _current_metrics.push_back({ name, value });
+}
+
+void bench_bytes_per_op(double bytes)
+{
+    _bytes_per_op = bytes;
+}
+
+double bench_peak_rss_mb()
+{
+#if defined(__APPLE__)
+    struct rusage usage;
+    if ( getrusage(RUSAGE_SELF, &usage) != 0 ) return 0;
+    return usage.ru_maxrss / (1024.0 * 1024.0);     // bytes on macOS
+#elif defined(__linux__)
+    struct rusage usage;
+    if ( getrusage(RUSAGE_SELF, &usage) != 0 ) return 0;
+    return usage.ru_maxrss / 1024.0;                // kilobytes on Linux
+#else
+    return 0;
+#endif
+}
+
+double bench_now()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool bench_warming_up()
+{
+    return _warming_up;
+}
+
+double bench_percentile(vector<double> &values, double pct)
+{
+    if ( values.empty() ) return 0;
+
+    sort(values.begin(), values.end());
+    size_t idx = static_cast<size_t>(pct / 100.0 * (values.size() - 1) + 0.5);
+    return values[min(idx, values.size() - 1)];
+}
+
+window bench_window()
+{
+    static window wnd = nullptr;
+    if ( ! wnd ) wnd = open_window("skbench", 800, 600);
+    return wnd;
+}
+
+void bench_present()
+{
+    refresh_window(bench_window());
+
+    render_statistics stats = render_stats();
+    bench_metric("draw_calls", stats.draw_calls);
+    bench_metric("texture_switches", stats.texture_switches);
+}
+
+static bench_result _run_benchmark(const bench_case &bench, int min_samples, double min_time)
+{
+    _current_metrics.clear();
+    _bytes_per_op = 0;
+
+    if ( bench.setup ) bench.setup();
+
+    _warming_up = true;
+    for (int i = 0; i < BENCH_WARMUP_SAMPLES; i++)
+        bench.body(bench.ops_per_sample);
+    _warming_up = false;
+
+    vector<double> op_ns;
+    double total = 0;
+
+    while ( op_ns.size() < BENCH_MAX_SAMPLES && (static_cast<int>(op_ns.size()) < min_samples || total < min_time) )
+    {
+        double start = bench_now();
+        bench.body(bench.ops_per_sample);
+        double taken = bench_now() - start;
+
+        total += taken;
+        op_ns.push_back(taken * 1e9 / bench.ops_per_sample);
+    }
+
+    if ( bench.teardown ) bench.teardown();
+
+    bench_result result;
+    result.group = bench.group;
+    result.name = bench.name;
+    result.samples = static_cast<int>(op_ns.size());
+    result.ops = static_cast<long long>(result.samples) * bench.ops_per_sample;
+    result.seconds = total;
+    result.ops_per_second = total > 0 ? result.ops / total : 0;
+    result.p50_ns = bench_percentile(op_ns, 50);
+    result.p90_ns = bench_percentile(op_ns, 90);
+    result.p99_ns = bench_percentile(op_ns, 99);
+    result.max_ns = op_ns.empty() ? 0 : op_ns.back();
+    result.metrics = _current_metrics;
+
+    if ( _bytes_per_op > 0 )
+        result.metrics.push_back({ "mb_per_second", result.ops_per_second * _bytes_per_op / 1e6 });
+
+    return result;
+}
+
+static string _json_string(const string &text)
+{
+    string result = "\"";
+    for (char c : text)
+    {
+        if ( c == '"' || c == '\\' ) result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
+
+static bool _write_json(const string &filename, const vector<bench_result> &results)
+{
+    ofstream out(filename, ios::trunc);
+    if ( ! out ) return false;
+
+    out << setprecision(10);
+    out << "{\n  \"headless\": " << (_headless ? "true" : "false") << ",\n  \"results\": [";
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const bench_result &r = results[i];
+
+        out << (i ? ",\n" : "\n")
+            << "    { \"group\": " << _json_string(r.group)
+            << ", \"name\": " << _json_string(r.name)
+            << ", \"ops\": " << r.ops
+            << ", \"samples\": " << r.samples
+            << ", \"seconds\": " << r.seconds
+            << ", \"ops_per_second\": " << r.ops_per_second
+            << ", \"p50_ns\": " << r.p50_ns
+            << ", \"p90_ns\": " << r.p90_ns
+            << ", \"p99_ns\": " << r.p99_ns
+            << ", \"max_ns\": " << r.max_ns
+            << ", \"metrics\": {";
+
+        for (size_t m = 0; m < r.metrics.size(); m++)
+            out << (m ? ", " : " ") << _json_string(r.metrics[m].name) << ": " << r.metrics[m].value;
+
+        out << (r.metrics.empty() ? "} }" : " } }");
+    }
+
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+static void _print_result(const bench_result &r)
+{
+    cout << left << setw(40) << (r.group + "/" + r.name) << right
+         << fixed << setprecision(0)
+         << setw(14) << r.ops_per_second << " ops/s"
+         << setprecision(1)
+         << setw(12) << r.p50_ns << " ns p50"
+         << setw(12) << r.p99_ns << " ns p99";
+
+    for (const bench_metric_value &metric : r.metrics)
+        cout << "  " << metric.name << "=" << setprecision(2) << metric.value;
+
+    cout << endl;
+}
+
+static void _usage(const char *program)
+{
+    cerr << "Usage: " << program << " [--filter text] [--samples n] [--min-time seconds] [--json file] [--window] [--list]" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    string filter, json_file;
+    int min_samples = BENCH_DEFAULT_SAMPLES;
+    double min_time = BENCH_DEFAULT_MIN_TIME;
+    bool list_only = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+
+        if ( strcmp(argv[i], "--filter") == 0 && has_value ) filter = argv[++i];
+        else if ( strcmp(argv[i], "--samples") == 0 && has_value ) min_samples = max(1, atoi(argv[++i]));
+        else if ( strcmp(argv[i], "--min-time") == 0 && has_value ) min_time = atof(argv[++i]);
+        else if ( strcmp(argv[i], "--json") == 0 && has_value ) json_file = argv[++i];
+        else if ( strcmp(argv[i], "--window") == 0 ) _headless = false;
+        else if ( strcmp(argv[i], "--list") == 0 ) list_only = true;
+        else
+        {
+            _usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Must be chosen before SplashKit starts
+    set_headless_rendering(_headless);
+
+    register_drawing_benchmarks();
+    register_networking_benchmarks();
+    register_web_server_benchmarks();
+    register_collision_benchmarks();
+    register_startup_benchmarks();
+    register_sprite_benchmarks();
+    register_parsing_benchmarks();
+
+    vector<bench_result> results;
+
+    for (const bench_case &bench : _benchmarks)
+    {
+        string full_name = bench.group + "/" + bench.name;
+        if ( ! filter.empty() && full_name.find(filter) == string::npos ) continue;
+
+        if ( list_only )
+        {
+            cout << full_name << endl;
+            continue;
+        }
+
+        results.push_back(_run_benchmark(bench, min_samples, min_time));
+        _print_result(results.back());
+    }
+
+    if ( ! json_file.empty() && ! _write_json(json_file, results) )
+    {
+        cerr << "Unable to write results to " << json_file << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+//
+//  skbench.h
+//  splashkit
+//
+//  A small harness for timing SplashKit. Each benchmark registers a body
+//  that runs its operation a number of times. The harness times repeated
+//  samples of the body and reports operations per second and percentiles
+//  of the time each operation took, as text and as JSON.
+//
+
+#ifndef skbench_h
+#define skbench_h
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "window_manager.h"
+
+// The work being measured, which should perform the operation `ops` times
+typedef std::function<void(int ops)> bench_body;
+
+// Setup and teardown steps, which run before and after the samples and are not timed
+typedef std::function<void()> bench_step;
+
+struct bench_case
+{
+    std::string group;
+    std::string name;
+    int         ops_per_sample;
+    bench_body  body;
+    bench_step  setup;
+    bench_step  teardown;
+};
+
+struct bench_metric_value
+{
+    std::string name;
+    double      value;
+};
+
+struct bench_result
+{
+    std::string group;
+    std::string name;
+    long long   ops;
+    int         samples;
+    double      seconds;
+    double      ops_per_second;
+    double      p50_ns, p90_ns, p99_ns, max_ns;     // time of each operation, across samples
+    std::vector<bench_metric_value> metrics;
+};
+
+/**
+ * Register a benchmark. Samples run the body with `ops_per_sample`
+ * operations, and each sample's time is divided by this count to give the
+ * time of one operation.
+ */
+void add_benchmark(const std::string &group, const std::string &name, int ops_per_sample, const bench_body &body, const bench_step &setup = nullptr, const bench_step &teardown = nullptr);
+
+/**
+ * Record a value for the benchmark being run, such as bytes per second or
+ * draw calls per frame. Recording the same name again replaces its value.
+ */
+void bench_metric(const std::string &name, double value);
+
+/**
+ * Set how many bytes each operation of the benchmark being run processes,
+ * so its throughput is also reported in megabytes per second. Call this
+ * from the benchmark's setup.
+ */
+void bench_bytes_per_op(double bytes);
+
+/**
+ * The most memory the process has had in use at once, in megabytes, or 0
+ * where this cannot be read.
+ */
+double bench_peak_rss_mb();
+
+/**
+ * Seconds on a clock that only moves forward.
+ */
+double bench_now();
+
+/**
+ * True while the untimed warm up samples run, before the timed samples.
+ */
+bool bench_warming_up();
+
+/**
+ * The value `pct` percent of the way through the values, which are sorted
+ * in place. Returns 0 when there are no values.
+ */
+double bench_percentile(std::vector<double> &values, double pct);
+
+/**
+ * The window the drawing benchmarks draw onto. It is opened on first use,
+ * and has no display when the benchmarks run headless.
+ */
+splashkit_lib::window bench_window();
+
+/**
+ * Show what has been drawn on the benchmark window, and record the draw
+ * calls and texture switches the frame used.
+ */
+void bench_present();
+
+/**
+ * Keep the optimiser from removing the calculation of a value that is
+ * otherwise unused.
+ */
+template <typename T>
+inline void bench_keep(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+// Each group of benchmarks is registered by its own file
+void register_drawing_benchmarks();
+void register_networking_benchmarks();
+void register_web_server_benchmarks();
+void register_collision_benchmarks();
+void register_startup_benchmarks();
+void register_sprite_benchmarks();
+void register_parsing_benchmarks();
+
+#endif /* skbench_h */
@@ -0,0 +1,224 @@
+//
+//  sklog_decode.cpp
+//  splashkit
+//
+//  Expands the binary logs written with the LOG_BINARY_FILE log mode into
+//  text. See coresdk/src/coresdk/logging.cpp for the record layout.
+//
+//  Usage: sklog_decode file.sklog [out.txt]
+//
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const char *LEVEL_NAMES[] = { "", "INFO: ", "DEBUG: ", "WARNING: ", "ERROR: ", "FATAL: " };
+
+class record_reader
+{
+private:
+    istream &_in;
+
+public:
+    explicit record_reader(istream &in) : _in(in) { }
+
+    bool read_bytes(uint64_t &value, int count)
+    {
+        unsigned char buffer[8];
+        if ( ! _in.read(reinterpret_cast<char *>(buffer), count) ) return false;
+
+        value = 0;
+        for (int i = count - 1; i >= 0; i--)
+        {
+            value = (value << 8) | buffer[i];
+        }
+        return true;
+    }
+
+    bool read_text(string &text)
+    {
+        uint64_t len;
+        if ( ! read_bytes(len, 2) ) return false;
+
+        text.resize(len);
+        return len == 0 || static_cast<bool>(_in.read(&text[0], len));
+    }
+
+    bool read_magic()
+    {
+        char magic[6];
+        return _in.read(magic, 6) && memcmp(magic, "SKLOG\x01", 6) == 0;
+    }
+
+    int peek()
+    {
+        return _in.peek();
+    }
+};
+
+static string format_time(uint64_t start_ns, uint64_t offset_ns)
+{
+    uint64_t ns = start_ns + offset_ns;
+    time_t seconds = static_cast<time_t>(ns / 1000000000ULL);
+
+    tm local;
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+
+    char buffer[64];
+    size_t len = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+    snprintf(buffer + len, sizeof(buffer) - len, ".%06llu", static_cast<unsigned long long>((ns / 1000) % 1000000));
+    return buffer;
+}
+
+// Replaces each {} in the format with the next value
+static string expand(const string &format, const vector<string> &args)
+{
+    string result;
+    size_t next = 0;
+
+    for (size_t i = 0; i < format.length(); i++)
+    {
+        if (format[i] == '{' && i + 1 < format.length() && format[i + 1] == '}')
+        {
+            result += next < args.size() ? args[next] : "{}";
+            next++;
+            i++;
+        }
+        else
+        {
+            result += format[i];
+        }
+    }
+
+    // values without a placeholder are shown at the end
+    for ( ; next < args.size(); next++)
+    {
+        result += " " + args[next];
+    }
+
+    return result;
+}
+
+static bool read_arg(record_reader &reader, string &arg)
+{
+    uint64_t type, value;
+    if ( ! reader.read_bytes(type, 1) ) return false;
+
+    switch (type)
+    {
+        case 1:
+            if ( ! reader.read_bytes(value, 8) ) return false;
+            arg = to_string(static_cast<int64_t>(value));
+            return true;
+        case 2:
+        {
+            if ( ! reader.read_bytes(value, 8) ) return false;
+            double d;
+            memcpy(&d, &value, sizeof(d));
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%g", d);
+            arg = buffer;
+            return true;
+        }
+        case 3:
+            return reader.read_text(arg);
+        default:
+            return false;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        cerr << "Usage: " << argv[0] << " file.sklog [out.txt]" << endl;
+        return 1;
+    }
+
+    ifstream in(argv[1], ios::binary);
+    if ( ! in )
+    {
+        cerr << "Unable to open " << argv[1] << endl;
+        return 1;
+    }
+
+    ofstream out_file;
+    if (argc > 2) out_file.open(argv[2]);
+    ostream &out = argc > 2 ? out_file : cout;
+
+    record_reader reader(in);
+    map<uint64_t, string> formats;
+    uint64_t start_ns = 0;
+
+    while (reader.peek() != EOF)
+    {
+        // each session starts with a header
+        if (reader.peek() == 'S')
+        {
+            if ( ! reader.read_magic() || ! reader.read_bytes(start_ns, 8) )
+            {
+                cerr << "Invalid session header in " << argv[1] << endl;
+                return 1;
+            }
+            formats.clear();
+            continue;
+        }
+
+        uint64_t type, id, timestamp, count, level;
+        string text;
+        bool ok = reader.read_bytes(type, 1);
+
+        if (ok && type == 1)
+        {
+            ok = reader.read_bytes(id, 4) && reader.read_text(text);
+            if (ok) formats[id] = text;
+        }
+        else if (ok && type == 2)
+        {
+            ok = reader.read_bytes(id, 4) && reader.read_bytes(timestamp, 8) && reader.read_bytes(count, 1);
+
+            vector<string> args(ok ? count : 0);
+            for (size_t i = 0; ok && i < args.size(); i++)
+            {
+                ok = read_arg(reader, args[i]);
+            }
+
+            if (ok)
+            {
+                auto it = formats.find(id);
+                string format = it != formats.end() ? it->second : "<format " + to_string(id) + ">";
+                out << format_time(start_ns, timestamp) << " " << expand(format, args) << "\n";
+            }
+        }
+        else if (ok && type == 3)
+        {
+            ok = reader.read_bytes(timestamp, 8) && reader.read_bytes(level, 1) && reader.read_text(text);
+            if (ok)
+                out << format_time(start_ns, timestamp) << " " << (level < 6 ? LEVEL_NAMES[level] : "") << text << "\n";
+        }
+        else
+        {
+            ok = false;
+        }
+
+        if ( ! ok )
+        {
+            cerr << "Log ends with a damaged or partial record" << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,186 @@
+//
+//  skpack.cpp
+//  splashkit
+//
+//  Packs a resource bundle and the files it lists into a single archive
+//  that load_resource_bundle can map and decode from memory. See
+//  coresdk/src/coresdk/bundles.cpp for the archive layout.
+//
+//  Usage: skpack bundle.txt out.skpack [resources_dir]
+//
+//  Files are found as SplashKit finds them: the path as given, then within
+//  the matching folder of resources_dir (default "Resources"). Bitmaps,
+//  sounds and music are packed. Fonts, animations, timers and nested
+//  bundles are kept as references and load as usual.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define PACK_ALIGNMENT 16
+
+static const char PACK_MAGIC[8] = { 'S', 'K', 'P', 'A', 'C', 'K', 0, 1 };
+
+struct pack_entry
+{
+    string line;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+static string trim(const string &text)
+{
+    size_t start = text.find_first_not_of(" \t\r\n");
+    if ( start == string::npos ) return "";
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(start, end - start + 1);
+}
+
+// The n'th (1 based) comma separated field of the line
+static string field(const string &line, int n)
+{
+    size_t start = 0;
+    for (int i = 1; i < n; i++)
+    {
+        start = line.find(',', start);
+        if ( start == string::npos ) return "";
+        start++;
+    }
+
+    size_t end = line.find(',', start);
+    return trim(line.substr(start, end == string::npos ? string::npos : end - start));
+}
+
+// The resources folder for bundle kinds that are packed, or "" to keep a reference
+static string packed_folder(string kind)
+{
+    transform(kind.begin(), kind.end(), kind.begin(), ::toupper);
+
+    if ( kind == "BITMAP" ) return "images";
+    if ( kind == "SOUND" || kind == "MUSIC" ) return "sounds";
+    return "";
+}
+
+static bool file_exists(const string &path)
+{
+    ifstream in(path, ios::binary);
+    return in.good();
+}
+
+static void write_u32(ostream &out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+static void write_u64(ostream &out, uint64_t value)
+{
+    for (int i = 0; i < 8; i++) out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+}
+
+static void pad_to_alignment(ostream &out)
+{
+    while ( static_cast<uint64_t>(out.tellp()) % PACK_ALIGNMENT != 0 ) out.put(0);
+}
+
+int main(int argc, char *argv[])
+{
+    if ( argc < 3 )
+    {
+        cerr << "Usage: " << argv[0] << " bundle.txt out.skpack [resources_dir]" << endl;
+        return 1;
+    }
+
+    string resources = argc > 3 ? argv[3] : "Resources";
+
+    ifstream bundle(argv[1]);
+    if ( ! bundle )
+    {
+        cerr << "Unable to open bundle " << argv[1] << endl;
+        return 1;
+    }
+
+    ofstream out(argv[2], ios::binary | ios::trunc);
+    if ( ! out )
+    {
+        cerr << "Unable to create " << argv[2] << endl;
+        return 1;
+    }
+
+    // Header, with the index offset filled in once the blobs are written
+    out.write(PACK_MAGIC, sizeof(PACK_MAGIC));
+    write_u32(out, 0);
+    write_u32(out, 0);
+    write_u64(out, 0);
+    pad_to_alignment(out);
+
+    vector<pack_entry> entries;
+    string line;
+    int line_no = 0;
+    uint64_t packed_bytes = 0;
+
+    while ( getline(bundle, line) )
+    {
+        line_no++;
+        line = trim(line);
+        if ( line.empty() || line.compare(0, 2, "//") == 0 ) continue;
+
+        pack_entry entry;
+        entry.line = line;
+
+        string folder = packed_folder(field(line, 1));
+        string path = field(line, 3);
+
+        if ( ! folder.empty() && ! path.empty() )
+        {
+            string file_path = file_exists(path) ? path : resources + "/" + folder + "/" + path;
+            ifstream data(file_path, ios::binary);
+
+            if ( data )
+            {
+                pad_to_alignment(out);
+                entry.offset = static_cast<uint64_t>(out.tellp());
+                out << data.rdbuf();
+                entry.size = static_cast<uint64_t>(out.tellp()) - entry.offset;
+                packed_bytes += entry.size;
+            }
+            else
+            {
+                cerr << "Warning: unable to find " << file_path << " for line " << line_no << ", keeping a reference" << endl;
+            }
+        }
+
+        entries.push_back(entry);
+    }
+
+    pad_to_alignment(out);
+    uint64_t index_offset = static_cast<uint64_t>(out.tellp());
+
+    for (const pack_entry &entry : entries)
+    {
+        write_u32(out, static_cast<uint32_t>(entry.line.size()));
+        out.write(entry.line.data(), entry.line.size());
+        write_u64(out, entry.offset);
+        write_u64(out, entry.size);
+    }
+
+    out.seekp(sizeof(PACK_MAGIC));
+    write_u32(out, static_cast<uint32_t>(entries.size()));
+    write_u32(out, 0);
+    write_u64(out, index_offset);
+
+    if ( ! out )
+    {
+        cerr << "Error writing " << argv[2] << endl;
+        return 1;
+    }
+
+    cout << "Packed " << entries.size() << " entries (" << packed_bytes << " bytes) into " << argv[2] << endl;
+    return 0;
+}